@@ -0,0 +1,66 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/adpcm_cache.h"
+#include "common/hash.h"
+
+namespace AudioCore {
+
+ADPCMCache::ADPCMCache() = default;
+
+ADPCMCache::~ADPCMCache() = default;
+
+const std::vector<s16>& ADPCMCache::Decode(VAddr address, const u8* data, std::size_t size,
+                                           const Codec::ADPCM_Coeff& coeff,
+                                           Codec::ADPCMState& state) {
+    if (size > MaxBufferSize) {
+        uncached_samples = Codec::DecodeADPCM(data, size, coeff, state);
+        return uncached_samples;
+    }
+
+    const u64 coeff_hash = Common::ComputeHash64(coeff.data(), sizeof(coeff));
+    const ADPCMCacheKey key{address, size, Common::ComputeHash64(data, size, coeff_hash),
+                            state.yn1, state.yn2};
+
+    const auto [it, is_new] = cache.try_emplace(key);
+    Entry& entry = it->second;
+    if (!is_new) {
+        lru.splice(lru.begin(), lru, entry.lru_position);
+        state = entry.end_state;
+        return entry.samples;
+    }
+
+    entry.samples = Codec::DecodeADPCM(data, size, coeff, state);
+    entry.end_state = state;
+    entry.lru_position = lru.insert(lru.begin(), key);
+    cache_size += entry.samples.size() * sizeof(s16);
+    Evict();
+    return entry.samples;
+}
+
+void ADPCMCache::Invalidate(VAddr address, u64 size) {
+    for (auto it = cache.begin(); it != cache.end();) {
+        const auto& key = it->first;
+        if (key.address < address + size && address < key.address + key.size) {
+            Erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ADPCMCache::Evict() {
+    // The most recently used buffer is kept, it is the one being returned
+    while (cache_size > MaxCacheSize && lru.size() > 1) {
+        Erase(cache.find(lru.back()));
+    }
+}
+
+void ADPCMCache::Erase(std::unordered_map<ADPCMCacheKey, Entry>::iterator it) {
+    cache_size -= it->second.samples.size() * sizeof(s16);
+    lru.erase(it->second.lru_position);
+    cache.erase(it);
+}
+
+} // namespace AudioCore
@@ -0,0 +1,92 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+struct ADPCMCacheKey {
+    VAddr address;
+    u64 size;
+    u64 hash; ///< Hash of the ADPCM data and of the coefficients
+    s16 yn1;  ///< Decoder state the buffer was decoded from, see Codec::ADPCMState
+    s16 yn2;
+
+    bool operator==(const ADPCMCacheKey& rhs) const {
+        return address == rhs.address && size == rhs.size && hash == rhs.hash && yn1 == rhs.yn1 &&
+               yn2 == rhs.yn2;
+    }
+};
+
+} // namespace AudioCore
+
+namespace std {
+
+template <>
+struct hash<AudioCore::ADPCMCacheKey> {
+    std::size_t operator()(const AudioCore::ADPCMCacheKey& k) const noexcept {
+        return static_cast<std::size_t>(k.hash ^ k.address ^ (static_cast<u64>(k.yn1) << 16) ^
+                                        static_cast<u16>(k.yn2));
+    }
+};
+
+} // namespace std
+
+namespace AudioCore {
+
+/**
+ * Decoded PCM16 of the ADPCM wave buffers played recently. Sound effects are short buffers that
+ * are played over and over, they are only decoded again when their data changes. The data is
+ * hashed on every lookup, so buffers rewritten by the guest are never played stale.
+ */
+class ADPCMCache {
+public:
+    ADPCMCache();
+    ~ADPCMCache();
+
+    /**
+     * Returns the decoded samples of a wave buffer, decoding it if it isn't cached.
+     * @param address Guest address of the buffer
+     * @param data ADPCM data of the buffer
+     * @param state Decoder state, it is updated as if the buffer had been decoded
+     */
+    const std::vector<s16>& Decode(VAddr address, const u8* data, std::size_t size,
+                                   const Codec::ADPCM_Coeff& coeff, Codec::ADPCMState& state);
+
+    /// Removes the buffers within a memory region, used when a memory pool is detached
+    void Invalidate(VAddr address, u64 size);
+
+private:
+    /// Total size of the decoded samples kept in the cache
+    static constexpr std::size_t MaxCacheSize = 16 * 1024 * 1024;
+    /// Larger buffers are streamed music, they are decoded directly as they never repeat
+    static constexpr std::size_t MaxBufferSize = 64 * 1024;
+
+    struct Entry {
+        std::vector<s16> samples;
+        Codec::ADPCMState end_state;
+        /// Position of the entry in the LRU list
+        std::list<ADPCMCacheKey>::iterator lru_position;
+    };
+
+    /// Releases the least recently used buffers until the cache fits in its size
+    void Evict();
+
+    void Erase(std::unordered_map<ADPCMCacheKey, Entry>::iterator it);
+
+    std::unordered_map<ADPCMCacheKey, Entry> cache;
+    /// Keys of the cached buffers, from the most to the least recently used
+    std::list<ADPCMCacheKey> lru;
+    std::size_t cache_size = 0;
+    std::vector<s16> uncached_samples; ///< Samples of the last buffer too large to be cached
+};
+
+} // namespace AudioCore
@@ -0,0 +1,267 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "audio_core/algorithm/effects.h"
+#include "audio_core/algorithm/mix.h"
+#include "common/assert.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// Delays of the combs and all-passes of Freeverb, tuned for 44.1 kHz
+constexpr std::array<std::size_t, ReverbEffect::NumCombs> COMB_DELAYS{
+    1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617,
+};
+constexpr std::array<std::size_t, ReverbEffect::NumAllPasses> ALL_PASS_DELAYS{
+    556, 441, 341, 225,
+};
+
+/// Lengthens the delays of the right channel to decorrelate it from the left one
+constexpr std::size_t STEREO_SPREAD = 23;
+
+/// Scaling of the input of the combs, keeps their sum in range
+constexpr float COMB_INPUT_GAIN = 0.015f;
+
+/// Scaling of the late reverberation, makes up for the comb input gain
+constexpr float LATE_OUTPUT_GAIN = 3.0f;
+
+/// Highest feedback of the combs, longer decays would ring forever
+constexpr float MAX_COMB_FEEDBACK = 0.98f;
+
+/// Runs the one pole low-pass of a feedback path, the samples depend on each other
+void LowpassFeedback(float* samples, std::size_t count, float damping, float gain,
+                     float& state) {
+    float last = state;
+    for (std::size_t i = 0; i < count; ++i) {
+        last = samples[i] + damping * (last - samples[i]);
+        samples[i] = last * gain;
+    }
+    state = last;
+}
+
+} // Anonymous namespace
+
+DelayLine::DelayLine() = default;
+
+DelayLine::DelayLine(std::size_t max_delay) : buffer(max_delay), delay(max_delay) {}
+
+void DelayLine::SetDelay(std::size_t delay_) {
+    ASSERT(delay_ > 0 && delay_ <= buffer.size());
+    delay = delay_;
+}
+
+void DelayLine::Read(float* dest, std::size_t count) const {
+    ASSERT(count <= delay);
+    const std::size_t size = buffer.size();
+    std::size_t read_position = (position + size - delay) % size;
+    while (count > 0) {
+        const std::size_t chunk = std::min(count, size - read_position);
+        std::memcpy(dest, buffer.data() + read_position, chunk * sizeof(float));
+        dest += chunk;
+        count -= chunk;
+        read_position = 0;
+    }
+}
+
+void DelayLine::Write(const float* src, std::size_t count) {
+    const std::size_t size = buffer.size();
+    while (count > 0) {
+        const std::size_t chunk = std::min(count, size - position);
+        std::memcpy(buffer.data() + position, src, chunk * sizeof(float));
+        src += chunk;
+        count -= chunk;
+        position = (position + chunk) % size;
+    }
+}
+
+void DelayLine::Clear() {
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+}
+
+DelayEffect::DelayEffect() = default;
+DelayEffect::~DelayEffect() = default;
+
+void DelayEffect::Configure(const DelayConfig& new_config) {
+    const std::size_t max_delay = std::max<std::size_t>(new_config.max_delay, 1);
+    if (max_delay != config.max_delay) {
+        for (auto& line : lines) {
+            line = DelayLine{max_delay};
+        }
+        lowpass_states = {};
+    }
+
+    config = new_config;
+    config.max_delay = max_delay;
+    config.delay = std::clamp<std::size_t>(config.delay, 1, max_delay);
+    config.lowpass_amount = std::clamp(config.lowpass_amount, 0.0f, 1.0f);
+    for (auto& line : lines) {
+        line.SetDelay(config.delay);
+    }
+}
+
+void DelayEffect::Process(std::size_t channel, float* samples, std::size_t num_frames) {
+    ASSERT(channel < MaxChannels);
+    auto& line = lines[channel];
+    if (line.GetMaxDelay() == 0) {
+        return;
+    }
+
+    // A block no longer than the delay only depends on samples written before it
+    const std::size_t step = config.delay;
+    delayed.resize(std::min(step, num_frames));
+    feedback.resize(delayed.size());
+    while (num_frames > 0) {
+        const std::size_t count = std::min(step, num_frames);
+        line.Read(delayed.data(), count);
+
+        std::memcpy(feedback.data(), delayed.data(), count * sizeof(float));
+        LowpassFeedback(feedback.data(), count, config.lowpass_amount, config.feedback_gain,
+                        lowpass_states[channel]);
+        AccumulateSamples(feedback.data(), samples, count, config.in_gain);
+        line.Write(feedback.data(), count);
+
+        ScaleSamples(samples, count, config.dry_gain);
+        AccumulateSamples(samples, delayed.data(), count, config.wet_gain);
+        samples += count;
+        num_frames -= count;
+    }
+}
+
+void DelayEffect::Clear() {
+    for (auto& line : lines) {
+        line.Clear();
+    }
+    lowpass_states = {};
+}
+
+ReverbEffect::ReverbEffect() = default;
+ReverbEffect::~ReverbEffect() = default;
+
+void ReverbEffect::Configure(u32 new_sample_rate, const ReverbConfig& new_config) {
+    ASSERT(new_sample_rate > 0);
+    const double scale = new_sample_rate / 44100.0;
+    if (new_sample_rate != sample_rate) {
+        sample_rate = new_sample_rate;
+        max_step = SIZE_MAX;
+        for (std::size_t index = 0; index < MaxChannels; ++index) {
+            auto& state = channels[index];
+            const std::size_t spread = index * STEREO_SPREAD;
+            state.pre_delay =
+                DelayLine{static_cast<std::size_t>(MaxPreDelay * sample_rate) + 1};
+            for (std::size_t comb = 0; comb < NumCombs; ++comb) {
+                const auto delay = static_cast<std::size_t>((COMB_DELAYS[comb] + spread) * scale);
+                state.combs[comb].line = DelayLine{std::max<std::size_t>(delay, 1)};
+                state.combs[comb].lowpass_state = 0.0f;
+                max_step = std::min(max_step, state.combs[comb].line.GetDelay());
+            }
+            for (std::size_t all_pass = 0; all_pass < NumAllPasses; ++all_pass) {
+                const auto delay =
+                    static_cast<std::size_t>((ALL_PASS_DELAYS[all_pass] + spread) * scale);
+                state.all_passes[all_pass] = DelayLine{std::max<std::size_t>(delay, 1)};
+                max_step = std::min(max_step, state.all_passes[all_pass].GetDelay());
+            }
+        }
+    }
+
+    config = new_config;
+    config.pre_delay = std::min(config.pre_delay, channels[0].pre_delay.GetMaxDelay());
+    for (auto& state : channels) {
+        if (config.pre_delay > 0) {
+            state.pre_delay.SetDelay(config.pre_delay);
+        }
+
+        // Each pass through a comb decays it by its delay over the decay time, 60 dB in total
+        const float decay_time = std::max(config.decay_time, 0.01f);
+        const float damping = std::clamp(1.0f - config.high_freq_decay_ratio, 0.0f, 0.95f);
+        for (auto& comb : state.combs) {
+            const double delay_seconds = static_cast<double>(comb.line.GetDelay()) / sample_rate;
+            const auto feedback = static_cast<float>(std::pow(10.0, -3.0 * delay_seconds /
+                                                                        decay_time));
+            comb.feedback = std::min(feedback, MAX_COMB_FEEDBACK);
+            comb.damping = damping;
+        }
+    }
+    all_pass_gain = 0.3f + 0.4f * std::clamp(config.colouration, 0.0f, 1.0f);
+}
+
+void ReverbEffect::Process(std::size_t channel, float* samples, std::size_t num_frames) {
+    ASSERT(channel < MaxChannels);
+    if (sample_rate == 0) {
+        return;
+    }
+
+    auto& state = channels[channel];
+    std::size_t step = max_step;
+    if (config.pre_delay > 0) {
+        step = std::min(step, config.pre_delay);
+    }
+    while (num_frames > 0) {
+        const std::size_t count = std::min(step, num_frames);
+        ProcessStep(state, samples, count);
+        samples += count;
+        num_frames -= count;
+    }
+}
+
+void ReverbEffect::ProcessStep(Channel& state, float* samples, std::size_t count) {
+    input.resize(max_step);
+    late.resize(max_step);
+    delayed.resize(max_step);
+    feedback.resize(max_step);
+
+    // The pre-delayed input is the early reflection and feeds the late reverberation
+    if (config.pre_delay > 0) {
+        state.pre_delay.Read(input.data(), count);
+        state.pre_delay.Write(samples, count);
+    } else {
+        std::memcpy(input.data(), samples, count * sizeof(float));
+    }
+
+    // Parallel combs, each one feeds its damped output back with the input
+    std::fill_n(late.begin(), count, 0.0f);
+    for (auto& comb : state.combs) {
+        comb.line.Read(delayed.data(), count);
+        AccumulateSamples(late.data(), delayed.data(), count, 1.0f);
+
+        std::memcpy(feedback.data(), delayed.data(), count * sizeof(float));
+        LowpassFeedback(feedback.data(), count, comb.damping, comb.feedback, comb.lowpass_state);
+        AccumulateSamples(feedback.data(), input.data(), count, config.in_gain * COMB_INPUT_GAIN);
+        comb.line.Write(feedback.data(), count);
+    }
+
+    // Series all-passes diffuse the echoes: v = x + g * v[n - D], y = v[n - D] - g * v
+    for (auto& all_pass : state.all_passes) {
+        all_pass.Read(delayed.data(), count);
+        std::memcpy(feedback.data(), late.data(), count * sizeof(float));
+        AccumulateSamples(feedback.data(), delayed.data(), count, all_pass_gain);
+        all_pass.Write(feedback.data(), count);
+
+        std::memcpy(late.data(), delayed.data(), count * sizeof(float));
+        AccumulateSamples(late.data(), feedback.data(), count, -all_pass_gain);
+    }
+
+    ScaleSamples(samples, count, config.dry_gain);
+    AccumulateSamples(samples, input.data(), count, config.wet_gain * config.early_gain);
+    AccumulateSamples(samples, late.data(), count,
+                      config.wet_gain * config.late_gain * LATE_OUTPUT_GAIN);
+}
+
+void ReverbEffect::Clear() {
+    for (auto& state : channels) {
+        state.pre_delay.Clear();
+        for (auto& comb : state.combs) {
+            comb.line.Clear();
+            comb.lowpass_state = 0.0f;
+        }
+        for (auto& all_pass : state.all_passes) {
+            all_pass.Clear();
+        }
+    }
+}
+
+} // namespace AudioCore
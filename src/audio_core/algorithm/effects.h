@@ -0,0 +1,157 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Circular buffer delaying a signal by a number of samples. Blocks up to the delay long are read
+ * before being written, none of their samples depend on each other so they are processed as
+ * vectors.
+ */
+class DelayLine {
+public:
+    DelayLine();
+
+    /// Creates a line for delays of up to max_delay samples
+    explicit DelayLine(std::size_t max_delay);
+
+    /// Changes the delay, it must be between 1 and the maximum delay. The line isn't cleared.
+    void SetDelay(std::size_t delay);
+
+    std::size_t GetDelay() const {
+        return delay;
+    }
+
+    std::size_t GetMaxDelay() const {
+        return buffer.size();
+    }
+
+    /// Copies the next samples coming out of the line, count must not exceed the delay
+    void Read(float* dest, std::size_t count) const;
+
+    /// Pushes the samples that come out delay samples later, after a Read of the same count
+    void Write(const float* src, std::size_t count);
+
+    /// Fills the line with silence
+    void Clear();
+
+private:
+    std::vector<float> buffer;
+    std::size_t delay = 0;
+    std::size_t position = 0; ///< Index where the next sample is written
+};
+
+/// Parameters of a DelayEffect, the gains are linear
+struct DelayConfig {
+    std::size_t max_delay; ///< Longest delay the effect may be set to, in samples
+    std::size_t delay;     ///< Delay of the echoes, in samples
+    float in_gain;         ///< Gain of the input fed to the delay line
+    float feedback_gain;   ///< Gain of the echoes fed back to the delay line
+    float wet_gain;        ///< Gain of the echoes in the output
+    float dry_gain;        ///< Gain of the input in the output
+    float lowpass_amount;  ///< Damping of the echoes, from 0 (none) to 1
+};
+
+/// Feedback delay, each echo is damped by a one pole low-pass filter
+class DelayEffect {
+public:
+    static constexpr std::size_t MaxChannels = 2;
+
+    DelayEffect();
+    ~DelayEffect();
+
+    /// Changes the parameters, the delay lines are only reallocated when the maximum changes
+    void Configure(const DelayConfig& config);
+
+    /// Applies the effect in place to a block of a channel
+    void Process(std::size_t channel, float* samples, std::size_t num_frames);
+
+    /// Drops the echoes that are left
+    void Clear();
+
+private:
+    DelayConfig config{};
+    std::array<DelayLine, MaxChannels> lines;
+    std::array<float, MaxChannels> lowpass_states{};
+    std::vector<float> delayed;  ///< Samples coming out of the line
+    std::vector<float> feedback; ///< Samples going into the line
+};
+
+/// Parameters of a ReverbEffect, the gains are linear
+struct ReverbConfig {
+    std::size_t pre_delay;       ///< Delay before the reverb starts, in samples
+    float early_gain;            ///< Gain of the early reflection
+    float late_gain;             ///< Gain of the late reverberation
+    float decay_time;            ///< Time for the late reverberation to decay by 60 dB, in seconds
+    float high_freq_decay_ratio; ///< Decay time of the high frequencies, relative to decay_time
+    float colouration;           ///< Diffusion of the late reverberation, from 0 to 1
+    float in_gain;               ///< Gain of the input fed to the reverb
+    float wet_gain;              ///< Gain of the reverb in the output
+    float dry_gain;              ///< Gain of the input in the output
+};
+
+/**
+ * Schroeder reverb with the comb and all-pass tunings of Freeverb: parallel low-pass feedback
+ * combs followed by series all-passes, for each channel. The pre-delayed input is the early
+ * reflection. Blocks are processed in steps no longer than the shortest delay of the network.
+ */
+class ReverbEffect {
+public:
+    static constexpr std::size_t MaxChannels = 2;
+    static constexpr std::size_t NumCombs = 8;
+    static constexpr std::size_t NumAllPasses = 4;
+
+    /// Longest pre-delay the effect supports, in seconds
+    static constexpr double MaxPreDelay = 0.3;
+
+    ReverbEffect();
+    ~ReverbEffect();
+
+    /// Changes the parameters, the network is only reallocated when the sample rate changes
+    void Configure(u32 sample_rate, const ReverbConfig& config);
+
+    /// Applies the effect in place to a block of a channel
+    void Process(std::size_t channel, float* samples, std::size_t num_frames);
+
+    /// Drops the reverberation that is left
+    void Clear();
+
+private:
+    struct Comb {
+        DelayLine line;
+        float feedback = 0.0f;
+        float damping = 0.0f;
+        float lowpass_state = 0.0f;
+    };
+
+    struct Channel {
+        DelayLine pre_delay;
+        std::array<Comb, NumCombs> combs;
+        std::array<DelayLine, NumAllPasses> all_passes;
+    };
+
+    /// Processes a block no longer than the shortest delay of the network
+    void ProcessStep(Channel& state, float* samples, std::size_t count);
+
+    u32 sample_rate = 0;
+    ReverbConfig config{};
+    float all_pass_gain = 0.5f;
+    std::size_t max_step = 0; ///< Shortest delay of the network
+    std::array<Channel, MaxChannels> channels;
+
+    // Scratch buffers of max_step samples
+    std::vector<float> input;
+    std::vector<float> late;
+    std::vector<float> delayed;
+    std::vector<float> feedback;
+};
+
+} // namespace AudioCore
@@ -11,6 +11,10 @@
 #include "audio_core/algorithm/filter.h"
 #include "common/common_types.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore {
 
 Filter Filter::LowPass(double cutoff, double Q) {
@@ -51,6 +55,58 @@ void Filter::Process(std::vector<s16>& signal) {
     }
 }
 
+void Filter::Process(float* left, float* right, std::size_t num_frames) {
+#ifdef ARCHITECTURE_x86_64
+    // The recurrence is sequential in time, the two channels are computed side by side instead
+    const __m128d coef_b0 = _mm_set1_pd(b0);
+    const __m128d coef_b1 = _mm_set1_pd(b1);
+    const __m128d coef_b2 = _mm_set1_pd(b2);
+    const __m128d coef_a1 = _mm_set1_pd(a1);
+    const __m128d coef_a2 = _mm_set1_pd(a2);
+    __m128d x1 = _mm_loadu_pd(in[0].data());
+    __m128d x2 = _mm_loadu_pd(in[1].data());
+    __m128d y1 = _mm_loadu_pd(out[0].data());
+    __m128d y2 = _mm_loadu_pd(out[1].data());
+    for (std::size_t i = 0; i < num_frames; i++) {
+        const __m128d x0 = _mm_set_pd(right[i], left[i]);
+        const __m128d forward = _mm_add_pd(_mm_add_pd(_mm_mul_pd(coef_b0, x0),
+                                                      _mm_mul_pd(coef_b1, x1)),
+                                           _mm_mul_pd(coef_b2, x2));
+        const __m128d feedback = _mm_add_pd(_mm_mul_pd(coef_a1, y1), _mm_mul_pd(coef_a2, y2));
+        const __m128d y0 = _mm_sub_pd(forward, feedback);
+        left[i] = static_cast<float>(_mm_cvtsd_f64(y0));
+        right[i] = static_cast<float>(_mm_cvtsd_f64(_mm_unpackhi_pd(y0, y0)));
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+    }
+    _mm_storeu_pd(in[0].data(), x1);
+    _mm_storeu_pd(in[1].data(), x2);
+    _mm_storeu_pd(out[0].data(), y1);
+    _mm_storeu_pd(out[1].data(), y2);
+#else
+    const std::array<float*, channel_count> signal{left, right};
+    for (std::size_t ch = 0; ch < channel_count; ch++) {
+        double x1 = in[0][ch], x2 = in[1][ch];
+        double y1 = out[0][ch], y2 = out[1][ch];
+        for (std::size_t i = 0; i < num_frames; i++) {
+            const double x0 = signal[ch][i];
+            const double y0 = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            signal[ch][i] = static_cast<float>(y0);
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+        }
+        in[0][ch] = x1;
+        in[1][ch] = x2;
+        out[0][ch] = y1;
+        out[1][ch] = y2;
+    }
+#endif
+}
+
 /// Calculates the appropriate Q for each biquad in a cascading filter.
 /// @param total_count The total number of biquads to be cascaded.
 /// @param index 0-index of the biquad to calculate the Q value for.
@@ -76,4 +132,10 @@ void CascadingFilter::Process(std::vector<s16>& signal) {
     }
 }
 
+void CascadingFilter::Process(float* left, float* right, std::size_t num_frames) {
+    for (auto& filter : filters) {
+        filter.Process(left, right, num_frames);
+    }
+}
+
 } // namespace AudioCore
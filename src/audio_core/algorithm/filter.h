@@ -29,15 +29,19 @@ public:
 
     void Process(std::vector<s16>& signal);
 
+    /// Filters a block of each channel in place, the history carries over to the next block.
+    /// The channels are filtered together, in the lanes of a vector where available.
+    void Process(float* left, float* right, std::size_t num_frames);
+
 private:
     static constexpr std::size_t channel_count = 2;
 
     /// Coefficients are in normalized form (a0 = 1.0).
     double a1, a2, b0, b1, b2;
     /// Input History
-    std::array<std::array<double, channel_count>, 3> in;
+    std::array<std::array<double, channel_count>, 3> in{};
     /// Output History
-    std::array<std::array<double, channel_count>, 3> out;
+    std::array<std::array<double, channel_count>, 3> out{};
 };
 
 /// Cascade filters to build up higher-order filters from lower-order ones.
@@ -55,6 +59,9 @@ public:
 
     void Process(std::vector<s16>& signal);
 
+    /// Filters a block of each channel in place, see Filter::Process
+    void Process(float* left, float* right, std::size_t num_frames);
+
 private:
     std::vector<Filter> filters;
 };
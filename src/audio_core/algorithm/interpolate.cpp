@@ -5,68 +5,170 @@
 #define _USE_MATH_DEFINES
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <vector>
 #include "audio_core/algorithm/interpolate.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <xmmintrin.h>
+#endif
+
 namespace AudioCore {
+namespace {
+
+constexpr std::size_t window_size = InterpolationState::window_size;
+constexpr std::size_t history_size = InterpolationState::history_size;
+
+/// Number of positions between two input frames the sinc weights are computed for
+constexpr std::size_t num_phases = 256;
+
+/// Sinc weights of a position, repeated for both channels of the frames in the window
+struct alignas(16) PhaseWeights {
+    std::array<float, window_size * 2> weights;
+};
 
 /// The Lanczos kernel
-static double Lanczos(std::size_t a, double x) {
+double Lanczos(std::size_t a, double x) {
     if (x == 0.0)
         return 1.0;
+    if (std::abs(x) >= static_cast<double>(a))
+        return 0.0;
     const double px = M_PI * x;
     return a * std::sin(px) * std::sin(px / a) / (px * px);
 }
 
-std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio) {
+/// Polyphase table of the weights, computed once so no trigonometry runs per sample
+const std::array<PhaseWeights, num_phases + 1>& GetSincTable() {
+    static const auto table = [] {
+        std::array<PhaseWeights, num_phases + 1> result{};
+        for (std::size_t phase = 0; phase <= num_phases; ++phase) {
+            const double pos = static_cast<double>(phase) / num_phases;
+            for (std::size_t k = 0; k < window_size; ++k) {
+                // The last frame of the window is the newest, the output moves from the frame
+                // lanczos_taps - 1 back from it to the next one as pos goes from 0 to 1
+                const double x = pos + InterpolationState::lanczos_taps - static_cast<double>(k);
+                const double weight = Lanczos(InterpolationState::lanczos_taps, x);
+                result[phase].weights[k * 2] = static_cast<float>(weight);
+                result[phase].weights[k * 2 + 1] = static_cast<float>(weight);
+            }
+        }
+        return result;
+    }();
+    return table;
+}
+
+s16 ClampToS16(float value) {
+    return static_cast<s16>(std::clamp(value, -32768.0f, 32767.0f));
+}
+
+/// Interpolates the stereo frame at pos of the window, which holds window_size frames
+std::array<float, 2> InterpolateSinc(const float* window, double pos) {
+    const auto& table = GetSincTable();
+    const float* weights =
+        table[static_cast<std::size_t>(pos * num_phases + 0.5)].weights.data();
+
+#ifdef ARCHITECTURE_x86_64
+    // Every vector holds two frames, so the left and right sums end up in alternate lanes
+    __m128 sum = _mm_setzero_ps();
+    for (std::size_t i = 0; i < window_size * 2; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(window + i), _mm_load_ps(weights + i)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    alignas(16) std::array<float, 4> result;
+    _mm_store_ps(result.data(), sum);
+    return {result[0], result[1]};
+#else
+    float l = 0.0f;
+    float r = 0.0f;
+    for (std::size_t i = 0; i < window_size * 2; i += 2) {
+        l += window[i] * weights[i];
+        r += window[i + 1] * weights[i + 1];
+    }
+    return {l, r};
+#endif
+}
+
+std::array<float, 2> InterpolateCubic(const float* window, double pos) {
+    // Catmull-Rom spline through the four frames around the position
+    const auto t = static_cast<float>(pos);
+    const float w0 = ((-t + 2.0f) * t - 1.0f) * t * 0.5f;
+    const float w1 = ((3.0f * t - 5.0f) * t * t + 2.0f) * 0.5f;
+    const float w2 = ((-3.0f * t + 4.0f) * t + 1.0f) * t * 0.5f;
+    const float w3 = (t - 1.0f) * t * t * 0.5f;
+    const float* p = window + (InterpolationState::lanczos_taps - 1) * 2;
+    return {w0 * p[0] + w1 * p[2] + w2 * p[4] + w3 * p[6],
+            w0 * p[1] + w1 * p[3] + w2 * p[5] + w3 * p[7]};
+}
+
+std::array<float, 2> InterpolateLinear(const float* window, double pos) {
+    const auto t = static_cast<float>(pos);
+    const float* p = window + InterpolationState::lanczos_taps * 2;
+    return {p[0] + (p[2] - p[0]) * t, p[1] + (p[3] - p[1]) * t};
+}
+
+} // Anonymous namespace
+
+void Interpolate(InterpolationState& state, std::vector<s16>& input, std::vector<s16>& output,
+                 double ratio, ResamplingQuality quality) {
+    output.clear();
     if (input.size() < 2)
-        return {};
+        return;
 
     if (ratio <= 0) {
         LOG_CRITICAL(Audio, "Nonsensical interpolation ratio {}", ratio);
         ratio = 1.0;
     }
 
-    if (ratio != state.current_ratio) {
-        const double cutoff_frequency = std::min(0.5 / ratio, 0.5 * ratio);
-        state.nyquist = CascadingFilter::LowPass(std::clamp(cutoff_frequency, 0.0, 0.4), 3);
-        state.current_ratio = ratio;
+    // The cheaper qualities don't filter, the biquads cost more than their interpolation
+    if (quality == ResamplingQuality::Sinc) {
+        if (ratio != state.current_ratio) {
+            const double cutoff_frequency = std::min(0.5 / ratio, 0.5 * ratio);
+            state.nyquist = CascadingFilter::LowPass(std::clamp(cutoff_frequency, 0.0, 0.4), 3);
+            state.current_ratio = ratio;
+        }
+        state.nyquist.Process(input);
     }
-    state.nyquist.Process(input);
 
-    constexpr std::size_t taps = InterpolationState::lanczos_taps;
+    // The frames are converted once, each output then reads its window straight from them
     const std::size_t num_frames = input.size() / 2;
+    auto& frames = state.frames;
+    frames.resize((history_size + num_frames) * 2);
+    std::transform(input.begin(), input.begin() + num_frames * 2,
+                   frames.begin() + history_size * 2,
+                   [](s16 sample) { return static_cast<float>(sample); });
 
-    std::vector<s16> output;
     output.reserve(static_cast<std::size_t>(input.size() / ratio + 4));
 
     double& pos = state.position;
-    auto& h = state.history;
     for (std::size_t i = 0; i < num_frames; ++i) {
-        std::rotate(h.begin(), h.end() - 1, h.end());
-        h[0][0] = input[i * 2 + 0];
-        h[0][1] = input[i * 2 + 1];
-
+        const float* window = frames.data() + i * 2;
         while (pos <= 1.0) {
-            double l = 0.0;
-            double r = 0.0;
-            for (std::size_t j = 0; j < h.size(); j++) {
-                const double lanczos_calc = Lanczos(taps, pos + j - taps + 1);
-                l += lanczos_calc * h[j][0];
-                r += lanczos_calc * h[j][1];
+            std::array<float, 2> frame;
+            switch (quality) {
+            case ResamplingQuality::Linear:
+                frame = InterpolateLinear(window, pos);
+                break;
+            case ResamplingQuality::Cubic:
+                frame = InterpolateCubic(window, pos);
+                break;
+            default:
+                frame = InterpolateSinc(window, pos);
+                break;
             }
-            output.emplace_back(static_cast<s16>(std::clamp(l, -32768.0, 32767.0)));
-            output.emplace_back(static_cast<s16>(std::clamp(r, -32768.0, 32767.0)));
+            output.push_back(ClampToS16(frame[0]));
+            output.push_back(ClampToS16(frame[1]));
 
             pos += ratio;
         }
         pos -= 1.0;
     }
 
-    return output;
+    // Keep the newest frames as the history of the next input
+    std::copy(frames.end() - history_size * 2, frames.end(), frames.begin());
+    frames.resize(history_size * 2);
 }
 
 } // namespace AudioCore
@@ -4,40 +4,51 @@
 
 #pragma once
 
-#include <array>
 #include <vector>
 #include "audio_core/algorithm/filter.h"
 #include "common/common_types.h"
 
 namespace AudioCore {
 
+/// Interpolation used to resample, the cheaper ones are for hosts that can't keep up with sinc
+enum class ResamplingQuality : u32 {
+    Linear = 0,
+    Cubic = 1,
+    Sinc = 2, ///< Lanczos windowed sinc with an anti-aliasing filter
+};
+
 struct InterpolationState {
     static constexpr std::size_t lanczos_taps = 4;
-    static constexpr std::size_t history_size = lanczos_taps * 2 - 1;
+    /// Frames around the output position that are read to interpolate it
+    static constexpr std::size_t window_size = lanczos_taps * 2;
+    static constexpr std::size_t history_size = window_size - 1;
 
     double current_ratio = 0.0;
     CascadingFilter nyquist;
-    std::array<std::array<s16, 2>, history_size> history = {};
+    /// Stereo frames of the previous input followed by the ones being interpolated
+    std::vector<float> frames;
     double position = 0;
 };
 
 /// Interpolates input signal to produce output signal.
-/// @param input The signal to interpolate.
+/// @param input The signal to interpolate, the sinc quality low-pass filters it in place.
+/// @param output Receives the output signal, its memory is reused.
 /// @param ratio Interpolation ratio.
 ///              ratio > 1.0 results in fewer output samples.
 ///              ratio < 1.0 results in more output samples.
-/// @returns Output signal.
-std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio);
+void Interpolate(InterpolationState& state, std::vector<s16>& input, std::vector<s16>& output,
+                 double ratio, ResamplingQuality quality = ResamplingQuality::Sinc);
 
 /// Interpolates input signal to produce output signal.
-/// @param input The signal to interpolate.
+/// @param input The signal to interpolate, the sinc quality low-pass filters it in place.
+/// @param output Receives the output signal, its memory is reused.
 /// @param input_rate The sample rate of input.
 /// @param output_rate The desired sample rate of the output.
-/// @returns Output signal.
-inline std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
-                                    u32 input_rate, u32 output_rate) {
+inline void Interpolate(InterpolationState& state, std::vector<s16>& input,
+                        std::vector<s16>& output, u32 input_rate, u32 output_rate,
+                        ResamplingQuality quality = ResamplingQuality::Sinc) {
     const double ratio = static_cast<double>(input_rate) / static_cast<double>(output_rate);
-    return Interpolate(state, std::move(input), ratio);
+    Interpolate(state, input, output, ratio, quality);
 }
 
 } // namespace AudioCore
@@ -0,0 +1,171 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/algorithm/mix.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/simd.h"
+#endif
+
+namespace AudioCore {
+namespace {
+
+void AccumulateSamplesScalar(float* dest, const s16* src, std::size_t count, float volume) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dest[i] += static_cast<float>(src[i]) * volume;
+    }
+}
+
+void AccumulateFloatSamplesScalar(float* dest, const float* src, std::size_t count,
+                                  float volume) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dest[i] += src[i] * volume;
+    }
+}
+
+void ScaleSamplesScalar(float* samples, std::size_t count, float gain) {
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+void ConvertToS16Scalar(s16* dest, const float* src, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        dest[i] = static_cast<s16>(std::lrint(std::clamp(src[i], -32768.0f, 32767.0f)));
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+std::size_t AccumulateSamplesSSE2(float* dest, const s16* src, std::size_t count, float volume) {
+    const __m128 scale = _mm_set1_ps(volume);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Sign extend the samples to 32 bits by placing them in the upper halves of the lanes
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        const __m128 mix_low = _mm_add_ps(_mm_loadu_ps(dest + i),
+                                          _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        const __m128 mix_high = _mm_add_ps(_mm_loadu_ps(dest + i + 4),
+                                           _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+        _mm_storeu_ps(dest + i, mix_low);
+        _mm_storeu_ps(dest + i + 4, mix_high);
+    }
+    return i;
+}
+
+AVX2_TARGET std::size_t AccumulateSamplesAVX2(float* dest, const s16* src, std::size_t count,
+                                              float volume) {
+    const __m256 scale = _mm256_set1_ps(volume);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i low =
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        const __m256i high =
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+        const __m256 mix_low = _mm256_add_ps(_mm256_loadu_ps(dest + i),
+                                             _mm256_mul_ps(_mm256_cvtepi32_ps(low), scale));
+        const __m256 mix_high = _mm256_add_ps(_mm256_loadu_ps(dest + i + 8),
+                                              _mm256_mul_ps(_mm256_cvtepi32_ps(high), scale));
+        _mm256_storeu_ps(dest + i, mix_low);
+        _mm256_storeu_ps(dest + i + 8, mix_high);
+    }
+    return i;
+}
+
+std::size_t AccumulateFloatSamplesSSE2(float* dest, const float* src, std::size_t count,
+                                       float volume) {
+    const __m128 scale = _mm_set1_ps(volume);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 mix_low = _mm_add_ps(_mm_loadu_ps(dest + i),
+                                          _mm_mul_ps(_mm_loadu_ps(src + i), scale));
+        const __m128 mix_high = _mm_add_ps(_mm_loadu_ps(dest + i + 4),
+                                           _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+        _mm_storeu_ps(dest + i, mix_low);
+        _mm_storeu_ps(dest + i + 4, mix_high);
+    }
+    return i;
+}
+
+std::size_t ScaleSamplesSSE2(float* samples, std::size_t count, float gain) {
+    const __m128 scale = _mm_set1_ps(gain);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+        _mm_storeu_ps(samples + i + 4, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), scale));
+    }
+    return i;
+}
+
+std::size_t ConvertToS16SSE2(s16* dest, const float* src, std::size_t count) {
+    // The conversion rounds to nearest, the pack saturates to the range of s16. Values too large
+    // for s32 become INT32_MIN, they are clamped before the conversion.
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), min), max);
+        const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), min), max);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), packed);
+    }
+    return i;
+}
+
+#endif
+
+} // Anonymous namespace
+
+void AccumulateSamples(float* dest, const s16* src, std::size_t count, float volume) {
+    std::size_t done = 0;
+#ifdef ARCHITECTURE_x86_64
+    done = Common::HasAVX2() ? AccumulateSamplesAVX2(dest, src, count, volume)
+                             : AccumulateSamplesSSE2(dest, src, count, volume);
+#endif
+    AccumulateSamplesScalar(dest + done, src + done, count - done, volume);
+}
+
+void AccumulateSamples(float* dest, const float* src, std::size_t count, float volume) {
+    std::size_t done = 0;
+#ifdef ARCHITECTURE_x86_64
+    done = AccumulateFloatSamplesSSE2(dest, src, count, volume);
+#endif
+    AccumulateFloatSamplesScalar(dest + done, src + done, count - done, volume);
+}
+
+void ScaleSamples(float* samples, std::size_t count, float gain) {
+    std::size_t done = 0;
+#ifdef ARCHITECTURE_x86_64
+    done = ScaleSamplesSSE2(samples, count, gain);
+#endif
+    ScaleSamplesScalar(samples + done, count - done, gain);
+}
+
+void DeinterleaveStereo(float* left, float* right, const float* src, std::size_t num_frames) {
+    for (std::size_t frame = 0; frame < num_frames; ++frame) {
+        left[frame] = src[frame * 2];
+        right[frame] = src[frame * 2 + 1];
+    }
+}
+
+void InterleaveStereo(float* dest, const float* left, const float* right, std::size_t num_frames) {
+    for (std::size_t frame = 0; frame < num_frames; ++frame) {
+        dest[frame * 2] = left[frame];
+        dest[frame * 2 + 1] = right[frame];
+    }
+}
+
+void ConvertToS16(s16* dest, const float* src, std::size_t count) {
+    std::size_t done = 0;
+#ifdef ARCHITECTURE_x86_64
+    done = ConvertToS16SSE2(dest, src, count);
+#endif
+    ConvertToS16Scalar(dest + done, src + done, count - done);
+}
+
+} // namespace AudioCore
@@ -0,0 +1,36 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Scales samples by a volume and adds them to a mix buffer.
+ * @param dest Mix buffer with at least count samples
+ * @param src Samples to add to the mix
+ * @param count Number of samples, the channels of a frame count separately
+ * @param volume Volume of the samples, 1.0 plays them as is
+ */
+void AccumulateSamples(float* dest, const s16* src, std::size_t count, float volume);
+
+/// Scales float samples by a volume and adds them to a mix buffer, see the PCM16 version
+void AccumulateSamples(float* dest, const float* src, std::size_t count, float volume);
+
+/// Multiplies samples by a gain in place
+void ScaleSamples(float* samples, std::size_t count, float gain);
+
+/// Splits interleaved stereo frames into one buffer per channel
+void DeinterleaveStereo(float* left, float* right, const float* src, std::size_t num_frames);
+
+/// Joins one buffer per channel into interleaved stereo frames
+void InterleaveStereo(float* dest, const float* left, const float* right, std::size_t num_frames);
+
+/// Rounds the samples of a mix buffer to PCM16, saturating the ones that are out of range
+void ConvertToS16(s16* dest, const float* src, std::size_t count);
+
+} // namespace AudioCore
@@ -2,20 +2,77 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include "audio_core/algorithm/effects.h"
 #include "audio_core/algorithm/interpolate.h"
+#include "audio_core/algorithm/mix.h"
 #include "audio_core/audio_out.h"
 #include "audio_core/audio_renderer.h"
 #include "audio_core/codec.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/hle/kernel/writable_event.h"
 #include "core/memory.h"
+#include "core/settings.h"
+
+MICROPROFILE_DEFINE(Audio_Update, "Audio", "Renderer Update", MP_RGB(64, 128, 192));
+MICROPROFILE_DEFINE(Audio_Decode, "Audio", "Voice Decode", MP_RGB(192, 128, 64));
+MICROPROFILE_DEFINE(Audio_Resample, "Audio", "Voice Resample", MP_RGB(192, 192, 64));
+MICROPROFILE_DEFINE(Audio_Mix, "Audio", "Mix", MP_RGB(64, 192, 128));
+MICROPROFILE_DEFINE(Audio_Effects, "Audio", "Effects", MP_RGB(128, 64, 192));
+MICROPROFILE_DEFINE(Audio_SinkEnqueue, "Audio", "Sink Enqueue", MP_RGB(192, 64, 128));
 
 namespace AudioCore {
 
 constexpr u32 STREAM_SAMPLE_RATE{48000};
 constexpr u32 STREAM_NUM_CHANNELS{2};
+constexpr std::size_t MIX_BUFFER_FRAMES{512};
+constexpr std::size_t LOW_LATENCY_MIX_BUFFER_FRAMES{256};
+
+/// Returns the number of frames of each mixed buffer. Three buffers are kept queued to the stream,
+/// so this sets most of the latency of the renderer.
+static std::size_t GetMixBufferFrames() {
+    return Settings::values.enable_low_latency_audio ? LOW_LATENCY_MIX_BUFFER_FRAMES
+                                                     : MIX_BUFFER_FRAMES;
+}
+
+static ResamplingQuality GetResamplingQuality() {
+    const auto quality = static_cast<ResamplingQuality>(Settings::values.resampling_quality);
+    switch (quality) {
+    case ResamplingQuality::Linear:
+    case ResamplingQuality::Cubic:
+    case ResamplingQuality::Sinc:
+        return quality;
+    default:
+        LOG_ERROR(Audio, "Invalid resampling quality={}", Settings::values.resampling_quality);
+        return ResamplingQuality::Sinc;
+    }
+}
+
+/// Converts a gain of the effect parameters, they are fixed point with 14 fractional bits
+static float FromFixedPoint(s32 value) {
+    return static_cast<float>(value) / (1 << 14);
+}
+
+/// Adds the time taken by its scope to a stage of the renderer
+class StageTimer {
+public:
+    StageTimer(Core::AudioStageTimes& stage_times, Core::AudioStage stage)
+        : time{stage_times[static_cast<std::size_t>(stage)]}, start{Clock::now()} {}
+
+    ~StageTimer() {
+        time += Clock::now() - start;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::nanoseconds& time;
+    Clock::time_point start;
+};
 
 class AudioRenderer::VoiceState {
 public:
@@ -36,11 +93,15 @@ public:
     }
 
     void SetWaveIndex(std::size_t index);
-    std::vector<s16> DequeueSamples(std::size_t sample_count);
+    void MixSamples(float* buffer, std::size_t frame_count, ADPCMCache& adpcm_cache,
+                    Core::AudioStageTimes& stage_times);
     void UpdateState();
-    void RefreshBuffer();
+    void RefreshBuffer(ADPCMCache& adpcm_cache, Core::AudioStageTimes& stage_times);
 
 private:
+    /// Reads and decodes the current wave buffer into samples, at the rate of the voice
+    void RefreshSamples(ADPCMCache& adpcm_cache, Core::AudioStageTimes& stage_times);
+
     bool is_in_use{};
     bool is_refresh_pending{};
     std::size_t wave_index{};
@@ -48,6 +109,7 @@ private:
     Codec::ADPCMState adpcm_state{};
     InterpolationState interp_state{};
     std::vector<s16> samples;
+    std::vector<s16> wave_data; ///< Wave buffer being decoded, kept to reuse its memory
     VoiceOutStatus out_status{};
     VoiceInfo info{};
 };
@@ -66,28 +128,68 @@ public:
         return info;
     }
 
+    /// Returns true if the effect changes the mix, disabled effects still route their channels
+    bool IsInUse() const {
+        return info.type != Effect::None;
+    }
+
     void UpdateState();
 
+    /**
+     * Applies the effect to a block of the final mix.
+     * @param channels Samples of each channel of the mix, indexed by mix buffer
+     * @param num_frames Number of samples of each channel
+     */
+    void Process(const std::array<float*, STREAM_NUM_CHANNELS>& channels, std::size_t num_frames);
+
 private:
+    /// Returns the channel of the mix of a mix buffer index, or nullptr if it isn't mixed
+    static float* GetChannel(const std::array<float*, STREAM_NUM_CHANNELS>& channels, s32 index);
+
+    /// Sends the input channels to the guest and replaces the output ones with what it returned
+    void ProcessAux(const std::array<float*, STREAM_NUM_CHANNELS>& channels,
+                    std::size_t num_frames);
+
     EffectOutStatus out_status{};
     EffectInStatus info{};
+    DelayEffect delay;
+    ReverbEffect reverb;
+    std::vector<float> samples; ///< Channel being processed
+    std::vector<s32> aux_samples;
 };
-AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendererParameter params,
+AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, Core::PerfStats& perf_stats,
+                             AudioRendererParameter params,
                              Kernel::SharedPtr<Kernel::WritableEvent> buffer_event)
-    : worker_params{params}, buffer_event{buffer_event}, voices(params.voice_count),
-      effects(params.effect_count) {
+    : worker_params{params}, perf_stats{perf_stats}, buffer_event{buffer_event},
+      voices(params.voice_count), effects(params.effect_count),
+      mix_buffer(GetMixBufferFrames() * STREAM_NUM_CHANNELS), voice_status(params.voice_count),
+      effect_status(params.effect_count) {
+
+    for (auto* snapshot : {&update_params, &pending_params, &applied_params}) {
+        snapshot->voices.resize(params.voice_count);
+        snapshot->effects.resize(params.effect_count);
+    }
 
     audio_out = std::make_unique<AudioCore::AudioOut>();
     stream = audio_out->OpenStream(core_timing, STREAM_SAMPLE_RATE, STREAM_NUM_CHANNELS,
-                                   "AudioRenderer", [=]() { buffer_event->Signal(); });
+                                   "AudioRenderer", [this]() { OnBufferReleased(); });
     audio_out->StartStream(stream);
 
     QueueMixedBuffer(0);
     QueueMixedBuffer(1);
     QueueMixedBuffer(2);
+
+    dsp_thread = std::thread{&AudioRenderer::DspLoop, this};
 }
 
-AudioRenderer::~AudioRenderer() = default;
+AudioRenderer::~AudioRenderer() {
+    {
+        std::lock_guard lock{mutex};
+        stop_dsp = true;
+    }
+    dsp_condition.notify_one();
+    dsp_thread.join();
+}
 
 u32 AudioRenderer::GetSampleRate() const {
     return worker_params.sample_rate;
@@ -101,66 +203,80 @@ u32 AudioRenderer::GetMixBufferCount() const {
     return worker_params.mix_buffer_count;
 }
 
+std::optional<std::chrono::microseconds> AudioRenderer::GetOutputLatency() const {
+    return stream->GetOutputLatency();
+}
+
 Stream::State AudioRenderer::GetStreamState() const {
     return stream->GetState();
 }
 
-std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_params) {
+std::vector<u8> AudioRenderer::UpdateAudioRenderer(const u8* input_params) {
+    MICROPROFILE_SCOPE(Audio_Update);
+    const auto update_start = std::chrono::steady_clock::now();
+
     // Copy UpdateDataHeader struct
     UpdateDataHeader config{};
-    std::memcpy(&config, input_params.data(), sizeof(UpdateDataHeader));
+    std::memcpy(&config, input_params, sizeof(UpdateDataHeader));
     u32 memory_pool_count = worker_params.effect_count + (worker_params.voice_count * 4);
 
     // Copy MemoryPoolInfo structs
     std::vector<MemoryPoolInfo> mem_pool_info(memory_pool_count);
     std::memcpy(mem_pool_info.data(),
-                input_params.data() + sizeof(UpdateDataHeader) + config.behavior_size,
+                input_params + sizeof(UpdateDataHeader) + config.behavior_size,
                 memory_pool_count * sizeof(MemoryPoolInfo));
 
     // Copy VoiceInfo structs
     std::size_t voice_offset{sizeof(UpdateDataHeader) + config.behavior_size +
                              config.memory_pools_size + config.voice_resource_size};
-    for (auto& voice : voices) {
-        std::memcpy(&voice.GetInfo(), input_params.data() + voice_offset, sizeof(VoiceInfo));
+    for (auto& voice_info : update_params.voices) {
+        std::memcpy(&voice_info, input_params + voice_offset, sizeof(VoiceInfo));
         voice_offset += sizeof(VoiceInfo);
     }
 
     std::size_t effect_offset{sizeof(UpdateDataHeader) + config.behavior_size +
                               config.memory_pools_size + config.voice_resource_size +
                               config.voices_size};
-    for (auto& effect : effects) {
-        std::memcpy(&effect.GetInfo(), input_params.data() + effect_offset, sizeof(EffectInStatus));
+    for (auto& effect_info : update_params.effects) {
+        std::memcpy(&effect_info, input_params + effect_offset, sizeof(EffectInStatus));
         effect_offset += sizeof(EffectInStatus);
     }
 
     // Update memory pool state
     std::vector<MemoryPoolEntry> memory_pool(memory_pool_count);
+    update_params.detached_pools.clear();
     for (std::size_t index = 0; index < memory_pool.size(); ++index) {
         if (mem_pool_info[index].pool_state == MemoryPoolStates::RequestAttach) {
             memory_pool[index].state = MemoryPoolStates::Attached;
         } else if (mem_pool_info[index].pool_state == MemoryPoolStates::RequestDetach) {
             memory_pool[index].state = MemoryPoolStates::Detached;
+            update_params.detached_pools.emplace_back(mem_pool_info[index].pool_address,
+                                                      mem_pool_info[index].pool_size);
         }
     }
 
-    // Update voices
-    for (auto& voice : voices) {
-        voice.UpdateState();
-        if (!voice.GetInfo().is_in_use) {
-            continue;
-        }
-        if (voice.GetInfo().is_new) {
-            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
+    // Hand the parameters to the DSP thread, they are applied before its next mix. The lock is
+    // only held to swap the snapshots, the guest thread never waits for a mix.
+    {
+        std::lock_guard lock{mutex};
+        if (has_pending_params) {
+            // The previous update was not applied yet, its new voices and effects are still new
+            for (std::size_t i = 0; i < update_params.voices.size(); ++i) {
+                update_params.voices[i].is_new |= pending_params.voices[i].is_new;
+            }
+            for (std::size_t i = 0; i < update_params.effects.size(); ++i) {
+                update_params.effects[i].is_new |= pending_params.effects[i].is_new;
+            }
+            update_params.detached_pools.insert(update_params.detached_pools.end(),
+                                                pending_params.detached_pools.begin(),
+                                                pending_params.detached_pools.end());
         }
+        std::swap(update_params, pending_params);
+        has_pending_params = true;
+        update_voice_status = voice_status;
+        update_effect_status = effect_status;
     }
 
-    for (auto& effect : effects) {
-        effect.UpdateState();
-    }
-
-    // Release previous buffers and queue next ones for playback
-    ReleaseAndQueueBuffers();
-
     // Copy output header
     UpdateDataHeader response_data{worker_params};
     std::vector<u8> output_params(response_data.total_size);
@@ -172,8 +288,8 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
 
     // Copy output voice status
     std::size_t voice_out_status_offset{sizeof(UpdateDataHeader) + response_data.memory_pools_size};
-    for (const auto& voice : voices) {
-        std::memcpy(output_params.data() + voice_out_status_offset, &voice.GetOutStatus(),
+    for (const auto& status : update_voice_status) {
+        std::memcpy(output_params.data() + voice_out_status_offset, &status,
                     sizeof(VoiceOutStatus));
         voice_out_status_offset += sizeof(VoiceOutStatus);
     }
@@ -181,11 +297,16 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
     std::size_t effect_out_status_offset{
         sizeof(UpdateDataHeader) + response_data.memory_pools_size + response_data.voices_size +
         response_data.voice_resource_size};
-    for (const auto& effect : effects) {
-        std::memcpy(output_params.data() + effect_out_status_offset, &effect.GetOutStatus(),
+    for (const auto& status : update_effect_status) {
+        std::memcpy(output_params.data() + effect_out_status_offset, &status,
                     sizeof(EffectOutStatus));
         effect_out_status_offset += sizeof(EffectOutStatus);
     }
+
+    Core::AudioStageTimes update_time{};
+    update_time[static_cast<std::size_t>(Core::AudioStage::Update)] =
+        std::chrono::steady_clock::now() - update_start;
+    perf_stats.AddAudioStats(update_time, 0, 0);
     return output_params;
 }
 
@@ -194,41 +315,44 @@ void AudioRenderer::VoiceState::SetWaveIndex(std::size_t index) {
     is_refresh_pending = true;
 }
 
-std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_count) {
-    if (!IsPlaying()) {
-        return {};
-    }
+void AudioRenderer::VoiceState::MixSamples(float* buffer, std::size_t frame_count,
+                                           ADPCMCache& adpcm_cache,
+                                           Core::AudioStageTimes& stage_times) {
+    const float volume = info.volume;
+    std::size_t remaining{frame_count * STREAM_NUM_CHANNELS};
+    while (remaining > 0 && IsPlaying()) {
+        if (is_refresh_pending) {
+            RefreshBuffer(adpcm_cache, stage_times);
+        }
 
-    if (is_refresh_pending) {
-        RefreshBuffer();
-    }
+        const std::size_t size{std::min(remaining, samples.size() - offset)};
+        AccumulateSamples(buffer, samples.data() + offset, size, volume);
+        buffer += size;
+        remaining -= size;
 
-    const std::size_t max_size{samples.size() - offset};
-    const std::size_t dequeue_offset{offset};
-    std::size_t size{sample_count * STREAM_NUM_CHANNELS};
-    if (size > max_size) {
-        size = max_size;
-    }
+        out_status.played_sample_count += size / STREAM_NUM_CHANNELS;
+        offset += size;
 
-    out_status.played_sample_count += size / STREAM_NUM_CHANNELS;
-    offset += size;
+        const auto& wave_buffer{info.wave_buffer[wave_index]};
+        if (offset == samples.size()) {
+            offset = 0;
 
-    const auto& wave_buffer{info.wave_buffer[wave_index]};
-    if (offset == samples.size()) {
-        offset = 0;
+            if (!wave_buffer.is_looping) {
+                SetWaveIndex(wave_index + 1);
+            }
 
-        if (!wave_buffer.is_looping) {
-            SetWaveIndex(wave_index + 1);
-        }
+            out_status.wave_buffer_consumed++;
 
-        out_status.wave_buffer_consumed++;
+            if (wave_buffer.end_of_stream) {
+                info.play_state = PlayState::Paused;
+            }
+        }
 
-        if (wave_buffer.end_of_stream) {
-            info.play_state = PlayState::Paused;
+        if (size == 0) {
+            // Empty wave buffers are consumed one per mix
+            break;
         }
     }
-
-    return {samples.begin() + dequeue_offset, samples.begin() + dequeue_offset + size};
 }
 
 void AudioRenderer::VoiceState::UpdateState() {
@@ -242,10 +366,31 @@ void AudioRenderer::VoiceState::UpdateState() {
     is_in_use = info.is_in_use;
 }
 
-void AudioRenderer::VoiceState::RefreshBuffer() {
-    std::vector<s16> new_samples(info.wave_buffer[wave_index].buffer_sz / sizeof(s16));
+void AudioRenderer::VoiceState::RefreshBuffer(ADPCMCache& adpcm_cache,
+                                              Core::AudioStageTimes& stage_times) {
+    RefreshSamples(adpcm_cache, stage_times);
+
+    // Only interpolate when necessary, expensive.
+    if (GetInfo().sample_rate != STREAM_SAMPLE_RATE) {
+        MICROPROFILE_SCOPE(Audio_Resample);
+        const StageTimer timer{stage_times, Core::AudioStage::Resample};
+        Interpolate(interp_state, samples, wave_data, GetInfo().sample_rate, STREAM_SAMPLE_RATE,
+                    GetResamplingQuality());
+        samples.swap(wave_data);
+    }
+
+    is_refresh_pending = false;
+}
+
+void AudioRenderer::VoiceState::RefreshSamples(ADPCMCache& adpcm_cache,
+                                               Core::AudioStageTimes& stage_times) {
+    MICROPROFILE_SCOPE(Audio_Decode);
+    const StageTimer timer{stage_times, Core::AudioStage::Decode};
+
+    auto& new_samples = wave_data;
+    new_samples.resize(info.wave_buffer[wave_index].buffer_sz / sizeof(s16));
     Memory::ReadBlock(info.wave_buffer[wave_index].buffer_addr, new_samples.data(),
-                      info.wave_buffer[wave_index].buffer_sz);
+                      new_samples.size() * sizeof(s16));
 
     switch (static_cast<Codec::PcmFormat>(info.sample_format)) {
     case Codec::PcmFormat::Int16: {
@@ -253,11 +398,13 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
         break;
     }
     case Codec::PcmFormat::Adpcm: {
-        // Decode ADPCM to PCM16
+        // Decode ADPCM to PCM16, sound effects replaying the same buffer are only decoded once
         Codec::ADPCM_Coeff coeffs;
         Memory::ReadBlock(info.additional_params_addr, coeffs.data(), sizeof(Codec::ADPCM_Coeff));
-        new_samples = Codec::DecodeADPCM(reinterpret_cast<u8*>(new_samples.data()),
-                                         new_samples.size() * sizeof(s16), coeffs, adpcm_state);
+        const auto& decoded = adpcm_cache.Decode(
+            info.wave_buffer[wave_index].buffer_addr, reinterpret_cast<u8*>(new_samples.data()),
+            new_samples.size() * sizeof(s16), coeffs, adpcm_state);
+        new_samples.assign(decoded.begin(), decoded.end());
         break;
     }
     default:
@@ -275,75 +422,254 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
         }
         break;
     case 2: {
-        // 2 channel is played as is
-        samples = std::move(new_samples);
+        // 2 channel is played as is, the buffers are swapped to keep both allocations
+        samples.swap(new_samples);
         break;
     }
     default:
         UNIMPLEMENTED_MSG("Unimplemented channel_count={}", info.channel_count);
         break;
     }
-
-    // Only interpolate when necessary, expensive.
-    if (GetInfo().sample_rate != STREAM_SAMPLE_RATE) {
-        samples = Interpolate(interp_state, std::move(samples), GetInfo().sample_rate,
-                              STREAM_SAMPLE_RATE);
-    }
-
-    is_refresh_pending = false;
 }
 
 void AudioRenderer::EffectState::UpdateState() {
     if (info.is_new) {
         out_status.state = EffectStatus::New;
-    } else {
-        if (info.type == Effect::Aux) {
-            ASSERT_MSG(Memory::Read32(info.aux_info.return_buffer_info) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.send_buffer_info) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.return_buffer_base) == 0,
-                       "Aux buffers tried to update");
-            ASSERT_MSG(Memory::Read32(info.aux_info.send_buffer_base) == 0,
-                       "Aux buffers tried to update");
-        }
+        delay.Clear();
+        reverb.Clear();
+    }
+
+    // Reconfiguring is cheap, the delay lines are only reallocated when their length changes
+    switch (info.type) {
+    case Effect::Delay: {
+        const auto& params = info.delay_params;
+        const auto to_samples = [](u32 ms) {
+            return static_cast<std::size_t>(u64{ms} * STREAM_SAMPLE_RATE / 1000);
+        };
+        delay.Configure({
+            to_samples(params.max_delay_ms),
+            to_samples(params.delay_ms),
+            FromFixedPoint(params.in_gain),
+            FromFixedPoint(params.feedback_gain),
+            FromFixedPoint(params.out_gain),
+            FromFixedPoint(params.dry_gain),
+            FromFixedPoint(params.lowpass_amount),
+        });
+        break;
+    }
+    case Effect::Reverb: {
+        const auto& params = info.reverb_params;
+        reverb.Configure(STREAM_SAMPLE_RATE,
+                         {
+                             static_cast<std::size_t>(u64{params.pre_delay_ms} *
+                                                      STREAM_SAMPLE_RATE / 1000),
+                             FromFixedPoint(params.early_gain),
+                             FromFixedPoint(params.late_gain),
+                             params.decay_time_ms / 1000.0f,
+                             FromFixedPoint(params.high_freq_decay_ratio),
+                             FromFixedPoint(params.colouration),
+                             FromFixedPoint(params.base_gain),
+                             FromFixedPoint(params.wet_gain),
+                             FromFixedPoint(params.dry_gain),
+                         });
+        break;
+    }
+    default:
+        break;
     }
 }
 
-static constexpr s16 ClampToS16(s32 value) {
-    return static_cast<s16>(std::clamp(value, -32768, 32767));
+float* AudioRenderer::EffectState::GetChannel(
+    const std::array<float*, STREAM_NUM_CHANNELS>& channels, s32 index) {
+    // Only the final mix is rendered, its channels are the first mix buffers
+    if (index < 0 || index >= static_cast<s32>(channels.size())) {
+        return nullptr;
+    }
+    return channels[index];
 }
 
-void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
-    constexpr std::size_t BUFFER_SIZE{512};
-    std::vector<s16> buffer(BUFFER_SIZE * stream->GetNumChannels());
+void AudioRenderer::EffectState::Process(const std::array<float*, STREAM_NUM_CHANNELS>& channels,
+                                         std::size_t num_frames) {
+    if (info.type == Effect::Aux) {
+        ProcessAux(channels, num_frames);
+        return;
+    }
+
+    const std::array<s8, 6>* inputs = nullptr;
+    const std::array<s8, 6>* outputs = nullptr;
+    std::size_t channel_count = 0;
+    switch (info.type) {
+    case Effect::Delay:
+        inputs = &info.delay_params.input_mix_buffers;
+        outputs = &info.delay_params.output_mix_buffers;
+        channel_count = info.delay_params.channel_count;
+        break;
+    case Effect::Reverb:
+        inputs = &info.reverb_params.input_mix_buffers;
+        outputs = &info.reverb_params.output_mix_buffers;
+        channel_count = info.reverb_params.channel_count;
+        break;
+    default:
+        LOG_DEBUG(Audio, "Unimplemented effect type={}, skipped", static_cast<u32>(info.type));
+        return;
+    }
 
-    for (auto& voice : voices) {
-        if (!voice.IsPlaying()) {
+    samples.resize(num_frames);
+    channel_count = std::min(channel_count, inputs->size());
+    for (std::size_t channel = 0; channel < channel_count; ++channel) {
+        const float* input = GetChannel(channels, (*inputs)[channel]);
+        float* output = GetChannel(channels, (*outputs)[channel]);
+        if (input == nullptr || output == nullptr) {
             continue;
         }
 
-        std::size_t offset{};
-        s64 samples_remaining{BUFFER_SIZE};
-        while (samples_remaining > 0) {
-            const std::vector<s16> samples{voice.DequeueSamples(samples_remaining)};
+        std::copy_n(input, num_frames, samples.data());
+        if (info.is_enabled && channel < STREAM_NUM_CHANNELS) {
+            if (info.type == Effect::Delay) {
+                delay.Process(channel, samples.data(), num_frames);
+            } else {
+                reverb.Process(channel, samples.data(), num_frames);
+            }
+        }
+        std::copy_n(samples.data(), num_frames, output);
+    }
+}
 
-            if (samples.empty()) {
-                break;
+void AudioRenderer::EffectState::ProcessAux(
+    const std::array<float*, STREAM_NUM_CHANNELS>& channels, std::size_t num_frames) {
+    const auto& params = info.aux_info;
+    const std::size_t capacity = params.sample_count;
+    if (!info.is_enabled || capacity == 0 || params.send_buffer_info == 0 ||
+        params.return_buffer_info == 0) {
+        return;
+    }
+
+    // The buffers are rings of s32 samples shared by the channels, which are written one after
+    // the other. The guest consumes the send buffer and fills the return buffer at its own pace.
+    const auto transfer = [capacity](VAddr base, u32 offset, void* data, std::size_t count,
+                                     bool is_write) {
+        auto* bytes = static_cast<u8*>(data);
+        while (count > 0) {
+            const std::size_t chunk = std::min<std::size_t>(count, capacity - offset);
+            const VAddr address = base + offset * sizeof(s32);
+            if (is_write) {
+                Memory::WriteBlock(address, bytes, chunk * sizeof(s32));
+            } else {
+                Memory::ReadBlock(address, bytes, chunk * sizeof(s32));
+            }
+            bytes += chunk * sizeof(s32);
+            count -= chunk;
+            offset = static_cast<u32>((offset + chunk) % capacity);
+        }
+    };
+
+    AuxBufferInfo send_info{};
+    AuxBufferInfo return_info{};
+    Memory::ReadBlock(params.send_buffer_info, &send_info, sizeof(send_info));
+    Memory::ReadBlock(params.return_buffer_info, &return_info, sizeof(return_info));
+    send_info.write_offset %= capacity;
+    return_info.read_offset %= capacity;
+
+    aux_samples.resize(num_frames);
+    const std::size_t channel_count =
+        std::min<std::size_t>(params.mix_buffer_count, params.input_mix_buffers.size());
+    for (std::size_t channel = 0; channel < channel_count; ++channel) {
+        const float* input = GetChannel(channels, params.input_mix_buffers[channel]);
+        if (input != nullptr) {
+            for (std::size_t i = 0; i < num_frames; ++i) {
+                aux_samples[i] = static_cast<s32>(
+                    std::clamp(input[i], -2147483648.0f, 2147483520.0f));
             }
+        } else {
+            std::fill(aux_samples.begin(), aux_samples.end(), 0);
+        }
+        transfer(params.send_buffer_base, send_info.write_offset, aux_samples.data(), num_frames,
+                 true);
+        send_info.write_offset = static_cast<u32>((send_info.write_offset + num_frames) % capacity);
+
+        // What the guest hasn't returned yet is silent
+        const std::size_t available =
+            std::min<std::size_t>(return_info.remaining, num_frames);
+        transfer(params.return_buffer_base, return_info.read_offset, aux_samples.data(),
+                 available, false);
+        std::fill(aux_samples.begin() + available, aux_samples.end(), 0);
+        return_info.read_offset =
+            static_cast<u32>((return_info.read_offset + available) % capacity);
+        return_info.remaining -= static_cast<u32>(available);
+
+        float* output = GetChannel(channels, params.output_mix_buffers[channel]);
+        if (output != nullptr) {
+            std::copy(aux_samples.begin(), aux_samples.end(), output);
+        }
+    }
 
-            samples_remaining -= samples.size() / stream->GetNumChannels();
+    send_info.remaining =
+        static_cast<u32>(std::min<std::size_t>(send_info.remaining + num_frames * channel_count,
+                                               capacity));
+    Memory::WriteBlock(params.send_buffer_info, &send_info, sizeof(send_info));
+    Memory::WriteBlock(params.return_buffer_info, &return_info, sizeof(return_info));
+}
 
-            for (const auto& sample : samples) {
-                const s32 buffer_sample{buffer[offset]};
-                buffer[offset++] =
-                    ClampToS16(buffer_sample + static_cast<s32>(sample * voice.GetInfo().volume));
+void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
+    const auto& decode_time = stage_times[static_cast<std::size_t>(Core::AudioStage::Decode)];
+    const auto& resample_time = stage_times[static_cast<std::size_t>(Core::AudioStage::Resample)];
+    const auto& effects_time = stage_times[static_cast<std::size_t>(Core::AudioStage::Effects)];
+    const auto nested_time = decode_time + resample_time + effects_time;
+
+    std::vector<s16> buffer(mix_buffer.size());
+    {
+        MICROPROFILE_SCOPE(Audio_Mix);
+        const StageTimer timer{stage_times, Core::AudioStage::Mix};
+
+        // Voices are mixed in float, so they are only saturated once they are all added together
+        std::fill(mix_buffer.begin(), mix_buffer.end(), 0.0f);
+        active_voices = 0;
+        for (auto& voice : voices) {
+            if (voice.IsPlaying()) {
+                voice.MixSamples(mix_buffer.data(), mix_buffer.size() / STREAM_NUM_CHANNELS,
+                                 adpcm_cache, stage_times);
+                ++active_voices;
             }
         }
+        ApplyEffects();
+        ConvertToS16(buffer.data(), mix_buffer.data(), buffer.size());
     }
+    // The voices are decoded, resampled and effected while they are mixed, that time has its own
+    // stages
+    stage_times[static_cast<std::size_t>(Core::AudioStage::Mix)] -=
+        decode_time + resample_time + effects_time - nested_time;
+    ++num_mixes;
+
+    MICROPROFILE_SCOPE(Audio_SinkEnqueue);
+    const StageTimer timer{stage_times, Core::AudioStage::SinkEnqueue};
     audio_out->QueueBuffer(stream, tag, std::move(buffer));
 }
 
+void AudioRenderer::ApplyEffects() {
+    const bool has_effects = std::any_of(effects.begin(), effects.end(),
+                                         [](const auto& effect) { return effect.IsInUse(); });
+    if (!has_effects) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(Audio_Effects);
+    const StageTimer timer{stage_times, Core::AudioStage::Effects};
+
+    // The effects work on one channel at a time, the delay lines are contiguous that way
+    const std::size_t num_frames = mix_buffer.size() / STREAM_NUM_CHANNELS;
+    for (auto& channel : effect_channels) {
+        channel.resize(num_frames);
+    }
+    auto& [left, right] = effect_channels;
+    DeinterleaveStereo(left.data(), right.data(), mix_buffer.data(), num_frames);
+    for (auto& effect : effects) {
+        if (effect.IsInUse()) {
+            effect.Process({left.data(), right.data()}, num_frames);
+        }
+    }
+    InterleaveStereo(mix_buffer.data(), left.data(), right.data(), num_frames);
+}
+
 void AudioRenderer::ReleaseAndQueueBuffers() {
     const auto released_buffers{audio_out->GetTagsAndReleaseBuffers(stream, 2)};
     for (const auto& tag : released_buffers) {
@@ -351,4 +677,74 @@ void AudioRenderer::ReleaseAndQueueBuffers() {
     }
 }
 
+void AudioRenderer::OnBufferReleased() {
+    // Runs on the thread of the stream, kernel objects can only be signaled from there
+    buffer_event->Signal();
+    {
+        std::lock_guard lock{mutex};
+        has_released_buffers = true;
+    }
+    dsp_condition.notify_one();
+}
+
+void AudioRenderer::ApplyParameters() {
+    // The memory of detached pools may be reused for other samples
+    for (const auto& [address, size] : applied_params.detached_pools) {
+        adpcm_cache.Invalidate(address, size);
+    }
+
+    for (std::size_t i = 0; i < voices.size(); ++i) {
+        auto& voice = voices[i];
+        voice.GetInfo() = applied_params.voices[i];
+        voice.UpdateState();
+        if (!voice.GetInfo().is_in_use) {
+            continue;
+        }
+        if (voice.GetInfo().is_new) {
+            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
+        }
+    }
+
+    MICROPROFILE_SCOPE(Audio_Effects);
+    const StageTimer timer{stage_times, Core::AudioStage::Effects};
+    for (std::size_t i = 0; i < effects.size(); ++i) {
+        effects[i].GetInfo() = applied_params.effects[i];
+        effects[i].UpdateState();
+    }
+}
+
+void AudioRenderer::DspLoop() {
+    Common::SetCurrentThreadName("yuzu:AudioRenderer");
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::Background);
+    std::unique_lock lock{mutex};
+    while (true) {
+        dsp_condition.wait(lock, [this] { return stop_dsp || has_released_buffers; });
+        if (stop_dsp) {
+            return;
+        }
+        has_released_buffers = false;
+        const bool has_new_params = has_pending_params;
+        if (has_new_params) {
+            std::swap(pending_params, applied_params);
+            has_pending_params = false;
+        }
+        lock.unlock();
+
+        if (has_new_params) {
+            ApplyParameters();
+        }
+        ReleaseAndQueueBuffers();
+        perf_stats.AddAudioStats(std::exchange(stage_times, {}), std::exchange(num_mixes, 0),
+                                 active_voices);
+
+        lock.lock();
+        for (std::size_t i = 0; i < voices.size(); ++i) {
+            voice_status[i] = voices[i].GetOutStatus();
+        }
+        for (std::size_t i = 0; i < effects.size(); ++i) {
+            effect_status[i] = effects[i].GetOutStatus();
+        }
+    }
+}
+
 } // namespace AudioCore
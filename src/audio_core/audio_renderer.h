@@ -5,14 +5,22 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "audio_core/adpcm_cache.h"
 #include "audio_core/stream.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/kernel/object.h"
+#include "core/perf_stats.h"
 
 namespace Core::Timing {
 class CoreTiming;
@@ -34,7 +42,11 @@ enum class PlayState : u8 {
 
 enum class Effect : u8 {
     None = 0,
+    BufferMixer = 1,
     Aux = 2,
+    Delay = 3,
+    Reverb = 4,
+    I3dl2Reverb = 5,
 };
 
 enum class EffectStatus : u8 {
@@ -158,6 +170,58 @@ struct AuxInfo {
 };
 static_assert(sizeof(AuxInfo) == 0x60, "AuxInfo is an invalid size");
 
+/// State of the ring buffers shared with the guest by an aux effect
+struct AuxBufferInfo {
+    u32_le read_offset;
+    u32_le write_offset;
+    u32_le remaining;
+    INSERT_PADDING_WORDS(13);
+};
+static_assert(sizeof(AuxBufferInfo) == 0x40, "AuxBufferInfo is an invalid size");
+
+/// Parameters of a delay effect, the gains are fixed point with 14 fractional bits
+struct DelayParams {
+    std::array<s8, 6> input_mix_buffers;
+    std::array<s8, 6> output_mix_buffers;
+    u16_le max_channels;
+    u16_le channel_count;
+    u32_le max_delay_ms;
+    u32_le delay_ms;
+    u32_le sample_rate;
+    s32_le in_gain;
+    s32_le feedback_gain;
+    s32_le out_gain;
+    s32_le dry_gain;
+    s32_le channel_spread;
+    s32_le lowpass_amount;
+    u8 state;
+    INSERT_PADDING_BYTES(3);
+};
+static_assert(sizeof(DelayParams) == 0x38, "DelayParams is an invalid size");
+
+/// Parameters of a reverb effect, the gains and ratios are fixed point with 14 fractional bits
+struct ReverbParams {
+    std::array<s8, 6> input_mix_buffers;
+    std::array<s8, 6> output_mix_buffers;
+    u16_le max_channels;
+    u16_le channel_count;
+    u32_le sample_rate;
+    u32_le early_mode;
+    s32_le early_gain;
+    u32_le pre_delay_ms;
+    u32_le late_mode;
+    s32_le late_gain;
+    u32_le decay_time_ms;
+    s32_le high_freq_decay_ratio;
+    s32_le colouration;
+    s32_le base_gain;
+    s32_le wet_gain;
+    s32_le dry_gain;
+    u8 state;
+    INSERT_PADDING_BYTES(3);
+};
+static_assert(sizeof(ReverbParams) == 0x44, "ReverbParams is an invalid size");
+
 struct EffectInStatus {
     Effect type;
     u8 is_new;
@@ -171,6 +235,8 @@ struct EffectInStatus {
     union {
         std::array<u8, 0xa0> raw;
         AuxInfo aux_info;
+        DelayParams delay_params;
+        ReverbParams reverb_params;
     };
 };
 static_assert(sizeof(EffectInStatus) == 0xc0, "EffectInStatus is an invalid size");
@@ -212,30 +278,84 @@ struct UpdateDataHeader {
 };
 static_assert(sizeof(UpdateDataHeader) == 0x40, "UpdateDataHeader has wrong size");
 
+/**
+ * Mixes the voices of an audio renderer on a host thread, like the ADSP of the Switch. The guest
+ * thread only parses the updates, the DSP thread applies them before its next mix and mixes a
+ * buffer each time the stream releases one.
+ */
 class AudioRenderer {
 public:
-    AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendererParameter params,
+    AudioRenderer(Core::Timing::CoreTiming& core_timing, Core::PerfStats& perf_stats,
+                  AudioRendererParameter params,
                   Kernel::SharedPtr<Kernel::WritableEvent> buffer_event);
     ~AudioRenderer();
 
-    std::vector<u8> UpdateAudioRenderer(const std::vector<u8>& input_params);
-    void QueueMixedBuffer(Buffer::Tag tag);
-    void ReleaseAndQueueBuffers();
+    std::vector<u8> UpdateAudioRenderer(const u8* input_params);
     u32 GetSampleRate() const;
     u32 GetSampleCount() const;
     u32 GetMixBufferCount() const;
     Stream::State GetStreamState() const;
 
+    /// Returns the measured time from a mix to it being heard, see Stream::GetOutputLatency
+    std::optional<std::chrono::microseconds> GetOutputLatency() const;
+
 private:
     class EffectState;
     class VoiceState;
 
+    /// Parameters of the voices and effects written by an update
+    struct ParameterSnapshot {
+        std::vector<VoiceInfo> voices;
+        std::vector<EffectInStatus> effects;
+        std::vector<std::pair<VAddr, u64>> detached_pools; ///< Address and size of each pool
+    };
+
+    /// Wakes up the DSP thread, runs on the thread of the stream
+    void OnBufferReleased();
+
+    /// Copies the parameters of the last update to the voices and effects, runs on the DSP thread
+    void ApplyParameters();
+
+    void DspLoop();
+
+    /// Applies the effects to the mix buffer, in the order of their indices
+    void ApplyEffects();
+
+    void QueueMixedBuffer(Buffer::Tag tag);
+    void ReleaseAndQueueBuffers();
+
     AudioRendererParameter worker_params;
+    Core::PerfStats& perf_stats;
     Kernel::SharedPtr<Kernel::WritableEvent> buffer_event;
     std::vector<VoiceState> voices;
     std::vector<EffectState> effects;
+    std::vector<float> mix_buffer; ///< Interleaved mix of the voices, reused by every mix
+    std::array<std::vector<float>, 2> effect_channels; ///< Mix split by channel for the effects
     std::unique_ptr<AudioOut> audio_out;
     AudioCore::StreamPtr stream;
+
+    // Owned by the guest thread
+    ParameterSnapshot update_params;
+    std::vector<VoiceOutStatus> update_voice_status;
+    std::vector<EffectOutStatus> update_effect_status;
+
+    // Shared between the guest and DSP threads, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable dsp_condition;
+    ParameterSnapshot pending_params;
+    bool has_pending_params = false;
+    bool has_released_buffers = false;
+    bool stop_dsp = false;
+    std::vector<VoiceOutStatus> voice_status; ///< Statuses published after every mix
+    std::vector<EffectOutStatus> effect_status;
+
+    // Owned by the DSP thread
+    ParameterSnapshot applied_params;
+    ADPCMCache adpcm_cache;
+    Core::AudioStageTimes stage_times{}; ///< Time spent in each stage since the last report
+    u64 num_mixes = 0;                   ///< Buffers mixed since the last report
+    u32 active_voices = 0;               ///< Voices played by the last mix
+    std::thread dsp_thread;
 };
 
 } // namespace AudioCore
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 
 namespace AudioCore {
 
@@ -18,7 +19,10 @@ class Buffer {
 public:
     using Tag = u64;
 
-    Buffer(Tag tag, std::vector<s16>&& samples) : tag{tag}, samples{std::move(samples)} {}
+    Buffer(Tag tag, std::vector<s16>&& samples)
+        : tag{tag}, samples{std::move(samples)},
+          accounting{Common::MemoryAccounting::Category::AudioBuffers,
+                     this->samples.capacity() * sizeof(s16)} {}
 
     /// Returns the raw audio data for the buffer
     std::vector<s16>& GetSamples() {
@@ -38,6 +42,7 @@ public:
 private:
     Tag tag;
     std::vector<s16> samples;
+    Common::MemoryAccounting::Allocation accounting;
 };
 
 using BufferPtr = std::shared_ptr<Buffer>;
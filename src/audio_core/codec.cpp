@@ -26,10 +26,13 @@ std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM
 
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+    // Sizes are truncated to whole frames, so every frame is decoded without bounds checks. The
+    // filter depends on the previous two outputs, the samples of a frame are decoded in order.
+    const std::size_t num_frames = size / FRAME_LEN;
+    s16* out = ret.data();
+    for (std::size_t framei = 0; framei < num_frames; framei++) {
+        const u8* const frame = data + framei * FRAME_LEN;
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -53,18 +56,9 @@ std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM
             return static_cast<s16>(val);
         };
 
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi] = sample1;
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi] = sample2;
-            outputi++;
-
-            datai++;
+        for (std::size_t datai = 1; datai < FRAME_LEN; datai++) {
+            *out++ = decode_sample(SIGNED_NIBBLES[frame[datai] >> 4]);
+            *out++ = decode_sample(SIGNED_NIBBLES[frame[datai] & 0xF]);
         }
     }
 
@@ -7,7 +7,9 @@
 #include <cstring>
 #include "audio_core/cubeb_sink.h"
 #include "audio_core/stream.h"
+#include "audio_core/stretch_controller.h"
 #include "audio_core/time_stretch.h"
+#include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/ring_buffer.h"
 #include "core/settings.h"
@@ -22,8 +24,9 @@ class CubebSinkStream final : public SinkStream {
 public:
     CubebSinkStream(cubeb* ctx, u32 sample_rate, u32 num_channels_, cubeb_devid output_device,
                     const std::string& name)
-        : ctx{ctx}, num_channels{std::min(num_channels_, 2u)}, time_stretch{sample_rate,
-                                                                            num_channels} {
+        : ctx{ctx}, source_num_channels{num_channels_}, num_channels{std::min(num_channels_, 2u)},
+          time_stretch{sample_rate, num_channels}, stretch_controller{sample_rate},
+          pop_buffer(queue.Capacity()) {
 
         cubeb_stream_params params{};
         params.rate = sample_rate;
@@ -36,8 +39,15 @@ public:
             LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
         }
 
+        // The low latency mode uses the smallest period of the device, the renderer mixes buffers
+        // small enough to keep up with it
+        const u32 latency = Settings::values.enable_low_latency_audio
+                                ? std::max(1u, minimum_latency)
+                                : std::max(512u, minimum_latency);
+        LOG_INFO(Audio_Sink, "Opening stream {} with a period of {} frames", name, latency);
+
         if (cubeb_stream_init(ctx, &stream_backend, name.c_str(), nullptr, nullptr, output_device,
-                              &params, std::max(512u, minimum_latency),
+                              &params, latency,
                               &CubebSinkStream::DataCallback, &CubebSinkStream::StateCallback,
                               this) != CUBEB_OK) {
             LOG_CRITICAL(Audio_Sink, "Error initializing cubeb stream");
@@ -62,20 +72,9 @@ public:
         cubeb_stream_destroy(stream_backend);
     }
 
-    void EnqueueSamples(u32 source_num_channels, const std::vector<s16>& samples) override {
-        if (source_num_channels > num_channels) {
-            // Downsample 6 channels to 2
-            std::vector<s16> buf;
-            buf.reserve(samples.size() * num_channels / source_num_channels);
-            for (std::size_t i = 0; i < samples.size(); i += source_num_channels) {
-                for (std::size_t ch = 0; ch < num_channels; ch++) {
-                    buf.push_back(samples[i + ch]);
-                }
-            }
-            queue.Push(buf);
-            return;
-        }
-
+    void EnqueueSamples(u32 samples_num_channels, const std::vector<s16>& samples) override {
+        // The samples are queued as is, they are downmixed by the callback once they are popped
+        ASSERT(samples_num_channels == source_num_channels);
         queue.Push(samples);
     }
 
@@ -86,6 +85,18 @@ public:
         return queue.Size() / channel_count;
     }
 
+    std::size_t GetLatencyFrames() const override {
+        if (!ctx || !stream_backend)
+            return 0;
+
+        u32 device_latency{};
+        if (cubeb_stream_get_latency(stream_backend, &device_latency) != CUBEB_OK) {
+            // Not every backend reports its latency, the queue is most of it anyway
+            device_latency = 0;
+        }
+        return queue.Size() / source_num_channels + device_latency;
+    }
+
     void Flush() override {
         should_flush = true;
     }
@@ -95,16 +106,114 @@ public:
     }
 
 private:
+    /// Keeps the front channels of the source frames, in place too as the output frames are the
+    /// smaller ones
+    void DownmixFrames(const s16* src, s16* dest, std::size_t num_frames) const {
+        for (std::size_t frame = 0; frame < num_frames; ++frame) {
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                dest[frame * num_channels + ch] = src[frame * source_num_channels + ch];
+            }
+        }
+    }
+
+    /**
+     * Pops frames from the queue and downmixes them to the channels of the output.
+     * @param dest Buffer with space for max_frames frames of the source channels
+     * @returns The number of frames popped
+     */
+    std::size_t PopFrames(s16* dest, std::size_t max_frames) {
+        const std::size_t num_frames =
+            queue.Pop(dest, max_frames * source_num_channels) / source_num_channels;
+        if (source_num_channels != num_channels) {
+            DownmixFrames(dest, dest, num_frames);
+        }
+        return num_frames;
+    }
+
+    /// Reads frames from the queue without stretching them
+    std::size_t ReadFrames(s16* out, std::size_t num_frames) {
+        if (source_num_channels == num_channels) {
+            // Nothing to downmix, the samples are popped straight into the output
+            return PopFrames(out, num_frames);
+        }
+
+        // The frames are downmixed where they are queued, the queue is contiguous unless its
+        // memory couldn't be mirrored
+        const auto [first, second] = queue.Peek();
+        const std::size_t frames_peeked = std::min(num_frames, first.size / source_num_channels);
+        DownmixFrames(first.data, out, frames_peeked);
+        queue.Consume(frames_peeked * source_num_channels);
+        if (frames_peeked == num_frames || second.size == 0) {
+            return frames_peeked;
+        }
+
+        // A frame wraps around the end of the queue, the rest goes through the pop buffer
+        out += frames_peeked * num_channels;
+        const std::size_t max_frames =
+            std::min(num_frames - frames_peeked, pop_buffer.size() / source_num_channels);
+        const std::size_t frames_read = PopFrames(pop_buffer.data(), max_frames);
+        std::memcpy(out, pop_buffer.data(), frames_read * num_channels * sizeof(s16));
+        return frames_peeked + frames_read;
+    }
+
+    /// Reads frames, going through the time stretcher only while the queue can't keep up
+    std::size_t ReadAdaptiveFrames(s16* out, std::size_t num_frames) {
+        if (!is_stretching) {
+            const std::size_t backlog =
+                queue.Size() / source_num_channels + time_stretch.GetBacklog();
+            is_stretching = stretch_controller.ShouldEngage(backlog, num_frames);
+        }
+
+        if (is_stretching) {
+            const std::size_t max_frames = pop_buffer.size() / source_num_channels;
+            const std::size_t num_in = PopFrames(pop_buffer.data(), max_frames);
+            const std::size_t frames_written =
+                time_stretch.Process(pop_buffer.data(), num_in, out, num_frames);
+
+            if (should_flush) {
+                time_stretch.Flush();
+                should_flush = false;
+            }
+            is_stretching =
+                !stretch_controller.ShouldDisengage(time_stretch.GetStretchRatio(), num_frames);
+            return frames_written;
+        }
+
+        // The frames the stretcher still holds are older than the queue, they are played first
+        should_flush = false;
+        const std::size_t frames_drained = time_stretch.Drain(out, num_frames);
+        return frames_drained +
+               ReadFrames(out + frames_drained * num_channels, num_frames - frames_drained);
+    }
+
+    /// Fades from the frame held during an underrun to the frames that follow it
+    void FadeIn(s16* out, std::size_t num_frames) {
+        constexpr std::size_t fade_frames = 128;
+        const std::size_t count = std::min(num_frames, fade_frames);
+        for (std::size_t frame = 0; frame < count; ++frame) {
+            const float weight = static_cast<float>(frame + 1) / (fade_frames + 1);
+            for (std::size_t ch = 0; ch < num_channels; ++ch) {
+                s16& sample = out[frame * num_channels + ch];
+                sample = static_cast<s16>(last_frame[ch] + (sample - last_frame[ch]) * weight);
+            }
+        }
+    }
+
     std::vector<std::string> device_list;
 
     cubeb* ctx{};
     cubeb_stream* stream_backend{};
-    u32 num_channels{};
+    u32 source_num_channels{}; ///< Channels of the queued samples
+    u32 num_channels{};        ///< Channels of the output, at most two
 
     Common::RingBuffer<s16, 0x10000> queue;
     std::array<s16, 2> last_frame{};
     std::atomic<bool> should_flush{};
     TimeStretcher time_stretch;
+    StretchController stretch_controller;
+    bool is_stretching{};
+    bool is_fade_pending{}; ///< The last read came up short and was padded with last_frame
+    std::vector<s16> pop_buffer; ///< Frames popped by the callback, allocated once
 
     static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                              void* output_buffer, long num_frames);
@@ -177,22 +286,19 @@ long CubebSinkStream::DataCallback(cubeb_stream* stream, void* user_data, const
 
     const std::size_t num_channels = impl->GetNumChannels();
     const std::size_t samples_to_write = num_channels * num_frames;
-    std::size_t samples_written;
-
-    if (Settings::values.enable_audio_stretching) {
-        const std::vector<s16> in{impl->queue.Pop()};
-        const std::size_t num_in{in.size() / num_channels};
-        s16* const out{reinterpret_cast<s16*>(buffer)};
-        const std::size_t out_frames =
-            impl->time_stretch.Process(in.data(), num_in, out, num_frames);
-        samples_written = out_frames * num_channels;
-
-        if (impl->should_flush) {
-            impl->time_stretch.Flush();
-            impl->should_flush = false;
-        }
-    } else {
-        samples_written = impl->queue.Pop(buffer, samples_to_write);
+    s16* const out{reinterpret_cast<s16*>(buffer)};
+
+    const std::size_t frames_written = Settings::values.enable_audio_stretching
+                                           ? impl->ReadAdaptiveFrames(out, num_frames)
+                                           : impl->ReadFrames(out, num_frames);
+    const std::size_t samples_written = frames_written * num_channels;
+
+    if (impl->is_fade_pending && frames_written != 0) {
+        impl->FadeIn(out, frames_written);
+        impl->is_fade_pending = false;
+    }
+    if (samples_written < samples_to_write) {
+        impl->is_fade_pending = true;
     }
 
     if (samples_written >= num_channels) {
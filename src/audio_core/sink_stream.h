@@ -28,6 +28,9 @@ public:
 
     virtual std::size_t SamplesInQueue(u32 num_channels) const = 0;
 
+    /// Returns the number of frames queued in the sink, including the ones held by the device
+    virtual std::size_t GetLatencyFrames() const = 0;
+
     virtual void Flush() = 0;
 };
 
@@ -19,6 +19,9 @@ namespace AudioCore {
 
 constexpr std::size_t MaxAudioBufferCount{32};
 
+/// Number of buffers played before the latency of a stream is reported
+constexpr std::size_t LatencyWarmupBufferCount{256};
+
 u32 Stream::GetNumChannels() const {
     switch (format) {
     case Format::Mono16:
@@ -42,6 +45,7 @@ Stream::Stream(Core::Timing::CoreTiming& core_timing, u32 sample_rate, Format fo
 }
 
 void Stream::Play() {
+    std::lock_guard lock{mutex};
     state = State::Playing;
     PlayNextBuffer();
 }
@@ -94,23 +98,49 @@ void Stream::PlayNextBuffer() {
 
     active_buffer = queued_buffers.front();
     queued_buffers.pop();
+    queued_samples -= active_buffer->GetSamples().size();
 
     VolumeAdjustSamples(active_buffer->GetSamples());
 
     sink_stream.EnqueueSamples(GetNumChannels(), active_buffer->GetSamples());
+    MeasureLatency();
 
     core_timing.ScheduleEventThreadsafe(GetBufferReleaseCycles(*active_buffer), release_event, {});
 }
 
 void Stream::ReleaseActiveBuffer() {
-    ASSERT(active_buffer);
-    released_buffers.push(std::move(active_buffer));
+    {
+        std::lock_guard lock{mutex};
+        ASSERT(active_buffer);
+        released_buffers.push(std::move(active_buffer));
+    }
     release_callback();
+
+    std::lock_guard lock{mutex};
     PlayNextBuffer();
 }
 
+void Stream::MeasureLatency() {
+    // The queued buffers play after the frames held by the sink
+    const std::size_t frames = sink_stream.GetLatencyFrames() + queued_samples / GetNumChannels();
+
+    // Exponential average, so the latency follows the stream settling after it starts
+    latency_frames = latency_measurements == 0 ? frames : (latency_frames * 15 + frames) / 16;
+    ++latency_measurements;
+}
+
+std::optional<std::chrono::microseconds> Stream::GetOutputLatency() const {
+    std::lock_guard lock{mutex};
+    if (latency_measurements < LatencyWarmupBufferCount) {
+        return std::nullopt;
+    }
+    return std::chrono::microseconds{latency_frames * 1000000 / sample_rate};
+}
+
 bool Stream::QueueBuffer(BufferPtr&& buffer) {
+    std::lock_guard lock{mutex};
     if (queued_buffers.size() < MaxAudioBufferCount) {
+        queued_samples += buffer->GetSamples().size();
         queued_buffers.push(std::move(buffer));
         PlayNextBuffer();
         return true;
@@ -124,6 +154,7 @@ bool Stream::ContainsBuffer(Buffer::Tag tag) const {
 }
 
 std::vector<Buffer::Tag> Stream::GetTagsAndReleaseBuffers(std::size_t max_count) {
+    std::lock_guard lock{mutex};
     std::vector<Buffer::Tag> tags;
     for (std::size_t count = 0; count < max_count && !released_buffers.empty(); ++count) {
         tags.push_back(released_buffers.front()->GetTag());
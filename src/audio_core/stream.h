@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <queue>
@@ -23,7 +26,9 @@ namespace AudioCore {
 class SinkStream;
 
 /**
- * Represents an audio stream, which is a sequence of queued buffers, to be outputed by AudioOut
+ * Represents an audio stream, which is a sequence of queued buffers, to be outputed by AudioOut.
+ * Buffers may be queued and released from any thread, the release callback runs on the thread of
+ * the core timing events.
  */
 class Stream {
 public:
@@ -68,6 +73,7 @@ public:
 
     /// Returns the number of queued buffers
     std::size_t GetQueueSize() const {
+        std::lock_guard lock{mutex};
         return queued_buffers.size();
     }
 
@@ -82,8 +88,12 @@ public:
     /// Get the state
     State GetState() const;
 
+    /// Returns the average time from a buffer being queued to it being heard, once measured
+    std::optional<std::chrono::microseconds> GetOutputLatency() const;
+
 private:
-    /// Plays the next queued buffer in the audio stream, starting playback if necessary
+    /// Plays the next queued buffer in the audio stream, starting playback if necessary. The
+    /// mutex must be held.
     void PlayNextBuffer();
 
     /// Releases the actively playing buffer, signalling that it has been completed
@@ -92,17 +102,24 @@ private:
     /// Gets the number of core cycles when the specified buffer will be released
     s64 GetBufferReleaseCycles(const Buffer& buffer) const;
 
+    /// Adds the current latency of the stream to its average. The mutex must be held.
+    void MeasureLatency();
+
     u32 sample_rate;                          ///< Sample rate of the stream
     Format format;                            ///< Format of the stream
     ReleaseCallback release_callback;         ///< Buffer release callback for the stream
     State state{State::Stopped};              ///< Playback state of the stream
     Core::Timing::EventType* release_event{}; ///< Core timing release event for the stream
+    mutable std::mutex mutex;                 ///< Guards the buffers of the stream
     BufferPtr active_buffer;                  ///< Actively playing buffer in the stream
     std::queue<BufferPtr> queued_buffers;     ///< Buffers queued to be played in the stream
+    std::size_t queued_samples{};             ///< Number of samples of the queued buffers
     std::queue<BufferPtr> released_buffers;   ///< Buffers recently released from the stream
     SinkStream& sink_stream;                  ///< Output sink for the stream
     Core::Timing::CoreTiming& core_timing;    ///< Core timing instance.
     std::string name;                         ///< Name of the stream, must be unique
+    u64 latency_frames{};                     ///< Average latency, in frames
+    std::size_t latency_measurements{};       ///< Number of buffers the latency was measured on
 };
 
 using StreamPtr = std::shared_ptr<Stream>;
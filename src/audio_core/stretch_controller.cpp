@@ -0,0 +1,69 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/stretch_controller.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+StretchController::StretchController(u32 sample_rate) : sample_rate{sample_rate} {}
+
+bool StretchController::ShouldEngage(std::size_t queued_frames, std::size_t requested_frames) {
+    // How far ahead the fill level is predicted from its trend
+    constexpr double prediction_time = 0.2; // seconds
+    // Responsiveness of the trend, long enough to smooth out the size of the queued buffers
+    constexpr double trend_time_scale = 0.5; // seconds
+    // Fill level the queue must keep, on top of the frames of one read
+    constexpr double min_latency = 0.02; // seconds
+
+    if (has_previous && previous_requested_frames != 0) {
+        const double time_delta = static_cast<double>(previous_requested_frames) / sample_rate;
+        const double change = (static_cast<double>(queued_frames) -
+                               static_cast<double>(previous_queued_frames)) /
+                              time_delta;
+        const double gain = 1.0 - std::exp(-time_delta / trend_time_scale);
+        queue_trend += gain * (change - queue_trend);
+    }
+    previous_queued_frames = queued_frames;
+    previous_requested_frames = requested_frames;
+    has_previous = true;
+
+    const double predicted_frames = queued_frames + std::min(queue_trend, 0.0) * prediction_time;
+    const double min_frames = requested_frames + sample_rate * min_latency;
+    if (queued_frames >= requested_frames && predicted_frames >= min_frames) {
+        return false;
+    }
+
+    LOG_DEBUG(Audio, "Engaging time stretching, queued={} trend={:.1f}", queued_frames,
+              queue_trend);
+    has_previous = false;
+    queue_trend = 0.0;
+    stable_time = 0.0;
+    return true;
+}
+
+bool StretchController::ShouldDisengage(double stretch_ratio, std::size_t requested_frames) {
+    // Deviation of the tempo from full speed still considered full speed
+    constexpr double ratio_tolerance = 0.02;
+    // Time the tempo must stay at full speed, so short recoveries keep stretching
+    constexpr double stable_duration = 2.0; // seconds
+
+    if (std::abs(stretch_ratio - 1.0) > ratio_tolerance) {
+        stable_time = 0.0;
+        return false;
+    }
+
+    stable_time += static_cast<double>(requested_frames) / sample_rate;
+    if (stable_time < stable_duration) {
+        return false;
+    }
+
+    LOG_DEBUG(Audio, "Bypassing time stretching, ratio={:.3f}", stretch_ratio);
+    stable_time = 0.0;
+    return true;
+}
+
+} // namespace AudioCore
@@ -0,0 +1,46 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Decides when the output has to be stretched. Stretching costs CPU and adds the latency of
+ * SoundTouch, it is only needed while the emulation doesn't produce audio as fast as it's played.
+ * The fill level of the output queue tells that directly, whatever the reason for the slowdown.
+ */
+class StretchController {
+public:
+    explicit StretchController(u32 sample_rate);
+
+    /**
+     * Called before reading frames from the queue while stretching is bypassed.
+     * @param queued_frames Frames in the queue
+     * @param requested_frames Frames about to be read
+     * @returns Whether the queue will run dry soon and stretching must start
+     */
+    bool ShouldEngage(std::size_t queued_frames, std::size_t requested_frames);
+
+    /**
+     * Called after stretching frames.
+     * @param stretch_ratio Tempo of the stretcher, see TimeStretcher::GetStretchRatio
+     * @param requested_frames Frames that were output
+     * @returns Whether the tempo stayed at full speed long enough to bypass stretching again
+     */
+    bool ShouldDisengage(double stretch_ratio, std::size_t requested_frames);
+
+private:
+    u32 sample_rate;
+    std::size_t previous_queued_frames{};
+    std::size_t previous_requested_frames{};
+    bool has_previous{};
+    double queue_trend{}; ///< Smoothed change of the fill level of the queue, in frames per second
+    double stable_time{}; ///< Seconds the tempo has been at full speed
+};
+
+} // namespace AudioCore
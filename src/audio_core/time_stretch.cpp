@@ -17,6 +17,10 @@ TimeStretcher::TimeStretcher(u32 sample_rate, u32 channel_count) : m_sample_rate
     m_sound_touch.setTempo(1.0);
 }
 
+std::size_t TimeStretcher::Drain(s16* out, std::size_t num_out) {
+    return m_sound_touch.receiveSamples(out, static_cast<u32>(num_out));
+}
+
 void TimeStretcher::Clear() {
     m_sound_touch.clear();
 }
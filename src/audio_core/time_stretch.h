@@ -21,6 +21,20 @@ public:
     /// @returns Actual number of frames written to `out`
     std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
 
+    /// Receives the frames the stretcher still holds without pushing new ones, this plays its
+    /// backlog before it is bypassed. Returns the number of frames written to `out`.
+    std::size_t Drain(s16* out, std::size_t num_out);
+
+    /// Returns the number of frames waiting to be received
+    std::size_t GetBacklog() const {
+        return m_sound_touch.numSamples();
+    }
+
+    /// Returns the tempo the last frames were stretched with, 1.0 is the speed of the input
+    double GetStretchRatio() const {
+        return m_stretch_ratio;
+    }
+
     void Clear();
 
     void Flush();
@@ -0,0 +1,143 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include "common/bit_util.h"
+#include "common/buffer_pool.h"
+
+namespace Common {
+
+namespace BufferPool {
+
+namespace {
+
+constexpr std::size_t MinClassBits = 8;
+constexpr std::size_t MaxClassBits = 26;
+constexpr std::size_t NumSizeClasses = MaxClassBits - MinClassBits + 1;
+static_assert(std::size_t{1} << MinClassBits == MinPooledSize);
+static_assert(std::size_t{1} << MaxClassBits == MaxPooledSize);
+
+std::atomic<u64> num_acquired{0};
+std::atomic<u64> num_reused{0};
+std::atomic<u64> num_recycled{0};
+std::atomic<u64> num_discarded{0};
+std::atomic<u64> total_pooled_size{0};
+
+/// Returns the size class whose buffers can hold the given size, sizes are rounded up
+std::size_t GetAcquireClass(std::size_t size) {
+    if (size <= MinPooledSize) {
+        return 0;
+    }
+    const std::size_t bits = 64 - CountLeadingZeroes64(static_cast<u64>(size - 1));
+    return bits - MinClassBits;
+}
+
+/// Returns the size class a buffer of the given capacity is kept in, capacities are rounded down
+std::size_t GetRecycleClass(std::size_t capacity) {
+    const std::size_t bits = 63 - CountLeadingZeroes64(static_cast<u64>(capacity));
+    return bits - MinClassBits;
+}
+
+/// Set once the pool of the thread is destroyed, buffers destroyed after it are freed
+thread_local bool is_pool_destroyed = false;
+
+struct ThreadPool {
+    ~ThreadPool() {
+        total_pooled_size -= pooled_size;
+        is_pool_destroyed = true;
+    }
+
+    std::array<std::vector<std::vector<u8>>, NumSizeClasses> free_lists;
+    std::size_t pooled_size = 0;
+};
+
+ThreadPool& GetThreadPool() {
+    thread_local ThreadPool pool;
+    return pool;
+}
+
+} // Anonymous namespace
+
+PooledVector Acquire(std::size_t size) {
+    ++num_acquired;
+    if (size > MaxPooledSize || is_pool_destroyed) {
+        return PooledVector{std::vector<u8>(size)};
+    }
+
+    ThreadPool& pool = GetThreadPool();
+    const std::size_t size_class = GetAcquireClass(size);
+    auto& free_list = pool.free_lists[size_class];
+    if (free_list.empty()) {
+        // Reserve the whole size class, so the buffer can serve any size of it once recycled
+        std::vector<u8> buffer;
+        buffer.reserve(std::size_t{1} << (size_class + MinClassBits));
+        buffer.resize(size);
+        return PooledVector{std::move(buffer)};
+    }
+
+    ++num_reused;
+    std::vector<u8> buffer = std::move(free_list.back());
+    free_list.pop_back();
+    pool.pooled_size -= buffer.capacity();
+    total_pooled_size -= buffer.capacity();
+    buffer.resize(size);
+    return PooledVector{std::move(buffer)};
+}
+
+void Recycle(std::vector<u8>&& buffer) {
+    const std::size_t capacity = buffer.capacity();
+    if (capacity < MinPooledSize || capacity >= MaxPooledSize * 2 || is_pool_destroyed) {
+        return;
+    }
+
+    ThreadPool& pool = GetThreadPool();
+    auto& free_list = pool.free_lists[GetRecycleClass(capacity)];
+    if (free_list.size() >= MaxBuffersPerClass ||
+        pool.pooled_size + capacity > MaxPooledBytesPerThread) {
+        ++num_discarded;
+        return;
+    }
+
+    ++num_recycled;
+    pool.pooled_size += capacity;
+    total_pooled_size += capacity;
+    free_list.push_back(std::move(buffer));
+}
+
+Stats GetStats() {
+    return {num_acquired.load(), num_reused.load(), num_recycled.load(), num_discarded.load(),
+            total_pooled_size.load()};
+}
+
+} // namespace BufferPool
+
+PooledVector::~PooledVector() {
+    BufferPool::Recycle(std::move(buffer));
+}
+
+PooledVector::PooledVector(const PooledVector& other)
+    : PooledVector{BufferPool::Acquire(other.size())} {
+    std::copy(other.begin(), other.end(), begin());
+}
+
+PooledVector& PooledVector::operator=(const PooledVector& other) {
+    if (this != &other) {
+        buffer.resize(other.size());
+        std::copy(other.begin(), other.end(), begin());
+    }
+    return *this;
+}
+
+PooledVector& PooledVector::operator=(PooledVector&& other) noexcept {
+    if (this != &other) {
+        BufferPool::Recycle(std::move(buffer));
+        buffer = std::move(other.buffer);
+        other.buffer = {};
+    }
+    return *this;
+}
+
+} // namespace Common
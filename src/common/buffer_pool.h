@@ -0,0 +1,120 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Byte buffer taken from the buffer pool, given back to the pool of the thread destroying it.
+ * Recycled buffers keep their capacity, so transient buffers of similar sizes are neither
+ * allocated nor faulted in again. The contents of a newly acquired buffer are unspecified.
+ */
+class PooledVector {
+public:
+    using iterator = std::vector<u8>::iterator;
+    using const_iterator = std::vector<u8>::const_iterator;
+
+    PooledVector() = default;
+    explicit PooledVector(std::vector<u8>&& buffer) : buffer{std::move(buffer)} {}
+    ~PooledVector();
+
+    PooledVector(const PooledVector& other);
+    PooledVector& operator=(const PooledVector& other);
+
+    PooledVector(PooledVector&& other) noexcept = default;
+    PooledVector& operator=(PooledVector&& other) noexcept;
+
+    u8* data() {
+        return buffer.data();
+    }
+    const u8* data() const {
+        return buffer.data();
+    }
+
+    std::size_t size() const {
+        return buffer.size();
+    }
+    bool empty() const {
+        return buffer.empty();
+    }
+
+    iterator begin() {
+        return buffer.begin();
+    }
+    const_iterator begin() const {
+        return buffer.begin();
+    }
+    iterator end() {
+        return buffer.end();
+    }
+    const_iterator end() const {
+        return buffer.end();
+    }
+
+    u8& operator[](std::size_t index) {
+        return buffer[index];
+    }
+    const u8& operator[](std::size_t index) const {
+        return buffer[index];
+    }
+
+    /// Returns the underlying vector, resizing it keeps it pooled
+    std::vector<u8>& Vector() {
+        return buffer;
+    }
+    const std::vector<u8>& Vector() const {
+        return buffer;
+    }
+
+    /// Takes the vector out of the pool, for buffers that outlive the transient use
+    std::vector<u8> Release() {
+        return std::exchange(buffer, {});
+    }
+
+private:
+    std::vector<u8> buffer;
+};
+
+/**
+ * Recycles large transient byte buffers. Each thread keeps free lists of its own, one for each
+ * power of two size class, so acquiring and recycling buffers doesn't synchronize between threads.
+ * Buffers larger than the largest size class are handled by the system allocator.
+ */
+namespace BufferPool {
+
+/// Smallest buffer capacity kept in the pool
+constexpr std::size_t MinPooledSize = 256;
+/// Largest buffer capacity kept in the pool
+constexpr std::size_t MaxPooledSize = 64 * 1024 * 1024;
+/// Buffers kept by a thread in each size class
+constexpr std::size_t MaxBuffersPerClass = 8;
+/// Bytes of capacity kept by a thread across its size classes
+constexpr std::size_t MaxPooledBytesPerThread = 128 * 1024 * 1024;
+
+struct Stats {
+    u64 acquired;    ///< Buffers acquired from the pool
+    u64 reused;      ///< Acquired buffers that were recycled from a free list
+    u64 recycled;    ///< Buffers given back to a free list
+    u64 discarded;   ///< Buffers given back that were freed, their free list being full
+    u64 pooled_size; ///< Bytes currently kept in the free lists of all threads
+};
+
+/// Returns a buffer of the given size, recycled from the free lists of this thread if possible
+PooledVector Acquire(std::size_t size);
+
+/// Gives a buffer back to the free lists of this thread, or frees it when they are full
+void Recycle(std::vector<u8>&& buffer);
+
+/// Returns the counters of the pool since the start of the process
+Stats GetStats();
+
+} // namespace BufferPool
+
+} // namespace Common
@@ -42,7 +42,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -262,6 +264,23 @@ bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     return false;
 }
 
+bool Replace(const std::string& srcFilename, const std::string& destFilename) {
+    LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
+#ifdef _WIN32
+    if (MoveFileExW(Common::UTF8ToUTF16W(srcFilename).c_str(),
+                    Common::UTF8ToUTF16W(destFilename).c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+#else
+    // rename replaces the destination atomically on POSIX
+    if (rename(srcFilename.c_str(), destFilename.c_str()) == 0)
+        return true;
+#endif
+    LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", srcFilename, destFilename,
+              GetLastErrorMsg());
+    return false;
+}
+
 bool Copy(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
 #ifdef _WIN32
@@ -343,6 +362,21 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+s64 GetModificationTime(const std::string& filename) {
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<s64>(buf.st_mtime);
+    }
+
+    LOG_TRACE(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return 0;
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -962,6 +996,101 @@ bool IOFile::Flush() {
     return IsOpen() && 0 == std::fflush(m_file);
 }
 
+bool IOFile::Sync() {
+    if (!Flush()) {
+        return false;
+    }
+#ifdef _WIN32
+    return 0 == _commit(_fileno(m_file));
+#else
+    return 0 == fsync(fileno(m_file));
+#endif
+}
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+    // Other handles can keep writing, renaming and deleting the file while it's mapped
+    const HANDLE file =
+        CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            // The view keeps the mapping alive once both handles are closed
+            base = static_cast<u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<std::size_t>(file_size.QuadPart);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    struct stat file_info;
+    if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+        void* const view = mmap(nullptr, static_cast<std::size_t>(file_info.st_size), PROT_READ,
+                                MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            base = static_cast<u8*>(view);
+            size = static_cast<std::size_t>(file_info.st_size);
+        }
+    }
+    // The mapping stays valid once the descriptor is closed
+    close(fd);
+#endif
+
+    if (base == nullptr) {
+        size = 0;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (base == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+void MappedFile::Advise(std::size_t offset, std::size_t length, AccessHint hint) const {
+    if (base == nullptr || offset >= size) {
+        return;
+    }
+    length = std::min(length, size - offset);
+#ifdef _WIN32
+    // Windows has no read-ahead hints for the pages of a view that is already mapped
+#else
+    // The address passed to madvise has to be page aligned
+    const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t aligned_offset = offset - offset % page_size;
+    int advice = MADV_NORMAL;
+    switch (hint) {
+    case AccessHint::Normal:
+        advice = MADV_NORMAL;
+        break;
+    case AccessHint::Sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case AccessHint::Random:
+        advice = MADV_RANDOM;
+        break;
+    }
+    if (madvise(base + aligned_offset, length + offset - aligned_offset, advice) != 0) {
+        LOG_DEBUG(Common_Filesystem, "madvise failed: {}", GetLastErrorMsg());
+    }
+#endif
+}
+
 bool IOFile::Resize(u64 size) {
     return IsOpen() && 0 ==
 #ifdef _WIN32
@@ -61,6 +61,9 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, 0 on failure
+s64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -77,6 +80,10 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// renames file srcFilename to destFilename, atomically replacing destFilename if it exists.
+// Returns true on success
+bool Replace(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -271,6 +278,8 @@ public:
     u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
+    // flushes the buffered writes and waits for the storage device to persist them
+    bool Sync();
 
     // clear error state
     void Clear() {
@@ -281,6 +290,46 @@ private:
     std::FILE* m_file = nullptr;
 };
 
+/**
+ * Read-only view of a whole file mapped into memory. Reading the bytes of the view doesn't go
+ * through a file position, so any number of threads can read it without locking. The view keeps
+ * the size the file had when it was mapped, so only files that nothing truncates while they are
+ * mapped can be viewed: reading past their new end faults on POSIX, and resizing them fails on
+ * Windows.
+ */
+class MappedFile : public NonCopyable {
+public:
+    /// How a range of the view is going to be read
+    enum class AccessHint {
+        Normal,
+        Sequential,
+        Random,
+    };
+
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    /// Tunes the read-ahead of the pages of a range of the view, the range is clamped to the view
+    void Advise(std::size_t offset, std::size_t length, AccessHint hint) const;
+
+    /// Returns false when the file could not be mapped, empty files are never mapped
+    bool IsOpen() const {
+        return base != nullptr;
+    }
+
+    const u8* Data() const {
+        return base;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+private:
+    u8* base = nullptr;
+    std::size_t size = 0;
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
@@ -0,0 +1,447 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Implementation of XXH3-64, following the xxHash specification by Yann Collet. The results match
+// XXH3_64bits and XXH3_64bits_withSeed of xxHash 0.8.
+
+#include <algorithm>
+#include <cstring>
+#include "common/hash.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/simd.h"
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr u64 PRIME32_1 = 0x9E3779B1U;
+constexpr u64 PRIME32_2 = 0x85EBCA77U;
+constexpr u64 PRIME32_3 = 0xC2B2AE3DU;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr u64 PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr u64 PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr std::size_t STRIPE_LEN = HashState::StripeLen;
+constexpr std::size_t SECRET_SIZE = HashState::SecretSize;
+constexpr std::size_t SECRET_CONSUME_RATE = 8;
+constexpr std::size_t SECRET_LASTACC_START = 7;
+constexpr std::size_t SECRET_MERGEACCS_START = 11;
+constexpr std::size_t MIDSIZE_MAX = 240;
+constexpr std::size_t MIDSIZE_STARTOFFSET = 3;
+constexpr std::size_t MIDSIZE_LASTOFFSET = 17;
+constexpr std::size_t SECRET_SIZE_MIN = 136;
+constexpr std::size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_LEN) / SECRET_CONSUME_RATE;
+
+alignas(64) constexpr u8 DEFAULT_SECRET[SECRET_SIZE]{
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+constexpr std::array<u64, HashState::NumAccumulators> INITIAL_ACCUMULATORS{
+    PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1,
+};
+
+// The hash is defined over little endian reads, which is every host the emulator runs on
+u32 Read32(const u8* ptr) {
+    u32 value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+u64 Read64(const u8* ptr) {
+    u64 value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+void Write64(u8* ptr, u64 value) {
+    std::memcpy(ptr, &value, sizeof(value));
+}
+
+u32 Swap32(u32 value) {
+    return ((value << 24) & 0xff000000) | ((value << 8) & 0x00ff0000) |
+           ((value >> 8) & 0x0000ff00) | ((value >> 24) & 0x000000ff);
+}
+
+u64 Swap64(u64 value) {
+    return (static_cast<u64>(Swap32(static_cast<u32>(value))) << 32) |
+           Swap32(static_cast<u32>(value >> 32));
+}
+
+u64 RotateLeft64(u64 value, int amount) {
+    return (value << amount) | (value >> (64 - amount));
+}
+
+/// Multiplies two 64-bit values into 128 bits and folds the halves together
+u64 Multiply128Fold64(u64 lhs, u64 rhs) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    u64 high;
+    const u64 low = _umul128(lhs, rhs, &high);
+    return low ^ high;
+#else
+    const u64 lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    const u64 hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    const u64 lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    const u64 hi_hi = (lhs >> 32) * (rhs >> 32);
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const u64 upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const u64 lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lower ^ upper;
+#endif
+}
+
+u64 XXH64Avalanche(u64 hash) {
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+u64 Avalanche(u64 hash) {
+    hash ^= hash >> 37;
+    hash *= PRIME_MX1;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+u64 RRMXMX(u64 hash, u64 len) {
+    hash ^= RotateLeft64(hash, 49) ^ RotateLeft64(hash, 24);
+    hash *= PRIME_MX2;
+    hash ^= (hash >> 35) + len;
+    hash *= PRIME_MX2;
+    return hash ^ (hash >> 28);
+}
+
+u64 Len1To3(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    const u32 combined = (static_cast<u32>(input[0]) << 16) |
+                         (static_cast<u32>(input[len >> 1]) << 24) |
+                         static_cast<u32>(input[len - 1]) | (static_cast<u32>(len) << 8);
+    const u64 bitflip = (Read32(secret) ^ Read32(secret + 4)) + seed;
+    return XXH64Avalanche(combined ^ bitflip);
+}
+
+u64 Len4To8(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    seed ^= static_cast<u64>(Swap32(static_cast<u32>(seed))) << 32;
+    const u64 bitflip = (Read64(secret + 8) ^ Read64(secret + 16)) - seed;
+    const u64 input64 = Read32(input + len - 4) + (static_cast<u64>(Read32(input)) << 32);
+    return RRMXMX(input64 ^ bitflip, len);
+}
+
+u64 Len9To16(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    const u64 bitflip_lo = (Read64(secret + 24) ^ Read64(secret + 32)) + seed;
+    const u64 bitflip_hi = (Read64(secret + 40) ^ Read64(secret + 48)) - seed;
+    const u64 input_lo = Read64(input) ^ bitflip_lo;
+    const u64 input_hi = Read64(input + len - 8) ^ bitflip_hi;
+    const u64 acc = len + Swap64(input_lo) + input_hi + Multiply128Fold64(input_lo, input_hi);
+    return Avalanche(acc);
+}
+
+u64 Len0To16(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    if (len > 8) {
+        return Len9To16(input, len, secret, seed);
+    }
+    if (len >= 4) {
+        return Len4To8(input, len, secret, seed);
+    }
+    if (len > 0) {
+        return Len1To3(input, len, secret, seed);
+    }
+    return XXH64Avalanche(seed ^ Read64(secret + 56) ^ Read64(secret + 64));
+}
+
+u64 Mix16B(const u8* input, const u8* secret, u64 seed) {
+    return Multiply128Fold64(Read64(input) ^ (Read64(secret) + seed),
+                             Read64(input + 8) ^ (Read64(secret + 8) - seed));
+}
+
+u64 Len17To128(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    u64 acc = len * PRIME64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += Mix16B(input + 48, secret + 96, seed);
+                acc += Mix16B(input + len - 64, secret + 112, seed);
+            }
+            acc += Mix16B(input + 32, secret + 64, seed);
+            acc += Mix16B(input + len - 48, secret + 80, seed);
+        }
+        acc += Mix16B(input + 16, secret + 32, seed);
+        acc += Mix16B(input + len - 32, secret + 48, seed);
+    }
+    acc += Mix16B(input, secret, seed);
+    acc += Mix16B(input + len - 16, secret + 16, seed);
+    return Avalanche(acc);
+}
+
+u64 Len129To240(const u8* input, std::size_t len, const u8* secret, u64 seed) {
+    u64 acc = len * PRIME64_1;
+    for (std::size_t i = 0; i < 8; ++i) {
+        acc += Mix16B(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc = Avalanche(acc);
+
+    const std::size_t num_rounds = len / 16;
+    for (std::size_t i = 8; i < num_rounds; ++i) {
+        acc += Mix16B(input + 16 * i, secret + 16 * (i - 8) + MIDSIZE_STARTOFFSET, seed);
+    }
+    acc += Mix16B(input + len - 16, secret + SECRET_SIZE_MIN - MIDSIZE_LASTOFFSET, seed);
+    return Avalanche(acc);
+}
+
+#ifndef ARCHITECTURE_x86_64
+
+void AccumulateScalar(u64* acc, const u8* input, const u8* secret, std::size_t num_stripes) {
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const u8* const data = input + stripe * STRIPE_LEN;
+        const u8* const key = secret + stripe * SECRET_CONSUME_RATE;
+        for (std::size_t i = 0; i < HashState::NumAccumulators; ++i) {
+            const u64 data_value = Read64(data + 8 * i);
+            const u64 data_key = data_value ^ Read64(key + 8 * i);
+            acc[i ^ 1] += data_value;
+            acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+        }
+    }
+}
+
+#else
+
+void AccumulateSSE2(u64* acc, const u8* input, const u8* secret, std::size_t num_stripes) {
+    __m128i sums[4];
+    for (std::size_t i = 0; i < 4; ++i) {
+        sums[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+    }
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const auto data = reinterpret_cast<const __m128i*>(input + stripe * STRIPE_LEN);
+        const auto key = reinterpret_cast<const __m128i*>(secret + stripe * SECRET_CONSUME_RATE);
+        for (std::size_t i = 0; i < 4; ++i) {
+            // Multiplies the low and high halves of each keyed lane and adds the swapped data
+            const __m128i data_value = _mm_loadu_si128(data + i);
+            const __m128i data_key = _mm_xor_si128(data_value, _mm_loadu_si128(key + i));
+            const __m128i product = _mm_mul_epu32(data_key, _mm_srli_epi64(data_key, 32));
+            const __m128i data_swap = _mm_shuffle_epi32(data_value, _MM_SHUFFLE(1, 0, 3, 2));
+            sums[i] = _mm_add_epi64(sums[i], _mm_add_epi64(product, data_swap));
+        }
+    }
+    for (std::size_t i = 0; i < 4; ++i) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, sums[i]);
+    }
+}
+
+AVX2_TARGET void AccumulateAVX2(u64* acc, const u8* input, const u8* secret,
+                                std::size_t num_stripes) {
+    __m256i sums[2];
+    for (std::size_t i = 0; i < 2; ++i) {
+        sums[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+    }
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const auto data = reinterpret_cast<const __m256i*>(input + stripe * STRIPE_LEN);
+        const auto key = reinterpret_cast<const __m256i*>(secret + stripe * SECRET_CONSUME_RATE);
+        for (std::size_t i = 0; i < 2; ++i) {
+            const __m256i data_value = _mm256_loadu_si256(data + i);
+            const __m256i data_key = _mm256_xor_si256(data_value, _mm256_loadu_si256(key + i));
+            const __m256i product = _mm256_mul_epu32(data_key, _mm256_srli_epi64(data_key, 32));
+            const __m256i data_swap = _mm256_shuffle_epi32(data_value, _MM_SHUFFLE(1, 0, 3, 2));
+            sums[i] = _mm256_add_epi64(sums[i], _mm256_add_epi64(product, data_swap));
+        }
+    }
+    for (std::size_t i = 0; i < 2; ++i) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, sums[i]);
+    }
+}
+
+#endif
+
+/// Accumulates consecutive stripes, each one keyed by the secret shifted by 8 bytes
+void Accumulate(u64* acc, const u8* input, const u8* secret, std::size_t num_stripes) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::HasAVX2()) {
+        AccumulateAVX2(acc, input, secret, num_stripes);
+    } else {
+        AccumulateSSE2(acc, input, secret, num_stripes);
+    }
+#else
+    AccumulateScalar(acc, input, secret, num_stripes);
+#endif
+}
+
+/// Mixes the accumulators at the end of a block, it only runs once per kilobyte
+void ScrambleAccumulators(u64* acc, const u8* secret) {
+    for (std::size_t i = 0; i < HashState::NumAccumulators; ++i) {
+        u64 value = acc[i];
+        value ^= value >> 47;
+        value ^= Read64(secret + 8 * i);
+        acc[i] = value * PRIME32_1;
+    }
+}
+
+u64 MergeAccumulators(const u64* acc, const u8* secret, u64 start) {
+    u64 result = start;
+    for (std::size_t i = 0; i < HashState::NumAccumulators / 2; ++i) {
+        result += Multiply128Fold64(acc[2 * i] ^ Read64(secret + 16 * i),
+                                    acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+    }
+    return Avalanche(result);
+}
+
+/// Consumes stripes that aren't the last ones of the input, scrambling at the end of each block
+void ConsumeStripes(u64* acc, std::size_t& stripes_in_block, const u8* input,
+                    std::size_t num_stripes, const u8* secret) {
+    while (num_stripes > 0) {
+        const std::size_t count = std::min(num_stripes, STRIPES_PER_BLOCK - stripes_in_block);
+        Accumulate(acc, input, secret + stripes_in_block * SECRET_CONSUME_RATE, count);
+        input += count * STRIPE_LEN;
+        num_stripes -= count;
+        stripes_in_block += count;
+        if (stripes_in_block == STRIPES_PER_BLOCK) {
+            ScrambleAccumulators(acc, secret + SECRET_SIZE - STRIPE_LEN);
+            stripes_in_block = 0;
+        }
+    }
+}
+
+u64 FinalizeLong(u64* acc, const u8* last_stripe, const u8* secret, u64 len) {
+    Accumulate(acc, last_stripe, secret + SECRET_SIZE - STRIPE_LEN - SECRET_LASTACC_START, 1);
+    return MergeAccumulators(acc, secret + SECRET_MERGEACCS_START, len * PRIME64_1);
+}
+
+u64 HashLong(const u8* input, std::size_t len, const u8* secret) {
+    std::array<u64, HashState::NumAccumulators> acc = INITIAL_ACCUMULATORS;
+
+    // Every stripe but the last one of the input goes through the blocks
+    std::size_t stripes_in_block = 0;
+    ConsumeStripes(acc.data(), stripes_in_block, input, (len - 1) / STRIPE_LEN, secret);
+    return FinalizeLong(acc.data(), input + len - STRIPE_LEN, secret, len);
+}
+
+void InitSecret(u8* secret, u64 seed) {
+    for (std::size_t i = 0; i < SECRET_SIZE; i += 16) {
+        Write64(secret + i, Read64(DEFAULT_SECRET + i) + seed);
+        Write64(secret + i + 8, Read64(DEFAULT_SECRET + i + 8) - seed);
+    }
+}
+
+u64 HashShort(const u8* input, std::size_t len, u64 seed) {
+    if (len <= 16) {
+        return Len0To16(input, len, DEFAULT_SECRET, seed);
+    }
+    if (len <= 128) {
+        return Len17To128(input, len, DEFAULT_SECRET, seed);
+    }
+    return Len129To240(input, len, DEFAULT_SECRET, seed);
+}
+
+} // Anonymous namespace
+
+u64 ComputeHash64(const void* data, std::size_t len, u64 seed) {
+    const auto input = static_cast<const u8*>(data);
+    if (len <= MIDSIZE_MAX) {
+        return HashShort(input, len, seed);
+    }
+    if (seed == 0) {
+        return HashLong(input, len, DEFAULT_SECRET);
+    }
+    alignas(64) u8 secret[SECRET_SIZE];
+    InitSecret(secret, seed);
+    return HashLong(input, len, secret);
+}
+
+HashState::HashState(u64 seed) {
+    Reset(seed);
+}
+
+void HashState::Reset(u64 seed_) {
+    seed = seed_;
+    acc = INITIAL_ACCUMULATORS;
+    stripes_in_block = 0;
+    buffered_size = 0;
+    total_len = 0;
+    if (seed == 0) {
+        std::memcpy(secret.data(), DEFAULT_SECRET, SECRET_SIZE);
+    } else {
+        InitSecret(secret.data(), seed);
+    }
+}
+
+void HashState::Update(const void* data, std::size_t len) {
+    auto input = static_cast<const u8*>(data);
+    total_len += len;
+
+    // The input is only consumed once more of it follows, the last stripe is hashed differently
+    if (buffered_size + len <= BufferSize) {
+        std::memcpy(buffer.data() + buffered_size, input, len);
+        buffered_size += len;
+        return;
+    }
+    if (buffered_size != 0) {
+        const std::size_t fill = BufferSize - buffered_size;
+        std::memcpy(buffer.data() + buffered_size, input, fill);
+        input += fill;
+        len -= fill;
+        ConsumeStripes(acc.data(), stripes_in_block, buffer.data(), BufferSize / STRIPE_LEN,
+                       secret.data());
+        buffered_size = 0;
+    }
+    if (len > BufferSize) {
+        do {
+            ConsumeStripes(acc.data(), stripes_in_block, input, BufferSize / STRIPE_LEN,
+                           secret.data());
+            input += BufferSize;
+            len -= BufferSize;
+        } while (len > BufferSize);
+
+        // Keep the last consumed stripe, the final one may overlap it
+        std::memcpy(buffer.data() + BufferSize - STRIPE_LEN, input - STRIPE_LEN, STRIPE_LEN);
+    }
+    std::memcpy(buffer.data(), input, len);
+    buffered_size = len;
+}
+
+u64 HashState::Digest() const {
+    if (total_len <= MIDSIZE_MAX) {
+        return HashShort(buffer.data(), buffered_size, seed);
+    }
+
+    std::array<u64, NumAccumulators> digest_acc = acc;
+    std::size_t digest_stripes_in_block = stripes_in_block;
+    if (buffered_size >= STRIPE_LEN) {
+        ConsumeStripes(digest_acc.data(), digest_stripes_in_block, buffer.data(),
+                       (buffered_size - 1) / STRIPE_LEN, secret.data());
+        return FinalizeLong(digest_acc.data(), buffer.data() + buffered_size - STRIPE_LEN,
+                            secret.data(), total_len);
+    }
+
+    // The last stripe starts in the previously consumed data
+    std::array<u8, STRIPE_LEN> last_stripe;
+    const std::size_t catch_up = STRIPE_LEN - buffered_size;
+    std::memcpy(last_stripe.data(), buffer.data() + BufferSize - catch_up, catch_up);
+    std::memcpy(last_stripe.data() + catch_up, buffer.data(), buffered_size);
+    return FinalizeLong(digest_acc.data(), last_stripe.data(), secret.data(), total_len);
+}
+
+} // namespace Common
@@ -4,22 +4,65 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstring>
+#include <type_traits>
 #include "common/cityhash.h"
 #include "common/common_types.h"
 
 namespace Common {
 
 /**
- * Computes a 64-bit hash over the specified block of data
+ * Computes a 64-bit hash over the specified block of data with XXH3. The hash is meant for in
+ * memory caches, use CityHash64 for hashes stored on disk so they stay valid across versions.
  * @param data Block of data to compute hash over
  * @param len Length of data (in bytes) to compute hash over
+ * @param seed Seed of the hash, different seeds give independent hashes of the same data
  * @returns 64-bit hash value that was computed over the data block
  */
-static inline u64 ComputeHash64(const void* data, std::size_t len) {
-    return CityHash64(static_cast<const char*>(data), len);
-}
+u64 ComputeHash64(const void* data, std::size_t len, u64 seed = 0);
+
+/**
+ * Computes the hash of ComputeHash64 over data passed in several pieces, the result only
+ * depends on their concatenation. Pieces shorter than the internal buffer are copied to it.
+ */
+class HashState {
+public:
+    static constexpr std::size_t StripeLen = 64;
+    static constexpr std::size_t SecretSize = 192;
+    static constexpr std::size_t NumAccumulators = 8;
+
+    explicit HashState(u64 seed = 0);
+
+    /// Starts a new hash with the given seed
+    void Reset(u64 seed = 0);
+
+    /// Appends a piece of data to the hashed input
+    void Update(const void* data, std::size_t len);
+
+    /// Appends the bytes of a trivially copyable value, see ComputeStructHash64 about padding
+    template <typename T>
+    void UpdateStruct(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Type passed to UpdateStruct must be trivially copyable");
+        Update(&value, sizeof(value));
+    }
+
+    /// Returns the hash of the data appended so far, more data can still be appended after it
+    u64 Digest() const;
+
+private:
+    static constexpr std::size_t BufferSize = StripeLen * 4;
+
+    alignas(64) std::array<u64, NumAccumulators> acc;
+    alignas(64) std::array<u8, BufferSize> buffer;
+    alignas(64) std::array<u8, SecretSize> secret;
+    std::size_t stripes_in_block;
+    std::size_t buffered_size;
+    u64 total_len;
+    u64 seed;
+};
 
 /**
  * Computes a 64-bit hash of a struct. In addition to being trivially copyable, it is also critical
@@ -33,6 +76,14 @@ static inline u64 ComputeStructHash64(const T& data) {
     return ComputeHash64(&data, sizeof(data));
 }
 
+/// Hash function object for unordered containers keyed by structs, see ComputeStructHash64
+template <typename T>
+struct StructHash {
+    std::size_t operator()(const T& value) const noexcept {
+        return static_cast<std::size_t>(ComputeStructHash64(value));
+    }
+};
+
 /// A helper template that ensures the padding in a struct is initialized by memsetting to 0.
 template <typename T>
 struct HashableStruct {
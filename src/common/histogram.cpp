@@ -0,0 +1,110 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <fmt/format.h>
+#include "common/bit_util.h"
+#include "common/histogram.h"
+
+namespace Common {
+
+std::size_t Histogram::GetBucketIndex(u64 value) {
+    // Values below the number of sub-buckets have a bucket each
+    if (value < NumSubBuckets) {
+        return static_cast<std::size_t>(value);
+    }
+    const u32 msb = 63 - CountLeadingZeroes64(value);
+    const u64 sub_bucket = (value >> (msb - SubBucketBits)) & (NumSubBuckets - 1);
+    return (msb - SubBucketBits + 1) * NumSubBuckets + static_cast<std::size_t>(sub_bucket);
+}
+
+u64 Histogram::GetBucketLowerBound(std::size_t bucket) {
+    if (bucket < NumSubBuckets) {
+        return bucket;
+    }
+    const std::size_t shift = bucket / NumSubBuckets - 1;
+    return (NumSubBuckets + bucket % NumSubBuckets) << shift;
+}
+
+u64 Histogram::GetBucketUpperBound(std::size_t bucket) {
+    if (bucket + 1 >= NumBuckets) {
+        return std::numeric_limits<u64>::max();
+    }
+    return GetBucketLowerBound(bucket + 1) - 1;
+}
+
+void Histogram::Add(u64 value) {
+    buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    u64 current_max = max.load(std::memory_order_relaxed);
+    while (value > current_max &&
+           !max.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::Reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+u64 Histogram::GetCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+u64 Histogram::GetSum() const {
+    return sum.load(std::memory_order_relaxed);
+}
+
+u64 Histogram::GetMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+u64 Histogram::GetPercentile(double fraction) const {
+    // The total is summed from the buckets, the count may already include values still being added
+    std::array<u64, NumBuckets> counts;
+    u64 total = 0;
+    for (std::size_t bucket = 0; bucket < NumBuckets; ++bucket) {
+        counts[bucket] = buckets[bucket].load(std::memory_order_relaxed);
+        total += counts[bucket];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(fraction, 0.0, 1.0);
+    const u64 rank = std::max<u64>(static_cast<u64>(std::ceil(clamped * total)), 1);
+    u64 seen = 0;
+    for (std::size_t bucket = 0; bucket < NumBuckets; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::min(GetBucketUpperBound(bucket), GetMax());
+        }
+    }
+    return GetMax();
+}
+
+std::string Histogram::Serialize() const {
+    std::string result;
+    for (std::size_t bucket = 0; bucket < NumBuckets; ++bucket) {
+        const u64 bucket_count = buckets[bucket].load(std::memory_order_relaxed);
+        if (bucket_count == 0) {
+            continue;
+        }
+        if (!result.empty()) {
+            result += ',';
+        }
+        result += fmt::format("{}:{}", bucket, bucket_count);
+    }
+    return result;
+}
+
+} // namespace Common
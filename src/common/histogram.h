@@ -0,0 +1,65 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Distribution of a metric in log-scale buckets, each power of two is split in four buckets so a
+ * value is known to within 25%. Adding a value is lock-free and can be done from any thread, the
+ * queries may miss the values added while they run.
+ */
+class Histogram final {
+public:
+    static constexpr std::size_t SubBucketBits = 2;
+    static constexpr std::size_t NumSubBuckets = std::size_t{1} << SubBucketBits;
+    static constexpr std::size_t NumBuckets = (64 - SubBucketBits + 1) * NumSubBuckets;
+
+    Histogram() = default;
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /// Returns the bucket a value falls in
+    static std::size_t GetBucketIndex(u64 value);
+
+    /// Returns the smallest value of a bucket
+    static u64 GetBucketLowerBound(std::size_t bucket);
+
+    /// Returns the largest value of a bucket
+    static u64 GetBucketUpperBound(std::size_t bucket);
+
+    void Add(u64 value);
+
+    void Reset();
+
+    u64 GetCount() const;
+    u64 GetSum() const;
+    u64 GetMax() const;
+
+    /**
+     * Returns the value below which the given fraction of the values fall, rounded up to the end of
+     * its bucket and capped at the largest value. Returns zero when the histogram is empty.
+     * @param fraction Fraction of the values between 0 and 1, e.g. 0.99 for the 99th percentile
+     */
+    u64 GetPercentile(double fraction) const;
+
+    /// Returns the non-empty buckets as "bucket:count" pairs separated by commas
+    std::string Serialize() const;
+
+private:
+    std::array<std::atomic<u64>, NumBuckets> buckets{};
+    std::atomic<u64> count{0};
+    std::atomic<u64> sum{0};
+    std::atomic<u64> max{0};
+};
+
+} // namespace Common
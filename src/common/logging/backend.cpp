@@ -7,6 +7,7 @@
 #include <chrono>
 #include <climits>
 #include <condition_variable>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -17,15 +18,132 @@
 #else
 #define _SH_DENYWR 0
 #endif
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
+#include "common/memory_accounting.h"
 #include "common/string_util.h"
-#include "common/threadsafe_queue.h"
 
 namespace Log {
 
+namespace {
+
+/// Start of each record in a log buffer, followed by the encoded arguments or the message
+struct RecordHeader {
+    u32 size;        ///< Size of the record with its header, records are 8 byte aligned
+    u32 args_size;   ///< Size of the data after the header
+    bool is_padding; ///< Skipped to wrap around the end of the buffer, nothing else is set
+    Class log_class;
+    Level log_level;
+    unsigned int line_num;
+    std::chrono::microseconds timestamp;
+    const char* filename;
+    const char* function;
+    const char* format;
+    detail::RecordFormatter formatter; ///< nullptr if the message was formatted already
+};
+
+/// Largest message formatted by the producer, longer ones are truncated
+constexpr std::size_t MAX_MESSAGE_SIZE = 16 * 1024;
+
+/**
+ * Ring of log records written by a single thread and read by the logging thread. Records are
+ * contiguous, a padding record fills the end of the buffer when the next record doesn't fit there.
+ */
+class RecordBuffer {
+public:
+    static constexpr std::size_t Capacity = 256 * 1024;
+
+    /// Largest record written, the producer waits for the logging thread when the buffer is full
+    static constexpr std::size_t MaxRecordSize = Capacity / 4;
+
+    RecordBuffer() : storage(Capacity / sizeof(u64)) {}
+
+    /// Reserves a record of the given size, returns nullptr if it is larger than MaxRecordSize
+    template <typename WaitFunc>
+    RecordHeader* Reserve(std::size_t record_size, WaitFunc&& wait) {
+        record_size = Common::AlignUp(record_size, alignof(RecordHeader));
+        if (record_size > MaxRecordSize) {
+            return nullptr;
+        }
+
+        // Only this thread writes the position, the logging thread only moves the read position
+        std::size_t position = write_position.load(std::memory_order_relaxed);
+        const std::size_t space_to_end = Capacity - position % Capacity;
+        const std::size_t padding = space_to_end < record_size ? space_to_end : 0;
+        while (position + padding + record_size -
+                   read_position.load(std::memory_order_acquire) >
+               Capacity) {
+            wait();
+        }
+
+        if (padding != 0) {
+            auto* const header = GetHeader(position);
+            header->size = static_cast<u32>(padding);
+            header->is_padding = true;
+            position += padding;
+        }
+        pending_position = position + record_size;
+        auto* const header = GetHeader(position);
+        header->size = static_cast<u32>(record_size);
+        header->is_padding = false;
+        return header;
+    }
+
+    /// Makes the record reserved last visible to the logging thread
+    void Publish() {
+        write_position.store(pending_position, std::memory_order_release);
+    }
+
+    /// Returns the oldest record that hasn't been read, nullptr if there are none
+    const RecordHeader* Peek() {
+        std::size_t position = read_position.load(std::memory_order_relaxed);
+        const std::size_t end = write_position.load(std::memory_order_acquire);
+        while (position != end) {
+            const auto* const header = GetHeader(position);
+            if (!header->is_padding) {
+                return header;
+            }
+            position += header->size;
+            read_position.store(position, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    /// Frees the record returned by Peek
+    void Pop() {
+        const std::size_t position = read_position.load(std::memory_order_relaxed);
+        read_position.store(position + GetHeader(position)->size, std::memory_order_release);
+    }
+
+    bool IsEmpty() const {
+        return read_position.load(std::memory_order_acquire) ==
+               write_position.load(std::memory_order_acquire);
+    }
+
+    /// Set once the thread writing the buffer exits, the buffer is removed once it is read
+    std::atomic_bool is_abandoned{false};
+
+private:
+    RecordHeader* GetHeader(std::size_t position) {
+        return reinterpret_cast<RecordHeader*>(reinterpret_cast<u8*>(storage.data()) +
+                                               position % Capacity);
+    }
+
+    std::vector<u64> storage;
+    Common::MemoryAccounting::Allocation accounting{Common::MemoryAccounting::Category::LogQueue,
+                                                    Capacity};
+
+    // Positions only increase, the offset in the buffer is the position modulo the capacity
+    alignas(64) std::atomic_size_t write_position{0};
+    alignas(64) std::atomic_size_t read_position{0};
+    std::size_t pending_position = 0; ///< End of the reserved record, owned by the producer
+};
+
+} // Anonymous namespace
+
 /**
  * Static state as a singleton.
  */
@@ -39,10 +157,55 @@ public:
     Impl(Impl const&) = delete;
     const Impl& operator=(Impl const&) = delete;
 
-    void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
-        message_queue.Push(
-            CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
+    /// Reserves a record in the buffer of the calling thread, see detail::BeginRecord
+    u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                    const char* function, const char* format, detail::RecordFormatter formatter,
+                    std::size_t args_size) {
+        auto& buffer = GetThreadBuffer();
+        auto* const header = buffer.Reserve(sizeof(RecordHeader) + args_size, [this] {
+            // The logging thread is behind, it is woken up in case it is sleeping
+            WakeUp();
+            std::this_thread::yield();
+        });
+        if (header == nullptr) {
+            return nullptr;
+        }
+
+        using std::chrono::duration_cast;
+        using std::chrono::steady_clock;
+        header->args_size = static_cast<u32>(args_size);
+        header->log_class = log_class;
+        header->log_level = log_level;
+        header->line_num = line_num;
+        header->timestamp =
+            duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+        header->filename = filename;
+        header->function = function;
+        header->format = format;
+        header->formatter = formatter;
+        return reinterpret_cast<u8*>(header + 1);
+    }
+
+    void EndRecord() {
+        GetThreadBuffer().Publish();
+
+        // Pairs with the fence of the logging thread, either it sees the record or we see that
+        // it is going to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (is_sleeping.load(std::memory_order_relaxed)) {
+            WakeUp();
+        }
+    }
+
+    void PushMessage(Class log_class, Level log_level, const char* filename,
+                     unsigned int line_num, const char* function, std::string message) {
+        if (message.size() > MAX_MESSAGE_SIZE) {
+            message.resize(MAX_MESSAGE_SIZE);
+        }
+        u8* const data = BeginRecord(log_class, log_level, filename, line_num, function, nullptr,
+                                     nullptr, message.size());
+        std::memcpy(data, message.data(), message.size());
+        EndRecord();
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -76,64 +239,153 @@ public:
     }
 
 private:
+    /// Owns the buffer of a thread for the logging thread to remove once it is read
+    struct BufferHolder {
+        ~BufferHolder() {
+            buffer->is_abandoned = true;
+        }
+
+        std::shared_ptr<RecordBuffer> buffer;
+    };
+
     Impl() {
         backend_thread = std::thread([&] {
-            Entry entry;
-            auto write_logs = [&](Entry& e) {
-                std::lock_guard lock{writing_mutex};
-                for (const auto& backend : backends) {
-                    backend->Write(e);
+            while (!stop_requested) {
+                if (WriteNextEntry()) {
+                    continue;
                 }
-            };
-            while (true) {
-                entry = message_queue.PopWait();
-                if (entry.final_entry) {
-                    break;
+
+                // Producers only take the lock to wake this thread up once it is sleeping
+                is_sleeping = true;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!HasRecords()) {
+                    std::unique_lock lock{wake_mutex};
+                    wake_condition.wait_for(lock, std::chrono::milliseconds{100},
+                                            [this] { return is_wake_requested || stop_requested; });
+                    is_wake_requested = false;
                 }
-                write_logs(entry);
+                is_sleeping = false;
             }
 
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
             // where a system is repeatedly spamming logs even on close.
             const int MAX_LOGS_TO_WRITE = filter.IsDebug() ? INT_MAX : 100;
             int logs_written = 0;
-            while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
-                write_logs(entry);
+            while (logs_written++ < MAX_LOGS_TO_WRITE && WriteNextEntry()) {
             }
         });
     }
 
     ~Impl() {
-        Entry entry;
-        entry.final_entry = true;
-        message_queue.Push(entry);
+        {
+            std::lock_guard lock{wake_mutex};
+            stop_requested = true;
+        }
+        wake_condition.notify_one();
         backend_thread.join();
     }
 
-    Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                      const char* function, std::string message) const {
-        using std::chrono::duration_cast;
-        using std::chrono::steady_clock;
+    RecordBuffer& GetThreadBuffer() {
+        thread_local const BufferHolder holder{[this] {
+            auto buffer = std::make_shared<RecordBuffer>();
+            std::lock_guard lock{buffers_mutex};
+            buffers.push_back(buffer);
+            return buffer;
+        }()};
+        return *holder.buffer;
+    }
 
-        Entry entry;
-        entry.timestamp =
-            duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
-        entry.log_class = log_class;
-        entry.log_level = log_level;
-        entry.filename = Common::TrimSourcePath(filename);
-        entry.line_num = line_nr;
-        entry.function = function;
-        entry.message = std::move(message);
+    void WakeUp() {
+        {
+            std::lock_guard lock{wake_mutex};
+            is_wake_requested = true;
+        }
+        wake_condition.notify_one();
+    }
+
+    bool HasRecords() {
+        std::lock_guard lock{buffers_mutex};
+        return std::any_of(buffers.begin(), buffers.end(),
+                           [](const auto& buffer) { return !buffer->IsEmpty(); });
+    }
+
+    /// Formats and writes the oldest record of all the threads, returns false if there are none
+    bool WriteNextEntry() {
+        RecordBuffer* oldest_buffer = nullptr;
+        const RecordHeader* oldest = nullptr;
+        {
+            std::lock_guard lock{buffers_mutex};
+            for (auto it = buffers.begin(); it != buffers.end();) {
+                auto& buffer = **it;
+                // The record has to be peeked after the check, the thread may log before exiting
+                const bool is_abandoned = buffer.is_abandoned;
+                const auto* const header = buffer.Peek();
+                if (header == nullptr && is_abandoned) {
+                    it = buffers.erase(it);
+                    continue;
+                }
+                if (header != nullptr &&
+                    (oldest == nullptr || header->timestamp < oldest->timestamp)) {
+                    oldest_buffer = &buffer;
+                    oldest = header;
+                }
+                ++it;
+            }
+        }
+        if (oldest == nullptr) {
+            return false;
+        }
+
+        // Buffers are only removed by this thread, the record stays valid until it is popped
+        Entry entry = CreateEntry(*oldest);
+        oldest_buffer->Pop();
+
+        std::lock_guard lock{writing_mutex};
+        for (const auto& backend : backends) {
+            backend->Write(entry);
+        }
+        return true;
+    }
+
+    Entry CreateEntry(const RecordHeader& header) const {
+        const auto* const data = reinterpret_cast<const u8*>(&header + 1);
 
+        Entry entry;
+        entry.timestamp = header.timestamp;
+        entry.log_class = header.log_class;
+        entry.log_level = header.log_level;
+        entry.filename = Common::TrimSourcePath(header.filename);
+        entry.line_num = header.line_num;
+        entry.function = header.function;
+        if (header.formatter == nullptr) {
+            entry.message.assign(reinterpret_cast<const char*>(data), header.args_size);
+        } else {
+            // The format string used to be checked when logging, errors now surface here
+            try {
+                entry.message = header.formatter(header.format, data);
+            } catch (const fmt::format_error& error) {
+                entry.message = fmt::format("Invalid log format \"{}\": {}", header.format,
+                                            error.what());
+            }
+        }
         return entry;
     }
 
     std::mutex writing_mutex;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
-    Common::MPSCQueue<Log::Entry> message_queue;
     Filter filter;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
+
+    // Buffers of the threads that logged, the list only changes when a thread logs the first time
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<RecordBuffer>> buffers;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    std::atomic_bool is_sleeping{false};
+    bool is_wake_requested = false;
+    std::atomic_bool stop_requested{false};
 };
 
 void ConsoleBackend::Write(const Entry& entry) {
@@ -316,7 +568,26 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
     if (!filter.CheckMessage(log_class, log_level))
         return;
 
-    instance.PushEntry(log_class, log_level, filename, line_num, function,
-                       fmt::vformat(format, args));
+    instance.PushMessage(log_class, log_level, filename, line_num, function,
+                         fmt::vformat(format, args));
 }
+
+namespace detail {
+
+bool IsLogged(Class log_class, Level log_level) {
+    return Impl::Instance().GetGlobalFilter().CheckMessage(log_class, log_level);
+}
+
+u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                const char* function, const char* format, RecordFormatter formatter,
+                std::size_t args_size) {
+    return Impl::Instance().BeginRecord(log_class, log_level, filename, line_num, function,
+                                        format, formatter, args_size);
+}
+
+void EndRecord() {
+    Impl::Instance().EndRecord();
+}
+
+} // namespace detail
 } // namespace Log
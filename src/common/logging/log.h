@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -124,14 +129,147 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
-/// Logs a message to the global logger, using fmt
+/// Logs a message to the global logger, formatting it right away, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+namespace detail {
+
+/// Formats the message of a record from its format string and the encoded arguments
+using RecordFormatter = std::string (*)(const char* format, const u8* data);
+
+/// Returns true if messages of this class and level pass the global filter
+bool IsLogged(Class log_class, Level log_level);
+
+/**
+ * Reserves a record in the log buffer of the calling thread, which is written without locks and
+ * formatted later by the logging thread. Returns nullptr if the arguments are too large for it.
+ */
+u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                const char* function, const char* format, RecordFormatter formatter,
+                std::size_t args_size);
+
+/// Hands the record reserved by BeginRecord over to the logging thread
+void EndRecord();
+
+/// Type an argument is encoded as, character arrays decay to pointers
+template <typename T>
+using ArgType = std::conditional_t<std::is_same_v<std::decay_t<T>, char*>, const char*,
+                                   std::decay_t<T>>;
+
+template <typename T>
+constexpr bool IsStringArg = std::is_same_v<T, const char*> || std::is_same_v<T, std::string> ||
+                             std::is_same_v<T, std::string_view>;
+
+/// Arguments that are copied into records. Anything else may own or point to memory that is gone
+/// by the time the record is formatted, so messages with them are formatted right away.
+template <typename T>
+constexpr bool IsDeferredArg = std::is_arithmetic_v<T> || std::is_enum_v<T> || IsStringArg<T>;
+
+/// Type an argument is decoded as, strings point into the record
+template <typename T>
+using DecodedArg = std::conditional_t<IsStringArg<T>, std::string_view, T>;
+
+template <typename T>
+std::string_view AsStringView(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return value != nullptr ? std::string_view{value} : std::string_view{"(null)"};
+    } else {
+        return value;
+    }
+}
+
+template <typename T>
+std::size_t EncodedSize(const T& value) {
+    if constexpr (IsStringArg<T>) {
+        return sizeof(u32) + AsStringView(value).size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+u8* Encode(u8* data, const T& value) {
+    if constexpr (IsStringArg<T>) {
+        const std::string_view view = AsStringView(value);
+        const auto size = static_cast<u32>(view.size());
+        std::memcpy(data, &size, sizeof(size));
+        std::memcpy(data + sizeof(size), view.data(), size);
+        return data + sizeof(size) + size;
+    } else {
+        std::memcpy(data, &value, sizeof(T));
+        return data + sizeof(T);
+    }
+}
+
+template <typename T>
+DecodedArg<T> Decode(const u8*& data) {
+    if constexpr (IsStringArg<T>) {
+        u32 size;
+        std::memcpy(&size, data, sizeof(size));
+        const std::string_view view{reinterpret_cast<const char*>(data + sizeof(size)), size};
+        data += sizeof(size) + size;
+        return view;
+    } else {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+}
+
+template <typename... Args>
+std::string FormatRecord(const char* format, [[maybe_unused]] const u8* data) {
+    // Braced initializers are evaluated in order, the arguments are decoded like they were encoded
+    const std::tuple<DecodedArg<Args>...> args{Decode<Args>(data)...};
+    return std::apply(
+        [format](const auto&... values) {
+            return fmt::vformat(format, fmt::make_format_args(values...));
+        },
+        args);
+}
+
+} // namespace detail
+
+/// Logs a message using fmt, formatting it right away. Used for formats that aren't string
+/// literals, which may be gone by the time the logging thread formats the record.
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if (!detail::IsLogged(log_class, log_level)) {
+        return;
+    }
+    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                      fmt::make_format_args(args...));
+}
+
+/**
+ * Logs a message using fmt, the format must be a string literal. Records only keep a pointer to
+ * their format, so it has to outlive them. The logging macros make sure of it by pasting an empty
+ * literal in front of the format, anything but a literal fails to compile there.
+ */
+template <typename... Args>
+void FmtLogLiteralMessage(Class log_class, Level log_level, const char* filename,
+                          unsigned int line_num, const char* function, const char* format,
+                          const Args&... args) {
+    if (!detail::IsLogged(log_class, log_level)) {
+        return;
+    }
+
+    // The arguments are copied and formatted on the logging thread, away from the emulation
+    if constexpr ((detail::IsDeferredArg<detail::ArgType<Args>> && ...)) {
+        const std::size_t args_size =
+            (std::size_t{0} + ... + detail::EncodedSize<detail::ArgType<Args>>(args));
+        u8* data = detail::BeginRecord(log_class, log_level, filename, line_num, function, format,
+                                       &detail::FormatRecord<detail::ArgType<Args>...>,
+                                       args_size);
+        if (data != nullptr) {
+            ((data = detail::Encode<detail::ArgType<Args>>(data, args)), ...);
+            detail::EndRecord();
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -140,24 +278,24 @@ void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsig
 
 #ifdef _DEBUG
 #define LOG_TRACE(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Trace, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Trace, __FILE__,            \
+                                __LINE__, __func__, "" __VA_ARGS__)
 #else
 #define LOG_TRACE(log_class, fmt, ...) (void(0))
 #endif
 
 #define LOG_DEBUG(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Debug, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Debug, __FILE__,            \
+                                __LINE__, __func__, "" __VA_ARGS__)
 #define LOG_INFO(log_class, ...)                                                                   \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Info, __FILE__, __LINE__,          \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Info, __FILE__,             \
+                                __LINE__, __func__, "" __VA_ARGS__)
 #define LOG_WARNING(log_class, ...)                                                                \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Warning, __FILE__, __LINE__,       \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Warning, __FILE__,          \
+                                __LINE__, __func__, "" __VA_ARGS__)
 #define LOG_ERROR(log_class, ...)                                                                  \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Error, __FILE__, __LINE__,         \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Error, __FILE__,            \
+                                __LINE__, __func__, "" __VA_ARGS__)
 #define LOG_CRITICAL(log_class, ...)                                                               \
-    ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Critical, __FILE__, __LINE__,      \
-                         __func__, __VA_ARGS__)
+    ::Log::FmtLogLiteralMessage(::Log::Class::log_class, ::Log::Level::Critical, __FILE__,         \
+                                __LINE__, __func__, "" __VA_ARGS__)
@@ -59,18 +59,23 @@ std::vector<u8> CompressDataLZ4HCMax(const u8* source, std::size_t source_size)
     return CompressDataLZ4HC(source, source_size, LZ4HC_CLEVEL_MAX);
 }
 
-std::vector<u8> DecompressDataLZ4(const std::vector<u8>& compressed,
-                                  std::size_t uncompressed_size) {
-    std::vector<u8> uncompressed(uncompressed_size);
-    const int size_check = LZ4_decompress_safe(reinterpret_cast<const char*>(compressed.data()),
-                                               reinterpret_cast<char*>(uncompressed.data()),
-                                               static_cast<int>(compressed.size()),
-                                               static_cast<int>(uncompressed.size()));
-    if (static_cast<int>(uncompressed_size) != size_check) {
+PooledVector DecompressDataLZ4(const std::vector<u8>& compressed, std::size_t uncompressed_size) {
+    PooledVector uncompressed = BufferPool::Acquire(uncompressed_size);
+    if (!DecompressDataLZ4(compressed.data(), compressed.size(), uncompressed.data(),
+                           uncompressed.size())) {
         // Decompression failed
         return {};
     }
     return uncompressed;
 }
 
+bool DecompressDataLZ4(const u8* compressed, std::size_t compressed_size, u8* uncompressed,
+                       std::size_t uncompressed_size) {
+    const int size_check = LZ4_decompress_safe(reinterpret_cast<const char*>(compressed),
+                                               reinterpret_cast<char*>(uncompressed),
+                                               static_cast<int>(compressed_size),
+                                               static_cast<int>(uncompressed_size));
+    return static_cast<int>(uncompressed_size) == size_check;
+}
+
 } // namespace Common::Compression
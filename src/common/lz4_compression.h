@@ -6,6 +6,7 @@
 
 #include <vector>
 
+#include "common/buffer_pool.h"
 #include "common/common_types.h"
 
 namespace Common::Compression {
@@ -45,13 +46,27 @@ std::vector<u8> CompressDataLZ4HC(const u8* source, std::size_t source_size, s32
 std::vector<u8> CompressDataLZ4HCMax(const u8* source, std::size_t source_size);
 
 /**
- * Decompresses a source memory region with LZ4 and returns the uncompressed data in a vector.
+ * Decompresses a source memory region with LZ4 and returns the uncompressed data in a buffer of the
+ * buffer pool.
  *
  * @param compressed the compressed source memory region.
  * @param uncompressed_size the size in bytes of the uncompressed data.
  *
- * @return the decompressed data.
+ * @return the decompressed data, empty if decompression failed.
  */
-std::vector<u8> DecompressDataLZ4(const std::vector<u8>& compressed, std::size_t uncompressed_size);
+PooledVector DecompressDataLZ4(const std::vector<u8>& compressed, std::size_t uncompressed_size);
+
+/**
+ * Decompresses a source memory region with LZ4 into a destination memory region.
+ *
+ * @param compressed the compressed source memory region.
+ * @param compressed_size the size in bytes of the compressed source memory region.
+ * @param uncompressed the destination memory region.
+ * @param uncompressed_size the size in bytes of the uncompressed data.
+ *
+ * @return true if exactly uncompressed_size bytes were decompressed.
+ */
+bool DecompressDataLZ4(const u8* compressed, std::size_t compressed_size, u8* uncompressed,
+                       std::size_t uncompressed_size);
 
 } // namespace Common::Compression
\ No newline at end of file
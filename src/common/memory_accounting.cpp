@@ -0,0 +1,88 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include "common/assert.h"
+#include "common/memory_accounting.h"
+
+namespace Common::MemoryAccounting {
+
+namespace {
+
+struct Counter {
+    std::atomic<u64> live{0};
+    std::atomic<u64> peak{0};
+};
+
+std::array<Counter, NumCategories> counters;
+
+Counter& GetCounter(Category category) {
+    const auto index = static_cast<std::size_t>(category);
+    ASSERT(index < NumCategories);
+    return counters[index];
+}
+
+} // Anonymous namespace
+
+const char* GetName(Category category) {
+    switch (category) {
+    case Category::GuestMemory:
+        return "GuestMemory";
+    case Category::PageTables:
+        return "PageTables";
+    case Category::TextureCache:
+        return "TextureCache";
+    case Category::BufferCache:
+        return "BufferCache";
+    case Category::ShaderCache:
+        return "ShaderCache";
+    case Category::ShaderDiskCache:
+        return "ShaderDiskCache";
+    case Category::TextureDiskCache:
+        return "TextureDiskCache";
+    case Category::AudioBuffers:
+        return "AudioBuffers";
+    case Category::VfsCache:
+        return "VfsCache";
+    case Category::LogQueue:
+        return "LogQueue";
+    default:
+        UNREACHABLE();
+        return "Unknown";
+    }
+}
+
+bool IsDeviceMemory(Category category) {
+    return category == Category::TextureCache || category == Category::BufferCache;
+}
+
+void Allocate(Category category, u64 bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    Counter& counter = GetCounter(category);
+    const u64 live = counter.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    u64 peak = counter.peak.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void Free(Category category, u64 bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    GetCounter(category).live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+u64 GetLiveBytes(Category category) {
+    return GetCounter(category).live.load(std::memory_order_relaxed);
+}
+
+u64 GetPeakBytes(Category category) {
+    return GetCounter(category).peak.load(std::memory_order_relaxed);
+}
+
+} // namespace Common::MemoryAccounting
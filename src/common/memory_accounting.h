@@ -0,0 +1,85 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common::MemoryAccounting {
+
+/// Major consumers of memory, each reports the bytes it currently holds. Memory reserved from the
+/// host is included whole, even though it is only resident once it is written.
+enum class Category : u32 {
+    GuestMemory,      ///< Memory blocks mapped into the guest processes, as reserved
+    PageTables,       ///< Page tables of the CPU and GPU address spaces, as reserved
+    TextureCache,     ///< Textures of the cached surfaces, in VRAM
+    BufferCache,      ///< Stream buffer and device local buffers of the buffer cache, in VRAM
+    ShaderCache,      ///< Sources of the cached shaders
+    ShaderDiskCache,  ///< Precompiled entries of the shader disk cache waiting to be written
+    TextureDiskCache, ///< Decoded textures of the texture disk cache waiting to be written
+    AudioBuffers,     ///< Sample buffers queued to the audio streams
+    VfsCache,         ///< Blocks of the cache of expensive to read files
+    LogQueue,         ///< Buffers holding the log records before they are written
+
+    NumCategories,
+};
+
+constexpr std::size_t NumCategories = static_cast<std::size_t>(Category::NumCategories);
+
+/// Returns the name of the category, as used in the reports
+const char* GetName(Category category);
+
+/// Returns true if the category is an estimate of host GPU memory rather than host RAM
+bool IsDeviceMemory(Category category);
+
+/// Adds bytes to the category, from any thread
+void Allocate(Category category, u64 bytes);
+
+/// Removes bytes previously added to the category, from any thread
+void Free(Category category, u64 bytes);
+
+/// Returns the bytes the category currently holds
+u64 GetLiveBytes(Category category);
+
+/// Returns the most bytes the category held at once since the start of the process
+u64 GetPeakBytes(Category category);
+
+/**
+ * Bytes held by an object, reported to a category for as long as the object is alive. Objects
+ * whose size changes resize their allocation instead of reporting the difference themselves.
+ */
+class Allocation final {
+public:
+    explicit Allocation(Category category, u64 bytes = 0) : category{category}, bytes{bytes} {
+        Allocate(category, bytes);
+    }
+
+    ~Allocation() {
+        Free(category, bytes);
+    }
+
+    Allocation(const Allocation&) = delete;
+    Allocation& operator=(const Allocation&) = delete;
+
+    /// Changes the bytes held, reporting the difference
+    void Resize(u64 new_bytes) {
+        if (new_bytes > bytes) {
+            Allocate(category, new_bytes - bytes);
+        } else {
+            Free(category, bytes - new_bytes);
+        }
+        bytes = new_bytes;
+    }
+
+    u64 GetSize() const {
+        return bytes;
+    }
+
+private:
+    Category category;
+    u64 bytes;
+};
+
+} // namespace Common::MemoryAccounting
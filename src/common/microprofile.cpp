@@ -5,3 +5,37 @@
 // Includes the MicroProfile implementation in this file for compilation
 #define MICROPROFILE_IMPL 1
 #include "common/microprofile.h"
+
+#include <atomic>
+
+namespace {
+std::atomic<Common::MicroProfileGpuTimer*> gpu_timer{};
+} // Anonymous namespace
+
+namespace Common {
+
+void SetMicroProfileGpuTimer(MicroProfileGpuTimer* timer) {
+    gpu_timer.store(timer, std::memory_order_release);
+}
+
+} // namespace Common
+
+uint32_t MicroProfileGpuInsertTimeStamp() {
+    Common::MicroProfileGpuTimer* const timer = gpu_timer.load(std::memory_order_acquire);
+    return timer ? timer->InsertTimestamp() : 1;
+}
+
+uint64_t MicroProfileGpuGetTimeStamp(uint32_t key) {
+    Common::MicroProfileGpuTimer* const timer = gpu_timer.load(std::memory_order_acquire);
+    return timer ? timer->GetTimestamp(key) : 0;
+}
+
+uint64_t MicroProfileTicksPerSecondGpu() {
+    Common::MicroProfileGpuTimer* const timer = gpu_timer.load(std::memory_order_acquire);
+    return timer ? timer->GetTicksPerSecond() : 1;
+}
+
+int MicroProfileGetGpuTickReference(int64_t* cpu_ticks, int64_t* gpu_ticks) {
+    Common::MicroProfileGpuTimer* const timer = gpu_timer.load(std::memory_order_acquire);
+    return timer && timer->GetTickReference(cpu_ticks, gpu_ticks) ? 1 : 0;
+}
@@ -11,7 +11,7 @@
 // Customized Citra settings.
 // This file wraps the MicroProfile header so that these are consistent everywhere.
 #define MICROPROFILE_WEBSERVER 0
-#define MICROPROFILE_GPU_TIMERS 0 // TODO: Implement timer queries when we upgrade to OpenGL 3.3
+#define MICROPROFILE_GPU_TIMERS 1 // Timestamps are provided by Common::MicroProfileGpuTimer
 #define MICROPROFILE_CONTEXT_SWITCH_TRACE 0
 #define MICROPROFILE_PER_THREAD_BUFFER_SIZE (2048 << 13) // 16 MB
 
@@ -22,8 +22,35 @@ typedef void* HANDLE;
 
 #include <microprofile.h>
 
+#include "common/common_types.h"
+
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
 
+namespace Common {
+
+/**
+ * Source of the timestamps of the MicroProfile GPU timeline, implemented by the renderer. A key
+ * is returned when a timestamp is inserted and it's resolved to GPU ticks a few frames later.
+ */
+class MicroProfileGpuTimer {
+public:
+    virtual ~MicroProfileGpuTimer() = default;
+
+    virtual u32 InsertTimestamp() = 0;
+
+    virtual u64 GetTimestamp(u32 key) = 0;
+
+    virtual u64 GetTicksPerSecond() const = 0;
+
+    /// Returns a CPU and a GPU tick taken at the same time, false if there's none yet
+    virtual bool GetTickReference(s64* cpu_ticks, s64* gpu_ticks) = 0;
+};
+
+/// Sets the source of the GPU timestamps, null disables the GPU timeline
+void SetMicroProfileGpuTimer(MicroProfileGpuTimer* timer);
+
+} // namespace Common
+
 // On OS X, some Mach header included by MicroProfile defines these as macros, conflicting with
 // identifiers we use.
 #ifdef PAGE_SIZE
@@ -2,11 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
+
 #include "common/page_table.h"
 
 namespace Common {
 
-PageTable::PageTable(std::size_t page_size_in_bits) : page_size_in_bits{page_size_in_bits} {}
+namespace {
+std::atomic<u64> next_generation{1};
+} // Anonymous namespace
+
+PageTable::PageTable(std::size_t page_size_in_bits)
+    : page_size_in_bits{page_size_in_bits}, generation{next_generation.fetch_add(1)} {}
 
 PageTable::~PageTable() = default;
 
@@ -14,18 +21,16 @@ void PageTable::Resize(std::size_t address_space_width_in_bits) {
     const std::size_t num_page_table_entries = 1ULL
                                                << (address_space_width_in_bits - page_size_in_bits);
 
+    // Unlike std::vector, resizing a VirtualBuffer does not touch its contents. A 39-bit address
+    // space would otherwise commit more than 2GB of zeroed table entries up front, most of which
+    // are never mapped.
     pointers.resize(num_page_table_entries);
     attributes.resize(num_page_table_entries);
     backing_addr.resize(num_page_table_entries);
-
-    // The default is a 39-bit address space, which causes an initial 1GB allocation size. If the
-    // vector size is subsequently decreased (via resize), the vector might not automatically
-    // actually reallocate/resize its underlying allocation, which wastes up to ~800 MB for
-    // 36-bit titles. Call shrink_to_fit to reduce capacity to what's actually in use.
-
-    pointers.shrink_to_fit();
-    attributes.shrink_to_fit();
-    backing_addr.shrink_to_fit();
+    generation = next_generation.fetch_add(1);
+    accounting.Resize(num_page_table_entries *
+                      (sizeof(*pointers.data()) + sizeof(*attributes.data()) +
+                       sizeof(*backing_addr.data())));
 }
 
 } // namespace Common
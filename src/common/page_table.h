@@ -4,10 +4,11 @@
 
 #pragma once
 
-#include <vector>
 #include <boost/icl/interval_map.hpp>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "common/memory_hook.h"
+#include "common/virtual_buffer.h"
 
 namespace Common {
 
@@ -19,7 +20,8 @@ enum class PageType : u8 {
     /// Page is mapped to regular memory, but also needs to check for rasterizer cache flushing and
     /// invalidation
     RasterizerCachedMemory,
-    /// Page is mapped to a I/O region. Writing and reading to this page is handled by functions.
+    /// Page is mapped to a I/O region or watched by a debug hook. Writing and reading to this page
+    /// is handled by functions, accesses they don't handle go to the backing memory if it has any.
     Special,
     /// Page is allocated for use.
     Allocated,
@@ -52,33 +54,48 @@ struct PageTable {
 
     /**
      * Resizes the page table to be able to accomodate enough pages within
-     * a given address space.
+     * a given address space. The resized table is entirely unmapped.
+     *
+     * The backing storage is reserved from the host virtual memory manager, so only the parts of
+     * the table that are actually mapped consume physical memory.
      *
      * @param address_space_width_in_bits The address size width in bits.
      */
     void Resize(std::size_t address_space_width_in_bits);
 
     /**
-     * Vector of memory pointers backing each page. An entry can only be non-null if the
+     * Array of memory pointers backing each page. An entry can only be non-null if the
      * corresponding entry in the `attributes` vector is of type `Memory`.
      */
-    std::vector<u8*> pointers;
+    VirtualBuffer<u8*> pointers;
 
     /**
-     * Contains MMIO handlers that back memory regions whose entries in the `attribute` vector is
+     * Contains MMIO handlers that back memory regions whose entries in the `attribute` array is
      * of type `Special`.
      */
     boost::icl::interval_map<u64, std::set<SpecialRegion>> special_regions;
 
     /**
-     * Vector of fine grained page attributes. If it is set to any value other than `Memory`, then
+     * Array of fine grained page attributes. If it is set to any value other than `Memory`, then
      * the corresponding entry in `pointers` MUST be set to null.
      */
-    std::vector<PageType> attributes;
+    VirtualBuffer<PageType> attributes;
 
-    std::vector<u64> backing_addr;
+    /**
+     * Array of the addresses backing each page. For CPU page tables this is the host address of
+     * the page, which, unlike `pointers`, stays valid while the page is rasterizer cached. For GPU
+     * page tables this is the CPU virtual address the page is mapped to.
+     */
+    VirtualBuffer<u64> backing_addr;
 
     const std::size_t page_size_in_bits{};
+
+    /// Identifies the storage of the arrays, a new value is assigned every time they are
+    /// reallocated. Values are never reused, not even by other tables, unlike host addresses.
+    u64 generation{};
+
+    /// Reserved size of the arrays, only the parts of them that are mapped are resident
+    MemoryAccounting::Allocation accounting{MemoryAccounting::Category::PageTables};
 };
 
 } // namespace Common
@@ -5,18 +5,21 @@
 #pragma once
 
 #include <algorithm>
-#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 #include <new>
 #include <type_traits>
+#include <utility>
 #include <vector>
 #include "common/common_types.h"
+#include "common/virtual_buffer.h"
 
 namespace Common {
 
-/// SPSC ring buffer
+/// SPSC ring buffer. Its memory is mirrored when the host allows it, so regions that wrap around
+/// the end of the buffer can be written and read in place.
 /// @tparam T            Element type
 /// @tparam capacity     Number of slots in ring buffer
 /// @tparam granularity  Slot size in terms of number of elements
@@ -33,6 +36,31 @@ class RingBuffer {
     static_assert(std::atomic_size_t::is_always_lock_free);
 
 public:
+    /// Contiguous slots of the ring buffer
+    template <typename U>
+    struct Span {
+        U* data;          ///< First element of the first slot
+        std::size_t size; ///< Number of slots
+    };
+
+    RingBuffer() {
+        m_data = static_cast<T*>(AllocateMirroredMemory(capacity * slot_size));
+        if (m_data == nullptr) {
+            // Sizes that aren't multiples of the host pages can't be mirrored
+            m_fallback.resize(granularity * capacity);
+            m_data = m_fallback.data();
+        }
+    }
+
+    ~RingBuffer() {
+        if (IsMirrored()) {
+            FreeMirroredMemory(m_data, capacity * slot_size);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
     /// Pushes slots into the ring buffer
     /// @param new_slots   Pointer to the slots to push
     /// @param slot_count  Number of slots to push
@@ -47,9 +75,9 @@ public:
         const std::size_t second_copy = push_count - first_copy;
 
         const char* in = static_cast<const char*>(new_slots);
-        std::memcpy(m_data.data() + pos * granularity, in, first_copy * slot_size);
+        std::memcpy(m_data + pos * granularity, in, first_copy * slot_size);
         in += first_copy * slot_size;
-        std::memcpy(m_data.data(), in, second_copy * slot_size);
+        std::memcpy(m_data, in, second_copy * slot_size);
 
         m_write_index.store(write_index + push_count);
 
@@ -74,9 +102,9 @@ public:
         const std::size_t second_copy = pop_count - first_copy;
 
         char* out = static_cast<char*>(output);
-        std::memcpy(out, m_data.data() + pos * granularity, first_copy * slot_size);
+        std::memcpy(out, m_data + pos * granularity, first_copy * slot_size);
         out += first_copy * slot_size;
-        std::memcpy(out, m_data.data(), second_copy * slot_size);
+        std::memcpy(out, m_data, second_copy * slot_size);
 
         m_read_index.store(read_index + pop_count);
 
@@ -90,6 +118,42 @@ public:
         return out;
     }
 
+    /// Reserves free slots to be written in place, they are pushed by Commit. Without mirrored
+    /// memory the reservation stops at the end of the buffer.
+    /// @param slot_count  Number of slots to reserve
+    /// @returns The contiguous free slots, fewer than slot_count when there's less space
+    Span<T> Reserve(std::size_t slot_count) {
+        const std::size_t write_index = m_write_index.load();
+        const std::size_t slots_free = capacity + m_read_index.load() - write_index;
+        const std::size_t pos = write_index % capacity;
+        std::size_t count = std::min(slot_count, slots_free);
+        if (!IsMirrored()) {
+            count = std::min(count, capacity - pos);
+        }
+        return {m_data + pos * granularity, count};
+    }
+
+    /// Pushes the first slot_count slots of the last reservation
+    void Commit(std::size_t slot_count) {
+        m_write_index.store(m_write_index.load() + slot_count);
+    }
+
+    /// Returns the filled slots to be read in place, they are popped by Consume. The second span
+    /// holds the slots wrapping around the end of the buffer, it's empty with mirrored memory.
+    std::pair<Span<const T>, Span<const T>> Peek() const {
+        const std::size_t read_index = m_read_index.load();
+        const std::size_t slots_filled = m_write_index.load() - read_index;
+        const std::size_t pos = read_index % capacity;
+        const std::size_t first_count =
+            IsMirrored() ? slots_filled : std::min(slots_filled, capacity - pos);
+        return {{m_data + pos * granularity, first_count}, {m_data, slots_filled - first_count}};
+    }
+
+    /// Pops the first slot_count slots of the last peek
+    void Consume(std::size_t slot_count) {
+        m_read_index.store(m_read_index.load() + slot_count);
+    }
+
     /// @returns Number of slots used
     std::size_t Size() const {
         return m_write_index.load() - m_read_index.load();
@@ -100,6 +164,11 @@ public:
         return capacity;
     }
 
+    /// @returns True if the memory of the buffer is mirrored
+    bool IsMirrored() const {
+        return m_fallback.empty();
+    }
+
 private:
     // It is important to align the below variables for performance reasons:
     // Having them on the same cache-line would result in false-sharing between them.
@@ -113,7 +182,8 @@ private:
     alignas(128) std::atomic_size_t m_write_index{0};
 #endif
 
-    std::array<T, granularity * capacity> m_data;
+    T* m_data = nullptr;
+    std::vector<T> m_fallback; ///< Memory of the buffer when it couldn't be mirrored
 };
 
 } // namespace Common
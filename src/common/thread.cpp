@@ -2,9 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "common/common_types.h"
+#include "common/logging/log.h"
 #include "common/thread.h"
+#include "common/trace.h"
 #ifdef __APPLE__
 #include <mach/mach.h>
+#include <pthread.h>
 #elif defined(_WIN32)
 #include <windows.h>
 #else
@@ -18,6 +26,16 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <fmt/format.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -34,6 +52,8 @@ namespace Common {
 // This is implemented much nicer in upcoming msvc++, see:
 // http://msdn.microsoft.com/en-us/library/xcb2z8hs(VS.100).aspx
 void SetCurrentThreadName(const char* name) {
+    Trace::SetThreadName(name);
+
     static const DWORD MS_VC_EXCEPTION = 0x406D1388;
 
 #pragma pack(push, 8)
@@ -61,6 +81,7 @@ void SetCurrentThreadName(const char* name) {
 // MinGW with the POSIX threading model does not support pthread_setname_np
 #if !defined(_WIN32) || defined(_MSC_VER)
 void SetCurrentThreadName(const char* name) {
+    Trace::SetThreadName(name);
 #ifdef __APPLE__
     pthread_setname_np(name);
 #elif defined(__Bitrig__) || defined(__DragonFly__) || defined(__FreeBSD__) || defined(__OpenBSD__)
@@ -75,4 +96,335 @@ void SetCurrentThreadName(const char* name) {
 
 #endif
 
+void SetCurrentThreadPriority(ThreadPriority priority) {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), priority == ThreadPriority::Low
+                                              ? THREAD_PRIORITY_BELOW_NORMAL
+                                              : THREAD_PRIORITY_NORMAL);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(
+        priority == ThreadPriority::Low ? QOS_CLASS_UTILITY : QOS_CLASS_USER_INITIATED, 0);
+#elif defined(__linux__)
+    // Linux keeps a nice value for each thread, raising it needs no privileges
+    const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, tid, priority == ThreadPriority::Low ? 5 : 0);
+#else
+    (void)priority;
+#endif
+}
+
+namespace {
+
+/// Logical CPU of the host the process may run on
+struct HostCpu {
+    u32 index; ///< Number of the logical CPU
+    u32 core;  ///< Physical core, shared by SMT siblings
+    u32 node;  ///< NUMA node
+};
+
+#if defined(__linux__)
+
+/// Parses a CPU list of sysfs, such as "0-3,8-11"
+std::vector<u32> ParseCpuList(const std::string& list) {
+    std::vector<u32> cpus;
+    const char* pos = list.c_str();
+    while (true) {
+        char* end;
+        const unsigned long first = std::strtoul(pos, &end, 10);
+        if (end == pos) {
+            break;
+        }
+        unsigned long last = first;
+        if (*end == '-') {
+            last = std::strtoul(end + 1, &end, 10);
+        }
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<u32>(cpu));
+        }
+        if (*end != ',') {
+            break;
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+std::string ReadSysfsFile(const std::string& path) {
+    std::ifstream file{path};
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::optional<u32> ReadSysfsNumber(const std::string& path) {
+    const std::string text = ReadSysfsFile(path);
+    if (text.empty()) {
+        return std::nullopt;
+    }
+    return static_cast<u32>(std::strtoul(text.c_str(), nullptr, 10));
+}
+
+std::vector<HostCpu> DetectHostCpus() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return {};
+    }
+
+    std::map<u32, u32> cpu_nodes;
+    for (const u32 node : ParseCpuList(ReadSysfsFile("/sys/devices/system/node/online"))) {
+        const auto path = fmt::format("/sys/devices/system/node/node{}/cpulist", node);
+        for (const u32 cpu : ParseCpuList(ReadSysfsFile(path))) {
+            cpu_nodes[cpu] = node;
+        }
+    }
+
+    // Core ids are only unique within a package
+    std::map<std::pair<u32, u32>, u32> physical_cores;
+    std::vector<HostCpu> cpus;
+    for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        const auto topology = fmt::format("/sys/devices/system/cpu/cpu{}/topology/", cpu);
+        const u32 package = ReadSysfsNumber(topology + "physical_package_id").value_or(0);
+        // Without a topology, each logical CPU is taken for a physical core
+        const u32 core_id = ReadSysfsNumber(topology + "core_id").value_or(cpu);
+        const auto core = physical_cores.emplace(std::pair{package, core_id},
+                                                 static_cast<u32>(physical_cores.size()));
+        const auto node = cpu_nodes.find(cpu);
+        cpus.push_back({cpu, core.first->second, node != cpu_nodes.end() ? node->second : 0});
+    }
+    return cpus;
+}
+
+bool PinThread(pthread_t thread, const std::vector<u32>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const u32 cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+#elif defined(_WIN32)
+
+// Thread affinity masks only cover the first processor group, the CPUs of the others are left out
+constexpr u32 MaxPinnableCpus = sizeof(DWORD_PTR) * 8;
+
+std::vector<HostCpu> DetectHostCpus() {
+    DWORD_PTR process_mask;
+    DWORD_PTR system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        return {};
+    }
+
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+    std::vector<u8> buffer(length);
+    if (!GetLogicalProcessorInformationEx(
+            RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()),
+            &length)) {
+        return {};
+    }
+
+    std::vector<HostCpu> cpus(MaxPinnableCpus, HostCpu{0, ~0U, 0});
+    u32 num_cores = 0;
+    for (DWORD offset = 0; offset < length;) {
+        const auto& info =
+            *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(&buffer[offset]);
+        offset += info.Size;
+
+        const GROUP_AFFINITY* affinity = nullptr;
+        if (info.Relationship == RelationProcessorCore) {
+            affinity = &info.Processor.GroupMask[0];
+        } else if (info.Relationship == RelationNumaNode) {
+            affinity = &info.NumaNode.GroupMask;
+        }
+        if (affinity == nullptr || affinity->Group != 0) {
+            continue;
+        }
+        for (u32 cpu = 0; cpu < MaxPinnableCpus; ++cpu) {
+            if ((affinity->Mask >> cpu) & 1) {
+                if (info.Relationship == RelationProcessorCore) {
+                    cpus[cpu].core = num_cores;
+                } else {
+                    cpus[cpu].node = info.NumaNode.NodeNumber;
+                }
+            }
+        }
+        if (info.Relationship == RelationProcessorCore) {
+            ++num_cores;
+        }
+    }
+
+    for (u32 cpu = 0; cpu < MaxPinnableCpus; ++cpu) {
+        cpus[cpu].index = cpu;
+    }
+    cpus.erase(std::remove_if(cpus.begin(), cpus.end(),
+                              [process_mask](const HostCpu& cpu) {
+                                  return cpu.core == ~0U || !((process_mask >> cpu.index) & 1);
+                              }),
+               cpus.end());
+    return cpus;
+}
+
+bool PinThread(HANDLE thread, const std::vector<u32>& cpus) {
+    DWORD_PTR mask = 0;
+    for (const u32 cpu : cpus) {
+        mask |= DWORD_PTR{1} << cpu;
+    }
+    return SetThreadAffinityMask(thread, mask) != 0;
+}
+
+#else
+
+// Threads can't be pinned on the other hosts, macOS only takes affinity hints
+std::vector<HostCpu> DetectHostCpus() {
+    return {};
+}
+
+#endif
+
+/// Logical CPUs of the host the process may run on, detected before any thread is pinned
+const std::vector<HostCpu>& GetHostCpus() {
+    static const std::vector<HostCpu> cpus = DetectHostCpus();
+    return cpus;
+}
+
+struct Placement {
+    std::vector<std::vector<u32>> emulated_cores; ///< CPUs of each emulated core
+    std::vector<u32> gpu;
+    std::vector<u32> background;
+    std::vector<u32> unpinned; ///< Every CPU, empty if no thread has been pinned
+    bool is_pinned = false;
+};
+
+std::mutex placement_mutex;
+Placement placement;
+
+/// Returns the CPUs planned for a role, empty if the thread should be left where it is
+std::vector<u32> GetPlacementCpus(ThreadRole role, std::size_t index) {
+    std::lock_guard lock{placement_mutex};
+    if (!placement.is_pinned) {
+        return placement.unpinned;
+    }
+    switch (role) {
+    case ThreadRole::EmulatedCore:
+        if (index < placement.emulated_cores.size()) {
+            return placement.emulated_cores[index];
+        }
+        break;
+    case ThreadRole::Gpu:
+        if (!placement.gpu.empty()) {
+            return placement.gpu;
+        }
+        break;
+    case ThreadRole::Background:
+        break;
+    }
+    return placement.background;
+}
+
+} // Anonymous namespace
+
+void ConfigureThreadPlacement(bool pin_threads, std::size_t num_emulated_cores,
+                              bool has_gpu_thread) {
+    const std::vector<HostCpu>& cpus = GetHostCpus();
+    Placement new_placement;
+    {
+        // Threads pinned before are released
+        std::lock_guard lock{placement_mutex};
+        if (placement.is_pinned || !placement.unpinned.empty()) {
+            for (const HostCpu& cpu : cpus) {
+                new_placement.unpinned.push_back(cpu.index);
+            }
+        }
+    }
+
+    if (pin_threads && cpus.empty()) {
+        LOG_WARNING(Common, "Host threads can't be pinned on this host");
+    } else if (pin_threads) {
+        // Physical cores of each node and logical CPUs of each physical core, in CPU order
+        std::map<u32, std::vector<u32>> node_cores;
+        std::map<u32, std::vector<u32>> core_cpus;
+        for (const HostCpu& cpu : cpus) {
+            auto& siblings = core_cpus[cpu.core];
+            if (siblings.empty()) {
+                node_cores[cpu.node].push_back(cpu.core);
+            }
+            siblings.push_back(cpu.index);
+        }
+
+        // The threads of the emulation share one node, the one with the most physical cores
+        const auto node = std::max_element(
+            node_cores.begin(), node_cores.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.second.size() < rhs.second.size(); });
+        const std::vector<u32>& cores = node->second;
+        const std::size_t num_reserved = num_emulated_cores + (has_gpu_thread ? 1 : 0);
+
+        // At least one physical core is left to the background threads
+        if (cores.size() > num_reserved) {
+            for (std::size_t i = 0; i < num_emulated_cores; ++i) {
+                new_placement.emulated_cores.push_back(core_cpus[cores[i]]);
+            }
+            if (has_gpu_thread) {
+                new_placement.gpu = core_cpus[cores[num_emulated_cores]];
+            }
+            for (const auto& [core, siblings] : core_cpus) {
+                if (std::find(cores.begin(), cores.begin() + num_reserved, core) ==
+                    cores.begin() + num_reserved) {
+                    new_placement.background.insert(new_placement.background.end(),
+                                                    siblings.begin(), siblings.end());
+                }
+            }
+            new_placement.is_pinned = true;
+            LOG_INFO(Common,
+                     "Pinned {} host threads to physical cores of NUMA node {}, {} logical CPUs "
+                     "are left to background threads",
+                     num_reserved, node->first, new_placement.background.size());
+        } else {
+            LOG_WARNING(Common, "{} physical cores are too few to pin {} host threads",
+                        cores.size(), num_reserved);
+        }
+    }
+
+    std::lock_guard lock{placement_mutex};
+    placement = std::move(new_placement);
+}
+
+void SetCurrentThreadPlacement(ThreadRole role, std::size_t index) {
+#if defined(__linux__) || defined(_WIN32)
+    const std::vector<u32> cpus = GetPlacementCpus(role, index);
+    if (cpus.empty()) {
+        return;
+    }
+#ifdef _WIN32
+    const bool is_pinned = PinThread(GetCurrentThread(), cpus);
+#else
+    const bool is_pinned = PinThread(pthread_self(), cpus);
+#endif
+    if (!is_pinned) {
+        LOG_WARNING(Common, "Failed to pin a host thread");
+    }
+#else
+    (void)role;
+    (void)index;
+#endif
+}
+
+void SetThreadPlacement(std::thread& thread, ThreadRole role, std::size_t index) {
+    // MinGW threads don't expose a native handle of the host, they stay where they are
+#if defined(__linux__) || defined(_MSC_VER)
+    const std::vector<u32> cpus = GetPlacementCpus(role, index);
+    if (!cpus.empty() && !PinThread(thread.native_handle(), cpus)) {
+        LOG_WARNING(Common, "Failed to pin a host thread");
+    }
+#else
+    (void)thread;
+    (void)role;
+    (void)index;
+#endif
+}
+
 } // namespace Common
@@ -77,6 +77,40 @@ private:
     std::size_t generation = 0; // Incremented once each time the barrier is used
 };
 
+enum class ThreadPriority {
+    Low,    ///< Background work, yields the host cores to the threads running the emulation
+    Normal, ///< Default priority of new threads
+};
+
+/// Role of a host thread, decides the host cores it's placed on
+enum class ThreadRole {
+    EmulatedCore, ///< Runs an emulated CPU core, gets a physical host core to itself
+    Gpu,          ///< Runs the GPU commands, gets a physical host core to itself
+    Background,   ///< Worker and service threads, share the host cores left by the others
+};
+
 void SetCurrentThreadName(const char* name);
 
+/// Changes the scheduling priority of the calling thread, this is a hint the host may ignore
+void SetCurrentThreadPriority(ThreadPriority priority);
+
+/**
+ * Plans the host cores of the threads placed afterwards. With pinning, the emulated cores and the
+ * GPU thread get distinct physical cores of one NUMA node, so they share neither a core with an
+ * SMT sibling nor memory across nodes, and background threads get the host cores left. Without
+ * pinning, or on hosts with too few cores or no way to pin threads, threads run on any host core.
+ * @param pin_threads Whether threads are pinned to host cores
+ * @param num_emulated_cores Number of host threads running emulated cores
+ * @param has_gpu_thread Whether the GPU commands run on a thread of their own
+ */
+void ConfigureThreadPlacement(bool pin_threads, std::size_t num_emulated_cores,
+                              bool has_gpu_thread);
+
+/// Places the calling thread on the host cores planned for its role
+/// @param index Emulated core run by the thread, used by ThreadRole::EmulatedCore
+void SetCurrentThreadPlacement(ThreadRole role, std::size_t index = 0);
+
+/// Places another thread on the host cores planned for its role
+void SetThreadPlacement(std::thread& thread, ThreadRole role, std::size_t index = 0);
+
 } // namespace Common
@@ -0,0 +1,162 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+namespace {
+
+/// Pool and queue of the worker running on this thread, if any
+thread_local ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // Anonymous namespace
+
+ThreadPool::ThreadPool(std::size_t num_threads, const char* name) : num_active{num_threads} {
+    ASSERT(num_threads > 0);
+    queues.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i, name);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{sleep_mutex};
+        stop_requested = true;
+    }
+    sleep_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetInstance() {
+    // The thread that uses the pool first keeps a core
+    static ThreadPool pool{std::max(std::thread::hardware_concurrency(), 2U) - 1};
+    return pool;
+}
+
+void ThreadPool::ReserveHostThreads(std::size_t count) {
+    const std::size_t num_cores = std::max(std::thread::hardware_concurrency(), 1U);
+    const std::size_t num_threads =
+        std::clamp<std::size_t>(num_cores > count ? num_cores - count : 1, 1, workers.size());
+    LOG_INFO(Common, "Running background work on {} threads, {} are left to the emulation",
+             num_threads, count);
+    {
+        std::lock_guard lock{sleep_mutex};
+        num_active = num_threads;
+    }
+    sleep_condition.notify_all();
+
+    // The workers follow the placement planned for the emulation, away from its host cores
+    for (auto& worker : workers) {
+        SetThreadPlacement(worker, ThreadRole::Background);
+    }
+}
+
+void ThreadPool::Push(Task task, TaskPriority priority) {
+    // Tasks queued by a task of this pool are likely to use the same data, they stay on its worker
+    const std::size_t index =
+        current_pool == this ? current_queue : next_queue++ % num_active;
+    ++num_queued;
+    {
+        auto& queue = *queues[index];
+        std::lock_guard lock{queue.mutex};
+        queue.tasks[static_cast<std::size_t>(priority)].push_back(std::move(task));
+    }
+
+    // The lock orders the wake up after a worker that is about to sleep has checked the count
+    { std::lock_guard lock{sleep_mutex}; }
+    sleep_condition.notify_one();
+}
+
+bool ThreadPool::Pop(std::size_t index, Task& task) {
+    for (std::size_t priority = 0; priority < NumPriorities; ++priority) {
+        // The worker takes its newest task, other workers steal the oldest ones
+        {
+            auto& queue = *queues[index];
+            std::lock_guard lock{queue.mutex};
+            auto& tasks = queue.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                --num_queued;
+                return true;
+            }
+        }
+        for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+            auto& queue = *queues[(index + offset) % queues.size()];
+            std::lock_guard lock{queue.mutex};
+            auto& tasks = queue.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                --num_queued;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::RunParallelFor(std::shared_ptr<ParallelForState> state, TaskPriority priority) {
+    // The calling thread takes its share, at most one task per worker is needed for the rest
+    const std::size_t num_tasks = std::min<std::size_t>(state->num_chunks - 1, num_active);
+    for (std::size_t i = 0; i < num_tasks; ++i) {
+        Push([state] { RunChunks(*state); }, priority);
+    }
+    RunChunks(*state);
+
+    std::unique_lock lock{state->mutex};
+    state->done_condition.wait(lock, [&] { return state->num_done == state->num_chunks; });
+}
+
+void ThreadPool::RunChunks(ParallelForState& state) {
+    for (std::size_t chunk; (chunk = state.next_chunk++) < state.num_chunks;) {
+        const std::size_t begin = state.count * chunk / state.num_chunks;
+        const std::size_t end = state.count * (chunk + 1) / state.num_chunks;
+        state.chunk(begin, end);
+
+        std::lock_guard lock{state.mutex};
+        if (++state.num_done == state.num_chunks) {
+            state.done_condition.notify_all();
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop(std::size_t index, const char* name) {
+    SetCurrentThreadName(name);
+    SetCurrentThreadPriority(ThreadPriority::Low);
+    current_pool = this;
+    current_queue = index;
+
+    Task task;
+    while (true) {
+        if (index < num_active && Pop(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock{sleep_mutex};
+        sleep_condition.wait(lock, [this, index] {
+            return stop_requested || (index < num_active && num_queued > 0);
+        });
+        // The tasks that are left when the pool stops are run by the active workers
+        if (stop_requested && (num_queued == 0 || index >= num_active)) {
+            return;
+        }
+    }
+}
+
+} // namespace Common
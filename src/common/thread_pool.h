@@ -0,0 +1,151 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Common {
+
+/// Order in which queued tasks are run, higher priority tasks are taken first by every worker
+enum class TaskPriority {
+    High,   ///< Work a thread of the emulation is waiting for, like decoding a texture
+    Normal, ///< Work whose result is needed soon, like building a shader
+    Low,    ///< Background work, like compressing a dump
+};
+
+/**
+ * Pool of worker threads shared by the parts of the emulator that split work between host
+ * threads. Each worker has its own queue, tasks submitted from a worker go to its queue and idle
+ * workers steal from the others. The workers run at a low priority and the shared pool leaves
+ * host cores to the emulated ones, so background work doesn't compete with the emulation.
+ */
+class ThreadPool {
+public:
+    /// Creates a pool with num_threads workers, the threads are named after the given name
+    explicit ThreadPool(std::size_t num_threads, const char* name = "yuzu:Worker");
+
+    /// Runs the tasks that are left and stops the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the pool shared by the emulator, created on first use with a worker for each host
+    /// core but one
+    static ThreadPool& GetInstance();
+
+    /**
+     * Leaves a number of host cores to the threads running the emulation, the workers beyond the
+     * remaining cores stay idle. Their queued tasks are taken by the others.
+     */
+    void ReserveHostThreads(std::size_t count);
+
+    /// Returns the number of workers running tasks
+    std::size_t GetNumThreads() const {
+        return num_active;
+    }
+
+    /**
+     * Queues a task, the returned future holds its result once it has run. Tasks must not wait
+     * for the futures of other tasks, every worker could end up waiting; use ParallelFor instead.
+     */
+    template <typename Func>
+    auto Submit(Func&& func, TaskPriority priority = TaskPriority::Normal)
+        -> std::future<std::invoke_result_t<std::decay_t<Func>>> {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        Push([task = std::move(task)] { (*task)(); }, priority);
+        return future;
+    }
+
+    /**
+     * Calls func(begin, end) on chunks covering [0, count) and waits for all of them. The calling
+     * thread runs chunks too, so this can be used from tasks of the pool.
+     * @param count Number of items to process
+     * @param min_chunk_size Fewest items worth handing to another thread
+     * @param func Function processing the items of a chunk
+     * @param priority Priority of the chunks run by the workers
+     */
+    template <typename Func>
+    void ParallelFor(std::size_t count, std::size_t min_chunk_size, Func&& func,
+                     TaskPriority priority = TaskPriority::High) {
+        if (count == 0) {
+            return;
+        }
+        min_chunk_size = std::max<std::size_t>(min_chunk_size, 1);
+        const std::size_t max_chunks = std::max<std::size_t>(count / min_chunk_size, 1);
+        // Chunks are claimed as threads get to them, more chunks than threads balance uneven work
+        const std::size_t num_chunks = std::min(max_chunks, (GetNumThreads() + 1) * 4);
+        if (num_chunks == 1) {
+            func(std::size_t{0}, count);
+            return;
+        }
+
+        // Workers may only get to their task once all the chunks are done, the state outlives
+        // this call for them. The function is only called while this call waits.
+        auto state = std::make_shared<ParallelForState>();
+        state->count = count;
+        state->num_chunks = num_chunks;
+        state->chunk = [&func](std::size_t begin, std::size_t end) { func(begin, end); };
+        RunParallelFor(std::move(state), priority);
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    static constexpr std::size_t NumPriorities = 3;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::array<std::deque<Task>, NumPriorities> tasks;
+    };
+
+    struct ParallelForState {
+        std::size_t count = 0;
+        std::size_t num_chunks = 0;
+        std::function<void(std::size_t, std::size_t)> chunk;
+        std::atomic_size_t next_chunk{0};
+        std::size_t num_done = 0;
+        std::mutex mutex;
+        std::condition_variable done_condition;
+    };
+
+    void Push(Task task, TaskPriority priority);
+
+    /// Takes the next task for a worker, from its own queue first and then from the others
+    bool Pop(std::size_t index, Task& task);
+
+    void RunParallelFor(std::shared_ptr<ParallelForState> state, TaskPriority priority);
+
+    /// Runs the chunks of a ParallelFor that are left, returns once no chunk is left to start
+    static void RunChunks(ParallelForState& state);
+
+    void WorkerLoop(std::size_t index, const char* name);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic_size_t next_queue{0}; ///< Queue of the next task submitted from another thread
+    std::atomic_size_t num_queued{0};
+    std::atomic_size_t num_active{0}; ///< Workers taking tasks, the first ones of the pool
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+    bool stop_requested = false;
+};
+
+} // namespace Common
@@ -7,13 +7,85 @@
 // a simple lockless thread-safe,
 // single reader, single writer queue
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 namespace Common {
+
+/**
+ * Lets threads sleep until a condition changed by another thread becomes true, without the
+ * notifying thread taking a lock while nobody sleeps. A waiter calls PrepareWait, checks the
+ * condition again and then either CancelWait or Wait. The notifier changes the condition and
+ * calls Notify.
+ */
+class EventCount {
+public:
+    /// Registers the calling thread as a waiter, returns the key to pass to Wait
+    std::size_t PrepareWait() {
+        num_waiters.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in Notify, either the notifier sees the waiter or the waiter sees
+        // the changed condition
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_relaxed);
+    }
+
+    /// Unregisters the waiter, when the condition was true after PrepareWait
+    void CancelWait() {
+        num_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Sleeps until a Notify after the PrepareWait that returned the key
+    void Wait(std::size_t key) {
+        std::unique_lock lock{mutex};
+        condition.wait(lock, [this, key] { return epoch.load(std::memory_order_relaxed) != key; });
+        num_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Wakes up the waiters, only takes the lock when there are any
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_waiters.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        {
+            std::lock_guard lock{mutex};
+            epoch.fetch_add(1, std::memory_order_relaxed);
+        }
+        condition.notify_all();
+    }
+
+    /// Returns once is_ready returns true, retrying spin_count times before going to sleep
+    template <typename Pred>
+    void Await(Pred&& is_ready, std::size_t spin_count = 0) {
+        for (std::size_t i = 0; i < spin_count; ++i) {
+            if (is_ready()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        while (!is_ready()) {
+            const std::size_t key = PrepareWait();
+            if (is_ready()) {
+                CancelWait();
+                return;
+            }
+            Wait(key);
+        }
+    }
+
+private:
+    std::atomic_size_t num_waiters{0};
+    std::atomic_size_t epoch{0};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
 template <typename T>
 class SPSCQueue {
 public:
@@ -46,9 +118,9 @@ public:
         ElementPtr* new_ptr = new ElementPtr();
         write_ptr->next.store(new_ptr, std::memory_order_release);
         write_ptr = new_ptr;
-        cv.notify_one();
 
         ++size;
+        not_empty.Notify();
     }
 
     void Pop() {
@@ -77,11 +149,8 @@ public:
     }
 
     T PopWait() {
-        if (Empty()) {
-            std::unique_lock lock{cv_mutex};
-            cv.wait(lock, [this]() { return !Empty(); });
-        }
-        T t;
+        not_empty.Await([this] { return !Empty(); });
+        T t{};
         Pop(t);
         return t;
     }
@@ -113,8 +182,7 @@ private:
     ElementPtr* write_ptr;
     ElementPtr* read_ptr;
     std::atomic_size_t size{0};
-    std::mutex cv_mutex;
-    std::condition_variable cv;
+    EventCount not_empty;
 };
 
 // a simple thread-safe,
@@ -138,7 +206,7 @@ public:
     template <typename Arg>
     void Push(Arg&& t) {
         std::lock_guard lock{write_lock};
-        spsc_queue.Push(t);
+        spsc_queue.Push(std::forward<Arg>(t));
     }
 
     void Pop() {
@@ -162,4 +230,264 @@ private:
     SPSCQueue<T> spsc_queue;
     std::mutex write_lock;
 };
+
+// a lockless thread-safe,
+// single reader, single writer queue with a fixed amount of slots.
+// Elements are stored inline, so pushing an element never allocates.
+
+template <typename T, std::size_t capacity>
+class BoundedSPSCQueue {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+public:
+    std::size_t Size() const {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    bool Full() const {
+        return Size() == capacity;
+    }
+
+    // Moves the element into the queue, the element is left untouched if the queue is full.
+    // Returns whether the element was pushed.
+    template <typename Arg>
+    bool TryPush(Arg&& t) {
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        if (write - read_index.load(std::memory_order_acquire) == capacity) {
+            return false;
+        }
+
+        slots[write & (capacity - 1)] = std::forward<Arg>(t);
+        write_index.store(write + 1, std::memory_order_release);
+        not_empty.Notify();
+        return true;
+    }
+
+    // Moves as many of the elements as fit into the queue, returns how many were pushed.
+    std::size_t PushBatch(T* elements, std::size_t count) {
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        const std::size_t free = capacity - (write - read_index.load(std::memory_order_acquire));
+        count = std::min(count, free);
+        if (count == 0) {
+            return 0;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            slots[(write + i) & (capacity - 1)] = std::move(elements[i]);
+        }
+        write_index.store(write + count, std::memory_order_release);
+        not_empty.Notify();
+        return count;
+    }
+
+    // Pushes the element, waiting for the consumer to make space if the queue is full.
+    template <typename Arg>
+    void PushWait(Arg&& t) {
+        while (!TryPush(std::forward<Arg>(t))) {
+            not_full.Await([this] { return !Full(); }, SpinCount);
+        }
+    }
+
+    bool Pop(T& t) {
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        if (read == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        t = std::move(slots[read & (capacity - 1)]);
+        read_index.store(read + 1, std::memory_order_release);
+        not_full.Notify();
+        return true;
+    }
+
+    // Moves up to max_count elements out of the queue, returns how many were popped.
+    std::size_t PopBatch(T* elements, std::size_t max_count) {
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        const std::size_t count =
+            std::min(max_count, write_index.load(std::memory_order_acquire) - read);
+        if (count == 0) {
+            return 0;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            elements[i] = std::move(slots[(read + i) & (capacity - 1)]);
+        }
+        read_index.store(read + count, std::memory_order_release);
+        not_full.Notify();
+        return count;
+    }
+
+    // Pops at least one element, waiting for the producer if the queue is empty.
+    std::size_t PopBatchWait(T* elements, std::size_t max_count) {
+        not_empty.Await([this] { return !Empty(); }, SpinCount);
+        return PopBatch(elements, max_count);
+    }
+
+    T PopWait() {
+        T t{};
+        PopBatchWait(&t, 1);
+        return t;
+    }
+
+private:
+    // Elements usually come in bursts, waits retry this many times before going to sleep
+    static constexpr std::size_t SpinCount = 64;
+
+    std::array<T, capacity> slots{};
+
+    // Keep the indices on their own cache lines, they are written by different threads
+    alignas(128) std::atomic_size_t write_index{0};
+    alignas(128) std::atomic_size_t read_index{0};
+
+    EventCount not_empty;
+    EventCount not_full;
+};
+
+// a lockless thread-safe,
+// single reader, multiple writer queue with a fixed amount of slots.
+// Writers claim slots by advancing the write index and publish each slot once it is written, so
+// neither pushing nor popping takes a lock or allocates.
+
+template <typename T, std::size_t capacity>
+class BoundedMPSCQueue {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+public:
+    // Includes the elements that are still being written
+    std::size_t Size() const {
+        const std::size_t read = read_index.load(std::memory_order_acquire);
+        return write_index.load(std::memory_order_acquire) - read;
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    bool Full() const {
+        return Size() == capacity;
+    }
+
+    // Moves the element into the queue, the element is left untouched if the queue is full.
+    // Returns whether the element was pushed.
+    template <typename Arg>
+    bool TryPush(Arg&& t) {
+        std::size_t first;
+        if (Claim(1, first) == 0) {
+            return false;
+        }
+        Publish(first, std::forward<Arg>(t));
+        not_empty.Notify();
+        return true;
+    }
+
+    // Moves as many of the elements as fit into the queue, returns how many were pushed.
+    // The pushed elements are contiguous in the queue.
+    std::size_t PushBatch(T* elements, std::size_t count) {
+        std::size_t first;
+        count = Claim(count, first);
+        for (std::size_t i = 0; i < count; ++i) {
+            Publish(first + i, std::move(elements[i]));
+        }
+        if (count != 0) {
+            not_empty.Notify();
+        }
+        return count;
+    }
+
+    // Pushes the element, waiting for the consumer to make space if the queue is full.
+    template <typename Arg>
+    void PushWait(Arg&& t) {
+        while (!TryPush(std::forward<Arg>(t))) {
+            not_full.Await([this] { return !Full(); }, SpinCount);
+        }
+    }
+
+    bool Pop(T& t) {
+        return PopBatch(&t, 1) != 0;
+    }
+
+    // Moves up to max_count published elements out of the queue, returns how many were popped.
+    std::size_t PopBatch(T* elements, std::size_t max_count) {
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (; count < max_count; ++count) {
+            Slot& slot = slots[(read + count) & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != read + count + 1) {
+                break;
+            }
+            elements[count] = std::move(slot.value);
+        }
+        if (count == 0) {
+            return 0;
+        }
+
+        read_index.store(read + count, std::memory_order_release);
+        not_full.Notify();
+        return count;
+    }
+
+    // Pops at least one element, waiting for the producers if the queue is empty.
+    std::size_t PopBatchWait(T* elements, std::size_t max_count) {
+        std::size_t count = 0;
+        not_empty.Await([&] { return (count = PopBatch(elements, max_count)) != 0; }, SpinCount);
+        return count;
+    }
+
+    T PopWait() {
+        T t{};
+        PopBatchWait(&t, 1);
+        return t;
+    }
+
+private:
+    // Elements usually come in bursts, waits retry this many times before going to sleep
+    static constexpr std::size_t SpinCount = 64;
+
+    struct Slot {
+        // One past the index of the element once it is published, the index tells the laps apart
+        std::atomic_size_t sequence{0};
+        T value{};
+    };
+
+    // Reserves up to max_count slots starting at first, returns how many were reserved.
+    std::size_t Claim(std::size_t max_count, std::size_t& first) {
+        std::size_t write = write_index.load(std::memory_order_relaxed);
+        while (true) {
+            // Slots before the read index have been moved out by the consumer
+            const std::size_t read = read_index.load(std::memory_order_acquire);
+            const std::size_t count = std::min(max_count, capacity - (write - read));
+            if (count == 0) {
+                return 0;
+            }
+            if (write_index.compare_exchange_weak(write, write + count,
+                                                  std::memory_order_relaxed)) {
+                first = write;
+                return count;
+            }
+        }
+    }
+
+    template <typename Arg>
+    void Publish(std::size_t index, Arg&& t) {
+        Slot& slot = slots[index & (capacity - 1)];
+        slot.value = std::forward<Arg>(t);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    std::array<Slot, capacity> slots{};
+
+    // Keep the indices on their own cache lines, they are written by different threads
+    alignas(128) std::atomic_size_t write_index{0};
+    alignas(128) std::atomic_size_t read_index{0};
+
+    EventCount not_empty;
+    EventCount not_full;
+};
 } // namespace Common
@@ -0,0 +1,226 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/trace.h"
+
+namespace Common::Trace {
+
+namespace Detail {
+std::atomic_bool enabled{false};
+} // namespace Detail
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class EventType : u8 {
+    Complete,
+    Counter,
+};
+
+struct Event {
+    const char* category;
+    const char* name;
+    u64 timestamp;
+    s64 value; ///< Duration of complete events in nanoseconds, value of counters
+    EventType type;
+};
+
+/// Events of a thread, only written by the thread itself
+struct ThreadBuffer {
+    std::vector<Event> events;
+    std::atomic<u64> num_written{0};
+    u32 thread_id = 0;
+    std::string name;               ///< Guarded by the registry mutex
+    std::atomic_bool exited{false}; ///< Set when the thread ends, the buffer is kept for export
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::size_t events_per_thread = DefaultEventsPerThread;
+    u32 next_thread_id = 1;
+    Clock::time_point start_time = Clock::now();
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+/// Marks the buffer of a thread as exited when the thread ends
+struct BufferOwner {
+    ~BufferOwner() {
+        if (buffer) {
+            buffer->exited = true;
+        }
+    }
+
+    std::shared_ptr<ThreadBuffer> buffer;
+    std::string name;
+};
+
+thread_local BufferOwner current_thread;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (current_thread.buffer) {
+        return *current_thread.buffer;
+    }
+
+    auto& registry = GetRegistry();
+    auto buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard lock{registry.mutex};
+    buffer->events.resize(registry.events_per_thread);
+    buffer->thread_id = registry.next_thread_id++;
+    buffer->name = current_thread.name.empty() ? fmt::format("Thread {}", buffer->thread_id)
+                                               : current_thread.name;
+    registry.buffers.push_back(buffer);
+    current_thread.buffer = std::move(buffer);
+    return *current_thread.buffer;
+}
+
+void Record(const Event& event) {
+    auto& buffer = GetThreadBuffer();
+    const u64 index = buffer.num_written.load(std::memory_order_relaxed);
+    buffer.events[index % buffer.events.size()] = event;
+    buffer.num_written.store(index + 1, std::memory_order_release);
+}
+
+/// Appends a string to the JSON output with the characters JSON reserves escaped
+void AppendEscaped(fmt::memory_buffer& out, const char* str) {
+    for (; *str != '\0'; ++str) {
+        const char c = *str;
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fmt::format_to(out, "\\u{:04x}", static_cast<int>(c));
+        } else {
+            out.push_back(c);
+        }
+    }
+}
+
+void AppendEvent(fmt::memory_buffer& out, const Event& event, u32 thread_id) {
+    out.append(std::string_view{",\n{\"name\":\""});
+    AppendEscaped(out, event.name);
+    out.append(std::string_view{"\",\"cat\":\""});
+    AppendEscaped(out, event.category);
+    // Chrome traces are in microseconds
+    const u64 timestamp = event.timestamp;
+    fmt::format_to(out, "\",\"ts\":{}.{:03},\"pid\":1,\"tid\":{},", timestamp / 1000,
+                   timestamp % 1000, thread_id);
+    switch (event.type) {
+    case EventType::Complete: {
+        const auto duration = static_cast<u64>(event.value);
+        fmt::format_to(out, "\"ph\":\"X\",\"dur\":{}.{:03}}}", duration / 1000, duration % 1000);
+        break;
+    }
+    case EventType::Counter:
+        fmt::format_to(out, "\"ph\":\"C\",\"args\":{{\"value\":{}}}}}", event.value);
+        break;
+    }
+}
+
+} // Anonymous namespace
+
+u64 GetTimestamp() {
+    const auto elapsed = Clock::now() - GetRegistry().start_time;
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    // Zero marks the scopes started while tracing was disabled
+    return static_cast<u64>(nanoseconds) + 1;
+}
+
+void RecordComplete(const char* category, const char* name, u64 start, u64 end) {
+    Record({category, name, start, static_cast<s64>(end - start), EventType::Complete});
+}
+
+void RecordCounter(const char* category, const char* name, s64 value) {
+    Record({category, name, GetTimestamp(), value, EventType::Counter});
+}
+
+void SetThreadName(const char* name) {
+    current_thread.name = name;
+    if (current_thread.buffer) {
+        std::lock_guard lock{GetRegistry().mutex};
+        current_thread.buffer->name = name;
+    }
+}
+
+void Start(std::size_t events_per_thread) {
+    auto& registry = GetRegistry();
+    std::lock_guard lock{registry.mutex};
+    auto& buffers = registry.buffers;
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                 [](const auto& buffer) { return buffer->exited.load(); }),
+                  buffers.end());
+    for (auto& buffer : buffers) {
+        buffer->num_written = 0;
+    }
+    registry.events_per_thread = std::max<std::size_t>(events_per_thread, 1);
+    registry.start_time = Clock::now();
+    Detail::enabled = true;
+}
+
+void Stop() {
+    Detail::enabled = false;
+}
+
+bool WriteChromeTrace(const std::string& path) {
+    FileUtil::IOFile file{path, "wb"};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common, "Failed to open the trace file {}", path);
+        return false;
+    }
+
+    auto& registry = GetRegistry();
+    std::lock_guard lock{registry.mutex};
+    fmt::memory_buffer out;
+    out.append(std::string_view{"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                                "\"args\":{\"name\":\"yuzu\"}}"});
+    std::size_t num_events = 0;
+    for (const auto& buffer : registry.buffers) {
+        const u64 num_written = buffer->num_written.load(std::memory_order_acquire);
+        if (num_written == 0) {
+            continue;
+        }
+        fmt::format_to(out, ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                            "\"args\":{{\"name\":\"",
+                       buffer->thread_id);
+        AppendEscaped(out, buffer->name.c_str());
+        out.append(std::string_view{"\"}}"});
+
+        // Once the ring has wrapped around, the oldest event is the one after the newest
+        const u64 size = buffer->events.size();
+        const u64 first = num_written > size ? num_written - size : 0;
+        for (u64 index = first; index < num_written; ++index) {
+            AppendEvent(out, buffer->events[index % size], buffer->thread_id);
+            if (out.size() >= 1 << 20) {
+                file.WriteBytes(out.data(), out.size());
+                out.clear();
+            }
+        }
+        num_events += num_written - first;
+    }
+    out.append(std::string_view{"\n]}\n"});
+    if (file.WriteBytes(out.data(), out.size()) != out.size()) {
+        LOG_ERROR(Common, "Failed to write the trace file {}", path);
+        return false;
+    }
+
+    LOG_INFO(Common, "Wrote {} events of {} threads to {}", num_events, registry.buffers.size(),
+             path);
+    return true;
+}
+
+} // namespace Common::Trace
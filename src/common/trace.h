@@ -0,0 +1,124 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include "common/common_types.h"
+#include "common/microprofile.h"
+
+/**
+ * Event tracer for offline analysis of the hot paths. While tracing, every thread records its
+ * scopes and counters to a ring buffer of its own, the buffers are written as a Chrome trace
+ * (chrome://tracing, Perfetto) once tracing is stopped. Tracing is off by default and a disabled
+ * scope costs a relaxed load.
+ */
+namespace Common::Trace {
+
+/// Events kept for each thread by default, the oldest ones are overwritten once it's full
+constexpr std::size_t DefaultEventsPerThread = 1 << 20;
+
+/// Category and name of a traced scope, both must live until the trace is written
+struct Label {
+    const char* category;
+    const char* name;
+};
+
+namespace Detail {
+extern std::atomic_bool enabled;
+} // namespace Detail
+
+/// Returns true while events are recorded
+inline bool IsEnabled() {
+    return Detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Returns the time in nanoseconds since tracing was started
+u64 GetTimestamp();
+
+/// Records a scope of the current thread that ran from start to end
+void RecordComplete(const char* category, const char* name, u64 start, u64 end);
+
+/// Records the value a counter has at the current time
+void RecordCounter(const char* category, const char* name, s64 value);
+
+/// Names the current thread in the trace, called by Common::SetCurrentThreadName
+void SetThreadName(const char* name);
+
+/**
+ * Starts recording events, the events of a previous trace are discarded.
+ * @param events_per_thread Size of the ring buffers of the threads that start recording
+ */
+void Start(std::size_t events_per_thread = DefaultEventsPerThread);
+
+/// Stops recording events, the recorded ones are kept until the next start
+void Stop();
+
+/**
+ * Writes the recorded events as Chrome trace JSON. Tracing should be stopped and the traced
+ * threads joined or idle, the buffers are read without synchronizing with their writers.
+ * @returns true on success
+ */
+bool WriteChromeTrace(const std::string& path);
+
+/// Records the time the current thread spends in a scope
+class Scope {
+public:
+    explicit Scope(const Label& label) : Scope{label.category, label.name} {}
+
+    Scope(const char* category, const char* name)
+        : category{category}, name{name}, start{IsEnabled() ? GetTimestamp() : 0} {}
+
+    ~Scope() {
+        if (start != 0 && IsEnabled()) {
+            RecordComplete(category, name, start, GetTimestamp());
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* category;
+    const char* name;
+    u64 start;
+};
+
+} // namespace Common::Trace
+
+/// Defines a MicroProfile timer that is also recorded by the tracer
+#define TRACE_DEFINE(var, group, timer, color)                                                     \
+    MICROPROFILE_DEFINE(var, group, timer, color);                                                 \
+    const ::Common::Trace::Label trace_label_##var{group, timer}
+
+/// Declares a timer of TRACE_DEFINE defined in another file
+#define TRACE_DECLARE(var)                                                                         \
+    MICROPROFILE_DECLARE(var);                                                                     \
+    extern const ::Common::Trace::Label trace_label_##var
+
+/// Times the enclosing scope with a timer of TRACE_DEFINE in MicroProfile and the tracer
+#define TRACE_SCOPE(var)                                                                           \
+    MICROPROFILE_SCOPE(var);                                                                       \
+    ::Common::Trace::Scope trace_scope_##var {                                                     \
+        trace_label_##var                                                                          \
+    }
+
+/// Traces the enclosing scope under a name only known at runtime, only recorded by the tracer
+#define TRACE_SCOPE_DYNAMIC(category, name)                                                        \
+    ::Common::Trace::Scope TRACE_TOKEN_PASTE(trace_scope_, __LINE__) {                             \
+        category, name                                                                             \
+    }
+
+/// Records the value of a counter, only recorded by the tracer
+#define TRACE_COUNTER(category, name, value)                                                       \
+    do {                                                                                           \
+        if (::Common::Trace::IsEnabled()) {                                                        \
+            ::Common::Trace::RecordCounter(category, name, static_cast<s64>(value));               \
+        }                                                                                          \
+    } while (0)
+
+#define TRACE_TOKEN_PASTE0(a, b) a##b
+#define TRACE_TOKEN_PASTE(a, b) TRACE_TOKEN_PASTE0(a, b)
@@ -0,0 +1,52 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Lock-free single producer, single consumer buffer of the latest state of something. The writer
+ * and the reader each own a copy and the third one is exchanged between them, so neither waits
+ * for the other and the reader always sees a complete state.
+ */
+template <typename T>
+class TripleBuffer {
+    static_assert(std::atomic<u32>::is_always_lock_free);
+
+public:
+    /// Returns the copy the writer fills, only visible to the reader once published.
+    T& GetWriteBuffer() {
+        return buffers[write_index];
+    }
+
+    /// Publishes the write buffer, the writer then fills the state the reader gave back last.
+    void Publish() {
+        const u32 previous = shared.exchange(write_index | NewStateBit, std::memory_order_acq_rel);
+        write_index = previous & IndexMask;
+    }
+
+    /// Returns the last published state, or the same one again when nothing was published since.
+    const T& Read() {
+        if (shared.load(std::memory_order_relaxed) & NewStateBit) {
+            read_index = shared.exchange(read_index, std::memory_order_acq_rel) & IndexMask;
+        }
+        return buffers[read_index];
+    }
+
+private:
+    static constexpr u32 IndexMask = 0x3;
+    static constexpr u32 NewStateBit = 0x4;
+
+    std::array<T, 3> buffers{};
+    std::atomic<u32> shared{1}; ///< Index of the exchanged copy, with NewStateBit if unread
+    u32 write_index = 0;
+    u32 read_index = 2;
+};
+
+} // namespace Common
@@ -0,0 +1,212 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <atomic>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fmt/format.h>
+#endif
+
+#include "common/assert.h"
+#include "common/virtual_buffer.h"
+
+namespace Common {
+
+void* AllocateMemoryPages(std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    void* base{VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)};
+#else
+    void* base{mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)};
+    if (base == MAP_FAILED) {
+        base = nullptr;
+    }
+#endif
+
+    ASSERT_MSG(base != nullptr, "Failed to allocate {} bytes of memory pages", size);
+    return base;
+}
+
+void FreeMemoryPages(void* base, std::size_t size) {
+    if (base == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    ASSERT(VirtualFree(base, 0, MEM_RELEASE));
+#else
+    ASSERT(munmap(base, size) == 0);
+#endif
+}
+
+void* ReserveMemoryPages(std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    void* base{VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_READWRITE)};
+#else
+    // Pages mapped without a reservation of swap space are only backed once they are touched
+    void* base{mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)};
+    if (base == MAP_FAILED) {
+        base = nullptr;
+    }
+#endif
+
+    ASSERT_MSG(base != nullptr, "Failed to reserve {} bytes of memory pages", size);
+    return base;
+}
+
+void CommitMemoryPages(void* base, std::size_t size) {
+    if (base == nullptr || size == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    ASSERT_MSG(VirtualAlloc(base, size, MEM_COMMIT, PAGE_READWRITE) == base,
+               "Failed to commit {} bytes of memory pages", size);
+#endif
+}
+
+void DecommitMemoryPages(void* base, std::size_t size) {
+    if (base == nullptr || size == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    ASSERT(VirtualFree(base, size, MEM_DECOMMIT));
+#else
+    // Mapping fresh pages over the range drops the old ones, unlike madvise this zeroes the range
+    // on every host
+    ASSERT(mmap(base, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0) == base);
+#endif
+}
+
+#ifndef _WIN32
+namespace {
+
+/// Creates an anonymous shared memory file of the given size, returns -1 on failure
+int CreateMemoryFile(std::size_t size) {
+#ifdef __linux__
+    const int fd = memfd_create("yuzu:mirror", MFD_CLOEXEC);
+#else
+    // The file is unlinked right away, the name only has to be unique for a moment
+    static std::atomic<u32> counter{0};
+    const std::string name = fmt::format("/yuzu-mirror-{}-{}", getpid(), counter++);
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+        shm_unlink(name.c_str());
+    }
+#endif
+    if (fd == -1) {
+        return -1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // Anonymous namespace
+#endif
+
+std::size_t GetMirroredMemoryGranularity() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void* AllocateMirroredMemory(std::size_t size) {
+    if (size == 0 || size % GetMirroredMemoryGranularity() != 0) {
+        return nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE mapping{CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<u64>(size) >> 32),
+                                      static_cast<DWORD>(size), nullptr)};
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+
+    // The views are placed where a reservation was released, another thread may map something
+    // there in the meantime, so a few places are tried
+    void* base{};
+    for (int attempt = 0; attempt < 16 && base == nullptr; ++attempt) {
+        auto* const place{static_cast<u8*>(VirtualAlloc(nullptr, size * 2, MEM_RESERVE,
+                                                        PAGE_NOACCESS))};
+        if (place == nullptr) {
+            break;
+        }
+        VirtualFree(place, 0, MEM_RELEASE);
+
+        void* const first{MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, place)};
+        if (first == nullptr) {
+            continue;
+        }
+        if (MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, place + size) == nullptr) {
+            UnmapViewOfFile(first);
+            continue;
+        }
+        base = place;
+    }
+
+    // The views keep the mapping alive
+    CloseHandle(mapping);
+    return base;
+#else
+    const int fd{CreateMemoryFile(size)};
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    // Both views replace a reservation, so nothing else can be mapped between them
+    void* base{mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+    if (base != MAP_FAILED) {
+        u8* const place{static_cast<u8*>(base)};
+        constexpr int prot{PROT_READ | PROT_WRITE};
+        if (mmap(place, size, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(place + size, size, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(base, size * 2);
+            base = MAP_FAILED;
+        }
+    }
+
+    // The mappings keep the file alive
+    close(fd);
+    return base == MAP_FAILED ? nullptr : base;
+#endif
+}
+
+void FreeMirroredMemory(void* base, std::size_t size) {
+    if (base == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    ASSERT(UnmapViewOfFile(base));
+    ASSERT(UnmapViewOfFile(static_cast<u8*>(base) + size));
+#else
+    ASSERT(munmap(base, size * 2) == 0);
+#endif
+}
+
+} // namespace Common
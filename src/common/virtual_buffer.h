@@ -0,0 +1,120 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Allocates zero-initialized memory pages directly from the host OS. Pages are only backed by
+ * physical memory once they are touched. POSIX hosts don't reserve swap space for them either,
+ * Windows commits the whole allocation up front and charges it against the commit limit.
+ */
+void* AllocateMemoryPages(std::size_t size);
+
+/// Releases memory previously allocated with AllocateMemoryPages.
+void FreeMemoryPages(void* base, std::size_t size);
+
+/**
+ * Reserves address space for memory pages without committing them, so the reservation doesn't
+ * count against the commit limit of the host. Pages must be committed with CommitMemoryPages
+ * before they are accessed. Release the reservation with FreeMemoryPages.
+ */
+void* ReserveMemoryPages(std::size_t size);
+
+/// Commits a page aligned range of a reservation, the range reads as zero.
+void CommitMemoryPages(void* base, std::size_t size);
+
+/// Returns the physical memory of a page aligned range of a reservation to the host OS. The range
+/// must be committed again before it is accessed, it reads as zero afterwards.
+void DecommitMemoryPages(void* base, std::size_t size);
+
+/// Returns the granularity of the host mappings, sizes of mirrored memory are multiples of it.
+std::size_t GetMirroredMemoryGranularity();
+
+/**
+ * Allocates zero-initialized memory mapped twice in a row, the byte at base + size + i is the
+ * byte at base + i. Ring buffers in mirrored memory can hand out contiguous regions that wrap
+ * around their end.
+ * @param size Size of the memory, a multiple of GetMirroredMemoryGranularity
+ * @returns The base of the 2 * size bytes of mappings, null if the host couldn't map them
+ */
+void* AllocateMirroredMemory(std::size_t size);
+
+/// Releases memory previously allocated with AllocateMirroredMemory.
+void FreeMirroredMemory(void* base, std::size_t size);
+
+/**
+ * Fixed-size buffer of trivial objects allocated from the host virtual memory manager. Unlike
+ * std::vector, constructing or resizing the buffer does not touch its contents, so large sparse
+ * tables (such as page tables covering a whole address space) only consume physical memory for
+ * the entries that are actually written. Every element starts out zero-initialized. On Windows
+ * the whole buffer still counts against the commit limit, see AllocateMemoryPages.
+ */
+template <typename T>
+class VirtualBuffer final : NonCopyable {
+public:
+    constexpr VirtualBuffer() = default;
+
+    explicit VirtualBuffer(std::size_t count) : alloc_size{count * sizeof(T)} {
+        base_ptr = static_cast<T*>(AllocateMemoryPages(alloc_size));
+    }
+
+    ~VirtualBuffer() {
+        FreeMemoryPages(base_ptr, alloc_size);
+    }
+
+    /// Replaces the buffer with a new zero-initialized buffer of the given number of elements.
+    void resize(std::size_t count) {
+        FreeMemoryPages(base_ptr, alloc_size);
+
+        alloc_size = count * sizeof(T);
+        base_ptr = static_cast<T*>(AllocateMemoryPages(alloc_size));
+    }
+
+    constexpr const T& operator[](std::size_t index) const {
+        return base_ptr[index];
+    }
+
+    constexpr T& operator[](std::size_t index) {
+        return base_ptr[index];
+    }
+
+    constexpr T* data() {
+        return base_ptr;
+    }
+
+    constexpr const T* data() const {
+        return base_ptr;
+    }
+
+    constexpr T* begin() {
+        return base_ptr;
+    }
+
+    constexpr const T* begin() const {
+        return base_ptr;
+    }
+
+    constexpr T* end() {
+        return base_ptr + size();
+    }
+
+    constexpr const T* end() const {
+        return base_ptr + size();
+    }
+
+    constexpr std::size_t size() const {
+        return alloc_size / sizeof(T);
+    }
+
+private:
+    std::size_t alloc_size{};
+    T* base_ptr{};
+};
+
+} // namespace Common
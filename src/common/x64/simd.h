@@ -0,0 +1,26 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+
+// yuzu is built for baseline x86-64, only the functions marked with AVX2_TARGET may use AVX2 and
+// they must not be called unless HasAVX2 returns true
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+namespace Common {
+
+/// Returns whether the host CPU supports AVX2, the detection is only done on the first call
+inline bool HasAVX2() {
+    static const bool has_avx2 = GetCPUCaps().avx2;
+    return has_avx2;
+}
+
+} // namespace Common
@@ -48,4 +48,12 @@ std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed) {
     return decompressed;
 }
 
+bool DecompressDataZSTD(const u8* compressed, std::size_t compressed_size, u8* decompressed,
+                        std::size_t decompressed_size) {
+    const std::size_t uncompressed_result_size =
+        ZSTD_decompress(decompressed, decompressed_size, compressed, compressed_size);
+    return !ZSTD_isError(uncompressed_result_size) &&
+           uncompressed_result_size == decompressed_size;
+}
+
 } // namespace Common::Compression
@@ -41,4 +41,17 @@ std::vector<u8> CompressDataZSTDDefault(const u8* source, std::size_t source_siz
  */
 std::vector<u8> DecompressDataZSTD(const std::vector<u8>& compressed);
 
+/**
+ * Decompresses a source memory region with Zstandard into a destination memory region.
+ *
+ * @param compressed the compressed source memory region.
+ * @param compressed_size the size in bytes of the compressed source memory region.
+ * @param decompressed the destination memory region.
+ * @param decompressed_size the size in bytes of the decompressed data.
+ *
+ * @return true if exactly decompressed_size bytes were decompressed.
+ */
+bool DecompressDataZSTD(const u8* compressed, std::size_t compressed_size, u8* decompressed,
+                        std::size_t decompressed_size);
+
 } // namespace Common::Compression
\ No newline at end of file
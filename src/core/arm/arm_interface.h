@@ -53,6 +53,9 @@ public:
     /// Clear all instruction cache
     virtual void ClearInstructionCache() = 0;
 
+    /// Clear the cached instructions of the given range of memory
+    virtual void InvalidateCacheRange(VAddr addr, std::size_t size) = 0;
+
     /// Notifies CPU emulation that the current page table has changed.
     ///
     /// @param new_page_table                 The new page table.
@@ -7,7 +7,7 @@
 #include <dynarmic/A64/a64.h>
 #include <dynarmic/A64/config.h>
 #include "common/logging/log.h"
-#include "common/microprofile.h"
+#include "common/trace.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
@@ -99,7 +99,7 @@ public:
     }
 
     void CallSVC(u32 swi) override {
-        Kernel::CallSVC(parent.system, swi);
+        Kernel::CallSVC(parent.system, parent, swi);
     }
 
     void AddTicks(u64 ticks) override {
@@ -157,12 +157,19 @@ std::unique_ptr<Dynarmic::A64::Jit> ARM_Dynarmic::MakeJit(Common::PageTable& pag
     return std::make_unique<Dynarmic::A64::Jit>(config);
 }
 
-MICROPROFILE_DEFINE(ARM_Jit_Dynarmic, "ARM JIT", "Dynarmic", MP_RGB(255, 64, 64));
+TRACE_DEFINE(ARM_Jit_Dynarmic, "ARM JIT", "Dynarmic", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    MICROPROFILE_SCOPE(ARM_Jit_Dynarmic);
+    TRACE_SCOPE(ARM_Jit_Dynarmic);
 
     jit->Run();
+
+    // Watchpoints halt the JIT from the memory callbacks, they can't trap in the middle of a block
+    if (GDBStub::IsServerEnabled() && GDBStub::IsMemoryBreak()) {
+        Kernel::Thread* thread = Kernel::GetCurrentThread();
+        SaveContext(thread->GetContext());
+        GDBStub::SendTrap(thread, 5);
+    }
 }
 
 void ARM_Dynarmic::Step() {
@@ -264,13 +271,27 @@ void ARM_Dynarmic::ClearInstructionCache() {
     jit->ClearCache();
 }
 
+void ARM_Dynarmic::InvalidateCacheRange(VAddr addr, std::size_t size) {
+    jit->InvalidateCacheRange(addr, size);
+}
+
 void ARM_Dynarmic::ClearExclusiveState() {
     jit->ClearExclusiveState();
 }
 
 void ARM_Dynarmic::PageTableChanged(Common::PageTable& page_table,
                                     std::size_t new_address_space_size_in_bits) {
+    // Switching back to the page table the JIT already runs on keeps all translated blocks.
+    // Anything else needs a new instance, as the page table is baked into the emitted code. The
+    // table is compared by generation, a reallocated table may get the address of another one.
+    if (jit != nullptr && jit_page_table_generation == page_table.generation &&
+        jit_address_space_bits == new_address_space_size_in_bits) {
+        return;
+    }
+
     jit = MakeJit(page_table, new_address_space_size_in_bits);
+    jit_page_table_generation = page_table.generation;
+    jit_address_space_bits = new_address_space_size_in_bits;
 }
 
 DynarmicExclusiveMonitor::DynarmicExclusiveMonitor(std::size_t core_count) : monitor(core_count) {}
@@ -48,6 +48,7 @@ public:
     void ClearExclusiveState() override;
 
     void ClearInstructionCache() override;
+    void InvalidateCacheRange(VAddr addr, std::size_t size) override;
     void PageTableChanged(Common::PageTable& new_page_table,
                           std::size_t new_address_space_size_in_bits) override;
 
@@ -60,6 +61,10 @@ private:
     std::unique_ptr<Dynarmic::A64::Jit> jit;
     ARM_Unicorn inner_unicorn;
 
+    /// Page table generation and address space size the current JIT instance was created for.
+    u64 jit_page_table_generation = 0;
+    std::size_t jit_address_space_bits = 0;
+
     std::size_t core_index;
     System& system;
     DynarmicExclusiveMonitor& exclusive_monitor;
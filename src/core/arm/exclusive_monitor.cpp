@@ -3,9 +3,83 @@
 // Refer to the license.txt file included.
 
 #include "core/arm/exclusive_monitor.h"
+#include "core/memory.h"
 
 namespace Core {
 
 ExclusiveMonitor::~ExclusiveMonitor() = default;
 
+ReservationExclusiveMonitor::ReservationExclusiveMonitor(std::size_t core_count)
+    : core_count{core_count}, reservations{std::make_unique<Reservation[]>(core_count)} {}
+
+ReservationExclusiveMonitor::~ReservationExclusiveMonitor() = default;
+
+template <typename Write>
+bool ReservationExclusiveMonitor::ExclusiveOperation(std::size_t core_index, VAddr vaddr,
+                                                     Write&& write) {
+    const VAddr cacheline = vaddr >> CACHELINE_BITS;
+    auto& reservation = reservations[core_index];
+    if (reservation.cacheline.exchange(INVALID_CACHELINE, std::memory_order_acquire) !=
+        cacheline) {
+        return false;
+    }
+    // The version only moves forward, the swap fails if any write committed after the mark.
+    // Writes to the cacheline are serialized while the version is odd.
+    auto& version = GetVersion(cacheline);
+    u64 expected = reservation.version;
+    if (!version.compare_exchange_strong(expected, expected + 1, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+        return false;
+    }
+    write();
+    version.store(expected + 2, std::memory_order_release);
+    return true;
+}
+
+void ReservationExclusiveMonitor::SetExclusive(std::size_t core_index, VAddr addr) {
+    const VAddr cacheline = addr >> CACHELINE_BITS;
+    const u64 version = GetVersion(cacheline).load(std::memory_order_acquire);
+    auto& reservation = reservations[core_index];
+    if ((version & 1) != 0) {
+        // Another core is writing to the cacheline, a write started now couldn't succeed
+        reservation.cacheline.store(INVALID_CACHELINE, std::memory_order_relaxed);
+        return;
+    }
+    reservation.version = version;
+    reservation.cacheline.store(cacheline, std::memory_order_release);
+}
+
+void ReservationExclusiveMonitor::ClearExclusive() {
+    for (std::size_t core = 0; core < core_count; ++core) {
+        reservations[core].cacheline.store(INVALID_CACHELINE, std::memory_order_relaxed);
+    }
+}
+
+bool ReservationExclusiveMonitor::ExclusiveWrite8(std::size_t core_index, VAddr vaddr, u8 value) {
+    return ExclusiveOperation(core_index, vaddr, [&] { Memory::Write8(vaddr, value); });
+}
+
+bool ReservationExclusiveMonitor::ExclusiveWrite16(std::size_t core_index, VAddr vaddr,
+                                                   u16 value) {
+    return ExclusiveOperation(core_index, vaddr, [&] { Memory::Write16(vaddr, value); });
+}
+
+bool ReservationExclusiveMonitor::ExclusiveWrite32(std::size_t core_index, VAddr vaddr,
+                                                   u32 value) {
+    return ExclusiveOperation(core_index, vaddr, [&] { Memory::Write32(vaddr, value); });
+}
+
+bool ReservationExclusiveMonitor::ExclusiveWrite64(std::size_t core_index, VAddr vaddr,
+                                                   u64 value) {
+    return ExclusiveOperation(core_index, vaddr, [&] { Memory::Write64(vaddr, value); });
+}
+
+bool ReservationExclusiveMonitor::ExclusiveWrite128(std::size_t core_index, VAddr vaddr,
+                                                    u128 value) {
+    return ExclusiveOperation(core_index, vaddr, [&] {
+        Memory::Write64(vaddr + 0, value[0]);
+        Memory::Write64(vaddr + 8, value[1]);
+    });
+}
+
 } // namespace Core
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include "common/common_types.h"
 
 namespace Core {
@@ -22,4 +26,54 @@ public:
     virtual bool ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) = 0;
 };
 
+/**
+ * Exclusive monitor that doesn't take a global lock. Every core has a reservation slot holding the
+ * cacheline it marked and the version the cacheline had at that time. Cachelines hash into a
+ * table of version counters, an exclusive write commits by moving the version of its cacheline
+ * to a busy state with a compare and swap, which fails if another core wrote to the cacheline
+ * since the mark. Cachelines sharing a counter may fail each other's writes, as STXR is allowed to.
+ */
+class ReservationExclusiveMonitor final : public ExclusiveMonitor {
+public:
+    explicit ReservationExclusiveMonitor(std::size_t core_count);
+    ~ReservationExclusiveMonitor() override;
+
+    void SetExclusive(std::size_t core_index, VAddr addr) override;
+    void ClearExclusive() override;
+
+    bool ExclusiveWrite8(std::size_t core_index, VAddr vaddr, u8 value) override;
+    bool ExclusiveWrite16(std::size_t core_index, VAddr vaddr, u16 value) override;
+    bool ExclusiveWrite32(std::size_t core_index, VAddr vaddr, u32 value) override;
+    bool ExclusiveWrite64(std::size_t core_index, VAddr vaddr, u64 value) override;
+    bool ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) override;
+
+private:
+    static constexpr std::size_t CACHELINE_BITS = 6;
+    static constexpr std::size_t NUM_VERSIONS = 1024;
+    static constexpr VAddr INVALID_CACHELINE = ~VAddr{0};
+
+    /// Reservation of a core, only its own core marks it
+    struct alignas(64) Reservation {
+        std::atomic<VAddr> cacheline{INVALID_CACHELINE};
+        u64 version = 0;
+    };
+
+    /// Version of the cachelines hashing to it, odd while an exclusive write is in progress
+    struct alignas(64) Version {
+        std::atomic<u64> value{0};
+    };
+
+    /// Runs the write if the core still holds the reservation, the reservation is always cleared
+    template <typename Write>
+    bool ExclusiveOperation(std::size_t core_index, VAddr vaddr, Write&& write);
+
+    std::atomic<u64>& GetVersion(VAddr cacheline) {
+        return versions[cacheline % NUM_VERSIONS].value;
+    }
+
+    std::size_t core_count;
+    std::unique_ptr<Reservation[]> reservations;
+    std::array<Version, NUM_VERSIONS> versions;
+};
+
 } // namespace Core
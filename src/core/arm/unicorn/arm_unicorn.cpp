@@ -5,7 +5,7 @@
 #include <algorithm>
 #include <unicorn/arm64.h>
 #include "common/assert.h"
-#include "common/microprofile.h"
+#include "common/trace.h"
 #include "core/arm/unicorn/arm_unicorn.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -170,10 +170,10 @@ void ARM_Unicorn::Step() {
     ExecuteInstructions(1);
 }
 
-MICROPROFILE_DEFINE(ARM_Jit_Unicorn, "ARM JIT", "Unicorn", MP_RGB(255, 64, 64));
+TRACE_DEFINE(ARM_Jit_Unicorn, "ARM JIT", "Unicorn", MP_RGB(255, 64, 64));
 
 void ARM_Unicorn::ExecuteInstructions(int num_instructions) {
-    MICROPROFILE_SCOPE(ARM_Jit_Unicorn);
+    TRACE_SCOPE(ARM_Jit_Unicorn);
     CHECKED(uc_emu_start(uc, GetPC(), 1ULL << 63, 0, num_instructions));
     system.CoreTiming().AddTicks(num_instructions);
     if (GDBStub::IsServerEnabled()) {
@@ -253,6 +253,8 @@ void ARM_Unicorn::ClearExclusiveState() {}
 
 void ARM_Unicorn::ClearInstructionCache() {}
 
+void ARM_Unicorn::InvalidateCacheRange(VAddr addr, std::size_t size) {}
+
 void ARM_Unicorn::RecordBreak(GDBStub::BreakpointAddress bkpt) {
     last_bkpt = bkpt;
     last_bkpt_hit = true;
@@ -269,7 +271,7 @@ void ARM_Unicorn::InterruptHook(uc_engine* uc, u32 int_no, void* user_data) {
 
     switch (ec) {
     case 0x15: // SVC
-        Kernel::CallSVC(arm_instance->system, iss);
+        Kernel::CallSVC(arm_instance->system, *arm_instance, iss);
         break;
     }
 }
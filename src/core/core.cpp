@@ -3,19 +3,28 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <string_view>
 #include <utility>
 
+#include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/core_timing_util.h"
 #include "core/cpu_core_manager.h"
 #include "core/file_sys/mode.h"
+#include "core/file_sys/program_metadata.h"
 #include "core/file_sys/registered_cache.h"
+#include "core/file_sys/vfs_compressed.h"
 #include "core/file_sys/vfs_concat.h"
 #include "core/file_sys/vfs_real.h"
 #include "core/frontend/applets/error.h"
@@ -24,6 +33,7 @@
 #include "core/frontend/applets/software_keyboard.h"
 #include "core/frontend/applets/web_browser.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
@@ -48,6 +58,21 @@ namespace Core {
 
 /*static*/ System System::s_instance;
 
+namespace {
+
+/// Runs a stage of the boot and logs how long it took
+template <typename Func>
+auto RunBootStage(std::string_view name, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = func();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LOG_INFO(Core, "Boot stage {} took {} ms", name, duration.count());
+    return result;
+}
+
+} // Anonymous namespace
+
 FileSys::VirtualFile GetGameFileFromPath(const FileSys::VirtualFilesystem& vfs,
                                          const std::string& path) {
     // To account for split 00+01+etc files.
@@ -79,7 +104,10 @@ FileSys::VirtualFile GetGameFileFromPath(const FileSys::VirtualFilesystem& vfs,
     if (FileUtil::IsDirectory(path))
         return vfs->OpenFile(path + "/" + "main", FileSys::Mode::Read);
 
-    return vfs->OpenFile(path, FileSys::Mode::Read);
+    auto file = vfs->OpenFile(path, FileSys::Mode::Read);
+    if (FileSys::CompressedVfsFile::IsCompressedFile(file))
+        return FileSys::CompressedVfsFile::Open(std::move(file));
+    return file;
 }
 struct System::Impl {
     explicit Impl(System& system) : kernel{system}, cpu_core_manager{system} {}
@@ -97,30 +125,55 @@ struct System::Impl {
     }
 
     ResultStatus Init(System& system, Frontend::EmuWindow& emu_window) {
+        CreateDefaultFilesystem();
+
+        const ResultStatus core_result = InitCore(system, emu_window);
+        InitServices(system);
+        return core_result;
+    }
+
+    /// Creates the default implementations of the VFS and the content provider if the frontend
+    /// did not provide them.
+    void CreateDefaultFilesystem() {
+        if (virtual_filesystem == nullptr)
+            virtual_filesystem = std::make_shared<FileSys::RealVfsFilesystem>();
+        if (content_provider == nullptr)
+            content_provider = std::make_unique<FileSys::ContentProviderUnion>();
+    }
+
+    /// Initializes the parts of the system that don't use the VFS. The renderer is created on the
+    /// calling thread, which owns the graphics context of the window.
+    ResultStatus InitCore(System& system, Frontend::EmuWindow& emu_window) {
         LOG_DEBUG(HW_Memory, "initialized OK");
 
-        core_timing.Initialize();
+        // The shared thread pool leaves a host core to each emulated core and to the GPU thread
+        const std::size_t num_emulated_cores = Settings::values.use_multi_core ? NUM_CPU_CORES : 1;
+        const bool has_gpu_thread = Settings::values.use_asynchronous_gpu_emulation;
+        Common::ConfigureThreadPlacement(Settings::values.pin_host_threads, num_emulated_cores,
+                                         has_gpu_thread);
+        Common::ThreadPool::GetInstance().ReserveHostThreads(num_emulated_cores +
+                                                             (has_gpu_thread ? 1 : 0));
+
+        core_timing.Initialize(Settings::values.use_host_timing);
         cpu_core_manager.Initialize();
         kernel.Initialize();
 
+        perf_stats.ResetSessionMetrics();
+        session_sample_event =
+            core_timing.RegisterEvent("SessionMetricsSample", [this](u64, s64 cycles_late) {
+                SampleSessionMetrics(cycles_late);
+            });
+        core_timing.ScheduleEvent(SESSION_SAMPLE_TICKS, session_sample_event);
+
         const auto current_time = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::system_clock::now().time_since_epoch());
         Settings::values.custom_rtc_differential =
             Settings::values.custom_rtc.value_or(current_time) - current_time;
 
-        // Create a default fs if one doesn't already exist.
-        if (virtual_filesystem == nullptr)
-            virtual_filesystem = std::make_shared<FileSys::RealVfsFilesystem>();
-        if (content_provider == nullptr)
-            content_provider = std::make_unique<FileSys::ContentProviderUnion>();
-
         /// Create default implementations of applets if one is not provided.
         applet_manager.SetDefaultAppletsIfMissing();
 
         telemetry_session = std::make_unique<Core::TelemetrySession>();
-        service_manager = std::make_shared<Service::SM::ServiceManager>();
-
-        Service::Init(service_manager, system, *virtual_filesystem);
         GDBStub::Init();
 
         renderer = VideoCore::CreateRenderer(emu_window, system);
@@ -136,39 +189,98 @@ struct System::Impl {
 
         // Reset counters and set time origin to current frame
         GetAndResetPerfStats();
+        perf_stats.ResetFrameHistory();
         perf_stats.BeginSystemFrame();
 
         return ResultStatus::Success;
     }
 
+    /// Initializes the services, the filesystem services refresh the content of the VFS.
+    void InitServices(System& system) {
+        service_manager = std::make_shared<Service::SM::ServiceManager>();
+        Service::Init(service_manager, system, *virtual_filesystem);
+    }
+
     ResultStatus Load(System& system, Frontend::EmuWindow& emu_window,
                       const std::string& filepath) {
-        app_loader = Loader::GetLoader(GetGameFileFromPath(virtual_filesystem, filepath));
+        // The boot is split in stages, the ones that don't depend on each other overlap:
+        //   loader:   Parses the game files on a worker thread, which decrypts the NCAs and
+        //             derives their keys.
+        //   core:     Kernel, CPU cores and renderer, on this thread as it owns the graphics
+        //             context. They don't use the VFS. When titles override settings, it waits
+        //             for the title ID of the loader and applies them first.
+        //   services: After loader, the VFS and the content providers are not thread-safe.
+        //   process:  After core and services, loads the game into the main process.
+        // The shader disk cache is loaded by the frontend once the process runs, it needs the
+        // title ID of the process.
+        CreateDefaultFilesystem();
+
+        std::promise<u64> title_id_promise;
+        auto title_id = title_id_promise.get_future();
+        auto loader_stage = std::async(std::launch::async, [this, &filepath, &title_id_promise] {
+            return RunBootStage("loader", [this, &filepath, &title_id_promise] {
+                auto loader = Loader::GetLoader(GetGameFileFromPath(virtual_filesystem, filepath));
+                u64 program_id = 0;
+                if (loader != nullptr) {
+                    loader->ReadProgramId(program_id);
+                }
+                title_id_promise.set_value(program_id);
+                if (loader == nullptr) {
+                    return std::make_pair(std::move(loader),
+                                          Loader::ResultStatus::ErrorNotInitialized);
+                }
+                const auto system_mode = loader->LoadKernelSystemMode();
+                return std::make_pair(std::move(loader), system_mode.second);
+            });
+        });
+
+        const ResultStatus init_result = RunBootStage("core", [&] {
+            if (!Settings::values.title_overrides.empty()) {
+                Settings::ApplyTitleOverrides(title_id.get());
+            }
+            return InitCore(system, emu_window);
+        });
+
+        auto [loader, loader_result] = loader_stage.get();
+        app_loader = std::move(loader);
+
+        // The services are not started yet on the failures below, Shutdown only has to tear down
+        // what InitCore created and tolerates a missing service manager
+        if (init_result != ResultStatus::Success) {
+            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                         static_cast<int>(init_result));
+            Shutdown();
+            return init_result;
+        }
 
         if (!app_loader) {
             LOG_CRITICAL(Core, "Failed to obtain loader for {}!", filepath);
+            Shutdown();
             return ResultStatus::ErrorGetLoader;
         }
-        std::pair<std::optional<u32>, Loader::ResultStatus> system_mode =
-            app_loader->LoadKernelSystemMode();
 
-        if (system_mode.second != Loader::ResultStatus::Success) {
+        if (loader_result != Loader::ResultStatus::Success) {
             LOG_CRITICAL(Core, "Failed to determine system mode (Error {})!",
-                         static_cast<int>(system_mode.second));
-
+                         static_cast<int>(loader_result));
+            Shutdown();
             return ResultStatus::ErrorSystemMode;
         }
 
-        ResultStatus init_result{Init(system, emu_window)};
-        if (init_result != ResultStatus::Success) {
-            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
-                         static_cast<int>(init_result));
-            Shutdown();
-            return init_result;
+        // The telemetry session is created with the core, the loader describes the game to it
+        telemetry_session->AddInitialInfo(*app_loader);
+
+        RunBootStage("services", [&] {
+            InitServices(system);
+            return true;
+        });
+
+        if (Settings::values.profile_guest) {
+            guest_profiler = std::make_unique<GuestProfiler>(system);
         }
 
         auto main_process = Kernel::Process::Create(system, "main");
-        const auto [load_result, load_parameters] = app_loader->Load(*main_process);
+        const auto [load_result, load_parameters] =
+            RunBootStage("process", [&] { return app_loader->Load(*main_process); });
         if (load_result != Loader::ResultStatus::Success) {
             LOG_CRITICAL(Core, "Failed to load ROM (Error {})!", static_cast<int>(load_result));
             Shutdown();
@@ -182,6 +294,9 @@ struct System::Impl {
         // Begin GPU and CPU execution.
         gpu_core->Start();
         cpu_core_manager.StartThreads();
+        if (guest_profiler) {
+            guest_profiler->Start(GUEST_PROFILER_INTERVAL, true);
+        }
 
         // All threads are started, begin main process execution, now that we're in the clear.
         main_process->Run(load_parameters->main_thread_priority,
@@ -191,6 +306,27 @@ struct System::Impl {
         return status;
     }
 
+    ResultStatus InitForReplay(System& system, Frontend::EmuWindow& emu_window) {
+        const ResultStatus init_result = Init(system, emu_window);
+        if (init_result != ResultStatus::Success) {
+            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                         static_cast<int>(init_result));
+            Shutdown();
+            return init_result;
+        }
+
+        // The process never runs, it only provides the address space the replayed memory is
+        // mapped to
+        auto replay_process = Kernel::Process::Create(system, "replay");
+        replay_process->VMManager().Reset(FileSys::ProgramAddressSpaceType::Is39Bit);
+        kernel.MakeCurrentProcess(replay_process.get());
+
+        gpu_core->Start();
+
+        status = ResultStatus::Success;
+        return status;
+    }
+
     void Shutdown() {
         // Log last frame performance stats
         const auto perf_results = GetAndResetPerfStats();
@@ -200,6 +336,13 @@ struct System::Impl {
                                     perf_results.game_fps);
         telemetry_session->AddField(Telemetry::FieldType::Performance, "Shutdown_Frametime",
                                     perf_results.frametime * 1000.0);
+        telemetry_session->AddSessionMetrics(perf_stats);
+
+        if (guest_profiler) {
+            guest_profiler->Stop();
+            DumpGuestProfile();
+            guest_profiler.reset();
+        }
 
         is_powered_on = false;
 
@@ -225,9 +368,33 @@ struct System::Impl {
         // Clear all applets
         applet_manager.ClearAll();
 
+        // The next session starts from the global settings
+        Settings::RestoreGlobalValues();
+
         LOG_DEBUG(Core, "Shutdown OK");
     }
 
+    /// Writes the guest profile of the session to the dump directory
+    void DumpGuestProfile() const {
+        const auto* const process = kernel.CurrentProcess();
+        if (guest_profiler->GetSampleCount() == 0 || process == nullptr) {
+            return;
+        }
+        const std::string dir{FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) +
+                              "guest_profile" + DIR_SEP};
+        if (!FileUtil::CreateFullPath(dir)) {
+            LOG_ERROR(Core, "Failed to create directory={}", dir);
+            return;
+        }
+        const std::string path{fmt::format("{}{:016X}.folded", dir, process->GetTitleID())};
+        if (!guest_profiler->WriteFoldedStacks(path)) {
+            LOG_ERROR(Core, "Failed to write the guest profile to path={}", path);
+            return;
+        }
+        LOG_INFO(Core, "Wrote {} guest profile samples to path={}",
+                 guest_profiler->GetSampleCount(), path);
+    }
+
     Loader::ResultStatus GetGameName(std::string& out) const {
         if (app_loader == nullptr)
             return Loader::ResultStatus::ErrorNotInitialized;
@@ -245,6 +412,20 @@ struct System::Impl {
         return perf_stats.GetAndResetStats(core_timing.GetGlobalTimeUs());
     }
 
+    /// Samples the periodic session metrics and schedules the next sample
+    void SampleSessionMetrics(s64 cycles_late) {
+        const Kernel::Process* process = kernel.CurrentProcess();
+        perf_stats.SampleSessionMetrics(process != nullptr ? process->GetTotalPhysicalMemoryUsed()
+                                                           : 0);
+        core_timing.ScheduleEvent(SESSION_SAMPLE_TICKS - cycles_late, session_sample_event);
+    }
+
+    /// Host time between two samples of the guest profiler
+    static constexpr std::chrono::microseconds GUEST_PROFILER_INTERVAL{1000};
+
+    /// Emulated time between two samples of the session metrics
+    static constexpr s64 SESSION_SAMPLE_TICKS = static_cast<s64>(Timing::BASE_CLOCK_RATE);
+
     Timing::CoreTiming core_timing;
     Kernel::KernelCore kernel;
     /// RealVfsFilesystem instance
@@ -261,6 +442,9 @@ struct System::Impl {
 
     std::unique_ptr<FileSys::CheatEngine> cheat_engine;
 
+    /// Samples the guest code of the session when profiling is enabled
+    std::unique_ptr<GuestProfiler> guest_profiler;
+
     /// Frontend applets
     Service::AM::Applets::AppletManager applet_manager;
 
@@ -275,6 +459,7 @@ struct System::Impl {
 
     Core::PerfStats perf_stats;
     Core::FrameLimiter frame_limiter;
+    Timing::EventType* session_sample_event = nullptr;
 };
 
 System::System() : impl{std::make_unique<Impl>(*this)} {}
@@ -300,6 +485,10 @@ void System::InvalidateCpuInstructionCaches() {
     impl->cpu_core_manager.InvalidateAllInstructionCaches();
 }
 
+void System::InvalidateCpuInstructionCacheRange(VAddr addr, std::size_t size) {
+    impl->cpu_core_manager.InvalidateInstructionCacheRange(addr, size);
+}
+
 System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::string& filepath) {
     return impl->Load(*this, emu_window, filepath);
 }
@@ -433,6 +622,10 @@ const Core::FrameLimiter& System::FrameLimiter() const {
     return impl->frame_limiter;
 }
 
+GuestProfiler* System::GetGuestProfiler() const {
+    return impl->guest_profiler.get();
+}
+
 Loader::ResultStatus System::GetGameName(std::string& out) const {
     return impl->GetGameName(out);
 }
@@ -513,6 +706,10 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window) {
     return impl->Init(*this, emu_window);
 }
 
+System::ResultStatus System::InitForReplay(Frontend::EmuWindow& emu_window) {
+    return impl->InitForReplay(*this, emu_window);
+}
+
 void System::Shutdown() {
     impl->Shutdown();
 }
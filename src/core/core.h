@@ -67,6 +67,7 @@ class ARM_Interface;
 class Cpu;
 class ExclusiveMonitor;
 class FrameLimiter;
+class GuestProfiler;
 class PerfStats;
 class TelemetrySession;
 
@@ -131,6 +132,13 @@ public:
      */
     void InvalidateCpuInstructionCaches();
 
+    /**
+     * Invalidate the cached instructions of a range of guest memory on every CPU core
+     * This should be preferred whenever the modified range of code is known, as the translations
+     * of all the other code are kept.
+     */
+    void InvalidateCpuInstructionCacheRange(VAddr addr, std::size_t size);
+
     /// Shutdown the emulated system.
     void Shutdown();
 
@@ -143,6 +151,14 @@ public:
      */
     ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Initializes the emulated system without an application, to replay GPU traces. The current
+     * process is an empty one that never runs, the guest memory is mapped by the caller.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus InitForReplay(Frontend::EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -243,6 +259,9 @@ public:
     /// Provides a constant referent to the frame limiter
     const Core::FrameLimiter& FrameLimiter() const;
 
+    /// Gets the guest profiler of the session, null unless Settings::values.profile_guest is set
+    Core::GuestProfiler* GetGuestProfiler() const;
+
     /// Gets the name of the current game
     Loader::ResultStatus GetGameName(std::string& out) const;
 
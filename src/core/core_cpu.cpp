@@ -4,6 +4,7 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <thread>
 
 #include "common/logging/log.h"
 #ifdef ARCHITECTURE_x86_64
@@ -22,32 +23,52 @@
 namespace Core {
 
 void CpuBarrier::NotifyEnd() {
-    std::unique_lock lock{mutex};
+    std::lock_guard lock{mutex};
     end = true;
     condition.notify_all();
 }
 
 bool CpuBarrier::Rendezvous() {
-    if (!Settings::values.use_multi_core) {
+    if (!is_multicore) {
         // Meaningless when running in single-core mode
         return true;
     }
 
-    if (!end) {
-        std::unique_lock lock{mutex};
+    if (end) {
+        return false;
+    }
 
-        --cores_waiting;
-        if (!cores_waiting) {
-            cores_waiting = NUM_CPU_CORES;
-            condition.notify_all();
-            return true;
+    const u32 current_generation = generation.load(std::memory_order_acquire);
+    if (cores_waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Last core to arrive, release the others into the next slice
+        cores_waiting.store(NUM_CPU_CORES, std::memory_order_relaxed);
+        {
+            std::lock_guard lock{mutex};
+            generation.fetch_add(1, std::memory_order_release);
         }
-
-        condition.wait(lock);
+        condition.notify_all();
         return true;
     }
 
-    return false;
+    // Timing slices are short, so the other cores usually arrive within a few microseconds. Spin
+    // for a while before going to sleep to avoid paying for a futex wait and wake-up every slice.
+    // Yield after the first iterations in case the host has fewer cores than the guest.
+    constexpr int busy_iterations = 256;
+    constexpr int spin_iterations = 2048;
+    for (int i = 0; i < spin_iterations; ++i) {
+        if (generation.load(std::memory_order_acquire) != current_generation) {
+            return true;
+        }
+        if (i >= busy_iterations) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::unique_lock lock{mutex};
+    condition.wait(lock, [this, current_generation] {
+        return generation.load(std::memory_order_acquire) != current_generation || end;
+    });
+    return true;
 }
 
 Cpu::Cpu(System& system, ExclusiveMonitor& exclusive_monitor, CpuBarrier& cpu_barrier,
@@ -64,7 +85,8 @@ Cpu::Cpu(System& system, ExclusiveMonitor& exclusive_monitor, CpuBarrier& cpu_ba
         arm_interface = std::make_unique<ARM_Unicorn>(system);
     }
 
-    scheduler = std::make_unique<Kernel::Scheduler>(system, *arm_interface);
+    scheduler = std::make_unique<Kernel::Scheduler>(system, *arm_interface,
+                                                    static_cast<u32>(core_index));
 }
 
 Cpu::~Cpu() = default;
@@ -72,12 +94,14 @@ Cpu::~Cpu() = default;
 std::unique_ptr<ExclusiveMonitor> Cpu::MakeExclusiveMonitor(std::size_t num_cores) {
     if (Settings::values.use_cpu_jit) {
 #ifdef ARCHITECTURE_x86_64
+        // The JIT commits guest exclusive stores through the monitor of Dynarmic, the kernel has
+        // to use the same one for its exclusive writes to be seen by the guest
         return std::make_unique<DynarmicExclusiveMonitor>(num_cores);
 #else
-        return nullptr; // TODO(merry): Passthrough exclusive monitor
+        return std::make_unique<ReservationExclusiveMonitor>(num_cores);
 #endif
     } else {
-        return nullptr; // TODO(merry): Passthrough exclusive monitor
+        return std::make_unique<ReservationExclusiveMonitor>(num_cores);
     }
 }
 
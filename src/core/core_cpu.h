@@ -32,6 +32,8 @@ constexpr unsigned NUM_CPU_CORES{4};
 
 class CpuBarrier {
 public:
+    explicit CpuBarrier(bool is_multicore) : is_multicore{is_multicore} {}
+
     bool IsAlive() const {
         return !end;
     }
@@ -41,10 +43,12 @@ public:
     bool Rendezvous();
 
 private:
-    unsigned cores_waiting{NUM_CPU_CORES};
+    std::atomic<unsigned> cores_waiting{NUM_CPU_CORES};
+    std::atomic<u32> generation{};
     std::mutex mutex;
     std::condition_variable condition;
     std::atomic<bool> end{};
+    const bool is_multicore;
 };
 
 class Cpu {
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 
 #include "common/assert.h"
@@ -17,27 +18,18 @@ namespace Core::Timing {
 
 constexpr int MAX_SLICE_LENGTH = 20000;
 
-struct CoreTiming::Event {
-    s64 time;
-    u64 fifo_order;
-    u64 userdata;
-    const EventType* type;
-
-    // Sort by time, unless the times are the same, in which case sort by
-    // the order added to the queue
-    friend bool operator>(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-    }
-
-    friend bool operator<(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
-    }
+struct CoreTiming::ThreadsafeRequest {
+    Event event;
+    bool is_unschedule;
 };
 
-CoreTiming::CoreTiming() = default;
+CoreTiming::CoreTiming(EventQueueType queue_type) : event_queue{MakeEventQueue(queue_type)} {}
 CoreTiming::~CoreTiming() = default;
 
-void CoreTiming::Initialize() {
+void CoreTiming::Initialize(bool use_host_timing) {
+    this->use_host_timing = use_host_timing;
+    host_start_time = std::chrono::steady_clock::now();
+
     downcount = MAX_SLICE_LENGTH;
     slice_length = MAX_SLICE_LENGTH;
     global_timer = 0;
@@ -76,12 +68,18 @@ EventType* CoreTiming::RegisterEvent(const std::string& name, TimedCallback call
 }
 
 void CoreTiming::UnregisterAllEvents() {
-    ASSERT_MSG(event_queue.empty(), "Cannot unregister events with events pending");
+    ASSERT_MSG(event_queue->IsEmpty(), "Cannot unregister events with events pending");
     event_types.clear();
 }
 
 void CoreTiming::ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
     ASSERT(event_type != nullptr);
+
+    if (!IsTimingThread()) {
+        ScheduleEventThreadsafe(cycles_into_future, event_type, userdata);
+        return;
+    }
+
     const s64 timeout = GetTicks() + cycles_into_future;
 
     // If this event needs to be scheduled before the next advance(), force one early
@@ -89,32 +87,46 @@ void CoreTiming::ScheduleEvent(s64 cycles_into_future, const EventType* event_ty
         ForceExceptionCheck(cycles_into_future);
     }
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    event_queue->Push(Event{timeout, event_fifo_id++, userdata, event_type});
 }
 
 void CoreTiming::ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
                                          u64 userdata) {
-    ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type});
+    const Event event{global_timer + cycles_into_future, 0, userdata, event_type};
+    ts_queue.Push(ThreadsafeRequest{event, false});
 }
 
 void CoreTiming::UnscheduleEvent(const EventType* event_type, u64 userdata) {
-    const auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    if (!IsTimingThread()) {
+        UnscheduleEventThreadsafe(event_type, userdata);
+        return;
     }
+
+    event_queue->Remove(event_type, userdata);
 }
 
 void CoreTiming::UnscheduleEventThreadsafe(const EventType* event_type, u64 userdata) {
-    unschedule_queue.Push(std::make_pair(event_type, userdata));
+    ts_queue.Push(ThreadsafeRequest{Event{0, 0, userdata, event_type}, true});
+}
+
+s64 CoreTiming::GetHostTicks() const {
+    const auto elapsed = std::chrono::steady_clock::now() - host_start_time;
+    return nsToCycles(
+        static_cast<s64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+bool CoreTiming::IsTimingThread() const {
+    const std::thread::id timing_thread = timing_thread_id.load(std::memory_order_relaxed);
+    return timing_thread == std::thread::id{} || timing_thread == std::this_thread::get_id();
 }
 
 u64 CoreTiming::GetTicks() const {
+    if (use_host_timing) {
+        // The guest must never observe the time going backwards, even if the host clock is
+        // sampled before the current slice began.
+        return static_cast<u64>(std::max(global_timer, GetHostTicks()));
+    }
+
     u64 ticks = static_cast<u64>(global_timer);
     if (!is_global_timer_sane) {
         ticks += slice_length - downcount;
@@ -131,18 +143,11 @@ void CoreTiming::AddTicks(u64 ticks) {
 }
 
 void CoreTiming::ClearPendingEvents() {
-    event_queue.clear();
+    event_queue->Clear();
 }
 
 void CoreTiming::RemoveEvent(const EventType* event_type) {
-    const auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                                    [&](const Event& e) { return e.type == event_type; });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    event_queue->RemoveAll(event_type);
 }
 
 void CoreTiming::RemoveNormalAndThreadsafeEvent(const EventType* event_type) {
@@ -163,44 +168,62 @@ void CoreTiming::ForceExceptionCheck(s64 cycles) {
 }
 
 void CoreTiming::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
+    for (ThreadsafeRequest request; ts_queue.Pop(request);) {
+        Event& ev = request.event;
+        if (request.is_unschedule) {
+            UnscheduleEvent(ev.type, ev.userdata);
+            continue;
+        }
+
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue->Push(ev);
     }
 }
 
 void CoreTiming::Advance() {
+    timing_thread_id.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
     MoveEvents();
-    for (std::pair<const EventType*, u64> ev; unschedule_queue.Pop(ev);) {
-        UnscheduleEvent(ev.first, ev.second);
-    }
 
     const int cycles_executed = slice_length - downcount;
-    global_timer += cycles_executed;
+    if (use_host_timing) {
+        global_timer = std::max(global_timer, GetHostTicks());
+    } else {
+        global_timer += cycles_executed;
+    }
     slice_length = MAX_SLICE_LENGTH;
 
     is_global_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    for (Event evt; event_queue->PopDue(global_timer, evt);) {
         evt.type->callback(evt.userdata, global_timer - evt.time);
     }
 
     is_global_timer_sane = false;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_queue->IsEmpty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - global_timer, MAX_SLICE_LENGTH));
+            std::min<s64>(event_queue->GetNextTime() - global_timer, MAX_SLICE_LENGTH));
     }
 
     downcount = slice_length;
 }
 
 void CoreTiming::Idle() {
+    if (use_host_timing) {
+        // Wait for the next event on the host clock instead of fast-forwarding the guest time.
+        // Events scheduled from other threads are only picked up by Advance(), so bound the wait.
+        constexpr s64 max_wait_cycles = BASE_CLOCK_RATE / 1000;
+        s64 wait_cycles = max_wait_cycles;
+        if (!event_queue->IsEmpty()) {
+            wait_cycles = std::min(wait_cycles, event_queue->GetNextTime() - GetHostTicks());
+        }
+        if (wait_cycles > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds{cyclesToNs(wait_cycles)});
+        }
+    }
+
     idled_cycles += downcount;
     downcount = 0;
 }
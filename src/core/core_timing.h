@@ -4,13 +4,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
-#include <vector>
 #include "common/common_types.h"
 #include "common/threadsafe_queue.h"
+#include "core/core_timing_queue.h"
 
 namespace Core::Timing {
 
@@ -39,7 +42,7 @@ struct EventType {
  */
 class CoreTiming {
 public:
-    CoreTiming();
+    explicit CoreTiming(EventQueueType queue_type = EventQueueType::TimingWheel);
     ~CoreTiming();
 
     CoreTiming(const CoreTiming&) = delete;
@@ -50,7 +53,13 @@ public:
 
     /// CoreTiming begins at the boundary of timing slice -1. An initial call to Advance() is
     /// required to end slice - 1 and start slice 0 before the first cycle of code is executed.
-    void Initialize();
+    ///
+    /// @param use_host_timing If true, the guest time is derived from the host steady clock
+    ///                        instead of the amount of executed guest cycles. Slices still end
+    ///                        after the downcount is consumed, but the time observed by the guest
+    ///                        and the time at which events fire follow the wall clock, and Idle()
+    ///                        waits for the next event instead of skipping ahead to it.
+    void Initialize(bool use_host_timing = false);
 
     /// Tears down all timing related functionality.
     void Shutdown();
@@ -74,6 +83,9 @@ public:
     /// event is scheduled earlier than the current values.
     ///
     /// Scheduling from a callback will not update the downcount until the Advance() completes.
+    ///
+    /// When called from a thread other than the one driving Advance(), such as another CPU core
+    /// in multicore mode, the request is forwarded to ScheduleEventThreadsafe instead.
     void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata = 0);
 
     /// This is to be called when outside of hle threads, such as the graphics thread, wants to
@@ -84,7 +96,12 @@ public:
     void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
                                  u64 userdata = 0);
 
+    /// When called from a thread other than the one driving Advance(), the request is forwarded
+    /// to UnscheduleEventThreadsafe instead.
     void UnscheduleEvent(const EventType* event_type, u64 userdata);
+
+    /// Threadsafe requests are applied by the next Advance() in the order they were made, so
+    /// unscheduling and then rescheduling an event from another thread behaves as expected.
     void UnscheduleEventThreadsafe(const EventType* event_type, u64 userdata);
 
     /// We only permit one event of each type in the queue at a time.
@@ -108,7 +125,8 @@ public:
     /// instructions is executed.
     void Advance();
 
-    /// Pretend that the main CPU has executed enough cycles to reach the next event.
+    /// Pretend that the main CPU has executed enough cycles to reach the next event. With host
+    /// timing, this instead sleeps until the next event is due.
     void Idle();
 
     std::chrono::microseconds GetGlobalTimeUs() const;
@@ -116,7 +134,14 @@ public:
     int GetDowncount() const;
 
 private:
-    struct Event;
+    using Event = TimedEvent;
+    struct ThreadsafeRequest;
+
+    /// Returns true if the calling thread is allowed to modify the event queue directly
+    bool IsTimingThread() const;
+
+    /// Returns the amount of cycles elapsed on the host clock since Initialize()
+    s64 GetHostTicks() const;
 
     /// Clear all pending events. This should ONLY be done on exit.
     void ClearPendingEvents();
@@ -127,28 +152,27 @@ private:
     int slice_length = 0;
     int downcount = 0;
 
+    bool use_host_timing = false;
+    std::chrono::steady_clock::time_point host_start_time;
+
     // Are we in a function that has been called from Advance()
     // If events are scheduled from a function that gets called from Advance(),
     // don't change slice_length and downcount.
     bool is_global_timer_sane = false;
 
-    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-    // accomodated by the standard adaptor class.
-    std::vector<Event> event_queue;
+    std::unique_ptr<EventQueue> event_queue;
     u64 event_fifo_id = 0;
 
     // Stores each element separately as a linked list node so pointers to elements
     // remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, EventType> event_types;
 
-    // The queue for storing the events from other threads threadsafe until they will be added
-    // to the event_queue by the emu thread
-    Common::MPSCQueue<Event> ts_queue;
+    // The queue for storing the schedule and unschedule requests from other threads threadsafe
+    // until they will be applied to the event_queue by the emu thread
+    Common::MPSCQueue<ThreadsafeRequest> ts_queue;
 
-    // The queue for unscheduling the events from other threads threadsafe
-    Common::MPSCQueue<std::pair<const EventType*, u64>> unschedule_queue;
+    // The thread driving Advance(). Until the first Advance() every thread may modify the queue.
+    std::atomic<std::thread::id> timing_thread_id{};
 
     EventType* ev_lost = nullptr;
 };
@@ -0,0 +1,321 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "core/core_timing_queue.h"
+
+namespace Core::Timing {
+
+namespace {
+// Sort by time, unless the times are the same, in which case sort by the order added to the queue
+struct EventGreater {
+    bool operator()(const TimedEvent& left, const TimedEvent& right) const {
+        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
+    }
+};
+} // Anonymous namespace
+
+EventQueue::~EventQueue() = default;
+
+std::unique_ptr<EventQueue> MakeEventQueue(EventQueueType type) {
+    switch (type) {
+    case EventQueueType::Heap:
+        return std::make_unique<HeapEventQueue>();
+    case EventQueueType::TimingWheel:
+        return std::make_unique<TimingWheelEventQueue>();
+    }
+    UNREACHABLE();
+    return nullptr;
+}
+
+HeapEventQueue::HeapEventQueue() = default;
+HeapEventQueue::~HeapEventQueue() = default;
+
+void HeapEventQueue::Push(const TimedEvent& event) {
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end(), EventGreater{});
+}
+
+bool HeapEventQueue::PopDue(s64 time_limit, TimedEvent& event) {
+    if (events.empty() || events.front().time > time_limit) {
+        return false;
+    }
+    event = events.front();
+    std::pop_heap(events.begin(), events.end(), EventGreater{});
+    events.pop_back();
+    return true;
+}
+
+s64 HeapEventQueue::GetNextTime() const {
+    ASSERT(!events.empty());
+    return events.front().time;
+}
+
+void HeapEventQueue::Remove(const EventType* type, u64 userdata) {
+    const auto itr = std::remove_if(events.begin(), events.end(), [&](const TimedEvent& e) {
+        return e.type == type && e.userdata == userdata;
+    });
+
+    // Removing random items breaks the invariant so we have to re-establish it.
+    if (itr != events.end()) {
+        events.erase(itr, events.end());
+        std::make_heap(events.begin(), events.end(), EventGreater{});
+    }
+}
+
+void HeapEventQueue::RemoveAll(const EventType* type) {
+    const auto itr = std::remove_if(events.begin(), events.end(),
+                                    [&](const TimedEvent& e) { return e.type == type; });
+
+    // Removing random items breaks the invariant so we have to re-establish it.
+    if (itr != events.end()) {
+        events.erase(itr, events.end());
+        std::make_heap(events.begin(), events.end(), EventGreater{});
+    }
+}
+
+void HeapEventQueue::Clear() {
+    events.clear();
+}
+
+bool HeapEventQueue::IsEmpty() const {
+    return events.empty();
+}
+
+TimingWheelEventQueue::TimingWheelEventQueue() = default;
+TimingWheelEventQueue::~TimingWheelEventQueue() = default;
+
+void TimingWheelEventQueue::Push(const TimedEvent& event) {
+    Link(AllocateNode(event));
+}
+
+bool TimingWheelEventQueue::PopDue(s64 time_limit, TimedEvent& event) {
+    if (time_limit < static_cast<s64>(current_time)) {
+        return false;
+    }
+    const u64 limit = static_cast<u64>(time_limit);
+
+    while (true) {
+        const u32 cursor = static_cast<u32>(current_time & (NUM_SLOTS - 1));
+        const u64 mask = occupied[0] & (~0ULL << cursor);
+        if (mask != 0) {
+            const u32 slot = Common::CountTrailingZeroes64(mask);
+            const u64 slot_time = (current_time & ~u64{NUM_SLOTS - 1}) | slot;
+            if (slot_time > limit) {
+                return false;
+            }
+            current_time = slot_time;
+
+            const u32 node = slots[0][slot].head;
+            event = nodes[node].event;
+            Unlink(node);
+            FreeNode(node);
+            return true;
+        }
+        if (!Cascade(limit)) {
+            return false;
+        }
+    }
+}
+
+s64 TimingWheelEventQueue::GetNextTime() const {
+    ASSERT(!IsEmpty());
+
+    const auto min_time_in_slot = [this](const Slot& slot) {
+        s64 min_time = nodes[slot.head].event.time;
+        for (u32 node = slot.head; node != INVALID_NODE; node = nodes[node].next) {
+            min_time = std::min(min_time, nodes[node].event.time);
+        }
+        return min_time;
+    };
+
+    const u32 cursor = static_cast<u32>(current_time & (NUM_SLOTS - 1));
+    const u64 mask = occupied[0] & (~0ULL << cursor);
+    if (mask != 0) {
+        const u32 slot = Common::CountTrailingZeroes64(mask);
+        if (slot == cursor) {
+            // The current slot may also hold events that were scheduled in the past, they are
+            // sorted before the others
+            return nodes[slots[0][slot].head].event.time;
+        }
+        return static_cast<s64>((current_time & ~u64{NUM_SLOTS - 1}) | slot);
+    }
+
+    for (u32 level = 1; level < NUM_LEVELS; ++level) {
+        const u32 digit = static_cast<u32>((current_time >> (level * LEVEL_BITS)) & (NUM_SLOTS - 1));
+        if (digit == NUM_SLOTS - 1) {
+            continue;
+        }
+        const u64 level_mask = occupied[level] & (~0ULL << (digit + 1));
+        if (level_mask != 0) {
+            return min_time_in_slot(slots[level][Common::CountTrailingZeroes64(level_mask)]);
+        }
+    }
+
+    UNREACHABLE();
+    return 0;
+}
+
+void TimingWheelEventQueue::Remove(const EventType* type, u64 userdata) {
+    const auto [begin, end] = index.equal_range(Key{type, userdata});
+    for (auto it = begin; it != end; ++it) {
+        Unlink(it->second);
+        free_nodes.push_back(it->second);
+    }
+    index.erase(begin, end);
+}
+
+void TimingWheelEventQueue::RemoveAll(const EventType* type) {
+    for (auto it = index.begin(); it != index.end();) {
+        if (it->first.type != type) {
+            ++it;
+            continue;
+        }
+        Unlink(it->second);
+        free_nodes.push_back(it->second);
+        it = index.erase(it);
+    }
+}
+
+void TimingWheelEventQueue::Clear() {
+    slots = {};
+    occupied = {};
+    nodes.clear();
+    free_nodes.clear();
+    index.clear();
+}
+
+bool TimingWheelEventQueue::IsEmpty() const {
+    return index.empty();
+}
+
+u32 TimingWheelEventQueue::AllocateNode(const TimedEvent& event) {
+    u32 node;
+    if (free_nodes.empty()) {
+        node = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    } else {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    nodes[node].event = event;
+    index.emplace(Key{event.type, event.userdata}, node);
+    return node;
+}
+
+void TimingWheelEventQueue::FreeNode(u32 node) {
+    const TimedEvent& event = nodes[node].event;
+    const auto [begin, end] = index.equal_range(Key{event.type, event.userdata});
+    const auto it = std::find_if(begin, end, [node](const auto& pair) { return pair.second == node; });
+    ASSERT(it != end);
+    index.erase(it);
+    free_nodes.push_back(node);
+}
+
+void TimingWheelEventQueue::Link(u32 node) {
+    Node& entry = nodes[node];
+
+    // Events scheduled in the past are due right away, place them in the current slot
+    const u64 time = entry.event.time < static_cast<s64>(current_time)
+                         ? current_time
+                         : static_cast<u64>(entry.event.time);
+
+    // Store the event in the lowest level whose span around the current time contains it
+    const u64 difference = time ^ current_time;
+    const u32 level =
+        difference == 0 ? 0 : (63 - Common::CountLeadingZeroes64(difference)) / LEVEL_BITS;
+    const u32 slot_index = static_cast<u32>((time >> (level * LEVEL_BITS)) & (NUM_SLOTS - 1));
+
+    Slot& slot = slots[level][slot_index];
+    entry.level = level;
+    entry.slot = slot_index;
+
+    // Level 0 slots are kept in (time, fifo) order. Their events share the same time except in
+    // the current slot, where past due events may be placed, so the walk from the tail is short.
+    // Upper level slots are sorted as they are cascaded.
+    u32 prev = slot.tail;
+    u32 next = INVALID_NODE;
+    if (level == 0) {
+        while (prev != INVALID_NODE && EventGreater{}(nodes[prev].event, entry.event)) {
+            next = prev;
+            prev = nodes[prev].prev;
+        }
+    }
+    entry.prev = prev;
+    entry.next = next;
+    if (prev != INVALID_NODE) {
+        nodes[prev].next = node;
+    } else {
+        slot.head = node;
+    }
+    if (next != INVALID_NODE) {
+        nodes[next].prev = node;
+    } else {
+        slot.tail = node;
+    }
+    occupied[level] |= 1ULL << slot_index;
+}
+
+void TimingWheelEventQueue::Unlink(u32 node) {
+    const Node& entry = nodes[node];
+    Slot& slot = slots[entry.level][entry.slot];
+
+    if (entry.prev != INVALID_NODE) {
+        nodes[entry.prev].next = entry.next;
+    } else {
+        slot.head = entry.next;
+    }
+    if (entry.next != INVALID_NODE) {
+        nodes[entry.next].prev = entry.prev;
+    } else {
+        slot.tail = entry.prev;
+    }
+    if (slot.head == INVALID_NODE) {
+        occupied[entry.level] &= ~(1ULL << entry.slot);
+    }
+}
+
+bool TimingWheelEventQueue::Cascade(u64 time_limit) {
+    // The lower levels are empty past the current time at this point. The slot matching the
+    // current time in every upper level is always empty, as those events are stored lower.
+    for (u32 level = 1; level < NUM_LEVELS; ++level) {
+        const u32 shift = level * LEVEL_BITS;
+        const u32 digit = static_cast<u32>((current_time >> shift) & (NUM_SLOTS - 1));
+        if (digit == NUM_SLOTS - 1) {
+            continue;
+        }
+        const u64 mask = occupied[level] & (~0ULL << (digit + 1));
+        if (mask == 0) {
+            continue;
+        }
+
+        const u32 slot_index = Common::CountTrailingZeroes64(mask);
+        const u64 span_mask = shift + LEVEL_BITS >= 64 ? ~0ULL : (1ULL << (shift + LEVEL_BITS)) - 1;
+        const u64 slot_time = (current_time & ~span_mask) | (u64{slot_index} << shift);
+        if (slot_time > time_limit) {
+            return false;
+        }
+        current_time = slot_time;
+
+        // Redistribute the events of the slot, the lower levels sort them by time and FIFO order
+        Slot& slot = slots[level][slot_index];
+        u32 node = slot.head;
+        slot = {};
+        occupied[level] &= ~(1ULL << slot_index);
+        while (node != INVALID_NODE) {
+            const u32 next = nodes[node].next;
+            Link(node);
+            node = next;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace Core::Timing
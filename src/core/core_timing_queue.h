@@ -0,0 +1,175 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core::Timing {
+
+struct EventType;
+
+/// An event pending in one of the CoreTiming event queues.
+struct TimedEvent {
+    s64 time;
+    u64 fifo_order;
+    u64 userdata;
+    const EventType* type;
+};
+
+/// Storage backends for the events pending in CoreTiming.
+enum class EventQueueType {
+    /// Binary min-heap. Cancelling events is linear in the number of pending events.
+    Heap,
+    /// Hierarchical timing wheel. Scheduling and cancelling events is constant time.
+    TimingWheel,
+};
+
+/**
+ * Interface of the containers CoreTiming stores pending events in. Events are extracted in order
+ * of their time, and events with the same time are extracted in the order they were pushed.
+ */
+class EventQueue {
+public:
+    virtual ~EventQueue();
+
+    /// Adds an event to the queue.
+    virtual void Push(const TimedEvent& event) = 0;
+
+    /// Extracts the earliest event whose time is not after `time_limit`.
+    /// @returns true if an event was extracted into `event`, false otherwise.
+    virtual bool PopDue(s64 time_limit, TimedEvent& event) = 0;
+
+    /// Returns the time of the earliest event in the queue. The queue must not be empty.
+    virtual s64 GetNextTime() const = 0;
+
+    /// Removes every event of the given type with the given userdata.
+    virtual void Remove(const EventType* type, u64 userdata) = 0;
+
+    /// Removes every event of the given type.
+    virtual void RemoveAll(const EventType* type) = 0;
+
+    /// Removes every event.
+    virtual void Clear() = 0;
+
+    /// Returns true if there are no events in the queue.
+    virtual bool IsEmpty() const = 0;
+};
+
+/// Creates an event queue using the given storage backend.
+std::unique_ptr<EventQueue> MakeEventQueue(EventQueueType type);
+
+/// Event queue backed by a binary min-heap.
+class HeapEventQueue final : public EventQueue {
+public:
+    HeapEventQueue();
+    ~HeapEventQueue() override;
+
+    void Push(const TimedEvent& event) override;
+    bool PopDue(s64 time_limit, TimedEvent& event) override;
+    s64 GetNextTime() const override;
+    void Remove(const EventType* type, u64 userdata) override;
+    void RemoveAll(const EventType* type) override;
+    void Clear() override;
+    bool IsEmpty() const override;
+
+private:
+    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
+    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
+    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
+    // accomodated by the standard adaptor class.
+    std::vector<TimedEvent> events;
+};
+
+/**
+ * Event queue backed by a hierarchical timing wheel.
+ *
+ * The wheel has NUM_LEVELS levels of NUM_SLOTS slots each. Slots of level N span NUM_SLOTS^N
+ * cycles, and an event is stored in the lowest level whose current span contains its time. As
+ * time advances, the slots of the upper levels are cascaded into the lower ones. Each slot is an
+ * intrusive list, those of the lowest level sorted by time and FIFO order, and a per-level
+ * occupancy mask allows skipping empty slots without visiting them. Events are additionally
+ * indexed by type and userdata, which makes cancelling them independent of the amount of pending
+ * events.
+ */
+class TimingWheelEventQueue final : public EventQueue {
+public:
+    TimingWheelEventQueue();
+    ~TimingWheelEventQueue() override;
+
+    void Push(const TimedEvent& event) override;
+    bool PopDue(s64 time_limit, TimedEvent& event) override;
+    s64 GetNextTime() const override;
+    void Remove(const EventType* type, u64 userdata) override;
+    void RemoveAll(const EventType* type) override;
+    void Clear() override;
+    bool IsEmpty() const override;
+
+private:
+    static constexpr u32 LEVEL_BITS = 6;
+    static constexpr u32 NUM_SLOTS = 1U << LEVEL_BITS;
+    static constexpr u32 NUM_LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS;
+    static constexpr u32 INVALID_NODE = 0xFFFFFFFF;
+
+    struct Node {
+        TimedEvent event;
+        u32 prev;
+        u32 next;
+        u32 level;
+        u32 slot;
+    };
+
+    struct Slot {
+        u32 head = INVALID_NODE;
+        u32 tail = INVALID_NODE;
+    };
+
+    struct Key {
+        const EventType* type;
+        u64 userdata;
+
+        bool operator==(const Key& other) const {
+            return type == other.type && userdata == other.userdata;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            const auto type = reinterpret_cast<std::uintptr_t>(key.type);
+            return static_cast<std::size_t>(type ^ (key.userdata * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    /// Allocates a node in the pool for the given event and returns its index.
+    u32 AllocateNode(const TimedEvent& event);
+
+    /// Returns the node to the pool, removing it from the index.
+    void FreeNode(u32 index);
+
+    /// Inserts an allocated node into the slot matching its time.
+    void Link(u32 index);
+
+    /// Removes a node from the slot it is currently stored in.
+    void Unlink(u32 index);
+
+    /// Moves the current time to the start of the next non-empty upper level slot, if it is not
+    /// after time_limit, redistributing the events of that slot into the lower levels.
+    /// @returns true if the current time was moved.
+    bool Cascade(u64 time_limit);
+
+    std::array<std::array<Slot, NUM_SLOTS>, NUM_LEVELS> slots{};
+    std::array<u64, NUM_LEVELS> occupied{};
+    std::vector<Node> nodes;
+    std::vector<u32> free_nodes;
+    std::unordered_multimap<Key, u32, KeyHash> index;
+
+    /// Every event before this time has already been extracted
+    u64 current_time = 0;
+};
+
+} // namespace Core::Timing
@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <fmt/format.h>
 #include "common/assert.h"
+#include "common/thread.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
@@ -13,6 +15,8 @@
 namespace Core {
 namespace {
 void RunCpuCore(const System& system, Cpu& cpu_state) {
+    Common::SetCurrentThreadName(fmt::format("yuzu:CPUCore{}", cpu_state.CoreIndex()).c_str());
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::EmulatedCore, cpu_state.CoreIndex());
     while (system.IsPoweredOn()) {
         cpu_state.RunLoop(true);
     }
@@ -23,7 +27,9 @@ CpuCoreManager::CpuCoreManager(System& system) : system{system} {}
 CpuCoreManager::~CpuCoreManager() = default;
 
 void CpuCoreManager::Initialize() {
-    barrier = std::make_unique<CpuBarrier>();
+    // The mode is fixed for the session, the setting may change while it runs
+    is_multicore = Settings::values.use_multi_core;
+    barrier = std::make_unique<CpuBarrier>(is_multicore);
     exclusive_monitor = Cpu::MakeExclusiveMonitor(cores.size());
 
     for (std::size_t index = 0; index < cores.size(); ++index) {
@@ -35,7 +41,7 @@ void CpuCoreManager::StartThreads() {
     // Create threads for CPU cores 1-3, and build thread_to_cpu map
     // CPU core 0 is run on the main thread
     thread_to_cpu[std::this_thread::get_id()] = cores[0].get();
-    if (!Settings::values.use_multi_core) {
+    if (!is_multicore) {
         return;
     }
 
@@ -48,7 +54,7 @@ void CpuCoreManager::StartThreads() {
 
 void CpuCoreManager::Shutdown() {
     barrier->NotifyEnd();
-    if (Settings::values.use_multi_core) {
+    if (is_multicore) {
         for (auto& thread : core_threads) {
             thread->join();
             thread.reset();
@@ -81,7 +87,7 @@ const ExclusiveMonitor& CpuCoreManager::GetExclusiveMonitor() const {
 }
 
 Cpu& CpuCoreManager::GetCurrentCore() {
-    if (Settings::values.use_multi_core) {
+    if (is_multicore) {
         const auto& search = thread_to_cpu.find(std::this_thread::get_id());
         ASSERT(search != thread_to_cpu.end());
         ASSERT(search->second);
@@ -93,7 +99,7 @@ Cpu& CpuCoreManager::GetCurrentCore() {
 }
 
 const Cpu& CpuCoreManager::GetCurrentCore() const {
-    if (Settings::values.use_multi_core) {
+    if (is_multicore) {
         const auto& search = thread_to_cpu.find(std::this_thread::get_id());
         ASSERT(search != thread_to_cpu.end());
         ASSERT(search->second);
@@ -106,7 +112,12 @@ const Cpu& CpuCoreManager::GetCurrentCore() const {
 
 void CpuCoreManager::RunLoop(bool tight_loop) {
     // Update thread_to_cpu in case Core 0 is run from a different host thread
-    thread_to_cpu[std::this_thread::get_id()] = cores[0].get();
+    const auto thread_id = std::this_thread::get_id();
+    thread_to_cpu[thread_id] = cores[0].get();
+    if (thread_id != core_0_thread) {
+        core_0_thread = thread_id;
+        Common::SetCurrentThreadPlacement(Common::ThreadRole::EmulatedCore, 0);
+    }
 
     if (GDBStub::IsServerEnabled()) {
         GDBStub::HandlePacket();
@@ -124,7 +135,7 @@ void CpuCoreManager::RunLoop(bool tight_loop) {
 
     for (active_core = 0; active_core < NUM_CPU_CORES; ++active_core) {
         cores[active_core]->RunLoop(tight_loop);
-        if (Settings::values.use_multi_core) {
+        if (is_multicore) {
             // Cores 1-3 are run on other threads in this mode
             break;
         }
@@ -141,4 +152,10 @@ void CpuCoreManager::InvalidateAllInstructionCaches() {
     }
 }
 
+void CpuCoreManager::InvalidateInstructionCacheRange(VAddr addr, std::size_t size) {
+    for (auto& cpu : cores) {
+        cpu->ArmInterface().InvalidateCacheRange(addr, size);
+    }
+}
+
 } // namespace Core
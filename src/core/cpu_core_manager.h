@@ -8,6 +8,7 @@
 #include <map>
 #include <memory>
 #include <thread>
+#include "common/common_types.h"
 
 namespace Core {
 
@@ -44,6 +45,8 @@ public:
 
     void InvalidateAllInstructionCaches();
 
+    void InvalidateInstructionCacheRange(VAddr addr, std::size_t size);
+
 private:
     static constexpr std::size_t NUM_CPU_CORES = 4;
 
@@ -51,7 +54,9 @@ private:
     std::unique_ptr<CpuBarrier> barrier;
     std::array<std::unique_ptr<Cpu>, NUM_CPU_CORES> cores;
     std::array<std::unique_ptr<std::thread>, NUM_CPU_CORES - 1> core_threads;
-    std::size_t active_core{}; ///< Active core, only used in single thread mode
+    std::size_t active_core{};     ///< Active core, only used in single thread mode
+    bool is_multicore{};           ///< Whether the cores run on their own threads this session
+    std::thread::id core_0_thread; ///< Host thread that last ran core 0, placed when it changes
 
     /// Map of guest threads to CPU cores
     std::map<std::thread::id, Cpu*> thread_to_cpu;
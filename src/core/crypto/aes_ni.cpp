@@ -0,0 +1,222 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#include "common/assert.h"
+#include "common/swap.h"
+#include "common/x64/cpu_detect.h"
+#include "core/crypto/aes_ni.h"
+
+// The rest of the code is built for baseline x86-64, only these functions may use AES-NI
+#if defined(__GNUC__) || defined(__clang__)
+#define AESNI_TARGET __attribute__((target("aes")))
+#else
+#define AESNI_TARGET
+#endif
+
+namespace Core::Crypto::AESNI {
+namespace {
+
+constexpr std::size_t BLOCK_SIZE = 0x10;
+constexpr std::size_t NUM_ROUNDS = 10;
+
+/// Number of blocks in flight, hides the latency of the AES instructions
+constexpr std::size_t PIPELINE_BLOCKS = 8;
+
+AESNI_TARGET __m128i LoadRoundKey(const RoundKeys128& keys, std::size_t round) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(keys.keys.data()) + round);
+}
+
+template <int rcon>
+AESNI_TARGET __m128i ExpandRound(__m128i key) {
+    const __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, rcon), 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/// Runs all the rounds on a group of blocks, interleaving the blocks round by round
+template <std::size_t count>
+AESNI_TARGET void EncryptBlocks(const RoundKeys128& keys, __m128i (&blocks)[count]) {
+    const __m128i first_key = LoadRoundKey(keys, 0);
+    for (auto& block : blocks) {
+        block = _mm_xor_si128(block, first_key);
+    }
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        const __m128i key = LoadRoundKey(keys, round);
+        for (auto& block : blocks) {
+            block = _mm_aesenc_si128(block, key);
+        }
+    }
+    const __m128i last_key = LoadRoundKey(keys, NUM_ROUNDS);
+    for (auto& block : blocks) {
+        block = _mm_aesenclast_si128(block, last_key);
+    }
+}
+
+template <std::size_t count>
+AESNI_TARGET void DecryptBlocks(const RoundKeys128& keys, __m128i (&blocks)[count]) {
+    const __m128i first_key = LoadRoundKey(keys, 0);
+    for (auto& block : blocks) {
+        block = _mm_xor_si128(block, first_key);
+    }
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        const __m128i key = LoadRoundKey(keys, round);
+        for (auto& block : blocks) {
+            block = _mm_aesdec_si128(block, key);
+        }
+    }
+    const __m128i last_key = LoadRoundKey(keys, NUM_ROUNDS);
+    for (auto& block : blocks) {
+        block = _mm_aesdeclast_si128(block, last_key);
+    }
+}
+
+template <std::size_t count>
+AESNI_TARGET void TranscodeBlocks(const RoundKeys128& keys, __m128i (&blocks)[count], Op op) {
+    if (op == Op::Encrypt) {
+        EncryptBlocks(keys, blocks);
+    } else {
+        DecryptBlocks(keys, blocks);
+    }
+}
+
+/// Builds the counter block of the given index, the 128-bit counter is stored big endian
+AESNI_TARGET __m128i MakeCounterBlock(u64 high, u64 low, u64 index) {
+    const u64 block_low = low + index;
+    const u64 block_high = high + (block_low < low ? 1 : 0);
+    return _mm_set_epi64x(static_cast<s64>(Common::swap64(block_low)),
+                          static_cast<s64>(Common::swap64(block_high)));
+}
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128)
+AESNI_TARGET __m128i MultiplyTweak(__m128i tweak) {
+    // Each 32-bit lane carries its top bit into the next lane, the top bit of the tweak is
+    // reduced by the polynomial x^128 + x^7 + x^2 + x + 1
+    const __m128i carries = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), 0x93);
+    const __m128i carry_values = _mm_set_epi32(1, 1, 1, 0x87);
+    return _mm_xor_si128(_mm_slli_epi32(tweak, 1), _mm_and_si128(carries, carry_values));
+}
+
+AESNI_TARGET __m128i LoadBlock(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+AESNI_TARGET void StoreBlock(u8* dest, __m128i block) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), block);
+}
+
+} // Anonymous namespace
+
+bool IsSupported() {
+    return Common::GetCPUCaps().aes;
+}
+
+AESNI_TARGET void ExpandKey128(const u8* key, RoundKeys128& encrypt_keys,
+                               RoundKeys128& decrypt_keys) {
+    __m128i round_keys[NUM_ROUNDS + 1];
+    round_keys[0] = LoadBlock(key);
+    round_keys[1] = ExpandRound<0x01>(round_keys[0]);
+    round_keys[2] = ExpandRound<0x02>(round_keys[1]);
+    round_keys[3] = ExpandRound<0x04>(round_keys[2]);
+    round_keys[4] = ExpandRound<0x08>(round_keys[3]);
+    round_keys[5] = ExpandRound<0x10>(round_keys[4]);
+    round_keys[6] = ExpandRound<0x20>(round_keys[5]);
+    round_keys[7] = ExpandRound<0x40>(round_keys[6]);
+    round_keys[8] = ExpandRound<0x80>(round_keys[7]);
+    round_keys[9] = ExpandRound<0x1B>(round_keys[8]);
+    round_keys[10] = ExpandRound<0x36>(round_keys[9]);
+
+    // The equivalent inverse cipher runs the rounds backwards with mixed round keys
+    auto* const encrypt = reinterpret_cast<__m128i*>(encrypt_keys.keys.data());
+    auto* const decrypt = reinterpret_cast<__m128i*>(decrypt_keys.keys.data());
+    for (std::size_t round = 0; round <= NUM_ROUNDS; ++round) {
+        _mm_store_si128(encrypt + round, round_keys[round]);
+    }
+    _mm_store_si128(decrypt, round_keys[NUM_ROUNDS]);
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        _mm_store_si128(decrypt + round, _mm_aesimc_si128(round_keys[NUM_ROUNDS - round]));
+    }
+    _mm_store_si128(decrypt + NUM_ROUNDS, round_keys[0]);
+}
+
+AESNI_TARGET void TranscodeCTR(const RoundKeys128& keys, std::array<u8, 0x10>& counter,
+                               const u8* src, std::size_t size, u8* dest) {
+    u64 high;
+    u64 low;
+    std::memcpy(&high, counter.data(), sizeof(high));
+    std::memcpy(&low, counter.data() + sizeof(high), sizeof(low));
+    high = Common::swap64(high);
+    low = Common::swap64(low);
+
+    u64 index = 0;
+    for (; size >= PIPELINE_BLOCKS * BLOCK_SIZE; size -= PIPELINE_BLOCKS * BLOCK_SIZE) {
+        __m128i blocks[PIPELINE_BLOCKS];
+        for (std::size_t i = 0; i < PIPELINE_BLOCKS; ++i) {
+            blocks[i] = MakeCounterBlock(high, low, index++);
+        }
+        EncryptBlocks(keys, blocks);
+        for (std::size_t i = 0; i < PIPELINE_BLOCKS; ++i) {
+            StoreBlock(dest, _mm_xor_si128(blocks[i], LoadBlock(src)));
+            src += BLOCK_SIZE;
+            dest += BLOCK_SIZE;
+        }
+    }
+    for (; size >= BLOCK_SIZE; size -= BLOCK_SIZE) {
+        __m128i blocks[1]{MakeCounterBlock(high, low, index++)};
+        EncryptBlocks(keys, blocks);
+        StoreBlock(dest, _mm_xor_si128(blocks[0], LoadBlock(src)));
+        src += BLOCK_SIZE;
+        dest += BLOCK_SIZE;
+    }
+    if (size > 0) {
+        __m128i blocks[1]{MakeCounterBlock(high, low, index++)};
+        EncryptBlocks(keys, blocks);
+        u8 key_stream[BLOCK_SIZE];
+        StoreBlock(key_stream, blocks[0]);
+        for (std::size_t i = 0; i < size; ++i) {
+            dest[i] = src[i] ^ key_stream[i];
+        }
+    }
+
+    StoreBlock(counter.data(), MakeCounterBlock(high, low, index));
+}
+
+AESNI_TARGET void TranscodeXTS(const RoundKeys128& data_keys, const RoundKeys128& tweak_keys,
+                               const std::array<u8, 0x10>& tweak, const u8* src, std::size_t size,
+                               u8* dest, Op op) {
+    ASSERT_MSG(size % BLOCK_SIZE == 0, "XTS data unit must be a multiple of the block size.");
+
+    __m128i current_tweak[1]{LoadBlock(tweak.data())};
+    EncryptBlocks(tweak_keys, current_tweak);
+
+    for (; size >= PIPELINE_BLOCKS * BLOCK_SIZE; size -= PIPELINE_BLOCKS * BLOCK_SIZE) {
+        __m128i tweaks[PIPELINE_BLOCKS];
+        __m128i blocks[PIPELINE_BLOCKS];
+        for (std::size_t i = 0; i < PIPELINE_BLOCKS; ++i) {
+            tweaks[i] = current_tweak[0];
+            blocks[i] = _mm_xor_si128(LoadBlock(src + i * BLOCK_SIZE), tweaks[i]);
+            current_tweak[0] = MultiplyTweak(current_tweak[0]);
+        }
+        TranscodeBlocks(data_keys, blocks, op);
+        for (std::size_t i = 0; i < PIPELINE_BLOCKS; ++i) {
+            StoreBlock(dest + i * BLOCK_SIZE, _mm_xor_si128(blocks[i], tweaks[i]));
+        }
+        src += PIPELINE_BLOCKS * BLOCK_SIZE;
+        dest += PIPELINE_BLOCKS * BLOCK_SIZE;
+    }
+    for (; size > 0; size -= BLOCK_SIZE) {
+        __m128i blocks[1]{_mm_xor_si128(LoadBlock(src), current_tweak[0])};
+        TranscodeBlocks(data_keys, blocks, op);
+        StoreBlock(dest, _mm_xor_si128(blocks[0], current_tweak[0]));
+        current_tweak[0] = MultiplyTweak(current_tweak[0]);
+        src += BLOCK_SIZE;
+        dest += BLOCK_SIZE;
+    }
+}
+
+} // namespace Core::Crypto::AESNI
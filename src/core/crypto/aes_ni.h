@@ -0,0 +1,45 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/crypto/aes_util.h"
+
+// AES-128 CTR and XTS implemented with the AES-NI instructions of x86-64 CPUs. The functions can
+// only be called when IsSupported returns true.
+namespace Core::Crypto::AESNI {
+
+/// Expanded round keys of an AES-128 key
+struct RoundKeys128 {
+    alignas(16) std::array<u8, 11 * 0x10> keys;
+};
+
+/// Returns whether the host CPU has the AES-NI instructions
+bool IsSupported();
+
+/// Expands an AES-128 key into the round keys used to encrypt and to decrypt
+void ExpandKey128(const u8* key, RoundKeys128& encrypt_keys, RoundKeys128& decrypt_keys);
+
+/**
+ * Encrypts or decrypts data in CTR mode, src and dest may be the same buffer.
+ * @param keys Encryption round keys, CTR mode only ever encrypts
+ * @param counter Big endian counter of the first block, advanced past the last block
+ */
+void TranscodeCTR(const RoundKeys128& keys, std::array<u8, 0x10>& counter, const u8* src,
+                  std::size_t size, u8* dest);
+
+/**
+ * Encrypts or decrypts one XTS data unit, src and dest may be the same buffer.
+ * @param data_keys Round keys of the first half of the key, for the operation being performed
+ * @param tweak_keys Encryption round keys of the second half of the key
+ * @param size Size of the data unit, must be a multiple of the block size
+ */
+void TranscodeXTS(const RoundKeys128& data_keys, const RoundKeys128& tweak_keys,
+                  const std::array<u8, 0x10>& tweak, const u8* src, std::size_t size, u8* dest,
+                  Op op);
+
+} // namespace Core::Crypto::AESNI
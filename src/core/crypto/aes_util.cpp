@@ -2,16 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <mbedtls/cipher.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "core/crypto/aes_ni.h"
+#endif
+
 namespace Core::Crypto {
 namespace {
-std::vector<u8> CalculateNintendoTweak(std::size_t sector_id) {
-    std::vector<u8> out(0x10);
+std::array<u8, 0x10> CalculateNintendoTweak(std::size_t sector_id) {
+    std::array<u8, 0x10> out;
     for (std::size_t i = 0xF; i <= 0xF; --i) {
         out[i] = sector_id & 0xFF;
         sector_id >>= 8;
@@ -34,11 +41,51 @@ static_assert(static_cast<std::size_t>(Mode::XTS) ==
 struct CipherContext {
     mbedtls_cipher_context_t encryption_context;
     mbedtls_cipher_context_t decryption_context;
+
+#ifdef ARCHITECTURE_x86_64
+    /// Set when AES-128 CTR or XTS is done with AES-NI instead of mbedtls
+    bool use_aesni = false;
+    AESNI::RoundKeys128 encryption_keys;
+    AESNI::RoundKeys128 decryption_keys;
+    AESNI::RoundKeys128 tweak_keys; ///< Second half of an XTS key
+    std::array<u8, 0x10> counter{}; ///< CTR counter or XTS tweak
+    Mode mode;
+#endif
 };
 
+namespace {
+void SetContextIV(CipherContext& ctx, const u8* iv, std::size_t size) {
+#ifdef ARCHITECTURE_x86_64
+    if (ctx.use_aesni) {
+        ctx.counter.fill(0);
+        std::memcpy(ctx.counter.data(), iv, std::min(size, ctx.counter.size()));
+        return;
+    }
+#endif
+    ASSERT_MSG((mbedtls_cipher_set_iv(&ctx.encryption_context, iv, size) ||
+                mbedtls_cipher_set_iv(&ctx.decryption_context, iv, size)) == 0,
+               "Failed to set IV on mbedtls ciphers.");
+}
+} // Anonymous namespace
+
 template <typename Key, std::size_t KeySize>
 Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
     : ctx(std::make_unique<CipherContext>()) {
+#ifdef ARCHITECTURE_x86_64
+    // XTS takes two AES-128 keys, the AES-256 variants of CTR and ECB stay on mbedtls
+    const bool is_aes128_ctr = KeySize == 0x10 && mode == Mode::CTR;
+    const bool is_aes128_xts = KeySize == 0x20 && mode == Mode::XTS;
+    if ((is_aes128_ctr || is_aes128_xts) && AESNI::IsSupported()) {
+        ctx->use_aesni = true;
+        ctx->mode = mode;
+        AESNI::ExpandKey128(key.data(), ctx->encryption_keys, ctx->decryption_keys);
+        if (is_aes128_xts) {
+            AESNI::RoundKeys128 unused_keys;
+            AESNI::ExpandKey128(key.data() + 0x10, ctx->tweak_keys, unused_keys);
+        }
+    }
+#endif
+
     mbedtls_cipher_init(&ctx->encryption_context);
     mbedtls_cipher_init(&ctx->decryption_context);
 
@@ -64,14 +111,24 @@ AESCipher<Key, KeySize>::~AESCipher() {
 }
 
 template <typename Key, std::size_t KeySize>
-void AESCipher<Key, KeySize>::SetIV(std::vector<u8> iv) {
-    ASSERT_MSG((mbedtls_cipher_set_iv(&ctx->encryption_context, iv.data(), iv.size()) ||
-                mbedtls_cipher_set_iv(&ctx->decryption_context, iv.data(), iv.size())) == 0,
-               "Failed to set IV on mbedtls ciphers.");
+void AESCipher<Key, KeySize>::SetIV(const std::vector<u8>& iv) {
+    SetContextIV(*ctx, iv.data(), iv.size());
 }
 
 template <typename Key, std::size_t KeySize>
 void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* dest, Op op) const {
+#ifdef ARCHITECTURE_x86_64
+    if (ctx->use_aesni) {
+        if (ctx->mode == Mode::CTR) {
+            AESNI::TranscodeCTR(ctx->encryption_keys, ctx->counter, src, size, dest);
+        } else {
+            AESNI::TranscodeXTS(op == Op::Encrypt ? ctx->encryption_keys : ctx->decryption_keys,
+                                ctx->tweak_keys, ctx->counter, src, size, dest, op);
+        }
+        return;
+    }
+#endif
+
     auto* const context = op == Op::Encrypt ? &ctx->encryption_context : &ctx->decryption_context;
 
     mbedtls_cipher_reset(context);
@@ -119,7 +176,8 @@ void AESCipher<Key, KeySize>::XTSTranscode(const u8* src, std::size_t size, u8*
     ASSERT_MSG(size % sector_size == 0, "XTS decryption size must be a multiple of sector size.");
 
     for (std::size_t i = 0; i < size; i += sector_size) {
-        SetIV(CalculateNintendoTweak(sector_id++));
+        const auto tweak = CalculateNintendoTweak(sector_id++);
+        SetContextIV(*ctx, tweak.data(), tweak.size());
         Transcode<u8, u8>(src + i, sector_size, dest + i, op);
     }
 }
@@ -2,16 +2,35 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstring>
 #include "common/assert.h"
 #include "core/crypto/ctr_encryption_layer.h"
 
 namespace Core::Crypto {
 
+// Reads at least this large get a cipher of their own instead of waiting for the shared one, its
+// key schedule costs far less than decrypting them. The small metadata reads of the file systems
+// stay below it and keep sharing the cipher.
+constexpr std::size_t LOCAL_CIPHER_THRESHOLD = 0x10000;
+
+namespace {
+
+/// Stores the counter of the sector at the given offset in the lower half of the IV
+void SetCounter(std::vector<u8>& iv, std::size_t offset) {
+    offset >>= 4;
+    for (std::size_t i = 0; i < 8; ++i) {
+        iv[16 - i - 1] = offset & 0xFF;
+        offset >>= 8;
+    }
+}
+
+} // Anonymous namespace
+
 CTREncryptionLayer::CTREncryptionLayer(FileSys::VirtualFile base_, Key128 key_,
                                        std::size_t base_offset)
-    : EncryptionLayer(std::move(base_)), base_offset(base_offset), cipher(key_, Mode::CTR),
-      iv(16, 0) {}
+    : EncryptionLayer(std::move(base_)), base_offset(base_offset), key(key_),
+      cipher(key_, Mode::CTR), iv(16, 0) {}
 
 std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
     if (length == 0)
@@ -19,16 +38,16 @@ std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
 
     const auto sector_offset = offset & 0xF;
     if (sector_offset == 0) {
-        UpdateIV(base_offset + offset);
-        std::vector<u8> raw = base->ReadBytes(length, offset);
-        cipher.Transcode(raw.data(), raw.size(), data, Op::Decrypt);
-        return length;
+        // Decrypted in place, the ciphertext doesn't go through a temporary buffer
+        const std::size_t read = base->Read(data, length, offset);
+        Decrypt(data, read, base_offset + offset);
+        return read;
     }
 
     // offset does not fall on block boundary (0x10)
-    std::vector<u8> block = base->ReadBytes(0x10, offset - sector_offset);
-    UpdateIV(base_offset + offset - sector_offset);
-    cipher.Transcode(block.data(), block.size(), block.data(), Op::Decrypt);
+    std::array<u8, 0x10> block{};
+    base->Read(block.data(), block.size(), offset - sector_offset);
+    Decrypt(block.data(), block.size(), base_offset + offset - sector_offset);
     std::size_t read = 0x10 - sector_offset;
 
     if (length + sector_offset < 0x10) {
@@ -40,16 +59,32 @@ std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
 }
 
 void CTREncryptionLayer::SetIV(const std::vector<u8>& iv_) {
+    std::scoped_lock lock{mutex};
     const auto length = std::min(iv_.size(), iv.size());
     iv.assign(iv_.cbegin(), iv_.cbegin() + length);
 }
 
-void CTREncryptionLayer::UpdateIV(std::size_t offset) const {
-    offset >>= 4;
-    for (std::size_t i = 0; i < 8; ++i) {
-        iv[16 - i - 1] = offset & 0xFF;
-        offset >>= 8;
+void CTREncryptionLayer::Decrypt(u8* data, std::size_t length, std::size_t offset) const {
+    if (length < LOCAL_CIPHER_THRESHOLD) {
+        std::scoped_lock lock{mutex};
+        UpdateIV(offset);
+        cipher.Transcode(data, length, data, Op::Decrypt);
+        return;
     }
+
+    std::vector<u8> local_iv;
+    {
+        std::scoped_lock lock{mutex};
+        local_iv = iv;
+    }
+    SetCounter(local_iv, offset);
+    AESCipher<Key128> local_cipher(key, Mode::CTR);
+    local_cipher.SetIV(local_iv);
+    local_cipher.Transcode(data, length, data, Op::Decrypt);
+}
+
+void CTREncryptionLayer::UpdateIV(std::size_t offset) const {
+    SetCounter(iv, offset);
     cipher.SetIV(iv);
 }
 } // namespace Core::Crypto
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 #include "core/crypto/aes_util.h"
 #include "core/crypto/encryption_layer.h"
@@ -11,7 +12,8 @@
 
 namespace Core::Crypto {
 
-// Sits on top of a VirtualFile and provides CTR-mode AES decription.
+// Sits on top of a VirtualFile and provides CTR-mode AES decription. Reads are safe from several
+// threads, large ones are decrypted in parallel.
 class CTREncryptionLayer : public EncryptionLayer {
 public:
     CTREncryptionLayer(FileSys::VirtualFile base, Key128 key, std::size_t base_offset);
@@ -22,12 +24,17 @@ public:
 
 private:
     std::size_t base_offset;
+    Key128 key;
 
     // Must be mutable as operations modify cipher contexts.
+    mutable std::mutex mutex; ///< Protects the shared cipher and its IV
     mutable AESCipher<Key128> cipher;
     mutable std::vector<u8> iv;
 
     void UpdateIV(std::size_t offset) const;
+
+    /// Decrypts in place the data read at the given offset of the encrypted region
+    void Decrypt(u8* data, std::size_t length, std::size_t offset) const;
 };
 
 } // namespace Core::Crypto
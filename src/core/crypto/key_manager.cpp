@@ -9,6 +9,7 @@
 #include <fstream>
 #include <locale>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string_view>
 #include <tuple>
@@ -371,24 +372,77 @@ std::optional<std::pair<Key128, Key128>> ParseTicket(const TicketRaw& ticket,
     return std::make_pair(rights_id, key_temp);
 }
 
+namespace {
+
+/// The keys loaded from the key files by the last KeyManager constructed, shared by all the
+/// instances constructed while the files stay the same.
+struct KeyFileCache {
+    /// Path, size and modification time of the key files, in the order they were loaded
+    std::vector<std::tuple<std::string, u64, s64>> files;
+    bool dev_mode = false;
+
+    std::map<KeyIndex<S128KeyType>, Key128> s128_keys;
+    std::map<KeyIndex<S256KeyType>, Key256> s256_keys;
+    std::array<std::array<u8, 0xB0>, 0x20> encrypted_keyblobs{};
+    std::array<std::array<u8, 0x90>, 0x20> keyblobs{};
+};
+
+std::mutex key_file_cache_mutex;
+std::optional<KeyFileCache> key_file_cache;
+
+} // Anonymous namespace
+
 KeyManager::KeyManager() {
     // Initialize keys
     const std::string hactool_keys_dir = FileUtil::GetHactoolConfigurationPath();
     const std::string yuzu_keys_dir = FileUtil::GetUserPath(FileUtil::UserPath::KeysDir);
+
+    // The keys are only parsed again when a key file changed, keys derived by other instances
+    // are appended to the autogenerated files, which changes them.
+    std::vector<std::pair<std::string, bool>> key_files;
+    const auto add_key_file = [&](const std::string& dir1, const std::string& dir2,
+                                  const std::string& filename, bool title) {
+        if (FileUtil::Exists(dir1 + DIR_SEP + filename))
+            key_files.emplace_back(dir1 + DIR_SEP + filename, title);
+        else if (FileUtil::Exists(dir2 + DIR_SEP + filename))
+            key_files.emplace_back(dir2 + DIR_SEP + filename, title);
+    };
+
     if (Settings::values.use_dev_keys) {
         dev_mode = true;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
+        add_key_file(yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
+        add_key_file(yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
     } else {
         dev_mode = false;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
+        add_key_file(yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
+        add_key_file(yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
+    }
+
+    add_key_file(yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
+    add_key_file(yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
+    add_key_file(yuzu_keys_dir, hactool_keys_dir, "console.keys", false);
+    add_key_file(yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated", false);
+
+    std::vector<std::tuple<std::string, u64, s64>> stamps;
+    stamps.reserve(key_files.size());
+    for (const auto& [path, title] : key_files) {
+        stamps.emplace_back(path, FileUtil::GetSize(path), FileUtil::GetModificationTime(path));
     }
 
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "console.keys", false);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated", false);
+    std::lock_guard lock{key_file_cache_mutex};
+    if (key_file_cache && key_file_cache->dev_mode == dev_mode && key_file_cache->files == stamps) {
+        s128_keys = key_file_cache->s128_keys;
+        s256_keys = key_file_cache->s256_keys;
+        encrypted_keyblobs = key_file_cache->encrypted_keyblobs;
+        keyblobs = key_file_cache->keyblobs;
+        return;
+    }
+
+    for (const auto& [path, title] : key_files) {
+        LoadFromFile(path, title);
+    }
+    key_file_cache =
+        KeyFileCache{std::move(stamps), dev_mode, s128_keys, s256_keys, encrypted_keyblobs, keyblobs};
 }
 
 static bool ValidCryptoRevisionString(std::string_view base, size_t begin, size_t length) {
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <limits>
 #include <locale>
 #include "common/hex_util.h"
 #include "common/microprofile.h"
@@ -61,173 +63,140 @@ void CheatList::Execute() {
     MICROPROFILE_SCOPE(Cheat_Engine);
 
     std::fill(scratch.begin(), scratch.end(), 0);
-    in_standard = false;
+    press_state.reset();
     for (std::size_t i = 0; i < master_list.size(); ++i) {
-        LOG_DEBUG(Common_Filesystem, "Executing block #{:08X} ({})", i, master_list[i].first);
-        current_block = i;
-        ExecuteBlock(master_list[i].second);
+        LOG_DEBUG(Common_Filesystem, "Executing block #{:08X} ({})", i, master_list[i].name);
+        ExecuteBlock(master_list[i]);
     }
 
-    in_standard = true;
     for (std::size_t i = 0; i < standard_list.size(); ++i) {
-        LOG_DEBUG(Common_Filesystem, "Executing block #{:08X} ({})", i, standard_list[i].first);
-        current_block = i;
-        ExecuteBlock(standard_list[i].second);
+        LOG_DEBUG(Common_Filesystem, "Executing block #{:08X} ({})", i, standard_list[i].name);
+        ExecuteBlock(standard_list[i]);
     }
 }
 
 CheatList::CheatList(const Core::System& system_, ProgramSegment master, ProgramSegment standard)
-    : master_list{std::move(master)}, standard_list{std::move(standard)}, system{&system_} {}
-
-bool CheatList::EvaluateConditional(const Cheat& cheat) const {
-    using ComparisonFunction = bool (*)(u64, u64);
-    constexpr std::array<ComparisonFunction, 6> comparison_functions{
-        [](u64 a, u64 b) { return a > b; },  [](u64 a, u64 b) { return a >= b; },
-        [](u64 a, u64 b) { return a < b; },  [](u64 a, u64 b) { return a <= b; },
-        [](u64 a, u64 b) { return a == b; }, [](u64 a, u64 b) { return a != b; },
-    };
-
-    if (cheat.type == CodeType::ConditionalInput) {
-        const auto applet_resource =
-            system->ServiceManager().GetService<Service::HID::Hid>("hid")->GetAppletResource();
-        if (applet_resource == nullptr) {
-            LOG_WARNING(
-                Common_Filesystem,
-                "Attempted to evaluate input conditional, but applet resource is not initialized!");
-            return false;
-        }
-
-        const auto press_state =
-            applet_resource
-                ->GetController<Service::HID::Controller_NPad>(Service::HID::HidController::NPad)
-                .GetAndResetPressState();
-        return ((press_state & cheat.KeypadValue()) & KEYPAD_BITMASK) != 0;
+    : system{&system_} {
+    std::size_t max_block_size = 0;
+    for (const auto& [name, block] : master) {
+        master_list.push_back(Compile(name, block));
+        max_block_size = std::max(max_block_size, block.size());
     }
-
-    ASSERT(cheat.type == CodeType::Conditional);
-
-    const auto offset =
-        cheat.memory_type == MemoryType::MainNSO ? main_region_begin : heap_region_begin;
-    ASSERT(static_cast<u8>(cheat.comparison_op.Value()) < 6);
-    auto* function = comparison_functions[static_cast<u8>(cheat.comparison_op.Value())];
-    const auto addr = cheat.Address() + offset;
-
-    return function(reader(cheat.width, SanitizeAddress(addr)), cheat.ValueWidth(8));
+    for (const auto& [name, block] : standard) {
+        standard_list.push_back(Compile(name, block));
+        max_block_size = std::max(max_block_size, block.size());
+    }
+    loop_counters.resize(max_block_size);
 }
 
-void CheatList::ProcessBlockPairs(const Block& block) {
-    block_pairs.clear();
-
-    u64 scope = 0;
-    std::map<u64, u64> pairs;
+CheatList::CompiledBlock CheatList::Compile(const std::string& name, const Block& block) {
+    CompiledBlock out{name, {}};
+    out.cheats.reserve(block.size());
 
+    // Conditionals and loops share one stack of open statements, the ones that are never closed
+    // run to the end of the block
+    std::vector<std::size_t> open;
     for (std::size_t i = 0; i < block.size(); ++i) {
         const auto& cheat = block[i];
+        CompiledCheat compiled{};
+        compiled.type = cheat.type;
+        compiled.memory_type = cheat.memory_type;
+        compiled.width = static_cast<u8>(cheat.width.Value());
+        compiled.register_index = static_cast<u8>(cheat.register_3.Value());
+        compiled.target = block.size();
 
         switch (cheat.type) {
+        case CodeType::WriteImmediate:
+            compiled.address = cheat.Address();
+            compiled.value = cheat.ValueWidth(8);
+            break;
         case CodeType::Conditional:
-        case CodeType::ConditionalInput:
-            pairs.insert_or_assign(scope, i);
-            ++scope;
+            compiled.address = cheat.Address();
+            compiled.value = cheat.ValueWidth(8);
+            compiled.op = static_cast<u8>(cheat.comparison_op.Value());
+            open.push_back(i);
             break;
-        case CodeType::EndConditional: {
-            --scope;
-            const auto idx = pairs.at(scope);
-            block_pairs.insert_or_assign(idx, i);
+        case CodeType::ConditionalInput:
+            compiled.value = cheat.KeypadValue();
+            open.push_back(i);
             break;
-        }
-        case CodeType::Loop: {
-            if (cheat.end_of_loop) {
-                --scope;
-                const auto idx = pairs.at(scope);
-                block_pairs.insert_or_assign(idx, i);
+        case CodeType::EndConditional:
+        case CodeType::Loop:
+            compiled.flag = cheat.type == CodeType::Loop && cheat.end_of_loop.Value() != 0;
+            compiled.value = cheat.Value(4, sizeof(s32));
+            if (cheat.type == CodeType::Loop && !compiled.flag) {
+                open.push_back(i);
+            } else if (open.empty()) {
+                LOG_WARNING(Common_Filesystem, "Cheat {} has an unmatched block end", name);
             } else {
-                pairs.insert_or_assign(scope, i);
-                ++scope;
+                out.cheats[open.back()].target = i;
+                compiled.target = open.back();
+                open.pop_back();
             }
             break;
+        case CodeType::LoadImmediate:
+            compiled.value = cheat.Value(4, 8);
+            break;
+        case CodeType::LoadIndexed:
+            compiled.address = cheat.Address();
+            compiled.flag = cheat.load_from_register.Value() != 0;
+            break;
+        case CodeType::StoreIndexed:
+            compiled.value = cheat.ValueWidth(4);
+            compiled.flag = cheat.add_additional_register.Value() != 0;
+            compiled.offset_register = static_cast<u8>(cheat.register_6.Value());
+            break;
+        case CodeType::RegisterArithmetic:
+            compiled.value = cheat.ValueWidth(4);
+            compiled.op = static_cast<u8>(cheat.arithmetic_op.Value());
+            break;
+        default:
+            LOG_WARNING(Common_Filesystem, "Cheat {} has an unknown code type {:X}", name,
+                        static_cast<u32>(cheat.type.Value()));
+            break;
         }
-        }
+        out.cheats.push_back(compiled);
     }
-}
 
-void CheatList::WriteImmediate(const Cheat& cheat) {
-    const auto offset =
-        cheat.memory_type == MemoryType::MainNSO ? main_region_begin : heap_region_begin;
-    const auto& register_3 = scratch.at(cheat.register_3);
-
-    const auto addr = cheat.Address() + offset + register_3;
-    LOG_DEBUG(Common_Filesystem, "writing value={:016X} to addr={:016X}", addr,
-              cheat.Value(8, cheat.width));
-    writer(cheat.width, SanitizeAddress(addr), cheat.ValueWidth(8));
+    return out;
 }
 
-void CheatList::BeginConditional(const Cheat& cheat) {
-    if (EvaluateConditional(cheat)) {
-        return;
-    }
-
-    const auto iter = block_pairs.find(current_index);
-    ASSERT(iter != block_pairs.end());
-    current_index = iter->second - 1;
-}
+bool CheatList::EvaluateConditional(const CompiledCheat& cheat) {
+    using ComparisonFunction = bool (*)(u64, u64);
+    constexpr std::array<ComparisonFunction, 6> comparison_functions{
+        [](u64 a, u64 b) { return a > b; },  [](u64 a, u64 b) { return a >= b; },
+        [](u64 a, u64 b) { return a < b; },  [](u64 a, u64 b) { return a <= b; },
+        [](u64 a, u64 b) { return a == b; }, [](u64 a, u64 b) { return a != b; },
+    };
 
-void CheatList::EndConditional(const Cheat& cheat) {
-    LOG_DEBUG(Common_Filesystem, "Ending conditional block.");
-}
+    if (cheat.type == CodeType::ConditionalInput) {
+        if (!press_state) {
+            const auto applet_resource =
+                system->ServiceManager().GetService<Service::HID::Hid>("hid")->GetAppletResource();
+            if (applet_resource == nullptr) {
+                LOG_WARNING(Common_Filesystem, "Attempted to evaluate input conditional, but "
+                                               "applet resource is not initialized!");
+                return false;
+            }
 
-void CheatList::Loop(const Cheat& cheat) {
-    if (cheat.end_of_loop.Value())
-        ASSERT(!cheat.end_of_loop.Value());
-
-    auto& register_3 = scratch.at(cheat.register_3);
-    const auto iter = block_pairs.find(current_index);
-    ASSERT(iter != block_pairs.end());
-    ASSERT(iter->first < iter->second);
-
-    const s32 initial_value = static_cast<s32>(cheat.Value(4, sizeof(s32)));
-    for (s32 i = initial_value; i >= 0; --i) {
-        register_3 = static_cast<u64>(i);
-        for (std::size_t c = iter->first + 1; c < iter->second; ++c) {
-            current_index = c;
-            ExecuteSingleCheat(
-                (in_standard ? standard_list : master_list)[current_block].second[c]);
+            press_state = applet_resource
+                              ->GetController<Service::HID::Controller_NPad>(
+                                  Service::HID::HidController::NPad)
+                              .GetAndResetPressState();
         }
+        return ((*press_state & cheat.value) & KEYPAD_BITMASK) != 0;
     }
 
-    current_index = iter->second;
-}
-
-void CheatList::LoadImmediate(const Cheat& cheat) {
-    auto& register_3 = scratch.at(cheat.register_3);
+    // The comparison operations start at 1
+    ASSERT(cheat.op >= static_cast<u8>(ComparisonOp::GreaterThan) &&
+           cheat.op <= static_cast<u8>(ComparisonOp::Inequal));
+    auto* function = comparison_functions[cheat.op - 1];
+    const auto addr = cheat.address + GetRegionBase(cheat.memory_type);
 
-    LOG_DEBUG(Common_Filesystem, "setting register={:01X} equal to value={:016X}", cheat.register_3,
-              cheat.Value(4, 8));
-    register_3 = cheat.Value(4, 8);
+    return function(reader(cheat.width, SanitizeAddress(addr)), cheat.value);
 }
 
-void CheatList::LoadIndexed(const Cheat& cheat) {
-    const auto offset =
-        cheat.memory_type == MemoryType::MainNSO ? main_region_begin : heap_region_begin;
-    auto& register_3 = scratch.at(cheat.register_3);
-
-    const auto addr = (cheat.load_from_register.Value() ? register_3 : offset) + cheat.Address();
-    LOG_DEBUG(Common_Filesystem, "writing indexed value to register={:01X}, addr={:016X}",
-              cheat.register_3, addr);
-    register_3 = reader(cheat.width, SanitizeAddress(addr));
-}
-
-void CheatList::StoreIndexed(const Cheat& cheat) {
-    const auto& register_3 = scratch.at(cheat.register_3);
-
-    const auto addr =
-        register_3 + (cheat.add_additional_register.Value() ? scratch.at(cheat.register_6) : 0);
-    LOG_DEBUG(Common_Filesystem, "writing value={:016X} to addr={:016X}",
-              cheat.Value(4, cheat.width), addr);
-    writer(cheat.width, SanitizeAddress(addr), cheat.ValueWidth(4));
-}
-
-void CheatList::RegisterArithmetic(const Cheat& cheat) {
+void CheatList::RegisterArithmetic(const CompiledCheat& cheat) {
     using ArithmeticFunction = u64 (*)(u64, u64);
     constexpr std::array<ArithmeticFunction, 5> arithmetic_functions{
         [](u64 a, u64 b) { return a + b; },  [](u64 a, u64 b) { return a - b; },
@@ -247,32 +216,26 @@ void CheatList::RegisterArithmetic(const Cheat& cheat) {
     static_assert(sizeof(arithmetic_functions) == sizeof(arithmetic_overflow_checks),
                   "Missing or have extra arithmetic overflow checks compared to functions!");
 
-    auto& register_3 = scratch.at(cheat.register_3);
+    auto& register_3 = scratch[cheat.register_index];
 
-    ASSERT(static_cast<u8>(cheat.arithmetic_op.Value()) < 5);
-    auto* function = arithmetic_functions[static_cast<u8>(cheat.arithmetic_op.Value())];
-    auto* overflow_function =
-        arithmetic_overflow_checks[static_cast<u8>(cheat.arithmetic_op.Value())];
+    ASSERT(cheat.op < arithmetic_functions.size());
+    auto* function = arithmetic_functions[cheat.op];
+    auto* overflow_function = arithmetic_overflow_checks[cheat.op];
     LOG_DEBUG(Common_Filesystem, "performing arithmetic with register={:01X}, value={:016X}",
-              cheat.register_3, cheat.ValueWidth(4));
+              cheat.register_index, cheat.value);
 
-    if (overflow_function(register_3, cheat.ValueWidth(4))) {
+    if (overflow_function(register_3, cheat.value)) {
         LOG_WARNING(Common_Filesystem,
                     "overflow will occur when performing arithmetic operation={:02X} with operands "
                     "a={:016X}, b={:016X}!",
-                    static_cast<u8>(cheat.arithmetic_op.Value()), register_3, cheat.ValueWidth(4));
+                    cheat.op, register_3, cheat.value);
     }
 
-    register_3 = function(register_3, cheat.ValueWidth(4));
+    register_3 = function(register_3, cheat.value);
 }
 
-void CheatList::BeginConditionalInput(const Cheat& cheat) {
-    if (EvaluateConditional(cheat))
-        return;
-
-    const auto iter = block_pairs.find(current_index);
-    ASSERT(iter != block_pairs.end());
-    current_index = iter->second - 1;
+VAddr CheatList::GetRegionBase(MemoryType type) const {
+    return type == MemoryType::MainNSO ? main_region_begin : heap_region_begin;
 }
 
 VAddr CheatList::SanitizeAddress(VAddr in) const {
@@ -289,30 +252,71 @@ VAddr CheatList::SanitizeAddress(VAddr in) const {
     return in;
 }
 
-void CheatList::ExecuteSingleCheat(const Cheat& cheat) {
-    using CheatOperationFunction = void (CheatList::*)(const Cheat&);
-    constexpr std::array<CheatOperationFunction, 9> cheat_operation_functions{
-        &CheatList::WriteImmediate,        &CheatList::BeginConditional,
-        &CheatList::EndConditional,        &CheatList::Loop,
-        &CheatList::LoadImmediate,         &CheatList::LoadIndexed,
-        &CheatList::StoreIndexed,          &CheatList::RegisterArithmetic,
-        &CheatList::BeginConditionalInput,
-    };
-
-    const auto index = static_cast<u8>(cheat.type.Value());
-    ASSERT(index < sizeof(cheat_operation_functions));
-    const auto op = cheat_operation_functions[index];
-    (this->*op)(cheat);
-}
+void CheatList::ExecuteBlock(const CompiledBlock& block) {
+    const auto& cheats = block.cheats;
+    for (std::size_t pc = 0; pc < cheats.size(); ++pc) {
+        const auto& cheat = cheats[pc];
+        auto& register_3 = scratch[cheat.register_index];
 
-void CheatList::ExecuteBlock(const Block& block) {
-    encountered_loops.clear();
-
-    ProcessBlockPairs(block);
-    for (std::size_t i = 0; i < block.size(); ++i) {
-        current_index = i;
-        ExecuteSingleCheat(block[i]);
-        i = current_index;
+        switch (cheat.type) {
+        case CodeType::WriteImmediate: {
+            const auto addr = cheat.address + GetRegionBase(cheat.memory_type) + register_3;
+            LOG_DEBUG(Common_Filesystem, "writing value={:016X} to addr={:016X}", cheat.value,
+                      addr);
+            writer(cheat.width, SanitizeAddress(addr), cheat.value);
+            break;
+        }
+        case CodeType::Conditional:
+        case CodeType::ConditionalInput:
+            // Failed conditionals continue after their EndConditional
+            if (!EvaluateConditional(cheat)) {
+                pc = cheat.target;
+            }
+            break;
+        case CodeType::EndConditional:
+            break;
+        case CodeType::Loop:
+            // Loops run with the register counting down from the value to 0
+            if (!cheat.flag) {
+                const auto initial_value = static_cast<s32>(cheat.value);
+                if (initial_value < 0) {
+                    pc = cheat.target;
+                    break;
+                }
+                loop_counters[pc] = initial_value;
+                register_3 = static_cast<u64>(initial_value);
+            } else if (cheat.target < cheats.size() && --loop_counters[cheat.target] >= 0) {
+                scratch[cheats[cheat.target].register_index] =
+                    static_cast<u64>(loop_counters[cheat.target]);
+                pc = cheat.target;
+            }
+            break;
+        case CodeType::LoadImmediate:
+            LOG_DEBUG(Common_Filesystem, "setting register={:01X} equal to value={:016X}",
+                      cheat.register_index, cheat.value);
+            register_3 = cheat.value;
+            break;
+        case CodeType::LoadIndexed: {
+            const auto addr =
+                (cheat.flag ? register_3 : GetRegionBase(cheat.memory_type)) + cheat.address;
+            LOG_DEBUG(Common_Filesystem, "writing indexed value to register={:01X}, addr={:016X}",
+                      cheat.register_index, addr);
+            register_3 = reader(cheat.width, SanitizeAddress(addr));
+            break;
+        }
+        case CodeType::StoreIndexed: {
+            const auto addr = register_3 + (cheat.flag ? scratch[cheat.offset_register] : 0);
+            LOG_DEBUG(Common_Filesystem, "writing value={:016X} to addr={:016X}", cheat.value,
+                      addr);
+            writer(cheat.width, SanitizeAddress(addr), cheat.value);
+            break;
+        }
+        case CodeType::RegisterArithmetic:
+            RegisterArithmetic(cheat);
+            break;
+        default:
+            break;
+        }
     }
 }
 
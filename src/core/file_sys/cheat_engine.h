@@ -4,8 +4,10 @@
 
 #pragma once
 
-#include <map>
-#include <set>
+#include <array>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -137,39 +139,53 @@ public:
     void Execute();
 
 private:
-    CheatList(const Core::System& system_, ProgramSegment master, ProgramSegment standard);
+    // A cheat decoded when the list is created. The execution of cheats used to decode them and to
+    // match their blocks every frame.
+    struct CompiledCheat {
+        CodeType type;
+        MemoryType memory_type;
+        u8 width;
+        u8 register_index;
+        u8 offset_register; ///< Register added to the address of StoreIndexed, if flag is set
+        u8 op;              ///< ComparisonOp or ArithmeticOp
+        bool flag;          ///< Loop end, LoadIndexed from register or StoreIndexed offset register
+        u64 address;
+        u64 value;
+        std::size_t target; ///< Matching end of blocks and loops, matching start of loop ends
+    };
+
+    struct CompiledBlock {
+        std::string name;
+        std::vector<CompiledCheat> cheats;
+    };
 
-    void ProcessBlockPairs(const Block& block);
-    void ExecuteSingleCheat(const Cheat& cheat);
+    CheatList(const Core::System& system_, ProgramSegment master, ProgramSegment standard);
 
-    void ExecuteBlock(const Block& block);
+    static CompiledBlock Compile(const std::string& name, const Block& block);
 
-    bool EvaluateConditional(const Cheat& cheat) const;
+    void ExecuteBlock(const CompiledBlock& block);
 
-    // Individual cheat operations
-    void WriteImmediate(const Cheat& cheat);
-    void BeginConditional(const Cheat& cheat);
-    void EndConditional(const Cheat& cheat);
-    void Loop(const Cheat& cheat);
-    void LoadImmediate(const Cheat& cheat);
-    void LoadIndexed(const Cheat& cheat);
-    void StoreIndexed(const Cheat& cheat);
-    void RegisterArithmetic(const Cheat& cheat);
-    void BeginConditionalInput(const Cheat& cheat);
+    bool EvaluateConditional(const CompiledCheat& cheat);
+    void RegisterArithmetic(const CompiledCheat& cheat);
 
+    VAddr GetRegionBase(MemoryType type) const;
     VAddr SanitizeAddress(VAddr in) const;
 
     // Master Codes are defined as codes that cannot be disabled and are run prior to all
     // others.
-    ProgramSegment master_list;
+    std::vector<CompiledBlock> master_list;
     // All other codes
-    ProgramSegment standard_list;
-
-    bool in_standard = false;
+    std::vector<CompiledBlock> standard_list;
 
     // 16 (0x0-0xF) scratch registers that can be used by cheats
     std::array<u64, 16> scratch{};
 
+    // Remaining iterations of the loops of the running block, indexed by their start
+    std::vector<s32> loop_counters;
+
+    // The buttons pressed since the previous frame, read by the first input conditional of a frame
+    std::optional<u32> press_state;
+
     MemoryWriter writer = nullptr;
     MemoryReader reader = nullptr;
 
@@ -178,16 +194,6 @@ private:
     u64 main_region_end{};
     u64 heap_region_end{};
 
-    u64 current_block{};
-    // The current index of the cheat within the current Block
-    u64 current_index{};
-
-    // The 'stack' of the program. When a conditional or loop statement is encountered, its index is
-    // pushed onto this queue. When a end block is encountered, the condition is checked.
-    std::map<u64, u64> block_pairs;
-
-    std::set<u64> encountered_loops;
-
     const Core::System* system;
 };
 
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <map>
 #include <optional>
 #include <utility>
 
@@ -14,7 +15,10 @@
 #include "core/file_sys/nca_patch.h"
 #include "core/file_sys/partition_filesystem.h"
 #include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_cached.h"
+#include "core/file_sys/vfs_concat.h"
 #include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -101,9 +105,7 @@ static bool IsValidNCA(const NCAHeader& header) {
     return header.magic == Common::MakeMagic('N', 'C', 'A', '3');
 }
 
-NCA::NCA(VirtualFile file_, VirtualFile bktr_base_romfs_, u64 bktr_base_ivfc_offset,
-         Core::Crypto::KeyManager keys_)
-    : file(std::move(file_)), bktr_base_romfs(std::move(bktr_base_romfs_)), keys(std::move(keys_)) {
+NCAHeaderView::NCAHeaderView(const VirtualFile& file, const Core::Crypto::KeyManager& keys) {
     if (file == nullptr) {
         status = Loader::ResultStatus::ErrorNullFile;
         return;
@@ -115,28 +117,24 @@ NCA::NCA(VirtualFile file_, VirtualFile bktr_base_romfs_, u64 bktr_base_ivfc_off
         return;
     }
 
-    if (!HandlePotentialHeaderDecryption()) {
+    if (!HandlePotentialHeaderDecryption(keys)) {
         return;
     }
 
     has_rights_id = std::any_of(header.rights_id.begin(), header.rights_id.end(),
                                 [](char c) { return c != '\0'; });
 
-    const std::vector<NCASectionHeader> sections = ReadSectionHeaders();
+    ReadSectionHeaders(file, keys);
     is_update = std::any_of(sections.begin(), sections.end(), [](const NCASectionHeader& header) {
         return header.raw.header.crypto_type == NCASectionCryptoType::BKTR;
     });
 
-    if (!ReadSections(sections, bktr_base_ivfc_offset)) {
-        return;
-    }
-
     status = Loader::ResultStatus::Success;
 }
 
-NCA::~NCA() = default;
+NCAHeaderView::~NCAHeaderView() = default;
 
-bool NCA::CheckSupportedNCA(const NCAHeader& nca_header) {
+bool NCAHeaderView::CheckSupportedNCA(const NCAHeader& nca_header) {
     if (nca_header.magic == Common::MakeMagic('N', 'C', 'A', '2')) {
         status = Loader::ResultStatus::ErrorNCA2;
         return false;
@@ -150,7 +148,7 @@ bool NCA::CheckSupportedNCA(const NCAHeader& nca_header) {
     return true;
 }
 
-bool NCA::HandlePotentialHeaderDecryption() {
+bool NCAHeaderView::HandlePotentialHeaderDecryption(const Core::Crypto::KeyManager& keys) {
     if (IsValidNCA(header)) {
         return true;
     }
@@ -183,12 +181,13 @@ bool NCA::HandlePotentialHeaderDecryption() {
     return true;
 }
 
-std::vector<NCASectionHeader> NCA::ReadSectionHeaders() const {
+void NCAHeaderView::ReadSectionHeaders(const VirtualFile& file,
+                                       const Core::Crypto::KeyManager& keys) {
     const std::ptrdiff_t number_sections =
         std::count_if(std::begin(header.section_tables), std::end(header.section_tables),
                       [](NCASectionTableEntry entry) { return entry.media_offset > 0; });
 
-    std::vector<NCASectionHeader> sections(number_sections);
+    sections.resize(number_sections);
     const auto length_sections = SECTION_HEADER_SIZE * number_sections;
 
     if (encrypted) {
@@ -200,16 +199,77 @@ std::vector<NCASectionHeader> NCA::ReadSectionHeaders() const {
     } else {
         file->ReadBytes(sections.data(), length_sections, SECTION_HEADER_OFFSET);
     }
+}
+
+Loader::ResultStatus NCAHeaderView::GetStatus() const {
+    return status;
+}
+
+const NCAHeader& NCAHeaderView::GetHeader() const {
+    return header;
+}
 
+const std::vector<NCASectionHeader>& NCAHeaderView::GetSectionHeaders() const {
     return sections;
 }
 
-bool NCA::ReadSections(const std::vector<NCASectionHeader>& sections, u64 bktr_base_ivfc_offset) {
+NCAContentType NCAHeaderView::GetType() const {
+    return header.content_type;
+}
+
+u64 NCAHeaderView::GetTitleId() const {
+    if (is_update)
+        return header.title_id | 0x800;
+    return header.title_id;
+}
+
+bool NCAHeaderView::IsUpdate() const {
+    return is_update;
+}
+
+bool NCAHeaderView::HasRightsId() const {
+    return has_rights_id;
+}
+
+bool NCAHeaderView::IsEncrypted() const {
+    return encrypted;
+}
+
+NCA::NCA(VirtualFile file_, VirtualFile bktr_base_romfs_, u64 bktr_base_ivfc_offset_,
+         Core::Crypto::KeyManager keys_)
+    : file(std::move(file_)), bktr_base_romfs(std::move(bktr_base_romfs_)),
+      bktr_base_ivfc_offset(bktr_base_ivfc_offset_), keys(std::move(keys_)) {
+    NCAHeaderView view{file, keys};
+    status = view.GetStatus();
+    if (status != Loader::ResultStatus::Success) {
+        return;
+    }
+
+    header = view.GetHeader();
+    sections = view.GetSectionHeaders();
+    has_rights_id = view.HasRightsId();
+    encrypted = view.IsEncrypted();
+    is_update = view.IsUpdate();
+}
+
+NCA::~NCA() = default;
+
+void NCA::LoadSections() const {
+    // Building the sections opens their PFS0 headers and reads the BKTR tables of updates, which
+    // callers that only need the header of the NCA don't use.
+    std::call_once(sections_loaded, [this] {
+        if (status == Loader::ResultStatus::Success) {
+            ReadSections();
+        }
+    });
+}
+
+bool NCA::ReadSections() const {
     for (std::size_t i = 0; i < sections.size(); ++i) {
         const auto& section = sections[i];
 
         if (section.raw.header.filesystem_type == NCASectionFilesystemType::ROMFS) {
-            if (!ReadRomFSSection(section, header.section_tables[i], bktr_base_ivfc_offset)) {
+            if (!ReadRomFSSection(section, header.section_tables[i])) {
                 return false;
             }
         } else if (section.raw.header.filesystem_type == NCASectionFilesystemType::PFS0) {
@@ -222,8 +282,8 @@ bool NCA::ReadSections(const std::vector<NCASectionHeader>& sections, u64 bktr_b
     return true;
 }
 
-bool NCA::ReadRomFSSection(const NCASectionHeader& section, const NCASectionTableEntry& entry,
-                           u64 bktr_base_ivfc_offset) {
+bool NCA::ReadRomFSSection(const NCASectionHeader& section,
+                           const NCASectionTableEntry& entry) const {
     const std::size_t base_offset = entry.media_offset * MEDIA_OFFSET_MULTIPLIER;
     ivfc_offset = section.romfs.ivfc.levels[IVFC_MAX_LEVEL - 1].offset;
     const std::size_t romfs_offset = base_offset + ivfc_offset;
@@ -337,7 +397,11 @@ bool NCA::ReadRomFSSection(const NCASectionHeader& section, const NCASectionTabl
 
         // BKTR applies to entire IVFC, so make an offset version to level 6
         files.push_back(std::make_shared<OffsetVfsFile>(
-            bktr, romfs_size, section.romfs.ivfc.levels[IVFC_MAX_LEVEL - 1].offset));
+            std::make_shared<CachedVfsFile>(std::move(bktr)), romfs_size,
+            section.romfs.ivfc.levels[IVFC_MAX_LEVEL - 1].offset));
+    } else if (dec != raw) {
+        // Decrypted blocks are kept around, games read the same assets over and over
+        files.push_back(std::make_shared<CachedVfsFile>(std::move(dec)));
     } else {
         files.push_back(std::move(dec));
     }
@@ -346,7 +410,8 @@ bool NCA::ReadRomFSSection(const NCASectionHeader& section, const NCASectionTabl
     return true;
 }
 
-bool NCA::ReadPFS0Section(const NCASectionHeader& section, const NCASectionTableEntry& entry) {
+bool NCA::ReadPFS0Section(const NCASectionHeader& section,
+                          const NCASectionTableEntry& entry) const {
     const u64 offset = (static_cast<u64>(entry.media_offset) * MEDIA_OFFSET_MULTIPLIER) +
                        section.pfs0.pfs0_header_offset;
     const u64 size = MEDIA_OFFSET_MULTIPLIER * (entry.media_end_offset - entry.media_offset);
@@ -418,7 +483,7 @@ std::optional<Core::Crypto::Key128> NCA::GetKeyAreaKey(NCASectionCryptoType type
     return out;
 }
 
-std::optional<Core::Crypto::Key128> NCA::GetTitlekey() {
+std::optional<Core::Crypto::Key128> NCA::GetTitlekey() const {
     const auto master_key_id = GetCryptoRevision();
 
     u128 rights_id{};
@@ -446,7 +511,8 @@ std::optional<Core::Crypto::Key128> NCA::GetTitlekey() {
     return titlekey;
 }
 
-VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in, u64 starting_offset) {
+VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in,
+                         u64 starting_offset) const {
     if (!encrypted)
         return in;
 
@@ -495,16 +561,19 @@ VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in, u64 s
 }
 
 Loader::ResultStatus NCA::GetStatus() const {
+    LoadSections();
     return status;
 }
 
 std::vector<std::shared_ptr<VfsFile>> NCA::GetFiles() const {
+    LoadSections();
     if (status != Loader::ResultStatus::Success)
         return {};
     return files;
 }
 
 std::vector<std::shared_ptr<VfsDirectory>> NCA::GetSubdirectories() const {
+    LoadSections();
     if (status != Loader::ResultStatus::Success)
         return {};
     return dirs;
@@ -523,7 +592,8 @@ NCAContentType NCA::GetType() const {
 }
 
 u64 NCA::GetTitleId() const {
-    if (is_update || status == Loader::ResultStatus::ErrorMissingBKTRBaseRomFS)
+    // Only updates have BKTR sections, so this also covers a missing BKTR base RomFS
+    if (is_update)
         return header.title_id | 0x800;
     return header.title_id;
 }
@@ -533,10 +603,12 @@ bool NCA::IsUpdate() const {
 }
 
 VirtualFile NCA::GetRomFS() const {
+    LoadSections();
     return romfs;
 }
 
 VirtualDir NCA::GetExeFS() const {
+    LoadSections();
     return exefs;
 }
 
@@ -544,11 +616,63 @@ VirtualFile NCA::GetBaseFile() const {
     return file;
 }
 
+VirtualFile NCA::GetDecryptedFile() const {
+    if (status != Loader::ResultStatus::Success || is_update) {
+        return nullptr;
+    }
+    if (!encrypted) {
+        return file;
+    }
+
+    // The plaintext headers are followed by the section headers of the present sections, the
+    // header of the NCA is only detected as encrypted when its magic doesn't match.
+    std::vector<u8> headers(SECTION_HEADER_OFFSET +
+                            SECTION_HEADER_SIZE * header.section_tables.size());
+    std::memcpy(headers.data(), &header, sizeof(NCAHeader));
+    std::memcpy(headers.data() + SECTION_HEADER_OFFSET, sections.data(),
+                sections.size() * sizeof(NCASectionHeader));
+
+    std::map<u64, VirtualFile> pieces;
+    pieces.emplace(0, std::make_shared<VectorVfsFile>(std::move(headers)));
+    u64 end_offset = pieces[0]->GetSize();
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        const auto& entry = header.section_tables[i];
+        const u64 offset = static_cast<u64>(entry.media_offset) * MEDIA_OFFSET_MULTIPLIER;
+        const u64 size = MEDIA_OFFSET_MULTIPLIER * (entry.media_end_offset - entry.media_offset);
+        if (offset < end_offset || offset + size > file->GetSize()) {
+            LOG_ERROR(Loader, "Section {} of {} overlaps another section", i, GetName());
+            return nullptr;
+        }
+
+        // The data between sections, if any, isn't encrypted
+        if (offset > end_offset) {
+            pieces.emplace(end_offset,
+                           std::make_shared<OffsetVfsFile>(file, offset - end_offset, end_offset));
+        }
+
+        auto dec =
+            Decrypt(sections[i], std::make_shared<OffsetVfsFile>(file, size, offset), offset);
+        if (dec == nullptr) {
+            return nullptr;
+        }
+        pieces.emplace(offset, std::move(dec));
+        end_offset = offset + size;
+    }
+    if (file->GetSize() > end_offset) {
+        pieces.emplace(end_offset, std::make_shared<OffsetVfsFile>(
+                                       file, file->GetSize() - end_offset, end_offset));
+    }
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(pieces), GetName());
+}
+
 u64 NCA::GetBaseIVFCOffset() const {
+    LoadSections();
     return ivfc_offset;
 }
 
 VirtualDir NCA::GetLogoPartition() const {
+    LoadSections();
     return logo;
 }
 
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
@@ -94,8 +95,44 @@ inline bool IsDirectoryLogoPartition(const VirtualDir& pfs) {
            pfs->GetFile("StartupMovie.gif") != nullptr;
 }
 
+// The decrypted headers of an NCA, without any of its sections. This is enough for callers that
+// only need to identify an NCA, e.g. by its type or title ID.
+class NCAHeaderView {
+public:
+    explicit NCAHeaderView(const VirtualFile& file,
+                           const Core::Crypto::KeyManager& keys = Core::Crypto::KeyManager());
+    ~NCAHeaderView();
+
+    // Only reflects errors of the headers, see NCA::GetStatus for the errors of the sections.
+    Loader::ResultStatus GetStatus() const;
+
+    const NCAHeader& GetHeader() const;
+    const std::vector<NCASectionHeader>& GetSectionHeaders() const;
+
+    NCAContentType GetType() const;
+    u64 GetTitleId() const;
+    bool IsUpdate() const;
+    bool HasRightsId() const;
+    bool IsEncrypted() const;
+
+private:
+    bool CheckSupportedNCA(const NCAHeader& header);
+    bool HandlePotentialHeaderDecryption(const Core::Crypto::KeyManager& keys);
+    void ReadSectionHeaders(const VirtualFile& file, const Core::Crypto::KeyManager& keys);
+
+    NCAHeader header{};
+    std::vector<NCASectionHeader> sections;
+
+    Loader::ResultStatus status{};
+
+    bool encrypted = false;
+    bool has_rights_id = false;
+    bool is_update = false;
+};
+
 // An implementation of VfsDirectory that represents a Nintendo Content Archive (NCA) conatiner.
-// After construction, use GetStatus to determine if the file is valid and ready to be used.
+// After construction, use GetStatus to determine if the file is valid and ready to be used. The
+// sections are only built once they are first used, or GetStatus is called.
 class NCA : public ReadOnlyVfsDirectory {
 public:
     explicit NCA(VirtualFile file, VirtualFile bktr_base_romfs = nullptr,
@@ -119,40 +156,45 @@ public:
 
     VirtualFile GetBaseFile() const;
 
+    // Returns a file with the same layout as the NCA whose headers and sections are stored
+    // decrypted, which can be opened as an NCA without any keys. Returns the NCA itself if it isn't
+    // encrypted, and nullptr for updates, whose BKTR sections can only be decrypted when read.
+    VirtualFile GetDecryptedFile() const;
+
     // Returns the base ivfc offset used in BKTR patching.
     u64 GetBaseIVFCOffset() const;
 
     VirtualDir GetLogoPartition() const;
 
 private:
-    bool CheckSupportedNCA(const NCAHeader& header);
-    bool HandlePotentialHeaderDecryption();
-
-    std::vector<NCASectionHeader> ReadSectionHeaders() const;
-    bool ReadSections(const std::vector<NCASectionHeader>& sections, u64 bktr_base_ivfc_offset);
-    bool ReadRomFSSection(const NCASectionHeader& section, const NCASectionTableEntry& entry,
-                          u64 bktr_base_ivfc_offset);
-    bool ReadPFS0Section(const NCASectionHeader& section, const NCASectionTableEntry& entry);
+    void LoadSections() const;
+    bool ReadSections() const;
+    bool ReadRomFSSection(const NCASectionHeader& section, const NCASectionTableEntry& entry) const;
+    bool ReadPFS0Section(const NCASectionHeader& section, const NCASectionTableEntry& entry) const;
 
     u8 GetCryptoRevision() const;
     std::optional<Core::Crypto::Key128> GetKeyAreaKey(NCASectionCryptoType type) const;
-    std::optional<Core::Crypto::Key128> GetTitlekey();
-    VirtualFile Decrypt(const NCASectionHeader& header, VirtualFile in, u64 starting_offset);
-
-    std::vector<VirtualDir> dirs;
-    std::vector<VirtualFile> files;
+    std::optional<Core::Crypto::Key128> GetTitlekey() const;
+    VirtualFile Decrypt(const NCASectionHeader& header, VirtualFile in, u64 starting_offset) const;
+
+    // Built by LoadSections
+    mutable std::once_flag sections_loaded;
+    mutable std::vector<VirtualDir> dirs;
+    mutable std::vector<VirtualFile> files;
+    mutable VirtualFile romfs = nullptr;
+    mutable VirtualDir exefs = nullptr;
+    mutable VirtualDir logo = nullptr;
+    mutable u64 ivfc_offset = 0;
 
-    VirtualFile romfs = nullptr;
-    VirtualDir exefs = nullptr;
-    VirtualDir logo = nullptr;
     VirtualFile file;
     VirtualFile bktr_base_romfs;
-    u64 ivfc_offset = 0;
+    u64 bktr_base_ivfc_offset = 0;
 
     NCAHeader header{};
+    std::vector<NCASectionHeader> sections;
     bool has_rights_id{};
 
-    Loader::ResultStatus status{};
+    mutable Loader::ResultStatus status{};
 
     bool encrypted = false;
     bool is_update = false;
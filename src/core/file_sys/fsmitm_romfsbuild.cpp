@@ -126,69 +126,76 @@ static u64 romfs_get_hash_table_count(u64 num_entries) {
     return count;
 }
 
-void RomFSBuildContext::VisitDirectory(VirtualDir root_romfs, VirtualDir ext,
+void RomFSBuildContext::VisitDirectory(VirtualDir dir, VirtualDir ext_dir,
                                        std::shared_ptr<RomFSBuildDirectoryContext> parent) {
-    std::vector<std::shared_ptr<RomFSBuildDirectoryContext>> child_dirs;
-
-    VirtualDir dir;
-
-    if (parent->path_len == 0)
-        dir = root_romfs;
-    else
-        dir = root_romfs->GetDirectoryRelative(parent->path);
-
-    const auto entries = dir->GetEntries();
-
-    for (const auto& kv : entries) {
-        if (kv.second == VfsEntryType::Directory) {
-            const auto child = std::make_shared<RomFSBuildDirectoryContext>();
-            // Set child's path.
-            child->cur_path_ofs = parent->path_len + 1;
-            child->path_len = child->cur_path_ofs + static_cast<u32>(kv.first.size());
-            child->path = parent->path + "/" + kv.first;
-
-            if (ext != nullptr && ext->GetFileRelative(child->path + ".stub") != nullptr)
-                continue;
-
-            // Sanity check on path_len
-            ASSERT(child->path_len < FS_MAX_PATH);
-
-            if (AddDirectory(parent, child)) {
-                child_dirs.push_back(child);
-            }
-        } else {
-            const auto child = std::make_shared<RomFSBuildFileContext>();
-            // Set child's path.
-            child->cur_path_ofs = parent->path_len + 1;
-            child->path_len = child->cur_path_ofs + static_cast<u32>(kv.first.size());
-            child->path = parent->path + "/" + kv.first;
+    // Stubs and IPS patches of the entries of this directory, listed once instead of looking up
+    // every entry in the ext directory
+    std::map<std::string, VirtualFile, std::less<>> ext_files;
+    if (ext_dir != nullptr) {
+        for (auto& file : ext_dir->GetFiles()) {
+            auto name = file->GetName();
+            ext_files.emplace(std::move(name), std::move(file));
+        }
+    }
+    const auto find_ext_file = [&ext_files](const std::string& name) -> VirtualFile {
+        const auto itr = ext_files.find(name);
+        return itr == ext_files.end() ? nullptr : itr->second;
+    };
+
+    // The entries are taken from the directory objects directly, resolving the path of every
+    // entry from the root would walk all the layers again for each of them
+    std::vector<std::pair<std::shared_ptr<RomFSBuildDirectoryContext>, VirtualDir>> child_dirs;
+    for (auto& subdir : dir->GetSubdirectories()) {
+        const auto name = subdir->GetName();
+        const auto child = std::make_shared<RomFSBuildDirectoryContext>();
+        // Set child's path.
+        child->cur_path_ofs = parent->path_len + 1;
+        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+        child->path = parent->path + "/" + name;
+
+        if (find_ext_file(name + ".stub") != nullptr)
+            continue;
+
+        // Sanity check on path_len
+        ASSERT(child->path_len < FS_MAX_PATH);
+
+        if (AddDirectory(parent, child)) {
+            child_dirs.emplace_back(child, std::move(subdir));
+        }
+    }
 
-            if (ext != nullptr && ext->GetFileRelative(child->path + ".stub") != nullptr)
-                continue;
+    for (auto& file : dir->GetFiles()) {
+        const auto name = file->GetName();
+        const auto child = std::make_shared<RomFSBuildFileContext>();
+        // Set child's path.
+        child->cur_path_ofs = parent->path_len + 1;
+        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+        child->path = parent->path + "/" + name;
 
-            // Sanity check on path_len
-            ASSERT(child->path_len < FS_MAX_PATH);
+        if (find_ext_file(name + ".stub") != nullptr)
+            continue;
 
-            child->source = root_romfs->GetFileRelative(child->path);
+        // Sanity check on path_len
+        ASSERT(child->path_len < FS_MAX_PATH);
 
-            if (ext != nullptr) {
-                const auto ips = ext->GetFileRelative(child->path + ".ips");
+        child->source = std::move(file);
 
-                if (ips != nullptr) {
-                    auto patched = PatchIPS(child->source, ips);
-                    if (patched != nullptr)
-                        child->source = std::move(patched);
-                }
-            }
+        const auto ips = find_ext_file(name + ".ips");
+        if (ips != nullptr) {
+            auto patched = PatchIPS(child->source, ips);
+            if (patched != nullptr)
+                child->source = std::move(patched);
+        }
 
-            child->size = child->source->GetSize();
+        child->size = child->source->GetSize();
 
-            AddFile(parent, child);
-        }
+        AddFile(parent, child);
     }
 
-    for (auto& child : child_dirs) {
-        this->VisitDirectory(root_romfs, ext, child);
+    for (auto& [child, subdir] : child_dirs) {
+        auto child_ext_dir =
+            ext_dir == nullptr ? nullptr : ext_dir->GetSubdirectory(subdir->GetName());
+        this->VisitDirectory(std::move(subdir), std::move(child_ext_dir), child);
     }
 }
 
@@ -65,16 +65,16 @@ static bool IsEOF(IPSFileType type, const std::vector<u8>& data) {
     return type == IPSFileType::IPS32 && std::equal(data.begin(), data.end(), eeof.begin());
 }
 
-VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
-    if (in == nullptr || ips == nullptr)
-        return nullptr;
+bool ApplyIPS(std::vector<u8>& in_data, const VirtualFile& ips) {
+    if (ips == nullptr)
+        return false;
 
     const auto type = IdentifyMagic(ips->ReadBytes(0x5));
     if (type == IPSFileType::Error)
-        return nullptr;
-
-    auto in_data = in->ReadAllBytes();
+        return false;
 
+    // The whole patch is read before any of it is applied, so an invalid patch changes nothing
+    std::vector<std::pair<u32, std::vector<u8>>> records;
     std::vector<u8> temp(type == IPSFileType::IPS ? 3 : 4);
     u64 offset = 5; // After header
     while (ips->Read(temp.data(), temp.size(), offset) == temp.size()) {
@@ -91,38 +91,52 @@ VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
 
         u16 data_size{};
         if (ips->ReadObject(&data_size, offset) != sizeof(u16))
-            return nullptr;
+            return false;
         data_size = Common::swap16(data_size);
         offset += sizeof(u16);
 
         if (data_size == 0) { // RLE
             u16 rle_size{};
             if (ips->ReadObject(&rle_size, offset) != sizeof(u16))
-                return nullptr;
+                return false;
             rle_size = Common::swap16(rle_size);
             offset += sizeof(u16);
 
             const auto data = ips->ReadByte(offset++);
             if (!data)
-                return nullptr;
+                return false;
 
-            if (real_offset + rle_size > in_data.size())
-                rle_size = static_cast<u16>(in_data.size() - real_offset);
-            std::memset(in_data.data() + real_offset, *data, rle_size);
+            records.emplace_back(real_offset, std::vector<u8>(rle_size, *data));
         } else { // Standard Patch
-            auto read = data_size;
-            if (real_offset + read > in_data.size())
-                read = static_cast<u16>(in_data.size() - real_offset);
-            if (ips->Read(in_data.data() + real_offset, read, offset) != data_size)
-                return nullptr;
+            auto data = ips->ReadBytes(data_size, offset);
+            if (data.size() != data_size)
+                return false;
+            records.emplace_back(real_offset, std::move(data));
             offset += data_size;
         }
     }
 
     if (!IsEOF(type, temp)) {
-        return nullptr;
+        return false;
     }
 
+    for (const auto& [record_offset, data] : records) {
+        if (record_offset >= in_data.size())
+            continue;
+        const auto size = std::min<std::size_t>(data.size(), in_data.size() - record_offset);
+        std::memcpy(in_data.data() + record_offset, data.data(), size);
+    }
+    return true;
+}
+
+VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
+    if (in == nullptr)
+        return nullptr;
+
+    auto in_data = in->ReadAllBytes();
+    if (!ApplyIPS(in_data, ips))
+        return nullptr;
+
     return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
                                            in->GetContainingDirectory());
 }
@@ -315,24 +329,28 @@ VirtualFile IPSwitchCompiler::Apply(const VirtualFile& in) const {
         return nullptr;
 
     auto in_data = in->ReadAllBytes();
+    Apply(in_data);
+    return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
+                                           in->GetContainingDirectory());
+}
+
+void IPSwitchCompiler::Apply(std::vector<u8>& data) const {
+    if (!valid)
+        return;
 
     for (const auto& patch : patches) {
         if (!patch.enabled)
             continue;
 
         for (const auto& record : patch.records) {
-            if (record.first >= in_data.size())
+            if (record.first >= data.size())
                 continue;
             auto replace_size = record.second.size();
-            if (record.first + replace_size > in_data.size())
-                replace_size = in_data.size() - record.first;
-            for (std::size_t i = 0; i < replace_size; ++i)
-                in_data[i + record.first] = record.second[i];
+            if (record.first + replace_size > data.size())
+                replace_size = data.size() - record.first;
+            std::memcpy(data.data() + record.first, record.second.data(), replace_size);
         }
     }
-
-    return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
-                                           in->GetContainingDirectory());
 }
 
 } // namespace FileSys
@@ -15,6 +15,10 @@ namespace FileSys {
 
 VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips);
 
+// Applies an IPS patch to data in place, returns false and leaves the data as it is if the patch
+// is invalid.
+bool ApplyIPS(std::vector<u8>& data, const VirtualFile& ips);
+
 class IPSwitchCompiler {
 public:
     explicit IPSwitchCompiler(VirtualFile patch_text);
@@ -23,6 +27,7 @@ public:
     std::array<u8, 0x20> GetBuildID() const;
     bool IsValid() const;
     VirtualFile Apply(const VirtualFile& in) const;
+    void Apply(std::vector<u8>& data) const;
 
 private:
     struct IPSwitchPatch;
@@ -46,13 +46,17 @@ PartitionFilesystem::PartitionFilesystem(std::shared_ptr<VfsFile> file) {
     std::size_t metadata_size =
         sizeof(Header) + (pfs_header.num_entries * entry_size) + pfs_header.strtab_size;
 
-    // Actually read in now...
-    std::vector<u8> file_data = file->ReadBytes(metadata_size);
-    const std::size_t total_size = file_data.size();
-
-    if (total_size != metadata_size) {
-        status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
-        return;
+    // Actually read in now... The tables of files mapped into memory are parsed in place
+    std::vector<u8> file_data;
+    const u8* metadata = file->GetMappedData();
+    if (metadata == nullptr || file->GetSize() < metadata_size) {
+        file_data = file->ReadBytes(metadata_size);
+        metadata = file_data.data();
+
+        if (file_data.size() != metadata_size) {
+            status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
+            return;
+        }
     }
 
     std::size_t entries_offset = sizeof(Header);
@@ -61,9 +65,9 @@ PartitionFilesystem::PartitionFilesystem(std::shared_ptr<VfsFile> file) {
     for (u16 i = 0; i < pfs_header.num_entries; i++) {
         FSEntry entry;
 
-        memcpy(&entry, &file_data[entries_offset + (i * entry_size)], sizeof(FSEntry));
+        memcpy(&entry, metadata + entries_offset + (i * entry_size), sizeof(FSEntry));
         std::string name(
-            reinterpret_cast<const char*>(&file_data[strtab_offset + entry.strtab_offset]));
+            reinterpret_cast<const char*>(metadata + strtab_offset + entry.strtab_offset));
 
         pfs_files.emplace_back(std::make_shared<OffsetVfsFile>(
             file, entry.size, content_offset + entry.offset, std::move(name)));
@@ -6,6 +6,7 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
+#include <mutex>
 
 #include "common/file_util.h"
 #include "common/hex_util.h"
@@ -47,7 +48,8 @@ std::string FormatTitleVersion(u32 version, TitleVersionFormat format) {
     return fmt::format("v{}.{}.{}", bytes[3], bytes[2], bytes[1]);
 }
 
-PatchManager::PatchManager(u64 title_id) : title_id(title_id) {}
+PatchManager::PatchManager(u64 title_id)
+    : title_id(title_id), nso_patches(std::make_shared<NSOPatchCache>()) {}
 
 PatchManager::~PatchManager() = default;
 
@@ -117,46 +119,68 @@ VirtualDir PatchManager::PatchExeFS(VirtualDir exefs) const {
     return exefs;
 }
 
-std::vector<VirtualFile> PatchManager::CollectPatches(const std::vector<VirtualDir>& patch_dirs,
-                                                      const std::string& build_id) const {
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+struct NSOPatch {
+    VirtualFile file;
+    std::string mod_name;
+    std::string build_id;
+    std::unique_ptr<IPSwitchCompiler> compiler; ///< Only set for IPSwitch patches
+};
 
-    std::vector<VirtualFile> out;
-    out.reserve(patch_dirs.size());
-    for (const auto& subdir : patch_dirs) {
-        if (std::find(disabled.begin(), disabled.end(), subdir->GetName()) != disabled.end())
-            continue;
+struct NSOPatchCache {
+    std::once_flag parsed;
+    std::vector<NSOPatch> patches;
+};
+
+static std::string TrimBuildID(std::string build_id) {
+    build_id.resize(build_id.find_last_not_of('0') + 1);
+    return build_id;
+}
+
+const NSOPatchCache& PatchManager::GetNSOPatches() const {
+    // Every module of a title checks and applies its patches, which parsed all the IPSwitch files
+    // of all the mods each time.
+    std::call_once(nso_patches->parsed, [this] {
+        const auto load_dir = Service::FileSystem::GetModificationLoadRoot(title_id);
+        if (load_dir == nullptr) {
+            return;
+        }
+
+        auto patch_dirs = load_dir->GetSubdirectories();
+        std::sort(
+            patch_dirs.begin(), patch_dirs.end(),
+            [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
+
+        const auto& disabled = Settings::values.disabled_addons[title_id];
+        for (const auto& subdir : patch_dirs) {
+            if (std::find(disabled.begin(), disabled.end(), subdir->GetName()) != disabled.end())
+                continue;
+
+            auto exefs_dir = subdir->GetSubdirectory("exefs");
+            if (exefs_dir == nullptr)
+                continue;
 
-        auto exefs_dir = subdir->GetSubdirectory("exefs");
-        if (exefs_dir != nullptr) {
             for (const auto& file : exefs_dir->GetFiles()) {
                 if (file->GetExtension() == "ips") {
-                    auto name = file->GetName();
-                    const auto p1 = name.substr(0, name.find('.'));
-                    const auto this_build_id = p1.substr(0, p1.find_last_not_of('0') + 1);
-
-                    if (build_id == this_build_id)
-                        out.push_back(file);
+                    const auto name = file->GetName();
+                    nso_patches->patches.push_back(
+                        {file, subdir->GetName(), TrimBuildID(name.substr(0, name.find('.'))),
+                         nullptr});
                 } else if (file->GetExtension() == "pchtxt") {
-                    IPSwitchCompiler compiler{file};
-                    if (!compiler.IsValid())
+                    auto compiler = std::make_unique<IPSwitchCompiler>(file);
+                    if (!compiler->IsValid())
                         continue;
 
-                    auto this_build_id = Common::HexArrayToString(compiler.GetBuildID());
-                    this_build_id =
-                        this_build_id.substr(0, this_build_id.find_last_not_of('0') + 1);
-
-                    if (build_id == this_build_id)
-                        out.push_back(file);
+                    auto build_id = TrimBuildID(Common::HexArrayToString(compiler->GetBuildID()));
+                    nso_patches->patches.push_back(
+                        {file, subdir->GetName(), std::move(build_id), std::move(compiler)});
                 }
             }
         }
-    }
-
-    return out;
+    });
+    return *nso_patches;
 }
 
-std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::string& name) const {
+std::vector<u8> PatchManager::PatchNSO(std::vector<u8> nso, const std::string& name) const {
     if (nso.size() < sizeof(Loader::NSOHeader)) {
         return nso;
     }
@@ -168,8 +192,7 @@ std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::st
         return nso;
     }
 
-    const auto build_id_raw = Common::HexArrayToString(header.build_id);
-    const auto build_id = build_id_raw.substr(0, build_id_raw.find_last_not_of('0') + 1);
+    const auto build_id = TrimBuildID(Common::HexArrayToString(header.build_id));
 
     if (Settings::values.dump_nso) {
         LOG_INFO(Loader, "Dumping NSO for name={}, build_id={}, title_id={:016X}", name, build_id,
@@ -186,50 +209,32 @@ std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::st
 
     LOG_INFO(Loader, "Patching NSO for name={}, build_id={}", name, build_id);
 
-    const auto load_dir = Service::FileSystem::GetModificationLoadRoot(title_id);
-    auto patch_dirs = load_dir->GetSubdirectories();
-    std::sort(patch_dirs.begin(), patch_dirs.end(),
-              [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
-    const auto patches = CollectPatches(patch_dirs, build_id);
-
-    auto out = nso;
-    for (const auto& patch_file : patches) {
-        if (patch_file->GetExtension() == "ips") {
-            LOG_INFO(Loader, "    - Applying IPS patch from mod \"{}\"",
-                     patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
-            const auto patched = PatchIPS(std::make_shared<VectorVfsFile>(out), patch_file);
-            if (patched != nullptr)
-                out = patched->ReadAllBytes();
-        } else if (patch_file->GetExtension() == "pchtxt") {
-            LOG_INFO(Loader, "    - Applying IPSwitch patch from mod \"{}\"",
-                     patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
-            const IPSwitchCompiler compiler{patch_file};
-            const auto patched = compiler.Apply(std::make_shared<VectorVfsFile>(out));
-            if (patched != nullptr)
-                out = patched->ReadAllBytes();
-        }
-    }
+    // The patches are applied in place, the size of the NSO doesn't change
+    for (const auto& patch : GetNSOPatches().patches) {
+        if (patch.build_id != build_id)
+            continue;
 
-    if (out.size() < sizeof(Loader::NSOHeader)) {
-        return nso;
+        if (patch.compiler == nullptr) {
+            LOG_INFO(Loader, "    - Applying IPS patch from mod \"{}\"", patch.mod_name);
+            ApplyIPS(nso, patch.file);
+        } else {
+            LOG_INFO(Loader, "    - Applying IPSwitch patch from mod \"{}\"", patch.mod_name);
+            patch.compiler->Apply(nso);
+        }
     }
 
-    std::memcpy(out.data(), &header, sizeof(header));
-    return out;
+    std::memcpy(nso.data(), &header, sizeof(header));
+    return nso;
 }
 
 bool PatchManager::HasNSOPatch(const std::array<u8, 32>& build_id_) const {
-    const auto build_id_raw = Common::HexArrayToString(build_id_);
-    const auto build_id = build_id_raw.substr(0, build_id_raw.find_last_not_of('0') + 1);
+    const auto build_id = TrimBuildID(Common::HexArrayToString(build_id_));
 
     LOG_INFO(Loader, "Querying NSO patch existence for build_id={}", build_id);
 
-    const auto load_dir = Service::FileSystem::GetModificationLoadRoot(title_id);
-    auto patch_dirs = load_dir->GetSubdirectories();
-    std::sort(patch_dirs.begin(), patch_dirs.end(),
-              [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
-
-    return !CollectPatches(patch_dirs, build_id).empty();
+    const auto& patches = GetNSOPatches().patches;
+    return std::any_of(patches.begin(), patches.end(),
+                       [&build_id](const NSOPatch& patch) { return patch.build_id == build_id; });
 }
 
 static std::optional<CheatList> ReadCheatFileFromFolder(const Core::System& system, u64 title_id,
@@ -512,19 +517,20 @@ std::pair<std::unique_ptr<NACP>, VirtualFile> PatchManager::ParseControlNCA(cons
     if (romfs == nullptr)
         return {};
 
-    const auto extracted = ExtractRomFS(romfs);
-    if (extracted == nullptr)
+    // Only a few files are needed, they are looked up without extracting the whole RomFS
+    const RomFSIndex index{romfs};
+    if (!index.IsValid())
         return {};
 
-    auto nacp_file = extracted->GetFile("control.nacp");
+    auto nacp_file = index.GetFile("control.nacp");
     if (nacp_file == nullptr)
-        nacp_file = extracted->GetFile("Control.nacp");
+        nacp_file = index.GetFile("Control.nacp");
 
     auto nacp = nacp_file == nullptr ? nullptr : std::make_unique<NACP>(nacp_file);
 
     VirtualFile icon_file;
     for (const auto& language : FileSys::LANGUAGE_NAMES) {
-        icon_file = extracted->GetFile("icon_" + std::string(language) + ".dat");
+        icon_file = index.GetFile("icon_" + std::string(language) + ".dat");
         if (icon_file != nullptr)
             break;
     }
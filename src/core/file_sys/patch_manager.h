@@ -20,6 +20,7 @@ namespace FileSys {
 
 class NCA;
 class NACP;
+struct NSOPatchCache;
 
 enum class TitleVersionFormat : u8 {
     ThreeElements, ///< vX.Y.Z
@@ -44,7 +45,7 @@ public:
     // Currently tracked NSO patches:
     // - IPS
     // - IPSwitch
-    std::vector<u8> PatchNSO(const std::vector<u8>& nso, const std::string& name) const;
+    std::vector<u8> PatchNSO(std::vector<u8> nso, const std::string& name) const;
 
     // Checks to see if PatchNSO() will have any effect given the NSO's build ID.
     // Used to prevent expensive copies in NSO loader.
@@ -74,10 +75,13 @@ public:
     std::pair<std::unique_ptr<NACP>, VirtualFile> ParseControlNCA(const NCA& nca) const;
 
 private:
-    std::vector<VirtualFile> CollectPatches(const std::vector<VirtualDir>& patch_dirs,
-                                            const std::string& build_id) const;
+    // Returns the patches of all the NSOs, which are only parsed the first time this is called
+    const NSOPatchCache& GetNSOPatches() const;
 
     u64 title_id;
+
+    // Shared by the copies of the manager, the NSO loader gets one for each module
+    std::shared_ptr<NSOPatchCache> nso_patches;
 };
 
 } // namespace FileSys
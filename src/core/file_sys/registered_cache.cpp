@@ -3,12 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <regex>
 #include <mbedtls/sha256.h>
 #include "common/assert.h"
+#include "common/common_funcs.h"
 #include "common/file_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
@@ -16,6 +19,7 @@
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -23,6 +27,29 @@ namespace FileSys {
 // The size of blocks to use when vfs raw copying into nand.
 constexpr size_t VFS_RC_LARGE_COPY_BLOCK = 0x400000;
 
+// Index of the parsed NCAs, stored in the registered directory. NCA IDs are hashes of the NCA, so
+// an ID with the same file size is the same NCA.
+constexpr char CONTENT_INDEX_FILE_NAME[] = "yuzu_content_index.bin";
+constexpr u32 CONTENT_INDEX_MAGIC = Common::MakeMagic('Y', 'C', 'I', 'X');
+constexpr u32 CONTENT_INDEX_VERSION = 1;
+
+struct ContentIndexHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le num_entries;
+};
+static_assert(sizeof(ContentIndexHeader) == 0x10, "ContentIndexHeader has incorrect size.");
+
+// Followed by the serialized CNMT of meta NCAs
+struct ContentIndexEntry {
+    NcaID nca_id;
+    u64_le file_size;
+    u64_le title_id;
+    u32_le is_meta;
+    u32_le cnmt_size;
+};
+static_assert(sizeof(ContentIndexEntry) == 0x28, "ContentIndexEntry has incorrect size.");
+
 std::string ContentProviderEntry::DebugInfo() const {
     return fmt::format("title_id={:016X}, content_type={:02X}", title_id, static_cast<u8>(type));
 }
@@ -243,28 +270,148 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
     return ids;
 }
 
+std::optional<RegisteredCache::IndexEntry> RegisteredCache::ParseIndexEntry(
+    const VirtualFile& file, const Core::Crypto::KeyManager& keys) {
+    // Only the CNMT of meta NCAs is read, the other NCAs are identified by their header
+    const NCAHeaderView header{file, keys};
+    if (header.GetStatus() != Loader::ResultStatus::Success) {
+        // Not indexed, it is parsed again once the keys might have changed
+        return std::nullopt;
+    }
+
+    IndexEntry entry{0, false, header.GetTitleId(), {}};
+    if (header.GetType() != NCAContentType::Meta) {
+        return entry;
+    }
+
+    const NCA nca{file, nullptr, 0, keys};
+    if (nca.GetStatus() != Loader::ResultStatus::Success) {
+        return std::nullopt;
+    }
+
+    const auto section0 = nca.GetSubdirectories()[0];
+    for (const auto& section0_file : section0->GetFiles()) {
+        if (section0_file->GetExtension() != "cnmt")
+            continue;
+
+        entry.is_meta = true;
+        entry.cnmt = CNMT(section0_file).Serialize();
+        break;
+    }
+    return entry;
+}
+
 void RegisteredCache::ProcessFiles(const std::vector<NcaID>& ids) {
+    // Opening the files goes through the VFS, which is not thread-safe. Only the NCAs missing from
+    // the index are parsed afterwards in parallel, each of them decrypts its own header.
+    std::map<NcaID, IndexEntry> new_index;
+    std::vector<std::pair<NcaID, u64>> misses;
+    std::vector<VirtualFile> miss_files;
     for (const auto& id : ids) {
         const auto file = GetFileAtID(id);
-
         if (file == nullptr)
             continue;
-        const auto nca = std::make_shared<NCA>(parser(file, id), nullptr, 0, keys);
-        if (nca->GetStatus() != Loader::ResultStatus::Success ||
-            nca->GetType() != NCAContentType::Meta) {
+
+        const u64 file_size = file->GetSize();
+        const auto itr = index.find(id);
+        if (itr != index.end() && itr->second.file_size == file_size) {
+            new_index.insert(*itr);
             continue;
         }
+        misses.emplace_back(id, file_size);
+        miss_files.push_back(parser(file, id));
+    }
+    // Entries of removed or changed files were left out
+    bool index_changed = new_index.size() != index.size();
+
+    std::vector<std::optional<IndexEntry>> parsed(misses.size());
+    Common::ThreadPool::GetInstance().ParallelFor(
+        misses.size(), 1,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (miss_files[i] != nullptr) {
+                    parsed[i] = ParseIndexEntry(miss_files[i], keys);
+                }
+            }
+        },
+        Common::TaskPriority::Normal);
 
-        const auto section0 = nca->GetSubdirectories()[0];
+    for (std::size_t i = 0; i < misses.size(); ++i) {
+        if (!parsed[i])
+            continue;
 
-        for (const auto& section0_file : section0->GetFiles()) {
-            if (section0_file->GetExtension() != "cnmt")
-                continue;
+        // The index is checked against the size of the raw file, not of the parsed one
+        parsed[i]->file_size = misses[i].second;
+        new_index.insert_or_assign(misses[i].first, std::move(*parsed[i]));
+        index_changed = true;
+    }
+    index = std::move(new_index);
 
-            meta.insert_or_assign(nca->GetTitleId(), CNMT(section0_file));
-            meta_id.insert_or_assign(nca->GetTitleId(), id);
+    for (const auto& id : ids) {
+        const auto itr = index.find(id);
+        if (itr == index.end() || !itr->second.is_meta)
+            continue;
+
+        const u64 title_id = itr->second.title_id;
+        meta.insert_or_assign(title_id, CNMT(std::make_shared<VectorVfsFile>(itr->second.cnmt)));
+        meta_id.insert_or_assign(title_id, id);
+    }
+
+    if (index_changed) {
+        WriteIndex();
+    }
+}
+
+void RegisteredCache::ReadIndex() {
+    const auto file = dir->GetFile(CONTENT_INDEX_FILE_NAME);
+    if (file == nullptr)
+        return;
+
+    ContentIndexHeader header{};
+    if (file->ReadObject(&header) != sizeof(header) || header.magic != CONTENT_INDEX_MAGIC ||
+        header.version != CONTENT_INDEX_VERSION) {
+        return;
+    }
+
+    std::size_t offset = sizeof(header);
+    for (u64 i = 0; i < header.num_entries; ++i) {
+        ContentIndexEntry raw_entry{};
+        if (file->ReadObject(&raw_entry, offset) != sizeof(raw_entry))
             break;
-        }
+        offset += sizeof(raw_entry);
+
+        IndexEntry entry{raw_entry.file_size, raw_entry.is_meta != 0, raw_entry.title_id, {}};
+        entry.cnmt = file->ReadBytes(raw_entry.cnmt_size, offset);
+        if (entry.cnmt.size() != raw_entry.cnmt_size)
+            break;
+        offset += raw_entry.cnmt_size;
+
+        index.insert_or_assign(raw_entry.nca_id, std::move(entry));
+    }
+}
+
+void RegisteredCache::WriteIndex() const {
+    std::vector<u8> data(sizeof(ContentIndexHeader));
+    const ContentIndexHeader header{CONTENT_INDEX_MAGIC, CONTENT_INDEX_VERSION, index.size()};
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    for (const auto& [nca_id, entry] : index) {
+        const ContentIndexEntry raw_entry{nca_id, entry.file_size, entry.title_id,
+                                          entry.is_meta ? 1U : 0U,
+                                          static_cast<u32>(entry.cnmt.size())};
+        const std::size_t offset = data.size();
+        data.resize(offset + sizeof(raw_entry) + entry.cnmt.size());
+        std::memcpy(data.data() + offset, &raw_entry, sizeof(raw_entry));
+        std::memcpy(data.data() + offset + sizeof(raw_entry), entry.cnmt.data(),
+                    entry.cnmt.size());
+    }
+
+    // Read-only directories are simply scanned again next time
+    auto file = dir->GetFile(CONTENT_INDEX_FILE_NAME);
+    if (file == nullptr)
+        file = dir->CreateFile(CONTENT_INDEX_FILE_NAME);
+    if (file == nullptr || !file->Resize(data.size()) || file->WriteBytes(data) != data.size()) {
+        LOG_WARNING(Loader, "Could not write the content index of {}", dir->GetFullPath());
     }
 }
 
@@ -285,6 +432,8 @@ void RegisteredCache::AccumulateYuzuMeta() {
 void RegisteredCache::Refresh() {
     if (dir == nullptr)
         return;
+    if (index.empty())
+        ReadIndex();
     const auto ids = AccumulateFiles();
     ProcessFiles(ids);
     AccumulateYuzuMeta();
@@ -383,12 +532,12 @@ static std::shared_ptr<NCA> GetNCAFromNSPForID(const NSP& nsp, const NcaID& id)
 }
 
 InstallResult RegisteredCache::InstallEntry(const XCI& xci, bool overwrite_if_exists,
-                                            const VfsCopyFunction& copy) {
-    return InstallEntry(*xci.GetSecurePartitionNSP(), overwrite_if_exists, copy);
+                                            const InstallProgressCallback& progress) {
+    return InstallEntry(*xci.GetSecurePartitionNSP(), overwrite_if_exists, progress);
 }
 
 InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_exists,
-                                            const VfsCopyFunction& copy) {
+                                            const InstallProgressCallback& progress) {
     const auto ncas = nsp.GetNCAsCollapsed();
     const auto meta_iter = std::find_if(ncas.begin(), ncas.end(), [](const auto& nca) {
         return nca->GetType() == NCAContentType::Meta;
@@ -404,7 +553,7 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
     const auto meta_id_raw = (*meta_iter)->GetName().substr(0, 32);
     const auto meta_id = Common::HexStringToArray<16>(meta_id_raw);
 
-    const auto res = RawInstallNCA(**meta_iter, copy, overwrite_if_exists, meta_id);
+    const auto res = RawInstallNCA(**meta_iter, progress, overwrite_if_exists, meta_id);
     if (res != InstallResult::Success)
         return res;
 
@@ -416,7 +565,8 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
         const auto nca = GetNCAFromNSPForID(nsp, record.nca_id);
         if (nca == nullptr)
             return InstallResult::ErrorCopyFailed;
-        const auto res2 = RawInstallNCA(*nca, copy, overwrite_if_exists, record.nca_id);
+        const auto res2 =
+            RawInstallNCA(*nca, progress, overwrite_if_exists, record.nca_id, record.hash);
         if (res2 != InstallResult::Success)
             return res2;
     }
@@ -426,7 +576,8 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
 }
 
 InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
-                                            bool overwrite_if_exists, const VfsCopyFunction& copy) {
+                                            bool overwrite_if_exists,
+                                            const InstallProgressCallback& progress) {
     CNMTHeader header{
         nca.GetTitleId(), ///< Title ID
         0,                ///< Ignore/Default title version
@@ -445,12 +596,12 @@ InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
     const CNMT new_cnmt(header, opt_header, {c_rec}, {});
     if (!RawInstallYuzuMeta(new_cnmt))
         return InstallResult::ErrorMetaFailed;
-    return RawInstallNCA(nca, copy, overwrite_if_exists, c_rec.nca_id);
+    return RawInstallNCA(nca, progress, overwrite_if_exists, c_rec.nca_id);
 }
 
-InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
-                                             bool overwrite_if_exists,
-                                             std::optional<NcaID> override_id) {
+InstallResult RegisteredCache::RawInstallNCA(
+    const NCA& nca, const InstallProgressCallback& progress, bool overwrite_if_exists,
+    std::optional<NcaID> override_id, std::optional<Core::Crypto::SHA256Hash> expected_hash) {
     const auto in = nca.GetBaseFile();
     Core::Crypto::SHA256Hash hash{};
 
@@ -479,13 +630,50 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
         VirtualDir c_dir;
         { c_dir = dir->GetFileRelative(path)->GetContainingDirectory(); }
         c_dir->DeleteFile(FileUtil::GetFilename(path));
+        // The new NCA can have the same size, the ID of installed NCAs only hashes its first MB
+        index.erase(id);
     }
 
     auto out = dir->CreateFileRelative(path);
     if (out == nullptr)
         return InstallResult::ErrorCopyFailed;
-    return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
-                                                  : InstallResult::ErrorCopyFailed;
+
+    // The NCA is hashed on the reading thread of the copy, which saves a second pass over it
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts_ret(&context, 0);
+    const auto on_read = [&context](const u8* data, std::size_t size) {
+        mbedtls_sha256_update_ret(&context, data, size);
+    };
+    const auto on_written = [&progress, &in](std::size_t copied) {
+        return !progress || progress(in, copied);
+    };
+
+    const bool copied =
+        VfsPipelinedCopy(in, out, VFS_RC_LARGE_COPY_BLOCK,
+                         expected_hash ? std::function<void(const u8*, std::size_t)>{on_read}
+                                       : nullptr,
+                         on_written);
+    mbedtls_sha256_finish_ret(&context, hash.data());
+    mbedtls_sha256_free(&context);
+
+    auto result = InstallResult::Success;
+    if (!copied) {
+        result = InstallResult::ErrorCopyFailed;
+    } else if (expected_hash && hash != *expected_hash) {
+        LOG_ERROR(Loader, "The hash of NCA {} doesn't match its metadata, the file is corrupted.",
+                  Common::HexArrayToString(id, false));
+        result = InstallResult::ErrorHashMismatch;
+    }
+
+    // Don't leave a partial NCA behind, it would be picked up by the next refresh
+    if (result != InstallResult::Success) {
+        const auto c_dir = out->GetContainingDirectory();
+        out = nullptr;
+        if (c_dir != nullptr)
+            c_dir->DeleteFile(FileUtil::GetFilename(path));
+    }
+    return result;
 }
 
 bool RegisteredCache::RawInstallYuzuMeta(const CNMT& cnmt) {
@@ -28,13 +28,17 @@ struct ContentRecord;
 
 using NcaID = std::array<u8, 0x10>;
 using ContentProviderParsingFunction = std::function<VirtualFile(const VirtualFile&, const NcaID&)>;
-using VfsCopyFunction = std::function<bool(const VirtualFile&, const VirtualFile&, size_t)>;
+
+/// Called while an NCA is being installed with the number of bytes copied so far, the install is
+/// cancelled when it returns false
+using InstallProgressCallback = std::function<bool(const VirtualFile& nca, std::size_t copied)>;
 
 enum class InstallResult {
     Success,
     ErrorAlreadyExists,
     ErrorCopyFailed,
     ErrorMetaFailed,
+    ErrorHashMismatch,
 };
 
 struct ContentProviderEntry {
@@ -130,20 +134,29 @@ public:
         std::optional<u64> title_id = {}) const override;
 
     // Raw copies all the ncas from the xci/nsp to the csache. Does some quick checks to make sure
-    // there is a meta NCA and all of them are accessible.
+    // there is a meta NCA and all of them are accessible. The NCAs are checked against the hashes
+    // of the metadata while they are copied.
     InstallResult InstallEntry(const XCI& xci, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
     InstallResult InstallEntry(const NSP& nsp, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
 
     // Due to the fact that we must use Meta-type NCAs to determine the existance of files, this
     // poses quite a challenge. Instead of creating a new meta NCA for this file, yuzu will create a
     // dir inside the NAND called 'yuzu_meta' and store the raw CNMT there.
     // TODO(DarkLordZach): Author real meta-type NCAs and install those.
     InstallResult InstallEntry(const NCA& nca, TitleType type, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const InstallProgressCallback& progress = {});
 
 private:
+    /// What parsing an NCA of the directory found, kept in the index file between sessions
+    struct IndexEntry {
+        u64 file_size;
+        bool is_meta;
+        u64 title_id;
+        std::vector<u8> cnmt; ///< Serialized CNMT of a meta NCA
+    };
+
     template <typename T>
     void IterateAllMetadata(std::vector<T>& out,
                             std::function<T(const CNMT&, const ContentRecord&)> proc,
@@ -151,11 +164,16 @@ private:
     std::vector<NcaID> AccumulateFiles() const;
     void ProcessFiles(const std::vector<NcaID>& ids);
     void AccumulateYuzuMeta();
+    void ReadIndex();
+    void WriteIndex() const;
+    static std::optional<IndexEntry> ParseIndexEntry(const VirtualFile& file,
+                                                     const Core::Crypto::KeyManager& keys);
     std::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
     VirtualFile GetFileAtID(NcaID id) const;
     VirtualFile OpenFileOrDirectoryConcat(const VirtualDir& dir, std::string_view path) const;
-    InstallResult RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
-                                bool overwrite_if_exists, std::optional<NcaID> override_id = {});
+    InstallResult RawInstallNCA(const NCA& nca, const InstallProgressCallback& progress,
+                                bool overwrite_if_exists, std::optional<NcaID> override_id = {},
+                                std::optional<Core::Crypto::SHA256Hash> expected_hash = {});
     bool RawInstallYuzuMeta(const CNMT& cnmt);
 
     VirtualDir dir;
@@ -167,6 +185,8 @@ private:
     std::map<u64, CNMT> meta;
     // maps tid -> meta for CNMT in yuzu_meta
     std::map<u64, CNMT> yuzu_meta;
+    // maps NcaID -> parsed NCA, only successfully parsed NCAs are indexed
+    std::map<NcaID, IndexEntry> index;
 };
 
 enum class ContentProviderUnionSlot {
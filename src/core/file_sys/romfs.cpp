@@ -132,6 +132,144 @@ VirtualDir ExtractRomFS(VirtualFile file, RomFSExtractionType type) {
     return out;
 }
 
+namespace {
+
+/// Hash of an entry name in the hash tables, the same as the one used to build RomFS images
+u32 CalculatePathHash(u32 parent, std::string_view name) {
+    u32 hash = parent ^ 123456789;
+    for (const char c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= c;
+    }
+    return hash;
+}
+
+template <typename T>
+bool ReadTable(const VirtualFile& file, const TableLocation& location, std::vector<T>& table) {
+    table.resize(location.size / sizeof(T));
+    return file->ReadBytes(table.data(), table.size() * sizeof(T), location.offset) ==
+           table.size() * sizeof(T);
+}
+
+/// Returns the entry at the offset in a table if it and its name fit in the table
+template <typename Entry>
+const Entry* GetTableEntry(const std::vector<u8>& table, u32 offset, std::string_view& name) {
+    if (offset > table.size() || table.size() - offset < sizeof(Entry)) {
+        return nullptr;
+    }
+    const auto* const entry = reinterpret_cast<const Entry*>(table.data() + offset);
+    if (table.size() - offset - sizeof(Entry) < entry->name_length) {
+        return nullptr;
+    }
+    name = {reinterpret_cast<const char*>(entry + 1), entry->name_length};
+    return entry;
+}
+
+/// Directory entry including the parent field that ExtractRomFS skips
+struct IndexedDirectoryEntry {
+    u32_le parent;
+    u32_le sibling;
+    u32_le child_dir;
+    u32_le child_file;
+    u32_le hash;
+    u32_le name_length;
+};
+static_assert(sizeof(IndexedDirectoryEntry) == 0x18, "IndexedDirectoryEntry has incorrect size.");
+
+} // Anonymous namespace
+
+RomFSIndex::RomFSIndex(VirtualFile file_) : file(std::move(file_)) {
+    RomFSHeader header{};
+    if (file->ReadObject(&header) != sizeof(RomFSHeader) ||
+        header.header_size != sizeof(RomFSHeader)) {
+        return;
+    }
+
+    if (!ReadTable(file, header.directory_hash, directory_hash_table) ||
+        !ReadTable(file, header.directory_meta, directory_table) ||
+        !ReadTable(file, header.file_hash, file_hash_table) ||
+        !ReadTable(file, header.file_meta, file_table) || directory_hash_table.empty() ||
+        file_hash_table.empty()) {
+        directory_hash_table.clear();
+        return;
+    }
+    data_offset = header.data_offset;
+}
+
+RomFSIndex::~RomFSIndex() = default;
+
+bool RomFSIndex::IsValid() const {
+    return !directory_hash_table.empty();
+}
+
+VirtualFile RomFSIndex::GetFile(std::string_view path) const {
+    if (!IsValid()) {
+        return nullptr;
+    }
+
+    // The root directory is the first entry of the directory table
+    u32 directory = 0;
+    while (true) {
+        const std::size_t separator = path.find_first_of("/\\");
+        const std::string_view component = path.substr(0, separator);
+        if (separator == std::string_view::npos) {
+            const auto file_offset = FindFile(directory, component);
+            if (!file_offset) {
+                return nullptr;
+            }
+            std::string_view name;
+            const auto* const entry = GetTableEntry<FileEntry>(file_table, *file_offset, name);
+            return std::make_shared<OffsetVfsFile>(file, entry->size, entry->offset + data_offset,
+                                                   std::string(name));
+        }
+
+        path.remove_prefix(separator + 1);
+        if (component.empty()) {
+            continue;
+        }
+        const auto directory_offset = FindDirectory(directory, component);
+        if (!directory_offset) {
+            return nullptr;
+        }
+        directory = *directory_offset;
+    }
+}
+
+std::optional<u32> RomFSIndex::FindDirectory(u32 parent, std::string_view name) const {
+    u32 offset =
+        directory_hash_table[CalculatePathHash(parent, name) % directory_hash_table.size()];
+    while (offset != ROMFS_ENTRY_EMPTY) {
+        std::string_view entry_name;
+        const auto* const entry =
+            GetTableEntry<IndexedDirectoryEntry>(directory_table, offset, entry_name);
+        if (entry == nullptr) {
+            return std::nullopt;
+        }
+        if (entry->parent == parent && entry_name == name) {
+            return offset;
+        }
+        // The hash field links the entries of a bucket
+        offset = entry->hash;
+    }
+    return std::nullopt;
+}
+
+std::optional<u32> RomFSIndex::FindFile(u32 parent, std::string_view name) const {
+    u32 offset = file_hash_table[CalculatePathHash(parent, name) % file_hash_table.size()];
+    while (offset != ROMFS_ENTRY_EMPTY) {
+        std::string_view entry_name;
+        const auto* const entry = GetTableEntry<FileEntry>(file_table, offset, entry_name);
+        if (entry == nullptr) {
+            return std::nullopt;
+        }
+        if (entry->parent == parent && entry_name == name) {
+            return offset;
+        }
+        offset = entry->hash;
+    }
+    return std::nullopt;
+}
+
 VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext) {
     if (dir == nullptr)
         return nullptr;
@@ -6,6 +6,9 @@
 
 #include <array>
 #include <map>
+#include <optional>
+#include <string_view>
+#include <vector>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
@@ -43,6 +46,32 @@ enum class RomFSExtractionType {
 VirtualDir ExtractRomFS(VirtualFile file,
                         RomFSExtractionType type = RomFSExtractionType::Truncated);
 
+// Looks up the files of a RomFS through the hash tables stored in it, without extracting its
+// directory tree. The tables are read once, lookups compare the names in place and read nothing
+// from the RomFS.
+class RomFSIndex {
+public:
+    explicit RomFSIndex(VirtualFile file);
+    ~RomFSIndex();
+
+    /// Returns false when the file is not a RomFS or its tables could not be read
+    bool IsValid() const;
+
+    /// Returns the file at the path relative to the root of the RomFS, nullptr if there is none
+    VirtualFile GetFile(std::string_view path) const;
+
+private:
+    std::optional<u32> FindDirectory(u32 parent, std::string_view name) const;
+    std::optional<u32> FindFile(u32 parent, std::string_view name) const;
+
+    VirtualFile file;
+    u64 data_offset = 0;
+    std::vector<u32_le> directory_hash_table;
+    std::vector<u8> directory_table;
+    std::vector<u32_le> file_hash_table;
+    std::vector<u8> file_table;
+};
+
 // Converts a VFS filesystem into a RomFS binary
 // Returns nullptr on failure
 VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext = nullptr);
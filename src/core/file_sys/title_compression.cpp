@@ -0,0 +1,105 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "common/logging/log.h"
+#include "core/file_sys/card_image.h"
+#include "core/file_sys/content_archive.h"
+#include "core/file_sys/nca_metadata.h"
+#include "core/file_sys/submission_package.h"
+#include "core/file_sys/title_compression.h"
+#include "core/file_sys/vfs_compressed.h"
+#include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_offset.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+namespace {
+
+/// Returns the offset of a slice of the title file, the NCAs of containers are nested slices
+std::optional<u64> GetOffsetInFile(VirtualFile slice, const VirtualFile& file) {
+    u64 offset = 0;
+    while (slice != file) {
+        const auto offset_file = std::dynamic_pointer_cast<OffsetVfsFile>(slice);
+        if (offset_file == nullptr) {
+            return std::nullopt;
+        }
+        offset += offset_file->GetOffset();
+        slice = offset_file->GetBaseFile();
+    }
+    return offset;
+}
+
+std::vector<std::shared_ptr<NCA>> GetTitleNCAs(const VirtualFile& file) {
+    const auto type = Loader::IdentifyFile(file);
+    if (type == Loader::FileType::XCI) {
+        const XCI xci{file};
+        if (xci.GetStatus() == Loader::ResultStatus::Success) {
+            return xci.GetNCAs();
+        }
+    } else if (type == Loader::FileType::NSP) {
+        const NSP nsp{file};
+        if (nsp.GetStatus() == Loader::ResultStatus::Success && !nsp.IsExtractedType()) {
+            return nsp.GetNCAsCollapsed();
+        }
+    }
+    return {};
+}
+
+} // Anonymous namespace
+
+VirtualFile MakeDecryptedTitle(const VirtualFile& file) {
+    const auto ncas = GetTitleNCAs(file);
+    if (ncas.empty()) {
+        return nullptr;
+    }
+
+    std::map<u64, VirtualFile> decrypted_ncas;
+    for (const auto& nca : ncas) {
+        const auto offset = GetOffsetInFile(nca->GetBaseFile(), file);
+        auto decrypted = nca->GetDecryptedFile();
+        if (!offset || decrypted == nullptr) {
+            LOG_WARNING(Loader, "Keeping {} encrypted", nca->GetName());
+            continue;
+        }
+        decrypted_ncas.emplace(*offset, std::move(decrypted));
+    }
+
+    // The rest of the title is stored as it is
+    std::map<u64, VirtualFile> pieces;
+    u64 end_offset = 0;
+    for (auto& [offset, nca] : decrypted_ncas) {
+        if (offset < end_offset) {
+            LOG_ERROR(Loader, "NCAs of {} overlap", file->GetName());
+            return nullptr;
+        }
+        if (offset > end_offset) {
+            pieces.emplace(end_offset,
+                           std::make_shared<OffsetVfsFile>(file, offset - end_offset, end_offset));
+        }
+        end_offset = offset + nca->GetSize();
+        pieces.emplace(offset, std::move(nca));
+    }
+    if (file->GetSize() > end_offset) {
+        pieces.emplace(end_offset, std::make_shared<OffsetVfsFile>(
+                                       file, file->GetSize() - end_offset, end_offset));
+    }
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(pieces), file->GetName());
+}
+
+bool CompressTitle(const VirtualFile& src, const VirtualFile& dest,
+                   const std::function<bool(std::size_t)>& progress) {
+    const auto decrypted = MakeDecryptedTitle(src);
+    if (decrypted == nullptr) {
+        LOG_ERROR(Loader, "{} is not an XCI or NSP", src->GetName());
+        return false;
+    }
+    return CompressVfsFile(decrypted, dest, COMPRESSED_FILE_BLOCK_SIZE, progress);
+}
+
+} // namespace FileSys
@@ -0,0 +1,28 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include "core/file_sys/vfs_types.h"
+
+namespace FileSys {
+
+/**
+ * Returns a view of an XCI or NSP whose NCAs are decrypted, with the same layout as the original.
+ * Encrypted data doesn't compress, this is what is stored in compressed titles. NCAs that can't
+ * be decrypted, like updates, are kept as they are. Returns nullptr if the file is neither.
+ */
+VirtualFile MakeDecryptedTitle(const VirtualFile& file);
+
+/**
+ * Stores an XCI or NSP as a block-compressed file (see CompressedVfsFile) with its NCAs decrypted.
+ * @param progress Called with the number of bytes that were compressed so far, stops the
+ *                 conversion when it returns false
+ */
+bool CompressTitle(const VirtualFile& src, const VirtualFile& dest,
+                   const std::function<bool(std::size_t)>& progress = {});
+
+} // namespace FileSys
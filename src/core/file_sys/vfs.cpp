@@ -3,11 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <numeric>
 #include <string>
+#include <thread>
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/backend.h"
+#include "common/thread_pool.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs.h"
 
@@ -167,6 +173,17 @@ std::string VfsFile::GetExtension() const {
 
 VfsDirectory::~VfsDirectory() = default;
 
+bool VfsFile::Sync() {
+    return true;
+}
+
+const u8* VfsFile::GetMappedData() const {
+    return nullptr;
+}
+
+void VfsFile::AdviseAccess(VfsAccessPattern pattern, std::size_t offset,
+                           std::size_t length) const {}
+
 std::optional<u8> VfsFile::ReadByte(std::size_t offset) const {
     u8 out{};
     std::size_t size = Read(&out, 1, offset);
@@ -406,6 +423,17 @@ bool VfsDirectory::CleanSubdirectoryRecursive(std::string_view name) {
     return success;
 }
 
+bool VfsDirectory::ReplaceFile(std::string_view src, std::string_view dest) {
+    const auto file = GetFile(src);
+    if (file == nullptr) {
+        return false;
+    }
+    if (GetFile(dest) != nullptr && !DeleteFile(dest)) {
+        return false;
+    }
+    return file->Rename(dest);
+}
+
 bool VfsDirectory::Copy(std::string_view src, std::string_view dest) {
     const auto f1 = GetFile(src);
     auto f2 = CreateFile(dest);
@@ -531,6 +559,115 @@ bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t blo
     return true;
 }
 
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size,
+                      const std::function<void(const u8*, std::size_t)>& on_read,
+                      const std::function<bool(std::size_t)>& on_written) {
+    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
+        return false;
+
+    const auto size = src->GetSize();
+    if (!dest->Resize(size))
+        return false;
+    if (size == 0)
+        return true;
+
+    // Number of blocks that are in flight between the reading and the writing side
+    constexpr std::size_t NUM_BUFFERS = 4;
+    block_size = std::min(block_size, size);
+    const std::size_t num_blocks = (size + block_size - 1) / block_size;
+    // Blocks of a file mapped into memory are passed on without copying them into a buffer
+    const u8* const mapped_data = src->GetMappedData();
+    std::array<std::vector<u8>, NUM_BUFFERS> buffers;
+    std::array<const u8*, NUM_BUFFERS> blocks{};
+    if (mapped_data == nullptr) {
+        for (auto& buffer : buffers) {
+            buffer.resize(block_size);
+        }
+    }
+    src->AdviseAccess(VfsAccessPattern::Sequential, 0, size);
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::size_t num_read = 0;
+    std::size_t num_written = 0;
+    bool read_failed = false;
+    bool aborted = false;
+
+    std::thread reader([&] {
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            {
+                std::unique_lock lock{mutex};
+                condition.wait(lock, [&] { return aborted || i - num_written < NUM_BUFFERS; });
+                if (aborted) {
+                    return;
+                }
+            }
+
+            auto& buffer = buffers[i % NUM_BUFFERS];
+            auto& block = blocks[i % NUM_BUFFERS];
+            const std::size_t offset = i * block_size;
+            const std::size_t length = std::min(block_size, size - offset);
+            bool success = true;
+            if (mapped_data != nullptr) {
+                block = mapped_data + offset;
+            } else {
+                block = buffer.data();
+                success = src->Read(buffer.data(), length, offset) == length;
+            }
+            if (success && on_read) {
+                on_read(block, length);
+            }
+
+            {
+                std::scoped_lock lock{mutex};
+                if (success) {
+                    ++num_read;
+                } else {
+                    read_failed = true;
+                }
+            }
+            condition.notify_all();
+            if (!success) {
+                return;
+            }
+        }
+    });
+
+    bool success = true;
+    for (std::size_t i = 0; i < num_blocks && success; ++i) {
+        {
+            std::unique_lock lock{mutex};
+            condition.wait(lock, [&] { return read_failed || num_read > i; });
+            if (num_read <= i) {
+                success = false;
+                break;
+            }
+        }
+
+        const std::size_t offset = i * block_size;
+        const std::size_t length = std::min(block_size, size - offset);
+        success = dest->Write(blocks[i % NUM_BUFFERS], length, offset) == length &&
+                  (!on_written || on_written(offset + length));
+
+        {
+            std::scoped_lock lock{mutex};
+            ++num_written;
+        }
+        condition.notify_all();
+    }
+
+    if (!success) {
+        {
+            std::scoped_lock lock{mutex};
+            aborted = true;
+        }
+        condition.notify_all();
+    }
+    reader.join();
+    src->AdviseAccess(VfsAccessPattern::Normal, 0, size);
+    return success;
+}
+
 bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size) {
     if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
         return false;
@@ -550,6 +687,107 @@ bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t bloc
     return true;
 }
 
+namespace {
+
+/// File of a parallel copy and the directory it's copied into
+struct ParallelCopyFile {
+    VirtualFile src;
+    VirtualDir dest;
+};
+
+/// Creates the directories of src in dest and gathers the files to copy into them
+bool CreateCopyTree(const VirtualDir& src, const VirtualDir& dest,
+                    std::vector<ParallelCopyFile>& files) {
+    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
+        return false;
+
+    for (const auto& file : src->GetFiles()) {
+        files.push_back({file, dest});
+    }
+
+    for (const auto& dir : src->GetSubdirectories()) {
+        if (!CreateCopyTree(dir, dest->CreateSubdirectory(dir->GetName()), files))
+            return false;
+    }
+
+    return true;
+}
+
+} // Anonymous namespace
+
+bool VfsParallelCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size,
+                      const std::function<bool(std::size_t, std::size_t)>& on_copied) {
+    std::vector<ParallelCopyFile> files;
+    if (!CreateCopyTree(src, dest, files))
+        return false;
+
+    // Large files are taken first, a thread left alone with a large file would hold the copy back
+    std::stable_sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.src->GetSize() > rhs.src->GetSize();
+    });
+    const std::size_t total_size = std::accumulate(
+        files.begin(), files.end(), std::size_t{0},
+        [](std::size_t sum, const auto& file) { return sum + file.src->GetSize(); });
+
+    // Creating files touches state of the filesystem shared by every file, unlike writing them
+    std::mutex create_mutex;
+    std::mutex progress_mutex;
+    std::size_t copied_size = 0;
+    std::atomic_size_t next_file{0};
+    std::atomic_bool failed{false};
+
+    const auto copy_file = [&](const ParallelCopyFile& file, std::vector<u8>& buffer) {
+        VirtualFile out;
+        {
+            std::scoped_lock lock{create_mutex};
+            out = file.dest->CreateFile(file.src->GetName());
+        }
+        if (out == nullptr || !file.src->IsReadable() || !out->IsWritable())
+            return false;
+
+        const std::size_t size = file.src->GetSize();
+        if (!out->Resize(size))
+            return false;
+
+        const u8* const mapped_data = file.src->GetMappedData();
+        if (mapped_data == nullptr && buffer.size() < std::min(block_size, size)) {
+            buffer.resize(std::min(block_size, size));
+        }
+        for (std::size_t offset = 0; offset < size; offset += block_size) {
+            const std::size_t length = std::min(block_size, size - offset);
+            const u8* block = mapped_data != nullptr ? mapped_data + offset : buffer.data();
+            if (mapped_data == nullptr && file.src->Read(buffer.data(), length, offset) != length)
+                return false;
+            if (out->Write(block, length, offset) != length)
+                return false;
+
+            std::scoped_lock lock{progress_mutex};
+            copied_size += length;
+            if (on_copied && !on_copied(copied_size, total_size))
+                return false;
+        }
+        return true;
+    };
+
+    // Every thread takes the next file as soon as it's done with one
+    auto& thread_pool = Common::ThreadPool::GetInstance();
+    thread_pool.ParallelFor(
+        thread_pool.GetNumThreads() + 1, 1,
+        [&](std::size_t, std::size_t) {
+            std::vector<u8> buffer;
+            while (!failed) {
+                const std::size_t index = next_file++;
+                if (index >= files.size())
+                    break;
+                if (!copy_file(files[index], buffer))
+                    failed = true;
+            }
+        },
+        Common::TaskPriority::Normal);
+
+    return !failed;
+}
+
 VirtualDir GetOrCreateDirectoryRelative(const VirtualDir& rel, std::string_view path) {
     const auto res = rel->GetDirectoryRelative(path);
     if (res == nullptr)
@@ -27,6 +27,13 @@ enum class VfsEntryType {
     Directory,
 };
 
+// How a range of a file is going to be read, see VfsFile::AdviseAccess
+enum class VfsAccessPattern {
+    Normal,
+    Sequential,
+    Random,
+};
+
 // A class representing an abstract filesystem. A default implementation given the root VirtualDir
 // is provided for convenience, but if the Vfs implementation has any additional state or
 // functionality, they will need to override.
@@ -105,6 +112,14 @@ public:
     // into file. Returns number of bytes successfully written.
     virtual std::size_t Write(const u8* data, std::size_t length, std::size_t offset = 0) = 0;
 
+    // Returns the contents of the file if they are mapped into memory, or nullptr if they are not.
+    // The memory is GetSize() bytes long and stays valid for as long as the file is alive.
+    virtual const u8* GetMappedData() const;
+    // Hints how a range of the file is going to be read, files that are mapped into memory tune
+    // the read-ahead of that range. Does nothing by default.
+    virtual void AdviseAccess(VfsAccessPattern pattern, std::size_t offset,
+                              std::size_t length) const;
+
     // Reads exactly one byte at the offset provided, returning std::nullopt on error.
     virtual std::optional<u8> ReadByte(std::size_t offset = 0) const;
     // Reads size bytes starting at offset in file into a vector.
@@ -172,6 +187,11 @@ public:
     // Renames the file to name. Returns whether or not the operation was successsful.
     virtual bool Rename(std::string_view name) = 0;
 
+    // Writes the contents of the file through to the storage device, so that they survive a power
+    // loss. Returns whether or not the operation was successful. Files without a storage device
+    // have nothing to write and always succeed.
+    virtual bool Sync();
+
     // Returns the full path of this file as a string, recursively
     virtual std::string GetFullPath() const;
 };
@@ -266,6 +286,11 @@ public:
     // dest.
     virtual bool Copy(std::string_view src, std::string_view dest);
 
+    // Renames the file with name src to dest, replacing dest if it exists. Returns whether or not
+    // the operation was successful. The default implementation deletes dest first, directories on
+    // the host filesystem replace it atomically.
+    virtual bool ReplaceFile(std::string_view src, std::string_view dest);
+
     // Gets all of the entries directly in the directory (files and dirs), returning a map between
     // item name -> type.
     virtual std::map<std::string, VfsEntryType, std::less<>> GetEntries() const;
@@ -302,11 +327,27 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2,
 // directory of src/dest.
 bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size = 0x1000);
 
+// A method that performs the same copy as VfsRawCopy, but the next blocks of src are read on
+// another thread while the current one is written to dest, which pays off for large block sizes.
+// on_read is called on the reading thread with every block in order, on_written is called with the
+// number of bytes written so far and the copy is aborted when it returns false.
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size,
+                      const std::function<void(const u8*, std::size_t)>& on_read = {},
+                      const std::function<bool(std::size_t)>& on_written = {});
+
 // A method that performs a similar function to VfsRawCopy above, but instead copies entire
 // directories. It suffers the same performance penalties as above and an implementation-specific
 // Copy should always be preferred.
 bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size = 0x1000);
 
+// A method that performs the same copy as VfsRawCopyD, but the files are copied in parallel on the
+// shared thread pool, the largest ones first. The directory tree is created up front and every
+// file is resized to its final size before it's written. Reads from the files of src must be safe
+// from several threads. on_copied is called with the number of bytes copied so far and the total,
+// never by two threads at once, and the copy is aborted when it returns false.
+bool VfsParallelCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size,
+                      const std::function<bool(std::size_t, std::size_t)>& on_copied = {});
+
 // Checks if the directory at path relative to rel exists. If it does, returns that. If it does not
 // it attempts to create it and returns the new dir or nullptr on failure.
 VirtualDir GetOrCreateDirectoryRelative(const VirtualDir& rel, std::string_view path);
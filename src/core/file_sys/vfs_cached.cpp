@@ -0,0 +1,208 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/memory_accounting.h"
+#include "core/file_sys/vfs_cached.h"
+
+namespace FileSys {
+namespace {
+
+constexpr std::size_t BLOCK_SIZE = 0x10000;
+
+/// Blocks loaded past the end of a sequential read
+constexpr std::size_t READ_AHEAD_BLOCKS = 4;
+
+/// Larger reads go straight to the base file, so that they don't flush the cache
+constexpr std::size_t MAX_CACHED_READ_SIZE = 0x100000;
+
+/// Shards have their own lock, so that reads of different blocks rarely contend
+constexpr std::size_t NUM_SHARDS = 16;
+
+/// Bounds the size of the cache to 64 MiB
+constexpr std::size_t MAX_BLOCKS_PER_SHARD = 64;
+
+using Block = std::shared_ptr<const std::vector<u8>>;
+
+class BlockCache {
+public:
+    Block Find(u64 file_id, u64 index) {
+        Shard& shard = GetShard(file_id, index);
+        std::scoped_lock lock{shard.mutex};
+        const auto itr = shard.entries.find({file_id, index});
+        if (itr == shard.entries.end()) {
+            return nullptr;
+        }
+        // Move the block to the front, the back of the list is evicted first
+        shard.lru.splice(shard.lru.begin(), shard.lru, itr->second);
+        return itr->second->second;
+    }
+
+    void Insert(u64 file_id, u64 index, Block block) {
+        Shard& shard = GetShard(file_id, index);
+        std::scoped_lock lock{shard.mutex};
+        const Key key{file_id, index};
+        if (shard.entries.find(key) != shard.entries.end()) {
+            return;
+        }
+        if (shard.lru.size() == MAX_BLOCKS_PER_SHARD) {
+            FreeAccounting(shard.lru.back().second);
+            shard.entries.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+        }
+        Common::MemoryAccounting::Allocate(Common::MemoryAccounting::Category::VfsCache,
+                                           block->capacity());
+        shard.lru.emplace_front(key, std::move(block));
+        shard.entries.emplace(key, shard.lru.begin());
+    }
+
+    void EvictFile(u64 file_id) {
+        for (Shard& shard : shards) {
+            std::scoped_lock lock{shard.mutex};
+            for (auto itr = shard.lru.begin(); itr != shard.lru.end();) {
+                if (itr->first.first == file_id) {
+                    FreeAccounting(itr->second);
+                    shard.entries.erase(itr->first);
+                    itr = shard.lru.erase(itr);
+                } else {
+                    ++itr;
+                }
+            }
+        }
+    }
+
+private:
+    /// File id and index of a block
+    using Key = std::pair<u64, u64>;
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return static_cast<std::size_t>(key.first * 0x9E3779B97F4A7C15ULL ^ key.second);
+        }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::pair<Key, Block>> lru;
+        std::unordered_map<Key, std::list<std::pair<Key, Block>>::iterator, KeyHash> entries;
+    };
+
+    static void FreeAccounting(const Block& block) {
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Category::VfsCache,
+                                       block->capacity());
+    }
+
+    Shard& GetShard(u64 file_id, u64 index) {
+        // Consecutive blocks of a file land in different shards
+        return shards[(file_id + index) % NUM_SHARDS];
+    }
+
+    std::array<Shard, NUM_SHARDS> shards;
+};
+
+BlockCache& GetBlockCache() {
+    static BlockCache cache;
+    return cache;
+}
+
+u64 GenerateFileId() {
+    static std::atomic<u64> next_file_id{0};
+    return next_file_id++;
+}
+
+} // Anonymous namespace
+
+CachedVfsFile::CachedVfsFile(VirtualFile base_)
+    : base(std::move(base_)), size(base->GetSize()), file_id(GenerateFileId()) {}
+
+CachedVfsFile::~CachedVfsFile() {
+    GetBlockCache().EvictFile(file_id);
+}
+
+std::string CachedVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t CachedVfsFile::GetSize() const {
+    return size;
+}
+
+bool CachedVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> CachedVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool CachedVfsFile::IsWritable() const {
+    return false;
+}
+
+bool CachedVfsFile::IsReadable() const {
+    return true;
+}
+
+std::size_t CachedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+    if (length > MAX_CACHED_READ_SIZE) {
+        return base->Read(data, length, offset);
+    }
+
+    BlockCache& cache = GetBlockCache();
+    const bool is_sequential = next_sequential_offset.exchange(offset + length) == offset;
+    const u64 num_blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    std::size_t read = 0;
+    while (read < length) {
+        const std::size_t position = offset + read;
+        const u64 index = position / BLOCK_SIZE;
+
+        Block block = cache.Find(file_id, index);
+        if (block == nullptr) {
+            const u64 last_index =
+                std::min(num_blocks, index + 1 + (is_sequential ? READ_AHEAD_BLOCKS : 0));
+            for (u64 load_index = index; load_index < last_index; ++load_index) {
+                if (load_index != index && cache.Find(file_id, load_index) != nullptr) {
+                    continue;
+                }
+                auto loaded = std::make_shared<std::vector<u8>>(BLOCK_SIZE);
+                loaded->resize(base->Read(loaded->data(), BLOCK_SIZE, load_index * BLOCK_SIZE));
+                if (load_index == index) {
+                    block = loaded;
+                }
+                cache.Insert(file_id, load_index, std::move(loaded));
+            }
+        }
+
+        const std::size_t block_offset = position % BLOCK_SIZE;
+        if (block->size() <= block_offset) {
+            break;
+        }
+        const std::size_t block_read = std::min(length - read, block->size() - block_offset);
+        std::memcpy(data + read, block->data() + block_offset, block_read);
+        read += block_read;
+    }
+    return read;
+}
+
+std::size_t CachedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool CachedVfsFile::Rename(std::string_view name) {
+    return false;
+}
+
+} // namespace FileSys
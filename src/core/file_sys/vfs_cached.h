@@ -0,0 +1,42 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// Read-only wrapper around a file that is expensive to read, such as a decrypted NCA section.
+// Reads go through a cache of fixed size blocks that is shared by all the cached files and evicts
+// the least recently used blocks once it is full. Sequential reads also load the blocks that
+// follow them.
+class CachedVfsFile : public VfsFile {
+public:
+    explicit CachedVfsFile(VirtualFile base);
+    ~CachedVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    VirtualFile base;
+    std::size_t size;
+    u64 file_id; ///< Identifies the blocks of this file in the block cache
+
+    /// End of the last read, a read starting there is sequential
+    mutable std::atomic<std::size_t> next_sequential_offset{0};
+};
+
+} // namespace FileSys
@@ -0,0 +1,266 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <utility>
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread_pool.h"
+#include "common/zstd_compression.h"
+#include "core/file_sys/vfs_cached.h"
+#include "core/file_sys/vfs_compressed.h"
+
+namespace FileSys {
+namespace {
+
+constexpr u32 COMPRESSED_FILE_MAGIC = Common::MakeMagic('Y', 'Z', 'C', '0');
+constexpr u32 COMPRESSED_FILE_VERSION = 1;
+
+/// Blocks larger than this are rejected, a corrupted header could make reads allocate anything
+constexpr std::size_t MAX_BLOCK_SIZE = 0x1000000;
+
+// The header is followed by the offsets of the num_blocks blocks and the end of the last block.
+// Blocks that don't get smaller are stored uncompressed, which is the case when the stored size of
+// a block is its decompressed size.
+struct CompressedFileHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le size;
+    u32_le block_size;
+    u32_le num_blocks;
+    INSERT_PADDING_BYTES(0x8);
+};
+static_assert(sizeof(CompressedFileHeader) == 0x20, "CompressedFileHeader has incorrect size.");
+
+} // Anonymous namespace
+
+CompressedVfsFile::CompressedVfsFile(VirtualFile base_, std::size_t size_, std::size_t block_size_,
+                                     std::vector<u64> block_offsets_)
+    : base(std::move(base_)), size(size_), block_size(block_size_),
+      block_offsets(std::move(block_offsets_)) {}
+
+CompressedVfsFile::~CompressedVfsFile() = default;
+
+bool CompressedVfsFile::IsCompressedFile(const VirtualFile& file) {
+    u32 magic = 0;
+    return file != nullptr && file->ReadObject(&magic) == sizeof(magic) &&
+           magic == COMPRESSED_FILE_MAGIC;
+}
+
+VirtualFile CompressedVfsFile::Open(VirtualFile file) {
+    CompressedFileHeader header{};
+    if (file == nullptr || file->ReadObject(&header) != sizeof(header) ||
+        header.magic != COMPRESSED_FILE_MAGIC) {
+        return nullptr;
+    }
+
+    if (header.version != COMPRESSED_FILE_VERSION || header.block_size == 0 ||
+        header.block_size > MAX_BLOCK_SIZE ||
+        header.num_blocks != (header.size + header.block_size - 1) / header.block_size) {
+        LOG_ERROR(Loader, "Compressed file {} has an invalid header", file->GetName());
+        return nullptr;
+    }
+
+    std::vector<u64_le> raw_offsets(header.num_blocks + 1);
+    const std::size_t index_size = raw_offsets.size() * sizeof(u64_le);
+    if (file->ReadBytes(raw_offsets.data(), index_size, sizeof(header)) != index_size) {
+        LOG_ERROR(Loader, "Compressed file {} has a truncated block index", file->GetName());
+        return nullptr;
+    }
+
+    std::vector<u64> block_offsets(raw_offsets.begin(), raw_offsets.end());
+    const u64 data_offset = sizeof(header) + index_size;
+    for (std::size_t i = 0; i < header.num_blocks; ++i) {
+        const u64 block_length =
+            std::min<u64>(header.block_size, header.size - i * header.block_size);
+        if (block_offsets[i] < data_offset || block_offsets[i + 1] < block_offsets[i] ||
+            block_offsets[i + 1] - block_offsets[i] > block_length) {
+            LOG_ERROR(Loader, "Compressed file {} has an invalid block index", file->GetName());
+            return nullptr;
+        }
+    }
+    if (block_offsets.back() > file->GetSize()) {
+        LOG_ERROR(Loader, "Compressed file {} is truncated", file->GetName());
+        return nullptr;
+    }
+
+    // Cannot use make_shared as the constructor is private
+    const std::shared_ptr<CompressedVfsFile> compressed{new CompressedVfsFile(
+        std::move(file), header.size, header.block_size, std::move(block_offsets))};
+    return std::make_shared<CachedVfsFile>(compressed);
+}
+
+std::string CompressedVfsFile::GetName() const {
+    std::string name = base->GetName();
+    if (name.size() > COMPRESSED_FILE_EXTENSION.size() &&
+        name.compare(name.size() - COMPRESSED_FILE_EXTENSION.size(),
+                     COMPRESSED_FILE_EXTENSION.size(), COMPRESSED_FILE_EXTENSION) == 0) {
+        name.resize(name.size() - COMPRESSED_FILE_EXTENSION.size());
+    }
+    return name;
+}
+
+std::size_t CompressedVfsFile::GetSize() const {
+    return size;
+}
+
+bool CompressedVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> CompressedVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool CompressedVfsFile::IsWritable() const {
+    return false;
+}
+
+bool CompressedVfsFile::IsReadable() const {
+    return base->IsReadable();
+}
+
+std::size_t CompressedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    std::vector<u8> block;
+    std::size_t done = 0;
+    while (done < length) {
+        const std::size_t position = offset + done;
+        const std::size_t index = position / block_size;
+        const std::size_t block_length = std::min(block_size, size - index * block_size);
+        const std::size_t block_offset = position - index * block_size;
+        const std::size_t chunk = std::min(block_length - block_offset, length - done);
+
+        // Whole blocks are decompressed straight into the output
+        if (chunk == block_length) {
+            if (!ReadBlock(index, data + done, block_length)) {
+                break;
+            }
+        } else {
+            block.resize(block_length);
+            if (!ReadBlock(index, block.data(), block_length)) {
+                break;
+            }
+            std::memcpy(data + done, block.data() + block_offset, chunk);
+        }
+        done += chunk;
+    }
+    return done;
+}
+
+std::size_t CompressedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool CompressedVfsFile::Rename(std::string_view name) {
+    return false;
+}
+
+bool CompressedVfsFile::ReadBlock(std::size_t index, u8* data, std::size_t length) const {
+    const u64 offset = block_offsets[index];
+    const std::size_t stored_length = block_offsets[index + 1] - offset;
+    if (stored_length == length) {
+        return base->Read(data, length, offset) == length;
+    }
+
+    // Mapped files are decompressed in place
+    const u8* const mapped_data = base->GetMappedData();
+    bool success = false;
+    if (mapped_data != nullptr) {
+        success = Common::Compression::DecompressDataZSTD(mapped_data + offset, stored_length, data,
+                                                          length);
+    } else {
+        const auto compressed = base->ReadBytes(stored_length, offset);
+        success = compressed.size() == stored_length &&
+                  Common::Compression::DecompressDataZSTD(compressed.data(), compressed.size(),
+                                                          data, length);
+    }
+
+    if (!success) {
+        LOG_ERROR(Loader, "Failed to decompress block {} of {}", index, base->GetName());
+    }
+    return success;
+}
+
+bool CompressVfsFile(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size,
+                     const std::function<bool(std::size_t)>& progress) {
+    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable() ||
+        block_size == 0 || block_size > MAX_BLOCK_SIZE) {
+        return false;
+    }
+
+    const std::size_t size = src->GetSize();
+    const std::size_t num_blocks = (size + block_size - 1) / block_size;
+    if (num_blocks >= std::numeric_limits<u32>::max()) {
+        return false;
+    }
+
+    // The header and the index are written last, once the offsets of the blocks are known
+    std::vector<u64_le> block_offsets(num_blocks + 1);
+    const std::size_t index_size = block_offsets.size() * sizeof(u64_le);
+    u64 write_offset = sizeof(CompressedFileHeader) + index_size;
+    if (!dest->Resize(write_offset)) {
+        return false;
+    }
+
+    // Enough blocks are read at once to keep all the threads busy compressing
+    auto& thread_pool = Common::ThreadPool::GetInstance();
+    const std::size_t batch_size = (thread_pool.GetNumThreads() + 1) * 2;
+    std::vector<std::vector<u8>> blocks(batch_size);
+    std::vector<std::future<std::vector<u8>>> compressed(batch_size);
+    for (std::size_t first = 0; first < num_blocks; first += batch_size) {
+        const std::size_t count = std::min(batch_size, num_blocks - first);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t offset = (first + i) * block_size;
+            const std::size_t length = std::min(block_size, size - offset);
+            blocks[i] = src->ReadBytes(length, offset);
+            if (blocks[i].size() != length) {
+                LOG_ERROR(Loader, "Failed to read {} at offset {:016X}", src->GetName(), offset);
+                return false;
+            }
+            compressed[i] = thread_pool.Submit(
+                [&block = blocks[i]] {
+                    return Common::Compression::CompressDataZSTDDefault(block.data(),
+                                                                        block.size());
+                },
+                Common::TaskPriority::Low);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto data = compressed[i].get();
+            if (data.empty() || data.size() >= blocks[i].size()) {
+                data = std::move(blocks[i]);
+            }
+            if (dest->WriteBytes(data, write_offset) != data.size()) {
+                return false;
+            }
+            block_offsets[first + i] = write_offset;
+            write_offset += data.size();
+        }
+
+        if (progress && !progress(std::min(size, (first + count) * block_size))) {
+            return false;
+        }
+    }
+    block_offsets[num_blocks] = write_offset;
+
+    CompressedFileHeader header{};
+    header.magic = COMPRESSED_FILE_MAGIC;
+    header.version = COMPRESSED_FILE_VERSION;
+    header.size = size;
+    header.block_size = static_cast<u32>(block_size);
+    header.num_blocks = static_cast<u32>(num_blocks);
+    return dest->WriteObject(header, 0) == sizeof(header) &&
+           dest->WriteBytes(block_offsets.data(), index_size, sizeof(header)) == index_size;
+}
+
+} // namespace FileSys
@@ -0,0 +1,76 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+/// Size of the blocks of the files written by CompressVfsFile by default
+constexpr std::size_t COMPRESSED_FILE_BLOCK_SIZE = 0x10000;
+
+/// Extension given to compressed files, it is dropped from the name of the decompressed view
+constexpr std::string_view COMPRESSED_FILE_EXTENSION = ".yzc";
+
+// Read-only view of a file written by CompressVfsFile. The file stores the contents of another
+// file as blocks compressed with Zstandard, each of them decompressed on its own through an index
+// of the blocks, so that reads only decompress the blocks they touch.
+class CompressedVfsFile : public VfsFile {
+public:
+    ~CompressedVfsFile() override;
+
+    /// Returns true if the file starts with the header of a compressed file
+    static bool IsCompressedFile(const VirtualFile& file);
+
+    /**
+     * Opens the decompressed view of a compressed file. The view is wrapped in a CachedVfsFile,
+     * so that small reads don't decompress the same block over and over.
+     * @return The view, or nullptr if the file is not a valid compressed file
+     */
+    static VirtualFile Open(VirtualFile file);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    CompressedVfsFile(VirtualFile base, std::size_t size, std::size_t block_size,
+                      std::vector<u64> block_offsets);
+
+    /// Decompresses the block with the given index, which is length bytes long, into data
+    bool ReadBlock(std::size_t index, u8* data, std::size_t length) const;
+
+    VirtualFile base;
+    std::size_t size;
+    std::size_t block_size;
+
+    /// Offsets of the compressed blocks in the base file, followed by the end of the last block
+    std::vector<u64> block_offsets;
+};
+
+/**
+ * Writes the contents of src to dest as a compressed file that can be read with
+ * CompressedVfsFile. The blocks are compressed in parallel, src and dest are only accessed from
+ * the calling thread.
+ * @param progress Called with the number of bytes of src compressed so far, the compression is
+ * aborted when it returns false
+ * @return Whether the whole file was compressed
+ */
+bool CompressVfsFile(const VirtualFile& src, const VirtualFile& dest,
+                     std::size_t block_size = COMPRESSED_FILE_BLOCK_SIZE,
+                     const std::function<bool(std::size_t)>& progress = {});
+
+} // namespace FileSys
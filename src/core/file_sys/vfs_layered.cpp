@@ -3,6 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "core/file_sys/vfs_layered.h"
 
@@ -59,12 +62,12 @@ std::string LayeredVfsDirectory::GetFullPath() const {
 
 std::vector<std::shared_ptr<VfsFile>> LayeredVfsDirectory::GetFiles() const {
     std::vector<VirtualFile> out;
+    std::unordered_set<std::string> names;
     for (const auto& layer : dirs) {
-        for (const auto& file : layer->GetFiles()) {
-            if (std::find_if(out.begin(), out.end(), [&file](const VirtualFile& comp) {
-                    return comp->GetName() == file->GetName();
-                }) == out.end()) {
-                out.push_back(file);
+        for (auto& file : layer->GetFiles()) {
+            // The file of the first layer that has the name hides the others
+            if (names.insert(file->GetName()).second) {
+                out.push_back(std::move(file));
             }
         }
     }
@@ -73,18 +76,24 @@ std::vector<std::shared_ptr<VfsFile>> LayeredVfsDirectory::GetFiles() const {
 }
 
 std::vector<std::shared_ptr<VfsDirectory>> LayeredVfsDirectory::GetSubdirectories() const {
-    std::vector<std::string> names;
+    // Gathers the layers of every subdirectory, keeping the order in which they were found
+    std::vector<std::pair<std::string, std::vector<VirtualDir>>> layers;
+    std::unordered_map<std::string, std::size_t> indices;
     for (const auto& layer : dirs) {
-        for (const auto& sd : layer->GetSubdirectories()) {
-            if (std::find(names.begin(), names.end(), sd->GetName()) == names.end())
-                names.push_back(sd->GetName());
+        for (auto& subdir : layer->GetSubdirectories()) {
+            auto name = subdir->GetName();
+            const auto [itr, inserted] = indices.emplace(name, layers.size());
+            if (inserted) {
+                layers.emplace_back(std::move(name), std::vector<VirtualDir>{});
+            }
+            layers[itr->second].second.push_back(std::move(subdir));
         }
     }
 
     std::vector<VirtualDir> out;
-    out.reserve(names.size());
-    for (const auto& subdir : names)
-        out.push_back(GetSubdirectory(subdir));
+    out.reserve(layers.size());
+    for (auto& [name, subdir_layers] : layers)
+        out.push_back(MakeLayeredDirectory(std::move(subdir_layers), std::move(name)));
 
     return out;
 }
@@ -57,6 +57,23 @@ std::size_t OffsetVfsFile::Write(const u8* data, std::size_t length, std::size_t
     return file->Write(data, TrimToFit(length, r_offset), offset + r_offset);
 }
 
+const u8* OffsetVfsFile::GetMappedData() const {
+    // The window can reach past the end of the base file, the mapping would be too short then
+    const u8* const base_data = file->GetMappedData();
+    if (base_data == nullptr || offset + size > file->GetSize()) {
+        return nullptr;
+    }
+    return base_data + offset;
+}
+
+void OffsetVfsFile::AdviseAccess(VfsAccessPattern pattern, std::size_t r_offset,
+                                 std::size_t length) const {
+    if (r_offset >= size) {
+        return;
+    }
+    file->AdviseAccess(pattern, offset + r_offset, TrimToFit(length, r_offset));
+}
+
 std::optional<u8> OffsetVfsFile::ReadByte(std::size_t r_offset) const {
     if (r_offset < size)
         return file->ReadByte(offset + r_offset);
@@ -91,6 +108,10 @@ std::size_t OffsetVfsFile::GetOffset() const {
     return offset;
 }
 
+std::shared_ptr<VfsFile> OffsetVfsFile::GetBaseFile() const {
+    return file;
+}
+
 std::size_t OffsetVfsFile::TrimToFit(std::size_t r_size, std::size_t r_offset) const {
     return std::clamp(r_size, std::size_t{0}, size - r_offset);
 }
@@ -29,6 +29,9 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetMappedData() const override;
+    void AdviseAccess(VfsAccessPattern pattern, std::size_t offset,
+                      std::size_t length) const override;
     std::optional<u8> ReadByte(std::size_t offset) const override;
     std::vector<u8> ReadBytes(std::size_t size, std::size_t offset) const override;
     std::vector<u8> ReadAllBytes() const override;
@@ -39,6 +42,9 @@ public:
 
     std::size_t GetOffset() const;
 
+    /// Returns the file this file is a window into
+    std::shared_ptr<VfsFile> GetBaseFile() const;
+
 private:
     std::size_t TrimToFit(std::size_t r_size, std::size_t r_offset) const;
 
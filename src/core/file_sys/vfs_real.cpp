@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
+#include <mutex>
 #include <utility>
 #include "common/assert.h"
 #include "common/common_paths.h"
@@ -64,12 +66,46 @@ VfsEntryType RealVfsFilesystem::GetEntryType(std::string_view path_) const {
     return VfsEntryType::File;
 }
 
+/// Returns true if the path is in one of the directories the emulated system writes to. Their files
+/// can be resized by a writable handle while a reader maps them, which faults reads past the new
+/// end of the file on POSIX and makes the resize fail on Windows, so they are never mapped.
+static bool IsInWritableUserDir(const std::string& path) {
+    for (const auto user_path :
+         {FileUtil::UserPath::NANDDir, FileUtil::UserPath::SDMCDir, FileUtil::UserPath::DumpDir}) {
+        const auto dir = FileUtil::SanitizePath(FileUtil::GetUserPath(user_path),
+                                                FileUtil::DirectorySeparator::PlatformDefault);
+        if (!dir.empty() && path.rfind(dir, 0) == 0 &&
+            (path.size() == dir.size() || path[dir.size()] == '/' || path[dir.size()] == '\\')) {
+            return true;
+        }
+    }
+    return false;
+}
+
 VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
+
+    std::shared_ptr<const FileUtil::MappedFile> mapping;
+    if (perms == Mode::Read && !IsInWritableUserDir(path)) {
+        mapping = mapped_cache[path].lock();
+        if (mapping == nullptr) {
+            auto new_mapping = std::make_shared<const FileUtil::MappedFile>(path);
+            if (new_mapping->IsOpen()) {
+                mapping = std::move(new_mapping);
+                mapped_cache[path] = mapping;
+            }
+        }
+    } else {
+        // The file can change size, the next read-only open maps it again
+        mapped_cache.erase(path);
+    }
+
     if (cache.find(path) != cache.end()) {
         auto weak = cache[path];
         if (!weak.expired()) {
-            return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, weak.lock(), path, perms));
+            return std::shared_ptr<RealVfsFile>(
+                new RealVfsFile(*this, weak.lock(), std::move(mapping), path, perms));
         }
     }
 
@@ -80,7 +116,8 @@ VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
     cache[path] = backing;
 
     // Cannot use make_shared as RealVfsFile constructor is private
-    return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, backing, path, perms));
+    return std::shared_ptr<RealVfsFile>(
+        new RealVfsFile(*this, backing, std::move(mapping), path, perms));
 }
 
 VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, Mode perms) {
@@ -116,13 +153,17 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
-    if (cache.find(old_path) != cache.end()) {
-        auto cached = cache[old_path];
-        if (!cached.expired()) {
-            auto file = cached.lock();
-            file->Open(new_path, "r+b");
-            cache.erase(old_path);
-            cache[new_path] = file;
+    {
+        std::lock_guard lock{cache_mutex};
+        InvalidateMappings(old_path);
+        if (cache.find(old_path) != cache.end()) {
+            auto cached = cache[old_path];
+            if (!cached.expired()) {
+                auto file = cached.lock();
+                file->Open(new_path, "r+b");
+                cache.erase(old_path);
+                cache[new_path] = file;
+            }
         }
     }
     return OpenFile(new_path, Mode::ReadWrite);
@@ -130,6 +171,8 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
 
 bool RealVfsFilesystem::DeleteFile(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
+    InvalidateMappings(path);
     if (cache.find(path) != cache.end()) {
         if (!cache[path].expired())
             cache[path].lock()->Close();
@@ -179,20 +222,24 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
-    for (auto& kv : cache) {
-        // Path in cache starts with old_path
-        if (kv.first.rfind(old_path, 0) == 0) {
-            const auto file_old_path =
-                FileUtil::SanitizePath(kv.first, FileUtil::DirectorySeparator::PlatformDefault);
-            const auto file_new_path =
-                FileUtil::SanitizePath(new_path + DIR_SEP + kv.first.substr(old_path.size()),
-                                       FileUtil::DirectorySeparator::PlatformDefault);
-            auto cached = cache[file_old_path];
-            if (!cached.expired()) {
-                auto file = cached.lock();
-                file->Open(file_new_path, "r+b");
-                cache.erase(file_old_path);
-                cache[file_new_path] = file;
+    {
+        std::lock_guard lock{cache_mutex};
+        InvalidateMappings(old_path);
+        for (auto& kv : cache) {
+            // Path in cache starts with old_path
+            if (kv.first.rfind(old_path, 0) == 0) {
+                const auto file_old_path = FileUtil::SanitizePath(
+                    kv.first, FileUtil::DirectorySeparator::PlatformDefault);
+                const auto file_new_path = FileUtil::SanitizePath(
+                    new_path + DIR_SEP + kv.first.substr(old_path.size()),
+                    FileUtil::DirectorySeparator::PlatformDefault);
+                auto cached = cache[file_old_path];
+                if (!cached.expired()) {
+                    auto file = cached.lock();
+                    file->Open(file_new_path, "r+b");
+                    cache.erase(file_old_path);
+                    cache[file_new_path] = file;
+                }
             }
         }
     }
@@ -202,6 +249,8 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
 
 bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
+    InvalidateMappings(path);
     for (auto& kv : cache) {
         // Path in cache starts with old_path
         if (kv.first.rfind(path, 0) == 0) {
@@ -213,9 +262,56 @@ bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
     return FileUtil::DeleteDirRecursively(path);
 }
 
+bool RealVfsFilesystem::ReplaceFile(std::string_view old_path_, std::string_view new_path_) {
+    const auto old_path =
+        FileUtil::SanitizePath(old_path_, FileUtil::DirectorySeparator::PlatformDefault);
+    const auto new_path =
+        FileUtil::SanitizePath(new_path_, FileUtil::DirectorySeparator::PlatformDefault);
+    if (!FileUtil::Exists(old_path) || FileUtil::IsDirectory(old_path) ||
+        FileUtil::IsDirectory(new_path))
+        return false;
+
+    std::lock_guard lock{cache_mutex};
+    InvalidateMappings(old_path);
+    InvalidateMappings(new_path);
+
+    // Windows can't replace a file that is open
+    if (cache.find(new_path) != cache.end()) {
+        if (!cache[new_path].expired())
+            cache[new_path].lock()->Close();
+        cache.erase(new_path);
+    }
+
+    if (!FileUtil::Replace(old_path, new_path))
+        return false;
+
+    if (cache.find(old_path) != cache.end()) {
+        auto cached = cache[old_path];
+        if (!cached.expired()) {
+            auto file = cached.lock();
+            file->Open(new_path, "r+b");
+            cache[new_path] = file;
+        }
+        cache.erase(old_path);
+    }
+    return true;
+}
+
+void RealVfsFilesystem::InvalidateMappings(const std::string& path) {
+    // Open files keep their mapping alive, only later opens are affected
+    for (auto itr = mapped_cache.begin(); itr != mapped_cache.end();) {
+        if (itr->first.rfind(path, 0) == 0) {
+            itr = mapped_cache.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+}
+
 RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, std::shared_ptr<FileUtil::IOFile> backing_,
+                         std::shared_ptr<const FileUtil::MappedFile> mapping_,
                          const std::string& path_, Mode perms_)
-    : base(base_), backing(std::move(backing_)), path(path_),
+    : base(base_), backing(std::move(backing_)), mapping(std::move(mapping_)), path(path_),
       parent_path(FileUtil::GetParentPath(path_)),
       path_components(FileUtil::SplitPathComponents(path_)),
       parent_components(FileUtil::SliceVector(path_components, 0, path_components.size() - 1)),
@@ -228,6 +324,9 @@ std::string RealVfsFile::GetName() const {
 }
 
 std::size_t RealVfsFile::GetSize() const {
+    if (mapping != nullptr) {
+        return mapping->Size();
+    }
     return backing->GetSize();
 }
 
@@ -248,6 +347,16 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (mapping != nullptr) {
+        // Doesn't touch the file position, which is shared by all the files of this path
+        if (offset >= mapping->Size()) {
+            return 0;
+        }
+        const std::size_t read_size = std::min(length, mapping->Size() - offset);
+        std::memcpy(data, mapping->Data() + offset, read_size);
+        return read_size;
+    }
+
     if (!backing->Seek(offset, SEEK_SET))
         return 0;
     return backing->ReadBytes(data, length);
@@ -259,10 +368,37 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return backing->WriteBytes(data, length);
 }
 
+const u8* RealVfsFile::GetMappedData() const {
+    return mapping != nullptr ? mapping->Data() : nullptr;
+}
+
+void RealVfsFile::AdviseAccess(VfsAccessPattern pattern, std::size_t offset,
+                               std::size_t length) const {
+    if (mapping == nullptr) {
+        return;
+    }
+
+    switch (pattern) {
+    case VfsAccessPattern::Normal:
+        mapping->Advise(offset, length, FileUtil::MappedFile::AccessHint::Normal);
+        break;
+    case VfsAccessPattern::Sequential:
+        mapping->Advise(offset, length, FileUtil::MappedFile::AccessHint::Sequential);
+        break;
+    case VfsAccessPattern::Random:
+        mapping->Advise(offset, length, FileUtil::MappedFile::AccessHint::Random);
+        break;
+    }
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + DIR_SEP + std::string(name)) != nullptr;
 }
 
+bool RealVfsFile::Sync() {
+    return backing->Sync();
+}
+
 bool RealVfsFile::Close() {
     return backing->Close();
 }
@@ -402,6 +538,12 @@ bool RealVfsDirectory::DeleteFile(std::string_view name) {
     return base.DeleteFile(file_path);
 }
 
+bool RealVfsDirectory::ReplaceFile(std::string_view src, std::string_view dest) {
+    const std::string src_path = (path + DIR_SEP).append(src);
+    const std::string dest_path = (path + DIR_SEP).append(dest);
+    return base.ReplaceFile(src_path, dest_path);
+}
+
 bool RealVfsDirectory::Rename(std::string_view name) {
     const std::string new_name = (parent_path + DIR_SEP).append(name);
     return base.MoveFile(path, new_name) != nullptr;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string_view>
 #include <boost/container/flat_map.hpp>
 #include "core/file_sys/mode.h"
@@ -11,6 +12,7 @@
 
 namespace FileUtil {
 class IOFile;
+class MappedFile;
 }
 
 namespace FileSys {
@@ -35,8 +37,21 @@ public:
     VirtualDir MoveDirectory(std::string_view old_path, std::string_view new_path) override;
     bool DeleteDirectory(std::string_view path) override;
 
+    /// Renames the file at old_path to new_path, atomically replacing the file at new_path if it
+    /// exists. Handles opened on the replaced file are closed.
+    bool ReplaceFile(std::string_view old_path, std::string_view new_path);
+
 private:
+    /// Drops the memory mappings of the paths starting with the given path, cache_mutex must be
+    /// held
+    void InvalidateMappings(const std::string& path);
+
+    /// Guards the caches, files are opened from the worker threads of the parallel loaders
+    std::mutex cache_mutex;
     boost::container::flat_map<std::string, std::weak_ptr<FileUtil::IOFile>> cache;
+    /// Mappings shared by the files opened read-only, reads from them don't seek the backing file
+    boost::container::flat_map<std::string, std::weak_ptr<const FileUtil::MappedFile>>
+        mapped_cache;
 };
 
 // An implmentation of VfsFile that represents a file on the user's computer.
@@ -55,16 +70,22 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetMappedData() const override;
+    void AdviseAccess(VfsAccessPattern pattern, std::size_t offset,
+                      std::size_t length) const override;
     bool Rename(std::string_view name) override;
+    bool Sync() override;
 
 private:
     RealVfsFile(RealVfsFilesystem& base, std::shared_ptr<FileUtil::IOFile> backing,
-                const std::string& path, Mode perms = Mode::Read);
+                std::shared_ptr<const FileUtil::MappedFile> mapping, const std::string& path,
+                Mode perms = Mode::Read);
 
     bool Close();
 
     RealVfsFilesystem& base;
     std::shared_ptr<FileUtil::IOFile> backing;
+    std::shared_ptr<const FileUtil::MappedFile> mapping; ///< Null unless opened read-only
     std::string path;
     std::string parent_path;
     std::vector<std::string> path_components;
@@ -97,6 +118,7 @@ public:
     bool DeleteSubdirectory(std::string_view name) override;
     bool DeleteFile(std::string_view name) override;
     bool Rename(std::string_view name) override;
+    bool ReplaceFile(std::string_view src, std::string_view dest) override;
     std::string GetFullPath() const override;
     std::map<std::string, VfsEntryType, std::less<>> GetEntries() const override;
 
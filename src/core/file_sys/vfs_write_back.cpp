@@ -0,0 +1,250 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "common/logging/log.h"
+#include "core/file_sys/vfs_write_back.h"
+
+namespace FileSys {
+
+namespace {
+
+/// Suffix of the files holding the new contents of a file while it is committed
+constexpr std::string_view COMMIT_SUFFIX = ".yuzu_commit";
+
+std::pair<std::string, std::string> SplitPath(const std::string& path) {
+    const auto index = path.find_last_of("\\/");
+    if (index == std::string::npos) {
+        return {{}, path};
+    }
+    return {path.substr(0, index), path.substr(index + 1)};
+}
+
+} // Anonymous namespace
+
+struct WriteBackEntry {
+    std::string path;
+    VirtualFile base;
+    std::vector<u8> data; ///< Contents of the file, once it has been written to
+    bool is_loaded = false;
+    bool is_dirty = false;
+    bool is_detached = false; ///< The views write to the base file directly
+
+    void Load() {
+        if (!is_loaded) {
+            data = base->ReadAllBytes();
+            is_loaded = true;
+        }
+    }
+};
+
+namespace {
+
+class WriteBackVfsFile final : public VfsFile {
+public:
+    WriteBackVfsFile(std::shared_ptr<WriteBackCache> cache, std::shared_ptr<WriteBackEntry> entry)
+        : cache(std::move(cache)), entry(std::move(entry)) {}
+
+    std::string GetName() const override {
+        return entry->base->GetName();
+    }
+
+    std::size_t GetSize() const override {
+        return entry->is_loaded ? entry->data.size() : entry->base->GetSize();
+    }
+
+    bool Resize(std::size_t new_size) override {
+        if (entry->is_detached) {
+            return entry->base->Resize(new_size);
+        }
+        entry->Load();
+        entry->data.resize(new_size);
+        entry->is_dirty = true;
+        return true;
+    }
+
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override {
+        return entry->base->GetContainingDirectory();
+    }
+
+    bool IsWritable() const override {
+        return entry->base->IsWritable();
+    }
+
+    bool IsReadable() const override {
+        return entry->base->IsReadable();
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        if (!entry->is_loaded) {
+            return entry->base->Read(data, length, offset);
+        }
+        if (offset >= entry->data.size()) {
+            return 0;
+        }
+        length = std::min(length, entry->data.size() - offset);
+        std::memcpy(data, entry->data.data() + offset, length);
+        return length;
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        if (entry->is_detached) {
+            return entry->base->Write(data, length, offset);
+        }
+        if (!IsWritable()) {
+            return 0;
+        }
+        entry->Load();
+        if (offset + length > entry->data.size()) {
+            entry->data.resize(offset + length);
+        }
+        std::memcpy(entry->data.data() + offset, data, length);
+        entry->is_dirty = true;
+        return length;
+    }
+
+    bool Rename(std::string_view name) override {
+        cache->CommitAndDetach();
+        return entry->base->Rename(name);
+    }
+
+private:
+    std::shared_ptr<WriteBackCache> cache;
+    std::shared_ptr<WriteBackEntry> entry;
+};
+
+} // Anonymous namespace
+
+WriteBackCache::WriteBackCache(VirtualDir root_) : root(std::move(root_)) {
+    RecoverCommits(root);
+}
+
+WriteBackCache::~WriteBackCache() {
+    Commit();
+}
+
+VirtualFile WriteBackCache::OpenFile(const std::string& path, VirtualFile file) {
+    auto& entry = entries[path];
+    if (entry == nullptr || entry->is_detached) {
+        entry = std::make_shared<WriteBackEntry>();
+        entry->path = path;
+        entry->base = std::move(file);
+    }
+    return std::make_shared<WriteBackVfsFile>(shared_from_this(), entry);
+}
+
+bool WriteBackCache::Commit() {
+    bool success = true;
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        auto& entry = *iter->second;
+        if (entry.is_dirty && !CommitEntry(entry)) {
+            success = false;
+        }
+
+        // The data of a file without views is on disk now, it is read from there the next time
+        if (!entry.is_dirty && iter->second.use_count() == 1) {
+            iter = entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    return success;
+}
+
+bool WriteBackCache::CommitAndDetach() {
+    const bool success = Commit();
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        auto& entry = *iter->second;
+
+        // Files that failed to be written keep their data, they are written on the next commit
+        if (entry.is_dirty) {
+            ++iter;
+            continue;
+        }
+
+        entry.is_detached = true;
+        entry.is_loaded = false;
+        entry.data = {};
+        iter = entries.erase(iter);
+    }
+    return success;
+}
+
+bool WriteBackCache::CommitEntry(WriteBackEntry& entry) {
+    const auto [parent_path, name] = SplitPath(entry.path);
+    const auto dir = parent_path.empty() ? root : root->GetDirectoryRelative(parent_path);
+    if (dir == nullptr || dir->GetFile(name) == nullptr) {
+        // The file was removed, there is nothing to write the data to anymore
+        LOG_WARNING(Service_FS, "File {} is gone, discarding its writes", entry.path);
+        entry.is_dirty = false;
+        return true;
+    }
+
+    // The new contents are on the storage device and closed before they replace the original
+    const std::string commit_name = name + std::string(COMMIT_SUFFIX);
+    {
+        auto commit_file = dir->GetFile(commit_name);
+        if (commit_file == nullptr) {
+            commit_file = dir->CreateFile(commit_name);
+        }
+        if (commit_file == nullptr || !commit_file->Resize(entry.data.size()) ||
+            commit_file->WriteBytes(entry.data) != entry.data.size() || !commit_file->Sync()) {
+            LOG_ERROR(Service_FS, "Failed to write the new contents of {}", entry.path);
+            return false;
+        }
+    }
+
+    entry.base = nullptr;
+    if (!dir->ReplaceFile(commit_name, name)) {
+        LOG_ERROR(Service_FS, "Failed to replace {} with its new contents", entry.path);
+        entry.base = dir->GetFile(name);
+        if (entry.base == nullptr) {
+            // The commit is completed the next time the directory is opened
+            entry.base = dir->GetFile(commit_name);
+        }
+        return false;
+    }
+
+    entry.base = dir->GetFile(name);
+    entry.is_dirty = false;
+    return entry.base != nullptr;
+}
+
+void WriteBackCache::RecoverCommits(const VirtualDir& dir) {
+    // The files are only looked up by name, files that are open can't be removed on Windows
+    std::vector<std::string> commit_names;
+    for (const auto& file : dir->GetFiles()) {
+        const auto file_name = file->GetName();
+        if (file_name.size() > COMMIT_SUFFIX.size() &&
+            std::string_view(file_name).substr(file_name.size() - COMMIT_SUFFIX.size()) ==
+                COMMIT_SUFFIX) {
+            commit_names.push_back(file_name);
+        }
+    }
+
+    for (const auto& commit_name : commit_names) {
+        const auto name = commit_name.substr(0, commit_name.size() - COMMIT_SUFFIX.size());
+        if (dir->GetFile(name) != nullptr) {
+            // The original is only replaced once the new contents are complete, they may not be
+            LOG_WARNING(Service_FS, "Rolling back interrupted commit of {}", name);
+            dir->DeleteFile(commit_name);
+        } else {
+            LOG_WARNING(Service_FS, "Completing interrupted commit of {}", name);
+            const auto commit_file = dir->GetFile(commit_name);
+            if (commit_file != nullptr) {
+                commit_file->Rename(name);
+            }
+        }
+    }
+
+    for (const auto& subdir : dir->GetSubdirectories()) {
+        RecoverCommits(subdir);
+    }
+}
+
+} // namespace FileSys
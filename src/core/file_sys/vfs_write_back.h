@@ -0,0 +1,60 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+struct WriteBackEntry;
+
+/**
+ * Keeps the writes to the files of a directory in memory until they are committed, like the
+ * journal of save data on Horizon. Committed files are written next to the originals and renamed
+ * over them, an interrupted commit leaves either the old or the new contents of every file.
+ */
+class WriteBackCache : public std::enable_shared_from_this<WriteBackCache> {
+public:
+    /// Completes or rolls back the commits to the directory that were interrupted
+    explicit WriteBackCache(VirtualDir root);
+
+    /// Commits the writes that are left, once the cache and all the files it opened are gone
+    ~WriteBackCache();
+
+    WriteBackCache(const WriteBackCache&) = delete;
+    WriteBackCache& operator=(const WriteBackCache&) = delete;
+
+    /**
+     * Returns a view of a file of the directory whose writes are kept in memory until they are
+     * committed. The views of a path opened while the previous ones are alive share their data.
+     * @param path Path of the file relative to the directory
+     * @param file The file in the directory
+     */
+    VirtualFile OpenFile(const std::string& path, VirtualFile file);
+
+    /// Writes the modified files to the directory, returns false if a file couldn't be written
+    bool Commit();
+
+    /**
+     * Commits and makes the views that are still open write to the directory directly. This must
+     * be done before the entries of the directory are changed by other means than the views.
+     */
+    bool CommitAndDetach();
+
+private:
+    /// Writes one modified file, see the class description for how this is crash-safe
+    bool CommitEntry(WriteBackEntry& entry);
+
+    /// Finishes the commits of the directory and its subdirectories that were interrupted
+    static void RecoverCommits(const VirtualDir& dir);
+
+    VirtualDir root;
+    std::map<std::string, std::shared_ptr<WriteBackEntry>> entries;
+};
+
+} // namespace FileSys
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <map>
 #include <numeric>
+#include <optional>
 #include <fcntl.h>
 
 #ifdef _WIN32
@@ -31,6 +32,7 @@
 #endif
 
 #include "common/logging/log.h"
+#include "common/memory_hook.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
@@ -42,6 +44,7 @@
 #include "core/hle/kernel/vm_manager.h"
 #include "core/loader/loader.h"
 #include "core/memory.h"
+#include "core/memory_setup.h"
 
 namespace GDBStub {
 namespace {
@@ -179,6 +182,74 @@ BreakpointMap breakpoints_execute;
 BreakpointMap breakpoints_read;
 BreakpointMap breakpoints_write;
 
+/**
+ * Breaks when the guest accesses the range of a read or write breakpoint. It is installed as a
+ * debug hook on the watched ranges only, so accesses to other pages stay on the fast path.
+ */
+class WatchpointHook final : public Common::MemoryHook {
+public:
+    explicit WatchpointHook(BreakpointType type) : type{type} {}
+
+    std::optional<bool> IsValidAddress(VAddr addr) override {
+        return std::nullopt;
+    }
+
+    std::optional<u8> Read8(VAddr addr) override {
+        return OnRead<u8>(addr);
+    }
+    std::optional<u16> Read16(VAddr addr) override {
+        return OnRead<u16>(addr);
+    }
+    std::optional<u32> Read32(VAddr addr) override {
+        return OnRead<u32>(addr);
+    }
+    std::optional<u64> Read64(VAddr addr) override {
+        return OnRead<u64>(addr);
+    }
+
+    bool ReadBlock(VAddr src_addr, void* dest_buffer, std::size_t size) override {
+        OnAccess(BreakpointType::Read, src_addr, size);
+        return false;
+    }
+
+    bool Write8(VAddr addr, u8 data) override {
+        return OnWrite(addr, sizeof(data));
+    }
+    bool Write16(VAddr addr, u16 data) override {
+        return OnWrite(addr, sizeof(data));
+    }
+    bool Write32(VAddr addr, u32 data) override {
+        return OnWrite(addr, sizeof(data));
+    }
+    bool Write64(VAddr addr, u64 data) override {
+        return OnWrite(addr, sizeof(data));
+    }
+
+    bool WriteBlock(VAddr dest_addr, const void* src_buffer, std::size_t size) override {
+        return OnWrite(dest_addr, size);
+    }
+
+private:
+    /// The access is always passed through to memory, the hook only observes it
+    template <typename T>
+    std::optional<T> OnRead(VAddr addr) {
+        OnAccess(BreakpointType::Read, addr, sizeof(T));
+        return std::nullopt;
+    }
+
+    bool OnWrite(VAddr addr, std::size_t size) {
+        OnAccess(BreakpointType::Write, addr, size);
+        return false;
+    }
+
+    void OnAccess(BreakpointType access_type, VAddr addr, std::size_t size) const;
+
+    BreakpointType type;
+};
+
+std::shared_ptr<WatchpointHook> read_watchpoint_hook;
+std::shared_ptr<WatchpointHook> write_watchpoint_hook;
+
 struct Module {
     std::string name;
     VAddr beg;
@@ -491,6 +562,45 @@ static BreakpointMap& GetBreakpointMap(BreakpointType type) {
     }
 }
 
+/// Returns the page table the debug hooks of watchpoints are installed in
+static Common::PageTable& GetCurrentPageTable() {
+    return Core::System::GetInstance().CurrentProcess()->VMManager().page_table;
+}
+
+static std::shared_ptr<WatchpointHook>& GetWatchpointHook(BreakpointType type) {
+    std::shared_ptr<WatchpointHook>& hook =
+        type == BreakpointType::Read ? read_watchpoint_hook : write_watchpoint_hook;
+    if (!hook) {
+        hook = std::make_shared<WatchpointHook>(type);
+    }
+    return hook;
+}
+
+/// Returns true if [addr, addr + size) overlaps an active breakpoint of the specified type
+static bool IsWatched(BreakpointType type, VAddr addr, std::size_t size) {
+    if (!IsConnected()) {
+        return false;
+    }
+
+    const BreakpointMap& p = GetBreakpointMap(type);
+    return std::any_of(p.begin(), p.end(), [addr, size](const auto& entry) {
+        const Breakpoint& bp = entry.second;
+        return bp.active && addr < bp.addr + bp.len && bp.addr < addr + size;
+    });
+}
+
+void WatchpointHook::OnAccess(BreakpointType access_type, VAddr addr, std::size_t size) const {
+    if (access_type != type || !IsWatched(type, addr, size)) {
+        return;
+    }
+
+    LOG_DEBUG(Debug_GDBStub, "Hit {} watchpoint @ {:016X} ({} bytes)", static_cast<int>(type),
+              addr, size);
+    Break(true);
+    // The JIT stops at the end of the current block, the trap is sent once it returns
+    Core::CurrentArmInterface().PrepareReschedule();
+}
+
 /**
  * Remove the breakpoint from the given address of the specified type.
  *
@@ -510,7 +620,22 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
 
     if (type == BreakpointType::Execute) {
         Memory::WriteBlock(bp->second.addr, bp->second.inst.data(), bp->second.inst.size());
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(bp->second.addr,
+                                                                       bp->second.inst.size());
+    } else if (bp->second.len != 0) {
+        auto& page_table = GetCurrentPageTable();
+        const auto& hook = GetWatchpointHook(type);
+        Memory::RemoveDebugHook(page_table, bp->second.addr, bp->second.len, hook);
+        p.erase(addr);
+
+        // The hook is shared by the watchpoints of a type, restore it on the ranges of the
+        // remaining ones the removed range overlapped
+        for (const auto& [watch_addr, watch] : p) {
+            if (watch.len != 0) {
+                Memory::AddDebugHook(page_table, watch.addr, watch.len, hook);
+            }
+        }
+        return;
     }
     p.erase(addr);
 }
@@ -1003,7 +1128,7 @@ static void WriteMemory() {
 
     GdbHexToMem(data.data(), len_pos + 1, len);
     Memory::WriteBlock(addr, data.data(), len);
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
+    Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, len);
     SendReply("OK");
 }
 
@@ -1025,7 +1150,6 @@ static void Step() {
     step_loop = true;
     halt_loop = true;
     send_trap = true;
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
 }
 
 /// Tell the CPU if we hit a memory breakpoint.
@@ -1042,7 +1166,6 @@ static void Continue() {
     memory_break = false;
     step_loop = false;
     halt_loop = false;
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
 }
 
 /**
@@ -1064,7 +1187,9 @@ static bool CommitBreakpoint(BreakpointType type, VAddr addr, u64 len) {
     static constexpr std::array<u8, 4> btrap{0x00, 0x7d, 0x20, 0xd4};
     if (type == BreakpointType::Execute) {
         Memory::WriteBlock(addr, btrap.data(), btrap.size());
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, btrap.size());
+    } else if (len != 0) {
+        Memory::AddDebugHook(GetCurrentPageTable(), addr, len, GetWatchpointHook(type));
     }
     p.insert({addr, breakpoint});
 
@@ -0,0 +1,208 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/guest_profiler.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/scheduler.h"
+#include "core/loader/symbols.h"
+#include "core/memory.h"
+
+namespace Core {
+
+namespace {
+
+/// Deepest chain of frame records walked per sample, it also stops walks through corrupt records
+constexpr std::size_t MAX_FRAMES = 64;
+
+/// Reads an object from regular memory of the process. Cached GPU memory isn't read, as it could
+/// require a flush, and unmapped addresses fail instead of logging, frame records can be garbage.
+template <typename T>
+std::optional<T> ReadGuest(const Kernel::Process& process, VAddr addr) {
+    const u8* const pointer = Memory::GetContiguousPointer(process, addr, sizeof(T));
+    if (pointer == nullptr) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, pointer, sizeof(T));
+    return value;
+}
+
+} // Anonymous namespace
+
+bool GuestProfiler::Stack::operator<(const Stack& rhs) const {
+    return std::tie(core_index, is_idle, svc, frames) <
+           std::tie(rhs.core_index, rhs.is_idle, rhs.svc, rhs.frames);
+}
+
+GuestProfiler::GuestProfiler(System& system) : system{system} {}
+
+GuestProfiler::~GuestProfiler() {
+    Stop();
+}
+
+void GuestProfiler::RegisterModule(const Kernel::Process& process, std::string name, VAddr base,
+                                   VAddr end) {
+    // Modules are mapped from a single host allocation
+    const u8* const image = Memory::GetContiguousPointer(process, base, end - base);
+    Module module{std::move(name), base, end,
+                  image ? Loader::ReadModuleFunctions(image, end - base)
+                        : std::vector<Loader::ModuleSymbol>{}};
+    LOG_DEBUG(Core, "Profiling module {} at 0x{:016X}-0x{:016X} with {} functions", module.name,
+              base, end, module.symbols.size());
+
+    std::lock_guard lock{modules_mutex};
+    // Modules loaded over an unloaded one replace it
+    modules.erase(std::remove_if(modules.begin(), modules.end(),
+                                 [base, end](const Module& other) {
+                                     return other.base < end && base < other.end;
+                                 }),
+                  modules.end());
+    const auto it = std::upper_bound(
+        modules.begin(), modules.end(), base,
+        [](VAddr address, const Module& other) { return address < other.base; });
+    modules.insert(it, std::move(module));
+}
+
+void GuestProfiler::Start(std::chrono::microseconds interval, bool walk_frames) {
+    if (sampling_thread.joinable()) {
+        return;
+    }
+    process = system.CurrentProcess();
+    if (process == nullptr) {
+        LOG_ERROR(Core, "There is no process to profile");
+        return;
+    }
+    stop_requested = false;
+    sampling_thread = std::thread(&GuestProfiler::SamplingLoop, this, interval, walk_frames);
+}
+
+void GuestProfiler::Stop() {
+    if (!sampling_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock{stop_mutex};
+        stop_requested = true;
+    }
+    stop_condition.notify_one();
+    sampling_thread.join();
+}
+
+bool GuestProfiler::WriteFoldedStacks(const std::string& path) const {
+    // Addresses in the same function fold into the same stack
+    std::map<std::string, u64> folded;
+    for (const auto& [stack, count] : samples) {
+        std::string line = fmt::format("core{}", stack.core_index);
+        if (stack.is_idle) {
+            line += ";[idle]";
+        } else {
+            for (auto it = stack.frames.rbegin(); it != stack.frames.rend(); ++it) {
+                line += ';';
+                line += Symbolize(*it);
+            }
+            if (stack.svc != nullptr) {
+                line += fmt::format(";[svc] {}", stack.svc);
+            }
+        }
+        folded[std::move(line)] += count;
+    }
+
+    std::string output;
+    for (const auto& [line, count] : folded) {
+        output += fmt::format("{} {}\n", line, count);
+    }
+    return FileUtil::WriteStringToFile(true, path, output) == output.size();
+}
+
+void GuestProfiler::SamplingLoop(std::chrono::microseconds interval, bool walk_frames) {
+    Common::SetCurrentThreadName("yuzu:GuestProfiler");
+
+    std::unique_lock lock{stop_mutex};
+    auto next_sample = std::chrono::steady_clock::now();
+    while (!stop_requested) {
+        for (std::size_t core_index = 0; core_index < NUM_CPU_CORES; ++core_index) {
+            Sample(core_index, walk_frames);
+        }
+        next_sample += interval;
+        stop_condition.wait_until(lock, next_sample, [this] { return stop_requested; });
+    }
+}
+
+void GuestProfiler::Sample(std::size_t core_index, bool walk_frames) {
+    // The cores keep running while they are sampled, the registers they last stored are read
+    Stack stack{core_index, false, active_svcs[core_index].load(std::memory_order_relaxed), {}};
+    if (system.CpuCore(core_index).Scheduler().GetCurrentThread() == nullptr) {
+        stack.is_idle = true;
+        ++samples[std::move(stack)];
+        ++sample_count;
+        return;
+    }
+
+    const ARM_Interface& arm_interface = system.ArmInterface(core_index);
+    stack.frames.push_back(arm_interface.GetPC());
+    if (walk_frames) {
+        // Return addresses are past the call, the call itself is attributed to the caller.
+        // Leaf functions may not push a frame record, their caller is only in the link register.
+        stack.frames.push_back(arm_interface.GetReg(30) - 4);
+
+        VAddr fp = arm_interface.GetReg(29);
+        while (fp != 0 && stack.frames.size() < MAX_FRAMES) {
+            const auto next_fp = ReadGuest<u64_le>(*process, fp);
+            const auto return_address = ReadGuest<u64_le>(*process, fp + 8);
+            if (!next_fp || !return_address) {
+                break;
+            }
+            const VAddr call_address = *return_address - 4;
+            if (stack.frames.size() != 2 || call_address != stack.frames.back()) {
+                stack.frames.push_back(call_address);
+            }
+            // The records of callers are at higher addresses, this also stops at loops
+            if (*next_fp <= fp) {
+                break;
+            }
+            fp = *next_fp;
+        }
+    }
+    ++samples[std::move(stack)];
+    ++sample_count;
+}
+
+std::string GuestProfiler::Symbolize(VAddr address) const {
+    std::lock_guard lock{modules_mutex};
+    auto module = std::upper_bound(
+        modules.begin(), modules.end(), address,
+        [](VAddr address, const Module& other) { return address < other.base; });
+    if (module == modules.begin() || address >= std::prev(module)->end) {
+        return fmt::format("0x{:016X}", address);
+    }
+    --module;
+
+    const auto& symbols = module->symbols;
+    const u64 offset = address - module->base;
+    auto symbol = std::upper_bound(
+        symbols.begin(), symbols.end(), offset,
+        [](u64 offset, const Loader::ModuleSymbol& other) { return offset < other.offset; });
+    if (symbol != symbols.begin()) {
+        --symbol;
+        if (symbol->size == 0 || offset < symbol->offset + symbol->size) {
+            return fmt::format("{}!{}", module->name, symbol->name);
+        }
+    }
+    return fmt::format("{}+0x{:X}", module->name, offset);
+}
+
+} // namespace Core
@@ -0,0 +1,109 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "core/core_cpu.h"
+#include "core/loader/symbols.h"
+
+namespace Kernel {
+class Process;
+}
+
+namespace Core {
+
+class System;
+
+/**
+ * Sampling profiler of the guest code run by the CPU cores. A host thread periodically captures
+ * the PC of each core and, optionally, the return addresses of its frame records, without
+ * stopping the cores. Samples taken while a core is in an SVC are attributed to the SVC, so HLE
+ * time can be told apart from guest time. The stacks are symbolized with the functions exported
+ * by the loaded modules and written in the folded format flame graph tools read.
+ */
+class GuestProfiler final {
+public:
+    explicit GuestProfiler(System& system);
+    ~GuestProfiler();
+
+    /// Registers a module mapped in the process. Its exported functions are read right away, since
+    /// modules loaded through ldr may be unmapped before the samples are symbolized.
+    void RegisterModule(const Kernel::Process& process, std::string name, VAddr base, VAddr end);
+
+    /// Starts sampling the cores of the current process every interval
+    void Start(std::chrono::microseconds interval, bool walk_frames);
+
+    /// Stops sampling, waiting for the sampling thread to exit
+    void Stop();
+
+    /// Records the SVC a core is executing, must be paired with ExitSVC
+    void EnterSVC(std::size_t core_index, const char* name) {
+        active_svcs[core_index].store(name, std::memory_order_relaxed);
+    }
+
+    void ExitSVC(std::size_t core_index) {
+        active_svcs[core_index].store(nullptr, std::memory_order_relaxed);
+    }
+
+    /// Writes the samples taken so far as folded stacks, one line per unique stack, root first.
+    /// Must not be called while sampling.
+    bool WriteFoldedStacks(const std::string& path) const;
+
+    /// Returns the number of samples taken so far
+    u64 GetSampleCount() const {
+        return sample_count;
+    }
+
+private:
+    struct Module {
+        std::string name;
+        VAddr base;
+        VAddr end;
+        std::vector<Loader::ModuleSymbol> symbols; ///< Sorted by offset
+    };
+
+    struct Stack {
+        std::size_t core_index;
+        bool is_idle;
+        const char* svc;           ///< SVC the core was executing, null in guest code
+        std::vector<VAddr> frames; ///< Leaf first
+
+        bool operator<(const Stack& rhs) const;
+    };
+
+    void SamplingLoop(std::chrono::microseconds interval, bool walk_frames);
+
+    void Sample(std::size_t core_index, bool walk_frames);
+
+    std::string Symbolize(VAddr address) const;
+
+    System& system;
+    const Kernel::Process* process = nullptr;
+
+    std::array<std::atomic<const char*>, NUM_CPU_CORES> active_svcs{};
+
+    mutable std::mutex modules_mutex;
+    std::vector<Module> modules; ///< Sorted by base address
+
+    std::map<Stack, u64> samples;
+    std::atomic<u64> sample_count{};
+
+    std::thread sampling_thread;
+    std::mutex stop_mutex;
+    std::condition_variable stop_condition;
+    bool stop_requested = false;
+};
+
+} // namespace Core
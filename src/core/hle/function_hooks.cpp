@@ -0,0 +1,152 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/hle/function_hooks.h"
+#include "core/hle/kernel/process.h"
+#include "core/loader/symbols.h"
+#include "core/memory.h"
+
+namespace HLE {
+
+namespace {
+
+constexpr u32 MakeSVC(u32 immediate) {
+    return 0xD4000001 | (immediate << 5);
+}
+
+constexpr u32 RET = 0xD65F03C0;
+
+/// Bytes replaced at the entry of a hooked function
+constexpr std::size_t HOOK_SIZE = 2 * sizeof(u32);
+
+// The host implementations must behave exactly like the C library functions, they read their
+// arguments from the registers and return the result in X0
+
+void Memcpy(Kernel::Process& process, Core::ARM_Interface& arm_interface) {
+    const VAddr dest = arm_interface.GetReg(0);
+    const VAddr src = arm_interface.GetReg(1);
+    const u64 size = arm_interface.GetReg(2);
+    Memory::CopyBlock(process, dest, src, size);
+}
+
+void Memmove(Kernel::Process& process, Core::ARM_Interface& arm_interface) {
+    const VAddr dest = arm_interface.GetReg(0);
+    const VAddr src = arm_interface.GetReg(1);
+    const u64 size = arm_interface.GetReg(2);
+    if (size == 0) {
+        return;
+    }
+    u8* const dest_pointer = Memory::GetContiguousPointer(process, dest, size);
+    const u8* const src_pointer = Memory::GetContiguousPointer(process, src, size);
+    if (dest_pointer != nullptr && src_pointer != nullptr) {
+        std::memmove(dest_pointer, src_pointer, size);
+        return;
+    }
+    // Ranges in cached GPU memory go through a copy, the block copy functions don't allow overlap
+    std::vector<u8> buffer(size);
+    Memory::ReadBlock(process, src, buffer.data(), size);
+    Memory::WriteBlock(process, dest, buffer.data(), size);
+}
+
+void Memset(Kernel::Process& process, Core::ARM_Interface& arm_interface) {
+    const VAddr dest = arm_interface.GetReg(0);
+    const u8 value = static_cast<u8>(arm_interface.GetReg(1));
+    const u64 size = arm_interface.GetReg(2);
+    if (u8* const pointer = Memory::GetContiguousPointer(process, dest, size)) {
+        std::memset(pointer, value, size);
+        return;
+    }
+    std::array<u8, Memory::PAGE_SIZE> buffer;
+    buffer.fill(value);
+    for (u64 offset = 0; offset < size; offset += buffer.size()) {
+        const u64 chunk_size = std::min<u64>(size - offset, buffer.size());
+        Memory::WriteBlock(process, dest + offset, buffer.data(), chunk_size);
+    }
+}
+
+void Strlen(Kernel::Process& process, Core::ARM_Interface& arm_interface) {
+    const VAddr string = arm_interface.GetReg(0);
+    u64 length = 0;
+    while (true) {
+        const VAddr addr = string + length;
+        const std::size_t page_left = Memory::PAGE_SIZE - (addr & Memory::PAGE_MASK);
+        if (const u8* const pointer = Memory::GetContiguousPointer(process, addr, page_left)) {
+            const void* const terminator = std::memchr(pointer, 0, page_left);
+            if (terminator != nullptr) {
+                length += static_cast<const u8*>(terminator) - pointer;
+                break;
+            }
+            length += page_left;
+            continue;
+        }
+        // Cached GPU memory is read a byte at a time, unmapped memory reads as a terminator
+        u8 c;
+        Memory::ReadBlock(process, addr, &c, sizeof(c));
+        if (c == 0) {
+            break;
+        }
+        ++length;
+    }
+    arm_interface.SetReg(0, length);
+}
+
+struct FunctionHook {
+    std::string_view name;
+    void (*function)(Kernel::Process& process, Core::ARM_Interface& arm_interface);
+};
+
+constexpr std::array<FunctionHook, 4> FUNCTION_HOOKS{{
+    {"memcpy", &Memcpy},
+    {"memmove", &Memmove},
+    {"memset", &Memset},
+    {"strlen", &Strlen},
+}};
+
+} // Anonymous namespace
+
+std::size_t HookModuleFunctions(std::vector<u8>& image, std::size_t text_offset,
+                                std::size_t text_size) {
+    std::size_t num_hooked = 0;
+    for (const auto& symbol : Loader::ReadModuleFunctions(image.data(), image.size())) {
+        const auto hook =
+            std::find_if(FUNCTION_HOOKS.begin(), FUNCTION_HOOKS.end(),
+                         [&symbol](const FunctionHook& hook) { return hook.name == symbol.name; });
+        if (hook == FUNCTION_HOOKS.end()) {
+            continue;
+        }
+        // Functions shorter than the hook would overwrite the next one
+        if (symbol.size < HOOK_SIZE || symbol.offset % sizeof(u32) != 0 ||
+            symbol.offset < text_offset || symbol.offset + HOOK_SIZE > text_offset + text_size) {
+            LOG_WARNING(Loader, "Not hooking {} at offset 0x{:X} with size {}", symbol.name,
+                        symbol.offset, symbol.size);
+            continue;
+        }
+
+        const u32 index = static_cast<u32>(std::distance(FUNCTION_HOOKS.begin(), hook));
+        const std::array<u32_le, 2> code{MakeSVC(FUNCTION_HOOK_SVC_BASE + index), RET};
+        std::memcpy(image.data() + symbol.offset, code.data(), HOOK_SIZE);
+        LOG_DEBUG(Loader, "Hooked {} at offset 0x{:X}", symbol.name, symbol.offset);
+        ++num_hooked;
+    }
+    return num_hooked;
+}
+
+void CallFunctionHook(Core::System& system, Core::ARM_Interface& arm_interface, u32 immediate) {
+    const u32 index = immediate - FUNCTION_HOOK_SVC_BASE;
+    ASSERT_MSG(index < FUNCTION_HOOKS.size(), "Invalid function hook {}", index);
+    FUNCTION_HOOKS[index].function(*system.CurrentProcess(), arm_interface);
+}
+
+} // namespace HLE
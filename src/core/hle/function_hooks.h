@@ -0,0 +1,37 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+class ARM_Interface;
+class System;
+} // namespace Core
+
+namespace HLE {
+
+/// SVC immediates from this one on call the host implementation of a hooked guest function, the
+/// kernel only has SVCs below 0x80
+constexpr u32 FUNCTION_HOOK_SVC_BASE = 0x8000;
+
+/**
+ * Redirects the C library functions exported by a module, such as memcpy, to host
+ * implementations. The first two instructions of a hooked function are replaced by an SVC that
+ * runs the host implementation and a return.
+ * @param image Image of the module, patched before it is mapped
+ * @param text_offset Offset of the text segment in the image
+ * @param text_size Size of the text segment, functions outside of it are not hooked
+ * @returns The number of hooked functions
+ */
+std::size_t HookModuleFunctions(std::vector<u8>& image, std::size_t text_offset,
+                                std::size_t text_size);
+
+/// Runs the host implementation of the hooked function an SVC immediate was assigned to
+void CallFunctionHook(Core::System& system, Core::ARM_Interface& arm_interface, u32 immediate);
+
+} // namespace HLE
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 #include "common/assert.h"
@@ -19,25 +21,6 @@
 #include "core/memory.h"
 
 namespace Kernel {
-namespace {
-// Wake up num_to_wake (or all) threads in a vector.
-void WakeThreads(const std::vector<SharedPtr<Thread>>& waiting_threads, s32 num_to_wake) {
-    // Only process up to 'target' threads, unless 'target' is <= 0, in which case process
-    // them all.
-    std::size_t last = waiting_threads.size();
-    if (num_to_wake > 0) {
-        last = std::min(last, static_cast<std::size_t>(num_to_wake));
-    }
-
-    // Signal the waiting threads.
-    for (std::size_t i = 0; i < last; i++) {
-        ASSERT(waiting_threads[i]->GetStatus() == ThreadStatus::WaitArb);
-        waiting_threads[i]->SetWaitSynchronizationResult(RESULT_SUCCESS);
-        waiting_threads[i]->SetArbiterWaitAddress(0);
-        waiting_threads[i]->ResumeFromWait();
-    }
-}
-} // Anonymous namespace
 
 AddressArbiter::AddressArbiter(Core::System& system) : system{system} {}
 AddressArbiter::~AddressArbiter() = default;
@@ -57,8 +40,7 @@ ResultCode AddressArbiter::SignalToAddress(VAddr address, SignalType type, s32 v
 }
 
 ResultCode AddressArbiter::SignalToAddressOnly(VAddr address, s32 num_to_wake) {
-    const std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
-    WakeThreads(waiting_threads, num_to_wake);
+    WakeThreads(address, num_to_wake);
     return RESULT_SUCCESS;
 }
 
@@ -84,14 +66,12 @@ ResultCode AddressArbiter::ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr a
         return ERR_INVALID_ADDRESS_STATE;
     }
 
-    // Get threads waiting on the address.
-    const std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
-
     // Determine the modified value depending on the waiting count.
+    const std::size_t waiting_count = GetWaitingThreadCount(address);
     s32 updated_value;
-    if (waiting_threads.empty()) {
+    if (waiting_count == 0) {
         updated_value = value + 1;
-    } else if (num_to_wake <= 0 || waiting_threads.size() <= static_cast<u32>(num_to_wake)) {
+    } else if (num_to_wake <= 0 || waiting_count <= static_cast<u32>(num_to_wake)) {
         updated_value = value - 1;
     } else {
         updated_value = value;
@@ -102,7 +82,7 @@ ResultCode AddressArbiter::ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr a
     }
 
     Memory::Write32(address, static_cast<u32>(updated_value));
-    WakeThreads(waiting_threads, num_to_wake);
+    WakeThreads(address, num_to_wake);
     return RESULT_SUCCESS;
 }
 
@@ -166,6 +146,7 @@ ResultCode AddressArbiter::WaitForAddressImpl(VAddr address, s64 timeout) {
     current_thread->SetArbiterWaitAddress(address);
     current_thread->SetStatus(ThreadStatus::WaitArb);
     current_thread->InvalidateWakeupCallback();
+    InsertWaitingThread(current_thread);
 
     current_thread->WakeAfterDelay(timeout);
 
@@ -173,33 +154,68 @@ ResultCode AddressArbiter::WaitForAddressImpl(VAddr address, s64 timeout) {
     return RESULT_TIMEOUT;
 }
 
-std::vector<SharedPtr<Thread>> AddressArbiter::GetThreadsWaitingOnAddress(VAddr address) const {
-    const auto RetrieveWaitingThreads = [this](std::size_t core_index,
-                                               std::vector<SharedPtr<Thread>>& waiting_threads,
-                                               VAddr arb_addr) {
-        const auto& scheduler = system.Scheduler(core_index);
-        const auto& thread_list = scheduler.GetThreadList();
-
-        for (const auto& thread : thread_list) {
-            if (thread->GetArbiterWaitAddress() == arb_addr) {
-                waiting_threads.push_back(thread);
-            }
-        }
-    };
-
-    // Retrieve all threads that are waiting for this address.
-    std::vector<SharedPtr<Thread>> threads;
-    RetrieveWaitingThreads(0, threads, address);
-    RetrieveWaitingThreads(1, threads, address);
-    RetrieveWaitingThreads(2, threads, address);
-    RetrieveWaitingThreads(3, threads, address);
-
-    // Sort them by priority, such that the highest priority ones come first.
-    std::sort(threads.begin(), threads.end(),
-              [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
-                  return lhs->GetPriority() < rhs->GetPriority();
-              });
-
-    return threads;
+void AddressArbiter::RemoveWaitingThread(const Thread& thread) {
+    const auto queue = waiting_threads.find(thread.GetArbiterWaitAddress());
+    ASSERT(queue != waiting_threads.end());
+
+    auto& threads = queue->second;
+    const auto it = std::find(threads.begin(), threads.end(), &thread);
+    ASSERT(it != threads.end());
+    threads.erase(it);
+    if (threads.empty()) {
+        waiting_threads.erase(queue);
+    }
+}
+
+void AddressArbiter::UpdateWaitingThreadPriority(SharedPtr<Thread> thread) {
+    RemoveWaitingThread(*thread);
+    InsertWaitingThread(std::move(thread));
+}
+
+void AddressArbiter::WakeThreads(VAddr address, s32 num_to_wake) {
+    const auto queue = waiting_threads.find(address);
+    if (queue == waiting_threads.end()) {
+        return;
+    }
+
+    // Only process up to 'target' threads, unless 'target' is <= 0, in which case process
+    // them all.
+    auto& threads = queue->second;
+    std::size_t last = threads.size();
+    if (num_to_wake > 0) {
+        last = std::min(last, static_cast<std::size_t>(num_to_wake));
+    }
+
+    // Take the threads out of the queue before waking them up, resuming a thread can reschedule
+    std::vector<SharedPtr<Thread>> woken_threads(std::make_move_iterator(threads.begin()),
+                                                 std::make_move_iterator(threads.begin() + last));
+    threads.erase(threads.begin(), threads.begin() + last);
+    if (threads.empty()) {
+        waiting_threads.erase(queue);
+    }
+
+    // Signal the waiting threads.
+    for (const auto& thread : woken_threads) {
+        ASSERT(thread->GetStatus() == ThreadStatus::WaitArb);
+        thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+        thread->SetArbiterWaitAddress(0);
+        thread->ResumeFromWait();
+    }
+}
+
+std::size_t AddressArbiter::GetWaitingThreadCount(VAddr address) const {
+    const auto queue = waiting_threads.find(address);
+    return queue == waiting_threads.end() ? 0 : queue->second.size();
+}
+
+void AddressArbiter::InsertWaitingThread(SharedPtr<Thread> thread) {
+    auto& threads = waiting_threads[thread->GetArbiterWaitAddress()];
+
+    // Threads of the same priority are woken up in the order they started waiting
+    const u32 priority = thread->GetPriority();
+    const auto it = std::find_if(threads.begin(), threads.end(), [priority](const auto& entry) {
+        return entry->GetPriority() > priority;
+    });
+    threads.insert(it, std::move(thread));
 }
 } // namespace Kernel
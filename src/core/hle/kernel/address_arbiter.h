@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 #include "common/common_types.h"
@@ -48,6 +49,12 @@ public:
     /// Waits on an address with a particular arbitration type.
     ResultCode WaitForAddress(VAddr address, ArbitrationType type, s32 value, s64 timeout_ns);
 
+    /// Removes a thread that stopped waiting without being signaled, on timeout or termination.
+    void RemoveWaitingThread(const Thread& thread);
+
+    /// Moves a waiting thread to its new position after its priority changed.
+    void UpdateWaitingThreadPriority(SharedPtr<Thread> thread);
+
 private:
     /// Signals an address being waited on.
     ResultCode SignalToAddressOnly(VAddr address, s32 num_to_wake);
@@ -71,8 +78,18 @@ private:
     // Waits on the given address with a timeout in nanoseconds
     ResultCode WaitForAddressImpl(VAddr address, s64 timeout);
 
-    // Gets the threads waiting on an address.
-    std::vector<SharedPtr<Thread>> GetThreadsWaitingOnAddress(VAddr address) const;
+    // Wakes up num_to_wake (or all) threads waiting on an address, highest priority first.
+    void WakeThreads(VAddr address, s32 num_to_wake);
+
+    // Gets the number of threads waiting on an address.
+    std::size_t GetWaitingThreadCount(VAddr address) const;
+
+    // Inserts a thread into the queue of the address it waits on, keeping it sorted by priority.
+    void InsertWaitingThread(SharedPtr<Thread> thread);
+
+    /// Threads waiting on each address, the highest priority ones come first. Addresses without
+    /// waiters are erased, so signaling and waiting only touch the threads of a single address.
+    std::unordered_map<VAddr, std::vector<SharedPtr<Thread>>> waiting_threads;
 
     Core::System& system;
 };
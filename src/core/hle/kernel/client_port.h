@@ -7,6 +7,7 @@
 #include <string>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/result.h"
 
 namespace Kernel {
@@ -15,7 +16,7 @@ class ClientSession;
 class KernelCore;
 class ServerPort;
 
-class ClientPort final : public Object {
+class ClientPort final : public Object, public SlabAllocated<ClientPort> {
 public:
     friend class ServerPort;
     std::string GetTypeName() const override {
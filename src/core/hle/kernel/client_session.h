@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 
 union ResultCode;
 
@@ -17,7 +18,7 @@ class Session;
 class ServerSession;
 class Thread;
 
-class ClientSession final : public Object {
+class ClientSession final : public Object, public SlabAllocated<ClientSession> {
 public:
     friend class ServerSession;
 
@@ -12,15 +12,6 @@
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
-namespace {
-constexpr u16 GetSlot(Handle handle) {
-    return static_cast<u16>(handle >> 15);
-}
-
-constexpr u16 GetGeneration(Handle handle) {
-    return static_cast<u16>(handle & 0x7FFF);
-}
-} // Anonymous namespace
 
 HandleTable::HandleTable() {
     Clear();
@@ -62,8 +53,10 @@ ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
         next_generation = 1;
     }
 
+    const u32 tag = generation | (static_cast<u32>(obj->GetHandleType()) << TAG_TYPE_SHIFT);
     generations[slot] = generation;
     objects[slot] = std::move(obj);
+    tags[slot].store(tag, std::memory_order_release);
 
     Handle handle = generation | (slot << 15);
     return MakeResult<Handle>(handle);
@@ -85,6 +78,7 @@ ResultCode HandleTable::Close(Handle handle) {
 
     const u16 slot = GetSlot(handle);
 
+    tags[slot].store(0, std::memory_order_release);
     objects[slot] = nullptr;
 
     generations[slot] = next_free_slot;
@@ -93,10 +87,7 @@ ResultCode HandleTable::Close(Handle handle) {
 }
 
 bool HandleTable::IsValid(Handle handle) const {
-    const std::size_t slot = GetSlot(handle);
-    const u16 generation = GetGeneration(handle);
-
-    return slot < table_size && objects[slot] != nullptr && generations[slot] == generation;
+    return LoadTag(handle) != 0;
 }
 
 SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
@@ -114,6 +105,7 @@ SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
 
 void HandleTable::Clear() {
     for (u16 i = 0; i < table_size; ++i) {
+        tags[i].store(0, std::memory_order_release);
         generations[i] = i + 1;
         objects[i] = nullptr;
     }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
@@ -40,6 +41,11 @@ enum KernelHandle : Handle {
  * is destroyed, it is again pushed onto the list to be re-used by the next allocation. It is
  * likely that this allocation strategy differs from the one used in CTR-OS, but this hasn't been
  * verified and isn't likely to cause any problems.
+ *
+ * Every slot also has a tag packing its generation with the handle type of its object, so typed
+ * lookups are a single load and compare instead of a virtual call. Lookups don't lock, tags are
+ * published after their object and cleared before it, so lookups can run alongside the creation
+ * and closing of other handles.
  */
 class HandleTable final : NonCopyable {
 public:
@@ -101,13 +107,41 @@ public:
      */
     template <class T>
     SharedPtr<T> Get(Handle handle) const {
-        return DynamicObjectCast<T>(GetGeneric(handle));
+        if (handle == CurrentThread || handle == CurrentProcess) {
+            return DynamicObjectCast<T>(GetGeneric(handle));
+        }
+        const u32 tag = LoadTag(handle);
+        if (tag == 0 || !IsHandleTypeOf<T>(static_cast<HandleType>(tag >> TAG_TYPE_SHIFT))) {
+            return nullptr;
+        }
+        return SharedPtr<T>(static_cast<T*>(objects[GetSlot(handle)].get()));
     }
 
     /// Closes all handles held in this table.
     void Clear();
 
 private:
+    /// The handle type of the object is stored above the generation in the tags
+    static constexpr u32 TAG_TYPE_SHIFT = 16;
+
+    static constexpr u16 GetSlot(Handle handle) {
+        return static_cast<u16>(handle >> 15);
+    }
+
+    static constexpr u16 GetGeneration(Handle handle) {
+        return static_cast<u16>(handle & 0x7FFF);
+    }
+
+    /// Returns the tag of the slot of a valid handle, or zero if the handle is not valid.
+    u32 LoadTag(Handle handle) const {
+        const u16 slot = GetSlot(handle);
+        if (slot >= table_size) {
+            return 0;
+        }
+        const u32 tag = tags[slot].load(std::memory_order_acquire);
+        return (tag & 0x7FFF) == GetGeneration(handle) ? tag : 0;
+    }
+
     /// Stores the Object referenced by the handle or null if the slot is empty.
     std::array<SharedPtr<Object>, MAX_COUNT> objects;
 
@@ -117,6 +151,9 @@ private:
      */
     std::array<u16, MAX_COUNT> generations;
 
+    /// Generation and handle type of the object of each slot, zero if the slot is empty.
+    std::array<std::atomic<u32>, MAX_COUNT> tags{};
+
     /**
      * The limited size of the handle table. This can be specified by process
      * capabilities in order to restrict the overall number of handles that
@@ -214,6 +214,12 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(Thread& thread) {
     auto& owner_process = *thread.GetOwnerProcess();
     auto& handle_table = owner_process.GetHandleTable();
 
+    for (const PendingWrite& write : pending_writes) {
+        const Common::PooledVector& scratch = scratch_buffers[write.scratch_index];
+        Memory::WriteBlock(owner_process, write.address, scratch.data(), scratch.size());
+    }
+    pending_writes.clear();
+
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> dst_cmdbuf;
     Memory::ReadBlock(owner_process, thread.GetTLSAddress(), dst_cmdbuf.data(),
                       dst_cmdbuf.size() * sizeof(u32));
@@ -295,6 +301,23 @@ std::vector<u8> HLERequestContext::ReadBuffer(int buffer_index) const {
     return buffer;
 }
 
+BufferSpan<const u8> HLERequestContext::ReadBufferSpan(int buffer_index) const {
+    const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
+    const VAddr address{is_buffer_a ? BufferDescriptorA()[buffer_index].Address()
+                                    : BufferDescriptorX()[buffer_index].Address()};
+    const std::size_t size{GetReadBufferSize(buffer_index)};
+    if (size == 0) {
+        return {};
+    }
+    const Process& process{*Core::CurrentProcess()};
+    if (const u8* const pointer = Memory::GetContiguousPointer(process, address, size)) {
+        return {pointer, size};
+    }
+    Common::PooledVector& scratch = AcquireScratchBuffer(size);
+    Memory::ReadBlock(address, scratch.data(), size);
+    return {scratch.data(), size};
+}
+
 std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
                                            int buffer_index) const {
     if (size == 0) {
@@ -319,6 +342,25 @@ std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
     return size;
 }
 
+BufferSpan<u8> HLERequestContext::WriteBufferSpan(int buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() && BufferDescriptorB()[buffer_index].Size()};
+    const VAddr address{is_buffer_b ? BufferDescriptorB()[buffer_index].Address()
+                                    : BufferDescriptorC()[buffer_index].Address()};
+    const std::size_t size{GetWriteBufferSize(buffer_index)};
+    if (size == 0) {
+        return {};
+    }
+    const Process& process{*Core::CurrentProcess()};
+    if (u8* const pointer = Memory::GetContiguousPointer(process, address, size)) {
+        return {pointer, size};
+    }
+    // Start from the guest contents, so the bytes the service doesn't write are left untouched
+    Common::PooledVector& scratch = AcquireScratchBuffer(size);
+    Memory::ReadBlock(address, scratch.data(), size);
+    pending_writes.push_back({address, scratch_buffers.size() - 1});
+    return {scratch.data(), size};
+}
+
 std::size_t HLERequestContext::GetReadBufferSize(int buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
     return is_buffer_a ? BufferDescriptorA()[buffer_index].Size()
@@ -331,6 +373,10 @@ std::size_t HLERequestContext::GetWriteBufferSize(int buffer_index) const {
                        : BufferDescriptorC()[buffer_index].Size();
 }
 
+Common::PooledVector& HLERequestContext::AcquireScratchBuffer(std::size_t size) const {
+    return scratch_buffers.emplace_back(Common::BufferPool::Acquire(size));
+}
+
 std::string HLERequestContext::Description() const {
     if (!command_header) {
         return "No command header available";
@@ -11,6 +11,8 @@
 #include <type_traits>
 #include <vector>
 #include <boost/container/small_vector.hpp>
+#include <boost/container/static_vector.hpp>
+#include "common/buffer_pool.h"
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
@@ -35,6 +37,46 @@ class WritableEvent;
 
 enum class ThreadWakeupReason;
 
+/**
+ * View of a buffer of an IPC request. It points directly into guest memory when the buffer is
+ * contiguous on the host, otherwise into a scratch buffer owned by the request context. Views are
+ * valid until the request context is destroyed.
+ */
+template <typename T>
+class BufferSpan {
+public:
+    constexpr BufferSpan() = default;
+    constexpr BufferSpan(T* data, std::size_t size) : data_{data}, size_{size} {}
+
+    constexpr T* data() const {
+        return data_;
+    }
+
+    constexpr std::size_t size() const {
+        return size_;
+    }
+
+    constexpr bool empty() const {
+        return size_ == 0;
+    }
+
+    constexpr T* begin() const {
+        return data_;
+    }
+
+    constexpr T* end() const {
+        return data_ + size_;
+    }
+
+    constexpr T& operator[](std::size_t index) const {
+        return data_[index];
+    }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
 /**
  * Interface implemented by HLE Session handlers.
  * This can be provided to a ServerSession in order to hook into several relevant events
@@ -97,6 +139,10 @@ protected:
  */
 class HLERequestContext {
 public:
+    /// Descriptor lists are stored in the context, the command header has room for 15 of each
+    template <typename T>
+    using DescriptorList = boost::container::static_vector<T, 15>;
+
     explicit HLERequestContext(SharedPtr<ServerSession> session, SharedPtr<Thread> thread);
     ~HLERequestContext();
 
@@ -152,19 +198,19 @@ public:
         return data_payload_offset;
     }
 
-    const std::vector<IPC::BufferDescriptorX>& BufferDescriptorX() const {
+    const DescriptorList<IPC::BufferDescriptorX>& BufferDescriptorX() const {
         return buffer_x_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
+    const DescriptorList<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
         return buffer_a_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
+    const DescriptorList<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
         return buffer_b_desciptors;
     }
 
-    const std::vector<IPC::BufferDescriptorC>& BufferDescriptorC() const {
+    const DescriptorList<IPC::BufferDescriptorC>& BufferDescriptorC() const {
         return buffer_c_desciptors;
     }
 
@@ -179,9 +225,19 @@ public:
     /// Helper function to read a buffer using the appropriate buffer descriptor
     std::vector<u8> ReadBuffer(int buffer_index = 0) const;
 
+    /// Helper function to view an input buffer without copying it when possible
+    BufferSpan<const u8> ReadBufferSpan(int buffer_index = 0) const;
+
     /// Helper function to write a buffer using the appropriate buffer descriptor
     std::size_t WriteBuffer(const void* buffer, std::size_t size, int buffer_index = 0) const;
 
+    /**
+     * Helper function to write an output buffer in place. The view covers the whole buffer and
+     * starts with its current contents. Writes reach guest memory directly or, when the buffer is
+     * not contiguous on the host, when the response is written.
+     */
+    BufferSpan<u8> WriteBufferSpan(int buffer_index = 0) const;
+
     /* Helper function to write a buffer using the appropriate buffer descriptor
      *
      * @tparam ContiguousContainer an arbitrary container that satisfies the
@@ -232,12 +288,13 @@ public:
 
     template <typename T>
     std::shared_ptr<T> GetDomainRequestHandler(std::size_t index) const {
-        return std::static_pointer_cast<T>(domain_request_handlers.at(index));
+        return std::static_pointer_cast<T>(domain_request_handlers->at(index));
     }
 
+    /// Sets the handlers of the domain, the list is owned by the session of the request
     void SetDomainRequestHandlers(
         const std::vector<std::shared_ptr<SessionRequestHandler>>& handlers) {
-        domain_request_handlers = handlers;
+        domain_request_handlers = &handlers;
     }
 
     /// Clears the list of objects so that no lingering objects are written accidentally to the
@@ -265,6 +322,9 @@ public:
 private:
     void ParseCommandBuffer(const HandleTable& handle_table, u32_le* src_cmdbuf, bool incoming);
 
+    /// Returns a scratch buffer of the given size from the buffer pool
+    Common::PooledVector& AcquireScratchBuffer(std::size_t size) const;
+
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     SharedPtr<Kernel::ServerSession> server_session;
     SharedPtr<Thread> thread;
@@ -277,17 +337,26 @@ private:
     std::optional<IPC::HandleDescriptorHeader> handle_descriptor_header;
     std::optional<IPC::DataPayloadHeader> data_payload_header;
     std::optional<IPC::DomainMessageHeader> domain_message_header;
-    std::vector<IPC::BufferDescriptorX> buffer_x_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_a_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_b_desciptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_w_desciptors;
-    std::vector<IPC::BufferDescriptorC> buffer_c_desciptors;
+    DescriptorList<IPC::BufferDescriptorX> buffer_x_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_a_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_b_desciptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_w_desciptors;
+    DescriptorList<IPC::BufferDescriptorC> buffer_c_desciptors;
 
     unsigned data_payload_offset{};
     unsigned buffer_c_offset{};
     u32_le command{};
 
-    std::vector<std::shared_ptr<SessionRequestHandler>> domain_request_handlers;
+    const std::vector<std::shared_ptr<SessionRequestHandler>>* domain_request_handlers{};
+
+    /// Output buffer backed by a scratch buffer, copied to guest memory with the response
+    struct PendingWrite {
+        VAddr address;
+        std::size_t scratch_index;
+    };
+
+    mutable std::vector<Common::PooledVector> scratch_buffers;
+    mutable std::vector<PendingWrite> pending_writes;
 };
 
 } // namespace Kernel
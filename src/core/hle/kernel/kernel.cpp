@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <utility>
@@ -14,17 +16,54 @@
 #include "core/core_timing.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/readable_event.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/transfer_memory.h"
+#include "core/hle/kernel/writable_event.h"
 #include "core/hle/lock.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
 
 namespace Kernel {
 
+/// Grows the slab heap of an object type to hold the objects allowed by a resource limit
+template <typename T>
+static void ReserveSlabHeap(const ResourceLimit& resource_limit, ResourceType resource) {
+    T::GetSlabHeap().Reserve(
+        static_cast<std::size_t>(resource_limit.GetMaxResourceValue(resource)));
+}
+
+/// Logs the objects of a type that are still alive, they were leaked once the kernel is shut down
+template <typename T>
+static void LogLiveObjects(const char* type_name) {
+    const std::size_t count = T::GetSlabHeap().GetAllocatedCount();
+    if (count != 0) {
+        LOG_DEBUG(Kernel, "{} {} objects are still alive", count, type_name);
+    }
+}
+
+/// Logs the SVCs that took the longest, to find the ones worth optimizing for a title
+static void LogSVCStatistics() {
+    constexpr std::size_t max_logged_svcs = 20;
+    const auto statistics = GetSVCStatistics();
+    for (std::size_t i = 0; i < std::min(statistics.size(), max_logged_svcs); ++i) {
+        const auto& svc = statistics[i];
+        LOG_INFO(Kernel_SVC, "{} (0x{:02X}) was called {} times and took {} us in total",
+                 svc.name, svc.id, svc.call_count,
+                 std::chrono::duration_cast<std::chrono::microseconds>(svc.total_time).count());
+    }
+    ResetSVCStatistics();
+}
+
 /**
  * Callback that will wake up the thread it was scheduled for
  * @param thread_handle The handle of the thread that's been awoken
@@ -79,6 +118,7 @@ static void ThreadWakeupCallback(u64 thread_handle, [[maybe_unused]] s64 cycles_
 
     if (thread->GetArbiterWaitAddress() != 0) {
         ASSERT(thread->GetStatus() == ThreadStatus::WaitArb);
+        thread->GetOwnerProcess()->GetAddressArbiter().RemoveWaitingThread(*thread);
         thread->SetArbiterWaitAddress(0);
     }
 
@@ -124,6 +164,15 @@ struct KernelCore::Impl {
         ASSERT(system_resource_limit->SetLimitValue(ResourceType::Events, 700).IsSuccess());
         ASSERT(system_resource_limit->SetLimitValue(ResourceType::TransferMemory, 200).IsSuccess());
         ASSERT(system_resource_limit->SetLimitValue(ResourceType::Sessions, 900).IsSuccess());
+
+        // Size the slab heaps like Horizon does, so the objects of a type start out contiguous
+        const auto& limit = *system_resource_limit;
+        ReserveSlabHeap<Thread>(limit, ResourceType::Threads);
+        ReserveSlabHeap<ReadableEvent>(limit, ResourceType::Events);
+        ReserveSlabHeap<WritableEvent>(limit, ResourceType::Events);
+        ReserveSlabHeap<TransferMemory>(limit, ResourceType::TransferMemory);
+        ReserveSlabHeap<ServerSession>(limit, ResourceType::Sessions);
+        ReserveSlabHeap<ClientSession>(limit, ResourceType::Sessions);
     }
 
     void InitializeThreads() {
@@ -165,6 +214,18 @@ void KernelCore::Initialize() {
 
 void KernelCore::Shutdown() {
     impl->Shutdown();
+
+    LogSVCStatistics();
+
+    LogLiveObjects<Thread>("Thread");
+    LogLiveObjects<ReadableEvent>("ReadableEvent");
+    LogLiveObjects<WritableEvent>("WritableEvent");
+    LogLiveObjects<ServerSession>("ServerSession");
+    LogLiveObjects<ClientSession>("ClientSession");
+    LogLiveObjects<ServerPort>("ServerPort");
+    LogLiveObjects<ClientPort>("ClientPort");
+    LogLiveObjects<SharedMemory>("SharedMemory");
+    LogLiveObjects<TransferMemory>("TransferMemory");
 }
 
 SharedPtr<ResourceLimit> KernelCore::GetSystemResourceLimit() const {
@@ -12,7 +12,11 @@ Object::Object(KernelCore& kernel) : kernel{kernel}, object_id{kernel.CreateNewO
 Object::~Object() = default;
 
 bool Object::IsWaitable() const {
-    switch (GetHandleType()) {
+    return IsWaitableHandleType(GetHandleType());
+}
+
+bool IsWaitableHandleType(HandleType handle_type) {
+    switch (handle_type) {
     case HandleType::ReadableEvent:
     case HandleType::Thread:
     case HandleType::Process:
@@ -87,6 +87,15 @@ inline void intrusive_ptr_release(Object* object) {
 template <typename T>
 using SharedPtr = boost::intrusive_ptr<T>;
 
+/// Returns true when objects of the given handle type can be waited on
+bool IsWaitableHandleType(HandleType handle_type);
+
+/// Returns true when an object with the given handle type can be cast to T
+template <typename T>
+constexpr bool IsHandleTypeOf(HandleType handle_type) {
+    return handle_type == T::HANDLE_TYPE;
+}
+
 /**
  * Attempts to downcast the given Object pointer to a pointer to T.
  * @return Derived pointer to the object, or `nullptr` if `object` isn't of type T.
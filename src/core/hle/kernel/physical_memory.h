@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+#include "common/virtual_buffer.h"
+
+namespace Kernel {
+
+/**
+ * Allocator of the memory blocks of the guest. Blocks are zero-initialized on allocation, so the
+ * elements that containers construct without a value are left untouched instead of being written.
+ *
+ * A reservation allocator only reserves the address space of its allocations. Its owner commits
+ * the pages before they are used and reports them as guest memory, which lets the heap reserve
+ * its whole region without taking memory for it.
+ */
+class PhysicalMemoryAllocator {
+public:
+    using value_type = u8;
+
+    template <typename U>
+    struct rebind {
+        static_assert(std::is_same_v<U, u8>, "Guest memory is only allocated as bytes");
+        using other = PhysicalMemoryAllocator;
+    };
+
+    PhysicalMemoryAllocator() = default;
+
+    explicit PhysicalMemoryAllocator(bool is_reservation) : is_reservation{is_reservation} {}
+
+    u8* allocate(std::size_t count) {
+        if (is_reservation) {
+            return static_cast<u8*>(Common::ReserveMemoryPages(count));
+        }
+        auto* const pointer = static_cast<u8*>(std::calloc(count, 1));
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        Common::MemoryAccounting::Allocate(Common::MemoryAccounting::Category::GuestMemory,
+                                           count);
+        return pointer;
+    }
+
+    void deallocate(u8* pointer, std::size_t count) {
+        if (is_reservation) {
+            Common::FreeMemoryPages(pointer, count);
+            return;
+        }
+        std::free(pointer);
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Category::GuestMemory, count);
+    }
+
+    /// Default-initializes the element, which keeps the zeroes of the allocation
+    template <typename U>
+    void construct(U* pointer) noexcept {
+        ::new (static_cast<void*>(pointer)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* pointer, Args&&... args) {
+        ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+    }
+
+    bool operator==(const PhysicalMemoryAllocator& other) const noexcept {
+        return is_reservation == other.is_reservation;
+    }
+
+    bool operator!=(const PhysicalMemoryAllocator& other) const noexcept {
+        return !operator==(other);
+    }
+
+private:
+    bool is_reservation = false;
+};
+
+/// Host memory backing the memory blocks mapped into processes. Zero-initialized elements are
+/// never written, so resizing a block doesn't touch its memory.
+using PhysicalMemory = std::vector<u8, PhysicalMemoryAllocator>;
+
+} // namespace Kernel
@@ -100,6 +100,11 @@ public:
         return vm_manager;
     }
 
+    /// Gets the system the process runs in.
+    Core::System& GetSystem() const {
+        return system;
+    }
+
     /// Gets a reference to the process' handle table.
     HandleTable& GetHandleTable() {
         return handle_table;
@@ -28,7 +28,13 @@ void ReadableEvent::Acquire(Thread* thread) {
 
 void ReadableEvent::Signal() {
     signaled = true;
-    WakeupAllWaitingThreads();
+
+    // Acquiring an automatic reset event clears it, only the first waiter can be woken up
+    if (reset_type == ResetType::Automatic) {
+        WakeupHighestPriorityThread();
+    } else {
+        WakeupAllWaitingThreads();
+    }
 }
 
 void ReadableEvent::Clear() {
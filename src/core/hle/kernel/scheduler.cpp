@@ -17,10 +17,8 @@
 
 namespace Kernel {
 
-std::mutex Scheduler::scheduler_mutex;
-
-Scheduler::Scheduler(Core::System& system, Core::ARM_Interface& cpu_core)
-    : cpu_core{cpu_core}, system{system} {}
+Scheduler::Scheduler(Core::System& system, Core::ARM_Interface& cpu_core, u32 core_id)
+    : cpu_core{cpu_core}, system{system}, core_id{core_id} {}
 
 Scheduler::~Scheduler() {
     for (auto& thread : thread_list) {
@@ -29,8 +27,7 @@ Scheduler::~Scheduler() {
 }
 
 bool Scheduler::HaveReadyThreads() const {
-    std::lock_guard lock{scheduler_mutex};
-    return !ready_queue.empty();
+    return has_ready_threads.load(std::memory_order_acquire);
 }
 
 Thread* Scheduler::GetCurrentThread() const {
@@ -71,6 +68,15 @@ void Scheduler::SwitchContext(Thread* new_thread) {
 
     UpdateLastContextSwitchTime(previous_thread, previous_process);
 
+    // The running thread is picked again when no ready thread has a higher priority, which is the
+    // case of most reschedules. Its context is still loaded in the CPU core, only the exclusive
+    // monitor is cleared like on any other reschedule.
+    if (new_thread != nullptr && new_thread == previous_thread &&
+        new_thread->GetStatus() == ThreadStatus::Running) {
+        cpu_core.ClearExclusiveState();
+        return;
+    }
+
     // Save context for previous thread
     if (previous_thread) {
         cpu_core.SaveContext(previous_thread->GetContext());
@@ -130,7 +136,46 @@ void Scheduler::UpdateLastContextSwitchTime(Thread* thread, Process* process) {
     last_context_switch_time = most_recent_switch_ticks;
 }
 
+void Scheduler::StealThread() {
+    for (u32 core = 0; core < Core::NUM_CPU_CORES; ++core) {
+        if (core == core_id) {
+            continue;
+        }
+        Scheduler& source = system.Scheduler(core);
+        if (!source.HaveReadyThreads()) {
+            continue;
+        }
+
+        // The thread is moved with both schedulers locked, it is never out of a ready queue
+        const auto locks = LockSchedulers(*this, source);
+
+        // The ready queue is iterated in priority order, so the first match is the best candidate.
+        const u64 mask = 1ULL << core_id;
+        const auto itr = std::find_if(source.ready_queue.begin(), source.ready_queue.end(),
+                                      [mask](Thread* thread) {
+                                          return (thread->GetAffinityMask() & mask) != 0;
+                                      });
+        if (itr == source.ready_queue.end()) {
+            continue;
+        }
+
+        Thread* const thread = *itr;
+        LOG_TRACE(Kernel, "core {} took thread {} from core {}", core_id, thread->GetObjectId(),
+                  core);
+        MoveReadyThread(thread, source, *this);
+        return;
+    }
+}
+
 void Scheduler::Reschedule() {
+    // An idle core takes over work from the other cores before picking its next thread. This
+    // locks the scheduler of the other core along with ours, so it happens before taking our lock.
+    const Thread* const current = GetCurrentThread();
+    const bool is_idling = current == nullptr || current->GetStatus() != ThreadStatus::Running;
+    if (is_idling && !HaveReadyThreads()) {
+        StealThread();
+    }
+
     std::lock_guard lock{scheduler_mutex};
 
     Thread* cur = GetCurrentThread();
@@ -145,6 +190,7 @@ void Scheduler::Reschedule() {
     }
 
     SwitchContext(next);
+    has_ready_threads.store(!ready_queue.empty(), std::memory_order_release);
 }
 
 void Scheduler::AddThread(SharedPtr<Thread> thread) {
@@ -154,38 +200,44 @@ void Scheduler::AddThread(SharedPtr<Thread> thread) {
 }
 
 void Scheduler::RemoveThread(Thread* thread) {
-    std::lock_guard lock{scheduler_mutex};
+    const auto [owner, lock] = LockOwner(thread);
 
-    thread_list.erase(std::remove(thread_list.begin(), thread_list.end(), thread),
-                      thread_list.end());
+    auto& list = owner->thread_list;
+    list.erase(std::remove(list.begin(), list.end(), thread), list.end());
 }
 
 void Scheduler::ScheduleThread(Thread* thread, u32 priority) {
-    std::lock_guard lock{scheduler_mutex};
+    const auto [owner, lock] = LockOwner(thread);
 
     ASSERT(thread->GetStatus() == ThreadStatus::Ready);
-    ready_queue.add(thread, priority);
+    owner->ready_queue.add(thread, priority);
+    owner->has_ready_threads.store(true, std::memory_order_release);
 }
 
 void Scheduler::UnscheduleThread(Thread* thread, u32 priority) {
-    std::lock_guard lock{scheduler_mutex};
+    const auto [owner, lock] = LockOwner(thread);
 
     ASSERT(thread->GetStatus() == ThreadStatus::Ready);
-    ready_queue.remove(thread, priority);
+    owner->ready_queue.remove(thread, priority);
+    owner->has_ready_threads.store(!owner->ready_queue.empty(), std::memory_order_release);
 }
 
 void Scheduler::SetThreadPriority(Thread* thread, u32 priority) {
-    std::lock_guard lock{scheduler_mutex};
+    const auto [owner, lock] = LockOwner(thread);
     if (thread->GetPriority() == priority) {
         return;
     }
 
     // If thread was ready, adjust queues
     if (thread->GetStatus() == ThreadStatus::Ready)
-        ready_queue.adjust(thread, thread->GetPriority(), priority);
+        owner->ready_queue.adjust(thread, thread->GetPriority(), priority);
 }
 
 Thread* Scheduler::GetNextSuggestedThread(u32 core, u32 maximum_priority) const {
+    if (!HaveReadyThreads()) {
+        return nullptr;
+    }
+
     std::lock_guard lock{scheduler_mutex};
 
     const u32 mask = 1U << core;
@@ -197,6 +249,62 @@ Thread* Scheduler::GetNextSuggestedThread(u32 core, u32 maximum_priority) const
     return nullptr;
 }
 
+void Scheduler::TransferReadyThread(Thread* thread, Scheduler& destination) {
+    while (true) {
+        Scheduler* const source = thread->GetScheduler();
+        const auto locks = LockSchedulers(*source, destination);
+        if (thread->GetScheduler() != source) {
+            // An idle core took the thread before the locks were taken, retry from its new owner
+            continue;
+        }
+        if (source == &destination) {
+            destination.ready_queue.remove(thread, thread->GetPriority());
+            destination.ready_queue.add(thread, thread->GetPriority());
+            destination.has_ready_threads.store(true, std::memory_order_release);
+        } else {
+            MoveReadyThread(thread, *source, destination);
+        }
+        return;
+    }
+}
+
+Scheduler::LockPair Scheduler::LockSchedulers(Scheduler& first, Scheduler& second) {
+    if (&first == &second) {
+        return {std::unique_lock{first.scheduler_mutex}, std::unique_lock<std::mutex>{}};
+    }
+    Scheduler& lower = first.core_id < second.core_id ? first : second;
+    Scheduler& upper = first.core_id < second.core_id ? second : first;
+    std::unique_lock lower_lock{lower.scheduler_mutex};
+    std::unique_lock upper_lock{upper.scheduler_mutex};
+    return {std::move(lower_lock), std::move(upper_lock)};
+}
+
+std::pair<Scheduler*, std::unique_lock<std::mutex>> Scheduler::LockOwner(Thread* thread) {
+    while (true) {
+        Scheduler* const owner = thread->GetScheduler();
+        std::unique_lock lock{owner->scheduler_mutex};
+        if (thread->GetScheduler() == owner) {
+            return {owner, std::move(lock)};
+        }
+    }
+}
+
+void Scheduler::MoveReadyThread(Thread* thread, Scheduler& source, Scheduler& destination) {
+    const u32 priority = thread->GetPriority();
+    source.ready_queue.remove(thread, priority);
+    source.has_ready_threads.store(!source.ready_queue.empty(), std::memory_order_release);
+
+    auto& list = source.thread_list;
+    const auto itr = std::find(list.begin(), list.end(), thread);
+    ASSERT(itr != list.end());
+    destination.thread_list.push_back(std::move(*itr));
+    list.erase(itr);
+
+    thread->MigrateToCore(destination, static_cast<s32>(destination.core_id));
+    destination.ready_queue.add(thread, priority);
+    destination.has_ready_threads.store(true, std::memory_order_release);
+}
+
 void Scheduler::YieldWithoutLoadBalancing(Thread* thread) {
     ASSERT(thread != nullptr);
     // Avoid yielding if the thread isn't even running.
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "common/multi_level_queue.h"
@@ -22,7 +24,7 @@ class Process;
 
 class Scheduler final {
 public:
-    explicit Scheduler(Core::System& system, Core::ARM_Interface& cpu_core);
+    explicit Scheduler(Core::System& system, Core::ARM_Interface& cpu_core, u32 core_id);
     ~Scheduler();
 
     /// Returns whether there are any threads that are ready to run.
@@ -55,6 +57,13 @@ public:
     /// Gets the next suggested thread for load balancing
     Thread* GetNextSuggestedThread(u32 core, u32 minimum_priority) const;
 
+    /**
+     * Moves a ready thread to the end of the ready queue of the given scheduler, along with its
+     * entry in the thread list. The scheduler that owns the thread and the destination are locked
+     * together, so the thread is always reachable from one of them.
+     */
+    static void TransferReadyThread(Thread* thread, Scheduler& destination);
+
     /**
      * YieldWithoutLoadBalancing -- analogous to normal yield on a system
      * Moves the thread to the end of the ready queue for its priority, and then reschedules the
@@ -152,6 +161,27 @@ private:
      */
     void UpdateLastContextSwitchTime(Thread* thread, Process* process);
 
+    /// Moves a ready thread from another core into this core's ready queue, if this core has
+    /// nothing to run and some other core has a ready thread that is allowed to run here.
+    void StealThread();
+
+    using LockPair = std::pair<std::unique_lock<std::mutex>, std::unique_lock<std::mutex>>;
+
+    /// Locks two schedulers in core order, so cores locking each other's schedulers at the same
+    /// time can't deadlock. A scheduler passed twice is locked once.
+    static LockPair LockSchedulers(Scheduler& first, Scheduler& second);
+
+    /**
+     * Locks the scheduler that owns the thread. Thread operations may be called on a scheduler the
+     * thread has been moved away from since it was read, threads only change scheduler with both
+     * schedulers locked, so the owner is stable once it has been locked.
+     * @return The owner of the thread and its lock
+     */
+    static std::pair<Scheduler*, std::unique_lock<std::mutex>> LockOwner(Thread* thread);
+
+    /// Moves a ready thread from one scheduler to another, both must be locked
+    static void MoveReadyThread(Thread* thread, Scheduler& source, Scheduler& destination);
+
     /// Lists all thread ids that aren't deleted/etc.
     std::vector<SharedPtr<Thread>> thread_list;
 
@@ -164,7 +194,14 @@ private:
     u64 last_context_switch_time = 0;
 
     Core::System& system;
-    static std::mutex scheduler_mutex;
+    u32 core_id;
+
+    /// Guards the ready queue and the thread list. Each core has its own lock, so that cores only
+    /// contend when they actually touch each other's queues.
+    mutable std::mutex scheduler_mutex;
+
+    /// Mirrors !ready_queue.empty(), so that other cores can skip this one without locking it.
+    std::atomic_bool has_ready_threads{false};
 };
 
 } // namespace Kernel
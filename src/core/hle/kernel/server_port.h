@@ -10,6 +10,7 @@
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
@@ -20,7 +21,7 @@ class KernelCore;
 class ServerSession;
 class SessionRequestHandler;
 
-class ServerPort final : public WaitObject {
+class ServerPort final : public WaitObject, public SlabAllocated<ServerPort> {
 public:
     using HLEHandler = std::shared_ptr<SessionRequestHandler>;
     using PortPair = std::pair<SharedPtr<ServerPort>, SharedPtr<ClientPort>>;
@@ -10,7 +10,9 @@
 
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/physical_memory.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/result.h"
 
 namespace Kernel {
@@ -30,7 +32,7 @@ enum class MemoryPermission : u32 {
     DontCare = (1u << 28)
 };
 
-class SharedMemory final : public Object {
+class SharedMemory final : public Object, public SlabAllocated<SharedMemory> {
 public:
     /**
      * Creates a shared memory object.
@@ -63,7 +65,7 @@ public:
      * @param name Optional object name, used for debugging purposes.
      */
     static SharedPtr<SharedMemory> CreateForApplet(KernelCore& kernel,
-                                                   std::shared_ptr<std::vector<u8>> heap_block,
+                                                   std::shared_ptr<PhysicalMemory> heap_block,
                                                    std::size_t offset, u64 size,
                                                    MemoryPermission permissions,
                                                    MemoryPermission other_permissions,
@@ -135,7 +137,7 @@ private:
     ~SharedMemory() override;
 
     /// Backing memory for this shared memory block.
-    std::shared_ptr<std::vector<u8>> backing_block;
+    std::shared_ptr<PhysicalMemory> backing_block;
     /// Offset into the backing block for this shared memory.
     std::size_t backing_block_offset = 0;
     /// Size of the memory block. Page-aligned.
@@ -0,0 +1,77 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <new>
+
+#include "common/alignment.h"
+#include "core/hle/kernel/slab_heap.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Number of blocks of the first chunk of a heap that was not reserved
+constexpr std::size_t MIN_CHUNK_BLOCKS = 64;
+
+} // Anonymous namespace
+
+SlabHeap::SlabHeap(std::size_t object_size, std::size_t object_alignment)
+    : block_size{Common::AlignUp(std::max(object_size, sizeof(FreeBlock)), object_alignment)} {
+    // Chunks are allocated with the default alignment of new
+    ASSERT(object_alignment <= alignof(std::max_align_t));
+}
+
+SlabHeap::~SlabHeap() = default;
+
+void* SlabHeap::Allocate() {
+    std::scoped_lock lock{mutex};
+    if (free_list == nullptr) {
+        // Double the capacity, so the number of chunks stays logarithmic
+        AddChunk(std::max(capacity, MIN_CHUNK_BLOCKS));
+    }
+    FreeBlock* const block = free_list;
+    free_list = block->next;
+    ++allocated_count;
+    return block;
+}
+
+void SlabHeap::Free(void* block) {
+    if (block == nullptr) {
+        return;
+    }
+    std::scoped_lock lock{mutex};
+    ASSERT(allocated_count > 0);
+    free_list = new (block) FreeBlock{free_list};
+    --allocated_count;
+}
+
+void SlabHeap::Reserve(std::size_t count) {
+    std::scoped_lock lock{mutex};
+    if (count > capacity) {
+        AddChunk(count - capacity);
+    }
+}
+
+std::size_t SlabHeap::GetAllocatedCount() const {
+    std::scoped_lock lock{mutex};
+    return allocated_count;
+}
+
+std::size_t SlabHeap::GetCapacity() const {
+    std::scoped_lock lock{mutex};
+    return capacity;
+}
+
+void SlabHeap::AddChunk(std::size_t count) {
+    u8* const chunk = chunks.emplace_back(std::make_unique<u8[]>(count * block_size)).get();
+
+    // Link the blocks in address order, the first allocations are contiguous in memory
+    for (std::size_t i = count; i-- > 0;) {
+        free_list = new (chunk + i * block_size) FreeBlock{free_list};
+    }
+    capacity += count;
+}
+
+} // namespace Kernel
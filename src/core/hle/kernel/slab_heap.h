@@ -0,0 +1,87 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/**
+ * Hands out the fixed size blocks of one kernel object type, like the slab heaps of Horizon.
+ * Blocks are carved out of large chunks and recycled through a free list, so creating and
+ * destroying objects is O(1), doesn't go through the general heap and keeps the objects of a type
+ * close together. The number of live objects is tracked to find leaked objects.
+ */
+class SlabHeap final {
+public:
+    explicit SlabHeap(std::size_t object_size, std::size_t object_alignment);
+    ~SlabHeap();
+
+    SlabHeap(const SlabHeap&) = delete;
+    SlabHeap& operator=(const SlabHeap&) = delete;
+
+    /// Returns an uninitialized block, growing the heap when all its blocks are in use
+    void* Allocate();
+
+    /// Returns a block obtained from Allocate to the heap
+    void Free(void* block);
+
+    /// Grows the heap so that it can hold at least the given number of objects
+    void Reserve(std::size_t count);
+
+    /// Returns the number of blocks handed out and not freed yet
+    std::size_t GetAllocatedCount() const;
+
+    /// Returns the number of blocks the heap can hand out without growing
+    std::size_t GetCapacity() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    /// Adds a chunk holding the given number of blocks, must be called with the mutex held
+    void AddChunk(std::size_t count);
+
+    const std::size_t block_size;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<u8[]>> chunks;
+    FreeBlock* free_list = nullptr;
+    std::size_t capacity = 0;
+    std::size_t allocated_count = 0;
+};
+
+/**
+ * Makes new and delete of a kernel object type go through the slab heap of the type. Objects are
+ * still released by their last SharedPtr, the virtual destructor of Object picks the heap of the
+ * dynamic type.
+ */
+template <typename T>
+class SlabAllocated {
+public:
+    static void* operator new(std::size_t size) {
+        ASSERT_MSG(size == sizeof(T), "Slab allocated types can't be derived from");
+        return GetSlabHeap().Allocate();
+    }
+
+    static void operator delete(void* block) {
+        GetSlabHeap().Free(block);
+    }
+
+    static SlabHeap& GetSlabHeap() {
+        // Never destroyed, objects can be released by other static objects on exit
+        static SlabHeap* const heap = new SlabHeap(sizeof(T), alignof(T));
+        return *heap;
+    }
+};
+
+} // namespace Kernel
@@ -3,6 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <iterator>
 #include <mutex>
@@ -11,12 +14,14 @@
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
-#include "common/microprofile.h"
 #include "common/string_util.h"
+#include "common/trace.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/guest_profiler.h"
+#include "core/hle/function_hooks.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
@@ -2232,7 +2237,7 @@ static ResultCode GetThreadList(Core::System& system, u32* out_num_threads, VAdd
 
 namespace {
 struct FunctionDef {
-    using Func = void(Core::System&);
+    using Func = void(Core::System&, Core::ARM_Interface&);
 
     u32 id;
     Func* func;
@@ -2379,10 +2384,23 @@ static const FunctionDef* GetSVCInfo(u32 func_num) {
     return &SVC_Table[func_num];
 }
 
-MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
+/// Call counts and time spent in each SVC, updated with the HLE lock held
+struct SVCCounters {
+    std::atomic<u64> call_count{};
+    std::atomic<u64> total_time_ns{};
+};
+static std::array<SVCCounters, std::size(SVC_Table)> svc_counters;
+
+TRACE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
+
+void CallSVC(Core::System& system, Core::ARM_Interface& arm_interface, u32 immediate) {
+    // Hooked guest functions don't touch the kernel state, they run without the kernel lock
+    if (immediate >= HLE::FUNCTION_HOOK_SVC_BASE) {
+        HLE::CallFunctionHook(system, arm_interface, immediate);
+        return;
+    }
 
-void CallSVC(Core::System& system, u32 immediate) {
-    MICROPROFILE_SCOPE(Kernel_SVC);
+    TRACE_SCOPE(Kernel_SVC);
 
     // Lock the global kernel mutex when we enter the kernel HLE.
     std::lock_guard lock{HLE::g_hle_lock};
@@ -2390,7 +2408,28 @@ void CallSVC(Core::System& system, u32 immediate) {
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
         if (info->func) {
-            info->func(system);
+            TRACE_SCOPE_DYNAMIC("SVC", info->name);
+            auto* const profiler = system.GetGuestProfiler();
+            const std::size_t core_index = profiler ? system.CurrentCoreIndex() : 0;
+            if (profiler) {
+                profiler->EnterSVC(core_index, info->name);
+            }
+
+            const auto start_time = std::chrono::steady_clock::now();
+            info->func(system, arm_interface);
+            const auto end_time = std::chrono::steady_clock::now();
+
+            if (profiler) {
+                profiler->ExitSVC(core_index);
+            }
+
+            SVCCounters& counters = svc_counters[immediate];
+            counters.call_count.fetch_add(1, std::memory_order_relaxed);
+            counters.total_time_ns.fetch_add(
+                static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     end_time - start_time)
+                                     .count()),
+                std::memory_order_relaxed);
         } else {
             LOG_CRITICAL(Kernel_SVC, "Unimplemented SVC function {}(..)", info->name);
         }
@@ -2399,4 +2438,28 @@ void CallSVC(Core::System& system, u32 immediate) {
     }
 }
 
+std::vector<SVCStatistics> GetSVCStatistics() {
+    std::vector<SVCStatistics> statistics;
+    for (std::size_t i = 0; i < svc_counters.size(); ++i) {
+        const u64 call_count = svc_counters[i].call_count.load(std::memory_order_relaxed);
+        if (call_count == 0) {
+            continue;
+        }
+        const u64 total_time_ns = svc_counters[i].total_time_ns.load(std::memory_order_relaxed);
+        statistics.push_back({static_cast<u32>(i), SVC_Table[i].name, call_count,
+                              std::chrono::nanoseconds{total_time_ns}});
+    }
+    std::sort(statistics.begin(), statistics.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.total_time > rhs.total_time;
+    });
+    return statistics;
+}
+
+void ResetSVCStatistics() {
+    for (auto& counters : svc_counters) {
+        counters.call_count.store(0, std::memory_order_relaxed);
+        counters.total_time_ns.store(0, std::memory_order_relaxed);
+    }
+}
+
 } // namespace Kernel
@@ -4,14 +4,38 @@
 
 #pragma once
 
+#include <chrono>
+#include <vector>
+
 #include "common/common_types.h"
 
 namespace Core {
+class ARM_Interface;
 class System;
 }
 
 namespace Kernel {
 
-void CallSVC(Core::System& system, u32 immediate);
+/**
+ * Runs an SVC for the thread executing on a CPU core
+ * @param system System context
+ * @param arm_interface CPU core that executed the SVC instruction, its registers hold the arguments
+ * @param immediate Number of the SVC
+ */
+void CallSVC(Core::System& system, Core::ARM_Interface& arm_interface, u32 immediate);
+
+/// Number of calls and time spent in an SVC since the last reset
+struct SVCStatistics {
+    u32 id;
+    const char* name;
+    u64 call_count;
+    std::chrono::nanoseconds total_time;
+};
+
+/// Returns the statistics of the SVCs that were called, the ones that took the longest come first
+std::vector<SVCStatistics> GetSVCStatistics();
+
+/// Clears the statistics of all SVCs, when a new title is started
+void ResetSVCStatistics();
 
 } // namespace Kernel
@@ -11,319 +11,318 @@
 
 namespace Kernel {
 
-static inline u64 Param(const Core::System& system, int n) {
-    return system.CurrentArmInterface().GetReg(n);
+static inline u64 Param(const Core::ARM_Interface& arm, int n) {
+    return arm.GetReg(n);
 }
 
 /**
  * HLE a function return from the current ARM userland process
- * @param system System context
+ * @param arm CPU core of the thread that called the SVC
  * @param result Result to return
  */
-static inline void FuncReturn(Core::System& system, u64 result) {
-    system.CurrentArmInterface().SetReg(0, result);
+static inline void FuncReturn(Core::ARM_Interface& arm, u64 result) {
+    arm.SetReg(0, result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function wrappers that return type ResultCode
 
 template <ResultCode func(Core::System&, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0)).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0)).raw);
 }
 
 template <ResultCode func(Core::System&, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0))).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     FuncReturn(
-        system,
-        func(system, static_cast<u32>(Param(system, 0)), static_cast<u32>(Param(system, 1))).raw);
+        arm,
+        func(system, static_cast<u32>(Param(arm, 0)), static_cast<u32>(Param(arm, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            Param(system, 2), Param(system, 3))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1),
+                         Param(arm, 2), Param(arm, 3))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u32*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param = 0;
     const u32 retval = func(system, &param).raw;
-    system.CurrentArmInterface().SetReg(1, param);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1))).raw;
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(arm, 1))).raw;
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u32*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
     u32 param_2 = 0;
     const u32 retval = func(system, &param_1, &param_2).raw;
 
-    auto& arm_interface = system.CurrentArmInterface();
-    arm_interface.SetReg(1, param_1);
-    arm_interface.SetReg(2, param_2);
+    arm.SetReg(1, param_1);
+    arm.SetReg(2, param_2);
 
-    FuncReturn(system, retval);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1)).raw;
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    const u32 retval = func(system, &param_1, Param(arm, 1)).raw;
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
     const u32 retval =
-        func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2))).raw;
+        func(system, &param_1, Param(arm, 1), static_cast<u32>(Param(arm, 2))).raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u64*, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1))).raw;
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(arm, 1))).raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u64, s32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<s32>(Param(system, 1))).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), static_cast<s32>(Param(arm, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1))).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), static_cast<u32>(Param(arm, 1))).raw);
 }
 
 template <ResultCode func(Core::System&, u64*, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1)).raw;
+    const u32 retval = func(system, &param_1, Param(arm, 1)).raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u64*, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u64 param_1 = 0;
-    const u32 retval = func(system, &param_1, static_cast<u32>(Param(system, 1)),
-                            static_cast<u32>(Param(system, 2)))
+    const u32 retval = func(system, &param_1, static_cast<u32>(Param(arm, 1)),
+                            static_cast<u32>(Param(arm, 2)))
                            .raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1)).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1)).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)),
-                            static_cast<u32>(Param(system, 1)), Param(system, 2))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0)),
+                         static_cast<u32>(Param(arm, 1)), Param(arm, 2))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u32*, u64*)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
     u64 param_2 = 0;
-    const ResultCode retval = func(system, static_cast<u32>(Param(system, 2)), &param_1, &param_2);
+    const ResultCode retval = func(system, static_cast<u32>(Param(arm, 2)), &param_1, &param_2);
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    system.CurrentArmInterface().SetReg(2, param_2);
-    FuncReturn(system, retval.raw);
+    arm.SetReg(1, param_1);
+    arm.SetReg(2, param_2);
+    FuncReturn(arm, retval.raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), static_cast<u32>(Param(system, 3)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), Param(arm, 1),
+                         static_cast<u32>(Param(arm, 2)), static_cast<u32>(Param(arm, 3)))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), Param(system, 3))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), Param(arm, 1),
+                         static_cast<u32>(Param(arm, 2)), Param(arm, 3))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1),
+                         static_cast<u32>(Param(arm, 2)))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1), Param(system, 2)).raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), Param(arm, 1), Param(arm, 2)).raw);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     FuncReturn(
-        system,
-        func(system, Param(system, 0), Param(system, 1), static_cast<u32>(Param(system, 2))).raw);
+        arm,
+        func(system, Param(arm, 0), Param(arm, 1), static_cast<u32>(Param(arm, 2))).raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, static_cast<u32>(Param(system, 0)), Param(system, 1),
-                            Param(system, 2), static_cast<u32>(Param(system, 3)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1),
+                         Param(arm, 2), static_cast<u32>(Param(arm, 3)))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u32, u64, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     FuncReturn(
-        system,
-        func(system, static_cast<u32>(Param(system, 0)), Param(system, 1), Param(system, 2)).raw);
+        arm,
+        func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1), Param(arm, 2)).raw);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, s64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2)),
-                            static_cast<s64>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(arm, 1), static_cast<u32>(Param(arm, 2)),
+                            static_cast<s64>(Param(arm, 3)))
                            .raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u64, u64, u32, s64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), Param(system, 1),
-                            static_cast<u32>(Param(system, 2)), static_cast<s64>(Param(system, 3)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), Param(arm, 1),
+                         static_cast<u32>(Param(arm, 2)), static_cast<s64>(Param(arm, 3)))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u64*, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u64 param_1 = 0;
     const u32 retval =
-        func(system, &param_1, Param(system, 1), Param(system, 2), Param(system, 3)).raw;
+        func(system, &param_1, Param(arm, 1), Param(arm, 2), Param(arm, 3)).raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, u64, u32, s32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), Param(system, 2), Param(system, 3),
-                            static_cast<u32>(Param(system, 4)), static_cast<s32>(Param(system, 5)))
+    const u32 retval = func(system, &param_1, Param(arm, 1), Param(arm, 2), Param(arm, 3),
+                            static_cast<u32>(Param(arm, 4)), static_cast<s32>(Param(arm, 5)))
                            .raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u32*, u64, u64, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), Param(system, 2),
-                            static_cast<u32>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(arm, 1), Param(arm, 2),
+                            static_cast<u32>(Param(arm, 3)))
                            .raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, Handle*, u64, u32, u32)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     u32 param_1 = 0;
-    const u32 retval = func(system, &param_1, Param(system, 1), static_cast<u32>(Param(system, 2)),
-                            static_cast<u32>(Param(system, 3)))
+    const u32 retval = func(system, &param_1, Param(arm, 1), static_cast<u32>(Param(arm, 2)),
+                            static_cast<u32>(Param(arm, 3)))
                            .raw;
 
-    system.CurrentArmInterface().SetReg(1, param_1);
-    FuncReturn(system, retval);
+    arm.SetReg(1, param_1);
+    FuncReturn(arm, retval);
 }
 
 template <ResultCode func(Core::System&, u64, u32, s32, s64)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1)),
-                            static_cast<s32>(Param(system, 2)), static_cast<s64>(Param(system, 3)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), static_cast<u32>(Param(arm, 1)),
+                         static_cast<s32>(Param(arm, 2)), static_cast<s64>(Param(arm, 3)))
+                        .raw);
 }
 
 template <ResultCode func(Core::System&, u64, u32, s32, s32)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system, Param(system, 0), static_cast<u32>(Param(system, 1)),
-                            static_cast<s32>(Param(system, 2)), static_cast<s32>(Param(system, 3)))
-                           .raw);
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system, Param(arm, 0), static_cast<u32>(Param(arm, 1)),
+                         static_cast<s32>(Param(arm, 2)), static_cast<s32>(Param(arm, 3)))
+                        .raw);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function wrappers that return type u32
 
 template <u32 func(Core::System&)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function wrappers that return type u64
 
 template <u64 func(Core::System&)>
-void SvcWrap(Core::System& system) {
-    FuncReturn(system, func(system));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    FuncReturn(arm, func(system));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Function wrappers that return type void
 
 template <void func(Core::System&)>
-void SvcWrap(Core::System& system) {
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
     func(system);
 }
 
 template <void func(Core::System&, s64)>
-void SvcWrap(Core::System& system) {
-    func(system, static_cast<s64>(Param(system, 0)));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    func(system, static_cast<s64>(Param(arm, 0)));
 }
 
 template <void func(Core::System&, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, Param(system, 0), Param(system, 1));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    func(system, Param(arm, 0), Param(arm, 1));
 }
 
 template <void func(Core::System&, u64, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, Param(system, 0), Param(system, 1), Param(system, 2));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    func(system, Param(arm, 0), Param(arm, 1), Param(arm, 2));
 }
 
 template <void func(Core::System&, u32, u64, u64)>
-void SvcWrap(Core::System& system) {
-    func(system, static_cast<u32>(Param(system, 0)), Param(system, 1), Param(system, 2));
+void SvcWrap(Core::System& system, Core::ARM_Interface& arm) {
+    func(system, static_cast<u32>(Param(arm, 0)), Param(arm, 1), Param(arm, 2));
 }
 
 } // namespace Kernel
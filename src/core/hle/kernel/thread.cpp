@@ -49,7 +49,13 @@ void Thread::Stop() {
     // Clean up thread from ready queue
     // This is only needed when the thread is terminated forcefully (SVC TerminateProcess)
     if (status == ThreadStatus::Ready || status == ThreadStatus::Paused) {
-        scheduler->UnscheduleThread(this, current_priority);
+        GetScheduler()->UnscheduleThread(this, current_priority);
+    }
+
+    // Terminated threads are not signaled by the arbiter anymore
+    if (arb_wait_address != 0) {
+        owner_process->GetAddressArbiter().RemoveWaitingThread(*this);
+        arb_wait_address = 0;
     }
 
     status = ThreadStatus::Dead;
@@ -206,7 +212,7 @@ ResultVal<SharedPtr<Thread>> Thread::Create(KernelCore& kernel, std::string name
     thread->callback_handle = kernel.ThreadWakeupCallbackHandleTable().Create(thread).Unwrap();
     thread->owner_process = &owner_process;
     thread->scheduler = &system.Scheduler(processor_id);
-    thread->scheduler->AddThread(thread);
+    system.Scheduler(processor_id).AddThread(thread);
     thread->tls_address = thread->owner_process->MarkNextAvailableTLSSlotAsUsed(*thread);
 
     thread->owner_process->RegisterThread(thread.get());
@@ -311,9 +317,17 @@ void Thread::UpdatePriority() {
         return;
     }
 
-    scheduler->SetThreadPriority(this, new_priority);
+    GetScheduler()->SetThreadPriority(this, new_priority);
     current_priority = new_priority;
 
+    if (arb_wait_address != 0) {
+        owner_process->GetAddressArbiter().UpdateWaitingThreadPriority(this);
+    }
+
+    for (auto& wait_object : wait_objects) {
+        wait_object->UpdateWaitingThreadPriority(this);
+    }
+
     if (!lock_owner) {
         return;
     }
@@ -333,6 +347,13 @@ void Thread::ChangeCore(u32 core, u64 mask) {
     ChangeScheduler();
 }
 
+void Thread::MigrateToCore(Scheduler& new_scheduler, s32 core) {
+    ASSERT(status == ThreadStatus::Ready);
+
+    processor_id = core;
+    scheduler.store(&new_scheduler, std::memory_order_release);
+}
+
 void Thread::ChangeScheduler() {
     if (status != ThreadStatus::Ready) {
         return;
@@ -353,22 +374,10 @@ void Thread::ChangeScheduler() {
     // Add thread to new core's scheduler
     auto& next_scheduler = system.Scheduler(*new_processor_id);
 
-    if (*new_processor_id != processor_id) {
-        // Remove thread from previous core's scheduler
-        scheduler->RemoveThread(this);
-        next_scheduler.AddThread(this);
-    }
-
-    processor_id = *new_processor_id;
-
-    // If the thread was ready, unschedule from the previous core and schedule on the new core
-    scheduler->UnscheduleThread(this, current_priority);
-    next_scheduler.ScheduleThread(this, current_priority);
-
-    // Change thread's scheduler
-    scheduler = &next_scheduler;
+    // Move the thread to the back of the ready queue of the new core, with both cores locked
+    Scheduler::TransferReadyThread(this, next_scheduler);
 
-    system.CpuCore(processor_id).PrepareReschedule();
+    system.CpuCore(*new_processor_id).PrepareReschedule();
 }
 
 bool Thread::AllWaitObjectsReady() const {
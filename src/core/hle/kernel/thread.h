@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -12,6 +13,8 @@
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/physical_memory.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
@@ -76,9 +79,9 @@ enum class ThreadActivity : u32 {
     Paused = 1,
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public SlabAllocated<Thread> {
 public:
-    using TLSMemory = std::vector<u8>;
+    using TLSMemory = PhysicalMemory;
     using TLSMemoryPtr = std::shared_ptr<TLSMemory>;
 
     using MutexWaitingThreads = std::vector<SharedPtr<Thread>>;
@@ -161,6 +164,16 @@ public:
     /// Changes the core that the thread is running or scheduled to run on.
     void ChangeCore(u32 core, u64 mask);
 
+    /// Sets the core of a ready thread that the schedulers are moving to another core, it keeps
+    /// the ideal core. Both schedulers must be locked.
+    void MigrateToCore(Scheduler& new_scheduler, s32 core);
+
+    /// Gets the scheduler of the core the thread is running or scheduled to run on. It can be
+    /// changed by other cores, unless one of the scheduler locks is held.
+    Scheduler* GetScheduler() const {
+        return scheduler.load(std::memory_order_acquire);
+    }
+
     /**
      * Gets the thread's thread ID
      * @return The thread's ID
@@ -458,7 +471,7 @@ private:
     /// available. In case of a timeout, the object will be nullptr.
     WakeupCallback wakeup_callback;
 
-    Scheduler* scheduler = nullptr;
+    std::atomic<Scheduler*> scheduler{nullptr};
 
     u32 ideal_core{0xFFFFFFFF};
     u64 affinity_mask{0x1};
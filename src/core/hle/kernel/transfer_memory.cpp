@@ -23,11 +23,26 @@ SharedPtr<TransferMemory> TransferMemory::Create(KernelCore& kernel, VAddr base_
     transfer_memory->owner_permissions = permissions;
     transfer_memory->owner_process = kernel.CurrentProcess();
 
+    // Alias the block already mapped at the address, when the whole range lives in a single one
+    const auto& vm_manager = transfer_memory->owner_process->VMManager();
+    const auto vma = vm_manager.FindVMA(base_address);
+    if (vm_manager.IsValidHandle(vma) && vma->second.backing_block) {
+        const auto vma_offset = base_address - vma->first;
+        if (vma_offset + size <= vma->second.size) {
+            transfer_memory->backing_block = vma->second.backing_block;
+            transfer_memory->backing_block_offset = vma->second.offset + vma_offset;
+        }
+    }
+
     return transfer_memory;
 }
 
+u8* TransferMemory::GetPointer() {
+    return backing_block ? backing_block->data() + backing_block_offset : nullptr;
+}
+
 const u8* TransferMemory::GetPointer() const {
-    return backing_block.get()->data();
+    return backing_block ? backing_block->data() + backing_block_offset : nullptr;
 }
 
 u64 TransferMemory::GetSize() const {
@@ -47,13 +62,18 @@ ResultCode TransferMemory::MapMemory(VAddr address, u64 size, MemoryPermission p
         return ERR_INVALID_STATE;
     }
 
-    backing_block = std::make_shared<std::vector<u8>>(size);
+    if (!backing_block) {
+        // The range wasn't backed by a single block, there is no memory to share
+        backing_block = std::make_shared<PhysicalMemory>(size);
+        backing_block_offset = 0;
+    }
 
     const auto map_state = owner_permissions == MemoryPermission::None
                                ? MemoryState::TransferMemoryIsolated
                                : MemoryState::TransferMemory;
     auto& vm_manager = owner_process->VMManager();
-    const auto map_result = vm_manager.MapMemoryBlock(address, backing_block, 0, size, map_state);
+    const auto map_result =
+        vm_manager.MapMemoryBlock(address, backing_block, backing_block_offset, size, map_state);
     if (map_result.Failed()) {
         return map_result.Code();
     }
@@ -8,6 +8,8 @@
 #include <vector>
 
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/physical_memory.h"
+#include "core/hle/kernel/slab_heap.h"
 
 union ResultCode;
 
@@ -24,7 +26,7 @@ enum class MemoryPermission : u32;
 /// transferring memory between separate process instances,
 /// thus the name.
 ///
-class TransferMemory final : public Object {
+class TransferMemory final : public Object, public SlabAllocated<TransferMemory> {
 public:
     static constexpr HandleType HANDLE_TYPE = HandleType::TransferMemory;
 
@@ -49,7 +51,12 @@ public:
         return HANDLE_TYPE;
     }
 
-    /// Gets a pointer to the backing block of this instance.
+    /// Gets a pointer to the memory of this instance. The memory is accessed in place, writes
+    /// are seen by the owner process. Returns null if there is no memory to access.
+    u8* GetPointer();
+
+    /// Gets a constant pointer to the memory of this instance. Returns null if there is no memory
+    /// to access.
     const u8* GetPointer() const;
 
     /// Gets the size of the memory backing this instance in bytes.
@@ -81,8 +88,12 @@ private:
     explicit TransferMemory(KernelCore& kernel);
     ~TransferMemory() override;
 
-    /// Memory block backing this instance.
-    std::shared_ptr<std::vector<u8>> backing_block;
+    /// Memory block backing this instance. It's the block of the owner process at the base
+    /// address, so the memory is shared instead of copied.
+    std::shared_ptr<PhysicalMemory> backing_block;
+
+    /// Offset into the backing block of the memory managed by this instance.
+    std::size_t backing_block_offset = 0;
 
     /// The base address for the memory managed by this instance.
     VAddr base_address = 0;
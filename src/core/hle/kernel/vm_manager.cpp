@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/memory_hook.h"
+#include "common/virtual_buffer.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/file_sys/program_metadata.h"
@@ -75,6 +76,10 @@ VMManager::~VMManager() {
 void VMManager::Reset(FileSys::ProgramAddressSpaceType type) {
     Clear();
 
+    // The heap of the new address space is reserved for the size of its heap region
+    heap_memory.reset();
+    heap_accounting.Resize(0);
+
     InitializeMemoryRegionRanges(type);
 
     page_table.Resize(address_space_width);
@@ -84,7 +89,8 @@ void VMManager::Reset(FileSys::ProgramAddressSpaceType type) {
     initial_vma.size = address_space_end;
     vma_map.emplace(initial_vma.base, initial_vma);
 
-    UpdatePageTableForVMA(initial_vma);
+    // The page table has just been resized, so it is already entirely unmapped and there is no need
+    // to walk the whole address space to unmap it again.
 }
 
 VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
@@ -100,7 +106,7 @@ bool VMManager::IsValidHandle(VMAHandle handle) const {
 }
 
 ResultVal<VMManager::VMAHandle> VMManager::MapMemoryBlock(VAddr target,
-                                                          std::shared_ptr<std::vector<u8>> block,
+                                                          std::shared_ptr<PhysicalMemory> block,
                                                           std::size_t offset, u64 size,
                                                           MemoryState state) {
     ASSERT(block != nullptr);
@@ -264,38 +270,40 @@ ResultVal<VAddr> VMManager::SetHeapSize(u64 size) {
     }
 
     if (heap_memory == nullptr) {
-        // Initialize heap
-        heap_memory = std::make_shared<std::vector<u8>>(size);
-        heap_end = heap_region_base + size;
-    } else {
-        UnmapRange(heap_region_base, GetCurrentHeapSize());
+        // The address space of the whole heap region is reserved up front, so resizing the heap
+        // never moves its memory and only the resized range of it has to be committed and mapped
+        heap_memory = std::make_shared<PhysicalMemory>(PhysicalMemoryAllocator{true});
+        heap_memory->reserve(GetHeapRegionSize());
     }
 
-    // If necessary, expand backing vector to cover new heap extents in
-    // the case of allocating. Otherwise, shrink the backing memory,
-    // if a smaller heap has been requested.
     const u64 old_heap_size = GetCurrentHeapSize();
     if (size > old_heap_size) {
         const u64 alloc_size = size - old_heap_size;
 
-        heap_memory->insert(heap_memory->end(), alloc_size, 0);
-        RefreshMemoryBlockMappings(heap_memory.get());
-    } else if (size < old_heap_size) {
+        // The new elements aren't written, they keep the zeroes of the committed pages
+        Common::CommitMemoryPages(heap_memory->data() + old_heap_size, alloc_size);
         heap_memory->resize(size);
-        heap_memory->shrink_to_fit();
+        const auto mapping_result =
+            MapMemoryBlock(heap_end, heap_memory, old_heap_size, alloc_size, MemoryState::Heap);
+        if (mapping_result.Failed()) {
+            heap_memory->resize(old_heap_size);
+            Common::DecommitMemoryPages(heap_memory->data() + old_heap_size, alloc_size);
+            return mapping_result.Code();
+        }
+    } else {
+        const u64 free_size = old_heap_size - size;
 
-        RefreshMemoryBlockMappings(heap_memory.get());
+        UnmapRange(heap_region_base + size, free_size);
+        heap_memory->resize(size);
+
+        // Return the freed memory to the host, it reads as zero when the heap grows again
+        Common::DecommitMemoryPages(heap_memory->data() + size, free_size);
     }
 
     heap_end = heap_region_base + size;
+    heap_accounting.Resize(size);
     ASSERT(GetCurrentHeapSize() == heap_memory->size());
 
-    const auto mapping_result =
-        MapMemoryBlock(heap_region_base, heap_memory, 0, size, MemoryState::Heap);
-    if (mapping_result.Failed()) {
-        return mapping_result.Code();
-    }
-
     return MakeResult<VAddr>(heap_region_base);
 }
 
@@ -373,7 +381,7 @@ ResultCode VMManager::UnmapCodeMemory(VAddr dst_address, VAddr src_address, u64
     Reprotect(src_vma_iter, VMAPermission::ReadWrite);
 
     if (dst_memory_state == MemoryState::ModuleCode) {
-        system.InvalidateCpuInstructionCaches();
+        system.InvalidateCpuInstructionCacheRange(dst_address, size);
     }
 
     return unmap_result;
@@ -438,7 +446,7 @@ ResultCode VMManager::MirrorMemory(VAddr dst_addr, VAddr src_addr, u64 size, Mem
     ASSERT_MSG(vma_offset + size <= vma->second.size,
                "Shared memory exceeds bounds of mapped block");
 
-    const std::shared_ptr<std::vector<u8>>& backing_block = vma->second.backing_block;
+    const std::shared_ptr<PhysicalMemory>& backing_block = vma->second.backing_block;
     const std::size_t backing_block_offset = vma->second.offset + vma_offset;
 
     CASCADE_RESULT(auto new_vma,
@@ -451,7 +459,7 @@ ResultCode VMManager::MirrorMemory(VAddr dst_addr, VAddr src_addr, u64 size, Mem
     return RESULT_SUCCESS;
 }
 
-void VMManager::RefreshMemoryBlockMappings(const std::vector<u8>* block) {
+void VMManager::RefreshMemoryBlockMappings(const PhysicalMemory* block) {
     // If this ever proves to have a noticeable performance impact, allow users of the function to
     // specify a specific range of addresses to limit the scan to.
     for (const auto& p : vma_map) {
@@ -692,10 +700,11 @@ void VMManager::ClearVMAMap() {
 }
 
 void VMManager::ClearPageTable() {
-    std::fill(page_table.pointers.begin(), page_table.pointers.end(), nullptr);
+    // Reallocating the table is cheaper than filling it, as it avoids committing every entry.
+    if (address_space_width != 0) {
+        page_table.Resize(address_space_width);
+    }
     page_table.special_regions.clear();
-    std::fill(page_table.attributes.begin(), page_table.attributes.end(),
-              Common::PageType::Unmapped);
 }
 
 VMManager::CheckResults VMManager::CheckRangeState(VAddr address, u64 size, MemoryState state_mask,
@@ -9,9 +9,11 @@
 #include <tuple>
 #include <vector>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "common/memory_hook.h"
 #include "common/page_table.h"
 #include "core/hle/result.h"
+#include "core/hle/kernel/physical_memory.h"
 #include "core/memory.h"
 
 namespace Core {
@@ -290,7 +292,7 @@ struct VirtualMemoryArea {
 
     // Settings for type = AllocatedMemoryBlock
     /// Memory block backing this VMA.
-    std::shared_ptr<std::vector<u8>> backing_block = nullptr;
+    std::shared_ptr<PhysicalMemory> backing_block = nullptr;
     /// Offset into the backing_memory the mapping starts from.
     std::size_t offset = 0;
 
@@ -348,7 +350,7 @@ public:
      * @param size Size of the mapping.
      * @param state MemoryState tag to attach to the VMA.
      */
-    ResultVal<VMAHandle> MapMemoryBlock(VAddr target, std::shared_ptr<std::vector<u8>> block,
+    ResultVal<VMAHandle> MapMemoryBlock(VAddr target, std::shared_ptr<PhysicalMemory> block,
                                         std::size_t offset, u64 size, MemoryState state);
 
     /**
@@ -493,7 +495,7 @@ public:
      * Scans all VMAs and updates the page table range of any that use the given vector as backing
      * memory. This should be called after any operation that causes reallocation of the vector.
      */
-    void RefreshMemoryBlockMappings(const std::vector<u8>* block);
+    void RefreshMemoryBlockMappings(const PhysicalMemory* block);
 
     /// Dumps the address space layout to the log, for debugging
     void LogLayout() const;
@@ -710,8 +712,13 @@ private:
     // Memory used to back the allocations in the regular heap. A single vector is used to cover
     // the entire virtual address space extents that bound the allocations, including any holes.
     // This makes deallocation and reallocation of holes fast and keeps process memory contiguous
-    // in the emulator address space, allowing Memory::GetPointer to be reasonably safe.
-    std::shared_ptr<std::vector<u8>> heap_memory;
+    // in the emulator address space, allowing Memory::GetPointer to be reasonably safe. Its
+    // capacity covers the whole heap region, so resizing the heap never reallocates it.
+    std::shared_ptr<PhysicalMemory> heap_memory;
+
+    // Committed part of the heap reservation, the allocator of the heap doesn't report it
+    Common::MemoryAccounting::Allocation heap_accounting{
+        Common::MemoryAccounting::Category::GuestMemory};
 
     // The end of the currently allocated heap. This is not an inclusive
     // end of the range. This is essentially 'base_address + current_size'.
@@ -17,8 +17,14 @@ WaitObject::~WaitObject() = default;
 
 void WaitObject::AddWaitingThread(SharedPtr<Thread> thread) {
     auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    if (itr != waiting_threads.end())
+        return;
+
+    // Threads of the same priority are woken up in the order they started waiting
+    const u32 priority = thread->GetPriority();
+    itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
+                       [priority](const auto& entry) { return entry->GetPriority() > priority; });
+    waiting_threads.insert(itr, std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
@@ -31,9 +37,7 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
 }
 
 SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = THREADPRIO_LOWEST + 1;
-
+    // The list is sorted by priority, the first thread that is ready to run is the candidate
     for (const auto& thread : waiting_threads) {
         const ThreadStatus thread_status = thread->GetStatus();
 
@@ -42,26 +46,28 @@ SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
                        thread_status == ThreadStatus::WaitHLEEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->GetPriority() >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
             continue;
 
         // A thread is ready to run if it's either in ThreadStatus::WaitSynch
         // and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
-        if (thread_status == ThreadStatus::WaitSynch) {
-            ready_to_run = thread->AllWaitObjectsReady();
-        }
+        if (thread_status == ThreadStatus::WaitSynch && !thread->AllWaitObjectsReady())
+            continue;
 
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->GetPriority();
-        }
+        return thread;
     }
 
-    return candidate;
+    return nullptr;
+}
+
+void WaitObject::UpdateWaitingThreadPriority(Thread* thread) {
+    const auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
+    if (itr == waiting_threads.end())
+        return;
+
+    SharedPtr<Thread> entry = std::move(*itr);
+    waiting_threads.erase(itr);
+    AddWaitingThread(std::move(entry));
 }
 
 void WaitObject::WakeupWaitingThread(SharedPtr<Thread> thread) {
@@ -100,7 +106,13 @@ void WaitObject::WakeupWaitingThread(SharedPtr<Thread> thread) {
 
 void WaitObject::WakeupAllWaitingThreads() {
     while (auto thread = GetHighestPriorityReadyThread()) {
-        WakeupWaitingThread(thread);
+        WakeupWaitingThread(std::move(thread));
+    }
+}
+
+void WaitObject::WakeupHighestPriorityThread() {
+    if (auto thread = GetHighestPriorityReadyThread()) {
+        WakeupWaitingThread(std::move(thread));
     }
 }
 
@@ -30,7 +30,8 @@ public:
     virtual void Acquire(Thread* thread) = 0;
 
     /**
-     * Add a thread to wait on this object
+     * Add a thread to wait on this object, behind the waiting threads of the same or higher
+     * priority
      * @param thread Pointer to thread to add
      */
     void AddWaitingThread(SharedPtr<Thread> thread);
@@ -47,6 +48,12 @@ public:
      */
     void WakeupAllWaitingThreads();
 
+    /**
+     * Wakes up the highest priority thread waiting on this object that can be awoken. Objects
+     * that stop being available once acquired use this instead of waking up all the threads.
+     */
+    void WakeupHighestPriorityThread();
+
     /**
      * Wakes up a single thread waiting on this object.
      * @param thread Thread that is waiting on this object to wakeup.
@@ -56,15 +63,26 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     SharedPtr<Thread> GetHighestPriorityReadyThread() const;
 
+    /**
+     * Moves a waiting thread to its new position in the waiting list after its priority changed
+     * @param thread Pointer to the thread whose priority changed
+     */
+    void UpdateWaitingThreadPriority(Thread* thread);
+
     /// Get a const reference to the waiting threads list for debug use
     const std::vector<SharedPtr<Thread>>& GetWaitingThreads() const;
 
 private:
-    /// Threads waiting for this object to become available
+    /// Threads waiting for this object to become available, the highest priority ones come first
     std::vector<SharedPtr<Thread>> waiting_threads;
 };
 
-// Specialization of DynamicObjectCast for WaitObjects
+// Specializations of IsHandleTypeOf and DynamicObjectCast for WaitObjects
+template <>
+inline bool IsHandleTypeOf<WaitObject>(HandleType handle_type) {
+    return IsWaitableHandleType(handle_type);
+}
+
 template <>
 inline SharedPtr<WaitObject> DynamicObjectCast<WaitObject>(SharedPtr<Object> object) {
     if (object != nullptr && object->IsWaitable()) {
@@ -938,6 +938,12 @@ void ILibraryAppletCreator::CreateTransferMemoryStorage(Kernel::HLERequestContex
     }
 
     const u8* const mem_begin = transfer_mem->GetPointer();
+    if (mem_begin == nullptr) {
+        LOG_ERROR(Service_AM, "transfer_mem has no backing memory for handle={:08X}", handle);
+        IPC::ResponseBuilder rb{ctx, 2};
+        rb.Push(ResultCode(-1));
+        return;
+    }
     const u8* const mem_end = mem_begin + transfer_mem->GetSize();
     std::vector<u8> memory{mem_begin, mem_end};
 
@@ -20,6 +20,7 @@
 #include "core/hle/kernel/writable_event.h"
 #include "core/hle/service/audio/audren_u.h"
 #include "core/hle/service/audio/errors.h"
+#include "core/telemetry_session.h"
 
 namespace Service::Audio {
 
@@ -48,8 +49,8 @@ public:
         auto& system = Core::System::GetInstance();
         system_event = Kernel::WritableEvent::CreateEventPair(
             system.Kernel(), Kernel::ResetType::Manual, "IAudioRenderer:SystemEvent");
-        renderer = std::make_unique<AudioCore::AudioRenderer>(system.CoreTiming(), audren_params,
-                                                              system_event.writable);
+        renderer = std::make_unique<AudioCore::AudioRenderer>(
+            system.CoreTiming(), system.GetPerfStats(), audren_params, system_event.writable);
     }
 
 private:
@@ -92,9 +93,27 @@ private:
     void RequestUpdateImpl(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_Audio, "(STUBBED) called");
 
-        ctx.WriteBuffer(renderer->UpdateAudioRenderer(ctx.ReadBuffer()));
+        ctx.WriteBuffer(renderer->UpdateAudioRenderer(ctx.ReadBufferSpan().data()));
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
+
+        if (!is_latency_reported) {
+            ReportOutputLatency();
+        }
+    }
+
+    /// Reports the audio latency once the renderer has played for long enough to measure it
+    void ReportOutputLatency() {
+        const auto latency = renderer->GetOutputLatency();
+        if (!latency) {
+            return;
+        }
+
+        const double latency_ms = latency->count() / 1000.0;
+        LOG_INFO(Service_Audio, "Audio output latency is {:.1f} ms", latency_ms);
+        Core::System::GetInstance().TelemetrySession().AddField(
+            Telemetry::FieldType::Performance, "Audio_OutputLatency", latency_ms);
+        is_latency_reported = true;
     }
 
     void Start(Kernel::HLERequestContext& ctx) {
@@ -155,6 +174,7 @@ private:
     Kernel::EventPair system_event;
     std::unique_ptr<AudioCore::AudioRenderer> renderer;
     u32 rendering_time_limit_percent = 100;
+    bool is_latency_reported = false;
 };
 
 class IAudioDevice final : public ServiceFramework<IAudioDevice> {
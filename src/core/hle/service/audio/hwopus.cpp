@@ -2,9 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <opus.h>
@@ -12,9 +15,11 @@
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/service/audio/hwopus.h"
+#include "core/hle/service/service_thread.h"
 
 namespace Service::Audio {
 namespace {
@@ -53,46 +58,58 @@ public:
     explicit OpusDecoderState(OpusDecoderPtr decoder, u32 sample_rate, u32 channel_count)
         : decoder{std::move(decoder)}, sample_rate{sample_rate}, channel_count{channel_count} {}
 
-    // Decodes interleaved Opus packets. Optionally allows reporting time taken to
-    // perform the decoding, as well as any relevant extra behavior.
-    void DecodeInterleaved(Kernel::HLERequestContext& ctx, PerfTime perf_time,
-                           ExtraBehavior extra_behavior) {
-        if (perf_time == PerfTime::Disabled) {
-            DecodeInterleavedHelper(ctx, nullptr, extra_behavior);
-        } else {
-            u64 performance = 0;
-            DecodeInterleavedHelper(ctx, &performance, extra_behavior);
-        }
+    // Decodes interleaved Opus packets on the service thread. Optionally allows reporting time
+    // taken to perform the decoding, as well as any relevant extra behavior.
+    static void DecodeInterleaved(const std::shared_ptr<OpusDecoderState>& state,
+                                  ServiceThread& service_thread, Kernel::HLERequestContext& ctx,
+                                  PerfTime perf_time, ExtraBehavior extra_behavior) {
+        // Guest memory is only accessed from the emulated core, before and after the decoding
+        service_thread.QueueRequest(
+            ctx, [state, perf_time, extra_behavior, input = ctx.ReadBuffer(),
+                  output_size = ctx.GetWriteBufferSize()]() -> ServiceThread::ReplyFunction {
+                return state->DecodeInterleavedHelper(input, output_size, perf_time,
+                                                      extra_behavior);
+            });
     }
 
 private:
-    void DecodeInterleavedHelper(Kernel::HLERequestContext& ctx, u64* performance,
-                                 ExtraBehavior extra_behavior) {
+    ServiceThread::ReplyFunction DecodeInterleavedHelper(const std::vector<u8>& input,
+                                                         std::size_t output_size,
+                                                         PerfTime perf_time,
+                                                         ExtraBehavior extra_behavior) {
         u32 consumed = 0;
         u32 sample_count = 0;
-        std::vector<opus_int16> samples(ctx.GetWriteBufferSize() / sizeof(opus_int16));
+        u64 performance = 0;
+        u64* const performance_ptr = perf_time == PerfTime::Enabled ? &performance : nullptr;
+        std::vector<opus_int16> samples(output_size / sizeof(opus_int16));
 
+        // Decoders run in parallel, but guest threads sharing a session decode one at a time
+        std::lock_guard lock{mutex};
         if (extra_behavior == ExtraBehavior::ResetContext) {
             ResetDecoderContext();
         }
 
-        if (!DecodeOpusData(consumed, sample_count, ctx.ReadBuffer(), samples, performance)) {
+        if (!DecodeOpusData(consumed, sample_count, input, samples, performance_ptr)) {
             LOG_ERROR(Audio, "Failed to decode opus data");
-            IPC::ResponseBuilder rb{ctx, 2};
-            // TODO(ogniK): Use correct error code
-            rb.Push(ResultCode(-1));
-            return;
+            return [](Kernel::HLERequestContext& ctx) {
+                IPC::ResponseBuilder rb{ctx, 2};
+                // TODO(ogniK): Use correct error code
+                rb.Push(ResultCode(-1));
+            };
         }
 
-        const u32 param_size = performance != nullptr ? 6 : 4;
-        IPC::ResponseBuilder rb{ctx, param_size};
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(consumed);
-        rb.Push<u32>(sample_count);
-        if (performance) {
-            rb.Push<u64>(*performance);
-        }
-        ctx.WriteBuffer(samples.data(), samples.size() * sizeof(s16));
+        return [consumed, sample_count, performance, perf_time,
+                samples = std::move(samples)](Kernel::HLERequestContext& ctx) {
+            const u32 param_size = perf_time == PerfTime::Enabled ? 6 : 4;
+            IPC::ResponseBuilder rb{ctx, param_size};
+            rb.Push(RESULT_SUCCESS);
+            rb.Push<u32>(consumed);
+            rb.Push<u32>(sample_count);
+            if (perf_time == PerfTime::Enabled) {
+                rb.Push<u64>(performance);
+            }
+            ctx.WriteBuffer(samples.data(), samples.size() * sizeof(s16));
+        };
     }
 
     bool DecodeOpusData(u32& consumed, u32& sample_count, const std::vector<u8>& input,
@@ -153,6 +170,7 @@ private:
         opus_multistream_decoder_ctl(decoder.get(), OPUS_RESET_STATE);
     }
 
+    std::mutex mutex;
     OpusDecoderPtr decoder;
     u32 sample_rate;
     u32 channel_count;
@@ -160,8 +178,10 @@ private:
 
 class IHardwareOpusDecoderManager final : public ServiceFramework<IHardwareOpusDecoderManager> {
 public:
-    explicit IHardwareOpusDecoderManager(OpusDecoderState decoder_state)
-        : ServiceFramework("IHardwareOpusDecoderManager"), decoder_state{std::move(decoder_state)} {
+    explicit IHardwareOpusDecoderManager(std::shared_ptr<OpusDecoderState> decoder_state,
+                                         std::shared_ptr<ServiceThread> service_thread)
+        : ServiceFramework("IHardwareOpusDecoderManager"), decoder_state{std::move(decoder_state)},
+          service_thread{std::move(service_thread)} {
         // clang-format off
         static const FunctionInfo functions[] = {
             {0, &IHardwareOpusDecoderManager::DecodeInterleavedOld, "DecodeInterleavedOld"},
@@ -182,15 +202,17 @@ private:
     void DecodeInterleavedOld(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Audio, "called");
 
-        decoder_state.DecodeInterleaved(ctx, OpusDecoderState::PerfTime::Disabled,
-                                        OpusDecoderState::ExtraBehavior::None);
+        OpusDecoderState::DecodeInterleaved(decoder_state, *service_thread, ctx,
+                                            OpusDecoderState::PerfTime::Disabled,
+                                            OpusDecoderState::ExtraBehavior::None);
     }
 
     void DecodeInterleavedWithPerfOld(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Audio, "called");
 
-        decoder_state.DecodeInterleaved(ctx, OpusDecoderState::PerfTime::Enabled,
-                                        OpusDecoderState::ExtraBehavior::None);
+        OpusDecoderState::DecodeInterleaved(decoder_state, *service_thread, ctx,
+                                            OpusDecoderState::PerfTime::Enabled,
+                                            OpusDecoderState::ExtraBehavior::None);
     }
 
     void DecodeInterleaved(Kernel::HLERequestContext& ctx) {
@@ -200,10 +222,13 @@ private:
         const auto extra_behavior = rp.Pop<bool>() ? OpusDecoderState::ExtraBehavior::ResetContext
                                                    : OpusDecoderState::ExtraBehavior::None;
 
-        decoder_state.DecodeInterleaved(ctx, OpusDecoderState::PerfTime::Enabled, extra_behavior);
+        OpusDecoderState::DecodeInterleaved(decoder_state, *service_thread, ctx,
+                                            OpusDecoderState::PerfTime::Enabled, extra_behavior);
     }
 
-    OpusDecoderState decoder_state;
+    /// Shared with the requests still being decoded, the session can be closed in the meantime
+    std::shared_ptr<OpusDecoderState> decoder_state;
+    std::shared_ptr<ServiceThread> service_thread;
 };
 
 std::size_t WorkerBufferSize(u32 channel_count) {
@@ -228,6 +253,11 @@ std::array<u8, 2> CreateMappingTable(u32 channel_count) {
 
     return {{0, 255}};
 }
+/// Number of host threads decoding, the packets of different decoders are decoded in parallel
+std::size_t NumDecodeThreads() {
+    constexpr u32 max_threads = 4;
+    return std::clamp(std::thread::hardware_concurrency() / 2, 1u, max_threads);
+}
 } // Anonymous namespace
 
 void HwOpus::GetWorkBufferSize(Kernel::HLERequestContext& ctx) {
@@ -285,10 +315,14 @@ void HwOpus::OpenOpusDecoder(Kernel::HLERequestContext& ctx) {
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
     rb.PushIpcInterface<IHardwareOpusDecoderManager>(
-        OpusDecoderState{std::move(decoder), sample_rate, channel_count});
+        std::make_shared<OpusDecoderState>(std::move(decoder), sample_rate, channel_count),
+        service_thread);
 }
 
-HwOpus::HwOpus() : ServiceFramework("hwopus") {
+HwOpus::HwOpus()
+    : ServiceFramework("hwopus"),
+      service_thread{std::make_shared<ServiceThread>(Core::System::GetInstance(), "hwopus",
+                                                     NumDecodeThreads())} {
     static const FunctionInfo functions[] = {
         {0, &HwOpus::OpenOpusDecoder, "OpenOpusDecoder"},
         {1, &HwOpus::GetWorkBufferSize, "GetWorkBufferSize"},
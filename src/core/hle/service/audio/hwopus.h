@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include "core/hle/service/service.h"
 
+namespace Service {
+class ServiceThread;
+}
+
 namespace Service::Audio {
 
 class HwOpus final : public ServiceFramework<HwOpus> {
@@ -16,6 +22,9 @@ public:
 private:
     void OpenOpusDecoder(Kernel::HLERequestContext& ctx);
     void GetWorkBufferSize(Kernel::HLERequestContext& ctx);
+
+    /// Decodes the packets of all the decoders opened through this service
+    std::shared_ptr<ServiceThread> service_thread;
 };
 
 } // namespace Service::Audio
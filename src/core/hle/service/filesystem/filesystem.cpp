@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <map>
 #include <utility>
 
 #include "common/assert.h"
@@ -19,6 +20,7 @@
 #include "core/file_sys/sdmc_factory.h"
 #include "core/file_sys/vfs.h"
 #include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_write_back.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/filesystem/fsp_ldr.h"
@@ -46,8 +48,9 @@ static FileSys::VirtualDir GetDirectoryRelativeWrapped(FileSys::VirtualDir base,
     return base->GetDirectoryRelative(dir_name);
 }
 
-VfsDirectoryServiceWrapper::VfsDirectoryServiceWrapper(FileSys::VirtualDir backing_)
-    : backing(std::move(backing_)) {}
+VfsDirectoryServiceWrapper::VfsDirectoryServiceWrapper(
+    FileSys::VirtualDir backing_, std::shared_ptr<FileSys::WriteBackCache> write_back_cache_)
+    : backing(std::move(backing_)), write_back_cache(std::move(write_back_cache_)) {}
 
 VfsDirectoryServiceWrapper::~VfsDirectoryServiceWrapper() = default;
 
@@ -56,6 +59,7 @@ std::string VfsDirectoryServiceWrapper::GetName() const {
 }
 
 ResultCode VfsDirectoryServiceWrapper::CreateFile(const std::string& path_, u64 size) const {
+    DetachWriteBackCache();
     std::string path(FileUtil::SanitizePath(path_));
     auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
     auto file = dir->CreateFile(FileUtil::GetFilename(path));
@@ -71,6 +75,7 @@ ResultCode VfsDirectoryServiceWrapper::CreateFile(const std::string& path_, u64
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteFile(const std::string& path_) const {
+    DetachWriteBackCache();
     std::string path(FileUtil::SanitizePath(path_));
     if (path.empty()) {
         // TODO(DarkLordZach): Why do games call this and what should it do? Works as is but...
@@ -90,6 +95,7 @@ ResultCode VfsDirectoryServiceWrapper::DeleteFile(const std::string& path_) cons
 }
 
 ResultCode VfsDirectoryServiceWrapper::CreateDirectory(const std::string& path_) const {
+    DetachWriteBackCache();
     std::string path(FileUtil::SanitizePath(path_));
     auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
     if (dir == nullptr && FileUtil::GetFilename(FileUtil::GetParentPath(path)).empty())
@@ -103,6 +109,7 @@ ResultCode VfsDirectoryServiceWrapper::CreateDirectory(const std::string& path_)
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteDirectory(const std::string& path_) const {
+    DetachWriteBackCache();
     std::string path(FileUtil::SanitizePath(path_));
     auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
     if (!dir->DeleteSubdirectory(FileUtil::GetFilename(path))) {
@@ -113,6 +120,7 @@ ResultCode VfsDirectoryServiceWrapper::DeleteDirectory(const std::string& path_)
 }
 
 ResultCode VfsDirectoryServiceWrapper::DeleteDirectoryRecursively(const std::string& path_) const {
+    DetachWriteBackCache();
     std::string path(FileUtil::SanitizePath(path_));
     auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(path));
     if (!dir->DeleteSubdirectoryRecursive(FileUtil::GetFilename(path))) {
@@ -123,6 +131,7 @@ ResultCode VfsDirectoryServiceWrapper::DeleteDirectoryRecursively(const std::str
 }
 
 ResultCode VfsDirectoryServiceWrapper::CleanDirectoryRecursively(const std::string& path) const {
+    DetachWriteBackCache();
     const std::string sanitized_path(FileUtil::SanitizePath(path));
     auto dir = GetDirectoryRelativeWrapped(backing, FileUtil::GetParentPath(sanitized_path));
 
@@ -136,6 +145,7 @@ ResultCode VfsDirectoryServiceWrapper::CleanDirectoryRecursively(const std::stri
 
 ResultCode VfsDirectoryServiceWrapper::RenameFile(const std::string& src_path_,
                                                   const std::string& dest_path_) const {
+    DetachWriteBackCache();
     std::string src_path(FileUtil::SanitizePath(src_path_));
     std::string dest_path(FileUtil::SanitizePath(dest_path_));
     auto src = backing->GetFileRelative(src_path);
@@ -171,6 +181,7 @@ ResultCode VfsDirectoryServiceWrapper::RenameFile(const std::string& src_path_,
 
 ResultCode VfsDirectoryServiceWrapper::RenameDirectory(const std::string& src_path_,
                                                        const std::string& dest_path_) const {
+    DetachWriteBackCache();
     std::string src_path(FileUtil::SanitizePath(src_path_));
     std::string dest_path(FileUtil::SanitizePath(dest_path_));
     auto src = GetDirectoryRelativeWrapped(backing, src_path);
@@ -208,6 +219,10 @@ ResultVal<FileSys::VirtualFile> VfsDirectoryServiceWrapper::OpenFile(const std::
         return FileSys::ERROR_PATH_NOT_FOUND;
     }
 
+    if (write_back_cache != nullptr) {
+        file = write_back_cache->OpenFile(std::string(npath), std::move(file));
+    }
+
     if (mode == FileSys::Mode::Append) {
         return MakeResult<FileSys::VirtualFile>(
             std::make_shared<FileSys::OffsetVfsFile>(file, 0, file->GetSize()));
@@ -217,6 +232,9 @@ ResultVal<FileSys::VirtualFile> VfsDirectoryServiceWrapper::OpenFile(const std::
 }
 
 ResultVal<FileSys::VirtualDir> VfsDirectoryServiceWrapper::OpenDirectory(const std::string& path_) {
+    // The entries of the directory are listed with the sizes of the files on disk
+    Commit();
+
     std::string path(FileUtil::SanitizePath(path_));
     auto dir = GetDirectoryRelativeWrapped(backing, path);
     if (dir == nullptr) {
@@ -251,6 +269,20 @@ ResultVal<FileSys::EntryType> VfsDirectoryServiceWrapper::GetEntryType(
     return FileSys::ERROR_PATH_NOT_FOUND;
 }
 
+ResultCode VfsDirectoryServiceWrapper::Commit() const {
+    if (write_back_cache != nullptr && !write_back_cache->Commit()) {
+        // The error code of a failed commit is unknown
+        return ResultCode(-1);
+    }
+    return RESULT_SUCCESS;
+}
+
+void VfsDirectoryServiceWrapper::DetachWriteBackCache() const {
+    if (write_back_cache != nullptr) {
+        write_back_cache->CommitAndDetach();
+    }
+}
+
 /**
  * Map of registered file systems, identified by type. Once an file system is registered here, it
  * is never removed until UnregisterFileSystems is called.
@@ -333,6 +365,28 @@ ResultVal<FileSys::VirtualDir> OpenSaveData(FileSys::SaveDataSpaceId space,
     return save_data_factory->Open(space, descriptor);
 }
 
+std::shared_ptr<FileSys::WriteBackCache> GetSaveDataWriteBackCache(
+    const FileSys::VirtualDir& save_data) {
+    // The caches are alive as long as a file system or a file of their directory is open
+    static std::map<std::string, std::weak_ptr<FileSys::WriteBackCache>> write_back_caches;
+
+    for (auto iter = write_back_caches.begin(); iter != write_back_caches.end();) {
+        if (iter->second.expired()) {
+            iter = write_back_caches.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    auto& cache = write_back_caches[save_data->GetFullPath()];
+    auto out = cache.lock();
+    if (out == nullptr) {
+        out = std::make_shared<FileSys::WriteBackCache>(save_data);
+        cache = out;
+    }
+    return out;
+}
+
 ResultVal<FileSys::VirtualDir> OpenSaveDataSpace(FileSys::SaveDataSpaceId space) {
     LOG_TRACE(Service_FS, "Opening Save Data Space for space_id={:01X}", static_cast<u8>(space));
 
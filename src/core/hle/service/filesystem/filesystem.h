@@ -17,6 +17,7 @@ class RegisteredCacheUnion;
 class RomFSFactory;
 class SaveDataFactory;
 class SDMCFactory;
+class WriteBackCache;
 
 enum class ContentRecordType : u8;
 enum class Mode : u32;
@@ -48,6 +49,11 @@ ResultVal<FileSys::VirtualFile> OpenRomFS(u64 title_id, FileSys::StorageId stora
 ResultVal<FileSys::VirtualDir> OpenSaveData(FileSys::SaveDataSpaceId space,
                                             const FileSys::SaveDataDescriptor& descriptor);
 ResultVal<FileSys::VirtualDir> OpenSaveDataSpace(FileSys::SaveDataSpaceId space);
+
+/// Returns the cache holding the uncommitted writes to a save data directory, it is shared by all
+/// the file systems mounting the directory at the same time
+std::shared_ptr<FileSys::WriteBackCache> GetSaveDataWriteBackCache(
+    const FileSys::VirtualDir& save_data);
 ResultVal<FileSys::VirtualDir> OpenSDMC();
 
 FileSys::SaveDataSize ReadSaveDataSize(FileSys::SaveDataType type, u64 title_id, u128 user_id);
@@ -72,7 +78,14 @@ void InstallInterfaces(SM::ServiceManager& service_manager, FileSys::VfsFilesyst
 // avoids repetitive code.
 class VfsDirectoryServiceWrapper {
 public:
-    explicit VfsDirectoryServiceWrapper(FileSys::VirtualDir backing);
+    /**
+     * @param backing The directory of the archive
+     * @param write_back_cache If set, writes to the files of the archive are kept in it until they
+     * are committed
+     */
+    explicit VfsDirectoryServiceWrapper(
+        FileSys::VirtualDir backing,
+        std::shared_ptr<FileSys::WriteBackCache> write_back_cache = nullptr);
     ~VfsDirectoryServiceWrapper();
 
     /**
@@ -171,8 +184,18 @@ public:
      */
     ResultVal<FileSys::EntryType> GetEntryType(const std::string& path) const;
 
+    /**
+     * Writes the pending writes to the files of the archive
+     * @return Result of the operation
+     */
+    ResultCode Commit() const;
+
 private:
+    /// Commits the pending writes before the entries of the archive are changed
+    void DetachWriteBackCache() const;
+
     FileSys::VirtualDir backing;
+    std::shared_ptr<FileSys::WriteBackCache> write_back_cache;
 };
 
 } // namespace FileSystem
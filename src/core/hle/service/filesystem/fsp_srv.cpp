@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include <iterator>
@@ -40,6 +41,20 @@ enum class FileSystemType : u8 {
     ApplicationPackage = 7,
 };
 
+/// Size of the reads of a file that is read sequentially, later reads are served from memory
+constexpr std::size_t FILE_READ_AHEAD_SIZE = 0x100000;
+
+/// Clamps the length of a read to the size of the output buffer it is read into
+static std::size_t ClampReadLength(s64 length, std::size_t buffer_size) {
+    const auto read_length = static_cast<std::size_t>(length);
+    if (read_length > buffer_size) {
+        LOG_CRITICAL(Service_FS, "Read length={} is greater than the buffer size={}", read_length,
+                     buffer_size);
+        return buffer_size;
+    }
+    return read_length;
+}
+
 class IStorage final : public ServiceFramework<IStorage> {
 public:
     explicit IStorage(FileSys::VirtualFile backend_)
@@ -79,10 +94,9 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-        // Write the data to memory
-        ctx.WriteBuffer(output);
+        // Read the data from the Storage backend straight into the output buffer
+        const Kernel::BufferSpan<u8> output = ctx.WriteBufferSpan();
+        backend->Read(output.data(), ClampReadLength(length, output.size()), offset);
 
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
@@ -101,7 +115,9 @@ private:
 class IFile final : public ServiceFramework<IFile> {
 public:
     explicit IFile(FileSys::VirtualFile backend_)
-        : ServiceFramework("IFile"), backend(std::move(backend_)) {
+        : ServiceFramework("IFile"), backend(std::move(backend_)),
+          // The buffer doesn't see writes made through other files, only read-only files use it
+          read_ahead_enabled(!backend->IsWritable()) {
         static const FunctionInfo functions[] = {
             {0, &IFile::Read, "Read"},       {1, &IFile::Write, "Write"},
             {2, &IFile::Flush, "Flush"},     {3, &IFile::SetSize, "SetSize"},
@@ -113,6 +129,39 @@ public:
 private:
     FileSys::VirtualFile backend;
 
+    const bool read_ahead_enabled;
+    std::vector<u8> read_ahead_buffer;
+    std::size_t read_ahead_offset = 0;
+    std::size_t next_sequential_offset = 0; ///< End of the last read
+
+    /**
+     * Reads from the backend, sequential reads smaller than FILE_READ_AHEAD_SIZE are widened to
+     * FILE_READ_AHEAD_SIZE so that the reads after them are copied from memory. Games usually read
+     * their files in small chunks, the backend is then only hit once per chunk of read-ahead.
+     */
+    std::size_t ReadWithReadAhead(u8* data, std::size_t length, std::size_t offset) {
+        const bool is_sequential = offset == next_sequential_offset;
+        next_sequential_offset = offset + length;
+
+        if (offset >= read_ahead_offset &&
+            offset + length <= read_ahead_offset + read_ahead_buffer.size()) {
+            std::memcpy(data, read_ahead_buffer.data() + (offset - read_ahead_offset), length);
+            return length;
+        }
+        if (!read_ahead_enabled || !is_sequential || length >= FILE_READ_AHEAD_SIZE) {
+            return backend->Read(data, length, offset);
+        }
+
+        read_ahead_buffer.resize(FILE_READ_AHEAD_SIZE);
+        read_ahead_buffer.resize(
+            backend->Read(read_ahead_buffer.data(), read_ahead_buffer.size(), offset));
+        read_ahead_offset = offset;
+
+        const std::size_t read_size = std::min(length, read_ahead_buffer.size());
+        std::memcpy(data, read_ahead_buffer.data(), read_size);
+        return read_size;
+    }
+
     void Read(Kernel::HLERequestContext& ctx) {
         IPC::RequestParser rp{ctx};
         const u64 option = rp.Pop<u64>();
@@ -136,15 +185,15 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-
-        // Write the data to memory
-        ctx.WriteBuffer(output);
+        // Read the data from the Storage backend straight into the output buffer
+        const Kernel::BufferSpan<u8> output = ctx.WriteBufferSpan();
+        const std::size_t read_size =
+            ReadWithReadAhead(output.data(), ClampReadLength(length, output.size()),
+                              static_cast<std::size_t>(offset));
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
-        rb.Push(static_cast<u64>(output.size()));
+        rb.Push(static_cast<u64>(read_size));
     }
 
     void Write(Kernel::HLERequestContext& ctx) {
@@ -170,7 +219,7 @@ private:
             return;
         }
 
-        const std::vector<u8> data = ctx.ReadBuffer();
+        const Kernel::BufferSpan<const u8> data = ctx.ReadBufferSpan();
 
         ASSERT_MSG(
             static_cast<s64>(data.size()) <= length,
@@ -178,8 +227,8 @@ private:
             length, data.size());
 
         // Write the data to the Storage backend
-        const auto write_size =
-            static_cast<std::size_t>(std::distance(data.begin(), data.begin() + length));
+        read_ahead_buffer.clear();
+        const auto write_size = std::min(static_cast<std::size_t>(length), data.size());
         const std::size_t written = backend->Write(data.data(), write_size, offset);
 
         ASSERT_MSG(static_cast<s64>(written) == length,
@@ -204,6 +253,7 @@ private:
         const u64 size = rp.Pop<u64>();
         LOG_DEBUG(Service_FS, "called, size={}", size);
 
+        read_ahead_buffer.clear();
         backend->Resize(size);
 
         IPC::ResponseBuilder rb{ctx, 2};
@@ -288,8 +338,10 @@ private:
 
 class IFileSystem final : public ServiceFramework<IFileSystem> {
 public:
-    explicit IFileSystem(FileSys::VirtualDir backend)
-        : ServiceFramework("IFileSystem"), backend(std::move(backend)) {
+    explicit IFileSystem(FileSys::VirtualDir backend,
+                         std::shared_ptr<FileSys::WriteBackCache> write_back_cache = nullptr)
+        : ServiceFramework("IFileSystem"),
+          backend(std::move(backend), std::move(write_back_cache)) {
         static const FunctionInfo functions[] = {
             {0, &IFileSystem::CreateFile, "CreateFile"},
             {1, &IFileSystem::DeleteFile, "DeleteFile"},
@@ -460,10 +512,10 @@ public:
     }
 
     void Commit(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_FS, "(STUBBED) called");
+        LOG_DEBUG(Service_FS, "called");
 
         IPC::ResponseBuilder rb{ctx, 2};
-        rb.Push(RESULT_SUCCESS);
+        rb.Push(backend.Commit());
     }
 
 private:
@@ -792,7 +844,9 @@ void FSP_SRV::OpenSaveDataFileSystem(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    IFileSystem filesystem(std::move(dir.Unwrap()));
+    // Save data is only written to disk when it is committed, like the journal on hardware
+    auto write_back_cache = GetSaveDataWriteBackCache(*dir);
+    IFileSystem filesystem(std::move(dir.Unwrap()), std::move(write_back_cache));
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
@@ -27,9 +27,12 @@ public:
     virtual void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data,
                           std::size_t size) = 0;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     virtual void OnLoadInputDevices() = 0;
 
+    // Called on the input thread to sample the input devices for the next updates
+    virtual void OnSampleInput() = 0;
+
     void ActivateController();
 
     void DeactivateController();
@@ -42,26 +42,27 @@ void Controller_DebugPad::OnUpdate(const Core::Timing::CoreTiming& core_timing,
     cur_entry.attribute.connected.Assign(1);
     auto& pad = cur_entry.pad_state;
 
+    const InputState& state = input_state.Read();
     using namespace Settings::NativeButton;
-    pad.a.Assign(buttons[A - BUTTON_HID_BEGIN]->GetStatus());
-    pad.b.Assign(buttons[B - BUTTON_HID_BEGIN]->GetStatus());
-    pad.x.Assign(buttons[X - BUTTON_HID_BEGIN]->GetStatus());
-    pad.y.Assign(buttons[Y - BUTTON_HID_BEGIN]->GetStatus());
-    pad.l.Assign(buttons[L - BUTTON_HID_BEGIN]->GetStatus());
-    pad.r.Assign(buttons[R - BUTTON_HID_BEGIN]->GetStatus());
-    pad.zl.Assign(buttons[ZL - BUTTON_HID_BEGIN]->GetStatus());
-    pad.zr.Assign(buttons[ZR - BUTTON_HID_BEGIN]->GetStatus());
-    pad.plus.Assign(buttons[Plus - BUTTON_HID_BEGIN]->GetStatus());
-    pad.minus.Assign(buttons[Minus - BUTTON_HID_BEGIN]->GetStatus());
-    pad.d_left.Assign(buttons[DLeft - BUTTON_HID_BEGIN]->GetStatus());
-    pad.d_up.Assign(buttons[DUp - BUTTON_HID_BEGIN]->GetStatus());
-    pad.d_right.Assign(buttons[DRight - BUTTON_HID_BEGIN]->GetStatus());
-    pad.d_down.Assign(buttons[DDown - BUTTON_HID_BEGIN]->GetStatus());
+    pad.a.Assign(state.buttons[A - BUTTON_HID_BEGIN]);
+    pad.b.Assign(state.buttons[B - BUTTON_HID_BEGIN]);
+    pad.x.Assign(state.buttons[X - BUTTON_HID_BEGIN]);
+    pad.y.Assign(state.buttons[Y - BUTTON_HID_BEGIN]);
+    pad.l.Assign(state.buttons[L - BUTTON_HID_BEGIN]);
+    pad.r.Assign(state.buttons[R - BUTTON_HID_BEGIN]);
+    pad.zl.Assign(state.buttons[ZL - BUTTON_HID_BEGIN]);
+    pad.zr.Assign(state.buttons[ZR - BUTTON_HID_BEGIN]);
+    pad.plus.Assign(state.buttons[Plus - BUTTON_HID_BEGIN]);
+    pad.minus.Assign(state.buttons[Minus - BUTTON_HID_BEGIN]);
+    pad.d_left.Assign(state.buttons[DLeft - BUTTON_HID_BEGIN]);
+    pad.d_up.Assign(state.buttons[DUp - BUTTON_HID_BEGIN]);
+    pad.d_right.Assign(state.buttons[DRight - BUTTON_HID_BEGIN]);
+    pad.d_down.Assign(state.buttons[DDown - BUTTON_HID_BEGIN]);
 
     const auto [stick_l_x_f, stick_l_y_f] =
-        analogs[static_cast<std::size_t>(JoystickId::Joystick_Left)]->GetStatus();
+        state.analogs[static_cast<std::size_t>(JoystickId::Joystick_Left)];
     const auto [stick_r_x_f, stick_r_y_f] =
-        analogs[static_cast<std::size_t>(JoystickId::Joystick_Right)]->GetStatus();
+        state.analogs[static_cast<std::size_t>(JoystickId::Joystick_Right)];
     cur_entry.l_stick.x = static_cast<s32>(stick_l_x_f * HID_JOYSTICK_MAX);
     cur_entry.l_stick.y = static_cast<s32>(stick_l_y_f * HID_JOYSTICK_MAX);
     cur_entry.r_stick.x = static_cast<s32>(stick_r_x_f * HID_JOYSTICK_MAX);
@@ -79,4 +80,15 @@ void Controller_DebugPad::OnLoadInputDevices() {
                    Settings::values.debug_pad_analogs.end(), analogs.begin(),
                    Input::CreateDevice<Input::AnalogDevice>);
 }
+
+void Controller_DebugPad::OnSampleInput() {
+    InputState& state = input_state.GetWriteBuffer();
+    for (std::size_t i = 0; i < buttons.size(); ++i) {
+        state.buttons[i] = buttons[i]->GetStatus();
+    }
+    for (std::size_t i = 0; i < analogs.size(); ++i) {
+        state.analogs[i] = analogs[i]->GetStatus();
+    }
+    input_state.Publish();
+}
 } // namespace Service::HID
@@ -9,6 +9,7 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/triple_buffer.h"
 #include "core/frontend/input.h"
 #include "core/hle/service/hid/controllers/controller_base.h"
 #include "core/settings.h"
@@ -28,9 +29,12 @@ public:
     // When the controller is requesting an update for the shared memory
     void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data, std::size_t size) override;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     void OnLoadInputDevices() override;
 
+    // Called on the input thread to sample the input devices for the next updates
+    void OnSampleInput() override;
+
 private:
     struct AnalogStick {
         s32_le x;
@@ -89,5 +93,11 @@ private:
         buttons;
     std::array<std::unique_ptr<Input::AnalogDevice>, Settings::NativeAnalog::NUM_STICKS_HID>
         analogs;
+
+    struct InputState {
+        std::array<bool, Settings::NativeButton::NUM_BUTTONS_HID> buttons;
+        std::array<std::tuple<float, float>, Settings::NativeAnalog::NUM_STICKS_HID> analogs;
+    };
+    Common::TripleBuffer<InputState> input_state;
 };
 } // namespace Service::HID
@@ -41,4 +41,6 @@ void Controller_Gesture::OnUpdate(const Core::Timing::CoreTiming& core_timing, u
 }
 
 void Controller_Gesture::OnLoadInputDevices() {}
+
+void Controller_Gesture::OnSampleInput() {}
 } // namespace Service::HID
@@ -24,9 +24,12 @@ public:
     // When the controller is requesting an update for the shared memory
     void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data, size_t size) override;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     void OnLoadInputDevices() override;
 
+    // Called on the input thread to sample the input devices for the next updates
+    void OnSampleInput() override;
+
 private:
     struct Locations {
         s32_le x;
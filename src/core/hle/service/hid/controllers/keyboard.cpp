@@ -38,14 +38,15 @@ void Controller_Keyboard::OnUpdate(const Core::Timing::CoreTiming& core_timing,
     cur_entry.sampling_number = last_entry.sampling_number + 1;
     cur_entry.sampling_number2 = cur_entry.sampling_number;
 
-    for (std::size_t i = 0; i < keyboard_keys.size(); ++i) {
+    const InputState& state = input_state.Read();
+    for (std::size_t i = 0; i < state.keys.size(); ++i) {
         for (std::size_t k = 0; k < KEYS_PER_BYTE; ++k) {
-            cur_entry.key[i / KEYS_PER_BYTE] |= (keyboard_keys[i]->GetStatus() << k);
+            cur_entry.key[i / KEYS_PER_BYTE] |= (state.keys[i] << k);
         }
     }
 
-    for (std::size_t i = 0; i < keyboard_mods.size(); ++i) {
-        cur_entry.modifier |= (keyboard_mods[i]->GetStatus() << i);
+    for (std::size_t i = 0; i < state.mods.size(); ++i) {
+        cur_entry.modifier |= (state.mods[i] << i);
     }
 
     std::memcpy(data + SHARED_MEMORY_OFFSET, &shared_memory, sizeof(SharedMemory));
@@ -57,4 +58,15 @@ void Controller_Keyboard::OnLoadInputDevices() {
     std::transform(Settings::values.keyboard_mods.begin(), Settings::values.keyboard_mods.end(),
                    keyboard_mods.begin(), Input::CreateDevice<Input::ButtonDevice>);
 }
+
+void Controller_Keyboard::OnSampleInput() {
+    InputState& state = input_state.GetWriteBuffer();
+    for (std::size_t i = 0; i < keyboard_keys.size(); ++i) {
+        state.keys[i] = keyboard_keys[i]->GetStatus();
+    }
+    for (std::size_t i = 0; i < keyboard_mods.size(); ++i) {
+        state.mods[i] = keyboard_mods[i]->GetStatus();
+    }
+    input_state.Publish();
+}
 } // namespace Service::HID
@@ -8,6 +8,7 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/triple_buffer.h"
 #include "core/frontend/input.h"
 #include "core/hle/service/hid/controllers/controller_base.h"
 #include "core/settings.h"
@@ -27,9 +28,12 @@ public:
     // When the controller is requesting an update for the shared memory
     void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data, std::size_t size) override;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     void OnLoadInputDevices() override;
 
+    // Called on the input thread to sample the input devices for the next updates
+    void OnSampleInput() override;
+
 private:
     struct KeyboardState {
         s64_le sampling_number;
@@ -53,5 +57,11 @@ private:
         keyboard_keys;
     std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeKeyboard::NumKeyboardMods>
         keyboard_mods;
+
+    struct InputState {
+        std::array<bool, Settings::NativeKeyboard::NumKeyboardKeys> keys;
+        std::array<bool, Settings::NativeKeyboard::NumKeyboardMods> mods;
+    };
+    Common::TripleBuffer<InputState> input_state;
 };
 } // namespace Service::HID
@@ -37,7 +37,8 @@ void Controller_Mouse::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8*
     cur_entry.sampling_number2 = cur_entry.sampling_number;
 
     if (Settings::values.mouse_enabled) {
-        const auto [px, py, sx, sy] = mouse_device->GetStatus();
+        const InputState& state = input_state.Read();
+        const auto [px, py, sx, sy] = state.mouse;
         const auto x = static_cast<s32>(px * Layout::ScreenUndocked::Width);
         const auto y = static_cast<s32>(py * Layout::ScreenUndocked::Height);
         cur_entry.x = x;
@@ -47,8 +48,8 @@ void Controller_Mouse::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8*
         cur_entry.mouse_wheel_x = sx;
         cur_entry.mouse_wheel_y = sy;
 
-        for (std::size_t i = 0; i < mouse_button_devices.size(); ++i) {
-            cur_entry.button |= (mouse_button_devices[i]->GetStatus() << i);
+        for (std::size_t i = 0; i < state.buttons.size(); ++i) {
+            cur_entry.button |= (state.buttons[i] << i);
         }
     }
 
@@ -60,4 +61,13 @@ void Controller_Mouse::OnLoadInputDevices() {
     std::transform(Settings::values.mouse_buttons.begin(), Settings::values.mouse_buttons.end(),
                    mouse_button_devices.begin(), Input::CreateDevice<Input::ButtonDevice>);
 }
+
+void Controller_Mouse::OnSampleInput() {
+    InputState& state = input_state.GetWriteBuffer();
+    state.mouse = mouse_device->GetStatus();
+    for (std::size_t i = 0; i < mouse_button_devices.size(); ++i) {
+        state.buttons[i] = mouse_button_devices[i]->GetStatus();
+    }
+    input_state.Publish();
+}
 } // namespace Service::HID
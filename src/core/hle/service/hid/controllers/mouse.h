@@ -7,6 +7,7 @@
 #include <array>
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/triple_buffer.h"
 #include "core/frontend/input.h"
 #include "core/hle/service/hid/controllers/controller_base.h"
 #include "core/settings.h"
@@ -26,9 +27,12 @@ public:
     // When the controller is requesting an update for the shared memory
     void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data, std::size_t size) override;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     void OnLoadInputDevices() override;
 
+    // Called on the input thread to sample the input devices for the next updates
+    void OnSampleInput() override;
+
 private:
     struct MouseState {
         s64_le sampling_number;
@@ -53,5 +57,11 @@ private:
     std::unique_ptr<Input::MouseDevice> mouse_device;
     std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeMouseButton::NumMouseButtons>
         mouse_button_devices;
+
+    struct InputState {
+        std::tuple<float, float, s32, s32> mouse;
+        std::array<bool, Settings::NativeMouseButton::NumMouseButtons> buttons;
+    };
+    Common::TripleBuffer<InputState> input_state;
 };
 } // namespace Service::HID
@@ -232,6 +232,17 @@ void Controller_NPad::OnLoadInputDevices() {
     }
 }
 
+void Controller_NPad::OnSampleInput() {
+    InputState& state = input_state.GetWriteBuffer();
+    for (std::size_t i = 0; i < buttons.size(); ++i) {
+        std::transform(buttons[i].begin(), buttons[i].end(), state.buttons[i].begin(),
+                       [](const auto& button) { return button->GetStatus(); });
+        std::transform(sticks[i].begin(), sticks[i].end(), state.sticks[i].begin(),
+                       [](const auto& stick) { return stick->GetStatus(); });
+    }
+    input_state.Publish();
+}
+
 void Controller_NPad::OnRelease() {}
 
 void Controller_NPad::RequestPadStateUpdate(u32 npad_id) {
@@ -243,45 +254,46 @@ void Controller_NPad::RequestPadStateUpdate(u32 npad_id) {
     auto& pad_state = npad_pad_states[controller_idx].pad_states;
     auto& lstick_entry = npad_pad_states[controller_idx].l_stick;
     auto& rstick_entry = npad_pad_states[controller_idx].r_stick;
-    const auto& button_state = buttons[controller_idx];
-    const auto& analog_state = sticks[controller_idx];
+    const InputState& state = input_state.Read();
+    const auto& button_state = state.buttons[controller_idx];
+    const auto& analog_state = state.sticks[controller_idx];
 
     using namespace Settings::NativeButton;
-    pad_state.a.Assign(button_state[A - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.b.Assign(button_state[B - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.x.Assign(button_state[X - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.y.Assign(button_state[Y - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.l_stick.Assign(button_state[LStick - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.r_stick.Assign(button_state[RStick - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.l.Assign(button_state[L - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.r.Assign(button_state[R - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.zl.Assign(button_state[ZL - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.zr.Assign(button_state[ZR - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.plus.Assign(button_state[Plus - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.minus.Assign(button_state[Minus - BUTTON_HID_BEGIN]->GetStatus());
-
-    pad_state.d_left.Assign(button_state[DLeft - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.d_up.Assign(button_state[DUp - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.d_right.Assign(button_state[DRight - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.d_down.Assign(button_state[DDown - BUTTON_HID_BEGIN]->GetStatus());
-
-    pad_state.l_stick_left.Assign(button_state[LStick_Left - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.l_stick_up.Assign(button_state[LStick_Up - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.l_stick_right.Assign(button_state[LStick_Right - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.l_stick_down.Assign(button_state[LStick_Down - BUTTON_HID_BEGIN]->GetStatus());
-
-    pad_state.r_stick_left.Assign(button_state[RStick_Left - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.r_stick_up.Assign(button_state[RStick_Up - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.r_stick_right.Assign(button_state[RStick_Right - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.r_stick_down.Assign(button_state[RStick_Down - BUTTON_HID_BEGIN]->GetStatus());
-
-    pad_state.left_sl.Assign(button_state[SL - BUTTON_HID_BEGIN]->GetStatus());
-    pad_state.left_sr.Assign(button_state[SR - BUTTON_HID_BEGIN]->GetStatus());
+    pad_state.a.Assign(button_state[A - BUTTON_HID_BEGIN]);
+    pad_state.b.Assign(button_state[B - BUTTON_HID_BEGIN]);
+    pad_state.x.Assign(button_state[X - BUTTON_HID_BEGIN]);
+    pad_state.y.Assign(button_state[Y - BUTTON_HID_BEGIN]);
+    pad_state.l_stick.Assign(button_state[LStick - BUTTON_HID_BEGIN]);
+    pad_state.r_stick.Assign(button_state[RStick - BUTTON_HID_BEGIN]);
+    pad_state.l.Assign(button_state[L - BUTTON_HID_BEGIN]);
+    pad_state.r.Assign(button_state[R - BUTTON_HID_BEGIN]);
+    pad_state.zl.Assign(button_state[ZL - BUTTON_HID_BEGIN]);
+    pad_state.zr.Assign(button_state[ZR - BUTTON_HID_BEGIN]);
+    pad_state.plus.Assign(button_state[Plus - BUTTON_HID_BEGIN]);
+    pad_state.minus.Assign(button_state[Minus - BUTTON_HID_BEGIN]);
+
+    pad_state.d_left.Assign(button_state[DLeft - BUTTON_HID_BEGIN]);
+    pad_state.d_up.Assign(button_state[DUp - BUTTON_HID_BEGIN]);
+    pad_state.d_right.Assign(button_state[DRight - BUTTON_HID_BEGIN]);
+    pad_state.d_down.Assign(button_state[DDown - BUTTON_HID_BEGIN]);
+
+    pad_state.l_stick_left.Assign(button_state[LStick_Left - BUTTON_HID_BEGIN]);
+    pad_state.l_stick_up.Assign(button_state[LStick_Up - BUTTON_HID_BEGIN]);
+    pad_state.l_stick_right.Assign(button_state[LStick_Right - BUTTON_HID_BEGIN]);
+    pad_state.l_stick_down.Assign(button_state[LStick_Down - BUTTON_HID_BEGIN]);
+
+    pad_state.r_stick_left.Assign(button_state[RStick_Left - BUTTON_HID_BEGIN]);
+    pad_state.r_stick_up.Assign(button_state[RStick_Up - BUTTON_HID_BEGIN]);
+    pad_state.r_stick_right.Assign(button_state[RStick_Right - BUTTON_HID_BEGIN]);
+    pad_state.r_stick_down.Assign(button_state[RStick_Down - BUTTON_HID_BEGIN]);
+
+    pad_state.left_sl.Assign(button_state[SL - BUTTON_HID_BEGIN]);
+    pad_state.left_sr.Assign(button_state[SR - BUTTON_HID_BEGIN]);
 
     const auto [stick_l_x_f, stick_l_y_f] =
-        analog_state[static_cast<std::size_t>(JoystickId::Joystick_Left)]->GetStatus();
+        analog_state[static_cast<std::size_t>(JoystickId::Joystick_Left)];
     const auto [stick_r_x_f, stick_r_y_f] =
-        analog_state[static_cast<std::size_t>(JoystickId::Joystick_Right)]->GetStatus();
+        analog_state[static_cast<std::size_t>(JoystickId::Joystick_Right)];
     lstick_entry.x = static_cast<s32>(stick_l_x_f * HID_JOYSTICK_MAX);
     lstick_entry.y = static_cast<s32>(stick_l_y_f * HID_JOYSTICK_MAX);
     rstick_entry.x = static_cast<s32>(stick_r_x_f * HID_JOYSTICK_MAX);
@@ -7,6 +7,7 @@
 #include <array>
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/triple_buffer.h"
 #include "core/frontend/input.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/writable_event.h"
@@ -32,9 +33,12 @@ public:
     // When the controller is requesting an update for the shared memory
     void OnUpdate(const Core::Timing::CoreTiming& core_timing, u8* data, std::size_t size) override;
 
-    // Called when input devices should be loaded
+    // Called on the input thread when input devices should be loaded
     void OnLoadInputDevices() override;
 
+    // Called on the input thread to sample the input devices for the next updates
+    void OnSampleInput() override;
+
     struct NPadType {
         union {
             u32_le raw{};
@@ -308,6 +312,15 @@ private:
         std::array<std::unique_ptr<Input::AnalogDevice>, Settings::NativeAnalog::NUM_STICKS_HID>,
         10>
         sticks;
+
+    struct InputState {
+        std::array<std::array<bool, Settings::NativeButton::NUM_BUTTONS_HID>, 10> buttons;
+        std::array<std::array<std::tuple<float, float>, Settings::NativeAnalog::NUM_STICKS_HID>,
+                   10>
+            sticks;
+    };
+    Common::TripleBuffer<InputState> input_state;
+
     std::vector<u32> supported_npad_id_types{};
     NpadHoldType hold_type{NpadHoldType::Vertical};
     Kernel::EventPair styleset_changed_event;
@@ -33,6 +33,8 @@ void Controller_Stubbed::OnUpdate(const Core::Timing::CoreTiming& core_timing, u
 
 void Controller_Stubbed::OnLoadInputDevices() {}
 
+void Controller_Stubbed::OnSampleInput() {}
+
 void Controller_Stubbed::SetCommonHeaderOffset(std::size_t off) {
     common_offset = off;
     smart_update = true;
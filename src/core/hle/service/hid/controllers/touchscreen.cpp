@@ -40,7 +40,7 @@ void Controller_Touchscreen::OnUpdate(const Core::Timing::CoreTiming& core_timin
     cur_entry.sampling_number = last_entry.sampling_number + 1;
     cur_entry.sampling_number2 = cur_entry.sampling_number;
 
-    const auto [x, y, pressed] = touch_device->GetStatus();
+    const auto [x, y, pressed] = touch_state.Read();
     auto& touch_entry = cur_entry.states[0];
     touch_entry.attribute.raw = 0;
     if (pressed && Settings::values.touchscreen.enabled) {
@@ -64,4 +64,9 @@ void Controller_Touchscreen::OnUpdate(const Core::Timing::CoreTiming& core_timin
 void Controller_Touchscreen::OnLoadInputDevices() {
     touch_device = Input::CreateDevice<Input::TouchDevice>(Settings::values.touchscreen.device);
 }
+
+void Controller_Touchscreen::OnSampleInput() {
+    touch_state.GetWriteBuffer() = touch_device->GetStatus();
+    touch_state.Publish();
+}
 } // namespace Service::HID
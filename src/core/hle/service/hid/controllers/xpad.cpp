@@ -43,4 +43,6 @@ void Controller_XPad::OnUpdate(const Core::Timing::CoreTiming& core_timing, u8*
 }
 
 void Controller_XPad::OnLoadInputDevices() {}
+
+void Controller_XPad::OnSampleInput() {}
 } // namespace Service::HID
@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <chrono>
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/core_timing_util.h"
@@ -40,6 +42,9 @@ constexpr s64 pad_update_ticks = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE
 constexpr s64 accelerometer_update_ticks = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 100);
 constexpr s64 gyroscope_update_ticks = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 100);
 constexpr std::size_t SHARED_MEMORY_SIZE = 0x40000;
+// Sampling the host input devices much faster than the pads are updated keeps the states copied to
+// the shared memory recent
+constexpr std::chrono::milliseconds input_sample_interval{1};
 
 IAppletResource::IAppletResource() : ServiceFramework("IAppletResource") {
     static const FunctionInfo functions[] = {
@@ -84,6 +89,7 @@ IAppletResource::IAppletResource() : ServiceFramework("IAppletResource") {
     core_timing.ScheduleEvent(pad_update_ticks, pad_update_event);
 
     ReloadInputDevices();
+    input_thread = std::thread{&IAppletResource::RunInputThread, this};
 }
 
 void IAppletResource::ActivateController(HidController controller) {
@@ -96,6 +102,13 @@ void IAppletResource::DeactivateController(HidController controller) {
 
 IAppletResource ::~IAppletResource() {
     Core::System::GetInstance().CoreTiming().UnscheduleEvent(pad_update_event, 0);
+
+    {
+        std::lock_guard lock{input_thread_mutex};
+        is_input_thread_stopping = true;
+    }
+    input_thread_cv.notify_one();
+    input_thread.join();
 }
 
 void IAppletResource::GetSharedMemoryHandle(Kernel::HLERequestContext& ctx) {
@@ -109,17 +122,31 @@ void IAppletResource::GetSharedMemoryHandle(Kernel::HLERequestContext& ctx) {
 void IAppletResource::UpdateControllers(u64 userdata, s64 cycles_late) {
     auto& core_timing = Core::System::GetInstance().CoreTiming();
 
-    const bool should_reload = Settings::values.is_device_reload_pending.exchange(false);
     for (const auto& controller : controllers) {
-        if (should_reload) {
-            controller->OnLoadInputDevices();
-        }
         controller->OnUpdate(core_timing, shared_mem->GetPointer(), SHARED_MEMORY_SIZE);
     }
 
     core_timing.ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
 }
 
+void IAppletResource::RunInputThread() {
+    Common::SetCurrentThreadName("yuzu:HidInput");
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::Background);
+
+    std::unique_lock lock{input_thread_mutex};
+    do {
+        // The input devices are only used by this thread, so they are reloaded here as well
+        const bool should_reload = Settings::values.is_device_reload_pending.exchange(false);
+        for (const auto& controller : controllers) {
+            if (should_reload) {
+                controller->OnLoadInputDevices();
+            }
+            controller->OnSampleInput();
+        }
+    } while (!input_thread_cv.wait_for(lock, input_sample_interval,
+                                       [this] { return is_input_thread_stopping; }));
+}
+
 class IActiveVibrationDeviceList final : public ServiceFramework<IActiveVibrationDeviceList> {
 public:
     IActiveVibrationDeviceList() : ServiceFramework("IActiveVibrationDeviceList") {
@@ -150,14 +177,14 @@ Hid::Hid() : ServiceFramework("hid") {
     // clang-format off
     static const FunctionInfo functions[] = {
         {0, &Hid::CreateAppletResource, "CreateAppletResource"},
-        {1, &Hid::ActivateDebugPad, "ActivateDebugPad"},
-        {11, &Hid::ActivateTouchScreen, "ActivateTouchScreen"},
-        {21, &Hid::ActivateMouse, "ActivateMouse"},
-        {31, &Hid::ActivateKeyboard, "ActivateKeyboard"},
+        {1, Decoded<&Hid::ActivateDebugPad>, "ActivateDebugPad"},
+        {11, Decoded<&Hid::ActivateTouchScreen>, "ActivateTouchScreen"},
+        {21, Decoded<&Hid::ActivateMouse>, "ActivateMouse"},
+        {31, Decoded<&Hid::ActivateKeyboard>, "ActivateKeyboard"},
         {32, nullptr, "SendKeyboardLockKeyEvent"},
         {40, nullptr, "AcquireXpadIdEventHandle"},
         {41, nullptr, "ReleaseXpadIdEventHandle"},
-        {51, &Hid::ActivateXpad, "ActivateXpad"},
+        {51, Decoded<&Hid::ActivateXpad>, "ActivateXpad"},
         {55, nullptr, "GetXpadIds"},
         {56, nullptr, "ActivateJoyXpad"},
         {58, nullptr, "GetJoyXpadLifoHandle"},
@@ -168,7 +195,7 @@ Hid::Hid() : ServiceFramework("hid") {
         {63, nullptr, "ActivateJoySixAxisSensor"},
         {64, nullptr, "DeactivateJoySixAxisSensor"},
         {65, nullptr, "GetJoySixAxisSensorLifoHandle"},
-        {66, &Hid::StartSixAxisSensor, "StartSixAxisSensor"},
+        {66, Decoded<&Hid::StartSixAxisSensor>, "StartSixAxisSensor"},
         {67, &Hid::StopSixAxisSensor, "StopSixAxisSensor"},
         {68, nullptr, "IsSixAxisSensorFusionEnabled"},
         {69, nullptr, "EnableSixAxisSensorFusion"},
@@ -181,24 +208,24 @@ Hid::Hid() : ServiceFramework("hid") {
         {76, nullptr, "SetAccelerometerPlayMode"},
         {77, nullptr, "GetAccelerometerPlayMode"},
         {78, nullptr, "ResetAccelerometerPlayMode"},
-        {79, &Hid::SetGyroscopeZeroDriftMode, "SetGyroscopeZeroDriftMode"},
+        {79, Decoded<&Hid::SetGyroscopeZeroDriftMode>, "SetGyroscopeZeroDriftMode"},
         {80, nullptr, "GetGyroscopeZeroDriftMode"},
         {81, nullptr, "ResetGyroscopeZeroDriftMode"},
-        {82, &Hid::IsSixAxisSensorAtRest, "IsSixAxisSensorAtRest"},
+        {82, Decoded<&Hid::IsSixAxisSensorAtRest>, "IsSixAxisSensorAtRest"},
         {83, nullptr, "IsFirmwareUpdateAvailableForSixAxisSensor"},
-        {91, &Hid::ActivateGesture, "ActivateGesture"},
-        {100, &Hid::SetSupportedNpadStyleSet, "SetSupportedNpadStyleSet"},
-        {101, &Hid::GetSupportedNpadStyleSet, "GetSupportedNpadStyleSet"},
+        {91, Decoded<&Hid::ActivateGesture>, "ActivateGesture"},
+        {100, Decoded<&Hid::SetSupportedNpadStyleSet>, "SetSupportedNpadStyleSet"},
+        {101, Decoded<&Hid::GetSupportedNpadStyleSet>, "GetSupportedNpadStyleSet"},
         {102, &Hid::SetSupportedNpadIdType, "SetSupportedNpadIdType"},
-        {103, &Hid::ActivateNpad, "ActivateNpad"},
+        {103, Decoded<&Hid::ActivateNpad>, "ActivateNpad"},
         {104, nullptr, "DeactivateNpad"},
         {106, &Hid::AcquireNpadStyleSetUpdateEventHandle, "AcquireNpadStyleSetUpdateEventHandle"},
-        {107, &Hid::DisconnectNpad, "DisconnectNpad"},
-        {108, &Hid::GetPlayerLedPattern, "GetPlayerLedPattern"},
-        {109, &Hid::ActivateNpadWithRevision, "ActivateNpadWithRevision"},
-        {120, &Hid::SetNpadJoyHoldType, "SetNpadJoyHoldType"},
-        {121, &Hid::GetNpadJoyHoldType, "GetNpadJoyHoldType"},
-        {122, &Hid::SetNpadJoyAssignmentModeSingleByDefault, "SetNpadJoyAssignmentModeSingleByDefault"},
+        {107, Decoded<&Hid::DisconnectNpad>, "DisconnectNpad"},
+        {108, Decoded<&Hid::GetPlayerLedPattern>, "GetPlayerLedPattern"},
+        {109, Decoded<&Hid::ActivateNpadWithRevision>, "ActivateNpadWithRevision"},
+        {120, Decoded<&Hid::SetNpadJoyHoldType>, "SetNpadJoyHoldType"},
+        {121, Decoded<&Hid::GetNpadJoyHoldType>, "GetNpadJoyHoldType"},
+        {122, Decoded<&Hid::SetNpadJoyAssignmentModeSingleByDefault>, "SetNpadJoyAssignmentModeSingleByDefault"},
         {123, nullptr, "SetNpadJoyAssignmentModeSingleByDefault"},
         {124, &Hid::SetNpadJoyAssignmentModeDual, "SetNpadJoyAssignmentModeDual"},
         {125, &Hid::MergeSingleJoyAsDualJoy, "MergeSingleJoyAsDualJoy"},
@@ -220,7 +247,7 @@ Hid::Hid() : ServiceFramework("hid") {
         {206, &Hid::SendVibrationValues, "SendVibrationValues"},
         {207, nullptr, "SendVibrationGcErmCommand"},
         {208, nullptr, "GetActualVibrationGcErmCommand"},
-        {209, &Hid::BeginPermitVibrationSession, "BeginPermitVibrationSession"},
+        {209, Decoded<&Hid::BeginPermitVibrationSession>, "BeginPermitVibrationSession"},
         {210, &Hid::EndPermitVibrationSession, "EndPermitVibrationSession"},
         {211, nullptr, "IsVibrationDeviceMounted"},
         {300, &Hid::ActivateConsoleSixAxisSensor, "ActivateConsoleSixAxisSensor"},
@@ -293,11 +320,8 @@ void Hid::CreateAppletResource(Kernel::HLERequestContext& ctx) {
     rb.PushIpcInterface<IAppletResource>(applet_resource);
 }
 
-void Hid::ActivateXpad(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto basic_xpad_id{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateXpad(Kernel::HLERequestContext& ctx, u32 basic_xpad_id,
+                       u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, basic_xpad_id={}, applet_resource_user_id={}", basic_xpad_id,
               applet_resource_user_id);
 
@@ -306,10 +330,7 @@ void Hid::ActivateXpad(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateDebugPad(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateDebugPad(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     applet_resource->ActivateController(HidController::DebugPad);
@@ -317,10 +338,7 @@ void Hid::ActivateDebugPad(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateTouchScreen(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateTouchScreen(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     applet_resource->ActivateController(HidController::Touchscreen);
@@ -328,10 +346,7 @@ void Hid::ActivateTouchScreen(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateMouse(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateMouse(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     applet_resource->ActivateController(HidController::Mouse);
@@ -339,10 +354,7 @@ void Hid::ActivateMouse(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateKeyboard(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateKeyboard(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     applet_resource->ActivateController(HidController::Keyboard);
@@ -350,11 +362,8 @@ void Hid::ActivateKeyboard(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateGesture(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto unknown{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateGesture(Kernel::HLERequestContext& ctx, u32 unknown,
+                          u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, unknown={}, applet_resource_user_id={}", unknown,
               applet_resource_user_id);
 
@@ -363,12 +372,9 @@ void Hid::ActivateGesture(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateNpadWithRevision(Kernel::HLERequestContext& ctx) {
+void Hid::ActivateNpadWithRevision(Kernel::HLERequestContext& ctx, u32 unknown,
+                                   u64 applet_resource_user_id) {
     // Should have no effect with how our npad sets up the data
-    IPC::RequestParser rp{ctx};
-    const auto unknown{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
     LOG_DEBUG(Service_HID, "called, unknown={}, applet_resource_user_id={}", unknown,
               applet_resource_user_id);
 
@@ -377,11 +383,8 @@ void Hid::ActivateNpadWithRevision(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::StartSixAxisSensor(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto handle{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::StartSixAxisSensor(Kernel::HLERequestContext& ctx, u32 handle,
+                             u64 applet_resource_user_id) {
     LOG_WARNING(Service_HID, "(STUBBED) called, handle={}, applet_resource_user_id={}", handle,
                 applet_resource_user_id);
 
@@ -389,12 +392,8 @@ void Hid::StartSixAxisSensor(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::SetGyroscopeZeroDriftMode(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto handle{rp.Pop<u32>()};
-    const auto drift_mode{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::SetGyroscopeZeroDriftMode(Kernel::HLERequestContext& ctx, u32 handle, u32 drift_mode,
+                                    u64 applet_resource_user_id) {
     LOG_WARNING(Service_HID,
                 "(STUBBED) called, handle={}, drift_mode={}, applet_resource_user_id={}", handle,
                 drift_mode, applet_resource_user_id);
@@ -403,11 +402,8 @@ void Hid::SetGyroscopeZeroDriftMode(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::IsSixAxisSensorAtRest(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto handle{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::IsSixAxisSensorAtRest(Kernel::HLERequestContext& ctx, u32 handle,
+                                u64 applet_resource_user_id) {
     LOG_WARNING(Service_HID, "(STUBBED) called, handle={}, applet_resource_user_id={}", handle,
                 applet_resource_user_id);
 
@@ -417,10 +413,7 @@ void Hid::IsSixAxisSensorAtRest(Kernel::HLERequestContext& ctx) {
     rb.Push(true);
 }
 
-void Hid::SetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto supported_styleset{rp.Pop<u32>()};
-
+void Hid::SetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx, u32 supported_styleset) {
     LOG_DEBUG(Service_HID, "called, supported_styleset={}", supported_styleset);
 
     applet_resource->GetController<Controller_NPad>(HidController::NPad)
@@ -430,10 +423,7 @@ void Hid::SetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::GetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::GetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     auto& controller = applet_resource->GetController<Controller_NPad>(HidController::NPad);
@@ -455,10 +445,7 @@ void Hid::SetSupportedNpadIdType(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::ActivateNpad(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::ActivateNpad(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     IPC::ResponseBuilder rb{ctx, 2};
@@ -481,11 +468,7 @@ void Hid::AcquireNpadStyleSetUpdateEventHandle(Kernel::HLERequestContext& ctx) {
                            .GetStyleSetChangedEvent());
 }
 
-void Hid::DisconnectNpad(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto npad_id{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::DisconnectNpad(Kernel::HLERequestContext& ctx, u32 npad_id, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, npad_id={}, applet_resource_user_id={}", npad_id,
               applet_resource_user_id);
 
@@ -494,10 +477,7 @@ void Hid::DisconnectNpad(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::GetPlayerLedPattern(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto npad_id{rp.Pop<u32>()};
-
+void Hid::GetPlayerLedPattern(Kernel::HLERequestContext& ctx, u32 npad_id) {
     LOG_DEBUG(Service_HID, "called, npad_id={}", npad_id);
 
     IPC::ResponseBuilder rb{ctx, 4};
@@ -507,11 +487,8 @@ void Hid::GetPlayerLedPattern(Kernel::HLERequestContext& ctx) {
                         .raw);
 }
 
-void Hid::SetNpadJoyHoldType(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-    const auto hold_type{rp.Pop<u64>()};
-
+void Hid::SetNpadJoyHoldType(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id,
+                             u64 hold_type) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}, hold_type={}",
               applet_resource_user_id, hold_type);
 
@@ -522,10 +499,7 @@ void Hid::SetNpadJoyHoldType(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::GetNpadJoyHoldType(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::GetNpadJoyHoldType(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     const auto& controller = applet_resource->GetController<Controller_NPad>(HidController::NPad);
@@ -534,11 +508,8 @@ void Hid::GetNpadJoyHoldType(Kernel::HLERequestContext& ctx) {
     rb.Push<u64>(static_cast<u64>(controller.GetHoldType()));
 }
 
-void Hid::SetNpadJoyAssignmentModeSingleByDefault(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto npad_id{rp.Pop<u32>()};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::SetNpadJoyAssignmentModeSingleByDefault(Kernel::HLERequestContext& ctx, u32 npad_id,
+                                                  u64 applet_resource_user_id) {
     LOG_WARNING(Service_HID, "(STUBBED) called, npad_id={}, applet_resource_user_id={}", npad_id,
                 applet_resource_user_id);
 
@@ -546,10 +517,7 @@ void Hid::SetNpadJoyAssignmentModeSingleByDefault(Kernel::HLERequestContext& ctx
     rb.Push(RESULT_SUCCESS);
 }
 
-void Hid::BeginPermitVibrationSession(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp{ctx};
-    const auto applet_resource_user_id{rp.Pop<u64>()};
-
+void Hid::BeginPermitVibrationSession(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id) {
     LOG_DEBUG(Service_HID, "called, applet_resource_user_id={}", applet_resource_user_id);
 
     applet_resource->GetController<Controller_NPad>(HidController::NPad).SetVibrationEnabled(true);
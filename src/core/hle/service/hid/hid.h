@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "core/hle/service/hid/controllers/controller_base.h"
 #include "core/hle/service/service.h"
 
@@ -67,12 +70,21 @@ private:
     void GetSharedMemoryHandle(Kernel::HLERequestContext& ctx);
     void UpdateControllers(u64 userdata, s64 cycles_late);
 
+    /// Samples the input devices of the controllers until the applet resource is destroyed
+    void RunInputThread();
+
     Kernel::SharedPtr<Kernel::SharedMemory> shared_mem;
 
     Core::Timing::EventType* pad_update_event;
 
     std::array<std::unique_ptr<ControllerBase>, static_cast<size_t>(HidController::MaxControllers)>
         controllers{};
+
+    /// Reads the input devices, so the emulated cores only copy the last states it sampled
+    std::thread input_thread;
+    std::mutex input_thread_mutex;
+    std::condition_variable input_thread_cv;
+    bool is_input_thread_stopping = false;
 };
 
 class Hid final : public ServiceFramework<Hid> {
@@ -84,27 +96,34 @@ public:
 
 private:
     void CreateAppletResource(Kernel::HLERequestContext& ctx);
-    void ActivateXpad(Kernel::HLERequestContext& ctx);
-    void ActivateDebugPad(Kernel::HLERequestContext& ctx);
-    void ActivateTouchScreen(Kernel::HLERequestContext& ctx);
-    void ActivateMouse(Kernel::HLERequestContext& ctx);
-    void ActivateKeyboard(Kernel::HLERequestContext& ctx);
-    void ActivateGesture(Kernel::HLERequestContext& ctx);
-    void ActivateNpadWithRevision(Kernel::HLERequestContext& ctx);
-    void StartSixAxisSensor(Kernel::HLERequestContext& ctx);
-    void SetGyroscopeZeroDriftMode(Kernel::HLERequestContext& ctx);
-    void IsSixAxisSensorAtRest(Kernel::HLERequestContext& ctx);
-    void SetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx);
-    void GetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx);
+    void ActivateXpad(Kernel::HLERequestContext& ctx, u32 basic_xpad_id,
+                      u64 applet_resource_user_id);
+    void ActivateDebugPad(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
+    void ActivateTouchScreen(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
+    void ActivateMouse(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
+    void ActivateKeyboard(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
+    void ActivateGesture(Kernel::HLERequestContext& ctx, u32 unknown, u64 applet_resource_user_id);
+    void ActivateNpadWithRevision(Kernel::HLERequestContext& ctx, u32 unknown,
+                                  u64 applet_resource_user_id);
+    void StartSixAxisSensor(Kernel::HLERequestContext& ctx, u32 handle,
+                            u64 applet_resource_user_id);
+    void SetGyroscopeZeroDriftMode(Kernel::HLERequestContext& ctx, u32 handle, u32 drift_mode,
+                                   u64 applet_resource_user_id);
+    void IsSixAxisSensorAtRest(Kernel::HLERequestContext& ctx, u32 handle,
+                               u64 applet_resource_user_id);
+    void SetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx, u32 supported_styleset);
+    void GetSupportedNpadStyleSet(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
     void SetSupportedNpadIdType(Kernel::HLERequestContext& ctx);
-    void ActivateNpad(Kernel::HLERequestContext& ctx);
+    void ActivateNpad(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
     void AcquireNpadStyleSetUpdateEventHandle(Kernel::HLERequestContext& ctx);
-    void DisconnectNpad(Kernel::HLERequestContext& ctx);
-    void GetPlayerLedPattern(Kernel::HLERequestContext& ctx);
-    void SetNpadJoyHoldType(Kernel::HLERequestContext& ctx);
-    void GetNpadJoyHoldType(Kernel::HLERequestContext& ctx);
-    void SetNpadJoyAssignmentModeSingleByDefault(Kernel::HLERequestContext& ctx);
-    void BeginPermitVibrationSession(Kernel::HLERequestContext& ctx);
+    void DisconnectNpad(Kernel::HLERequestContext& ctx, u32 npad_id, u64 applet_resource_user_id);
+    void GetPlayerLedPattern(Kernel::HLERequestContext& ctx, u32 npad_id);
+    void SetNpadJoyHoldType(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id,
+                            u64 hold_type);
+    void GetNpadJoyHoldType(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
+    void SetNpadJoyAssignmentModeSingleByDefault(Kernel::HLERequestContext& ctx, u32 npad_id,
+                                                 u64 applet_resource_user_id);
+    void BeginPermitVibrationSession(Kernel::HLERequestContext& ctx, u64 applet_resource_user_id);
     void EndPermitVibrationSession(Kernel::HLERequestContext& ctx);
     void SendVibrationValue(Kernel::HLERequestContext& ctx);
     void SendVibrationValues(Kernel::HLERequestContext& ctx);
@@ -8,11 +8,14 @@
 
 #include "common/alignment.h"
 #include "common/hex_util.h"
+#include "core/core.h"
+#include "core/guest_profiler.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/ldr/ldr.h"
 #include "core/hle/service/service.h"
 #include "core/loader/nro.h"
+#include "core/memory.h"
 
 namespace Service::LDR {
 
@@ -289,12 +292,19 @@ public:
             return;
         }
 
-        // Read NRO data from memory
-        std::vector<u8> nro_data(nro_size);
-        Memory::ReadBlock(nro_address, nro_data.data(), nro_size);
+        // The NRO is hashed where the game loaded it, it's only copied when its pages aren't
+        // contiguous on the host
+        auto* process = Core::CurrentProcess();
+        std::vector<u8> nro_copy;
+        const u8* nro_data = Memory::GetContiguousPointer(*process, nro_address, nro_size);
+        if (nro_data == nullptr) {
+            nro_copy.resize(nro_size);
+            Memory::ReadBlock(nro_address, nro_copy.data(), nro_size);
+            nro_data = nro_copy.data();
+        }
 
         SHA256Hash hash{};
-        mbedtls_sha256(nro_data.data(), nro_data.size(), hash.data(), 0);
+        mbedtls_sha256(nro_data, nro_size, hash.data(), 0);
 
         // NRO Hash is already loaded
         if (std::any_of(nro.begin(), nro.end(), [&hash](const std::pair<VAddr, NROInfo>& info) {
@@ -317,7 +327,7 @@ public:
         }
 
         NROHeader header;
-        std::memcpy(&header, nro_data.data(), sizeof(NROHeader));
+        std::memcpy(&header, nro_data, sizeof(NROHeader));
 
         if (!IsValidNRO(header, nro_size, bss_size)) {
             LOG_ERROR(Service_LDR, "NRO was invalid!");
@@ -327,7 +337,6 @@ public:
         }
 
         // Load NRO as new executable module
-        auto* process = Core::CurrentProcess();
         auto& vm_manager = process->VMManager();
         auto map_address = vm_manager.FindFreeRegion(nro_size + bss_size);
 
@@ -362,7 +371,13 @@ public:
         vm_manager.ReprotectRange(*map_address + header.rw_offset, header.rw_size,
                                   Kernel::VMAPermission::ReadWrite);
 
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(*map_address,
+                                                                       nro_size + bss_size);
+
+        if (auto* const profiler = process->GetSystem().GetGuestProfiler()) {
+            profiler->RegisterModule(*process, fmt::format("nro_{:016X}", *map_address),
+                                     *map_address, *map_address + nro_size);
+        }
 
         nro.insert_or_assign(*map_address, NROInfo{hash, nro_size + bss_size});
 
@@ -413,7 +428,7 @@ public:
 
         ASSERT(vm_manager.UnmapRange(nro_address, nro_size).IsSuccess());
 
-        Core::System::GetInstance().InvalidateCpuInstructionCaches();
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(nro_address, nro_size);
 
         nro.erase(iter);
         IPC::ResponseBuilder rb{ctx, 2};
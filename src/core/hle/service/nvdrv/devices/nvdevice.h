@@ -4,13 +4,27 @@
 
 #pragma once
 
-#include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/readable_event.h"
 
 namespace Service::Nvidia::Devices {
 
+/// Result codes returned by the ioctls
+enum class NvResult : u32 {
+    Success = 0x0,
+    BadParameter = 0x4,
+    Timeout = 0x5,
+};
+
+/// Input buffer of an ioctl, usually a view of guest memory
+using IoctlInput = Kernel::BufferSpan<const u8>;
+/// Output buffer of an ioctl, written in place. It may alias the input buffer, so the parameters
+/// must be read before any output is written.
+using IoctlOutput = Kernel::BufferSpan<u8>;
+
 /// Represents an abstract nvidia device node. It is to be subclassed by concrete device nodes to
 /// implement the ioctl interface.
 class nvdevice {
@@ -29,11 +43,17 @@ public:
     /**
      * Handles an ioctl request.
      * @param command The ioctl command id.
-     * @param input A buffer containing the input data for the ioctl.
-     * @param output A buffer where the output data will be written to.
+     * @param input A view of the input data for the ioctl.
+     * @param output A view of the output buffer, written in place. Bytes that aren't written keep
+     *               their previous contents.
      * @returns The result code of the ioctl.
      */
-    virtual u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) = 0;
+    virtual u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) = 0;
+
+    /// Returns the event of the device identified by event_id, or null if the device has none
+    virtual Kernel::SharedPtr<Kernel::ReadableEvent> QueryEvent(u32 event_id) {
+        return nullptr;
+    }
 };
 
 } // namespace Service::Nvidia::Devices
@@ -16,27 +16,31 @@ namespace Service::Nvidia::Devices {
 nvdisp_disp0::nvdisp_disp0(std::shared_ptr<nvmap> nvmap_dev) : nvmap_dev(std::move(nvmap_dev)) {}
 nvdisp_disp0 ::~nvdisp_disp0() = default;
 
-u32 nvdisp_disp0::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvdisp_disp0::ioctl(Ioctl command, IoctlInput input, IoctlOutput output) {
     UNIMPLEMENTED_MSG("Unimplemented ioctl");
     return 0;
 }
 
-void nvdisp_disp0::flip(u32 buffer_handle, u32 offset, u32 format, u32 width, u32 height,
-                        u32 stride, NVFlinger::BufferQueue::BufferTransformFlags transform,
-                        const Common::Rectangle<int>& crop_rect) {
+Tegra::FramebufferConfig nvdisp_disp0::GetFramebuffer(
+    u32 buffer_handle, u32 offset, u32 format, u32 width, u32 height, u32 stride,
+    NVFlinger::BufferQueue::BufferTransformFlags transform,
+    const Common::Rectangle<int>& crop_rect) const {
     VAddr addr = nvmap_dev->GetObjectAddress(buffer_handle);
     LOG_TRACE(Service,
               "Drawing from address {:X} offset {:08X} Width {} Height {} Stride {} Format {}",
               addr, offset, width, height, stride, format);
 
     using PixelFormat = Tegra::FramebufferConfig::PixelFormat;
-    const Tegra::FramebufferConfig framebuffer{
-        addr,      offset,   width, height, stride, static_cast<PixelFormat>(format),
-        transform, crop_rect};
+    return {addr,      offset,   width, height, stride, static_cast<PixelFormat>(format),
+            transform, crop_rect};
+}
 
+void nvdisp_disp0::flip(const Tegra::FramebufferConfig& framebuffer,
+                        Tegra::FramebufferOverlays overlays,
+                        std::function<void()> release_callback) {
     auto& instance = Core::System::GetInstance();
     instance.GetPerfStats().EndGameFrame();
-    instance.GPU().SwapBuffers(framebuffer);
+    instance.GPU().SwapBuffers(framebuffer, std::move(overlays), std::move(release_callback));
 }
 
 } // namespace Service::Nvidia::Devices
@@ -4,12 +4,14 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include "common/common_types.h"
 #include "common/math_util.h"
 #include "core/hle/service/nvdrv/devices/nvdevice.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
+#include "video_core/gpu.h"
 
 namespace Service::Nvidia::Devices {
 
@@ -20,12 +22,18 @@ public:
     explicit nvdisp_disp0(std::shared_ptr<nvmap> nvmap_dev);
     ~nvdisp_disp0() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
 
-    /// Performs a screen flip, drawing the buffer pointed to by the handle.
-    void flip(u32 buffer_handle, u32 offset, u32 format, u32 width, u32 height, u32 stride,
-              NVFlinger::BufferQueue::BufferTransformFlags transform,
-              const Common::Rectangle<int>& crop_rect);
+    /// Returns the framebuffer the GPU reads to display the buffer pointed to by the handle.
+    Tegra::FramebufferConfig GetFramebuffer(u32 buffer_handle, u32 offset, u32 format, u32 width,
+                                            u32 height, u32 stride,
+                                            NVFlinger::BufferQueue::BufferTransformFlags transform,
+                                            const Common::Rectangle<int>& crop_rect) const;
+
+    /// Performs a screen flip, drawing the framebuffer with the overlays composed on top of it.
+    /// The callback is invoked from an unspecified thread once the buffers can be reused.
+    void flip(const Tegra::FramebufferConfig& framebuffer, Tegra::FramebufferOverlays overlays,
+              std::function<void()> release_callback);
 
 private:
     std::shared_ptr<nvmap> nvmap_dev;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
@@ -11,6 +12,7 @@
 #include "core/hle/service/nvdrv/devices/nvhost_as_gpu.h"
 #include "core/hle/service/nvdrv/devices/nvmap.h"
 #include "core/memory.h"
+#include "video_core/gpu.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
@@ -22,10 +24,13 @@ enum {
 };
 }
 
+/// Idle mappings kept for buffers to be mapped again, the least recently unmapped are evicted first
+constexpr std::size_t MaxIdleMappings = 64;
+
 nvhost_as_gpu::nvhost_as_gpu(std::shared_ptr<nvmap> nvmap_dev) : nvmap_dev(std::move(nvmap_dev)) {}
 nvhost_as_gpu::~nvhost_as_gpu() = default;
 
-u32 nvhost_as_gpu::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::ioctl(Ioctl command, IoctlInput input, IoctlOutput output) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
 
@@ -51,7 +56,7 @@ u32 nvhost_as_gpu::ioctl(Ioctl command, const std::vector<u8>& input, std::vecto
     return 0;
 }
 
-u32 nvhost_as_gpu::InitalizeEx(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::InitalizeEx(IoctlInput input, IoctlOutput output) {
     IoctlInitalizeEx params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, big_page_size=0x{:X}", params.big_page_size);
@@ -59,7 +64,7 @@ u32 nvhost_as_gpu::InitalizeEx(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::AllocateSpace(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::AllocateSpace(IoctlInput input, IoctlOutput output) {
     IoctlAllocSpace params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, pages={:X}, page_size={:X}, flags={:X}", params.pages,
@@ -68,6 +73,7 @@ u32 nvhost_as_gpu::AllocateSpace(const std::vector<u8>& input, std::vector<u8>&
     auto& gpu = Core::System::GetInstance().GPU();
     const u64 size{static_cast<u64>(params.pages) * static_cast<u64>(params.page_size)};
     if (params.flags & 1) {
+        EvictIdleMappings(params.offset, size);
         params.offset = gpu.MemoryManager().AllocateSpace(params.offset, size, 1);
     } else {
         params.offset = gpu.MemoryManager().AllocateSpace(size, params.align);
@@ -77,7 +83,7 @@ u32 nvhost_as_gpu::AllocateSpace(const std::vector<u8>& input, std::vector<u8>&
     return 0;
 }
 
-u32 nvhost_as_gpu::Remap(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::Remap(IoctlInput input, IoctlOutput output) {
     std::size_t num_entries = input.size() / sizeof(IoctlRemapEntry);
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, num_entries=0x{:X}", num_entries);
@@ -102,6 +108,7 @@ u32 nvhost_as_gpu::Remap(const std::vector<u8>& input, std::vector<u8>& output)
         u64 size = static_cast<u64>(entry.pages) << 0x10;
         ASSERT(size <= object->size);
 
+        EvictIdleMappings(offset, size);
         GPUVAddr returned = gpu.MemoryManager().MapBufferEx(object->addr, offset, size);
         ASSERT(returned == offset);
     }
@@ -109,7 +116,7 @@ u32 nvhost_as_gpu::Remap(const std::vector<u8>& input, std::vector<u8>& output)
     return 0;
 }
 
-u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::MapBufferEx(IoctlInput input, IoctlOutput output) {
     IoctlMapBufferEx params{};
     std::memcpy(&params, input.data(), input.size());
 
@@ -136,9 +143,20 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     // case to prevent unexpected behavior.
     ASSERT(object->id == params.nvmap_handle);
 
+    const bool is_fixed = (params.flags & 1) != 0;
+    const auto idle_offset = ReuseIdleMapping(
+        params.nvmap_handle, object->addr, object->size,
+        is_fixed ? std::optional<u64>{params.offset} : std::nullopt);
+    if (idle_offset) {
+        params.offset = *idle_offset;
+        std::memcpy(output.data(), &params, output.size());
+        return 0;
+    }
+
     auto& gpu = Core::System::GetInstance().GPU();
 
-    if (params.flags & 1) {
+    if (is_fixed) {
+        EvictIdleMappings(params.offset, object->size);
         params.offset = gpu.MemoryManager().MapBufferEx(object->addr, params.offset, object->size);
     } else {
         params.offset = gpu.MemoryManager().MapBufferEx(object->addr, object->size);
@@ -152,6 +170,7 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     mapping.nvmap_handle = params.nvmap_handle;
     mapping.offset = params.offset;
     mapping.size = object->size;
+    mapping.cpu_addr = object->addr;
 
     buffer_mappings[params.offset] = mapping;
 
@@ -159,29 +178,35 @@ u32 nvhost_as_gpu::MapBufferEx(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::UnmapBuffer(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::UnmapBuffer(IoctlInput input, IoctlOutput output) {
     IoctlUnmapBuffer params{};
     std::memcpy(&params, input.data(), input.size());
 
     LOG_DEBUG(Service_NVDRV, "called, offset=0x{:X}", params.offset);
 
     const auto itr = buffer_mappings.find(params.offset);
-    if (itr == buffer_mappings.end()) {
+    if (itr == buffer_mappings.end() || itr->second.is_idle) {
         LOG_WARNING(Service_NVDRV, "Tried to unmap an invalid offset 0x{:X}", params.offset);
         // Hardware tests shows that unmapping an already unmapped buffer always returns successful
         // and doesn't fail.
         return 0;
     }
 
-    params.offset = Core::System::GetInstance().GPU().MemoryManager().UnmapBuffer(params.offset,
-                                                                                  itr->second.size);
-    buffer_mappings.erase(itr->second.offset);
+    // The buffer stays mapped in case it's mapped again, only the GPU writes to it are flushed
+    auto& gpu = Core::System::GetInstance().GPU();
+    BufferMapping& mapping = itr->second;
+    gpu.FlushRegion(ToCacheAddr(gpu.MemoryManager().GetPointer(mapping.offset)), mapping.size);
+    mapping.is_idle = true;
+    idle_mappings.push_back(mapping.offset);
+    if (idle_mappings.size() > MaxIdleMappings) {
+        UnmapIdleMapping(0);
+    }
 
     std::memcpy(output.data(), &params, output.size());
     return 0;
 }
 
-u32 nvhost_as_gpu::BindChannel(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::BindChannel(IoctlInput input, IoctlOutput output) {
     IoctlBindChannel params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, fd={:X}", params.fd);
@@ -190,7 +215,7 @@ u32 nvhost_as_gpu::BindChannel(const std::vector<u8>& input, std::vector<u8>& ou
     return 0;
 }
 
-u32 nvhost_as_gpu::GetVARegions(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_as_gpu::GetVARegions(IoctlInput input, IoctlOutput output) {
     IoctlGetVaRegions params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, buf_addr={:X}, buf_size={:X}", params.buf_addr,
@@ -209,4 +234,42 @@ u32 nvhost_as_gpu::GetVARegions(const std::vector<u8>& input, std::vector<u8>& o
     return 0;
 }
 
+std::optional<u64> nvhost_as_gpu::ReuseIdleMapping(u32 nvmap_handle, VAddr cpu_addr, u64 size,
+                                                   std::optional<u64> fixed_offset) {
+    // Handles of freed objects are never reused, so a mapping of the same handle, address and size
+    // still maps the same memory
+    const auto itr = std::find_if(idle_mappings.begin(), idle_mappings.end(), [&](u64 offset) {
+        const BufferMapping& mapping = buffer_mappings.at(offset);
+        return mapping.nvmap_handle == nvmap_handle && mapping.cpu_addr == cpu_addr &&
+               mapping.size == size && (!fixed_offset || *fixed_offset == offset);
+    });
+    if (itr == idle_mappings.end()) {
+        return std::nullopt;
+    }
+
+    const u64 offset = *itr;
+    buffer_mappings.at(offset).is_idle = false;
+    idle_mappings.erase(itr);
+    return offset;
+}
+
+void nvhost_as_gpu::EvictIdleMappings(u64 offset, u64 size) {
+    for (std::size_t index = 0; index < idle_mappings.size();) {
+        const BufferMapping& mapping = buffer_mappings.at(idle_mappings[index]);
+        if (mapping.offset < offset + size && offset < mapping.offset + mapping.size) {
+            UnmapIdleMapping(index);
+        } else {
+            ++index;
+        }
+    }
+}
+
+void nvhost_as_gpu::UnmapIdleMapping(std::size_t index) {
+    const u64 offset = idle_mappings[index];
+    const auto itr = buffer_mappings.find(offset);
+    Core::System::GetInstance().GPU().MemoryManager().UnmapBuffer(offset, itr->second.size);
+    buffer_mappings.erase(itr);
+    idle_mappings.erase(idle_mappings.begin() + index);
+}
+
 } // namespace Service::Nvidia::Devices
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
@@ -20,7 +21,7 @@ public:
     explicit nvhost_as_gpu(std::shared_ptr<nvmap> nvmap_dev);
     ~nvhost_as_gpu() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -108,20 +109,37 @@ private:
         u64 offset;
         u64 size;
         u32 nvmap_handle;
+        VAddr cpu_addr;       ///< Address of the nvmap object when it was mapped
+        bool is_idle = false; ///< Unmapped by the guest, kept mapped until it's mapped again
     };
 
     /// Map containing the nvmap object mappings in GPU memory.
     std::unordered_map<u64, BufferMapping> buffer_mappings;
 
+    /// Offsets of the idle mappings from the least recently unmapped one. Buffers the guest remaps
+    /// reuse them, without updating the page table nor the rasterizer caches.
+    std::vector<u64> idle_mappings;
+
     u32 channel{};
 
-    u32 InitalizeEx(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocateSpace(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 Remap(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 MapBufferEx(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 UnmapBuffer(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 BindChannel(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetVARegions(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 InitalizeEx(IoctlInput input, IoctlOutput output);
+    u32 AllocateSpace(IoctlInput input, IoctlOutput output);
+    u32 Remap(IoctlInput input, IoctlOutput output);
+    u32 MapBufferEx(IoctlInput input, IoctlOutput output);
+    u32 UnmapBuffer(IoctlInput input, IoctlOutput output);
+    u32 BindChannel(IoctlInput input, IoctlOutput output);
+    u32 GetVARegions(IoctlInput input, IoctlOutput output);
+
+    /// Returns the offset of an idle mapping of the nvmap object that can be reused, if any.
+    std::optional<u64> ReuseIdleMapping(u32 nvmap_handle, VAddr cpu_addr, u64 size,
+                                        std::optional<u64> fixed_offset);
+
+    /// Unmaps the idle mappings overlapping a range of the address space, before the guest places
+    /// something else there.
+    void EvictIdleMappings(u64 offset, u64 size);
+
+    /// Unmaps the idle mapping at the given position of the idle list.
+    void UnmapIdleMapping(std::size_t index);
 
     std::shared_ptr<nvmap> nvmap_dev;
 };
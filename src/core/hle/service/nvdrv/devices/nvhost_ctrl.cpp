@@ -5,34 +5,54 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/service/nvdrv/devices/nvhost_ctrl.h"
+#include "video_core/gpu.h"
 
 namespace Service::Nvidia::Devices {
 
-nvhost_ctrl::nvhost_ctrl() = default;
+nvhost_ctrl::nvhost_ctrl() {
+    auto& system = Core::System::GetInstance();
+    for (u32 i = 0; i < MaxNvEvents; ++i) {
+        events[i].event = Kernel::WritableEvent::CreateEventPair(
+            system.Kernel(), Kernel::ResetType::Automatic, fmt::format("NVDRV::NvEvent_{}", i));
+    }
+    signal_event_type = system.CoreTiming().RegisterEvent(
+        "NvhostCtrlSignalEvent",
+        [this](u64 event_id, s64) { SignalEvent(static_cast<u32>(event_id)); });
+}
+
 nvhost_ctrl::~nvhost_ctrl() = default;
 
-u32 nvhost_ctrl::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_ctrl::ioctl(Ioctl command, IoctlInput input, IoctlOutput output) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
 
     switch (static_cast<IoctlCommand>(command.raw)) {
     case IoctlCommand::IocGetConfigCommand:
         return NvOsGetConfigU32(input, output);
+    case IoctlCommand::IocSyncptReadCommand:
+        return IocSyncptRead(input, output);
+    case IoctlCommand::IocCtrlEventSignalCommand:
+        return IocCtrlEventSignal(input, output);
     case IoctlCommand::IocCtrlEventWaitCommand:
         return IocCtrlEventWait(input, output, false);
     case IoctlCommand::IocCtrlEventWaitAsyncCommand:
         return IocCtrlEventWait(input, output, true);
     case IoctlCommand::IocCtrlEventRegisterCommand:
         return IocCtrlEventRegister(input, output);
+    case IoctlCommand::IocCtrlEventUnregisterCommand:
+        return IocCtrlEventUnregister(input, output);
     }
     UNIMPLEMENTED_MSG("Unimplemented ioctl");
     return 0;
 }
 
-u32 nvhost_ctrl::NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_ctrl::NvOsGetConfigU32(IoctlInput input, IoctlOutput output) {
     IocGetConfigParams params{};
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_TRACE(Service_NVDRV, "called, setting={}!{}", params.domain_str.data(),
@@ -40,24 +60,139 @@ u32 nvhost_ctrl::NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>&
     return 0x30006; // Returns error on production mode
 }
 
-u32 nvhost_ctrl::IocCtrlEventWait(const std::vector<u8>& input, std::vector<u8>& output,
-                                  bool is_async) {
+Kernel::SharedPtr<Kernel::ReadableEvent> nvhost_ctrl::QueryEvent(u32 event_id) {
+    // The guest passes either the id it registered or the value returned by a timed out wait
+    const u32 slot = event_id & 0xFF;
+    if (slot >= MaxNvEvents) {
+        return nullptr;
+    }
+    return events[slot].event.readable;
+}
+
+u32 nvhost_ctrl::IocSyncptRead(IoctlInput input, IoctlOutput output) {
+    IocSyncptReadParams params{};
+    std::memcpy(&params, input.data(), sizeof(params));
+    LOG_DEBUG(Service_NVDRV, "called, id={}", params.id);
+
+    if (params.id >= Tegra::GPU::MaxSyncPoints) {
+        return static_cast<u32>(NvResult::BadParameter);
+    }
+    params.value = Core::System::GetInstance().GPU().GetSyncPointValue(params.id);
+    std::memcpy(output.data(), &params, sizeof(params));
+    return static_cast<u32>(NvResult::Success);
+}
+
+u32 nvhost_ctrl::IocCtrlEventSignal(IoctlInput input, IoctlOutput output) {
+    IocCtrlEventSignalParams params{};
+    std::memcpy(&params, input.data(), sizeof(params));
+    LOG_DEBUG(Service_NVDRV, "called, user_event_id={:X}", params.user_event_id);
+
+    // Cancels a wait, the guest then sees its syncpoint as not reached yet and may wait again
+    const u32 event_id = params.user_event_id & 0xFF;
+    if (event_id >= MaxNvEvents) {
+        return static_cast<u32>(NvResult::BadParameter);
+    }
+    SignalEvent(event_id);
+    return static_cast<u32>(NvResult::Success);
+}
+
+u32 nvhost_ctrl::IocCtrlEventWait(IoctlInput input, IoctlOutput output, bool is_async) {
     IocCtrlEventWaitParams params{};
     std::memcpy(&params, input.data(), sizeof(params));
-    LOG_WARNING(Service_NVDRV,
-                "(STUBBED) called, syncpt_id={}, threshold={}, timeout={}, is_async={}",
-                params.syncpt_id, params.threshold, params.timeout, is_async);
+    LOG_DEBUG(Service_NVDRV, "called, syncpt_id={}, threshold={}, timeout={}, is_async={}",
+              params.syncpt_id, params.threshold, params.timeout, is_async);
+
+    if (params.syncpt_id >= Tegra::GPU::MaxSyncPoints) {
+        return static_cast<u32>(NvResult::BadParameter);
+    }
 
-    // TODO(Subv): Implement actual syncpt waiting.
-    params.value = 0;
+    auto& gpu = Core::System::GetInstance().GPU();
+    const auto complete = [&] {
+        params.value = gpu.GetSyncPointValue(params.syncpt_id);
+        std::memcpy(output.data(), &params, sizeof(params));
+        return static_cast<u32>(NvResult::Success);
+    };
+    if (gpu.IsSyncPointReached(params.syncpt_id, params.threshold)) {
+        return complete();
+    }
+    if (params.timeout == 0) {
+        return static_cast<u32>(NvResult::Timeout);
+    }
+
+    // The wait is not blocked here, the guest waits on the event and asks again once signaled
+    u32 event_id;
+    if (is_async) {
+        event_id = params.value & 0xFF;
+        if (event_id >= MaxNvEvents || !events[event_id].is_registered) {
+            LOG_ERROR(Service_NVDRV, "Waited on unregistered event {}", event_id);
+            return static_cast<u32>(NvResult::BadParameter);
+        }
+    } else {
+        event_id = AllocateWaitEvent();
+        if (event_id == MaxNvEvents) {
+            LOG_ERROR(Service_NVDRV, "No event left to wait on syncpoint {}", params.syncpt_id);
+            return static_cast<u32>(NvResult::BadParameter);
+        }
+    }
+
+    auto& event = events[event_id];
+    event.event.writable->Clear();
+    event.is_waiting = true;
+    auto& core_timing = Core::System::GetInstance().CoreTiming();
+    const auto on_reached = [&core_timing, signal_event = signal_event_type, event_id] {
+        core_timing.ScheduleEventThreadsafe(0, signal_event, event_id);
+    };
+    if (!gpu.RegisterSyncPointInterrupt(params.syncpt_id, params.threshold, on_reached)) {
+        // Reached since it was checked
+        event.is_waiting = false;
+        return complete();
+    }
+
+    params.value = ((params.syncpt_id & 0xFFF) << 16) | 0x10000000 | event_id;
     std::memcpy(output.data(), &params, sizeof(params));
-    return 0;
+    return static_cast<u32>(NvResult::Timeout);
 }
 
-u32 nvhost_ctrl::IocCtrlEventRegister(const std::vector<u8>& input, std::vector<u8>& output) {
-    LOG_WARNING(Service_NVDRV, "(STUBBED) called");
-    // TODO(bunnei): Implement this.
-    return 0;
+u32 nvhost_ctrl::IocCtrlEventRegister(IoctlInput input, IoctlOutput output) {
+    IocCtrlEventRegisterParams params{};
+    std::memcpy(&params, input.data(), sizeof(params));
+    LOG_DEBUG(Service_NVDRV, "called, user_event_id={}", params.user_event_id);
+
+    if (params.user_event_id >= MaxNvEvents) {
+        return static_cast<u32>(NvResult::BadParameter);
+    }
+    events[params.user_event_id].is_registered = true;
+    return static_cast<u32>(NvResult::Success);
+}
+
+u32 nvhost_ctrl::IocCtrlEventUnregister(IoctlInput input, IoctlOutput output) {
+    IocCtrlEventUnregisterParams params{};
+    std::memcpy(&params, input.data(), sizeof(params));
+    LOG_DEBUG(Service_NVDRV, "called, user_event_id={}", params.user_event_id);
+
+    if (params.user_event_id >= MaxNvEvents) {
+        return static_cast<u32>(NvResult::BadParameter);
+    }
+    events[params.user_event_id].is_registered = false;
+    return static_cast<u32>(NvResult::Success);
+}
+
+u32 nvhost_ctrl::AllocateWaitEvent() {
+    for (u32 i = 0; i < MaxNvEvents; ++i) {
+        const u32 event_id = (next_wait_event + i) % MaxNvEvents;
+        const auto& event = events[event_id];
+        if (!event.is_registered && !event.is_waiting) {
+            next_wait_event = (event_id + 1) % MaxNvEvents;
+            return event_id;
+        }
+    }
+    return MaxNvEvents;
+}
+
+void nvhost_ctrl::SignalEvent(u32 event_id) {
+    auto& event = events[event_id];
+    event.is_waiting = false;
+    event.event.writable->Signal();
 }
 
 } // namespace Service::Nvidia::Devices
@@ -7,8 +7,13 @@
 #include <array>
 #include <vector>
 #include "common/common_types.h"
+#include "core/hle/kernel/writable_event.h"
 #include "core/hle/service/nvdrv/devices/nvdevice.h"
 
+namespace Core::Timing {
+struct EventType;
+}
+
 namespace Service::Nvidia::Devices {
 
 class nvhost_ctrl final : public nvdevice {
@@ -16,7 +21,12 @@ public:
     nvhost_ctrl();
     ~nvhost_ctrl() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
+
+    Kernel::SharedPtr<Kernel::ReadableEvent> QueryEvent(u32 event_id) override;
+
+    /// Number of events the guest can wait on for syncpoints to be reached
+    static constexpr u32 MaxNvEvents = 64;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -130,11 +140,35 @@ private:
     };
     static_assert(sizeof(IocCtrlEventKill) == 8, "IocCtrlEventKill is incorrect size");
 
-    u32 NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>& output);
+    struct SyncpointEvent {
+        Kernel::EventPair event;
+        bool is_registered = false; ///< Reserved by the guest for asynchronous waits
+        bool is_waiting = false;    ///< Signaled once the syncpoint it waits on is reached
+    };
+
+    u32 NvOsGetConfigU32(IoctlInput input, IoctlOutput output);
+
+    u32 IocSyncptRead(IoctlInput input, IoctlOutput output);
+
+    u32 IocCtrlEventSignal(IoctlInput input, IoctlOutput output);
+
+    u32 IocCtrlEventWait(IoctlInput input, IoctlOutput output, bool is_async);
+
+    u32 IocCtrlEventRegister(IoctlInput input, IoctlOutput output);
+
+    u32 IocCtrlEventUnregister(IoctlInput input, IoctlOutput output);
+
+    /// Returns a free event for a synchronous wait, or MaxNvEvents if all of them are in use
+    u32 AllocateWaitEvent();
 
-    u32 IocCtrlEventWait(const std::vector<u8>& input, std::vector<u8>& output, bool is_async);
+    /// Signals an event whose syncpoint was reached, called on the emulated CPU thread
+    void SignalEvent(u32 event_id);
 
-    u32 IocCtrlEventRegister(const std::vector<u8>& input, std::vector<u8>& output);
+    std::array<SyncpointEvent, MaxNvEvents> events;
+    /// Event to try first for the next synchronous wait, so freed events are reused last
+    u32 next_wait_event = 0;
+    /// Core timing event moving the syncpoint interrupts of the GPU to the emulated CPU thread
+    Core::Timing::EventType* signal_event_type = nullptr;
 };
 
 } // namespace Service::Nvidia::Devices
@@ -16,7 +16,7 @@ public:
     nvhost_ctrl_gpu();
     ~nvhost_ctrl_gpu() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -161,15 +161,15 @@ private:
     };
     static_assert(sizeof(IoctlGetGpuTime) == 8, "IoctlGetGpuTime is incorrect size");
 
-    u32 GetCharacteristics(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetTPCMasks(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetActiveSlotMask(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZCullGetCtxSize(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZCullGetInfo(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZBCSetTable(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZBCQueryTable(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 FlushL2(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetGpuTime(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 GetCharacteristics(IoctlInput input, IoctlOutput output);
+    u32 GetTPCMasks(IoctlInput input, IoctlOutput output);
+    u32 GetActiveSlotMask(IoctlInput input, IoctlOutput output);
+    u32 ZCullGetCtxSize(IoctlInput input, IoctlOutput output);
+    u32 ZCullGetInfo(IoctlInput input, IoctlOutput output);
+    u32 ZBCSetTable(IoctlInput input, IoctlOutput output);
+    u32 ZBCQueryTable(IoctlInput input, IoctlOutput output);
+    u32 FlushL2(IoctlInput input, IoctlOutput output);
+    u32 GetGpuTime(IoctlInput input, IoctlOutput output);
 };
 
 } // namespace Service::Nvidia::Devices
@@ -23,7 +23,7 @@ public:
     explicit nvhost_gpu(std::shared_ptr<nvmap> nvmap_dev);
     ~nvhost_gpu() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -153,7 +153,11 @@ private:
     struct IoctlSubmitGpfifo {
         u64_le address;     // pointer to gpfifo entry structs
         u32_le num_entries; // number of fence objects being submitted
-        u32_le flags;
+        union {
+            u32_le raw;
+            BitField<0, 1, u32_le> fence_wait; // waits for the fence before executing
+            BitField<1, 1, u32_le> fence_get;  // returns a fence signaled once executed
+        } flags;
         IoctlFence fence_out; // returned new fence object for others to wait on
     };
     static_assert(sizeof(IoctlSubmitGpfifo) == 16 + sizeof(IoctlFence),
@@ -165,23 +169,31 @@ private:
     };
     static_assert(sizeof(IoctlGetWaitbase) == 8, "IoctlGetWaitbase is incorrect size");
 
+    /// Syncpoint of the channel, incremented after the submissions asking for a fence
+    static constexpr u32 ChannelSyncpointId = 1;
+
     u32_le nvmap_fd{};
     u64_le user_data{};
     IoctlZCullBind zcull_params{};
     u32_le channel_priority{};
-
-    u32 SetNVMAPfd(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetClientData(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetClientData(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZCullBind(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetErrorNotifier(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetChannelPriority(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocGPFIFOEx2(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocateObjectContext(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SubmitGPFIFO(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 KickoffPB(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetWaitbase(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ChannelSetTimeout(const std::vector<u8>& input, std::vector<u8>& output);
+    /// Value the channel syncpoint reaches once every submission queued so far is executed
+    u32 syncpoint_max{};
+
+    u32 SetNVMAPfd(IoctlInput input, IoctlOutput output);
+    u32 SetClientData(IoctlInput input, IoctlOutput output);
+    u32 GetClientData(IoctlInput input, IoctlOutput output);
+    u32 ZCullBind(IoctlInput input, IoctlOutput output);
+    u32 SetErrorNotifier(IoctlInput input, IoctlOutput output);
+    u32 SetChannelPriority(IoctlInput input, IoctlOutput output);
+    u32 AllocGPFIFOEx2(IoctlInput input, IoctlOutput output);
+    u32 AllocateObjectContext(IoctlInput input, IoctlOutput output);
+    u32 SubmitGPFIFO(IoctlInput input, IoctlOutput output);
+    u32 KickoffPB(IoctlInput input, IoctlOutput output);
+    u32 GetWaitbase(IoctlInput input, IoctlOutput output);
+    u32 ChannelSetTimeout(IoctlInput input, IoctlOutput output);
+
+    /// Returns the fence of a submission that was just pushed to the GPU, if it asks for one
+    void UpdateSubmitFence(IoctlSubmitGpfifo& params);
 
     std::shared_ptr<nvmap> nvmap_dev;
 };
@@ -13,7 +13,7 @@ namespace Service::Nvidia::Devices {
 nvhost_vic::nvhost_vic() = default;
 nvhost_vic::~nvhost_vic() = default;
 
-u32 nvhost_vic::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_vic::ioctl(Ioctl command, IoctlInput input, IoctlOutput output) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
 
@@ -26,7 +26,7 @@ u32 nvhost_vic::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u
     return 0;
 }
 
-u32 nvhost_vic::SetNVMAPfd(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_vic::SetNVMAPfd(IoctlInput input, IoctlOutput output) {
     IoctlSetNvmapFD params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, fd={}", params.nvmap_fd);
@@ -2,7 +2,6 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
 #include <cstring>
 
 #include "common/assert.h"
@@ -28,7 +27,31 @@ VAddr nvmap::GetObjectAddress(u32 handle) const {
     return object->addr;
 }
 
-u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::CreateHandle(std::shared_ptr<Object> object) {
+    u32 index;
+    if (free_slots.empty()) {
+        index = static_cast<u32>(handles.size());
+        ASSERT_MSG(index < HandleIndexMask, "Out of nvmap handles");
+        handles.emplace_back();
+    } else {
+        index = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    HandleSlot& slot = handles[index];
+    slot.object = std::move(object);
+    return (slot.generation << HandleIndexBits) | (index + 1);
+}
+
+void nvmap::FreeHandle(u32 handle) {
+    const u32 index = (handle & HandleIndexMask) - 1;
+    HandleSlot& slot = handles[index];
+    slot.object.reset();
+    slot.generation = (slot.generation + 1) & HandleGenerationMask;
+    free_slots.push_back(index);
+}
+
+u32 nvmap::ioctl(Ioctl command, IoctlInput input, IoctlOutput output) {
     switch (static_cast<IoctlCommand>(command.raw)) {
     case IoctlCommand::Create:
         return IocCreate(input, output);
@@ -48,7 +71,7 @@ u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& o
     return 0;
 }
 
-u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocCreate(IoctlInput input, IoctlOutput output) {
     IocCreateParams params;
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_DEBUG(Service_NVDRV, "size=0x{:08X}", params.size);
@@ -57,15 +80,15 @@ u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
         LOG_ERROR(Service_NVDRV, "Size is 0");
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
-    // Create a new nvmap object and obtain a handle to it.
+    // Create a new nvmap object and obtain a handle to it. Like the real nvservices, the id of
+    // the object is its handle.
     auto object = std::make_shared<Object>();
-    object->id = next_id++;
     object->size = params.size;
     object->status = Object::Status::Created;
     object->refcount = 1;
 
-    u32 handle = next_handle++;
-    handles[handle] = std::move(object);
+    const u32 handle = CreateHandle(object);
+    object->id = handle;
 
     params.handle = handle;
 
@@ -73,7 +96,7 @@ u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocAlloc(IoctlInput input, IoctlOutput output) {
     IocAllocParams params;
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_DEBUG(Service_NVDRV, "called, addr={:X}", params.addr);
@@ -114,7 +137,7 @@ u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocGetId(IoctlInput input, IoctlOutput output) {
     IocGetIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -137,35 +160,33 @@ u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFromId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFromId(IoctlInput input, IoctlOutput output) {
     IocFromIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called");
 
-    auto itr = std::find_if(handles.begin(), handles.end(),
-                            [&](const auto& entry) { return entry.second->id == params.id; });
-    if (itr == handles.end()) {
+    const auto object = GetObject(params.id);
+    if (!object) {
         LOG_ERROR(Service_NVDRV, "Object does not exist, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    auto& object = itr->second;
     if (object->status != Object::Status::Allocated) {
         LOG_ERROR(Service_NVDRV, "Object is not allocated, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    itr->second->refcount++;
+    object->refcount++;
 
     // Return the existing handle instead of creating a new one.
-    params.handle = itr->first;
+    params.handle = params.id;
 
     std::memcpy(output.data(), &params, sizeof(params));
     return 0;
 }
 
-u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocParam(IoctlInput input, IoctlOutput output) {
     enum class ParamTypes { Size = 1, Alignment = 2, Base = 3, Heap = 4, Kind = 5, Compr = 6 };
 
     IocParamParams params;
@@ -206,7 +227,7 @@ u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFree(IoctlInput input, IoctlOutput output) {
     // TODO(Subv): These flags are unconfirmed.
     enum FreeFlags {
         Freed = 0,
@@ -218,12 +239,12 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
 
     LOG_WARNING(Service_NVDRV, "(STUBBED) called");
 
-    auto itr = handles.find(params.handle);
-    if (itr == handles.end()) {
+    const auto object = GetObject(params.handle);
+    if (!object) {
         LOG_ERROR(Service_NVDRV, "Object does not exist, handle={:08X}", params.handle);
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
-    if (!itr->second->refcount) {
+    if (!object->refcount) {
         LOG_ERROR(
             Service_NVDRV,
             "There is no references to this object. The object is already freed. handle={:08X}",
@@ -231,21 +252,21 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
         return static_cast<u32>(NvErrCodes::InvalidValue);
     }
 
-    itr->second->refcount--;
+    object->refcount--;
 
-    params.size = itr->second->size;
+    params.size = object->size;
 
-    if (itr->second->refcount == 0) {
+    if (object->refcount == 0) {
         params.flags = Freed;
         // The address of the nvmap is written to the output if we're finally freeing it, otherwise
         // 0 is written.
-        params.address = itr->second->addr;
+        params.address = object->addr;
     } else {
         params.flags = NotFreedYet;
         params.address = 0;
     }
 
-    handles.erase(params.handle);
+    FreeHandle(params.handle);
 
     std::memcpy(output.data(), &params, sizeof(params));
     return 0;
@@ -5,7 +5,6 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <vector>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
@@ -22,7 +21,7 @@ public:
     /// Returns the allocated address of an nvmap object given its handle.
     VAddr GetObjectAddress(u32 handle) const;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, IoctlInput input, IoctlOutput output) override;
 
     /// Represents an nvmap object.
     struct Object {
@@ -37,23 +36,42 @@ public:
         u32 refcount;
     };
 
+    /// Returns the object a handle refers to, or null if the handle is invalid or was freed.
     std::shared_ptr<Object> GetObject(u32 handle) const {
-        auto itr = handles.find(handle);
-        if (itr != handles.end()) {
-            return itr->second;
+        const u32 index = (handle & HandleIndexMask) - 1;
+        if (index >= handles.size()) {
+            return {};
         }
-        return {};
+        const HandleSlot& slot = handles[index];
+        if (slot.generation != handle >> HandleIndexBits) {
+            return {};
+        }
+        return slot.object;
     }
 
 private:
-    /// Id to use for the next handle that is created.
-    u32 next_handle = 1;
+    /// Handles are the index of their slot plus one, with the generation of the slot in the upper
+    /// bits. Freeing a handle bumps the generation, so stale handles to a reused slot are invalid.
+    static constexpr u32 HandleIndexBits = 20;
+    static constexpr u32 HandleIndexMask = (1U << HandleIndexBits) - 1;
+    static constexpr u32 HandleGenerationMask = (1U << (32 - HandleIndexBits)) - 1;
+
+    struct HandleSlot {
+        std::shared_ptr<Object> object;
+        u32 generation = 0;
+    };
+
+    /// Creates a handle to an object, reusing the slot of a freed handle if there is one.
+    u32 CreateHandle(std::shared_ptr<Object> object);
+
+    /// Frees a valid handle.
+    void FreeHandle(u32 handle);
 
-    /// Id to use for the next object that is created.
-    u32 next_id = 1;
+    /// Slots of the handles, indexed by handle.
+    std::vector<HandleSlot> handles;
 
-    /// Mapping of currently allocated handles to the objects they represent.
-    std::unordered_map<u32, std::shared_ptr<Object>> handles;
+    /// Indices of the slots without an object.
+    std::vector<u32> free_slots;
 
     enum class IoctlCommand : u32 {
         Create = 0xC0080101,
@@ -117,12 +135,12 @@ private:
     };
     static_assert(sizeof(IocGetIdParams) == 8, "IocGetIdParams has wrong size");
 
-    u32 IocCreate(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocAlloc(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocGetId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFromId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocParam(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFree(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 IocCreate(IoctlInput input, IoctlOutput output);
+    u32 IocAlloc(IoctlInput input, IoctlOutput output);
+    u32 IocGetId(IoctlInput input, IoctlOutput output);
+    u32 IocFromId(IoctlInput input, IoctlOutput output);
+    u32 IocParam(IoctlInput input, IoctlOutput output);
+    u32 IocFree(IoctlInput input, IoctlOutput output);
 };
 
 } // namespace Service::Nvidia::Devices
@@ -34,13 +34,13 @@ void NVDRV::Ioctl(Kernel::HLERequestContext& ctx) {
     u32 fd = rp.Pop<u32>();
     u32 command = rp.Pop<u32>();
 
-    std::vector<u8> output(ctx.GetWriteBufferSize());
+    // The buffers are used in place, the output is written back with the response when it isn't
+    // contiguous in host memory
+    const u32 result = nvdrv->Ioctl(fd, command, ctx.ReadBufferSpan(), ctx.WriteBufferSpan());
 
     IPC::ResponseBuilder rb{ctx, 3};
     rb.Push(RESULT_SUCCESS);
-    rb.Push(nvdrv->Ioctl(fd, command, ctx.ReadBuffer(), output));
-
-    ctx.WriteBuffer(output);
+    rb.Push(result);
 }
 
 void NVDRV::Close(Kernel::HLERequestContext& ctx) {
@@ -67,11 +67,17 @@ void NVDRV::QueryEvent(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
     u32 fd = rp.Pop<u32>();
     u32 event_id = rp.Pop<u32>();
-    LOG_WARNING(Service_NVDRV, "(STUBBED) called, fd={:X}, event_id={:X}", fd, event_id);
+    LOG_DEBUG(Service_NVDRV, "called, fd={:X}, event_id={:X}", fd, event_id);
+
+    auto event = nvdrv->QueryEvent(fd, event_id);
+    if (!event) {
+        LOG_WARNING(Service_NVDRV, "(STUBBED) no event for fd={:X}, event_id={:X}", fd, event_id);
+        event = query_event.readable;
+    }
 
     IPC::ResponseBuilder rb{ctx, 3, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushCopyObjects(query_event.readable);
+    rb.PushCopyObjects(event);
     rb.Push<u32>(0);
 }
 
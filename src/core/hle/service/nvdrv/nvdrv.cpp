@@ -59,7 +59,7 @@ u32 Module::Open(const std::string& device_name) {
     return fd;
 }
 
-u32 Module::Ioctl(u32 fd, u32 command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 Module::Ioctl(u32 fd, u32 command, Devices::IoctlInput input, Devices::IoctlOutput output) {
     auto itr = open_files.find(fd);
     ASSERT_MSG(itr != open_files.end(), "Tried to talk to an invalid device");
 
@@ -67,6 +67,15 @@ u32 Module::Ioctl(u32 fd, u32 command, const std::vector<u8>& input, std::vector
     return device->ioctl({command}, input, output);
 }
 
+Kernel::SharedPtr<Kernel::ReadableEvent> Module::QueryEvent(u32 fd, u32 event_id) {
+    auto itr = open_files.find(fd);
+    if (itr == open_files.end()) {
+        LOG_ERROR(Service_NVDRV, "Queried an event of an invalid device, fd={}", fd);
+        return nullptr;
+    }
+    return itr->second->QueryEvent(event_id);
+}
+
 ResultCode Module::Close(u32 fd) {
     auto itr = open_files.find(fd);
     ASSERT_MSG(itr != open_files.end(), "Tried to talk to an invalid device");
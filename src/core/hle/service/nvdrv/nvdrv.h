@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
+#include "core/hle/service/nvdrv/devices/nvdevice.h"
 #include "core/hle/service/service.h"
 
 namespace Service::NVFlinger {
@@ -16,10 +17,6 @@ class NVFlinger;
 
 namespace Service::Nvidia {
 
-namespace Devices {
-class nvdevice;
-}
-
 struct IoctlFence {
     u32 id;
     u32 value;
@@ -44,9 +41,11 @@ public:
     /// Opens a device node and returns a file descriptor to it.
     u32 Open(const std::string& device_name);
     /// Sends an ioctl command to the specified file descriptor.
-    u32 Ioctl(u32 fd, u32 command, const std::vector<u8>& input, std::vector<u8>& output);
+    u32 Ioctl(u32 fd, u32 command, Devices::IoctlInput input, Devices::IoctlOutput output);
     /// Closes a device file descriptor and returns operation success.
     ResultCode Close(u32 fd);
+    /// Returns an event of the device referenced by a file descriptor, or null if it has none.
+    Kernel::SharedPtr<Kernel::ReadableEvent> QueryEvent(u32 fd, u32 event_id);
 
 private:
     /// Id to use for the next open file descriptor.
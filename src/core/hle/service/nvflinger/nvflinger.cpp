@@ -29,6 +29,18 @@ namespace Service::NVFlinger {
 constexpr s64 frame_ticks = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 60);
 constexpr s64 frame_ticks_30fps = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE / 30);
 
+namespace {
+
+Tegra::FramebufferConfig GetFramebuffer(const Nvidia::Devices::nvdisp_disp0& nvdisp,
+                                        const BufferQueue::Buffer& buffer) {
+    const auto& igbp_buffer = buffer.igbp_buffer;
+    return nvdisp.GetFramebuffer(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
+                                 igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride,
+                                 buffer.transform, buffer.crop_rect);
+}
+
+} // Anonymous namespace
+
 NVFlinger::NVFlinger(Core::Timing::CoreTiming& core_timing) : core_timing{core_timing} {
     displays.emplace_back(0, "Default");
     displays.emplace_back(1, "External");
@@ -46,10 +58,14 @@ NVFlinger::NVFlinger(Core::Timing::CoreTiming& core_timing) : core_timing{core_t
         });
 
     core_timing.ScheduleEvent(ticks, composition_event);
+
+    release_event = core_timing.RegisterEvent(
+        "BufferRelease", [this](u64 token, s64 cycles_late) { ReleaseBuffers(token); });
 }
 
 NVFlinger::~NVFlinger() {
     core_timing.UnscheduleEvent(composition_event, 0);
+    core_timing.RemoveNormalAndThreadsafeEvent(release_event);
 }
 
 void NVFlinger::SetNVDrvInstance(std::shared_ptr<Nvidia::Module> instance) {
@@ -176,37 +192,94 @@ void NVFlinger::Compose() {
         if (!display.HasLayers())
             continue;
 
-        // TODO(Subv): Support more than 1 layer.
-        VI::Layer& layer = display.GetLayer(0);
-        auto& buffer_queue = layer.GetBufferQueue();
+        // Buffers queued since the last vsync have already been sent to the GPU
+        if (IsComposed(display.GetID()))
+            continue;
 
-        // Search for a queued buffer and acquire it
-        auto buffer = buffer_queue.AcquireBuffer();
+        ComposeDisplay(display);
+    }
+    composed_displays.clear();
+}
 
-        MicroProfileFlip();
+void NVFlinger::OnBufferQueued(u32 buffer_queue_id) {
+    Core::System::GetInstance().GetPerfStats().RecordFrameEvent(Core::FrameEvent::QueueBuffer);
 
-        if (!buffer) {
-            auto& system_instance = Core::System::GetInstance();
+    if (!Settings::values.use_immediate_composition) {
+        return;
+    }
 
-            // There was no queued buffer to draw, render previous frame
-            system_instance.GetPerfStats().EndGameFrame();
-            system_instance.GPU().SwapBuffers({});
+    for (auto& display : displays) {
+        // Only the primary layer paces the display
+        if (!display.HasLayers() || display.GetLayer(0).GetBufferQueue().GetId() != buffer_queue_id)
             continue;
+
+        ComposeDisplay(display);
+        if (!IsComposed(display.GetID())) {
+            composed_displays.push_back(display.GetID());
         }
+    }
+}
+
+bool NVFlinger::IsComposed(u64 display_id) const {
+    return std::find(composed_displays.begin(), composed_displays.end(), display_id) !=
+           composed_displays.end();
+}
+
+void NVFlinger::ComposeDisplay(VI::Display& display) {
+    auto& buffer_queue = display.GetLayer(0).GetBufferQueue();
+
+    // Search for a queued buffer and acquire it
+    auto buffer = buffer_queue.AcquireBuffer();
+
+    MicroProfileFlip();
+
+    if (!buffer) {
+        auto& system_instance = Core::System::GetInstance();
+
+        // There was no queued buffer to draw, render previous frame
+        system_instance.GetPerfStats().EndGameFrame();
+        system_instance.GPU().SwapBuffers({});
+        return;
+    }
 
-        const auto& igbp_buffer = buffer->get().igbp_buffer;
+    Core::System::GetInstance().GetPerfStats().RecordFrameEvent(Core::FrameEvent::Compose);
 
-        // Now send the buffer to the GPU for drawing.
-        // TODO(Subv): Support more than just disp0. The display device selection is probably based
-        // on which display we're drawing (Default, Internal, External, etc)
-        auto nvdisp = nvdrv->GetDevice<Nvidia::Devices::nvdisp_disp0>("/dev/nvdisp_disp0");
-        ASSERT(nvdisp);
+    // Now send the buffer to the GPU for drawing.
+    // TODO(Subv): Support more than just disp0. The display device selection is probably based
+    // on which display we're drawing (Default, Internal, External, etc)
+    auto nvdisp = nvdrv->GetDevice<Nvidia::Devices::nvdisp_disp0>("/dev/nvdisp_disp0");
+    ASSERT(nvdisp);
 
-        nvdisp->flip(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
-                     igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride,
-                     buffer->get().transform, buffer->get().crop_rect);
+    const u64 token = next_release_token++;
+    pending_releases.push_back({token, buffer_queue.GetId(), buffer->get().slot});
+
+    // Latch the buffers queued to the other layers, the ones without a new buffer keep showing
+    // their previous one
+    Tegra::FramebufferOverlays overlays(display.GetNumLayers() - 1);
+    for (std::size_t index = 1; index < display.GetNumLayers(); ++index) {
+        auto& overlay_queue = display.GetLayer(index).GetBufferQueue();
+        const auto overlay = overlay_queue.AcquireBuffer();
+        if (!overlay) {
+            continue;
+        }
+        overlays[index - 1] = GetFramebuffer(*nvdisp, overlay->get());
+        pending_releases.push_back({token, overlay_queue.GetId(), overlay->get().slot});
+    }
+
+    // The buffers go back to the guest as soon as the GPU has read them instead of waiting for the
+    // next composition. This may run on the GPU thread, so hop back to the emulated CPU.
+    nvdisp->flip(GetFramebuffer(*nvdisp, buffer->get()), std::move(overlays),
+                 [&core_timing = core_timing, release_event = release_event, token] {
+                     core_timing.ScheduleEventThreadsafe(0, release_event, token);
+                 });
+}
 
-        buffer_queue.ReleaseBuffer(buffer->get().slot);
+void NVFlinger::ReleaseBuffers(u64 token) {
+    // The GPU reads the compositions in the order they were sent
+    while (!pending_releases.empty() && pending_releases.front().token <= token) {
+        const PendingRelease& release = pending_releases.front();
+        FindBufferQueue(release.buffer_queue_id).ReleaseBuffer(release.slot);
+        pending_releases.pop_front();
     }
 }
 
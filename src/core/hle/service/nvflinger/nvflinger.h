@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -74,7 +75,23 @@ public:
     /// finished.
     void Compose();
 
+    /// Notifies that a buffer was queued to the given buffer queue. With immediate composition the
+    /// buffer is sent to the GPU right away, vsync events are still signaled at the fixed rate.
+    /// The event is recorded in the frame history of the performance statistics.
+    void OnBufferQueued(u32 buffer_queue_id);
+
 private:
+    /// Sends the next queued buffer of the display to the GPU, or presents the previous frame again
+    /// if there is none. The primary layer paces the display, the buffers queued to the other
+    /// layers are composed on top of it when it presents.
+    void ComposeDisplay(VI::Display& display);
+
+    /// Hands the buffers presented with the given token back to their queues.
+    void ReleaseBuffers(u64 token);
+
+    /// Returns true when the display has been composed since its last vsync.
+    bool IsComposed(u64 display_id) const;
+
     /// Finds the display identified by the specified ID.
     VI::Display* FindDisplay(u64 display_id);
 
@@ -90,7 +107,8 @@ private:
     std::shared_ptr<Nvidia::Module> nvdrv;
 
     std::vector<VI::Display> displays;
-    std::vector<BufferQueue> buffer_queues;
+    /// Layers reference their buffer queue, so the queues must not move when new ones are added.
+    std::deque<BufferQueue> buffer_queues;
 
     /// Id to use for the next layer that is created, this counter is shared among all displays.
     u64 next_layer_id = 1;
@@ -98,9 +116,28 @@ private:
     /// layers.
     u32 next_buffer_queue_id = 1;
 
+    /// Displays that have already been composed since their last vsync, used with immediate
+    /// composition to avoid presenting the same frame twice.
+    std::vector<u64> composed_displays;
+
+    /// Buffer acquired for a composition, waiting for the GPU to be done with it.
+    struct PendingRelease {
+        u64 token;
+        u32 buffer_queue_id;
+        u32 slot;
+    };
+
+    /// Presented buffers that haven't been handed back to their queues, in presentation order.
+    std::deque<PendingRelease> pending_releases;
+    /// Token identifying the buffers of the next composition sent to the GPU.
+    u64 next_release_token = 1;
+
     /// Event that handles screen composition.
     Core::Timing::EventType* composition_event;
 
+    /// Event that releases presented buffers, scheduled by the GPU once it has read them.
+    Core::Timing::EventType* release_event;
+
     /// Core timing instance for registering/unregistering the composition event.
     Core::Timing::CoreTiming& core_timing;
 };
@@ -7,6 +7,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/ipc_helpers.h"
@@ -68,6 +69,7 @@
 #include "core/hle/service/usb/usb.h"
 #include "core/hle/service/vi/vi.h"
 #include "core/hle/service/wlan/wlan.h"
+#include "core/perf_stats.h"
 
 namespace Service {
 
@@ -128,13 +130,30 @@ Kernel::SharedPtr<Kernel::ClientPort> ServiceFrameworkBase::CreatePort() {
 }
 
 void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n) {
-    handlers.reserve(handlers.size() + n);
     for (std::size_t i = 0; i < n; ++i) {
-        // Usually this array is sorted by id already, so hint to insert at the end
-        handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
+        const FunctionInfoBase& info = functions[i];
+        if (info.expected_header < DENSE_HANDLERS_LIMIT) {
+            if (info.expected_header >= dense_handlers.size()) {
+                dense_handlers.resize(info.expected_header + 1, FunctionInfoBase{});
+            }
+            dense_handlers[info.expected_header] = info;
+        } else {
+            // Usually this array is sorted by id already, so hint to insert at the end
+            sparse_handlers.emplace_hint(sparse_handlers.cend(), info.expected_header, info);
+        }
     }
 }
 
+const ServiceFrameworkBase::FunctionInfoBase* ServiceFrameworkBase::FindHandler(
+    u32 command) const {
+    if (command < dense_handlers.size()) {
+        const FunctionInfoBase& info = dense_handlers[command];
+        return info.name != nullptr ? &info : nullptr;
+    }
+    const auto it = sparse_handlers.find(command);
+    return it != sparse_handlers.end() ? &it->second : nullptr;
+}
+
 void ServiceFrameworkBase::ReportUnimplementedFunction(Kernel::HLERequestContext& ctx,
                                                        const FunctionInfoBase* info) {
     auto cmd_buf = ctx.CommandBuffer();
@@ -152,14 +171,21 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(Kernel::HLERequestContext
 }
 
 void ServiceFrameworkBase::InvokeRequest(Kernel::HLERequestContext& ctx) {
-    auto itr = handlers.find(ctx.GetCommand());
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
-    if (info == nullptr || info->handler_callback == nullptr) {
+    const FunctionInfoBase* info = FindHandler(ctx.GetCommand());
+    const bool is_implemented{info != nullptr && (info->handler_callback != nullptr ||
+                                                  info->decoded_invoker != nullptr)};
+    if (!is_implemented) {
         return ReportUnimplementedFunction(ctx, info);
     }
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName(), ctx.CommandBuffer()));
-    handler_invoker(this, info->handler_callback, ctx);
+    TRACE_SCOPE_DYNAMIC("IPC", info->name);
+    Core::System::GetInstance().GetPerfStats().AddSessionCount(Core::SessionCounter::IpcRequests);
+    if (info->decoded_invoker != nullptr) {
+        info->decoded_invoker(this, ctx);
+    } else {
+        handler_invoker(this, info->handler_callback, ctx);
+    }
 }
 
 ResultCode ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
@@ -6,8 +6,11 @@
 
 #include <cstddef>
 #include <string>
+#include <tuple>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
+#include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/object.h"
 
@@ -80,19 +83,28 @@ private:
     template <typename T>
     friend class ServiceFramework;
 
+    /// Function generated for a handler that takes its arguments decoded from the request.
+    using DecodedInvokerFn = void(ServiceFrameworkBase* object, Kernel::HLERequestContext& ctx);
+
     struct FunctionInfoBase {
         u32 expected_header;
         HandlerFnP<ServiceFrameworkBase> handler_callback;
         const char* name;
+        DecodedInvokerFn* decoded_invoker; ///< Used instead of handler_callback when not null
     };
 
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
                            Kernel::HLERequestContext& ctx);
 
+    /// Commands with ids below this are dispatched through a table indexed by the id, the ids of
+    /// the few commands above it are looked up.
+    static constexpr u32 DENSE_HANDLERS_LIMIT = 512;
+
     ServiceFrameworkBase(const char* service_name, u32 max_sessions, InvokerFn* handler_invoker);
     ~ServiceFrameworkBase() override;
 
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
+    const FunctionInfoBase* FindHandler(u32 command) const;
     void ReportUnimplementedFunction(Kernel::HLERequestContext& ctx, const FunctionInfoBase* info);
 
     /// Identifier string used to connect to the service.
@@ -106,7 +118,9 @@ private:
 
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
-    boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /// Handlers indexed by their id, entries without a name are not registered.
+    std::vector<FunctionInfoBase> dense_handlers;
+    boost::container::flat_map<u32, FunctionInfoBase> sparse_handlers;
 };
 
 /**
@@ -123,7 +137,35 @@ private:
  */
 template <typename Self>
 class ServiceFramework : public ServiceFrameworkBase {
+    /// Pops the arguments of a handler from the request, then invokes it.
+    template <auto handler>
+    static void InvokeDecoded(ServiceFrameworkBase* object, Kernel::HLERequestContext& ctx) {
+        CallDecoded(static_cast<Self*>(object), ctx, handler);
+    }
+
+    template <typename... Args>
+    static void CallDecoded(Self* self, Kernel::HLERequestContext& ctx,
+                            void (Self::*handler)(Kernel::HLERequestContext&, Args...)) {
+        IPC::RequestParser rp{ctx};
+        // The elements of a braced initializer are evaluated in order
+        const std::tuple<Args...> args{rp.Pop<Args>()...};
+        std::apply([&](const Args&... arguments) { (self->*handler)(ctx, arguments...); }, args);
+    }
+
 protected:
+    /// Tag type carrying the invoker generated for a handler with decoded arguments.
+    struct DecodedHandler {
+        DecodedInvokerFn* invoker;
+    };
+
+    /**
+     * Handler that takes the raw arguments of the request as parameters, after the context. They
+     * are popped from the request in declaration order with IPC::RequestParser, like a handler
+     * doing it by hand would. Used in a handler table as `{id, Decoded<&Self::Handler>, "Name"}`.
+     */
+    template <auto handler>
+    static constexpr DecodedHandler Decoded{&InvokeDecoded<handler>};
+
     /// Contains information about a request type which is handled by the service.
     struct FunctionInfo : FunctionInfoBase {
         // TODO(yuriks): This function could be constexpr, but clang is the only compiler that
@@ -142,7 +184,12 @@ protected:
             : FunctionInfoBase{
                   expected_header,
                   // Type-erase member function pointer by casting it down to the base class.
-                  static_cast<HandlerFnP<ServiceFrameworkBase>>(handler_callback), name} {}
+                  static_cast<HandlerFnP<ServiceFrameworkBase>>(handler_callback), name,
+                  nullptr} {}
+
+        /// Constructs a FunctionInfo for a function taking its arguments decoded.
+        constexpr FunctionInfo(u32 expected_header, DecodedHandler handler, const char* name)
+            : FunctionInfoBase{expected_header, nullptr, name, handler.invoker} {}
     };
 
     /**
@@ -0,0 +1,106 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/writable_event.h"
+#include "core/hle/lock.h"
+#include "core/hle/service/service_thread.h"
+#include "core/settings.h"
+
+namespace Service {
+
+struct ServiceThread::Request {
+    WorkFunction work;
+    ReplyFunction reply;
+    Kernel::SharedPtr<Kernel::WritableEvent> event; ///< Wakes up the client thread
+};
+
+ServiceThread::ServiceThread(Core::System& system, std::string name, std::size_t num_workers)
+    : system{system}, name{std::move(name)} {
+    completion_event = system.CoreTiming().RegisterEvent(
+        "ServiceThread::" + this->name,
+        [this](u64 userdata, s64 cycles_late) { SignalCompletedRequests(); });
+    for (std::size_t i = 0; i < std::max<std::size_t>(num_workers, 1); ++i) {
+        workers.emplace_back(&ServiceThread::WorkerLoop, this);
+    }
+}
+
+ServiceThread::~ServiceThread() {
+    // Queued requests are completed, their client threads are not woken up anymore
+    {
+        std::scoped_lock lock{mutex};
+        stop_worker = true;
+    }
+    work_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    system.CoreTiming().UnscheduleEvent(completion_event, 0);
+}
+
+void ServiceThread::QueueRequest(Kernel::HLERequestContext& ctx, WorkFunction work) {
+    if (!Settings::values.use_service_threads) {
+        work()(ctx);
+        return;
+    }
+
+    auto request = std::make_shared<Request>();
+    request->work = std::move(work);
+    request->event = ctx.SleepClientThread(
+        name, -1,
+        [request](Kernel::SharedPtr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                  Kernel::ThreadWakeupReason reason) { request->reply(ctx); });
+    {
+        std::scoped_lock lock{mutex};
+        pending_requests.push_back(std::move(request));
+    }
+    work_condition.notify_one();
+}
+
+void ServiceThread::WorkerLoop() {
+    while (true) {
+        std::shared_ptr<Request> request;
+        {
+            std::unique_lock lock{mutex};
+            work_condition.wait(lock, [this] { return stop_worker || !pending_requests.empty(); });
+            if (pending_requests.empty()) {
+                return;
+            }
+            request = std::move(pending_requests.front());
+            pending_requests.pop_front();
+        }
+
+        request->reply = request->work();
+        request->work = nullptr;
+        {
+            std::scoped_lock lock{mutex};
+            completed_requests.push_back(std::move(request));
+        }
+        // Kernel objects can only be touched by the emulated cores, hand the wakeup over to them
+        system.CoreTiming().ScheduleEventThreadsafe(0, completion_event);
+    }
+}
+
+void ServiceThread::SignalCompletedRequests() {
+    std::lock_guard hle_lock{HLE::g_hle_lock};
+
+    std::vector<std::shared_ptr<Request>> requests;
+    {
+        std::scoped_lock lock{mutex};
+        requests.swap(completed_requests);
+    }
+    for (const auto& request : requests) {
+        request->event->Signal();
+    }
+}
+
+} // namespace Service
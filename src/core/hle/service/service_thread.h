@@ -0,0 +1,80 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Core {
+class System;
+}
+
+namespace Core::Timing {
+struct EventType;
+}
+
+namespace Kernel {
+class HLERequestContext;
+}
+
+namespace Service {
+
+/**
+ * Host threads running the slow part of the requests of a service, such as decoding, while the
+ * emulated cores keep executing. The client thread of a queued request sleeps like it would on
+ * Horizon and resumes once the reply has been written on the emulated core.
+ */
+class ServiceThread final {
+public:
+    /// Writes the response of a request, runs on the emulated core once the work has completed
+    using ReplyFunction = std::function<void(Kernel::HLERequestContext& ctx)>;
+
+    /// Runs on the host thread, it must not access guest memory or kernel objects
+    using WorkFunction = std::function<ReplyFunction()>;
+
+    /**
+     * @param name Name of the service, used for the sleep of the client threads
+     * @param num_workers Number of host threads, with more than one the work of the requests must
+     *                    synchronize the state it shares with other requests
+     */
+    explicit ServiceThread(Core::System& system, std::string name, std::size_t num_workers = 1);
+    ~ServiceThread();
+
+    /**
+     * Runs the work of a request on a host thread. A client thread sleeps until its request is
+     * replied to, so its requests run in the order they were queued. The work runs inline when
+     * Settings::values.use_service_threads is unset.
+     * @param ctx Request whose client thread sleeps until the reply has been written
+     * @param work Function doing the work, it returns the function writing the reply
+     */
+    void QueueRequest(Kernel::HLERequestContext& ctx, WorkFunction work);
+
+private:
+    struct Request;
+
+    void WorkerLoop();
+
+    /// Wakes up the client threads of the completed requests, runs on the emulated core
+    void SignalCompletedRequests();
+
+    Core::System& system;
+    const std::string name;
+    Core::Timing::EventType* completion_event;
+
+    std::mutex mutex;
+    std::condition_variable work_condition;
+    std::deque<std::shared_ptr<Request>> pending_requests;
+    std::vector<std::shared_ptr<Request>> completed_requests;
+    bool stop_worker = false;
+    std::vector<std::thread> workers;
+};
+
+} // namespace Service
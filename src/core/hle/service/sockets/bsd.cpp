@@ -2,11 +2,305 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/readable_event.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/writable_event.h"
 #include "core/hle/service/sockets/bsd.h"
 
 namespace Service::Sockets {
 
+namespace {
+
+/// Error codes of the guest, they follow FreeBSD
+enum class Errno : u32 {
+    SUCCESS = 0,
+    BADF = 9,
+    INVAL = 22,
+    MFILE = 24,
+    PIPE = 32,
+    AGAIN = 35,
+    INPROGRESS = 36,
+    ALREADY = 37,
+    MSGSIZE = 40,
+    NOPROTOOPT = 42,
+    PROTONOSUPPORT = 43,
+    OPNOTSUPP = 45,
+    AFNOSUPPORT = 47,
+    ADDRINUSE = 48,
+    ADDRNOTAVAIL = 49,
+    NETUNREACH = 51,
+    CONNABORTED = 53,
+    CONNRESET = 54,
+    NOBUFS = 55,
+    ISCONN = 56,
+    NOTCONN = 57,
+    TIMEDOUT = 60,
+    CONNREFUSED = 61,
+    HOSTUNREACH = 65,
+};
+
+constexpr u32 AF_INET = 2;
+
+constexpr u32 SOCK_STREAM = 1;
+constexpr u32 SOCK_DGRAM = 2;
+constexpr u32 SOCK_RAW = 3;
+constexpr u32 SOCK_NONBLOCK = 0x20000000;
+constexpr u32 SOCK_CLOEXEC = 0x10000000;
+
+constexpr u32 IPPROTO_IP = 0;
+constexpr u32 IPPROTO_ICMP = 1;
+constexpr u32 IPPROTO_TCP = 6;
+constexpr u32 IPPROTO_UDP = 17;
+
+constexpr u32 SOL_SOCKET = 0xFFFF;
+constexpr u32 SO_REUSEADDR = 0x4;
+constexpr u32 SO_KEEPALIVE = 0x8;
+constexpr u32 SO_BROADCAST = 0x20;
+constexpr u32 SO_LINGER = 0x80;
+constexpr u32 SO_REUSEPORT = 0x200;
+constexpr u32 SO_SNDBUF = 0x1001;
+constexpr u32 SO_RCVBUF = 0x1002;
+constexpr u32 SO_SNDTIMEO = 0x1005;
+constexpr u32 SO_RCVTIMEO = 0x1006;
+constexpr u32 SO_ERROR = 0x1007;
+constexpr u32 SO_TYPE = 0x1008;
+constexpr u32 TCP_NODELAY = 0x1;
+
+constexpr u32 MSG_PEEK = 0x2;
+constexpr u32 MSG_DONTWAIT = 0x80;
+
+constexpr u32 F_GETFL = 3;
+constexpr u32 F_SETFL = 4;
+constexpr u32 O_NONBLOCK = 0x4;
+
+constexpr u16 POLLIN = 0x1;
+constexpr u16 POLLPRI = 0x2;
+constexpr u16 POLLOUT = 0x4;
+constexpr u16 POLLERR = 0x8;
+constexpr u16 POLLHUP = 0x10;
+constexpr u16 POLLNVAL = 0x20;
+constexpr u16 POLLRDNORM = 0x40;
+
+struct SockAddrIn {
+    u8 len;
+    u8 family;
+    u16_be portno;
+    std::array<u8, 4> ip;
+    std::array<u8, 8> zeroes;
+};
+static_assert(sizeof(SockAddrIn) == 16, "SockAddrIn has wrong size");
+
+struct PollFD {
+    s32 fd;
+    u16 events;
+    u16 revents;
+};
+static_assert(sizeof(PollFD) == 8, "PollFD has wrong size");
+
+struct Linger {
+    u32 onoff;
+    u32 linger;
+};
+static_assert(sizeof(Linger) == 8, "Linger has wrong size");
+
+struct TimeVal {
+    s64 sec;
+    s64 usec;
+};
+static_assert(sizeof(TimeVal) == 16, "TimeVal has wrong size");
+
+Errno Translate(Network::Errno value) {
+    switch (value) {
+    case Network::Errno::SUCCESS:
+        return Errno::SUCCESS;
+    case Network::Errno::BADF:
+        return Errno::BADF;
+    case Network::Errno::INVAL:
+        return Errno::INVAL;
+    case Network::Errno::MFILE:
+        return Errno::MFILE;
+    case Network::Errno::AGAIN:
+        return Errno::AGAIN;
+    case Network::Errno::INPROGRESS:
+        return Errno::INPROGRESS;
+    case Network::Errno::ALREADY:
+        return Errno::ALREADY;
+    case Network::Errno::ISCONN:
+        return Errno::ISCONN;
+    case Network::Errno::NOTCONN:
+        return Errno::NOTCONN;
+    case Network::Errno::CONNREFUSED:
+        return Errno::CONNREFUSED;
+    case Network::Errno::CONNRESET:
+        return Errno::CONNRESET;
+    case Network::Errno::CONNABORTED:
+        return Errno::CONNABORTED;
+    case Network::Errno::TIMEDOUT:
+        return Errno::TIMEDOUT;
+    case Network::Errno::NETUNREACH:
+        return Errno::NETUNREACH;
+    case Network::Errno::HOSTUNREACH:
+        return Errno::HOSTUNREACH;
+    case Network::Errno::ADDRINUSE:
+        return Errno::ADDRINUSE;
+    case Network::Errno::ADDRNOTAVAIL:
+        return Errno::ADDRNOTAVAIL;
+    case Network::Errno::MSGSIZE:
+        return Errno::MSGSIZE;
+    case Network::Errno::PIPE:
+        return Errno::PIPE;
+    case Network::Errno::NOBUFS:
+        return Errno::NOBUFS;
+    case Network::Errno::AFNOSUPPORT:
+        return Errno::AFNOSUPPORT;
+    case Network::Errno::OPNOTSUPP:
+        return Errno::OPNOTSUPP;
+    case Network::Errno::OTHER:
+        break;
+    }
+    // There is no generic error, an invalid argument is the closest to an unknown host failure
+    return Errno::INVAL;
+}
+
+Network::SockAddrIn Translate(const SockAddrIn& value) {
+    Network::SockAddrIn result;
+    result.ip = value.ip;
+    result.portno = value.portno;
+    return result;
+}
+
+SockAddrIn Translate(const Network::SockAddrIn& value) {
+    SockAddrIn result{};
+    result.len = sizeof(SockAddrIn);
+    result.family = static_cast<u8>(AF_INET);
+    result.portno = value.portno;
+    result.ip = value.ip;
+    return result;
+}
+
+Network::PollEvents TranslatePollEvents(u16 events) {
+    Network::PollEvents result = Network::PollEvents::None;
+    if ((events & (POLLIN | POLLRDNORM)) != 0) {
+        result |= Network::PollEvents::In;
+    }
+    if ((events & POLLPRI) != 0) {
+        result |= Network::PollEvents::Pri;
+    }
+    if ((events & POLLOUT) != 0) {
+        result |= Network::PollEvents::Out;
+    }
+    return result;
+}
+
+u16 TranslatePollRevents(Network::PollEvents revents, u16 events) {
+    const auto has = [revents](Network::PollEvents event) {
+        return (revents & event) != Network::PollEvents::None;
+    };
+    u16 result = 0;
+    if (has(Network::PollEvents::In)) {
+        result |= events & (POLLIN | POLLRDNORM);
+    }
+    if (has(Network::PollEvents::Pri)) {
+        result |= POLLPRI;
+    }
+    if (has(Network::PollEvents::Out)) {
+        result |= POLLOUT;
+    }
+    if (has(Network::PollEvents::Err)) {
+        result |= POLLERR;
+    }
+    if (has(Network::PollEvents::Hup)) {
+        result |= POLLHUP;
+    }
+    if (has(Network::PollEvents::Nval)) {
+        result |= POLLNVAL;
+    }
+    return result;
+}
+
+/// Converts a guest timeval to nanoseconds, a zero timeval disables the timeout
+s64 TimeValToNanoseconds(const TimeVal& value) {
+    if (value.sec == 0 && value.usec == 0) {
+        return -1;
+    }
+    return std::max<s64>(value.sec * 1000000000 + value.usec * 1000, 1);
+}
+
+TimeVal NanosecondsToTimeVal(s64 value) {
+    if (value < 0) {
+        return {};
+    }
+    return {value / 1000000000, value % 1000000000 / 1000};
+}
+
+/// Most calls respond with a return value and an error code, -1 and the error on failure
+void WriteResponse(Kernel::HLERequestContext& ctx, s32 ret, Errno bsd_errno) {
+    IPC::ResponseBuilder rb{ctx, 4};
+    rb.Push(RESULT_SUCCESS);
+    rb.Push<s32>(ret);
+    rb.PushEnum(bsd_errno);
+}
+
+/// Calls writing a buffer also respond with the size they wrote to it
+void WriteResponse(Kernel::HLERequestContext& ctx, s32 ret, Errno bsd_errno, u32 size) {
+    IPC::ResponseBuilder rb{ctx, 5};
+    rb.Push(RESULT_SUCCESS);
+    rb.Push<s32>(ret);
+    rb.PushEnum(bsd_errno);
+    rb.Push<u32>(size);
+}
+
+void WriteResponse(Kernel::HLERequestContext& ctx, Network::Errno error) {
+    WriteResponse(ctx, error == Network::Errno::SUCCESS ? 0 : -1, Translate(error));
+}
+
+/// Writes an address to the output buffer, returns the size written
+u32 WriteAddress(Kernel::HLERequestContext& ctx, int buffer_index,
+                 const Network::SockAddrIn& address) {
+    if (ctx.GetWriteBufferSize(buffer_index) == 0) {
+        return 0;
+    }
+    const SockAddrIn guest_address = Translate(address);
+    return static_cast<u32>(ctx.WriteBuffer(&guest_address, sizeof(guest_address), buffer_index));
+}
+
+/// Reads an address from the input buffer
+std::optional<Network::SockAddrIn> ReadAddress(Kernel::HLERequestContext& ctx, int buffer_index) {
+    const auto buffer = ctx.ReadBufferSpan(buffer_index);
+    if (buffer.size() < sizeof(SockAddrIn)) {
+        return std::nullopt;
+    }
+    SockAddrIn address;
+    std::memcpy(&address, buffer.data(), sizeof(address));
+    if (address.family != AF_INET) {
+        return std::nullopt;
+    }
+    return Translate(address);
+}
+
+template <typename T>
+std::optional<T> ReadOption(Kernel::HLERequestContext& ctx) {
+    const auto buffer = ctx.ReadBufferSpan();
+    if (buffer.size() < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, buffer.data(), sizeof(value));
+    return value;
+}
+
+} // Anonymous namespace
+
 void BSD::RegisterClient(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service, "(STUBBED) called");
 
@@ -27,52 +321,728 @@ void BSD::StartMonitoring(Kernel::HLERequestContext& ctx) {
 void BSD::Socket(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
 
-    u32 domain = rp.Pop<u32>();
-    u32 type = rp.Pop<u32>();
-    u32 protocol = rp.Pop<u32>();
+    const u32 domain = rp.Pop<u32>();
+    const u32 type = rp.Pop<u32>();
+    const u32 protocol = rp.Pop<u32>();
 
-    LOG_WARNING(Service, "(STUBBED) called domain={} type={} protocol={}", domain, type, protocol);
+    LOG_DEBUG(Service, "called domain={} type={} protocol={}", domain, type, protocol);
 
-    u32 fd = next_fd++;
+    if (domain != AF_INET) {
+        WriteResponse(ctx, -1, Errno::AFNOSUPPORT);
+        return;
+    }
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    const u32 base_type = type & ~(SOCK_NONBLOCK | SOCK_CLOEXEC);
+    Network::Type host_type;
+    switch (base_type) {
+    case SOCK_STREAM:
+        host_type = Network::Type::STREAM;
+        break;
+    case SOCK_DGRAM:
+        host_type = Network::Type::DGRAM;
+        break;
+    case SOCK_RAW:
+        host_type = Network::Type::RAW;
+        break;
+    default:
+        WriteResponse(ctx, -1, Errno::PROTONOSUPPORT);
+        return;
+    }
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(fd);
-    rb.Push<u32>(0); // bsd errno
+    Network::Protocol host_protocol;
+    switch (protocol) {
+    case IPPROTO_IP:
+        host_protocol = Network::Protocol::UNSPECIFIED;
+        break;
+    case IPPROTO_ICMP:
+        host_protocol = Network::Protocol::ICMP;
+        break;
+    case IPPROTO_TCP:
+        host_protocol = Network::Protocol::TCP;
+        break;
+    case IPPROTO_UDP:
+        host_protocol = Network::Protocol::UDP;
+        break;
+    default:
+        WriteResponse(ctx, -1, Errno::PROTONOSUPPORT);
+        return;
+    }
+
+    const auto it = std::find_if(file_descriptors.begin(), file_descriptors.end(),
+                                 [](const auto& descriptor) { return !descriptor; });
+    if (it == file_descriptors.end()) {
+        WriteResponse(ctx, -1, Errno::MFILE);
+        return;
+    }
+
+    auto socket = std::make_unique<Network::Socket>();
+    const Network::Errno error =
+        socket->Initialize(Network::Domain::INET, host_type, host_protocol);
+    if (error != Network::Errno::SUCCESS) {
+        WriteResponse(ctx, -1, Translate(error));
+        return;
+    }
+
+    FileDescriptor& descriptor = it->emplace();
+    descriptor.socket = std::move(socket);
+    descriptor.type = base_type;
+    descriptor.flags = (type & SOCK_NONBLOCK) != 0 ? O_NONBLOCK : 0;
+    descriptor.is_connection_based = base_type == SOCK_STREAM;
+
+    WriteResponse(ctx, static_cast<s32>(it - file_descriptors.begin()), Errno::SUCCESS);
 }
 
-void BSD::Connect(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+void BSD::Poll(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    const s32 nfds = rp.Pop<s32>();
+    const s32 timeout = rp.Pop<s32>();
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+    LOG_DEBUG(Service, "called nfds={} timeout={}", nfds, timeout);
+
+    const auto input = ctx.ReadBufferSpan();
+    if (nfds < 0 || input.size() < nfds * sizeof(PollFD)) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+
+    std::vector<PollFD> guest_fds(nfds);
+    std::memcpy(guest_fds.data(), input.data(), nfds * sizeof(PollFD));
+
+    std::vector<Network::Reactor::Interest> interests;
+    for (const PollFD& guest_fd : guest_fds) {
+        if (const FileDescriptor* descriptor = GetFileDescriptor(guest_fd.fd)) {
+            interests.push_back(
+                {descriptor->socket->GetHandle(), TranslatePollEvents(guest_fd.events)});
+        }
+    }
+
+    const s64 timeout_ns = timeout < 0 ? -1 : s64{timeout} * 1000000;
+    ExecuteBlocking(
+        ctx, std::move(interests), timeout_ns, timeout == 0,
+        [this, guest_fds](Kernel::HLERequestContext& ctx, bool is_final) mutable {
+            std::vector<Network::PollFD> host_fds;
+            for (const PollFD& guest_fd : guest_fds) {
+                if (const FileDescriptor* descriptor = GetFileDescriptor(guest_fd.fd)) {
+                    host_fds.push_back({descriptor->socket->GetHandle(),
+                                        TranslatePollEvents(guest_fd.events),
+                                        Network::PollEvents::None});
+                }
+            }
+
+            const auto [result, error] = Network::Poll(host_fds, 0);
+            if (error != Network::Errno::SUCCESS) {
+                WriteResponse(ctx, -1, Translate(error));
+                return true;
+            }
+
+            // Descriptors that aren't open are reported as invalid, like the host does
+            s32 num_ready = 0;
+            auto host_fd = host_fds.begin();
+            for (PollFD& guest_fd : guest_fds) {
+                if (GetFileDescriptor(guest_fd.fd) == nullptr) {
+                    guest_fd.revents = guest_fd.fd < 0 ? 0 : POLLNVAL;
+                } else {
+                    guest_fd.revents = TranslatePollRevents(host_fd->revents, guest_fd.events);
+                    ++host_fd;
+                }
+                num_ready += guest_fd.revents != 0 ? 1 : 0;
+            }
+            if (num_ready == 0 && !is_final) {
+                return false;
+            }
+
+            ctx.WriteBuffer(guest_fds);
+            WriteResponse(ctx, num_ready, Errno::SUCCESS);
+            return true;
+        });
+}
+
+void BSD::Recv(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+
+    RecvImpl(ctx, fd, flags, false);
+}
+
+void BSD::RecvFrom(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+
+    RecvImpl(ctx, fd, flags, true);
+}
+
+void BSD::Send(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+
+    SendImpl(ctx, fd, flags, false);
 }
 
 void BSD::SendTo(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+    IPC::RequestParser rp{ctx};
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+
+    SendImpl(ctx, fd, flags, true);
+}
+
+void BSD::Accept(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    const bool is_nonblocking = (descriptor->flags & O_NONBLOCK) != 0;
+    ExecuteBlocking(
+        ctx, {{descriptor->socket->GetHandle(), Network::PollEvents::In}}, -1, is_nonblocking,
+        [this, fd](Kernel::HLERequestContext& ctx, bool is_final) {
+            FileDescriptor* const descriptor = GetFileDescriptor(fd);
+            if (descriptor == nullptr) {
+                WriteResponse(ctx, -1, Errno::BADF, 0);
+                return true;
+            }
+
+            const auto it = std::find_if(file_descriptors.begin(), file_descriptors.end(),
+                                         [](const auto& other) { return !other; });
+            if (it == file_descriptors.end()) {
+                WriteResponse(ctx, -1, Errno::MFILE, 0);
+                return true;
+            }
+
+            auto [result, error] = descriptor->socket->Accept();
+            if (error == Network::Errno::AGAIN && !is_final) {
+                return false;
+            }
+            if (error != Network::Errno::SUCCESS) {
+                WriteResponse(ctx, -1, Translate(error), 0);
+                return true;
+            }
+
+            // The accepted socket inherits the options of the listening one except its blocking
+            FileDescriptor& new_descriptor = it->emplace();
+            new_descriptor.socket = std::move(result.socket);
+            new_descriptor.type = descriptor->type;
+            new_descriptor.recv_timeout = descriptor->recv_timeout;
+            new_descriptor.send_timeout = descriptor->send_timeout;
+            new_descriptor.is_connection_based = descriptor->is_connection_based;
+
+            const u32 size = WriteAddress(ctx, 0, result.sockaddr_in);
+            WriteResponse(ctx, static_cast<s32>(it - file_descriptors.begin()), Errno::SUCCESS,
+                          size);
+            return true;
+        });
+}
+
+void BSD::Bind(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    const auto address = ReadAddress(ctx, 0);
+    if (!address) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+    WriteResponse(ctx, descriptor->socket->Bind(*address));
+}
+
+void BSD::Connect(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    const auto address = ReadAddress(ctx, 0);
+    if (!address) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+
+    const Network::Errno error = descriptor->socket->Connect(*address);
+    const bool is_nonblocking = (descriptor->flags & O_NONBLOCK) != 0;
+    if (error != Network::Errno::INPROGRESS || is_nonblocking) {
+        WriteResponse(ctx, error);
+        return;
+    }
+
+    // A blocking connection completes when the socket becomes writable, its result is the
+    // pending error of the socket
+    const auto complete = [this, fd](Kernel::HLERequestContext& ctx, bool is_final) {
+        FileDescriptor* const descriptor = GetFileDescriptor(fd);
+        if (descriptor == nullptr) {
+            WriteResponse(ctx, -1, Errno::BADF);
+            return true;
+        }
+        std::vector<Network::PollFD> poll_fd{
+            {descriptor->socket->GetHandle(), Network::PollEvents::Out, Network::PollEvents::None}};
+        Network::Poll(poll_fd, 0);
+        if (poll_fd[0].revents == Network::PollEvents::None) {
+            if (!is_final) {
+                return false;
+            }
+            WriteResponse(ctx, -1, Errno::TIMEDOUT);
+            return true;
+        }
+        const auto [pending_error, error] = descriptor->socket->GetPendingError();
+        WriteResponse(ctx, error != Network::Errno::SUCCESS ? error : pending_error);
+        return true;
+    };
+    ExecuteBlocking(ctx, {{descriptor->socket->GetHandle(), Network::PollEvents::Out}},
+                    descriptor->send_timeout, false, complete);
+}
+
+void BSD::GetPeerName(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+    const auto [address, error] = descriptor->socket->GetPeerName();
+    if (error != Network::Errno::SUCCESS) {
+        WriteResponse(ctx, -1, Translate(error), 0);
+        return;
+    }
+    WriteResponse(ctx, 0, Errno::SUCCESS, WriteAddress(ctx, 0, address));
+}
+
+void BSD::GetSockName(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+    const auto [address, error] = descriptor->socket->GetSockName();
+    if (error != Network::Errno::SUCCESS) {
+        WriteResponse(ctx, -1, Translate(error), 0);
+        return;
+    }
+    WriteResponse(ctx, 0, Errno::SUCCESS, WriteAddress(ctx, 0, address));
+}
+
+void BSD::GetSockOpt(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 level = rp.Pop<u32>();
+    const u32 optname = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} level=0x{:X} optname=0x{:X}", fd, level, optname);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    const auto write_value = [&ctx](const auto& value) {
+        const auto size = static_cast<u32>(ctx.WriteBuffer(&value, sizeof(value)));
+        WriteResponse(ctx, 0, Errno::SUCCESS, size);
+    };
+    const auto write_u32 = [&](const std::pair<u32, Network::Errno>& result) {
+        if (result.second != Network::Errno::SUCCESS) {
+            WriteResponse(ctx, -1, Translate(result.second), 0);
+            return;
+        }
+        write_value(result.first);
+    };
+
+    if (level == SOL_SOCKET) {
+        switch (optname) {
+        case SO_ERROR: {
+            const auto [pending_error, error] = descriptor->socket->GetPendingError();
+            write_u32({static_cast<u32>(Translate(pending_error)), error});
+            return;
+        }
+        case SO_TYPE:
+            write_value(descriptor->type);
+            return;
+        case SO_SNDBUF:
+            write_u32(descriptor->socket->GetSndBuf());
+            return;
+        case SO_RCVBUF:
+            write_u32(descriptor->socket->GetRcvBuf());
+            return;
+        case SO_SNDTIMEO:
+            write_value(NanosecondsToTimeVal(descriptor->send_timeout));
+            return;
+        case SO_RCVTIMEO:
+            write_value(NanosecondsToTimeVal(descriptor->recv_timeout));
+            return;
+        }
+    }
+
+    LOG_WARNING(Service, "Unimplemented option level=0x{:X} optname=0x{:X}", level, optname);
+    WriteResponse(ctx, -1, Errno::NOPROTOOPT, 0);
+}
+
+void BSD::Listen(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const s32 backlog = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={} backlog={}", fd, backlog);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    WriteResponse(ctx, descriptor->socket->Listen(backlog));
+}
+
+void BSD::Fcntl(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 cmd = rp.Pop<u32>();
+    const u32 arg = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} cmd={} arg=0x{:X}", fd, cmd, arg);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    // The host socket is always non-blocking, only the guest view of the flags changes
+    switch (cmd) {
+    case F_GETFL:
+        WriteResponse(ctx, static_cast<s32>(descriptor->flags), Errno::SUCCESS);
+        return;
+    case F_SETFL:
+        descriptor->flags = arg;
+        WriteResponse(ctx, 0, Errno::SUCCESS);
+        return;
+    default:
+        LOG_WARNING(Service, "Unimplemented command {}", cmd);
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+}
+
+void BSD::SetSockOpt(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const u32 level = rp.Pop<u32>();
+    const u32 optname = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} level=0x{:X} optname=0x{:X}", fd, level, optname);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    Network::Socket& socket = *descriptor->socket;
+
+    if (level == SOL_SOCKET && optname == SO_LINGER) {
+        const auto linger = ReadOption<Linger>(ctx);
+        if (!linger) {
+            WriteResponse(ctx, -1, Errno::INVAL);
+            return;
+        }
+        WriteResponse(ctx, socket.SetLinger(linger->onoff != 0, linger->linger));
+        return;
+    }
+    if (level == SOL_SOCKET && (optname == SO_SNDTIMEO || optname == SO_RCVTIMEO)) {
+        const auto timeval = ReadOption<TimeVal>(ctx);
+        if (!timeval) {
+            WriteResponse(ctx, -1, Errno::INVAL);
+            return;
+        }
+        s64& timeout =
+            optname == SO_SNDTIMEO ? descriptor->send_timeout : descriptor->recv_timeout;
+        timeout = TimeValToNanoseconds(*timeval);
+        WriteResponse(ctx, 0, Errno::SUCCESS);
+        return;
+    }
+
+    const auto value = ReadOption<u32>(ctx);
+    if (!value) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+    if (level == SOL_SOCKET) {
+        switch (optname) {
+        case SO_REUSEADDR:
+        case SO_REUSEPORT:
+            // Guests reuse ports to rebind them, the host address reuse covers that
+            WriteResponse(ctx, socket.SetReuseAddr(*value != 0));
+            return;
+        case SO_KEEPALIVE:
+            WriteResponse(ctx, socket.SetKeepAlive(*value != 0));
+            return;
+        case SO_BROADCAST:
+            WriteResponse(ctx, socket.SetBroadcast(*value != 0));
+            return;
+        case SO_SNDBUF:
+            WriteResponse(ctx, socket.SetSndBuf(*value));
+            return;
+        case SO_RCVBUF:
+            WriteResponse(ctx, socket.SetRcvBuf(*value));
+            return;
+        }
+    } else if (level == IPPROTO_TCP && optname == TCP_NODELAY) {
+        WriteResponse(ctx, socket.SetNoDelay(*value != 0));
+        return;
+    }
+
+    LOG_WARNING(Service, "Unimplemented option level=0x{:X} optname=0x{:X}", level, optname);
+    WriteResponse(ctx, -1, Errno::NOPROTOOPT);
+}
+
+void BSD::Shutdown(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+    const s32 how = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={} how={}", fd, how);
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    if (how < 0 || how > 2) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+    WriteResponse(ctx, descriptor->socket->Shutdown(static_cast<Network::ShutdownHow>(how)));
+}
+
+void BSD::Write(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    SendImpl(ctx, fd, 0, false);
+}
+
+void BSD::Read(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    RecvImpl(ctx, fd, 0, false);
 }
 
 void BSD::Close(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+    IPC::RequestParser rp{ctx};
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    const s32 fd = rp.Pop<s32>();
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    if (GetFileDescriptor(fd) == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    // Guest threads parked on the socket are woken up by the host reporting it as invalid
+    file_descriptors[fd].reset();
+    WriteResponse(ctx, 0, Errno::SUCCESS);
 }
 
-BSD::BSD(const char* name) : ServiceFramework(name) {
+void BSD::RecvImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address) {
+    const auto write_error = [with_address](Kernel::HLERequestContext& ctx, Errno bsd_errno) {
+        if (with_address) {
+            WriteResponse(ctx, -1, bsd_errno, 0);
+        } else {
+            WriteResponse(ctx, -1, bsd_errno);
+        }
+    };
+
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        write_error(ctx, Errno::BADF);
+        return;
+    }
+
+    const bool is_nonblocking =
+        (descriptor->flags & O_NONBLOCK) != 0 || (flags & MSG_DONTWAIT) != 0;
+    ExecuteBlocking(
+        ctx, {{descriptor->socket->GetHandle(), Network::PollEvents::In}},
+        descriptor->recv_timeout, is_nonblocking,
+        [this, fd, flags, with_address, write_error](Kernel::HLERequestContext& ctx,
+                                                      bool is_final) {
+            FileDescriptor* const descriptor = GetFileDescriptor(fd);
+            if (descriptor == nullptr) {
+                write_error(ctx, Errno::BADF);
+                return true;
+            }
+
+            const u32 host_flags = (flags & MSG_PEEK) != 0 ? Network::FLAG_MSG_PEEK : 0;
+            const auto message = ctx.WriteBufferSpan(0);
+            Network::SockAddrIn address;
+            const auto [ret, error] = descriptor->socket->RecvFrom(
+                host_flags, message.data(), message.size(), with_address ? &address : nullptr);
+            if (error == Network::Errno::AGAIN && !is_final) {
+                return false;
+            }
+            if (error != Network::Errno::SUCCESS) {
+                write_error(ctx, Translate(error));
+                return true;
+            }
+            if (!with_address) {
+                WriteResponse(ctx, ret, Errno::SUCCESS);
+                return true;
+            }
+
+            // Connected sockets don't report the peer
+            const u32 size =
+                descriptor->is_connection_based ? 0 : WriteAddress(ctx, 1, address);
+            WriteResponse(ctx, ret, Errno::SUCCESS, size);
+            return true;
+        });
+}
+
+void BSD::SendImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address) {
+    FileDescriptor* const descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    std::optional<Network::SockAddrIn> address;
+    if (with_address && ctx.GetReadBufferSize(1) != 0) {
+        address = ReadAddress(ctx, 1);
+        if (!address) {
+            WriteResponse(ctx, -1, Errno::INVAL);
+            return;
+        }
+    }
+
+    const bool is_nonblocking =
+        (descriptor->flags & O_NONBLOCK) != 0 || (flags & MSG_DONTWAIT) != 0;
+    ExecuteBlocking(
+        ctx, {{descriptor->socket->GetHandle(), Network::PollEvents::Out}},
+        descriptor->send_timeout, is_nonblocking,
+        [this, fd, address](Kernel::HLERequestContext& ctx, bool is_final) {
+            FileDescriptor* const descriptor = GetFileDescriptor(fd);
+            if (descriptor == nullptr) {
+                WriteResponse(ctx, -1, Errno::BADF);
+                return true;
+            }
+
+            const auto message = ctx.ReadBufferSpan(0);
+            const auto [ret, error] = descriptor->socket->SendTo(
+                0, message.data(), message.size(), address ? &*address : nullptr);
+            if (error == Network::Errno::AGAIN && !is_final) {
+                return false;
+            }
+            WriteResponse(ctx, ret, Translate(error));
+            return true;
+        });
+}
+
+void BSD::ExecuteBlocking(Kernel::HLERequestContext& ctx,
+                          std::vector<Network::Reactor::Interest> interests, s64 timeout,
+                          bool is_nonblocking, Attempt attempt) {
+    if (attempt(ctx, is_nonblocking)) {
+        return;
+    }
+
+    auto& system = Core::System::GetInstance();
+    const u64 wait_id = next_wait_id++;
+    const auto event = Kernel::WritableEvent::CreateEventPair(
+        system.Kernel(), Kernel::ResetType::Manual, "BSD:SocketWait");
+    pending_waits.emplace(wait_id, event.writable);
+
+    // The reactor thread can't signal kernel objects, it defers the signal to the core thread
+    u64 watch_id = 0;
+    if (!interests.empty()) {
+        watch_id = reactor->Watch(std::move(interests), [&core_timing = system.CoreTiming(),
+                                                         event_type = socket_ready_event,
+                                                         wait_id] {
+            core_timing.ScheduleEventThreadsafe(0, event_type, wait_id);
+        });
+    }
+
+    ctx.SleepClientThread(
+        "BSD::ExecuteBlocking", static_cast<u64>(timeout),
+        [this, wait_id, watch_id, attempt = std::move(attempt)](
+            Kernel::SharedPtr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+            Kernel::ThreadWakeupReason reason) {
+            if (watch_id != 0) {
+                reactor->Cancel(watch_id);
+            }
+            pending_waits.erase(wait_id);
+            attempt(ctx, true);
+        },
+        event.writable);
+}
+
+void BSD::OnSocketReady(u64 wait_id) {
+    const auto it = pending_waits.find(wait_id);
+    if (it != pending_waits.end()) {
+        it->second->Signal();
+    }
+}
+
+BSD::FileDescriptor* BSD::GetFileDescriptor(s32 fd) {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= MAX_FD || !file_descriptors[fd]) {
+        return nullptr;
+    }
+    return &*file_descriptors[fd];
+}
+
+BSD::BSD(const char* name, std::shared_ptr<Network::Reactor> reactor)
+    : ServiceFramework(name), reactor{std::move(reactor)} {
     // clang-format off
     static const FunctionInfo functions[] = {
         {0, &BSD::RegisterClient, "RegisterClient"},
@@ -81,26 +1051,26 @@ BSD::BSD(const char* name) : ServiceFramework(name) {
         {3, nullptr, "SocketExempt"},
         {4, nullptr, "Open"},
         {5, nullptr, "Select"},
-        {6, nullptr, "Poll"},
+        {6, &BSD::Poll, "Poll"},
         {7, nullptr, "Sysctl"},
-        {8, nullptr, "Recv"},
-        {9, nullptr, "RecvFrom"},
-        {10, nullptr, "Send"},
+        {8, &BSD::Recv, "Recv"},
+        {9, &BSD::RecvFrom, "RecvFrom"},
+        {10, &BSD::Send, "Send"},
         {11, &BSD::SendTo, "SendTo"},
-        {12, nullptr, "Accept"},
-        {13, nullptr, "Bind"},
+        {12, &BSD::Accept, "Accept"},
+        {13, &BSD::Bind, "Bind"},
         {14, &BSD::Connect, "Connect"},
-        {15, nullptr, "GetPeerName"},
-        {16, nullptr, "GetSockName"},
-        {17, nullptr, "GetSockOpt"},
-        {18, nullptr, "Listen"},
+        {15, &BSD::GetPeerName, "GetPeerName"},
+        {16, &BSD::GetSockName, "GetSockName"},
+        {17, &BSD::GetSockOpt, "GetSockOpt"},
+        {18, &BSD::Listen, "Listen"},
         {19, nullptr, "Ioctl"},
-        {20, nullptr, "Fcntl"},
-        {21, nullptr, "SetSockOpt"},
-        {22, nullptr, "Shutdown"},
+        {20, &BSD::Fcntl, "Fcntl"},
+        {21, &BSD::SetSockOpt, "SetSockOpt"},
+        {22, &BSD::Shutdown, "Shutdown"},
         {23, nullptr, "ShutdownAllSockets"},
-        {24, nullptr, "Write"},
-        {25, nullptr, "Read"},
+        {24, &BSD::Write, "Write"},
+        {25, &BSD::Read, "Read"},
         {26, &BSD::Close, "Close"},
         {27, nullptr, "DuplicateSocket"},
         {28, nullptr, "GetResourceStatistics"},
@@ -112,9 +1082,15 @@ BSD::BSD(const char* name) : ServiceFramework(name) {
     // clang-format on
 
     RegisterHandlers(functions);
+
+    socket_ready_event = Core::System::GetInstance().CoreTiming().RegisterEvent(
+        std::string("BSDSocketReady:") + name,
+        [this](u64 wait_id, s64) { OnSocketReady(wait_id); });
 }
 
-BSD::~BSD() = default;
+BSD::~BSD() {
+    Core::System::GetInstance().CoreTiming().RemoveNormalAndThreadsafeEvent(socket_ready_event);
+}
 
 BSDCFG::BSDCFG() : ServiceFramework{"bsdcfg"} {
     // clang-format off
@@ -4,26 +4,103 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/service/service.h"
+#include "core/network/network.h"
+#include "core/network/reactor.h"
+
+namespace Core::Timing {
+struct EventType;
+}
+
+namespace Kernel {
+class WritableEvent;
+}
 
 namespace Service::Sockets {
 
+/**
+ * BSD sockets backed by host sockets. The host sockets never block, an operation that would block
+ * a blocking guest socket parks the guest thread until the reactor reports the socket as ready,
+ * and runs again then.
+ */
 class BSD final : public ServiceFramework<BSD> {
 public:
-    explicit BSD(const char* name);
+    explicit BSD(const char* name, std::shared_ptr<Network::Reactor> reactor);
     ~BSD() override;
 
 private:
+    /// Maximum number of file descriptors
+    static constexpr std::size_t MAX_FD = 128;
+
+    struct FileDescriptor {
+        std::unique_ptr<Network::Socket> socket;
+        u32 type = 0;      ///< Guest socket type, returned by SO_TYPE
+        u32 flags = 0;     ///< Guest file status flags of fcntl
+        s64 recv_timeout = -1; ///< Timeout of blocking receptions in nanoseconds, -1 is infinite
+        s64 send_timeout = -1; ///< Timeout of blocking sends in nanoseconds, -1 is infinite
+        bool is_connection_based = false;
+    };
+
+    /**
+     * Attempt of an operation that may block. It writes the whole response and returns true, or
+     * returns false without writing anything if it would block. A final attempt must write the
+     * response, the guest socket is non-blocking or the guest thread already waited.
+     */
+    using Attempt = std::function<bool(Kernel::HLERequestContext& ctx, bool is_final)>;
+
+    /**
+     * Runs an attempt, parks the guest thread when it would block until one of the sockets is
+     * ready or the timeout in nanoseconds expires, and runs the final attempt then.
+     */
+    void ExecuteBlocking(Kernel::HLERequestContext& ctx,
+                         std::vector<Network::Reactor::Interest> interests, s64 timeout,
+                         bool is_nonblocking, Attempt attempt);
+
+    /// Wakes up the guest thread of a parked operation, runs on the emulated core thread
+    void OnSocketReady(u64 wait_id);
+
+    FileDescriptor* GetFileDescriptor(s32 fd);
+
     void RegisterClient(Kernel::HLERequestContext& ctx);
     void StartMonitoring(Kernel::HLERequestContext& ctx);
     void Socket(Kernel::HLERequestContext& ctx);
-    void Connect(Kernel::HLERequestContext& ctx);
+    void Poll(Kernel::HLERequestContext& ctx);
+    void Recv(Kernel::HLERequestContext& ctx);
+    void RecvFrom(Kernel::HLERequestContext& ctx);
+    void Send(Kernel::HLERequestContext& ctx);
     void SendTo(Kernel::HLERequestContext& ctx);
+    void Accept(Kernel::HLERequestContext& ctx);
+    void Bind(Kernel::HLERequestContext& ctx);
+    void Connect(Kernel::HLERequestContext& ctx);
+    void GetPeerName(Kernel::HLERequestContext& ctx);
+    void GetSockName(Kernel::HLERequestContext& ctx);
+    void GetSockOpt(Kernel::HLERequestContext& ctx);
+    void Listen(Kernel::HLERequestContext& ctx);
+    void Fcntl(Kernel::HLERequestContext& ctx);
+    void SetSockOpt(Kernel::HLERequestContext& ctx);
+    void Shutdown(Kernel::HLERequestContext& ctx);
+    void Write(Kernel::HLERequestContext& ctx);
+    void Read(Kernel::HLERequestContext& ctx);
     void Close(Kernel::HLERequestContext& ctx);
 
-    /// Id to use for the next open file descriptor.
-    u32 next_fd = 1;
+    void RecvImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address);
+    void SendImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address);
+
+    std::array<std::optional<FileDescriptor>, MAX_FD> file_descriptors;
+
+    std::shared_ptr<Network::Reactor> reactor;
+    Core::Timing::EventType* socket_ready_event = nullptr;
+
+    /// Events of the parked operations by wait id, only used by the emulated core thread
+    std::unordered_map<u64, Kernel::SharedPtr<Kernel::WritableEvent>> pending_waits;
+    u64 next_wait_id = 1;
 };
 
 class BSDCFG final : public ServiceFramework<BSDCFG> {
@@ -11,8 +11,10 @@
 namespace Service::Sockets {
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
-    std::make_shared<BSD>("bsd:s")->InstallAsService(service_manager);
-    std::make_shared<BSD>("bsd:u")->InstallAsService(service_manager);
+    // Both interfaces wait on the same reactor thread
+    auto reactor = std::make_shared<Network::Reactor>();
+    std::make_shared<BSD>("bsd:s", reactor)->InstallAsService(service_manager);
+    std::make_shared<BSD>("bsd:u", reactor)->InstallAsService(service_manager);
     std::make_shared<BSDCFG>()->InstallAsService(service_manager);
 
     std::make_shared<ETHC_C>()->InstallAsService(service_manager);
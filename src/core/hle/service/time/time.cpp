@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <random>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -11,12 +13,17 @@
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/service/time/interface.h"
 #include "core/hle/service/time/time.h"
+#include "core/hle/service/time/time_sharedmemory.h"
 #include "core/settings.h"
 
 namespace Service::Time {
 
+/// The system clocks are realigned on the host clock once per emulated second
+constexpr s64 clock_update_ticks = static_cast<s64>(Core::Timing::BASE_CLOCK_RATE);
+
 static std::chrono::seconds GetSecondsSinceEpoch() {
     return std::chrono::duration_cast<std::chrono::seconds>(
                std::chrono::system_clock::now().time_since_epoch()) +
@@ -63,7 +70,8 @@ static u64 CalendarToPosix(const CalendarTime& calendar_time,
 
 class ISystemClock final : public ServiceFramework<ISystemClock> {
 public:
-    ISystemClock() : ServiceFramework("ISystemClock") {
+    explicit ISystemClock(std::shared_ptr<Module> time)
+        : ServiceFramework("ISystemClock"), time(std::move(time)) {
         static const FunctionInfo functions[] = {
             {0, &ISystemClock::GetCurrentTime, "GetCurrentTime"},
             {1, nullptr, "SetCurrentTime"},
@@ -76,27 +84,31 @@ public:
 
 private:
     void GetCurrentTime(Kernel::HLERequestContext& ctx) {
-        const s64 time_since_epoch{GetSecondsSinceEpoch().count()};
         LOG_DEBUG(Service_Time, "called");
 
+        // Computed like the guest does from the shared memory, so both paths agree
+        const u64 time_since_epoch =
+            time->GetSystemClockContext().offset + time->GetSteadyClockTimePoint().value;
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
         rb.Push<u64>(time_since_epoch);
     }
 
     void GetSystemClockContext(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_Time, "(STUBBED) called");
+        LOG_DEBUG(Service_Time, "called");
 
-        SystemClockContext system_clock_ontext{};
         IPC::ResponseBuilder rb{ctx, (sizeof(SystemClockContext) / 4) + 2};
         rb.Push(RESULT_SUCCESS);
-        rb.PushRaw(system_clock_ontext);
+        rb.PushRaw(time->GetSystemClockContext());
     }
+
+    std::shared_ptr<Module> time;
 };
 
 class ISteadyClock final : public ServiceFramework<ISteadyClock> {
 public:
-    ISteadyClock() : ServiceFramework("ISteadyClock") {
+    explicit ISteadyClock(std::shared_ptr<Module> time)
+        : ServiceFramework("ISteadyClock"), time(std::move(time)) {
         static const FunctionInfo functions[] = {
             {0, &ISteadyClock::GetCurrentTimePoint, "GetCurrentTimePoint"},
         };
@@ -107,13 +119,12 @@ private:
     void GetCurrentTimePoint(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_Time, "called");
 
-        const auto& core_timing = Core::System::GetInstance().CoreTiming();
-        const SteadyClockTimePoint steady_clock_time_point{
-            Core::Timing::cyclesToMs(core_timing.GetTicks()) / 1000};
         IPC::ResponseBuilder rb{ctx, (sizeof(SteadyClockTimePoint) / 4) + 2};
         rb.Push(RESULT_SUCCESS);
-        rb.PushRaw(steady_clock_time_point);
+        rb.PushRaw(time->GetSteadyClockTimePoint());
     }
+
+    std::shared_ptr<Module> time;
 };
 
 class ITimeZoneService final : public ServiceFramework<ITimeZoneService> {
@@ -232,7 +243,7 @@ void Module::Interface::GetStandardUserSystemClock(Kernel::HLERequestContext& ct
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
 }
 
 void Module::Interface::GetStandardNetworkSystemClock(Kernel::HLERequestContext& ctx) {
@@ -240,7 +251,7 @@ void Module::Interface::GetStandardNetworkSystemClock(Kernel::HLERequestContext&
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
 }
 
 void Module::Interface::GetStandardSteadyClock(Kernel::HLERequestContext& ctx) {
@@ -248,7 +259,7 @@ void Module::Interface::GetStandardSteadyClock(Kernel::HLERequestContext& ctx) {
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISteadyClock>();
+    rb.PushIpcInterface<ISteadyClock>(time);
 }
 
 void Module::Interface::GetTimeZoneService(Kernel::HLERequestContext& ctx) {
@@ -264,7 +275,15 @@ void Module::Interface::GetStandardLocalSystemClock(Kernel::HLERequestContext& c
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
+}
+
+void Module::Interface::GetSharedMemoryNativeHandle(Kernel::HLERequestContext& ctx) {
+    LOG_DEBUG(Service_Time, "called");
+
+    IPC::ResponseBuilder rb{ctx, 2, 1};
+    rb.Push(RESULT_SUCCESS);
+    rb.PushCopyObjects(time->shared_memory->GetSharedMemoryHolder());
 }
 
 void Module::Interface::GetClockSnapshot(Kernel::HLERequestContext& ctx) {
@@ -273,9 +292,11 @@ void Module::Interface::GetClockSnapshot(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
     const auto initial_type = rp.PopRaw<u8>();
 
-    const s64 time_since_epoch{GetSecondsSinceEpoch().count()};
-    const std::time_t time(time_since_epoch);
-    const std::tm* tm = std::localtime(&time);
+    const SystemClockContext& system_clock_context = time->GetSystemClockContext();
+    const SteadyClockTimePoint steady_clock_time_point = time->GetSteadyClockTimePoint();
+    const s64 time_since_epoch = system_clock_context.offset + steady_clock_time_point.value;
+    const std::time_t posix_time(time_since_epoch);
+    const std::tm* tm = std::localtime(&posix_time);
     if (tm == nullptr) {
         LOG_ERROR(Service_Time, "tm is a nullptr");
         IPC::ResponseBuilder rb{ctx, 2};
@@ -283,10 +304,6 @@ void Module::Interface::GetClockSnapshot(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    const auto& core_timing = Core::System::GetInstance().CoreTiming();
-    const SteadyClockTimePoint steady_clock_time_point{
-        Core::Timing::cyclesToMs(core_timing.GetTicks()) / 1000, {}};
-
     CalendarTime calendar_time{};
     calendar_time.year = tm->tm_year + 1900;
     calendar_time.month = tm->tm_mon + 1;
@@ -296,6 +313,8 @@ void Module::Interface::GetClockSnapshot(Kernel::HLERequestContext& ctx) {
     calendar_time.second = tm->tm_sec;
 
     ClockSnapshot clock_snapshot{};
+    clock_snapshot.user_clock_context = system_clock_context;
+    clock_snapshot.network_clock_context = system_clock_context;
     clock_snapshot.system_posix_time = time_since_epoch;
     clock_snapshot.network_posix_time = time_since_epoch;
     clock_snapshot.system_calendar_time = calendar_time;
@@ -337,6 +356,53 @@ Module::Interface::Interface(std::shared_ptr<Module> time, const char* name)
 
 Module::Interface::~Interface() = default;
 
+Module::Module() {
+    // The source id tells the guest whether time points come from the same steady clock, a new
+    // one per boot matches the hardware resetting it
+    std::random_device device;
+    std::generate(clock_source_id.begin(), clock_source_id.end(),
+                  [&device] { return static_cast<u8>(device()); });
+
+    auto& system = Core::System::GetInstance();
+    shared_memory = std::make_unique<SharedMemory>(system.Kernel());
+    shared_memory->SetStandardSteadyClockContext({0, clock_source_id});
+    shared_memory->SetStandardUserSystemClockAutomaticCorrectionEnabled(true);
+    UpdateClocks();
+
+    auto& core_timing = system.CoreTiming();
+    clock_update_event =
+        core_timing.RegisterEvent("Time::UpdateClocks", [this](u64 userdata, s64 cycles_late) {
+            UpdateClocks();
+            Core::System::GetInstance().CoreTiming().ScheduleEvent(
+                clock_update_ticks - cycles_late, clock_update_event);
+        });
+    core_timing.ScheduleEvent(clock_update_ticks, clock_update_event);
+}
+
+Module::~Module() {
+    Core::System::GetInstance().CoreTiming().UnscheduleEvent(clock_update_event, 0);
+}
+
+SteadyClockTimePoint Module::GetSteadyClockTimePoint() const {
+    const auto& core_timing = Core::System::GetInstance().CoreTiming();
+    return {Core::Timing::cyclesToMs(core_timing.GetTicks()) / 1000, clock_source_id};
+}
+
+void Module::UpdateClocks() {
+    const SteadyClockTimePoint time_point = GetSteadyClockTimePoint();
+    const u64 offset = GetSecondsSinceEpoch().count() - time_point.value;
+
+    // The guest retries reads racing with a store, only changes are published
+    if (offset == system_clock_context.offset &&
+        system_clock_context.time_point.source_id == clock_source_id) {
+        return;
+    }
+    system_clock_context.offset = offset;
+    system_clock_context.time_point = time_point;
+    shared_memory->SetStandardLocalSystemClockContext(system_clock_context);
+    shared_memory->SetStandardNetworkSystemClockContext(system_clock_context);
+}
+
 void InstallInterfaces(SM::ServiceManager& service_manager) {
     auto time = std::make_shared<Module>();
     std::make_shared<Time>(time, "time:a")->InstallAsService(service_manager);
@@ -5,11 +5,18 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include "common/common_funcs.h"
 #include "core/hle/service/service.h"
 
+namespace Core::Timing {
+struct EventType;
+}
+
 namespace Service::Time {
 
+class SharedMemory;
+
 struct LocationName {
     std::array<u8, 0x24> name;
 };
@@ -48,6 +55,12 @@ struct SteadyClockTimePoint {
 };
 static_assert(sizeof(SteadyClockTimePoint) == 0x18, "SteadyClockTimePoint is incorrect size");
 
+struct SteadyClockContext {
+    u64_le internal_offset; ///< Nanoseconds added to the system tick
+    SteadyClockTimePoint::SourceID clock_source_id;
+};
+static_assert(sizeof(SteadyClockContext) == 0x18, "SteadyClockContext is incorrect size");
+
 struct SystemClockContext {
     u64_le offset;
     SteadyClockTimePoint time_point;
@@ -75,6 +88,9 @@ static_assert(sizeof(ClockSnapshot) == 0xd0, "ClockSnapshot is an invalid size")
 
 class Module final {
 public:
+    Module();
+    ~Module();
+
     class Interface : public ServiceFramework<Interface> {
     public:
         explicit Interface(std::shared_ptr<Module> time, const char* name);
@@ -85,12 +101,30 @@ public:
         void GetStandardSteadyClock(Kernel::HLERequestContext& ctx);
         void GetTimeZoneService(Kernel::HLERequestContext& ctx);
         void GetStandardLocalSystemClock(Kernel::HLERequestContext& ctx);
+        void GetSharedMemoryNativeHandle(Kernel::HLERequestContext& ctx);
         void GetClockSnapshot(Kernel::HLERequestContext& ctx);
         void CalculateStandardUserSystemClockDifferenceByUser(Kernel::HLERequestContext& ctx);
 
     protected:
         std::shared_ptr<Module> time;
     };
+
+    /// Returns the current time point of the standard steady clock
+    SteadyClockTimePoint GetSteadyClockTimePoint() const;
+
+    /// Returns the context of the standard system clocks, they follow the host clock
+    const SystemClockContext& GetSystemClockContext() const {
+        return system_clock_context;
+    }
+
+private:
+    /// Aligns the system clocks on the host clock and publishes them to the shared memory
+    void UpdateClocks();
+
+    std::unique_ptr<SharedMemory> shared_memory;
+    SteadyClockTimePoint::SourceID clock_source_id{};
+    SystemClockContext system_clock_context{};
+    Core::Timing::EventType* clock_update_event = nullptr;
 };
 
 /// Registers all Time services with the specified service manager.
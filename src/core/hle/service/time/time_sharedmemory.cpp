@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstring>
+#include "core/hle/kernel/shared_memory.h"
+#include "core/hle/service/time/time_sharedmemory.h"
+
+namespace Service::Time {
+
+namespace {
+constexpr std::size_t SHARED_MEMORY_SIZE = 0x1000;
+constexpr u32 FORMAT_VERSION = 0;
+} // Anonymous namespace
+
+SharedMemory::SharedMemory(Kernel::KernelCore& kernel) {
+    shared_memory_holder = Kernel::SharedMemory::Create(
+        kernel, nullptr, SHARED_MEMORY_SIZE, Kernel::MemoryPermission::ReadWrite,
+        Kernel::MemoryPermission::Read, 0, Kernel::MemoryRegion::BASE, "Time:SharedMemory");
+
+    std::memset(shared_memory_holder->GetPointer(), 0, SHARED_MEMORY_SIZE);
+    GetFormat().format_version = FORMAT_VERSION;
+}
+
+SharedMemory::~SharedMemory() = default;
+
+Kernel::SharedPtr<Kernel::SharedMemory> SharedMemory::GetSharedMemoryHolder() const {
+    return shared_memory_holder;
+}
+
+void SharedMemory::SetStandardSteadyClockContext(const SteadyClockContext& context) {
+    Store(GetFormat().standard_steady_clock_context, context);
+}
+
+void SharedMemory::SetStandardLocalSystemClockContext(const SystemClockContext& context) {
+    Store(GetFormat().standard_local_system_clock_context, context);
+}
+
+void SharedMemory::SetStandardNetworkSystemClockContext(const SystemClockContext& context) {
+    Store(GetFormat().standard_network_system_clock_context, context);
+}
+
+void SharedMemory::SetStandardUserSystemClockAutomaticCorrectionEnabled(bool is_enabled) {
+    Store(GetFormat().standard_user_system_clock_automatic_correction,
+          static_cast<u8>(is_enabled ? 1 : 0));
+}
+
+template <typename T>
+void SharedMemory::Store(LockFreeAtomicType<T>& atomic_type, const T& value) {
+    const u32 counter = atomic_type.counter + 1;
+    atomic_type.value[counter & 1] = value;
+    // The guest must not observe the new counter before the copy it selects
+    std::atomic_thread_fence(std::memory_order_release);
+    atomic_type.counter = counter;
+}
+
+SharedMemory::Format& SharedMemory::GetFormat() {
+    return *reinterpret_cast<Format*>(shared_memory_holder->GetPointer());
+}
+
+} // namespace Service::Time
@@ -0,0 +1,69 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/hle/kernel/object.h"
+#include "core/hle/service/time/time.h"
+
+namespace Kernel {
+class KernelCore;
+class SharedMemory;
+} // namespace Kernel
+
+namespace Service::Time {
+
+/**
+ * Time shared memory, the guest reads the clock contexts from it instead of calling the clock
+ * services. Each value is stored twice with a counter, the guest reads the copy selected by the
+ * counter and retries when the counter changed during the read.
+ */
+class SharedMemory final {
+public:
+    explicit SharedMemory(Kernel::KernelCore& kernel);
+    ~SharedMemory();
+
+    /// Returns the shared memory object the guest maps
+    Kernel::SharedPtr<Kernel::SharedMemory> GetSharedMemoryHolder() const;
+
+    void SetStandardSteadyClockContext(const SteadyClockContext& context);
+    void SetStandardLocalSystemClockContext(const SystemClockContext& context);
+    void SetStandardNetworkSystemClockContext(const SystemClockContext& context);
+    void SetStandardUserSystemClockAutomaticCorrectionEnabled(bool is_enabled);
+
+private:
+    template <typename T>
+    struct LockFreeAtomicType {
+        u32_le counter;
+        std::array<T, 2> value;
+    };
+
+    struct Format {
+        LockFreeAtomicType<SteadyClockContext> standard_steady_clock_context;
+        LockFreeAtomicType<SystemClockContext> standard_local_system_clock_context;
+        LockFreeAtomicType<SystemClockContext> standard_network_system_clock_context;
+        LockFreeAtomicType<u8> standard_user_system_clock_automatic_correction;
+        u32_le format_version;
+    };
+    static_assert(offsetof(Format, standard_local_system_clock_context) == 0x38,
+                  "Local system clock context has wrong offset");
+    static_assert(offsetof(Format, standard_network_system_clock_context) == 0x80,
+                  "Network system clock context has wrong offset");
+    static_assert(offsetof(Format, standard_user_system_clock_automatic_correction) == 0xC8,
+                  "Automatic correction has wrong offset");
+    static_assert(offsetof(Format, format_version) == 0xD0, "Format version has wrong offset");
+
+    /// Writes the copy the guest reads next, then publishes it with the counter
+    template <typename T>
+    static void Store(LockFreeAtomicType<T>& atomic_type, const T& value);
+
+    Format& GetFormat();
+
+    Kernel::SharedPtr<Kernel::SharedMemory> shared_memory_holder;
+};
+
+} // namespace Service::Time
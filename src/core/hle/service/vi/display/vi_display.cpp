@@ -7,7 +7,6 @@
 
 #include <fmt/format.h>
 
-#include "common/assert.h"
 #include "core/core.h"
 #include "core/hle/kernel/readable_event.h"
 #include "core/hle/service/vi/display/vi_display.h"
@@ -40,9 +39,6 @@ void Display::SignalVSyncEvent() {
 }
 
 void Display::CreateLayer(u64 id, NVFlinger::BufferQueue& buffer_queue) {
-    // TODO(Subv): Support more than 1 layer.
-    ASSERT_MSG(layers.empty(), "Only one layer is supported per display at the moment");
-
     layers.emplace_back(id, buffer_queue);
 }
 
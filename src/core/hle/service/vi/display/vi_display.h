@@ -50,6 +50,11 @@ public:
         return !layers.empty();
     }
 
+    /// Gets the number of layers of this display, in their composition order from the bottom up.
+    std::size_t GetNumLayers() const {
+        return layers.size();
+    }
+
     /// Gets a layer for this display based off an index.
     Layer& GetLayer(std::size_t index);
 
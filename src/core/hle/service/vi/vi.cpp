@@ -58,6 +58,14 @@ struct DisplayInfo {
 };
 static_assert(sizeof(DisplayInfo) == 0x60, "DisplayInfo has wrong size");
 
+struct ParcelHeader {
+    u32_le data_size;
+    u32_le data_offset;
+    u32_le objects_size;
+    u32_le objects_offset;
+};
+static_assert(sizeof(ParcelHeader) == 16, "ParcelHeader has wrong size");
+
 class Parcel {
 public:
     // This default size was chosen arbitrarily.
@@ -139,10 +147,10 @@ public:
     }
 
     void Deserialize() {
-        ASSERT(buffer.size() > sizeof(Header));
+        ASSERT(buffer.size() > sizeof(ParcelHeader));
 
-        Header header{};
-        std::memcpy(&header, buffer.data(), sizeof(Header));
+        ParcelHeader header{};
+        std::memcpy(&header, buffer.data(), sizeof(ParcelHeader));
 
         read_index = header.data_offset;
         DeserializeData();
@@ -150,16 +158,16 @@ public:
 
     std::vector<u8> Serialize() {
         ASSERT(read_index == 0);
-        write_index = sizeof(Header);
+        write_index = sizeof(ParcelHeader);
 
         SerializeData();
 
-        Header header{};
-        header.data_size = static_cast<u32_le>(write_index - sizeof(Header));
-        header.data_offset = sizeof(Header);
+        ParcelHeader header{};
+        header.data_size = static_cast<u32_le>(write_index - sizeof(ParcelHeader));
+        header.data_offset = sizeof(ParcelHeader);
         header.objects_size = 4;
-        header.objects_offset = sizeof(Header) + header.data_size;
-        std::memcpy(buffer.data(), &header, sizeof(Header));
+        header.objects_offset = sizeof(ParcelHeader) + header.data_size;
+        std::memcpy(buffer.data(), &header, sizeof(ParcelHeader));
 
         return buffer;
     }
@@ -170,19 +178,91 @@ protected:
     virtual void DeserializeData() {}
 
 private:
-    struct Header {
-        u32_le data_size;
-        u32_le data_offset;
-        u32_le objects_size;
-        u32_le objects_offset;
-    };
-    static_assert(sizeof(Header) == 16, "ParcelHeader has wrong size");
-
     std::vector<u8> buffer;
     std::size_t read_index = 0;
     std::size_t write_index = 0;
 };
 
+/**
+ * Reads a request parcel in place. Games dequeue, request and queue a buffer every frame, the
+ * parcels of those transactions are read with this instead of being copied to a Parcel, and their
+ * interface token is skipped instead of being decoded.
+ */
+class ParcelReader {
+public:
+    explicit ParcelReader(Kernel::BufferSpan<const u8> buffer) : buffer{buffer} {
+        ASSERT(buffer.size() > sizeof(ParcelHeader));
+
+        ParcelHeader header{};
+        std::memcpy(&header, buffer.data(), sizeof(ParcelHeader));
+        read_index = header.data_offset;
+
+        // The interface token is an unknown word and a length, followed by that many UTF-16
+        // characters and a terminator
+        Read<u32_le>();
+        const u32 token_length = Read<u32_le>();
+        read_index = Common::AlignUp(read_index + (token_length + 1) * sizeof(u16), 4);
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+        ASSERT(read_index + sizeof(T) <= buffer.size());
+
+        T val;
+        std::memcpy(&val, buffer.data() + read_index, sizeof(T));
+        read_index += sizeof(T);
+        read_index = Common::AlignUp(read_index, 4);
+        return val;
+    }
+
+private:
+    Kernel::BufferSpan<const u8> buffer;
+    std::size_t read_index = 0;
+};
+
+/// Writes a response parcel in place, the counterpart of ParcelReader
+class ParcelWriter {
+public:
+    explicit ParcelWriter(Kernel::BufferSpan<u8> buffer) : buffer{buffer} {}
+
+    template <typename T>
+    void Write(const T& val) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+        ASSERT_MSG(write_index + sizeof(T) <= buffer.size(), "Parcel doesn't fit in the buffer");
+
+        std::memcpy(buffer.data() + write_index, &val, sizeof(T));
+        write_index += sizeof(T);
+        write_index = Common::AlignUp(write_index, 4);
+    }
+
+    template <typename T>
+    void WriteObject(const T& val) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable.");
+
+        const u32_le size = static_cast<u32>(sizeof(val));
+        Write(size);
+        // TODO(Subv): Support file descriptors.
+        Write<u32_le>(0); // Fd count.
+        Write(val);
+    }
+
+    /// Writes the header and the empty object list after the data, like Parcel::Serialize
+    void Finish() {
+        ParcelHeader header{};
+        header.data_size = static_cast<u32_le>(write_index - sizeof(ParcelHeader));
+        header.data_offset = sizeof(ParcelHeader);
+        header.objects_size = 4;
+        header.objects_offset = sizeof(ParcelHeader) + header.data_size;
+        Write<u32_le>(0);
+        std::memcpy(buffer.data(), &header, sizeof(ParcelHeader));
+    }
+
+private:
+    Kernel::BufferSpan<u8> buffer;
+    std::size_t write_index = sizeof(ParcelHeader);
+};
+
 class NativeWindow : public Parcel {
 public:
     explicit NativeWindow(u32 id) {
@@ -305,28 +385,14 @@ protected:
     }
 };
 
-class IGBPDequeueBufferRequestParcel : public Parcel {
-public:
-    explicit IGBPDequeueBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
-        Deserialize();
-    }
-    ~IGBPDequeueBufferRequestParcel() override = default;
-
-    void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
-        data = Read<Data>();
-    }
-
-    struct Data {
-        u32_le pixel_format;
-        u32_le width;
-        u32_le height;
-        u32_le get_frame_timestamps;
-        u32_le usage;
-    };
-
-    Data data;
+struct IGBPDequeueBufferRequest {
+    u32_le pixel_format;
+    u32_le width;
+    u32_le height;
+    u32_le get_frame_timestamps;
+    u32_le usage;
 };
+static_assert(sizeof(IGBPDequeueBufferRequest) == 20, "IGBPDequeueBufferRequest has wrong size");
 
 struct BufferProducerFence {
     u32 is_valid;
@@ -334,128 +400,42 @@ struct BufferProducerFence {
 };
 static_assert(sizeof(BufferProducerFence) == 36, "BufferProducerFence has wrong size");
 
-class IGBPDequeueBufferResponseParcel : public Parcel {
-public:
-    explicit IGBPDequeueBufferResponseParcel(u32 slot) : slot(slot) {}
-    ~IGBPDequeueBufferResponseParcel() override = default;
-
-protected:
-    void SerializeData() override {
-        // TODO(Subv): Find out how this Fence is used.
-        BufferProducerFence fence = {};
-        fence.is_valid = 1;
-        for (auto& fence_ : fence.fences)
-            fence_.id = -1;
-
-        Write(slot);
-        Write<u32_le>(1);
-        WriteObject(fence);
-        Write<u32_le>(0);
-    }
-
-    u32_le slot;
-};
-
-class IGBPRequestBufferRequestParcel : public Parcel {
-public:
-    explicit IGBPRequestBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
-        Deserialize();
-    }
-    ~IGBPRequestBufferRequestParcel() override = default;
-
-    void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
-        slot = Read<u32_le>();
-    }
-
-    u32_le slot;
-};
-
-class IGBPRequestBufferResponseParcel : public Parcel {
-public:
-    explicit IGBPRequestBufferResponseParcel(NVFlinger::IGBPBuffer buffer) : buffer(buffer) {}
-    ~IGBPRequestBufferResponseParcel() override = default;
-
-protected:
-    void SerializeData() override {
-        // TODO(Subv): Figure out what this value means, writing non-zero here will make libnx
-        // try to read an IGBPBuffer object from the parcel.
-        Write<u32_le>(1);
-        WriteObject(buffer);
-        Write<u32_le>(0);
-    }
-
-    NVFlinger::IGBPBuffer buffer;
-};
-
-class IGBPQueueBufferRequestParcel : public Parcel {
-public:
-    explicit IGBPQueueBufferRequestParcel(std::vector<u8> buffer) : Parcel(std::move(buffer)) {
-        Deserialize();
-    }
-    ~IGBPQueueBufferRequestParcel() override = default;
-
-    void DeserializeData() override {
-        std::u16string token = ReadInterfaceToken();
-        data = Read<Data>();
-    }
-
+struct IGBPQueueBufferRequest {
     struct Fence {
         u32_le id;
         u32_le value;
     };
     static_assert(sizeof(Fence) == 8, "Fence has wrong size");
 
-    struct Data {
-        u32_le slot;
-        INSERT_PADDING_WORDS(3);
-        u32_le timestamp;
-        s32_le is_auto_timestamp;
-        s32_le crop_top;
-        s32_le crop_left;
-        s32_le crop_right;
-        s32_le crop_bottom;
-        s32_le scaling_mode;
-        NVFlinger::BufferQueue::BufferTransformFlags transform;
-        u32_le sticky_transform;
-        INSERT_PADDING_WORDS(2);
-        u32_le fence_is_valid;
-        std::array<Fence, 2> fences;
-
-        Common::Rectangle<int> GetCropRect() const {
-            return {crop_left, crop_top, crop_right, crop_bottom};
-        }
-    };
-    static_assert(sizeof(Data) == 80, "ParcelData has wrong size");
-
-    Data data;
-};
-
-class IGBPQueueBufferResponseParcel : public Parcel {
-public:
-    explicit IGBPQueueBufferResponseParcel(u32 width, u32 height) {
-        data.width = width;
-        data.height = height;
-    }
-    ~IGBPQueueBufferResponseParcel() override = default;
-
-protected:
-    void SerializeData() override {
-        Write(data);
+    u32_le slot;
+    INSERT_PADDING_WORDS(3);
+    u32_le timestamp;
+    s32_le is_auto_timestamp;
+    s32_le crop_top;
+    s32_le crop_left;
+    s32_le crop_right;
+    s32_le crop_bottom;
+    s32_le scaling_mode;
+    NVFlinger::BufferQueue::BufferTransformFlags transform;
+    u32_le sticky_transform;
+    INSERT_PADDING_WORDS(2);
+    u32_le fence_is_valid;
+    std::array<Fence, 2> fences;
+
+    Common::Rectangle<int> GetCropRect() const {
+        return {crop_left, crop_top, crop_right, crop_bottom};
     }
-
-private:
-    struct Data {
-        u32_le width;
-        u32_le height;
-        u32_le transform_hint;
-        u32_le num_pending_buffers;
-        u32_le status;
-    };
-    static_assert(sizeof(Data) == 20, "ParcelData has wrong size");
-
-    Data data{};
 };
+static_assert(sizeof(IGBPQueueBufferRequest) == 80, "IGBPQueueBufferRequest has wrong size");
+
+struct IGBPQueueBufferResponse {
+    u32_le width;
+    u32_le height;
+    u32_le transform_hint;
+    u32_le num_pending_buffers;
+    u32_le status;
+};
+static_assert(sizeof(IGBPQueueBufferResponse) == 20, "IGBPQueueBufferResponse has wrong size");
 
 class IGBPQueryRequestParcel : public Parcel {
 public:
@@ -530,11 +510,8 @@ private:
 
         if (transaction == TransactionId::Connect) {
             IGBPConnectRequestParcel request{ctx.ReadBuffer()};
-            IGBPConnectResponseParcel response{
-                static_cast<u32>(static_cast<u32>(DisplayResolution::UndockedWidth) *
-                                 Settings::values.resolution_factor),
-                static_cast<u32>(static_cast<u32>(DisplayResolution::UndockedHeight) *
-                                 Settings::values.resolution_factor)};
+            IGBPConnectResponseParcel response{static_cast<u32>(DisplayResolution::UndockedWidth),
+                                               static_cast<u32>(DisplayResolution::UndockedHeight)};
             ctx.WriteBuffer(response.Serialize());
         } else if (transaction == TransactionId::SetPreallocatedBuffer) {
             IGBPSetPreallocatedBufferRequestParcel request{ctx.ReadBuffer()};
@@ -544,15 +521,15 @@ private:
             IGBPSetPreallocatedBufferResponseParcel response{};
             ctx.WriteBuffer(response.Serialize());
         } else if (transaction == TransactionId::DequeueBuffer) {
-            IGBPDequeueBufferRequestParcel request{ctx.ReadBuffer()};
-            const u32 width{request.data.width};
-            const u32 height{request.data.height};
+            const auto request =
+                ParcelReader{ctx.ReadBufferSpan()}.Read<IGBPDequeueBufferRequest>();
+            const u32 width{request.width};
+            const u32 height{request.height};
             std::optional<u32> slot = buffer_queue.DequeueBuffer(width, height);
 
             if (slot) {
                 // Buffer is available
-                IGBPDequeueBufferResponseParcel response{*slot};
-                ctx.WriteBuffer(response.Serialize());
+                WriteDequeueBufferResponse(ctx, *slot);
             } else {
                 // Wait the current thread until a buffer becomes available
                 ctx.SleepClientThread(
@@ -564,28 +541,35 @@ private:
                         std::optional<u32> slot = buffer_queue.DequeueBuffer(width, height);
                         ASSERT_MSG(slot != std::nullopt, "Could not dequeue buffer.");
 
-                        IGBPDequeueBufferResponseParcel response{*slot};
-                        ctx.WriteBuffer(response.Serialize());
+                        WriteDequeueBufferResponse(ctx, *slot);
                         IPC::ResponseBuilder rb{ctx, 2};
                         rb.Push(RESULT_SUCCESS);
                     },
                     buffer_queue.GetWritableBufferWaitEvent());
             }
         } else if (transaction == TransactionId::RequestBuffer) {
-            IGBPRequestBufferRequestParcel request{ctx.ReadBuffer()};
-
-            auto& buffer = buffer_queue.RequestBuffer(request.slot);
-
-            IGBPRequestBufferResponseParcel response{buffer};
-            ctx.WriteBuffer(response.Serialize());
+            const u32 slot = ParcelReader{ctx.ReadBufferSpan()}.Read<u32_le>();
+            const auto& buffer = buffer_queue.RequestBuffer(slot);
+
+            // TODO(Subv): Figure out what this value means, writing non-zero here will make libnx
+            // try to read an IGBPBuffer object from the parcel.
+            ParcelWriter response{ctx.WriteBufferSpan()};
+            response.Write<u32_le>(1);
+            response.WriteObject(buffer);
+            response.Write<u32_le>(0);
+            response.Finish();
         } else if (transaction == TransactionId::QueueBuffer) {
-            IGBPQueueBufferRequestParcel request{ctx.ReadBuffer()};
+            const auto request = ParcelReader{ctx.ReadBufferSpan()}.Read<IGBPQueueBufferRequest>();
 
-            buffer_queue.QueueBuffer(request.data.slot, request.data.transform,
-                                     request.data.GetCropRect());
+            buffer_queue.QueueBuffer(request.slot, request.transform, request.GetCropRect());
+            nv_flinger->OnBufferQueued(id);
 
-            IGBPQueueBufferResponseParcel response{1280, 720};
-            ctx.WriteBuffer(response.Serialize());
+            IGBPQueueBufferResponse data{};
+            data.width = 1280;
+            data.height = 720;
+            ParcelWriter response{ctx.WriteBufferSpan()};
+            response.Write(data);
+            response.Finish();
         } else if (transaction == TransactionId::Query) {
             IGBPQueryRequestParcel request{ctx.ReadBuffer()};
 
@@ -610,6 +594,21 @@ private:
         rb.Push(RESULT_SUCCESS);
     }
 
+    static void WriteDequeueBufferResponse(Kernel::HLERequestContext& ctx, u32 slot) {
+        // TODO(Subv): Find out how this Fence is used.
+        BufferProducerFence fence = {};
+        fence.is_valid = 1;
+        for (auto& fence_ : fence.fences)
+            fence_.id = -1;
+
+        ParcelWriter response{ctx.WriteBufferSpan()};
+        response.Write<u32_le>(slot);
+        response.Write<u32_le>(1);
+        response.WriteObject(fence);
+        response.Write<u32_le>(0);
+        response.Finish();
+    }
+
     void AdjustRefcount(Kernel::HLERequestContext& ctx) {
         IPC::RequestParser rp{ctx};
         const u32 id = rp.Pop<u32>();
@@ -724,16 +723,13 @@ private:
         IPC::ResponseBuilder rb{ctx, 6};
         rb.Push(RESULT_SUCCESS);
 
+        // The resolution scale is applied by the renderer, the guest always sees the native size
         if (Settings::values.use_docked_mode) {
-            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::DockedWidth) *
-                    static_cast<u32>(Settings::values.resolution_factor));
-            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::DockedHeight) *
-                    static_cast<u32>(Settings::values.resolution_factor));
+            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::DockedWidth));
+            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::DockedHeight));
         } else {
-            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::UndockedWidth) *
-                    static_cast<u32>(Settings::values.resolution_factor));
-            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::UndockedHeight) *
-                    static_cast<u32>(Settings::values.resolution_factor));
+            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::UndockedWidth));
+            rb.Push(static_cast<u32>(Service::VI::DisplayResolution::UndockedHeight));
         }
 
         rb.PushRaw<float>(60.0f); // This wouldn't seem to be correct for 30 fps games.
@@ -1229,6 +1225,11 @@ void detail::GetDisplayServiceImpl(Kernel::HLERequestContext& ctx,
     rb.PushIpcInterface<IApplicationDisplayService>(std::move(nv_flinger));
 }
 
+std::shared_ptr<Kernel::SessionRequestHandler> detail::MakeHOSBinderDriver(
+    std::shared_ptr<NVFlinger::NVFlinger> nv_flinger) {
+    return std::make_shared<IHOSBinderDriver>(std::move(nv_flinger));
+}
+
 void InstallInterfaces(SM::ServiceManager& service_manager,
                        std::shared_ptr<NVFlinger::NVFlinger> nv_flinger) {
     std::make_shared<VI_M>(nv_flinger)->InstallAsService(service_manager);
@@ -9,6 +9,7 @@
 
 namespace Kernel {
 class HLERequestContext;
+class SessionRequestHandler;
 }
 
 namespace Service::NVFlinger {
@@ -45,6 +46,10 @@ enum class Policy {
 namespace detail {
 void GetDisplayServiceImpl(Kernel::HLERequestContext& ctx,
                            std::shared_ptr<NVFlinger::NVFlinger> nv_flinger, Permission permission);
+
+/// Creates an IHOSBinderDriver interface outside of a session, used by the tests
+std::shared_ptr<Kernel::SessionRequestHandler> MakeHOSBinderDriver(
+    std::shared_ptr<NVFlinger::NVFlinger> nv_flinger);
 } // namespace detail
 
 /// Registers all VI services with the specified service manager.
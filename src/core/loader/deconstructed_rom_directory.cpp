@@ -4,6 +4,7 @@
 
 #include <cinttypes>
 #include <cstring>
+#include <vector>
 #include "common/common_funcs.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
@@ -140,28 +141,44 @@ AppLoader_DeconstructedRomDirectory::LoadResult AppLoader_DeconstructedRomDirect
 
     const FileSys::PatchManager pm(metadata.GetTitleID());
 
-    // Load NSO modules
-    const VAddr base_address = process.VMManager().GetCodeRegionBaseAddress();
-    VAddr next_load_addr = base_address;
+    // Read all the NSO modules first, so that they are decompressed in parallel while the
+    // following ones are read
+    struct PendingModule {
+        const char* name;
+        FileSys::VirtualFile file;
+        NSOImage image;
+    };
+    std::vector<PendingModule> modules;
     for (const auto& module : {"rtld", "main", "subsdk0", "subsdk1", "subsdk2", "subsdk3",
                                "subsdk4", "subsdk5", "subsdk6", "subsdk7", "sdk"}) {
-        const FileSys::VirtualFile module_file = dir->GetFile(module);
+        FileSys::VirtualFile module_file = dir->GetFile(module);
         if (module_file == nullptr) {
             continue;
         }
 
-        const VAddr load_addr = next_load_addr;
         const bool should_pass_arguments = std::strcmp(module, "rtld") == 0;
-        const auto tentative_next_load_addr =
-            AppLoader_NSO::LoadModule(process, *module_file, load_addr, should_pass_arguments, pm);
+        auto image = AppLoader_NSO::ReadModule(*module_file, should_pass_arguments);
+        if (!image) {
+            return {ResultStatus::ErrorLoadingNSO, {}};
+        }
+        modules.push_back({module, std::move(module_file), std::move(*image)});
+    }
+
+    // Load NSO modules
+    const VAddr base_address = process.VMManager().GetCodeRegionBaseAddress();
+    VAddr next_load_addr = base_address;
+    for (auto& module : modules) {
+        const VAddr load_addr = next_load_addr;
+        const auto tentative_next_load_addr = AppLoader_NSO::LoadModule(
+            process, *module.file, std::move(module.image), load_addr, pm);
         if (!tentative_next_load_addr) {
             return {ResultStatus::ErrorLoadingNSO, {}};
         }
 
         next_load_addr = *tentative_next_load_addr;
-        LOG_DEBUG(Loader, "loaded module {} @ 0x{:X}", module, load_addr);
+        LOG_DEBUG(Loader, "loaded module {} @ 0x{:X}", module.name, load_addr);
         // Register module with GDBStub
-        GDBStub::RegisterModule(module, load_addr, next_load_addr - 1, false);
+        GDBStub::RegisterModule(module.name, load_addr, next_load_addr - 1, false);
     }
 
     // Find the RomFS by searching for a ".romfs" file in this directory
@@ -10,10 +10,12 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "core/core.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/romfs_factory.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/code_set.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/vm_manager.h"
@@ -129,26 +131,38 @@ static constexpr u32 PageAlignSize(u32 size) {
     return (size + Memory::PAGE_MASK) & ~Memory::PAGE_MASK;
 }
 
-static bool LoadNroImpl(Kernel::Process& process, const std::vector<u8>& data,
-                        const std::string& name, VAddr load_base) {
-    if (data.size() < sizeof(NroHeader)) {
-        return {};
-    }
-
-    // Read NSO header
+bool AppLoader_NRO::LoadNro(Kernel::Process& process, const FileSys::VfsFile& file,
+                            VAddr load_base) {
+    // Read NRO header
     NroHeader nro_header{};
-    std::memcpy(&nro_header, data.data(), sizeof(NroHeader));
-    if (nro_header.magic != Common::MakeMagic('N', 'R', 'O', '0')) {
+    if (file.ReadObject(&nro_header) != sizeof(NroHeader) ||
+        nro_header.magic != Common::MakeMagic('N', 'R', 'O', '0')) {
         return {};
     }
 
-    // Build program image
-    std::vector<u8> program_image(PageAlignSize(nro_header.file_size));
-    std::memcpy(program_image.data(), data.data(), program_image.size());
-    if (program_image.size() != PageAlignSize(nro_header.file_size)) {
-        return {};
+    // Default .bss to NRO header bss size if MOD0 section doesn't exist
+    u32 bss_size{PageAlignSize(nro_header.bss_size)};
+
+    // Read MOD header
+    ModHeader mod_header{};
+    file.ReadObject(&mod_header, nro_header.module_header_offset);
+
+    const bool has_mod_header{mod_header.magic == Common::MakeMagic('M', 'O', 'D', '0')};
+    if (has_mod_header) {
+        // Resize program image to include .bss section and page align each section
+        bss_size = PageAlignSize(mod_header.bss_end_offset - mod_header.bss_start_offset);
     }
 
+    // The file is read straight into the program image, which is allocated with its final size.
+    // Growing it would leave it with up to twice the capacity for as long as the module is loaded.
+    const auto arg_data = Settings::values.program_args;
+    const u32 arguments_size = arg_data.empty() ? 0 : NSO_ARGUMENT_DATA_ALLOCATION_SIZE;
+    std::vector<u8> program_image;
+    program_image.reserve(PageAlignSize(nro_header.file_size) + arguments_size + bss_size);
+    program_image.resize(PageAlignSize(nro_header.file_size));
+    file.Read(program_image.data(), nro_header.file_size);
+
+    // Build program image
     Kernel::CodeSet codeset;
     for (std::size_t i = 0; i < nro_header.segments.size(); ++i) {
         codeset.segments[i].addr = nro_header.segments[i].offset;
@@ -156,8 +170,7 @@ static bool LoadNroImpl(Kernel::Process& process, const std::vector<u8>& data,
         codeset.segments[i].size = PageAlignSize(nro_header.segments[i].size);
     }
 
-    if (!Settings::values.program_args.empty()) {
-        const auto arg_data = Settings::values.program_args;
+    if (!arg_data.empty()) {
         codeset.DataSegment().size += NSO_ARGUMENT_DATA_ALLOCATION_SIZE;
         NSOArgumentHeader args_header{
             NSO_ARGUMENT_DATA_ALLOCATION_SIZE, static_cast<u32_le>(arg_data.size()), {}};
@@ -169,38 +182,24 @@ static bool LoadNroImpl(Kernel::Process& process, const std::vector<u8>& data,
                     arg_data.size());
     }
 
-    // Default .bss to NRO header bss size if MOD0 section doesn't exist
-    u32 bss_size{PageAlignSize(nro_header.bss_size)};
-
-    // Read MOD header
-    ModHeader mod_header{};
-    std::memcpy(&mod_header, program_image.data() + nro_header.module_header_offset,
-                sizeof(ModHeader));
-
-    const bool has_mod_header{mod_header.magic == Common::MakeMagic('M', 'O', 'D', '0')};
-    if (has_mod_header) {
-        // Resize program image to include .bss section and page align each section
-        bss_size = PageAlignSize(mod_header.bss_end_offset - mod_header.bss_start_offset);
-    }
-
     codeset.DataSegment().size += bss_size;
     program_image.resize(static_cast<u32>(program_image.size()) + bss_size);
 
     // Load codeset for current process
+    const std::size_t image_size = program_image.size();
     codeset.memory = std::move(program_image);
     process.LoadModule(std::move(codeset), load_base);
 
+    if (auto* const profiler = process.GetSystem().GetGuestProfiler()) {
+        profiler->RegisterModule(process, file.GetName(), load_base, load_base + image_size);
+    }
+
     // Register module with GDBStub
-    GDBStub::RegisterModule(name, load_base, load_base);
+    GDBStub::RegisterModule(file.GetName(), load_base, load_base);
 
     return true;
 }
 
-bool AppLoader_NRO::LoadNro(Kernel::Process& process, const FileSys::VfsFile& file,
-                            VAddr load_base) {
-    return LoadNroImpl(process, file.ReadAllBytes(), file.GetName(), load_base);
-}
-
 AppLoader_NRO::LoadResult AppLoader_NRO::Load(Kernel::Process& process) {
     if (is_loaded) {
         return {ResultStatus::ErrorAlreadyLoaded, {}};
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cinttypes>
+#include <future>
 #include <vector>
 
 #include "common/common_funcs.h"
@@ -11,9 +12,12 @@
 #include "common/logging/log.h"
 #include "common/lz4_compression.h"
 #include "common/swap.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
+#include "core/hle/function_hooks.h"
 #include "core/hle/kernel/code_set.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/vm_manager.h"
@@ -34,17 +38,6 @@ struct MODHeader {
 };
 static_assert(sizeof(MODHeader) == 0x1c, "MODHeader has incorrect size.");
 
-std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
-                                  const NSOSegmentHeader& header) {
-    const std::vector<u8> uncompressed_data =
-        Common::Compression::DecompressDataLZ4(compressed_data, header.size);
-
-    ASSERT_MSG(uncompressed_data.size() == static_cast<int>(header.size), "{} != {}", header.size,
-               uncompressed_data.size());
-
-    return uncompressed_data;
-}
-
 constexpr u32 PageAlignSize(u32 size) {
     return (size + Memory::PAGE_MASK) & ~Memory::PAGE_MASK;
 }
@@ -70,15 +63,15 @@ FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& file) {
     return FileType::NSO;
 }
 
-std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
-                                               const FileSys::VfsFile& file, VAddr load_base,
-                                               bool should_pass_arguments,
-                                               std::optional<FileSys::PatchManager> pm) {
+std::optional<NSOImage> AppLoader_NSO::ReadModule(const FileSys::VfsFile& file,
+                                                   bool should_pass_arguments) {
     if (file.GetSize() < sizeof(NSOHeader)) {
         return {};
     }
 
-    NSOHeader nso_header{};
+    NSOImage image;
+    image.should_pass_arguments = should_pass_arguments;
+    auto& nso_header = image.header;
     if (sizeof(NSOHeader) != file.ReadObject(&nso_header)) {
         return {};
     }
@@ -87,20 +80,78 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
         return {};
     }
 
+    // The segments are laid out in order, the data segment ends the image until the arguments and
+    // .bss are appended. Room for them is reserved so that the image is not copied again.
+    const auto& data_segment = nso_header.segments[2];
+    const u64 segments_end = u64{data_segment.location} + data_segment.size;
+    for (const auto& segment : nso_header.segments) {
+        if (u64{segment.location} + segment.size > segments_end) {
+            LOG_ERROR(Loader, "Segment of {} is out of the bounds of the image", file.GetName());
+            return {};
+        }
+    }
+    const u64 arguments_size = should_pass_arguments ? NSO_ARGUMENT_DATA_ALLOCATION_SIZE : 0;
+    image.program_image.reserve(
+        PageAlignSize(static_cast<u32>(segments_end + arguments_size)) +
+        PageAlignSize(data_segment.bss_size));
+    image.program_image.resize(segments_end);
+
+    // The VFS is only read from this thread, the segments are decompressed while the next ones are
+    // read
+    for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
+        const auto& segment = nso_header.segments[i];
+        u8* const destination = image.program_image.data() + segment.location;
+        if (!nso_header.IsSegmentCompressed(i)) {
+            file.Read(destination, segment.size, segment.offset);
+            continue;
+        }
+
+        image.pending_segments.push_back(Common::ThreadPool::GetInstance().Submit(
+            [compressed = file.ReadBytes(nso_header.segments_compressed_size[i], segment.offset),
+             destination, size = segment.size] {
+                return Common::Compression::DecompressDataLZ4(compressed.data(), compressed.size(),
+                                                              destination, size);
+            },
+            Common::TaskPriority::High));
+    }
+
+    return image;
+}
+
+std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
+                                               const FileSys::VfsFile& file, VAddr load_base,
+                                               bool should_pass_arguments,
+                                               std::optional<FileSys::PatchManager> pm) {
+    auto image = ReadModule(file, should_pass_arguments);
+    if (!image) {
+        return {};
+    }
+    return LoadModule(process, file, std::move(*image), load_base, std::move(pm));
+}
+
+std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
+                                               const FileSys::VfsFile& file, NSOImage image,
+                                               VAddr load_base,
+                                               std::optional<FileSys::PatchManager> pm) {
+    bool decompressed = true;
+    for (auto& segment : image.pending_segments) {
+        decompressed &= segment.get();
+    }
+    if (!decompressed) {
+        LOG_ERROR(Loader, "Failed to decompress the segments of {}", file.GetName());
+        return {};
+    }
+
+    auto& nso_header = image.header;
+    auto& program_image = image.program_image;
+    const bool should_pass_arguments = image.should_pass_arguments;
+
     // Build program image
     Kernel::CodeSet codeset;
-    std::vector<u8> program_image;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data =
-            file.ReadBytes(nso_header.segments_compressed_size[i], nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
-        }
-        program_image.resize(nso_header.segments[i].location);
-        program_image.insert(program_image.end(), data.begin(), data.end());
         codeset.segments[i].addr = nso_header.segments[i].location;
         codeset.segments[i].offset = nso_header.segments[i].location;
-        codeset.segments[i].size = PageAlignSize(static_cast<u32>(data.size()));
+        codeset.segments[i].size = PageAlignSize(nso_header.segments[i].size);
     }
 
     if (should_pass_arguments && !Settings::values.program_args.empty()) {
@@ -142,11 +193,20 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
         pi_header.insert(pi_header.begin() + sizeof(NSOHeader), program_image.begin(),
                          program_image.end());
 
-        pi_header = pm->PatchNSO(pi_header, file.GetName());
+        pi_header = pm->PatchNSO(std::move(pi_header), file.GetName());
 
         std::copy(pi_header.begin() + sizeof(NSOHeader), pi_header.end(), program_image.begin());
     }
 
+    // Redirect the C library functions to the host after the patches, they may replace them
+    if (Settings::values.use_function_hooks) {
+        const std::size_t num_hooked = HLE::HookModuleFunctions(
+            program_image, codeset.CodeSegment().offset, codeset.CodeSegment().size);
+        if (num_hooked != 0) {
+            LOG_INFO(Loader, "Hooked {} functions of {}", num_hooked, file.GetName());
+        }
+    }
+
     // Apply cheats if they exist and the program has a valid title ID
     if (pm) {
         auto& system = Core::System::GetInstance();
@@ -161,6 +221,10 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
     codeset.memory = std::move(program_image);
     process.LoadModule(std::move(codeset), load_base);
 
+    if (auto* const profiler = process.GetSystem().GetGuestProfiler()) {
+        profiler->RegisterModule(process, file.GetName(), load_base, load_base + image_size);
+    }
+
     // Register module with GDBStub
     GDBStub::RegisterModule(file.GetName(), load_base, load_base);
 
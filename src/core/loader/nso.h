@@ -5,8 +5,10 @@
 #pragma once
 
 #include <array>
+#include <future>
 #include <optional>
 #include <type_traits>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/patch_manager.h"
@@ -64,6 +66,21 @@ struct NSOArgumentHeader {
 };
 static_assert(sizeof(NSOArgumentHeader) == 0x20, "NSOArgumentHeader has incorrect size.");
 
+/// An NSO whose segments are being decompressed, returned by AppLoader_NSO::ReadModule
+struct NSOImage {
+    NSOHeader header{};
+
+    /// The text, rodata and data segments at their locations, must not be resized while the
+    /// segments are pending
+    std::vector<u8> program_image;
+
+    /// Decompressions of the segments into the program image, declared after it so that they are
+    /// waited for before it is freed
+    std::vector<std::future<bool>> pending_segments;
+
+    bool should_pass_arguments = false;
+};
+
 /// Loads an NSO file
 class AppLoader_NSO final : public AppLoader {
 public:
@@ -80,6 +97,22 @@ public:
         return IdentifyType(file);
     }
 
+    /**
+     * Reads the segments of an NSO and decompresses them into its program image in the
+     * background. The reads of the modules loaded after it overlap with the decompression.
+     * @return The image of the NSO, or std::nullopt if the file is not a valid NSO
+     */
+    static std::optional<NSOImage> ReadModule(const FileSys::VfsFile& file,
+                                              bool should_pass_arguments);
+
+    /**
+     * Waits for the segments of an image read with ReadModule and maps it into the process.
+     * @return The end address of the module, or std::nullopt if it couldn't be loaded
+     */
+    static std::optional<VAddr> LoadModule(Kernel::Process& process, const FileSys::VfsFile& file,
+                                           NSOImage image, VAddr load_base,
+                                           std::optional<FileSys::PatchManager> pm = {});
+
     static std::optional<VAddr> LoadModule(Kernel::Process& process, const FileSys::VfsFile& file,
                                            VAddr load_base, bool should_pass_arguments,
                                            std::optional<FileSys::PatchManager> pm = {});
@@ -0,0 +1,131 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include "common/common_funcs.h"
+#include "common/swap.h"
+#include "core/loader/symbols.h"
+
+namespace Loader {
+
+namespace {
+
+constexpr u64 DT_NULL = 0;
+constexpr u64 DT_HASH = 4;
+constexpr u64 DT_STRTAB = 5;
+constexpr u64 DT_SYMTAB = 6;
+constexpr u64 DT_STRSZ = 10;
+constexpr u64 DT_SYMENT = 11;
+
+constexpr u8 STT_FUNC = 2;
+
+struct ELFDynamic {
+    u64_le tag;
+    u64_le value;
+};
+static_assert(sizeof(ELFDynamic) == 0x10, "ELFDynamic has incorrect size.");
+
+struct ELFSymbol {
+    u32_le name;
+    u8 info;
+    u8 other;
+    u16_le shndx;
+    u64_le value;
+    u64_le size;
+};
+static_assert(sizeof(ELFSymbol) == 0x18, "ELFSymbol has incorrect size.");
+
+template <typename T>
+std::optional<T> ReadObject(const u8* image, std::size_t size, u64 offset) {
+    if (offset > size || size - offset < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, image + offset, sizeof(T));
+    return value;
+}
+
+} // Anonymous namespace
+
+std::vector<ModuleSymbol> ReadModuleFunctions(const u8* image, std::size_t size) {
+    // The offset of the MOD0 header is stored right after the first instruction
+    const auto mod_offset = ReadObject<u32_le>(image, size, 4);
+    if (!mod_offset) {
+        return {};
+    }
+    const auto magic = ReadObject<u32_le>(image, size, *mod_offset);
+    const auto dynamic_offset = ReadObject<s32_le>(image, size, *mod_offset + 4);
+    if (!magic || *magic != Common::MakeMagic('M', 'O', 'D', '0') || !dynamic_offset) {
+        return {};
+    }
+
+    u64 hash_offset = 0;
+    u64 strtab_offset = 0;
+    u64 symtab_offset = 0;
+    u64 strtab_size = 0;
+    u64 symbol_size = 0;
+    const u64 first_dynamic = *mod_offset + static_cast<s64>(*dynamic_offset);
+    for (u64 offset = first_dynamic;; offset += sizeof(ELFDynamic)) {
+        const auto dynamic = ReadObject<ELFDynamic>(image, size, offset);
+        if (!dynamic || dynamic->tag == DT_NULL) {
+            break;
+        }
+        switch (dynamic->tag) {
+        case DT_HASH:
+            hash_offset = dynamic->value;
+            break;
+        case DT_STRTAB:
+            strtab_offset = dynamic->value;
+            break;
+        case DT_SYMTAB:
+            symtab_offset = dynamic->value;
+            break;
+        case DT_STRSZ:
+            strtab_size = dynamic->value;
+            break;
+        case DT_SYMENT:
+            symbol_size = dynamic->value;
+            break;
+        }
+    }
+    if (strtab_offset == 0 || symtab_offset == 0 || symbol_size < sizeof(ELFSymbol) ||
+        strtab_offset > size || size - strtab_offset < strtab_size) {
+        return {};
+    }
+
+    // The hash table has a chain per symbol, modules without one have the symbol table right
+    // before the string table
+    u64 num_symbols = 0;
+    if (hash_offset != 0) {
+        num_symbols = ReadObject<u32_le>(image, size, hash_offset + 4).value_or(0);
+    } else if (strtab_offset > symtab_offset) {
+        num_symbols = (strtab_offset - symtab_offset) / symbol_size;
+    }
+    const char* const strings = reinterpret_cast<const char*>(image + strtab_offset);
+
+    std::vector<ModuleSymbol> symbols;
+    for (u64 index = 0; index < num_symbols; ++index) {
+        const auto symbol =
+            ReadObject<ELFSymbol>(image, size, symtab_offset + index * symbol_size);
+        if (!symbol) {
+            break;
+        }
+        if ((symbol->info & 0xF) != STT_FUNC || symbol->shndx == 0 || symbol->value == 0 ||
+            symbol->name >= strtab_size) {
+            continue;
+        }
+        const char* const name = strings + symbol->name;
+        symbols.push_back({symbol->value, symbol->size,
+                           std::string(name, strnlen(name, strtab_size - symbol->name))});
+    }
+    std::sort(symbols.begin(), symbols.end(), [](const ModuleSymbol& lhs, const ModuleSymbol& rhs) {
+        return lhs.offset < rhs.offset;
+    });
+    return symbols;
+}
+
+} // namespace Loader
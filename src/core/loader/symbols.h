@@ -0,0 +1,28 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Loader {
+
+/// Function exported by the dynamic symbol table of a module
+struct ModuleSymbol {
+    u64 offset; ///< Offset of the function from the start of the module
+    u64 size;
+    std::string name;
+};
+
+/**
+ * Reads the functions in the dynamic symbol table of a loaded module image, found through its MOD0
+ * header. Offsets read from the image are bounds checked, it may come from guest memory.
+ * @returns The functions sorted by offset, empty when the module has no symbol table
+ */
+std::vector<ModuleSymbol> ReadModuleFunctions(const u8* image, std::size_t size);
+
+} // namespace Loader
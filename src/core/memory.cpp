@@ -6,6 +6,7 @@
 #include <cstring>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -25,13 +26,22 @@
 namespace Memory {
 
 static Common::PageTable* current_page_table = nullptr;
+/// System of the process whose page table is current, the GPU caches of its guest memory are
+/// notified through it instead of through the global instance
+static Core::System* current_system = nullptr;
 
 void SetCurrentPageTable(Kernel::Process& process) {
     current_page_table = &process.VMManager().page_table;
+    current_system = &process.GetSystem();
 
     const std::size_t address_space_width = process.VMManager().GetAddressSpaceWidth();
 
-    auto& system = Core::System::GetInstance();
+    // The CPU cores only exist while the system is powered on, tools that read guest memory without
+    // running it have no core to notify
+    auto& system = process.GetSystem();
+    if (!system.IsPoweredOn()) {
+        return;
+    }
     system.ArmInterface(0).PageTableChanged(*current_page_table, address_space_width);
     system.ArmInterface(1).PageTableChanged(*current_page_table, address_space_width);
     system.ArmInterface(2).PageTableChanged(*current_page_table, address_space_width);
@@ -57,9 +67,11 @@ static void MapPages(Common::PageTable& page_table, VAddr base, u64 size, u8* me
 
     if (memory == nullptr) {
         std::fill(page_table.pointers.begin() + base, page_table.pointers.begin() + end, memory);
+        std::fill(page_table.backing_addr.begin() + base, page_table.backing_addr.begin() + end, 0);
     } else {
         while (base != end) {
             page_table.pointers[base] = memory;
+            page_table.backing_addr[base] = reinterpret_cast<u64>(memory);
 
             base += 1;
             memory += PAGE_SIZE;
@@ -100,6 +112,18 @@ void AddDebugHook(Common::PageTable& page_table, VAddr base, u64 size,
     Common::SpecialRegion region{Common::SpecialRegion::Type::DebugHook, std::move(hook)};
     page_table.special_regions.add(
         std::make_pair(interval, std::set<Common::SpecialRegion>{region}));
+
+    // Only the hooked pages leave the fast path, the CPU accesses them through the callbacks that
+    // run the hooks before accessing the backing memory
+    const std::size_t last_page = (base + size - 1) >> PAGE_BITS;
+    for (std::size_t page = base >> PAGE_BITS; page <= last_page; ++page) {
+        Common::PageType& page_type = page_table.attributes[page];
+        if (page_type == Common::PageType::Memory ||
+            page_type == Common::PageType::RasterizerCachedMemory) {
+            page_type = Common::PageType::Special;
+            page_table.pointers[page] = nullptr;
+        }
+    }
 }
 
 void RemoveDebugHook(Common::PageTable& page_table, VAddr base, u64 size,
@@ -108,42 +132,177 @@ void RemoveDebugHook(Common::PageTable& page_table, VAddr base, u64 size,
     Common::SpecialRegion region{Common::SpecialRegion::Type::DebugHook, std::move(hook)};
     page_table.special_regions.subtract(
         std::make_pair(interval, std::set<Common::SpecialRegion>{region}));
+
+    const std::size_t last_page = (base + size - 1) >> PAGE_BITS;
+    for (std::size_t page = base >> PAGE_BITS; page <= last_page; ++page) {
+        if (page_table.attributes[page] != Common::PageType::Special ||
+            page_table.backing_addr[page] == 0) {
+            continue;
+        }
+        const VAddr page_addr = static_cast<VAddr>(page) << PAGE_BITS;
+        const auto page_interval =
+            boost::icl::discrete_interval<VAddr>::closed(page_addr, page_addr + PAGE_MASK);
+        const auto [begin, end] = page_table.special_regions.equal_range(page_interval);
+        if (begin != end) {
+            continue;
+        }
+        // Whether the rasterizer caches the page isn't known here, so it keeps notifying the GPU
+        // until the rasterizer uncaches it, which returns it to the fast path
+        page_table.attributes[page] = Common::PageType::RasterizerCachedMemory;
+    }
 }
 
 /**
- * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
- * using a VMA from the current process
+ * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned) using the
+ * host address recorded in the page table. Unlike the `pointers` entry, this address remains
+ * available while the page is marked as rasterizer cached, so the slow path can resolve accesses
+ * with a plain base + offset computation instead of walking the VMA map of the process.
  */
-static u8* GetPointerFromVMA(const Kernel::Process& process, VAddr vaddr) {
-    const auto& vm_manager = process.VMManager();
+static u8* GetPointerFromPageTable(const Common::PageTable& page_table, VAddr vaddr) {
+    const u64 backing_addr = page_table.backing_addr[vaddr >> PAGE_BITS];
+    if (backing_addr == 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<u8*>(backing_addr) + (vaddr & PAGE_MASK);
+}
 
-    const auto it = vm_manager.FindVMA(vaddr);
-    DEBUG_ASSERT(vm_manager.IsValidHandle(it));
+/// Range of pages that share their type and are contiguous in host memory
+struct PageRun {
+    Common::PageType type;
+    VAddr addr;
+    /// Host memory of the first byte, null when the pages are unmapped
+    u8* host_ptr;
+    std::size_t size;
+};
 
-    u8* direct_pointer = nullptr;
-    const auto& vma = it->second;
-    switch (vma.type) {
-    case Kernel::VMAType::AllocatedMemoryBlock:
-        direct_pointer = vma.backing_block->data() + vma.offset;
-        break;
-    case Kernel::VMAType::BackingMemory:
-        direct_pointer = vma.backing_memory;
-        break;
-    case Kernel::VMAType::Free:
-        return nullptr;
-    default:
-        UNREACHABLE();
+/**
+ * Returns the longest run of pages starting at the given address, so block operations can copy
+ * a whole run and notify the GPU of it at once instead of visiting every page.
+ * @param max_size Size of the block the run is part of, the run doesn't extend past it
+ */
+static PageRun GetPageRun(const Common::PageTable& page_table, VAddr addr,
+                          std::size_t max_size) {
+    const std::size_t first_page = addr >> PAGE_BITS;
+    const Common::PageType type = page_table.attributes[first_page];
+    const u64 backing_addr = page_table.backing_addr[first_page];
+
+    std::size_t size =
+        std::min(static_cast<std::size_t>(PAGE_SIZE - (addr & PAGE_MASK)), max_size);
+    for (std::size_t page = first_page + 1; size < max_size; ++page) {
+        if (page_table.attributes[page] != type) {
+            break;
+        }
+        // Unmapped pages have no backing, the contiguity check only applies to mapped ones
+        if (type != Common::PageType::Unmapped &&
+            page_table.backing_addr[page] != backing_addr + (page - first_page) * PAGE_SIZE) {
+            break;
+        }
+        size = std::min(size + static_cast<std::size_t>(PAGE_SIZE), max_size);
     }
 
-    return direct_pointer + (vaddr - vma.base);
+    // Unmapped pages and I/O regions have no backing memory
+    u8* const host_ptr =
+        backing_addr == 0 ? nullptr : reinterpret_cast<u8*>(backing_addr) + (addr & PAGE_MASK);
+    return {type, addr, host_ptr, size};
 }
 
 /**
  * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
- * using a VMA from the current process.
+ * using the page table of the current process.
  */
-static u8* GetPointerFromVMA(VAddr vaddr) {
-    return GetPointerFromVMA(*Core::CurrentProcess(), vaddr);
+static u8* GetPointerFromPageTable(VAddr vaddr) {
+    return GetPointerFromPageTable(*current_page_table, vaddr);
+}
+
+/**
+ * Calls func with the handler of every special region overlapping [vaddr, vaddr + size) until one
+ * of them returns true.
+ * @returns Whether a handler handled the access
+ */
+template <typename Func>
+static bool HandleSpecialRegions(const Common::PageTable& page_table, VAddr vaddr,
+                                 std::size_t size, Func&& func) {
+    const auto interval = boost::icl::discrete_interval<VAddr>::closed(vaddr, vaddr + size - 1);
+    const auto [begin, end] = page_table.special_regions.equal_range(interval);
+    for (auto it = begin; it != end; ++it) {
+        for (const Common::SpecialRegion& region : it->second) {
+            if (func(*region.handler)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename T>
+static std::optional<T> ReadFromHook(Common::MemoryHook& hook, VAddr vaddr) {
+    if constexpr (sizeof(T) == 1) {
+        if (const auto value = hook.Read8(vaddr)) {
+            return static_cast<T>(*value);
+        }
+    } else if constexpr (sizeof(T) == 2) {
+        if (const auto value = hook.Read16(vaddr)) {
+            return static_cast<T>(*value);
+        }
+    } else if constexpr (sizeof(T) == 4) {
+        if (const auto value = hook.Read32(vaddr)) {
+            return static_cast<T>(*value);
+        }
+    } else {
+        if (const auto value = hook.Read64(vaddr)) {
+            return static_cast<T>(*value);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+static bool WriteToHook(Common::MemoryHook& hook, VAddr vaddr, T data) {
+    if constexpr (sizeof(T) == 1) {
+        return hook.Write8(vaddr, static_cast<u8>(data));
+    } else if constexpr (sizeof(T) == 2) {
+        return hook.Write16(vaddr, static_cast<u16>(data));
+    } else if constexpr (sizeof(T) == 4) {
+        return hook.Write32(vaddr, static_cast<u32>(data));
+    } else {
+        return hook.Write64(vaddr, static_cast<u64>(data));
+    }
+}
+
+/// Reads a run of special pages through their hooks, or from their backing memory
+static void ReadSpecialBlock(const Kernel::Process& process, const PageRun& run, u8* dest_ptr) {
+    const auto& page_table = process.VMManager().page_table;
+    if (HandleSpecialRegions(page_table, run.addr, run.size, [&](Common::MemoryHook& hook) {
+            return hook.ReadBlock(run.addr, dest_ptr, run.size);
+        })) {
+        return;
+    }
+    if (run.host_ptr == nullptr) {
+        LOG_ERROR(HW_Memory, "Unhandled special ReadBlock @ 0x{:016X} (size = {})", run.addr,
+                  run.size);
+        std::memset(dest_ptr, 0, run.size);
+        return;
+    }
+    process.GetSystem().GPU().FlushRegion(ToCacheAddr(run.host_ptr), run.size);
+    std::memcpy(dest_ptr, run.host_ptr, run.size);
+}
+
+/// Writes a run of special pages through their hooks, or to their backing memory
+static void WriteSpecialBlock(const Kernel::Process& process, const PageRun& run,
+                              const u8* src_ptr) {
+    const auto& page_table = process.VMManager().page_table;
+    if (HandleSpecialRegions(page_table, run.addr, run.size, [&](Common::MemoryHook& hook) {
+            return hook.WriteBlock(run.addr, src_ptr, run.size);
+        })) {
+        return;
+    }
+    if (run.host_ptr == nullptr) {
+        LOG_ERROR(HW_Memory, "Unhandled special WriteBlock @ 0x{:016X} (size = {})", run.addr,
+                  run.size);
+        return;
+    }
+    std::memcpy(run.host_ptr, src_ptr, run.size);
+    process.GetSystem().GPU().DeferInvalidateRegion(ToCacheAddr(run.host_ptr), run.size);
 }
 
 template <typename T>
@@ -165,12 +324,31 @@ T Read(const VAddr vaddr) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:016X}", vaddr);
         break;
     case Common::PageType::RasterizerCachedMemory: {
-        auto host_ptr{GetPointerFromVMA(vaddr)};
-        Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(host_ptr), sizeof(T));
+        auto host_ptr{GetPointerFromPageTable(vaddr)};
+        current_system->GPU().FlushRegion(ToCacheAddr(host_ptr), sizeof(T));
         T value;
         std::memcpy(&value, host_ptr, sizeof(T));
         return value;
     }
+    case Common::PageType::Special: {
+        std::optional<T> value;
+        HandleSpecialRegions(*current_page_table, vaddr, sizeof(T), [&](Common::MemoryHook& hook) {
+            value = ReadFromHook<T>(hook, vaddr);
+            return value.has_value();
+        });
+        if (value) {
+            return *value;
+        }
+        auto host_ptr{GetPointerFromPageTable(vaddr)};
+        if (host_ptr == nullptr) {
+            LOG_ERROR(HW_Memory, "Unhandled special Read{} @ 0x{:016X}", sizeof(T) * 8, vaddr);
+            return 0;
+        }
+        current_system->GPU().FlushRegion(ToCacheAddr(host_ptr), sizeof(T));
+        T result;
+        std::memcpy(&result, host_ptr, sizeof(T));
+        return result;
+    }
     default:
         UNREACHABLE();
     }
@@ -196,9 +374,26 @@ void Write(const VAddr vaddr, const T data) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:016X}", vaddr);
         break;
     case Common::PageType::RasterizerCachedMemory: {
-        auto host_ptr{GetPointerFromVMA(vaddr)};
-        Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(host_ptr), sizeof(T));
+        auto host_ptr{GetPointerFromPageTable(vaddr)};
+        std::memcpy(host_ptr, &data, sizeof(T));
+        current_system->GPU().DeferInvalidateRegion(ToCacheAddr(host_ptr), sizeof(T));
+        break;
+    }
+    case Common::PageType::Special: {
+        if (HandleSpecialRegions(*current_page_table, vaddr, sizeof(T),
+                                 [&](Common::MemoryHook& hook) {
+                                     return WriteToHook<T>(hook, vaddr, data);
+                                 })) {
+            break;
+        }
+        auto host_ptr{GetPointerFromPageTable(vaddr)};
+        if (host_ptr == nullptr) {
+            LOG_ERROR(HW_Memory, "Unhandled special Write{} @ 0x{:016X}", sizeof(data) * 8,
+                      vaddr);
+            break;
+        }
         std::memcpy(host_ptr, &data, sizeof(T));
+        current_system->GPU().DeferInvalidateRegion(ToCacheAddr(host_ptr), sizeof(T));
         break;
     }
     default:
@@ -216,14 +411,15 @@ bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     if (page_table.attributes[vaddr >> PAGE_BITS] == Common::PageType::RasterizerCachedMemory)
         return true;
 
-    if (page_table.attributes[vaddr >> PAGE_BITS] != Common::PageType::Special)
-        return false;
+    // Pages watched by debug hooks keep their backing memory, I/O regions have none
+    if (page_table.attributes[vaddr >> PAGE_BITS] == Common::PageType::Special)
+        return page_table.backing_addr[vaddr >> PAGE_BITS] != 0;
 
     return false;
 }
 
 bool IsValidVirtualAddress(const VAddr vaddr) {
-    return IsValidVirtualAddress(*Core::CurrentProcess(), vaddr);
+    return IsValidVirtualAddress(*current_system->CurrentProcess(), vaddr);
 }
 
 bool IsKernelVirtualAddress(const VAddr vaddr) {
@@ -238,13 +434,44 @@ u8* GetPointer(const VAddr vaddr) {
 
     if (current_page_table->attributes[vaddr >> PAGE_BITS] ==
         Common::PageType::RasterizerCachedMemory) {
-        return GetPointerFromVMA(vaddr);
+        return GetPointerFromPageTable(vaddr);
+    }
+
+    // Accesses through the pointer bypass the debug hooks of the page
+    if (current_page_table->attributes[vaddr >> PAGE_BITS] == Common::PageType::Special) {
+        if (u8* const pointer = GetPointerFromPageTable(vaddr)) {
+            return pointer;
+        }
     }
 
     LOG_ERROR(HW_Memory, "Unknown GetPointer @ 0x{:016X}", vaddr);
     return nullptr;
 }
 
+u8* GetContiguousPointer(const Kernel::Process& process, const VAddr vaddr,
+                         const std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    const auto& page_table = process.VMManager().page_table;
+    const std::size_t first_page = vaddr >> PAGE_BITS;
+    const std::size_t last_page = (vaddr + size - 1) >> PAGE_BITS;
+    if (last_page < first_page || last_page >= page_table.pointers.size()) {
+        return nullptr;
+    }
+
+    u8* const base = page_table.pointers[first_page];
+    for (std::size_t page = first_page; page <= last_page; ++page) {
+        if (page_table.attributes[page] != Common::PageType::Memory) {
+            return nullptr;
+        }
+        if (page_table.pointers[page] != base + ((page - first_page) << PAGE_BITS)) {
+            return nullptr;
+        }
+    }
+    return base + (vaddr & PAGE_MASK);
+}
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -288,6 +515,9 @@ void RasterizerMarkRegionCached(VAddr vaddr, u64 size, bool cached) {
                 // There can be more than one GPU region mapped per CPU region, so it's common that
                 // this area is already marked as cached.
                 break;
+            case Common::PageType::Special:
+                // Special pages notify the GPU from the slow path whether they are cached or not
+                break;
             default:
                 UNREACHABLE();
             }
@@ -303,11 +533,11 @@ void RasterizerMarkRegionCached(VAddr vaddr, u64 size, bool cached) {
                 // this area is already unmarked as cached.
                 break;
             case Common::PageType::RasterizerCachedMemory: {
-                u8* pointer = GetPointerFromVMA(vaddr & ~PAGE_MASK);
+                u8* pointer = GetPointerFromPageTable(vaddr & ~PAGE_MASK);
                 if (pointer == nullptr) {
                     // It's possible that this function has been called while updating the pagetable
-                    // after unmapping a VMA. In that case the underlying VMA will no longer exist,
-                    // and we should just leave the pagetable entry blank.
+                    // after unmapping a VMA. In that case the page will no longer have a backing
+                    // address, and we should just leave the pagetable entry blank.
                     page_type = Common::PageType::Unmapped;
                 } else {
                     page_type = Common::PageType::Memory;
@@ -315,6 +545,8 @@ void RasterizerMarkRegionCached(VAddr vaddr, u64 size, bool cached) {
                 }
                 break;
             }
+            case Common::PageType::Special:
+                break;
             default:
                 UNREACHABLE();
             }
@@ -342,49 +574,42 @@ void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_
                const std::size_t size) {
     const auto& page_table = process.VMManager().page_table;
 
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
+    std::size_t offset = 0;
+    while (offset < size) {
+        const PageRun run = GetPageRun(page_table, src_addr + offset, size - offset);
+        u8* const dest_ptr = static_cast<u8*>(dest_buffer) + offset;
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped ReadBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
+                      run.addr, src_addr, size);
+            std::memset(dest_ptr, 0, run.size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            std::memcpy(dest_ptr, run.host_ptr, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memcpy(dest_buffer, host_ptr, copy_amount);
+            process.GetSystem().GPU().FlushRegion(ToCacheAddr(run.host_ptr), run.size);
+            std::memcpy(dest_ptr, run.host_ptr, run.size);
+            break;
+        }
+        case Common::PageType::Special: {
+            ReadSpecialBlock(process, run, dest_ptr);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        offset += run.size;
     }
 }
 
 void ReadBlock(const VAddr src_addr, void* dest_buffer, const std::size_t size) {
-    ReadBlock(*Core::CurrentProcess(), src_addr, dest_buffer, size);
+    ReadBlock(*current_system->CurrentProcess(), src_addr, dest_buffer, size);
 }
 
 void Write8(const VAddr addr, const u8 data) {
@@ -406,137 +631,121 @@ void Write64(const VAddr addr, const u64 data) {
 void WriteBlock(const Kernel::Process& process, const VAddr dest_addr, const void* src_buffer,
                 const std::size_t size) {
     const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+    std::size_t offset = 0;
+    while (offset < size) {
+        const PageRun run = GetPageRun(page_table, dest_addr + offset, size - offset);
+        const u8* const src_ptr = static_cast<const u8*>(src_buffer) + offset;
 
-        switch (page_table.attributes[page_index]) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped WriteBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      run.addr, dest_addr, size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
+            std::memcpy(run.host_ptr, src_ptr, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memcpy(host_ptr, src_buffer, copy_amount);
+            std::memcpy(run.host_ptr, src_ptr, run.size);
+            process.GetSystem().GPU().DeferInvalidateRegion(ToCacheAddr(run.host_ptr), run.size);
+            break;
+        }
+        case Common::PageType::Special: {
+            WriteSpecialBlock(process, run, src_ptr);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        offset += run.size;
     }
 }
 
 void WriteBlock(const VAddr dest_addr, const void* src_buffer, const std::size_t size) {
-    WriteBlock(*Core::CurrentProcess(), dest_addr, src_buffer, size);
+    WriteBlock(*current_system->CurrentProcess(), dest_addr, src_buffer, size);
 }
 
 void ZeroBlock(const Kernel::Process& process, const VAddr dest_addr, const std::size_t size) {
     const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+    std::size_t offset = 0;
+    while (offset < size) {
+        const PageRun run = GetPageRun(page_table, dest_addr + offset, size - offset);
 
-        switch (page_table.attributes[page_index]) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped ZeroBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      run.addr, dest_addr, size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
+            std::memset(run.host_ptr, 0, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().InvalidateRegion(ToCacheAddr(host_ptr), copy_amount);
-            std::memset(host_ptr, 0, copy_amount);
+            std::memset(run.host_ptr, 0, run.size);
+            process.GetSystem().GPU().DeferInvalidateRegion(ToCacheAddr(run.host_ptr), run.size);
+            break;
+        }
+        case Common::PageType::Special: {
+            const std::vector<u8> zeros(run.size);
+            WriteSpecialBlock(process, run, zeros.data());
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
+        offset += run.size;
     }
 }
 
 void CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
                const std::size_t size) {
     const auto& page_table = process.VMManager().page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
 
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+    std::size_t offset = 0;
+    while (offset < size) {
+        const PageRun run = GetPageRun(page_table, src_addr + offset, size - offset);
 
-        switch (page_table.attributes[page_index]) {
+        switch (run.type) {
         case Common::PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "Unmapped CopyBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(process, dest_addr, copy_amount);
+                      run.addr, src_addr, size);
+            ZeroBlock(process, dest_addr + offset, run.size);
             break;
         }
         case Common::PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            WriteBlock(process, dest_addr, src_ptr, copy_amount);
+            WriteBlock(process, dest_addr + offset, run.host_ptr, run.size);
             break;
         }
         case Common::PageType::RasterizerCachedMemory: {
-            const auto& host_ptr{GetPointerFromVMA(process, current_vaddr)};
-            Core::System::GetInstance().GPU().FlushRegion(ToCacheAddr(host_ptr), copy_amount);
-            WriteBlock(process, dest_addr, host_ptr, copy_amount);
+            process.GetSystem().GPU().FlushRegion(ToCacheAddr(run.host_ptr), run.size);
+            WriteBlock(process, dest_addr + offset, run.host_ptr, run.size);
+            break;
+        }
+        case Common::PageType::Special: {
+            std::vector<u8> buffer(run.size);
+            ReadSpecialBlock(process, run, buffer.data());
+            WriteBlock(process, dest_addr + offset, buffer.data(), run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
+        offset += run.size;
     }
 }
 
 void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size) {
-    CopyBlock(*Core::CurrentProcess(), dest_addr, src_addr, size);
+    CopyBlock(*current_system->CurrentProcess(), dest_addr, src_addr, size);
 }
 
 } // namespace Memory
@@ -66,10 +66,20 @@ void WriteBlock(const Kernel::Process& process, VAddr dest_addr, const void* src
                 std::size_t size);
 void WriteBlock(VAddr dest_addr, const void* src_buffer, std::size_t size);
 void ZeroBlock(const Kernel::Process& process, VAddr dest_addr, std::size_t size);
+void CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
+               std::size_t size);
 void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size);
 
 u8* GetPointer(VAddr vaddr);
 
+/**
+ * Gets a host pointer to a whole guest range, so it can be accessed without copying it out.
+ * @returns Null when the range is empty, crosses pages that are not regular memory (including
+ *          rasterizer cached pages, which need a flush or invalidation on access), is outside
+ *          of the address space or when its pages are not contiguous on the host.
+ */
+u8* GetContiguousPointer(const Kernel::Process& process, VAddr vaddr, std::size_t size);
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length);
 
 /**
@@ -0,0 +1,550 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/network/network.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Network {
+
+namespace {
+
+#ifdef _WIN32
+
+using socklen_t = int;
+
+void CloseSocket(SocketHandle handle) {
+    closesocket(static_cast<SOCKET>(handle));
+}
+
+bool SetNonBlock(SocketHandle handle) {
+    u_long mode = 1;
+    return ioctlsocket(static_cast<SOCKET>(handle), FIONBIO, &mode) == 0;
+}
+
+int GetLastHostError() {
+    return WSAGetLastError();
+}
+
+Errno TranslateError(int error) {
+    switch (error) {
+    case WSAEBADF:
+    case WSAENOTSOCK:
+        return Errno::BADF;
+    case WSAEINVAL:
+        return Errno::INVAL;
+    case WSAEMFILE:
+        return Errno::MFILE;
+    case WSAEWOULDBLOCK:
+        return Errno::AGAIN;
+    case WSAEINPROGRESS:
+        return Errno::INPROGRESS;
+    case WSAEALREADY:
+        return Errno::ALREADY;
+    case WSAEISCONN:
+        return Errno::ISCONN;
+    case WSAENOTCONN:
+        return Errno::NOTCONN;
+    case WSAECONNREFUSED:
+        return Errno::CONNREFUSED;
+    case WSAECONNRESET:
+        return Errno::CONNRESET;
+    case WSAECONNABORTED:
+        return Errno::CONNABORTED;
+    case WSAETIMEDOUT:
+        return Errno::TIMEDOUT;
+    case WSAENETUNREACH:
+        return Errno::NETUNREACH;
+    case WSAEHOSTUNREACH:
+        return Errno::HOSTUNREACH;
+    case WSAEADDRINUSE:
+        return Errno::ADDRINUSE;
+    case WSAEADDRNOTAVAIL:
+        return Errno::ADDRNOTAVAIL;
+    case WSAEMSGSIZE:
+        return Errno::MSGSIZE;
+    case WSAESHUTDOWN:
+        return Errno::PIPE;
+    case WSAENOBUFS:
+        return Errno::NOBUFS;
+    case WSAEAFNOSUPPORT:
+        return Errno::AFNOSUPPORT;
+    case WSAEOPNOTSUPP:
+        return Errno::OPNOTSUPP;
+    default:
+        return Errno::OTHER;
+    }
+}
+
+constexpr int SHUT_RD = SD_RECEIVE;
+constexpr int SHUT_WR = SD_SEND;
+constexpr int SHUT_RDWR = SD_BOTH;
+
+constexpr int SEND_FLAGS = 0;
+
+#else
+
+void CloseSocket(SocketHandle handle) {
+    close(handle);
+}
+
+bool SetNonBlock(SocketHandle handle) {
+    const int flags = fcntl(handle, F_GETFL, 0);
+    return flags != -1 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+int GetLastHostError() {
+    return errno;
+}
+
+Errno TranslateError(int error) {
+    switch (error) {
+    case EBADF:
+    case ENOTSOCK:
+        return Errno::BADF;
+    case EINVAL:
+        return Errno::INVAL;
+    case EMFILE:
+    case ENFILE:
+        return Errno::MFILE;
+    case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+    case EWOULDBLOCK:
+#endif
+        return Errno::AGAIN;
+    case EINPROGRESS:
+        return Errno::INPROGRESS;
+    case EALREADY:
+        return Errno::ALREADY;
+    case EISCONN:
+        return Errno::ISCONN;
+    case ENOTCONN:
+        return Errno::NOTCONN;
+    case ECONNREFUSED:
+        return Errno::CONNREFUSED;
+    case ECONNRESET:
+        return Errno::CONNRESET;
+    case ECONNABORTED:
+        return Errno::CONNABORTED;
+    case ETIMEDOUT:
+        return Errno::TIMEDOUT;
+    case ENETUNREACH:
+        return Errno::NETUNREACH;
+    case EHOSTUNREACH:
+        return Errno::HOSTUNREACH;
+    case EADDRINUSE:
+        return Errno::ADDRINUSE;
+    case EADDRNOTAVAIL:
+        return Errno::ADDRNOTAVAIL;
+    case EMSGSIZE:
+        return Errno::MSGSIZE;
+    case EPIPE:
+        return Errno::PIPE;
+    case ENOBUFS:
+    case ENOMEM:
+        return Errno::NOBUFS;
+    case EAFNOSUPPORT:
+        return Errno::AFNOSUPPORT;
+    case EOPNOTSUPP:
+        return Errno::OPNOTSUPP;
+    default:
+        return Errno::OTHER;
+    }
+}
+
+// A peer closing the connection must fail the send instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+#endif
+
+/// Returns the error of the last failed call, errors other than AGAIN are logged
+Errno GetAndLogLastError() {
+    const int error = GetLastHostError();
+    const Errno translated = TranslateError(error);
+    if (translated != Errno::AGAIN) {
+        LOG_ERROR(Network, "Socket operation failed with host error {}", error);
+    }
+    return translated;
+}
+
+sockaddr TranslateFromSockAddrIn(const SockAddrIn& input) {
+    sockaddr_in result{};
+    result.sin_family = AF_INET;
+    result.sin_port = htons(input.portno);
+    std::memcpy(&result.sin_addr, input.ip.data(), sizeof(input.ip));
+
+    sockaddr addr;
+    std::memcpy(&addr, &result, sizeof(result));
+    return addr;
+}
+
+SockAddrIn TranslateToSockAddrIn(const sockaddr& input) {
+    sockaddr_in input_in;
+    std::memcpy(&input_in, &input, sizeof(input_in));
+
+    SockAddrIn result;
+    std::memcpy(result.ip.data(), &input_in.sin_addr, sizeof(result.ip));
+    result.portno = ntohs(input_in.sin_port);
+    return result;
+}
+
+short TranslatePollEvents(PollEvents events) {
+    short result = 0;
+    if ((events & PollEvents::In) != PollEvents::None) {
+        result |= POLLIN;
+    }
+    if ((events & PollEvents::Pri) != PollEvents::None) {
+#ifdef _WIN32
+        // WSAPoll rejects POLLPRI, out of band data is reported as readable
+        result |= POLLIN;
+#else
+        result |= POLLPRI;
+#endif
+    }
+    if ((events & PollEvents::Out) != PollEvents::None) {
+        result |= POLLOUT;
+    }
+    return result;
+}
+
+PollEvents TranslatePollRevents(short revents) {
+    PollEvents result = PollEvents::None;
+    const auto translate = [&](short host, PollEvents guest) {
+        if ((revents & host) != 0) {
+            result |= guest;
+        }
+    };
+    translate(POLLIN, PollEvents::In);
+    translate(POLLPRI, PollEvents::Pri);
+    translate(POLLOUT, PollEvents::Out);
+    translate(POLLERR, PollEvents::Err);
+    translate(POLLHUP, PollEvents::Hup);
+    translate(POLLNVAL, PollEvents::Nval);
+    return result;
+}
+
+template <typename T>
+Errno SetSockOpt(SocketHandle handle, int level, int option, T value) {
+    const int result = setsockopt(handle, level, option, reinterpret_cast<const char*>(&value),
+                                  static_cast<socklen_t>(sizeof(value)));
+    return result == 0 ? Errno::SUCCESS : GetAndLogLastError();
+}
+
+template <typename T>
+std::pair<T, Errno> GetSockOpt(SocketHandle handle, int level, int option) {
+    T value{};
+    socklen_t length = static_cast<socklen_t>(sizeof(value));
+    if (getsockopt(handle, level, option, reinterpret_cast<char*>(&value), &length) != 0) {
+        return {T{}, GetAndLogLastError()};
+    }
+    return {value, Errno::SUCCESS};
+}
+
+int ClampSize(std::size_t size) {
+    return static_cast<int>(std::min<std::size_t>(size, std::numeric_limits<int>::max()));
+}
+
+} // Anonymous namespace
+
+NetworkInstance::NetworkInstance() {
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        LOG_CRITICAL(Network, "WSAStartup failed with {}", WSAGetLastError());
+    }
+#endif
+}
+
+NetworkInstance::~NetworkInstance() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+Socket::~Socket() {
+    Close();
+}
+
+Errno Socket::Initialize(Domain domain, Type type, Protocol protocol) {
+    ASSERT(domain == Domain::INET);
+
+    int host_type = SOCK_STREAM;
+    switch (type) {
+    case Type::STREAM:
+        host_type = SOCK_STREAM;
+        break;
+    case Type::DGRAM:
+        host_type = SOCK_DGRAM;
+        break;
+    case Type::RAW:
+        host_type = SOCK_RAW;
+        break;
+    }
+
+    int host_protocol = 0;
+    switch (protocol) {
+    case Protocol::UNSPECIFIED:
+        host_protocol = 0;
+        break;
+    case Protocol::ICMP:
+        host_protocol = IPPROTO_ICMP;
+        break;
+    case Protocol::TCP:
+        host_protocol = IPPROTO_TCP;
+        break;
+    case Protocol::UDP:
+        host_protocol = IPPROTO_UDP;
+        break;
+    }
+
+    const auto new_handle = static_cast<SocketHandle>(socket(AF_INET, host_type, host_protocol));
+    if (new_handle == InvalidSocketHandle) {
+        return GetAndLogLastError();
+    }
+    if (!SetNonBlock(new_handle)) {
+        const Errno error = GetAndLogLastError();
+        CloseSocket(new_handle);
+        return error;
+    }
+#ifdef SO_NOSIGPIPE
+    SetSockOpt<int>(new_handle, SOL_SOCKET, SO_NOSIGPIPE, 1);
+#endif
+    Close();
+    handle = new_handle;
+    return Errno::SUCCESS;
+}
+
+Errno Socket::Close() {
+    if (!IsOpen()) {
+        return Errno::BADF;
+    }
+    CloseSocket(handle);
+    handle = InvalidSocketHandle;
+    return Errno::SUCCESS;
+}
+
+std::pair<Socket::AcceptResult, Errno> Socket::Accept() {
+    sockaddr addr;
+    socklen_t addrlen = sizeof(addr);
+    const auto new_handle = static_cast<SocketHandle>(accept(handle, &addr, &addrlen));
+    if (new_handle == InvalidSocketHandle) {
+        return {AcceptResult{}, GetAndLogLastError()};
+    }
+
+    // Accepted sockets don't inherit the non-blocking mode on every host
+    if (!SetNonBlock(new_handle)) {
+        const Errno error = GetAndLogLastError();
+        CloseSocket(new_handle);
+        return {AcceptResult{}, error};
+    }
+
+    AcceptResult result;
+    result.socket = std::unique_ptr<Socket>(new Socket(new_handle));
+    result.sockaddr_in = TranslateToSockAddrIn(addr);
+    return {std::move(result), Errno::SUCCESS};
+}
+
+Errno Socket::Connect(const SockAddrIn& addr_in) {
+    const sockaddr addr = TranslateFromSockAddrIn(addr_in);
+    if (connect(handle, &addr, sizeof(addr)) == 0) {
+        return Errno::SUCCESS;
+    }
+    const int host_error = GetLastHostError();
+    const Errno error = TranslateError(host_error);
+    // Non-blocking connections complete later, Windows reports them as would-block
+    if (error == Errno::INPROGRESS || error == Errno::AGAIN) {
+        return Errno::INPROGRESS;
+    }
+    LOG_ERROR(Network, "Connection failed with host error {}", host_error);
+    return error;
+}
+
+std::pair<SockAddrIn, Errno> Socket::GetPeerName() const {
+    sockaddr addr;
+    socklen_t addrlen = sizeof(addr);
+    if (getpeername(handle, &addr, &addrlen) != 0) {
+        return {SockAddrIn{}, GetAndLogLastError()};
+    }
+    return {TranslateToSockAddrIn(addr), Errno::SUCCESS};
+}
+
+std::pair<SockAddrIn, Errno> Socket::GetSockName() const {
+    sockaddr addr;
+    socklen_t addrlen = sizeof(addr);
+    if (getsockname(handle, &addr, &addrlen) != 0) {
+        return {SockAddrIn{}, GetAndLogLastError()};
+    }
+    return {TranslateToSockAddrIn(addr), Errno::SUCCESS};
+}
+
+Errno Socket::Bind(const SockAddrIn& addr_in) {
+    const sockaddr addr = TranslateFromSockAddrIn(addr_in);
+    if (bind(handle, &addr, sizeof(addr)) != 0) {
+        return GetAndLogLastError();
+    }
+    return Errno::SUCCESS;
+}
+
+Errno Socket::Listen(s32 backlog) {
+    if (listen(handle, backlog) != 0) {
+        return GetAndLogLastError();
+    }
+    return Errno::SUCCESS;
+}
+
+Errno Socket::Shutdown(ShutdownHow how) {
+    int host_how = SHUT_RDWR;
+    switch (how) {
+    case ShutdownHow::RD:
+        host_how = SHUT_RD;
+        break;
+    case ShutdownHow::WR:
+        host_how = SHUT_WR;
+        break;
+    case ShutdownHow::RDWR:
+        host_how = SHUT_RDWR;
+        break;
+    }
+    if (shutdown(handle, host_how) != 0) {
+        return GetAndLogLastError();
+    }
+    return Errno::SUCCESS;
+}
+
+std::pair<s32, Errno> Socket::Recv(u32 flags, u8* data, std::size_t size) {
+    return RecvFrom(flags, data, size, nullptr);
+}
+
+std::pair<s32, Errno> Socket::RecvFrom(u32 flags, u8* data, std::size_t size, SockAddrIn* addr) {
+    const int host_flags = (flags & FLAG_MSG_PEEK) != 0 ? MSG_PEEK : 0;
+    sockaddr addr_from{};
+    socklen_t addrlen = sizeof(addr_from);
+    const auto result = recvfrom(handle, reinterpret_cast<char*>(data), ClampSize(size), host_flags,
+                                 addr ? &addr_from : nullptr, addr ? &addrlen : nullptr);
+    if (result < 0) {
+        return {-1, GetAndLogLastError()};
+    }
+    if (addr) {
+        *addr = TranslateToSockAddrIn(addr_from);
+    }
+    return {static_cast<s32>(result), Errno::SUCCESS};
+}
+
+std::pair<s32, Errno> Socket::Send(u32 flags, const u8* data, std::size_t size) {
+    return SendTo(flags, data, size, nullptr);
+}
+
+std::pair<s32, Errno> Socket::SendTo(u32 flags, const u8* data, std::size_t size,
+                                     const SockAddrIn* addr) {
+    // Peeking only applies to receptions, there are no other flags
+    sockaddr addr_to{};
+    if (addr) {
+        addr_to = TranslateFromSockAddrIn(*addr);
+    }
+    const auto result =
+        sendto(handle, reinterpret_cast<const char*>(data), ClampSize(size), SEND_FLAGS,
+               addr ? &addr_to : nullptr, addr ? static_cast<socklen_t>(sizeof(addr_to)) : 0);
+    if (result < 0) {
+        return {-1, GetAndLogLastError()};
+    }
+    return {static_cast<s32>(result), Errno::SUCCESS};
+}
+
+Errno Socket::SetLinger(bool enable, u32 linger) {
+    ::linger value{};
+    value.l_onoff = enable ? 1 : 0;
+    value.l_linger = static_cast<decltype(value.l_linger)>(linger);
+    return SetSockOpt(handle, SOL_SOCKET, SO_LINGER, value);
+}
+
+Errno Socket::SetReuseAddr(bool enable) {
+    return SetSockOpt<int>(handle, SOL_SOCKET, SO_REUSEADDR, enable ? 1 : 0);
+}
+
+Errno Socket::SetBroadcast(bool enable) {
+    return SetSockOpt<int>(handle, SOL_SOCKET, SO_BROADCAST, enable ? 1 : 0);
+}
+
+Errno Socket::SetKeepAlive(bool enable) {
+    return SetSockOpt<int>(handle, SOL_SOCKET, SO_KEEPALIVE, enable ? 1 : 0);
+}
+
+Errno Socket::SetNoDelay(bool enable) {
+    return SetSockOpt<int>(handle, IPPROTO_TCP, TCP_NODELAY, enable ? 1 : 0);
+}
+
+Errno Socket::SetSndBuf(u32 value) {
+    return SetSockOpt<int>(handle, SOL_SOCKET, SO_SNDBUF, static_cast<int>(value));
+}
+
+Errno Socket::SetRcvBuf(u32 value) {
+    return SetSockOpt<int>(handle, SOL_SOCKET, SO_RCVBUF, static_cast<int>(value));
+}
+
+std::pair<u32, Errno> Socket::GetSndBuf() const {
+    const auto [value, error] = GetSockOpt<int>(handle, SOL_SOCKET, SO_SNDBUF);
+    return {static_cast<u32>(value), error};
+}
+
+std::pair<u32, Errno> Socket::GetRcvBuf() const {
+    const auto [value, error] = GetSockOpt<int>(handle, SOL_SOCKET, SO_RCVBUF);
+    return {static_cast<u32>(value), error};
+}
+
+std::pair<Errno, Errno> Socket::GetPendingError() {
+    const auto [value, error] = GetSockOpt<int>(handle, SOL_SOCKET, SO_ERROR);
+    if (error != Errno::SUCCESS) {
+        return {Errno::SUCCESS, error};
+    }
+    return {value == 0 ? Errno::SUCCESS : TranslateError(value), Errno::SUCCESS};
+}
+
+std::pair<s32, Errno> Poll(std::vector<PollFD>& poll_fds, s32 timeout) {
+    std::vector<pollfd> host_poll_fds(poll_fds.size());
+    for (std::size_t i = 0; i < poll_fds.size(); ++i) {
+        auto& host_poll_fd = host_poll_fds[i];
+        host_poll_fd.fd = static_cast<decltype(host_poll_fd.fd)>(poll_fds[i].handle);
+        host_poll_fd.events = TranslatePollEvents(poll_fds[i].events);
+        host_poll_fd.revents = 0;
+    }
+
+#ifdef _WIN32
+    const int result = WSAPoll(host_poll_fds.data(), static_cast<ULONG>(host_poll_fds.size()),
+                               timeout);
+#else
+    const int result = poll(host_poll_fds.data(), host_poll_fds.size(), timeout);
+#endif
+    if (result < 0) {
+        return {-1, GetAndLogLastError()};
+    }
+
+    for (std::size_t i = 0; i < poll_fds.size(); ++i) {
+        poll_fds[i].revents = TranslatePollRevents(host_poll_fds[i].revents);
+    }
+    return {result, Errno::SUCCESS};
+}
+
+} // namespace Network
@@ -0,0 +1,214 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Network {
+
+#ifdef _WIN32
+using SocketHandle = std::uintptr_t;
+constexpr SocketHandle InvalidSocketHandle = ~SocketHandle{0};
+#else
+using SocketHandle = int;
+constexpr SocketHandle InvalidSocketHandle = -1;
+#endif
+
+/// Host independent error codes of the socket operations
+enum class Errno {
+    SUCCESS,
+    BADF,
+    INVAL,
+    MFILE,
+    AGAIN,
+    INPROGRESS,
+    ALREADY,
+    ISCONN,
+    NOTCONN,
+    CONNREFUSED,
+    CONNRESET,
+    CONNABORTED,
+    TIMEDOUT,
+    NETUNREACH,
+    HOSTUNREACH,
+    ADDRINUSE,
+    ADDRNOTAVAIL,
+    MSGSIZE,
+    PIPE,
+    NOBUFS,
+    AFNOSUPPORT,
+    OPNOTSUPP,
+    OTHER,
+};
+
+enum class Domain {
+    INET,
+};
+
+enum class Type {
+    STREAM,
+    DGRAM,
+    RAW,
+};
+
+enum class Protocol {
+    UNSPECIFIED,
+    ICMP,
+    TCP,
+    UDP,
+};
+
+enum class ShutdownHow {
+    RD,
+    WR,
+    RDWR,
+};
+
+/// Events of a socket, the values match the POSIX poll events
+enum class PollEvents : u16 {
+    None = 0,
+    In = 1 << 0,
+    Pri = 1 << 1,
+    Out = 1 << 2,
+    Err = 1 << 3,
+    Hup = 1 << 4,
+    Nval = 1 << 5,
+};
+
+constexpr PollEvents operator|(PollEvents lhs, PollEvents rhs) {
+    return static_cast<PollEvents>(u32(lhs) | u32(rhs));
+}
+
+constexpr PollEvents operator&(PollEvents lhs, PollEvents rhs) {
+    return static_cast<PollEvents>(u32(lhs) & u32(rhs));
+}
+
+constexpr PollEvents& operator|=(PollEvents& lhs, PollEvents rhs) {
+    lhs = lhs | rhs;
+    return lhs;
+}
+
+/// Messages flags of Recv and Send
+constexpr u32 FLAG_MSG_PEEK = 0x2;
+
+using IPv4Address = std::array<u8, 4>;
+
+/// IPv4 socket address, the port is in host byte order
+struct SockAddrIn {
+    IPv4Address ip{};
+    u16 portno = 0;
+};
+
+/**
+ * Host socket. Host sockets are always non-blocking, the operations that would block fail with
+ * Errno::AGAIN and have to be retried once the socket is ready.
+ */
+class Socket final {
+public:
+    struct AcceptResult {
+        std::unique_ptr<Socket> socket;
+        SockAddrIn sockaddr_in;
+    };
+
+    Socket() = default;
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    Errno Initialize(Domain domain, Type type, Protocol protocol);
+
+    Errno Close();
+
+    std::pair<AcceptResult, Errno> Accept();
+
+    Errno Connect(const SockAddrIn& addr_in);
+
+    std::pair<SockAddrIn, Errno> GetPeerName() const;
+
+    std::pair<SockAddrIn, Errno> GetSockName() const;
+
+    Errno Bind(const SockAddrIn& addr);
+
+    Errno Listen(s32 backlog);
+
+    Errno Shutdown(ShutdownHow how);
+
+    std::pair<s32, Errno> Recv(u32 flags, u8* data, std::size_t size);
+
+    /// Receives a message, addr is filled with its sender when it's not null
+    std::pair<s32, Errno> RecvFrom(u32 flags, u8* data, std::size_t size, SockAddrIn* addr);
+
+    std::pair<s32, Errno> Send(u32 flags, const u8* data, std::size_t size);
+
+    /// Sends a message to addr, or to the peer of a connected socket when it's null
+    std::pair<s32, Errno> SendTo(u32 flags, const u8* data, std::size_t size,
+                                 const SockAddrIn* addr);
+
+    Errno SetLinger(bool enable, u32 linger);
+
+    Errno SetReuseAddr(bool enable);
+
+    Errno SetBroadcast(bool enable);
+
+    Errno SetKeepAlive(bool enable);
+
+    Errno SetNoDelay(bool enable);
+
+    Errno SetSndBuf(u32 value);
+
+    Errno SetRcvBuf(u32 value);
+
+    std::pair<u32, Errno> GetSndBuf() const;
+
+    std::pair<u32, Errno> GetRcvBuf() const;
+
+    /// Returns and clears the error of the socket, set by a failed non-blocking connection
+    std::pair<Errno, Errno> GetPendingError();
+
+    SocketHandle GetHandle() const {
+        return handle;
+    }
+
+    bool IsOpen() const {
+        return handle != InvalidSocketHandle;
+    }
+
+private:
+    explicit Socket(SocketHandle handle) : handle{handle} {}
+
+    SocketHandle handle = InvalidSocketHandle;
+};
+
+struct PollFD {
+    SocketHandle handle;
+    PollEvents events;
+    PollEvents revents;
+};
+
+/**
+ * Polls the sockets for events.
+ * @param timeout Timeout in milliseconds, zero returns immediately and -1 waits forever
+ * @returns The number of sockets with events and the error
+ */
+std::pair<s32, Errno> Poll(std::vector<PollFD>& poll_fds, s32 timeout);
+
+/// Initializes the host socket library for as long as it lives
+class NetworkInstance final {
+public:
+    NetworkInstance();
+    ~NetworkInstance();
+
+    NetworkInstance(const NetworkInstance&) = delete;
+    NetworkInstance& operator=(const NetworkInstance&) = delete;
+};
+
+} // namespace Network
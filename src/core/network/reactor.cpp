@@ -0,0 +1,154 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/network/reactor.h"
+
+namespace Network {
+
+namespace {
+/// Poll timeout when the reactor can't be woken up, new watches are only seen after it
+constexpr s32 fallback_poll_timeout_ms = 10;
+} // Anonymous namespace
+
+Reactor::Reactor() {
+    // Connecting a datagram socket to its own address makes it a wake-up channel that every host
+    // can poll, unlike pipes on Windows
+    const SockAddrIn loopback{{127, 0, 0, 1}, 0};
+    if (wake_socket.Initialize(Domain::INET, Type::DGRAM, Protocol::UDP) != Errno::SUCCESS ||
+        wake_socket.Bind(loopback) != Errno::SUCCESS) {
+        LOG_CRITICAL(Network, "Failed to create the reactor wake-up socket");
+        wake_socket.Close();
+        return;
+    }
+    const auto [address, error] = wake_socket.GetSockName();
+    if (error != Errno::SUCCESS || wake_socket.Connect(address) != Errno::SUCCESS) {
+        LOG_CRITICAL(Network, "Failed to connect the reactor wake-up socket");
+        wake_socket.Close();
+    }
+}
+
+Reactor::~Reactor() {
+    {
+        std::lock_guard lock{mutex};
+        is_stopping = true;
+    }
+    if (thread.joinable()) {
+        Wake();
+        thread.join();
+    }
+}
+
+u64 Reactor::Watch(std::vector<Interest> interests, Callback callback) {
+    u64 id;
+    {
+        std::lock_guard lock{mutex};
+        id = next_id++;
+        watches.push_back({id, std::move(interests), std::move(callback)});
+        if (!thread.joinable()) {
+            thread = std::thread([this] { Run(); });
+            return id;
+        }
+    }
+    Wake();
+    return id;
+}
+
+void Reactor::Cancel(u64 id) {
+    {
+        std::lock_guard lock{mutex};
+        const auto it = std::find_if(watches.begin(), watches.end(),
+                                     [id](const WatchEntry& watch) { return watch.id == id; });
+        if (it == watches.end()) {
+            return;
+        }
+        watches.erase(it);
+    }
+    Wake();
+}
+
+void Reactor::Wake() {
+    if (!wake_socket.IsOpen()) {
+        return;
+    }
+    const u8 byte = 0;
+    wake_socket.Send(0, &byte, sizeof(byte));
+}
+
+void Reactor::Run() {
+    Common::SetCurrentThreadName("yuzu:SocketReactor");
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::Background);
+
+    const bool can_wake = wake_socket.IsOpen();
+    std::vector<PollFD> poll_fds;
+    std::vector<u64> owners;
+    std::vector<Callback> ready;
+    while (true) {
+        poll_fds.clear();
+        owners.clear();
+        {
+            std::lock_guard lock{mutex};
+            if (is_stopping) {
+                return;
+            }
+            if (can_wake) {
+                poll_fds.push_back({wake_socket.GetHandle(), PollEvents::In, PollEvents::None});
+                owners.push_back(0);
+            }
+            for (const WatchEntry& watch : watches) {
+                for (const Interest& interest : watch.interests) {
+                    poll_fds.push_back({interest.handle, interest.events, PollEvents::None});
+                    owners.push_back(watch.id);
+                }
+            }
+        }
+
+        const auto [result, error] =
+            Poll(poll_fds, can_wake ? -1 : fallback_poll_timeout_ms);
+        if (error != Errno::SUCCESS) {
+            LOG_ERROR(Network, "Reactor poll failed");
+            continue;
+        }
+        if (result == 0) {
+            continue;
+        }
+
+        if (can_wake && poll_fds[0].revents != PollEvents::None) {
+            // Drain the wake-ups, the watches are polled again from scratch anyway
+            std::array<u8, 64> buffer;
+            while (wake_socket.Recv(0, buffer.data(), buffer.size()).first > 0) {
+            }
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            for (std::size_t i = 0; i < poll_fds.size(); ++i) {
+                if (owners[i] == 0 || poll_fds[i].revents == PollEvents::None) {
+                    continue;
+                }
+                const u64 id = owners[i];
+                const auto it =
+                    std::find_if(watches.begin(), watches.end(),
+                                 [id](const WatchEntry& watch) { return watch.id == id; });
+                // A watch with several ready sockets is fired by the first one
+                if (it == watches.end()) {
+                    continue;
+                }
+                ready.push_back(std::move(it->callback));
+                watches.erase(it);
+            }
+        }
+
+        for (Callback& callback : ready) {
+            callback();
+        }
+        ready.clear();
+    }
+}
+
+} // namespace Network
@@ -0,0 +1,67 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "core/network/network.h"
+
+namespace Network {
+
+/**
+ * Thread waiting for host sockets to become ready, so the emulated operations that would block
+ * don't block a host thread. A watch calls its callback once, from the reactor thread, when one of
+ * its sockets has one of the requested events or an error. The thread is started by the first
+ * watch.
+ */
+class Reactor final {
+public:
+    using Callback = std::function<void()>;
+
+    struct Interest {
+        SocketHandle handle;
+        PollEvents events;
+    };
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /// Watches the sockets for the events, returns the id of the watch
+    u64 Watch(std::vector<Interest> interests, Callback callback);
+
+    /// Cancels a watch, a callback that is already running may still complete after this returns
+    void Cancel(u64 id);
+
+private:
+    struct WatchEntry {
+        u64 id;
+        std::vector<Interest> interests;
+        Callback callback;
+    };
+
+    void Run();
+
+    /// Wakes the reactor thread up, so it polls the new set of watches
+    void Wake();
+
+    NetworkInstance network_instance;
+
+    /// Datagram socket connected to itself, a datagram sent to it wakes the reactor thread
+    Socket wake_socket;
+
+    std::mutex mutex;
+    std::vector<WatchEntry> watches;
+    u64 next_id = 1;
+    bool is_stopping = false;
+    std::thread thread;
+};
+
+} // namespace Network
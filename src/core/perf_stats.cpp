@@ -4,8 +4,20 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iterator>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
 #include "common/math_util.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
@@ -32,6 +44,9 @@ void PerfStats::EndSystemFrame() {
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
+
+    AddSessionSample(SessionHistogram::FrameTime,
+                     static_cast<u64>(duration_cast<microseconds>(previous_frame_length).count()));
 }
 
 void PerfStats::EndGameFrame() {
@@ -66,6 +81,70 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
     return results;
 }
 
+void PerfStats::AddAudioStats(const AudioStageTimes& stage_times, u64 num_mixes,
+                              u32 active_voices) {
+    std::lock_guard lock{object_mutex};
+
+    for (std::size_t stage = 0; stage < NumAudioStages; ++stage) {
+        audio_stats.stage_times[stage] += stage_times[stage];
+    }
+    audio_stats.num_mixes += num_mixes;
+    audio_stats.max_active_voices = std::max(audio_stats.max_active_voices, active_voices);
+}
+
+AudioStats PerfStats::GetAndResetAudioStats() {
+    std::lock_guard lock{object_mutex};
+
+    return std::exchange(audio_stats, {});
+}
+
+void PerfStats::SampleSessionMetrics(u64 memory_usage) {
+    std::lock_guard lock{object_mutex};
+
+    const auto now = Clock::now();
+    const s64 gpu_busy = gpu_busy_ns.load(std::memory_order_relaxed);
+    const s64 frame_limiter = frame_limiter_ns.load(std::memory_order_relaxed);
+    const u64 ipc_requests = GetSessionCount(SessionCounter::IpcRequests);
+    const double interval = duration_cast<DoubleSecs>(now - previous_sample_time).count();
+    if (interval > 0.0) {
+        // The GPU thread is only busy while asynchronous GPU emulation is enabled, its swaps then
+        // include the frame limiter
+        if (gpu_busy != 0) {
+            const s64 busy_ns = (gpu_busy - previous_sample_gpu_busy_ns) -
+                                (frame_limiter - previous_sample_frame_limiter_ns);
+            const double busy = static_cast<double>(busy_ns) / 1e9;
+            const double utilization = std::clamp(busy / interval, 0.0, 1.0) * 100.0;
+            AddSessionSample(SessionHistogram::GpuUtilization,
+                             static_cast<u64>(std::lround(utilization)));
+        }
+        const double ipc_rate = static_cast<double>(ipc_requests - previous_sample_ipc_requests);
+        AddSessionSample(SessionHistogram::IpcRate, static_cast<u64>(ipc_rate / interval));
+    }
+    AddSessionSample(SessionHistogram::MemoryUsage, memory_usage / 1024);
+
+    previous_sample_time = now;
+    previous_sample_gpu_busy_ns = gpu_busy;
+    previous_sample_frame_limiter_ns = frame_limiter;
+    previous_sample_ipc_requests = ipc_requests;
+}
+
+void PerfStats::ResetSessionMetrics() {
+    std::lock_guard lock{object_mutex};
+
+    for (auto& histogram : session_histograms) {
+        histogram.Reset();
+    }
+    for (auto& counter : session_counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    gpu_busy_ns = 0;
+    frame_limiter_ns = 0;
+    previous_sample_time = Clock::now();
+    previous_sample_gpu_busy_ns = 0;
+    previous_sample_frame_limiter_ns = 0;
+    previous_sample_ipc_requests = 0;
+}
+
 double PerfStats::GetLastFrameTimeScale() {
     std::lock_guard lock{object_mutex};
 
@@ -73,6 +152,156 @@ double PerfStats::GetLastFrameTimeScale() {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+u64 PerfStats::RecordFrameEvent(FrameEvent event) {
+    std::lock_guard lock{object_mutex};
+
+    const u64 frame = frame_event_counts[static_cast<std::size_t>(event)]++;
+    RecordFrameEventInner(event, frame);
+    return frame;
+}
+
+void PerfStats::RecordFrameEvent(FrameEvent event, u64 frame) {
+    std::lock_guard lock{object_mutex};
+
+    RecordFrameEventInner(event, frame);
+}
+
+std::vector<FrameTimestamps> PerfStats::GetFrameHistory() {
+    std::lock_guard lock{object_mutex};
+
+    std::vector<FrameTimestamps> history;
+    history.reserve(FRAME_HISTORY_SIZE);
+    std::copy_if(frame_history.begin(), frame_history.end(), std::back_inserter(history),
+                 [](const FrameTimestamps& entry) {
+                     return std::any_of(entry.times.begin(), entry.times.end(),
+                                        [](auto time) { return time != Clock::time_point{}; });
+                 });
+    std::sort(history.begin(), history.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.frame < rhs.frame; });
+    return history;
+}
+
+void PerfStats::ResetFrameHistory() {
+    std::lock_guard lock{object_mutex};
+
+    frame_history = {};
+    frame_event_counts = {};
+}
+
+void PerfStats::RecordFrameEventInner(FrameEvent event, u64 frame) {
+    FrameTimestamps& entry = frame_history[frame % FRAME_HISTORY_SIZE];
+    if (entry.frame != frame) {
+        if (entry.frame > frame) {
+            // The frame is too old to be in the history anymore
+            return;
+        }
+        entry = {};
+        entry.frame = frame;
+    }
+    entry.times[static_cast<std::size_t>(event)] = Clock::now();
+}
+
+const char* GetSessionHistogramName(SessionHistogram histogram) {
+    switch (histogram) {
+    case SessionHistogram::FrameTime:
+        return "FrameTime";
+    case SessionHistogram::GpuUtilization:
+        return "GpuUtilization";
+    case SessionHistogram::ShaderBuildTime:
+        return "ShaderBuildTime";
+    case SessionHistogram::IpcRate:
+        return "IpcRate";
+    case SessionHistogram::MemoryUsage:
+        return "MemoryUsage";
+    case SessionHistogram::Count:
+        break;
+    }
+    return "Unknown";
+}
+
+namespace {
+
+/// Returns the event frame times are measured at, renderers that don't report presentation are
+/// measured at the end of their swaps
+FrameEvent GetMeasuredEvent(const std::vector<FrameTimestamps>& history) {
+    const bool has_presents =
+        std::any_of(history.begin(), history.end(),
+                    [](const auto& entry) { return entry.HasEvent(FrameEvent::Present); });
+    return has_presents ? FrameEvent::Present : FrameEvent::SwapEnd;
+}
+
+} // Anonymous namespace
+
+std::vector<double> GetFrameTimes(const std::vector<FrameTimestamps>& history) {
+    const FrameEvent measured_event = GetMeasuredEvent(history);
+
+    std::vector<double> frame_times;
+    frame_times.reserve(history.size());
+
+    std::optional<FrameTimestamps::Clock::time_point> previous;
+    for (const FrameTimestamps& entry : history) {
+        if (!entry.HasEvent(measured_event)) {
+            continue;
+        }
+        const auto time = entry.GetTime(measured_event);
+        if (previous) {
+            frame_times.push_back(
+                std::chrono::duration<double, std::milli>(time - *previous).count());
+        }
+        previous = time;
+    }
+    return frame_times;
+}
+
+FrameTimeStats ComputeFrameTimeStats(const std::vector<FrameTimestamps>& history) {
+    FrameTimeStats stats{};
+
+    const FrameEvent measured_event = GetMeasuredEvent(history);
+    stats.dropped_frames = static_cast<std::size_t>(
+        std::count_if(history.begin(), history.end(), [measured_event](const auto& entry) {
+            return entry.HasEvent(FrameEvent::SwapEnd) && !entry.HasEvent(measured_event);
+        }));
+
+    std::vector<double> frame_times = GetFrameTimes(history);
+    stats.num_frames = frame_times.size();
+    if (frame_times.empty()) {
+        return stats;
+    }
+
+    double total = 0.0;
+    for (const double frame_time : frame_times) {
+        total += frame_time;
+    }
+    stats.average = total / static_cast<double>(frame_times.size());
+
+    std::sort(frame_times.begin(), frame_times.end());
+    const auto percentile = [&frame_times](double fraction) {
+        const auto index = static_cast<std::size_t>(
+            std::ceil(fraction * static_cast<double>(frame_times.size())) - 1.0);
+        return frame_times[std::min(index, frame_times.size() - 1)];
+    };
+    stats.percentile_99 = percentile(0.99);
+    stats.percentile_999 = percentile(0.999);
+    stats.max = frame_times.back();
+    return stats;
+}
+
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+    // Regular waitable timers and sleeps are rounded to the scheduler's quantum
+    timer_handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                          TIMER_ALL_ACCESS);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    if (timer_handle) {
+        CloseHandle(timer_handle);
+    }
+#endif
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (!Settings::values.use_frame_limit) {
         return;
@@ -80,23 +309,38 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
 
     auto now = Clock::now();
 
-    const double sleep_scale = Settings::values.frame_limit / 100.0;
+    // Time the frame is expected to take, from the emulated time or from the target frame rate
+    microseconds frame_length;
+    if (Settings::values.frame_limit_fps != 0) {
+        frame_length = duration_cast<microseconds>(
+            std::chrono::duration<double>(1.0 / Settings::values.frame_limit_fps));
+    } else {
+        const double sleep_scale = Settings::values.frame_limit / 100.0;
+        frame_length = duration_cast<microseconds>(
+            std::chrono::duration<double, std::chrono::microseconds::period>(
+                (current_system_time_us - previous_system_time_us) / sleep_scale));
+    }
 
     // Max lag caused by slow frames. Shouldn't be more than the length of a frame at the current
     // speed percent or it will clamp too much and prevent this from properly limiting to that
     // percent. High values means it'll take longer after a slow frame to recover and start
     // limiting
-    const microseconds max_lag_time_us = duration_cast<microseconds>(
-        std::chrono::duration<double, std::chrono::microseconds::period>(25ms / sleep_scale));
-    frame_limiting_delta_err += duration_cast<microseconds>(
-        std::chrono::duration<double, std::chrono::microseconds::period>(
-            (current_system_time_us - previous_system_time_us) / sleep_scale));
+    const microseconds max_lag_time_us =
+        Settings::values.frame_limit_fps != 0
+            ? frame_length
+            : duration_cast<microseconds>(
+                  std::chrono::duration<double, std::chrono::microseconds::period>(
+                      25ms / (Settings::values.frame_limit / 100.0)));
+
+    // The accumulated difference carries the drift between frames, frames finishing early or late
+    // are balanced by the next ones
+    frame_limiting_delta_err += frame_length;
     frame_limiting_delta_err -= duration_cast<microseconds>(now - previous_walltime);
     frame_limiting_delta_err =
         std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
 
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
+        WaitUntil(now + frame_limiting_delta_err);
         auto now_after_sleep = Clock::now();
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
@@ -106,4 +350,40 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     previous_walltime = now;
 }
 
+void FrameLimiter::WaitUntil(Clock::time_point deadline) {
+    constexpr Clock::duration min_spin_margin = 100us;
+    constexpr Clock::duration max_spin_margin = 4ms;
+
+    const auto sleep_begin = Clock::now();
+    const auto sleep_length = deadline - spin_margin - sleep_begin;
+    if (sleep_length > Clock::duration::zero()) {
+        CoarseSleep(sleep_length);
+
+        // Grow the margin right away when a sleep overshoots it, shrink it slowly otherwise
+        const auto overshoot = Clock::now() - sleep_begin - sleep_length;
+        spin_margin = std::clamp(std::max(overshoot + overshoot / 4, spin_margin * 15 / 16),
+                                 min_spin_margin, max_spin_margin);
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FrameLimiter::CoarseSleep(Clock::duration duration) {
+#ifdef _WIN32
+    if (timer_handle) {
+        // Negative due times are relative, in 100 nanosecond units
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -std::max<LONGLONG>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100, 1);
+        if (SetWaitableTimerEx(timer_handle, &due_time, 0, nullptr, nullptr, nullptr, 0)) {
+            WaitForSingleObject(timer_handle, INFINITE);
+            return;
+        }
+    }
+#endif
+    std::this_thread::sleep_for(duration);
+}
+
 } // namespace Core
@@ -4,9 +4,14 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
+#include "common/histogram.h"
 
 namespace Core {
 
@@ -21,6 +26,105 @@ struct PerfStatsResults {
     double emulation_speed;
 };
 
+/// Stages a guest frame goes through from the guest queueing it to the host presenting it
+enum class FrameEvent : u32 {
+    QueueBuffer, ///< The guest queued the buffer to its layer
+    Compose,     ///< NVFlinger sent the buffer to the GPU
+    SwapBegin,   ///< The renderer started processing the frame
+    SwapEnd,     ///< The renderer finished processing the frame, including frame limiting
+    Present,     ///< The host presented the frame
+    Count,
+};
+
+constexpr std::size_t NumFrameEvents = static_cast<std::size_t>(FrameEvent::Count);
+
+/// Wall clock times of the events of a frame, events that didn't happen are left at the epoch
+struct FrameTimestamps {
+    using Clock = std::chrono::high_resolution_clock;
+
+    bool HasEvent(FrameEvent event) const {
+        return times[static_cast<std::size_t>(event)] != Clock::time_point{};
+    }
+
+    Clock::time_point GetTime(FrameEvent event) const {
+        return times[static_cast<std::size_t>(event)];
+    }
+
+    u64 frame = 0;
+    std::array<Clock::time_point, NumFrameEvents> times{};
+};
+
+/// Stages of the audio renderer, timed separately to find where the audio time goes
+enum class AudioStage : u32 {
+    Update,      ///< Parsing the parameters of an update from the guest
+    Decode,      ///< Reading and decoding the wave buffers of the voices
+    Resample,    ///< Resampling the voices to the output rate
+    Mix,         ///< Adding the voices together and converting the mix
+    Effects,     ///< Updating the effects
+    SinkEnqueue, ///< Queueing the mixed buffers to the stream
+    Count,
+};
+
+constexpr std::size_t NumAudioStages = static_cast<std::size_t>(AudioStage::Count);
+
+using AudioStageTimes = std::array<std::chrono::nanoseconds, NumAudioStages>;
+
+struct AudioStats {
+    /// Number of buffers the audio renderers mixed
+    u64 num_mixes;
+    /// Largest number of voices played by a mix
+    u32 max_active_voices;
+    /// Time spent in each stage
+    AudioStageTimes stage_times;
+};
+
+/// Metrics aggregated over a whole session into histograms, submitted with the telemetry
+enum class SessionHistogram : u32 {
+    FrameTime,       ///< Visible length of the system frames in microseconds
+    GpuUtilization,  ///< Percentage of each sample period the GPU thread spent executing commands
+    ShaderBuildTime, ///< Length of the shader builds done on the GPU thread in microseconds
+    IpcRate,         ///< IPC requests per second of each sample period
+    MemoryUsage,     ///< Physical memory used by the guest process at each sample, in KiB
+    Count,
+};
+
+constexpr std::size_t NumSessionHistograms = static_cast<std::size_t>(SessionHistogram::Count);
+
+/// Events counted over a whole session, submitted with the telemetry
+enum class SessionCounter : u32 {
+    SurfaceCacheHits,   ///< Surface lookups served by a compatible cached surface
+    SurfaceCacheMisses, ///< Surface lookups that had to create a surface
+    IpcRequests,        ///< IPC requests handled by service functions
+    Count,
+};
+
+constexpr std::size_t NumSessionCounters = static_cast<std::size_t>(SessionCounter::Count);
+
+/// Returns the name of a session histogram as used in the telemetry fields
+const char* GetSessionHistogramName(SessionHistogram histogram);
+
+struct FrameTimeStats {
+    /// Number of frame times the statistics were calculated from
+    std::size_t num_frames;
+    /// Frames that were processed by the renderer but never presented
+    std::size_t dropped_frames;
+    /// Frame time statistics in milliseconds
+    double average;
+    double percentile_99;  ///< The 1% lows
+    double percentile_999; ///< The 0.1% lows
+    double max;
+};
+
+/**
+ * Returns the frame times in milliseconds of a frame history, from the oldest to the newest. Frame
+ * times are the intervals between the presentation of consecutive frames, or between the end of
+ * their swaps when the renderer doesn't report presentation.
+ */
+std::vector<double> GetFrameTimes(const std::vector<FrameTimestamps>& history);
+
+/// Calculates frame time statistics from a frame history, see GetFrameTimes
+FrameTimeStats ComputeFrameTimeStats(const std::vector<FrameTimestamps>& history);
+
 /**
  * Class to manage and query performance/timing statistics. All public functions of this class are
  * thread-safe unless stated otherwise.
@@ -41,9 +145,101 @@ public:
      */
     double GetLastFrameTimeScale();
 
+    /**
+     * Records an event for the next frame going through that stage. Stages process frames in
+     * order, so the n-th event of each stage belongs to the same frame.
+     * @returns The number of the frame the event was recorded for
+     */
+    u64 RecordFrameEvent(FrameEvent event);
+
+    /// Records an event for the given frame, used by stages that may skip frames
+    void RecordFrameEvent(FrameEvent event, u64 frame);
+
+    /// Returns the recorded frames in the history, from the oldest to the newest
+    std::vector<FrameTimestamps> GetFrameHistory();
+
+    /// Clears the frame history, the stages start counting frames from zero again
+    void ResetFrameHistory();
+
+    /**
+     * Adds the time spent by an audio renderer in each of its stages.
+     * @param num_mixes Number of buffers mixed during that time
+     * @param active_voices Number of voices played by the last of them
+     */
+    void AddAudioStats(const AudioStageTimes& stage_times, u64 num_mixes, u32 active_voices);
+
+    /// Returns the audio statistics accumulated since the last call
+    AudioStats GetAndResetAudioStats();
+
+    /// Adds a value to a session histogram, lock-free
+    void AddSessionSample(SessionHistogram histogram, u64 value) {
+        session_histograms[static_cast<std::size_t>(histogram)].Add(value);
+    }
+
+    /// Adds to a session counter, lock-free
+    void AddSessionCount(SessionCounter counter, u64 amount = 1) {
+        session_counters[static_cast<std::size_t>(counter)].fetch_add(amount,
+                                                                      std::memory_order_relaxed);
+    }
+
+    /// Adds time the GPU thread spent executing commands, lock-free
+    void AddGpuBusyTime(Clock::duration time) {
+        gpu_busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+                              std::memory_order_relaxed);
+    }
+
+    /// Adds time the renderer spent in the frame limiter, which doesn't count as GPU busy time
+    void AddFrameLimiterTime(Clock::duration time) {
+        frame_limiter_ns.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+            std::memory_order_relaxed);
+    }
+
+    /**
+     * Samples the rates of the session metrics over the walltime elapsed since the previous
+     * sample, called periodically while emulating.
+     * @param memory_usage Physical memory used by the guest process in bytes
+     */
+    void SampleSessionMetrics(u64 memory_usage);
+
+    const Common::Histogram& GetSessionHistogram(SessionHistogram histogram) const {
+        return session_histograms[static_cast<std::size_t>(histogram)];
+    }
+
+    u64 GetSessionCount(SessionCounter counter) const {
+        return session_counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /// Clears the session metrics, done when a new session starts
+    void ResetSessionMetrics();
+
 private:
+    /// Number of frames kept in the frame history
+    static constexpr std::size_t FRAME_HISTORY_SIZE = 1024;
+
+    void RecordFrameEventInner(FrameEvent event, u64 frame);
+
     std::mutex object_mutex;
 
+    /// Ring buffer with the timestamps of the last frames, indexed by frame number
+    std::array<FrameTimestamps, FRAME_HISTORY_SIZE> frame_history{};
+    /// Number of events recorded for each stage
+    std::array<u64, NumFrameEvents> frame_event_counts{};
+
+    /// Audio statistics accumulated since the last reset
+    AudioStats audio_stats{};
+
+    std::array<Common::Histogram, NumSessionHistograms> session_histograms;
+    std::array<std::atomic<u64>, NumSessionCounters> session_counters{};
+    std::atomic<s64> gpu_busy_ns{0};
+    std::atomic<s64> frame_limiter_ns{0};
+
+    /// Walltime and rate counters at the previous session sample, guarded by the object mutex
+    Clock::time_point previous_sample_time = Clock::now();
+    s64 previous_sample_gpu_busy_ns = 0;
+    s64 previous_sample_frame_limiter_ns = 0;
+    u64 previous_sample_ipc_requests = 0;
+
     /// Point when the cumulative counters were reset
     Clock::time_point reset_point = Clock::now();
     /// System time when the cumulative counters were reset
@@ -64,13 +260,36 @@ private:
     Clock::duration previous_frame_length = Clock::duration::zero();
 };
 
+/**
+ * Paces the emulation to the emulated time, or to a fixed frame rate when
+ * Settings::values.frame_limit_fps is set. Waits sleep coarsely and spin the last part, the spun
+ * margin adapts to how much the host's sleeps overshoot.
+ */
 class FrameLimiter {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    FrameLimiter();
+    ~FrameLimiter();
+
+    FrameLimiter(const FrameLimiter&) = delete;
+    FrameLimiter& operator=(const FrameLimiter&) = delete;
+
     void DoFrameLimiting(std::chrono::microseconds current_system_time_us);
 
 private:
+    /// Waits until the given time point, sleeping coarsely and spinning the rest
+    void WaitUntil(Clock::time_point deadline);
+
+    /// Sleeps for about the given duration, it might overshoot by the host's timer resolution
+    void CoarseSleep(Clock::duration duration);
+
+    /// Handle of a high resolution waitable timer on Windows, null when it's not available
+    void* timer_handle = nullptr;
+
+    /// Time left before a deadline to stop sleeping and start spinning
+    Clock::duration spin_margin = std::chrono::milliseconds{1};
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
     /// Walltime at the last limiter invocation
@@ -62,6 +62,29 @@ const std::array<const char*, NumMouseButtons> mapping = {{
 
 Values values = {};
 
+namespace {
+/// Global values replaced by the overrides of the running title
+TitleOverrides replaced_values;
+
+template <typename T>
+void ApplyOverride(T& value, const std::optional<T>& override_value,
+                   std::optional<T>& replaced_value) {
+    if (!override_value) {
+        return;
+    }
+    replaced_value = value;
+    value = *override_value;
+}
+
+template <typename T>
+void RestoreValue(T& value, std::optional<T>& replaced_value) {
+    if (replaced_value) {
+        value = *replaced_value;
+        replaced_value.reset();
+    }
+}
+} // Anonymous namespace
+
 void Apply() {
     GDBStub::SetServerPort(values.gdbstub_port);
     GDBStub::ToggleServer(values.use_gdbstub);
@@ -74,6 +97,48 @@ void Apply() {
     Service::HID::ReloadInputDevices();
 }
 
+void ApplyTitleOverrides(u64 title_id) {
+    RestoreGlobalValues();
+
+    const auto it = values.title_overrides.find(title_id);
+    if (it == values.title_overrides.end() || it->second.IsEmpty()) {
+        return;
+    }
+    const TitleOverrides& overrides = it->second;
+    ApplyOverride(values.use_multi_core, overrides.use_multi_core, replaced_values.use_multi_core);
+    ApplyOverride(values.use_function_hooks, overrides.use_function_hooks,
+                  replaced_values.use_function_hooks);
+    ApplyOverride(values.use_asynchronous_gpu_emulation, overrides.use_asynchronous_gpu_emulation,
+                  replaced_values.use_asynchronous_gpu_emulation);
+    ApplyOverride(values.use_accurate_gpu_emulation, overrides.use_accurate_gpu_emulation,
+                  replaced_values.use_accurate_gpu_emulation);
+    ApplyOverride(values.use_disk_shader_cache, overrides.use_disk_shader_cache,
+                  replaced_values.use_disk_shader_cache);
+    ApplyOverride(values.resolution_factor, overrides.resolution_factor,
+                  replaced_values.resolution_factor);
+
+    LOG_INFO(Config, "Applied the setting overrides of title {:016X}", title_id);
+    LogSettings();
+}
+
+void RestoreGlobalValues() {
+    RestoreValue(values.use_multi_core, replaced_values.use_multi_core);
+    RestoreValue(values.use_function_hooks, replaced_values.use_function_hooks);
+    RestoreValue(values.use_asynchronous_gpu_emulation,
+                 replaced_values.use_asynchronous_gpu_emulation);
+    RestoreValue(values.use_accurate_gpu_emulation, replaced_values.use_accurate_gpu_emulation);
+    RestoreValue(values.use_disk_shader_cache, replaced_values.use_disk_shader_cache);
+    RestoreValue(values.resolution_factor, replaced_values.resolution_factor);
+}
+
+template <typename T>
+T GetGlobalValue(const T& value, std::optional<T> TitleOverrides::*setting) {
+    return (replaced_values.*setting).value_or(value);
+}
+
+template bool GetGlobalValue(const bool&, std::optional<bool> TitleOverrides::*);
+template float GetGlobalValue(const float&, std::optional<float> TitleOverrides::*);
+
 template <typename T>
 void LogSetting(const std::string& name, const T& value) {
     LOG_INFO(Config, "{}: {}", name, value);
@@ -87,16 +152,28 @@ void LogSettings() {
     LogSetting("System_LanguageIndex", Settings::values.language_index);
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
     LogSetting("Core_UseMultiCore", Settings::values.use_multi_core);
+    LogSetting("Core_UseFunctionHooks", Settings::values.use_function_hooks);
+    LogSetting("Core_UseHostTiming", Settings::values.use_host_timing);
+    LogSetting("Core_UseServiceThreads", Settings::values.use_service_threads);
+    LogSetting("Core_PinHostThreads", Settings::values.pin_host_threads);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
+    LogSetting("Renderer_FrameLimitFps", Settings::values.frame_limit_fps);
     LogSetting("Renderer_UseCompatibilityProfile", Settings::values.use_compatibility_profile);
     LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_UseDiskTextureCache", Settings::values.use_disk_texture_cache);
     LogSetting("Renderer_UseAccurateGpuEmulation", Settings::values.use_accurate_gpu_emulation);
     LogSetting("Renderer_UseAsynchronousGpuEmulation",
                Settings::values.use_asynchronous_gpu_emulation);
+    LogSetting("Renderer_UseAsynchronousShaders", Settings::values.use_asynchronous_shaders);
+    LogSetting("Renderer_UseComputeSwizzle", Settings::values.use_compute_swizzle);
+    LogSetting("Renderer_VramBudget", Settings::values.vram_budget);
+    LogSetting("Renderer_UseImmediateComposition", Settings::values.use_immediate_composition);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
+    LogSetting("Audio_ResamplingQuality", Settings::values.resampling_quality);
+    LogSetting("Audio_EnableLowLatencyAudio", Settings::values.enable_low_latency_audio);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
     LogSetting("DataStorage_UseVirtualSd", Settings::values.use_virtual_sd);
     LogSetting("DataStorage_NandDir", Settings::values.nand_dir);
@@ -104,6 +181,11 @@ void LogSettings() {
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
     LogSetting("Debugging_GdbstubPort", Settings::values.gdbstub_port);
     LogSetting("Debugging_ProgramArgs", Settings::values.program_args);
+    LogSetting("Debugging_GpuTraceFrames", Settings::values.gpu_trace_frames);
+    LogSetting("Debugging_DumpShaderStats", Settings::values.dump_shader_stats);
+    LogSetting("Debugging_RecordFrames", Settings::values.record_frames);
+    LogSetting("Debugging_RecordFramesZstdLevel", Settings::values.record_frames_zstd_level);
+    LogSetting("Debugging_ProfileGuest", Settings::values.profile_guest);
 }
 
 } // namespace Settings
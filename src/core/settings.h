@@ -346,6 +346,21 @@ struct TouchscreenInput {
     u32 rotation_angle;
 };
 
+/// Settings a title can override, the unset ones keep the global value
+struct TitleOverrides {
+    std::optional<bool> use_multi_core;
+    std::optional<bool> use_function_hooks;
+    std::optional<bool> use_asynchronous_gpu_emulation;
+    std::optional<bool> use_accurate_gpu_emulation;
+    std::optional<bool> use_disk_shader_cache;
+    std::optional<float> resolution_factor;
+
+    bool IsEmpty() const {
+        return !use_multi_core && !use_function_hooks && !use_asynchronous_gpu_emulation &&
+               !use_accurate_gpu_emulation && !use_disk_shader_cache && !resolution_factor;
+    }
+};
+
 struct Values {
     // System
     bool use_docked_mode;
@@ -380,6 +395,10 @@ struct Values {
     // Core
     bool use_cpu_jit;
     bool use_multi_core;
+    bool use_function_hooks;
+    bool use_host_timing;
+    bool use_service_threads;
+    bool pin_host_threads;
 
     // Data Storage
     bool use_virtual_sd;
@@ -390,11 +409,17 @@ struct Values {
     float resolution_factor;
     bool use_frame_limit;
     u16 frame_limit;
+    u16 frame_limit_fps;
     bool use_compatibility_profile;
     bool use_disk_shader_cache;
+    bool use_disk_texture_cache;
     bool use_accurate_gpu_emulation;
     bool use_asynchronous_gpu_emulation;
+    bool use_asynchronous_shaders;
+    bool use_compute_swizzle;
+    u16 vram_budget;
     bool force_30fps_mode;
+    bool use_immediate_composition;
 
     float bg_red;
     float bg_green;
@@ -407,6 +432,8 @@ struct Values {
     // Audio
     std::string sink_id;
     bool enable_audio_stretching;
+    u16 resampling_quality;
+    bool enable_low_latency_audio;
     std::string audio_device_id;
     float volume;
 
@@ -416,6 +443,11 @@ struct Values {
     std::string program_args;
     bool dump_exefs;
     bool dump_nso;
+    u32 gpu_trace_frames;
+    bool dump_shader_stats;
+    bool record_frames;
+    u32 record_frames_zstd_level;
+    bool profile_guest;
 
     // WebService
     bool enable_telemetry;
@@ -425,8 +457,24 @@ struct Values {
 
     // Add-Ons
     std::map<u64, std::vector<std::string>> disabled_addons;
+
+    // Per-title overrides, by title ID
+    std::map<u64, TitleOverrides> title_overrides;
 } extern values;
 
 void Apply();
 void LogSettings();
+
+/**
+ * Replaces the global values by the overrides of a title, for the session being booted. It is
+ * called before the subsystems are created, they read the settings of the session from values.
+ */
+void ApplyTitleOverrides(u64 title_id);
+
+/// Restores the global values replaced by ApplyTitleOverrides, once the session is shut down
+void RestoreGlobalValues();
+
+/// Returns a setting of the global configuration, ignoring the overrides of the running title
+template <typename T>
+T GetGlobalValue(const T& value, std::optional<T> TitleOverrides::*setting);
 } // namespace Settings
@@ -0,0 +1,376 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/zstd_compression.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_cpu.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/scheduler.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/memory.h"
+#include "core/snapshot.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu.h"
+
+namespace Core {
+namespace {
+
+constexpr u32 SNAPSHOT_MAGIC = Common::MakeMagic('Y', 'Z', 'S', 'S');
+constexpr u32 SNAPSHOT_VERSION = 1;
+
+/// Index of the pages that are all zeroes, most of the heap of a title is never written
+constexpr u32 ZERO_PAGE = 0xFFFFFFFF;
+
+// Followed by the zstd-compressed contents: the unique pages, the memory regions as lists of page
+// indices, the threads and the registers of the 3D engine.
+struct SnapshotHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le title_id;
+    u64_le contents_size;
+};
+static_assert(sizeof(SnapshotHeader) == 0x18, "SnapshotHeader has incorrect size.");
+
+struct SnapshotThread {
+    u64 thread_id;
+    u32 status;
+    u64 tpidr_el0;
+    ARM_Interface::ThreadContext context;
+};
+
+class SnapshotWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types are stored");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* source, std::size_t size) {
+        const auto* const bytes = static_cast<const u8*>(source);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    std::vector<u8> data;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::vector<u8>& data) : data(data) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types are stored");
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    bool ReadBytes(void* dest, std::size_t size) {
+        if (data.size() - position < size) {
+            return false;
+        }
+        std::memcpy(dest, data.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    /// Returns a pointer to the next size bytes, or nullptr if there aren't as many left
+    const u8* Skip(std::size_t size) {
+        if (data.size() - position < size) {
+            return nullptr;
+        }
+        const u8* const pointer = data.data() + position;
+        position += size;
+        return pointer;
+    }
+
+    bool IsAtEnd() const {
+        return position == data.size();
+    }
+
+private:
+    const std::vector<u8>& data;
+    std::size_t position = 0;
+};
+
+struct MemoryRegion {
+    VAddr base;
+    u64 size;
+    u8* host_pointer;
+};
+
+bool IsSnapshotMemory(const Kernel::VirtualMemoryArea& vma) {
+    return (vma.type == Kernel::VMAType::AllocatedMemoryBlock ||
+            vma.type == Kernel::VMAType::BackingMemory) &&
+           vma.permissions != Kernel::VMAPermission::None;
+}
+
+u8* GetHostPointer(const Kernel::VirtualMemoryArea& vma) {
+    if (vma.type == Kernel::VMAType::AllocatedMemoryBlock) {
+        return vma.backing_block->data() + vma.offset;
+    }
+    return vma.backing_memory;
+}
+
+/// Returns the memory of the process that is captured, in address order
+std::vector<MemoryRegion> GetMemoryRegions(const Kernel::VMManager& vm_manager) {
+    std::vector<MemoryRegion> regions;
+    VAddr address = vm_manager.GetAddressSpaceBaseAddress();
+    while (address < vm_manager.GetAddressSpaceEndAddress()) {
+        const auto handle = vm_manager.FindVMA(address);
+        if (!vm_manager.IsValidHandle(handle)) {
+            break;
+        }
+        const auto& vma = handle->second;
+        if (IsSnapshotMemory(vma)) {
+            regions.push_back({vma.base, vma.size, GetHostPointer(vma)});
+        }
+        address = vma.base + vma.size;
+    }
+    return regions;
+}
+
+std::map<u64, Kernel::Thread*> GetThreads(System& system) {
+    std::map<u64, Kernel::Thread*> threads;
+    for (std::size_t core = 0; core < NUM_CPU_CORES; ++core) {
+        for (const auto& thread : system.Scheduler(core).GetThreadList()) {
+            threads.emplace(thread->GetThreadID(), thread.get());
+        }
+    }
+    return threads;
+}
+
+} // Anonymous namespace
+
+std::optional<std::vector<u8>> CreateSnapshot(System& system) {
+    Kernel::Process* const process = system.CurrentProcess();
+    if (process == nullptr) {
+        return std::nullopt;
+    }
+
+    // The state of the running threads is only stored in their threads on context switches
+    for (std::size_t core = 0; core < NUM_CPU_CORES; ++core) {
+        Kernel::Thread* const thread = system.Scheduler(core).GetCurrentThread();
+        if (thread != nullptr) {
+            system.ArmInterface(core).SaveContext(thread->GetContext());
+            thread->SetTPIDR_EL0(system.ArmInterface(core).GetTPIDR_EL0());
+        }
+    }
+
+    // Pages are deduplicated by their hash, collisions are told apart by their contents
+    const auto regions = GetMemoryRegions(process->VMManager());
+    std::vector<const u8*> pages;
+    std::unordered_multimap<u64, u32> page_hashes;
+    std::vector<std::vector<u32>> region_pages(regions.size());
+    static const std::vector<u8> zero_page(Memory::PAGE_SIZE);
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        const auto& region = regions[i];
+
+        // Surfaces the GPU rendered to are only in guest memory once flushed
+        system.GPU().FlushRegion(ToCacheAddr(region.host_pointer), region.size);
+
+        for (u64 offset = 0; offset < region.size; offset += Memory::PAGE_SIZE) {
+            const u8* const page = region.host_pointer + offset;
+            if (std::memcmp(page, zero_page.data(), Memory::PAGE_SIZE) == 0) {
+                region_pages[i].push_back(ZERO_PAGE);
+                continue;
+            }
+
+            const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(page),
+                                                Memory::PAGE_SIZE);
+            const auto [begin, end] = page_hashes.equal_range(hash);
+            const auto match = std::find_if(begin, end, [&](const auto& entry) {
+                return std::memcmp(pages[entry.second], page, Memory::PAGE_SIZE) == 0;
+            });
+            if (match != end) {
+                region_pages[i].push_back(match->second);
+                continue;
+            }
+
+            const auto index = static_cast<u32>(pages.size());
+            pages.push_back(page);
+            page_hashes.emplace(hash, index);
+            region_pages[i].push_back(index);
+        }
+    }
+
+    SnapshotWriter writer;
+    writer.data.reserve(pages.size() * Memory::PAGE_SIZE + sizeof(Tegra::Engines::Maxwell3D::Regs));
+    writer.Write(static_cast<u32>(pages.size()));
+    for (const u8* page : pages) {
+        writer.WriteBytes(page, Memory::PAGE_SIZE);
+    }
+    writer.Write(static_cast<u32>(regions.size()));
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        writer.Write(regions[i].base);
+        writer.Write(regions[i].size);
+        writer.WriteBytes(region_pages[i].data(), region_pages[i].size() * sizeof(u32));
+    }
+
+    const auto threads = GetThreads(system);
+    writer.Write(static_cast<u32>(threads.size()));
+    for (const auto& [thread_id, thread] : threads) {
+        writer.Write(SnapshotThread{thread_id, static_cast<u32>(thread->GetStatus()),
+                                    thread->GetTPIDR_EL0(), thread->GetContext()});
+    }
+
+    writer.Write(system.GPU().Maxwell3D().regs);
+
+    const auto compressed =
+        Common::Compression::CompressDataZSTDDefault(writer.data.data(), writer.data.size());
+    if (compressed.empty()) {
+        LOG_ERROR(Core, "Failed to compress the snapshot");
+        return std::nullopt;
+    }
+
+    SnapshotHeader header{};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.title_id = process->GetTitleID();
+    header.contents_size = writer.data.size();
+
+    std::vector<u8> snapshot(sizeof(header) + compressed.size());
+    std::memcpy(snapshot.data(), &header, sizeof(header));
+    std::memcpy(snapshot.data() + sizeof(header), compressed.data(), compressed.size());
+    LOG_INFO(Core, "Created a snapshot of {} unique pages, {} bytes compressed", pages.size(),
+             snapshot.size());
+    return snapshot;
+}
+
+bool RestoreSnapshot(System& system, const std::vector<u8>& snapshot) {
+    Kernel::Process* const process = system.CurrentProcess();
+    SnapshotHeader header{};
+    if (process == nullptr || snapshot.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, snapshot.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        header.title_id != process->GetTitleID()) {
+        LOG_ERROR(Core, "The snapshot is not of the running title");
+        return false;
+    }
+
+    std::vector<u8> contents(header.contents_size);
+    if (!Common::Compression::DecompressDataZSTD(snapshot.data() + sizeof(header),
+                                                 snapshot.size() - sizeof(header),
+                                                 contents.data(), contents.size())) {
+        LOG_ERROR(Core, "Failed to decompress the snapshot");
+        return false;
+    }
+
+    // Everything is validated before anything is restored
+    SnapshotReader reader{contents};
+    u32 num_pages = 0;
+    if (!reader.Read(num_pages)) {
+        return false;
+    }
+    const u8* const pages = reader.Skip(static_cast<std::size_t>(num_pages) * Memory::PAGE_SIZE);
+
+    const auto regions = GetMemoryRegions(process->VMManager());
+    u32 num_regions = 0;
+    if (pages == nullptr || !reader.Read(num_regions)) {
+        return false;
+    }
+    if (num_regions != regions.size()) {
+        LOG_ERROR(Core, "The memory layout of the process changed since the snapshot");
+        return false;
+    }
+    std::vector<const u32*> region_pages(num_regions);
+    for (std::size_t i = 0; i < num_regions; ++i) {
+        VAddr base = 0;
+        u64 size = 0;
+        if (!reader.Read(base) || !reader.Read(size)) {
+            return false;
+        }
+        if (base != regions[i].base || size != regions[i].size) {
+            LOG_ERROR(Core, "The memory layout of the process changed since the snapshot");
+            return false;
+        }
+        const u8* const indices = reader.Skip(size / Memory::PAGE_SIZE * sizeof(u32));
+        if (indices == nullptr) {
+            return false;
+        }
+        region_pages[i] = reinterpret_cast<const u32*>(indices);
+        for (u64 page = 0; page < size / Memory::PAGE_SIZE; ++page) {
+            if (region_pages[i][page] >= num_pages && region_pages[i][page] != ZERO_PAGE) {
+                return false;
+            }
+        }
+    }
+
+    const auto threads = GetThreads(system);
+    u32 num_threads = 0;
+    if (!reader.Read(num_threads) || num_threads != threads.size()) {
+        LOG_ERROR(Core, "The threads of the process changed since the snapshot");
+        return false;
+    }
+    std::vector<SnapshotThread> thread_states(num_threads);
+    for (auto& state : thread_states) {
+        if (!reader.Read(state)) {
+            return false;
+        }
+        const auto thread = threads.find(state.thread_id);
+        if (thread == threads.end() ||
+            static_cast<u32>(thread->second->GetStatus()) != state.status) {
+            LOG_ERROR(Core, "The threads of the process changed since the snapshot");
+            return false;
+        }
+    }
+
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    Tegra::Engines::Maxwell3D::Regs regs;
+    if (!reader.Read(regs) || !reader.IsAtEnd()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        const auto& region = regions[i];
+        for (u64 page = 0; page < region.size / Memory::PAGE_SIZE; ++page) {
+            u8* const dest = region.host_pointer + page * Memory::PAGE_SIZE;
+            const u32 index = region_pages[i][page];
+            if (index == ZERO_PAGE) {
+                std::memset(dest, 0, Memory::PAGE_SIZE);
+            } else {
+                std::memcpy(dest, pages + static_cast<std::size_t>(index) * Memory::PAGE_SIZE,
+                            Memory::PAGE_SIZE);
+            }
+        }
+        system.GPU().InvalidateRegion(ToCacheAddr(region.host_pointer), region.size);
+    }
+
+    for (const auto& state : thread_states) {
+        Kernel::Thread* const thread = threads.at(state.thread_id);
+        thread->GetContext() = state.context;
+        thread->SetTPIDR_EL0(state.tpidr_el0);
+    }
+    for (std::size_t core = 0; core < NUM_CPU_CORES; ++core) {
+        auto& cpu_core = system.ArmInterface(core);
+        const Kernel::Thread* const thread = system.Scheduler(core).GetCurrentThread();
+        if (thread != nullptr) {
+            cpu_core.LoadContext(thread->GetContext());
+            cpu_core.SetTPIDR_EL0(thread->GetTPIDR_EL0());
+        }
+        cpu_core.ClearExclusiveState();
+        cpu_core.ClearInstructionCache();
+    }
+
+    // The rasterizer syncs all of its state again
+    maxwell3d.regs = regs;
+    maxwell3d.dirty_flags = {};
+
+    LOG_INFO(Core, "Restored a snapshot of {} unique pages", num_pages);
+    return true;
+}
+
+} // namespace Core
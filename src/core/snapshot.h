@@ -0,0 +1,32 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+class System;
+
+/**
+ * Captures the guest memory of the current process, the CPU contexts of its threads and the
+ * registers of the 3D engine. Identical pages are stored once and the snapshot is compressed.
+ * Emulation must be paused while this runs.
+ * @return The snapshot, or nullopt if no process is running
+ */
+std::optional<std::vector<u8>> CreateSnapshot(System& system);
+
+/**
+ * Restores a snapshot made earlier in the same session. The state of the kernel objects and HLE
+ * services isn't part of snapshots, so the restore is refused unless the memory layout and the
+ * threads of the process, including what they are waiting on, are still the same.
+ * Emulation must be paused while this runs.
+ * @return Whether the snapshot was restored, nothing is changed if it wasn't
+ */
+bool RestoreSnapshot(System& system, const std::vector<u8>& snapshot);
+
+} // namespace Core
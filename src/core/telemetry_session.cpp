@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <fmt/format.h>
 
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/entropy.h>
@@ -11,11 +12,13 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 
 #include "core/core.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/loader/loader.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 
@@ -111,28 +114,6 @@ TelemetrySession::TelemetrySession() {
                             .count()};
     AddField(Telemetry::FieldType::Session, "Init_Time", init_time);
 
-    u64 program_id{};
-    const Loader::ResultStatus res{System::GetInstance().GetAppLoader().ReadProgramId(program_id)};
-    if (res == Loader::ResultStatus::Success) {
-        const std::string formatted_program_id{fmt::format("{:016X}", program_id)};
-        AddField(Telemetry::FieldType::Session, "ProgramId", formatted_program_id);
-
-        std::string name;
-        System::GetInstance().GetAppLoader().ReadTitle(name);
-
-        if (name.empty()) {
-            auto [nacp, icon_file] = FileSys::PatchManager(program_id).GetControlMetadata();
-            if (nacp != nullptr)
-                name = nacp->GetApplicationName();
-        }
-
-        if (!name.empty())
-            AddField(Telemetry::FieldType::Session, "ProgramName", name);
-    }
-
-    AddField(Telemetry::FieldType::Session, "ProgramFormat",
-             static_cast<u8>(System::GetInstance().GetAppLoader().GetFileType()));
-
     // Log application information
     Telemetry::AppendBuildInfo(field_collection);
 
@@ -147,6 +128,8 @@ TelemetrySession::TelemetrySession() {
     AddField(Telemetry::FieldType::UserConfig, "Core_UseCpuJit", Settings::values.use_cpu_jit);
     AddField(Telemetry::FieldType::UserConfig, "Core_UseMultiCore",
              Settings::values.use_multi_core);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseHostTiming",
+             Settings::values.use_host_timing);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_ResolutionFactor",
              Settings::values.resolution_factor);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseFrameLimit",
@@ -154,14 +137,42 @@ TelemetrySession::TelemetrySession() {
     AddField(Telemetry::FieldType::UserConfig, "Renderer_FrameLimit", Settings::values.frame_limit);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseDiskShaderCache",
              Settings::values.use_disk_shader_cache);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseDiskTextureCache",
+             Settings::values.use_disk_texture_cache);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAccurateGpuEmulation",
              Settings::values.use_accurate_gpu_emulation);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAsynchronousGpuEmulation",
              Settings::values.use_asynchronous_gpu_emulation);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_VramBudget",
+             Settings::values.vram_budget);
     AddField(Telemetry::FieldType::UserConfig, "System_UseDockedMode",
              Settings::values.use_docked_mode);
 }
 
+void TelemetrySession::AddInitialInfo(Loader::AppLoader& app_loader) {
+    u64 program_id{};
+    const Loader::ResultStatus res{app_loader.ReadProgramId(program_id)};
+    if (res == Loader::ResultStatus::Success) {
+        const std::string formatted_program_id{fmt::format("{:016X}", program_id)};
+        AddField(Telemetry::FieldType::Session, "ProgramId", formatted_program_id);
+
+        std::string name;
+        app_loader.ReadTitle(name);
+
+        if (name.empty()) {
+            auto [nacp, icon_file] = FileSys::PatchManager(program_id).GetControlMetadata();
+            if (nacp != nullptr)
+                name = nacp->GetApplicationName();
+        }
+
+        if (!name.empty())
+            AddField(Telemetry::FieldType::Session, "ProgramName", name);
+    }
+
+    AddField(Telemetry::FieldType::Session, "ProgramFormat",
+             static_cast<u8>(app_loader.GetFileType()));
+}
+
 TelemetrySession::~TelemetrySession() {
     // Log one-time session end information
     const s64 shutdown_time{std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -183,6 +194,47 @@ TelemetrySession::~TelemetrySession() {
     backend = nullptr;
 }
 
+void TelemetrySession::AddSessionMetrics(const PerfStats& perf_stats) {
+    constexpr auto field_type = Telemetry::FieldType::Performance;
+    for (std::size_t i = 0; i < NumSessionHistograms; ++i) {
+        const auto histogram = static_cast<SessionHistogram>(i);
+        const Common::Histogram& values = perf_stats.GetSessionHistogram(histogram);
+        if (values.GetCount() == 0) {
+            continue;
+        }
+        const char* name = GetSessionHistogramName(histogram);
+        const auto add_field = [&](const char* suffix, auto value) {
+            AddField(field_type, fmt::format("Session_{}_{}", name, suffix).c_str(), value);
+        };
+        add_field("Count", values.GetCount());
+        add_field("Sum", values.GetSum());
+        add_field("P50", values.GetPercentile(0.50));
+        add_field("P90", values.GetPercentile(0.90));
+        add_field("P99", values.GetPercentile(0.99));
+        add_field("Max", values.GetMax());
+        add_field("Buckets", values.Serialize());
+    }
+
+    const u64 surface_hits = perf_stats.GetSessionCount(SessionCounter::SurfaceCacheHits);
+    const u64 surface_misses = perf_stats.GetSessionCount(SessionCounter::SurfaceCacheMisses);
+    if (surface_hits + surface_misses != 0) {
+        AddField(field_type, "Session_SurfaceCacheHitRate",
+                 static_cast<double>(surface_hits) * 100.0 /
+                     static_cast<double>(surface_hits + surface_misses));
+    }
+    AddField(field_type, "Session_IpcRequests",
+             perf_stats.GetSessionCount(SessionCounter::IpcRequests));
+
+    for (std::size_t i = 0; i < Common::MemoryAccounting::NumCategories; ++i) {
+        const auto category = static_cast<Common::MemoryAccounting::Category>(i);
+        AddField(field_type,
+                 fmt::format("Session_Memory_{}_PeakBytes",
+                             Common::MemoryAccounting::GetName(category))
+                     .c_str(),
+                 Common::MemoryAccounting::GetPeakBytes(category));
+    }
+}
+
 bool TelemetrySession::SubmitTestcase() {
 #ifdef ENABLE_WEB_SERVICE
     auto backend = std::make_unique<WebService::TelemetryJson>(
@@ -8,8 +8,14 @@
 #include <string>
 #include "common/telemetry.h"
 
+namespace Loader {
+class AppLoader;
+}
+
 namespace Core {
 
+class PerfStats;
+
 /**
  * Instruments telemetry for this emulation session. Creates a new set of telemetry fields on each
  * session, logging any one-time fields. Interfaces with the telemetry backend used for submitting
@@ -20,6 +26,13 @@ public:
     TelemetrySession();
     ~TelemetrySession();
 
+    /**
+     * Adds the one-time fields describing the loaded application. The session is created before
+     * the game files are parsed, so they are added once the loader is available.
+     * @param app_loader Loader of the application of the session.
+     */
+    void AddInitialInfo(Loader::AppLoader& app_loader);
+
     /**
      * Wrapper around the Telemetry::FieldCollection::AddField method.
      * @param type Type of the field to add.
@@ -31,6 +44,12 @@ public:
         field_collection.AddField(type, name, std::move(value));
     }
 
+    /**
+     * Adds the session metrics of the performance statistics as fields: the percentiles of each
+     * histogram, its non-empty buckets and the session counters.
+     */
+    void AddSessionMetrics(const PerfStats& perf_stats);
+
     /**
      * Submits a Testcase.
      * @returns A bool indicating whether the submission succeeded
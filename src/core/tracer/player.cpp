@@ -0,0 +1,150 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include "common/alignment.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/kernel/physical_memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/gpu.h"
+#include "video_core/memory_manager.h"
+
+namespace Tracer {
+
+Player::Player(Core::System& system) : system{system} {}
+
+Player::~Player() = default;
+
+bool Player::Load(const std::string& filename) {
+    return reader.Load(filename);
+}
+
+bool Player::PlayFrame() {
+    Reader::Record record;
+    while (reader.ReadRecord(record)) {
+        if (!ApplyRecord(record)) {
+            LOG_ERROR(Debug_GPU, "Malformed GPU trace record of type {}",
+                      static_cast<u32>(record.type));
+            return false;
+        }
+        if (record.type == RecordType::FrameEnd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Player::ApplyRecord(const Reader::Record& record) {
+    auto& gpu = system.GPU();
+    switch (record.type) {
+    case RecordType::MapBuffer: {
+        MapBufferRecord map;
+        if (record.size != sizeof(map)) {
+            return false;
+        }
+        std::memcpy(&map, record.data, sizeof(map));
+        MapGuestMemory(map.cpu_addr, map.size);
+        gpu.MemoryManager().MapBufferEx(map.cpu_addr, map.gpu_addr, map.size);
+        return true;
+    }
+    case RecordType::UnmapBuffer: {
+        UnmapBufferRecord unmap;
+        if (record.size != sizeof(unmap)) {
+            return false;
+        }
+        std::memcpy(&unmap, record.data, sizeof(unmap));
+        gpu.MemoryManager().UnmapBuffer(unmap.gpu_addr, unmap.size);
+        return true;
+    }
+    case RecordType::MemoryUpdate: {
+        MemoryUpdateRecord update;
+        if (record.size < sizeof(update)) {
+            return false;
+        }
+        std::memcpy(&update, record.data, sizeof(update));
+        const std::size_t size = record.size - sizeof(update);
+        MapGuestMemory(update.cpu_addr, size);
+        Memory::WriteBlock(update.cpu_addr, record.data + sizeof(update), size);
+        return true;
+    }
+    case RecordType::CommandList:
+        return PushCommandList(record.data, record.size);
+    case RecordType::FrameEnd: {
+        // Layers composed on top of the framebuffer are not recorded
+        if (record.size == 0) {
+            gpu.SwapBuffers(std::nullopt);
+            return true;
+        }
+        Tegra::FramebufferConfig framebuffer;
+        if (record.size != sizeof(framebuffer)) {
+            return false;
+        }
+        std::memcpy(&framebuffer, record.data, sizeof(framebuffer));
+        gpu.SwapBuffers(framebuffer);
+        return true;
+    }
+    }
+    return false;
+}
+
+void Player::MapGuestMemory(VAddr cpu_addr, u64 size) {
+    auto& vm_manager = system.CurrentProcess()->VMManager();
+    VAddr addr = Common::AlignDown(cpu_addr, Memory::PAGE_SIZE);
+    const VAddr end = Common::AlignUp(cpu_addr + size, Memory::PAGE_SIZE);
+    while (addr < end) {
+        const auto vma = vm_manager.FindVMA(addr);
+        if (!vm_manager.IsValidHandle(vma)) {
+            LOG_ERROR(Debug_GPU, "Guest memory at 0x{:016X} is out of the address space", addr);
+            return;
+        }
+
+        const VAddr vma_end = std::min<VAddr>(vma->second.EndAddress() + 1, end);
+        if (vma->second.type == Kernel::VMAType::Free) {
+            const u64 block_size = vma_end - addr;
+            vm_manager
+                .MapMemoryBlock(addr, std::make_shared<Kernel::PhysicalMemory>(block_size), 0,
+                                block_size, Kernel::MemoryState::Heap)
+                .Unwrap();
+        }
+        addr = vma_end;
+    }
+}
+
+bool Player::PushCommandList(const u8* data, std::size_t size) {
+    auto& gpu = system.GPU();
+    auto& memory_manager = gpu.MemoryManager();
+
+    Tegra::CommandList entries;
+    while (size != 0) {
+        Tegra::CommandListHeader entry;
+        if (size < sizeof(entry.raw)) {
+            return false;
+        }
+        std::memcpy(&entry.raw, data, sizeof(entry.raw));
+        data += sizeof(entry.raw);
+        size -= sizeof(entry.raw);
+
+        // The pushbuffers are rings, their words are restored before every submission
+        const std::size_t segment_size = entry.size * sizeof(u32);
+        if (size < segment_size) {
+            return false;
+        }
+        memory_manager.WriteBlock(entry.addr, data, segment_size);
+        data += segment_size;
+        size -= segment_size;
+
+        entries.push_back(entry);
+    }
+
+    gpu.PushGPUEntries(std::move(entries));
+    return true;
+}
+
+} // namespace Tracer
@@ -0,0 +1,63 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+#include "core/tracer/reader.h"
+
+namespace Core {
+class System;
+}
+
+namespace Tracer {
+
+/**
+ * Replays a GPU trace on the GPU of a system initialized with Core::System::InitForReplay. The
+ * guest memory referenced by the trace is mapped to the current process as it is needed.
+ */
+class Player {
+public:
+    explicit Player(Core::System& system);
+    ~Player();
+
+    /**
+     * Opens the trace to replay.
+     * @returns false if the file could not be read or is not a valid trace.
+     */
+    bool Load(const std::string& filename);
+
+    /// Returns the header of the loaded trace.
+    const TraceHeader& GetHeader() const {
+        return reader.GetHeader();
+    }
+
+    /**
+     * Submits the records of the next frame of the trace to the GPU, up to and including its
+     * presentation.
+     * @returns false if there are no frames left or the trace is corrupted.
+     */
+    bool PlayFrame();
+
+    /// Moves the player back to the first frame. The GPU state of the last replay is kept.
+    void Rewind() {
+        reader.Rewind();
+    }
+
+private:
+    /// Applies a record, returns false if it is malformed.
+    bool ApplyRecord(const Reader::Record& record);
+
+    /// Maps the pages of the given guest memory range that aren't yet mapped.
+    void MapGuestMemory(VAddr cpu_addr, u64 size);
+
+    /// Writes the pushbuffer words of a recorded command list and submits it.
+    bool PushCommandList(const u8* data, std::size_t size);
+
+    Core::System& system;
+    Reader reader;
+};
+
+} // namespace Tracer
@@ -0,0 +1,99 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/tracer/reader.h"
+
+namespace Tracer {
+
+Reader::Reader() = default;
+
+Reader::~Reader() = default;
+
+bool Reader::Load(const std::string& filename_) {
+    filename = filename_;
+    file = FileUtil::IOFile(filename, "rb");
+    if (!file.IsOpen() || file.GetSize() < sizeof(TraceHeader)) {
+        LOG_ERROR(Debug_GPU, "Failed to open GPU trace {}", filename);
+        return false;
+    }
+
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) || header.magic != TraceMagic) {
+        LOG_ERROR(Debug_GPU, "{} is not a GPU trace", filename);
+        return false;
+    }
+    if (header.version != TraceVersion) {
+        LOG_ERROR(Debug_GPU, "Unsupported GPU trace version {} in {}", header.version, filename);
+        return false;
+    }
+
+    Rewind();
+    return true;
+}
+
+bool Reader::ReadRecord(Record& record) {
+    if (offset == chunk.size() && !ReadChunk()) {
+        return false;
+    }
+
+    RecordHeader record_header;
+    if (chunk.size() - offset < sizeof(record_header)) {
+        LOG_ERROR(Debug_GPU, "GPU trace record header in chunk {} is truncated", chunks_read);
+        return false;
+    }
+    std::memcpy(&record_header, chunk.data() + offset, sizeof(record_header));
+
+    const std::size_t payload_offset = offset + sizeof(record_header);
+    if (chunk.size() - payload_offset < record_header.size) {
+        LOG_ERROR(Debug_GPU, "GPU trace record at offset {} of chunk {} is truncated", offset,
+                  chunks_read);
+        return false;
+    }
+
+    record.type = record_header.type;
+    record.data = chunk.data() + payload_offset;
+    record.size = record_header.size;
+    offset = payload_offset + record_header.size;
+    return true;
+}
+
+void Reader::Rewind() {
+    file.Seek(sizeof(TraceHeader), SEEK_SET);
+    chunks_read = 0;
+    chunk.clear();
+    offset = 0;
+}
+
+bool Reader::ReadChunk() {
+    if (chunks_read == header.num_chunks) {
+        return false;
+    }
+
+    ChunkHeader chunk_header;
+    std::vector<u8> compressed;
+    if (file.ReadBytes(&chunk_header, sizeof(chunk_header)) == sizeof(chunk_header)) {
+        compressed.resize(chunk_header.compressed_size);
+    }
+    if (compressed.empty() ||
+        file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(Debug_GPU, "Failed to read chunk {} of GPU trace {}", chunks_read, filename);
+        return false;
+    }
+
+    chunk = Common::Compression::DecompressDataZSTD(compressed);
+    offset = 0;
+    if (chunk.size() != chunk_header.size) {
+        LOG_ERROR(Debug_GPU, "Chunk {} of GPU trace {} is corrupted", chunks_read, filename);
+        chunk.clear();
+        return false;
+    }
+
+    ++chunks_read;
+    return true;
+}
+
+} // namespace Tracer
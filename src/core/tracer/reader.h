@@ -0,0 +1,65 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/tracer/trace_format.h"
+
+namespace Tracer {
+
+/**
+ * Sequential reader of the records of a GPU trace saved by Tracer::Recorder. The trace is
+ * decompressed a chunk at a time while it is read.
+ */
+class Reader {
+public:
+    struct Record {
+        RecordType type;
+        /// Pointer to the payload of the record, valid until the next record is read
+        const u8* data;
+        std::size_t size;
+    };
+
+    Reader();
+    ~Reader();
+
+    /**
+     * Opens a trace file and reads its header.
+     * @returns false if the file could not be read or is not a valid trace.
+     */
+    bool Load(const std::string& filename);
+
+    /// Returns the header of the loaded trace.
+    const TraceHeader& GetHeader() const {
+        return header;
+    }
+
+    /**
+     * Reads the next record of the trace.
+     * @returns false if there are no records left or the trace is truncated.
+     */
+    bool ReadRecord(Record& record);
+
+    /// Moves the reader back to the first record of the trace.
+    void Rewind();
+
+private:
+    /// Reads and decompresses the next chunk, returns false if there are none left.
+    bool ReadChunk();
+
+    FileUtil::IOFile file;
+    std::string filename;
+    TraceHeader header{};
+    u32 chunks_read = 0;
+
+    /// Decompressed records of the current chunk
+    std::vector<u8> chunk;
+    std::size_t offset = 0;
+};
+
+} // namespace Tracer
@@ -1,208 +1,211 @@
-// Copyright 2015 Citra Emulator Project
+// Copyright 2019 yuzu Emulator Project
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
 #include <cstring>
 #include "common/assert.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/memory.h"
 #include "core/tracer/recorder.h"
+#include "video_core/gpu.h"
+#include "video_core/memory_manager.h"
+
+namespace Tracer {
+
+namespace {
+// Records are buffered up to this size before they are compressed and written as a chunk. Large
+// enough for zstd to find matches across draws, small enough to keep the buffer cheap to hold.
+constexpr std::size_t ChunkSize = 4 * 1024 * 1024;
+} // Anonymous namespace
+
+Recorder::Recorder(const Tegra::MemoryManager& memory_manager, u32 num_frames,
+                   const std::string& filename)
+    : memory_manager{memory_manager}, num_frames{num_frames}, file{filename, "wb"},
+      filename{filename} {
+    if (!file.IsOpen()) {
+        LOG_ERROR(Debug_GPU, "Failed to create GPU trace {}", filename);
+        return;
+    }
+    // The header is written once the trace is finished, its space is reserved for now
+    const TraceHeader header{};
+    has_write_failed = file.WriteObject(header) != 1;
+    chunk.reserve(ChunkSize);
+}
 
-namespace CiTrace {
-
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
-
-void Recorder::Finish(const std::string& filename) {
-    // Setup CiTrace header
-    CTHeader header;
-    std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
-    header.version = CTHeader::ExpectedVersion();
-    header.header_size = sizeof(CTHeader);
-
-    // Calculate file offsets
-    auto& initial = header.initial_state_offsets;
-
-    initial.gpu_registers_size = static_cast<u32>(initial_state.gpu_registers.size());
-    initial.lcd_registers_size = static_cast<u32>(initial_state.lcd_registers.size());
-    initial.pica_registers_size = static_cast<u32>(initial_state.pica_registers.size());
-    initial.default_attributes_size = static_cast<u32>(initial_state.default_attributes.size());
-    initial.vs_program_binary_size = static_cast<u32>(initial_state.vs_program_binary.size());
-    initial.vs_swizzle_data_size = static_cast<u32>(initial_state.vs_swizzle_data.size());
-    initial.vs_float_uniforms_size = static_cast<u32>(initial_state.vs_float_uniforms.size());
-    initial.gs_program_binary_size = static_cast<u32>(initial_state.gs_program_binary.size());
-    initial.gs_swizzle_data_size = static_cast<u32>(initial_state.gs_swizzle_data.size());
-    initial.gs_float_uniforms_size = static_cast<u32>(initial_state.gs_float_uniforms.size());
-    header.stream_size = static_cast<u32>(stream.size());
-
-    initial.gpu_registers = sizeof(header);
-    initial.lcd_registers = initial.gpu_registers + initial.gpu_registers_size * sizeof(u32);
-    initial.pica_registers = initial.lcd_registers + initial.lcd_registers_size * sizeof(u32);
-    ;
-    initial.default_attributes = initial.pica_registers + initial.pica_registers_size * sizeof(u32);
-    initial.vs_program_binary =
-        initial.default_attributes + initial.default_attributes_size * sizeof(u32);
-    initial.vs_swizzle_data =
-        initial.vs_program_binary + initial.vs_program_binary_size * sizeof(u32);
-    initial.vs_float_uniforms =
-        initial.vs_swizzle_data + initial.vs_swizzle_data_size * sizeof(u32);
-    initial.gs_program_binary =
-        initial.vs_float_uniforms + initial.vs_float_uniforms_size * sizeof(u32);
-    initial.gs_swizzle_data =
-        initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
-    initial.gs_float_uniforms =
-        initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
-
-    // Iterate through stream elements, update relevant stream element data
-    for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
-            }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
-        }
+Recorder::~Recorder() {
+    if (file.IsOpen()) {
+        LOG_WARNING(Debug_GPU, "GPU trace {} was stopped after {} of {} frames", filename,
+                    recorded_frames, num_frames);
+        Finish();
+    }
+}
 
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
+void Recorder::MapBuffer(GPUVAddr gpu_addr, VAddr cpu_addr, u64 size) {
+    mappings.insert_or_assign(gpu_addr, Mapping{cpu_addr, size});
+
+    MapBufferRecord record{};
+    record.gpu_addr = gpu_addr;
+    record.cpu_addr = cpu_addr;
+    record.size = size;
+    std::memcpy(AppendRecord(RecordType::MapBuffer, sizeof(record)), &record, sizeof(record));
+}
+
+void Recorder::UnmapBuffer(GPUVAddr gpu_addr, u64 size) {
+    mappings.erase(mappings.lower_bound(gpu_addr), mappings.lower_bound(gpu_addr + size));
+
+    UnmapBufferRecord record{};
+    record.gpu_addr = gpu_addr;
+    record.size = size;
+    std::memcpy(AppendRecord(RecordType::UnmapBuffer, sizeof(record)), &record, sizeof(record));
+}
+
+void Recorder::PushCommandList(const Tegra::CommandList& entries) {
+    if (frame_start) {
+        CaptureMemory();
+        frame_start = false;
     }
 
-    try {
-        // Open file and write header
-        FileUtil::IOFile file(filename, "wb");
-        std::size_t written = file.WriteObject(header);
-        if (written != 1 || file.Tell() != initial.gpu_registers)
-            throw "Failed to write header";
-
-        // Write initial state
-        written =
-            file.WriteArray(initial_state.gpu_registers.data(), initial_state.gpu_registers.size());
-        if (written != initial_state.gpu_registers.size() || file.Tell() != initial.lcd_registers)
-            throw "Failed to write GPU registers";
-
-        written =
-            file.WriteArray(initial_state.lcd_registers.data(), initial_state.lcd_registers.size());
-        if (written != initial_state.lcd_registers.size() || file.Tell() != initial.pica_registers)
-            throw "Failed to write LCD registers";
-
-        written = file.WriteArray(initial_state.pica_registers.data(),
-                                  initial_state.pica_registers.size());
-        if (written != initial_state.pica_registers.size() ||
-            file.Tell() != initial.default_attributes)
-            throw "Failed to write Pica registers";
-
-        written = file.WriteArray(initial_state.default_attributes.data(),
-                                  initial_state.default_attributes.size());
-        if (written != initial_state.default_attributes.size() ||
-            file.Tell() != initial.vs_program_binary)
-            throw "Failed to write default vertex attributes";
-
-        written = file.WriteArray(initial_state.vs_program_binary.data(),
-                                  initial_state.vs_program_binary.size());
-        if (written != initial_state.vs_program_binary.size() ||
-            file.Tell() != initial.vs_swizzle_data)
-            throw "Failed to write vertex shader program binary";
-
-        written = file.WriteArray(initial_state.vs_swizzle_data.data(),
-                                  initial_state.vs_swizzle_data.size());
-        if (written != initial_state.vs_swizzle_data.size() ||
-            file.Tell() != initial.vs_float_uniforms)
-            throw "Failed to write vertex shader swizzle data";
-
-        written = file.WriteArray(initial_state.vs_float_uniforms.data(),
-                                  initial_state.vs_float_uniforms.size());
-        if (written != initial_state.vs_float_uniforms.size() ||
-            file.Tell() != initial.gs_program_binary)
-            throw "Failed to write vertex shader float uniforms";
-
-        written = file.WriteArray(initial_state.gs_program_binary.data(),
-                                  initial_state.gs_program_binary.size());
-        if (written != initial_state.gs_program_binary.size() ||
-            file.Tell() != initial.gs_swizzle_data)
-            throw "Failed to write geomtry shader program binary";
-
-        written = file.WriteArray(initial_state.gs_swizzle_data.data(),
-                                  initial_state.gs_swizzle_data.size());
-        if (written != initial_state.gs_swizzle_data.size() ||
-            file.Tell() != initial.gs_float_uniforms)
-            throw "Failed to write geometry shader swizzle data";
-
-        written = file.WriteArray(initial_state.gs_float_uniforms.data(),
-                                  initial_state.gs_float_uniforms.size());
-        if (written != initial_state.gs_float_uniforms.size() ||
-            file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
-            throw "Failed to write geometry shader float uniforms";
-
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
+    std::size_t payload_size = 0;
+    for (const Tegra::CommandListHeader& entry : entries) {
+        payload_size += sizeof(u64) + entry.size * sizeof(u32);
+    }
 
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
-        }
+    // The pushbuffers are usually rings reused by later submissions, so their contents are stored
+    // along with the command list instead of relying on the per-frame memory capture.
+    u8* payload = AppendRecord(RecordType::CommandList, payload_size);
+    for (const Tegra::CommandListHeader& entry : entries) {
+        std::memcpy(payload, &entry.raw, sizeof(u64));
+        payload += sizeof(u64);
 
-        if (file.Tell() != header.stream_offset)
-            throw "Unexpected end of extra data";
+        const std::size_t segment_size = entry.size * sizeof(u32);
+        memory_manager.ReadBlock(entry.addr, payload, segment_size);
+        payload += segment_size;
+    }
+}
 
-        // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
-        }
-    } catch (const char* str) {
-        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+bool Recorder::FrameFinished(const Tegra::FramebufferConfig* framebuffer) {
+    if (framebuffer) {
+        std::memcpy(AppendRecord(RecordType::FrameEnd, sizeof(*framebuffer)), framebuffer,
+                    sizeof(*framebuffer));
+    } else {
+        AppendRecord(RecordType::FrameEnd, 0);
     }
+    frame_start = true;
+    return ++recorded_frames >= num_frames;
 }
 
-void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+bool Recorder::Finish() {
+    WriteChunk();
+
+    TraceHeader header{};
+    header.magic = TraceMagic;
+    header.version = TraceVersion;
+    header.num_frames = recorded_frames;
+    header.num_chunks = num_chunks;
+    header.stream_size = stream_size;
+
+    const u64 file_size = file.Tell();
+    if (has_write_failed || !file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1 ||
+        !file.Close()) {
+        LOG_ERROR(Debug_GPU, "Failed to write GPU trace to {}", filename);
+        file.Close();
+        return false;
+    }
+
+    LOG_INFO(Debug_GPU, "Saved GPU trace of {} frames to {} ({} bytes, {} uncompressed)",
+             recorded_frames, filename, file_size, stream_size);
+    return true;
 }
 
-void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
-    StreamElement element = {{MemoryLoad}};
-    element.data.memory_load.size = size;
-    element.data.memory_load.physical_address = physical_address;
-
-    // Compute hash over given memory region to check if the contents are already stored internally
-    boost::crc_32_type result;
-    result.process_bytes(data, size);
-    element.hash = result.checksum();
-
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
-    if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
+u8* Recorder::AppendRecord(RecordType type, std::size_t payload_size) {
+    ASSERT(payload_size <= UINT32_MAX - sizeof(RecordHeader));
+
+    const std::size_t record_size = sizeof(RecordHeader) + payload_size;
+    if (!chunk.empty() && chunk.size() + record_size > ChunkSize) {
+        WriteChunk();
+    }
+
+    RecordHeader header{};
+    header.type = type;
+    header.size = static_cast<u32>(payload_size);
+
+    const std::size_t offset = chunk.size();
+    chunk.resize(offset + record_size);
+    std::memcpy(chunk.data() + offset, &header, sizeof(header));
+    return chunk.data() + offset + sizeof(header);
+}
+
+void Recorder::WriteChunk() {
+    if (chunk.empty()) {
+        return;
+    }
+
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(chunk.data(), chunk.size());
+
+    ChunkHeader header{};
+    header.compressed_size = static_cast<u32>(compressed.size());
+    header.size = static_cast<u32>(chunk.size());
+    if (!has_write_failed &&
+        (compressed.empty() || file.WriteObject(header) != 1 ||
+         file.WriteBytes(compressed.data(), compressed.size()) != compressed.size())) {
+        LOG_ERROR(Debug_GPU, "Failed to write a chunk of GPU trace {}", filename);
+        has_write_failed = true;
     }
 
-    stream.push_back(element);
+    ++num_chunks;
+    stream_size += chunk.size();
+    chunk.clear();
 }
 
-template <typename T>
-void Recorder::RegisterWritten(u32 physical_address, T value) {
-    StreamElement element = {{RegisterWrite}};
-    element.data.register_write.size =
-        (sizeof(T) == 1) ? CTRegisterWrite::SIZE_8
-                         : (sizeof(T) == 2) ? CTRegisterWrite::SIZE_16
-                                            : (sizeof(T) == 4) ? CTRegisterWrite::SIZE_32
-                                                               : CTRegisterWrite::SIZE_64;
-    element.data.register_write.physical_address = physical_address;
-    element.data.register_write.value = value;
-
-    stream.push_back(element);
+void Recorder::CaptureMemory() {
+    // Runs of changed pages are emitted as a single record
+    VAddr run_start = 0;
+    std::vector<u8> run_data;
+
+    const auto flush_run = [&] {
+        if (run_data.empty()) {
+            return;
+        }
+        MemoryUpdateRecord record{};
+        record.cpu_addr = run_start;
+        u8* payload = AppendRecord(RecordType::MemoryUpdate, sizeof(record) + run_data.size());
+        std::memcpy(payload, &record, sizeof(record));
+        std::memcpy(payload + sizeof(record), run_data.data(), run_data.size());
+        run_data.clear();
+    };
+
+    for (const auto& [gpu_addr, mapping] : mappings) {
+        const VAddr start = mapping.cpu_addr & ~Memory::PAGE_MASK;
+        const VAddr end = mapping.cpu_addr + mapping.size;
+        for (VAddr page = start; page < end; page += Memory::PAGE_SIZE) {
+            if (!Memory::IsValidVirtualAddress(page)) {
+                flush_run();
+                continue;
+            }
+
+            const u8* const pointer = Memory::GetPointer(page);
+            const u64 hash = Common::ComputeHash64(pointer, Memory::PAGE_SIZE);
+            const auto [it, inserted] = page_hashes.try_emplace(page, hash);
+            if (!inserted && it->second == hash) {
+                flush_run();
+                continue;
+            }
+            it->second = hash;
+
+            if (run_start + run_data.size() != page) {
+                flush_run();
+            }
+            if (run_data.empty()) {
+                run_start = page;
+            }
+            run_data.insert(run_data.end(), pointer, pointer + Memory::PAGE_SIZE);
+        }
+    }
+    flush_run();
 }
 
-template void Recorder::RegisterWritten(u32, u8);
-template void Recorder::RegisterWritten(u32, u16);
-template void Recorder::RegisterWritten(u32, u32);
-template void Recorder::RegisterWritten(u32, u64);
-} // namespace CiTrace
+} // namespace Tracer
@@ -1,87 +1,106 @@
-// Copyright 2015 Citra Emulator Project
+// Copyright 2019 yuzu Emulator Project
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
 #pragma once
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <boost/crc.hpp>
 #include "common/common_types.h"
-#include "core/tracer/citrace.h"
-
-namespace CiTrace {
-
+#include "common/file_util.h"
+#include "core/tracer/trace_format.h"
+#include "video_core/dma_pusher.h"
+
+namespace Tegra {
+struct FramebufferConfig;
+class MemoryManager;
+} // namespace Tegra
+
+namespace Tracer {
+
+/**
+ * Records the command lists submitted to the GPU, its memory mappings and the guest memory they
+ * reference for a fixed amount of frames. The records are compressed and written to the trace file
+ * in chunks as they are made. All the methods have to be called from the thread that submits work
+ * to the GPU.
+ */
 class Recorder {
 public:
-    struct InitialState {
-        std::vector<u32> gpu_registers;
-        std::vector<u32> lcd_registers;
-        std::vector<u32> pica_registers;
-        std::vector<u32> default_attributes;
-        std::vector<u32> vs_program_binary;
-        std::vector<u32> vs_swizzle_data;
-        std::vector<u32> vs_float_uniforms;
-        std::vector<u32> gs_program_binary;
-        std::vector<u32> gs_swizzle_data;
-        std::vector<u32> gs_float_uniforms;
-    };
-
     /**
      * Recorder constructor
-     * @param initial_state Initial recorder state
+     * @param memory_manager GPU memory manager the command lists are read from
+     * @param num_frames Number of frames to record
+     * @param filename Path of the trace file, created by the constructor
      */
-    explicit Recorder(const InitialState& initial_state);
+    explicit Recorder(const Tegra::MemoryManager& memory_manager, u32 num_frames,
+                      const std::string& filename);
 
-    /// Finish recording of this Citrace and save it using the given filename.
-    void Finish(const std::string& filename);
+    /// Finishes the trace if it is still being recorded, keeping the frames recorded so far.
+    ~Recorder();
 
-    /// Mark end of a frame
-    void FrameFinished();
+    /// Returns true if the trace file could be created.
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
 
-    /**
-     * Store a copy of the given memory range in the recording.
-     * @note Use this whenever the GPU is about to access a particular memory region.
-     * @note The implementation will make sure to minimize redundant memory updates.
-     */
-    void MemoryAccessed(const u8* data, u32 size, u32 physical_address);
+    /// Records a mapping of guest memory into the GPU address space.
+    void MapBuffer(GPUVAddr gpu_addr, VAddr cpu_addr, u64 size);
+
+    /// Records the removal of a GPU address space mapping.
+    void UnmapBuffer(GPUVAddr gpu_addr, u64 size);
+
+    /// Records a command list and the contents of the pushbuffer segments it references.
+    void PushCommandList(const Tegra::CommandList& entries);
 
     /**
-     * Record a register write.
-     * @note Use this whenever a GPU-related MMIO register has been written to.
+     * Marks the end of a frame.
+     * @param framebuffer The presented framebuffer, or nullptr if nothing was presented.
+     * @returns true if the requested amount of frames has been recorded.
      */
-    template <typename T>
-    void RegisterWritten(u32 physical_address, T value);
+    bool FrameFinished(const Tegra::FramebufferConfig* framebuffer);
+
+    /// Writes the buffered records and the header of the trace, then closes its file.
+    bool Finish();
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
+    struct Mapping {
+        VAddr cpu_addr;
+        u64 size;
+    };
 
-    // Command stream
-    struct StreamElement {
-        CTStreamElement data;
+    /// Appends a record to the chunk, returning a pointer to its zero-initialized payload.
+    u8* AppendRecord(RecordType type, std::size_t payload_size);
 
-        /**
-         * Extra data to store along "core" data.
-         * This is e.g. used for data used in MemoryUpdates.
-         */
-        std::vector<u8> extra_data;
+    /// Compresses the buffered records and writes them to the trace file as a chunk.
+    void WriteChunk();
 
-        /// Optional CRC hash (e.g. for hashing memory regions)
-        boost::crc_32_type::value_type hash;
+    /// Captures the mapped guest memory pages that changed since they were last captured.
+    void CaptureMemory();
 
-        /// If true, refer to data already written to the output file instead of extra_data
-        bool uses_existing_data;
-    };
+    const Tegra::MemoryManager& memory_manager;
+    const u32 num_frames;
+    u32 recorded_frames = 0;
 
-    std::vector<StreamElement> stream;
+    /// When true, the next command list is the first one of a frame
+    bool frame_start = true;
 
-    /**
-     * Internal cache which maps hashes of memory contents to file offsets at which those memory
-     * contents are stored.
-     */
-    std::unordered_map<boost::crc_32_type::value_type /*hash*/, u32 /*file_offset*/> memory_regions;
+    /// Mappings of the GPU address space, indexed by their GPU address
+    std::map<GPUVAddr, Mapping> mappings;
+
+    /// Hashes of the guest memory pages at the time they were last captured
+    std::unordered_map<VAddr, u64> page_hashes;
+
+    /// Trace file, closed once the trace is finished
+    FileUtil::IOFile file;
+    std::string filename;
+    u32 num_chunks = 0;
+    u64 stream_size = 0;
+    bool has_write_failed = false;
+
+    /// Uncompressed records of the chunk being built
+    std::vector<u8> chunk;
 };
 
-} // namespace CiTrace
+} // namespace Tracer
@@ -0,0 +1,92 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/swap.h"
+
+namespace Tracer {
+
+/*
+ * GPU trace file layout:
+ *
+ *   TraceHeader
+ *   Chunks until the end of the file, each one a ChunkHeader followed by zstd compressed records
+ *
+ * Every record is a RecordHeader followed by its payload, records never span two chunks. The
+ * recorder writes a chunk whenever enough records are buffered, so a trace is never held in
+ * memory as a whole.
+ *
+ * The records contain, in submission order, the GPU memory mappings, the command lists with the
+ * pushbuffer words they reference and the guest memory pages that changed since they were last
+ * captured. Memory is captured before the first submission of every frame, which makes the
+ * trace self-contained: a player that applies the records in order reproduces the GPU state of
+ * the recorded frames without booting the title.
+ */
+
+constexpr u32 TraceMagic = Common::MakeMagic('Y', 'G', 'T', 'R');
+constexpr u32 TraceVersion = 2;
+
+struct TraceHeader {
+    u32_le magic;
+    u32_le version;
+    /// Number of frames captured in the trace
+    u32_le num_frames;
+    /// Number of chunks following the header
+    u32_le num_chunks;
+    /// Size of all the records once decompressed
+    u64_le stream_size;
+};
+static_assert(sizeof(TraceHeader) == 0x18, "TraceHeader has incorrect size.");
+
+struct ChunkHeader {
+    /// Size of the zstd compressed data following the header
+    u32_le compressed_size;
+    /// Size of the records of the chunk once decompressed
+    u32_le size;
+};
+static_assert(sizeof(ChunkHeader) == 0x8, "ChunkHeader has incorrect size.");
+
+enum class RecordType : u32 {
+    /// A GPU virtual address range was mapped to guest memory. Payload: MapBufferRecord.
+    MapBuffer = 0,
+    /// A GPU virtual address range was unmapped. Payload: UnmapBufferRecord.
+    UnmapBuffer = 1,
+    /// Contents of guest memory. Payload: MemoryUpdateRecord followed by the memory contents.
+    MemoryUpdate = 2,
+    /// A submitted command list. Payload: for every entry, its raw CommandListHeader followed
+    /// by the pushbuffer words of its segment.
+    CommandList = 3,
+    /// A frame was presented. Payload: the presented Tegra::FramebufferConfig, if any.
+    FrameEnd = 4,
+};
+
+struct RecordHeader {
+    RecordType type;
+    /// Size of the payload following the header, in bytes
+    u32_le size;
+};
+static_assert(sizeof(RecordHeader) == 0x8, "RecordHeader has incorrect size.");
+
+struct MapBufferRecord {
+    u64_le gpu_addr;
+    u64_le cpu_addr;
+    u64_le size;
+};
+static_assert(sizeof(MapBufferRecord) == 0x18, "MapBufferRecord has incorrect size.");
+
+struct UnmapBufferRecord {
+    u64_le gpu_addr;
+    u64_le size;
+};
+static_assert(sizeof(UnmapBufferRecord) == 0x10, "UnmapBufferRecord has incorrect size.");
+
+struct MemoryUpdateRecord {
+    u64_le cpu_addr;
+};
+static_assert(sizeof(MemoryUpdateRecord) == 0x8, "MemoryUpdateRecord has incorrect size.");
+
+} // namespace Tracer
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <functional>
@@ -27,6 +28,9 @@ namespace InputCommon {
 
 namespace SDL {
 
+/// Longest time the event thread waits for an event before checking whether it should stop
+constexpr int poll_timeout_ms = 100;
+
 static std::string GetGUID(SDL_Joystick* joystick) {
     SDL_JoystickGUID guid = SDL_JoystickGetGUID(joystick);
     char guid_str[33];
@@ -55,23 +59,36 @@ public:
         : guid{std::move(guid_)}, port{port_}, sdl_joystick{joystick, deleter} {}
 
     void SetButton(int button, bool value) {
-        std::lock_guard lock{mutex};
-        state.buttons[button] = value;
+        if (button < 0 || button >= MaxButtons) {
+            return;
+        }
+        const u64 mask = u64{1} << button;
+        if (value) {
+            state.buttons.fetch_or(mask, std::memory_order_relaxed);
+        } else {
+            state.buttons.fetch_and(~mask, std::memory_order_relaxed);
+        }
     }
 
     bool GetButton(int button) const {
-        std::lock_guard lock{mutex};
-        return state.buttons.at(button);
+        if (button < 0 || button >= MaxButtons) {
+            return false;
+        }
+        return (state.buttons.load(std::memory_order_relaxed) >> button) & 1;
     }
 
     void SetAxis(int axis, Sint16 value) {
-        std::lock_guard lock{mutex};
-        state.axes[axis] = value;
+        if (axis < 0 || axis >= MaxAxes) {
+            return;
+        }
+        state.axes[axis].store(value, std::memory_order_relaxed);
     }
 
     float GetAxis(int axis) const {
-        std::lock_guard lock{mutex};
-        return state.axes.at(axis) / 32767.0f;
+        if (axis < 0 || axis >= MaxAxes) {
+            return 0.0f;
+        }
+        return state.axes[axis].load(std::memory_order_relaxed) / 32767.0f;
     }
 
     std::tuple<float, float> GetAnalog(int axis_x, int axis_y) const {
@@ -92,14 +109,19 @@ public:
     }
 
     void SetHat(int hat, Uint8 direction) {
-        std::lock_guard lock{mutex};
-        state.hats[hat] = direction;
+        if (hat < 0 || hat >= MaxHats) {
+            return;
+        }
+        state.hats[hat].store(direction, std::memory_order_relaxed);
     }
 
     bool GetHatDirection(int hat, Uint8 direction) const {
-        std::lock_guard lock{mutex};
-        return (state.hats.at(hat) & direction) != 0;
+        if (hat < 0 || hat >= MaxHats) {
+            return false;
+        }
+        return (state.hats[hat].load(std::memory_order_relaxed) & direction) != 0;
     }
+
     /**
      * The guid of the joystick
      */
@@ -125,15 +147,20 @@ public:
     }
 
 private:
+    static constexpr int MaxButtons = 64;
+    static constexpr int MaxAxes = 32;
+    static constexpr int MaxHats = 8;
+
+    /// Written by the SDL event thread and read by the emulated controllers without locking. Inputs
+    /// beyond the limits are ignored and read as released.
     struct State {
-        std::unordered_map<int, bool> buttons;
-        std::unordered_map<int, Sint16> axes;
-        std::unordered_map<int, Uint8> hats;
+        std::atomic<u64> buttons{0};
+        std::array<std::atomic<Sint16>, MaxAxes> axes{};
+        std::array<std::atomic<Uint8>, MaxHats> hats{};
     } state;
     std::string guid;
     int port;
     std::unique_ptr<SDL_Joystick, decltype(&SDL_JoystickClose)> sdl_joystick;
-    mutable std::mutex mutex;
 };
 
 /**
@@ -478,10 +505,15 @@ SDLState::SDLState() {
     initialized = true;
     if (start_thread) {
         poll_thread = std::thread([this] {
-            using namespace std::chrono_literals;
+            // The event watcher handles the events as SDL pumps them, they are only drained from
+            // the queue here. Waiting wakes up as soon as an event arrives instead of sleeping.
+            SDL_Event event;
             while (initialized) {
-                SDL_PumpEvents();
-                std::this_thread::sleep_for(10ms);
+                if (SDL_WaitEventTimeout(&event, poll_timeout_ms) == 0) {
+                    continue;
+                }
+                while (SDL_PollEvent(&event)) {
+                }
             }
         });
     }
@@ -502,6 +534,10 @@ SDLState::~SDLState() {
 
     initialized = false;
     if (start_thread) {
+        // Wake the event thread up instead of waiting for its timeout
+        SDL_Event wake_event{};
+        wake_event.type = SDL_USEREVENT;
+        SDL_PushEvent(&wake_event);
         poll_thread.join();
         SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
     }
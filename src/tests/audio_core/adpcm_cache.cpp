@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "audio_core/adpcm_cache.h"
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+
+namespace {
+
+constexpr AudioCore::Codec::ADPCM_Coeff COEFFS{
+    {0x04ab, -0x01f1, 0x0789, -0x0326, 0x0470, -0x0155, 0x050f, -0x0281, 0x0555, -0x013e, 0x07d4,
+     -0x0485, 0x0e0b, -0x0245, 0x0739, -0x02e1}};
+
+std::vector<u8> MakeFrames(std::size_t count, u8 seed) {
+    std::vector<u8> data(count * 8);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 37 + seed);
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ADPCMCache[Decode]", "[audio_core]") {
+    AudioCore::ADPCMCache cache;
+    auto data = MakeFrames(16, 3);
+
+    AudioCore::Codec::ADPCMState reference_state{};
+    const auto reference = AudioCore::Codec::DecodeADPCM(data.data(), data.size(), COEFFS,
+                                                         reference_state);
+    REQUIRE(reference.size() == 16 * 14);
+
+    // A cached buffer gives the same samples and end state as decoding it again
+    for (int i = 0; i < 2; ++i) {
+        AudioCore::Codec::ADPCMState state{};
+        REQUIRE(cache.Decode(0x1000, data.data(), data.size(), COEFFS, state) == reference);
+        REQUIRE(state.yn1 == reference_state.yn1);
+        REQUIRE(state.yn2 == reference_state.yn2);
+    }
+
+    // Continuing from another state or changing the data decodes the buffer again
+    AudioCore::Codec::ADPCMState state = reference_state;
+    AudioCore::Codec::ADPCMState expected_state = reference_state;
+    REQUIRE(cache.Decode(0x1000, data.data(), data.size(), COEFFS, state) ==
+            AudioCore::Codec::DecodeADPCM(data.data(), data.size(), COEFFS, expected_state));
+    REQUIRE(state.yn1 == expected_state.yn1);
+
+    data[9] ^= 0xff;
+    state = {};
+    expected_state = {};
+    REQUIRE(cache.Decode(0x1000, data.data(), data.size(), COEFFS, state) ==
+            AudioCore::Codec::DecodeADPCM(data.data(), data.size(), COEFFS, expected_state));
+
+    cache.Invalidate(0x1000, 8);
+    state = {};
+    REQUIRE(cache.Decode(0x1000, data.data(), data.size(), COEFFS, state).size() == 16 * 14);
+}
@@ -0,0 +1,84 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "audio_core/algorithm/effects.h"
+#include "audio_core/algorithm/filter.h"
+
+namespace {
+
+double Energy(const std::vector<float>& samples, std::size_t begin, std::size_t end) {
+    double energy = 0.0;
+    for (std::size_t i = begin; i < end; ++i) {
+        energy += samples[i] * samples[i];
+    }
+    return energy;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DelayEffect[Echo]", "[audio_core]") {
+    AudioCore::DelayEffect effect;
+    effect.Configure({1000, 100, 1.0f, 0.5f, 1.0f, 1.0f, 0.0f});
+
+    // An impulse echoes every delay, halved by the feedback each time, across block boundaries
+    std::vector<float> samples(350);
+    samples[0] = 1.0f;
+    effect.Process(0, samples.data(), 64);
+    effect.Process(0, samples.data() + 64, samples.size() - 64);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const float expected = i % 100 == 0 ? std::pow(0.5f, i / 100.0f - 1.0f) : 0.0f;
+        REQUIRE(samples[i] == Approx(i == 0 ? 1.0f : expected));
+    }
+
+    // The channels have their own delay lines
+    std::vector<float> other(200);
+    effect.Process(1, other.data(), other.size());
+    REQUIRE(Energy(other, 0, other.size()) == 0.0);
+}
+
+TEST_CASE("ReverbEffect[Decay]", "[audio_core]") {
+    AudioCore::ReverbEffect effect;
+    effect.Configure(48000, {480, 1.0f, 1.0f, 0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f});
+
+    std::vector<float> samples(48000);
+    samples[0] = 1.0f;
+    effect.Process(0, samples.data(), samples.size());
+
+    // The early reflection is the pre-delayed input, the late reverberation then fades away
+    REQUIRE(samples[0] == 0.0f);
+    REQUIRE(samples[480] == Approx(1.0f));
+    const double early_tail = Energy(samples, 481, 12000);
+    const double late_tail = Energy(samples, 36000, 48000);
+    REQUIRE(early_tail > 0.0);
+    REQUIRE(late_tail < early_tail * 1e-3);
+}
+
+TEST_CASE("Filter[ProcessFloat]", "[audio_core]") {
+    auto filter = AudioCore::Filter::LowPass(0.1);
+    auto reference = filter;
+
+    std::vector<s16> interleaved(256);
+    std::vector<float> left(128);
+    std::vector<float> right(128);
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<float>((i * 2654435761u) % 2000) - 1000.0f;
+        right[i] = static_cast<float>((i * 40503u) % 2000) - 1000.0f;
+        interleaved[i * 2] = static_cast<s16>(left[i]);
+        interleaved[i * 2 + 1] = static_cast<s16>(right[i]);
+    }
+
+    // The planar float path filters like the interleaved PCM16 one, before its rounding
+    filter.Process(left.data(), right.data(), 64);
+    filter.Process(left.data() + 64, right.data() + 64, 64);
+    reference.Process(interleaved);
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        REQUIRE(std::abs(left[i] - interleaved[i * 2]) <= 1.0f);
+        REQUIRE(std::abs(right[i] - interleaved[i * 2 + 1]) <= 1.0f);
+    }
+}
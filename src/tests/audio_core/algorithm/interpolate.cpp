@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "audio_core/algorithm/interpolate.h"
+#include "common/common_types.h"
+
+namespace {
+
+std::vector<s16> MakeRamp(std::size_t num_frames, s16 step) {
+    std::vector<s16> frames(num_frames * 2);
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        frames[i * 2] = static_cast<s16>(i * step);
+        frames[i * 2 + 1] = static_cast<s16>(-static_cast<s16>(i * step));
+    }
+    return frames;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Interpolate[Linear]", "[audio_core]") {
+    AudioCore::InterpolationState state;
+    auto input = MakeRamp(20, 100);
+    std::vector<s16> output;
+    AudioCore::Interpolate(state, input, output, 0.5, AudioCore::ResamplingQuality::Linear);
+
+    // The output lags the input by three frames, doubling the rate adds the midpoints
+    REQUIRE(output.size() == 82);
+    for (std::size_t i = 8; i < output.size() / 2; ++i) {
+        REQUIRE(output[i * 2] == static_cast<s16>((i - 6) * 50));
+        REQUIRE(output[i * 2 + 1] == -output[i * 2]);
+    }
+}
+
+TEST_CASE("Interpolate[Streaming]", "[audio_core]") {
+    // Interpolating the input in pieces gives the same signal as interpolating it at once
+    for (const auto quality : {AudioCore::ResamplingQuality::Linear,
+                               AudioCore::ResamplingQuality::Cubic,
+                               AudioCore::ResamplingQuality::Sinc}) {
+        AudioCore::InterpolationState whole_state;
+        auto whole = MakeRamp(64, 300);
+        std::vector<s16> expected;
+        AudioCore::Interpolate(whole_state, whole, expected, 44100, 48000, quality);
+
+        AudioCore::InterpolationState state;
+        std::vector<s16> output;
+        std::vector<s16> piece;
+        const auto input = MakeRamp(64, 300);
+        for (std::size_t offset = 0; offset < input.size(); offset += 24) {
+            const auto end = input.begin() + std::min<std::size_t>(offset + 24, input.size());
+            std::vector<s16> part(input.begin() + offset, end);
+            AudioCore::Interpolate(state, part, piece, 44100, 48000, quality);
+            output.insert(output.end(), piece.begin(), piece.end());
+        }
+        REQUIRE(output == expected);
+    }
+}
@@ -0,0 +1,35 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "audio_core/algorithm/mix.h"
+#include "common/common_types.h"
+
+TEST_CASE("Mix[Accumulate]", "[audio_core]") {
+    // The sizes are not multiples of the vector width, so the scalar tail is covered as well
+    std::vector<s16> samples(37);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<s16>(i * 1000 - 18000);
+    }
+
+    std::vector<float> mix(samples.size(), 1.0f);
+    AudioCore::AccumulateSamples(mix.data(), samples.data(), samples.size(), 0.5f);
+    AudioCore::AccumulateSamples(mix.data(), samples.data(), samples.size(), 2.0f);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        REQUIRE(mix[i] == 1.0f + samples[i] * 2.5f);
+    }
+}
+
+TEST_CASE("Mix[ConvertToS16]", "[audio_core]") {
+    const std::vector<float> mix{0.0f,   1.4f,     -1.6f, 40000.0f,  -40000.0f, 3e10f,
+                                 -3e10f, 32767.0f, 2.5f,  -32768.0f, 100.0f};
+    const std::vector<s16> expected{0, 1, -2, 32767, -32768, 32767, -32768, 32767, 2, -32768, 100};
+
+    std::vector<s16> output(mix.size());
+    AudioCore::ConvertToS16(output.data(), mix.data(), mix.size());
+    REQUIRE(output == expected);
+}
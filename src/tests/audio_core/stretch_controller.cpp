@@ -0,0 +1,51 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include "audio_core/stretch_controller.h"
+
+namespace {
+
+constexpr u32 SAMPLE_RATE = 48000;
+constexpr std::size_t READ_FRAMES = 480;
+
+} // Anonymous namespace
+
+TEST_CASE("StretchController[Engage]", "[audio_core]") {
+    AudioCore::StretchController controller{SAMPLE_RATE};
+
+    // The emulation keeps up, the queue stays at 100ms
+    for (int i = 0; i < 500; ++i) {
+        REQUIRE(!controller.ShouldEngage(4800, READ_FRAMES));
+    }
+
+    // The emulation runs at 80% speed, stretching starts before the queue runs dry
+    std::size_t queued = 4800;
+    bool engaged = false;
+    while (!engaged && queued >= READ_FRAMES) {
+        engaged = controller.ShouldEngage(queued, READ_FRAMES);
+        queued -= READ_FRAMES / 5;
+    }
+    REQUIRE(engaged);
+    REQUIRE(queued > READ_FRAMES);
+
+    // An underrun always engages
+    AudioCore::StretchController empty_controller{SAMPLE_RATE};
+    REQUIRE(empty_controller.ShouldEngage(READ_FRAMES - 1, READ_FRAMES));
+}
+
+TEST_CASE("StretchController[Disengage]", "[audio_core]") {
+    AudioCore::StretchController controller{SAMPLE_RATE};
+
+    // Two seconds at full speed are needed, a slower tempo starts over
+    for (int i = 0; i < 150; ++i) {
+        REQUIRE(!controller.ShouldDisengage(1.0, READ_FRAMES));
+    }
+    REQUIRE(!controller.ShouldDisengage(0.9, READ_FRAMES));
+    for (int i = 0; i < 199; ++i) {
+        REQUIRE(!controller.ShouldDisengage(1.01, READ_FRAMES));
+    }
+    REQUIRE(controller.ShouldDisengage(1.0, READ_FRAMES));
+}
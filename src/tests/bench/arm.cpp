@@ -0,0 +1,251 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Execution speed of the CPU backends. Every workload loops forever and counts its iterations in
+// X28, the executed guest instructions are derived from the count so the backends are compared
+// on the same work whatever the length of their slices.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#endif
+#include "core/arm/unicorn/arm_unicorn.h"
+#include "core/core.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "tests/bench/bench.h"
+#include "tests/bench/guest_memory.h"
+
+namespace {
+
+using Bench::GUEST_MEMORY_BASE;
+using Bench::GUEST_MEMORY_SIZE;
+using Bench::GuestMemory;
+
+/// The workloads run from the start of the guest memory, X1 points to their data after the code
+constexpr VAddr CODE_ADDRESS = GUEST_MEMORY_BASE;
+constexpr VAddr DATA_ADDRESS = GUEST_MEMORY_BASE + GUEST_MEMORY_SIZE / 2;
+
+constexpr int COUNTER_REGISTER = 28;
+
+enum class Backend { Dynarmic, Unicorn };
+
+struct Workload {
+    const char* name;
+    std::vector<u32> code;
+    /// Instructions executed by an iteration of the loop, all paths through it have this length
+    u64 loop_length;
+};
+
+const std::vector<Workload> WORKLOADS{
+    {"Integer",
+     {
+         0x8B030042, // add x2, x2, x3
+         0xCA020C63, // eor x3, x3, x2, lsl #3
+         0x9B037C44, // mul x4, x2, x3
+         0x8B441CA5, // add x5, x5, x4, lsr #7
+         0xCB0200A6, // sub x6, x5, x2
+         0xAA0600E7, // orr x7, x7, x6
+         0x9B032048, // madd x8, x2, x3, x8
+         0x9100079C, // add x28, x28, #1
+         0x17FFFFF8, // b #-0x20
+     },
+     9},
+    {"NEON",
+     {
+         0x4E22CC20, // fmla v0.4s, v1.4s, v2.4s
+         0x4E25CC83, // fmla v3.4s, v4.4s, v5.4s
+         0x4E23D406, // fadd v6.4s, v0.4s, v3.4s
+         0x6E21DCC7, // fmul v7.4s, v6.4s, v1.4s
+         0x4EA98508, // add v8.4s, v8.4s, v9.4s
+         0x6E281D4A, // eor v10.16b, v10.16b, v8.16b
+         0x9100079C, // add x28, x28, #1
+         0x17FFFFF9, // b #-0x1c
+     },
+     8},
+    {"LoadStore",
+     {
+         0x92402F8A, // and x10, x28, #0xfff
+         0x8B0A102B, // add x11, x1, x10, lsl #4
+         0xA9400D62, // ldp x2, x3, [x11]
+         0x8B030042, // add x2, x2, x3
+         0xF9000162, // str x2, [x11]
+         0xB9400564, // ldr w4, [x11, #4]
+         0x39003164, // strb w4, [x11, #12]
+         0x9100079C, // add x28, x28, #1
+         0x17FFFFF8, // b #-0x20
+     },
+     9},
+    {"Branchy",
+     {
+         0x9100079C, // add x28, x28, #1
+         0x3600007C, // tbz w28, #0, #0xc
+         0x91000442, // add x2, x2, #1
+         0x14000003, // b #0xc
+         0xD1000463, // sub x3, x3, #1
+         0x8B030084, // add x4, x4, x3
+         0xF27F039F, // tst x28, #2
+         0x54000060, // b.eq #0xc
+         0x94000006, // bl #0x18
+         0x17FFFFF7, // b #-0x24
+         0x8B1C00C6, // add x6, x6, x28
+         0xCA0600E7, // eor x7, x7, x6
+         0x91000508, // add x8, x8, #1
+         0x17FFFFF3, // b #-0x34
+         0xCA1C00A5, // eor x5, x5, x28
+         0xD65F03C0, // ret
+     },
+     10},
+};
+
+/// Builds straight-line code of two instruction blocks, longer than a timing slice executes, so
+/// every block a slice reaches has to be translated
+std::vector<u32> MakeCacheFillCode() {
+    constexpr std::size_t NUM_BLOCKS = 64 * 1024;
+    std::vector<u32> code;
+    code.reserve(NUM_BLOCKS * 2);
+    for (std::size_t block = 0; block < NUM_BLOCKS; ++block) {
+        code.push_back(0x9100079C); // add x28, x28, #1
+        code.push_back(0x14000001); // b #4
+    }
+    // The last block branches back to the first one
+    const s32 offset = -static_cast<s32>(code.size() - 1);
+    code.back() = 0x14000000 | (static_cast<u32>(offset) & 0x3FFFFFF);
+    return code;
+}
+
+/// CPU running a workload on its own timing slices of the system CoreTiming
+class CpuFixture {
+public:
+    CpuFixture(Backend backend, const std::vector<u32>& code)
+        : system{Core::System::GetInstance()}, memory{GuestMemory::Get()}, backend{backend} {
+        std::memcpy(memory.GetPointer(CODE_ADDRESS), code.data(), code.size() * sizeof(u32));
+        system.CoreTiming().Initialize();
+        Reset();
+    }
+
+    ~CpuFixture() {
+        system.CoreTiming().Shutdown();
+    }
+
+    /// Drops the translated code and restarts the workload from its first instruction
+    void Reset() {
+        // Unicorn doesn't implement ClearInstructionCache, a new instance starts empty
+        if (backend == Backend::Unicorn || cpu == nullptr) {
+            cpu = MakeCpu();
+        } else {
+            cpu->ClearInstructionCache();
+        }
+
+        Core::ARM_Interface::ThreadContext context{};
+        context.pc = CODE_ADDRESS;
+        context.cpu_registers[1] = DATA_ADDRESS;
+        cpu->LoadContext(context);
+    }
+
+    /// Runs a timing slice, returns the iterations of the workload executed in it
+    u64 RunSlice() {
+        const u64 start = cpu->GetReg(COUNTER_REGISTER);
+        system.CoreTiming().Advance();
+        cpu->Run();
+        return cpu->GetReg(COUNTER_REGISTER) - start;
+    }
+
+private:
+    std::unique_ptr<Core::ARM_Interface> MakeCpu() {
+        std::unique_ptr<Core::ARM_Interface> new_cpu;
+#ifdef ARCHITECTURE_x86_64
+        if (backend == Backend::Dynarmic) {
+            new_cpu = std::make_unique<Core::ARM_Dynarmic>(system, exclusive_monitor, 0);
+        }
+#endif
+        if (new_cpu == nullptr) {
+            new_cpu = std::make_unique<Core::ARM_Unicorn>(system);
+        }
+        new_cpu->MapBackingMemory(GUEST_MEMORY_BASE, GUEST_MEMORY_SIZE,
+                                  memory.GetPointer(GUEST_MEMORY_BASE),
+                                  Kernel::VMAPermission::ReadWriteExecute);
+        new_cpu->PageTableChanged(memory.GetPageTable(), memory.GetAddressSpaceWidth());
+        return new_cpu;
+    }
+
+    Core::System& system;
+    GuestMemory& memory;
+    Backend backend;
+#ifdef ARCHITECTURE_x86_64
+    Core::DynarmicExclusiveMonitor exclusive_monitor{Core::NUM_CPU_CORES};
+#endif
+    std::unique_ptr<Core::ARM_Interface> cpu;
+};
+
+/// Runs the workload from a warm code cache, the guest instructions per second of the backend
+void RunWarm(Bench::State& state, Backend backend, const Workload& workload) {
+    CpuFixture fixture{backend, workload.code};
+    fixture.RunSlice();
+
+    u64 iterations = 0;
+    while (state.KeepRunning()) {
+        iterations += fixture.RunSlice();
+    }
+    state.SetItemsProcessed(iterations * workload.loop_length);
+}
+
+/// Runs a slice of the workload from an empty code cache, the warm run plus its translation
+void RunCold(Bench::State& state, Backend backend, const Workload& workload) {
+    CpuFixture fixture{backend, workload.code};
+
+    u64 iterations = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        fixture.Reset();
+        state.ResumeTiming();
+        iterations += fixture.RunSlice();
+    }
+    state.SetItemsProcessed(iterations * workload.loop_length);
+}
+
+/// Runs a slice of blocks that are all new to the code cache, the rate is in translated blocks
+void CacheFill(Bench::State& state, Backend backend) {
+    CpuFixture fixture{backend, MakeCacheFillCode()};
+
+    u64 blocks = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        fixture.Reset();
+        state.ResumeTiming();
+        blocks += fixture.RunSlice();
+    }
+    state.SetItemsProcessed(blocks);
+}
+
+void RegisterBackend(Backend backend, const std::string& backend_name) {
+    const std::string prefix = "arm/" + backend_name + '/';
+    for (const Workload& workload : WORKLOADS) {
+        Bench::Registration{prefix + workload.name, [backend, &workload](Bench::State& state) {
+                                RunWarm(state, backend, workload);
+                            }};
+        Bench::Registration{prefix + workload.name + "/Cold",
+                            [backend, &workload](Bench::State& state) {
+                                RunCold(state, backend, workload);
+                            }};
+    }
+    Bench::Registration{prefix + "CacheFill",
+                        [backend](Bench::State& state) { CacheFill(state, backend); }};
+}
+
+[[maybe_unused]] const bool registered = [] {
+#ifdef ARCHITECTURE_x86_64
+    RegisterBackend(Backend::Dynarmic, "Dynarmic");
+#endif
+    RegisterBackend(Backend::Unicorn, "Unicorn");
+    return true;
+}();
+
+} // Anonymous namespace
@@ -0,0 +1,184 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// The audio renderer plays synthetic voices to the null sink while the emulated time is advanced
+// as fast as the DSP thread mixes, so the mixes per second measure the throughput of the audio
+// pipeline without running a game.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "audio_core/audio_renderer.h"
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/readable_event.h"
+#include "core/hle/kernel/writable_event.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
+#include "tests/bench/bench.h"
+#include "tests/bench/guest_memory.h"
+
+namespace {
+
+using AudioCore::Codec::PcmFormat;
+using Bench::GUEST_MEMORY_BASE;
+using Bench::GuestMemory;
+
+constexpr u32 VOICE_COUNT = 32;
+constexpr u32 VOICE_SAMPLE_RATE = 32000;
+
+/// Length of the wave buffer of each voice
+constexpr double WAVE_SECONDS = 0.25;
+
+/// Interval between the updates of the guest, games usually update once per audio frame
+constexpr std::chrono::milliseconds UPDATE_INTERVAL{5};
+
+constexpr AudioCore::Codec::ADPCM_Coeff ADPCM_COEFFS{
+    {0x04ab, -0x01f1, 0x0789, -0x0326, 0x0470, -0x0155, 0x050f, -0x0281, 0x0555, -0x013e, 0x07d4,
+     -0x0485, 0x0e0b, -0x0245, 0x0739, -0x02e1}};
+
+/// Builds the wave buffer played by every voice, a tone in the given format
+std::vector<u8> MakeWaveBuffer(PcmFormat format) {
+    const auto num_samples = static_cast<std::size_t>(VOICE_SAMPLE_RATE * WAVE_SECONDS);
+    if (format == PcmFormat::Int16) {
+        std::vector<s16> samples(num_samples);
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            samples[i] =
+                static_cast<s16>(8192.0 * std::sin(i * 440.0 * 6.2831853 / VOICE_SAMPLE_RATE));
+        }
+        std::vector<u8> data(samples.size() * sizeof(s16));
+        std::memcpy(data.data(), samples.data(), data.size());
+        return data;
+    }
+
+    // The content doesn't matter to the decoder, only the scale is kept low to avoid clipping
+    std::vector<u8> data(num_samples / 14 * 8);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i % 8 == 0 ? ((i / 8) % 8) << 4 | 9 : i * 37);
+    }
+    return data;
+}
+
+/// Builds the input of an update playing the voices, in the layout parsed by the renderer
+std::vector<u8> MakeUpdate(const AudioCore::AudioRendererParameter& params, PcmFormat format,
+                           std::size_t wave_size, bool is_first) {
+    const std::size_t memory_pool_count = params.effect_count + params.voice_count * 4;
+
+    // The input only has the memory pools and the voices, the header is built like the output one
+    AudioCore::UpdateDataHeader header{params};
+    header.behavior_size = 0;
+    header.memory_pools_size =
+        static_cast<u32>(memory_pool_count * sizeof(AudioCore::MemoryPoolInfo));
+    header.voices_size = static_cast<u32>(params.voice_count * sizeof(AudioCore::VoiceInfo));
+    header.total_size = sizeof(header) + header.memory_pools_size + header.voices_size;
+
+    std::vector<u8> update(header.total_size);
+    std::memcpy(update.data(), &header, sizeof(header));
+
+    const VAddr coeffs_address = GUEST_MEMORY_BASE + params.voice_count * wave_size;
+    std::size_t offset = sizeof(header) + header.memory_pools_size;
+    for (u32 index = 0; index < params.voice_count; ++index) {
+        AudioCore::VoiceInfo voice{};
+        voice.id = index;
+        voice.is_new = is_first;
+        voice.is_in_use = 1;
+        voice.play_state = AudioCore::PlayState::Started;
+        voice.sample_format = static_cast<u8>(format);
+        voice.sample_rate = VOICE_SAMPLE_RATE;
+        voice.channel_count = 1;
+        voice.volume = 1.0f / params.voice_count;
+        voice.wave_buffer_count = 4;
+        voice.additional_params_addr = coeffs_address;
+        voice.additional_params_sz = sizeof(AudioCore::Codec::ADPCM_Coeff);
+
+        // The four buffers are played in a cycle, every one of them is decoded and resampled
+        for (auto& wave_buffer : voice.wave_buffer) {
+            wave_buffer.buffer_addr = GUEST_MEMORY_BASE + index * wave_size;
+            wave_buffer.buffer_sz = wave_size;
+        }
+
+        std::memcpy(update.data() + offset, &voice, sizeof(voice));
+        offset += sizeof(voice);
+    }
+    return update;
+}
+
+void MixVoices(Bench::State& state, PcmFormat format, u16 resampling_quality) {
+    Settings::values.sink_id = "null";
+    Settings::values.resampling_quality = resampling_quality;
+    Settings::values.enable_low_latency_audio = false;
+
+    // The wave buffer of every voice, followed by the ADPCM coefficients
+    GuestMemory& guest_memory = GuestMemory::Get();
+    const std::vector<u8> wave = MakeWaveBuffer(format);
+    for (u32 index = 0; index < VOICE_COUNT; ++index) {
+        std::memcpy(guest_memory.GetPointer(GUEST_MEMORY_BASE + index * wave.size()), wave.data(),
+                    wave.size());
+    }
+    std::memcpy(guest_memory.GetPointer(GUEST_MEMORY_BASE + VOICE_COUNT * wave.size()),
+                ADPCM_COEFFS.data(), sizeof(ADPCM_COEFFS));
+
+    Core::Timing::CoreTiming core_timing;
+    core_timing.Initialize();
+
+    AudioCore::AudioRendererParameter params{};
+    params.sample_rate = 48000;
+    params.sample_count = 240;
+    params.mix_buffer_count = 1;
+    params.voice_count = VOICE_COUNT;
+
+    auto& kernel = Core::System::GetInstance().Kernel();
+    const auto event =
+        Kernel::WritableEvent::CreateEventPair(kernel, Kernel::ResetType::Manual, "yuzu-bench");
+    Core::PerfStats perf_stats;
+    {
+        AudioCore::AudioRenderer renderer{core_timing, perf_stats, params, event.writable};
+        renderer.UpdateAudioRenderer(MakeUpdate(params, format, wave.size(), true).data());
+        const auto update = MakeUpdate(params, format, wave.size(), false);
+        perf_stats.GetAndResetAudioStats();
+
+        // Releasing a buffer wakes the DSP thread, jumping to the next release as soon as it is
+        // scheduled keeps the DSP thread mixing all the time
+        using Clock = std::chrono::steady_clock;
+        auto next_update = Clock::now() + UPDATE_INTERVAL;
+        while (state.KeepRunning()) {
+            core_timing.AddTicks(core_timing.GetDowncount());
+            core_timing.Advance();
+
+            if (Clock::now() >= next_update) {
+                renderer.UpdateAudioRenderer(update.data());
+                next_update += UPDATE_INTERVAL;
+            }
+        }
+        state.SetItemsProcessed(perf_stats.GetAndResetAudioStats().num_mixes);
+    }
+    core_timing.Shutdown();
+}
+
+[[maybe_unused]] const bool registered = [] {
+    constexpr std::array<std::pair<PcmFormat, const char*>, 2> formats{{
+        {PcmFormat::Int16, "PCM16"},
+        {PcmFormat::Adpcm, "ADPCM"},
+    }};
+    constexpr std::array<const char*, 3> qualities{"Linear", "Cubic", "Sinc"};
+    for (const auto& [format, format_name] : formats) {
+        for (u16 quality = 0; quality < qualities.size(); ++quality) {
+            const std::string name = std::string("audio/Mix32Voices/") + format_name + '/' +
+                                     qualities[quality];
+            Bench::Registration{name, [format = format, quality](Bench::State& state) {
+                                    MixVoices(state, format, quality);
+                                }};
+        }
+    }
+    return true;
+}();
+
+} // Anonymous namespace
@@ -0,0 +1,276 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Micro-benchmarks of the emulator hot paths. Every suite registers its benchmarks, the runner
+// times them and prints the results, optionally as JSON in the layout of Google Benchmark so the
+// results of two builds can be compared by the usual tools.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "tests/bench/bench.h"
+
+namespace Bench {
+namespace {
+
+/// Upper bound of the iterations run between two reads of the clock
+constexpr u64 MAX_BATCH_SIZE = u64{1} << 20;
+
+struct Benchmark {
+    std::string name;
+    Function function;
+};
+
+struct Result {
+    std::string name;
+    u64 iterations;
+    double ns_per_iteration;
+    double bytes_per_second;
+    double items_per_second;
+    std::string skip_message;
+};
+
+std::vector<Benchmark>& GetRegistry() {
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+Options options;
+
+struct RunnerOptions {
+    std::string filter;
+    std::string json_path;
+    bool list = false;
+};
+
+void PrintHelp(const char* argv0) {
+    fmt::print("Usage: {} [options]\n"
+               "-f, --filter=TEXT  Only run the benchmarks whose name contains TEXT\n"
+               "-t, --time=MS      Minimum time of each benchmark in milliseconds, 500 by default\n"
+               "-s, --shaders=PATH Transferable shader cache decoded by the shader benchmarks\n"
+               "-j, --json=PATH    Write the results as JSON to PATH, - for the standard output\n"
+               "-l, --list         List the benchmarks and exit\n"
+               "-h, --help         Display this help and exit\n",
+               argv0);
+}
+
+/// Parses the options, returns false if the benchmarks shouldn't run
+bool ParseOptions(int argc, char** argv, RunnerOptions& runner_options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            PrintHelp(argv[0]);
+            return false;
+        }
+        if (arg == "-l" || arg == "--list") {
+            runner_options.list = true;
+            continue;
+        }
+
+        std::string name = arg;
+        std::string value;
+        const auto equals = arg.find('=');
+        if (equals != std::string::npos) {
+            name = arg.substr(0, equals);
+            value = arg.substr(equals + 1);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        }
+
+        if (name == "-f" || name == "--filter") {
+            runner_options.filter = value;
+        } else if (name == "-t" || name == "--time") {
+            options.min_time = std::chrono::milliseconds{std::strtoull(value.c_str(), nullptr, 0)};
+        } else if (name == "-s" || name == "--shaders") {
+            options.shader_cache_path = value;
+        } else if (name == "-j" || name == "--json") {
+            runner_options.json_path = value;
+        } else {
+            fmt::print("Invalid option {}\n", arg);
+            PrintHelp(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string FormatJson(const std::vector<Result>& results, const char* executable) {
+    std::string json = fmt::format("{{\n  \"context\": {{\n    \"executable\": \"{}\",\n"
+                                   "    \"min_time_ms\": {}\n  }},\n  \"benchmarks\": [",
+                                   EscapeJson(executable),
+                                   std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       options.min_time)
+                                       .count());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        json += i == 0 ? "\n" : ",\n";
+        if (!result.skip_message.empty()) {
+            json += fmt::format("    {{\"name\": \"{}\", \"error_occurred\": true, "
+                                "\"error_message\": \"{}\"}}",
+                                EscapeJson(result.name), EscapeJson(result.skip_message));
+            continue;
+        }
+        json += fmt::format("    {{\"name\": \"{}\", \"iterations\": {}, \"real_time\": {:.3f}, "
+                            "\"time_unit\": \"ns\"",
+                            EscapeJson(result.name), result.iterations, result.ns_per_iteration);
+        if (result.bytes_per_second != 0.0) {
+            json += fmt::format(", \"bytes_per_second\": {:.0f}", result.bytes_per_second);
+        }
+        if (result.items_per_second != 0.0) {
+            json += fmt::format(", \"items_per_second\": {:.0f}", result.items_per_second);
+        }
+        json += '}';
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+Result Run(const Benchmark& benchmark) {
+    State state{options.min_time};
+    benchmark.function(state);
+
+    Result result{benchmark.name, state.GetIterations(), 0.0, 0.0, 0.0,
+                  state.GetSkipMessage()};
+    if (result.iterations != 0) {
+        const double elapsed_ns = static_cast<double>(state.GetElapsed().count());
+        result.ns_per_iteration = elapsed_ns / result.iterations;
+        if (elapsed_ns > 0.0) {
+            result.bytes_per_second =
+                static_cast<double>(state.GetBytesProcessed()) * result.iterations * 1e9 /
+                elapsed_ns;
+            result.items_per_second =
+                static_cast<double>(state.GetItemsProcessed()) * 1e9 / elapsed_ns;
+        }
+    }
+    return result;
+}
+
+void PrintResult(const Result& result) {
+    if (!result.skip_message.empty()) {
+        fmt::print("{:<44} skipped: {}\n", result.name, result.skip_message);
+        return;
+    }
+    fmt::print("{:<44} {:>12} {:>14.1f} ns", result.name, result.iterations,
+               result.ns_per_iteration);
+    if (result.bytes_per_second != 0.0) {
+        fmt::print(" {:>11.1f} MiB/s", result.bytes_per_second / (1024.0 * 1024.0));
+    }
+    if (result.items_per_second != 0.0) {
+        fmt::print(" {:>11.2f} M/s", result.items_per_second / 1e6);
+    }
+    fmt::print("\n");
+    std::fflush(stdout);
+}
+
+} // Anonymous namespace
+
+const Options& GetOptions() {
+    return options;
+}
+
+State::State(std::chrono::nanoseconds min_time) : min_time{min_time} {}
+
+void State::PauseTiming() {
+    elapsed += Clock::now() - start;
+}
+
+void State::ResumeTiming() {
+    start = Clock::now();
+}
+
+bool State::NextBatch() {
+    const auto now = Clock::now();
+    if (!is_running) {
+        is_running = true;
+        batch_size = 1;
+    } else {
+        elapsed += now - start;
+        iterations += batch_size;
+        if (elapsed >= min_time) {
+            return false;
+        }
+        batch_size = std::min(batch_size * 2, MAX_BATCH_SIZE);
+    }
+    batch_remaining = batch_size - 1;
+    start = Clock::now();
+    return true;
+}
+
+Registration::Registration(std::string name, Function function) {
+    GetRegistry().push_back({std::move(name), std::move(function)});
+}
+
+} // namespace Bench
+
+int main(int argc, char** argv) {
+    Bench::RunnerOptions runner_options;
+    if (!Bench::ParseOptions(argc, argv, runner_options)) {
+        return 1;
+    }
+
+    auto benchmarks = Bench::GetRegistry();
+    std::sort(benchmarks.begin(), benchmarks.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.name < rhs.name; });
+    benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+                                    [&runner_options](const auto& benchmark) {
+                                        return benchmark.name.find(runner_options.filter) ==
+                                               std::string::npos;
+                                    }),
+                     benchmarks.end());
+
+    if (runner_options.list) {
+        for (const auto& benchmark : benchmarks) {
+            fmt::print("{}\n", benchmark.name);
+        }
+        return 0;
+    }
+
+    // The JSON written to the standard output must not be mixed with the table
+    const bool json_to_stdout = runner_options.json_path == "-";
+    std::vector<Bench::Result> results;
+    for (const auto& benchmark : benchmarks) {
+        results.push_back(Bench::Run(benchmark));
+        if (!json_to_stdout) {
+            Bench::PrintResult(results.back());
+        }
+    }
+
+    if (runner_options.json_path.empty()) {
+        return 0;
+    }
+    const std::string json = Bench::FormatJson(results, argv[0]);
+    if (json_to_stdout) {
+        fmt::print("{}", json);
+        return 0;
+    }
+    if (FileUtil::WriteStringToFile(true, runner_options.json_path, json) != json.size()) {
+        fmt::print("Failed to write {}\n", runner_options.json_path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "common/common_types.h"
+
+namespace Bench {
+
+/// Options shared by the suites, set from the command line of yuzu-bench
+struct Options {
+    /// Minimum time every benchmark runs for
+    std::chrono::nanoseconds min_time{std::chrono::milliseconds{500}};
+    /// Transferable shader cache the shader benchmarks decode, they are skipped without one
+    std::string shader_cache_path;
+};
+
+const Options& GetOptions();
+
+/**
+ * Timing state of a running benchmark. The benchmark repeats its work while KeepRunning returns
+ * true, iterations are run in batches that double in size so the clock is rarely read.
+ */
+class State {
+public:
+    explicit State(std::chrono::nanoseconds min_time);
+
+    bool KeepRunning() {
+        if (batch_remaining != 0) {
+            --batch_remaining;
+            return true;
+        }
+        return NextBatch();
+    }
+
+    /// Excludes the setup done between iterations from the measured time
+    void PauseTiming();
+    void ResumeTiming();
+
+    /// Sets the bytes processed by every iteration, reported as a throughput
+    void SetBytesProcessed(u64 bytes) {
+        bytes_per_iteration = bytes;
+    }
+
+    /// Sets the items processed by all iterations together, such as the executed guest
+    /// instructions, for work that varies between iterations. Reported as a rate
+    void SetItemsProcessed(u64 items) {
+        items_processed = items;
+    }
+
+    /// Skips the benchmark, some need input the runner doesn't have
+    void SkipWithMessage(std::string message) {
+        skip_message = std::move(message);
+    }
+
+    u64 GetIterations() const {
+        return iterations;
+    }
+
+    std::chrono::nanoseconds GetElapsed() const {
+        return elapsed;
+    }
+
+    u64 GetBytesProcessed() const {
+        return bytes_per_iteration;
+    }
+
+    u64 GetItemsProcessed() const {
+        return items_processed;
+    }
+
+    const std::string& GetSkipMessage() const {
+        return skip_message;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool NextBatch();
+
+    std::chrono::nanoseconds min_time;
+    std::chrono::nanoseconds elapsed{};
+    Clock::time_point start;
+    bool is_running = false;
+
+    u64 iterations = 0;
+    u64 batch_size = 0;
+    u64 batch_remaining = 0;
+    u64 bytes_per_iteration = 0;
+    u64 items_processed = 0;
+    std::string skip_message;
+};
+
+using Function = std::function<void(State&)>;
+
+/// Registers a benchmark at static initialization, names are grouped by suite as "suite/name"
+struct Registration {
+    Registration(std::string name, Function function);
+};
+
+/// Keeps a computed value alive without a side effect, so benchmarked code isn't optimized out
+template <typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+} // namespace Bench
@@ -0,0 +1,253 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "common/lz4_compression.h"
+#include "common/threadsafe_queue.h"
+#include "tests/bench/bench.h"
+
+namespace {
+
+constexpr std::size_t QUEUE_CAPACITY = 1024;
+constexpr std::size_t QUEUE_BATCH_SIZE = 32;
+
+/// Elements handed from the producers to the consumer by every iteration of a queue benchmark
+constexpr std::size_t HANDOFF_COUNT = 1 << 16;
+
+/// Producers of the multiple writer queues
+constexpr std::size_t NUM_PRODUCERS = 4;
+
+/**
+ * Runs num_producers threads calling push(producer, value) for their share of the elements of
+ * an iteration while the calling thread pops them with pop(), which returns how many it popped.
+ * The queues are compared by the handoffs per second.
+ */
+template <typename Push, typename Pop>
+void Handoff(Bench::State& state, std::size_t num_producers, Push&& push, Pop&& pop) {
+    const std::size_t per_producer = HANDOFF_COUNT / num_producers;
+    const std::size_t total = per_producer * num_producers;
+
+    u64 sum = 0;
+    while (state.KeepRunning()) {
+        std::vector<std::thread> producers;
+        for (std::size_t producer = 0; producer < num_producers; ++producer) {
+            producers.emplace_back([&push, producer, per_producer] {
+                for (std::size_t i = 0; i < per_producer; ++i) {
+                    push(producer, i);
+                }
+            });
+        }
+        for (std::size_t popped = 0; popped < total;) {
+            popped += pop(sum);
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    }
+    state.SetItemsProcessed(state.GetIterations() * total);
+
+    // The sum keeps the consumer from being optimized out and checks that nothing got lost
+    const u64 expected = static_cast<u64>(num_producers) * per_producer * (per_producer - 1) / 2;
+    if (sum != expected * state.GetIterations()) {
+        state.SkipWithMessage("The queue lost elements");
+    }
+}
+
+/// Pops an element without waiting, returns how many were popped
+template <typename Queue>
+std::size_t PopOne(Queue& queue, u64& sum) {
+    std::size_t value;
+    if (!queue.Pop(value)) {
+        return 0;
+    }
+    sum += value;
+    return 1;
+}
+
+/// Pops up to a batch of elements, waiting for the first one
+template <typename Queue>
+std::size_t PopBatch(Queue& queue, u64& sum) {
+    std::array<std::size_t, QUEUE_BATCH_SIZE> popped;
+    const std::size_t num_popped = queue.PopBatchWait(popped.data(), popped.size());
+    for (std::size_t i = 0; i < num_popped; ++i) {
+        sum += popped[i];
+    }
+    return num_popped;
+}
+
+/// Pushes the elements of each producer in batches, the last one is flushed when it is partial
+template <typename Queue>
+class BatchPusher {
+public:
+    BatchPusher(Queue& queue, std::size_t num_producers)
+        : queue{queue}, batches(num_producers), per_producer{HANDOFF_COUNT / num_producers} {}
+
+    void operator()(std::size_t producer, std::size_t value) {
+        auto& batch = batches[producer];
+        batch.elements[batch.size++] = value;
+        if (batch.size < QUEUE_BATCH_SIZE && value + 1 < per_producer) {
+            return;
+        }
+        std::size_t pushed = queue.PushBatch(batch.elements.data(), batch.size);
+        while (pushed < batch.size) {
+            // Let the consumer make space
+            std::this_thread::yield();
+            pushed += queue.PushBatch(batch.elements.data() + pushed, batch.size - pushed);
+        }
+        batch.size = 0;
+    }
+
+private:
+    struct alignas(128) Batch {
+        std::array<std::size_t, QUEUE_BATCH_SIZE> elements;
+        std::size_t size = 0;
+    };
+
+    Queue& queue;
+    std::vector<Batch> batches;
+    std::size_t per_producer;
+};
+
+void SPSCQueue(Bench::State& state) {
+    Common::SPSCQueue<std::size_t> queue;
+    Handoff(state, 1, [&](std::size_t, std::size_t value) { queue.Push(value); },
+            [&](u64& sum) { return PopOne(queue, sum); });
+}
+
+void SPSCQueuePopWait(Bench::State& state) {
+    Common::SPSCQueue<std::size_t> queue;
+    Handoff(state, 1, [&](std::size_t, std::size_t value) { queue.Push(value); },
+            [&](u64& sum) {
+                sum += queue.PopWait();
+                return 1;
+            });
+}
+
+void BoundedSPSCQueue(Bench::State& state) {
+    Common::BoundedSPSCQueue<std::size_t, QUEUE_CAPACITY> queue;
+    Handoff(state, 1, [&](std::size_t, std::size_t value) { queue.PushWait(value); },
+            [&](u64& sum) {
+                sum += queue.PopWait();
+                return 1;
+            });
+}
+
+void BoundedSPSCQueueBatches(Bench::State& state) {
+    Common::BoundedSPSCQueue<std::size_t, QUEUE_CAPACITY> queue;
+    BatchPusher pusher{queue, 1};
+    Handoff(state, 1, pusher, [&](u64& sum) { return PopBatch(queue, sum); });
+}
+
+void MPSCQueue(Bench::State& state) {
+    Common::MPSCQueue<std::size_t> queue;
+    Handoff(state, NUM_PRODUCERS, [&](std::size_t, std::size_t value) { queue.Push(value); },
+            [&](u64& sum) { return PopOne(queue, sum); });
+}
+
+void BoundedMPSCQueue(Bench::State& state) {
+    Common::BoundedMPSCQueue<std::size_t, QUEUE_CAPACITY> queue;
+    Handoff(state, NUM_PRODUCERS,
+            [&](std::size_t, std::size_t value) { queue.PushWait(value); },
+            [&](u64& sum) {
+                sum += queue.PopWait();
+                return 1;
+            });
+}
+
+void BoundedMPSCQueueBatches(Bench::State& state) {
+    Common::BoundedMPSCQueue<std::size_t, QUEUE_CAPACITY> queue;
+    BatchPusher pusher{queue, NUM_PRODUCERS};
+    Handoff(state, NUM_PRODUCERS, pusher, [&](u64& sum) { return PopBatch(queue, sum); });
+}
+
+/// Sizes hashed by the emulator: cache keys, samplers and surface parameters, guest pages and
+/// shader programs
+constexpr std::array<std::size_t, 9> HASH_SIZES{8, 16, 32, 64, 128, 256, 1024, 4096, 65536};
+
+/// Hashes the first size bytes of a buffer, each call from a different offset so the calls
+/// can't be hoisted out of the loop
+template <typename Hash>
+void HashBench(Bench::State& state, std::size_t size, Hash&& hash) {
+    std::vector<u8> data(size + 8);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 131 + 7);
+    }
+    u64 result = 0;
+    std::size_t offset = 0;
+    while (state.KeepRunning()) {
+        result += hash(data.data() + (offset++ & 7), size);
+    }
+    Bench::DoNotOptimize(result);
+    state.SetBytesProcessed(size);
+}
+
+/**
+ * Builds a segment that compresses like the text of an executable, a stream of instructions
+ * drawn from a small set with a few varying fields.
+ */
+std::vector<u8> MakeCodeSegment(std::size_t size) {
+    constexpr std::array<u32, 8> opcodes{0xAA0003E0, 0xF9400000, 0xF9000000, 0x91000000,
+                                         0x94000000, 0xD65F03C0, 0xB4000000, 0x52800000};
+    std::vector<u8> segment(size);
+    u32 seed = 0x12345678;
+    for (std::size_t offset = 0; offset + sizeof(u32) <= size; offset += sizeof(u32)) {
+        seed = seed * 1103515245 + 12345;
+        const u32 instruction = opcodes[(seed >> 16) % opcodes.size()] | ((seed >> 8) & 0x3FF);
+        std::memcpy(segment.data() + offset, &instruction, sizeof(instruction));
+    }
+    return segment;
+}
+
+/// Decompresses a segment the size of the text of a large NSO
+void Lz4Decompress(Bench::State& state) {
+    const std::vector<u8> segment = MakeCodeSegment(8 * 1024 * 1024);
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataLZ4(segment.data(), segment.size());
+    std::vector<u8> decompressed(segment.size());
+    while (state.KeepRunning()) {
+        Common::Compression::DecompressDataLZ4(compressed.data(), compressed.size(),
+                                               decompressed.data(), decompressed.size());
+        Bench::DoNotOptimize(decompressed.data());
+    }
+    state.SetBytesProcessed(decompressed.size());
+}
+
+const Bench::Registration registrations[]{
+    {"queue/SPSCQueue/Handoff", SPSCQueue},
+    {"queue/SPSCQueue/HandoffPopWait", SPSCQueuePopWait},
+    {"queue/BoundedSPSCQueue/Handoff", BoundedSPSCQueue},
+    {"queue/BoundedSPSCQueue/HandoffBatches", BoundedSPSCQueueBatches},
+    {"queue/MPSCQueue/Handoff/4", MPSCQueue},
+    {"queue/BoundedMPSCQueue/Handoff/4", BoundedMPSCQueue},
+    {"queue/BoundedMPSCQueue/HandoffBatches/4", BoundedMPSCQueueBatches},
+    {"compression/LZ4/DecompressNSOSegment", Lz4Decompress},
+};
+
+[[maybe_unused]] const bool hash_registered = [] {
+    for (const std::size_t size : HASH_SIZES) {
+        const std::string suffix = '/' + std::to_string(size);
+        Bench::Registration{"hash/CityHash64" + suffix, [size](Bench::State& state) {
+                                HashBench(state, size, [](const u8* data, std::size_t len) {
+                                    return Common::CityHash64(
+                                        reinterpret_cast<const char*>(data), len);
+                                });
+                            }};
+        Bench::Registration{"hash/ComputeHash64" + suffix, [size](Bench::State& state) {
+                                HashBench(state, size, [](const u8* data, std::size_t len) {
+                                    return Common::ComputeHash64(data, len);
+                                });
+                            }};
+    }
+    return true;
+}();
+
+} // Anonymous namespace
@@ -0,0 +1,208 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#endif
+#include "core/arm/exclusive_monitor.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+#include "tests/bench/bench.h"
+#include "tests/bench/guest_memory.h"
+
+namespace {
+
+using Bench::GUEST_MEMORY_BASE;
+using Bench::GUEST_MEMORY_SIZE;
+using Bench::GuestMemory;
+
+template <typename T, typename Read>
+void ReadSequential(Bench::State& state, Read&& read) {
+    GuestMemory::Get();
+    VAddr offset = 0;
+    T sum = 0;
+    while (state.KeepRunning()) {
+        sum += static_cast<T>(read(GUEST_MEMORY_BASE + offset));
+        offset = (offset + sizeof(T)) % GUEST_MEMORY_SIZE;
+    }
+    Bench::DoNotOptimize(sum);
+    state.SetBytesProcessed(sizeof(T));
+}
+
+void Read8(Bench::State& state) {
+    ReadSequential<u8>(state, Memory::Read8);
+}
+
+void Read32(Bench::State& state) {
+    ReadSequential<u32>(state, Memory::Read32);
+}
+
+void Read64(Bench::State& state) {
+    ReadSequential<u64>(state, Memory::Read64);
+}
+
+void Write32(Bench::State& state) {
+    GuestMemory::Get();
+    VAddr offset = 0;
+    u32 value = 0;
+    while (state.KeepRunning()) {
+        Memory::Write32(GUEST_MEMORY_BASE + offset, ++value);
+        offset = (offset + sizeof(u32)) % GUEST_MEMORY_SIZE;
+    }
+    state.SetBytesProcessed(sizeof(u32));
+}
+
+void ReadBlock(Bench::State& state, std::size_t size) {
+    GuestMemory::Get();
+    std::vector<u8> buffer(size);
+    VAddr offset = 0;
+    while (state.KeepRunning()) {
+        Memory::ReadBlock(GUEST_MEMORY_BASE + offset, buffer.data(), size);
+        Bench::DoNotOptimize(buffer.data());
+        offset = (offset + size) % GUEST_MEMORY_SIZE;
+    }
+    state.SetBytesProcessed(size);
+}
+
+void WriteBlock(Bench::State& state, std::size_t size) {
+    GuestMemory::Get();
+    const std::vector<u8> buffer(size, 0xAB);
+    VAddr offset = 0;
+    while (state.KeepRunning()) {
+        Memory::WriteBlock(GUEST_MEMORY_BASE + offset, buffer.data(), size);
+        offset = (offset + size) % GUEST_MEMORY_SIZE;
+    }
+    state.SetBytesProcessed(size);
+}
+
+/**
+ * Schedules events at spread out times and advances the emulated time every few events, like the
+ * CPU cores do at the end of their slices, with pending_events events waiting far in the future.
+ */
+void ScheduleAndAdvance(Bench::State& state, Core::Timing::EventQueueType queue_type,
+                        u32 pending_events) {
+    Core::Timing::CoreTiming core_timing{queue_type};
+    core_timing.Initialize();
+    const auto* const event = core_timing.RegisterEvent("bench", [](u64, s64) {});
+
+    // Events far in the future stay pending, every iteration schedules one that runs soon
+    for (u32 i = 0; i < pending_events; ++i) {
+        core_timing.ScheduleEvent(1'000'000'000 + i, event, i);
+    }
+
+    u64 index = 0;
+    while (state.KeepRunning()) {
+        core_timing.ScheduleEvent(static_cast<s64>(100 + (index * 7919) % 10000), event, index);
+        if (++index % 16 == 0) {
+            core_timing.AddTicks(core_timing.GetDowncount());
+            core_timing.Advance();
+        }
+    }
+    core_timing.Shutdown();
+}
+
+using MonitorFactory = std::function<std::unique_ptr<Core::ExclusiveMonitor>()>;
+
+/// Increments a counter with exclusive writes, like the spin loop of a guest mutex
+bool ExclusiveIncrement(Core::ExclusiveMonitor& monitor, std::size_t core_index, VAddr address) {
+    monitor.SetExclusive(core_index, address);
+    const u32 value = Memory::Read32(address);
+    return monitor.ExclusiveWrite32(core_index, address, value + 1);
+}
+
+/**
+ * Core 0 increments its counter while the other cores increment theirs, either the same counter
+ * or counters on their own cachelines. The rate is in successful increments of core 0.
+ */
+void ExclusiveContention(Bench::State& state, const MonitorFactory& make_monitor,
+                         std::size_t num_contenders, bool shared_counter) {
+    GuestMemory::Get();
+    const auto monitor = make_monitor();
+    const auto get_address = [shared_counter](std::size_t core_index) {
+        return GUEST_MEMORY_BASE + (shared_counter ? 0 : core_index * 0x40);
+    };
+
+    std::atomic_bool stop{false};
+    std::vector<std::thread> contenders;
+    for (std::size_t core = 1; core <= num_contenders; ++core) {
+        contenders.emplace_back([&, core] {
+            const VAddr address = get_address(core);
+            while (!stop.load(std::memory_order_relaxed)) {
+                ExclusiveIncrement(*monitor, core, address);
+            }
+        });
+    }
+
+    const VAddr address = get_address(0);
+    u64 increments = 0;
+    while (state.KeepRunning()) {
+        increments += ExclusiveIncrement(*monitor, 0, address) ? 1 : 0;
+    }
+    state.SetItemsProcessed(increments);
+
+    stop = true;
+    for (auto& contender : contenders) {
+        contender.join();
+    }
+}
+
+void RegisterExclusiveMonitor(const std::string& name, MonitorFactory make_monitor) {
+    const std::string prefix = "exclusive_monitor/" + name + '/';
+    for (const std::size_t num_contenders : {0U, Core::NUM_CPU_CORES - 1}) {
+        const std::string suffix = '/' + std::to_string(num_contenders);
+        Bench::Registration{prefix + "Shared" + suffix,
+                            [make_monitor, num_contenders](Bench::State& state) {
+                                ExclusiveContention(state, make_monitor, num_contenders, true);
+                            }};
+        Bench::Registration{prefix + "Private" + suffix,
+                            [make_monitor, num_contenders](Bench::State& state) {
+                                ExclusiveContention(state, make_monitor, num_contenders, false);
+                            }};
+    }
+}
+
+const Bench::Registration memory_registrations[]{
+    {"memory/Read8", Read8},
+    {"memory/Read32", Read32},
+    {"memory/Read64", Read64},
+    {"memory/Write32", Write32},
+    {"memory/ReadBlock/64", [](Bench::State& state) { ReadBlock(state, 64); }},
+    {"memory/ReadBlock/4096", [](Bench::State& state) { ReadBlock(state, 4096); }},
+    {"memory/ReadBlock/1048576", [](Bench::State& state) { ReadBlock(state, 1024 * 1024); }},
+    {"memory/WriteBlock/4096", [](Bench::State& state) { WriteBlock(state, 4096); }},
+};
+
+const Bench::Registration core_timing_registrations[]{
+    {"core_timing/ScheduleAdvance/TimingWheel",
+     [](Bench::State& state) {
+         ScheduleAndAdvance(state, Core::Timing::EventQueueType::TimingWheel, 256);
+     }},
+    {"core_timing/ScheduleAdvance/Heap",
+     [](Bench::State& state) {
+         ScheduleAndAdvance(state, Core::Timing::EventQueueType::Heap, 256);
+     }},
+};
+
+[[maybe_unused]] const bool exclusive_monitor_registered = [] {
+    RegisterExclusiveMonitor("Reservation", [] {
+        return std::make_unique<Core::ReservationExclusiveMonitor>(Core::NUM_CPU_CORES);
+    });
+#ifdef ARCHITECTURE_x86_64
+    RegisterExclusiveMonitor("Dynarmic", [] {
+        return std::make_unique<Core::DynarmicExclusiveMonitor>(Core::NUM_CPU_CORES);
+    });
+#endif
+    return true;
+}();
+
+} // Anonymous namespace
@@ -0,0 +1,80 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/crypto/ctr_encryption_layer.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_vector.h"
+#include "tests/bench/bench.h"
+#include "tests/core/file_sys/vfs_test_common.h"
+
+namespace {
+
+constexpr std::size_t ENCRYPTED_SIZE = 16 * 1024 * 1024;
+
+/// Reads through a CTR layer in chunks of read_size bytes, like the reads of an encrypted NCA
+void AesCtrRead(Bench::State& state, std::size_t read_size) {
+    const auto base = std::make_shared<FileSys::VectorVfsFile>(std::vector<u8>(ENCRYPTED_SIZE));
+    Core::Crypto::Key128 key{};
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<u8>(i * 17);
+    }
+    Core::Crypto::CTREncryptionLayer layer{base, key, 0};
+    layer.SetIV(std::vector<u8>(16, 0x5A));
+
+    std::vector<u8> buffer(read_size);
+    std::size_t offset = 0;
+    while (state.KeepRunning()) {
+        layer.Read(buffer.data(), buffer.size(), offset);
+        Bench::DoNotOptimize(buffer.data());
+        offset = (offset + read_size) % ENCRYPTED_SIZE;
+    }
+    state.SetBytesProcessed(read_size);
+}
+
+/// Looks up files of a RomFS with 64 directories of 64 files, cycling through all of them
+void RomFSLookup(Bench::State& state) {
+    constexpr int NUM_DIRECTORIES = 64;
+    constexpr int FILES_PER_DIRECTORY = 64;
+
+    std::vector<FileSys::VirtualDir> directories;
+    std::vector<std::string> paths;
+    for (int dir = 0; dir < NUM_DIRECTORIES; ++dir) {
+        const std::string dir_name = "directory" + std::to_string(dir);
+        std::vector<FileSys::VirtualFile> files;
+        for (int file = 0; file < FILES_PER_DIRECTORY; ++file) {
+            const std::string file_name = "file" + std::to_string(file) + ".bin";
+            files.push_back(FileSysTests::MakeFile(file_name, 16));
+            paths.push_back(dir_name + '/' + file_name);
+        }
+        directories.push_back(std::make_shared<FileSys::VectorVfsDirectory>(
+            std::move(files), std::vector<FileSys::VirtualDir>{}, dir_name));
+    }
+    const auto root = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::vector<FileSys::VirtualFile>{}, std::move(directories), "root");
+
+    const FileSys::RomFSIndex index{FileSys::CreateRomFS(root)};
+    if (!index.IsValid()) {
+        state.SkipWithMessage("Failed to build the RomFS");
+        return;
+    }
+
+    std::size_t path = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(index.GetFile(paths[path]));
+        path = (path + 1) % paths.size();
+    }
+}
+
+const Bench::Registration registrations[]{
+    {"crypto/AesCtrRead/512", [](Bench::State& state) { AesCtrRead(state, 512); }},
+    {"crypto/AesCtrRead/65536", [](Bench::State& state) { AesCtrRead(state, 64 * 1024); }},
+    {"file_sys/RomFSIndex/GetFile", RomFSLookup},
+};
+
+} // Anonymous namespace
@@ -0,0 +1,41 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "core/core.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory_setup.h"
+#include "tests/bench/guest_memory.h"
+
+namespace Bench {
+
+GuestMemory::GuestMemory() : memory(GUEST_MEMORY_SIZE) {
+    process = Kernel::Process::Create(Core::System::GetInstance(), "yuzu-bench");
+    Memory::MapMemoryRegion(process->VMManager().page_table, GUEST_MEMORY_BASE, memory.size(),
+                            memory.data());
+}
+
+GuestMemory::~GuestMemory() = default;
+
+GuestMemory& GuestMemory::Get() {
+    static GuestMemory guest_memory;
+    Core::System::GetInstance().Kernel().MakeCurrentProcess(guest_memory.process.get());
+    return guest_memory;
+}
+
+u8* GuestMemory::GetPointer(VAddr address) {
+    ASSERT(address >= GUEST_MEMORY_BASE && address < GUEST_MEMORY_BASE + GUEST_MEMORY_SIZE);
+    return memory.data() + (address - GUEST_MEMORY_BASE);
+}
+
+Common::PageTable& GuestMemory::GetPageTable() {
+    return process->VMManager().page_table;
+}
+
+std::size_t GuestMemory::GetAddressSpaceWidth() const {
+    return process->VMManager().GetAddressSpaceWidth();
+}
+
+} // namespace Bench
@@ -0,0 +1,47 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/kernel/object.h"
+
+namespace Common {
+struct PageTable;
+}
+
+namespace Kernel {
+class Process;
+}
+
+namespace Bench {
+
+/// Guest address of the memory accessed by the benchmarks
+constexpr VAddr GUEST_MEMORY_BASE = 0x10000000;
+constexpr std::size_t GUEST_MEMORY_SIZE = 16 * 1024 * 1024;
+
+/// Process whose page table maps the memory accessed by the benchmarks
+class GuestMemory {
+public:
+    /// Returns the memory, its process is made the current one on every call
+    static GuestMemory& Get();
+
+    /// Returns the host memory backing the guest address, which must be in the mapped range
+    u8* GetPointer(VAddr address);
+
+    Common::PageTable& GetPageTable();
+
+    std::size_t GetAddressSpaceWidth() const;
+
+private:
+    GuestMemory();
+    ~GuestMemory();
+
+    std::vector<u8> memory;
+    Kernel::SharedPtr<Kernel::Process> process;
+};
+
+} // namespace Bench
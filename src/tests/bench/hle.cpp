@@ -0,0 +1,60 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/common_types.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/thread.h"
+#include "tests/bench/bench.h"
+#include "core/hle/service/nvflinger/buffer_queue.h"
+#include "tests/core/hle/kernel/hle_ipc_test_common.h"
+#include "tests/core/hle/service/vi/vi_test_common.h"
+
+namespace {
+
+/// Builds a context from a request with every kind of buffer descriptor, the part of every
+/// SendSyncRequest that runs before the service handler
+void ParseRequest(Bench::State& state) {
+    KernelTests::SessionEnvironment environment;
+    const KernelTests::CommandBuffer request = KernelTests::MakeRequest();
+    u64 checksum = 0;
+    while (state.KeepRunning()) {
+        KernelTests::CommandBuffer cmdbuf = request;
+        Kernel::HLERequestContext context(environment.server_session, nullptr);
+        context.PopulateFromIncomingCommandBuffer(environment.handle_table, cmdbuf.data());
+        checksum += context.GetCommand() + context.BufferDescriptorC().size();
+    }
+    Bench::DoNotOptimize(checksum);
+}
+
+/// The frame loop of a game: dequeue, request and queue a buffer, which the compositor acquires
+/// and releases. Reported as transactions per second
+void BinderFrameLoop(Bench::State& state) {
+    using namespace ViTests;
+
+    BinderDriverFixture fixture;
+    auto& buffer_queue = fixture.GetBufferQueue();
+    u64 checksum = 0;
+    while (state.KeepRunning()) {
+        const u8* response =
+            fixture.Transact(DEQUEUE_BUFFER, DequeueBufferRequest{1, 1280, 720, 0, 0});
+        const u32 slot = ReadWord(response, 16);
+        response = fixture.Transact(REQUEST_BUFFER, u32_le{slot});
+        checksum += ReadWord(response, 28 + 4);
+
+        QueueBufferRequest queue_request{};
+        queue_request.slot = slot;
+        fixture.Transact(QUEUE_BUFFER, queue_request);
+        buffer_queue.ReleaseBuffer(buffer_queue.AcquireBuffer()->get().slot);
+    }
+    Bench::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.GetIterations() * 3);
+}
+
+const Bench::Registration registrations[]{
+    {"hle/HLERequestContext/Parse", ParseRequest},
+    {"hle/IHOSBinderDriver/FrameLoop", BinderFrameLoop},
+};
+
+} // Anonymous namespace
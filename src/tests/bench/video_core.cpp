@@ -0,0 +1,233 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+#include "tests/bench/bench.h"
+#include "video_core/morton.h"
+#include "video_core/renderer_opengl/gl_device.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+#include "video_core/shader/shader_ir.h"
+#include "video_core/surface.h"
+#include "video_core/textures/astc.h"
+#include "video_core/textures/decoders.h"
+
+namespace {
+
+constexpr u32 TEXTURE_WIDTH = 1024;
+constexpr u32 TEXTURE_HEIGHT = 1024;
+constexpr u32 BYTES_PER_PIXEL = 4;
+/// Block height in GOBs of the textures, the common one of render targets
+constexpr u32 BLOCK_HEIGHT = 16;
+
+/// Offset of the main function of graphics programs, after their header
+constexpr u32 PROGRAM_OFFSET = 10;
+
+/// Instructions of the synthetic program, about the size of a large fragment shader
+constexpr std::size_t SYNTHETIC_INSTRUCTIONS = 1500;
+
+std::vector<u8> MakeData(std::size_t size) {
+    std::vector<u8> data(size);
+    u32 seed = 0x9E3779B9;
+    for (auto& value : data) {
+        seed = seed * 1664525 + 1013904223;
+        value = static_cast<u8>(seed >> 24);
+    }
+    return data;
+}
+
+void Morton(Bench::State& state, VideoCore::MortonSwizzleMode mode) {
+    const std::size_t swizzled_size = Tegra::Texture::CalculateSize(
+        true, BYTES_PER_PIXEL, TEXTURE_WIDTH, TEXTURE_HEIGHT, 1, BLOCK_HEIGHT, 1);
+    std::vector<u8> swizzled = MakeData(swizzled_size);
+    std::vector<u8> linear(TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_PIXEL);
+    while (state.KeepRunning()) {
+        VideoCore::MortonSwizzle(mode, VideoCore::Surface::PixelFormat::ABGR8U, TEXTURE_WIDTH,
+                                 BLOCK_HEIGHT, TEXTURE_HEIGHT, 1, 1, 0, linear.data(),
+                                 swizzled.data());
+        Bench::DoNotOptimize(linear.data());
+    }
+    state.SetBytesProcessed(linear.size());
+}
+
+void Unswizzle(Bench::State& state) {
+    const std::size_t swizzled_size = Tegra::Texture::CalculateSize(
+        true, BYTES_PER_PIXEL, TEXTURE_WIDTH, TEXTURE_HEIGHT, 1, BLOCK_HEIGHT, 1);
+    std::vector<u8> swizzled = MakeData(swizzled_size);
+    std::vector<u8> linear(TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_PIXEL);
+    while (state.KeepRunning()) {
+        Tegra::Texture::UnswizzleTexture(linear.data(), swizzled.data(), 1, 1, BYTES_PER_PIXEL,
+                                         TEXTURE_WIDTH, TEXTURE_HEIGHT, 1, BLOCK_HEIGHT, 1);
+        Bench::DoNotOptimize(linear.data());
+    }
+    state.SetBytesProcessed(linear.size());
+}
+
+/// Decompresses 4x4 blocks of pseudo-random data, a mix of valid and error blocks
+void AstcDecompress(Bench::State& state) {
+    constexpr u32 width = 512;
+    constexpr u32 height = 512;
+    const std::vector<u8> blocks = MakeData((width / 4) * (height / 4) * 16);
+    while (state.KeepRunning()) {
+        const auto texels =
+            Tegra::Texture::ASTC::Decompress(blocks.data(), width, height, 1, 4, 4);
+        Bench::DoNotOptimize(texels.data());
+    }
+    state.SetBytesProcessed(width * height * 4);
+}
+
+struct ShaderProgram {
+    VideoCommon::Shader::ProgramCode code;
+    OpenGL::GLShader::ProgramType type;
+};
+
+/// Returns the programs of the shader cache passed to yuzu-bench, nothing if there is none
+std::optional<std::vector<ShaderProgram>> LoadShaderCorpus(Bench::State& state) {
+    const std::string& path = Bench::GetOptions().shader_cache_path;
+    if (path.empty()) {
+        state.SkipWithMessage("No transferable shader cache given with --shaders");
+        return {};
+    }
+    const auto transferable = OpenGL::ShaderDiskCacheOpenGL::LoadTransferableFile(path);
+    if (!transferable) {
+        state.SkipWithMessage("Failed to load the transferable shader cache");
+        return {};
+    }
+
+    using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+    std::vector<ShaderProgram> programs;
+    for (const auto& raw : transferable->first) {
+        // The decompiler has no tessellation stages yet
+        switch (raw.GetProgramStage()) {
+        case Maxwell::ShaderStage::Vertex:
+            programs.push_back({raw.GetProgramCode(), OpenGL::GLShader::ProgramType::Vertex});
+            if (raw.HasProgramA()) {
+                programs.push_back(
+                    {raw.GetProgramCodeB(), OpenGL::GLShader::ProgramType::Vertex});
+            }
+            break;
+        case Maxwell::ShaderStage::Geometry:
+            programs.push_back({raw.GetProgramCode(), OpenGL::GLShader::ProgramType::Geometry});
+            break;
+        case Maxwell::ShaderStage::Fragment:
+            programs.push_back({raw.GetProgramCode(), OpenGL::GLShader::ProgramType::Fragment});
+            break;
+        default:
+            break;
+        }
+    }
+    if (programs.empty()) {
+        state.SkipWithMessage("The transferable shader cache has no programs");
+        return {};
+    }
+    return programs;
+}
+
+/**
+ * Builds a vertex program that loads constants to a few registers and chains float additions
+ * between them, so the shader benchmarks have a program to work on without a shader cache.
+ */
+ShaderProgram MakeSyntheticProgram() {
+    // Encodings with the always true predicate, the register operands go in the low bits
+    constexpr u64 MOV32I = 0x010000000007F000;
+    constexpr u64 FADD32I = 0x0800000000070000;
+    constexpr u64 EXIT = 0xE30000000007000F;
+    constexpr u64 SCHED = 0x001F8000FC0007E0;
+    constexpr u64 NUM_REGISTERS = 8;
+    constexpr u64 ONE_HALF = 0x3F000000;
+
+    VideoCommon::Shader::ProgramCode code(PROGRAM_OFFSET);
+    for (std::size_t i = 0; i < SYNTHETIC_INSTRUCTIONS; ++i) {
+        // Every group of three instructions is preceded by its scheduling word
+        if (i % 3 == 0) {
+            code.push_back(SCHED);
+        }
+        const u64 dest = i % NUM_REGISTERS;
+        if (i < NUM_REGISTERS) {
+            code.push_back(MOV32I | (static_cast<u64>(0x3F800000 + i) << 20) | dest);
+        } else {
+            const u64 src = (i + 3) % NUM_REGISTERS;
+            code.push_back(FADD32I | (ONE_HALF << 20) | (src << 8) | dest);
+        }
+    }
+    if (SYNTHETIC_INSTRUCTIONS % 3 == 0) {
+        code.push_back(SCHED);
+    }
+    code.push_back(EXIT);
+    code.resize(code.size() + 4);
+    return {std::move(code), OpenGL::GLShader::ProgramType::Vertex};
+}
+
+/// Returns the programs of the shader cache, or the synthetic program when is_synthetic is set
+std::optional<std::vector<ShaderProgram>> LoadShaderPrograms(Bench::State& state,
+                                                             bool is_synthetic) {
+    if (is_synthetic) {
+        return std::vector<ShaderProgram>{MakeSyntheticProgram()};
+    }
+    return LoadShaderCorpus(state);
+}
+
+u64 GetCorpusSize(const std::vector<ShaderProgram>& programs) {
+    u64 size = 0;
+    for (const auto& program : programs) {
+        size += program.code.size() * sizeof(u64);
+    }
+    return size;
+}
+
+/// Decodes every program to the shader IR, an iteration is the whole corpus
+void ShaderDecode(Bench::State& state, bool is_synthetic) {
+    const auto programs = LoadShaderPrograms(state, is_synthetic);
+    if (!programs) {
+        return;
+    }
+    while (state.KeepRunning()) {
+        for (const auto& program : *programs) {
+            const VideoCommon::Shader::ShaderIR ir(program.code, PROGRAM_OFFSET);
+            Bench::DoNotOptimize(ir);
+        }
+    }
+    state.SetBytesProcessed(GetCorpusSize(*programs));
+}
+
+/// Decodes and decompiles every program to GLSL, the work of a cache miss
+void ShaderDecompileGLSL(Bench::State& state, bool is_synthetic) {
+    const auto programs = LoadShaderPrograms(state, is_synthetic);
+    if (!programs) {
+        return;
+    }
+    const OpenGL::Device device{nullptr};
+    while (state.KeepRunning()) {
+        for (const auto& program : *programs) {
+            const VideoCommon::Shader::ShaderIR ir(program.code, PROGRAM_OFFSET);
+            const auto result = OpenGL::GLShader::Decompile(device, ir, program.type, "bench");
+            Bench::DoNotOptimize(result.first.data());
+        }
+    }
+    state.SetBytesProcessed(GetCorpusSize(*programs));
+}
+
+const Bench::Registration registrations[]{
+    {"texture/MortonSwizzle/MortonToLinear",
+     [](Bench::State& state) {
+         Morton(state, VideoCore::MortonSwizzleMode::MortonToLinear);
+     }},
+    {"texture/MortonSwizzle/LinearToMorton",
+     [](Bench::State& state) {
+         Morton(state, VideoCore::MortonSwizzleMode::LinearToMorton);
+     }},
+    {"texture/UnswizzleTexture", Unswizzle},
+    {"texture/ASTC/Decompress4x4", AstcDecompress},
+    {"shader/Decode/Corpus", [](Bench::State& state) { ShaderDecode(state, false); }},
+    {"shader/Decode/Synthetic", [](Bench::State& state) { ShaderDecode(state, true); }},
+    {"shader/DecompileGLSL/Corpus",
+     [](Bench::State& state) { ShaderDecompileGLSL(state, false); }},
+    {"shader/DecompileGLSL/Synthetic",
+     [](Bench::State& state) { ShaderDecompileGLSL(state, true); }},
+};
+
+} // Anonymous namespace
@@ -0,0 +1,68 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <thread>
+#include <utility>
+#include <catch2/catch.hpp>
+#include "common/buffer_pool.h"
+
+namespace Common {
+
+TEST_CASE("BufferPool[ReusesBuffersOfTheSameClass]", "[common]") {
+    // Run on a thread of its own, so the free lists start empty
+    std::thread{[] {
+        const u8* first_data = nullptr;
+        {
+            PooledVector first = BufferPool::Acquire(3000);
+            REQUIRE(first.size() == 3000);
+            first_data = first.data();
+        }
+
+        const auto before = BufferPool::GetStats();
+        PooledVector second = BufferPool::Acquire(4096);
+        REQUIRE(second.size() == 4096);
+        REQUIRE(second.data() == first_data);
+        REQUIRE(BufferPool::GetStats().reused == before.reused + 1);
+
+        // A buffer of another size class is allocated
+        PooledVector third = BufferPool::Acquire(5000);
+        REQUIRE(third.data() != first_data);
+    }}.join();
+}
+
+TEST_CASE("BufferPool[ReleasedBuffersLeaveThePool]", "[common]") {
+    std::thread{[] {
+        std::vector<u8> released;
+        {
+            PooledVector buffer = BufferPool::Acquire(1024);
+            buffer[0] = 42;
+            released = buffer.Release();
+            REQUIRE(buffer.empty());
+        }
+        REQUIRE(released.size() == 1024);
+        REQUIRE(released[0] == 42);
+
+        const auto before = BufferPool::GetStats();
+        PooledVector buffer = BufferPool::Acquire(1024);
+        REQUIRE(BufferPool::GetStats().reused == before.reused);
+    }}.join();
+}
+
+TEST_CASE("BufferPool[CopiesAndMoves]", "[common]") {
+    PooledVector original = BufferPool::Acquire(512);
+    for (std::size_t i = 0; i < original.size(); ++i) {
+        original[i] = static_cast<u8>(i);
+    }
+
+    const PooledVector copy{original};
+    REQUIRE(copy.Vector() == original.Vector());
+    REQUIRE(copy.data() != original.data());
+
+    const u8* data = original.data();
+    PooledVector moved{std::move(original)};
+    REQUIRE(moved.data() == data);
+    REQUIRE(original.empty());
+}
+
+} // namespace Common
@@ -0,0 +1,94 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/hash.h"
+
+namespace Common {
+
+namespace {
+
+struct HashVector {
+    std::size_t len;
+    u64 hash;
+    u64 seeded_hash;
+};
+
+constexpr u64 TEST_SEED = 0x9e3779b97f4a7c15ULL;
+
+// XXH3_64bits and XXH3_64bits_withSeed of the bytes made by MakeInput, one per size class
+constexpr std::array<HashVector, 15> HASH_VECTORS{{
+    {0, 0x2d06800538d394c2ULL, 0x602b0e2cd6662c8bULL},
+    {1, 0x4c5cca45d0f4811fULL, 0x2f3acd3805f81de3ULL},
+    {3, 0x6e3e2670e61106acULL, 0xbc74611d87f659e0ULL},
+    {4, 0x5c4c63133443d03fULL, 0x6c3753177c607de4ULL},
+    {8, 0xf9fd4dd0b04d78f5ULL, 0xbc72d0531396303fULL},
+    {9, 0x7c20df9712c26edfULL, 0x93c5aa006102daf5ULL},
+    {16, 0x86abf6baccea0858ULL, 0x69d001b16ecf450aULL},
+    {17, 0xb58bf5dc5022d071ULL, 0xb7c99d19be27eb69ULL},
+    {128, 0x10d17f72c0ccba41ULL, 0x49b81c6e0abb9305ULL},
+    {129, 0x1648bdc3db49d1a2ULL, 0x5e3831b221810b00ULL},
+    {240, 0xb6cfaf343fab81e6ULL, 0x76a73ec26433f82cULL},
+    {241, 0x956cae592c67279eULL, 0x2be236ba3bacf75cULL},
+    {1024, 0x70bd377d9574f4bbULL, 0xd8cf6b464541f232ULL},
+    {1025, 0x66c4487c41e127a7ULL, 0x8dc3a55e9c26d886ULL},
+    {4096, 0x9ddd66c14af0daffULL, 0xc7bc989f5d547a4dULL},
+}};
+
+std::vector<u8> MakeInput(std::size_t len) {
+    std::vector<u8> input(len);
+    for (std::size_t i = 0; i < len; ++i) {
+        input[i] = static_cast<u8>(i * 131 + 7);
+    }
+    return input;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ComputeHash64: Matches XXH3", "[common]") {
+    for (const auto& vector : HASH_VECTORS) {
+        const std::vector<u8> input = MakeInput(vector.len);
+        INFO("Length " << vector.len);
+        REQUIRE(ComputeHash64(input.data(), input.size()) == vector.hash);
+        REQUIRE(ComputeHash64(input.data(), input.size(), TEST_SEED) == vector.seeded_hash);
+    }
+}
+
+TEST_CASE("HashState: Pieces hash like the whole input", "[common]") {
+    const std::vector<u8> input = MakeInput(5000);
+    constexpr std::array<std::size_t, 6> piece_sizes{1, 7, 64, 100, 256, 1500};
+
+    // Every length that ends within, at and after the internal buffer and the blocks
+    for (std::size_t len = 0; len <= input.size(); len += len < 1100 ? 1 : 97) {
+        for (const std::size_t piece_size : piece_sizes) {
+            HashState state{TEST_SEED};
+            for (std::size_t offset = 0; offset < len; offset += piece_size) {
+                state.Update(input.data() + offset, std::min(piece_size, len - offset));
+            }
+            INFO("Length " << len << ", pieces of " << piece_size);
+            REQUIRE(state.Digest() == ComputeHash64(input.data(), len, TEST_SEED));
+        }
+    }
+}
+
+TEST_CASE("HashState: Digest doesn't end the hash", "[common]") {
+    const std::vector<u8> input = MakeInput(1000);
+    HashState state;
+    state.Update(input.data(), 300);
+    REQUIRE(state.Digest() == ComputeHash64(input.data(), 300));
+    state.Update(input.data() + 300, 700);
+    REQUIRE(state.Digest() == ComputeHash64(input.data(), 1000));
+
+    state.Reset();
+    state.UpdateStruct(u32{0x12345678});
+    const u32 value = 0x12345678;
+    REQUIRE(state.Digest() == ComputeStructHash64(value));
+}
+
+} // namespace Common
@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <limits>
+#include <catch2/catch.hpp>
+#include "common/histogram.h"
+
+namespace Common {
+
+TEST_CASE("Histogram[BucketBounds]", "[common]") {
+    for (u64 value = 0; value < 4; ++value) {
+        REQUIRE(Histogram::GetBucketIndex(value) == value);
+    }
+    REQUIRE(Histogram::GetBucketIndex(std::numeric_limits<u64>::max()) ==
+            Histogram::NumBuckets - 1);
+
+    // The buckets are contiguous and every value falls within the bounds of its bucket
+    for (std::size_t bucket = 1; bucket < Histogram::NumBuckets; ++bucket) {
+        REQUIRE(Histogram::GetBucketLowerBound(bucket) ==
+                Histogram::GetBucketUpperBound(bucket - 1) + 1);
+    }
+    for (const u64 value : {5ULL, 100ULL, 1000ULL, 16667ULL, 1ULL << 40}) {
+        const std::size_t bucket = Histogram::GetBucketIndex(value);
+        REQUIRE(Histogram::GetBucketLowerBound(bucket) <= value);
+        REQUIRE(Histogram::GetBucketUpperBound(bucket) >= value);
+        REQUIRE(Histogram::GetBucketUpperBound(bucket) - Histogram::GetBucketLowerBound(bucket) <
+                value / 4 + 1);
+    }
+}
+
+TEST_CASE("Histogram[Percentiles]", "[common]") {
+    Histogram histogram;
+    REQUIRE(histogram.GetPercentile(0.5) == 0);
+
+    for (u64 value = 1; value <= 100; ++value) {
+        histogram.Add(value);
+    }
+    REQUIRE(histogram.GetCount() == 100);
+    REQUIRE(histogram.GetSum() == 5050);
+    REQUIRE(histogram.GetMax() == 100);
+
+    const u64 median = histogram.GetPercentile(0.5);
+    REQUIRE(median >= 50);
+    REQUIRE(median < 64);
+    REQUIRE(histogram.GetPercentile(0.99) >= 99);
+    REQUIRE(histogram.GetPercentile(1.0) == 100);
+
+    histogram.Reset();
+    REQUIRE(histogram.GetCount() == 0);
+    REQUIRE(histogram.GetMax() == 0);
+}
+
+TEST_CASE("Histogram[Serialize]", "[common]") {
+    Histogram histogram;
+    histogram.Add(1);
+    histogram.Add(1);
+    histogram.Add(9);
+    REQUIRE(histogram.Serialize() == "1:2,8:1");
+}
+
+} // namespace Common
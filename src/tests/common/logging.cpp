@@ -0,0 +1,102 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+
+namespace {
+
+class CaptureBackend : public Log::Backend {
+public:
+    static const char* Name() {
+        return "capture";
+    }
+
+    const char* GetName() const override {
+        return Name();
+    }
+
+    void Write(const Log::Entry& entry) override {
+        {
+            std::lock_guard lock{mutex};
+            messages.push_back(entry.message);
+        }
+        condition.notify_all();
+    }
+
+    /// Waits for the logging thread to write a number of messages and returns them
+    std::vector<std::string> WaitForMessages(std::size_t count) {
+        std::unique_lock lock{mutex};
+        condition.wait_for(lock, std::chrono::seconds{5},
+                           [&] { return messages.size() >= count; });
+        return messages;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::string> messages;
+};
+
+enum Direction { Up, Down };
+
+} // Anonymous namespace
+
+TEST_CASE("Logging[DeferredFormat]", "[common]") {
+    auto backend = std::make_unique<CaptureBackend>();
+    auto* const capture = backend.get();
+    Log::AddBackend(std::move(backend));
+
+    // The arguments are copied, they can be gone by the time the message is formatted
+    std::thread thread([] {
+        std::string name = "yuzu";
+        LOG_INFO(Common, "{} {:#x} {:.1f} {} {}", name, 255u, 0.25, Down, "literal");
+        name = "changed";
+        LOG_INFO(Common, "{}", std::string_view{name}.substr(0, 3));
+    });
+    thread.join();
+
+    // Arguments that aren't copied are formatted right away, filtered messages are dropped
+    const int value = 7;
+    LOG_INFO(Common, "{}", static_cast<const void*>(nullptr));
+    LOG_DEBUG(Common, "{}", value);
+    LOG_INFO(Common, "{:08}", value);
+    LOG_INFO(Common, "{:d}", "not a number");
+
+    const auto messages = capture->WaitForMessages(5);
+    Log::RemoveBackend(CaptureBackend::Name());
+
+    REQUIRE(messages.size() == 5);
+    REQUIRE(messages[0] == "yuzu 0xff 0.2 1 literal");
+    REQUIRE(messages[1] == "cha");
+    REQUIRE(messages[2] == "0x0");
+    REQUIRE(messages[3] == "00000007");
+    REQUIRE(messages[4].find("Invalid log format") == 0);
+}
+
+TEST_CASE("Logging[RuntimeFormat]", "[common]") {
+    auto backend = std::make_unique<CaptureBackend>();
+    auto* const capture = backend.get();
+    Log::AddBackend(std::move(backend));
+
+    // Formats that aren't literals are formatted right away, their storage can be reused after
+    std::string format = "{} {}";
+    Log::FmtLogMessage(Log::Class::Common, Log::Level::Info, __FILE__, __LINE__, __func__,
+                       format.c_str(), 1, "runtime");
+    format.assign(format.size(), '?');
+
+    const auto messages = capture->WaitForMessages(1);
+    Log::RemoveBackend(CaptureBackend::Name());
+
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages[0] == "1 runtime");
+}
@@ -0,0 +1,46 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/memory_accounting.h"
+
+namespace Common::MemoryAccounting {
+
+// The counters are shared by the whole process, the tests only check the changes they make
+
+TEST_CASE("MemoryAccounting[Allocation]", "[common]") {
+    constexpr auto category = Category::ShaderDiskCache;
+    const u64 initial_live = GetLiveBytes(category);
+    {
+        Allocation allocation{category, 4096};
+        REQUIRE(GetLiveBytes(category) == initial_live + 4096);
+        REQUIRE(GetPeakBytes(category) >= initial_live + 4096);
+
+        allocation.Resize(16384);
+        REQUIRE(allocation.GetSize() == 16384);
+        REQUIRE(GetLiveBytes(category) == initial_live + 16384);
+
+        allocation.Resize(1024);
+        REQUIRE(GetLiveBytes(category) == initial_live + 1024);
+        // The peak keeps the largest size
+        REQUIRE(GetPeakBytes(category) >= initial_live + 16384);
+    }
+    REQUIRE(GetLiveBytes(category) == initial_live);
+}
+
+TEST_CASE("MemoryAccounting[Categories]", "[common]") {
+    const u64 initial_live = GetLiveBytes(Category::AudioBuffers);
+    Allocate(Category::LogQueue, 100);
+    REQUIRE(GetLiveBytes(Category::AudioBuffers) == initial_live);
+    Free(Category::LogQueue, 100);
+
+    REQUIRE(IsDeviceMemory(Category::TextureCache));
+    REQUIRE(IsDeviceMemory(Category::BufferCache));
+    REQUIRE_FALSE(IsDeviceMemory(Category::GuestMemory));
+    for (std::size_t i = 0; i < NumCategories; ++i) {
+        REQUIRE(GetName(static_cast<Category>(i))[0] != '\0');
+    }
+}
+
+} // namespace Common::MemoryAccounting
@@ -9,6 +9,7 @@
 #include <thread>
 #include <vector>
 #include <catch2/catch.hpp>
+#include "common/common_types.h"
 #include "common/ring_buffer.h"
 
 namespace Common {
@@ -127,4 +128,70 @@ TEST_CASE("RingBuffer: Threaded Test", "[common]") {
     printf("RingBuffer: Threaded Test: full: %zu, empty: %zu\n", full, empty);
 }
 
+TEST_CASE("RingBuffer: Reserve Wraps Around", "[common]") {
+    RingBuffer<u32, 1024> buf;
+
+    // Move the indices close to the end, so the next reservation wraps around it
+    std::vector<u32> filler(1000);
+    REQUIRE(buf.Push(filler) == 1000);
+    REQUIRE(buf.Pop(1000).size() == 1000);
+
+    auto span = buf.Reserve(100);
+    if (buf.IsMirrored()) {
+        REQUIRE(span.size == 100);
+    } else {
+        REQUIRE(span.size == 24);
+    }
+    std::iota(span.data, span.data + span.size, 0u);
+    buf.Commit(span.size);
+    REQUIRE(buf.Size() == span.size);
+
+    // Reservations never exceed the free slots
+    REQUIRE(buf.Reserve(2000).size <= 1024 - span.size);
+
+    const auto [first, second] = buf.Peek();
+    REQUIRE(first.size + second.size == span.size);
+    REQUIRE(second.size == 0);
+    for (std::size_t i = 0; i < first.size; ++i) {
+        REQUIRE(first.data[i] == i);
+    }
+    buf.Consume(first.size);
+    REQUIRE(buf.Size() == 0);
+
+    // The slots written in place are the ones Pop copies out
+    span = buf.Reserve(1024);
+    std::iota(span.data, span.data + span.size, 7u);
+    buf.Commit(span.size);
+    const std::vector<u32> popped = buf.Pop();
+    REQUIRE(popped.size() == span.size);
+    for (std::size_t i = 0; i < popped.size(); ++i) {
+        REQUIRE(popped[i] == i + 7);
+    }
+}
+
+TEST_CASE("RingBuffer: Peek Without Mirroring", "[common]") {
+    // Three bytes can't be mirrored, the filled slots wrapping around the end take two spans
+    RingBuffer<char, 4, 1> buf;
+    REQUIRE(!buf.IsMirrored());
+
+    REQUIRE(buf.Push(std::vector<char>{1, 2, 3}) == 3);
+    buf.Pop(2);
+    REQUIRE(buf.Push(std::vector<char>{4, 5}) == 2);
+
+    const auto [first, second] = buf.Peek();
+    REQUIRE(first.size == 2);
+    REQUIRE(first.data[0] == 3);
+    REQUIRE(first.data[1] == 4);
+    REQUIRE(second.size == 1);
+    REQUIRE(second.data[0] == 5);
+    buf.Consume(3);
+    REQUIRE(buf.Size() == 0);
+
+    // The reservation stops at the end
+    const auto span = buf.Reserve(4);
+    REQUIRE(span.size == 3);
+    buf.Commit(0);
+    REQUIRE(buf.Size() == 0);
+}
+
 } // namespace Common
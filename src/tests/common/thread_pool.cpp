@@ -0,0 +1,82 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool[Submit]", "[common]") {
+    ThreadPool pool{3};
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.Submit([i] { return i * 2; }, static_cast<TaskPriority>(i % 3)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(results[i].get() == i * 2);
+    }
+}
+
+TEST_CASE("ThreadPool[ParallelFor]", "[common]") {
+    ThreadPool pool{4};
+    std::vector<int> values(10000);
+    pool.ParallelFor(values.size(), 100, [&](std::size_t begin, std::size_t end) {
+        std::iota(values.begin() + begin, values.begin() + end, static_cast<int>(begin));
+    });
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(values[i] == static_cast<int>(i));
+    }
+
+    // Tasks of the pool can split their work too, the waiting threads run chunks themselves
+    std::vector<std::future<long>> sums;
+    for (int task = 0; task < 8; ++task) {
+        sums.push_back(pool.Submit([&pool] {
+            std::atomic<long> sum{0};
+            pool.ParallelFor(1000, 10, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    sum += static_cast<long>(i);
+                }
+            });
+            return sum.load();
+        }));
+    }
+    for (auto& sum : sums) {
+        REQUIRE(sum.get() == 999 * 1000 / 2);
+    }
+}
+
+TEST_CASE("ThreadPool[ReserveHostThreads]", "[common]") {
+    // Tasks queued to the workers that become idle are taken by the others
+    ThreadPool pool{4};
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(pool.Submit([i] { return i; }));
+    }
+    pool.ReserveHostThreads(1000);
+    REQUIRE(pool.GetNumThreads() == 1);
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(pool.Submit([i] { return i; }));
+    }
+    for (int i = 0; i < 40; ++i) {
+        REQUIRE(results[i].get() == i % 20);
+    }
+}
+
+TEST_CASE("ThreadPool[Shutdown]", "[common]") {
+    // Queued tasks still run when the pool is destroyed
+    std::atomic_int count{0};
+    {
+        ThreadPool pool{2};
+        for (int i = 0; i < 50; ++i) {
+            pool.Submit([&count] { ++count; }, TaskPriority::Low);
+        }
+    }
+    REQUIRE(count == 50);
+}
+
+} // namespace Common
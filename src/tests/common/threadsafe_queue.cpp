@@ -0,0 +1,228 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("BoundedSPSCQueue: Basic Tests", "[common]") {
+    BoundedSPSCQueue<int, 4> queue;
+    REQUIRE(queue.Empty());
+
+    // Pushing values into a queue with space should succeed.
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(queue.TryPush(i));
+    }
+
+    REQUIRE(queue.Size() == 4);
+    REQUIRE(queue.Full());
+
+    // Pushing values into a full queue should fail.
+    REQUIRE(!queue.TryPush(42));
+    REQUIRE(queue.Size() == 4);
+
+    // Values are popped in the order they were pushed, also after wrapping around.
+    int value = -1;
+    REQUIRE(queue.Pop(value));
+    REQUIRE(value == 0);
+    REQUIRE(queue.TryPush(4));
+
+    for (int i = 1; i < 5; i++) {
+        REQUIRE(queue.Pop(value));
+        REQUIRE(value == i);
+    }
+
+    // Popping from an empty queue should fail.
+    REQUIRE(queue.Empty());
+    REQUIRE(!queue.Pop(value));
+}
+
+TEST_CASE("BoundedSPSCQueue: Failed pushes keep the element", "[common]") {
+    BoundedSPSCQueue<std::vector<int>, 1> queue;
+    REQUIRE(queue.TryPush(std::vector<int>{1}));
+
+    std::vector<int> element{2, 3};
+    REQUIRE(!queue.TryPush(std::move(element)));
+    REQUIRE(element.size() == 2);
+
+    std::vector<int> popped;
+    REQUIRE(queue.Pop(popped));
+    REQUIRE(popped == std::vector<int>{1});
+    REQUIRE(queue.TryPush(std::move(element)));
+    REQUIRE(queue.Pop(popped));
+    REQUIRE(popped == std::vector<int>{2, 3});
+}
+
+TEST_CASE("BoundedSPSCQueue: Threaded Test", "[common]") {
+    BoundedSPSCQueue<std::vector<std::size_t>, 8> queue;
+    constexpr std::size_t count = 100000;
+
+    std::thread producer{[&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            std::vector<std::size_t> element{i, i * 2};
+            while (!queue.TryPush(std::move(element))) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    std::size_t expected = 0;
+    bool in_order = true;
+    std::vector<std::size_t> element;
+    while (expected < count) {
+        if (!queue.Pop(element)) {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order &= element == std::vector<std::size_t>{expected, expected * 2};
+        ++expected;
+    }
+
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("BoundedSPSCQueue: Batches", "[common]") {
+    BoundedSPSCQueue<int, 8> queue;
+    std::array<int, 6> values{0, 1, 2, 3, 4, 5};
+
+    // Only the elements that fit are pushed
+    REQUIRE(queue.PushBatch(values.data(), values.size()) == 6);
+    REQUIRE(queue.PushBatch(values.data(), values.size()) == 2);
+    REQUIRE(queue.Full());
+
+    std::array<int, 8> popped{};
+    REQUIRE(queue.PopBatch(popped.data(), 4) == 4);
+    REQUIRE(popped[3] == 3);
+
+    // Batches wrap around the end of the ring
+    REQUIRE(queue.PushBatch(values.data(), 4) == 4);
+    REQUIRE(queue.PopBatch(popped.data(), popped.size()) == 8);
+    REQUIRE(popped == std::array<int, 8>{4, 5, 0, 1, 0, 1, 2, 3});
+    REQUIRE(queue.PopBatch(popped.data(), popped.size()) == 0);
+}
+
+TEST_CASE("BoundedSPSCQueue: Blocking Test", "[common]") {
+    BoundedSPSCQueue<std::size_t, 4> queue;
+    constexpr std::size_t count = 100000;
+
+    // Both threads sleep on the queue, the producer when it is full and the consumer when empty
+    std::thread producer{[&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            queue.PushWait(i);
+        }
+    }};
+
+    std::size_t expected = 0;
+    bool in_order = true;
+    std::array<std::size_t, 3> popped;
+    while (expected < count) {
+        const std::size_t num_popped = queue.PopBatchWait(popped.data(), popped.size());
+        for (std::size_t i = 0; i < num_popped; ++i) {
+            in_order &= popped[i] == expected++;
+        }
+    }
+
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("BoundedMPSCQueue: Basic Tests", "[common]") {
+    BoundedMPSCQueue<int, 4> queue;
+    REQUIRE(queue.Empty());
+
+    REQUIRE(queue.TryPush(0));
+    std::array<int, 5> values{1, 2, 3, 4, 5};
+    REQUIRE(queue.PushBatch(values.data(), values.size()) == 3);
+    REQUIRE(queue.Full());
+    REQUIRE(!queue.TryPush(42));
+
+    int value = -1;
+    REQUIRE(queue.Pop(value));
+    REQUIRE(value == 0);
+    REQUIRE(queue.TryPush(4));
+
+    std::array<int, 8> popped{};
+    REQUIRE(queue.PopBatch(popped.data(), popped.size()) == 4);
+    REQUIRE(popped[0] == 1);
+    REQUIRE(popped[3] == 4);
+
+    REQUIRE(queue.Empty());
+    REQUIRE(!queue.Pop(value));
+}
+
+TEST_CASE("BoundedMPSCQueue: Threaded Test", "[common]") {
+    BoundedMPSCQueue<std::size_t, 16> queue;
+    constexpr std::size_t num_producers = 4;
+    constexpr std::size_t count = 50000;
+
+    // Each producer pushes its index followed by a counter, half of them in batches
+    std::vector<std::thread> producers;
+    for (std::size_t producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (std::size_t i = 0; i < count; i += 2) {
+                std::array<std::size_t, 2> batch{producer * count + i, producer * count + i + 1};
+                if (producer % 2 == 0) {
+                    queue.PushWait(batch[0]);
+                    queue.PushWait(batch[1]);
+                    continue;
+                }
+                std::size_t pushed = 0;
+                while (pushed < batch.size()) {
+                    pushed += queue.PushBatch(batch.data() + pushed, batch.size() - pushed);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Elements of the same producer come out in the order they were pushed
+    std::array<std::size_t, num_producers> next{};
+    bool in_order = true;
+    std::array<std::size_t, 8> popped;
+    for (std::size_t total = 0; total < num_producers * count;) {
+        const std::size_t num_popped = queue.PopBatchWait(popped.data(), popped.size());
+        for (std::size_t i = 0; i < num_popped; ++i) {
+            const std::size_t producer = popped[i] / count;
+            in_order &= popped[i] % count == next[producer]++;
+        }
+        total += num_popped;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(in_order);
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("SPSCQueue: PopWait", "[common]") {
+    SPSCQueue<int> queue;
+    std::thread producer{[&] {
+        for (int i = 0; i < 1000; ++i) {
+            queue.Push(i);
+        }
+    }};
+
+    bool in_order = true;
+    for (int i = 0; i < 1000; ++i) {
+        in_order &= queue.PopWait() == i;
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE(queue.Empty());
+}
+
+} // namespace Common
@@ -0,0 +1,92 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/thread.h"
+#include "common/trace.h"
+
+TRACE_DEFINE(Test_Outer, "Test", "Outer", MP_RGB(128, 128, 192));
+
+namespace Common::Trace {
+
+namespace {
+
+constexpr char TRACE_PATH[] = "trace_test.json";
+
+/// Writes the recorded events and returns the written trace
+std::string WriteTrace() {
+    REQUIRE(WriteChromeTrace(TRACE_PATH));
+    std::string trace;
+    FileUtil::ReadFileToString(false, TRACE_PATH, trace);
+    FileUtil::Delete(TRACE_PATH);
+    return trace;
+}
+
+std::size_t CountOccurrences(const std::string& str, const std::string& substr) {
+    std::size_t count = 0;
+    for (auto pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Trace[RecordsScopesAndCounters]", "[common]") {
+    Start();
+    std::thread{[] {
+        SetCurrentThreadName("yuzu:Traced");
+        TRACE_SCOPE(Test_Outer);
+        {
+            TRACE_SCOPE_DYNAMIC("Test", "Inner \"quoted\"");
+        }
+        TRACE_COUNTER("Test", "Counter", 42);
+    }}.join();
+    Stop();
+
+    const std::string trace = WriteTrace();
+    REQUIRE(trace.find("\"traceEvents\":[") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"name\":\"yuzu:Traced\"}") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"Outer\",\"cat\":\"Test\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"Inner \\\"quoted\\\"\"") != std::string::npos);
+    REQUIRE(trace.find("\"ph\":\"C\",\"args\":{\"value\":42}") != std::string::npos);
+    REQUIRE(CountOccurrences(trace, "\"ph\":\"X\"") == 2);
+}
+
+TEST_CASE("Trace[DisabledRecordsNothing]", "[common]") {
+    Start();
+    Stop();
+    std::thread{[] {
+        TRACE_SCOPE(Test_Outer);
+        TRACE_COUNTER("Test", "Counter", 1);
+    }}.join();
+
+    const std::string trace = WriteTrace();
+    REQUIRE(CountOccurrences(trace, "\"ph\":\"X\"") == 0);
+    REQUIRE(CountOccurrences(trace, "\"ph\":\"C\"") == 0);
+}
+
+TEST_CASE("Trace[RingKeepsNewestEvents]", "[common]") {
+    Start(4);
+    std::thread{[] {
+        for (int i = 0; i < 10; ++i) {
+            TRACE_COUNTER("Test", "Counter", i);
+        }
+    }}.join();
+    Stop();
+
+    const std::string trace = WriteTrace();
+    REQUIRE(CountOccurrences(trace, "\"ph\":\"C\"") == 4);
+    REQUIRE(trace.find("{\"value\":5}") == std::string::npos);
+    for (int i = 6; i < 10; ++i) {
+        REQUIRE(trace.find(fmt::format("{{\"value\":{}}}", i)) != std::string::npos);
+    }
+}
+
+} // namespace Common::Trace
@@ -0,0 +1,60 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/triple_buffer.h"
+
+namespace Common {
+
+TEST_CASE("TripleBuffer[ReadsLatestState]", "[common]") {
+    TripleBuffer<int> buffer;
+    REQUIRE(buffer.Read() == 0);
+
+    buffer.GetWriteBuffer() = 1;
+    REQUIRE(buffer.Read() == 0);
+    buffer.Publish();
+    buffer.GetWriteBuffer() = 2;
+    buffer.Publish();
+    REQUIRE(buffer.Read() == 2);
+    REQUIRE(buffer.Read() == 2);
+
+    buffer.GetWriteBuffer() = 3;
+    buffer.Publish();
+    REQUIRE(buffer.Read() == 3);
+}
+
+TEST_CASE("TripleBuffer[ConcurrentStatesAreComplete]", "[common]") {
+    // Every element of a published state has the same value, a torn read would mix them
+    using State = std::array<u32, 64>;
+    TripleBuffer<State> buffer;
+    constexpr u32 num_states = 100000;
+
+    std::thread writer{[&buffer] {
+        for (u32 value = 1; value <= num_states; ++value) {
+            buffer.GetWriteBuffer().fill(value);
+            buffer.Publish();
+        }
+    }};
+
+    u32 last_value = 0;
+    bool is_complete = true;
+    bool is_ordered = true;
+    while (last_value != num_states) {
+        const State& state = buffer.Read();
+        for (const u32 element : state) {
+            is_complete &= element == state[0];
+        }
+        is_ordered &= state[0] >= last_value;
+        last_value = state[0];
+    }
+    writer.join();
+
+    REQUIRE(is_complete);
+    REQUIRE(is_ordered);
+}
+
+} // namespace Common
@@ -0,0 +1,67 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/arm/exclusive_monitor.h"
+#include "core/memory.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace ArmTests {
+
+TEST_CASE("ReservationExclusiveMonitor[Commit]", "[core]") {
+    TestEnvironment test_env{true};
+    Core::ReservationExclusiveMonitor monitor{4};
+
+    // Writes without a reservation fail and leave memory untouched
+    test_env.SetMemory32(0x1000, 0);
+    REQUIRE(!monitor.ExclusiveWrite32(0, 0x1000, 1));
+    REQUIRE(Memory::Read32(0x1000) == 0);
+
+    monitor.SetExclusive(0, 0x1000);
+    REQUIRE(monitor.ExclusiveWrite32(0, 0x1000, 1));
+    REQUIRE(Memory::Read32(0x1000) == 1);
+
+    // A successful write consumes the reservation
+    REQUIRE(!monitor.ExclusiveWrite32(0, 0x1000, 2));
+    REQUIRE(Memory::Read32(0x1000) == 1);
+
+    // Reservations cover the whole cacheline but not the next one
+    monitor.SetExclusive(1, 0x1000);
+    REQUIRE(monitor.ExclusiveWrite32(1, 0x103C, 3));
+    monitor.SetExclusive(1, 0x1000);
+    REQUIRE(!monitor.ExclusiveWrite32(1, 0x1040, 4));
+    REQUIRE(Memory::Read32(0x1040) == 0);
+}
+
+TEST_CASE("ReservationExclusiveMonitor[Contention]", "[core]") {
+    TestEnvironment test_env{true};
+    Core::ReservationExclusiveMonitor monitor{4};
+    test_env.SetMemory64(0x2000, 0);
+
+    // The first core to commit wins, the other core's reservation is lost
+    monitor.SetExclusive(0, 0x2000);
+    monitor.SetExclusive(1, 0x2008);
+    REQUIRE(monitor.ExclusiveWrite64(1, 0x2008, 5));
+    REQUIRE(!monitor.ExclusiveWrite64(0, 0x2000, 6));
+    REQUIRE(Memory::Read64(0x2000) == 0);
+    REQUIRE(Memory::Read64(0x2008) == 5);
+
+    // Reservations on other cachelines are kept
+    monitor.SetExclusive(2, 0x3000);
+    monitor.SetExclusive(3, 0x2000);
+    REQUIRE(monitor.ExclusiveWrite64(3, 0x2000, 7));
+    REQUIRE(monitor.ExclusiveWrite64(2, 0x3000, 8));
+
+    // Clearing drops the reservations of all cores
+    monitor.SetExclusive(0, 0x2000);
+    monitor.SetExclusive(1, 0x3000);
+    monitor.ClearExclusive();
+    REQUIRE(!monitor.ExclusiveWrite64(0, 0x2000, 9));
+    REQUIRE(!monitor.ExclusiveWrite64(1, 0x3000, 10));
+    REQUIRE(Memory::Read64(0x2000) == 7);
+}
+
+} // namespace ArmTests
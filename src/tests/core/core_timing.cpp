@@ -6,10 +6,16 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/core_timing_queue.h"
+#include "core/core_timing_util.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
 static constexpr std::array<u64, 5> CB_IDS{{42, 144, 93, 1026, UINT64_C(0xFFFF7FFFF7FFFF)}};
@@ -29,8 +35,11 @@ void CallbackTemplate(u64 userdata, s64 cycles_late) {
 }
 
 struct ScopeInit final {
-    ScopeInit() {
-        core_timing.Initialize();
+    explicit ScopeInit(Core::Timing::EventQueueType queue_type =
+                           Core::Timing::EventQueueType::TimingWheel,
+                       bool use_host_timing = false)
+        : core_timing{queue_type} {
+        core_timing.Initialize(use_host_timing);
     }
     ~ScopeInit() {
         core_timing.Shutdown();
@@ -127,6 +136,39 @@ TEST_CASE("CoreTiming[Threadsave]", "[core]") {
     AdvanceAndCheck(core_timing, 4, MAX_SLICE_LENGTH);
 }
 
+TEST_CASE("CoreTiming[CrossThreadOrder]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    Core::Timing::EventType* cb_a = core_timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::Timing::EventType* cb_b = core_timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0, this thread now drives the event queue
+    core_timing.Advance();
+
+    core_timing.ScheduleEvent(100, cb_a, CB_IDS[0]);
+    core_timing.ScheduleEvent(300, cb_b, CB_IDS[1]);
+
+    // Requests from other threads are deferred to the next Advance and applied in order, so the
+    // rescheduled event must survive the unschedule that preceded it.
+    std::thread other_core{[&core_timing, cb_a, cb_b] {
+        core_timing.UnscheduleEvent(cb_a, CB_IDS[0]);
+        core_timing.UnscheduleEvent(cb_b, CB_IDS[1]);
+        core_timing.ScheduleEvent(200, cb_b, CB_IDS[1]);
+    }};
+    other_core.join();
+
+    REQUIRE(100 == core_timing.GetDowncount());
+
+    callbacks_ran_flags = 0;
+    core_timing.AddTicks(core_timing.GetDowncount());
+    core_timing.Advance();
+    REQUIRE(callbacks_ran_flags.none());
+    REQUIRE(100 == core_timing.GetDowncount());
+
+    AdvanceAndCheck(core_timing, 1, MAX_SLICE_LENGTH);
+}
+
 namespace SharedSlotTest {
 static unsigned int counter = 0;
 
@@ -245,3 +287,119 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == core_timing.GetDowncount());
 }
+
+TEST_CASE("CoreTiming[HostTiming]", "[core]") {
+    ScopeInit guard{Core::Timing::EventQueueType::TimingWheel, true};
+    auto& core_timing = guard.core_timing;
+
+    bool fired = false;
+    Core::Timing::EventType* cb =
+        core_timing.RegisterEvent("hostTimed", [&fired](u64, s64) { fired = true; });
+
+    // Enter slice 0
+    core_timing.Advance();
+
+    const auto start = std::chrono::steady_clock::now();
+    const u64 start_ticks = core_timing.GetTicks();
+    core_timing.ScheduleEvent(Core::Timing::msToCycles(2), cb);
+
+    // Idling must wait for the event on the host clock rather than skipping to it
+    while (!fired) {
+        core_timing.Idle();
+        core_timing.Advance();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(elapsed >= std::chrono::milliseconds{2});
+    REQUIRE(core_timing.GetTicks() - start_ticks >=
+            static_cast<u64>(Core::Timing::msToCycles(2)));
+}
+
+namespace QueueBackendTest {
+using Core::Timing::EventQueueType;
+
+struct FiredEvent {
+    u64 userdata;
+    s64 cycles_late;
+
+    bool operator==(const FiredEvent& other) const {
+        return userdata == other.userdata && cycles_late == other.cycles_late;
+    }
+};
+
+static std::vector<FiredEvent> RunRandomWorkload(EventQueueType queue_type) {
+    ScopeInit guard{queue_type};
+    auto& core_timing = guard.core_timing;
+
+    std::vector<FiredEvent> fired;
+    std::array<Core::Timing::EventType*, 4> types;
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        types[i] = core_timing.RegisterEvent("random" + std::to_string(i),
+                                             [&fired, i](u64 userdata, s64 cycles_late) {
+                                                 fired.push_back({userdata * 4 + i, cycles_late});
+                                             });
+    }
+
+    std::mt19937 rng{1234};
+    std::uniform_int_distribution<int> action{0, 9};
+    std::uniform_int_distribution<s64> delay{0, 200000};
+    std::uniform_int_distribution<u64> userdata{0, 31};
+    std::uniform_int_distribution<std::size_t> type{0, types.size() - 1};
+
+    // Enter slice 0
+    core_timing.Advance();
+
+    for (int step = 0; step < 20000; ++step) {
+        const int choice = action(rng);
+        if (choice < 6) {
+            core_timing.ScheduleEvent(delay(rng), types[type(rng)], userdata(rng));
+        } else if (choice < 8) {
+            core_timing.UnscheduleEvent(types[type(rng)], userdata(rng));
+        } else {
+            core_timing.AddTicks(std::uniform_int_distribution<int>{0, 20000}(rng));
+            core_timing.Advance();
+        }
+    }
+
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        core_timing.RemoveEvent(types[i]);
+    }
+    return fired;
+}
+} // namespace QueueBackendTest
+
+TEST_CASE("CoreTiming[QueueBackendsAgree]", "[core]") {
+    using namespace QueueBackendTest;
+
+    const auto heap_events = RunRandomWorkload(EventQueueType::Heap);
+    const auto wheel_events = RunRandomWorkload(EventQueueType::TimingWheel);
+
+    REQUIRE(!heap_events.empty());
+    REQUIRE(heap_events == wheel_events);
+}
+
+TEST_CASE("CoreTiming[PastDueOrder]", "[core]") {
+    using Core::Timing::EventQueueType;
+    using Core::Timing::TimedEvent;
+
+    for (const auto queue_type : {EventQueueType::Heap, EventQueueType::TimingWheel}) {
+        const auto queue = Core::Timing::MakeEventQueue(queue_type);
+        TimedEvent event{};
+
+        // Move the queue past the events pushed next
+        queue->Push({100, 0, 0, nullptr});
+        REQUIRE(queue->PopDue(100, event));
+
+        queue->Push({100, 1, 1, nullptr});
+        queue->Push({50, 2, 2, nullptr});
+        queue->Push({20, 3, 3, nullptr});
+        queue->Push({50, 4, 4, nullptr});
+
+        REQUIRE(queue->GetNextTime() == 20);
+        for (const u64 expected : {3, 2, 4, 1}) {
+            REQUIRE(queue->PopDue(100, event));
+            REQUIRE(event.userdata == expected);
+        }
+        REQUIRE(queue->IsEmpty());
+    }
+}
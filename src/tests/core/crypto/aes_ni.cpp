@@ -0,0 +1,272 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <mbedtls/aes.h>
+#include "common/common_types.h"
+#include "core/crypto/aes_ni.h"
+
+namespace Core::Crypto {
+
+namespace {
+
+using Block = std::array<u8, 0x10>;
+
+constexpr std::size_t BLOCK_SIZE = 0x10;
+
+/// Larger than the blocks AES-NI keeps in flight, so both the pipelined and the single block
+/// paths are covered
+constexpr std::size_t MULTI_PIPELINE_SIZE = 0x10 * BLOCK_SIZE + 3 * BLOCK_SIZE;
+
+constexpr Block CTR_KEY{0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                        0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+
+constexpr std::array<u8, 0x20> XTS_KEY{
+    0x27, 0x18, 0x28, 0x18, 0x28, 0x45, 0x90, 0x45, 0x23, 0x53, 0x60, 0x28, 0x74, 0x71, 0x35, 0x26,
+    0x31, 0x41, 0x59, 0x26, 0x53, 0x58, 0x97, 0x93, 0x23, 0x84, 0x62, 0x64, 0x33, 0x83, 0x27, 0x95,
+};
+
+std::vector<u8> MakeData(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 37 + 11);
+    }
+    return data;
+}
+
+/// Transcodes with mbedtls, returns the output and advances the counter the same way AES-NI does
+std::vector<u8> ReferenceCTR(const Block& key, Block& counter, const u8* src, std::size_t size) {
+    mbedtls_aes_context ctx;
+    mbedtls_aes_init(&ctx);
+    REQUIRE(mbedtls_aes_setkey_enc(&ctx, key.data(), 128) == 0);
+
+    std::vector<u8> out(size);
+    std::size_t offset = 0;
+    Block stream_block{};
+    REQUIRE(mbedtls_aes_crypt_ctr(&ctx, size, &offset, counter.data(), stream_block.data(), src,
+                                  out.data()) == 0);
+    mbedtls_aes_free(&ctx);
+    return out;
+}
+
+std::vector<u8> ReferenceXTS(const u8* src, std::size_t size, const Block& tweak, Op op) {
+    mbedtls_aes_xts_context ctx;
+    mbedtls_aes_xts_init(&ctx);
+    const int result = op == Op::Encrypt
+                           ? mbedtls_aes_xts_setkey_enc(&ctx, XTS_KEY.data(), 256)
+                           : mbedtls_aes_xts_setkey_dec(&ctx, XTS_KEY.data(), 256);
+    REQUIRE(result == 0);
+
+    std::vector<u8> out(size);
+    const int mode = op == Op::Encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT;
+    REQUIRE(mbedtls_aes_crypt_xts(&ctx, mode, size, tweak.data(), src, out.data()) == 0);
+    mbedtls_aes_xts_free(&ctx);
+    return out;
+}
+
+struct XTSKeys {
+    AESNI::RoundKeys128 encrypt;
+    AESNI::RoundKeys128 decrypt;
+    AESNI::RoundKeys128 tweak;
+};
+
+XTSKeys ExpandXTSKey(const u8* key) {
+    XTSKeys keys;
+    AESNI::RoundKeys128 unused_keys;
+    AESNI::ExpandKey128(key, keys.encrypt, keys.decrypt);
+    AESNI::ExpandKey128(key + 0x10, keys.tweak, unused_keys);
+    return keys;
+}
+
+void CheckCTR(const Block& initial_counter, std::size_t size, std::size_t src_offset,
+              std::size_t dest_offset) {
+    AESNI::RoundKeys128 keys;
+    AESNI::RoundKeys128 unused_keys;
+    AESNI::ExpandKey128(CTR_KEY.data(), keys, unused_keys);
+
+    const std::vector<u8> src = MakeData(src_offset + size);
+    Block reference_counter = initial_counter;
+    const std::vector<u8> expected =
+        ReferenceCTR(CTR_KEY, reference_counter, src.data() + src_offset, size);
+
+    std::vector<u8> dest(dest_offset + size);
+    Block counter = initial_counter;
+    AESNI::TranscodeCTR(keys, counter, src.data() + src_offset, size, dest.data() + dest_offset);
+
+    REQUIRE(std::memcmp(dest.data() + dest_offset, expected.data(), size) == 0);
+    REQUIRE(counter == reference_counter);
+}
+
+void CheckXTS(std::size_t size, std::size_t src_offset, std::size_t dest_offset, Op op) {
+    const XTSKeys keys = ExpandXTSKey(XTS_KEY.data());
+    const Block tweak{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x12, 0x34};
+
+    const std::vector<u8> src = MakeData(src_offset + size);
+    const std::vector<u8> expected = ReferenceXTS(src.data() + src_offset, size, tweak, op);
+
+    std::vector<u8> dest(dest_offset + size);
+    AESNI::TranscodeXTS(op == Op::Encrypt ? keys.encrypt : keys.decrypt, keys.tweak, tweak,
+                        src.data() + src_offset, size, dest.data() + dest_offset, op);
+
+    REQUIRE(std::memcmp(dest.data() + dest_offset, expected.data(), size) == 0);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AESNI[CTRKnownAnswer]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    // NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt
+    const std::array<u8, 0x40> plaintext{
+        0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73,
+        0x93, 0x17, 0x2A, 0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7,
+        0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51, 0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4,
+        0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF, 0xF6, 0x9F, 0x24, 0x45,
+        0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10,
+    };
+    const std::array<u8, 0x40> ciphertext{
+        0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99,
+        0x0D, 0xB6, 0xCE, 0x98, 0x06, 0xF6, 0x6B, 0x79, 0x70, 0xFD, 0xFF, 0x86, 0x17,
+        0x18, 0x7B, 0xB9, 0xFF, 0xFD, 0xFF, 0x5A, 0xE4, 0xDF, 0x3E, 0xDB, 0xD5, 0xD3,
+        0x5E, 0x5B, 0x4F, 0x09, 0x02, 0x0D, 0xB0, 0x3E, 0xAB, 0x1E, 0x03, 0x1D, 0xDA,
+        0x2F, 0xBE, 0x03, 0xD1, 0x79, 0x21, 0x70, 0xA0, 0xF3, 0x00, 0x9C, 0xEE,
+    };
+
+    AESNI::RoundKeys128 keys;
+    AESNI::RoundKeys128 unused_keys;
+    AESNI::ExpandKey128(CTR_KEY.data(), keys, unused_keys);
+
+    Block counter{0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+                  0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF};
+    std::array<u8, 0x40> out{};
+    AESNI::TranscodeCTR(keys, counter, plaintext.data(), plaintext.size(), out.data());
+    REQUIRE(out == ciphertext);
+
+    const Block next_counter{0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+                             0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFF, 0x03};
+    REQUIRE(counter == next_counter);
+}
+
+TEST_CASE("AESNI[CTRCounterCarry]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    // The low half overflows inside the pipelined blocks, the carry must reach the high half
+    const Block low_overflow{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                             0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFD};
+    CheckCTR(low_overflow, MULTI_PIPELINE_SIZE, 0, 0);
+
+    // The low half overflows in the single block tail
+    const Block tail_overflow{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                              0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF1};
+    CheckCTR(tail_overflow, MULTI_PIPELINE_SIZE, 0, 0);
+
+    // The whole 128-bit counter wraps around to zero
+    Block all_ones;
+    all_ones.fill(0xFF);
+    CheckCTR(all_ones, MULTI_PIPELINE_SIZE, 0, 0);
+}
+
+TEST_CASE("AESNI[CTRPartialBlock]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    const Block counter{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0xFF};
+    for (const std::size_t size : {std::size_t{1}, BLOCK_SIZE - 1, BLOCK_SIZE + 1,
+                                   8 * BLOCK_SIZE + 5, MULTI_PIPELINE_SIZE + 15}) {
+        CheckCTR(counter, size, 0, 0);
+    }
+}
+
+TEST_CASE("AESNI[CTRUnaligned]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    const Block counter{};
+    for (std::size_t offset = 1; offset < BLOCK_SIZE; offset += 3) {
+        CheckCTR(counter, MULTI_PIPELINE_SIZE + 7, offset, 0);
+        CheckCTR(counter, MULTI_PIPELINE_SIZE + 7, 0, offset);
+        CheckCTR(counter, MULTI_PIPELINE_SIZE + 7, offset, BLOCK_SIZE - offset);
+    }
+}
+
+TEST_CASE("AESNI[XTSKnownAnswer]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    // IEEE 1619-2007, XTS-AES-128 vector 1
+    const std::array<u8, 0x20> key{};
+    const Block tweak{};
+    const std::array<u8, 0x20> plaintext{};
+    const std::array<u8, 0x20> ciphertext{
+        0x91, 0x7C, 0xF6, 0x9E, 0xBD, 0x68, 0xB2, 0xEC, 0x9B, 0x9F, 0xE9,
+        0xA3, 0xEA, 0xDD, 0xA6, 0x92, 0xCD, 0x43, 0xD2, 0xF5, 0x95, 0x98,
+        0xED, 0x85, 0x8C, 0x02, 0xC2, 0x65, 0x2F, 0xBF, 0x92, 0x2E,
+    };
+
+    const XTSKeys keys = ExpandXTSKey(key.data());
+    std::array<u8, 0x20> out{};
+    AESNI::TranscodeXTS(keys.encrypt, keys.tweak, tweak, plaintext.data(), plaintext.size(),
+                        out.data(), Op::Encrypt);
+    REQUIRE(out == ciphertext);
+
+    AESNI::TranscodeXTS(keys.decrypt, keys.tweak, tweak, ciphertext.data(), ciphertext.size(),
+                        out.data(), Op::Decrypt);
+    REQUIRE(out == plaintext);
+}
+
+TEST_CASE("AESNI[XTSReference]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    for (const Op op : {Op::Encrypt, Op::Decrypt}) {
+        CheckXTS(BLOCK_SIZE, 0, 0, op);
+        CheckXTS(0x200, 0, 0, op);
+        CheckXTS(MULTI_PIPELINE_SIZE, 0, 0, op);
+        CheckXTS(MULTI_PIPELINE_SIZE, 5, 0, op);
+        CheckXTS(MULTI_PIPELINE_SIZE, 0, 9, op);
+        CheckXTS(MULTI_PIPELINE_SIZE, 3, 13, op);
+    }
+}
+
+TEST_CASE("AESNI[XTSInPlace]", "[core]") {
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+
+    const XTSKeys keys = ExpandXTSKey(XTS_KEY.data());
+    const Block tweak{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x00, 0x07};
+
+    // Unaligned within the buffer, like a sector read into the middle of a larger one
+    constexpr std::size_t offset = 3;
+    const std::vector<u8> plaintext = MakeData(MULTI_PIPELINE_SIZE);
+    const std::vector<u8> expected =
+        ReferenceXTS(plaintext.data(), plaintext.size(), tweak, Op::Encrypt);
+
+    std::vector<u8> buffer(offset + plaintext.size());
+    std::memcpy(buffer.data() + offset, plaintext.data(), plaintext.size());
+    u8* const data = buffer.data() + offset;
+
+    AESNI::TranscodeXTS(keys.encrypt, keys.tweak, tweak, data, plaintext.size(), data,
+                        Op::Encrypt);
+    REQUIRE(std::memcmp(data, expected.data(), expected.size()) == 0);
+
+    AESNI::TranscodeXTS(keys.decrypt, keys.tweak, tweak, data, plaintext.size(), data,
+                        Op::Decrypt);
+    REQUIRE(std::memcmp(data, plaintext.data(), plaintext.size()) == 0);
+}
+
+} // namespace Core::Crypto
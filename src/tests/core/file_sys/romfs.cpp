@@ -0,0 +1,61 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_vector.h"
+#include "tests/core/file_sys/vfs_test_common.h"
+
+namespace {
+
+using FileSysTests::MakeNamedFile;
+
+std::string ReadString(const FileSys::VirtualFile& file) {
+    const auto data = file->ReadAllBytes();
+    return std::string(data.begin(), data.end());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RomFSIndex[GetFile]", "[core]") {
+    std::vector<FileSys::VirtualFile> files;
+    for (int i = 0; i < 64; ++i) {
+        files.push_back(MakeNamedFile("file" + std::to_string(i)));
+    }
+    const auto nested = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::vector<FileSys::VirtualFile>{MakeNamedFile("leaf.bin")},
+        std::vector<FileSys::VirtualDir>{}, "nested");
+    const auto data = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::vector<FileSys::VirtualFile>{MakeNamedFile("file0")},
+        std::vector<FileSys::VirtualDir>{nested}, "data");
+    const auto root = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::move(files), std::vector<FileSys::VirtualDir>{data}, "root");
+
+    const FileSys::RomFSIndex index{FileSys::CreateRomFS(root)};
+    REQUIRE(index.IsValid());
+
+    for (int i = 0; i < 64; ++i) {
+        const std::string name = "file" + std::to_string(i);
+        const auto file = index.GetFile(name);
+        REQUIRE(file != nullptr);
+        REQUIRE(file->GetName() == name);
+        REQUIRE(ReadString(file) == name);
+    }
+
+    // Files with the same name in different directories are told apart by their parent
+    REQUIRE(index.GetFile("data/file0") != nullptr);
+    REQUIRE(ReadString(index.GetFile("data/nested/leaf.bin")) == "leaf.bin");
+    REQUIRE(ReadString(index.GetFile("/data\\nested//leaf.bin")) == "leaf.bin");
+
+    REQUIRE(index.GetFile("file64") == nullptr);
+    REQUIRE(index.GetFile("leaf.bin") == nullptr);
+    REQUIRE(index.GetFile("data/nested") == nullptr);
+    REQUIRE(index.GetFile("missing/file0") == nullptr);
+}
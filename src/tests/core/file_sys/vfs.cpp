@@ -0,0 +1,69 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/vfs.h"
+#include "core/file_sys/vfs_vector.h"
+#include "tests/core/file_sys/vfs_test_common.h"
+
+using FileSysTests::MakeFile;
+using FileSysTests::WritableVectorVfsDirectory;
+
+TEST_CASE("VfsParallelCopyD[Copy]", "[core]") {
+    std::vector<FileSys::VirtualFile> files;
+    for (std::size_t i = 0; i < 32; ++i) {
+        files.push_back(MakeFile("file" + std::to_string(i), i * 0x1234));
+    }
+    const auto nested = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::vector<FileSys::VirtualFile>{MakeFile("leaf.bin", 0x10001)},
+        std::vector<FileSys::VirtualDir>{}, "nested");
+    const auto src = std::make_shared<FileSys::VectorVfsDirectory>(
+        std::move(files), std::vector<FileSys::VirtualDir>{nested}, "src");
+
+    const auto dest = std::make_shared<WritableVectorVfsDirectory>();
+    // Progress is reported from the copying threads, its checks are done afterwards
+    bool is_increasing = true;
+    std::size_t last_copied = 0;
+    std::size_t last_total = 0;
+    REQUIRE(FileSys::VfsParallelCopyD(src, dest, 0x1000,
+                                      [&](std::size_t copied, std::size_t total) {
+                                          is_increasing = is_increasing && copied > last_copied;
+                                          last_copied = copied;
+                                          last_total = total;
+                                          return true;
+                                      }));
+    REQUIRE(is_increasing);
+    REQUIRE(last_copied == last_total);
+
+    for (const auto& file : src->GetFiles()) {
+        const auto copy = dest->GetFile(file->GetName());
+        REQUIRE(copy != nullptr);
+        REQUIRE(FileSys::DeepEquals(file, copy));
+    }
+    const auto nested_copy = dest->GetSubdirectory("nested");
+    REQUIRE(nested_copy != nullptr);
+    REQUIRE(nested_copy->GetFile("leaf.bin") != nullptr);
+    REQUIRE(FileSys::DeepEquals(nested->GetFile("leaf.bin"), nested_copy->GetFile("leaf.bin")));
+}
+
+TEST_CASE("VfsParallelCopyD[Abort]", "[core]") {
+    std::vector<FileSys::VirtualFile> files;
+    for (std::size_t i = 0; i < 8; ++i) {
+        files.push_back(MakeFile("file" + std::to_string(i), 0x8000));
+    }
+    const auto src = std::make_shared<FileSys::VectorVfsDirectory>(std::move(files));
+    const auto dest = std::make_shared<WritableVectorVfsDirectory>();
+
+    std::size_t num_calls = 0;
+    REQUIRE(!FileSys::VfsParallelCopyD(src, dest, 0x1000, [&](std::size_t, std::size_t) {
+        return ++num_calls < 4;
+    }));
+    REQUIRE(num_calls < 8 * 8);
+}
@@ -0,0 +1,54 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/vfs_cached.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace {
+
+class CountingVfsFile : public FileSys::VectorVfsFile {
+public:
+    using VectorVfsFile::VectorVfsFile;
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        ++read_count;
+        return VectorVfsFile::Read(data, length, offset);
+    }
+
+    mutable std::size_t read_count = 0;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("CachedVfsFile[Read]", "[core]") {
+    std::vector<u8> data(0x48000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7 + i / 0x100);
+    }
+    const auto base = std::make_shared<CountingVfsFile>(data);
+    FileSys::CachedVfsFile cached{base};
+    REQUIRE(cached.GetSize() == data.size());
+
+    // Reads crossing block boundaries return the data of the base file
+    std::vector<u8> buffer(0x12345);
+    REQUIRE(cached.Read(buffer.data(), buffer.size(), 0x8000) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data.begin() + 0x8000));
+
+    // Reading the same range again is served from the cache
+    const std::size_t read_count = base->read_count;
+    REQUIRE(cached.Read(buffer.data(), buffer.size(), 0x8000) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data.begin() + 0x8000));
+    REQUIRE(base->read_count == read_count);
+
+    // Reads are clamped to the end of the file
+    REQUIRE(cached.Read(buffer.data(), buffer.size(), data.size() - 0x10) == 0x10);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 0x10, data.end() - 0x10));
+    REQUIRE(cached.Read(buffer.data(), buffer.size(), data.size()) == 0);
+}
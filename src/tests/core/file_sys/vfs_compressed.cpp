@@ -0,0 +1,58 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/vfs_compressed.h"
+#include "core/file_sys/vfs_vector.h"
+
+TEST_CASE("CompressedVfsFile[RoundTrip]", "[core]") {
+    // Compressible data followed by data that is stored uncompressed, ending with a partial block
+    std::vector<u8> data(0x30000 + 0x123);
+    u32 state = 1;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        state = state * 1103515245 + 12345;
+        data[i] = i < 0x18000 ? static_cast<u8>(i / 0x100) : static_cast<u8>(state >> 16);
+    }
+    const auto src = std::make_shared<FileSys::VectorVfsFile>(data, "title.nsp");
+    const auto dest = std::make_shared<FileSys::VectorVfsFile>(std::vector<u8>{}, "title.nsp.yzc");
+
+    std::size_t last_progress = 0;
+    REQUIRE(FileSys::CompressVfsFile(src, dest, 0x8000, [&](std::size_t done) {
+        last_progress = done;
+        return true;
+    }));
+    REQUIRE(last_progress == data.size());
+    REQUIRE(dest->GetSize() < data.size());
+    REQUIRE(FileSys::CompressedVfsFile::IsCompressedFile(dest));
+    REQUIRE(!FileSys::CompressedVfsFile::IsCompressedFile(src));
+
+    const auto file = FileSys::CompressedVfsFile::Open(dest);
+    REQUIRE(file != nullptr);
+    REQUIRE(file->GetName() == "title.nsp");
+    REQUIRE(file->ReadAllBytes() == data);
+
+    // Reads that start and end in the middle of blocks
+    std::vector<u8> buffer(0x10001);
+    REQUIRE(file->Read(buffer.data(), buffer.size(), 0x7FFF) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data.begin() + 0x7FFF));
+    REQUIRE(file->Read(buffer.data(), buffer.size(), data.size() - 0x10) == 0x10);
+}
+
+TEST_CASE("CompressedVfsFile[Corrupted]", "[core]") {
+    const auto src = std::make_shared<FileSys::VectorVfsFile>(std::vector<u8>(0x20000, 0xAB));
+    const auto dest = std::make_shared<FileSys::VectorVfsFile>();
+    REQUIRE(FileSys::CompressVfsFile(src, dest));
+
+    // A block index pointing outside of the file is rejected
+    auto raw = dest->ReadAllBytes();
+    raw[0x2F] = 0xFF;
+    const auto corrupted = std::make_shared<FileSys::VectorVfsFile>(std::move(raw));
+    REQUIRE(FileSys::CompressedVfsFile::IsCompressedFile(corrupted));
+    REQUIRE(FileSys::CompressedVfsFile::Open(corrupted) == nullptr);
+}
@@ -0,0 +1,45 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <utility>
+#include "tests/core/file_sys/vfs_test_common.h"
+
+namespace FileSysTests {
+
+bool WritableVectorVfsDirectory::IsWritable() const {
+    return true;
+}
+
+FileSys::VirtualDir WritableVectorVfsDirectory::CreateSubdirectory(std::string_view name) {
+    auto dir = std::make_shared<WritableVectorVfsDirectory>(std::vector<FileSys::VirtualFile>{},
+                                                            std::vector<FileSys::VirtualDir>{},
+                                                            std::string(name));
+    AddDirectory(dir);
+    return dir;
+}
+
+FileSys::VirtualFile WritableVectorVfsDirectory::CreateFile(std::string_view name) {
+    auto file = std::make_shared<FileSys::VectorVfsFile>(std::vector<u8>{}, std::string(name));
+    AddFile(file);
+    return file;
+}
+
+FileSys::VirtualFile MakeFile(const std::string& name, std::vector<u8> data) {
+    return std::make_shared<FileSys::VectorVfsFile>(std::move(data), name);
+}
+
+FileSys::VirtualFile MakeFile(const std::string& name, std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 7 + name.size());
+    }
+    return MakeFile(name, std::move(data));
+}
+
+FileSys::VirtualFile MakeNamedFile(const std::string& name) {
+    return MakeFile(name, std::vector<u8>(name.begin(), name.end()));
+}
+
+} // namespace FileSysTests
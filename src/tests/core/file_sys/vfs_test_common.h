@@ -0,0 +1,36 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs_types.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSysTests {
+
+/// In-memory directory that files and subdirectories can be created in
+class WritableVectorVfsDirectory : public FileSys::VectorVfsDirectory {
+public:
+    using VectorVfsDirectory::VectorVfsDirectory;
+
+    bool IsWritable() const override;
+    FileSys::VirtualDir CreateSubdirectory(std::string_view name) override;
+    FileSys::VirtualFile CreateFile(std::string_view name) override;
+};
+
+/// Makes an in-memory file with the given contents
+FileSys::VirtualFile MakeFile(const std::string& name, std::vector<u8> data);
+
+/// Makes an in-memory file of the given size, filled with a pattern that depends on its name
+FileSys::VirtualFile MakeFile(const std::string& name, std::size_t size);
+
+/// Makes an in-memory file whose contents are its name, so lookups can check what they found
+FileSys::VirtualFile MakeNamedFile(const std::string& name);
+
+} // namespace FileSysTests
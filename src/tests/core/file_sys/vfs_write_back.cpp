@@ -0,0 +1,64 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/file_sys/vfs_vector.h"
+#include "core/file_sys/vfs_write_back.h"
+#include "tests/core/file_sys/vfs_test_common.h"
+
+namespace {
+
+using FileSysTests::WritableVectorVfsDirectory;
+
+std::shared_ptr<WritableVectorVfsDirectory> MakeDirectory(
+    std::vector<std::pair<std::string, std::vector<u8>>> files) {
+    auto dir = std::make_shared<WritableVectorVfsDirectory>();
+    for (auto& [name, data] : files) {
+        dir->AddFile(FileSysTests::MakeFile(name, std::move(data)));
+    }
+    return dir;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("WriteBackCache[Commit]", "[core]") {
+    const auto dir = MakeDirectory({{"save.bin", {1, 2, 3, 4}}});
+    const auto cache = std::make_shared<FileSys::WriteBackCache>(dir);
+
+    const auto file = cache->OpenFile("save.bin", dir->GetFile("save.bin"));
+    REQUIRE(file->WriteBytes({9, 9}, 1) == 2);
+    REQUIRE(file->WriteBytes({7}, 5) == 1);
+
+    // The writes are visible through all the views of the file, but not on disk yet
+    const auto other_view = cache->OpenFile("save.bin", dir->GetFile("save.bin"));
+    const std::vector<u8> expected{1, 9, 9, 4, 0, 7};
+    REQUIRE(file->ReadAllBytes() == expected);
+    REQUIRE(other_view->GetSize() == expected.size());
+    REQUIRE(dir->GetFile("save.bin")->ReadAllBytes() == std::vector<u8>{1, 2, 3, 4});
+
+    REQUIRE(cache->Commit());
+    REQUIRE(dir->GetFile("save.bin")->ReadAllBytes() == expected);
+    REQUIRE(dir->GetFiles().size() == 1);
+
+    // Views write to the directory directly once detached
+    REQUIRE(cache->CommitAndDetach());
+    REQUIRE(file->WriteBytes({5}, 0) == 1);
+    REQUIRE(dir->GetFile("save.bin")->ReadAllBytes()[0] == 5);
+}
+
+TEST_CASE("WriteBackCache[Recover]", "[core]") {
+    // An interrupted commit is rolled back while the original is there and completed otherwise
+    const auto dir = MakeDirectory({{"a", {1}}, {"a.yuzu_commit", {2}}, {"b.yuzu_commit", {3}}});
+    FileSys::WriteBackCache cache{dir};
+
+    REQUIRE(dir->GetFiles().size() == 2);
+    REQUIRE(dir->GetFile("a")->ReadAllBytes() == std::vector<u8>{1});
+    REQUIRE(dir->GetFile("b")->ReadAllBytes() == std::vector<u8>{3});
+}
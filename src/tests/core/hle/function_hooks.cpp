@@ -0,0 +1,109 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "core/hle/function_hooks.h"
+#include "core/loader/symbols.h"
+
+namespace {
+
+constexpr std::size_t MOD0_OFFSET = 0x100;
+constexpr std::size_t DYNAMIC_OFFSET = 0x200;
+constexpr std::size_t SYMTAB_OFFSET = 0x300;
+constexpr std::size_t STRTAB_OFFSET = 0x400;
+constexpr std::size_t SYMBOL_SIZE = 0x18;
+
+constexpr u8 STT_OBJECT = 1;
+constexpr u8 STT_FUNC = 2;
+
+template <typename T>
+void Write(std::vector<u8>& image, std::size_t offset, T value) {
+    std::memcpy(image.data() + offset, &value, sizeof(T));
+}
+
+void WriteSymbol(std::vector<u8>& image, std::size_t index, u32 name, u8 type, u64 value,
+                 u64 size) {
+    const std::size_t offset = SYMTAB_OFFSET + index * SYMBOL_SIZE;
+    Write<u32>(image, offset, name);
+    Write<u8>(image, offset + 4, type);
+    Write<u16>(image, offset + 6, 1);
+    Write<u64>(image, offset + 8, value);
+    Write<u64>(image, offset + 16, size);
+}
+
+/// Builds a module image exporting memcpy, a strlen too short to hook, another function and a
+/// memset object
+std::vector<u8> MakeModule() {
+    std::vector<u8> image(0x1000);
+    Write<u32>(image, 4, MOD0_OFFSET);
+    Write<u32>(image, MOD0_OFFSET, Common::MakeMagic('M', 'O', 'D', '0'));
+    Write<s32>(image, MOD0_OFFSET + 4, DYNAMIC_OFFSET - MOD0_OFFSET);
+
+    const std::string strings{std::string("\0memcpy\0strlen\0other\0memset\0", 29)};
+    std::memcpy(image.data() + STRTAB_OFFSET, strings.data(), strings.size());
+
+    const u64 dynamic[][2] = {
+        {6, SYMTAB_OFFSET},  {5, STRTAB_OFFSET}, {10, strings.size()},
+        {11, SYMBOL_SIZE}, {0, 0},
+    };
+    std::memcpy(image.data() + DYNAMIC_OFFSET, dynamic, sizeof(dynamic));
+
+    WriteSymbol(image, 1, 1, STT_FUNC, 0x880, 0x20);
+    WriteSymbol(image, 2, 8, STT_FUNC, 0x800, 4);
+    WriteSymbol(image, 3, 15, STT_FUNC, 0x840, 0x10);
+    WriteSymbol(image, 4, 21, STT_OBJECT, 0x8C0, 0x10);
+    return image;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ModuleSymbols[ReadFunctions]", "[core]") {
+    const std::vector<u8> image = MakeModule();
+    const auto symbols = Loader::ReadModuleFunctions(image.data(), image.size());
+
+    // Objects are skipped and the functions are sorted by offset
+    REQUIRE(symbols.size() == 3);
+    REQUIRE(symbols[0].name == "strlen");
+    REQUIRE(symbols[0].offset == 0x800);
+    REQUIRE(symbols[1].name == "other");
+    REQUIRE(symbols[1].offset == 0x840);
+    REQUIRE(symbols[2].name == "memcpy");
+    REQUIRE(symbols[2].offset == 0x880);
+    REQUIRE(symbols[2].size == 0x20);
+
+    // Images without a MOD0 header have no symbols
+    std::vector<u8> stripped = image;
+    Write<u32>(stripped, MOD0_OFFSET, 0);
+    REQUIRE(Loader::ReadModuleFunctions(stripped.data(), stripped.size()).empty());
+
+    // Tables out of the image are rejected instead of read
+    REQUIRE(Loader::ReadModuleFunctions(image.data(), STRTAB_OFFSET).empty());
+}
+
+TEST_CASE("FunctionHooks[HookModuleFunctions]", "[core]") {
+    std::vector<u8> image = MakeModule();
+    const std::vector<u8> original = image;
+    REQUIRE(HLE::HookModuleFunctions(image, 0, image.size()) == 1);
+
+    // memcpy starts with the SVC of the first hook and a return
+    u32 code[2];
+    std::memcpy(code, image.data() + 0x880, sizeof(code));
+    REQUIRE(code[0] == (0xD4000001 | (HLE::FUNCTION_HOOK_SVC_BASE << 5)));
+    REQUIRE(code[1] == 0xD65F03C0);
+
+    // Nothing else is patched, strlen is shorter than the hook
+    std::memset(image.data() + 0x880, 0, sizeof(code));
+    REQUIRE(image == original);
+
+    // Functions outside of the text segment aren't hooked
+    std::vector<u8> data_only = MakeModule();
+    REQUIRE(HLE::HookModuleFunctions(data_only, 0, 0x800) == 0);
+}
@@ -0,0 +1,46 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include "core/core.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/readable_event.h"
+#include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/wait_object.h"
+#include "core/hle/kernel/writable_event.h"
+
+TEST_CASE("HandleTable[TypedLookups]", "[core]") {
+    Kernel::KernelCore kernel{Core::System::GetInstance()};
+    Kernel::HandleTable handle_table;
+
+    const auto resource_limit = Kernel::ResourceLimit::Create(kernel);
+    const auto event = Kernel::WritableEvent::CreateEventPair(kernel, Kernel::ResetType::Manual,
+                                                              "HandleTable test");
+    const Kernel::Handle limit_handle = handle_table.Create(resource_limit).Unwrap();
+    const Kernel::Handle readable_handle = handle_table.Create(event.readable).Unwrap();
+
+    REQUIRE(handle_table.Get<Kernel::ResourceLimit>(limit_handle) == resource_limit);
+    REQUIRE(handle_table.Get<Kernel::Thread>(limit_handle) == nullptr);
+    REQUIRE(handle_table.Get<Kernel::WaitObject>(limit_handle) == nullptr);
+
+    REQUIRE(handle_table.Get<Kernel::ReadableEvent>(readable_handle) == event.readable);
+    REQUIRE(handle_table.Get<Kernel::WaitObject>(readable_handle) == event.readable);
+    REQUIRE(handle_table.Get<Kernel::WritableEvent>(readable_handle) == nullptr);
+
+    REQUIRE(handle_table.Close(limit_handle) == RESULT_SUCCESS);
+    REQUIRE(handle_table.Get<Kernel::ResourceLimit>(limit_handle) == nullptr);
+    REQUIRE(!handle_table.IsValid(limit_handle));
+
+    // A new handle reusing the slot must not make the closed one valid again
+    const Kernel::Handle reused_handle = handle_table.Create(resource_limit).Unwrap();
+    REQUIRE(reused_handle != limit_handle);
+    REQUIRE(handle_table.Get<Kernel::ResourceLimit>(reused_handle) == resource_limit);
+    REQUIRE(handle_table.Get<Kernel::ResourceLimit>(limit_handle) == nullptr);
+
+    handle_table.Clear();
+    REQUIRE(handle_table.Get<Kernel::ReadableEvent>(readable_handle) == nullptr);
+}
@@ -0,0 +1,34 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/thread.h"
+#include "tests/core/hle/kernel/hle_ipc_test_common.h"
+
+TEST_CASE("HLERequestContext[ParseDescriptors]", "[core]") {
+    KernelTests::SessionEnvironment guard;
+    KernelTests::CommandBuffer cmdbuf = KernelTests::MakeRequest();
+
+    Kernel::HLERequestContext context(guard.server_session, nullptr);
+    context.PopulateFromIncomingCommandBuffer(guard.handle_table, cmdbuf.data());
+
+    REQUIRE(context.GetCommand() == 7);
+    REQUIRE(context.BufferDescriptorX().size() == 1);
+    REQUIRE(context.BufferDescriptorX()[0].Address() == 0x1000);
+    REQUIRE(context.BufferDescriptorX()[0].Size() == 0x10);
+    REQUIRE(context.BufferDescriptorA().size() == 1);
+    REQUIRE(context.BufferDescriptorA()[0].Address() == 0x2000);
+    REQUIRE(context.BufferDescriptorA()[0].Size() == 0x20);
+    REQUIRE(context.BufferDescriptorB().size() == 1);
+    REQUIRE(context.BufferDescriptorB()[0].Address() == 0x3000);
+    REQUIRE(context.BufferDescriptorB()[0].Size() == 0x30);
+    REQUIRE(context.BufferDescriptorC().size() == 1);
+    REQUIRE(context.BufferDescriptorC()[0].Address() == 0x4000);
+    REQUIRE(context.BufferDescriptorC()[0].Size() == 0x40);
+    REQUIRE(context.GetReadBufferSize() == 0x20);
+    REQUIRE(context.GetWriteBufferSize() == 0x30);
+}
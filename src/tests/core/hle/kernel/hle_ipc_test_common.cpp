@@ -0,0 +1,63 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <tuple>
+
+#include "common/common_funcs.h"
+#include "core/core.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/server_session.h"
+#include "tests/core/hle/kernel/hle_ipc_test_common.h"
+
+namespace KernelTests {
+
+CommandBuffer MakeRequest() {
+    CommandBuffer cmdbuf{};
+    IPC::CommandHeader header{};
+    header.type.Assign(IPC::CommandType::Request);
+    header.num_buf_x_descriptors.Assign(1);
+    header.num_buf_a_descriptors.Assign(1);
+    header.num_buf_b_descriptors.Assign(1);
+    header.data_size.Assign(8);
+    header.buf_c_descriptor_flags.Assign(IPC::CommandHeader::BufferDescriptorCFlag::OneDescriptor);
+    cmdbuf[0] = header.raw_low;
+    cmdbuf[1] = header.raw_high;
+
+    IPC::BufferDescriptorX buffer_x{};
+    buffer_x.size.Assign(0x10);
+    buffer_x.address_bits_0_31 = 0x1000;
+    std::memcpy(&cmdbuf[2], &buffer_x, sizeof(buffer_x));
+
+    IPC::BufferDescriptorABW buffer_a{};
+    buffer_a.size_bits_0_31 = 0x20;
+    buffer_a.address_bits_0_31 = 0x2000;
+    std::memcpy(&cmdbuf[4], &buffer_a, sizeof(buffer_a));
+
+    IPC::BufferDescriptorABW buffer_b{};
+    buffer_b.size_bits_0_31 = 0x30;
+    buffer_b.address_bits_0_31 = 0x3000;
+    std::memcpy(&cmdbuf[7], &buffer_b, sizeof(buffer_b));
+
+    // The descriptors end at word 10, the payload is aligned to word 12
+    cmdbuf[12] = Common::MakeMagic('S', 'F', 'C', 'I');
+    cmdbuf[14] = 7;
+
+    // The C descriptor goes after the data, which starts at word 10
+    IPC::BufferDescriptorC buffer_c{};
+    buffer_c.address_bits_0_31 = 0x4000;
+    buffer_c.size.Assign(0x40);
+    std::memcpy(&cmdbuf[18], &buffer_c, sizeof(buffer_c));
+    return cmdbuf;
+}
+
+SessionEnvironment::SessionEnvironment() : kernel{Core::System::GetInstance()} {
+    std::tie(server_session, client_session) =
+        Kernel::ServerSession::CreateSessionPair(kernel, "test");
+}
+
+SessionEnvironment::~SessionEnvironment() = default;
+
+} // namespace KernelTests
@@ -0,0 +1,37 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+#include "core/hle/ipc.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/object.h"
+
+namespace Kernel {
+class ClientSession;
+class ServerSession;
+} // namespace Kernel
+
+namespace KernelTests {
+
+using CommandBuffer = std::array<u32, IPC::COMMAND_BUFFER_LENGTH>;
+
+/// Builds a request for command 7 with an X, an A, a B and a C buffer descriptor
+CommandBuffer MakeRequest();
+
+/// Kernel and session the requests built by the tests are parsed for
+struct SessionEnvironment final {
+    SessionEnvironment();
+    ~SessionEnvironment();
+
+    Kernel::KernelCore kernel;
+    Kernel::HandleTable handle_table;
+    Kernel::SharedPtr<Kernel::ServerSession> server_session;
+    Kernel::SharedPtr<Kernel::ClientSession> client_session;
+};
+
+} // namespace KernelTests
@@ -0,0 +1,45 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <set>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/slab_heap.h"
+
+TEST_CASE("SlabHeap[Recycle]", "[core]") {
+    Kernel::SlabHeap heap{24, 8};
+    heap.Reserve(4);
+    REQUIRE(heap.GetCapacity() == 4);
+
+    // Reserved blocks are handed out contiguously
+    std::vector<u8*> blocks;
+    for (int i = 0; i < 4; ++i) {
+        blocks.push_back(static_cast<u8*>(heap.Allocate()));
+    }
+    for (std::size_t i = 1; i < blocks.size(); ++i) {
+        REQUIRE(blocks[i] == blocks[i - 1] + 24);
+    }
+    REQUIRE(heap.GetAllocatedCount() == 4);
+    REQUIRE(heap.GetCapacity() == 4);
+
+    // The most recently freed block is reused first
+    heap.Free(blocks[1]);
+    REQUIRE(heap.GetAllocatedCount() == 3);
+    REQUIRE(heap.Allocate() == blocks[1]);
+
+    // A full heap grows instead of failing
+    void* const extra = heap.Allocate();
+    REQUIRE(std::set<u8*>(blocks.begin(), blocks.end()).count(static_cast<u8*>(extra)) == 0);
+    REQUIRE(heap.GetCapacity() > 4);
+    REQUIRE(heap.GetAllocatedCount() == 5);
+
+    heap.Free(extra);
+    for (u8* const block : blocks) {
+        heap.Free(block);
+    }
+    REQUIRE(heap.GetAllocatedCount() == 0);
+}
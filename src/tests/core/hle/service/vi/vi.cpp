@@ -0,0 +1,44 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include "core/hle/service/nvflinger/buffer_queue.h"
+#include "tests/core/hle/service/vi/vi_test_common.h"
+
+TEST_CASE("IHOSBinderDriver[TransactParcel]", "[core]") {
+    using namespace ViTests;
+    BinderDriverFixture fixture;
+
+    const u8* response = fixture.Transact(DEQUEUE_BUFFER, DequeueBufferRequest{1, 1280, 720, 0, 0});
+    // Slot, a one, the fence object with its size and fd count, and a zero
+    REQUIRE(ReadWord(response, 0) == 56);
+    REQUIRE(ReadWord(response, 4) == 16);
+    REQUIRE(ReadWord(response, 8) == 4);
+    REQUIRE(ReadWord(response, 12) == 16 + 56);
+    const u32 slot = ReadWord(response, 16);
+    REQUIRE(slot == 0);
+    REQUIRE(ReadWord(response, 24) == 36);
+    REQUIRE(ReadWord(response, 32) == 1);
+    REQUIRE(ReadWord(response, 36) == 0xFFFFFFFF);
+
+    response = fixture.Transact(REQUEST_BUFFER, u32_le{slot});
+    REQUIRE(ReadWord(response, 0) == 4 + 8 + sizeof(Service::NVFlinger::IGBPBuffer) + 4);
+    REQUIRE(ReadWord(response, 16) == 1);
+    REQUIRE(ReadWord(response, 20) == sizeof(Service::NVFlinger::IGBPBuffer));
+    REQUIRE(ReadWord(response, 28 + 4) == 1280);
+    REQUIRE(ReadWord(response, 28 + 8) == 720);
+
+    QueueBufferRequest queue_request{};
+    queue_request.slot = slot;
+    response = fixture.Transact(QUEUE_BUFFER, queue_request);
+    REQUIRE(ReadWord(response, 0) == 20);
+    REQUIRE(ReadWord(response, 16) == 1280);
+    REQUIRE(ReadWord(response, 20) == 720);
+
+    const auto buffer = fixture.GetBufferQueue().AcquireBuffer();
+    REQUIRE(buffer);
+    REQUIRE(buffer->get().slot == slot);
+    REQUIRE(buffer->get().igbp_buffer.gpu_buffer_id == 5);
+}
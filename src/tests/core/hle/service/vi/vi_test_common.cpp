@@ -0,0 +1,98 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <tuple>
+
+#include "common/common_funcs.h"
+#include "core/core.h"
+#include "core/hle/ipc.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/service/nvflinger/buffer_queue.h"
+#include "core/hle/service/nvflinger/nvflinger.h"
+#include "core/hle/service/vi/vi.h"
+#include "core/memory_setup.h"
+#include "tests/core/hle/service/vi/vi_test_common.h"
+
+namespace ViTests {
+
+KernelTests::CommandBuffer MakeTransactParcel(u32 binder_id, u32 transaction) {
+    KernelTests::CommandBuffer cmdbuf{};
+    IPC::CommandHeader header{};
+    header.type.Assign(IPC::CommandType::Request);
+    header.num_buf_a_descriptors.Assign(1);
+    header.num_buf_b_descriptors.Assign(1);
+    header.data_size.Assign(10);
+    cmdbuf[0] = header.raw_low;
+    cmdbuf[1] = header.raw_high;
+
+    IPC::BufferDescriptorABW buffer_a{};
+    buffer_a.size_bits_0_31 = PARCEL_SIZE;
+    buffer_a.address_bits_0_31 = static_cast<u32>(PARCEL_BASE);
+    std::memcpy(&cmdbuf[2], &buffer_a, sizeof(buffer_a));
+
+    IPC::BufferDescriptorABW buffer_b{};
+    buffer_b.size_bits_0_31 = PARCEL_SIZE;
+    buffer_b.address_bits_0_31 = static_cast<u32>(PARCEL_BASE + Memory::PAGE_SIZE);
+    std::memcpy(&cmdbuf[5], &buffer_b, sizeof(buffer_b));
+
+    // The descriptors end at word 8, which is already aligned for the payload. Command 0 is
+    // TransactParcel, followed by the binder id, the transaction and the flags.
+    cmdbuf[8] = Common::MakeMagic('S', 'F', 'C', 'I');
+    cmdbuf[10] = 0;
+    cmdbuf[12] = binder_id;
+    cmdbuf[13] = transaction;
+    cmdbuf[14] = 0;
+    return cmdbuf;
+}
+
+u32 ReadWord(const u8* memory, std::size_t offset) {
+    u32 value;
+    std::memcpy(&value, memory + offset, sizeof(value));
+    return value;
+}
+
+BinderDriverFixture::BinderDriverFixture() : system{Core::System::GetInstance()} {
+    core_timing.Initialize();
+    std::tie(server_session, client_session) =
+        Kernel::ServerSession::CreateSessionPair(system.Kernel(), "vi_test");
+
+    process = Kernel::Process::Create(system, "vi_test");
+    Memory::MapMemoryRegion(process->VMManager().page_table, PARCEL_BASE, memory.size(),
+                            memory.data());
+    system.Kernel().MakeCurrentProcess(process.get());
+
+    nv_flinger = std::make_shared<Service::NVFlinger::NVFlinger>(core_timing);
+    const u64 display_id = *nv_flinger->OpenDisplay("Default");
+    const u64 layer_id = *nv_flinger->CreateLayer(display_id);
+    binder_id = *nv_flinger->FindBufferQueueId(display_id, layer_id);
+
+    Service::NVFlinger::IGBPBuffer buffer{};
+    buffer.width = 1280;
+    buffer.height = 720;
+    buffer.gpu_buffer_id = 5;
+    for (u32 slot = 0; slot < 2; ++slot) {
+        nv_flinger->FindBufferQueue(binder_id).SetPreallocatedBuffer(slot, buffer);
+    }
+
+    driver = Service::VI::detail::MakeHOSBinderDriver(nv_flinger);
+}
+
+BinderDriverFixture::~BinderDriverFixture() {
+    driver.reset();
+    nv_flinger.reset();
+    system.Kernel().MakeCurrentProcess(nullptr);
+    Memory::UnmapRegion(process->VMManager().page_table, PARCEL_BASE, memory.size());
+    core_timing.Shutdown();
+}
+
+Service::NVFlinger::BufferQueue& BinderDriverFixture::GetBufferQueue() {
+    return nv_flinger->FindBufferQueue(binder_id);
+}
+
+} // namespace ViTests
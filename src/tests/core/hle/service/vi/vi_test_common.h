@@ -0,0 +1,121 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/swap.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/object.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "tests/core/hle/kernel/hle_ipc_test_common.h"
+
+namespace Core {
+class System;
+}
+
+namespace Kernel {
+class ClientSession;
+class Process;
+} // namespace Kernel
+
+namespace Service::NVFlinger {
+class BufferQueue;
+class NVFlinger;
+} // namespace Service::NVFlinger
+
+namespace ViTests {
+
+/// Guest address of the request parcel, the response parcel is written to the next page
+constexpr VAddr PARCEL_BASE = 0x10000000;
+constexpr u32 PARCEL_SIZE = 0x400;
+
+constexpr u32 DEQUEUE_BUFFER = 3;
+constexpr u32 REQUEST_BUFFER = 1;
+constexpr u32 QUEUE_BUFFER = 7;
+
+constexpr char16_t INTERFACE_TOKEN[] = u"android.gui.IGraphicBufferProducer";
+
+struct DequeueBufferRequest {
+    u32_le pixel_format;
+    u32_le width;
+    u32_le height;
+    u32_le get_frame_timestamps;
+    u32_le usage;
+};
+
+/// Slot, the transform and the crop rectangle are the only fields read by the service
+struct QueueBufferRequest {
+    u32_le slot;
+    std::array<u32_le, 15> unused;
+    std::array<u32_le, 4> fences;
+};
+static_assert(sizeof(QueueBufferRequest) == 80, "QueueBufferRequest has wrong size");
+
+/// Builds a TransactParcel request with the parcel in an A buffer and the response in a B buffer
+KernelTests::CommandBuffer MakeTransactParcel(u32 binder_id, u32 transaction);
+
+/// Writes a request parcel with the interface token and the given data to guest memory
+template <typename T>
+void WriteRequestParcel(u8* memory, const T& data) {
+    constexpr u32 token_length = static_cast<u32>(std::size(INTERFACE_TOKEN) - 1);
+    constexpr u32 token_size = (8 + (token_length + 1) * sizeof(char16_t) + 3) & ~3U;
+    const std::array<u32_le, 4> header{static_cast<u32>(token_size + sizeof(T)), 16, 0,
+                                       static_cast<u32>(16 + token_size + sizeof(T))};
+    const std::array<u32_le, 2> token_header{0x100, token_length};
+
+    std::memset(memory, 0, PARCEL_SIZE);
+    std::memcpy(memory, header.data(), sizeof(header));
+    std::memcpy(memory + 16, token_header.data(), sizeof(token_header));
+    std::memcpy(memory + 24, INTERFACE_TOKEN, sizeof(INTERFACE_TOKEN));
+    std::memcpy(memory + 16 + token_size, &data, sizeof(T));
+}
+
+u32 ReadWord(const u8* memory, std::size_t offset);
+
+/// Binder driver of a display layer with two 1280x720 buffers, transacting parcels in the
+/// memory of its own process
+class BinderDriverFixture {
+public:
+    BinderDriverFixture();
+    ~BinderDriverFixture();
+
+    /// Runs a transaction with the given request data, returns the response parcel
+    template <typename T>
+    const u8* Transact(u32 transaction, const T& data) {
+        WriteRequestParcel(memory.data(), data);
+        KernelTests::CommandBuffer cmdbuf = MakeTransactParcel(binder_id, transaction);
+        Kernel::HLERequestContext context(server_session, nullptr);
+        context.PopulateFromIncomingCommandBuffer(handle_table, cmdbuf.data());
+        driver->HandleSyncRequest(context);
+        return memory.data() + Memory::PAGE_SIZE;
+    }
+
+    Service::NVFlinger::BufferQueue& GetBufferQueue();
+
+private:
+    Core::System& system;
+    Core::Timing::CoreTiming core_timing;
+    Kernel::HandleTable handle_table;
+    Kernel::SharedPtr<Kernel::ServerSession> server_session;
+    Kernel::SharedPtr<Kernel::ClientSession> client_session;
+    Kernel::SharedPtr<Kernel::Process> process;
+    std::vector<u8> memory = std::vector<u8>(2 * Memory::PAGE_SIZE);
+    std::shared_ptr<Service::NVFlinger::NVFlinger> nv_flinger;
+    std::shared_ptr<Kernel::SessionRequestHandler> driver;
+    u32 binder_id = 0;
+};
+
+} // namespace ViTests
@@ -0,0 +1,82 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <vector>
+#include "core/perf_stats.h"
+
+using Core::FrameEvent;
+using Core::FrameTimestamps;
+
+namespace {
+
+/// Builds a history of frames presented at the given times, in milliseconds
+std::vector<FrameTimestamps> MakeHistory(const std::vector<int>& present_times) {
+    const auto origin = FrameTimestamps::Clock::now();
+    std::vector<FrameTimestamps> history;
+    for (std::size_t i = 0; i < present_times.size(); ++i) {
+        FrameTimestamps& entry = history.emplace_back();
+        entry.frame = i;
+        const auto time = origin + std::chrono::milliseconds{present_times[i]};
+        entry.times[static_cast<std::size_t>(FrameEvent::SwapEnd)] = time;
+        if (present_times[i] >= 0) {
+            entry.times[static_cast<std::size_t>(FrameEvent::Present)] = time;
+        }
+    }
+    return history;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PerfStats[FrameTimes]", "[core]") {
+    const auto frame_times = Core::GetFrameTimes(MakeHistory({0, 16, 33, 50, 100}));
+    REQUIRE(frame_times.size() == 4);
+    REQUIRE(frame_times[0] == Approx(16.0));
+    REQUIRE(frame_times[3] == Approx(50.0));
+}
+
+TEST_CASE("PerfStats[Percentiles]", "[core]") {
+    // 99 frames at 10 ms followed by a single 100 ms stutter
+    std::vector<int> present_times;
+    for (int i = 0; i < 100; ++i) {
+        present_times.push_back(i * 10);
+    }
+    present_times.push_back(present_times.back() + 100);
+
+    const auto stats = Core::ComputeFrameTimeStats(MakeHistory(present_times));
+    REQUIRE(stats.num_frames == 100);
+    REQUIRE(stats.dropped_frames == 0);
+    REQUIRE(stats.average == Approx(10.9));
+    REQUIRE(stats.percentile_99 == Approx(10.0));
+    REQUIRE(stats.percentile_999 == Approx(100.0));
+    REQUIRE(stats.max == Approx(100.0));
+}
+
+TEST_CASE("PerfStats[DroppedFrames]", "[core]") {
+    // Negative times mark frames the renderer processed but never presented
+    auto history = MakeHistory({0, 16, -1, 50});
+    const auto stats = Core::ComputeFrameTimeStats(history);
+    REQUIRE(stats.num_frames == 2);
+    REQUIRE(stats.dropped_frames == 1);
+    REQUIRE(stats.max == Approx(34.0));
+}
+
+TEST_CASE("PerfStats[AudioStats]", "[core]") {
+    Core::PerfStats perf_stats;
+    Core::AudioStageTimes times{};
+    times[static_cast<std::size_t>(Core::AudioStage::Mix)] = std::chrono::microseconds{5};
+    perf_stats.AddAudioStats(times, 2, 8);
+    perf_stats.AddAudioStats(times, 1, 3);
+
+    const auto stats = perf_stats.GetAndResetAudioStats();
+    REQUIRE(stats.num_mixes == 3);
+    REQUIRE(stats.max_active_voices == 8);
+    REQUIRE(stats.stage_times[static_cast<std::size_t>(Core::AudioStage::Mix)] ==
+            std::chrono::microseconds{10});
+
+    // The statistics start over after being read
+    REQUIRE(perf_stats.GetAndResetAudioStats().num_mixes == 0);
+}
@@ -0,0 +1,99 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+#include "common/assert.h"
+#include "core/memory.h"
+#include "video_core/cached_page_counter.h"
+
+namespace VideoCommon {
+
+CachedPageCounter::CachedPageCounter() = default;
+
+CachedPageCounter::~CachedPageCounter() = default;
+
+void CachedPageCounter::Update(VAddr addr, u64 size, int delta) {
+    if (size == 0 || delta == 0) {
+        return;
+    }
+    ASSERT(std::abs(delta) <= std::numeric_limits<u16>::max());
+
+    const u64 page_start = addr >> Memory::PAGE_BITS;
+    const u64 page_end = (addr + size + Memory::PAGE_SIZE - 1) >> Memory::PAGE_BITS;
+    const bool increment = delta > 0;
+    const u16 magnitude = static_cast<u16>(std::abs(delta));
+    // Adding the two's complement of a decrement wraps to the subtraction
+    const u16 step = static_cast<u16>(delta);
+    // Count pages have before the update when it takes them from or to zero
+    const u16 transition_count = increment ? 0 : magnitude;
+    const u16 max_count = static_cast<u16>(std::numeric_limits<u16>::max() - magnitude);
+
+    // Contiguous transitioning pages are marked with a single call, also across chunks
+    u64 run_start = 0;
+    u64 run_end = 0;
+    const auto flush_run = [&] {
+        if (run_start == run_end) {
+            return;
+        }
+        Memory::RasterizerMarkRegionCached(run_start << Memory::PAGE_BITS,
+                                           (run_end - run_start) << Memory::PAGE_BITS, increment);
+        run_start = run_end = 0;
+    };
+
+    for (u64 page = page_start; page < page_end;) {
+        const u64 chunk_index = page >> CHUNK_BITS;
+        const u64 chunk_base = chunk_index << CHUNK_BITS;
+        const std::size_t first = static_cast<std::size_t>(page - chunk_base);
+        const std::size_t last = static_cast<std::size_t>(std::min<u64>(page_end - chunk_base,
+                                                                        CHUNK_PAGES));
+        u16* const counts = GetChunk(static_cast<std::size_t>(chunk_index)).data();
+
+        // Branchless reductions, these vectorize and most updates don't transition any page
+        bool has_transitions = false;
+        bool out_of_range = false;
+        for (std::size_t i = first; i < last; ++i) {
+            has_transitions |= counts[i] == transition_count;
+            out_of_range |= increment ? counts[i] > max_count : counts[i] < magnitude;
+        }
+        ASSERT_MSG(!out_of_range, "Cached page count out of range");
+
+        if (has_transitions) {
+            for (std::size_t i = first; i < last; ++i) {
+                if (counts[i] != transition_count) {
+                    flush_run();
+                    continue;
+                }
+                const u64 transition_page = chunk_base + i;
+                if (run_start == run_end) {
+                    run_start = transition_page;
+                }
+                run_end = transition_page + 1;
+            }
+        } else {
+            flush_run();
+        }
+
+        for (std::size_t i = first; i < last; ++i) {
+            counts[i] = static_cast<u16>(counts[i] + step);
+        }
+        page = chunk_base + last;
+    }
+    flush_run();
+}
+
+CachedPageCounter::Chunk& CachedPageCounter::GetChunk(std::size_t index) {
+    if (index >= chunks.size()) {
+        chunks.resize(index + 1);
+    }
+    auto& chunk = chunks[index];
+    if (!chunk) {
+        chunk = std::make_unique<Chunk>();
+    }
+    return *chunk;
+}
+
+} // namespace VideoCommon
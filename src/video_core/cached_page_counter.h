@@ -0,0 +1,41 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/**
+ * Counts how many cached objects overlap each guest page, marking pages as cached in the memory
+ * manager when their count leaves zero and as uncached when it returns to zero. Counts are stored
+ * in chunks of contiguous pages allocated the first time an object is cached in them, so updates
+ * are linear passes over arrays instead of interval map insertions.
+ */
+class CachedPageCounter final {
+public:
+    CachedPageCounter();
+    ~CachedPageCounter();
+
+    /// Adds delta to the count of every page overlapping the given region
+    void Update(VAddr addr, u64 size, int delta);
+
+private:
+    static constexpr std::size_t CHUNK_BITS = 14;
+    static constexpr std::size_t CHUNK_PAGES = std::size_t{1} << CHUNK_BITS;
+
+    using Chunk = std::array<u16, CHUNK_PAGES>;
+
+    Chunk& GetChunk(std::size_t index);
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+};
+
+} // namespace VideoCommon
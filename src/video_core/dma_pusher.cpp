@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "common/microprofile.h"
+#include <algorithm>
+
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/memory.h"
 #include "video_core/dma_pusher.h"
@@ -16,10 +18,10 @@ DmaPusher::DmaPusher(GPU& gpu) : gpu(gpu) {}
 
 DmaPusher::~DmaPusher() = default;
 
-MICROPROFILE_DEFINE(DispatchCalls, "GPU", "Execute command buffer", MP_RGB(128, 128, 192));
+TRACE_DEFINE(DispatchCalls, "GPU", "Execute command buffer", MP_RGB(128, 128, 192));
 
 void DmaPusher::DispatchCalls() {
-    MICROPROFILE_SCOPE(DispatchCalls);
+    TRACE_SCOPE(DispatchCalls);
 
     // On entering GPU code, assume all memory may be touched by the ARM core.
     gpu.Maxwell3D().dirty_flags.OnMemoryWrite();
@@ -31,6 +33,10 @@ void DmaPusher::DispatchCalls() {
             break;
         }
     }
+
+    // Draws can't be deferred past the end of the submission, as the caches may be flushed or
+    // invalidated before the next one.
+    gpu.Maxwell3D().FlushPendingDraw();
 }
 
 bool DmaPusher::Step() {
@@ -43,6 +49,7 @@ bool DmaPusher::Step() {
     ASSERT_OR_EXECUTE(!command_list.empty(), {
         // Somehow the command_list is empty, in order to avoid a crash
         // We ignore it and assume its size is 0.
+        gpu.RecycleCommandList(std::move(dma_pushbuffer.front()));
         dma_pushbuffer.pop();
         dma_pushbuffer_subindex = 0;
         return true;
@@ -54,6 +61,7 @@ bool DmaPusher::Step() {
 
     if (dma_pushbuffer_subindex >= command_list.size()) {
         // We've gone through the current list, remove it from the queue
+        gpu.RecycleCommandList(std::move(dma_pushbuffer.front()));
         dma_pushbuffer.pop();
         dma_pushbuffer_subindex = 0;
     }
@@ -62,18 +70,34 @@ bool DmaPusher::Step() {
         return true;
     }
 
-    // Push buffer non-empty, read a word
-    command_headers.resize(command_list_header.size);
-    gpu.MemoryManager().ReadBlockUnsafe(dma_get, command_headers.data(),
-                                        command_list_header.size * sizeof(u32));
+    // Push buffer non-empty, read a word. Avoid the copy when the segment is contiguous in host
+    // memory, which is almost always the case.
+    auto& memory_manager = gpu.MemoryManager();
+    const u32 num_words = static_cast<u32>(command_list_header.size);
+    const std::size_t size = num_words * sizeof(u32);
+    const CommandHeader* headers;
+    if (memory_manager.IsBlockContinuous(dma_get, size)) {
+        headers = reinterpret_cast<const CommandHeader*>(memory_manager.GetPointer(dma_get));
+    } else {
+        command_headers.resize(num_words);
+        memory_manager.ReadBlockUnsafe(dma_get, command_headers.data(), size);
+        headers = command_headers.data();
+    }
 
-    for (const CommandHeader& command_header : command_headers) {
+    for (u32 index = 0; index < num_words; ++index) {
+        const CommandHeader& command_header = headers[index];
 
         // now, see if we're in the middle of a command
         if (dma_state.length_pending) {
             // Second word of long non-inc methods command - method count
             dma_state.length_pending = 0;
             dma_state.method_count = command_header.method_count_;
+        } else if (dma_state.method_count && dma_state.non_incrementing) {
+            // Data words of non-incrementing methods command, send all the words in this segment
+            const u32 amount = std::min(num_words - index, dma_state.method_count);
+            CallMultiMethod(&command_header.argument, amount);
+            dma_state.method_count -= amount;
+            index += amount - 1;
         } else if (dma_state.method_count) {
             // Data word of methods command
             CallMethod(command_header.argument);
@@ -136,4 +160,9 @@ void DmaPusher::CallMethod(u32 argument) const {
     gpu.CallMethod({dma_state.method, argument, dma_state.subchannel, dma_state.method_count});
 }
 
+void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
+    gpu.CallMultiMethod(dma_state.method, dma_state.subchannel, base_start, num_methods,
+                        dma_state.method_count);
+}
+
 } // namespace Tegra
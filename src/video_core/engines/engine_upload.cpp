@@ -7,12 +7,14 @@
 #include "common/assert.h"
 #include "video_core/engines/engine_upload.h"
 #include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines::Upload {
 
-State::State(MemoryManager& memory_manager, Registers& regs)
-    : regs{regs}, memory_manager{memory_manager} {}
+State::State(VideoCore::RasterizerInterface& rasterizer, MemoryManager& memory_manager,
+             Registers& regs)
+    : regs{regs}, rasterizer{rasterizer}, memory_manager{memory_manager} {}
 
 State::~State() = default;
 
@@ -24,15 +26,24 @@ void State::ProcessExec(const bool is_linear) {
 }
 
 void State::ProcessData(const u32 data, const bool is_last_call) {
-    const u32 sub_copy_size = std::min(4U, copy_size - write_offset);
-    std::memcpy(&inner_buffer[write_offset], &data, sub_copy_size);
-    write_offset += sub_copy_size;
+    ProcessData(&data, 1, is_last_call);
+}
+
+void State::ProcessData(const u32* data, const std::size_t num_data, const bool is_last_call) {
+    const u32 sub_copy_size =
+        static_cast<u32>(std::min<std::size_t>(num_data * sizeof(u32), copy_size - write_offset));
+    if (sub_copy_size != 0) {
+        std::memcpy(&inner_buffer[write_offset], data, sub_copy_size);
+        write_offset += sub_copy_size;
+    }
     if (!is_last_call) {
         return;
     }
     const GPUVAddr address{regs.dest.Address()};
     if (is_linear) {
-        memory_manager.WriteBlock(address, inner_buffer.data(), copy_size);
+        if (!rasterizer.AccelerateInlineToMemory(address, inner_buffer.data(), copy_size)) {
+            memory_manager.WriteBlock(address, inner_buffer.data(), copy_size);
+        }
     } else {
         UNIMPLEMENTED_IF(regs.dest.z != 0);
         UNIMPLEMENTED_IF(regs.dest.depth != 1);
@@ -12,6 +12,10 @@ namespace Tegra {
 class MemoryManager;
 }
 
+namespace VideoCore {
+class RasterizerInterface;
+}
+
 namespace Tegra::Engines::Upload {
 
 struct Registers {
@@ -54,11 +58,13 @@ struct Registers {
 
 class State {
 public:
-    State(MemoryManager& memory_manager, Registers& regs);
+    State(VideoCore::RasterizerInterface& rasterizer, MemoryManager& memory_manager,
+          Registers& regs);
     ~State();
 
     void ProcessExec(bool is_linear);
     void ProcessData(u32 data, bool is_last_call);
+    void ProcessData(const u32* data, std::size_t num_data, bool is_last_call);
 
 private:
     u32 write_offset = 0;
@@ -67,6 +73,7 @@ private:
     std::vector<u8> tmp_buffer;
     bool is_linear = false;
     Registers& regs;
+    VideoCore::RasterizerInterface& rasterizer;
     MemoryManager& memory_manager;
 };
 
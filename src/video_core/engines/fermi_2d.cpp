@@ -2,12 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines {
 
@@ -30,6 +34,13 @@ void Fermi2D::CallMethod(const GPU::MethodCall& method_call) {
     }
 }
 
+void Fermi2D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                              u32 methods_pending) {
+    for (u32 i = 0; i < amount; ++i) {
+        CallMethod({method, base_start[i], 0, methods_pending - i});
+    }
+}
+
 void Fermi2D::HandleSurfaceCopy() {
     LOG_WARNING(HW_GPU, "Requested a surface copy with operation {}",
                 static_cast<u32>(regs.operation));
@@ -49,9 +60,87 @@ void Fermi2D::HandleSurfaceCopy() {
                                           regs.blit_dst_x + regs.blit_dst_width,
                                           regs.blit_dst_y + regs.blit_dst_height};
 
-    if (!rasterizer.AccelerateSurfaceCopy(regs.src, regs.dst, src_rect, dst_rect)) {
-        UNIMPLEMENTED();
+    const Config config{regs.operation, regs.blit_control.filter, src_rect, dst_rect};
+    if (!rasterizer.AccelerateSurfaceCopy(regs.src, regs.dst, config)) {
+        CopySurfacesInMemory(config);
+    }
+}
+
+void Fermi2D::CopySurfacesInMemory(const Config& config) {
+    const u32 bytes_per_pixel = RenderTargetBytesPerPixel(regs.src.format);
+    if (bytes_per_pixel != RenderTargetBytesPerPixel(regs.dst.format)) {
+        UNIMPLEMENTED_MSG("Unimplemented surface copy from format {} to format {}",
+                          static_cast<u32>(regs.src.format), static_cast<u32>(regs.dst.format));
+        return;
+    }
+    if (regs.src.width == 0 || regs.src.height == 0) {
+        return;
+    }
+
+    ReadLinearImage(regs.src, bytes_per_pixel, src_image);
+    ReadLinearImage(regs.dst, bytes_per_pixel, dst_image);
+
+    // Source coordinates are 32.32 fixed point, stepped by du_dx and dv_dy per destination texel
+    const u32 dst_right = std::min(config.dst_rect.right, regs.dst.width);
+    const u32 dst_bottom = std::min(config.dst_rect.bottom, regs.dst.height);
+    for (u32 y = config.dst_rect.top; y < dst_bottom; ++y) {
+        const u64 src_y_fixed = regs.blit_src_y + (y - config.dst_rect.top) * regs.blit_dv_dy;
+        const u32 src_y = std::min(static_cast<u32>(src_y_fixed >> 32), regs.src.height - 1);
+        for (u32 x = config.dst_rect.left; x < dst_right; ++x) {
+            const u64 src_x_fixed = regs.blit_src_x + (x - config.dst_rect.left) * regs.blit_du_dx;
+            const u32 src_x = std::min(static_cast<u32>(src_x_fixed >> 32), regs.src.width - 1);
+            std::memcpy(&dst_image[(y * regs.dst.width + x) * bytes_per_pixel],
+                        &src_image[(src_y * regs.src.width + src_x) * bytes_per_pixel],
+                        bytes_per_pixel);
+        }
     }
+
+    WriteLinearImage(regs.dst, bytes_per_pixel, dst_image);
+}
+
+void Fermi2D::ReadLinearImage(const Regs::Surface& surface, u32 bytes_per_pixel,
+                              std::vector<u8>& image) {
+    const std::size_t row_size = static_cast<std::size_t>(surface.width) * bytes_per_pixel;
+    image.resize(row_size * surface.height);
+
+    if (surface.linear) {
+        for (u32 y = 0; y < surface.height; ++y) {
+            memory_manager.ReadBlock(surface.Address() + static_cast<u64>(y) * surface.pitch,
+                                     &image[y * row_size], row_size);
+        }
+        return;
+    }
+
+    tiled_buffer.resize(Texture::CalculateSize(true, bytes_per_pixel, surface.width,
+                                               surface.height, 1, surface.BlockHeight(),
+                                               surface.BlockDepth()));
+    memory_manager.ReadBlock(surface.Address(), tiled_buffer.data(), tiled_buffer.size());
+    Texture::CopySwizzledData(surface.width, surface.height, 1, bytes_per_pixel, bytes_per_pixel,
+                              tiled_buffer.data(), image.data(), true, surface.BlockHeight(),
+                              surface.BlockDepth(), 1);
+}
+
+void Fermi2D::WriteLinearImage(const Regs::Surface& surface, u32 bytes_per_pixel,
+                               std::vector<u8>& image) {
+    const std::size_t row_size = static_cast<std::size_t>(surface.width) * bytes_per_pixel;
+
+    if (surface.linear) {
+        for (u32 y = 0; y < surface.height; ++y) {
+            memory_manager.WriteBlock(surface.Address() + static_cast<u64>(y) * surface.pitch,
+                                      &image[y * row_size], row_size);
+        }
+        return;
+    }
+
+    // The tiled buffer still holds the destination read by ReadLinearImage, including the bytes
+    // outside of the image
+    tiled_buffer.resize(Texture::CalculateSize(true, bytes_per_pixel, surface.width,
+                                               surface.height, 1, surface.BlockHeight(),
+                                               surface.BlockDepth()));
+    Texture::CopySwizzledData(surface.width, surface.height, 1, bytes_per_pixel, bytes_per_pixel,
+                              tiled_buffer.data(), image.data(), false, surface.BlockHeight(),
+                              surface.BlockDepth(), 1);
+    memory_manager.WriteBlock(surface.Address(), tiled_buffer.data(), tiled_buffer.size());
 }
 
 } // namespace Tegra::Engines
@@ -6,9 +6,11 @@
 
 #include <array>
 #include <cstddef>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
+#include "common/math_util.h"
 #include "video_core/gpu.h"
 
 namespace Tegra {
@@ -38,6 +40,9 @@ public:
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Write multiple values to the register identified by method.
+    void CallMultiMethod(u32 method, const u32* base_start, u32 amount, u32 methods_pending);
+
     struct Regs {
         static constexpr std::size_t NUM_REGS = 0x258;
 
@@ -79,6 +84,11 @@ public:
         };
         static_assert(sizeof(Surface) == 0x28, "Surface has incorrect size");
 
+        enum class Filter : u32 {
+            PointSample = 0,
+            Linear = 1,
+        };
+
         enum class Operation : u32 {
             SrcCopyAnd = 0,
             ROPAnd = 1,
@@ -105,7 +115,11 @@ public:
 
                 INSERT_PADDING_WORDS(0x177);
 
-                u32 blit_control;
+                union {
+                    u32 raw;
+                    BitField<0, 1, u32> origin;
+                    BitField<4, 1, Filter> filter;
+                } blit_control;
 
                 INSERT_PADDING_WORDS(0x8);
 
@@ -124,6 +138,14 @@ public:
         };
     } regs{};
 
+    /// Parameters of a surface copy that are not part of the surfaces
+    struct Config {
+        Regs::Operation operation;
+        Regs::Filter filter;
+        Common::Rectangle<u32> src_rect;
+        Common::Rectangle<u32> dst_rect;
+    };
+
 private:
     VideoCore::RasterizerInterface& rasterizer;
     MemoryManager& memory_manager;
@@ -131,6 +153,21 @@ private:
     /// Performs the copy from the source surface to the destination surface as configured in the
     /// registers.
     void HandleSurfaceCopy();
+
+    /// Copies the surfaces in guest memory when the rasterizer does not accelerate the copy.
+    /// Texels are point sampled and copied as they are, without format conversion.
+    void CopySurfacesInMemory(const Config& config);
+
+    /// Reads a surface from guest memory into a linear image, rows are width * bytes_per_pixel
+    void ReadLinearImage(const Regs::Surface& surface, u32 bytes_per_pixel, std::vector<u8>& image);
+
+    /// Writes a linear image read with ReadLinearImage back to the surface in guest memory
+    void WriteLinearImage(const Regs::Surface& surface, u32 bytes_per_pixel,
+                          std::vector<u8>& image);
+
+    std::vector<u8> src_image;
+    std::vector<u8> dst_image;
+    std::vector<u8> tiled_buffer;
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -16,9 +17,8 @@ namespace Tegra::Engines {
 
 KeplerCompute::KeplerCompute(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                              MemoryManager& memory_manager)
-    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager}, upload_state{
-                                                                                  memory_manager,
-                                                                                  regs.upload} {}
+    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
+      upload_state{rasterizer, memory_manager, regs.upload} {}
 
 KeplerCompute::~KeplerCompute() = default;
 
@@ -49,14 +49,86 @@ void KeplerCompute::CallMethod(const GPU::MethodCall& method_call) {
     }
 }
 
-void KeplerCompute::ProcessLaunch() {
+void KeplerCompute::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                    u32 methods_pending) {
+    // Inline uploads are copied at once, other methods are processed one word at a time
+    if (method != KEPLER_COMPUTE_REG_INDEX(data_upload)) {
+        for (u32 i = 0; i < amount; ++i) {
+            CallMethod({method, base_start[i], 0, methods_pending - i});
+        }
+        return;
+    }
+
+    regs.reg_array[method] = base_start[amount - 1];
+    const bool is_last_call = amount == methods_pending;
+    upload_state.ProcessData(base_start, amount, is_last_call);
+    if (is_last_call) {
+        system.GPU().Maxwell3D().dirty_flags.OnMemoryWrite();
+    }
+}
+
+Texture::FullTextureInfo KeplerCompute::GetTextureInfo(Texture::TextureHandle tex_handle,
+                                                       std::size_t offset) const {
+    Texture::FullTextureInfo tex_info{};
+    tex_info.index = static_cast<u32>(offset);
 
+    // Linked launches sample with the TSC entry of the same index as the TIC entry
+    const u32 tsc_id = launch_description.linked_tsc ? tex_handle.tic_id : tex_handle.tsc_id;
+
+    // TODO(Subv): Workaround for BitField's move constructor being deleted.
+    const Texture::TICEntry tic_entry = GetTICEntry(tex_handle.tic_id);
+    std::memcpy(&tex_info.tic, &tic_entry, sizeof(tic_entry));
+    const Texture::TSCEntry tsc_entry = GetTSCEntry(tsc_id);
+    std::memcpy(&tex_info.tsc, &tsc_entry, sizeof(tsc_entry));
+
+    return tex_info;
+}
+
+Texture::FullTextureInfo KeplerCompute::GetTexture(std::size_t offset) const {
+    const auto& tex_info_buffer =
+        launch_description.const_buffer_config[regs.texture_const_buffer_index];
+    const GPUVAddr tex_info_address =
+        tex_info_buffer.Address() + offset * sizeof(Texture::TextureHandle);
+    ASSERT(tex_info_address < tex_info_buffer.Address() + tex_info_buffer.size);
+
+    const Texture::TextureHandle tex_handle{memory_manager.Read<u32>(tex_info_address)};
+    return GetTextureInfo(tex_handle, offset);
+}
+
+u32 KeplerCompute::AccessConstBuffer32(u64 const_buffer, u64 offset) const {
+    const auto& buffer = launch_description.const_buffer_config[const_buffer];
+    return memory_manager.Read<u32>(buffer.Address() + offset);
+}
+
+void KeplerCompute::ProcessLaunch() {
     const GPUVAddr launch_desc_loc = regs.launch_desc_loc.Address();
     memory_manager.ReadBlockUnsafe(launch_desc_loc, &launch_description,
                                    LaunchParams::NUM_LAUNCH_PARAMETERS * sizeof(u32));
 
-    const GPUVAddr code_loc = regs.code_loc.Address() + launch_description.program_start;
-    LOG_WARNING(HW_GPU, "Compute Kernel Execute at Address 0x{:016x}, STUBBED", code_loc);
+    const GPUVAddr code_addr = regs.code_loc.Address() + launch_description.program_start;
+    LOG_TRACE(HW_GPU, "Compute dispatch at 0x{:016x}", code_addr);
+
+    rasterizer.DispatchCompute(code_addr);
+}
+
+Texture::TICEntry KeplerCompute::GetTICEntry(u32 tic_index) const {
+    const GPUVAddr tic_address_gpu{regs.tic.Address() + tic_index * sizeof(Texture::TICEntry)};
+
+    Texture::TICEntry tic_entry;
+    memory_manager.ReadBlockUnsafe(tic_address_gpu, &tic_entry, sizeof(Texture::TICEntry));
+
+    ASSERT_MSG(tic_entry.header_version == Texture::TICHeaderVersion::BlockLinear ||
+                   tic_entry.header_version == Texture::TICHeaderVersion::Pitch,
+               "TIC versions other than BlockLinear or Pitch are unimplemented");
+    return tic_entry;
+}
+
+Texture::TSCEntry KeplerCompute::GetTSCEntry(u32 tsc_index) const {
+    const GPUVAddr tsc_address_gpu{regs.tsc.Address() + tsc_index * sizeof(Texture::TSCEntry)};
+
+    Texture::TSCEntry tsc_entry;
+    memory_manager.ReadBlockUnsafe(tsc_address_gpu, &tsc_entry, sizeof(Texture::TSCEntry));
+    return tsc_entry;
 }
 
 } // namespace Tegra::Engines
@@ -14,8 +14,10 @@
 
 namespace Tegra::Engines {
 
-KeplerMemory::KeplerMemory(Core::System& system, MemoryManager& memory_manager)
-    : system{system}, memory_manager{memory_manager}, upload_state{memory_manager, regs.upload} {}
+KeplerMemory::KeplerMemory(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                           MemoryManager& memory_manager)
+    : system{system}, memory_manager{memory_manager}, upload_state{rasterizer, memory_manager,
+                                                                   regs.upload} {}
 
 KeplerMemory::~KeplerMemory() = default;
 
@@ -41,4 +43,22 @@ void KeplerMemory::CallMethod(const GPU::MethodCall& method_call) {
     }
 }
 
+void KeplerMemory::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                   u32 methods_pending) {
+    // Inline uploads are copied at once, other methods are processed one word at a time
+    if (method != KEPLERMEMORY_REG_INDEX(data)) {
+        for (u32 i = 0; i < amount; ++i) {
+            CallMethod({method, base_start[i], 0, methods_pending - i});
+        }
+        return;
+    }
+
+    regs.reg_array[method] = base_start[amount - 1];
+    const bool is_last_call = amount == methods_pending;
+    upload_state.ProcessData(base_start, amount, is_last_call);
+    if (is_last_call) {
+        system.GPU().Maxwell3D().dirty_flags.OnMemoryWrite();
+    }
+}
+
 } // namespace Tegra::Engines
@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/memory.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/memory_manager.h"
@@ -18,10 +20,96 @@ namespace Tegra::Engines {
 /// First register id that is actually a Macro call.
 constexpr u32 MacroRegistersStart = 0xE00;
 
+namespace {
+
+using DirtyFlags = Maxwell3D::DirtyFlags;
+using Regs = Maxwell3D::Regs;
+
+static_assert(DirtyFlags::NumStateFlags <= 16, "Dirty state flags don't fit in the table");
+
+/// Builds the table of the dirty state flags set by writes to each register.
+constexpr std::array<u16, Regs::NUM_REGS> MakeDirtyStateTable() {
+    std::array<u16, Regs::NUM_REGS> table{};
+    const auto mark = [&table](std::size_t index, std::size_t size, DirtyFlags::StateFlag flag) {
+        for (std::size_t reg = index; reg < index + size / sizeof(u32); ++reg) {
+            table[reg] |= static_cast<u16>(1U << flag);
+        }
+    };
+#define MARK_DIRTY(field_name, flag)                                                               \
+    mark(MAXWELL3D_REG_INDEX(field_name), sizeof(Regs::field_name), DirtyFlags::flag)
+
+    // The amount of viewports and scissors in use depends on the geometry shader being enabled
+    MARK_DIRTY(viewport_transform, Viewport);
+    MARK_DIRTY(viewports, Viewport);
+    MARK_DIRTY(view_volume_clip_control, Viewport);
+    MARK_DIRTY(shader_config, Viewport);
+    MARK_DIRTY(scissor_test, Scissor);
+    MARK_DIRTY(shader_config, Scissor);
+
+    MARK_DIRTY(color_mask, ColorMask);
+    MARK_DIRTY(color_mask_common, ColorMask);
+    MARK_DIRTY(independent_blend_enable, ColorMask);
+
+    MARK_DIRTY(frag_color_clamp, FragmentColorClamp);
+    MARK_DIRTY(multisample_control, MultiSample);
+
+    MARK_DIRTY(depth_test_enable, DepthTest);
+    MARK_DIRTY(depth_write_enabled, DepthTest);
+    MARK_DIRTY(depth_test_func, DepthTest);
+
+    MARK_DIRTY(stencil_enable, StencilTest);
+    MARK_DIRTY(stencil_front_op_fail, StencilTest);
+    MARK_DIRTY(stencil_front_op_zfail, StencilTest);
+    MARK_DIRTY(stencil_front_op_zpass, StencilTest);
+    MARK_DIRTY(stencil_front_func_func, StencilTest);
+    MARK_DIRTY(stencil_front_func_ref, StencilTest);
+    MARK_DIRTY(stencil_front_func_mask, StencilTest);
+    MARK_DIRTY(stencil_front_mask, StencilTest);
+    MARK_DIRTY(stencil_two_side_enable, StencilTest);
+    MARK_DIRTY(stencil_back_op_fail, StencilTest);
+    MARK_DIRTY(stencil_back_op_zfail, StencilTest);
+    MARK_DIRTY(stencil_back_op_zpass, StencilTest);
+    MARK_DIRTY(stencil_back_func_func, StencilTest);
+    MARK_DIRTY(stencil_back_func_ref, StencilTest);
+    MARK_DIRTY(stencil_back_func_mask, StencilTest);
+    MARK_DIRTY(stencil_back_mask, StencilTest);
+
+    MARK_DIRTY(blend_color, Blend);
+    MARK_DIRTY(independent_blend_enable, Blend);
+    MARK_DIRTY(blend, Blend);
+    MARK_DIRTY(independent_blend, Blend);
+
+    // Logic operations are validated against the blending state
+    MARK_DIRTY(logic_op, LogicOp);
+    MARK_DIRTY(blend, LogicOp);
+
+    // Front faces are flipped along with the rasterized triangles
+    MARK_DIRTY(cull, CullMode);
+    MARK_DIRTY(screen_y_control, CullMode);
+    MARK_DIRTY(viewport_transform, CullMode);
+
+    MARK_DIRTY(primitive_restart, PrimitiveRestart);
+    MARK_DIRTY(point_size, PointSize);
+
+    MARK_DIRTY(polygon_offset_fill_enable, PolygonOffset);
+    MARK_DIRTY(polygon_offset_line_enable, PolygonOffset);
+    MARK_DIRTY(polygon_offset_point_enable, PolygonOffset);
+    MARK_DIRTY(polygon_offset_units, PolygonOffset);
+    MARK_DIRTY(polygon_offset_factor, PolygonOffset);
+    MARK_DIRTY(polygon_offset_clamp, PolygonOffset);
+
+#undef MARK_DIRTY
+    return table;
+}
+
+constexpr auto dirty_state_table = MakeDirtyStateTable();
+
+} // Anonymous namespace
+
 Maxwell3D::Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                      MemoryManager& memory_manager)
     : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
-      macro_interpreter{*this}, upload_state{memory_manager, regs.upload} {
+      macro_interpreter{*this}, upload_state{rasterizer, memory_manager, regs.upload} {
     InitializeRegisterDefaults();
 }
 
@@ -86,7 +174,7 @@ void Maxwell3D::InitializeRegisterDefaults() {
     regs.rt_separate_frag_data = 1;
 }
 
-void Maxwell3D::CallMacroMethod(u32 method, std::vector<u32> parameters) {
+void Maxwell3D::CallMacroMethod(u32 method, const std::vector<u32>& parameters) {
     // Reset the current macro.
     executing_macro = 0;
 
@@ -100,7 +188,20 @@ void Maxwell3D::CallMacroMethod(u32 method, std::vector<u32> parameters) {
     }
 
     // Execute the current macro.
-    macro_interpreter.Execute(search->second, std::move(parameters));
+    macro_interpreter.Execute(search->second, parameters.size(), parameters.data());
+}
+
+void Maxwell3D::CallCurrentMacro() {
+    // The macro may start another macro call, so it can't use macro_params directly.
+    std::vector<u32> parameters = std::move(macro_params);
+    macro_params.clear();
+    CallMacroMethod(executing_macro, parameters);
+
+    // Keep the allocation around for the next macro call.
+    if (macro_params.empty()) {
+        parameters.clear();
+        macro_params = std::move(parameters);
+    }
 }
 
 void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
@@ -129,7 +230,7 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
 
         // Call the macro when there are no more parameters in the command buffer
         if (method_call.IsLastCall()) {
-            CallMacroMethod(executing_macro, std::move(macro_params));
+            CallCurrentMacro();
         }
         return;
     }
@@ -141,8 +242,19 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
         debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandLoaded, nullptr);
     }
 
+    if (!pending_draw.draws.empty()) {
+        if (!IsDrawBatchableWrite(method, method_call.argument)) {
+            FlushPendingDraw();
+        } else if (method == MAXWELL3D_REG_INDEX(vertex_buffer.count) ||
+                   method == MAXWELL3D_REG_INDEX(index_array.count)) {
+            pending_draw.count_written = true;
+        }
+    }
+
     if (regs.reg_array[method] != method_call.argument) {
         regs.reg_array[method] = method_call.argument;
+        dirty_flags.state |= DirtyFlags::StateFlags{dirty_state_table[method]};
+
         // Color buffers
         constexpr u32 first_rt_reg = MAXWELL3D_REG_INDEX(rt);
         constexpr u32 registers_per_rt = sizeof(regs.rt[0]) / sizeof(u32);
@@ -249,6 +361,14 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
         ProcessQueryGet();
         break;
     }
+    case MAXWELL3D_REG_INDEX(counter_reset): {
+        ProcessCounterReset();
+        break;
+    }
+    case MAXWELL3D_REG_INDEX(condition.mode): {
+        ProcessQueryCondition();
+        break;
+    }
     case MAXWELL3D_REG_INDEX(sync_info): {
         ProcessSyncPoint();
         break;
@@ -274,10 +394,51 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
     }
 }
 
+void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                u32 methods_pending) {
+    const bool is_last_call = amount == methods_pending;
+
+    // Macro arguments, inline uploads and constant buffer updates are consumed at once. Anything
+    // else, and every method while a debug context has to observe them, is processed one word at
+    // a time.
+    if (system.GetGPUDebugContext() == nullptr) {
+        if (executing_macro != 0 && method == executing_macro + 1) {
+            macro_params.insert(macro_params.end(), base_start, base_start + amount);
+            if (is_last_call) {
+                CallCurrentMacro();
+            }
+            return;
+        }
+
+        if (method >= MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]) &&
+            method <= MAXWELL3D_REG_INDEX(const_buffer.cb_data[15])) {
+            FlushPendingDraw();
+            regs.reg_array[method] = base_start[amount - 1];
+            ProcessCBMultiData(base_start, amount);
+            return;
+        }
+
+        if (method == MAXWELL3D_REG_INDEX(data_upload)) {
+            FlushPendingDraw();
+            regs.reg_array[method] = base_start[amount - 1];
+            upload_state.ProcessData(base_start, amount, is_last_call);
+            if (is_last_call) {
+                dirty_flags.OnMemoryWrite();
+            }
+            return;
+        }
+    }
+
+    for (u32 i = 0; i < amount; ++i) {
+        CallMethod({method, base_start[i], 0, methods_pending - i});
+    }
+}
+
 void Maxwell3D::ProcessMacroUpload(u32 data) {
     ASSERT_MSG(regs.macros.upload_address < macro_memory.size(),
                "upload_address exceeded macro_memory size!");
     macro_memory[regs.macros.upload_address++] = data;
+    macro_interpreter.InvalidateCache();
 }
 
 void Maxwell3D::ProcessMacroBind(u32 data) {
@@ -294,6 +455,7 @@ void Maxwell3D::ProcessQueryGet() {
                "Units other than CROP are unimplemented");
 
     u64 result = 0;
+    const bool is_long_query = regs.query.query_get.short_query == 0;
 
     // TODO(Subv): Support the other query variables
     switch (regs.query.query_get.select) {
@@ -301,6 +463,19 @@ void Maxwell3D::ProcessQueryGet() {
         // This seems to actually write the query sequence to the query address.
         result = regs.query.query_sequence;
         break;
+    case Regs::QuerySelect::SamplesPassed: {
+        // The host GPU writes the result once it's available, the rasterizer flushes it when the
+        // guest reads the address
+        std::optional<u64> timestamp;
+        if (is_long_query) {
+            timestamp = system.CoreTiming().GetTicks();
+        }
+        if (rasterizer.Query(sequence_address, VideoCore::QueryType::SamplesPassed, timestamp)) {
+            return;
+        }
+        LOG_WARNING(HW_GPU, "Sample counts are not emulated by the rasterizer");
+        break;
+    }
     default:
         UNIMPLEMENTED_MSG("Unimplemented query select type {}",
                           static_cast<u32>(regs.query.query_get.select.Value()));
@@ -318,7 +493,7 @@ void Maxwell3D::ProcessQueryGet() {
     case Regs::QueryMode::Write:
     case Regs::QueryMode::Write2: {
         u32 sequence = regs.query.query_sequence;
-        if (regs.query.query_get.short_query) {
+        if (!is_long_query) {
             // Write the current query sequence to the sequence address.
             // TODO(Subv): Find out what happens if you use a long query type but mark it as a short
             // query.
@@ -342,6 +517,55 @@ void Maxwell3D::ProcessQueryGet() {
     }
 }
 
+void Maxwell3D::ProcessCounterReset() {
+    switch (regs.counter_reset) {
+    case Regs::CounterReset::SampleCnt:
+        rasterizer.ResetCounter(VideoCore::QueryType::SamplesPassed);
+        break;
+    default:
+        LOG_WARNING(HW_GPU, "Unimplemented counter reset={}",
+                    static_cast<u32>(regs.counter_reset));
+        break;
+    }
+}
+
+void Maxwell3D::ProcessQueryCondition() {
+    const GPUVAddr condition_address{regs.condition.Address()};
+    rasterizer.DisableConditionalRendering();
+    execute_on = true;
+
+    switch (regs.condition.mode) {
+    case Regs::ConditionMode::Always:
+        break;
+    case Regs::ConditionMode::Never:
+        execute_on = false;
+        break;
+    case Regs::ConditionMode::ResNonZero: {
+        if (rasterizer.AccelerateConditionalRendering(condition_address)) {
+            break;
+        }
+        // Reading the result flushes the pending query writing it
+        u64_le value;
+        memory_manager.ReadBlock(condition_address, &value, sizeof(value));
+        execute_on = value != 0;
+        break;
+    }
+    case Regs::ConditionMode::Equal:
+    case Regs::ConditionMode::NotEqual: {
+        // Compares the values of the two long query results stored at the address
+        std::array<u64_le, 4> results;
+        memory_manager.ReadBlock(condition_address, results.data(), sizeof(results));
+        const bool is_equal = results[0] == results[2];
+        execute_on = is_equal == (regs.condition.mode == Regs::ConditionMode::Equal);
+        break;
+    }
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented render condition mode={}",
+                          static_cast<u32>(regs.condition.mode));
+        break;
+    }
+}
+
 void Maxwell3D::ProcessSyncPoint() {
     const u32 sync_point = regs.sync_info.sync_point.Value();
     const u32 increment = regs.sync_info.increment.Value();
@@ -365,19 +589,102 @@ void Maxwell3D::DrawArrays() {
     ASSERT_MSG(!regs.draw.instance_next || !regs.draw.instance_cont,
                "Illegal combination of instancing parameters");
 
+    const bool is_indexed{regs.index_array.count && !regs.vertex_buffer.count};
     if (regs.draw.instance_next) {
         // Increment the current instance *before* drawing.
         state.current_instance += 1;
+
+        // Games draw instances one at a time, rewriting the same state for each of them. When
+        // nothing changed since the previous instance, it is merged into the pending draw.
+        if (CanMergeDraw(is_indexed)) {
+            State::DrawRange& last = pending_draw.draws.back();
+            const State::DrawRange range = GetDrawRange(is_indexed);
+            if (last.first == range.first && last.count == range.count &&
+                last.base_vertex == range.base_vertex) {
+                ++last.num_instances;
+                pending_draw.count_written = false;
+                return;
+            }
+        }
     } else if (!regs.draw.instance_cont) {
         // Reset the current instance to 0.
         state.current_instance = 0;
     }
 
-    const bool is_indexed{regs.index_array.count && !regs.vertex_buffer.count};
-    rasterizer.AccelerateDrawBatch(is_indexed);
+    // Draws of the same instance only changing the vertex or index range are batched together.
+    // Quads are not batched, they are converted to triangles on every draw.
+    if (CanMergeDraw(is_indexed) && pending_draw.base_instance == state.current_instance &&
+        pending_draw.draws.size() < MaxBatchedDraws &&
+        regs.draw.topology != Regs::PrimitiveTopology::Quads) {
+        pending_draw.draws.push_back(GetDrawRange(is_indexed));
+        pending_draw.count_written = false;
+        return;
+    }
 
-    if (debug_context) {
-        debug_context->OnEvent(Tegra::DebugContext::Event::FinishedPrimitiveBatch, nullptr);
+    // Executing the pending draw resets the count registers it used, which may hold the count of
+    // this draw when the guest didn't change it. The range is saved and written back after it.
+    const State::DrawRange range = GetDrawRange(is_indexed);
+    FlushPendingDraw();
+    SetDrawRange(is_indexed, range);
+
+    if (!debug_context) {
+        pending_draw.is_indexed = is_indexed;
+        pending_draw.base_instance = state.current_instance;
+        pending_draw.draws.push_back(range);
+        pending_draw.count_written = false;
+        return;
+    }
+
+    state.base_instance = state.current_instance;
+    state.num_instances = 1;
+    state.batched_draws.clear();
+    ExecuteDraw(is_indexed);
+
+    debug_context->OnEvent(Tegra::DebugContext::Event::FinishedPrimitiveBatch, nullptr);
+}
+
+void Maxwell3D::FlushPendingDraw() {
+    if (pending_draw.draws.empty()) {
+        return;
+    }
+
+    // The range registers may have already been written for the next draw
+    const bool is_indexed = pending_draw.is_indexed;
+    const State::DrawRange next_range = GetDrawRange(is_indexed);
+    const bool next_count_written = pending_draw.count_written;
+
+    state.base_instance = pending_draw.base_instance;
+    if (pending_draw.draws.size() == 1) {
+        const State::DrawRange& range = pending_draw.draws[0];
+        SetDrawRange(is_indexed, range);
+        state.num_instances = range.num_instances;
+        state.batched_draws.clear();
+        pending_draw.draws.clear();
+    } else {
+        state.num_instances = 1;
+        // Swap the vectors to keep their allocations around
+        std::swap(state.batched_draws, pending_draw.draws);
+        pending_draw.draws.clear();
+    }
+    ExecuteDraw(is_indexed);
+
+    if (is_indexed) {
+        regs.index_array.first = next_range.first;
+        regs.vb_element_base = next_range.base_vertex;
+        if (next_count_written) {
+            regs.index_array.count = next_range.count;
+        }
+    } else {
+        regs.vertex_buffer.first = next_range.first;
+        if (next_count_written) {
+            regs.vertex_buffer.count = next_range.count;
+        }
+    }
+}
+
+void Maxwell3D::ExecuteDraw(bool is_indexed) {
+    if (execute_on) {
+        rasterizer.AccelerateDrawBatch(is_indexed);
     }
 
     // TODO(bunnei): Below, we reset vertex count so that we can use these registers to determine if
@@ -391,6 +698,73 @@ void Maxwell3D::DrawArrays() {
     }
 }
 
+bool Maxwell3D::CanMergeDraw(bool is_indexed) const {
+    return !pending_draw.draws.empty() && pending_draw.count_written &&
+           pending_draw.is_indexed == is_indexed;
+}
+
+Maxwell3D::State::DrawRange Maxwell3D::GetDrawRange(bool is_indexed) const {
+    if (is_indexed) {
+        return {regs.index_array.first, regs.index_array.count, regs.vb_element_base, 1};
+    }
+    return {regs.vertex_buffer.first, regs.vertex_buffer.count, 0, 1};
+}
+
+void Maxwell3D::SetDrawRange(bool is_indexed, const State::DrawRange& range) {
+    if (is_indexed) {
+        regs.index_array.first = range.first;
+        regs.index_array.count = range.count;
+        regs.vb_element_base = range.base_vertex;
+    } else {
+        regs.vertex_buffer.first = range.first;
+        regs.vertex_buffer.count = range.count;
+    }
+}
+
+bool Maxwell3D::IsDrawBatchableWrite(u32 method, u32 argument) const {
+    if (method >= MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]) &&
+        method <= MAXWELL3D_REG_INDEX(const_buffer.cb_data[15])) {
+        return false;
+    }
+
+    switch (method) {
+    case MAXWELL3D_REG_INDEX(draw.vertex_end_gl):
+        // Draws decide by themselves whether they can be merged.
+        return true;
+    case MAXWELL3D_REG_INDEX(vertex_buffer.first):
+    case MAXWELL3D_REG_INDEX(vertex_buffer.count):
+        // The range of the following draw, it's recorded when the draw is merged.
+        return !pending_draw.is_indexed || regs.reg_array[method] == argument;
+    case MAXWELL3D_REG_INDEX(index_array.first):
+    case MAXWELL3D_REG_INDEX(index_array.count):
+    case MAXWELL3D_REG_INDEX(vb_element_base):
+        return pending_draw.is_indexed || regs.reg_array[method] == argument;
+    case MAXWELL3D_REG_INDEX(draw.vertex_begin_gl): {
+        // The instancing bits only affect the following draw, the topology has to match.
+        constexpr u32 instancing_mask = 0b11U << 26;
+        return ((regs.draw.vertex_begin_gl ^ argument) & ~instancing_mask) == 0;
+    }
+    case MAXWELL3D_REG_INDEX(macros.data):
+    case MAXWELL3D_REG_INDEX(macros.bind):
+    case MAXWELL3D_REG_INDEX(cb_bind[0].raw_config):
+    case MAXWELL3D_REG_INDEX(cb_bind[1].raw_config):
+    case MAXWELL3D_REG_INDEX(cb_bind[2].raw_config):
+    case MAXWELL3D_REG_INDEX(cb_bind[3].raw_config):
+    case MAXWELL3D_REG_INDEX(cb_bind[4].raw_config):
+    case MAXWELL3D_REG_INDEX(clear_buffers):
+    case MAXWELL3D_REG_INDEX(query.query_get):
+    case MAXWELL3D_REG_INDEX(counter_reset):
+    case MAXWELL3D_REG_INDEX(condition.mode):
+    case MAXWELL3D_REG_INDEX(sync_info):
+    case MAXWELL3D_REG_INDEX(exec_upload):
+    case MAXWELL3D_REG_INDEX(data_upload):
+        // Writes triggering an action, even if the value did not change.
+        return false;
+    default:
+        return regs.reg_array[method] == argument;
+    }
+}
+
 void Maxwell3D::ProcessCBBind(Regs::ShaderStage stage) {
     // Bind the buffer currently in CB_ADDRESS to the specified index in the desired shader stage.
     auto& shader = state.shader_stages[static_cast<std::size_t>(stage)];
@@ -426,11 +800,86 @@ void Maxwell3D::ProcessCBData(u32 value) {
     regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + 4;
 }
 
-Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
-    const GPUVAddr tic_address_gpu{regs.tic.TICAddress() + tic_index * sizeof(Texture::TICEntry)};
+void Maxwell3D::ProcessCBMultiData(const u32* start_base, u32 amount) {
+    // Write the input values to the current const buffer at the current position.
+    const GPUVAddr buffer_address = regs.const_buffer.BufferAddress();
+    ASSERT(buffer_address != 0);
+
+    // Don't allow writing past the end of the buffer.
+    const std::size_t copy_size = amount * sizeof(u32);
+    ASSERT(regs.const_buffer.cb_pos + copy_size <= regs.const_buffer.cb_size);
 
-    Texture::TICEntry tic_entry;
-    memory_manager.ReadBlockUnsafe(tic_address_gpu, &tic_entry, sizeof(Texture::TICEntry));
+    const GPUVAddr address{buffer_address + regs.const_buffer.cb_pos};
+    if (!rasterizer.AccelerateInlineToMemory(address, reinterpret_cast<const u8*>(start_base),
+                                             copy_size)) {
+        memory_manager.WriteBlock(address, start_base, copy_size);
+    }
+
+    dirty_flags.OnMemoryWrite();
+
+    // Increment the current buffer position.
+    regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + static_cast<u32>(copy_size);
+}
+
+void Maxwell3D::InvalidateDescriptorCache(CacheAddr addr, u64 size) {
+    const auto overlaps = [addr, size](const std::pair<CacheAddr, VAddr>& page) {
+        return page.first < addr + size && addr < page.first + Memory::PAGE_SIZE;
+    };
+    if (std::any_of(descriptor_pages.begin(), descriptor_pages.end(), overlaps)) {
+        ClearDescriptorCache();
+    }
+}
+
+template <typename Descriptor>
+Descriptor Maxwell3D::ReadDescriptor(DescriptorTable<Descriptor>& table, GPUVAddr table_address,
+                                     u32 index) const {
+    if (table.address != table_address) {
+        // The table was moved, the pages of the old one don't have to be tracked anymore
+        ClearDescriptorCache();
+        table.address = table_address;
+    }
+    if (index < table.entries.size() && table.is_cached[index]) {
+        return table.entries[index];
+    }
+
+    const GPUVAddr address{table_address + index * sizeof(Descriptor)};
+    Descriptor descriptor;
+    memory_manager.ReadBlockUnsafe(address, &descriptor, sizeof(Descriptor));
+
+    const GPUVAddr page_address{address & ~Memory::PAGE_MASK};
+    const u8* const page_pointer{memory_manager.GetPointer(page_address)};
+    const auto cpu_addr{memory_manager.GpuToCpuAddress(page_address)};
+    if (!page_pointer || !cpu_addr) {
+        // Writes to unmapped memory can't be tracked, read the descriptor every time
+        return descriptor;
+    }
+    const CacheAddr cache_addr{ToCacheAddr(page_pointer)};
+    const auto is_same_page = [cache_addr](const auto& page) { return page.first == cache_addr; };
+    if (std::none_of(descriptor_pages.begin(), descriptor_pages.end(), is_same_page)) {
+        rasterizer.UpdatePagesCachedCount(*cpu_addr, Memory::PAGE_SIZE, 1);
+        descriptor_pages.emplace_back(cache_addr, *cpu_addr);
+    }
+
+    if (index >= table.entries.size()) {
+        table.entries.resize(index + 1);
+        table.is_cached.resize(index + 1);
+    }
+    table.entries[index] = descriptor;
+    table.is_cached[index] = true;
+    return descriptor;
+}
+
+void Maxwell3D::ClearDescriptorCache() const {
+    for (const auto& page : descriptor_pages) {
+        rasterizer.UpdatePagesCachedCount(page.second, Memory::PAGE_SIZE, -1);
+    }
+    descriptor_pages.clear();
+    std::fill(tic_table.is_cached.begin(), tic_table.is_cached.end(), false);
+    std::fill(tsc_table.is_cached.begin(), tsc_table.is_cached.end(), false);
+}
+
+Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
+    const Texture::TICEntry tic_entry{ReadDescriptor(tic_table, regs.tic.TICAddress(), tic_index)};
 
     ASSERT_MSG(tic_entry.header_version == Texture::TICHeaderVersion::BlockLinear ||
                    tic_entry.header_version == Texture::TICHeaderVersion::Pitch,
@@ -448,11 +897,7 @@ Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
 }
 
 Texture::TSCEntry Maxwell3D::GetTSCEntry(u32 tsc_index) const {
-    const GPUVAddr tsc_address_gpu{regs.tsc.TSCAddress() + tsc_index * sizeof(Texture::TSCEntry)};
-
-    Texture::TSCEntry tsc_entry;
-    memory_manager.ReadBlockUnsafe(tsc_address_gpu, &tsc_entry, sizeof(Texture::TSCEntry));
-    return tsc_entry;
+    return ReadDescriptor(tsc_table, regs.tsc.TSCAddress(), tsc_index);
 }
 
 std::vector<Texture::FullTextureInfo> Maxwell3D::GetStageTextures(Regs::ShaderStage stage) const {
@@ -538,7 +983,9 @@ void Maxwell3D::ProcessClearBuffers() {
            regs.clear_buffers.R == regs.clear_buffers.B &&
            regs.clear_buffers.R == regs.clear_buffers.A);
 
-    rasterizer.Clear();
+    if (execute_on) {
+        rasterizer.Clear();
+    }
 }
 
 u32 Maxwell3D::AccessConstBuffer32(Regs::ShaderStage stage, u64 const_buffer, u64 offset) const {
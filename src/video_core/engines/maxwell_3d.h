@@ -8,6 +8,7 @@
 #include <bitset>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/assert.h"
@@ -62,6 +63,8 @@ public:
         static constexpr std::size_t NumVaryings = 31;
         static constexpr std::size_t NumTextureSamplers = 32;
         static constexpr std::size_t NumClipDistances = 8;
+        static constexpr std::size_t NumTransformFeedbackBuffers = 4;
+        static constexpr std::size_t MaxTransformFeedbackVaryings = 128;
         static constexpr std::size_t MaxShaderProgram = 6;
         static constexpr std::size_t MaxShaderStage = 5;
         // Maximum number of const buffers per shader stage.
@@ -88,6 +91,7 @@ public:
 
         enum class QuerySelect : u32 {
             Zero = 0,
+            SamplesPassed = 21,
         };
 
         enum class QuerySyncCondition : u32 {
@@ -95,6 +99,18 @@ public:
             GreaterThan = 1,
         };
 
+        enum class CounterReset : u32 {
+            SampleCnt = 0x01,
+        };
+
+        enum class ConditionMode : u32 {
+            Never = 0,
+            Always = 1,
+            ResNonZero = 2,
+            Equal = 3,
+            NotEqual = 4,
+        };
+
         enum class ShaderProgram : u32 {
             VertexA = 0,
             VertexB = 1,
@@ -544,6 +560,29 @@ public:
             }
         };
 
+        struct TransformFeedbackBinding {
+            u32 buffer_enable;
+            u32 address_high;
+            u32 address_low;
+            s32 buffer_size;
+            s32 buffer_offset;
+            INSERT_PADDING_WORDS(3);
+
+            GPUVAddr Address() const {
+                return static_cast<GPUVAddr>(
+                    (static_cast<GPUVAddr>(address_high) << 32) | address_low);
+            }
+        };
+        static_assert(sizeof(TransformFeedbackBinding) == 32);
+
+        struct TransformFeedbackLayout {
+            u32 stream;
+            u32 varying_count;
+            u32 stride;
+            INSERT_PADDING_WORDS(1);
+        };
+        static_assert(sizeof(TransformFeedbackLayout) == 16);
+
         struct ScissorTest {
             u32 enable;
             union {
@@ -610,7 +649,15 @@ public:
                     };
                 } sync_info;
 
-                INSERT_PADDING_WORDS(0x11E);
+                INSERT_PADDING_WORDS(0x2D);
+
+                std::array<TransformFeedbackBinding, NumTransformFeedbackBuffers> tfb_bindings;
+
+                INSERT_PADDING_WORDS(0xC0);
+
+                std::array<TransformFeedbackLayout, NumTransformFeedbackBuffers> tfb_layouts;
+
+                INSERT_PADDING_WORDS(1);
 
                 u32 tfb_enabled;
 
@@ -800,11 +847,15 @@ public:
                     BitField<7, 1, u32> c7;
                 } clip_distance_enabled;
 
-                INSERT_PADDING_WORDS(0x1);
+                u32 samplecnt_enable;
 
                 float point_size;
 
-                INSERT_PADDING_WORDS(0x7);
+                INSERT_PADDING_WORDS(0x5);
+
+                CounterReset counter_reset;
+
+                INSERT_PADDING_WORDS(0x1);
 
                 u32 zeta_enable;
 
@@ -813,7 +864,18 @@ public:
                     BitField<4, 1, u32> alpha_to_one;
                 } multisample_control;
 
-                INSERT_PADDING_WORDS(0x7);
+                INSERT_PADDING_WORDS(0x4);
+
+                struct {
+                    u32 address_high;
+                    u32 address_low;
+                    ConditionMode mode;
+
+                    GPUVAddr Address() const {
+                        return static_cast<GPUVAddr>(
+                            (static_cast<GPUVAddr>(address_high) << 32) | address_low);
+                    }
+                } condition;
 
                 struct {
                     u32 tsc_address_high;
@@ -1083,7 +1145,15 @@ public:
 
                 u32 tex_cb_index;
 
-                INSERT_PADDING_WORDS(0x395);
+                INSERT_PADDING_WORDS(0x7D);
+
+                /// Output attribute component captured into each word of the vertices written to
+                /// a transform feedback buffer, in units of 4 bytes of the attribute space
+                std::array<std::array<u8, MaxTransformFeedbackVaryings>,
+                           NumTransformFeedbackBuffers>
+                    tfb_varying_locs;
+
+                INSERT_PADDING_WORDS(0x298);
 
                 struct {
                     /// Compressed address of a buffer that holds information about bound SSBOs.
@@ -1112,6 +1182,14 @@ public:
     static_assert(std::is_trivially_copyable_v<Regs>, "Maxwell3D Regs must be trivially copyable");
 
     struct State {
+        /// Vertex or index range of a draw
+        struct DrawRange {
+            u32 first;         ///< First vertex or index
+            u32 count;         ///< Number of vertices or indices
+            u32 base_vertex;   ///< Value added to the indices, zero for non-indexed draws
+            u32 num_instances; ///< Number of instances drawn
+        };
+
         struct ConstBufferInfo {
             GPUVAddr address;
             u32 index;
@@ -1125,13 +1203,40 @@ public:
 
         std::array<ShaderStageInfo, Regs::MaxShaderStage> shader_stages;
         u32 current_instance = 0; ///< Current instance to be used to simulate instanced rendering.
+        u32 base_instance = 0;    ///< First instance of the draw being executed.
+        u32 num_instances = 1;    ///< Number of instances of the draw being executed.
+        /// Draws executed together, in submission order, when several consecutive draws only
+        /// differ in their vertex or index ranges. Empty when a single draw is executed from the
+        /// registers. All of them share the base instance.
+        std::vector<DrawRange> batched_draws;
     };
 
     State state{};
 
     struct DirtyFlags {
+        /// Groups of registers synced together into the rasterizer state. Which registers belong
+        /// to each group is described by a per-register table in maxwell_3d.cpp.
+        enum StateFlag : std::size_t {
+            Viewport,
+            Scissor,
+            ColorMask,
+            FragmentColorClamp,
+            MultiSample,
+            DepthTest,
+            StencilTest,
+            Blend,
+            LogicOp,
+            CullMode,
+            PrimitiveRestart,
+            PointSize,
+            PolygonOffset,
+            NumStateFlags,
+        };
+        using StateFlags = std::bitset<NumStateFlags>;
+
         std::bitset<8> color_buffer{0xFF};
         std::bitset<32> vertex_array{0xFFFFFFFF};
+        StateFlags state{0xFFFF};
 
         bool vertex_attrib_format = true;
         bool zeta_buffer = true;
@@ -1153,6 +1258,13 @@ public:
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Write multiple values to the register identified by method.
+    void CallMultiMethod(u32 method, const u32* base_start, u32 amount, u32 methods_pending);
+
+    /// Executes the draw deferred to batch it with its following instances, if there is one. This
+    /// has to be called before anything outside of the 3D engine can observe the draw results.
+    void FlushPendingDraw();
+
     /// Given a Texture Handle, returns the TSC and TIC entries.
     Texture::FullTextureInfo GetTextureInfo(const Texture::TextureHandle tex_handle,
                                             std::size_t offset) const;
@@ -1165,6 +1277,9 @@ public:
 
     u32 AccessConstBuffer32(Regs::ShaderStage stage, u64 const_buffer, u64 offset) const;
 
+    /// Drops the cached TIC and TSC entries if any of them is stored in the given region
+    void InvalidateDescriptorCache(CacheAddr addr, u64 size);
+
     /// Memory for macro code - it's undetermined how big this is, however 1MB is much larger than
     /// we've seen used.
     using MacroMemory = std::array<u32, 0x40000>;
@@ -1199,6 +1314,49 @@ private:
 
     Upload::State upload_state;
 
+    /// Maximum number of draws batched together
+    static constexpr std::size_t MaxBatchedDraws = 256;
+
+    /// Draw deferred to merge the consecutive instances of it into a single instanced draw, and
+    /// the following draws that only differ in their vertex or index range into a batch.
+    struct PendingDraw {
+        bool is_indexed = false;
+        u32 base_instance = 0;
+        /// Ranges of the draws merged so far, empty when there is no pending draw
+        std::vector<State::DrawRange> draws;
+        /// Whether the vertex or index count was written since the last draw was merged
+        bool count_written = false;
+    };
+
+    PendingDraw pending_draw;
+
+    /// Whether the render condition evaluated on the CPU lets draws and clears execute. When the
+    /// host GPU evaluates the condition this stays true.
+    bool execute_on = true;
+
+    /// Entries of a TIC or TSC table read from guest memory. The guest pages holding them are
+    /// tracked as rasterizer cached memory, so writes to them invalidate the cached entries.
+    template <typename Descriptor>
+    struct DescriptorTable {
+        GPUVAddr address = 0;
+        std::vector<Descriptor> entries;
+        std::vector<bool> is_cached;
+    };
+
+    mutable DescriptorTable<Texture::TICEntry> tic_table;
+    mutable DescriptorTable<Texture::TSCEntry> tsc_table;
+
+    /// Host and CPU addresses of the guest pages holding the cached descriptors
+    mutable std::vector<std::pair<CacheAddr, VAddr>> descriptor_pages;
+
+    /// Returns a descriptor of the table at the given address, reading it only on cache misses
+    template <typename Descriptor>
+    Descriptor ReadDescriptor(DescriptorTable<Descriptor>& table, GPUVAddr table_address,
+                              u32 index) const;
+
+    /// Untracks the pages of the cached descriptors and drops them from both tables
+    void ClearDescriptorCache() const;
+
     /// Retrieves information about a specific TIC entry from the TIC buffer.
     Texture::TICEntry GetTICEntry(u32 tic_index) const;
 
@@ -1210,7 +1368,10 @@ private:
      * @param method Method to call
      * @param parameters Arguments to the method call
      */
-    void CallMacroMethod(u32 method, std::vector<u32> parameters);
+    void CallMacroMethod(u32 method, const std::vector<u32>& parameters);
+
+    /// Calls the macro that is currently being fed parameters with the parameters received.
+    void CallCurrentMacro();
 
     /// Handles writes to the macro uploading register.
     void ProcessMacroUpload(u32 data);
@@ -1224,17 +1385,41 @@ private:
     /// Handles a write to the QUERY_GET register.
     void ProcessQueryGet();
 
+    /// Handles a write to the COUNTER_RESET register.
+    void ProcessCounterReset();
+
+    /// Handles a write to the render condition mode register.
+    void ProcessQueryCondition();
+
     /// Handles writes to syncing register.
     void ProcessSyncPoint();
 
     /// Handles a write to the CB_DATA[i] register.
     void ProcessCBData(u32 value);
 
+    /// Handles writes of multiple values to the CB_DATA[i] registers.
+    void ProcessCBMultiData(const u32* start_base, u32 amount);
+
     /// Handles a write to the CB_BIND register.
     void ProcessCBBind(Regs::ShaderStage stage);
 
     /// Handles a write to the VERTEX_END_GL register, triggering a draw.
     void DrawArrays();
+
+    /// Executes a draw with the current register state and the instances in state.
+    void ExecuteDraw(bool is_indexed);
+
+    /// Returns true if writing the value to the register leaves the pending draw unaffected.
+    bool IsDrawBatchableWrite(u32 method, u32 argument) const;
+
+    /// Returns true if a draw of the given kind can be merged into the pending draw.
+    bool CanMergeDraw(bool is_indexed) const;
+
+    /// Returns the vertex or index range of a single instance draw from the registers.
+    State::DrawRange GetDrawRange(bool is_indexed) const;
+
+    /// Writes the vertex or index range of a single instance draw to the registers.
+    void SetDrawRange(bool is_indexed, const State::DrawRange& range);
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
@@ -1246,6 +1431,8 @@ ASSERT_REG_POSITION(upload, 0x60);
 ASSERT_REG_POSITION(exec_upload, 0x6C);
 ASSERT_REG_POSITION(data_upload, 0x6D);
 ASSERT_REG_POSITION(sync_info, 0xB2);
+ASSERT_REG_POSITION(tfb_bindings, 0xE0);
+ASSERT_REG_POSITION(tfb_layouts, 0x1C0);
 ASSERT_REG_POSITION(tfb_enabled, 0x1D1);
 ASSERT_REG_POSITION(rt, 0x200);
 ASSERT_REG_POSITION(viewport_transform, 0x280);
@@ -1292,9 +1479,12 @@ ASSERT_REG_POSITION(frag_color_clamp, 0x4EA);
 ASSERT_REG_POSITION(screen_y_control, 0x4EB);
 ASSERT_REG_POSITION(vb_element_base, 0x50D);
 ASSERT_REG_POSITION(clip_distance_enabled, 0x544);
+ASSERT_REG_POSITION(samplecnt_enable, 0x545);
 ASSERT_REG_POSITION(point_size, 0x546);
+ASSERT_REG_POSITION(counter_reset, 0x54C);
 ASSERT_REG_POSITION(zeta_enable, 0x54E);
 ASSERT_REG_POSITION(multisample_control, 0x54F);
+ASSERT_REG_POSITION(condition, 0x554);
 ASSERT_REG_POSITION(tsc, 0x557);
 ASSERT_REG_POSITION(polygon_offset_factor, 0x55b);
 ASSERT_REG_POSITION(tic, 0x55D);
@@ -1327,6 +1517,7 @@ ASSERT_REG_POSITION(shader_config[0], 0x800);
 ASSERT_REG_POSITION(const_buffer, 0x8E0);
 ASSERT_REG_POSITION(cb_bind[0], 0x904);
 ASSERT_REG_POSITION(tex_cb_index, 0x982);
+ASSERT_REG_POSITION(tfb_varying_locs, 0xA00);
 ASSERT_REG_POSITION(ssbo_info, 0xD18);
 ASSERT_REG_POSITION(tex_info_buffers.address[0], 0xD2A);
 ASSERT_REG_POSITION(tex_info_buffers.size[0], 0xD2F);
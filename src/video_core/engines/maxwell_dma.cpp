@@ -37,6 +37,13 @@ void MaxwellDMA::CallMethod(const GPU::MethodCall& method_call) {
 #undef MAXWELLDMA_REG_INDEX
 }
 
+void MaxwellDMA::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
+                                 u32 methods_pending) {
+    for (u32 i = 0; i < amount; ++i) {
+        CallMethod({method, base_start[i], 0, methods_pending - i});
+    }
+}
+
 void MaxwellDMA::HandleCopy() {
     LOG_WARNING(HW_GPU, "Requested a DMA copy");
 
@@ -60,6 +67,10 @@ void MaxwellDMA::HandleCopy() {
     // All copies here update the main memory, so mark all rasterizer states as invalid.
     system.GPU().Maxwell3D().dirty_flags.OnMemoryWrite();
 
+    if (rasterizer.AccelerateDMACopy(regs)) {
+        return;
+    }
+
     if (regs.exec.is_dst_linear && regs.exec.is_src_linear) {
         // When the enable_2d bit is disabled, the copy is performed as if we were copying a 1D
         // buffer of length `x_count`, otherwise we copy a 2D image of dimensions (x_count,
@@ -1385,6 +1385,8 @@ public:
         SYNC,
         BRK,
         DEPBAR,
+        BAR,
+        MEMBAR,
         BFE_C,
         BFE_R,
         BFE_IMM,
@@ -1664,6 +1666,8 @@ private:
             INST("1111000011111---", Id::SYNC, Type::Flow, "SYNC"),
             INST("111000110100---", Id::BRK, Type::Flow, "BRK"),
             INST("1111000011110---", Id::DEPBAR, Type::Synch, "DEPBAR"),
+            INST("1111000010101---", Id::BAR, Type::Synch, "BAR"),
+            INST("1110111110011---", Id::MEMBAR, Type::Synch, "MEMBAR"),
             INST("1110111111011---", Id::LD_A, Type::Memory, "LD_A"),
             INST("1110111101001---", Id::LD_S, Type::Memory, "LD_S"),
             INST("1110111101000---", Id::LD_L, Type::Memory, "LD_L"),
@@ -2,10 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <ctime>
+#include <fmt/format.h>
 #include "common/assert.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/memory.h"
+#include "core/settings.h"
+#include "core/tracer/recorder.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/kepler_memory.h"
@@ -37,11 +43,155 @@ GPU::GPU(Core::System& system, VideoCore::RendererBase& renderer) : renderer{ren
     fermi_2d = std::make_unique<Engines::Fermi2D>(rasterizer, *memory_manager);
     kepler_compute = std::make_unique<Engines::KeplerCompute>(system, rasterizer, *memory_manager);
     maxwell_dma = std::make_unique<Engines::MaxwellDMA>(system, rasterizer, *memory_manager);
-    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, *memory_manager);
+    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, rasterizer, *memory_manager);
+
+    if (Settings::values.gpu_trace_frames > 0) {
+        StartTraceRecorder(Settings::values.gpu_trace_frames);
+    }
 }
 
 GPU::~GPU() = default;
 
+Tegra::CommandList GPU::AcquireCommandList(std::size_t num_entries) {
+    Tegra::CommandList entries;
+    {
+        std::lock_guard lock{command_list_pool_mutex};
+        if (!command_list_pool.empty()) {
+            entries = std::move(command_list_pool.back());
+            command_list_pool.pop_back();
+        }
+    }
+    entries.resize(num_entries);
+    return entries;
+}
+
+void GPU::RecycleCommandList(Tegra::CommandList&& entries) {
+    // Submissions are consumed about as fast as they are made, a few lists cover the ones in flight
+    constexpr std::size_t MaxPooledCommandLists = 64;
+    std::lock_guard lock{command_list_pool_mutex};
+    if (command_list_pool.size() < MaxPooledCommandLists) {
+        command_list_pool.push_back(std::move(entries));
+    }
+}
+
+void GPU::TraceCommandList(const Tegra::CommandList& entries) {
+    if (trace_recorder) {
+        trace_recorder->PushCommandList(entries);
+    }
+}
+
+void GPU::TraceFrameFinished(
+    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) {
+    if (!trace_recorder) {
+        return;
+    }
+    if (!trace_recorder->FrameFinished(framebuffer ? &framebuffer->get() : nullptr)) {
+        return;
+    }
+
+    trace_recorder->Finish();
+    memory_manager->SetTraceRecorder(nullptr);
+    trace_recorder.reset();
+}
+
+void GPU::StartTraceRecorder(u32 num_frames) {
+    const std::string path{FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) + "gpu_traces" +
+                           DIR_SEP};
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+    auto recorder = std::make_unique<Tracer::Recorder>(
+        *memory_manager, num_frames, fmt::format("{}trace_{}.ygt", path, std::time(nullptr)));
+    if (!recorder->IsOpen()) {
+        return;
+    }
+    trace_recorder = std::move(recorder);
+    memory_manager->SetTraceRecorder(trace_recorder.get());
+}
+
+void GPU::DeferInvalidateRegion(CacheAddr addr, u64 size) {
+    if (size == 0) {
+        return;
+    }
+
+    // Track whole pages, this bounds the amount of regions when many small writes are scattered
+    constexpr CacheAddr page_mask = Memory::PAGE_SIZE - 1;
+    const CacheAddr begin = addr & ~page_mask;
+    const CacheAddr end = (addr + size + page_mask) & ~page_mask;
+
+    // Publishing the region releases the write done before this call to the draining thread
+    if (deferred_invalidations.TryPush(DeferredInvalidation{begin, end})) {
+        return;
+    }
+    // The GPU hasn't drained the queue for a while, fall back to a locked set
+    using Interval = boost::icl::interval_set<CacheAddr>::interval_type;
+    std::lock_guard lock{overflow_invalidations_mutex};
+    overflow_invalidations.add(Interval::right_open(begin, end));
+    has_overflow_invalidations.store(true, std::memory_order_release);
+}
+
+void GPU::InvalidateDeferredRegions() {
+    using Interval = boost::icl::interval_set<CacheAddr>::interval_type;
+
+    boost::icl::interval_set<CacheAddr> regions;
+    std::array<DeferredInvalidation, 256> batch;
+    std::size_t count;
+    while ((count = deferred_invalidations.PopBatch(batch.data(), batch.size())) != 0) {
+        for (std::size_t i = 0; i < count; ++i) {
+            regions.add(Interval::right_open(batch[i].begin, batch[i].end));
+        }
+    }
+    if (has_overflow_invalidations.load(std::memory_order_acquire)) {
+        std::lock_guard lock{overflow_invalidations_mutex};
+        regions += overflow_invalidations;
+        overflow_invalidations.clear();
+        has_overflow_invalidations.store(false, std::memory_order_relaxed);
+    }
+
+    // The interval set has merged adjacent and overlapping writes
+    auto& rasterizer{renderer.Rasterizer()};
+    for (const auto& interval : regions) {
+        rasterizer.InvalidateRegion(interval.lower(), interval.upper() - interval.lower());
+    }
+}
+
+u32 GPU::GetSyncPointValue(u32 syncpoint_id) const {
+    return syncpoints[syncpoint_id].load(std::memory_order_acquire);
+}
+
+bool GPU::IsSyncPointReached(u32 syncpoint_id, u32 value) const {
+    return static_cast<s32>(GetSyncPointValue(syncpoint_id) - value) >= 0;
+}
+
+void GPU::IncrementSyncPoint(u32 syncpoint_id) {
+    std::list<SyncPointInterrupt> ready;
+    {
+        std::lock_guard lock{syncpoint_mutex};
+        const u32 value = syncpoints[syncpoint_id].fetch_add(1, std::memory_order_acq_rel) + 1;
+        auto& interrupts = syncpoint_interrupts[syncpoint_id];
+        for (auto it = interrupts.begin(); it != interrupts.end();) {
+            const auto next = std::next(it);
+            if (static_cast<s32>(value - it->value) >= 0) {
+                ready.splice(ready.end(), interrupts, it);
+            }
+            it = next;
+        }
+    }
+    // The callbacks run unlocked, so they can register new interrupts
+    for (auto& interrupt : ready) {
+        interrupt.callback();
+    }
+}
+
+bool GPU::RegisterSyncPointInterrupt(u32 syncpoint_id, u32 value, std::function<void()> callback) {
+    std::lock_guard lock{syncpoint_mutex};
+    if (IsSyncPointReached(syncpoint_id, value)) {
+        return false;
+    }
+    syncpoint_interrupts[syncpoint_id].push_back({value, std::move(callback)});
+    return true;
+}
+
 Engines::Maxwell3D& GPU::Maxwell3D() {
     return *maxwell_3d;
 }
@@ -50,6 +200,14 @@ const Engines::Maxwell3D& GPU::Maxwell3D() const {
     return *maxwell_3d;
 }
 
+Engines::KeplerCompute& GPU::KeplerCompute() {
+    return *kepler_compute;
+}
+
+const Engines::KeplerCompute& GPU::KeplerCompute() const {
+    return *kepler_compute;
+}
+
 MemoryManager& GPU::MemoryManager() {
     return *memory_manager;
 }
@@ -147,8 +305,8 @@ enum class BufferMethods {
     RefCnt = 0x14,
     SemaphoreAcquire = 0x1A,
     SemaphoreRelease = 0x1B,
-    Unk70 = 0x1C,
-    Unk74 = 0x1D,
+    SyncpointPayload = 0x1C,
+    SyncpointOperation = 0x1D,
     Unk78 = 0x1E,
     Unk7c = 0x1F,
     Yield = 0x20,
@@ -168,16 +326,41 @@ void GPU::CallMethod(const MethodCall& method_call) {
 
     ASSERT(method_call.subchannel < bound_engines.size());
 
-    if (ExecuteMethodOnEngine(method_call)) {
+    FlushPendingDraws(method_call.method, method_call.subchannel);
+
+    if (ExecuteMethodOnEngine(method_call.method)) {
         CallEngineMethod(method_call);
     } else {
         CallPullerMethod(method_call);
     }
 }
 
-bool GPU::ExecuteMethodOnEngine(const MethodCall& method_call) {
-    const auto method = static_cast<BufferMethods>(method_call.method);
-    return method >= BufferMethods::NonPullerMethods;
+void GPU::CallMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                          u32 methods_pending) {
+    LOG_TRACE(HW_GPU, "Processing method {:08X} {} times on subchannel {}", method, amount,
+              subchannel);
+
+    ASSERT(subchannel < bound_engines.size());
+
+    FlushPendingDraws(method, subchannel);
+
+    if (ExecuteMethodOnEngine(method)) {
+        CallEngineMultiMethod(method, subchannel, base_start, amount, methods_pending);
+    } else {
+        for (u32 i = 0; i < amount; ++i) {
+            CallPullerMethod({method, base_start[i], subchannel, methods_pending - i});
+        }
+    }
+}
+
+void GPU::FlushPendingDraws(u32 method, u32 subchannel) {
+    if (!ExecuteMethodOnEngine(method) || bound_engines[subchannel] != EngineID::MAXWELL_B) {
+        maxwell_3d->FlushPendingDraw();
+    }
+}
+
+bool GPU::ExecuteMethodOnEngine(u32 method) {
+    return static_cast<BufferMethods>(method) >= BufferMethods::NonPullerMethods;
 }
 
 void GPU::CallPullerMethod(const MethodCall& method_call) {
@@ -194,6 +377,7 @@ void GPU::CallPullerMethod(const MethodCall& method_call) {
     case BufferMethods::SemaphoreAddressLow:
     case BufferMethods::SemaphoreSequence:
     case BufferMethods::RefCnt:
+    case BufferMethods::SyncpointPayload:
         break;
     case BufferMethods::SemaphoreTrigger: {
         ProcessSemaphoreTriggerMethod();
@@ -227,6 +411,10 @@ void GPU::CallPullerMethod(const MethodCall& method_call) {
         ProcessSemaphoreRelease();
         break;
     }
+    case BufferMethods::SyncpointOperation: {
+        ProcessSyncPointMethod();
+        break;
+    }
     case BufferMethods::Yield: {
         // TODO(Kmather73): Research and implement this method.
         LOG_ERROR(HW_GPU, "Special puller engine method Yield not implemented");
@@ -263,6 +451,31 @@ void GPU::CallEngineMethod(const MethodCall& method_call) {
     }
 }
 
+void GPU::CallEngineMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                                u32 methods_pending) {
+    const EngineID engine = bound_engines[subchannel];
+
+    switch (engine) {
+    case EngineID::FERMI_TWOD_A:
+        fermi_2d->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::MAXWELL_B:
+        maxwell_3d->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::KEPLER_COMPUTE_B:
+        kepler_compute->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::MAXWELL_DMA_COPY_A:
+        maxwell_dma->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    case EngineID::KEPLER_INLINE_TO_MEMORY_B:
+        kepler_memory->CallMultiMethod(method, base_start, amount, methods_pending);
+        break;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented engine");
+    }
+}
+
 void GPU::ProcessBindMethod(const MethodCall& method_call) {
     // Bind the current subchannel to the desired engine id.
     LOG_DEBUG(HW_GPU, "Binding subchannel {} to engine {}", method_call.subchannel,
@@ -331,4 +544,21 @@ void GPU::ProcessSemaphoreAcquire() {
     }
 }
 
+void GPU::ProcessSyncPointMethod() {
+    const u32 syncpoint_id = regs.syncpoint.index;
+    if (syncpoint_id >= MaxSyncPoints) {
+        LOG_ERROR(HW_GPU, "Invalid syncpoint {}", syncpoint_id);
+        return;
+    }
+    if (regs.syncpoint.increment) {
+        IncrementSyncPoint(syncpoint_id);
+        return;
+    }
+    // Commands execute in submission order, a wait can only be for another engine or the CPU
+    if (!IsSyncPointReached(syncpoint_id, regs.syncpoint_payload)) {
+        LOG_WARNING(HW_GPU, "Syncpoint {} wait for {} not satisfied, value is {}", syncpoint_id,
+                    regs.syncpoint_payload, GetSyncPointValue(syncpoint_id));
+    }
+}
+
 } // namespace Tegra
@@ -5,8 +5,17 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <boost/icl/interval_set.hpp>
+#include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/threadsafe_queue.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
 #include "video_core/dma_pusher.h"
 
@@ -19,6 +28,10 @@ namespace Core {
 class System;
 }
 
+namespace Tracer {
+class Recorder;
+}
+
 namespace VideoCore {
 class RendererBase;
 } // namespace VideoCore
@@ -107,6 +120,12 @@ struct FramebufferConfig {
     Common::Rectangle<int> crop_rect;
 };
 
+/**
+ * Layers of a display composed on top of its primary framebuffer, from the bottom to the top.
+ * Layers without a new buffer keep showing the last one they presented.
+ */
+using FramebufferOverlays = std::vector<std::optional<FramebufferConfig>>;
+
 namespace Engines {
 class Fermi2D;
 class Maxwell3D;
@@ -149,12 +168,23 @@ public:
     /// Calls a GPU method.
     void CallMethod(const MethodCall& method_call);
 
+    /// Calls a GPU method multiple times, with the given arguments.
+    /// @param methods_pending Number of calls left in the command, including these ones.
+    void CallMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                         u32 methods_pending);
+
     /// Returns a reference to the Maxwell3D GPU engine.
     Engines::Maxwell3D& Maxwell3D();
 
     /// Returns a const reference to the Maxwell3D GPU engine.
     const Engines::Maxwell3D& Maxwell3D() const;
 
+    /// Returns a reference to the KeplerCompute GPU engine.
+    Engines::KeplerCompute& KeplerCompute();
+
+    /// Returns a const reference to the KeplerCompute GPU engine.
+    const Engines::KeplerCompute& KeplerCompute() const;
+
     /// Returns a reference to the GPU memory manager.
     Tegra::MemoryManager& MemoryManager();
 
@@ -194,7 +224,14 @@ public:
 
                 u32 semaphore_acquire;
                 u32 semaphore_release;
-                INSERT_PADDING_WORDS(0xE4);
+
+                u32 syncpoint_payload;
+                union {
+                    u32 raw;
+                    BitField<0, 1, u32> increment; ///< Waits for the payload when clear
+                    BitField<8, 8, u32> index;
+                } syncpoint;
+                INSERT_PADDING_WORDS(0xE2);
 
                 // Puller state
                 u32 acquire_mode;
@@ -215,9 +252,29 @@ public:
     /// Push GPU command entries to be processed
     virtual void PushGPUEntries(Tegra::CommandList&& entries) = 0;
 
-    /// Swap buffers (render frame)
+    /**
+     * Returns a command list of the given size for a submission. Its storage is recycled from the
+     * lists the GPU already processed, its contents are unspecified. Thread-safe.
+     */
+    Tegra::CommandList AcquireCommandList(std::size_t num_entries);
+
+    /// Gives back a processed command list, so later submissions reuse its storage. Thread-safe.
+    void RecycleCommandList(Tegra::CommandList&& entries);
+
+    /**
+     * Swap buffers (render frame)
+     * @param framebuffer Primary framebuffer to present, or none to present the previous frame
+     * @param overlays Layers composed on top of the primary framebuffer
+     * @param release_callback Called from an unspecified thread once the host GPU no longer
+     *                         reads the guest memory of the presented buffers
+     */
     virtual void SwapBuffers(
-        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) = 0;
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+        Tegra::FramebufferOverlays overlays = {},
+        std::function<void()> release_callback = {}) = 0;
+
+    /// Increments a syncpoint once the commands pushed before it have been executed
+    virtual void QueueSyncPointIncrement(u32 syncpoint_id) = 0;
 
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
     virtual void FlushRegion(CacheAddr addr, u64 size) = 0;
@@ -228,11 +285,46 @@ public:
     /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
     virtual void FlushAndInvalidateRegion(CacheAddr addr, u64 size) = 0;
 
+    /**
+     * Records a CPU write to a rasterizer cached region. Instead of invalidating the caches on
+     * every write, the written pages are queued without taking a lock, and merged and invalidated
+     * in batches the next time the GPU consumes them through InvalidateDeferredRegions. It has to
+     * be called after the write has been done, so the GPU never reloads a region it has drained
+     * before the new data is in memory.
+     */
+    void DeferInvalidateRegion(CacheAddr addr, u64 size);
+
+    /// Invalidates the rasterizer caches of every region written since the last call. This must be
+    /// called from the thread that owns the rasterizer.
+    void InvalidateDeferredRegions();
+
+    /// Number of hardware syncpoints
+    static constexpr u32 MaxSyncPoints = 192;
+
+    /// Returns the current value of a syncpoint. Thread-safe.
+    u32 GetSyncPointValue(u32 syncpoint_id) const;
+
+    /// Returns true when a syncpoint has reached the given value, wrapping around like the hardware
+    /// counters do. Thread-safe.
+    bool IsSyncPointReached(u32 syncpoint_id, u32 value) const;
+
+    /// Increments a syncpoint and runs the interrupts waiting for the value it reaches. Called by
+    /// the thread executing the GPU commands.
+    void IncrementSyncPoint(u32 syncpoint_id);
+
+    /**
+     * Registers a callback to run once a syncpoint reaches a value. The callback runs on the thread
+     * executing the GPU commands and must not block. Thread-safe.
+     * @returns false without registering the callback when the value has already been reached
+     */
+    bool RegisterSyncPointInterrupt(u32 syncpoint_id, u32 value, std::function<void()> callback);
+
 private:
     void ProcessBindMethod(const MethodCall& method_call);
     void ProcessSemaphoreTriggerMethod();
     void ProcessSemaphoreRelease();
     void ProcessSemaphoreAcquire();
+    void ProcessSyncPointMethod();
 
     /// Calls a GPU puller method.
     void CallPullerMethod(const MethodCall& method_call);
@@ -240,16 +332,37 @@ private:
     /// Calls a GPU engine method.
     void CallEngineMethod(const MethodCall& method_call);
 
+    /// Calls a GPU engine method multiple times.
+    void CallEngineMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
+                               u32 methods_pending);
+
     /// Determines where the method should be executed.
-    bool ExecuteMethodOnEngine(const MethodCall& method_call);
+    bool ExecuteMethodOnEngine(u32 method);
+
+    /// Executes the draws deferred by the 3D engine when the method is not processed by it, as
+    /// the method may observe their results.
+    void FlushPendingDraws(u32 method, u32 subchannel);
 
 protected:
+    /// Records a command list submission if a GPU trace is being recorded.
+    void TraceCommandList(const Tegra::CommandList& entries);
+
+    /// Marks the end of a frame in the GPU trace being recorded, saving it once it is complete.
+    void TraceFrameFinished(
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer);
+
     std::unique_ptr<Tegra::DmaPusher> dma_pusher;
     VideoCore::RendererBase& renderer;
 
 private:
+    /// Starts recording a GPU trace of the given number of frames to the dump directory.
+    void StartTraceRecorder(u32 num_frames);
+
     std::unique_ptr<Tegra::MemoryManager> memory_manager;
 
+    /// Recorder of the GPU trace, only present while recording one
+    std::unique_ptr<Tracer::Recorder> trace_recorder;
+
     /// Mapping of command subchannels to their bound engine ids
     std::array<EngineID, 8> bound_engines = {};
     /// 3D engine
@@ -262,6 +375,36 @@ private:
     std::unique_ptr<Engines::MaxwellDMA> maxwell_dma;
     /// Inline memory engine
     std::unique_ptr<Engines::KeplerMemory> kepler_memory;
+
+    /// Page-aligned region written by the CPU
+    struct DeferredInvalidation {
+        CacheAddr begin;
+        CacheAddr end;
+    };
+    // A full queue falls back to the locked overflow set, so this only has to hold the writes of a
+    // typical frame between two drains. 4096 entries take 64 KiB.
+    static constexpr std::size_t DeferredInvalidationsCapacity = 4096;
+
+    /// Regions written by the CPU and pending invalidation, any thread may push to it
+    Common::BoundedMPSCQueue<DeferredInvalidation, DeferredInvalidationsCapacity>
+        deferred_invalidations;
+    /// Regions that didn't fit in the queue, only touched under its mutex
+    boost::icl::interval_set<CacheAddr> overflow_invalidations;
+    std::atomic_bool has_overflow_invalidations{};
+    std::mutex overflow_invalidations_mutex;
+
+    /// Processed command lists kept for the next submissions
+    std::vector<Tegra::CommandList> command_list_pool;
+    std::mutex command_list_pool_mutex;
+
+    struct SyncPointInterrupt {
+        u32 value;
+        std::function<void()> callback;
+    };
+    std::array<std::atomic<u32>, MaxSyncPoints> syncpoints{};
+    /// Callbacks waiting for each syncpoint, guarded by the syncpoint mutex
+    std::array<std::list<SyncPointInterrupt>, MaxSyncPoints> syncpoint_interrupts;
+    std::mutex syncpoint_mutex;
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
@@ -274,6 +417,8 @@ ASSERT_REG_POSITION(semaphore_trigger, 0x7);
 ASSERT_REG_POSITION(reference_count, 0x14);
 ASSERT_REG_POSITION(semaphore_acquire, 0x1A);
 ASSERT_REG_POSITION(semaphore_release, 0x1B);
+ASSERT_REG_POSITION(syncpoint_payload, 0x1C);
+ASSERT_REG_POSITION(syncpoint, 0x1D);
 
 ASSERT_REG_POSITION(acquire_mode, 0x100);
 ASSERT_REG_POSITION(acquire_source, 0x101);
@@ -14,16 +14,24 @@ GPUAsynch::GPUAsynch(Core::System& system, VideoCore::RendererBase& renderer)
 GPUAsynch::~GPUAsynch() = default;
 
 void GPUAsynch::Start() {
-    gpu_thread.StartThread(renderer, *dma_pusher);
+    gpu_thread.StartThread(*this, renderer, *dma_pusher);
 }
 
 void GPUAsynch::PushGPUEntries(Tegra::CommandList&& entries) {
+    TraceCommandList(entries);
     gpu_thread.SubmitList(std::move(entries));
 }
 
 void GPUAsynch::SwapBuffers(
-    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) {
-    gpu_thread.SwapBuffers(std::move(framebuffer));
+    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+    Tegra::FramebufferOverlays overlays, std::function<void()> release_callback) {
+    TraceFrameFinished(framebuffer);
+    gpu_thread.SwapBuffers(std::move(framebuffer), std::move(overlays),
+                           std::move(release_callback));
+}
+
+void GPUAsynch::QueueSyncPointIncrement(u32 syncpoint_id) {
+    gpu_thread.IncrementSyncPoint(syncpoint_id);
 }
 
 void GPUAsynch::FlushRegion(CacheAddr addr, u64 size) {
@@ -31,11 +39,13 @@ void GPUAsynch::FlushRegion(CacheAddr addr, u64 size) {
 }
 
 void GPUAsynch::InvalidateRegion(CacheAddr addr, u64 size) {
-    gpu_thread.InvalidateRegion(addr, size);
+    // Accumulated and merged until the GPU thread processes its next command
+    DeferInvalidateRegion(addr, size);
 }
 
 void GPUAsynch::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
-    gpu_thread.FlushAndInvalidateRegion(addr, size);
+    // Skip flush on asynch mode, as FlushAndInvalidateRegion is not used for anything too important
+    DeferInvalidateRegion(addr, size);
 }
 
 } // namespace VideoCommon
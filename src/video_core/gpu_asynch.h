@@ -22,7 +22,9 @@ public:
     void Start() override;
     void PushGPUEntries(Tegra::CommandList&& entries) override;
     void SwapBuffers(
-        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) override;
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+        Tegra::FramebufferOverlays overlays, std::function<void()> release_callback) override;
+    void QueueSyncPointIncrement(u32 syncpoint_id) override;
     void FlushRegion(CacheAddr addr, u64 size) override;
     void InvalidateRegion(CacheAddr addr, u64 size) override;
     void FlushAndInvalidateRegion(CacheAddr addr, u64 size) override;
@@ -0,0 +1,86 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/gpu_profiler.h"
+
+namespace VideoCore {
+
+MICROPROFILE_DEFINE_GPU(GPU_RenderPass, "Render Pass", MP_RGB(128, 192, 255));
+
+GpuProfiler::GpuProfiler(u64 ticks_per_second) : ticks_per_second{ticks_per_second} {
+    Common::SetMicroProfileGpuTimer(this);
+}
+
+GpuProfiler::~GpuProfiler() {
+    Common::SetMicroProfileGpuTimer(nullptr);
+}
+
+u32 GpuProfiler::InsertTimestamp() {
+    const u32 key = next_key.fetch_add(1, std::memory_order_relaxed) % NumKeys;
+    timestamps[key].store(EstimateGpuTicks(MP_TICK()), std::memory_order_relaxed);
+    if (std::this_thread::get_id() == render_thread.load(std::memory_order_relaxed)) {
+        WriteTimestamp(key);
+    }
+    return key;
+}
+
+u64 GpuProfiler::GetTimestamp(u32 key) {
+    return timestamps[key % NumKeys].load(std::memory_order_relaxed);
+}
+
+u64 GpuProfiler::GetTicksPerSecond() const {
+    return ticks_per_second;
+}
+
+bool GpuProfiler::GetTickReference(s64* cpu_ticks, s64* gpu_ticks) {
+    std::lock_guard lock{reference_mutex};
+    *cpu_ticks = reference_cpu_ticks;
+    *gpu_ticks = reference_gpu_ticks;
+    return has_reference;
+}
+
+void GpuProfiler::TickFrame() {
+    EndRenderPass();
+    render_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    ReadTimestamps();
+
+    const s64 gpu_ticks = GetGpuTime();
+    if (gpu_ticks == 0) {
+        return;
+    }
+    std::lock_guard lock{reference_mutex};
+    has_reference = true;
+    reference_cpu_ticks = MP_TICK();
+    reference_gpu_ticks = gpu_ticks;
+}
+
+void GpuProfiler::BeginRenderPass(u64 framebuffer) {
+    if (render_pass_scope && render_pass_framebuffer == framebuffer) {
+        return;
+    }
+    EndRenderPass();
+    render_pass_framebuffer = framebuffer;
+    render_pass_scope.emplace(g_mp_GPU_RenderPass);
+}
+
+void GpuProfiler::EndRenderPass() {
+    render_pass_scope.reset();
+}
+
+void GpuProfiler::SetTimestamp(u32 key, u64 gpu_ticks) {
+    timestamps[key].store(gpu_ticks, std::memory_order_relaxed);
+}
+
+u64 GpuProfiler::EstimateGpuTicks(s64 cpu_ticks) {
+    std::lock_guard lock{reference_mutex};
+    if (!has_reference) {
+        return 0;
+    }
+    const double elapsed_seconds = static_cast<double>(cpu_ticks - reference_cpu_ticks) /
+                                   static_cast<double>(MicroProfileTicksPerSecondCpu());
+    return static_cast<u64>(reference_gpu_ticks +
+                            static_cast<s64>(elapsed_seconds * ticks_per_second));
+}
+
+} // namespace VideoCore
@@ -0,0 +1,89 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "common/common_types.h"
+#include "common/microprofile.h"
+
+namespace VideoCore {
+
+/**
+ * Feeds host GPU timestamps to the MicroProfile GPU timeline. Timestamps inserted from the
+ * rendering thread are written by the backend into its command stream and read back a few frames
+ * later. Until then, and for timestamps inserted from other threads, the GPU time is estimated
+ * from the CPU clock.
+ */
+class GpuProfiler : public Common::MicroProfileGpuTimer {
+public:
+    explicit GpuProfiler(u64 ticks_per_second);
+    ~GpuProfiler() override;
+
+    u32 InsertTimestamp() override;
+
+    u64 GetTimestamp(u32 key) override;
+
+    u64 GetTicksPerSecond() const override;
+
+    bool GetTickReference(s64* cpu_ticks, s64* gpu_ticks) override;
+
+    /**
+     * Reads back the timestamps that are available and synchronizes the GPU clock with the CPU
+     * clock. Has to be called once per frame from the rendering thread, which becomes the only
+     * thread whose timestamps are written to the command stream.
+     */
+    void TickFrame();
+
+    /**
+     * Profiles the commands rendering to a framebuffer as a render pass, ending the previous pass
+     * if the framebuffer changed. Has to be called from the rendering thread.
+     * @param framebuffer Backend identifier of the framebuffer
+     */
+    void BeginRenderPass(u64 framebuffer);
+
+    /// Ends the current render pass, if any
+    void EndRenderPass();
+
+protected:
+    /// Number of keys handed out before they are reused
+    static constexpr u32 NumKeys = 1U << 16;
+
+    /// Writes a timestamp of the given key into the command stream
+    virtual void WriteTimestamp(u32 key) = 0;
+
+    /// Reads the timestamps that are available, calling SetTimestamp for each of them
+    virtual void ReadTimestamps() = 0;
+
+    /// Returns the current GPU time in ticks, or zero if it can't be read
+    virtual s64 GetGpuTime() = 0;
+
+    /// Stores the GPU ticks of a written timestamp
+    void SetTimestamp(u32 key, u64 gpu_ticks);
+
+private:
+    /// Converts a CPU tick to the GPU clock through the last tick reference
+    u64 EstimateGpuTicks(s64 cpu_ticks);
+
+    const u64 ticks_per_second;
+
+    std::optional<MicroProfileScopeGpuHandler> render_pass_scope;
+    u64 render_pass_framebuffer = 0;
+
+    std::atomic<std::thread::id> render_thread{};
+    std::atomic<u32> next_key{};
+    std::array<std::atomic<u64>, NumKeys> timestamps{};
+
+    std::mutex reference_mutex;
+    bool has_reference = false;
+    s64 reference_cpu_ticks = 0;
+    s64 reference_gpu_ticks = 0;
+};
+
+} // namespace VideoCore
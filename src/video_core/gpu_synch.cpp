@@ -15,24 +15,36 @@ GPUSynch::~GPUSynch() = default;
 void GPUSynch::Start() {}
 
 void GPUSynch::PushGPUEntries(Tegra::CommandList&& entries) {
+    TraceCommandList(entries);
+    InvalidateDeferredRegions();
     dma_pusher->Push(std::move(entries));
     dma_pusher->DispatchCalls();
 }
 
 void GPUSynch::SwapBuffers(
-    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) {
-    renderer.SwapBuffers(std::move(framebuffer));
+    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+    Tegra::FramebufferOverlays overlays, std::function<void()> release_callback) {
+    TraceFrameFinished(framebuffer);
+    InvalidateDeferredRegions();
+    renderer.SwapBuffers(std::move(framebuffer), overlays, release_callback);
+}
+
+void GPUSynch::QueueSyncPointIncrement(u32 syncpoint_id) {
+    IncrementSyncPoint(syncpoint_id);
 }
 
 void GPUSynch::FlushRegion(CacheAddr addr, u64 size) {
+    InvalidateDeferredRegions();
     renderer.Rasterizer().FlushRegion(addr, size);
 }
 
 void GPUSynch::InvalidateRegion(CacheAddr addr, u64 size) {
+    InvalidateDeferredRegions();
     renderer.Rasterizer().InvalidateRegion(addr, size);
 }
 
 void GPUSynch::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
+    InvalidateDeferredRegions();
     renderer.Rasterizer().FlushAndInvalidateRegion(addr, size);
 }
 
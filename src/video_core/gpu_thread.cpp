@@ -2,12 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include "common/assert.h"
-#include "common/microprofile.h"
+#include "common/scope_exit.h"
+#include "common/thread.h"
+#include "common/trace.h"
 #include "core/core.h"
-#include "core/core_timing.h"
-#include "core/core_timing_util.h"
-#include "core/frontend/scope_acquire_window_context.h"
+#include "core/frontend/emu_window.h"
+#include "core/perf_stats.h"
 #include "video_core/dma_pusher.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_thread.h"
@@ -16,42 +18,60 @@
 namespace VideoCommon::GPUThread {
 
 /// Runs the GPU thread
-static void RunThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher,
+static void RunThread(Tegra::GPU& gpu, VideoCore::RendererBase& renderer,
+                      Tegra::DmaPusher& dma_pusher, Core::PerfStats& perf_stats,
                       SynchState& state) {
     MicroProfileOnThreadCreate("GpuThread");
+    Common::SetCurrentThreadName("yuzu:GpuThread");
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::Gpu);
+
+    // Commands are taken in batches, so the queue indices are only touched once per batch
+    constexpr std::size_t batch_size = 16;
+    std::array<CommandDataContainer, batch_size> commands;
 
     // Wait for first GPU command before acquiring the window context
-    state.WaitForCommands();
+    std::size_t count = state.queue.PopBatchWait(commands.data(), commands.size());
 
     // If emulation was stopped during disk shader loading, abort before trying to acquire context
     if (!state.is_running) {
         return;
     }
 
-    Core::Frontend::ScopeAcquireWindowContext acquire_context{renderer.GetRenderWindow()};
+    Core::Frontend::GraphicsContext& context = renderer.GetCommandContext();
+    context.MakeCurrent();
+    SCOPE_EXIT({ context.DoneCurrent(); });
 
-    CommandDataContainer next;
     while (state.is_running) {
-        state.WaitForCommands();
-        while (!state.queue.Empty()) {
-            state.queue.Pop(next);
-            if (const auto submit_list = std::get_if<SubmitListCommand>(&next.data)) {
+        // The time spent on the batch counts as busy, waiting for the next one as idle
+        const auto batch_start = Core::PerfStats::Clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            CommandDataContainer& command = commands[i];
+
+            // Apply the CPU writes to cached memory that happened before this command was queued
+            gpu.InvalidateDeferredRegions();
+
+            if (const auto submit_list = std::get_if<SubmitListCommand>(&command.data)) {
+                TRACE_SCOPE_DYNAMIC("GPU", "SubmitList");
                 dma_pusher.Push(std::move(submit_list->entries));
                 dma_pusher.DispatchCalls();
-            } else if (const auto data = std::get_if<SwapBuffersCommand>(&next.data)) {
-                renderer.SwapBuffers(std::move(data->framebuffer));
-            } else if (const auto data = std::get_if<FlushRegionCommand>(&next.data)) {
+            } else if (const auto data = std::get_if<SwapBuffersCommand>(&command.data)) {
+                TRACE_SCOPE_DYNAMIC("GPU", "SwapBuffers");
+                renderer.SwapBuffers(std::move(data->framebuffer), data->overlays,
+                                     data->release_callback);
+            } else if (const auto data = std::get_if<FlushRegionCommand>(&command.data)) {
+                TRACE_SCOPE_DYNAMIC("GPU", "FlushRegion");
                 renderer.Rasterizer().FlushRegion(data->addr, data->size);
-            } else if (const auto data = std::get_if<InvalidateRegionCommand>(&next.data)) {
-                renderer.Rasterizer().InvalidateRegion(data->addr, data->size);
-            } else if (std::holds_alternative<EndProcessingCommand>(next.data)) {
+            } else if (const auto data = std::get_if<IncrementSyncPointCommand>(&command.data)) {
+                gpu.IncrementSyncPoint(data->syncpoint_id);
+            } else if (std::holds_alternative<EndProcessingCommand>(command.data)) {
                 return;
             } else {
                 UNREACHABLE();
             }
-            state.signaled_fence = next.fence;
-            state.TrySynchronize();
+            state.SignalFence(command.fence);
         }
+        perf_stats.AddGpuBusyTime(Core::PerfStats::Clock::now() - batch_start);
+        count = state.queue.PopBatchWait(commands.data(), commands.size());
     }
 }
 
@@ -67,49 +87,66 @@ ThreadManager::~ThreadManager() {
     thread.join();
 }
 
-void ThreadManager::StartThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher) {
-    thread = std::thread{RunThread, std::ref(renderer), std::ref(dma_pusher), std::ref(state)};
-    synchronization_event = system.CoreTiming().RegisterEvent(
-        "GPUThreadSynch", [this](u64 fence, s64) { state.WaitForSynchronization(fence); });
+void ThreadManager::StartThread(Tegra::GPU& gpu, VideoCore::RendererBase& renderer,
+                                Tegra::DmaPusher& dma_pusher) {
+    thread = std::thread{RunThread,
+                         std::ref(gpu),
+                         std::ref(renderer),
+                         std::ref(dma_pusher),
+                         std::ref(system.GetPerfStats()),
+                         std::ref(state)};
 }
 
 void ThreadManager::SubmitList(Tegra::CommandList&& entries) {
-    const u64 fence{PushCommand(SubmitListCommand(std::move(entries)))};
-    const s64 synchronization_ticks{Core::Timing::usToCycles(9000)};
-    system.CoreTiming().ScheduleEvent(synchronization_ticks, synchronization_event, fence);
+    PushCommand(SubmitListCommand(std::move(entries)));
 }
 
 void ThreadManager::SwapBuffers(
-    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) {
-    PushCommand(SwapBuffersCommand(std::move(framebuffer)));
+    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+    Tegra::FramebufferOverlays overlays, std::function<void()> release_callback) {
+    PushCommand(SwapBuffersCommand(std::move(framebuffer), std::move(overlays),
+                                   std::move(release_callback)));
 }
 
 void ThreadManager::FlushRegion(CacheAddr addr, u64 size) {
-    PushCommand(FlushRegionCommand(addr, size));
-}
-
-void ThreadManager::InvalidateRegion(CacheAddr addr, u64 size) {
-    if (state.queue.Empty()) {
-        // It's quicker to invalidate a single region on the CPU if the queue is already empty
-        system.Renderer().Rasterizer().InvalidateRegion(addr, size);
-    } else {
-        PushCommand(InvalidateRegionCommand(addr, size));
+    // When the GPU thread has executed every command, the caches are up to date and can tell
+    // whether there is anything to flush at all. Otherwise a pending command may still modify
+    // the region, so the flush has to be queued after it.
+    const bool is_gpu_idle = state.signaled_fence == state.last_fence;
+    if (is_gpu_idle && !system.Renderer().Rasterizer().MustFlushRegion(addr, size)) {
+        return;
     }
+    PushCommand(FlushRegionCommand(addr, size));
 }
 
-void ThreadManager::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
-    // Skip flush on asynch mode, as FlushAndInvalidateRegion is not used for anything too important
-    InvalidateRegion(addr, size);
+void ThreadManager::IncrementSyncPoint(u32 syncpoint_id) {
+    PushCommand(IncrementSyncPointCommand(syncpoint_id));
 }
 
+TRACE_DEFINE(GPU_queue_full, "GPU", "Wait for space in the GPU queue", MP_RGB(128, 128, 192));
 u64 ThreadManager::PushCommand(CommandData&& command_data) {
     const u64 fence{++state.last_fence};
-    state.queue.Push(CommandDataContainer(std::move(command_data), fence));
-    state.SignalCommands();
+    CommandDataContainer command{std::move(command_data), fence};
+    TRACE_COUNTER("GPU", "Queued commands", fence - state.signaled_fence);
+    if (!state.queue.TryPush(std::move(command))) {
+        TRACE_SCOPE(GPU_queue_full);
+        state.queue.PushWait(std::move(command));
+    }
     return fence;
 }
 
-MICROPROFILE_DEFINE(GPU_wait, "GPU", "Wait for the GPU", MP_RGB(128, 128, 192));
+void SynchState::SignalFence(u64 fence) {
+    signaled_fence = fence;
+
+    // Only take the lock when the CPU is actually waiting for this fence
+    const u64 waiting = waiting_fence;
+    if (waiting != 0 && fence >= waiting) {
+        std::lock_guard lock{synchronization_mutex};
+        synchronization_condition.notify_one();
+    }
+}
+
+TRACE_DEFINE(GPU_wait, "GPU", "Wait for the GPU", MP_RGB(128, 128, 192));
 void SynchState::WaitForSynchronization(u64 fence) {
     if (signaled_fence >= fence) {
         return;
@@ -117,9 +154,11 @@ void SynchState::WaitForSynchronization(u64 fence) {
 
     // Wait for the GPU to be idle (all commands to be executed)
     {
-        MICROPROFILE_SCOPE(GPU_wait);
+        TRACE_SCOPE(GPU_wait);
         std::unique_lock lock{synchronization_mutex};
+        waiting_fence = fence;
         synchronization_condition.wait(lock, [this, fence] { return signaled_fence >= fence; });
+        waiting_fence = 0;
     }
 }
 
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -17,13 +18,11 @@
 namespace Tegra {
 struct FramebufferConfig;
 class DmaPusher;
+class GPU;
 } // namespace Tegra
 
 namespace Core {
 class System;
-namespace Timing {
-struct EventType;
-} // namespace Timing
 } // namespace Core
 
 namespace VideoCommon::GPUThread {
@@ -40,10 +39,15 @@ struct SubmitListCommand final {
 
 /// Command to signal to the GPU thread that a swap buffers is pending
 struct SwapBuffersCommand final {
-    explicit SwapBuffersCommand(std::optional<const Tegra::FramebufferConfig> framebuffer)
-        : framebuffer{std::move(framebuffer)} {}
+    explicit SwapBuffersCommand(std::optional<const Tegra::FramebufferConfig> framebuffer,
+                                Tegra::FramebufferOverlays overlays,
+                                std::function<void()> release_callback)
+        : framebuffer{std::move(framebuffer)}, overlays{std::move(overlays)},
+          release_callback{std::move(release_callback)} {}
 
     std::optional<Tegra::FramebufferConfig> framebuffer;
+    Tegra::FramebufferOverlays overlays;
+    std::function<void()> release_callback;
 };
 
 /// Command to signal to the GPU thread to flush a region
@@ -54,26 +58,15 @@ struct FlushRegionCommand final {
     u64 size;
 };
 
-/// Command to signal to the GPU thread to invalidate a region
-struct InvalidateRegionCommand final {
-    explicit constexpr InvalidateRegionCommand(CacheAddr addr, u64 size) : addr{addr}, size{size} {}
+/// Command to signal to the GPU thread to increment a syncpoint
+struct IncrementSyncPointCommand final {
+    explicit constexpr IncrementSyncPointCommand(u32 syncpoint_id) : syncpoint_id{syncpoint_id} {}
 
-    CacheAddr addr;
-    u64 size;
-};
-
-/// Command to signal to the GPU thread to flush and invalidate a region
-struct FlushAndInvalidateRegionCommand final {
-    explicit constexpr FlushAndInvalidateRegionCommand(CacheAddr addr, u64 size)
-        : addr{addr}, size{size} {}
-
-    CacheAddr addr;
-    u64 size;
+    u32 syncpoint_id;
 };
 
-using CommandData =
-    std::variant<EndProcessingCommand, SubmitListCommand, SwapBuffersCommand, FlushRegionCommand,
-                 InvalidateRegionCommand, FlushAndInvalidateRegionCommand>;
+using CommandData = std::variant<EndProcessingCommand, SubmitListCommand, SwapBuffersCommand,
+                                 FlushRegionCommand, IncrementSyncPointCommand>;
 
 struct CommandDataContainer {
     CommandDataContainer() = default;
@@ -90,43 +83,23 @@ struct SynchState final {
     std::atomic_bool is_running{true};
     std::atomic_int queued_frame_count{};
     std::mutex synchronization_mutex;
-    std::mutex commands_mutex;
-    std::condition_variable commands_condition;
     std::condition_variable synchronization_condition;
 
-    /// Returns true if the gap in GPU commands is small enough that we can consider the CPU and GPU
-    /// synchronized. This is entirely empirical.
-    bool IsSynchronized() const {
-        constexpr std::size_t max_queue_gap{5};
-        return queue.Size() <= max_queue_gap;
-    }
-
-    void TrySynchronize() {
-        if (IsSynchronized()) {
-            std::lock_guard lock{synchronization_mutex};
-            synchronization_condition.notify_one();
-        }
-    }
+    /// Marks the commands up to the given fence as executed, waking up the CPU if it waits on them.
+    void SignalFence(u64 fence);
 
     void WaitForSynchronization(u64 fence);
 
-    void SignalCommands() {
-        if (queue.Empty()) {
-            return;
-        }
-
-        commands_condition.notify_one();
-    }
+    /// Maximum amount of commands that can be queued before the CPU has to wait for the GPU.
+    static constexpr std::size_t QueueCapacity = 1024;
 
-    void WaitForCommands() {
-        std::unique_lock lock{commands_mutex};
-        commands_condition.wait(lock, [this] { return !queue.Empty(); });
-    }
-
-    using CommandQueue = Common::SPSCQueue<CommandDataContainer>;
+    using CommandQueue = Common::BoundedSPSCQueue<CommandDataContainer, QueueCapacity>;
     CommandQueue queue;
     u64 last_fence{};
     std::atomic<u64> signaled_fence{};
+
+    /// Fence the CPU is waiting on, or zero if it isn't waiting on the GPU.
+    std::atomic<u64> waiting_fence{};
 };
 
 /// Class used to manage the GPU thread
@@ -136,23 +109,22 @@ public:
     ~ThreadManager();
 
     /// Creates and starts the GPU thread.
-    void StartThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher);
+    void StartThread(Tegra::GPU& gpu, VideoCore::RendererBase& renderer,
+                     Tegra::DmaPusher& dma_pusher);
 
     /// Push GPU command entries to be processed
     void SubmitList(Tegra::CommandList&& entries);
 
     /// Swap buffers (render frame)
     void SwapBuffers(
-        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer);
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+        Tegra::FramebufferOverlays overlays, std::function<void()> release_callback);
 
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
     void FlushRegion(CacheAddr addr, u64 size);
 
-    /// Notify rasterizer that any caches of the specified region should be invalidated
-    void InvalidateRegion(CacheAddr addr, u64 size);
-
-    /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
-    void FlushAndInvalidateRegion(CacheAddr addr, u64 size);
+    /// Increments a syncpoint once the commands pushed before it have been executed
+    void IncrementSyncPoint(u32 syncpoint_id);
 
 private:
     /// Pushes a command to be executed by the GPU thread
@@ -161,7 +133,6 @@ private:
 private:
     SynchState state;
     Core::System& system;
-    Core::Timing::EventType* synchronization_event{};
     std::thread thread;
     std::thread::id thread_id;
 };
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <tuple>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "video_core/engines/maxwell_3d.h"
@@ -11,19 +12,51 @@ namespace Tegra {
 
 MacroInterpreter::MacroInterpreter(Engines::Maxwell3D& maxwell3d) : maxwell3d(maxwell3d) {}
 
-void MacroInterpreter::Execute(u32 offset, std::vector<u32> parameters) {
+void MacroInterpreter::Execute(u32 offset, std::size_t num_parameters, const u32* parameters) {
+    // A macro may call another one through the methods it sends, the state of the caller is
+    // restored once the callee returns
+    const auto caller_state =
+        std::make_tuple(pc, delayed_pc, registers, method_address, this->parameters,
+                        this->num_parameters, next_parameter_index, current_code, carry_flag);
+
     Reset();
+    ASSERT(num_parameters > 0);
     registers[1] = parameters[0];
-    this->parameters = std::move(parameters);
+    this->parameters = parameters;
+    this->num_parameters = num_parameters;
+    current_code = &code_cache[offset];
 
     // Execute the code until we hit an exit condition.
+    ++execution_depth;
     bool keep_executing = true;
     while (keep_executing) {
         keep_executing = Step(offset, false);
     }
+    --execution_depth;
 
     // Assert the the macro used all the input parameters
-    ASSERT(next_parameter_index == this->parameters.size());
+    ASSERT(next_parameter_index == num_parameters);
+
+    std::tie(pc, delayed_pc, registers, method_address, this->parameters, this->num_parameters,
+             next_parameter_index, current_code, carry_flag) = caller_state;
+
+    if (execution_depth == 0 && is_invalidation_pending) {
+        is_invalidation_pending = false;
+        code_cache.clear();
+    }
+}
+
+void MacroInterpreter::InvalidateCache() {
+    if (code_cache.empty()) {
+        return;
+    }
+    // A macro can upload macro code through the methods it sends, its decoded instructions are
+    // kept alive until it returns
+    if (execution_depth != 0) {
+        is_invalidation_pending = true;
+        return;
+    }
+    code_cache.clear();
 }
 
 void MacroInterpreter::Reset() {
@@ -31,7 +64,8 @@ void MacroInterpreter::Reset() {
     pc = 0;
     delayed_pc = {};
     method_address.raw = 0;
-    parameters.clear();
+    parameters = nullptr;
+    num_parameters = 0;
     // The next parameter index starts at 1, because $r1 already has the value of the first
     // parameter.
     next_parameter_index = 1;
@@ -41,7 +75,8 @@ void MacroInterpreter::Reset() {
 bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
     u32 base_address = pc;
 
-    Opcode opcode = GetOpcode(offset);
+    // Copied, sending methods in ProcessResult may decode more instructions into the cache
+    const DecodedOpcode opcode = GetOpcode(offset);
     pc += 4;
 
     // Update the program counter if we were delayed
@@ -67,8 +102,8 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        src = (src >> opcode.bf_src_bit) & opcode.GetBitfieldMask();
-        dst &= ~(opcode.GetBitfieldMask() << opcode.bf_dst_bit);
+        src = (src >> opcode.bf_src_bit) & opcode.bitfield_mask;
+        dst &= ~(opcode.bitfield_mask << opcode.bf_dst_bit);
         dst |= src << opcode.bf_dst_bit;
         ProcessResult(opcode.result_operation, opcode.dst, dst);
         break;
@@ -77,7 +112,7 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        u32 result = ((src >> dst) & opcode.GetBitfieldMask()) << opcode.bf_dst_bit;
+        u32 result = ((src >> dst) & opcode.bitfield_mask) << opcode.bf_dst_bit;
 
         ProcessResult(opcode.result_operation, opcode.dst, result);
         break;
@@ -86,7 +121,7 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        u32 result = ((src >> opcode.bf_src_bit) & opcode.GetBitfieldMask()) << dst;
+        u32 result = ((src >> opcode.bf_src_bit) & opcode.bitfield_mask) << dst;
 
         ProcessResult(opcode.result_operation, opcode.dst, result);
         break;
@@ -103,19 +138,18 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
         if (taken) {
             // Ignore the delay slot if the branch has the annul bit.
             if (opcode.branch_annul) {
-                pc = base_address + opcode.GetBranchTarget();
+                pc = base_address + opcode.branch_target;
                 return true;
             }
 
-            delayed_pc = base_address + opcode.GetBranchTarget();
+            delayed_pc = base_address + opcode.branch_target;
             // Execute one more instruction due to the delay slot.
             return Step(offset, true);
         }
         break;
     }
     default:
-        UNIMPLEMENTED_MSG("Unimplemented macro operation {}",
-                          static_cast<u32>(opcode.operation.Value()));
+        UNIMPLEMENTED_MSG("Unimplemented macro operation {}", static_cast<u32>(opcode.operation));
     }
 
     // An instruction with the Exit flag will not actually
@@ -131,11 +165,39 @@ bool MacroInterpreter::Step(u32 offset, bool is_delay_slot) {
     return true;
 }
 
-MacroInterpreter::Opcode MacroInterpreter::GetOpcode(u32 offset) const {
+MacroInterpreter::DecodedOpcode MacroInterpreter::GetOpcode(u32 offset) {
     const auto& macro_memory{maxwell3d.GetMacroMemory()};
     ASSERT((pc % sizeof(u32)) == 0);
     ASSERT((pc + offset) < macro_memory.size() * sizeof(u32));
-    return {macro_memory[offset + pc / sizeof(u32)]};
+
+    const std::size_t index = pc / sizeof(u32);
+    auto& code = *current_code;
+    if (index >= code.size()) {
+        ASSERT(offset + index < macro_memory.size());
+        for (std::size_t i = code.size(); i <= index; ++i) {
+            code.push_back(Decode({macro_memory[offset + i]}));
+        }
+    }
+    return code[index];
+}
+
+MacroInterpreter::DecodedOpcode MacroInterpreter::Decode(Opcode opcode) {
+    DecodedOpcode decoded;
+    decoded.operation = opcode.operation;
+    decoded.result_operation = opcode.result_operation;
+    decoded.alu_operation = opcode.alu_operation;
+    decoded.branch_condition = opcode.branch_condition;
+    decoded.branch_annul = opcode.branch_annul != 0;
+    decoded.is_exit = opcode.is_exit != 0;
+    decoded.dst = opcode.dst;
+    decoded.src_a = opcode.src_a;
+    decoded.src_b = opcode.src_b;
+    decoded.immediate = opcode.immediate;
+    decoded.bf_src_bit = opcode.bf_src_bit;
+    decoded.bf_dst_bit = opcode.bf_dst_bit;
+    decoded.bitfield_mask = opcode.GetBitfieldMask();
+    decoded.branch_target = opcode.GetBranchTarget();
+    return decoded;
 }
 
 u32 MacroInterpreter::GetALUResult(ALUOperation operation, u32 src_a, u32 src_b) {
@@ -225,7 +287,8 @@ void MacroInterpreter::ProcessResult(ResultOperation operation, u32 reg, u32 res
 }
 
 u32 MacroInterpreter::FetchParameter() {
-    return parameters.at(next_parameter_index++);
+    ASSERT(next_parameter_index < num_parameters);
+    return parameters[next_parameter_index++];
 }
 
 u32 MacroInterpreter::GetRegister(u32 register_id) const {
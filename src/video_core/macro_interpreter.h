@@ -6,6 +6,7 @@
 
 #include <array>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "common/bit_field.h"
@@ -23,9 +24,14 @@ public:
     /**
      * Executes the macro code with the specified input parameters.
      * @param offset Offset to start execution at.
+     * @param num_parameters Number of parameters of the macro, it must be at least one.
      * @param parameters The parameters of the macro.
      */
-    void Execute(u32 offset, std::vector<u32> parameters);
+    void Execute(u32 offset, std::size_t num_parameters, const u32* parameters);
+
+    /// Discards the decoded macros, must be called whenever the macro memory is modified. When a
+    /// macro is executing, they are discarded once it returns.
+    void InvalidateCache();
 
 private:
     enum class Operation : u32 {
@@ -98,6 +104,24 @@ private:
         }
     };
 
+    /// Macro instruction with all its fields extracted, so that executing it again is cheap.
+    struct DecodedOpcode {
+        Operation operation;
+        ResultOperation result_operation;
+        ALUOperation alu_operation;
+        BranchCondition branch_condition;
+        bool branch_annul;
+        bool is_exit;
+        u32 dst;
+        u32 src_a;
+        u32 src_b;
+        s32 immediate;
+        u32 bf_src_bit;
+        u32 bf_dst_bit;
+        u32 bitfield_mask;
+        s32 branch_target;
+    };
+
     union MethodAddress {
         u32 raw;
         BitField<0, 12, u32> address;
@@ -126,8 +150,11 @@ private:
     /// Evaluates the branch condition and returns whether the branch should be taken or not.
     bool EvaluateBranchCondition(BranchCondition cond, u32 value) const;
 
-    /// Reads an opcode at the current program counter location.
-    Opcode GetOpcode(u32 offset) const;
+    /// Reads an opcode at the current program counter location, decoding it on its first use.
+    DecodedOpcode GetOpcode(u32 offset);
+
+    /// Extracts the fields of a raw macro instruction.
+    static DecodedOpcode Decode(Opcode opcode);
 
     /// Returns the specified register's value. Register 0 is hardcoded to always return 0.
     u32 GetRegister(u32 register_id) const;
@@ -149,7 +176,7 @@ private:
 
     Engines::Maxwell3D& maxwell3d;
 
-    u32 pc; ///< Current program counter
+    u32 pc{}; ///< Current program counter
     std::optional<u32>
         delayed_pc; ///< Program counter to execute at after the delay slot is executed.
 
@@ -162,10 +189,21 @@ private:
     MethodAddress method_address = {};
 
     /// Input parameters of the current macro.
-    std::vector<u32> parameters;
+    const u32* parameters = nullptr;
+    std::size_t num_parameters = 0;
     /// Index of the next parameter that will be fetched by the 'parm' instruction.
     u32 next_parameter_index = 0;
 
+    /// Decoded instructions of each executed macro, indexed by their start offset. The
+    /// instructions of a macro are indexed by their program counter in words.
+    std::unordered_map<u32, std::vector<DecodedOpcode>> code_cache;
+    /// Decoded instructions of the macro that is currently executing.
+    std::vector<DecodedOpcode>* current_code = nullptr;
+    /// Number of macros executing, macros may be called from the methods a macro sends
+    u32 execution_depth = 0;
+    /// Set when the macro memory was modified by an executing macro
+    bool is_invalidation_pending = false;
+
     bool carry_flag{};
 };
 } // namespace Tegra
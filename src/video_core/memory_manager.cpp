@@ -6,23 +6,20 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
+#include "core/tracer/recorder.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 
 namespace Tegra {
 
 MemoryManager::MemoryManager(VideoCore::RasterizerInterface& rasterizer) : rasterizer{rasterizer} {
-    std::fill(page_table.pointers.begin(), page_table.pointers.end(), nullptr);
-    std::fill(page_table.attributes.begin(), page_table.attributes.end(),
-              Common::PageType::Unmapped);
+    // The newly allocated page table is entirely unmapped, matching the initial free region.
     page_table.Resize(address_space_width);
 
     // Initialize the map with a single free region covering the entire managed space.
     VirtualMemoryArea initial_vma;
     initial_vma.size = address_space_end;
     vma_map.emplace(initial_vma.base, initial_vma);
-
-    UpdatePageTableForVMA(initial_vma);
 }
 
 MemoryManager::~MemoryManager() = default;
@@ -49,6 +46,9 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, u64 size) {
     const GPUVAddr gpu_addr{FindFreeRegion(address_space_base, aligned_size)};
 
     MapBackingMemory(gpu_addr, Memory::GetPointer(cpu_addr), aligned_size, cpu_addr);
+    if (recorder) {
+        recorder->MapBuffer(gpu_addr, cpu_addr, aligned_size);
+    }
 
     return gpu_addr;
 }
@@ -59,6 +59,9 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, GPUVAddr gpu_addr, u64 size)
     const u64 aligned_size{Common::AlignUp(size, page_size)};
 
     MapBackingMemory(gpu_addr, Memory::GetPointer(cpu_addr), aligned_size, cpu_addr);
+    if (recorder) {
+        recorder->MapBuffer(gpu_addr, cpu_addr, aligned_size);
+    }
 
     return gpu_addr;
 }
@@ -71,6 +74,9 @@ GPUVAddr MemoryManager::UnmapBuffer(GPUVAddr gpu_addr, u64 size) {
 
     rasterizer.FlushAndInvalidateRegion(cache_addr, aligned_size);
     UnmapRange(gpu_addr, aligned_size);
+    if (recorder) {
+        recorder->UnmapBuffer(gpu_addr, aligned_size);
+    }
 
     return gpu_addr;
 }
@@ -202,25 +208,43 @@ const u8* MemoryManager::GetPointer(GPUVAddr addr) const {
 }
 
 bool MemoryManager::IsBlockContinuous(const GPUVAddr start, const std::size_t size) const {
-    const GPUVAddr end = start + size;
-    const auto host_ptr_start = reinterpret_cast<std::uintptr_t>(GetPointer(start));
-    const auto host_ptr_end = reinterpret_cast<std::uintptr_t>(GetPointer(end));
-    const auto range = static_cast<std::size_t>(host_ptr_end - host_ptr_start);
-    return range == size;
+    if (!IsAddressValid(start) || page_table.pointers[start >> page_bits] == nullptr) {
+        return false;
+    }
+    return GetContinuousSize(start, size) == size;
+}
+
+std::size_t MemoryManager::GetContinuousSize(GPUVAddr addr, std::size_t max_size) const {
+    std::size_t page_index{addr >> page_bits};
+    std::size_t size{std::min(static_cast<std::size_t>(page_size - (addr & page_mask)), max_size)};
+
+    const u8* page_pointer{page_table.pointers[page_index]};
+    if (page_pointer == nullptr) {
+        return size;
+    }
+
+    // Extend the range while the following pages are mapped right after the previous one
+    while (size < max_size && ++page_index < page_table.pointers.size()) {
+        page_pointer += page_size;
+        if (page_table.pointers[page_index] != page_pointer) {
+            break;
+        }
+        size = std::min(size + static_cast<std::size_t>(page_size), max_size);
+    }
+    return size;
 }
 
 void MemoryManager::ReadBlock(GPUVAddr src_addr, void* dest_buffer, const std::size_t size) const {
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> page_bits};
-    std::size_t page_offset{src_addr & page_mask};
 
+    // Copies are done in runs of pages continuous in host memory, each run needs a single flush
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{src_addr >> page_bits};
+        const std::size_t copy_amount{GetContinuousSize(src_addr, remaining_size)};
 
         switch (page_table.attributes[page_index]) {
         case Common::PageType::Memory: {
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
+            const u8* src_ptr{page_table.pointers[page_index] + (src_addr & page_mask)};
             rasterizer.FlushRegion(ToCacheAddr(src_ptr), copy_amount);
             std::memcpy(dest_buffer, src_ptr, copy_amount);
             break;
@@ -229,8 +253,7 @@ void MemoryManager::ReadBlock(GPUVAddr src_addr, void* dest_buffer, const std::s
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        src_addr += copy_amount;
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -239,21 +262,17 @@ void MemoryManager::ReadBlock(GPUVAddr src_addr, void* dest_buffer, const std::s
 void MemoryManager::ReadBlockUnsafe(GPUVAddr src_addr, void* dest_buffer,
                                     const std::size_t size) const {
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> page_bits};
-    std::size_t page_offset{src_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
-        const u8* page_pointer = page_table.pointers[page_index];
+        const std::size_t copy_amount{GetContinuousSize(src_addr, remaining_size)};
+        const u8* page_pointer = page_table.pointers[src_addr >> page_bits];
         if (page_pointer) {
-            const u8* src_ptr{page_pointer + page_offset};
+            const u8* src_ptr{page_pointer + (src_addr & page_mask)};
             std::memcpy(dest_buffer, src_ptr, copy_amount);
         } else {
             std::memset(dest_buffer, 0, copy_amount);
         }
-        page_index++;
-        page_offset = 0;
+        src_addr += copy_amount;
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -261,16 +280,14 @@ void MemoryManager::ReadBlockUnsafe(GPUVAddr src_addr, void* dest_buffer,
 
 void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const std::size_t size) {
     std::size_t remaining_size{size};
-    std::size_t page_index{dest_addr >> page_bits};
-    std::size_t page_offset{dest_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{dest_addr >> page_bits};
+        const std::size_t copy_amount{GetContinuousSize(dest_addr, remaining_size)};
 
         switch (page_table.attributes[page_index]) {
         case Common::PageType::Memory: {
-            u8* dest_ptr{page_table.pointers[page_index] + page_offset};
+            u8* dest_ptr{page_table.pointers[page_index] + (dest_addr & page_mask)};
             rasterizer.InvalidateRegion(ToCacheAddr(dest_ptr), copy_amount);
             std::memcpy(dest_ptr, src_buffer, copy_amount);
             break;
@@ -279,8 +296,7 @@ void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        dest_addr += copy_amount;
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -289,19 +305,15 @@ void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const
 void MemoryManager::WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer,
                                      const std::size_t size) {
     std::size_t remaining_size{size};
-    std::size_t page_index{dest_addr >> page_bits};
-    std::size_t page_offset{dest_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
-        u8* page_pointer = page_table.pointers[page_index];
+        const std::size_t copy_amount{GetContinuousSize(dest_addr, remaining_size)};
+        u8* page_pointer = page_table.pointers[dest_addr >> page_bits];
         if (page_pointer) {
-            u8* dest_ptr{page_pointer + page_offset};
+            u8* dest_ptr{page_pointer + (dest_addr & page_mask)};
             std::memcpy(dest_ptr, src_buffer, copy_amount);
         }
-        page_index++;
-        page_offset = 0;
+        dest_addr += copy_amount;
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
         remaining_size -= copy_amount;
     }
@@ -309,16 +321,14 @@ void MemoryManager::WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer,
 
 void MemoryManager::CopyBlock(GPUVAddr dest_addr, GPUVAddr src_addr, const std::size_t size) {
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> page_bits};
-    std::size_t page_offset{src_addr & page_mask};
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount{
-            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        const std::size_t page_index{src_addr >> page_bits};
+        const std::size_t copy_amount{GetContinuousSize(src_addr, remaining_size)};
 
         switch (page_table.attributes[page_index]) {
         case Common::PageType::Memory: {
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
+            const u8* src_ptr{page_table.pointers[page_index] + (src_addr & page_mask)};
             rasterizer.FlushRegion(ToCacheAddr(src_ptr), copy_amount);
             WriteBlock(dest_addr, src_ptr, copy_amount);
             break;
@@ -327,8 +337,6 @@ void MemoryManager::CopyBlock(GPUVAddr dest_addr, GPUVAddr src_addr, const std::
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
         dest_addr += static_cast<VAddr>(copy_amount);
         src_addr += static_cast<VAddr>(copy_amount);
         remaining_size -= copy_amount;
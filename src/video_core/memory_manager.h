@@ -10,6 +10,10 @@
 #include "common/common_types.h"
 #include "common/page_table.h"
 
+namespace Tracer {
+class Recorder;
+}
+
 namespace VideoCore {
 class RasterizerInterface;
 }
@@ -66,6 +70,11 @@ public:
     u8* GetPointer(GPUVAddr addr);
     const u8* GetPointer(GPUVAddr addr) const;
 
+    /// Sets the recorder the buffer mappings are reported to while tracing, or nullptr to stop.
+    void SetTraceRecorder(Tracer::Recorder* recorder_) {
+        recorder = recorder_;
+    }
+
     /// Returns true if the block is continuous in host memory, false otherwise
     bool IsBlockContinuous(GPUVAddr start, std::size_t size) const;
 
@@ -99,6 +108,12 @@ private:
     using VMAIter = VMAMap::iterator;
 
     bool IsAddressValid(GPUVAddr addr) const;
+
+    /**
+     * Returns the size of the range starting at the given address, limited to max_size, that is
+     * continuous in host memory. Unmapped pages are returned one at a time.
+     */
+    std::size_t GetContinuousSize(GPUVAddr addr, std::size_t max_size) const;
     void MapPages(GPUVAddr base, u64 size, u8* memory, Common::PageType type,
                   VAddr backing_addr = 0);
     void MapMemoryRegion(GPUVAddr base, u64 size, u8* target, VAddr backing_addr);
@@ -173,6 +188,7 @@ private:
     Common::PageTable page_table{page_bits};
     VMAMap vma_map;
     VideoCore::RasterizerInterface& rasterizer;
+    Tracer::Recorder* recorder{};
 };
 
 } // namespace Tegra
@@ -89,6 +89,25 @@ public:
         }
     }
 
+    /// Returns true if any cached resource overlapping the specified region is dirty
+    bool MustFlushRegion(CacheAddr addr, u64 size) {
+        std::lock_guard lock{mutex};
+
+        if (size == 0) {
+            return false;
+        }
+
+        const ObjectInterval interval{addr, addr + size};
+        for (auto& pair : boost::make_iterator_range(interval_cache.equal_range(interval))) {
+            for (auto& cached_object : pair.second) {
+                if (cached_object && cached_object->IsDirty()) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     /// Mark the specified region as being invalidated
     void InvalidateRegion(CacheAddr addr, u64 size) {
         std::lock_guard lock{mutex};
@@ -169,7 +188,6 @@ protected:
         object->MarkAsModified(false, *this);
     }
 
-private:
     /// Returns a list of cached objects from the specified memory region, ordered by access time
     std::vector<T> GetSortedObjectsFromRegion(CacheAddr addr, u64 size) {
         if (size == 0) {
@@ -194,6 +212,9 @@ private:
         return objects;
     }
 
+    std::recursive_mutex mutex;
+
+private:
     using ObjectSet = std::set<T>;
     using ObjectCache = std::unordered_map<CacheAddr, T>;
     using IntervalCache = boost::icl::interval_map<CacheAddr, ObjectSet>;
@@ -208,5 +229,4 @@ private:
     IntervalCache interval_cache; ///< Cache of objects
     u64 modified_ticks{};         ///< Counter of cache state ticks, used for in-order flushing
     VideoCore::RasterizerInterface& rasterizer;
-    std::recursive_mutex mutex;
 };
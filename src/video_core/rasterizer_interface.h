@@ -6,12 +6,20 @@
 
 #include <atomic>
 #include <functional>
+#include <optional>
 #include "common/common_types.h"
 #include "video_core/engines/fermi_2d.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
 
 namespace VideoCore {
 
+/// Counters the guest can query
+enum class QueryType {
+    SamplesPassed,
+};
+constexpr std::size_t NumQueryTypes = 1;
+
 enum class LoadCallbackStage {
     Prepare,
     Decompile,
@@ -30,6 +38,9 @@ public:
     /// Clear the current framebuffer
     virtual void Clear() = 0;
 
+    /// Dispatches a compute shader invocation
+    virtual void DispatchCompute(GPUVAddr code_addr) = 0;
+
     /// Notify rasterizer that all caches should be flushed to Switch memory
     virtual void FlushAll() = 0;
 
@@ -39,6 +50,12 @@ public:
     /// Notify rasterizer that any caches of the specified region should be invalidated
     virtual void InvalidateRegion(CacheAddr addr, u64 size) = 0;
 
+    /// Returns true if the caches of the specified region hold modifications that have not been
+    /// flushed to Switch memory yet
+    virtual bool MustFlushRegion(CacheAddr addr, u64 size) {
+        return true;
+    }
+
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
     /// and invalidated
     virtual void FlushAndInvalidateRegion(CacheAddr addr, u64 size) = 0;
@@ -46,8 +63,13 @@ public:
     /// Attempt to use a faster method to perform a surface copy
     virtual bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                        const Tegra::Engines::Fermi2D::Regs::Surface& dst,
-                                       const Common::Rectangle<u32>& src_rect,
-                                       const Common::Rectangle<u32>& dst_rect) {
+                                       const Tegra::Engines::Fermi2D::Config& copy_config) {
+        return false;
+    }
+
+    /// Attempt to perform a DMA copy on the host GPU, avoiding a round trip through guest memory
+    /// when the surfaces involved are cached
+    virtual bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
         return false;
     }
 
@@ -57,10 +79,37 @@ public:
         return false;
     }
 
+    /// Attempt to write inline data to guest memory updating the cached buffers holding it in
+    /// place, instead of invalidating them. Returns false if nothing was written.
+    virtual bool AccelerateInlineToMemory(GPUVAddr address, const u8* data, std::size_t size) {
+        return false;
+    }
+
+    /// Records the value of a counter at this point of the command stream, to be written to the
+    /// address once the host GPU produced it. Returns false if the counter is not emulated.
+    virtual bool Query(GPUVAddr gpu_addr, QueryType type, std::optional<u64> timestamp) {
+        return false;
+    }
+
+    /// Resets a counter to zero
+    virtual void ResetCounter(QueryType type) {}
+
+    /// Attempt to let the host GPU discard the following draws and clears when the query result
+    /// stored at the address is zero, instead of reading it on the CPU
+    virtual bool AccelerateConditionalRendering(GPUVAddr address) {
+        return false;
+    }
+
+    /// Stops discarding draws and clears on the host GPU
+    virtual void DisableConditionalRendering() {}
+
     virtual bool AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
 
+    /// Notify the rasterizer that a frame has been presented, used to release unused resources
+    virtual void TickFrame() {}
+
     /// Increase/decrease the number of object in pages touching the specified region
     virtual void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {}
 
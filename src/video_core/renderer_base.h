@@ -5,6 +5,7 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <optional>
 
@@ -35,9 +36,16 @@ public:
     explicit RendererBase(Core::Frontend::EmuWindow& window);
     virtual ~RendererBase();
 
-    /// Swap buffers (render frame)
+    /**
+     * Swap buffers (render frame)
+     * @param framebuffer Primary framebuffer to present, or none to present the previous frame
+     * @param overlays Layers composed on top of the primary framebuffer
+     * @param release_callback Called as soon as the guest memory of the buffers has been read
+     */
     virtual void SwapBuffers(
-        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) = 0;
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+        const Tegra::FramebufferOverlays& overlays,
+        const std::function<void()>& release_callback) = 0;
 
     /// Initialize the renderer
     virtual bool Init() = 0;
@@ -72,6 +80,11 @@ public:
         return render_window;
     }
 
+    /// Returns the context the GPU thread processes commands with, the render window by default
+    virtual Core::Frontend::GraphicsContext& GetCommandContext() {
+        return render_window;
+    }
+
     RendererSettings& Settings() {
         return renderer_settings;
     }
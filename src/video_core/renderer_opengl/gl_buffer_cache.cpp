@@ -2,10 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 #include <memory>
+#include <mutex>
 
 #include "common/alignment.h"
+#include "common/bit_util.h"
 #include "core/core.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
@@ -13,30 +17,135 @@
 
 namespace OpenGL {
 
-CachedBufferEntry::CachedBufferEntry(VAddr cpu_addr, std::size_t size, GLintptr offset,
-                                     std::size_t alignment, u8* host_ptr)
-    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, size{size}, offset{offset},
-      alignment{alignment} {}
+DeviceBufferHeap::DeviceBufferHeap() {
+    blocks.reserve(MaxBlocks);
+}
+
+DeviceBufferHeap::~DeviceBufferHeap() = default;
+
+std::optional<DeviceBufferHeap::Allocation> DeviceBufferHeap::Allocate(std::size_t size) {
+    const u32 order = std::max(
+        MinOrder, size <= 1 ? 0 : 64 - Common::CountLeadingZeroes64(static_cast<u64>(size - 1)));
+    if (order > MaxOrder) {
+        return {};
+    }
+
+    for (std::size_t index = 0; index < blocks.size(); ++index) {
+        if (const auto offset = AllocateFromBlock(blocks[index], order)) {
+            return Allocation{blocks[index].buffer.handle, *offset, index, order};
+        }
+    }
+    if (blocks.size() == MaxBlocks) {
+        return {};
+    }
+
+    Block& block = blocks.emplace_back();
+    block.buffer.Create();
+    glNamedBufferStorage(block.buffer.handle, GLsizeiptr{1} << MaxOrder, nullptr,
+                         GL_DYNAMIC_STORAGE_BIT);
+    block.free_chunks[MaxOrder - MinOrder].insert(0);
+    accounting.Resize(blocks.size() << MaxOrder);
+    const auto offset = AllocateFromBlock(block, order);
+    return Allocation{block.buffer.handle, *offset, blocks.size() - 1, order};
+}
+
+void DeviceBufferHeap::Free(const Allocation& allocation) {
+    Block& block = blocks[allocation.block];
+    GLintptr offset = allocation.offset;
+    u32 order = allocation.order;
+    while (order < MaxOrder) {
+        auto& chunks = block.free_chunks[order - MinOrder];
+        const auto buddy = chunks.find(offset ^ (GLintptr{1} << order));
+        if (buddy == chunks.end()) {
+            break;
+        }
+        chunks.erase(buddy);
+        offset &= ~(GLintptr{1} << order);
+        ++order;
+    }
+    block.free_chunks[order - MinOrder].insert(offset);
+}
+
+std::optional<GLintptr> DeviceBufferHeap::AllocateFromBlock(Block& block, u32 order) {
+    for (u32 current = order; current <= MaxOrder; ++current) {
+        auto& chunks = block.free_chunks[current - MinOrder];
+        if (chunks.empty()) {
+            continue;
+        }
+        const GLintptr offset = *chunks.begin();
+        chunks.erase(chunks.begin());
+
+        // Split the chunk until it has the requested size, leaving the upper halves free
+        while (current > order) {
+            --current;
+            block.free_chunks[current - MinOrder].insert(offset + (GLintptr{1} << current));
+        }
+        return offset;
+    }
+    return {};
+}
 
-OGLBufferCache::OGLBufferCache(RasterizerOpenGL& rasterizer, std::size_t size)
-    : RasterizerCache{rasterizer}, stream_buffer(size, true) {}
+CachedBufferEntry::CachedBufferEntry(VAddr cpu_addr, std::size_t size, GLuint handle,
+                                     GLintptr offset, std::size_t alignment, u8* host_ptr)
+    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, size{size}, handle{handle},
+      offset{offset}, alignment{alignment}, host_ptr{host_ptr} {}
 
-GLintptr OGLBufferCache::UploadMemory(GPUVAddr gpu_addr, std::size_t size, std::size_t alignment,
-                                      bool cache) {
-    auto& memory_manager = Core::System::GetInstance().GPU().MemoryManager();
+OGLBufferCache::OGLBufferCache(RasterizerOpenGL& rasterizer, Core::System& system,
+                               std::size_t size)
+    : RasterizerCache{rasterizer}, system{system}, stream_buffer(size, true),
+      stream_buffer_accounting{Common::MemoryAccounting::Category::BufferCache, size} {}
 
+std::tuple<GLuint, GLintptr> OGLBufferCache::UploadMemory(GPUVAddr gpu_addr, std::size_t size,
+                                                          std::size_t alignment, bool cache) {
     // Cache management is a big overhead, so only cache entries with a given size.
     // TODO: Figure out which size is the best for given games.
-    cache &= size >= 2048;
+    return Upload(gpu_addr, size, alignment, cache && size >= 2048);
+}
+
+std::tuple<GLuint, GLintptr> OGLBufferCache::UploadConstBuffer(GPUVAddr gpu_addr,
+                                                               std::size_t size,
+                                                               std::size_t alignment) {
+    return Upload(gpu_addr, size, alignment, true);
+}
+
+std::tuple<GLuint, GLintptr> OGLBufferCache::Upload(GPUVAddr gpu_addr, std::size_t size,
+                                                    std::size_t alignment, bool cache) {
+    auto& memory_manager = system.GPU().MemoryManager();
 
     const auto& host_ptr{memory_manager.GetPointer(gpu_addr)};
     if (cache) {
         auto entry = TryGet(host_ptr);
         if (entry) {
             if (entry->GetSize() >= size && entry->GetAlignment() == alignment) {
-                return entry->GetOffset();
+                if (!entry->GetAllocation()) {
+                    // The entry might be stored in a region fenced before this draw
+                    stream_buffer.MarkUsed(entry->GetOffset(),
+                                           static_cast<GLsizeiptr>(entry->GetSize()));
+                    entry->MarkHit();
+                }
+                return {entry->GetHandle(), entry->GetOffset()};
             }
+            // The larger upload below reads guest memory, it must hold what the GPU wrote
+            FlushObject(entry);
             Unregister(entry);
+            if (!entry->GetAllocation()) {
+                stream_entries.erase(entry->GetOffset());
+            }
+        }
+
+        // Buffers invalidated while they were in device local memory are updated in place
+        if (host_ptr) {
+            if (const auto allocation =
+                    TakeEvictedAllocation(ToCacheAddr(host_ptr), size, alignment)) {
+                glNamedBufferSubData(allocation->handle, allocation->offset,
+                                     static_cast<GLsizeiptr>(size), host_ptr);
+                auto entry = std::make_shared<CachedBufferEntry>(
+                    *memory_manager.GpuToCpuAddress(gpu_addr), size, allocation->handle,
+                    allocation->offset, alignment, host_ptr);
+                entry->SetAllocation(*allocation);
+                Register(entry);
+                return {allocation->handle, allocation->offset};
+            }
         }
     }
 
@@ -44,7 +153,11 @@ GLintptr OGLBufferCache::UploadMemory(GPUVAddr gpu_addr, std::size_t size, std::
     const GLintptr uploaded_offset = buffer_offset;
 
     if (!host_ptr) {
-        return uploaded_offset;
+        return {stream_buffer.GetHandle(), uploaded_offset};
+    }
+
+    if (has_gpu_written_entries) {
+        FlushRegion(ToCacheAddr(host_ptr), size);
     }
 
     std::memcpy(buffer_ptr, host_ptr, size);
@@ -53,11 +166,13 @@ GLintptr OGLBufferCache::UploadMemory(GPUVAddr gpu_addr, std::size_t size, std::
 
     if (cache) {
         auto entry = std::make_shared<CachedBufferEntry>(
-            *memory_manager.GpuToCpuAddress(gpu_addr), size, uploaded_offset, alignment, host_ptr);
+            *memory_manager.GpuToCpuAddress(gpu_addr), size, stream_buffer.GetHandle(),
+            uploaded_offset, alignment, host_ptr);
         Register(entry);
+        stream_entries.insert_or_assign(uploaded_offset, std::move(entry));
     }
 
-    return uploaded_offset;
+    return {stream_buffer.GetHandle(), uploaded_offset};
 }
 
 GLintptr OGLBufferCache::UploadHostMemory(const void* raw_pointer, std::size_t size,
@@ -71,6 +186,56 @@ GLintptr OGLBufferCache::UploadHostMemory(const void* raw_pointer, std::size_t s
     return uploaded_offset;
 }
 
+std::tuple<GLuint, GLintptr> OGLBufferCache::GetTransformFeedbackBuffer(GPUVAddr gpu_addr,
+                                                                        std::size_t size) {
+    // Vertex buffers use the default alignment, so the entry can be reused by them
+    constexpr std::size_t alignment = 4;
+    auto& memory_manager = system.GPU().MemoryManager();
+    u8* const host_ptr = memory_manager.GetPointer(gpu_addr);
+    if (!host_ptr || size == 0) {
+        return {};
+    }
+    const CacheAddr cache_addr = ToCacheAddr(host_ptr);
+    has_gpu_written_entries = true;
+
+    if (const auto entry = TryGet(host_ptr); entry && entry->GetAllocation() &&
+                                             entry->GetSize() >= size &&
+                                             entry->GetAlignment() == alignment) {
+        entry->MarkAsModified(true, *this);
+        return {entry->GetHandle(), entry->GetOffset()};
+    }
+
+    // Other entries overlapping the range would go stale once the GPU writes it
+    for (const auto& object : GetSortedObjectsFromRegion(cache_addr, size)) {
+        FlushObject(object);
+        Unregister(object);
+        if (!object->GetAllocation()) {
+            stream_entries.erase(object->GetOffset());
+        }
+    }
+
+    auto allocation = TakeEvictedAllocation(cache_addr, size, alignment);
+    if (!allocation) {
+        allocation = AllocateDevice(size);
+    }
+    if (!allocation) {
+        LOG_ERROR(Render_OpenGL, "Out of device memory for a transform feedback buffer of {} bytes",
+                  size);
+        return {};
+    }
+
+    // Transform feedback might not write the whole range, start from the guest contents
+    glNamedBufferSubData(allocation->handle, allocation->offset, static_cast<GLsizeiptr>(size),
+                         host_ptr);
+    auto entry = std::make_shared<CachedBufferEntry>(*memory_manager.GpuToCpuAddress(gpu_addr),
+                                                     size, allocation->handle, allocation->offset,
+                                                     alignment, host_ptr);
+    entry->SetAllocation(*allocation);
+    Register(entry);
+    entry->MarkAsModified(true, *this);
+    return {allocation->handle, allocation->offset};
+}
+
 std::tuple<u8*, GLintptr> OGLBufferCache::ReserveMemory(std::size_t size, std::size_t alignment) {
     AlignBuffer(alignment);
     u8* const uploaded_ptr = buffer_ptr;
@@ -81,6 +246,26 @@ std::tuple<u8*, GLintptr> OGLBufferCache::ReserveMemory(std::size_t size, std::s
     return std::make_tuple(uploaded_ptr, uploaded_offset);
 }
 
+bool OGLBufferCache::InlineMemory(CacheAddr addr, const u8* data, std::size_t size) {
+    std::lock_guard lock{mutex};
+
+    const auto entries = GetSortedObjectsFromRegion(addr, size);
+    const auto in_stream = [](const auto& entry) { return !entry->GetAllocation(); };
+    if (entries.empty() || std::any_of(entries.begin(), entries.end(), in_stream)) {
+        // Stream buffer ranges may still be read by draws in flight, they can't be updated
+        return false;
+    }
+    for (const auto& entry : entries) {
+        const CacheAddr begin = std::max(addr, entry->GetCacheAddr());
+        const CacheAddr end = std::min(addr + size, entry->GetCacheAddr() + entry->GetSize());
+        glNamedBufferSubData(entry->GetHandle(),
+                             entry->GetOffset() +
+                                 static_cast<GLintptr>(begin - entry->GetCacheAddr()),
+                             static_cast<GLsizeiptr>(end - begin), data + (begin - addr));
+    }
+    return true;
+}
+
 bool OGLBufferCache::Map(std::size_t max_size) {
     bool invalidate;
     std::tie(buffer_ptr, buffer_offset_base, invalidate) =
@@ -88,7 +273,9 @@ bool OGLBufferCache::Map(std::size_t max_size) {
     buffer_offset = buffer_offset_base;
 
     if (invalidate) {
-        InvalidateAll();
+        // Only the entries stored in the reused part of the stream buffer are lost
+        const auto [begin, end] = stream_buffer.GetInvalidatedRange();
+        InvalidateStreamRange(begin, end);
     }
     return invalidate;
 }
@@ -101,6 +288,95 @@ GLuint OGLBufferCache::GetHandle() const {
     return stream_buffer.GetHandle();
 }
 
+void OGLBufferCache::InvalidateStreamRange(GLintptr begin, GLintptr end) {
+    auto it = stream_entries.lower_bound(begin);
+    if (it != stream_entries.begin()) {
+        // The previous entry might end inside the range
+        const auto& [offset, entry] = *std::prev(it);
+        if (offset + static_cast<GLintptr>(entry->GetSize()) > begin) {
+            --it;
+        }
+    }
+    while (it != stream_entries.end() && it->first < end) {
+        const auto& entry = it->second;
+        if (entry->IsRegistered()) {
+            // Buffers reused by later draws are likely static, keep them out of the stream
+            const bool promoted = entry->GetHits() > 0 && Promote(*entry);
+            if (!promoted) {
+                Unregister(entry);
+            }
+        }
+        it = stream_entries.erase(it);
+    }
+}
+
+bool OGLBufferCache::Promote(CachedBufferEntry& entry) {
+    const std::size_t size = entry.GetSize();
+    const std::size_t alignment = entry.GetAlignment();
+    auto allocation = TakeEvictedAllocation(entry.GetCacheAddr(), size, alignment);
+    if (!allocation) {
+        // Buddy chunks are aligned to their size
+        allocation = AllocateDevice(std::max(size, alignment));
+    }
+    if (!allocation) {
+        return false;
+    }
+
+    // The stream range is about to be overwritten by the CPU before a GPU copy could run, so the
+    // buffer is uploaded again from guest memory. It hasn't changed since it's still registered.
+    glNamedBufferSubData(allocation->handle, allocation->offset, static_cast<GLsizeiptr>(size),
+                         entry.GetHostPtr());
+    entry.SetAllocation(*allocation);
+    return true;
+}
+
+std::optional<DeviceBufferHeap::Allocation> OGLBufferCache::TakeEvictedAllocation(
+    CacheAddr addr, std::size_t size, std::size_t alignment) {
+    const auto it = evicted_allocations.find(addr);
+    if (it == evicted_allocations.end()) {
+        return {};
+    }
+    const DeviceBufferHeap::Allocation allocation = it->second;
+    evicted_allocations.erase(it);
+
+    if (DeviceBufferHeap::GetAllocationSize(allocation) >= size &&
+        allocation.offset % static_cast<GLintptr>(alignment) == 0) {
+        return allocation;
+    }
+    device_heap.Free(allocation);
+    return {};
+}
+
+std::optional<DeviceBufferHeap::Allocation> OGLBufferCache::AllocateDevice(std::size_t size) {
+    if (const auto allocation = device_heap.Allocate(size)) {
+        return allocation;
+    }
+    for (const auto& [addr, allocation] : evicted_allocations) {
+        device_heap.Free(allocation);
+    }
+    evicted_allocations.clear();
+    return device_heap.Allocate(size);
+}
+
+void OGLBufferCache::FlushObjectInner(const std::shared_ptr<CachedBufferEntry>& object) {
+    glGetNamedBufferSubData(object->GetHandle(), object->GetOffset(),
+                            static_cast<GLsizeiptr>(object->GetSize()),
+                            object->GetWritableHostPtr());
+}
+
+void OGLBufferCache::Unregister(const std::shared_ptr<CachedBufferEntry>& object) {
+    if (const auto& allocation = object->GetAllocation()) {
+        const auto [it, is_new] =
+            evicted_allocations.try_emplace(object->GetCacheAddr(), *allocation);
+        if (!is_new) {
+            device_heap.Free(it->second);
+            it->second = *allocation;
+        }
+    }
+    ++invalidation_tick;
+    RasterizerCache::Unregister(object);
+}
+
 void OGLBufferCache::AlignBuffer(std::size_t alignment) {
     // Align the offset, not the mapped pointer
     const GLintptr offset_aligned =
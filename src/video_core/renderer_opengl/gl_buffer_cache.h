@@ -4,22 +4,79 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
 
+namespace Core {
+class System;
+}
+
 namespace OpenGL {
 
 class RasterizerOpenGL;
 
+/**
+ * Buddy allocator of device local buffer memory. Memory is sub-allocated from large blocks that
+ * are only updated with glNamedBufferSubData, so the driver is free to keep them in VRAM.
+ */
+class DeviceBufferHeap final {
+public:
+    struct Allocation {
+        GLuint handle{};
+        GLintptr offset{};
+        std::size_t block{};
+        u32 order{};
+    };
+
+    DeviceBufferHeap();
+    ~DeviceBufferHeap();
+
+    /// Allocates at least "size" bytes aligned to their power of two size, at least 256 bytes.
+    /// Returns an empty optional when the heap is exhausted.
+    std::optional<Allocation> Allocate(std::size_t size);
+
+    /// Returns an allocation to the heap, merging it with its free buddies.
+    void Free(const Allocation& allocation);
+
+    /// Returns the size reserved by an allocation
+    static std::size_t GetAllocationSize(const Allocation& allocation) {
+        return std::size_t{1} << allocation.order;
+    }
+
+private:
+    static constexpr u32 MinOrder = 8;
+    static constexpr u32 MaxOrder = 25;
+    static constexpr std::size_t MaxBlocks = 8;
+
+    struct Block {
+        OGLBuffer buffer;
+        /// Offsets of the free chunks of each order
+        std::array<std::set<GLintptr>, MaxOrder - MinOrder + 1> free_chunks;
+    };
+
+    std::optional<GLintptr> AllocateFromBlock(Block& block, u32 order);
+
+    std::vector<Block> blocks;
+    Common::MemoryAccounting::Allocation accounting{
+        Common::MemoryAccounting::Category::BufferCache};
+};
+
 class CachedBufferEntry final : public RasterizerCacheObject {
 public:
-    explicit CachedBufferEntry(VAddr cpu_addr, std::size_t size, GLintptr offset,
+    explicit CachedBufferEntry(VAddr cpu_addr, std::size_t size, GLuint handle, GLintptr offset,
                                std::size_t alignment, u8* host_ptr);
 
     VAddr GetCpuAddr() const override {
@@ -34,49 +91,142 @@ public:
         return size;
     }
 
+    GLuint GetHandle() const {
+        return handle;
+    }
+
     GLintptr GetOffset() const {
         return offset;
     }
 
+    u8* GetWritableHostPtr() const {
+        return host_ptr;
+    }
+
     std::size_t GetAlignment() const {
         return alignment;
     }
 
+    /// Returns the number of draws that reused the entry while it was in the stream buffer
+    u32 GetHits() const {
+        return hits;
+    }
+
+    void MarkHit() {
+        ++hits;
+    }
+
+    /// Returns the device local allocation holding the entry, if it has been promoted
+    const std::optional<DeviceBufferHeap::Allocation>& GetAllocation() const {
+        return allocation;
+    }
+
+    /// Moves the entry out of the stream buffer into a device local allocation
+    void SetAllocation(const DeviceBufferHeap::Allocation& new_allocation) {
+        allocation = new_allocation;
+        handle = new_allocation.handle;
+        offset = new_allocation.offset;
+    }
+
 private:
     VAddr cpu_addr{};
     std::size_t size{};
+    GLuint handle{};
     GLintptr offset{};
     std::size_t alignment{};
+    u32 hits{};
+    std::optional<DeviceBufferHeap::Allocation> allocation;
+    u8* host_ptr{};
 };
 
 class OGLBufferCache final : public RasterizerCache<std::shared_ptr<CachedBufferEntry>> {
 public:
-    explicit OGLBufferCache(RasterizerOpenGL& rasterizer, std::size_t size);
+    explicit OGLBufferCache(RasterizerOpenGL& rasterizer, Core::System& system, std::size_t size);
 
-    /// Uploads data from a guest GPU address. Returns host's buffer offset where it's been
-    /// allocated.
-    GLintptr UploadMemory(GPUVAddr gpu_addr, std::size_t size, std::size_t alignment = 4,
-                          bool cache = true);
+    /// Uploads data from a guest GPU address. Returns the host's buffer and offset where it's
+    /// been allocated.
+    std::tuple<GLuint, GLintptr> UploadMemory(GPUVAddr gpu_addr, std::size_t size,
+                                              std::size_t alignment = 4, bool cache = true);
+
+    /// Uploads a constant buffer from a guest GPU address. Unlike UploadMemory, small buffers are
+    /// cached too, as draws keep reading the same constant buffers until the guest writes them.
+    std::tuple<GLuint, GLintptr> UploadConstBuffer(GPUVAddr gpu_addr, std::size_t size,
+                                                   std::size_t alignment);
 
     /// Uploads from a host memory. Returns host's buffer offset where it's been allocated.
     GLintptr UploadHostMemory(const void* raw_pointer, std::size_t size, std::size_t alignment = 4);
 
+    /// Returns a device local buffer holding a range of guest memory written by transform
+    /// feedback. Draws reading the range use the buffer directly, and it is flushed to guest memory
+    /// when the CPU reads it. Returns a zero handle when the range can't be cached.
+    std::tuple<GLuint, GLintptr> GetTransformFeedbackBuffer(GPUVAddr gpu_addr, std::size_t size);
+
     /// Reserves memory to be used by host's CPU. Returns mapped address and offset.
     std::tuple<u8*, GLintptr> ReserveMemory(std::size_t size, std::size_t alignment = 4);
 
+    /// Writes inline data to the device local entries overlapping a range of guest memory.
+    /// Returns false without writing anything when no entry or a stream buffer entry overlaps it.
+    bool InlineMemory(CacheAddr addr, const u8* data, std::size_t size);
+
     bool Map(std::size_t max_size);
     void Unmap();
 
     GLuint GetHandle() const;
 
+    /// Returns a counter incremented whenever a cached entry is unregistered. Buffers returned by
+    /// UploadMemory outside of the stream buffer hold the guest data while it doesn't change.
+    u64 GetInvalidationTick() const {
+        return invalidation_tick;
+    }
+
 protected:
     void AlignBuffer(std::size_t alignment);
 
-    // We do not have to flush this cache as things in it are never modified by us.
-    void FlushObjectInner(const std::shared_ptr<CachedBufferEntry>& object) override {}
+    /// Downloads an entry written by transform feedback to guest memory
+    void FlushObjectInner(const std::shared_ptr<CachedBufferEntry>& object) override;
+
+    /// Keeps the device local allocation of the unregistered entry for its next upload
+    void Unregister(const std::shared_ptr<CachedBufferEntry>& object) override;
 
 private:
+    /// Uploads data from a guest GPU address, caching it when cache is true
+    std::tuple<GLuint, GLintptr> Upload(GPUVAddr gpu_addr, std::size_t size,
+                                        std::size_t alignment, bool cache);
+
+    /// Unregisters the cached entries stored in the given range of the stream buffer. Entries
+    /// reused since they were uploaded are promoted to device local memory instead.
+    void InvalidateStreamRange(GLintptr begin, GLintptr end);
+
+    /// Moves a cached entry from the stream buffer to device local memory
+    bool Promote(CachedBufferEntry& entry);
+
+    /// Takes the allocation left by an invalidated device local entry at the given address if
+    /// it can hold the buffer, freeing it otherwise
+    std::optional<DeviceBufferHeap::Allocation> TakeEvictedAllocation(CacheAddr addr,
+                                                                       std::size_t size,
+                                                                       std::size_t alignment);
+
+    /// Allocates device local memory, releasing the evicted allocations when the heap is full
+    std::optional<DeviceBufferHeap::Allocation> AllocateDevice(std::size_t size);
+
+    Core::System& system;
+
     OGLStreamBuffer stream_buffer;
+    Common::MemoryAccounting::Allocation stream_buffer_accounting;
+    DeviceBufferHeap device_heap;
+
+    /// Cached entries indexed by their offset in the stream buffer. Entries that are no longer
+    /// registered are dropped when their range of the stream buffer is reused.
+    std::map<GLintptr, std::shared_ptr<CachedBufferEntry>> stream_entries;
+
+    u64 invalidation_tick = 0;
+
+    /// True once an entry has been written by the GPU, uploads check for them from then on
+    bool has_gpu_written_entries = false;
+
+    /// Allocations of device local entries invalidated by guest writes, indexed by their cache
+    /// address. The next upload of the same buffer updates them in place.
+    std::unordered_map<CacheAddr, DeviceBufferHeap::Allocation> evicted_allocations;
 
     u8* buffer_ptr = nullptr;
     GLintptr buffer_offset = 0;
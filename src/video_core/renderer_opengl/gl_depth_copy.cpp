@@ -0,0 +1,119 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "video_core/renderer_opengl/gl_depth_copy.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/surface.h"
+
+namespace OpenGL {
+
+using VideoCore::Surface::GetDefaultBlockWidth;
+using VideoCore::Surface::GetFormatBpp;
+
+namespace {
+
+constexpr u32 WorkGroupSize = 8;
+
+// Depth values are written with the bit pattern they have in guest memory, so a format that
+// aliases the same memory reads the same texels.
+constexpr char copy_shader[] = R"(
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (binding = 0) uniform sampler2D depth_texture;
+layout (binding = 0, COLOR_FORMAT) uniform writeonly uimage2D color_image;
+
+layout (location = 0) uniform uvec2 size;
+layout (location = 1) uniform int level;
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (pos.x >= int(size.x) || pos.y >= int(size.y)) {
+        return;
+    }
+    float depth = texelFetch(depth_texture, pos, level).r;
+    imageStore(color_image, pos, uvec4(ENCODE_DEPTH(depth)));
+}
+)";
+
+OGLProgram BuildProgram(const char* color_format, const char* encode) {
+    const std::string source = std::string("#version 430 core\n#define COLOR_FORMAT ") +
+                               color_format + "\n#define ENCODE_DEPTH(depth) " + encode + '\n' +
+                               copy_shader;
+    OGLShader shader;
+    shader.Create(source.c_str(), GL_COMPUTE_SHADER);
+    OGLProgram program;
+    program.Create(false, false, shader.handle);
+    return program;
+}
+
+} // Anonymous namespace
+
+DepthToColorCopy::DepthToColorCopy()
+    : depth32_program{BuildProgram("r32ui", "floatBitsToUint(depth)")},
+      depth16_program{BuildProgram("r16ui", "uint(depth * 65535.0 + 0.5)")} {}
+
+DepthToColorCopy::~DepthToColorCopy() = default;
+
+bool DepthToColorCopy::IsCompatible(const SurfaceParams& src_params,
+                                    const SurfaceParams& dst_params) {
+    if (src_params.type != SurfaceType::Depth || dst_params.type != SurfaceType::ColorTexture) {
+        // Stencil can't be sampled together with depth, those formats take the slow path
+        return false;
+    }
+    if (src_params.target != SurfaceTarget::Texture2D ||
+        dst_params.target != SurfaceTarget::Texture2D) {
+        return false;
+    }
+    const bool is_supported_format = (src_params.pixel_format == PixelFormat::Z32F ||
+                                      src_params.pixel_format == PixelFormat::Z16);
+    return is_supported_format && GetDefaultBlockWidth(dst_params.pixel_format) == 1 &&
+           GetFormatBpp(src_params.pixel_format) == GetFormatBpp(dst_params.pixel_format);
+}
+
+void DepthToColorCopy::Copy(const CachedSurface& src_surface, const CachedSurface& dst_surface) {
+    const auto& src_params = src_surface.GetSurfaceParams();
+    const auto& dst_params = dst_surface.GetSurfaceParams();
+    const bool is_depth32 = src_params.pixel_format == PixelFormat::Z32F;
+    const GLuint program = is_depth32 ? depth32_program.handle : depth16_program.handle;
+    const GLenum image_format = is_depth32 ? GL_R32UI : GL_R16UI;
+
+    OpenGLState state = OpenGLState::GetCurState();
+    const OpenGLState previous_state = state;
+    state.draw.shader_program = program;
+    state.texture_units[0].texture = src_surface.Texture().handle;
+    state.texture_units[0].sampler = 0;
+    state.ApplyShaderProgram();
+    state.ApplyTextures();
+    state.ApplySamplers();
+
+    // Sizes are clamped to the smaller surface like the other copies do
+    const u32 levels = std::min(src_params.max_mip_level, dst_params.max_mip_level);
+    for (u32 level = 0; level < levels; ++level) {
+        const u32 width = std::min(src_params.MipWidth(level), dst_params.MipWidth(level));
+        const u32 height = std::min(src_params.MipHeight(level), dst_params.MipHeight(level));
+        glProgramUniform2ui(program, 0, width, height);
+        glProgramUniform1i(program, 1, static_cast<GLint>(level));
+        glBindImageTexture(0, dst_surface.Texture().handle, static_cast<GLint>(level), GL_FALSE, 0,
+                           GL_WRITE_ONLY, image_format);
+        glDispatchCompute((width + WorkGroupSize - 1) / WorkGroupSize,
+                          (height + WorkGroupSize - 1) / WorkGroupSize, 1);
+    }
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, image_format);
+
+    // The color surface can be sampled, rendered to or read back right after the copy
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT |
+                    GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    previous_state.ApplyShaderProgram();
+    previous_state.ApplyTextures();
+    previous_state.ApplySamplers();
+}
+
+} // namespace OpenGL
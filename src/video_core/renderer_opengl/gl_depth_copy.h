@@ -0,0 +1,34 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class CachedSurface;
+struct SurfaceParams;
+
+/**
+ * Reinterprets the contents of depth surfaces as color with a compute shader. Depth texels can't
+ * be aliased by color views, this avoids reading them back to a pixel buffer instead.
+ */
+class DepthToColorCopy final {
+public:
+    DepthToColorCopy();
+    ~DepthToColorCopy();
+
+    /// Returns true if the depth surface can be copied to the color surface with a dispatch
+    static bool IsCompatible(const SurfaceParams& src_params, const SurfaceParams& dst_params);
+
+    /// Copies the texels of the depth surface bit by bit to the color surface
+    void Copy(const CachedSurface& src_surface, const CachedSurface& dst_surface);
+
+private:
+    OGLProgram depth32_program;
+    OGLProgram depth16_program;
+};
+
+} // namespace OpenGL
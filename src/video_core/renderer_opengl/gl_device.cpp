@@ -21,16 +21,26 @@ T GetInteger(GLenum pname) {
 
 Device::Device() {
     uniform_buffer_alignment = GetInteger<std::size_t>(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT);
+    shader_storage_buffer_alignment =
+        GetInteger<std::size_t>(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT);
     max_vertex_attributes = GetInteger<u32>(GL_MAX_VERTEX_ATTRIBS);
     max_varyings = GetInteger<u32>(GL_MAX_VARYING_VECTORS);
     has_variable_aoffi = TestVariableAoffi();
+    has_astc = GLAD_GL_KHR_texture_compression_astc_ldr;
+    has_sparse_texture = GLAD_GL_ARB_sparse_texture && GLAD_GL_ARB_sparse_texture2 &&
+                         GLAD_GL_EXT_direct_state_access;
+    has_texture_barrier = GLAD_GL_ARB_texture_barrier;
 }
 
 Device::Device(std::nullptr_t) {
     uniform_buffer_alignment = 0;
+    shader_storage_buffer_alignment = 0;
     max_vertex_attributes = 16;
     max_varyings = 15;
     has_variable_aoffi = true;
+    has_astc = false;
+    has_sparse_texture = false;
+    has_texture_barrier = false;
 }
 
 bool Device::TestVariableAoffi() {
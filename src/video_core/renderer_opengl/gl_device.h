@@ -18,6 +18,10 @@ public:
         return uniform_buffer_alignment;
     }
 
+    std::size_t GetShaderStorageBufferAlignment() const {
+        return shader_storage_buffer_alignment;
+    }
+
     u32 GetMaxVertexAttributes() const {
         return max_vertex_attributes;
     }
@@ -30,13 +34,32 @@ public:
         return has_variable_aoffi;
     }
 
+    bool HasASTC() const {
+        return has_astc;
+    }
+
+    /// Returns true when textures can be allocated without committing their memory and reads of
+    /// the uncommitted regions return zeros
+    bool HasSparseTexture() const {
+        return has_sparse_texture;
+    }
+
+    /// Returns true when draws can sample the textures they render to after a texture barrier
+    bool HasTextureBarrier() const {
+        return has_texture_barrier;
+    }
+
 private:
     static bool TestVariableAoffi();
 
     std::size_t uniform_buffer_alignment{};
+    std::size_t shader_storage_buffer_alignment{};
     u32 max_vertex_attributes{};
     u32 max_varyings{};
     bool has_variable_aoffi{};
+    bool has_astc{};
+    bool has_sparse_texture{};
+    bool has_texture_barrier{};
 };
 
 } // namespace OpenGL
@@ -0,0 +1,208 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <ctime>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/assert.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/zstd_compression.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "video_core/renderer_opengl/gl_frame_capture.h"
+
+namespace OpenGL {
+
+MICROPROFILE_DEFINE(OpenGL_FrameCapture, "OpenGL", "Frame Capture", MP_RGB(128, 192, 192));
+
+/// Bytes per pixel of the captured frames
+constexpr std::size_t CAPTURE_BPP = 4;
+
+FrameCapture::FrameCapture(std::size_t num_slots)
+    : slots(num_slots), max_busy_count{num_slots * 2}, worker{&FrameCapture::WorkerLoop, this} {}
+
+FrameCapture::~FrameCapture() {
+    // Reads still in flight are dropped, the frames already handed to the worker are consumed
+    {
+        std::scoped_lock lock{mutex};
+        stop_worker = true;
+    }
+    job_condition.notify_all();
+    worker.join();
+}
+
+bool FrameCapture::ReadFramebuffer(u32 width, u32 height, Consumer consumer) {
+    Slot* const slot = ReserveSlot(width, height);
+    if (!slot) {
+        return false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer.handle);
+    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_BGRA,
+                 GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    Submit(*slot, width, height, std::move(consumer));
+    return true;
+}
+
+bool FrameCapture::ReadTexture(GLuint texture, u32 width, u32 height, Consumer consumer) {
+    Slot* const slot = ReserveSlot(width, height);
+    if (!slot) {
+        return false;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer.handle);
+    glGetTextureImage(texture, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                      static_cast<GLsizei>(slot->buffer_size), nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    Submit(*slot, width, height, std::move(consumer));
+    return true;
+}
+
+void FrameCapture::Poll() {
+    MICROPROFILE_SCOPE(OpenGL_FrameCapture);
+    while (!pending_slots.empty()) {
+        Slot& slot = *pending_slots.front();
+        // Reads complete in order, stop at the first one that is still in flight
+        const GLenum status = glClientWaitSync(slot.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return;
+        }
+        slot.fence.Release();
+        pending_slots.pop_front();
+
+        // The data is resident by now, copying it out does not wait for the GPU
+        std::vector<u8> pixels(slot.width * slot.height * CAPTURE_BPP);
+        glGetNamedBufferSubData(slot.buffer.handle, 0, static_cast<GLsizeiptr>(pixels.size()),
+                                pixels.data());
+        {
+            std::scoped_lock lock{mutex};
+            jobs.push_back([this, consumer = std::move(slot.consumer), pixels = std::move(pixels),
+                            width = slot.width, height = slot.height]() mutable {
+                consumer(std::move(pixels), width, height);
+                --busy_count;
+            });
+        }
+        slot.consumer = nullptr;
+        job_condition.notify_one();
+    }
+}
+
+FrameCapture::Slot* FrameCapture::ReserveSlot(u32 width, u32 height) {
+    if (busy_count >= max_busy_count) {
+        return nullptr;
+    }
+    const auto it = std::find_if(slots.begin(), slots.end(),
+                                 [](const Slot& slot) { return !slot.consumer; });
+    if (it == slots.end()) {
+        return nullptr;
+    }
+    const std::size_t size = width * height * CAPTURE_BPP;
+    if (it->buffer_size < size) {
+        it->buffer.Release();
+        it->buffer.Create();
+        glNamedBufferData(it->buffer.handle, static_cast<GLsizeiptr>(size), nullptr,
+                          GL_STREAM_READ);
+        it->buffer_size = size;
+    }
+    return &*it;
+}
+
+void FrameCapture::Submit(Slot& slot, u32 width, u32 height, Consumer consumer) {
+    ASSERT(consumer);
+    slot.fence.Create();
+    slot.width = width;
+    slot.height = height;
+    slot.consumer = std::move(consumer);
+    pending_slots.push_back(&slot);
+    ++busy_count;
+}
+
+void FrameCapture::WorkerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock{mutex};
+            job_condition.wait(lock, [this] { return stop_worker || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+FrameRecorder::FrameRecorder(Core::System& system, u32 compression_level)
+    : system{system}, compression_level{compression_level}, capture{3} {}
+
+FrameRecorder::~FrameRecorder() {
+    if (num_frames == 0) {
+        return;
+    }
+    LOG_INFO(Render_OpenGL, "Recorded {} frames to path={}, {} were dropped", num_frames,
+             path, num_dropped_frames);
+}
+
+void FrameRecorder::Record(GLuint texture) {
+    capture.Poll();
+
+    if (path.empty()) {
+        // The process is not available when the renderer is created
+        const std::string dir{FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) + "frames" +
+                              DIR_SEP};
+        path = fmt::format("{}{:016X}_{}.frames", dir, system.CurrentProcess()->GetTitleID(),
+                           std::time(nullptr));
+    }
+
+    GLint width, height;
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+
+    const u64 frame = num_frames++;
+    const bool is_read = capture.ReadTexture(
+        texture, static_cast<u32>(width), static_cast<u32>(height),
+        [this, frame](std::vector<u8> pixels, u32 width, u32 height) {
+            WriteFrame(frame, std::move(pixels), width, height);
+        });
+    if (!is_read) {
+        // Writing to the disk can't keep up, skip the frame instead of stalling the GPU thread
+        ++num_dropped_frames;
+    }
+}
+
+void FrameRecorder::WriteFrame(u64 frame, std::vector<u8> pixels, u32 width, u32 height) {
+    if (!file) {
+        file = std::make_unique<FileUtil::IOFile>();
+        if (!FileUtil::CreateFullPath(path) || !file->Open(path, "wb")) {
+            LOG_ERROR(Render_OpenGL, "Failed to create frame recording in path={}", path);
+            return;
+        }
+        FileHeader header;
+        header.compression_level = compression_level;
+        file->WriteObject(header);
+    }
+    if (!file->IsOpen()) {
+        return;
+    }
+
+    if (compression_level != 0) {
+        pixels = Common::Compression::CompressDataZSTD(pixels.data(), pixels.size(),
+                                                       static_cast<s32>(compression_level));
+    }
+    const FrameHeader header{frame, width, height, pixels.size()};
+    const bool is_written = file->WriteObject(header) == 1 &&
+                            file->WriteBytes(pixels.data(), pixels.size()) == pixels.size();
+    if (!is_written) {
+        LOG_ERROR(Render_OpenGL, "Failed to write frame {} to path={}", frame, path);
+        file->Close();
+    }
+}
+
+} // namespace OpenGL
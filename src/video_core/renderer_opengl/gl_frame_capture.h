@@ -0,0 +1,138 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core {
+class System;
+}
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace OpenGL {
+
+/**
+ * Reads frames back without stalling the thread that renders them. The pixels are written into a
+ * pixel buffer, copied out once its fence has signaled a few frames later and handed to a worker
+ * thread. Reads and polls have to come from a single thread with a context current.
+ */
+class FrameCapture final {
+public:
+    /// Receives the BGRA8 pixels of a frame, rows from the bottom up, on the worker thread
+    using Consumer = std::function<void(std::vector<u8> pixels, u32 width, u32 height)>;
+
+    explicit FrameCapture(std::size_t num_slots);
+    ~FrameCapture();
+
+    /**
+     * Reads the bound read framebuffer.
+     * @returns False when too many frames are in flight, the frame is dropped then.
+     */
+    bool ReadFramebuffer(u32 width, u32 height, Consumer consumer);
+
+    /// Reads the first level of a texture, dropping the frame like ReadFramebuffer
+    bool ReadTexture(GLuint texture, u32 width, u32 height, Consumer consumer);
+
+    /// Hands the frames whose pixels have arrived to the worker thread
+    void Poll();
+
+    /// Returns true while a read has not reached its consumer
+    bool IsBusy() const {
+        return busy_count != 0;
+    }
+
+private:
+    struct Slot {
+        OGLBuffer buffer;
+        std::size_t buffer_size = 0;
+        OGLSync fence;
+        u32 width = 0;
+        u32 height = 0;
+        Consumer consumer; ///< Set while the read is in flight
+    };
+
+    /// Returns a slot without a read in flight that fits the frame, or null if there is none
+    Slot* ReserveSlot(u32 width, u32 height);
+
+    void Submit(Slot& slot, u32 width, u32 height, Consumer consumer);
+
+    void WorkerLoop();
+
+    std::vector<Slot> slots;
+    std::deque<Slot*> pending_slots; ///< Reads in flight, in submission order
+
+    /// Frames read but not consumed yet, bounded so a slow consumer can't pile them up
+    std::atomic<std::size_t> busy_count{};
+    const std::size_t max_busy_count;
+
+    std::mutex mutex;
+    std::condition_variable job_condition;
+    std::deque<std::function<void()>> jobs;
+    bool stop_worker = false;
+    std::thread worker;
+};
+
+/**
+ * Records the presented frames into a file in the dump directory, to capture benchmark runs
+ * without perturbing their frame times. The file starts with a FileHeader, every frame is a
+ * FrameHeader followed by its BGRA8 pixels with rows from the bottom up. The pixels are compressed
+ * with Zstandard when a compression level is set.
+ */
+class FrameRecorder final {
+public:
+    explicit FrameRecorder(Core::System& system, u32 compression_level);
+    ~FrameRecorder();
+
+    /// Queues the read of the displayed texture, called once per presented frame
+    void Record(GLuint texture);
+
+private:
+    struct FileHeader {
+        std::array<char, 4> magic{'Y', 'F', 'R', 'M'};
+        u32 version = 1;
+        u32 compression_level = 0; ///< Zero when the pixels are stored raw
+    };
+
+    struct FrameHeader {
+        u64 frame; ///< Index of the frame since the start of the recording
+        u32 width;
+        u32 height;
+        u64 size; ///< Size of the data following the header
+    };
+
+    /// Writes a frame to the file, runs on the worker thread of the capture
+    void WriteFrame(u64 frame, std::vector<u8> pixels, u32 width, u32 height);
+
+    Core::System& system;
+    const u32 compression_level;
+
+    std::string path;
+    std::unique_ptr<FileUtil::IOFile> file;
+    u64 num_frames = 0;
+    u64 num_dropped_frames = 0;
+
+    /// Destroyed first, so the frames it still holds are written before the file is closed
+    FrameCapture capture;
+};
+
+} // namespace OpenGL
@@ -0,0 +1,121 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+#include "video_core/renderer_opengl/gl_framebuffer_cache.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_state.h"
+
+namespace OpenGL {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+std::size_t FramebufferCacheKey::Hash() const {
+    std::size_t hash = 0;
+    boost::hash_combine(hash, is_single_buffer);
+    boost::hash_combine(hash, stencil_enable);
+    boost::hash_combine(hash, colors_count);
+    boost::hash_combine(hash, zeta);
+    for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
+        boost::hash_combine(hash, color_attachments[index]);
+        boost::hash_combine(hash, colors[index]);
+    }
+    return hash;
+}
+
+bool FramebufferCacheKey::operator==(const FramebufferCacheKey& rhs) const {
+    return Tie() == rhs.Tie();
+}
+
+FramebufferCacheOpenGL::FramebufferCacheOpenGL() = default;
+
+FramebufferCacheOpenGL::~FramebufferCacheOpenGL() = default;
+
+void FramebufferCacheOpenGL::Bind(const FramebufferCacheKey& key,
+                                  const ColorSurfaces& color_surfaces,
+                                  const Surface& depth_surface, OpenGLState& current_state) {
+    const auto [it, is_cache_miss] = cache.try_emplace(key);
+    Entry& entry = it->second;
+    if (is_cache_miss) {
+        entry.lru_position = lru.insert(lru.begin(), key);
+    } else {
+        lru.splice(lru.begin(), lru, entry.lru_position);
+        if (!entry.IsStale()) {
+            current_state.draw.draw_framebuffer = entry.framebuffer.handle;
+            current_state.ApplyFramebufferState();
+            return;
+        }
+        // The textures were replaced and their handles reused, the framebuffer can't be trusted
+        entry.framebuffer.Release();
+    }
+
+    entry.surfaces.clear();
+    for (const Surface& surface : color_surfaces) {
+        if (surface) {
+            entry.surfaces.push_back({surface, surface->Texture().handle});
+        }
+    }
+    if (depth_surface) {
+        entry.surfaces.push_back({depth_surface, depth_surface->Texture().handle});
+    }
+
+    entry.framebuffer.Create();
+    current_state.draw.draw_framebuffer = entry.framebuffer.handle;
+    current_state.ApplyFramebufferState();
+    Attach(key);
+
+    if (cache.size() > MaxFramebuffers) {
+        Evict();
+    }
+}
+
+bool FramebufferCacheOpenGL::Entry::IsStale() const {
+    return std::any_of(surfaces.begin(), surfaces.end(), [](const Attachment& attachment) {
+        const Surface surface = attachment.surface.lock();
+        return !surface || surface->Texture().handle != attachment.texture;
+    });
+}
+
+void FramebufferCacheOpenGL::Attach(const FramebufferCacheKey& key) {
+    if (key.is_single_buffer) {
+        if (key.color_attachments[0] != GL_NONE) {
+            glFramebufferTexture(GL_DRAW_FRAMEBUFFER, key.color_attachments[0], key.colors[0], 0);
+        }
+        glDrawBuffer(key.color_attachments[0]);
+    } else {
+        for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
+            if (key.colors[index]) {
+                glFramebufferTexture(GL_DRAW_FRAMEBUFFER,
+                                     GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index),
+                                     key.colors[index], 0);
+            }
+        }
+        glDrawBuffers(key.colors_count, key.color_attachments.data());
+    }
+
+    if (key.zeta) {
+        const GLenum zeta_attachment =
+            key.stencil_enable ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        glFramebufferTexture(GL_DRAW_FRAMEBUFFER, zeta_attachment, key.zeta, 0);
+    }
+}
+
+void FramebufferCacheOpenGL::Evict() {
+    const auto erase = [this](std::list<FramebufferCacheKey>::iterator position) {
+        const auto next = std::next(position);
+        cache.erase(*position);
+        lru.erase(position);
+        return next;
+    };
+
+    for (auto position = std::next(lru.begin()); position != lru.end();) {
+        position = cache.at(*position).IsStale() ? erase(position) : std::next(position);
+    }
+    while (cache.size() > MaxFramebuffers) {
+        erase(std::prev(lru.end()));
+    }
+}
+
+} // namespace OpenGL
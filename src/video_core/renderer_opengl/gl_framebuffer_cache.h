@@ -0,0 +1,122 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class CachedSurface;
+class OpenGLState;
+
+using Surface = std::shared_ptr<CachedSurface>;
+
+struct FramebufferCacheKey {
+    bool is_single_buffer = false;
+    bool stencil_enable = false;
+
+    std::array<GLenum, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets> color_attachments{};
+    std::array<GLuint, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets> colors{};
+    u32 colors_count = 0;
+
+    GLuint zeta = 0;
+
+    std::size_t Hash() const;
+
+    bool operator==(const FramebufferCacheKey& rhs) const;
+
+    bool operator!=(const FramebufferCacheKey& rhs) const {
+        return !operator==(rhs);
+    }
+
+private:
+    auto Tie() const {
+        return std::tie(is_single_buffer, stencil_enable, color_attachments, colors, colors_count,
+                        zeta);
+    }
+};
+
+} // namespace OpenGL
+
+namespace std {
+
+template <>
+struct hash<OpenGL::FramebufferCacheKey> {
+    std::size_t operator()(const OpenGL::FramebufferCacheKey& k) const noexcept {
+        return k.Hash();
+    }
+};
+
+} // namespace std
+
+namespace OpenGL {
+
+/**
+ * Cache of framebuffer objects indexed by their attachments. The amount of cached framebuffers is
+ * bounded, the least recently used ones and the ones attaching deleted surfaces are released first.
+ */
+class FramebufferCacheOpenGL final {
+public:
+    using ColorSurfaces = std::array<Surface, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets>;
+
+    FramebufferCacheOpenGL();
+    ~FramebufferCacheOpenGL();
+
+    /**
+     * Binds a framebuffer with the given attachments as the draw framebuffer of the state.
+     * @param key Texture handles and attachment points of the framebuffer
+     * @param color_surfaces Surfaces of the textures in key.colors
+     * @param depth_surface Surface of the texture in key.zeta
+     * @param current_state State the framebuffer is bound to
+     */
+    void Bind(const FramebufferCacheKey& key, const ColorSurfaces& color_surfaces,
+              const Surface& depth_surface, OpenGLState& current_state);
+
+private:
+    /// Maximum number of framebuffers kept in the cache
+    static constexpr std::size_t MaxFramebuffers = 256;
+
+    struct Attachment {
+        std::weak_ptr<CachedSurface> surface;
+        GLuint texture = 0; ///< Texture of the surface when it was attached
+    };
+
+    struct Entry {
+        OGLFramebuffer framebuffer;
+        /// Surfaces attached to the framebuffer. When one of them is deleted or its texture is
+        /// replaced, the texture handle might be reused by a new texture that has to be attached
+        /// again.
+        std::vector<Attachment> surfaces;
+        /// Position of the entry in the LRU list
+        std::list<FramebufferCacheKey>::iterator lru_position;
+
+        bool IsStale() const;
+    };
+
+    /// Attaches the textures of the key to the framebuffer bound to the draw target
+    static void Attach(const FramebufferCacheKey& key);
+
+    /// Releases the framebuffers with deleted surfaces and, if that's not enough, the least
+    /// recently used ones. The most recently used framebuffer is always kept.
+    void Evict();
+
+    std::unordered_map<FramebufferCacheKey, Entry> cache;
+    /// Keys of the cached framebuffers, from the most to the least recently used
+    std::list<FramebufferCacheKey> lru;
+};
+
+} // namespace OpenGL
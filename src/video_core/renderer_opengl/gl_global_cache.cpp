@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <mutex>
+
 #include <glad/glad.h>
 
 #include "common/logging/log.h"
@@ -14,28 +17,89 @@
 
 namespace OpenGL {
 
-CachedGlobalRegion::CachedGlobalRegion(VAddr cpu_addr, u8* host_ptr, u32 size, u32 max_size)
-    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, host_ptr{host_ptr}, size{size},
-      max_size{max_size} {
-    buffer.Create();
-    LabelGLObject(GL_BUFFER, buffer.handle, cpu_addr, "GlobalMemory");
-}
+CachedGlobalRegion::CachedGlobalRegion(VAddr cpu_addr, u8* host_ptr)
+    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, host_ptr{host_ptr} {}
 
 CachedGlobalRegion::~CachedGlobalRegion() = default;
 
-void CachedGlobalRegion::Reload(u32 size_) {
+template <typename Func>
+void CachedGlobalRegion::ForEachPageRun(bool dirty, Func&& func) const {
+    const std::size_t num_pages = dirty_pages.size();
+    std::size_t page = 0;
+    while (page < num_pages) {
+        if (dirty_pages[page] != dirty) {
+            ++page;
+            continue;
+        }
+        const std::size_t first_page = page;
+        while (page < num_pages && dirty_pages[page] == dirty) {
+            ++page;
+        }
+        func(first_page << PAGE_BITS, std::min<std::size_t>(page << PAGE_BITS, size));
+    }
+}
+
+void CachedGlobalRegion::Resize(u32 size_, DeviceBufferHeap& heap) {
+    if (allocation) {
+        heap.Free(*allocation);
+    }
+    dedicated_buffer.Release();
+
     size = size_;
-    if (size > max_size) {
-        size = max_size;
-        LOG_CRITICAL(HW_GPU, "Global region size {} exceeded the supported size {}!", size_,
-                     max_size);
+    allocation = heap.Allocate(size);
+    if (allocation) {
+        handle = allocation->handle;
+        offset = allocation->offset;
+    } else {
+        // The region is larger than the blocks of the heap or the heap is exhausted
+        dedicated_buffer.Create();
+        glNamedBufferStorage(dedicated_buffer.handle, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        LabelGLObject(GL_BUFFER, dedicated_buffer.handle, cpu_addr, "GlobalMemory");
+        handle = dedicated_buffer.handle;
+        offset = 0;
+    }
+
+    dirty_pages.assign((size + PAGE_SIZE - 1) >> PAGE_BITS, true);
+    has_dirty_pages = true;
+}
+
+void CachedGlobalRegion::MarkPagesDirty(CacheAddr addr, u64 write_size) {
+    const CacheAddr region_begin = GetCacheAddr();
+    const CacheAddr begin = std::max(addr, region_begin);
+    const CacheAddr end = std::min(addr + write_size, region_begin + size);
+    if (begin >= end) {
+        return;
+    }
+    const std::size_t first_page = (begin - region_begin) >> PAGE_BITS;
+    const std::size_t last_page = (end - 1 - region_begin) >> PAGE_BITS;
+    std::fill(dirty_pages.begin() + first_page, dirty_pages.begin() + last_page + 1, true);
+    has_dirty_pages = true;
+}
+
+void CachedGlobalRegion::MarkAllPagesDirty() {
+    std::fill(dirty_pages.begin(), dirty_pages.end(), true);
+    has_dirty_pages = !dirty_pages.empty();
+}
+
+void CachedGlobalRegion::UploadDirtyPages() {
+    if (!has_dirty_pages) {
+        return;
     }
-    glNamedBufferData(buffer.handle, size, host_ptr, GL_STREAM_DRAW);
+    ForEachPageRun(true, [this](std::size_t begin, std::size_t end) {
+        glNamedBufferSubData(handle, offset + static_cast<GLintptr>(begin),
+                             static_cast<GLsizeiptr>(end - begin), host_ptr + begin);
+    });
+    std::fill(dirty_pages.begin(), dirty_pages.end(), false);
+    has_dirty_pages = false;
 }
 
 void CachedGlobalRegion::Flush() {
     LOG_DEBUG(Render_OpenGL, "Flushing {} bytes to CPU memory address 0x{:16}", size, cpu_addr);
-    glGetNamedBufferSubData(buffer.handle, 0, static_cast<GLsizeiptr>(size), host_ptr);
+    // Dirty pages hold guest writes newer than the copy in the buffer, keep them
+    ForEachPageRun(false, [this](std::size_t begin, std::size_t end) {
+        glGetNamedBufferSubData(handle, offset + static_cast<GLintptr>(begin),
+                                static_cast<GLsizeiptr>(end - begin), host_ptr + begin);
+    });
 }
 
 GlobalRegion GlobalRegionCacheOpenGL::TryGetReservedGlobalRegion(CacheAddr addr, u32 size) const {
@@ -48,17 +112,24 @@ GlobalRegion GlobalRegionCacheOpenGL::TryGetReservedGlobalRegion(CacheAddr addr,
 
 GlobalRegion GlobalRegionCacheOpenGL::GetUncachedGlobalRegion(GPUVAddr addr, u8* host_ptr,
                                                               u32 size) {
+    if (size > max_ssbo_size) {
+        LOG_WARNING(HW_GPU, "Global region size {} exceeds the maximum storage block size {}",
+                    size, max_ssbo_size);
+    }
+
     GlobalRegion region{TryGetReservedGlobalRegion(ToCacheAddr(host_ptr), size)};
     if (!region) {
         // No reserved surface available, create a new one and reserve it
-        auto& memory_manager{Core::System::GetInstance().GPU().MemoryManager()};
+        auto& memory_manager{system.GPU().MemoryManager()};
         const auto cpu_addr{memory_manager.GpuToCpuAddress(addr)};
         ASSERT(cpu_addr);
 
-        region = std::make_shared<CachedGlobalRegion>(*cpu_addr, host_ptr, size, max_ssbo_size);
+        region = std::make_shared<CachedGlobalRegion>(*cpu_addr, host_ptr);
+        region->Resize(size, heap);
         ReserveGlobalRegion(region);
+    } else if (region->GetSizeInBytes() < size) {
+        region->Resize(size, heap);
     }
-    region->Reload(size);
     return region;
 }
 
@@ -66,22 +137,24 @@ void GlobalRegionCacheOpenGL::ReserveGlobalRegion(GlobalRegion region) {
     reserve.insert_or_assign(region->GetCacheAddr(), std::move(region));
 }
 
-GlobalRegionCacheOpenGL::GlobalRegionCacheOpenGL(RasterizerOpenGL& rasterizer)
-    : RasterizerCache{rasterizer} {
+GlobalRegionCacheOpenGL::GlobalRegionCacheOpenGL(RasterizerOpenGL& rasterizer,
+                                                 Core::System& system)
+    : RasterizerCache{rasterizer}, system{system} {
     GLint max_ssbo_size_;
     glGetIntegerv(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &max_ssbo_size_);
     max_ssbo_size = static_cast<u32>(max_ssbo_size_);
+
+    // Heap allocations are aligned to their size, at least 256 bytes
+    GLint ssbo_alignment;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo_alignment);
+    ASSERT(ssbo_alignment <= 256);
 }
 
 GlobalRegion GlobalRegionCacheOpenGL::GetGlobalRegion(
-    const GLShader::GlobalMemoryEntry& global_region,
-    Tegra::Engines::Maxwell3D::Regs::ShaderStage stage) {
-
-    auto& gpu{Core::System::GetInstance().GPU()};
-    auto& memory_manager{gpu.MemoryManager()};
-    const auto cbufs{gpu.Maxwell3D().state.shader_stages[static_cast<std::size_t>(stage)]};
-    const auto addr{cbufs.const_buffers[global_region.GetCbufIndex()].address +
-                    global_region.GetCbufOffset()};
+    const GLShader::GlobalMemoryEntry& global_region, GPUVAddr cbuf_addr) {
+
+    auto& memory_manager{system.GPU().MemoryManager()};
+    const auto addr{cbuf_addr + global_region.GetCbufOffset()};
     const auto actual_addr{memory_manager.Read<u64>(addr)};
     const auto size{memory_manager.Read<u32>(addr + 8)};
 
@@ -93,9 +166,29 @@ GlobalRegion GlobalRegionCacheOpenGL::GetGlobalRegion(
         // No global region found - create a new one
         region = GetUncachedGlobalRegion(actual_addr, host_ptr, size);
         Register(region);
+    } else if (region->GetSizeInBytes() < size) {
+        // The region grew, keep the shader writes before moving it to larger storage
+        FlushObject(region);
+        Unregister(region);
+        region = GetUncachedGlobalRegion(actual_addr, host_ptr, size);
+        Register(region);
     }
 
+    region->UploadDirtyPages();
     return region;
 }
 
+void GlobalRegionCacheOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
+    std::lock_guard lock{mutex};
+
+    for (const auto& region : GetSortedObjectsFromRegion(addr, size)) {
+        region->MarkPagesDirty(addr, size);
+    }
+}
+
+void GlobalRegionCacheOpenGL::Unregister(const GlobalRegion& object) {
+    object->MarkAllPagesDirty();
+    RasterizerCache::Unregister(object);
+}
+
 } // namespace OpenGL
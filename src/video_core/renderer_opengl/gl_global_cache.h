@@ -5,7 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -13,8 +15,13 @@
 #include "common/common_types.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_buffer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 
+namespace Core {
+class System;
+}
+
 namespace OpenGL {
 
 namespace GLShader {
@@ -25,9 +32,13 @@ class RasterizerOpenGL;
 class CachedGlobalRegion;
 using GlobalRegion = std::shared_ptr<CachedGlobalRegion>;
 
+/**
+ * Global memory region sub-allocated from a device buffer heap. Guest writes mark the pages they
+ * touch as dirty instead of dropping the region, only the dirty pages are uploaded again.
+ */
 class CachedGlobalRegion final : public RasterizerCacheObject {
 public:
-    explicit CachedGlobalRegion(VAddr cpu_addr, u8* host_ptr, u32 size, u32 max_size);
+    explicit CachedGlobalRegion(VAddr cpu_addr, u8* host_ptr);
     ~CachedGlobalRegion();
 
     VAddr GetCpuAddr() const override {
@@ -38,43 +49,83 @@ public:
         return size;
     }
 
-    /// Gets the GL program handle for the buffer
+    /// Gets the GL handle of the buffer holding the region
     GLuint GetBufferHandle() const {
-        return buffer.handle;
+        return handle;
+    }
+
+    /// Gets the offset of the region in its buffer
+    GLintptr GetBufferOffset() const {
+        return offset;
     }
 
-    /// Reloads the global region from guest memory
-    void Reload(u32 size_);
+    /// Moves the region to new storage of the given size, all its pages are uploaded again
+    void Resize(u32 size_, DeviceBufferHeap& heap);
+
+    /// Marks the pages of the region overlapping the given range as modified by the guest
+    void MarkPagesDirty(CacheAddr addr, u64 write_size);
+
+    /// Marks the whole region as modified by the guest
+    void MarkAllPagesDirty();
+
+    /// Uploads the pages modified by the guest since the last upload
+    void UploadDirtyPages();
 
+    /// Writes the pages not modified by the guest back to guest memory
     void Flush();
 
 private:
+    static constexpr std::size_t PAGE_BITS = 12;
+    static constexpr std::size_t PAGE_SIZE = std::size_t{1} << PAGE_BITS;
+
+    /// Calls func with the byte range of each run of pages whose dirty state is the given one
+    template <typename Func>
+    void ForEachPageRun(bool dirty, Func&& func) const;
+
     VAddr cpu_addr{};
     u8* host_ptr{};
     u32 size{};
-    u32 max_size{};
 
-    OGLBuffer buffer;
+    GLuint handle{};
+    GLintptr offset{};
+    std::optional<DeviceBufferHeap::Allocation> allocation;
+    OGLBuffer dedicated_buffer; ///< Used when the region does not fit in the heap
+
+    std::vector<bool> dirty_pages;
+    bool has_dirty_pages{};
 };
 
 class GlobalRegionCacheOpenGL final : public RasterizerCache<GlobalRegion> {
 public:
-    explicit GlobalRegionCacheOpenGL(RasterizerOpenGL& rasterizer);
+    explicit GlobalRegionCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system);
 
-    /// Gets the current specified shader stage program
-    GlobalRegion GetGlobalRegion(const GLShader::GlobalMemoryEntry& descriptor,
-                                 Tegra::Engines::Maxwell3D::Regs::ShaderStage stage);
+    /**
+     * Gets the global memory region described by a shader entry, with its dirty pages uploaded
+     * @param descriptor Shader entry describing the region
+     * @param cbuf_addr GPU address of the const buffer that holds the region's address and size
+     */
+    GlobalRegion GetGlobalRegion(const GLShader::GlobalMemoryEntry& descriptor, GPUVAddr cbuf_addr);
+
+    /// Marks the pages of the cached regions overlapping the specified range as dirty. Unlike
+    /// RasterizerCache::InvalidateRegion the regions stay registered.
+    void InvalidateRegion(CacheAddr addr, u64 size);
 
 protected:
     void FlushObjectInner(const GlobalRegion& object) override {
         object->Flush();
     }
 
+    /// Marks the whole region as dirty, it is not notified of guest writes while unregistered
+    void Unregister(const GlobalRegion& object) override;
+
 private:
     GlobalRegion TryGetReservedGlobalRegion(CacheAddr addr, u32 size) const;
     GlobalRegion GetUncachedGlobalRegion(GPUVAddr addr, u8* host_ptr, u32 size);
     void ReserveGlobalRegion(GlobalRegion region);
 
+    Core::System& system;
+
+    DeviceBufferHeap heap;
     std::unordered_map<CacheAddr, GlobalRegion> reserve;
     u32 max_ssbo_size{};
 };
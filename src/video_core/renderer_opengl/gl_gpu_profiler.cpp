@@ -0,0 +1,65 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
+
+namespace OpenGL {
+
+namespace {
+
+/// Queries in flight at most, timestamps written past it keep their CPU estimate
+constexpr std::size_t MAX_PENDING_QUERIES = 1U << 14;
+
+constexpr u64 NANOSECONDS_PER_SECOND = 1'000'000'000;
+
+} // Anonymous namespace
+
+GLGpuProfiler::GLGpuProfiler() : GpuProfiler{NANOSECONDS_PER_SECOND} {}
+
+GLGpuProfiler::~GLGpuProfiler() {
+    glDeleteQueries(static_cast<GLsizei>(all_queries.size()), all_queries.data());
+}
+
+void GLGpuProfiler::WriteTimestamp(u32 key) {
+    if (pending_queries.size() >= MAX_PENDING_QUERIES) {
+        return;
+    }
+    if (free_queries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        all_queries.push_back(query);
+        free_queries.push_back(query);
+    }
+    const GLuint query = free_queries.back();
+    free_queries.pop_back();
+
+    glQueryCounter(query, GL_TIMESTAMP);
+    pending_queries.push_back({query, key});
+}
+
+void GLGpuProfiler::ReadTimestamps() {
+    // Queries complete in order, stop at the first one that isn't available yet
+    while (!pending_queries.empty()) {
+        const PendingQuery& pending = pending_queries.front();
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            break;
+        }
+        GLuint64 gpu_ticks = 0;
+        glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &gpu_ticks);
+        SetTimestamp(pending.key, gpu_ticks);
+
+        free_queries.push_back(pending.query);
+        pending_queries.pop_front();
+    }
+}
+
+s64 GLGpuProfiler::GetGpuTime() {
+    GLint64 gpu_ticks = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_ticks);
+    return gpu_ticks;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,43 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/gpu_profiler.h"
+
+namespace OpenGL {
+
+/// GPU profiler backed by GL_TIMESTAMP queries
+class GLGpuProfiler final : public VideoCore::GpuProfiler {
+public:
+    explicit GLGpuProfiler();
+    ~GLGpuProfiler() override;
+
+protected:
+    void WriteTimestamp(u32 key) override;
+
+    void ReadTimestamps() override;
+
+    s64 GetGpuTime() override;
+
+private:
+    struct PendingQuery {
+        GLuint query;
+        u32 key;
+    };
+
+    /// Queries written to the command stream, in submission order
+    std::deque<PendingQuery> pending_queries;
+    /// Queries whose results were read, ready to be written again
+    std::vector<GLuint> free_queries;
+    std::vector<GLuint> all_queries;
+};
+
+} // namespace OpenGL
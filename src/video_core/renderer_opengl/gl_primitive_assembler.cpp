@@ -4,60 +4,157 @@
 
 #include <algorithm>
 #include <array>
+#include <vector>
+#include "common/alignment.h"
 #include "common/assert.h"
+#include "common/bit_util.h"
 #include "common/common_types.h"
-#include "core/core.h"
-#include "video_core/memory_manager.h"
-#include "video_core/renderer_opengl/gl_buffer_cache.h"
 #include "video_core/renderer_opengl/gl_primitive_assembler.h"
+#include "video_core/renderer_opengl/gl_state.h"
 
 namespace OpenGL {
 
+namespace {
+
 constexpr u32 TRIANGLES_PER_QUAD = 6;
 constexpr std::array<u32, TRIANGLES_PER_QUAD> QUAD_MAP = {0, 1, 2, 0, 2, 3};
 
-PrimitiveAssembler::PrimitiveAssembler(OGLBufferCache& buffer_cache) : buffer_cache(buffer_cache) {}
+/// Smallest number of quads the quad array buffer is created with
+constexpr u32 MIN_QUAD_ARRAY_CAPACITY = 1024;
+
+/// Smallest size of the buffer indexed quads are expanded to
+constexpr std::size_t MIN_QUAD_INDEXED_SIZE = 1024 * 1024;
+
+constexpr u32 QUAD_INDEXED_LOCAL_SIZE = 128;
+
+constexpr GLint QUAD_INDEXED_SHIFT_LOCATION = 0;
+constexpr GLint QUAD_INDEXED_COUNT_LOCATION = 1;
+
+constexpr GLuint QUAD_INDEXED_INPUT_BINDING = 0;
+constexpr GLuint QUAD_INDEXED_OUTPUT_BINDING = 1;
+
+// Each invocation expands one quad. Indices narrower than 32 bits are extracted from the words
+// that contain them, index_shift is the log2 of the index size in bytes.
+constexpr char QUAD_INDEXED_SOURCE[] = R"(#version 430 core
+layout (local_size_x = 128) in;
+
+layout (std430, binding = 0) readonly buffer InputIndices {
+    uint input_indices[];
+};
+layout (std430, binding = 1) writeonly buffer OutputIndices {
+    uint output_indices[];
+};
+
+layout (location = 0) uniform uint index_shift;
+layout (location = 1) uniform uint num_quads;
+
+const uint quad_map[6] = uint[](0, 1, 2, 0, 2, 3);
+
+void main() {
+    const uint quad = gl_GlobalInvocationID.x;
+    if (quad >= num_quads) {
+        return;
+    }
+    const int index_bits = int(8u << index_shift);
+    for (uint i = 0; i < 6; ++i) {
+        const uint byte_offset = (quad * 4 + quad_map[i]) << index_shift;
+        const uint word = input_indices[byte_offset >> 2];
+        const int bit_offset = int((byte_offset & 3) * 8);
+        output_indices[quad * 6 + i] = bitfieldExtract(word, bit_offset, index_bits);
+    }
+}
+)";
+
+template <typename T>
+T NextPowerOfTwo(T value) {
+    if (value <= 1) {
+        return 1;
+    }
+    return static_cast<T>(u64{1} << (64 - Common::CountLeadingZeroes64(u64{value} - 1)));
+}
+
+} // Anonymous namespace
+
+PrimitiveAssembler::PrimitiveAssembler() = default;
 
 PrimitiveAssembler::~PrimitiveAssembler() = default;
 
-std::size_t PrimitiveAssembler::CalculateQuadSize(u32 count) const {
+GLuint PrimitiveAssembler::GetQuadArrayBuffer(u32 count) {
     ASSERT_MSG(count % 4 == 0, "Quad count is expected to be a multiple of 4");
-    return (count / 4) * TRIANGLES_PER_QUAD * sizeof(GLuint);
-}
+    const u32 num_quads = count / 4;
+    if (num_quads <= quad_array_capacity) {
+        return quad_array_buffer.handle;
+    }
 
-GLintptr PrimitiveAssembler::MakeQuadArray(u32 first, u32 count) {
-    const std::size_t size{CalculateQuadSize(count)};
-    auto [dst_pointer, index_offset] = buffer_cache.ReserveMemory(size);
+    // Grow to a power of two so titles drawing increasingly larger batches don't rebuild it often
+    quad_array_capacity = std::max(MIN_QUAD_ARRAY_CAPACITY, NextPowerOfTwo(num_quads));
 
-    for (u32 primitive = 0; primitive < count / 4; ++primitive) {
+    std::vector<u32> indices(static_cast<std::size_t>(quad_array_capacity) * TRIANGLES_PER_QUAD);
+    for (u32 quad = 0; quad < quad_array_capacity; ++quad) {
         for (u32 i = 0; i < TRIANGLES_PER_QUAD; ++i) {
-            const u32 index = first + primitive * 4 + QUAD_MAP[i];
-            std::memcpy(dst_pointer, &index, sizeof(index));
-            dst_pointer += sizeof(index);
+            indices[quad * TRIANGLES_PER_QUAD + i] = quad * 4 + QUAD_MAP[i];
         }
     }
 
-    return index_offset;
+    quad_array_buffer.Release();
+    quad_array_buffer.Create();
+    glNamedBufferStorage(quad_array_buffer.handle, indices.size() * sizeof(u32), indices.data(),
+                         0);
+    return quad_array_buffer.handle;
 }
 
-GLintptr PrimitiveAssembler::MakeQuadIndexed(GPUVAddr gpu_addr, std::size_t index_size, u32 count) {
-    const std::size_t map_size{CalculateQuadSize(count)};
-    auto [dst_pointer, index_offset] = buffer_cache.ReserveMemory(map_size);
-
-    auto& memory_manager = Core::System::GetInstance().GPU().MemoryManager();
-    const u8* source{memory_manager.GetPointer(gpu_addr)};
+std::tuple<GLuint, GLintptr> PrimitiveAssembler::ConvertQuadIndexed(OpenGLState& state,
+                                                                    GLuint src_buffer,
+                                                                    GLintptr src_offset,
+                                                                    std::size_t index_size,
+                                                                    u32 count) {
+    ASSERT_MSG(count % 4 == 0, "Quad count is expected to be a multiple of 4");
+    ASSERT(index_size == 1 || index_size == 2 || index_size == 4);
+    const u32 num_quads = count / 4;
+    const std::size_t src_size = Common::AlignUp(count * index_size, sizeof(u32));
+    const std::size_t dst_size = num_quads * TRIANGLES_PER_QUAD * sizeof(u32);
 
-    for (u32 primitive = 0; primitive < count / 4; ++primitive) {
-        for (std::size_t i = 0; i < TRIANGLES_PER_QUAD; ++i) {
-            const u32 index = primitive * 4 + QUAD_MAP[i];
-            const u8* src_offset = source + (index * index_size);
+    if (quad_indexed_program.handle == 0) {
+        OGLShader shader;
+        shader.Create(QUAD_INDEXED_SOURCE, GL_COMPUTE_SHADER);
+        quad_indexed_program.Create(false, false, shader.handle);
+    }
 
-            std::memcpy(dst_pointer, src_offset, index_size);
-            dst_pointer += index_size;
+    // Expanded indices are sub-allocated linearly, starting over when the buffer is used up so
+    // consecutive draws don't wait for each other
+    constexpr std::size_t dst_alignment = 256;
+    quad_indexed_cursor = Common::AlignUp(quad_indexed_cursor, dst_alignment);
+    if (quad_indexed_cursor + dst_size > quad_indexed_size) {
+        if (dst_size > quad_indexed_size) {
+            quad_indexed_size = std::max(MIN_QUAD_INDEXED_SIZE, NextPowerOfTwo(dst_size * 4));
+            quad_indexed_buffer.Release();
+            quad_indexed_buffer.Create();
+            glNamedBufferStorage(quad_indexed_buffer.handle, quad_indexed_size, nullptr, 0);
         }
+        quad_indexed_cursor = 0;
     }
+    const auto dst_offset = static_cast<GLintptr>(quad_indexed_cursor);
+    quad_indexed_cursor += dst_size;
+
+    state.draw.shader_program = quad_indexed_program.handle;
+    state.ApplyShaderProgram();
+
+    glProgramUniform1ui(quad_indexed_program.handle, QUAD_INDEXED_SHIFT_LOCATION,
+                        Common::CountTrailingZeroes32(static_cast<u32>(index_size)));
+    glProgramUniform1ui(quad_indexed_program.handle, QUAD_INDEXED_COUNT_LOCATION, num_quads);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, QUAD_INDEXED_INPUT_BINDING, src_buffer,
+                      src_offset, src_size);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, QUAD_INDEXED_OUTPUT_BINDING,
+                      quad_indexed_buffer.handle, dst_offset, dst_size);
+
+    glDispatchCompute(Common::AlignUp(num_quads, QUAD_INDEXED_LOCAL_SIZE) /
+                          QUAD_INDEXED_LOCAL_SIZE,
+                      1, 1);
+
+    // The expanded indices are read by the draw that follows
+    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT);
 
-    return index_offset;
+    return {quad_indexed_buffer.handle, dst_offset};
 }
 
 } // namespace OpenGL
@@ -4,28 +4,48 @@
 
 #pragma once
 
+#include <cstddef>
+#include <tuple>
 #include <glad/glad.h>
 
 #include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
 
 namespace OpenGL {
 
-class OGLBufferCache;
+class OpenGLState;
 
+/**
+ * Converts quads, which OpenGL core profiles can't draw, to triangle lists. The indices of
+ * non-indexed quads are the same for every draw and live in a persistent buffer, indexed quads are
+ * expanded on the host GPU.
+ */
 class PrimitiveAssembler {
 public:
-    explicit PrimitiveAssembler(OGLBufferCache& buffer_cache);
+    explicit PrimitiveAssembler();
     ~PrimitiveAssembler();
 
-    /// Calculates the size required by MakeQuadArray and MakeQuadIndexed.
-    std::size_t CalculateQuadSize(u32 count) const;
+    /// Returns a buffer with the triangle indices of count vertices drawn as quads, starting at
+    /// vertex zero. Draws offset them to their first vertex with the base vertex.
+    GLuint GetQuadArrayBuffer(u32 count);
 
-    GLintptr MakeQuadArray(u32 first, u32 count);
-
-    GLintptr MakeQuadIndexed(GPUVAddr gpu_addr, std::size_t index_size, u32 count);
+    /**
+     * Expands count quad indices of index_size bytes read from a buffer to 32-bit triangle
+     * indices with a compute dispatch. The source offset must be aligned for shader storage.
+     * @returns The buffer and offset of the triangle indices
+     */
+    std::tuple<GLuint, GLintptr> ConvertQuadIndexed(OpenGLState& state, GLuint src_buffer,
+                                                    GLintptr src_offset, std::size_t index_size,
+                                                    u32 count);
 
 private:
-    OGLBufferCache& buffer_cache;
+    OGLBuffer quad_array_buffer;
+    u32 quad_array_capacity = 0; ///< Number of quads in the quad array buffer
+
+    OGLProgram quad_indexed_program;
+    OGLBuffer quad_indexed_buffer;
+    std::size_t quad_indexed_size = 0;
+    std::size_t quad_indexed_cursor = 0;
 };
 
-} // namespace OpenGL
\ No newline at end of file
+} // namespace OpenGL
@@ -0,0 +1,176 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include <glad/glad.h>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
+#include "video_core/renderer_opengl/gl_rasterizer.h"
+
+namespace OpenGL {
+
+namespace {
+
+constexpr std::array<GLenum, VideoCore::NumQueryTypes> QueryTargets = {GL_SAMPLES_PASSED};
+
+/// Unresolved segments a counter may depend on, deeper chains are resolved when a segment starts
+constexpr u64 MaxDependencyDepth = 32;
+
+} // Anonymous namespace
+
+HostCounter::HostCounter(std::shared_ptr<HostCounter> dependency_, VideoCore::QueryType type)
+    : dependency{std::move(dependency_)}, target{QueryTargets[static_cast<std::size_t>(type)]} {
+    if (dependency) {
+        depth = dependency->depth + 1;
+        if (dependency->result || depth > MaxDependencyDepth) {
+            // Keeps the chain short, the oldest segments are likely available already
+            base_result = dependency->Query();
+            dependency.reset();
+            depth = 0;
+        }
+    }
+
+    query.Create(target);
+    glBeginQuery(target, query.handle);
+}
+
+HostCounter::~HostCounter() = default;
+
+void HostCounter::EndQuery() {
+    glEndQuery(target);
+}
+
+u64 HostCounter::Query() {
+    if (result) {
+        return *result;
+    }
+
+    u64 value;
+    glGetQueryObjectui64v(query.handle, GL_QUERY_RESULT, &value);
+    if (dependency) {
+        base_result += dependency->Query();
+        dependency.reset();
+    }
+    result = base_result + value;
+    return *result;
+}
+
+CachedQuery::CachedQuery(VAddr cpu_addr, u8* host_ptr, std::shared_ptr<HostCounter> counter,
+                         std::optional<u64> timestamp)
+    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, host_ptr{host_ptr},
+      counter{std::move(counter)}, timestamp{timestamp} {}
+
+CachedQuery::~CachedQuery() = default;
+
+void CachedQuery::Flush() {
+    const u64 value = counter ? counter->Query() : 0;
+    LOG_DEBUG(Render_OpenGL, "Flushing query result {} to CPU memory address 0x{:016X}", value,
+              cpu_addr);
+
+    if (timestamp) {
+        const std::array<u64_le, 2> long_result{value, *timestamp};
+        std::memcpy(host_ptr, long_result.data(), LongQuerySize);
+    } else {
+        const u32_le short_result = static_cast<u32>(value);
+        std::memcpy(host_ptr, &short_result, ShortQuerySize);
+    }
+}
+
+QueryCache::CounterStream::CounterStream(VideoCore::QueryType type) : type{type} {}
+
+QueryCache::CounterStream::~CounterStream() {
+    if (current) {
+        current->EndQuery();
+    }
+}
+
+void QueryCache::CounterStream::Update(bool enabled) {
+    if (enabled == static_cast<bool>(current)) {
+        return;
+    }
+    if (enabled) {
+        current = std::make_shared<HostCounter>(last, type);
+    } else {
+        current->EndQuery();
+        last = std::move(current);
+    }
+}
+
+std::shared_ptr<HostCounter> QueryCache::CounterStream::GetCurrent() {
+    if (current) {
+        current->EndQuery();
+        last = std::move(current);
+        // Keep counting in a new segment
+        current = std::make_shared<HostCounter>(last, type);
+    }
+    return last;
+}
+
+void QueryCache::CounterStream::Reset() {
+    if (current) {
+        current->EndQuery();
+        current = std::make_shared<HostCounter>(nullptr, type);
+    }
+    last.reset();
+}
+
+QueryCache::QueryCache(RasterizerOpenGL& rasterizer, Core::System& system)
+    : RasterizerCache{rasterizer}, system{system}, streams{{CounterStream{
+                                                       VideoCore::QueryType::SamplesPassed}}} {}
+
+QueryCache::~QueryCache() = default;
+
+void QueryCache::UpdateCounters() {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    GetStream(VideoCore::QueryType::SamplesPassed).Update(regs.samplecnt_enable != 0);
+}
+
+void QueryCache::ResetCounter(VideoCore::QueryType type) {
+    UpdateCounters();
+    GetStream(type).Reset();
+}
+
+void QueryCache::Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                       std::optional<u64> timestamp) {
+    auto& memory_manager = system.GPU().MemoryManager();
+    u8* const host_ptr = memory_manager.GetPointer(gpu_addr);
+    const auto cpu_addr = memory_manager.GpuToCpuAddress(gpu_addr);
+    if (!host_ptr || !cpu_addr) {
+        LOG_ERROR(Render_OpenGL, "Query to unmapped address 0x{:016X}", gpu_addr);
+        return;
+    }
+
+    UpdateCounters();
+    auto counter = GetStream(type).GetCurrent();
+
+    if (const auto pending = TryGet(host_ptr)) {
+        // The new result replaces the one that was not read yet
+        Unregister(pending);
+    }
+    auto query = std::make_shared<CachedQuery>(*cpu_addr, host_ptr, std::move(counter), timestamp);
+    Register(query);
+    query->MarkAsModified(true, *this);
+}
+
+std::shared_ptr<HostCounter> QueryCache::GetIndependentCounter(GPUVAddr gpu_addr) {
+    const auto query = TryGet(system.GPU().MemoryManager().GetPointer(gpu_addr));
+    if (!query || !query->IsDirty()) {
+        return {};
+    }
+    const auto& counter = query->GetCounter();
+    if (!counter || !counter->IsIndependent()) {
+        return {};
+    }
+    return counter;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,147 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/rasterizer_cache.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core {
+class System;
+}
+
+namespace OpenGL {
+
+class RasterizerOpenGL;
+
+/**
+ * Host query counting a segment of a guest counter. The value of the guest counter is the result
+ * of the segment added to the value of the segment it depends on, the previous one since the
+ * counter was last reset.
+ */
+class HostCounter final {
+public:
+    explicit HostCounter(std::shared_ptr<HostCounter> dependency, VideoCore::QueryType type);
+    ~HostCounter();
+
+    /// Stops counting, the segment has to be ended before it's queried
+    void EndQuery();
+
+    /// Returns the value of the guest counter at the end of the segment, waiting for the host GPU
+    u64 Query();
+
+    /// Returns true if the value of the guest counter is the result of this host query alone
+    bool IsIndependent() const {
+        return !dependency && base_result == 0;
+    }
+
+    GLuint GetHandle() const {
+        return query.handle;
+    }
+
+private:
+    std::shared_ptr<HostCounter> dependency; ///< Previous segment, released once resolved
+    u64 base_result = 0;                     ///< Resolved value of the previous segments
+    std::optional<u64> result;               ///< Value of the guest counter once resolved
+    u64 depth = 0;                           ///< Number of unresolved previous segments
+    GLenum target;
+    OGLQuery query;
+};
+
+/// Query written to guest memory, resolved lazily when the guest reads it
+class CachedQuery final : public RasterizerCacheObject {
+public:
+    explicit CachedQuery(VAddr cpu_addr, u8* host_ptr, std::shared_ptr<HostCounter> counter,
+                         std::optional<u64> timestamp);
+    ~CachedQuery();
+
+    VAddr GetCpuAddr() const override {
+        return cpu_addr;
+    }
+
+    std::size_t GetSizeInBytes() const override {
+        return timestamp ? LongQuerySize : ShortQuerySize;
+    }
+
+    /// Returns the counter holding the result, null when the counter was just reset
+    const std::shared_ptr<HostCounter>& GetCounter() const {
+        return counter;
+    }
+
+    /// Writes the result, and the timestamp of long queries, to guest memory
+    void Flush();
+
+private:
+    static constexpr std::size_t ShortQuerySize = 4;
+    static constexpr std::size_t LongQuerySize = 16;
+
+    VAddr cpu_addr{};
+    u8* host_ptr{};
+    std::shared_ptr<HostCounter> counter;
+    std::optional<u64> timestamp;
+};
+
+class QueryCache final : public RasterizerCache<std::shared_ptr<CachedQuery>> {
+public:
+    explicit QueryCache(RasterizerOpenGL& rasterizer, Core::System& system);
+    ~QueryCache();
+
+    /// Starts or stops the host counters following the guest enable registers
+    void UpdateCounters();
+
+    /// Resets a counter to zero
+    void ResetCounter(VideoCore::QueryType type);
+
+    /// Records the current value of a counter, to be written to the address when it's read
+    void Query(GPUVAddr gpu_addr, VideoCore::QueryType type, std::optional<u64> timestamp);
+
+    /// Returns the host counter of the query pending at the address when the result of its host
+    /// query is the guest counter value, so the host GPU can use it directly
+    std::shared_ptr<HostCounter> GetIndependentCounter(GPUVAddr gpu_addr);
+
+protected:
+    void FlushObjectInner(const std::shared_ptr<CachedQuery>& object) override {
+        object->Flush();
+    }
+
+private:
+    /// Segments of a guest counter, counting while the guest has the counter enabled
+    class CounterStream final {
+    public:
+        explicit CounterStream(VideoCore::QueryType type);
+        ~CounterStream();
+
+        /// Starts or stops counting
+        void Update(bool enabled);
+
+        /// Ends the running segment and returns the counter holding the current value, null when
+        /// nothing was counted since the last reset
+        std::shared_ptr<HostCounter> GetCurrent();
+
+        /// Drops the segments counted so far
+        void Reset();
+
+    private:
+        std::shared_ptr<HostCounter> current; ///< Running segment
+        std::shared_ptr<HostCounter> last;    ///< Last ended segment
+        VideoCore::QueryType type;
+    };
+
+    CounterStream& GetStream(VideoCore::QueryType type) {
+        return streams[static_cast<std::size_t>(type)];
+    }
+
+    Core::System& system;
+    std::array<CounterStream, VideoCore::NumQueryTypes> streams;
+};
+
+} // namespace OpenGL
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -16,10 +18,14 @@
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/settings.h"
+#include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu_profiler.h"
+#include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
@@ -39,15 +45,83 @@ MICROPROFILE_DEFINE(OpenGL_UBO, "OpenGL", "Const Buffer Setup", MP_RGB(128, 128,
 MICROPROFILE_DEFINE(OpenGL_Index, "OpenGL", "Index Buffer Setup", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Texture, "OpenGL", "Texture Setup", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Framebuffer, "OpenGL", "Framebuffer Setup", MP_RGB(128, 128, 192));
-MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
+TRACE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
+TRACE_DEFINE(OpenGL_Compute, "OpenGL", "Compute Dispatch", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_CacheManagement, "OpenGL", "Cache Mgmt", MP_RGB(100, 255, 100));
 MICROPROFILE_DEFINE(OpenGL_PrimitiveAssembly, "OpenGL", "Prim Asmbl", MP_RGB(255, 100, 100));
+MICROPROFILE_DEFINE_GPU(OpenGL_GpuClear, "Clear", MP_RGB(192, 128, 128));
+MICROPROFILE_DEFINE_GPU(OpenGL_GpuDraw, "Draw", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE_GPU(OpenGL_GpuCompute, "Compute", MP_RGB(128, 192, 128));
+
+/// Layout of the commands read by glMultiDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;
+    GLuint base_instance;
+};
+static_assert(sizeof(DrawArraysIndirectCommand) == 16, "Invalid indirect command size");
+
+/// Layout of the commands read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "Invalid indirect command size");
+
+/// Returns the first vertex or index and the count of the range covering all the draws
+static std::pair<u32, u32> GetBatchedRange(
+    const std::vector<Tegra::Engines::Maxwell3D::State::DrawRange>& draws) {
+    u32 begin = draws[0].first;
+    u32 end = draws[0].first + draws[0].count;
+    for (const auto& draw : draws) {
+        begin = std::min(begin, draw.first);
+        end = std::max(end, draw.first + draw.count);
+    }
+    return {begin, end - begin};
+}
+
+/// Returns the transform feedback state of the enabled buffers
+static TransformFeedbackConfig GetTransformFeedbackConfig(const Maxwell& regs) {
+    TransformFeedbackConfig config;
+    for (std::size_t index = 0; index < Maxwell::NumTransformFeedbackBuffers; ++index) {
+        if (regs.tfb_bindings[index].buffer_enable == 0) {
+            continue;
+        }
+        const auto& layout = regs.tfb_layouts[index];
+        UNIMPLEMENTED_IF_MSG(layout.stream != 0, "Transform feedback stream {}", layout.stream);
+        config.strides[index] = layout.stride;
+        config.varying_counts[index] = layout.varying_count;
+        config.varying_locs[index] = regs.tfb_varying_locs[index];
+    }
+    return config;
+}
+
+/// Returns the transform feedback primitive mode of the primitives drawn without geometry shaders
+static GLenum GetTransformFeedbackMode(GLenum primitive_mode) {
+    switch (primitive_mode) {
+    case GL_POINTS:
+        return GL_POINTS;
+    case GL_LINES:
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+    case GL_LINES_ADJACENCY:
+    case GL_LINE_STRIP_ADJACENCY:
+        return GL_LINES;
+    default:
+        return GL_TRIANGLES;
+    }
+}
 
 struct DrawParameters {
     GLenum primitive_mode;
     GLsizei count;
-    GLint current_instance;
+    GLuint base_instance;
+    GLsizei num_instances;
     bool use_indexed;
 
     GLint vertex_first;
@@ -56,21 +130,42 @@ struct DrawParameters {
     GLint base_vertex;
     GLintptr index_buffer_offset;
 
+    /// Quad indices waiting to be expanded to triangles, quad_index_size is zero without them
+    GLuint quad_index_buffer;
+    GLintptr quad_index_offset;
+    std::size_t quad_index_size;
+
+    /// Number of batched draws dispatched with indirect commands, zero for single draws
+    GLsizei draw_count;
+    GLuint indirect_buffer;
+    GLintptr indirect_offset;
+
     void DispatchDraw() const {
+        if (draw_count > 0) {
+            const auto indirect_ptr = reinterpret_cast<const void*>(indirect_offset);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+            if (use_indexed) {
+                glMultiDrawElementsIndirect(primitive_mode, index_format, indirect_ptr, draw_count,
+                                            0);
+            } else {
+                glMultiDrawArraysIndirect(primitive_mode, indirect_ptr, draw_count, 0);
+            }
+            return;
+        }
         if (use_indexed) {
             const auto index_buffer_ptr = reinterpret_cast<const void*>(index_buffer_offset);
-            if (current_instance > 0) {
+            if (base_instance > 0 || num_instances > 1) {
                 glDrawElementsInstancedBaseVertexBaseInstance(primitive_mode, count, index_format,
-                                                              index_buffer_ptr, 1, base_vertex,
-                                                              current_instance);
+                                                              index_buffer_ptr, num_instances,
+                                                              base_vertex, base_instance);
             } else {
                 glDrawElementsBaseVertex(primitive_mode, count, index_format, index_buffer_ptr,
                                          base_vertex);
             }
         } else {
-            if (current_instance > 0) {
-                glDrawArraysInstancedBaseInstance(primitive_mode, vertex_first, count, 1,
-                                                  current_instance);
+            if (base_instance > 0 || num_instances > 1) {
+                glDrawArraysInstancedBaseInstance(primitive_mode, vertex_first, count,
+                                                  num_instances, base_instance);
             } else {
                 glDrawArrays(primitive_mode, vertex_first, count);
             }
@@ -78,31 +173,55 @@ struct DrawParameters {
     }
 };
 
-struct FramebufferCacheKey {
-    bool is_single_buffer = false;
-    bool stencil_enable = false;
+using DirtyFlags = Tegra::Engines::Maxwell3D::DirtyFlags;
 
-    std::array<GLenum, Maxwell::NumRenderTargets> color_attachments{};
-    std::array<GLuint, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets> colors{};
-    u32 colors_count = 0;
+/// Returns true if the given state group changed since it was last synced, marking it as synced.
+static bool TakeDirtyState(DirtyFlags& dirty_flags, DirtyFlags::StateFlag flag) {
+    if (!dirty_flags.state[flag]) {
+        return false;
+    }
+    dirty_flags.state.reset(flag);
+    return true;
+}
 
-    GLuint zeta = 0;
+/// Converts a coordinate in guest pixels to the pixels of a framebuffer at the given scale
+static GLint ScaleCoordinate(s64 value, float scale) {
+    return static_cast<GLint>(std::lround(static_cast<double>(value) * scale));
+}
 
-    auto Tie() const {
-        return std::tie(is_single_buffer, stencil_enable, color_attachments, colors, colors_count,
-                        zeta);
+/// Returns true if a clear with the given scissor writes every texel of a single layer surface
+static bool IsSurfaceCovered(const Surface& surface, const OpenGLState::viewport& viewport) {
+    if (!surface) {
+        return false;
+    }
+    const auto& params = surface->GetSurfaceParams();
+    if (params.depth != 1 || params.max_mip_level != 1) {
+        return false;
+    }
+    const auto& scissor = viewport.scissor;
+    if (!scissor.enabled) {
+        return true;
     }
+    const float scale = surface->GetScale();
+    return scissor.x <= 0 && scissor.y <= 0 &&
+           scissor.x + scissor.width >= ScaleCoordinate(params.width, scale) &&
+           scissor.y + scissor.height >= ScaleCoordinate(params.height, scale);
+}
 
-    bool operator<(const FramebufferCacheKey& rhs) const {
-        return Tie() < rhs.Tie();
+/// Returns true if a depth stencil clear writes every bit of the stencil
+static bool IsStencilFullyCleared(const Maxwell& regs, bool clear_stencil) {
+    if (!clear_stencil || !regs.clear_buffers.S) {
+        return false;
     }
-};
+    // The clear only obeys the stencil masks when the clear flags ask for it
+    return !regs.clear_flags.stencil || (regs.stencil_front_mask & 0xFF) == 0xFF;
+}
 
 RasterizerOpenGL::RasterizerOpenGL(Core::System& system, Core::Frontend::EmuWindow& emu_window,
-                                   ScreenInfo& info)
-    : res_cache{*this}, shader_cache{*this, system, emu_window, device},
-      global_cache{*this}, system{system}, screen_info{info},
-      buffer_cache(*this, STREAM_BUFFER_SIZE) {
+                                   ScreenInfo& info, VideoCore::GpuProfiler& gpu_profiler)
+    : res_cache{*this, system, device}, shader_cache{*this, system, emu_window, device},
+      global_cache{*this, system}, query_cache{*this, system}, system{system}, screen_info{info},
+      gpu_profiler{gpu_profiler}, buffer_cache(*this, system, STREAM_BUFFER_SIZE) {
     OpenGLState::ApplyDefaultState();
 
     shader_program_manager = std::make_unique<GLShader::ProgramManager>();
@@ -143,8 +262,8 @@ GLuint RasterizerOpenGL::SetupVertexFormat() {
     auto& vao_entry = iter->second;
 
     if (is_cache_miss) {
-        vao_entry.Create();
-        const GLuint vao = vao_entry.handle;
+        vao_entry.vao.Create();
+        const GLuint vao = vao_entry.vao.handle;
 
         // Eventhough we are using DSA to create this vertex array, there is a bug on Intel's blob
         // that fails to properly create the vertex array if it's not bound even after creating it
@@ -152,8 +271,6 @@ GLuint RasterizerOpenGL::SetupVertexFormat() {
         state.draw.vertex_array = vao;
         state.ApplyVertexArrayState();
 
-        glVertexArrayElementBuffer(vao, buffer_cache.GetHandle());
-
         // Use the vertex array as-is, assumes that the data is formatted correctly for OpenGL.
         // Enables the first 16 vertex attributes always, as we don't know which ones are actually
         // used until shader time. Note, Tegra technically supports 32, but we're capping this to 16
@@ -190,11 +307,12 @@ GLuint RasterizerOpenGL::SetupVertexFormat() {
         }
     }
 
-    // Rebinding the VAO invalidates the vertex buffer bindings.
+    // The bindings of the VAO may point to other buffers than the ones of the previous VAO
     gpu.dirty_flags.vertex_array.set();
 
-    state.draw.vertex_array = vao_entry.handle;
-    return vao_entry.handle;
+    current_vertex_array = &vao_entry;
+    state.draw.vertex_array = vao_entry.vao.handle;
+    return vao_entry.vao.handle;
 }
 
 void RasterizerOpenGL::SetupVertexBuffer(GLuint vao) {
@@ -206,6 +324,13 @@ void RasterizerOpenGL::SetupVertexBuffer(GLuint vao) {
 
     MICROPROFILE_SCOPE(OpenGL_VB);
 
+    auto& bindings = current_vertex_array->bindings;
+    const GLuint stream_handle = buffer_cache.GetHandle();
+
+    // Range of binding points that changed, they are rebound with a single call
+    u32 first_changed = Maxwell::NumVertexArrays;
+    u32 last_changed = 0;
+
     // Upload all guest vertex arrays sequentially to our buffer
     for (u32 index = 0; index < Maxwell::NumVertexArrays; ++index) {
         if (!gpu.dirty_flags.vertex_array[index])
@@ -220,51 +345,98 @@ void RasterizerOpenGL::SetupVertexBuffer(GLuint vao) {
 
         ASSERT(end > start);
         const u64 size = end - start + 1;
-        const GLintptr vertex_buffer_offset = buffer_cache.UploadMemory(start, size);
+        auto& binding = bindings[index];
+
+        // Streams in the stream buffer are uploaded again as their range might have been reused,
+        // buffers elsewhere hold the guest data until an entry of the buffer cache is dropped
+        GLuint vertex_buffer = binding.buffer;
+        GLintptr vertex_buffer_offset = binding.offset;
+        if (binding.buffer == 0 || binding.buffer == stream_handle || binding.start != start ||
+            binding.size != size ||
+            binding.invalidation_tick != buffer_cache.GetInvalidationTick()) {
+            std::tie(vertex_buffer, vertex_buffer_offset) = buffer_cache.UploadMemory(start, size);
+            binding.start = start;
+            binding.size = size;
+            binding.invalidation_tick = buffer_cache.GetInvalidationTick();
+        }
+
+        const auto stride = static_cast<GLsizei>(vertex_array.stride);
+        if (vertex_buffer != binding.buffer || vertex_buffer_offset != binding.offset ||
+            stride != binding.stride) {
+            binding.buffer = vertex_buffer;
+            binding.offset = vertex_buffer_offset;
+            binding.stride = stride;
+            first_changed = std::min(first_changed, index);
+            last_changed = std::max(last_changed, index);
+        }
 
-        // Bind the vertex array to the buffer at the current offset.
-        glVertexArrayVertexBuffer(vao, index, buffer_cache.GetHandle(), vertex_buffer_offset,
-                                  vertex_array.stride);
+        // Zero disables the vertex buffer instancing
+        const bool is_instanced =
+            regs.instanced_arrays.IsInstancingEnabled(index) && vertex_array.divisor != 0;
+        const GLuint divisor = is_instanced ? vertex_array.divisor : 0;
+        if (divisor != binding.divisor) {
+            binding.divisor = divisor;
+            glVertexArrayBindingDivisor(vao, index, divisor);
+        }
+    }
 
-        if (regs.instanced_arrays.IsInstancingEnabled(index) && vertex_array.divisor != 0) {
-            // Enable vertex buffer instancing with the specified divisor.
-            glVertexArrayBindingDivisor(vao, index, vertex_array.divisor);
-        } else {
-            // Disable the vertex buffer instancing.
-            glVertexArrayBindingDivisor(vao, index, 0);
+    if (first_changed <= last_changed) {
+        // Points in between that didn't change are bound again to the same buffers
+        std::array<GLuint, Maxwell::NumVertexArrays> buffers;
+        std::array<GLintptr, Maxwell::NumVertexArrays> offsets;
+        std::array<GLsizei, Maxwell::NumVertexArrays> strides;
+        const u32 count = last_changed - first_changed + 1;
+        for (u32 i = 0; i < count; ++i) {
+            const auto& binding = bindings[first_changed + i];
+            buffers[i] = binding.buffer;
+            offsets[i] = binding.offset;
+            strides[i] = binding.stride;
         }
+        glVertexArrayVertexBuffers(vao, first_changed, static_cast<GLsizei>(count),
+                                   buffers.data(), offsets.data(), strides.data());
     }
 
     gpu.dirty_flags.vertex_array.reset();
 }
 
-DrawParameters RasterizerOpenGL::SetupDraw() {
+DrawParameters RasterizerOpenGL::SetupDraw(GLuint vao) {
     const auto& gpu = system.GPU().Maxwell3D();
     const auto& regs = gpu.regs;
     const bool is_indexed = accelerate_draw == AccelDraw::Indexed;
 
     DrawParameters params{};
-    params.current_instance = gpu.state.current_instance;
+    params.base_instance = gpu.state.base_instance;
+    params.num_instances = static_cast<GLsizei>(gpu.state.num_instances);
+
+    if (!gpu.state.batched_draws.empty()) {
+        SetupBatchedDraw(vao, params);
+        return params;
+    }
 
     if (regs.draw.topology == Maxwell::PrimitiveTopology::Quads) {
         MICROPROFILE_SCOPE(OpenGL_PrimitiveAssembly);
 
         params.use_indexed = true;
         params.primitive_mode = GL_TRIANGLES;
+        // Quads are always drawn with 32-bit triangle indices
+        params.index_format = GL_UNSIGNED_INT;
 
         if (is_indexed) {
-            params.index_format = MaxwellToGL::IndexFormat(regs.index_array.format);
             params.count = (regs.index_array.count / 4) * 6;
-            params.index_buffer_offset = primitive_assembler.MakeQuadIndexed(
-                regs.index_array.IndexStart(), regs.index_array.FormatSizeInBytes(),
-                regs.index_array.count);
+            // The guest indices are expanded on the host GPU once the stream buffer is unmapped
+            std::tie(params.quad_index_buffer, params.quad_index_offset) =
+                buffer_cache.UploadMemory(regs.index_array.IndexStart(),
+                                          Common::AlignUp(CalculateIndexBufferSize(), 4),
+                                          device.GetShaderStorageBufferAlignment());
+            params.quad_index_size = regs.index_array.FormatSizeInBytes();
             params.base_vertex = static_cast<GLint>(regs.vb_element_base);
         } else {
-            // MakeQuadArray always generates u32 indexes
-            params.index_format = GL_UNSIGNED_INT;
+            // The shared quad indices start at zero, the base vertex moves them to the first vertex
             params.count = (regs.vertex_buffer.count / 4) * 6;
-            params.index_buffer_offset = primitive_assembler.MakeQuadArray(
-                regs.vertex_buffer.first, regs.vertex_buffer.count);
+            params.index_buffer_offset = 0;
+            params.base_vertex = static_cast<GLint>(regs.vertex_buffer.first);
+            glVertexArrayElementBuffer(
+                vao, primitive_assembler.GetQuadArrayBuffer(regs.vertex_buffer.count));
         }
         return params;
     }
@@ -276,8 +448,11 @@ DrawParameters RasterizerOpenGL::SetupDraw() {
         MICROPROFILE_SCOPE(OpenGL_Index);
         params.index_format = MaxwellToGL::IndexFormat(regs.index_array.format);
         params.count = regs.index_array.count;
-        params.index_buffer_offset =
+        // Indices might live in the stream buffer or in a device local buffer
+        GLuint index_buffer;
+        std::tie(index_buffer, params.index_buffer_offset) =
             buffer_cache.UploadMemory(regs.index_array.IndexStart(), CalculateIndexBufferSize());
+        glVertexArrayElementBuffer(vao, index_buffer);
         params.base_vertex = static_cast<GLint>(regs.vb_element_base);
     } else {
         params.count = regs.vertex_buffer.count;
@@ -286,7 +461,58 @@ DrawParameters RasterizerOpenGL::SetupDraw() {
     return params;
 }
 
-void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
+void RasterizerOpenGL::SetupBatchedDraw(GLuint vao, DrawParameters& params) {
+    const auto& gpu = system.GPU().Maxwell3D();
+    const auto& regs = gpu.regs;
+    const auto& draws = gpu.state.batched_draws;
+    ASSERT_MSG(regs.draw.topology != Maxwell::PrimitiveTopology::Quads,
+               "Quads can't be batched");
+
+    params.use_indexed = accelerate_draw == AccelDraw::Indexed;
+    params.primitive_mode = MaxwellToGL::PrimitiveTopology(regs.draw.topology);
+    params.draw_count = static_cast<GLsizei>(draws.size());
+    params.indirect_buffer = buffer_cache.GetHandle();
+
+    if (!params.use_indexed) {
+        const std::size_t commands_size = draws.size() * sizeof(DrawArraysIndirectCommand);
+        u8* commands_ptr;
+        std::tie(commands_ptr, params.indirect_offset) =
+            buffer_cache.ReserveMemory(commands_size, 4);
+        for (const auto& draw : draws) {
+            const DrawArraysIndirectCommand command{draw.count, draw.num_instances, draw.first,
+                                                    params.base_instance};
+            std::memcpy(commands_ptr, &command, sizeof(command));
+            commands_ptr += sizeof(command);
+        }
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_Index);
+    params.index_format = MaxwellToGL::IndexFormat(regs.index_array.format);
+
+    // Upload the indices of all the draws at once
+    const auto [first, count] = GetBatchedRange(draws);
+    const std::size_t index_size = regs.index_array.FormatSizeInBytes();
+    const auto [index_buffer, index_offset] = buffer_cache.UploadMemory(
+        regs.index_array.StartAddress() + first * index_size, count * index_size);
+    glVertexArrayElementBuffer(vao, index_buffer);
+
+    // Indirect commands address the indices from the start of the element buffer
+    const auto base_index = static_cast<GLuint>(index_offset / index_size);
+    const std::size_t commands_size = draws.size() * sizeof(DrawElementsIndirectCommand);
+    u8* commands_ptr;
+    std::tie(commands_ptr, params.indirect_offset) = buffer_cache.ReserveMemory(commands_size, 4);
+    for (const auto& draw : draws) {
+        const DrawElementsIndirectCommand command{draw.count, draw.num_instances,
+                                                  base_index + draw.first - first,
+                                                  static_cast<GLint>(draw.base_vertex),
+                                                  params.base_instance};
+        std::memcpy(commands_ptr, &command, sizeof(command));
+        commands_ptr += sizeof(command);
+    }
+}
+
+bool RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
     MICROPROFILE_SCOPE(OpenGL_Shader);
     auto& gpu = system.GPU().Maxwell3D();
 
@@ -324,9 +550,32 @@ void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
         bind_ubo_pushbuffer.Push(buffer_cache.GetHandle(), offset,
                                  static_cast<GLsizeiptr>(sizeof(ubo)));
 
+        // Transform feedback captures the outputs of the last stage before rasterization
+        const bool is_geometry_enabled = gpu.regs.IsShaderConfigEnabled(
+            static_cast<std::size_t>(Maxwell::ShaderProgram::Geometry));
+        const bool use_transform_feedback =
+            gpu.regs.tfb_enabled != 0 &&
+            (program == Maxwell::ShaderProgram::Geometry ||
+             (program != Maxwell::ShaderProgram::Fragment && !is_geometry_enabled));
+
         Shader shader{shader_cache.GetStageProgram(program)};
         const auto [program_handle, next_bindings] =
-            shader->GetProgramHandle(primitive_mode, base_bindings);
+            use_transform_feedback
+                ? shader->GetTransformFeedbackHandle(primitive_mode, base_bindings,
+                                                     GetTransformFeedbackConfig(gpu.regs))
+                : shader->GetProgramHandle(primitive_mode, base_bindings);
+        if (program_handle == 0) {
+            // The program is still being built in the background
+            return false;
+        }
+
+        if (use_transform_feedback) {
+            GLint output_type = static_cast<GLint>(primitive_mode);
+            if (program == Maxwell::ShaderProgram::Geometry) {
+                glGetProgramiv(program_handle, GL_GEOMETRY_OUTPUT_TYPE, &output_type);
+            }
+            transform_feedback_mode = GetTransformFeedbackMode(static_cast<GLenum>(output_type));
+        }
 
         switch (program) {
         case Maxwell::ShaderProgram::VertexA:
@@ -372,44 +621,7 @@ void RasterizerOpenGL::SetupShaders(GLenum primitive_mode) {
     SyncClipEnabled(clip_distances);
 
     gpu.dirty_flags.shaders = false;
-}
-
-void RasterizerOpenGL::SetupCachedFramebuffer(const FramebufferCacheKey& fbkey,
-                                              OpenGLState& current_state) {
-    const auto [entry, is_cache_miss] = framebuffer_cache.try_emplace(fbkey);
-    auto& framebuffer = entry->second;
-
-    if (is_cache_miss)
-        framebuffer.Create();
-
-    current_state.draw.draw_framebuffer = framebuffer.handle;
-    current_state.ApplyFramebufferState();
-
-    if (!is_cache_miss)
-        return;
-
-    if (fbkey.is_single_buffer) {
-        if (fbkey.color_attachments[0] != GL_NONE) {
-            glFramebufferTexture(GL_DRAW_FRAMEBUFFER, fbkey.color_attachments[0], fbkey.colors[0],
-                                 0);
-        }
-        glDrawBuffer(fbkey.color_attachments[0]);
-    } else {
-        for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
-            if (fbkey.colors[index]) {
-                glFramebufferTexture(GL_DRAW_FRAMEBUFFER,
-                                     GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index),
-                                     fbkey.colors[index], 0);
-            }
-        }
-        glDrawBuffers(fbkey.colors_count, fbkey.color_attachments.data());
-    }
-
-    if (fbkey.zeta) {
-        GLenum zeta_attachment =
-            fbkey.stencil_enable ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
-        glFramebufferTexture(GL_DRAW_FRAMEBUFFER, zeta_attachment, fbkey.zeta, 0);
-    }
+    return true;
 }
 
 std::size_t RasterizerOpenGL::CalculateVertexArraysSize() const {
@@ -431,10 +643,14 @@ std::size_t RasterizerOpenGL::CalculateVertexArraysSize() const {
 }
 
 std::size_t RasterizerOpenGL::CalculateIndexBufferSize() const {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    const auto& gpu = system.GPU().Maxwell3D();
+    const auto& regs = gpu.regs;
 
-    return static_cast<std::size_t>(regs.index_array.count) *
-           static_cast<std::size_t>(regs.index_array.FormatSizeInBytes());
+    std::size_t count = regs.index_array.count;
+    if (!gpu.state.batched_draws.empty()) {
+        count = GetBatchedRange(gpu.state.batched_draws).second;
+    }
+    return count * static_cast<std::size_t>(regs.index_array.FormatSizeInBytes());
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
@@ -443,44 +659,23 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
     return true;
 }
 
-template <typename Map, typename Interval>
-static constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
-    return boost::make_iterator_range(map.equal_range(interval));
-}
-
 void RasterizerOpenGL::UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {
-    const u64 page_start{addr >> Memory::PAGE_BITS};
-    const u64 page_end{(addr + size + Memory::PAGE_SIZE - 1) >> Memory::PAGE_BITS};
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = CachedPageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0)
-        cached_pages.add({pages_interval, delta});
-
-    for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const VAddr interval_start_addr = boost::icl::first(interval) << Memory::PAGE_BITS;
-        const VAddr interval_end_addr = boost::icl::last_next(interval) << Memory::PAGE_BITS;
-        const u64 interval_size = interval_end_addr - interval_start_addr;
+    cached_pages.Update(addr, size, delta);
+}
 
-        if (delta > 0 && count == delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        else if (delta < 0 && count == -delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        else
-            ASSERT(count >= 0);
+void RasterizerOpenGL::TickFrame() {
+    if (res_cache.TickFrame()) {
+        // Units not used by the next draws could still name the textures of evicted surfaces
+        for (auto& texture_unit : state.texture_units) {
+            texture_unit.texture = 0;
+        }
     }
-
-    if (delta < 0)
-        cached_pages.add({pages_interval, delta});
 }
 
 void RasterizerOpenGL::LoadDiskResources(const std::atomic_bool& stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
     shader_cache.LoadDiskCache(stop_loading, callback);
+    res_cache.LoadDiskCache();
 }
 
 std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
@@ -512,6 +707,7 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
     current_state.framebuffer_srgb.enabled = regs.framebuffer_srgb != 0;
 
     FramebufferCacheKey fbkey;
+    FramebufferCacheOpenGL::ColorSurfaces color_surfaces;
 
     if (using_color_fb) {
         if (single_color_target) {
@@ -523,6 +719,7 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
                 // Assume that a surface will be written to if it is used as a framebuffer, even if
                 // the shader doesn't actually write to it.
                 color_surface->MarkAsModified(true, res_cache);
+                color_surface->Commit();
                 // Workaround for and issue in nvidia drivers
                 // https://devtalk.nvidia.com/default/topic/776591/opengl/gl_framebuffer_srgb-functions-incorrectly/
                 state.framebuffer_srgb.enabled |= color_surface->GetSurfaceParams().srgb_conversion;
@@ -532,6 +729,7 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
             fbkey.color_attachments[0] =
                 GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(*single_color_target);
             fbkey.colors[0] = color_surface != nullptr ? color_surface->Texture().handle : 0;
+            color_surfaces[0] = std::move(color_surface);
         } else {
             // Multiple color attachments are enabled
             for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
@@ -541,6 +739,7 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
                     // Assume that a surface will be written to if it is used as a framebuffer, even
                     // if the shader doesn't actually write to it.
                     color_surface->MarkAsModified(true, res_cache);
+                    color_surface->Commit();
                     // Enable sRGB only for supported formats
                     // Workaround for and issue in nvidia drivers
                     // https://devtalk.nvidia.com/default/topic/776591/opengl/gl_framebuffer_srgb-functions-incorrectly/
@@ -552,6 +751,7 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
                     GL_COLOR_ATTACHMENT0 + regs.rt_control.GetMap(index);
                 fbkey.colors[index] =
                     color_surface != nullptr ? color_surface->Texture().handle : 0;
+                color_surfaces[index] = std::move(color_surface);
             }
             fbkey.is_single_buffer = false;
             fbkey.colors_count = regs.rt_control.count;
@@ -561,18 +761,31 @@ std::pair<bool, bool> RasterizerOpenGL::ConfigureFramebuffers(
         fbkey.is_single_buffer = true;
     }
 
+    // Viewports and scissors are given in guest pixels, they are scaled to the attachments
+    const float scale = res_cache.SyncFramebufferScale(color_surfaces, depth_surface);
+    for (std::size_t index = 0; index < color_surfaces.size(); ++index) {
+        if (color_surfaces[index]) {
+            fbkey.colors[index] = color_surfaces[index]->Texture().handle;
+        }
+    }
+    if (scale != framebuffer_scale) {
+        framebuffer_scale = scale;
+        gpu.dirty_flags.state.set(DirtyFlags::Viewport);
+        gpu.dirty_flags.state.set(DirtyFlags::Scissor);
+    }
+
     if (depth_surface) {
         // Assume that a surface will be written to if it is used as a framebuffer, even if
         // the shader doesn't actually write to it.
         depth_surface->MarkAsModified(true, res_cache);
+        depth_surface->Commit();
 
         fbkey.zeta = depth_surface->Texture().handle;
         fbkey.stencil_enable = regs.stencil_enable &&
                                depth_surface->GetSurfaceParams().type == SurfaceType::DepthStencil;
     }
 
-    SetupCachedFramebuffer(fbkey, current_state);
-    SyncViewport(current_state);
+    framebuffer_cache.Bind(fbkey, color_surfaces, depth_surface, current_state);
 
     return current_depth_stencil_usage = {static_cast<bool>(depth_surface), fbkey.stencil_enable};
 }
@@ -641,6 +854,9 @@ void RasterizerOpenGL::Clear() {
 
     const auto [clear_depth, clear_stencil] = ConfigureFramebuffers(
         clear_state, use_color, use_depth || use_stencil, false, regs.clear_buffers.RT.Value());
+    gpu_profiler.BeginRenderPass(clear_state.draw.draw_framebuffer);
+    MICROPROFILE_SCOPEGPU(OpenGL_GpuClear);
+    SyncViewport(clear_state);
     if (regs.clear_flags.scissor) {
         SyncScissorTest(clear_state);
     }
@@ -649,11 +865,51 @@ void RasterizerOpenGL::Clear() {
         clear_state.EmulateViewportWithScissor();
     }
 
+    // Clears that write every texel of a surface are recorded on it. Clearing it again to the same
+    // value is skipped and flushing it writes the value instead of reading the texture back.
+    Surface fast_color_surface;
+    Surface fast_zeta_surface;
+    if (!condition_counter) {
+        const auto& viewport = clear_state.viewports[0];
+        if (use_color && regs.clear_buffers.R && regs.clear_buffers.G && regs.clear_buffers.B &&
+            regs.clear_buffers.A) {
+            fast_color_surface = res_cache.GetColorBufferSurface(regs.clear_buffers.RT, false);
+            if (!IsSurfaceCovered(fast_color_surface, viewport)) {
+                fast_color_surface = {};
+            }
+        }
+        if (clear_depth && regs.clear_buffers.Z) {
+            fast_zeta_surface = res_cache.GetDepthBufferSurface(false);
+            if (!IsSurfaceCovered(fast_zeta_surface, viewport) ||
+                (fast_zeta_surface->GetSurfaceParams().type == SurfaceType::DepthStencil &&
+                 !IsStencilFullyCleared(regs, clear_stencil))) {
+                fast_zeta_surface = {};
+            }
+        }
+    }
+    const FastClearValue color_value{
+        {regs.clear_color[0], regs.clear_color[1], regs.clear_color[2], regs.clear_color[3]}};
+    const FastClearValue zeta_value{{}, regs.clear_depth, clear_stencil ? regs.clear_stencil : 0};
+    const bool is_color_redundant =
+        !use_color ||
+        (fast_color_surface && fast_color_surface->GetFastClearValue() == color_value);
+    const bool is_zeta_redundant =
+        !(use_depth || use_stencil) ||
+        (fast_zeta_surface && fast_zeta_surface->GetFastClearValue() == zeta_value);
+    if (is_color_redundant && is_zeta_redundant) {
+        // The surfaces haven't been modified since they were cleared to the same values
+        return;
+    }
+
     clear_state.ApplyColorMask();
     clear_state.ApplyDepth();
     clear_state.ApplyStencilTest();
     clear_state.ApplyViewport();
 
+    if (condition_counter) {
+        glBeginConditionalRender(condition_counter->GetHandle(), GL_QUERY_WAIT);
+    }
+
     if (use_color) {
         glClearBufferfv(GL_COLOR, regs.clear_buffers.RT, regs.clear_color);
     }
@@ -665,17 +921,31 @@ void RasterizerOpenGL::Clear() {
     } else if (clear_stencil) {
         glClearBufferiv(GL_STENCIL, 0, &regs.clear_stencil);
     }
+
+    if (condition_counter) {
+        glEndConditionalRender();
+    }
+
+    if (fast_color_surface) {
+        fast_color_surface->MarkAsFastCleared(color_value);
+    }
+    if (fast_zeta_surface) {
+        fast_zeta_surface->MarkAsFastCleared(zeta_value);
+    }
 }
 
 void RasterizerOpenGL::DrawArrays() {
     if (accelerate_draw == AccelDraw::Disabled)
         return;
 
-    MICROPROFILE_SCOPE(OpenGL_Drawing);
+    TRACE_SCOPE(OpenGL_Drawing);
     auto& gpu = system.GPU().Maxwell3D();
     const auto& regs = gpu.regs;
 
     ConfigureFramebuffers(state);
+    gpu_profiler.BeginRenderPass(state.draw.draw_framebuffer);
+    MICROPROFILE_SCOPEGPU(OpenGL_GpuDraw);
+    SyncViewport(state);
     SyncColorMask();
     SyncFragmentColorClampState();
     SyncMultiSampleState();
@@ -691,6 +961,7 @@ void RasterizerOpenGL::DrawArrays() {
     SyncPointState();
     CheckAlphaTests();
     SyncPolygonOffset();
+    query_cache.UpdateCounters();
     // TODO(bunnei): Sync framebuffer_scale uniform here
     // TODO(bunnei): Sync scissorbox uniform(s) here
 
@@ -702,8 +973,11 @@ void RasterizerOpenGL::DrawArrays() {
     // Add space for index buffer (keeping in mind non-core primitives)
     switch (regs.draw.topology) {
     case Maxwell::PrimitiveTopology::Quads:
-        buffer_size = Common::AlignUp(buffer_size, 4) +
-                      primitive_assembler.CalculateQuadSize(regs.vertex_buffer.count);
+        // Non-indexed quads use indices that live outside of the stream buffer
+        if (is_indexed) {
+            buffer_size = Common::AlignUp(buffer_size, device.GetShaderStorageBufferAlignment()) +
+                          Common::AlignUp(CalculateIndexBufferSize(), 4);
+        }
         break;
     default:
         if (is_indexed) {
@@ -712,6 +986,10 @@ void RasterizerOpenGL::DrawArrays() {
         break;
     }
 
+    // Indirect commands of batched draws
+    buffer_size = Common::AlignUp<std::size_t>(buffer_size, 4) +
+                  gpu.state.batched_draws.size() * sizeof(DrawElementsIndirectCommand);
+
     // Uniform space for the 5 shader stages
     buffer_size = Common::AlignUp<std::size_t>(buffer_size, 4) +
                   (sizeof(GLShader::MaxwellUniformData) + device.GetUniformBufferAlignment()) *
@@ -730,21 +1008,91 @@ void RasterizerOpenGL::DrawArrays() {
     const GLuint vao = SetupVertexFormat();
     SetupVertexBuffer(vao);
 
-    DrawParameters params = SetupDraw();
-    SetupShaders(params.primitive_mode);
+    DrawParameters params = SetupDraw(vao);
+    if (!SetupShaders(params.primitive_mode)) {
+        // Skip the draw until all of its programs have been built
+        buffer_cache.Unmap();
+        accelerate_draw = AccelDraw::Disabled;
+        return;
+    }
 
     buffer_cache.Unmap();
 
+    if (params.quad_index_size != 0) {
+        MICROPROFILE_SCOPE(OpenGL_PrimitiveAssembly);
+        GLuint index_buffer;
+        std::tie(index_buffer, params.index_buffer_offset) = primitive_assembler.ConvertQuadIndexed(
+            state, params.quad_index_buffer, params.quad_index_offset, params.quad_index_size,
+            regs.index_array.count);
+        glVertexArrayElementBuffer(vao, index_buffer);
+    }
+
     shader_program_manager->ApplyTo(state);
     state.Apply();
 
     res_cache.SignalPreDrawCall();
+    if (condition_counter) {
+        glBeginConditionalRender(condition_counter->GetHandle(), GL_QUERY_WAIT);
+    }
+    const bool use_transform_feedback = regs.tfb_enabled != 0;
+    if (use_transform_feedback) {
+        glBeginTransformFeedback(transform_feedback_mode);
+    }
     params.DispatchDraw();
+    if (use_transform_feedback) {
+        glEndTransformFeedback();
+    }
+    if (condition_counter) {
+        glEndConditionalRender();
+    }
     res_cache.SignalPostDrawCall();
 
     accelerate_draw = AccelDraw::Disabled;
 }
 
+void RasterizerOpenGL::DispatchCompute(GPUVAddr code_addr) {
+    TRACE_SCOPE(OpenGL_Compute);
+    MICROPROFILE_SCOPEGPU(OpenGL_GpuCompute);
+    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+
+    const Shader kernel = shader_cache.GetComputeKernel(code_addr);
+
+    const KernelConfig config{
+        {launch_desc.block_dim_x, launch_desc.block_dim_y, launch_desc.block_dim_z},
+        launch_desc.local_pos_alloc,
+        launch_desc.shared_alloc};
+    state.draw.shader_program = kernel->GetKernelHandle(config);
+
+    // Add space for all the constant buffers of the launch
+    const std::size_t buffer_size = Tegra::Engines::KeplerCompute::NumConstBuffers *
+                                    (MaxConstbufferSize + device.GetUniformBufferAlignment());
+    if (buffer_cache.Map(buffer_size)) {
+        // As all cached buffers are invalidated, we need to recheck their state.
+        system.GPU().Maxwell3D().dirty_flags.vertex_array.set();
+    }
+
+    // Kernels are not linked with other stages, so their resources are bound from zero
+    bind_ubo_pushbuffer.Setup(0);
+    bind_ssbo_pushbuffer.Setup(0);
+
+    SetupComputeConstBuffers(kernel);
+    SetupComputeGlobalRegions(kernel);
+
+    buffer_cache.Unmap();
+
+    SetupComputeTextures(kernel);
+
+    bind_ubo_pushbuffer.Bind();
+    bind_ssbo_pushbuffer.Bind();
+
+    state.Apply();
+
+    glDispatchCompute(launch_desc.grid_dim_x, launch_desc.grid_dim_y, launch_desc.grid_dim_z);
+
+    // Global memory written by the kernel may be read by the following draws and dispatches
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
 void RasterizerOpenGL::FlushAll() {}
 
 void RasterizerOpenGL::FlushRegion(CacheAddr addr, u64 size) {
@@ -754,6 +1102,16 @@ void RasterizerOpenGL::FlushRegion(CacheAddr addr, u64 size) {
     }
     res_cache.FlushRegion(addr, size);
     global_cache.FlushRegion(addr, size);
+    buffer_cache.FlushRegion(addr, size);
+    query_cache.FlushRegion(addr, size);
+}
+
+bool RasterizerOpenGL::MustFlushRegion(CacheAddr addr, u64 size) {
+    if (!addr || !size) {
+        return false;
+    }
+    return res_cache.MustFlushRegion(addr, size) || global_cache.MustFlushRegion(addr, size) ||
+           buffer_cache.MustFlushRegion(addr, size) || query_cache.MustFlushRegion(addr, size);
 }
 
 void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
@@ -765,6 +1123,8 @@ void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
     shader_cache.InvalidateRegion(addr, size);
     global_cache.InvalidateRegion(addr, size);
     buffer_cache.InvalidateRegion(addr, size);
+    query_cache.InvalidateRegion(addr, size);
+    system.GPU().Maxwell3D().InvalidateDescriptorCache(addr, size);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
@@ -774,13 +1134,57 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
 
 bool RasterizerOpenGL::AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                              const Tegra::Engines::Fermi2D::Regs::Surface& dst,
-                                             const Common::Rectangle<u32>& src_rect,
-                                             const Common::Rectangle<u32>& dst_rect) {
+                                             const Tegra::Engines::Fermi2D::Config& copy_config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
-    res_cache.FermiCopySurface(src, dst, src_rect, dst_rect);
+    return res_cache.FermiCopySurface(src, dst, copy_config);
+}
+
+bool RasterizerOpenGL::AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    return res_cache.AccelerateDMACopy(regs);
+}
+
+bool RasterizerOpenGL::AccelerateInlineToMemory(GPUVAddr address, const u8* data,
+                                                std::size_t size) {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    auto& memory_manager = system.GPU().MemoryManager();
+    if (!memory_manager.IsBlockContinuous(address, size)) {
+        return false;
+    }
+    const CacheAddr addr = ToCacheAddr(memory_manager.GetPointer(address));
+    if (!buffer_cache.InlineMemory(addr, data, size)) {
+        return false;
+    }
+
+    // The cached buffers are up to date, only the other caches lose the range
+    res_cache.InvalidateRegion(addr, size);
+    shader_cache.InvalidateRegion(addr, size);
+    global_cache.InvalidateRegion(addr, size);
+    query_cache.InvalidateRegion(addr, size);
+    system.GPU().Maxwell3D().InvalidateDescriptorCache(addr, size);
+    memory_manager.WriteBlockUnsafe(address, data, size);
+    return true;
+}
+
+bool RasterizerOpenGL::Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                             std::optional<u64> timestamp) {
+    query_cache.Query(gpu_addr, type, timestamp);
     return true;
 }
 
+void RasterizerOpenGL::ResetCounter(VideoCore::QueryType type) {
+    query_cache.ResetCounter(type);
+}
+
+bool RasterizerOpenGL::AccelerateConditionalRendering(GPUVAddr address) {
+    condition_counter = query_cache.GetIndependentCounter(address);
+    return condition_counter != nullptr;
+}
+
+void RasterizerOpenGL::DisableConditionalRendering() {
+    condition_counter.reset();
+}
+
 bool RasterizerOpenGL::AccelerateDisplay(const Tegra::FramebufferConfig& config,
                                          VAddr framebuffer_addr, u32 pixel_stride) {
     if (!framebuffer_addr) {
@@ -817,62 +1221,98 @@ void RasterizerOpenGL::SetupConstBuffers(Tegra::Engines::Maxwell3D::Regs::Shader
     const auto& gpu = system.GPU();
     const auto& maxwell3d = gpu.Maxwell3D();
     const auto& shader_stage = maxwell3d.state.shader_stages[static_cast<std::size_t>(stage)];
-    const auto& entries = shader->GetShaderEntries().const_buffers;
 
     // Upload only the enabled buffers from the 16 constbuffers of each shader stage
-    for (u32 bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
-        const auto& used_buffer = entries[bindpoint];
-        const auto& buffer = shader_stage.const_buffers[used_buffer.GetIndex()];
+    for (const auto& entry : shader->GetShaderEntries().const_buffers) {
+        SetupConstBuffer(shader_stage.const_buffers[entry.GetIndex()], entry);
+    }
+}
 
-        if (!buffer.enabled) {
-            // Set values to zero to unbind buffers
-            bind_ubo_pushbuffer.Push(0, 0, 0);
-            continue;
-        }
+void RasterizerOpenGL::SetupComputeConstBuffers(const Shader& kernel) {
+    MICROPROFILE_SCOPE(OpenGL_UBO);
+    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+    const u32 enable_mask = launch_desc.memory_config.const_buffer_enable_mask;
+
+    for (const auto& entry : kernel->GetShaderEntries().const_buffers) {
+        const u32 index = entry.GetIndex();
+        ASSERT(index < Tegra::Engines::KeplerCompute::NumConstBuffers);
+        const auto& config = launch_desc.const_buffer_config[index];
+
+        Tegra::Engines::Maxwell3D::State::ConstBufferInfo buffer;
+        buffer.address = config.Address();
+        buffer.index = index;
+        buffer.size = config.size;
+        buffer.enabled = ((enable_mask >> index) & 1) != 0;
+        SetupConstBuffer(buffer, entry);
+    }
+}
 
-        std::size_t size = 0;
+void RasterizerOpenGL::SetupConstBuffer(
+    const Tegra::Engines::Maxwell3D::State::ConstBufferInfo& buffer,
+    const GLShader::ConstBufferEntry& entry) {
+    if (!buffer.enabled) {
+        // Set values to zero to unbind buffers
+        bind_ubo_pushbuffer.Push(0, 0, 0);
+        return;
+    }
 
-        if (used_buffer.IsIndirect()) {
-            // Buffer is accessed indirectly, so upload the entire thing
-            size = buffer.size;
+    std::size_t size = 0;
 
-            if (size > MaxConstbufferSize) {
-                LOG_WARNING(Render_OpenGL, "Indirect constbuffer size {} exceeds maximum {}", size,
-                            MaxConstbufferSize);
-                size = MaxConstbufferSize;
-            }
-        } else {
-            // Buffer is accessed directly, upload just what we use
-            size = used_buffer.GetSize();
+    if (entry.IsIndirect()) {
+        // Buffer is accessed indirectly, so upload the entire thing
+        size = buffer.size;
+
+        if (size > MaxConstbufferSize) {
+            LOG_WARNING(Render_OpenGL, "Indirect constbuffer size {} exceeds maximum {}", size,
+                        MaxConstbufferSize);
+            size = MaxConstbufferSize;
         }
+    } else {
+        // Buffer is accessed directly, upload just what we use
+        size = entry.GetSize();
+    }
 
-        // Align the actual size so it ends up being a multiple of vec4 to meet the OpenGL std140
-        // UBO alignment requirements.
-        size = Common::AlignUp(size, sizeof(GLvec4));
-        ASSERT_MSG(size <= MaxConstbufferSize, "Constbuffer too big");
+    // Align the actual size so it ends up being a multiple of vec4 to meet the OpenGL std140
+    // UBO alignment requirements.
+    size = Common::AlignUp(size, sizeof(GLvec4));
+    ASSERT_MSG(size <= MaxConstbufferSize, "Constbuffer too big");
 
-        const GLintptr const_buffer_offset =
-            buffer_cache.UploadMemory(buffer.address, size, device.GetUniformBufferAlignment());
+    // Unchanged constant buffers are reused from the buffer cache, the guest writing them
+    // invalidates the cached copy
+    const auto [const_buffer, const_buffer_offset] =
+        buffer_cache.UploadConstBuffer(buffer.address, size, device.GetUniformBufferAlignment());
 
-        bind_ubo_pushbuffer.Push(buffer_cache.GetHandle(), const_buffer_offset, size);
-    }
+    bind_ubo_pushbuffer.Push(const_buffer, const_buffer_offset, size);
 }
 
 void RasterizerOpenGL::SetupGlobalRegions(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
                                           const Shader& shader, GLenum primitive_mode,
                                           BaseBindings base_bindings) {
-    const auto& entries = shader->GetShaderEntries().global_memory_entries;
-    for (std::size_t bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
-        const auto& entry{entries[bindpoint]};
-        const auto& region{global_cache.GetGlobalRegion(entry, stage)};
-        if (entry.IsWritten()) {
-            region->MarkAsModified(true, global_cache);
-        }
-        bind_ssbo_pushbuffer.Push(region->GetBufferHandle(), 0,
-                                  static_cast<GLsizeiptr>(region->GetSizeInBytes()));
+    const auto& maxwell3d = system.GPU().Maxwell3D();
+    const auto& shader_stage = maxwell3d.state.shader_stages[static_cast<std::size_t>(stage)];
+    for (const auto& entry : shader->GetShaderEntries().global_memory_entries) {
+        SetupGlobalRegion(entry, shader_stage.const_buffers[entry.GetCbufIndex()].address);
     }
 }
 
+void RasterizerOpenGL::SetupComputeGlobalRegions(const Shader& kernel) {
+    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+    for (const auto& entry : kernel->GetShaderEntries().global_memory_entries) {
+        ASSERT(entry.GetCbufIndex() < Tegra::Engines::KeplerCompute::NumConstBuffers);
+        SetupGlobalRegion(entry, launch_desc.const_buffer_config[entry.GetCbufIndex()].Address());
+    }
+}
+
+void RasterizerOpenGL::SetupGlobalRegion(const GLShader::GlobalMemoryEntry& entry,
+                                         GPUVAddr cbuf_addr) {
+    const auto& region{global_cache.GetGlobalRegion(entry, cbuf_addr)};
+    if (entry.IsWritten()) {
+        region->MarkAsModified(true, global_cache);
+    }
+    bind_ssbo_pushbuffer.Push(region->GetBufferHandle(), region->GetBufferOffset(),
+                              static_cast<GLsizeiptr>(region->GetSizeInBytes()));
+}
+
 void RasterizerOpenGL::SetupTextures(Maxwell::ShaderStage stage, const Shader& shader,
                                      GLuint program_handle, BaseBindings base_bindings) {
     MICROPROFILE_SCOPE(OpenGL_Texture);
@@ -880,38 +1320,83 @@ void RasterizerOpenGL::SetupTextures(Maxwell::ShaderStage stage, const Shader& s
     const auto& maxwell3d = gpu.Maxwell3D();
     const auto& entries = shader->GetShaderEntries().samplers;
 
-    ASSERT_MSG(base_bindings.sampler + entries.size() <= std::size(state.texture_units),
+    std::size_t num_samplers = 0;
+    for (const auto& entry : entries) {
+        num_samplers += entry.GetSize();
+    }
+    ASSERT_MSG(base_bindings.sampler + num_samplers <= std::size(state.texture_units),
                "Exceeded the number of active textures.");
 
-    for (u32 bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
-        const auto& entry = entries[bindpoint];
-        Tegra::Texture::FullTextureInfo texture;
-        if (entry.IsBindless()) {
-            const auto cbuf = entry.GetBindlessCBuf();
-            Tegra::Texture::TextureHandle tex_handle;
-            tex_handle.raw = maxwell3d.AccessConstBuffer32(stage, cbuf.first, cbuf.second);
-            texture = maxwell3d.GetTextureInfo(tex_handle, entry.GetOffset());
-        } else {
-            texture = maxwell3d.GetStageTexture(stage, entry.GetOffset());
+    u32 current_bindpoint = base_bindings.sampler;
+    for (const auto& entry : entries) {
+        // Indexed samplers take a unit for each of their consecutive handles
+        for (u32 element = 0; element < entry.GetSize(); ++element, ++current_bindpoint) {
+            Tegra::Texture::FullTextureInfo texture;
+            if (entry.IsBindless()) {
+                const auto cbuf = entry.GetBindlessCBuf();
+                Tegra::Texture::TextureHandle tex_handle;
+                tex_handle.raw =
+                    maxwell3d.AccessConstBuffer32(stage, cbuf.first, cbuf.second + element * 4);
+                texture = maxwell3d.GetTextureInfo(tex_handle, entry.GetOffset());
+            } else {
+                texture = maxwell3d.GetStageTexture(stage, entry.GetOffset());
+            }
+            SetupTexture(current_bindpoint, texture, entry);
         }
-        const u32 current_bindpoint = base_bindings.sampler + bindpoint;
-
-        state.texture_units[current_bindpoint].sampler = sampler_cache.GetSampler(texture.tsc);
+    }
+}
 
-        if (Surface surface = res_cache.GetTextureSurface(texture, entry); surface) {
-            state.texture_units[current_bindpoint].texture =
-                surface->Texture(entry.IsArray()).handle;
-            surface->UpdateSwizzle(texture.tic.x_source, texture.tic.y_source, texture.tic.z_source,
-                                   texture.tic.w_source);
-        } else {
-            // Can occur when texture addr is null or its memory is unmapped/invalid
-            state.texture_units[current_bindpoint].texture = 0;
+void RasterizerOpenGL::SetupComputeTextures(const Shader& kernel) {
+    MICROPROFILE_SCOPE(OpenGL_Texture);
+    const auto& kepler_compute = system.GPU().KeplerCompute();
+    const auto& entries = kernel->GetShaderEntries().samplers;
+
+    u32 current_bindpoint = 0;
+    for (const auto& entry : entries) {
+        for (u32 element = 0; element < entry.GetSize(); ++element, ++current_bindpoint) {
+            ASSERT_MSG(current_bindpoint < std::size(state.texture_units),
+                       "Exceeded the number of active textures.");
+            Tegra::Texture::FullTextureInfo texture;
+            if (entry.IsBindless()) {
+                const auto cbuf = entry.GetBindlessCBuf();
+                Tegra::Texture::TextureHandle tex_handle;
+                tex_handle.raw =
+                    kepler_compute.AccessConstBuffer32(cbuf.first, cbuf.second + element * 4);
+                texture = kepler_compute.GetTextureInfo(tex_handle, entry.GetOffset());
+            } else {
+                texture = kepler_compute.GetTexture(entry.GetOffset() + element);
+            }
+            SetupTexture(current_bindpoint, texture, entry);
         }
     }
 }
 
+void RasterizerOpenGL::SetupTexture(u32 binding, const Tegra::Texture::FullTextureInfo& texture,
+                                    const GLShader::SamplerEntry& entry) {
+    state.texture_units[binding].sampler = sampler_cache.GetSampler(texture.tsc, binding);
+
+    if (Surface surface = res_cache.GetTextureSurface(texture, entry); surface) {
+        // Surfaces also rendered to by the draw are synchronized or copied by the cache
+        state.texture_units[binding].texture =
+            res_cache.GetSampledTexture(surface, entry.IsArray());
+        surface->UpdateSwizzle(texture.tic.x_source, texture.tic.y_source, texture.tic.z_source,
+                               texture.tic.w_source);
+    } else {
+        // Can occur when texture addr is null or its memory is unmapped/invalid
+        state.texture_units[binding].texture = 0;
+    }
+}
+
 void RasterizerOpenGL::SyncViewport(OpenGLState& current_state) {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    // Temporary states, like the one used for clears, are always synced from scratch
+    const bool is_persistent_state = &current_state == &state;
+    if (is_persistent_state && !TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::Viewport)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    current_state.MarkDirty(OpenGLState::Group::Viewport);
+    state.MarkDirty(OpenGLState::Group::DepthClamp);
     const bool geometry_shaders_enabled =
         regs.IsShaderConfigEnabled(static_cast<size_t>(Maxwell::ShaderProgram::Geometry));
     const std::size_t viewport_count =
@@ -920,10 +1405,10 @@ void RasterizerOpenGL::SyncViewport(OpenGLState& current_state) {
         auto& viewport = current_state.viewports[i];
         const auto& src = regs.viewports[i];
         const Common::Rectangle<s32> viewport_rect{regs.viewport_transform[i].GetRect()};
-        viewport.x = viewport_rect.left;
-        viewport.y = viewport_rect.bottom;
-        viewport.width = viewport_rect.GetWidth();
-        viewport.height = viewport_rect.GetHeight();
+        viewport.x = ScaleCoordinate(viewport_rect.left, framebuffer_scale);
+        viewport.y = ScaleCoordinate(viewport_rect.bottom, framebuffer_scale);
+        viewport.width = ScaleCoordinate(viewport_rect.GetWidth(), framebuffer_scale);
+        viewport.height = ScaleCoordinate(viewport_rect.GetHeight(), framebuffer_scale);
         viewport.depth_range_far = src.depth_range_far;
         viewport.depth_range_near = src.depth_range_near;
     }
@@ -951,7 +1436,12 @@ void RasterizerOpenGL::SyncClipCoef() {
 }
 
 void RasterizerOpenGL::SyncCullMode() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::CullMode)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::Culling);
 
     state.cull.enabled = regs.cull.enabled != 0;
 
@@ -975,14 +1465,24 @@ void RasterizerOpenGL::SyncCullMode() {
 }
 
 void RasterizerOpenGL::SyncPrimitiveRestart() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::PrimitiveRestart)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::PrimitiveRestart);
 
     state.primitive_restart.enabled = regs.primitive_restart.enabled;
     state.primitive_restart.index = regs.primitive_restart.index;
 }
 
 void RasterizerOpenGL::SyncDepthTestState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::DepthTest)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::Depth);
 
     state.depth.test_enabled = regs.depth_test_enable != 0;
     state.depth.write_mask = regs.depth_write_enabled ? GL_TRUE : GL_FALSE;
@@ -994,7 +1494,12 @@ void RasterizerOpenGL::SyncDepthTestState() {
 }
 
 void RasterizerOpenGL::SyncStencilTestState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::StencilTest)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::Stencil);
     state.stencil.test_enabled = regs.stencil_enable != 0;
 
     if (!regs.stencil_enable) {
@@ -1028,7 +1533,12 @@ void RasterizerOpenGL::SyncStencilTestState() {
 }
 
 void RasterizerOpenGL::SyncColorMask() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::ColorMask)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::ColorMask);
     const std::size_t count =
         regs.independent_blend_enable ? Tegra::Engines::Maxwell3D::Regs::NumRenderTargets : 1;
     for (std::size_t i = 0; i < count; i++) {
@@ -1042,18 +1552,33 @@ void RasterizerOpenGL::SyncColorMask() {
 }
 
 void RasterizerOpenGL::SyncMultiSampleState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::MultiSample)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::Multisample);
     state.multisample_control.alpha_to_coverage = regs.multisample_control.alpha_to_coverage != 0;
     state.multisample_control.alpha_to_one = regs.multisample_control.alpha_to_one != 0;
 }
 
 void RasterizerOpenGL::SyncFragmentColorClampState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::FragmentColorClamp)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::FragmentColorClamp);
     state.fragment_color_clamp.enabled = regs.frag_color_clamp != 0;
 }
 
 void RasterizerOpenGL::SyncBlendState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::Blend)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::Blending);
 
     state.blend_color.red = regs.blend_color.r;
     state.blend_color.green = regs.blend_color.g;
@@ -1095,7 +1620,12 @@ void RasterizerOpenGL::SyncBlendState() {
 }
 
 void RasterizerOpenGL::SyncLogicOpState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::LogicOp)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::LogicOp);
 
     state.logic_op.enabled = regs.logic_op.enable != 0;
 
@@ -1109,7 +1639,14 @@ void RasterizerOpenGL::SyncLogicOpState() {
 }
 
 void RasterizerOpenGL::SyncScissorTest(OpenGLState& current_state) {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    // Temporary states, like the one used for clears, are always synced from scratch
+    const bool is_persistent_state = &current_state == &state;
+    if (is_persistent_state && !TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::Scissor)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    current_state.MarkDirty(OpenGLState::Group::Viewport);
     const bool geometry_shaders_enabled =
         regs.IsShaderConfigEnabled(static_cast<size_t>(Maxwell::ShaderProgram::Geometry));
     const std::size_t viewport_count =
@@ -1121,29 +1658,59 @@ void RasterizerOpenGL::SyncScissorTest(OpenGLState& current_state) {
         if (dst.enabled == 0) {
             return;
         }
-        const u32 width = src.max_x - src.min_x;
-        const u32 height = src.max_y - src.min_y;
-        dst.x = src.min_x;
-        dst.y = src.min_y;
-        dst.width = width;
-        dst.height = height;
+        dst.x = ScaleCoordinate(src.min_x, framebuffer_scale);
+        dst.y = ScaleCoordinate(src.min_y, framebuffer_scale);
+        dst.width = ScaleCoordinate(src.max_x, framebuffer_scale) - dst.x;
+        dst.height = ScaleCoordinate(src.max_y, framebuffer_scale) - dst.y;
     }
 }
 
 void RasterizerOpenGL::SyncTransformFeedback() {
     const auto& regs = system.GPU().Maxwell3D().regs;
-    UNIMPLEMENTED_IF_MSG(regs.tfb_enabled != 0, "Transform feedbacks are not implemented");
+    if (regs.tfb_enabled == 0) {
+        return;
+    }
+    for (std::size_t index = 0; index < Maxwell::NumTransformFeedbackBuffers; ++index) {
+        const auto& binding = regs.tfb_bindings[index];
+        const auto gl_index = static_cast<GLuint>(index);
+        if (binding.buffer_enable == 0 || binding.buffer_size <= binding.buffer_offset) {
+            glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, gl_index, 0);
+            continue;
+        }
+
+        // Vertices are captured from the buffer offset on, to a buffer that later draws can read
+        // vertices and constants from without a round-trip through guest memory
+        const GPUVAddr gpu_addr = binding.Address() + binding.buffer_offset;
+        const auto size = static_cast<std::size_t>(binding.buffer_size - binding.buffer_offset);
+        const auto [handle, offset] = buffer_cache.GetTransformFeedbackBuffer(gpu_addr, size);
+        if (handle == 0) {
+            glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, gl_index, 0);
+            continue;
+        }
+        glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, gl_index, handle, offset,
+                          static_cast<GLsizeiptr>(size));
+    }
 }
 
 void RasterizerOpenGL::SyncPointState() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::PointSize)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::PointSize);
     // Limit the point size to 1 since nouveau sometimes sets a point size of 0 (and that's invalid
     // in OpenGL).
     state.point.size = std::max(1.0f, regs.point_size);
 }
 
 void RasterizerOpenGL::SyncPolygonOffset() {
-    const auto& regs = system.GPU().Maxwell3D().regs;
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!TakeDirtyState(maxwell3d.dirty_flags, DirtyFlags::PolygonOffset)) {
+        return;
+    }
+    const auto& regs = maxwell3d.regs;
+    state.MarkDirty(OpenGLState::Group::PolygonOffset);
     state.polygon_offset.fill_enable = regs.polygon_offset_fill_enable != 0;
     state.polygon_offset.line_enable = regs.polygon_offset_line_enable != 0;
     state.polygon_offset.point_enable = regs.polygon_offset_point_enable != 0;
@@ -13,17 +13,19 @@
 #include <tuple>
 #include <utility>
 
-#include <boost/icl/interval_map.hpp>
 #include <glad/glad.h>
 
 #include "common/common_types.h"
+#include "video_core/cached_page_counter.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
 #include "video_core/renderer_opengl/gl_device.h"
+#include "video_core/renderer_opengl/gl_framebuffer_cache.h"
 #include "video_core/renderer_opengl/gl_global_cache.h"
 #include "video_core/renderer_opengl/gl_primitive_assembler.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_sampler_cache.h"
@@ -40,32 +42,44 @@ namespace Core::Frontend {
 class EmuWindow;
 }
 
+namespace VideoCore {
+class GpuProfiler;
+}
+
 namespace OpenGL {
 
 struct ScreenInfo;
 struct DrawParameters;
-struct FramebufferCacheKey;
 
 class RasterizerOpenGL : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerOpenGL(Core::System& system, Core::Frontend::EmuWindow& emu_window,
-                              ScreenInfo& info);
+                              ScreenInfo& info, VideoCore::GpuProfiler& gpu_profiler);
     ~RasterizerOpenGL() override;
 
     void DrawArrays() override;
     void Clear() override;
+    void DispatchCompute(GPUVAddr code_addr) override;
     void FlushAll() override;
     void FlushRegion(CacheAddr addr, u64 size) override;
     void InvalidateRegion(CacheAddr addr, u64 size) override;
+    bool MustFlushRegion(CacheAddr addr, u64 size) override;
     void FlushAndInvalidateRegion(CacheAddr addr, u64 size) override;
     bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                const Tegra::Engines::Fermi2D::Regs::Surface& dst,
-                               const Common::Rectangle<u32>& src_rect,
-                               const Common::Rectangle<u32>& dst_rect) override;
+                               const Tegra::Engines::Fermi2D::Config& copy_config) override;
+    bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) override;
     bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                            u32 pixel_stride) override;
+    bool AccelerateInlineToMemory(GPUVAddr address, const u8* data, std::size_t size) override;
+    bool Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+               std::optional<u64> timestamp) override;
+    void ResetCounter(VideoCore::QueryType type) override;
+    bool AccelerateConditionalRendering(GPUVAddr address) override;
+    void DisableConditionalRendering() override;
     bool AccelerateDrawBatch(bool is_indexed) override;
     void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) override;
+    void TickFrame() override;
     void LoadDiskResources(const std::atomic_bool& stop_loading,
                            const VideoCore::DiskResourceLoadCallback& callback) override;
 
@@ -109,15 +123,35 @@ private:
     void SetupConstBuffers(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage, const Shader& shader,
                            GLuint program_handle, BaseBindings base_bindings);
 
+    /// Configures the constbuffers of the current compute launch.
+    void SetupComputeConstBuffers(const Shader& kernel);
+
+    /// Uploads a constbuffer used by a shader and pushes its binding.
+    void SetupConstBuffer(const Tegra::Engines::Maxwell3D::State::ConstBufferInfo& buffer,
+                          const GLShader::ConstBufferEntry& entry);
+
     /// Configures the current global memory entries to use for the draw command.
     void SetupGlobalRegions(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
                             const Shader& shader, GLenum primitive_mode,
                             BaseBindings base_bindings);
 
+    /// Configures the global memory entries of the current compute launch.
+    void SetupComputeGlobalRegions(const Shader& kernel);
+
+    /// Pushes the binding of a global memory region described by the given constbuffer.
+    void SetupGlobalRegion(const GLShader::GlobalMemoryEntry& entry, GPUVAddr cbuf_addr);
+
     /// Configures the current textures to use for the draw command.
     void SetupTextures(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage, const Shader& shader,
                        GLuint program_handle, BaseBindings base_bindings);
 
+    /// Configures the textures of the current compute launch.
+    void SetupComputeTextures(const Shader& kernel);
+
+    /// Binds a texture and its sampler used by a shader to the given texture unit.
+    void SetupTexture(u32 binding, const Tegra::Texture::FullTextureInfo& texture,
+                      const GLShader::SamplerEntry& entry);
+
     /// Syncs the viewport and depth range to match the guest state
     void SyncViewport(OpenGLState& current_state);
 
@@ -180,24 +214,54 @@ private:
     RasterizerCacheOpenGL res_cache;
     ShaderCacheOpenGL shader_cache;
     GlobalRegionCacheOpenGL global_cache;
+    QueryCache query_cache;
+
+    /// Host counter deciding whether draws and clears are discarded, null when they never are
+    std::shared_ptr<HostCounter> condition_counter;
+
+    /// Primitive mode transform feedback is started with, set up with the shaders of the draw
+    GLenum transform_feedback_mode = GL_POINTS;
     SamplerCacheOpenGL sampler_cache;
 
     Core::System& system;
     ScreenInfo& screen_info;
+    VideoCore::GpuProfiler& gpu_profiler;
 
     std::unique_ptr<GLShader::ProgramManager> shader_program_manager;
+    /// Vertex buffer bound to a binding point of a vertex array
+    struct VertexBufferBinding {
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+        GLsizei stride = 0;
+        GLuint divisor = 0;
+
+        // Guest range uploaded to the buffer, and the buffer cache tick when it was uploaded
+        GPUVAddr start = 0;
+        u64 size = 0;
+        u64 invalidation_tick = 0;
+    };
+
+    struct VertexArrayEntry {
+        OGLVertexArray vao;
+        std::array<VertexBufferBinding, Tegra::Engines::Maxwell3D::Regs::NumVertexArrays>
+            bindings;
+    };
+
     std::map<std::array<Tegra::Engines::Maxwell3D::Regs::VertexAttribute,
                         Tegra::Engines::Maxwell3D::Regs::NumVertexAttributes>,
-             OGLVertexArray>
+             VertexArrayEntry>
         vertex_array_cache;
+    VertexArrayEntry* current_vertex_array = nullptr;
 
-    std::map<FramebufferCacheKey, OGLFramebuffer> framebuffer_cache;
+    FramebufferCacheOpenGL framebuffer_cache;
     FramebufferConfigState current_framebuffer_config_state;
     std::pair<bool, bool> current_depth_stencil_usage{};
+    /// Scale of the textures attached to the bound framebuffer
+    float framebuffer_scale = 1.0f;
 
     static constexpr std::size_t STREAM_BUFFER_SIZE = 128 * 1024 * 1024;
     OGLBufferCache buffer_cache;
-    PrimitiveAssembler primitive_assembler{buffer_cache};
+    PrimitiveAssembler primitive_assembler;
 
     BindBuffersRangePushBuffer bind_ubo_pushbuffer{GL_UNIFORM_BUFFER};
     BindBuffersRangePushBuffer bind_ssbo_pushbuffer{GL_SHADER_STORAGE_BUFFER};
@@ -209,19 +273,21 @@ private:
     /// Updates and returns a vertex array object representing current vertex format
     GLuint SetupVertexFormat();
 
+    /// Uploads the dirty vertex streams and binds the ones whose buffer changed
     void SetupVertexBuffer(GLuint vao);
 
-    DrawParameters SetupDraw();
+    DrawParameters SetupDraw(GLuint vao);
 
-    void SetupShaders(GLenum primitive_mode);
+    /// Uploads the indices and the indirect commands of the draws batched by the 3D engine
+    void SetupBatchedDraw(GLuint vao, DrawParameters& params);
 
-    void SetupCachedFramebuffer(const FramebufferCacheKey& fbkey, OpenGLState& current_state);
+    /// Binds the programs of the enabled stages. Returns false if any of them isn't built yet.
+    bool SetupShaders(GLenum primitive_mode);
 
     enum class AccelDraw { Disabled, Arrays, Indexed };
     AccelDraw accelerate_draw = AccelDraw::Disabled;
 
-    using CachedPageMap = boost::icl::interval_map<u64, int>;
-    CachedPageMap cached_pages;
+    VideoCommon::CachedPageCounter cached_pages;
 };
 
 } // namespace OpenGL
@@ -3,26 +3,31 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <optional>
 #include <glad/glad.h>
 
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
-#include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/memory_manager.h"
 #include "video_core/morton.h"
+#include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/utils.h"
 #include "video_core/surface.h"
 #include "video_core/textures/convert.h"
 #include "video_core/textures/decoders.h"
+#include "video_core/video_core.h"
 
 namespace OpenGL {
 
@@ -36,6 +41,10 @@ using VideoCore::Surface::PixelFormatFromRenderTargetFormat;
 using VideoCore::Surface::PixelFormatFromTextureFormat;
 using VideoCore::Surface::SurfaceTargetFromTextureType;
 
+/// Bounds of the resolution scale, surfaces have to fit in the maximum texture size
+constexpr float MIN_RESOLUTION_SCALE = 0.25f;
+constexpr float MAX_RESOLUTION_SCALE = 8.0f;
+
 struct FormatTuple {
     GLint internal_format;
     GLenum format;
@@ -44,6 +53,117 @@ struct FormatTuple {
     bool compressed;
 };
 
+/// Whether the host samples ASTC, set by the cache from the device. ASTC is decoded to RGBA8 on
+/// upload otherwise.
+static bool has_native_astc = false;
+
+/// Whether large layered surfaces are allocated as sparse textures, set by the cache from the
+/// device
+static bool has_sparse_texture = false;
+
+/// Surfaces smaller than this are fully allocated, committing them page by page isn't worth it
+constexpr std::size_t MinSparseTextureSize = 16 * 1024 * 1024;
+
+/// Minimum GL_MAX_ARRAY_TEXTURE_LAYERS, the layers sparse storages can be grown to
+constexpr u32 MaxSparseTextureLayers = 2048;
+
+/// Returns the size of a dimension of a texture allocated at the given scale
+static u32 ScaleDimension(u32 value, float scale) {
+    return std::max(1U, static_cast<u32>(value * scale + 0.5f));
+}
+
+/// Returns a rectangle of guest texels in the texels of a texture allocated at the given scale
+static Common::Rectangle<u32> ScaleRect(const Common::Rectangle<u32>& rect, float scale) {
+    const auto scale_coordinate = [scale](u32 value) {
+        return static_cast<u32>(value * scale + 0.5f);
+    };
+    return {scale_coordinate(rect.left), scale_coordinate(rect.top), scale_coordinate(rect.right),
+            scale_coordinate(rect.bottom)};
+}
+
+/// Converts a normalized value to an unsigned integer with the given maximum
+static u32 ToUnorm(float value, u32 max) {
+    return static_cast<u32>(std::lround(std::clamp(value, 0.0f, 1.0f) * max));
+}
+
+/**
+ * Encodes a clear value as a texel in the guest layout of a format.
+ * @returns The size of the texel in bytes, zero when the format is not supported
+ */
+static std::size_t EncodeClearValue(PixelFormat pixel_format, const FastClearValue& value,
+                                    std::array<u8, 16>& texel) {
+    const auto store = [&texel](const auto& data) {
+        std::memcpy(texel.data(), &data, sizeof(data));
+        return sizeof(data);
+    };
+    const auto& color = value.color;
+    const u32 stencil = static_cast<u32>(value.stencil) & 0xFF;
+    switch (pixel_format) {
+    case PixelFormat::ABGR8U:
+        return store(ToUnorm(color[0], 0xFF) | ToUnorm(color[1], 0xFF) << 8 |
+                     ToUnorm(color[2], 0xFF) << 16 | ToUnorm(color[3], 0xFF) << 24);
+    case PixelFormat::BGRA8:
+        return store(ToUnorm(color[2], 0xFF) | ToUnorm(color[1], 0xFF) << 8 |
+                     ToUnorm(color[0], 0xFF) << 16 | ToUnorm(color[3], 0xFF) << 24);
+    case PixelFormat::A2B10G10R10U:
+        return store(ToUnorm(color[0], 0x3FF) | ToUnorm(color[1], 0x3FF) << 10 |
+                     ToUnorm(color[2], 0x3FF) << 20 | ToUnorm(color[3], 0x3) << 30);
+    case PixelFormat::RGBA32F:
+        return store(color);
+    case PixelFormat::RG32F:
+        return store(std::array<float, 2>{color[0], color[1]});
+    case PixelFormat::R32F:
+        return store(color[0]);
+    case PixelFormat::Z32F:
+        return store(value.depth);
+    case PixelFormat::Z16:
+        return store(static_cast<u16>(ToUnorm(value.depth, 0xFFFF)));
+    case PixelFormat::S8Z24:
+        return store(ToUnorm(value.depth, 0xFFFFFF) | stencil << 24);
+    case PixelFormat::Z24S8:
+        return store(ToUnorm(value.depth, 0xFFFFFF) << 8 | stencil);
+    default:
+        return 0;
+    }
+}
+
+/// Blits the first level of a 2D texture to another one of a different size
+static void BlitScaledTexture(GLuint src_texture, u32 src_width, u32 src_height,
+                              GLuint dst_texture, u32 dst_width, u32 dst_height, SurfaceType type,
+                              GLuint read_fb_handle, GLuint draw_fb_handle) {
+    OpenGLState prev_state{OpenGLState::GetCurState()};
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    OpenGLState state;
+    state.draw.read_framebuffer = read_fb_handle;
+    state.draw.draw_framebuffer = draw_fb_handle;
+    state.Apply();
+
+    const bool is_color = type == SurfaceType::ColorTexture;
+    const GLenum depth_attachment =
+        type == SurfaceType::DepthStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    const auto attach = [&](GLenum target, GLuint texture) {
+        glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, is_color ? texture : 0,
+                               0);
+        glFramebufferTexture2D(target, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        if (!is_color) {
+            glFramebufferTexture2D(target, depth_attachment, GL_TEXTURE_2D, texture, 0);
+        }
+    };
+    attach(GL_READ_FRAMEBUFFER, src_texture);
+    attach(GL_DRAW_FRAMEBUFFER, dst_texture);
+
+    GLbitfield buffers = GL_COLOR_BUFFER_BIT;
+    if (type == SurfaceType::Depth) {
+        buffers = GL_DEPTH_BUFFER_BIT;
+    } else if (type == SurfaceType::DepthStencil) {
+        buffers = GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+    }
+    glBlitFramebuffer(0, 0, static_cast<GLint>(src_width), static_cast<GLint>(src_height), 0, 0,
+                      static_cast<GLint>(dst_width), static_cast<GLint>(dst_height), buffers,
+                      is_color ? GL_LINEAR : GL_NEAREST);
+}
+
 static void ApplyTextureDefaults(GLuint texture, u32 max_mip_level) {
     glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -62,7 +182,7 @@ void SurfaceParams::InitCacheParameters(GPUVAddr gpu_addr_) {
     host_ptr = memory_manager.GetPointer(gpu_addr_);
     size_in_bytes = SizeInBytesRaw();
 
-    if (IsPixelFormatASTC(pixel_format)) {
+    if (GetGuestConversion() == Tegra::Texture::GuestConversion::DecodeASTC) {
         // ASTC is uncompressed in software, in emulated as RGBA8
         size_in_bytes_gl = width * height * depth * 4;
     } else {
@@ -407,7 +527,50 @@ static GLenum SurfaceTargetToGL(SurfaceTarget target) {
     return {};
 }
 
+/// Formats of the ASTC textures of hosts that sample ASTC, they are uploaded without decoding
+static constexpr std::array<std::pair<PixelFormat, FormatTuple>, 12> native_astc_format_tuples = {{
+    {PixelFormat::ASTC_2D_4X4,
+     {GL_COMPRESSED_RGBA_ASTC_4x4_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_5X4,
+     {GL_COMPRESSED_RGBA_ASTC_5x4_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_5X5,
+     {GL_COMPRESSED_RGBA_ASTC_5x5_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_8X5,
+     {GL_COMPRESSED_RGBA_ASTC_8x5_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_8X8,
+     {GL_COMPRESSED_RGBA_ASTC_8x8_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_10X8,
+     {GL_COMPRESSED_RGBA_ASTC_10x8_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, true}},
+    {PixelFormat::ASTC_2D_4X4_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+    {PixelFormat::ASTC_2D_5X4_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+    {PixelFormat::ASTC_2D_5X5_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+    {PixelFormat::ASTC_2D_8X5_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+    {PixelFormat::ASTC_2D_8X8_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+    {PixelFormat::ASTC_2D_10X8_SRGB,
+     {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm,
+      true}},
+}};
+
 static const FormatTuple& GetFormatTuple(PixelFormat pixel_format, ComponentType component_type) {
+    if (has_native_astc && IsPixelFormatASTC(pixel_format)) {
+        const auto it =
+            std::find_if(native_astc_format_tuples.begin(), native_astc_format_tuples.end(),
+                         [pixel_format](const auto& entry) { return entry.first == pixel_format; });
+        ASSERT(it != native_astc_format_tuples.end());
+        ASSERT(component_type == it->second.component_type);
+        return it->second;
+    }
+
     ASSERT(static_cast<std::size_t>(pixel_format) < tex_format_tuples.size());
     auto& format = tex_format_tuples[static_cast<unsigned int>(pixel_format)];
     ASSERT(component_type == format.component_type);
@@ -436,6 +599,10 @@ constexpr GLenum GetArrayDiscrepantTarget(SurfaceTarget target) {
     return GL_NONE;
 }
 
+Tegra::Texture::GuestConversion SurfaceParams::GetGuestConversion() const {
+    return Tegra::Texture::GetGuestConversion(pixel_format, has_native_astc);
+}
+
 Common::Rectangle<u32> SurfaceParams::GetRect(u32 mip_level) const {
     u32 actual_height{std::max(1U, unaligned_height >> mip_level)};
     if (IsPixelFormatASTC(pixel_format)) {
@@ -482,6 +649,7 @@ void RasterizerCacheOpenGL::FastCopySurface(const Surface& src_surface,
     const u32 width{std::min(src_params.width, dst_params.width)};
     const u32 height{std::min(src_params.height, dst_params.height)};
 
+    dst_surface->CommitLayers(0, 1);
     glCopyImageSubData(src_surface->Texture().handle, SurfaceTargetToGL(src_params.target), 0, 0, 0,
                        0, dst_surface->Texture().handle, SurfaceTargetToGL(dst_params.target), 0, 0,
                        0, 0, width, height, 1);
@@ -489,12 +657,12 @@ void RasterizerCacheOpenGL::FastCopySurface(const Surface& src_surface,
     dst_surface->MarkAsModified(true, *this);
 }
 
-MICROPROFILE_DEFINE(OpenGL_CopySurface, "OpenGL", "CopySurface", MP_RGB(128, 192, 64));
+TRACE_DEFINE(OpenGL_CopySurface, "OpenGL", "CopySurface", MP_RGB(128, 192, 64));
 void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surface& dst_surface,
                                         const GLuint copy_pbo_handle, const GLenum src_attachment,
                                         const GLenum dst_attachment,
                                         const std::size_t cubemap_face) {
-    MICROPROFILE_SCOPE(OpenGL_CopySurface);
+    TRACE_SCOPE(OpenGL_CopySurface);
     ASSERT_MSG(dst_attachment == 0, "Unimplemented");
 
     const auto& src_params{src_surface->GetSurfaceParams()};
@@ -505,6 +673,7 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
 
     const std::size_t buffer_size = std::max(src_params.size_in_bytes, dst_params.size_in_bytes);
 
+    dst_surface->Commit();
     glBindBuffer(GL_PIXEL_PACK_BUFFER, copy_pbo_handle);
     glBufferData(GL_PIXEL_PACK_BUFFER, buffer_size, nullptr, GL_STREAM_COPY);
     if (source_format.compressed) {
@@ -528,7 +697,7 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
                               "reinterpretation but the texture is tiled.");
         }
         const std::size_t remaining_size = dst_params.size_in_bytes - src_params.size_in_bytes;
-        auto& memory_manager{Core::System::GetInstance().GPU().MemoryManager()};
+        auto& memory_manager{system.GPU().MemoryManager()};
         glBufferSubData(GL_PIXEL_PACK_BUFFER, src_params.size_in_bytes, remaining_size,
                         memory_manager.GetPointer(dst_params.gpu_addr + src_params.size_in_bytes));
     }
@@ -577,27 +746,79 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
     dst_surface->MarkAsModified(true, *this);
 }
 
-CachedSurface::CachedSurface(const SurfaceParams& params)
+void SparseStorage::Commit(u32 first_layer, u32 num_layers) {
+    const bool is_3d = target == GL_TEXTURE_3D;
+    if (is_3d) {
+        first_layer = 0;
+        num_layers = 1;
+    }
+    const u32 end_layer =
+        std::min(first_layer + num_layers, static_cast<u32>(committed_layers.size()));
+    for (u32 layer = first_layer; layer < end_layer; ++layer) {
+        if (committed_layers[layer]) {
+            continue;
+        }
+        committed_layers[layer] = true;
+        // Committing a level of the mip tail commits the whole tail
+        for (u32 level = 0; level < num_levels; ++level) {
+            const auto level_width = static_cast<GLsizei>(std::max(width >> level, 1U));
+            const auto level_height = static_cast<GLsizei>(std::max(height >> level, 1U));
+            const auto level_depth =
+                static_cast<GLsizei>(is_3d ? std::max(depth >> level, 1U) : 1U);
+            glTexturePageCommitmentEXT(texture.handle, static_cast<GLint>(level), 0, 0,
+                                       static_cast<GLint>(layer), level_width, level_height,
+                                       level_depth, GL_TRUE);
+        }
+        vram_accounting.Resize(vram_accounting.GetSize() + layer_size);
+    }
+}
+
+CachedSurface::CachedSurface(const SurfaceParams& params, float scale, const OGLTexture* storage,
+                             std::shared_ptr<SparseStorage> sparse_storage)
     : RasterizerCacheObject{params.host_ptr}, params{params},
-      gl_target{SurfaceTargetToGL(params.target)}, cached_size_in_bytes{params.size_in_bytes} {
+      gl_target{SurfaceTargetToGL(params.target)}, cached_size_in_bytes{params.size_in_bytes},
+      scale{scale}, sparse_storage{std::move(sparse_storage)} {
+    ASSERT_MSG(!IsScaled() || (params.target == SurfaceTarget::Texture2D &&
+                               params.max_mip_level == 1),
+               "Only single level 2D surfaces can be scaled");
 
     const auto optional_cpu_addr{
         Core::System::GetInstance().GPU().MemoryManager().GpuToCpuAddress(params.gpu_addr)};
     ASSERT_MSG(optional_cpu_addr, "optional_cpu_addr is invalid");
     cpu_addr = *optional_cpu_addr;
 
-    texture.Create(gl_target);
-
     // TODO(Rodrigo): Using params.GetRect() returns a different size than using its Mip*(0)
     // alternatives. This signals a bug on those functions.
-    const auto width = static_cast<GLsizei>(params.MipWidth(0));
-    const auto height = static_cast<GLsizei>(params.MipHeight(0));
+    const auto width = static_cast<GLsizei>(ScaleDimension(params.MipWidth(0), scale));
+    const auto height = static_cast<GLsizei>(ScaleDimension(params.MipHeight(0), scale));
     memory_size = params.MemorySize();
     reinterpreted = false;
 
     const auto& format_tuple = GetFormatTuple(params.pixel_format, params.component_type);
     gl_internal_format = format_tuple.internal_format;
 
+    if (storage) {
+        // Views have to be created from names that were never bound
+        glGenTextures(1, &texture.handle);
+        const GLuint num_layers{params.is_layered ? params.depth : 1u};
+        glTextureView(texture.handle, gl_target, storage->handle, gl_internal_format, 0,
+                      params.max_mip_level, 0, num_layers);
+        ApplyTextureDefaults(texture.handle, params.max_mip_level);
+        OpenGL::LabelGLObject(GL_TEXTURE, texture.handle, params.gpu_addr,
+                              params.IdentityString());
+        return;
+    }
+
+    if (has_sparse_texture && CreateSparseTexture()) {
+        // The storage accounts the VRAM as it's committed
+        ApplyTextureDefaults(texture.handle, params.max_mip_level);
+        OpenGL::LabelGLObject(GL_TEXTURE, texture.handle, params.gpu_addr,
+                              params.IdentityString());
+        return;
+    }
+
+    texture.Create(gl_target);
+    vram_accounting.Resize(static_cast<u64>(params.size_in_bytes_gl * scale * scale));
     switch (params.target) {
     case SurfaceTarget::Texture1D:
         glTextureStorage1D(texture.handle, params.max_mip_level, format_tuple.internal_format,
@@ -627,9 +848,102 @@ CachedSurface::CachedSurface(const SurfaceParams& params)
     OpenGL::LabelGLObject(GL_TEXTURE, texture.handle, params.gpu_addr, params.IdentityString());
 }
 
-MICROPROFILE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 192, 64));
+bool CachedSurface::CreateSparseTexture() {
+    const bool is_3d = params.target == SurfaceTarget::Texture3D;
+    if ((params.target != SurfaceTarget::Texture2DArray &&
+         params.target != SurfaceTarget::TextureCubeArray && !is_3d) ||
+        IsScaled() || params.size_in_bytes_gl < MinSparseTextureSize) {
+        return false;
+    }
+
+    GLint num_page_sizes{};
+    glGetInternalformativ(gl_target, gl_internal_format, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1,
+                          &num_page_sizes);
+    if (num_page_sizes == 0) {
+        return false;
+    }
+    GLint page_width{};
+    GLint page_height{};
+    GLint page_depth{};
+    glGetInternalformativ(gl_target, gl_internal_format, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1,
+                          &page_width);
+    glGetInternalformativ(gl_target, gl_internal_format, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1,
+                          &page_height);
+    glGetInternalformativ(gl_target, gl_internal_format, GL_VIRTUAL_PAGE_SIZE_Z_ARB, 1,
+                          &page_depth);
+
+    // Arrays are allocated with room to grow, uncommitted layers take no memory. Cubemap arrays
+    // grow by whole cubes.
+    const auto round_up_pow2 = [](u32 value) {
+        return value <= 1 ? 1U : 1U << (32 - Common::CountLeadingZeroes32(value - 1));
+    };
+    u32 depth = params.depth;
+    if (params.target == SurfaceTarget::Texture2DArray) {
+        depth = std::max(std::min(round_up_pow2(depth), MaxSparseTextureLayers), depth);
+    } else if (params.target == SurfaceTarget::TextureCubeArray) {
+        depth = std::max(std::min(round_up_pow2(depth / 6), MaxSparseTextureLayers / 6) * 6, depth);
+    }
+
+    // Sparse storages are sized in whole pages and views share the size of their storage, so the
+    // texture can't be padded to the page size
+    const u32 width = params.MipWidth(0);
+    const u32 height = params.MipHeight(0);
+    if (page_width <= 0 || page_height <= 0 || page_depth <= 0 ||
+        width % static_cast<u32>(page_width) != 0 || height % static_cast<u32>(page_height) != 0 ||
+        depth % static_cast<u32>(page_depth) != 0) {
+        return false;
+    }
+
+    auto storage = std::make_shared<SparseStorage>();
+    storage->target = gl_target;
+    storage->width = width;
+    storage->height = height;
+    storage->depth = depth;
+    // Every level is allocated so surfaces with more levels can view the storage
+    const u32 max_dimension = std::max({width, height, is_3d ? depth : 1U});
+    storage->num_levels = 32 - Common::CountLeadingZeroes32(max_dimension);
+    storage->layer_size = is_3d ? params.size_in_bytes_gl : params.size_in_bytes_gl / params.depth;
+    storage->committed_layers.resize(is_3d ? 1 : depth);
+
+    storage->texture.Create(gl_target);
+    glTextureParameteri(storage->texture.handle, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+    glTextureStorage3D(storage->texture.handle, static_cast<GLsizei>(storage->num_levels),
+                       gl_internal_format, static_cast<GLsizei>(width),
+                       static_cast<GLsizei>(height), static_cast<GLsizei>(depth));
+
+    glGenTextures(1, &texture.handle);
+    glTextureView(texture.handle, gl_target, storage->texture.handle, gl_internal_format, 0,
+                  params.max_mip_level, 0, is_3d ? 1 : params.depth);
+    sparse_storage = std::move(storage);
+    return true;
+}
+
+void CachedSurface::CommitGuestLayers() {
+    if (!sparse_storage) {
+        return;
+    }
+    // Zeroed guest memory only matches uncommitted texels when it's uploaded as it is
+    if (GetFormatTuple(params.pixel_format, params.component_type).compressed ||
+        params.GetGuestConversion() != Tegra::Texture::GuestConversion::None ||
+        params.host_ptr == nullptr || !params.is_layered) {
+        Commit();
+        return;
+    }
+    const std::size_t layer_size = params.LayerMemorySize();
+    for (u32 layer = 0; layer < params.depth; ++layer) {
+        if (sparse_storage->committed_layers[layer]) {
+            continue;
+        }
+        const u8* const begin = params.host_ptr + layer * layer_size;
+        if (std::any_of(begin, begin + layer_size, [](u8 value) { return value != 0; })) {
+            CommitLayers(layer, 1);
+        }
+    }
+}
+
+TRACE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 192, 64));
 void CachedSurface::LoadGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem) {
-    MICROPROFILE_SCOPE(OpenGL_SurfaceLoad);
+    TRACE_SCOPE(OpenGL_SurfaceLoad);
     auto& gl_buffer = res_cache_tmp_mem.gl_buffer;
     if (gl_buffer.size() < params.max_mip_level)
         gl_buffer.resize(params.max_mip_level);
@@ -662,19 +976,52 @@ void CachedSurface::LoadGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem) {
         const u32 width = params.MipWidth(i);
         const u32 height = params.MipHeight(i);
         const u32 depth = params.MipDepth(i);
-        if (VideoCore::Surface::IsPixelFormatASTC(params.pixel_format)) {
+        if (params.GetGuestConversion() == Tegra::Texture::GuestConversion::DecodeASTC) {
             // Reserve size for RGBA8 conversion
             constexpr std::size_t rgba_bpp = 4;
             gl_buffer[i].resize(std::max(gl_buffer[i].size(), width * height * depth * rgba_bpp));
         }
         Tegra::Texture::ConvertFromGuestToHost(gl_buffer[i].data(), params.pixel_format, width,
-                                               height, depth, true, true);
+                                               height, depth, !has_native_astc, true);
+    }
+}
+
+TRACE_DEFINE(OpenGL_SurfaceFlush, "OpenGL", "Surface Flush", MP_RGB(128, 192, 64));
+void CachedSurface::QueueReadback() {
+    if (readback_fence.handle) {
+        // The previous readback was never used, stop predicting reads of this surface
+        readback_fence.Release();
+        readback_buffer.Release();
+        readback_pointer = nullptr;
+        is_readback_predicted = false;
+        return;
+    }
+
+    const auto size = static_cast<GLsizeiptr>(GetSizeInBytes());
+    if (!readback_buffer.handle) {
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        readback_buffer.Create();
+        glNamedBufferStorage(readback_buffer.handle, size, nullptr, flags);
+        readback_pointer =
+            static_cast<const u8*>(glMapNamedBufferRange(readback_buffer.handle, 0, size, flags));
     }
+
+    const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    const u32 align = std::clamp(params.RowAlign(0), 1U, 8U);
+    glPixelStorei(GL_PACK_ALIGNMENT, align);
+    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.width));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffer.handle);
+    glGetTextureImage(GuestTexture(), 0, tuple.format, tuple.type, static_cast<GLsizei>(size),
+                      nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    readback_fence.Create();
+    readback_ticks = GetLastModifiedTicks();
 }
 
-MICROPROFILE_DEFINE(OpenGL_SurfaceFlush, "OpenGL", "Surface Flush", MP_RGB(128, 192, 64));
 void CachedSurface::FlushGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem) {
-    MICROPROFILE_SCOPE(OpenGL_SurfaceFlush);
+    TRACE_SCOPE(OpenGL_SurfaceFlush);
 
     ASSERT_MSG(!IsPixelFormatASTC(params.pixel_format), "Unimplemented");
 
@@ -683,29 +1030,70 @@ void CachedSurface::FlushGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem)
     gl_buffer[0].resize(GetSizeInBytes());
 
     const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
-    const u32 align = std::clamp(params.RowAlign(0), 1U, 8U);
-    glPixelStorei(GL_PACK_ALIGNMENT, align);
-    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.width));
     ASSERT(!tuple.compressed);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    glGetTextureImage(texture.handle, 0, tuple.format, tuple.type,
-                      static_cast<GLsizei>(gl_buffer[0].size()), gl_buffer[0].data());
-    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    if (readback_fence.handle && readback_ticks == GetLastModifiedTicks()) {
+        // The surface hasn't been modified since the readback was queued, wait for it instead
+        while (glClientWaitSync(readback_fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                1'000'000'000) == GL_TIMEOUT_EXPIRED) {
+        }
+        std::memcpy(gl_buffer[0].data(), readback_pointer, gl_buffer[0].size());
+    } else {
+        const u32 align = std::clamp(params.RowAlign(0), 1U, 8U);
+        glPixelStorei(GL_PACK_ALIGNMENT, align);
+        glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.width));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glGetTextureImage(GuestTexture(), 0, tuple.format, tuple.type,
+                          static_cast<GLsizei>(gl_buffer[0].size()), gl_buffer[0].data());
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    }
+    readback_fence.Release();
+    is_readback_predicted = true;
+
     Tegra::Texture::ConvertFromHostToGuest(gl_buffer[0].data(), params.pixel_format, params.width,
                                            params.height, params.depth, true, true);
+    WriteGuestMemory(gl_buffer[0]);
+}
+
+bool CachedSurface::CanFlushFastClear() const {
+    const std::optional<FastClearValue> value = GetFastClearValue();
+    if (!value || params.max_mip_level != 1 || params.depth != 1 || params.srgb_conversion) {
+        return false;
+    }
+    std::array<u8, 16> pixel;
+    return EncodeClearValue(params.pixel_format, *value, pixel) != 0;
+}
+
+void CachedSurface::FlushFastClear(RasterizerTemporaryMemory& res_cache_tmp_mem) {
+    TRACE_SCOPE(OpenGL_SurfaceFlush);
+
+    std::array<u8, 16> pixel;
+    const std::size_t pixel_size =
+        EncodeClearValue(params.pixel_format, *GetFastClearValue(), pixel);
+    ASSERT(pixel_size == params.GetFormatBpp() / 8);
+
+    auto& gl_buffer = res_cache_tmp_mem.gl_buffer;
+    gl_buffer[0].resize(GetSizeInBytes());
+    const std::size_t num_pixels = static_cast<std::size_t>(params.width) * params.height;
+    for (std::size_t i = 0; i < num_pixels; ++i) {
+        std::memcpy(gl_buffer[0].data() + i * pixel_size, pixel.data(), pixel_size);
+    }
+    WriteGuestMemory(gl_buffer[0]);
+}
+
+void CachedSurface::WriteGuestMemory(std::vector<u8>& gl_buffer) {
     if (params.is_tiled) {
         ASSERT_MSG(params.block_width == 1, "Block width is defined as {} on texture type {}",
                    params.block_width, static_cast<u32>(params.target));
 
-        SwizzleFunc(MortonSwizzleMode::LinearToMorton, params, gl_buffer[0], 0);
+        SwizzleFunc(MortonSwizzleMode::LinearToMorton, params, gl_buffer, 0);
     } else {
         const u32 bpp = params.GetFormatBpp() / 8;
         const u32 copy_size = params.width * bpp;
         if (params.pitch == copy_size) {
-            std::memcpy(params.host_ptr, gl_buffer[0].data(), GetSizeInBytes());
+            std::memcpy(params.host_ptr, gl_buffer.data(), GetSizeInBytes());
         } else {
             u8* start{params.host_ptr};
-            const u8* read_to = gl_buffer[0].data();
+            const u8* read_to = gl_buffer.data();
             for (u32 h = params.height; h > 0; h--) {
                 std::memcpy(start, read_to, copy_size);
                 start += params.pitch;
@@ -715,11 +1103,29 @@ void CachedSurface::FlushGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem)
     }
 }
 
-void CachedSurface::UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_tmp_mem, u32 mip_map,
-                                          GLuint read_fb_handle, GLuint draw_fb_handle) {
-    const auto& rect{params.GetRect(mip_map)};
+void CachedSurface::FlushSwizzledGLBuffer(TextureSwizzler& swizzler) {
+    TRACE_SCOPE(OpenGL_SurfaceFlush);
 
-    auto& gl_buffer = res_cache_tmp_mem.gl_buffer;
+    const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    ASSERT(!tuple.compressed);
+    const auto level_size = static_cast<GLsizei>(params.GetMipmapSizeGL(0));
+
+    const u32 align = std::clamp(params.RowAlign(0), 1U, 8U);
+    glPixelStorei(GL_PACK_ALIGNMENT, align);
+    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(params.width));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, swizzler.GetLinearBuffer(level_size));
+    glGetTextureImage(GuestTexture(), 0, tuple.format, tuple.type, level_size, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    // Upload the current guest memory first, so the gaps between the texels are preserved
+    swizzler.UploadSwizzled(params);
+    swizzler.Swizzle(params, 0);
+    swizzler.DownloadSwizzled(params);
+}
+
+void CachedSurface::UploadGLMipmapTexture(const u8* buffer, u32 mip_map) {
+    const auto& rect{params.GetRect(mip_map)};
 
     // Load data from memory to the surface
     const auto x0 = static_cast<GLint>(rect.left);
@@ -730,6 +1136,7 @@ void CachedSurface::UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_t
         GetBytesPerPixel(params.pixel_format);
 
     const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    const GLuint handle = GuestTexture();
 
     const u32 align = std::clamp(params.RowAlign(mip_map), 1U, 8U);
     glPixelStorei(GL_UNPACK_ALIGNMENT, align);
@@ -740,32 +1147,32 @@ void CachedSurface::UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_t
         switch (params.target) {
         case SurfaceTarget::Texture2D:
             glCompressedTextureSubImage2D(
-                texture.handle, mip_map, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
+                handle, mip_map, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
                 static_cast<GLsizei>(params.MipHeight(mip_map)), tuple.internal_format, image_size,
-                &gl_buffer[mip_map][buffer_offset]);
+                buffer + buffer_offset);
             break;
         case SurfaceTarget::Texture3D:
             glCompressedTextureSubImage3D(
-                texture.handle, mip_map, 0, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
+                handle, mip_map, 0, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
                 static_cast<GLsizei>(params.MipHeight(mip_map)),
                 static_cast<GLsizei>(params.MipDepth(mip_map)), tuple.internal_format, image_size,
-                &gl_buffer[mip_map][buffer_offset]);
+                buffer + buffer_offset);
             break;
         case SurfaceTarget::Texture2DArray:
         case SurfaceTarget::TextureCubeArray:
             glCompressedTextureSubImage3D(
-                texture.handle, mip_map, 0, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
+                handle, mip_map, 0, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
                 static_cast<GLsizei>(params.MipHeight(mip_map)), static_cast<GLsizei>(params.depth),
-                tuple.internal_format, image_size, &gl_buffer[mip_map][buffer_offset]);
+                tuple.internal_format, image_size, buffer + buffer_offset);
             break;
         case SurfaceTarget::TextureCubemap: {
             const auto layer_size = static_cast<GLsizei>(params.LayerSizeGL(mip_map));
             for (std::size_t face = 0; face < params.depth; ++face) {
                 glCompressedTextureSubImage3D(
-                    texture.handle, mip_map, 0, 0, static_cast<GLint>(face),
+                    handle, mip_map, 0, 0, static_cast<GLint>(face),
                     static_cast<GLsizei>(params.MipWidth(mip_map)),
                     static_cast<GLsizei>(params.MipHeight(mip_map)), 1, tuple.internal_format,
-                    layer_size, &gl_buffer[mip_map][buffer_offset]);
+                    layer_size, buffer + buffer_offset);
                 buffer_offset += layer_size;
             }
             break;
@@ -775,41 +1182,41 @@ void CachedSurface::UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_t
                          static_cast<u32>(params.target));
             UNREACHABLE();
             glCompressedTextureSubImage2D(
-                texture.handle, mip_map, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
+                handle, mip_map, 0, 0, static_cast<GLsizei>(params.MipWidth(mip_map)),
                 static_cast<GLsizei>(params.MipHeight(mip_map)), tuple.internal_format,
-                static_cast<GLsizei>(params.size_in_bytes_gl), &gl_buffer[mip_map][buffer_offset]);
+                static_cast<GLsizei>(params.size_in_bytes_gl), buffer + buffer_offset);
         }
     } else {
         switch (params.target) {
         case SurfaceTarget::Texture1D:
-            glTextureSubImage1D(texture.handle, mip_map, x0, static_cast<GLsizei>(rect.GetWidth()),
-                                tuple.format, tuple.type, &gl_buffer[mip_map][buffer_offset]);
+            glTextureSubImage1D(handle, mip_map, x0, static_cast<GLsizei>(rect.GetWidth()),
+                                tuple.format, tuple.type, buffer + buffer_offset);
             break;
         case SurfaceTarget::Texture2D:
-            glTextureSubImage2D(texture.handle, mip_map, x0, y0,
+            glTextureSubImage2D(handle, mip_map, x0, y0,
                                 static_cast<GLsizei>(rect.GetWidth()),
                                 static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                                &gl_buffer[mip_map][buffer_offset]);
+                                buffer + buffer_offset);
             break;
         case SurfaceTarget::Texture3D:
-            glTextureSubImage3D(texture.handle, mip_map, x0, y0, 0,
+            glTextureSubImage3D(handle, mip_map, x0, y0, 0,
                                 static_cast<GLsizei>(rect.GetWidth()),
                                 static_cast<GLsizei>(rect.GetHeight()), params.MipDepth(mip_map),
-                                tuple.format, tuple.type, &gl_buffer[mip_map][buffer_offset]);
+                                tuple.format, tuple.type, buffer + buffer_offset);
             break;
         case SurfaceTarget::Texture2DArray:
         case SurfaceTarget::TextureCubeArray:
-            glTextureSubImage3D(texture.handle, mip_map, x0, y0, 0,
+            glTextureSubImage3D(handle, mip_map, x0, y0, 0,
                                 static_cast<GLsizei>(rect.GetWidth()),
                                 static_cast<GLsizei>(rect.GetHeight()), params.depth, tuple.format,
-                                tuple.type, &gl_buffer[mip_map][buffer_offset]);
+                                tuple.type, buffer + buffer_offset);
             break;
         case SurfaceTarget::TextureCubemap: {
             for (std::size_t face = 0; face < params.depth; ++face) {
-                glTextureSubImage3D(texture.handle, mip_map, x0, y0, static_cast<GLint>(face),
+                glTextureSubImage3D(handle, mip_map, x0, y0, static_cast<GLint>(face),
                                     static_cast<GLsizei>(rect.GetWidth()),
                                     static_cast<GLsizei>(rect.GetHeight()), 1, tuple.format,
-                                    tuple.type, &gl_buffer[mip_map][buffer_offset]);
+                                    tuple.type, buffer + buffer_offset);
                 buffer_offset += params.LayerSizeGL(mip_map);
             }
             break;
@@ -818,16 +1225,62 @@ void CachedSurface::UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_t
             LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
                          static_cast<u32>(params.target));
             UNREACHABLE();
-            glTextureSubImage2D(texture.handle, mip_map, x0, y0,
+            glTextureSubImage2D(handle, mip_map, x0, y0,
                                 static_cast<GLsizei>(rect.GetWidth()),
                                 static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                                &gl_buffer[mip_map][buffer_offset]);
+                                buffer + buffer_offset);
         }
     }
 
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
 
+GLuint CachedSurface::GuestTexture() {
+    if (!IsScaled()) {
+        return texture.handle;
+    }
+    if (!guest_texture.handle) {
+        guest_texture.Create(gl_target);
+        vram_accounting.Resize(vram_accounting.GetSize() + params.size_in_bytes_gl);
+        glTextureStorage2D(guest_texture.handle, 1, gl_internal_format,
+                           static_cast<GLsizei>(params.width), static_cast<GLsizei>(params.height));
+        ApplyTextureDefaults(guest_texture.handle, params.max_mip_level);
+    }
+    return guest_texture.handle;
+}
+
+void CachedSurface::Downscale(GLuint read_fb_handle, GLuint draw_fb_handle) {
+    if (!IsScaled()) {
+        return;
+    }
+    BlitScaledTexture(texture.handle, ScaleDimension(params.width, scale),
+                      ScaleDimension(params.height, scale), GuestTexture(), params.width,
+                      params.height, params.type, read_fb_handle, draw_fb_handle);
+}
+
+void CachedSurface::Upscale(GLuint read_fb_handle, GLuint draw_fb_handle) {
+    if (!IsScaled()) {
+        return;
+    }
+    BlitScaledTexture(GuestTexture(), params.width, params.height, texture.handle,
+                      ScaleDimension(params.width, scale), ScaleDimension(params.height, scale),
+                      params.type, read_fb_handle, draw_fb_handle);
+}
+
+void CachedSurface::Unscale(GLuint read_fb_handle, GLuint draw_fb_handle) {
+    if (!IsScaled()) {
+        return;
+    }
+    Downscale(read_fb_handle, draw_fb_handle);
+    texture = std::move(guest_texture);
+    discrepant_view.Release();
+    scale = 1.0f;
+
+    glTextureParameteriv(texture.handle, GL_TEXTURE_SWIZZLE_RGBA,
+                         reinterpret_cast<const GLint*>(swizzle.data()));
+    OpenGL::LabelGLObject(GL_TEXTURE, texture.handle, params.gpu_addr, params.IdentityString());
+}
+
 void CachedSurface::EnsureTextureDiscrepantView() {
     if (discrepant_view.handle != 0)
         return;
@@ -847,13 +1300,96 @@ void CachedSurface::EnsureTextureDiscrepantView() {
                          reinterpret_cast<const GLint*>(swizzle.data()));
 }
 
-MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 192, 64));
+TRACE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 192, 64));
 void CachedSurface::UploadGLTexture(RasterizerTemporaryMemory& res_cache_tmp_mem,
                                     GLuint read_fb_handle, GLuint draw_fb_handle) {
-    MICROPROFILE_SCOPE(OpenGL_TextureUL);
+    TRACE_SCOPE(OpenGL_TextureUL);
 
     for (u32 i = 0; i < params.max_mip_level; i++)
-        UploadGLMipmapTexture(res_cache_tmp_mem, i, read_fb_handle, draw_fb_handle);
+        UploadGLMipmapTexture(res_cache_tmp_mem.gl_buffer[i].data(), i);
+    Upscale(read_fb_handle, draw_fb_handle);
+}
+
+void CachedSurface::UploadSwizzledGLTexture(TextureSwizzler& swizzler, GLuint read_fb_handle,
+                                            GLuint draw_fb_handle) {
+    TRACE_SCOPE(OpenGL_TextureUL);
+
+    swizzler.UploadSwizzled(params);
+    for (u32 i = 0; i < params.max_mip_level; i++) {
+        swizzler.Unswizzle(params, i);
+        // The level is read from the bound pixel unpack buffer, pointers become offsets into it
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                     swizzler.GetLinearBuffer(params.GetMipmapSizeGL(i)));
+        UploadGLMipmapTexture(nullptr, i);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    Upscale(read_fb_handle, draw_fb_handle);
+}
+
+void CachedSurface::UploadLinearRect(const Common::Rectangle<u32>& rect, u32 layer, u32 pitch,
+                                     const u8* data) {
+    const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    ASSERT(!tuple.compressed);
+
+    CommitLayers(layer, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH,
+                  static_cast<GLint>(pitch / GetBytesPerPixel(params.pixel_format)));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (params.target == SurfaceTarget::Texture2D) {
+        glTextureSubImage2D(texture.handle, 0, static_cast<GLint>(rect.left),
+                            static_cast<GLint>(rect.top), static_cast<GLsizei>(rect.GetWidth()),
+                            static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type, data);
+    } else {
+        glTextureSubImage3D(texture.handle, 0, static_cast<GLint>(rect.left),
+                            static_cast<GLint>(rect.top), static_cast<GLint>(layer),
+                            static_cast<GLsizei>(rect.GetWidth()),
+                            static_cast<GLsizei>(rect.GetHeight()), 1, tuple.format, tuple.type,
+                            data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void CachedSurface::DownloadLinearRect(const Common::Rectangle<u32>& rect, u32 layer, u32 pitch,
+                                       u8* data, std::size_t data_size) {
+    const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    ASSERT(!tuple.compressed);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH,
+                  static_cast<GLint>(pitch / GetBytesPerPixel(params.pixel_format)));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glGetTextureSubImage(texture.handle, 0, static_cast<GLint>(rect.left),
+                         static_cast<GLint>(rect.top), static_cast<GLint>(layer),
+                         static_cast<GLsizei>(rect.GetWidth()),
+                         static_cast<GLsizei>(rect.GetHeight()), 1, tuple.format, tuple.type,
+                         static_cast<GLsizei>(data_size), data);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+}
+
+GLuint CachedSurface::CopyForFeedbackLoop() {
+    if (params.target != SurfaceTarget::Texture2D) {
+        // Render targets are 2D, layered ones are sampled as they are
+        return texture.handle;
+    }
+    const auto width = static_cast<GLsizei>(ScaleDimension(params.MipWidth(0), scale));
+    const auto height = static_cast<GLsizei>(ScaleDimension(params.MipHeight(0), scale));
+    if (feedback_copy.handle == 0) {
+        feedback_copy.Create(GL_TEXTURE_2D);
+        glTextureStorage2D(feedback_copy.handle, params.max_mip_level, gl_internal_format, width,
+                           height);
+        ApplyTextureDefaults(feedback_copy.handle, params.max_mip_level);
+        glTextureParameteriv(feedback_copy.handle, GL_TEXTURE_SWIZZLE_RGBA,
+                             reinterpret_cast<const GLint*>(swizzle.data()));
+        vram_accounting.Resize(vram_accounting.GetSize() +
+                               static_cast<u64>(params.size_in_bytes_gl * scale * scale));
+    }
+    for (u32 level = 0; level < params.max_mip_level; ++level) {
+        glCopyImageSubData(texture.handle, GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, 0,
+                           feedback_copy.handle, GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                           0, std::max(width >> level, 1), std::max(height >> level, 1), 1);
+    }
+    return feedback_copy.handle;
 }
 
 void CachedSurface::UpdateSwizzle(Tegra::Texture::SwizzleSource swizzle_x,
@@ -873,13 +1409,24 @@ void CachedSurface::UpdateSwizzle(Tegra::Texture::SwizzleSource swizzle_x,
     if (discrepant_view.handle != 0) {
         glTextureParameteriv(discrepant_view.handle, GL_TEXTURE_SWIZZLE_RGBA, swizzle_data);
     }
+    if (feedback_copy.handle != 0) {
+        glTextureParameteriv(feedback_copy.handle, GL_TEXTURE_SWIZZLE_RGBA, swizzle_data);
+    }
 }
 
-RasterizerCacheOpenGL::RasterizerCacheOpenGL(RasterizerOpenGL& rasterizer)
-    : RasterizerCache{rasterizer} {
+RasterizerCacheOpenGL::RasterizerCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
+                                             const Device& device)
+    : RasterizerCache{rasterizer}, system{system}, texture_disk_cache{system} {
+    has_native_astc = device.HasASTC();
+    has_sparse_texture = device.HasSparseTexture();
+    has_texture_barrier = device.HasTextureBarrier();
     read_framebuffer.Create();
     draw_framebuffer.Create();
     copy_pbo.Create();
+
+    if (Settings::values.use_compute_swizzle) {
+        texture_swizzler = std::make_unique<TextureSwizzler>();
+    }
 }
 
 Surface RasterizerCacheOpenGL::GetTextureSurface(const Tegra::Texture::FullTextureInfo& config,
@@ -888,7 +1435,7 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Tegra::Texture::FullTextu
 }
 
 Surface RasterizerCacheOpenGL::GetDepthBufferSurface(bool preserve_contents) {
-    auto& gpu{Core::System::GetInstance().GPU().Maxwell3D()};
+    auto& gpu{system.GPU().Maxwell3D()};
     const auto& regs{gpu.regs};
 
     if (!gpu.dirty_flags.zeta_buffer) {
@@ -909,7 +1456,7 @@ Surface RasterizerCacheOpenGL::GetDepthBufferSurface(bool preserve_contents) {
 }
 
 Surface RasterizerCacheOpenGL::GetColorBufferSurface(std::size_t index, bool preserve_contents) {
-    auto& gpu{Core::System::GetInstance().GPU().Maxwell3D()};
+    auto& gpu{system.GPU().Maxwell3D()};
     const auto& regs{gpu.regs};
 
     if (!gpu.dirty_flags.color_buffer[index]) {
@@ -932,25 +1479,88 @@ Surface RasterizerCacheOpenGL::GetColorBufferSurface(std::size_t index, bool pre
     return current_color_buffers[index] = GetSurface(color_params, preserve_contents);
 }
 
+GLuint RasterizerCacheOpenGL::GetSampledTexture(const Surface& surface, bool as_array) {
+    if (!IsRenderTarget(surface)) {
+        return surface->Texture(as_array).handle;
+    }
+    if (has_texture_barrier) {
+        // Writes of the previous draws are made visible to the texture fetches of the next one
+        texception = true;
+        return surface->Texture(as_array).handle;
+    }
+    if (surface->GetSurfaceParams().is_array != as_array) {
+        return surface->Texture(as_array).handle;
+    }
+    return surface->CopyForFeedbackLoop();
+}
+
+bool RasterizerCacheOpenGL::IsRenderTarget(const Surface& surface) const {
+    if (surface == last_depth_buffer) {
+        return true;
+    }
+    return std::find(current_color_buffers.begin(), current_color_buffers.end(), surface) !=
+           current_color_buffers.end();
+}
+
+void RasterizerCacheOpenGL::FlushObjectInner(const Surface& object) {
+    if (object->CanFlushFastClear()) {
+        // Every texel holds the clear value, write it without reading the texture back
+        object->FlushFastClear(temporal_memory);
+        return;
+    }
+    // Surfaces read by the guest are flushed again later, don't scale their address from now on
+    unscaled_addresses.insert(object->GetSurfaceParams().gpu_addr);
+    object->Downscale(read_framebuffer.handle, draw_framebuffer.handle);
+    if (texture_swizzler && TextureSwizzler::IsCompatible(object->GetSurfaceParams())) {
+        object->FlushSwizzledGLBuffer(*texture_swizzler);
+    } else {
+        object->FlushGLBuffer(temporal_memory);
+    }
+}
+
 void RasterizerCacheOpenGL::LoadSurface(const Surface& surface) {
-    surface->LoadGLBuffer(temporal_memory);
-    surface->UploadGLTexture(temporal_memory, read_framebuffer.handle, draw_framebuffer.handle);
+    surface->CommitGuestLayers();
+    if (texture_swizzler && TextureSwizzler::IsCompatible(surface->GetSurfaceParams())) {
+        surface->UploadSwizzledGLTexture(*texture_swizzler, read_framebuffer.handle,
+                                         draw_framebuffer.handle);
+    } else {
+        const SurfaceParams& params = surface->GetSurfaceParams();
+        const std::optional<u64> disk_key = texture_disk_cache.GetKey(params);
+        if (!disk_key || !texture_disk_cache.Read(*disk_key, params.max_mip_level,
+                                                  temporal_memory.gl_buffer)) {
+            surface->LoadGLBuffer(temporal_memory);
+            if (disk_key) {
+                texture_disk_cache.Write(*disk_key, params.max_mip_level,
+                                         temporal_memory.gl_buffer);
+            }
+        }
+        surface->UploadGLTexture(temporal_memory, read_framebuffer.handle,
+                                 draw_framebuffer.handle);
+    }
     surface->MarkAsModified(false, *this);
     surface->MarkForReload(false);
 }
 
+void RasterizerCacheOpenGL::LoadDiskCache() {
+    texture_disk_cache.Load();
+}
+
 Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool preserve_contents) {
     if (!params.IsValid()) {
         return {};
     }
 
     // Look up surface in the cache based on address
+    auto& perf_stats{system.GetPerfStats()};
     Surface surface{TryGet(params.host_ptr)};
     if (surface) {
         if (surface->GetSurfaceParams().IsCompatibleSurface(params)) {
+            perf_stats.AddSessionCount(Core::SessionCounter::SurfaceCacheHits);
+
             // Use the cached surface as-is unless it's not synced with memory
             if (surface->MustReload())
                 LoadSurface(surface);
+            surface->MarkAsUsed(GetModifiedTicks());
             return surface;
         } else if (preserve_contents) {
             // If surface parameters changed and we care about keeping the previous data, recreate
@@ -961,6 +1571,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool pres
             if (new_surface->IsUploaded()) {
                 RegisterReinterpretSurface(new_surface);
             }
+            new_surface->MarkAsUsed(GetModifiedTicks());
             return new_surface;
         } else {
             // Delete the old surface before creating a new one to prevent collisions.
@@ -969,6 +1580,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool pres
     }
 
     // No cached surface found - get a new one
+    perf_stats.AddSessionCount(Core::SessionCounter::SurfaceCacheMisses);
     surface = GetUncachedSurface(params);
     Register(surface);
 
@@ -977,24 +1589,90 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool pres
         LoadSurface(surface);
     }
 
+    surface->MarkAsUsed(GetModifiedTicks());
     return surface;
 }
 
 Surface RasterizerCacheOpenGL::GetUncachedSurface(const SurfaceParams& params) {
+    const float scale = GetSurfaceScale(params);
     Surface surface{TryGetReservedSurface(params)};
-    if (!surface) {
+    if (!surface || surface->GetScale() != scale) {
         // No reserved surface available, create a new one and reserve it
-        surface = std::make_shared<CachedSurface>(params);
+        surface = std::make_shared<CachedSurface>(params, scale);
         ReserveSurface(surface);
     }
     return surface;
 }
 
+float RasterizerCacheOpenGL::GetSurfaceScale(const SurfaceParams& params) const {
+    // Only render targets and depth buffers never read by the guest are scaled. Sampled-only
+    // textures and copies keep the texels the guest uploaded them with, and surfaces the CPU
+    // reads would have to be filtered down on every flush.
+    if (params.identity != SurfaceParams::SurfaceClass::RenderTarget &&
+        params.identity != SurfaceParams::SurfaceClass::DepthBuffer) {
+        return 1.0f;
+    }
+    if (params.target != SurfaceTarget::Texture2D || params.max_mip_level != 1 ||
+        !params.is_tiled || unscaled_addresses.count(params.gpu_addr) != 0) {
+        return 1.0f;
+    }
+    float scale = Settings::values.resolution_factor;
+    if (scale == 0.0f) {
+        scale = VideoCore::GetResolutionScaleFactor(system.Renderer());
+    }
+    return std::clamp(scale, MIN_RESOLUTION_SCALE, MAX_RESOLUTION_SCALE);
+}
+
+void RasterizerCacheOpenGL::UnscaleSurface(const Surface& surface) {
+    if (!surface->IsScaled()) {
+        return;
+    }
+    unscaled_addresses.insert(surface->GetSurfaceParams().gpu_addr);
+    surface->Unscale(read_framebuffer.handle, draw_framebuffer.handle);
+
+    // The texture may be bound as a render target, attach the new one
+    auto& dirty_flags{system.GPU().Maxwell3D().dirty_flags};
+    dirty_flags.color_buffer.set();
+    dirty_flags.zeta_buffer = true;
+}
+
+float RasterizerCacheOpenGL::SyncFramebufferScale(
+    const std::array<Surface, Maxwell::NumRenderTargets>& color_surfaces,
+    const Surface& depth_surface) {
+    std::optional<float> scale;
+    bool is_mixed = false;
+    const auto check_surface = [&](const Surface& surface) {
+        if (!surface) {
+            return;
+        }
+        if (!scale) {
+            scale = surface->GetScale();
+        }
+        is_mixed |= *scale != surface->GetScale();
+    };
+    std::for_each(color_surfaces.begin(), color_surfaces.end(), check_surface);
+    check_surface(depth_surface);
+    if (!is_mixed) {
+        return scale.value_or(1.0f);
+    }
+
+    // Attachments have to be the same size, render all of them at guest resolution
+    for (const Surface& surface : color_surfaces) {
+        if (surface) {
+            UnscaleSurface(surface);
+        }
+    }
+    if (depth_surface) {
+        UnscaleSurface(depth_surface);
+    }
+    return 1.0f;
+}
+
 void RasterizerCacheOpenGL::FastLayeredCopySurface(const Surface& src_surface,
                                                    const Surface& dst_surface) {
     const auto& init_params{src_surface->GetSurfaceParams()};
     const auto& dst_params{dst_surface->GetSurfaceParams()};
-    auto& memory_manager{Core::System::GetInstance().GPU().MemoryManager()};
+    auto& memory_manager{system.GPU().MemoryManager()};
     GPUVAddr address{init_params.gpu_addr};
     const std::size_t layer_size{dst_params.LayerMemorySize()};
     for (u32 layer = 0; layer < dst_params.depth; layer++) {
@@ -1004,10 +1682,12 @@ void RasterizerCacheOpenGL::FastLayeredCopySurface(const Surface& src_surface,
             if (!copy) {
                 continue;
             }
+            UnscaleSurface(copy);
             const auto& src_params{copy->GetSurfaceParams()};
             const u32 width{std::min(src_params.width, dst_params.MipWidth(mipmap))};
             const u32 height{std::min(src_params.height, dst_params.MipHeight(mipmap))};
 
+            dst_surface->CommitLayers(layer, 1);
             glCopyImageSubData(copy->Texture().handle, SurfaceTargetToGL(src_params.target), 0, 0,
                                0, 0, dst_surface->Texture().handle,
                                SurfaceTargetToGL(dst_params.target), mipmap, 0, 0, layer, width,
@@ -1023,11 +1703,12 @@ static bool BlitSurface(const Surface& src_surface, const Surface& dst_surface,
                         const Common::Rectangle<u32>& src_rect,
                         const Common::Rectangle<u32>& dst_rect, GLuint read_fb_handle,
                         GLuint draw_fb_handle, GLenum src_attachment = 0, GLenum dst_attachment = 0,
-                        std::size_t cubemap_face = 0) {
+                        std::size_t cubemap_face = 0, GLenum color_filter = GL_LINEAR) {
 
     const auto& src_params{src_surface->GetSurfaceParams()};
     const auto& dst_params{dst_surface->GetSurfaceParams()};
 
+    dst_surface->Commit();
     OpenGLState prev_state{OpenGLState::GetCurState()};
     SCOPE_EXIT({ prev_state.Apply(); });
 
@@ -1141,35 +1822,166 @@ static bool BlitSurface(const Surface& src_surface, const Surface& dst_surface,
         buffers = GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
     }
 
-    glBlitFramebuffer(src_rect.left, src_rect.top, src_rect.right, src_rect.bottom, dst_rect.left,
-                      dst_rect.top, dst_rect.right, dst_rect.bottom, buffers,
-                      buffers == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST);
+    // Rectangles are given in guest texels, scaled surfaces are blitted at their own resolution
+    const auto src{ScaleRect(src_rect, src_surface->GetScale())};
+    const auto dst{ScaleRect(dst_rect, dst_surface->GetScale())};
+    const GLenum filter = buffers == GL_COLOR_BUFFER_BIT ? color_filter : GL_NEAREST;
+    glBlitFramebuffer(src.left, src.top, src.right, src.bottom, dst.left, dst.top, dst.right,
+                      dst.bottom, buffers, filter);
+
+    return true;
+}
 
+/// Returns true if glBlitFramebuffer can convert texels between the formats of the surfaces
+static bool IsBlitCompatible(const SurfaceParams& src_params, const SurfaceParams& dst_params) {
+    if (src_params.type != dst_params.type) {
+        return false;
+    }
+    if (src_params.type != SurfaceType::ColorTexture) {
+        // Depth formats must match exactly
+        return src_params.pixel_format == dst_params.pixel_format;
+    }
+    // Integer formats can only be blitted to integer formats of the same signedness
+    const auto is_integer = [](ComponentType type) {
+        return type == ComponentType::SInt || type == ComponentType::UInt;
+    };
+    if (is_integer(src_params.component_type) || is_integer(dst_params.component_type)) {
+        return src_params.component_type == dst_params.component_type;
+    }
     return true;
 }
 
-void RasterizerCacheOpenGL::FermiCopySurface(
+bool RasterizerCacheOpenGL::FermiCopySurface(
     const Tegra::Engines::Fermi2D::Regs::Surface& src_config,
     const Tegra::Engines::Fermi2D::Regs::Surface& dst_config,
-    const Common::Rectangle<u32>& src_rect, const Common::Rectangle<u32>& dst_rect) {
+    const Tegra::Engines::Fermi2D::Config& copy_config) {
+    const auto& src_rect = copy_config.src_rect;
+    const auto& dst_rect = copy_config.dst_rect;
 
     const auto& src_params = SurfaceParams::CreateForFermiCopySurface(src_config);
     const auto& dst_params = SurfaceParams::CreateForFermiCopySurface(dst_config);
+    if (!IsBlitCompatible(src_params, dst_params)) {
+        return false;
+    }
+
+    // Plain copies between surfaces only known to the CPU stay in guest memory, the host would
+    // have to upload both and download the destination again when it's read
+    const bool is_scaled = src_rect.GetWidth() != dst_rect.GetWidth() ||
+                           src_rect.GetHeight() != dst_rect.GetHeight();
+    if (!is_scaled && src_params.pixel_format == dst_params.pixel_format &&
+        !TryGet(src_params.host_ptr) && !TryGet(dst_params.host_ptr)) {
+        return false;
+    }
 
-    ASSERT(src_params.pixel_format == dst_params.pixel_format);
-    ASSERT(src_params.block_height == dst_params.block_height);
-    ASSERT(src_params.is_tiled == dst_params.is_tiled);
-    ASSERT(src_params.depth == dst_params.depth);
-    ASSERT(src_params.target == dst_params.target);
-    ASSERT(src_params.rt.index == dst_params.rt.index);
+    // The previous contents of the destination are only needed when the blit doesn't cover it
+    const bool is_full_destination = dst_rect.left == 0 && dst_rect.top == 0 &&
+                                     dst_rect.right >= dst_params.width &&
+                                     dst_rect.bottom >= dst_params.height;
 
     auto src_surface = GetSurface(src_params, true);
-    auto dst_surface = GetSurface(dst_params, true);
+    auto dst_surface = GetSurface(dst_params, !is_full_destination);
 
+    const bool is_integer = src_params.component_type == ComponentType::SInt ||
+                            src_params.component_type == ComponentType::UInt;
+    const bool is_linear = copy_config.filter == Tegra::Engines::Fermi2D::Regs::Filter::Linear;
     BlitSurface(src_surface, dst_surface, src_rect, dst_rect, read_framebuffer.handle,
-                draw_framebuffer.handle);
+                draw_framebuffer.handle, 0, 0, 0,
+                is_linear && !is_integer ? GL_LINEAR : GL_NEAREST);
 
     dst_surface->MarkAsModified(true, *this);
+    return true;
+}
+
+/// Returns true if a DMA copy to or from a block linear image can be done on the given surface
+static bool IsDMACompatibleSurface(const SurfaceParams& params,
+                                   const Tegra::Engines::MaxwellDMA::Regs::Parameters& config,
+                                   u32 bytes_per_pixel) {
+    if (!params.is_tiled || params.type != SurfaceType::ColorTexture) {
+        return false;
+    }
+    if (params.target != SurfaceTarget::Texture2D &&
+        params.target != SurfaceTarget::Texture2DArray) {
+        return false;
+    }
+    // Formats converted between the guest and the host representation can't be copied as-is
+    if (params.GetGuestConversion() != Tegra::Texture::GuestConversion::None ||
+        GetFormatTuple(params.pixel_format, params.component_type).compressed) {
+        return false;
+    }
+    // The image described by the copy has to be the first level of the surface
+    return GetBytesPerPixel(params.pixel_format) == bytes_per_pixel &&
+           params.width == config.size_x && params.height == config.size_y &&
+           params.block_height == config.BlockHeight() &&
+           params.block_depth == config.BlockDepth() && config.pos_z < params.depth;
+}
+
+bool RasterizerCacheOpenGL::AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+    if (regs.exec.is_src_linear == regs.exec.is_dst_linear || regs.exec.enable_2d == 0 ||
+        regs.x_count == 0 || regs.y_count == 0) {
+        // Linear copies are plain memory copies, they do not benefit from the host GPU
+        return false;
+    }
+
+    auto& memory_manager{system.GPU().MemoryManager()};
+    const GPUVAddr source = regs.src_address.Address();
+    const GPUVAddr dest = regs.dst_address.Address();
+
+    if (regs.exec.is_src_linear) {
+        // Linear to block linear, upload the linear image straight to the cached surface instead
+        // of swizzling it in guest memory and reloading the whole surface
+        const Surface surface{TryGet(memory_manager.GetPointer(dest))};
+        const u32 bytes_per_pixel = regs.src_pitch / regs.x_count;
+        // Scaled surfaces can't take linear rectangles, fall back to a copy in guest memory
+        if (!surface || surface->IsScaled() ||
+            !IsDMACompatibleSurface(surface->GetSurfaceParams(), regs.dst_params,
+                                    bytes_per_pixel)) {
+            return false;
+        }
+        const auto& params{surface->GetSurfaceParams()};
+        if (regs.x_count > params.width || regs.y_count > params.height ||
+            regs.src_pitch % bytes_per_pixel != 0) {
+            return false;
+        }
+
+        const std::size_t src_size = regs.src_pitch * regs.y_count;
+        dma_buffer.resize(src_size);
+        memory_manager.ReadBlock(source, dma_buffer.data(), src_size);
+
+        surface->UploadLinearRect({0, 0, regs.x_count, regs.y_count}, regs.dst_params.pos_z,
+                                  regs.src_pitch, dma_buffer.data());
+        surface->MarkAsModified(true, *this);
+        return true;
+    }
+
+    // Block linear to linear. Only worth doing on the host when the surface holds modifications,
+    // otherwise guest memory is already up to date and reading it back would stall the GPU.
+    const Surface surface{TryGet(memory_manager.GetPointer(source))};
+    if (!surface || surface->IsScaled() || !surface->IsDirty() || regs.src_params.size_x == 0) {
+        return false;
+    }
+    const u32 bytes_per_pixel = regs.src_pitch / regs.src_params.size_x;
+    if (!IsDMACompatibleSurface(surface->GetSurfaceParams(), regs.src_params, bytes_per_pixel)) {
+        return false;
+    }
+    const auto& params{surface->GetSurfaceParams()};
+    const u32 pos_x = regs.src_params.pos_x;
+    const u32 pos_y = regs.src_params.pos_y;
+    if (pos_x + regs.x_count > params.width || pos_y + regs.y_count > params.height ||
+        regs.dst_pitch % bytes_per_pixel != 0 || regs.dst_pitch < regs.x_count * bytes_per_pixel) {
+        return false;
+    }
+
+    // Bytes in between the rows of the destination are preserved
+    const std::size_t dst_size = regs.dst_pitch * regs.y_count;
+    dma_buffer.resize(dst_size);
+    memory_manager.ReadBlock(dest, dma_buffer.data(), dst_size);
+
+    surface->DownloadLinearRect({pos_x, pos_y, pos_x + regs.x_count, pos_y + regs.y_count},
+                                regs.src_params.pos_z, regs.dst_pitch, dma_buffer.data(),
+                                dst_size);
+
+    memory_manager.WriteBlock(dest, dma_buffer.data(), dst_size);
+    return true;
 }
 
 void RasterizerCacheOpenGL::AccurateCopySurface(const Surface& src_surface,
@@ -1184,20 +1996,101 @@ void RasterizerCacheOpenGL::AccurateCopySurface(const Surface& src_surface,
     LoadSurface(dst_surface);
 }
 
+/// Returns true if a texture with the new parameters can be a view of the old surface's storage
+static bool CanAliasSurface(const CachedSurface& old_surface, const SurfaceParams& new_params) {
+    const auto& old_params{old_surface.GetSurfaceParams()};
+    // Sparse storages have room for more layers and levels than the surface that created them
+    if (const auto& storage{old_surface.GetSparseStorage()};
+        storage && new_params.target == old_params.target &&
+        new_params.target != SurfaceTarget::Texture3D &&
+        std::tie(old_params.pixel_format, old_params.component_type, old_params.width,
+                 old_params.height) == std::tie(new_params.pixel_format, new_params.component_type,
+                                                new_params.width, new_params.height) &&
+        new_params.depth <= storage->depth && new_params.max_mip_level <= storage->num_levels) {
+        return true;
+    }
+    if (GetFormatTuple(old_params.pixel_format, old_params.component_type).compressed ||
+        GetFormatTuple(new_params.pixel_format, new_params.component_type).compressed) {
+        return false;
+    }
+    if (old_params.type != new_params.type) {
+        return false;
+    }
+    // Uncompressed color formats share a view class when their sizes match, depth and stencil
+    // formats can only be viewed with their own format
+    if (old_params.type == SurfaceType::ColorTexture
+            ? GetFormatBpp(old_params.pixel_format) != GetFormatBpp(new_params.pixel_format)
+            : old_params.pixel_format != new_params.pixel_format) {
+        return false;
+    }
+    if (std::tie(old_params.width, old_params.height, old_params.depth) !=
+            std::tie(new_params.width, new_params.height, new_params.depth) ||
+        new_params.max_mip_level > old_params.max_mip_level) {
+        return false;
+    }
+    const auto is_layered_target = [](SurfaceTarget target) {
+        return target == SurfaceTarget::Texture2D || target == SurfaceTarget::Texture2DArray ||
+               target == SurfaceTarget::TextureCubemap ||
+               target == SurfaceTarget::TextureCubeArray;
+    };
+    return old_params.target == new_params.target ||
+           (is_layered_target(old_params.target) && is_layered_target(new_params.target));
+}
+
+Surface RasterizerCacheOpenGL::AliasSurface(const Surface& old_surface,
+                                            const SurfaceParams& new_params) {
+    // The old surface shares its storage with the new one from now on. Reusing it for other
+    // contents would overwrite the new surface.
+    const auto old_key{SurfaceReserveKey::Create(old_surface->GetSurfaceParams())};
+    if (const auto it{surface_reserve.find(old_key)};
+        it != surface_reserve.end() && it->second == old_surface) {
+        surface_reserve.erase(it);
+    }
+
+    const auto& sparse_storage{old_surface->GetSparseStorage()};
+    const OGLTexture& storage{sparse_storage ? sparse_storage->texture : old_surface->Texture()};
+    Surface new_surface{std::make_shared<CachedSurface>(new_params, old_surface->GetScale(),
+                                                        &storage, sparse_storage)};
+    ReserveSurface(new_surface);
+    new_surface->MarkAsModified(true, *this);
+    return new_surface;
+}
+
 Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& old_surface,
                                                const SurfaceParams& new_params) {
     // Verify surface is compatible for blitting
     auto old_params{old_surface->GetSurfaceParams()};
 
-    // Get a new surface with the new parameters, and blit the previous surface to it
-    Surface new_surface{GetUncachedSurface(new_params)};
-
     // With use_accurate_gpu_emulation enabled, do an accurate surface copy
     if (Settings::values.use_accurate_gpu_emulation) {
+        Surface new_surface{GetUncachedSurface(new_params)};
         AccurateCopySurface(old_surface, new_surface);
         return new_surface;
     }
 
+    // Views of the same texels don't need a copy, alias the storage of the old surface
+    if (CanAliasSurface(*old_surface, new_params)) {
+        // Layers and levels a sparse storage grows into are loaded from guest memory, which has
+        // to hold the contents of the old surface first
+        const bool grows = new_params.depth > old_params.depth ||
+                           new_params.max_mip_level > old_params.max_mip_level;
+        if (grows && old_surface->IsDirty()) {
+            FlushObject(old_surface);
+        }
+        Surface new_surface{AliasSurface(old_surface, new_params)};
+        if (grows) {
+            LoadSurface(new_surface);
+        }
+        return new_surface;
+    }
+
+    // Copies between surfaces are done in guest texels, keep both surfaces at guest resolution
+    UnscaleSurface(old_surface);
+    unscaled_addresses.insert(new_params.gpu_addr);
+
+    // Get a new surface with the new parameters, and blit the previous surface to it
+    Surface new_surface{GetUncachedSurface(new_params)};
+
     const bool old_compressed =
         GetFormatTuple(old_params.pixel_format, old_params.component_type).compressed;
     const bool new_compressed =
@@ -1205,6 +2098,19 @@ Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& old_surface,
     const bool compatible_formats =
         GetFormatBpp(old_params.pixel_format) == GetFormatBpp(new_params.pixel_format) &&
         !(old_compressed || new_compressed);
+
+    // Depth reinterpreted as color can't be aliased nor copied with glCopyImageSubData,
+    // copy it on the GPU instead of through a PBO
+    if (DepthToColorCopy::IsCompatible(old_params, new_params)) {
+        if (!depth_to_color_copy) {
+            depth_to_color_copy = std::make_unique<DepthToColorCopy>();
+        }
+        new_surface->Commit();
+        depth_to_color_copy->Copy(*old_surface, *new_surface);
+        new_surface->MarkAsModified(true, *this);
+        return new_surface;
+    }
+
     // For compatible surfaces, we can just do fast glCopyImageSubData based copy
     if (old_params.target == new_params.target && old_params.depth == new_params.depth &&
         old_params.depth == 1 && compatible_formats) {
@@ -1246,6 +2152,83 @@ void RasterizerCacheOpenGL::ReserveSurface(const Surface& surface) {
     surface_reserve[surface_reserve_key] = surface;
 }
 
+bool RasterizerCacheOpenGL::TickFrame() {
+    QueuePredictedReadbacks();
+    const bool evicted = EvictSurfaces();
+    frame_start_ticks = GetModifiedTicks();
+    return evicted;
+}
+
+void RasterizerCacheOpenGL::QueuePredictedReadbacks() {
+    for (const auto& [key, surface] : surface_reserve) {
+        if (!surface->IsRegistered() || !surface->IsDirty() || !surface->IsReadbackPredicted()) {
+            continue;
+        }
+        if (texture_swizzler && TextureSwizzler::IsCompatible(surface->GetSurfaceParams())) {
+            // Surfaces swizzled on the GPU are downloaded through the swizzler buffers
+            continue;
+        }
+        if (surface->CanFlushFastClear()) {
+            // Flushing it writes the clear value, there is nothing to read back
+            continue;
+        }
+        surface->Downscale(read_framebuffer.handle, draw_framebuffer.handle);
+        surface->QueueReadback();
+    }
+}
+
+bool RasterizerCacheOpenGL::EvictSurfaces() {
+    const u64 budget = static_cast<u64>(Settings::values.vram_budget) * 1024 * 1024;
+    if (budget == 0) {
+        return false;
+    }
+
+    // Aliased surfaces are counted once per view, the budget errs on the side of evicting early
+    u64 total_size = 0;
+    std::vector<Surface> candidates;
+    for (const auto& [key, surface] : surface_reserve) {
+        total_size += surface->GetResidentSize();
+        if (surface->GetLastUsedTicks() < frame_start_ticks) {
+            candidates.push_back(surface);
+        }
+    }
+    if (total_size <= budget) {
+        return false;
+    }
+
+    // Surfaces only kept in the reserve are released first, then the clean ones and finally the
+    // dirty ones, which have to be flushed before their contents are lost
+    const auto eviction_cost = [](const Surface& surface) {
+        return !surface->IsRegistered() ? 0 : (surface->IsDirty() ? 2 : 1);
+    };
+    std::sort(candidates.begin(), candidates.end(), [&](const Surface& a, const Surface& b) {
+        const int a_cost = eviction_cost(a);
+        const int b_cost = eviction_cost(b);
+        if (a_cost != b_cost) {
+            return a_cost < b_cost;
+        }
+        return a->GetLastUsedTicks() < b->GetLastUsedTicks();
+    });
+
+    bool evicted = false;
+    for (const Surface& surface : candidates) {
+        if (total_size <= budget) {
+            break;
+        }
+        if (surface->IsRegistered()) {
+            FlushObject(surface);
+            Unregister(surface);
+        }
+        surface_reserve.erase(SurfaceReserveKey::Create(surface->GetSurfaceParams()));
+        total_size -= surface->GetResidentSize();
+        evicted = true;
+    }
+    if (total_size > budget) {
+        LOG_DEBUG(Render_OpenGL, "Surfaces used in the last frame exceed the VRAM budget");
+    }
+    return evicted;
+}
+
 Surface RasterizerCacheOpenGL::TryGetReservedSurface(const SurfaceParams& params) {
     const auto& surface_reserve_key{SurfaceReserveKey::Create(params)};
     auto search{surface_reserve.find(surface_reserve_key)};
@@ -1291,6 +2274,7 @@ static bool LayerFitReinterpretSurface(RasterizerCacheOpenGL& cache, const Surfa
             const std::optional<u32> slot =
                 TryFindBestLayer(render_surface->GetSurfaceParams().gpu_addr, dst_params, *level);
             if (slot.has_value()) {
+                blitted_surface->CommitLayers(*slot, 1);
                 glCopyImageSubData(render_surface->Texture().handle,
                                    SurfaceTargetToGL(src_params.target), 0, 0, 0, 0,
                                    blitted_surface->Texture().handle,
@@ -1323,6 +2307,8 @@ static bool IsReinterpretInvalidSecond(const Surface render_surface,
 
 bool RasterizerCacheOpenGL::PartialReinterpretSurface(Surface triggering_surface,
                                                       Surface intersect) {
+    // Layers are copied in guest texels
+    UnscaleSurface(triggering_surface);
     if (IsReinterpretInvalid(triggering_surface, intersect)) {
         Unregister(intersect);
         return false;
@@ -1340,7 +2326,7 @@ bool RasterizerCacheOpenGL::PartialReinterpretSurface(Surface triggering_surface
 }
 
 void RasterizerCacheOpenGL::SignalPreDrawCall() {
-    if (texception && GLAD_GL_ARB_texture_barrier) {
+    if (texception && has_texture_barrier) {
         glTextureBarrier();
     }
     texception = false;
@@ -6,8 +6,10 @@
 
 #include <array>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
 #include "common/alignment.h"
@@ -15,18 +17,29 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/math_util.h"
+#include "common/memory_accounting.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_depth_copy.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
+#include "video_core/renderer_opengl/gl_texture_disk_cache.h"
+#include "video_core/renderer_opengl/gl_texture_swizzler.h"
 #include "video_core/surface.h"
+#include "video_core/textures/convert.h"
 #include "video_core/textures/decoders.h"
 #include "video_core/textures/texture.h"
 
+namespace Core {
+class System;
+}
+
 namespace OpenGL {
 
 class CachedSurface;
+class Device;
 using Surface = std::shared_ptr<CachedSurface>;
 using SurfaceSurfaceRect_Tuple = std::tuple<Surface, Surface, Common::Rectangle<u32>>;
 
@@ -74,6 +87,9 @@ struct SurfaceParams {
     /// Returns the rectangle corresponding to this surface
     Common::Rectangle<u32> GetRect(u32 mip_level = 0) const;
 
+    /// Returns the conversion the texels need between the guest and the host representation
+    Tegra::Texture::GuestConversion GetGuestConversion() const;
+
     /// Returns the total size of this surface in bytes, adjusted for compression
     std::size_t SizeInBytesRaw(bool ignore_tiled = false) const {
         const u32 compression_factor{GetCompressionFactor(pixel_format)};
@@ -361,9 +377,59 @@ struct RasterizerTemporaryMemory {
     std::vector<std::vector<u8>> gl_buffer;
 };
 
+/// Value a whole surface was cleared to, color surfaces only use the color and depth surfaces the
+/// depth and the stencil
+struct FastClearValue {
+    std::array<float, 4> color{};
+    float depth{};
+    s32 stencil{};
+
+    bool operator==(const FastClearValue& rhs) const {
+        return std::tie(color, depth, stencil) == std::tie(rhs.color, rhs.depth, rhs.stencil);
+    }
+
+    bool operator!=(const FastClearValue& rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+/**
+ * Sparse texture backing large layered surfaces. Only the layers that have been written are
+ * committed to memory, and it holds every level and more layers than the surface that created it,
+ * so surfaces growing into it are views of it instead of copies.
+ */
+struct SparseStorage {
+    OGLTexture texture;
+    GLenum target{};
+    u32 width{};
+    u32 height{};
+    /// Layers of the texture, or slices for 3D textures
+    u32 depth{};
+    u32 num_levels{};
+    /// VRAM committed by a layer, 3D textures are committed as a whole
+    std::size_t layer_size{};
+    std::vector<bool> committed_layers;
+
+    Common::MemoryAccounting::Allocation vram_accounting{
+        Common::MemoryAccounting::Category::TextureCache};
+
+    /// Commits a range of layers in every level, or the whole texture if it's 3D
+    void Commit(u32 first_layer, u32 num_layers);
+
+    /// Returns the VRAM committed so far
+    std::size_t GetCommittedSize() const {
+        return static_cast<std::size_t>(vram_accounting.GetSize());
+    }
+};
+
 class CachedSurface final : public RasterizerCacheObject {
 public:
-    explicit CachedSurface(const SurfaceParams& params);
+    /// Creates a surface. When storage is given, the texture is a view of it instead of
+    /// allocating new memory, sparse_storage being the storage when it is sparse. The texture of
+    /// a scaled surface is scale times the guest size.
+    explicit CachedSurface(const SurfaceParams& params, float scale = 1.0f,
+                           const OGLTexture* storage = nullptr,
+                           std::shared_ptr<SparseStorage> sparse_storage = {});
 
     VAddr GetCpuAddr() const override {
         return cpu_addr;
@@ -398,14 +464,59 @@ public:
         return params;
     }
 
+    /// Returns the factor between the size of the texture and the size seen by the guest
+    float GetScale() const {
+        return scale;
+    }
+
+    bool IsScaled() const {
+        return scale != 1.0f;
+    }
+
+    /// Copies the contents of a scaled surface to its guest resolution texture, which is the one
+    /// read by flushes and readbacks
+    void Downscale(GLuint read_fb_handle, GLuint draw_fb_handle);
+
+    /// Replaces the texture of a scaled surface with one at guest resolution
+    void Unscale(GLuint read_fb_handle, GLuint draw_fb_handle);
+
     // Read/Write data in Switch memory to/from gl_buffer
     void LoadGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem);
     void FlushGLBuffer(RasterizerTemporaryMemory& res_cache_tmp_mem);
 
+    /// Returns true if the guest has read the surface back before, so it's expected to do it again
+    bool IsReadbackPredicted() const {
+        return is_readback_predicted;
+    }
+
+    /**
+     * Queues a download of the texture into a pixel pack buffer followed by a fence. If the
+     * surface isn't modified until it's flushed, the flush only waits for the fence.
+     */
+    void QueueReadback();
+
     // Upload data in gl_buffer to this surface's texture
     void UploadGLTexture(RasterizerTemporaryMemory& res_cache_tmp_mem, GLuint read_fb_handle,
                          GLuint draw_fb_handle);
 
+    /// Uploads the guest memory of a tiled surface and unswizzles it on the GPU
+    void UploadSwizzledGLTexture(TextureSwizzler& swizzler, GLuint read_fb_handle,
+                                 GLuint draw_fb_handle);
+
+    /// Swizzles the texture of a tiled surface on the GPU and writes it to guest memory
+    void FlushSwizzledGLBuffer(TextureSwizzler& swizzler);
+
+    /// Uploads a rectangle of pitch linear pixels to a layer of the first level of the texture
+    void UploadLinearRect(const Common::Rectangle<u32>& rect, u32 layer, u32 pitch,
+                          const u8* data);
+
+    /// Downloads a rectangle of a layer of the first level of the texture as pitch linear pixels
+    void DownloadLinearRect(const Common::Rectangle<u32>& rect, u32 layer, u32 pitch, u8* data,
+                            std::size_t data_size);
+
+    /// Copies the texture for a draw that samples it while rendering to it, returns the copy
+    GLuint CopyForFeedbackLoop();
+
     void UpdateSwizzle(Tegra::Texture::SwizzleSource swizzle_x,
                        Tegra::Texture::SwizzleSource swizzle_y,
                        Tegra::Texture::SwizzleSource swizzle_z,
@@ -419,6 +530,15 @@ public:
         return reinterpreted;
     }
 
+    /// Records when the surface was last looked up, used to evict the least recently used first
+    void MarkAsUsed(u64 ticks) {
+        last_used_ticks = ticks;
+    }
+
+    u64 GetLastUsedTicks() const {
+        return last_used_ticks;
+    }
+
     void MarkForReload(bool reload) {
         must_reload = reload;
     }
@@ -431,28 +551,116 @@ public:
         return params.identity == SurfaceParams::SurfaceClass::Uploaded;
     }
 
+    /// Records that the whole surface holds a clear value. It has to be called once the clear has
+    /// marked the surface as modified, any later modification discards the value.
+    void MarkAsFastCleared(const FastClearValue& value) {
+        fast_clear_value = value;
+        fast_clear_ticks = GetLastModifiedTicks();
+    }
+
+    /// Returns the value the whole surface was cleared to, if it hasn't been modified since
+    std::optional<FastClearValue> GetFastClearValue() const {
+        if (fast_clear_ticks != GetLastModifiedTicks()) {
+            return {};
+        }
+        return fast_clear_value;
+    }
+
+    /// Returns true if the surface can be flushed by filling guest memory with its clear value
+    bool CanFlushFastClear() const;
+
+    /// Returns the sparse storage the texture is a view of, null when the texture isn't sparse
+    const std::shared_ptr<SparseStorage>& GetSparseStorage() const {
+        return sparse_storage;
+    }
+
+    /// Returns the estimate of the VRAM taken by the texture, its storage when it's a view
+    std::size_t GetResidentSize() const {
+        return sparse_storage ? sparse_storage->GetCommittedSize() : params.size_in_bytes_gl;
+    }
+
+    /// Commits the memory of every layer of a sparse texture before it's written by the host GPU
+    void Commit() {
+        CommitLayers(0, params.is_layered ? params.depth : 1);
+    }
+
+    /// Commits the memory of a range of layers of a sparse texture before they are written
+    void CommitLayers(u32 first_layer, u32 num_layers) {
+        if (sparse_storage) {
+            sparse_storage->Commit(first_layer, num_layers);
+        }
+    }
+
+    /// Commits the layers of a sparse texture whose guest memory isn't zero before they are
+    /// uploaded. The uncommitted layers already read as zeros.
+    void CommitGuestLayers();
+
+    /// Fills guest memory with the value the surface was cleared to instead of reading it back
+    void FlushFastClear(RasterizerTemporaryMemory& res_cache_tmp_mem);
+
 private:
-    void UploadGLMipmapTexture(RasterizerTemporaryMemory& res_cache_tmp_mem, u32 mip_map,
-                               GLuint read_fb_handle, GLuint draw_fb_handle);
+    /// Uploads a level from buffer, which is an offset when a pixel unpack buffer is bound
+    void UploadGLMipmapTexture(const u8* buffer, u32 mip_map);
 
     void EnsureTextureDiscrepantView();
 
+    /// Writes the texels of the first level in gl_buffer to guest memory
+    void WriteGuestMemory(std::vector<u8>& gl_buffer);
+
+    /// Returns the texture transferred to and from guest memory, which for scaled surfaces is a
+    /// copy at guest resolution
+    GLuint GuestTexture();
+
+    /// Copies the guest resolution texture of a scaled surface to its scaled texture
+    void Upscale(GLuint read_fb_handle, GLuint draw_fb_handle);
+
+    /// Allocates the texture as a view of a new sparse storage. Returns false if the surface
+    /// can't be sparse, leaving the texture uncreated.
+    bool CreateSparseTexture();
+
     OGLTexture texture;
+    /// Guest resolution copy of a scaled surface, created the first time it's transferred
+    OGLTexture guest_texture;
     OGLTexture discrepant_view;
+    /// Copy sampled by the draws rendering to the surface when the host has no texture barriers
+    OGLTexture feedback_copy;
     SurfaceParams params{};
     GLenum gl_target{};
     GLenum gl_internal_format{};
     std::size_t cached_size_in_bytes{};
+    float scale = 1.0f;
     std::array<GLenum, 4> swizzle{GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
     std::size_t memory_size;
     bool reinterpreted = false;
     bool must_reload = false;
     VAddr cpu_addr{};
+    u64 last_used_ticks{};
+
+    /// Persistently mapped buffer the queued readbacks are downloaded to
+    OGLBuffer readback_buffer;
+    const u8* readback_pointer{};
+    /// Signaled once the queued readback has been written, null when there is none pending
+    OGLSync readback_fence;
+    /// Modified ticks of the surface when the readback was queued
+    u64 readback_ticks{};
+    bool is_readback_predicted = false;
+
+    std::optional<FastClearValue> fast_clear_value;
+    /// Modified ticks of the surface when the clear value was recorded
+    u64 fast_clear_ticks{};
+
+    /// Estimate of the VRAM taken by the textures the surface owns, views own none
+    Common::MemoryAccounting::Allocation vram_accounting{
+        Common::MemoryAccounting::Category::TextureCache};
+
+    /// Storage of the texture when it's sparse, shared with the surfaces that are views of it
+    std::shared_ptr<SparseStorage> sparse_storage;
 };
 
 class RasterizerCacheOpenGL final : public RasterizerCache<Surface> {
 public:
-    explicit RasterizerCacheOpenGL(RasterizerOpenGL& rasterizer);
+    explicit RasterizerCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
+                                   const Device& device);
 
     /// Get a surface based on the texture configuration
     Surface GetTextureSurface(const Tegra::Texture::FullTextureInfo& config,
@@ -467,19 +675,48 @@ public:
     /// Tries to find a framebuffer using on the provided CPU address
     Surface TryFindFramebufferSurface(const u8* host_ptr) const;
 
-    /// Copies the contents of one surface to another
-    void FermiCopySurface(const Tegra::Engines::Fermi2D::Regs::Surface& src_config,
+    /**
+     * Makes the attachments of a framebuffer share their scale, unscaling them when they don't.
+     * @returns the factor between the size of the attached textures and the guest size
+     */
+    float SyncFramebufferScale(const std::array<Surface, Maxwell::NumRenderTargets>& color_surfaces,
+                               const Surface& depth_surface);
+
+    /// Blits one surface to another on the host GPU, creating the surfaces that are not cached.
+    /// Returns false when the blit can't be done by the host or is cheaper in guest memory.
+    bool FermiCopySurface(const Tegra::Engines::Fermi2D::Regs::Surface& src_config,
                           const Tegra::Engines::Fermi2D::Regs::Surface& dst_config,
-                          const Common::Rectangle<u32>& src_rect,
-                          const Common::Rectangle<u32>& dst_rect);
+                          const Tegra::Engines::Fermi2D::Config& copy_config);
+
+    /**
+     * Performs a DMA copy between guest memory and a cached surface on the host GPU.
+     * @returns false if no compatible surface is cached and the copy must be done in guest memory
+     */
+    bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs);
 
     void SignalPreDrawCall();
     void SignalPostDrawCall();
 
+    /**
+     * Queues the readbacks of the surfaces expected to be read by the guest and evicts the least
+     * recently used surfaces until the cache fits in the VRAM budget. Surfaces used during the
+     * last frame are kept.
+     * @returns true if any surface was evicted
+     */
+    bool TickFrame();
+
+    /**
+     * Returns the texture a draw samples a surface from. A surface the draw also renders to is
+     * synchronized with a texture barrier before the draw, or sampled from a copy when the host
+     * has no texture barriers.
+     */
+    GLuint GetSampledTexture(const Surface& surface, bool as_array);
+
+    /// Opens the disk cache of the textures decoded on the CPU for the current title
+    void LoadDiskCache();
+
 protected:
-    void FlushObjectInner(const Surface& object) override {
-        object->FlushGLBuffer(temporal_memory);
-    }
+    void FlushObjectInner(const Surface& object) override;
 
 private:
     void LoadSurface(const Surface& surface);
@@ -488,9 +725,27 @@ private:
     /// Gets an uncached surface, creating it if need be
     Surface GetUncachedSurface(const SurfaceParams& params);
 
+    /// Returns the scale a new surface with the given parameters is created at
+    float GetSurfaceScale(const SurfaceParams& params) const;
+
+    /// Brings a scaled surface to guest resolution and stops scaling its address
+    void UnscaleSurface(const Surface& surface);
+
     /// Recreates a surface with new parameters
     Surface RecreateSurface(const Surface& old_surface, const SurfaceParams& new_params);
 
+    /// Creates a surface with new parameters whose texture shares the old surface's storage
+    Surface AliasSurface(const Surface& old_surface, const SurfaceParams& new_params);
+
+    /// Releases the least recently used surfaces until the cache fits in the VRAM budget
+    bool EvictSurfaces();
+
+    /// Queues readbacks of the dirty surfaces the guest is expected to read
+    void QueuePredictedReadbacks();
+
+    /// Returns true if the surface is attached to the framebuffer of the next draw
+    bool IsRenderTarget(const Surface& surface) const;
+
     /// Reserves a unique surface that can be reused later
     void ReserveSurface(const Surface& surface);
 
@@ -509,15 +764,25 @@ private:
                      const GLuint copy_pbo_handle, const GLenum src_attachment = 0,
                      const GLenum dst_attachment = 0, const std::size_t cubemap_face = 0);
 
+    Core::System& system;
+
     /// The surface reserve is a "backup" cache, this is where we put unique surfaces that have
     /// previously been used. This is to prevent surfaces from being constantly created and
     /// destroyed when used with different surface parameters.
     std::unordered_map<SurfaceReserveKey, Surface> surface_reserve;
 
+    /// Modified ticks when the current frame started, surfaces used after it aren't evicted
+    u64 frame_start_ticks = 0;
+
+    /// Addresses of the render targets that were read by the guest or copied to other surfaces.
+    /// Surfaces created on them are kept at guest resolution.
+    std::unordered_set<GPUVAddr> unscaled_addresses;
+
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
     bool texception = false;
+    bool has_texture_barrier = false;
 
     /// Use a Pixel Buffer Object to download the previous texture and then upload it to the new one
     /// using the new format.
@@ -529,6 +794,18 @@ private:
 
     RasterizerTemporaryMemory temporal_memory;
 
+    /// Decoded texels of the textures converted on the CPU, kept between runs
+    TextureDiskCacheOpenGL texture_disk_cache;
+
+    /// Swizzles tiled surfaces on the GPU when enabled, null otherwise
+    std::unique_ptr<TextureSwizzler> texture_swizzler;
+
+    /// Copies depth surfaces reinterpreted as color, built the first time it's needed
+    std::unique_ptr<DepthToColorCopy> depth_to_color_copy;
+
+    /// Staging memory of the DMA copies performed on cached surfaces
+    std::vector<u8> dma_buffer;
+
     using SurfaceIntervalCache = boost::icl::interval_map<CacheAddr, Surface>;
     using SurfaceInterval = typename SurfaceIntervalCache::interval_type;
 
@@ -29,7 +29,7 @@ void OGLTexture::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteTextures(1, &handle);
-    OpenGLState::GetCurState().UnbindTexture(handle).Apply();
+    OpenGLState::GetCurState().UnbindTexture(handle).ApplyTextures();
     handle = 0;
 }
 
@@ -47,7 +47,7 @@ void OGLSampler::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteSamplers(1, &handle);
-    OpenGLState::GetCurState().ResetSampler(handle).Apply();
+    OpenGLState::GetCurState().ResetSampler(handle).ApplySamplers();
     handle = 0;
 }
 
@@ -91,7 +91,7 @@ void OGLProgram::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteProgram(handle);
-    OpenGLState::GetCurState().ResetProgram(handle).Apply();
+    OpenGLState::GetCurState().ResetProgram(handle).ApplyShaderProgram();
     handle = 0;
 }
 
@@ -109,7 +109,7 @@ void OGLPipeline::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteProgramPipelines(1, &handle);
-    OpenGLState::GetCurState().ResetPipeline(handle).Apply();
+    OpenGLState::GetCurState().ResetPipeline(handle).ApplyProgramPipeline();
     handle = 0;
 }
 
@@ -161,7 +161,7 @@ void OGLVertexArray::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteVertexArrays(1, &handle);
-    OpenGLState::GetCurState().ResetVertexArray(handle).Apply();
+    OpenGLState::GetCurState().ResetVertexArray(handle).ApplyVertexArrayState();
     handle = 0;
 }
 
@@ -179,7 +179,24 @@ void OGLFramebuffer::Release() {
 
     MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
     glDeleteFramebuffers(1, &handle);
-    OpenGLState::GetCurState().ResetFramebuffer(handle).Apply();
+    OpenGLState::GetCurState().ResetFramebuffer(handle).ApplyFramebufferState();
+    handle = 0;
+}
+
+void OGLQuery::Create(GLenum target) {
+    if (handle != 0)
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceCreation);
+    glCreateQueries(target, 1, &handle);
+}
+
+void OGLQuery::Release() {
+    if (handle == 0)
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_ResourceDeletion);
+    glDeleteQueries(1, &handle);
     handle = 0;
 }
 
@@ -2,18 +2,26 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <mutex>
 #include <thread>
 #include <boost/functional/hash.hpp>
+#include "common/alignment.h"
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/hash.h"
 #include "common/scope_exit.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
+#include "video_core/renderer_opengl/gl_shader_compiler.h"
 #include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/utils.h"
@@ -23,20 +31,52 @@ namespace OpenGL {
 
 using VideoCommon::Shader::ProgramCode;
 
+TRACE_DEFINE(OpenGL_ShaderDecompile, "OpenGL", "Shader Decompile", MP_RGB(128, 192, 128));
+TRACE_DEFINE(OpenGL_ShaderBuild, "OpenGL", "Shader Build", MP_RGB(128, 192, 128));
+
 // One UBO is always reserved for emulation values
 constexpr u32 RESERVED_UBOS = 1;
 
+// Offset of the first instruction of graphics programs, after the shader header
+constexpr std::size_t STAGE_MAIN_OFFSET = 10;
+
+// Compute kernels have no header, they start at the first instruction
+constexpr std::size_t KERNEL_MAIN_OFFSET = 0;
+
+/// Usages first used within these frames since boot are built before the game starts. Three
+/// seconds at 60 FPS, enough to cover the boot screens of most games.
+constexpr u32 BOOT_WARMUP_FRAMES = 180;
+
 struct UnspecializedShader {
     std::string code;
     GLShader::ShaderEntries entries;
     Maxwell::ShaderProgram program_type;
 };
 
+/// Disk cache usages built in the background while the game runs
+struct ShaderStreaming {
+    std::vector<ShaderDiskCacheUsage> usages; ///< Usages in the order they are built
+    std::unordered_map<u64, UnspecializedShader> unspecialized;
+    ShaderDumpsMap dumps;
+    std::set<GLenum> supported_formats;
+
+    std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+    std::atomic_size_t next_usage{0};   ///< Index of the next usage a worker takes
+    std::atomic_size_t num_finished{0}; ///< Number of usages that have been built
+    std::atomic_bool stop{false};
+    std::atomic_bool dump_rejected{false};
+
+    /// Programs rejected by the driver, they are released on the GPU thread
+    std::mutex mutex;
+    std::vector<CachedProgram> rejected_programs;
+};
+
 namespace {
 
 /// Gets the address for the specified shader stage program
-GPUVAddr GetShaderAddress(Maxwell::ShaderProgram program) {
-    const auto& gpu{Core::System::GetInstance().GPU().Maxwell3D()};
+GPUVAddr GetShaderAddress(Core::System& system, Maxwell::ShaderProgram program) {
+    const auto& gpu{system.GPU().Maxwell3D()};
     const auto& shader_config{gpu.regs.shader_config[static_cast<std::size_t>(program)]};
     return gpu.regs.code_address.CodeAddress() + shader_config.offset;
 }
@@ -69,6 +109,26 @@ constexpr GLenum GetShaderType(Maxwell::ShaderProgram program_type) {
     }
 }
 
+/// Gets the name of a program type for the shader statistics
+constexpr const char* GetStageName(Maxwell::ShaderProgram program_type) {
+    switch (program_type) {
+    case Maxwell::ShaderProgram::VertexA:
+        return "VertexA";
+    case Maxwell::ShaderProgram::VertexB:
+        return "VertexB";
+    case Maxwell::ShaderProgram::TesselationControl:
+        return "TesselationControl";
+    case Maxwell::ShaderProgram::TesselationEval:
+        return "TesselationEval";
+    case Maxwell::ShaderProgram::Geometry:
+        return "Geometry";
+    case Maxwell::ShaderProgram::Fragment:
+        return "Fragment";
+    default:
+        return "Unknown";
+    }
+}
+
 /// Gets if the current instruction offset is a scheduler instruction
 constexpr bool IsSchedInstruction(std::size_t offset, std::size_t main_offset) {
     // Sched instructions appear once every 4 instructions.
@@ -101,13 +161,13 @@ constexpr std::tuple<const char*, const char*, u32> GetPrimitiveDescription(GLen
 }
 
 /// Calculates the size of a program stream
-std::size_t CalculateProgramSize(const GLShader::ProgramCode& program) {
-    constexpr std::size_t start_offset = 10;
-    std::size_t offset = start_offset;
-    std::size_t size = start_offset * sizeof(u64);
+std::size_t CalculateProgramSize(const GLShader::ProgramCode& program,
+                                 std::size_t main_offset = STAGE_MAIN_OFFSET) {
+    std::size_t offset = main_offset;
+    std::size_t size = main_offset * sizeof(u64);
     while (offset < program.size()) {
         const u64 instruction = program[offset];
-        if (!IsSchedInstruction(offset, start_offset)) {
+        if (!IsSchedInstruction(offset, main_offset)) {
             if (instruction == 0 || (instruction >> 52) == 0x50b) {
                 // End on Maxwell's "nop" instruction
                 break;
@@ -139,6 +199,18 @@ u64 GetUniqueIdentifier(Maxwell::ShaderProgram program_type, const ProgramCode&
     return static_cast<u64>(seed);
 }
 
+/// Hashes the contents of one (or two) program streams to look them up in the decode cache. The
+/// unique identifier is combined with an independent hash of the code, making a 128-bit key.
+u128 GetCodeHash(Maxwell::ShaderProgram program_type, const ProgramCode& code,
+                 const ProgramCode& code_b, u64 unique_identifier) {
+    Common::HashState hash;
+    hash.Update(code.data(), CalculateProgramSize(code));
+    if (program_type == Maxwell::ShaderProgram::VertexA) {
+        hash.Update(code_b.data(), CalculateProgramSize(code_b));
+    }
+    return {unique_identifier, hash.Digest()};
+}
+
 /// Creates an unspecialized program from code streams
 GLShader::ProgramResult CreateProgram(const Device& device, Maxwell::ShaderProgram program_type,
                                       ProgramCode program_code, ProgramCode program_code_b) {
@@ -167,12 +239,10 @@ GLShader::ProgramResult CreateProgram(const Device& device, Maxwell::ShaderProgr
     }
 }
 
-CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEntries& entries,
-                               Maxwell::ShaderProgram program_type, BaseBindings base_bindings,
-                               GLenum primitive_mode, bool hint_retrievable = false) {
-    std::string source = "#version 430 core\n";
-    source += fmt::format("#define EMULATION_UBO_BINDING {}\n", base_bindings.cbuf++);
-
+/// Generates the defines assigning a binding to each resource used by a program
+std::string GenerateBindingDefines(const GLShader::ShaderEntries& entries,
+                                   BaseBindings base_bindings) {
+    std::string source;
     for (const auto& cbuf : entries.const_buffers) {
         source +=
             fmt::format("#define CBUF_BINDING_{} {}\n", cbuf.GetIndex(), base_bindings.cbuf++);
@@ -183,8 +253,91 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
     }
     for (const auto& sampler : entries.samplers) {
         source += fmt::format("#define SAMPLER_BINDING_{} {}\n", sampler.GetIndex(),
-                              base_bindings.sampler++);
+                              base_bindings.sampler);
+        base_bindings.sampler += static_cast<u32>(sampler.GetSize());
+    }
+    return source;
+}
+
+/// Generates the outputs captured by transform feedback and the function that writes them, it is
+/// appended to the program so it can read the output attributes the program declares
+std::string GenerateTransformFeedback(const TransformFeedbackConfig& config) {
+    constexpr u32 position_attribute = 7;
+    constexpr u32 first_generic_attribute = 8;
+    constexpr std::array<const char*, 4> types = {"float", "vec2", "vec3", "vec4"};
+    constexpr std::array<char, 4> swizzle = {'x', 'y', 'z', 'w'};
+
+    std::string declarations;
+    std::string writes;
+    for (std::size_t buffer = 0; buffer < Maxwell::NumTransformFeedbackBuffers; ++buffer) {
+        if (config.strides[buffer] == 0) {
+            continue;
+        }
+        declarations += fmt::format("layout (xfb_buffer = {}, xfb_stride = {}) out;\n", buffer,
+                                    config.strides[buffer]);
+
+        const auto& locs = config.varying_locs[buffer];
+        const u32 count = std::min<u32>(config.varying_counts[buffer],
+                                        static_cast<u32>(Maxwell::MaxTransformFeedbackVaryings));
+        u32 word = 0;
+        while (word < count) {
+            // Captures consecutive components of the same attribute with a single output
+            const u32 attribute = locs[word] / 4;
+            const u32 first_component = locs[word] % 4;
+            u32 num_components = 1;
+            while (word + num_components < count && first_component + num_components < 4 &&
+                   locs[word + num_components] == locs[word] + num_components) {
+                ++num_components;
+            }
+
+            std::string value;
+            if (attribute == position_attribute) {
+                value = "position";
+            } else if (attribute >= first_generic_attribute &&
+                       attribute < first_generic_attribute + Maxwell::NumVaryings) {
+                value = fmt::format("OUTPUT_ATTRIBUTE_{}", attribute - first_generic_attribute);
+            } else {
+                LOG_WARNING(Render_OpenGL, "Unimplemented transform feedback attribute {}",
+                            attribute);
+            }
+
+            if (!value.empty()) {
+                const std::string name = fmt::format("xfb_{}_{}", buffer, word);
+                const char* type = types[num_components - 1];
+                declarations +=
+                    fmt::format("layout (xfb_buffer = {}, xfb_offset = {}) out {} {};\n", buffer,
+                                word * 4, type, name);
+
+                std::string components(swizzle.data() + first_component, num_components);
+                if (attribute == position_attribute) {
+                    writes += fmt::format("    {} = {}.{};\n", name, value, components);
+                } else {
+                    // Attributes the program doesn't write are captured as zero
+                    writes += fmt::format("#ifdef {}\n", value);
+                    writes += fmt::format("    {} = {}.{};\n", name, value, components);
+                    writes += fmt::format("#else\n    {} = {}(0);\n#endif\n", name, type);
+                }
+            }
+            word += num_components;
+        }
     }
+    return fmt::format("\n{}\nvoid write_transform_feedback() {{\n{}}}\n", declarations, writes);
+}
+
+/// Generates the source of a graphics program specialized for the given bindings and topology,
+/// and for transform feedback when a configuration is given
+std::string SpecializeSource(const std::string& code, const GLShader::ShaderEntries& entries,
+                             Maxwell::ShaderProgram program_type, BaseBindings base_bindings,
+                             GLenum primitive_mode,
+                             const TransformFeedbackConfig* transform_feedback = nullptr) {
+    std::string source = "#version 430 core\n";
+    if (transform_feedback) {
+        source += "#extension GL_ARB_enhanced_layouts : require\n";
+        source += "#define TRANSFORM_FEEDBACK\n";
+        source += "void write_transform_feedback();\n";
+    }
+    source += fmt::format("#define EMULATION_UBO_BINDING {}\n", base_bindings.cbuf++);
+    source += GenerateBindingDefines(entries, base_bindings);
 
     if (program_type == Maxwell::ShaderProgram::Geometry) {
         const auto [glsl_topology, debug_name, max_vertices] =
@@ -195,6 +348,18 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
     }
 
     source += code;
+    if (transform_feedback) {
+        source += GenerateTransformFeedback(*transform_feedback);
+    }
+    return source;
+}
+
+CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEntries& entries,
+                               Maxwell::ShaderProgram program_type, BaseBindings base_bindings,
+                               GLenum primitive_mode, bool hint_retrievable = false,
+                               const TransformFeedbackConfig* transform_feedback = nullptr) {
+    const std::string source{SpecializeSource(code, entries, program_type, base_bindings,
+                                              primitive_mode, transform_feedback)};
 
     OGLShader shader;
     shader.Create(source.c_str(), GetShaderType(program_type));
@@ -204,6 +369,39 @@ CachedProgram SpecializeShader(const std::string& code, const GLShader::ShaderEn
     return program;
 }
 
+CachedProgram SpecializeKernel(const std::string& code, const GLShader::ShaderEntries& entries,
+                               const KernelConfig& config) {
+    // Kernels are dispatched on their own, their resources are bound starting from zero
+    std::string source = "#version 430 core\n";
+    source += GenerateBindingDefines(entries, {});
+    source += fmt::format(
+        "#define LOCAL_MEMORY_ELEMENTS {}\n",
+        std::max<u32>(Common::AlignUp(config.local_memory_size, 4) / 4, 1));
+    source += fmt::format(
+        "#define SHARED_MEMORY_ELEMENTS {}\n",
+        std::max<u32>(Common::AlignUp(config.shared_memory_size, 4) / 4, 1));
+    source += fmt::format("layout (local_size_x = {}, local_size_y = {}, local_size_z = {}) in;\n",
+                          config.local_size[0], config.local_size[1], config.local_size[2]);
+    source += code;
+
+    OGLShader shader;
+    shader.Create(source.c_str(), GL_COMPUTE_SHADER);
+
+    auto program = std::make_shared<OGLProgram>();
+    program->Create(true, false, shader.handle);
+    return program;
+}
+
+/// Gets the number of threads used to load the disk cache
+std::size_t GetNumLoadWorkers() {
+    return static_cast<std::size_t>(std::thread::hardware_concurrency() + 1);
+}
+
+std::size_t GetNumStreamingWorkers() {
+    // The game is running while the disk cache is streamed, leave most host threads to it
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency() / 4, 1, 2);
+}
+
 std::set<GLenum> GetSupportedFormats() {
     std::set<GLenum> supported_formats;
 
@@ -220,48 +418,37 @@ std::set<GLenum> GetSupportedFormats() {
 
 } // Anonymous namespace
 
-CachedShader::CachedShader(const Device& device, VAddr cpu_addr, u64 unique_identifier,
+CachedShader::CachedShader(VAddr cpu_addr, u64 unique_identifier,
                            Maxwell::ShaderProgram program_type, ShaderDiskCacheOpenGL& disk_cache,
                            const PrecompiledPrograms& precompiled_programs,
-                           ProgramCode&& program_code, ProgramCode&& program_code_b, u8* host_ptr)
+                           ShaderCompilerPool* compiler_pool, ShaderStatistics& statistics,
+                           GLShader::ProgramResult result, u8* host_ptr)
     : RasterizerCacheObject{host_ptr}, host_ptr{host_ptr}, cpu_addr{cpu_addr},
       unique_identifier{unique_identifier}, program_type{program_type}, disk_cache{disk_cache},
-      precompiled_programs{precompiled_programs} {
-    const std::size_t code_size{CalculateProgramSize(program_code)};
-    const std::size_t code_size_b{program_code_b.empty() ? 0
-                                                         : CalculateProgramSize(program_code_b)};
-    GLShader::ProgramResult program_result{
-        CreateProgram(device, program_type, program_code, program_code_b)};
-    if (program_result.first.empty()) {
-        // TODO(Rodrigo): Unimplemented shader stages hit here, avoid using these for now
-        return;
-    }
-
-    code = program_result.first;
-    entries = program_result.second;
+      precompiled_programs{precompiled_programs}, compiler_pool{compiler_pool},
+      statistics{statistics} {
+    code = std::move(result.first);
+    entries = result.second;
     shader_length = entries.shader_length;
-
-    const ShaderDiskCacheRaw raw(unique_identifier, program_type,
-                                 static_cast<u32>(code_size / sizeof(u64)),
-                                 static_cast<u32>(code_size_b / sizeof(u64)),
-                                 std::move(program_code), std::move(program_code_b));
-    disk_cache.SaveRaw(raw);
+    code_accounting.Resize(code.size());
 }
 
-CachedShader::CachedShader(VAddr cpu_addr, u64 unique_identifier,
-                           Maxwell::ShaderProgram program_type, ShaderDiskCacheOpenGL& disk_cache,
+CachedShader::CachedShader(VAddr cpu_addr, u64 unique_identifier, ShaderDiskCacheOpenGL& disk_cache,
                            const PrecompiledPrograms& precompiled_programs,
-                           GLShader::ProgramResult result, u8* host_ptr)
-    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, unique_identifier{unique_identifier},
-      program_type{program_type}, disk_cache{disk_cache}, precompiled_programs{
-                                                              precompiled_programs} {
+                           ShaderStatistics& statistics, GLShader::ProgramResult result,
+                           u8* host_ptr)
+    : RasterizerCacheObject{host_ptr}, host_ptr{host_ptr}, cpu_addr{cpu_addr},
+      unique_identifier{unique_identifier}, is_kernel{true}, disk_cache{disk_cache},
+      precompiled_programs{precompiled_programs}, statistics{statistics} {
     code = std::move(result.first);
-    entries = result.second;
+    entries = std::move(result.second);
     shader_length = entries.shader_length;
+    code_accounting.Resize(code.size());
 }
 
 std::tuple<GLuint, BaseBindings> CachedShader::GetProgramHandle(GLenum primitive_mode,
                                                                 BaseBindings base_bindings) {
+    ASSERT(!is_kernel);
     GLuint handle{};
     if (program_type == Maxwell::ShaderProgram::Geometry) {
         handle = GetGeometryShader(primitive_mode, base_bindings);
@@ -270,23 +457,67 @@ std::tuple<GLuint, BaseBindings> CachedShader::GetProgramHandle(GLenum primitive
         auto& program = entry->second;
         if (is_cache_miss) {
             program = TryLoadProgram(primitive_mode, base_bindings);
-            if (!program) {
-                program =
-                    SpecializeShader(code, entries, program_type, base_bindings, primitive_mode);
-                disk_cache.SaveUsage(GetUsage(primitive_mode, base_bindings));
+            if (!program && compiler_pool) {
+                // Build it in the background, the generic program is used until it's ready
+                statistics.RecordQueued(unique_identifier);
+                auto queued = TryGetStreamedProgram(primitive_mode, base_bindings);
+                if (!queued) {
+                    queued = compiler_pool->Queue(SpecializeSource(code, entries, program_type,
+                                                                   base_bindings, primitive_mode),
+                                                  GetShaderType(program_type));
+                }
+                pending_programs.emplace(base_bindings, std::move(queued));
+            } else if (!program) {
+                program = BuildProgram(primitive_mode, base_bindings);
             }
 
-            LabelGLObject(GL_PROGRAM, program->handle, cpu_addr);
+            if (program) {
+                LabelGLObject(GL_PROGRAM, program->handle, cpu_addr);
+            }
+        }
+        if (!program) {
+            program = TryTakeQueuedProgram(primitive_mode, base_bindings);
         }
 
-        handle = program->handle;
+        handle = program ? program->handle : GetGenericProgram(primitive_mode, base_bindings);
     }
+    return {handle, GetNextBindings(base_bindings)};
+}
 
-    base_bindings.cbuf += static_cast<u32>(entries.const_buffers.size()) + RESERVED_UBOS;
-    base_bindings.gmem += static_cast<u32>(entries.global_memory_entries.size());
-    base_bindings.sampler += static_cast<u32>(entries.samplers.size());
+std::tuple<GLuint, BaseBindings> CachedShader::GetTransformFeedbackHandle(
+    GLenum primitive_mode, BaseBindings base_bindings, const TransformFeedbackConfig& config) {
+    ASSERT(program_type != Maxwell::ShaderProgram::Fragment && !is_kernel);
+    if (program_type != Maxwell::ShaderProgram::Geometry) {
+        // Only geometry programs depend on the topology
+        primitive_mode = GL_POINTS;
+    }
 
-    return {handle, base_bindings};
+    const auto [entry, is_cache_miss] = transform_feedback_programs.try_emplace(
+        {primitive_mode, base_bindings.cbuf, base_bindings.gmem, base_bindings.sampler, config});
+    auto& program = entry->second;
+    if (is_cache_miss) {
+        TRACE_SCOPE(OpenGL_ShaderBuild);
+        const auto start = ShaderStatistics::Clock::now();
+        program = SpecializeShader(code, entries, program_type, base_bindings, primitive_mode,
+                                   false, &config);
+        statistics.RecordBuild(unique_identifier, ShaderStatistics::Clock::now() - start);
+        LabelGLObject(GL_PROGRAM, program->handle, cpu_addr, "TransformFeedback");
+    }
+    return {program->handle, GetNextBindings(base_bindings)};
+}
+
+GLuint CachedShader::GetKernelHandle(const KernelConfig& config) {
+    ASSERT(is_kernel);
+    const auto [entry, is_cache_miss] = kernel_programs.try_emplace(config);
+    auto& program = entry->second;
+    if (is_cache_miss) {
+        TRACE_SCOPE(OpenGL_ShaderBuild);
+        const auto start = ShaderStatistics::Clock::now();
+        program = SpecializeKernel(code, entries, config);
+        statistics.RecordBuild(unique_identifier, ShaderStatistics::Clock::now() - start);
+        LabelGLObject(GL_PROGRAM, program->handle, cpu_addr);
+    }
+    return program->handle;
 }
 
 GLuint CachedShader::GetGeometryShader(GLenum primitive_mode, BaseBindings base_bindings) {
@@ -323,9 +554,7 @@ GLuint CachedShader::LazyGeometryProgram(CachedProgram& target_program, BaseBind
     const auto [glsl_name, debug_name, vertices] = GetPrimitiveDescription(primitive_mode);
     target_program = TryLoadProgram(primitive_mode, base_bindings);
     if (!target_program) {
-        target_program =
-            SpecializeShader(code, entries, program_type, base_bindings, primitive_mode);
-        disk_cache.SaveUsage(GetUsage(primitive_mode, base_bindings));
+        target_program = BuildProgram(primitive_mode, base_bindings);
     }
 
     LabelGLObject(GL_PROGRAM, target_program->handle, cpu_addr, debug_name);
@@ -333,23 +562,152 @@ GLuint CachedShader::LazyGeometryProgram(CachedProgram& target_program, BaseBind
     return target_program->handle;
 };
 
+GLuint CachedShader::GetGenericProgram(GLenum primitive_mode, BaseBindings base_bindings) {
+    if (!generic.queued) {
+        // The generic program uses the default bindings, they are moved on each use
+        generic.queued =
+            compiler_pool->Queue(SpecializeSource(code, entries, program_type, {}, primitive_mode),
+                                 GetShaderType(program_type));
+    }
+    if (!generic.program) {
+        if (!generic.queued->is_built) {
+            // Neither variant is ready, the caller has to skip its draws
+            return 0;
+        }
+        generic.program = std::move(generic.queued->program);
+        LabelGLObject(GL_PROGRAM, generic.program->handle, cpu_addr, "Generic");
+
+        // Gather the default binding of each resource to offset them later
+        const GLuint handle = generic.program->handle;
+        const auto GatherBlocks = [handle](GLenum interface, auto& blocks) {
+            GLint num_blocks{};
+            glGetProgramInterfaceiv(handle, interface, GL_ACTIVE_RESOURCES, &num_blocks);
+            for (GLint index = 0; index < num_blocks; ++index) {
+                const GLenum property = GL_BUFFER_BINDING;
+                GLint binding{};
+                glGetProgramResourceiv(handle, interface, static_cast<GLuint>(index), 1,
+                                       &property, 1, nullptr, &binding);
+                blocks.emplace_back(static_cast<GLuint>(index), binding);
+            }
+        };
+        GatherBlocks(GL_UNIFORM_BLOCK, generic.uniform_blocks);
+        GatherBlocks(GL_SHADER_STORAGE_BLOCK, generic.storage_blocks);
+
+        // Samplers are the only uniforms declared outside of a block
+        GLint num_uniforms{};
+        glGetProgramInterfaceiv(handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &num_uniforms);
+        for (GLint index = 0; index < num_uniforms; ++index) {
+            const std::array<GLenum, 2> properties{GL_BLOCK_INDEX, GL_LOCATION};
+            std::array<GLint, 2> values{};
+            glGetProgramResourceiv(handle, GL_UNIFORM, static_cast<GLuint>(index),
+                                   static_cast<GLsizei>(properties.size()), properties.data(),
+                                   static_cast<GLsizei>(values.size()), nullptr, values.data());
+            const auto [block_index, location] = values;
+            if (block_index != -1 || location == -1) {
+                continue;
+            }
+            GLint unit{};
+            glGetUniformiv(handle, location, &unit);
+            generic.samplers.emplace_back(location, unit);
+        }
+    }
+
+    const GLuint handle = generic.program->handle;
+    if (generic.bindings != base_bindings) {
+        generic.bindings = base_bindings;
+        for (const auto& [index, binding] : generic.uniform_blocks) {
+            glUniformBlockBinding(handle, index, binding + base_bindings.cbuf);
+        }
+        for (const auto& [index, binding] : generic.storage_blocks) {
+            glShaderStorageBlockBinding(handle, index, binding + base_bindings.gmem);
+        }
+        for (const auto& [location, unit] : generic.samplers) {
+            glProgramUniform1i(handle, location, unit + static_cast<GLint>(base_bindings.sampler));
+        }
+    }
+    return handle;
+}
+
+CachedProgram CachedShader::TryTakeQueuedProgram(GLenum primitive_mode,
+                                                 BaseBindings base_bindings) {
+    const auto it = pending_programs.find(base_bindings);
+    if (it == pending_programs.end() || !it->second->is_built) {
+        return {};
+    }
+    // Streamed programs are shared with the disk cache, so the program is not moved out
+    CachedProgram program = it->second->program;
+    pending_programs.erase(it);
+
+    disk_cache.SaveUsage(GetUsage(primitive_mode, base_bindings));
+    LabelGLObject(GL_PROGRAM, program->handle, cpu_addr);
+    return program;
+}
+
 CachedProgram CachedShader::TryLoadProgram(GLenum primitive_mode,
                                            BaseBindings base_bindings) const {
     const auto found = precompiled_programs.find(GetUsage(primitive_mode, base_bindings));
-    if (found == precompiled_programs.end()) {
+    if (found == precompiled_programs.end() || !found->second->is_built) {
+        return {};
+    }
+    statistics.RecordPrecompiled(unique_identifier);
+    return found->second->program;
+}
+
+std::shared_ptr<QueuedProgram> CachedShader::TryGetStreamedProgram(
+    GLenum primitive_mode, BaseBindings base_bindings) const {
+    const auto found = precompiled_programs.find(GetUsage(primitive_mode, base_bindings));
+    if (found == precompiled_programs.end() || found->second->is_built) {
         return {};
     }
     return found->second;
 }
 
+CachedProgram CachedShader::BuildProgram(GLenum primitive_mode, BaseBindings base_bindings) {
+    TRACE_SCOPE(OpenGL_ShaderBuild);
+    const auto start = ShaderStatistics::Clock::now();
+    CachedProgram program =
+        SpecializeShader(code, entries, program_type, base_bindings, primitive_mode);
+    statistics.RecordBuild(unique_identifier, ShaderStatistics::Clock::now() - start);
+
+    disk_cache.SaveUsage(GetUsage(primitive_mode, base_bindings));
+    return program;
+}
+
 ShaderDiskCacheUsage CachedShader::GetUsage(GLenum primitive_mode,
                                             BaseBindings base_bindings) const {
     return {unique_identifier, base_bindings, primitive_mode};
 }
 
+BaseBindings CachedShader::GetNextBindings(BaseBindings base_bindings) const {
+    base_bindings.cbuf += static_cast<u32>(entries.const_buffers.size()) + RESERVED_UBOS;
+    base_bindings.gmem += static_cast<u32>(entries.global_memory_entries.size());
+    for (const auto& sampler : entries.samplers) {
+        base_bindings.sampler += static_cast<u32>(sampler.GetSize());
+    }
+    return base_bindings;
+}
+
 ShaderCacheOpenGL::ShaderCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
                                      Core::Frontend::EmuWindow& emu_window, const Device& device)
-    : RasterizerCache{rasterizer}, emu_window{emu_window}, device{device}, disk_cache{system} {}
+    : RasterizerCache{rasterizer}, system{system}, emu_window{emu_window}, device{device},
+      disk_cache{system}, statistics{system} {
+    if (Settings::values.use_asynchronous_shaders) {
+        compiler_pool = std::make_unique<ShaderCompilerPool>(emu_window);
+        if (!compiler_pool->IsAvailable()) {
+            compiler_pool.reset();
+        }
+    }
+}
+
+ShaderCacheOpenGL::~ShaderCacheOpenGL() {
+    if (!streaming) {
+        return;
+    }
+    streaming->stop = true;
+    for (auto& worker : streaming->workers) {
+        worker.join();
+    }
+}
 
 void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
                                       const VideoCore::DiskResourceLoadCallback& callback) {
@@ -357,20 +715,29 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     if (!transferable) {
         return;
     }
-    const auto [raws, shader_usages] = *transferable;
+    const auto& [raws, usages] = *transferable;
 
     auto [decompiled, dumps] = disk_cache.LoadPrecompiled();
 
-    const auto supported_formats{GetSupportedFormats()};
-    const auto unspecialized_shaders{
+    auto supported_formats{GetSupportedFormats()};
+    auto unspecialized_shaders{
         GenerateUnspecializedShaders(stop_loading, callback, raws, decompiled)};
     if (stop_loading) {
         return;
     }
 
-    // Track if precompiled cache was altered during loading to know if we have to serialize the
-    // virtual precompiled cache file back to the hard drive
-    bool precompiled_cache_altered = false;
+    // Build the usages in the order the title needs them. Only the ones used right after boot
+    // are built before the game starts, the rest are streamed in while it runs.
+    std::vector<ShaderDiskCacheUsage> shader_usages{usages};
+    std::sort(shader_usages.begin(), shader_usages.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.first_use_frame, lhs.first_use_order) <
+               std::tie(rhs.first_use_frame, rhs.first_use_order);
+    });
+    const auto boot_end = std::partition_point(
+        shader_usages.begin(), shader_usages.end(),
+        [](const auto& usage) { return usage.first_use_frame < BOOT_WARMUP_FRAMES; });
+    std::vector<ShaderDiskCacheUsage> streamed_usages(boot_end, shader_usages.end());
+    shader_usages.erase(boot_end, shader_usages.end());
 
     // Inform the frontend about shader build initialization
     if (callback) {
@@ -413,17 +780,21 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
                                           usage.primitive, true);
             }
 
+            auto queued = std::make_shared<QueuedProgram>();
+            queued->program = std::move(shader);
+            queued->is_built = true;
+
             std::scoped_lock lock(mutex);
             if (callback) {
                 callback(VideoCore::LoadCallbackStage::Build, ++built_shaders,
                          shader_usages.size());
             }
 
-            precompiled_programs.emplace(usage, std::move(shader));
+            precompiled_programs.emplace(usage, std::move(queued));
         }
     };
 
-    const auto num_workers{static_cast<std::size_t>(std::thread::hardware_concurrency() + 1)};
+    const std::size_t num_workers{GetNumLoadWorkers()};
     const std::size_t bucket_size{shader_usages.size() / num_workers};
     std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts(num_workers);
     std::vector<std::thread> threads(num_workers);
@@ -434,7 +805,8 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
 
         // On some platforms the shared context has to be created from the GUI thread
         contexts[i] = emu_window.CreateSharedContext();
-        threads[i] = std::thread(Worker, contexts[i].get(), start, end, shader_usages, dumps);
+        threads[i] = std::thread(Worker, contexts[i].get(), start, end, std::cref(shader_usages),
+                                 std::cref(dumps));
     }
     for (auto& thread : threads) {
         thread.join();
@@ -444,7 +816,6 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
         // Invalidate the precompiled cache if a shader dumped shader was rejected
         disk_cache.InvalidatePrecompiled();
         dumps.clear();
-        precompiled_cache_altered = true;
         return;
     }
     if (stop_loading) {
@@ -457,19 +828,28 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     for (std::size_t i = 0; i < shader_usages.size(); ++i) {
         const auto& usage{shader_usages[i]};
         if (dumps.find(usage) == dumps.end()) {
-            const auto& program{precompiled_programs.at(usage)};
-            disk_cache.SaveDump(usage, program->handle);
-            precompiled_cache_altered = true;
+            const auto& queued{precompiled_programs.at(usage)};
+            disk_cache.SaveDump(usage, queued->program->handle);
         }
     }
 
-    if (precompiled_cache_altered) {
-        disk_cache.SaveVirtualPrecompiledFile();
+    disk_cache.SavePrecompiledEntries();
+
+    if (streamed_usages.empty()) {
+        return;
+    }
+    const std::size_t num_streamed = streamed_usages.size();
+    if (!StartStreaming(std::move(streamed_usages), std::move(unspecialized_shaders),
+                        std::move(dumps), std::move(supported_formats))) {
+        LOG_WARNING(Render_OpenGL, "Shared contexts are not available, {} shaders of the disk "
+                                   "cache will be built when they are used",
+                    num_streamed);
     }
 }
 
 CachedProgram ShaderCacheOpenGL::GeneratePrecompiledProgram(
-    const ShaderDiskCacheDump& dump, const std::set<GLenum>& supported_formats) {
+    const ShaderDiskCacheDump& dump, const std::set<GLenum>& supported_formats,
+    std::vector<CachedProgram>* rejected_programs) {
 
     if (supported_formats.find(dump.binary_format) == supported_formats.end()) {
         LOG_INFO(Render_OpenGL, "Precompiled cache entry with unsupported format - removing");
@@ -486,12 +866,116 @@ CachedProgram ShaderCacheOpenGL::GeneratePrecompiledProgram(
     glGetProgramiv(shader->handle, GL_LINK_STATUS, &link_status);
     if (link_status == GL_FALSE) {
         LOG_INFO(Render_OpenGL, "Precompiled cache rejected by the driver - removing");
+        if (rejected_programs) {
+            rejected_programs->push_back(std::move(shader));
+        }
         return {};
     }
 
     return shader;
 }
 
+bool ShaderCacheOpenGL::StartStreaming(std::vector<ShaderDiskCacheUsage> usages,
+                                       std::unordered_map<u64, UnspecializedShader> unspecialized,
+                                       ShaderDumpsMap dumps, std::set<GLenum> supported_formats) {
+    auto state = std::make_unique<ShaderStreaming>();
+    const std::size_t num_workers{GetNumStreamingWorkers()};
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        // On some platforms the shared context has to be created from the GUI thread
+        auto context = emu_window.CreateSharedContext();
+        if (!context) {
+            break;
+        }
+        state->contexts.push_back(std::move(context));
+    }
+    if (state->contexts.empty()) {
+        return false;
+    }
+
+    // Every streamed program is known before the game starts, so the map isn't modified while the
+    // workers and the GPU thread look at it
+    for (const auto& usage : usages) {
+        precompiled_programs.emplace(usage, std::make_shared<QueuedProgram>());
+    }
+    state->usages = std::move(usages);
+    state->unspecialized = std::move(unspecialized);
+    state->dumps = std::move(dumps);
+    state->supported_formats = std::move(supported_formats);
+
+    LOG_INFO(Render_OpenGL, "Streaming {} shaders of the disk cache with {} workers",
+             state->usages.size(), state->contexts.size());
+    streaming = std::move(state);
+    for (auto& context : streaming->contexts) {
+        streaming->workers.emplace_back(&ShaderCacheOpenGL::StreamingWorker, this, context.get());
+    }
+    return true;
+}
+
+void ShaderCacheOpenGL::TryFinishStreaming() {
+    if (streaming->num_finished < streaming->usages.size()) {
+        return;
+    }
+    for (auto& worker : streaming->workers) {
+        worker.join();
+    }
+
+    if (streaming->dump_rejected) {
+        // Invalidate the precompiled cache if a dumped shader was rejected
+        disk_cache.InvalidatePrecompiled();
+    } else {
+        for (const auto& usage : streaming->usages) {
+            if (streaming->dumps.find(usage) == streaming->dumps.end()) {
+                disk_cache.SaveDump(usage, precompiled_programs.at(usage)->program->handle);
+            }
+        }
+        disk_cache.SavePrecompiledEntries();
+    }
+
+    LOG_INFO(Render_OpenGL, "Finished streaming {} shaders of the disk cache",
+             streaming->usages.size());
+    // Rejected programs are released here, deleting them touches the GPU thread's OpenGLState
+    streaming.reset();
+}
+
+void ShaderCacheOpenGL::StreamingWorker(Core::Frontend::GraphicsContext* context) {
+    context->MakeCurrent();
+    SCOPE_EXIT({ return context->DoneCurrent(); });
+
+    ShaderStreaming& state = *streaming;
+    while (!state.stop) {
+        const std::size_t index = state.next_usage++;
+        if (index >= state.usages.size()) {
+            return;
+        }
+        const auto& usage{state.usages[index]};
+        const auto& unspecialized{state.unspecialized.at(usage.unique_identifier)};
+
+        CachedProgram program;
+        if (const auto dump{state.dumps.find(usage)}; dump != state.dumps.end()) {
+            std::vector<CachedProgram> rejected;
+            program = GeneratePrecompiledProgram(dump->second, state.supported_formats, &rejected);
+            if (!program) {
+                state.dump_rejected = true;
+                std::scoped_lock lock{state.mutex};
+                std::move(rejected.begin(), rejected.end(),
+                          std::back_inserter(state.rejected_programs));
+            }
+        }
+        if (!program) {
+            program = SpecializeShader(unspecialized.code, unspecialized.entries,
+                                       unspecialized.program_type, usage.bindings,
+                                       usage.primitive, true);
+        }
+        // Make sure the program is fully linked before other contexts look at it
+        glFinish();
+
+        QueuedProgram& queued{*precompiled_programs.at(usage)};
+        queued.program = std::move(program);
+        queued.is_built = true;
+        ++state.num_finished;
+    }
+}
+
 std::unordered_map<u64, UnspecializedShader> ShaderCacheOpenGL::GenerateUnspecializedShaders(
     const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback,
     const std::vector<ShaderDiskCacheRaw>& raws,
@@ -502,55 +986,97 @@ std::unordered_map<u64, UnspecializedShader> ShaderCacheOpenGL::GenerateUnspecia
         callback(VideoCore::LoadCallbackStage::Decompile, 0, raws.size());
     }
 
-    for (std::size_t i = 0; i < raws.size(); ++i) {
-        if (stop_loading) {
-            return {};
-        }
-        const auto& raw{raws[i]};
-        const u64 unique_identifier{raw.GetUniqueIdentifier()};
-        const u64 calculated_hash{
-            GetUniqueIdentifier(raw.GetProgramType(), raw.GetProgramCode(), raw.GetProgramCodeB())};
-        if (unique_identifier != calculated_hash) {
-            LOG_ERROR(
-                Render_OpenGL,
-                "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing shader cache",
-                raw.GetUniqueIdentifier(), calculated_hash);
-            disk_cache.InvalidateTransferable();
-            return {};
-        }
+    std::mutex mutex;
+    std::size_t decompiled_shaders = 0; // It doesn't have be atomic since it's used behind a mutex
+    std::atomic_bool invalid_hash = false;
 
-        GLShader::ProgramResult result;
-        if (const auto it = decompiled.find(unique_identifier); it != decompiled.end()) {
-            // If it's stored in the precompiled file, avoid decompiling it here
-            const auto& stored_decompiled{it->second};
-            result = {stored_decompiled.code, stored_decompiled.entries};
-        } else {
-            // Otherwise decompile the shader at boot and save the result to the decompiled file
-            result = CreateProgram(device, raw.GetProgramType(), raw.GetProgramCode(),
-                                   raw.GetProgramCodeB());
-            disk_cache.SaveDecompiled(unique_identifier, result.first, result.second);
-        }
+    // Decompiling doesn't need a context, workers only lock to store their results
+    const auto Worker = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (stop_loading || invalid_hash) {
+                return;
+            }
+            const auto& raw{raws[i]};
+            const u64 unique_identifier{raw.GetUniqueIdentifier()};
+            const u64 calculated_hash{GetUniqueIdentifier(
+                raw.GetProgramType(), raw.GetProgramCode(), raw.GetProgramCodeB())};
+            if (unique_identifier != calculated_hash) {
+                LOG_ERROR(
+                    Render_OpenGL,
+                    "Invalid hash in entry={:016x} (obtained hash={:016x}) - removing shader cache",
+                    raw.GetUniqueIdentifier(), calculated_hash);
+                invalid_hash = true;
+                return;
+            }
 
-        precompiled_shaders.insert({unique_identifier, result});
+            GLShader::ProgramResult result;
+            bool is_stored = false;
+            if (const auto it = decompiled.find(unique_identifier); it != decompiled.end()) {
+                // If it's stored in the precompiled file, avoid decompiling it here
+                const auto& stored_decompiled{it->second};
+                result = {stored_decompiled.code, stored_decompiled.entries};
+                is_stored = true;
+            } else {
+                // Otherwise decompile the shader at boot and save the result to the decompiled
+                // file
+                result = CreateProgram(device, raw.GetProgramType(), raw.GetProgramCode(),
+                                       raw.GetProgramCodeB());
+            }
+
+            std::scoped_lock lock(mutex);
+            if (!is_stored) {
+                disk_cache.SaveDecompiled(unique_identifier, result.first, result.second);
+            }
+
+            decoded_shaders.insert({{GetCodeHash(raw.GetProgramType(), raw.GetProgramCode(),
+                                                 raw.GetProgramCodeB(), unique_identifier),
+                                     raw.GetProgramType()},
+                                    result});
 
-        unspecialized.insert(
-            {raw.GetUniqueIdentifier(),
-             {std::move(result.first), std::move(result.second), raw.GetProgramType()}});
+            unspecialized.insert(
+                {unique_identifier,
+                 {std::move(result.first), std::move(result.second), raw.GetProgramType()}});
 
-        if (callback) {
-            callback(VideoCore::LoadCallbackStage::Decompile, i, raws.size());
+            if (callback) {
+                callback(VideoCore::LoadCallbackStage::Decompile, ++decompiled_shaders,
+                         raws.size());
+            }
         }
+    };
+
+    const std::size_t num_workers{GetNumLoadWorkers()};
+    const std::size_t bucket_size{raws.size() / num_workers};
+    std::vector<std::thread> threads(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        const bool is_last_worker = i + 1 == num_workers;
+        const std::size_t start{bucket_size * i};
+        const std::size_t end{is_last_worker ? raws.size() : start + bucket_size};
+        threads[i] = std::thread(Worker, start, end);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (invalid_hash) {
+        disk_cache.InvalidateTransferable();
+        return {};
+    }
+    if (stop_loading) {
+        return {};
     }
     return unspecialized;
 }
 
 Shader ShaderCacheOpenGL::GetStageProgram(Maxwell::ShaderProgram program) {
-    if (!Core::System::GetInstance().GPU().Maxwell3D().dirty_flags.shaders) {
+    if (!system.GPU().Maxwell3D().dirty_flags.shaders) {
         return last_shaders[static_cast<u32>(program)];
     }
+    if (streaming) {
+        TryFinishStreaming();
+    }
 
-    auto& memory_manager{Core::System::GetInstance().GPU().MemoryManager()};
-    const GPUVAddr program_addr{GetShaderAddress(program)};
+    auto& memory_manager{system.GPU().MemoryManager()};
+    const GPUVAddr program_addr{GetShaderAddress(system, program)};
 
     // Look up shader in the cache based on address
     const auto& host_ptr{memory_manager.GetPointer(program_addr)};
@@ -561,26 +1087,79 @@ Shader ShaderCacheOpenGL::GetStageProgram(Maxwell::ShaderProgram program) {
         ProgramCode program_code{GetShaderCode(memory_manager, program_addr, host_ptr)};
         ProgramCode program_code_b;
         if (program == Maxwell::ShaderProgram::VertexA) {
-            const GPUVAddr program_addr_b{GetShaderAddress(Maxwell::ShaderProgram::VertexB)};
+            const GPUVAddr program_addr_b{
+                GetShaderAddress(system, Maxwell::ShaderProgram::VertexB)};
             program_code_b = GetShaderCode(memory_manager, program_addr_b,
                                            memory_manager.GetPointer(program_addr_b));
         }
         const u64 unique_identifier = GetUniqueIdentifier(program, program_code, program_code_b);
         const VAddr cpu_addr{*memory_manager.GpuToCpuAddress(program_addr)};
-        const auto found = precompiled_shaders.find(unique_identifier);
-        if (found != precompiled_shaders.end()) {
-            shader =
-                std::make_shared<CachedShader>(cpu_addr, unique_identifier, program, disk_cache,
-                                               precompiled_programs, found->second, host_ptr);
+
+        // Games copy the same program to several addresses, only decompile it the first time
+        const ShaderDecodeKey key{
+            GetCodeHash(program, program_code, program_code_b, unique_identifier), program};
+        const auto [entry, is_cache_miss] = decoded_shaders.try_emplace(key);
+        GLShader::ProgramResult& result = entry->second;
+        if (is_cache_miss) {
+            TRACE_SCOPE(OpenGL_ShaderDecompile);
+            const auto start = ShaderStatistics::Clock::now();
+            result = CreateProgram(device, program, program_code, program_code_b);
+            statistics.RecordDecompile(unique_identifier, GetStageName(program),
+                                       ShaderStatistics::Clock::now() - start);
+            // TODO(Rodrigo): Unimplemented shader stages decompile to an empty program, avoid
+            // storing them
+            if (!result.first.empty()) {
+                const std::size_t code_size{CalculateProgramSize(program_code)};
+                const std::size_t code_size_b{
+                    program_code_b.empty() ? 0 : CalculateProgramSize(program_code_b)};
+                disk_cache.SaveRaw(ShaderDiskCacheRaw(
+                    unique_identifier, program, static_cast<u32>(code_size / sizeof(u64)),
+                    static_cast<u32>(code_size_b / sizeof(u64)), std::move(program_code),
+                    std::move(program_code_b)));
+            }
         } else {
-            shader = std::make_shared<CachedShader>(
-                device, cpu_addr, unique_identifier, program, disk_cache, precompiled_programs,
-                std::move(program_code), std::move(program_code_b), host_ptr);
+            statistics.RecordUse(unique_identifier, GetStageName(program));
         }
+        shader = std::make_shared<CachedShader>(cpu_addr, unique_identifier, program, disk_cache,
+                                                precompiled_programs, compiler_pool.get(),
+                                                statistics, result, host_ptr);
         Register(shader);
     }
 
     return last_shaders[static_cast<u32>(program)] = shader;
 }
 
+Shader ShaderCacheOpenGL::GetComputeKernel(GPUVAddr code_addr) {
+    auto& memory_manager{system.GPU().MemoryManager()};
+
+    // Look up the kernel in the cache based on address, it is shared with the graphics programs
+    const auto& host_ptr{memory_manager.GetPointer(code_addr)};
+    if (Shader kernel{TryGet(host_ptr)}; kernel) {
+        ASSERT_MSG(kernel->IsKernel(), "Graphics program used as a compute kernel");
+        return kernel;
+    }
+
+    ProgramCode code{GetShaderCode(memory_manager, code_addr, host_ptr)};
+    const std::size_t code_size{CalculateProgramSize(code, KERNEL_MAIN_OFFSET)};
+    const u64 unique_identifier =
+        Common::CityHash64(reinterpret_cast<const char*>(code.data()), code_size);
+    const VAddr cpu_addr{*memory_manager.GpuToCpuAddress(code_addr)};
+
+    GLShader::ProgramResult result;
+    {
+        TRACE_SCOPE(OpenGL_ShaderDecompile);
+        const auto start = ShaderStatistics::Clock::now();
+        GLShader::ShaderSetup setup(std::move(code));
+        setup.program.unique_identifier = unique_identifier;
+        result = GLShader::GenerateComputeShader(device, setup);
+        statistics.RecordDecompile(unique_identifier, "Compute",
+                                   ShaderStatistics::Clock::now() - start);
+    }
+    Shader kernel = std::make_shared<CachedShader>(cpu_addr, unique_identifier, disk_cache,
+                                                   precompiled_programs, statistics,
+                                                   std::move(result), host_ptr);
+    Register(kernel);
+    return kernel;
+}
+
 } // namespace OpenGL
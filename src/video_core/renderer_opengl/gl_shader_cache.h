@@ -6,7 +6,9 @@
 
 #include <array>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -15,10 +17,12 @@
 #include <glad/glad.h>
 
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+#include "video_core/renderer_opengl/gl_shader_stats.h"
 
 namespace Core {
 class System;
@@ -26,33 +30,102 @@ class System;
 
 namespace Core::Frontend {
 class EmuWindow;
-}
+class GraphicsContext;
+} // namespace Core::Frontend
 
 namespace OpenGL {
 
 class CachedShader;
 class Device;
 class RasterizerOpenGL;
+class ShaderCompilerPool;
+struct QueuedProgram;
+struct ShaderStreaming;
 struct UnspecializedShader;
 
 using Shader = std::shared_ptr<CachedShader>;
 using CachedProgram = std::shared_ptr<OGLProgram>;
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
-using PrecompiledPrograms = std::unordered_map<ShaderDiskCacheUsage, CachedProgram>;
-using PrecompiledShaders = std::unordered_map<u64, GLShader::ProgramResult>;
+/// Programs of the disk cache. The ones not needed on boot are still being built in the background
+/// while they are not flagged as built.
+using PrecompiledPrograms =
+    std::unordered_map<ShaderDiskCacheUsage, std::shared_ptr<QueuedProgram>>;
+
+/// Identifies the decompiled program of a stage by the contents of its code. The same program in
+/// two stages is decompiled differently, so the stage is part of the key.
+struct ShaderDecodeKey {
+    u128 code_hash{};
+    Maxwell::ShaderProgram program_type{};
+
+    bool operator==(const ShaderDecodeKey& rhs) const {
+        return std::tie(code_hash, program_type) == std::tie(rhs.code_hash, rhs.program_type);
+    }
+
+    bool operator!=(const ShaderDecodeKey& rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+} // namespace OpenGL
+
+namespace std {
+
+template <>
+struct hash<OpenGL::ShaderDecodeKey> {
+    std::size_t operator()(const OpenGL::ShaderDecodeKey& k) const noexcept {
+        return static_cast<std::size_t>(k.code_hash[0] ^ k.code_hash[1]) ^
+               static_cast<std::size_t>(k.program_type);
+    }
+};
+
+} // namespace std
+
+namespace OpenGL {
+
+using DecodedShaders = std::unordered_map<ShaderDecodeKey, GLShader::ProgramResult>;
+
+/// Launch state a compute kernel is specialized with
+struct KernelConfig {
+    std::array<u32, 3> local_size;
+    u32 local_memory_size;
+    u32 shared_memory_size;
+
+    bool operator<(const KernelConfig& rhs) const {
+        return std::tie(local_size, local_memory_size, shared_memory_size) <
+               std::tie(rhs.local_size, rhs.local_memory_size, rhs.shared_memory_size);
+    }
+};
+
+/// Transform feedback state the last vertex processing stage is specialized with
+struct TransformFeedbackConfig {
+    /// Stride in bytes of the vertices captured to each buffer, zero for disabled buffers
+    std::array<u32, Maxwell::NumTransformFeedbackBuffers> strides{};
+    std::array<u32, Maxwell::NumTransformFeedbackBuffers> varying_counts{};
+    std::array<std::array<u8, Maxwell::MaxTransformFeedbackVaryings>,
+               Maxwell::NumTransformFeedbackBuffers>
+        varying_locs{};
+
+    bool operator<(const TransformFeedbackConfig& rhs) const {
+        return std::tie(strides, varying_counts, varying_locs) <
+               std::tie(rhs.strides, rhs.varying_counts, rhs.varying_locs);
+    }
+};
 
 class CachedShader final : public RasterizerCacheObject {
 public:
-    explicit CachedShader(const Device& device, VAddr cpu_addr, u64 unique_identifier,
-                          Maxwell::ShaderProgram program_type, ShaderDiskCacheOpenGL& disk_cache,
-                          const PrecompiledPrograms& precompiled_programs,
-                          ProgramCode&& program_code, ProgramCode&& program_code_b, u8* host_ptr);
-
     explicit CachedShader(VAddr cpu_addr, u64 unique_identifier,
                           Maxwell::ShaderProgram program_type, ShaderDiskCacheOpenGL& disk_cache,
                           const PrecompiledPrograms& precompiled_programs,
+                          ShaderCompilerPool* compiler_pool, ShaderStatistics& statistics,
                           GLShader::ProgramResult result, u8* host_ptr);
 
+    /// Creates a compute kernel. Kernels depend on the launch state, so they are not stored in the
+    /// disk cache.
+    explicit CachedShader(VAddr cpu_addr, u64 unique_identifier, ShaderDiskCacheOpenGL& disk_cache,
+                          const PrecompiledPrograms& precompiled_programs,
+                          ShaderStatistics& statistics, GLShader::ProgramResult result,
+                          u8* host_ptr);
+
     VAddr GetCpuAddr() const override {
         return cpu_addr;
     }
@@ -66,10 +139,24 @@ public:
         return entries;
     }
 
-    /// Gets the GL program handle for the shader
+    /// Gets the GL program handle for the shader. When shaders are built asynchronously, the
+    /// handle is zero until a program for it is ready to be used.
     std::tuple<GLuint, BaseBindings> GetProgramHandle(GLenum primitive_mode,
                                                       BaseBindings base_bindings);
 
+    /// Gets the GL program handle for the shader writing its outputs to the transform feedback
+    /// buffers. These variants are built on first use and are not stored in the disk cache.
+    std::tuple<GLuint, BaseBindings> GetTransformFeedbackHandle(
+        GLenum primitive_mode, BaseBindings base_bindings, const TransformFeedbackConfig& config);
+
+    /// Gets the GL program handle for a compute kernel specialized with the given launch state
+    GLuint GetKernelHandle(const KernelConfig& config);
+
+    /// Returns true if the shader is a compute kernel
+    bool IsKernel() const {
+        return is_kernel;
+    }
+
 private:
     // Geometry programs. These are needed because GLSL needs an input topology but it's not
     // declared by the hardware. Workaround this issue by generating a different shader per input
@@ -82,30 +169,72 @@ private:
         CachedProgram triangles_adjacency;
     };
 
+    /// Program built with the default bindings. While the variant specialized for some bindings
+    /// is built in the background, the resources of this program are rebound to them instead.
+    struct GenericProgram {
+        std::shared_ptr<QueuedProgram> queued;
+        CachedProgram program;
+        /// Default bindings of the uniform and storage blocks, indexed by block index
+        std::vector<std::pair<GLuint, GLint>> uniform_blocks;
+        std::vector<std::pair<GLuint, GLint>> storage_blocks;
+        /// Default texture unit of the samplers, indexed by uniform location
+        std::vector<std::pair<GLint, GLint>> samplers;
+        /// Bindings the resources of the program are currently offset by
+        std::optional<BaseBindings> bindings;
+    };
+
     GLuint GetGeometryShader(GLenum primitive_mode, BaseBindings base_bindings);
 
+    /// Returns the generic program rebound to the given bindings, or zero if it isn't built yet.
+    GLuint GetGenericProgram(GLenum primitive_mode, BaseBindings base_bindings);
+
     /// Generates a geometry shader or returns one that already exists.
     GLuint LazyGeometryProgram(CachedProgram& target_program, BaseBindings base_bindings,
                                GLenum primitive_mode);
 
+    /// Returns the program of the disk cache for the given bindings if it has been built
     CachedProgram TryLoadProgram(GLenum primitive_mode, BaseBindings base_bindings) const;
 
+    /// Returns the program of the disk cache for the given bindings if it's still being built in
+    /// the background, so it can be waited on instead of building it again.
+    std::shared_ptr<QueuedProgram> TryGetStreamedProgram(GLenum primitive_mode,
+                                                         BaseBindings base_bindings) const;
+
+    /// Builds a variant on the GPU thread, recording how long it takes
+    CachedProgram BuildProgram(GLenum primitive_mode, BaseBindings base_bindings);
+
+    /// Returns the program queued for the given bindings if a worker has finished building it.
+    CachedProgram TryTakeQueuedProgram(GLenum primitive_mode, BaseBindings base_bindings);
+
     ShaderDiskCacheUsage GetUsage(GLenum primitive_mode, BaseBindings base_bindings) const;
 
+    /// Returns the bindings of the stage that follows this one
+    BaseBindings GetNextBindings(BaseBindings base_bindings) const;
+
     u8* host_ptr{};
     VAddr cpu_addr{};
     u64 unique_identifier{};
     Maxwell::ShaderProgram program_type{};
+    bool is_kernel{};
     ShaderDiskCacheOpenGL& disk_cache;
     const PrecompiledPrograms& precompiled_programs;
+    ShaderCompilerPool* compiler_pool{};
+    ShaderStatistics& statistics;
 
     std::size_t shader_length{};
     GLShader::ShaderEntries entries;
 
     std::string code;
+    Common::MemoryAccounting::Allocation code_accounting{
+        Common::MemoryAccounting::Category::ShaderCache};
 
     std::unordered_map<BaseBindings, CachedProgram> programs;
+    std::unordered_map<BaseBindings, std::shared_ptr<QueuedProgram>> pending_programs;
+    GenericProgram generic;
     std::unordered_map<BaseBindings, GeometryPrograms> geometry_programs;
+    std::map<KernelConfig, CachedProgram> kernel_programs;
+    std::map<std::tuple<GLenum, u32, u32, u32, TransformFeedbackConfig>, CachedProgram>
+        transform_feedback_programs;
 
     std::unordered_map<u32, GLuint> cbuf_resource_cache;
     std::unordered_map<u32, GLuint> gmem_resource_cache;
@@ -116,6 +245,7 @@ class ShaderCacheOpenGL final : public RasterizerCache<Shader> {
 public:
     explicit ShaderCacheOpenGL(RasterizerOpenGL& rasterizer, Core::System& system,
                                Core::Frontend::EmuWindow& emu_window, const Device& device);
+    ~ShaderCacheOpenGL();
 
     /// Loads disk cache for the current game
     void LoadDiskCache(const std::atomic_bool& stop_loading,
@@ -124,6 +254,9 @@ public:
     /// Gets the current specified shader stage program
     Shader GetStageProgram(Maxwell::ShaderProgram program);
 
+    /// Gets the compute kernel at the specified GPU address
+    Shader GetComputeKernel(GPUVAddr code_addr);
+
 protected:
     // We do not have to flush this cache as things in it are never modified by us.
     void FlushObjectInner(const Shader& object) override {}
@@ -134,16 +267,41 @@ private:
         const std::vector<ShaderDiskCacheRaw>& raws,
         const std::unordered_map<u64, ShaderDiskCacheDecompiled>& decompiled);
 
-    CachedProgram GeneratePrecompiledProgram(const ShaderDiskCacheDump& dump,
-                                             const std::set<GLenum>& supported_formats);
+    /// Loads a dumped program. Programs rejected by the driver are moved to rejected_programs
+    /// when it's given, so threads that can't touch the OpenGL state don't delete them.
+    CachedProgram GeneratePrecompiledProgram(
+        const ShaderDiskCacheDump& dump, const std::set<GLenum>& supported_formats,
+        std::vector<CachedProgram>* rejected_programs = nullptr);
 
+    /// Starts building the usages that are not needed on boot in the background, in the order
+    /// they were first used. Returns false if no shared context is available.
+    bool StartStreaming(std::vector<ShaderDiskCacheUsage> usages,
+                        std::unordered_map<u64, UnspecializedShader> unspecialized,
+                        ShaderDumpsMap dumps, std::set<GLenum> supported_formats);
+
+    /// Saves the dumps of the streamed programs once the background workers are done
+    void TryFinishStreaming();
+
+    /// Builds streamed programs on a shared context until there are none left
+    void StreamingWorker(Core::Frontend::GraphicsContext* context);
+
+    Core::System& system;
     Core::Frontend::EmuWindow& emu_window;
     const Device& device;
     ShaderDiskCacheOpenGL disk_cache;
+    ShaderStatistics statistics;
 
-    PrecompiledShaders precompiled_shaders;
+    /// Background compiler for new programs, null when shaders are built synchronously
+    std::unique_ptr<ShaderCompilerPool> compiler_pool;
+
+    /// Decompiled graphics programs. Shaders with the same code share them, no matter their
+    /// address, and the ones in the transferable cache are decompiled when it's loaded.
+    DecodedShaders decoded_shaders;
     PrecompiledPrograms precompiled_programs;
     std::array<Shader, Maxwell::MaxShaderProgram> last_shaders;
+
+    /// Background build of the disk cache, null when nothing is being streamed
+    std::unique_ptr<ShaderStreaming> streaming;
 };
 
 } // namespace OpenGL
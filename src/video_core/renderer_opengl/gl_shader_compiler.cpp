@@ -0,0 +1,91 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_shader_compiler.h"
+
+namespace OpenGL {
+
+ShaderCompilerPool::ShaderCompilerPool(Core::Frontend::EmuWindow& emu_window) {
+    // Leave half of the host threads to the emulated CPU cores and the GPU thread
+    const std::size_t num_workers{
+        std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4)};
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        // On some platforms the shared context has to be created from the GUI thread
+        auto context = emu_window.CreateSharedContext();
+        if (!context) {
+            break;
+        }
+        contexts.push_back(std::move(context));
+    }
+    if (contexts.empty()) {
+        LOG_WARNING(Render_OpenGL, "Shared contexts are not available, shaders will be built on "
+                                   "the GPU thread");
+        return;
+    }
+
+    LOG_INFO(Render_OpenGL, "Building shaders asynchronously with {} workers", contexts.size());
+    for (auto& context : contexts) {
+        workers.emplace_back(&ShaderCompilerPool::WorkerLoop, this, context.get());
+    }
+}
+
+ShaderCompilerPool::~ShaderCompilerPool() {
+    {
+        std::scoped_lock lock{mutex};
+        stop_workers = true;
+    }
+    job_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<QueuedProgram> ShaderCompilerPool::Queue(std::string source,
+                                                         GLenum shader_type) {
+    auto queued = std::make_shared<QueuedProgram>();
+    {
+        std::scoped_lock lock{mutex};
+        // This is called from the GPU thread, release the programs the workers are done with
+        built_programs.clear();
+        jobs.push_back({queued, std::move(source), shader_type});
+    }
+    job_condition.notify_one();
+    return queued;
+}
+
+void ShaderCompilerPool::WorkerLoop(Core::Frontend::GraphicsContext* context) {
+    context->MakeCurrent();
+    SCOPE_EXIT({ return context->DoneCurrent(); });
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock{mutex};
+            job_condition.wait(lock, [this] { return stop_workers || !jobs.empty(); });
+            if (stop_workers) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        {
+            OGLShader shader;
+            shader.Create(job.source.c_str(), job.shader_type);
+            job.queued->program->Create(true, false, shader.handle);
+        }
+        // Make sure the program is fully linked before other contexts look at it
+        glFinish();
+        job.queued->is_built = true;
+
+        std::scoped_lock lock{mutex};
+        built_programs.push_back(std::move(job.queued));
+    }
+}
+
+} // namespace OpenGL
@@ -0,0 +1,79 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core::Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Core::Frontend
+
+namespace OpenGL {
+
+/// Program built in the background by a ShaderCompilerPool
+struct QueuedProgram {
+    /// Program object, only valid once is_built is set
+    std::shared_ptr<OGLProgram> program = std::make_shared<OGLProgram>();
+    /// Set when the program has been linked and it's safe to use it from any context
+    std::atomic_bool is_built{false};
+};
+
+/**
+ * Pool of worker threads that compile and link GLSL programs on contexts shared with the emu
+ * window, so compiling new shaders doesn't stall the GPU thread.
+ */
+class ShaderCompilerPool final {
+public:
+    explicit ShaderCompilerPool(Core::Frontend::EmuWindow& emu_window);
+    ~ShaderCompilerPool();
+
+    /// Returns true if the frontend provided shared contexts and the pool has workers running
+    bool IsAvailable() const {
+        return !workers.empty();
+    }
+
+    /**
+     * Queues a separable program to be built from the given source.
+     * @param source GLSL source of the single stage of the program
+     * @param shader_type Type of the shader stage (e.g. GL_VERTEX_SHADER)
+     * @returns Program that will be flagged as built once a worker has linked it
+     */
+    std::shared_ptr<QueuedProgram> Queue(std::string source, GLenum shader_type);
+
+private:
+    struct Job {
+        std::shared_ptr<QueuedProgram> queued;
+        std::string source;
+        GLenum shader_type{};
+    };
+
+    void WorkerLoop(Core::Frontend::GraphicsContext* context);
+
+    std::vector<std::unique_ptr<Core::Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable job_condition;
+    std::deque<Job> jobs;
+    bool stop_workers = false;
+
+    /// Programs built by the workers. These are kept alive until the GPU thread releases them, as
+    /// deleting a program touches the GPU thread's OpenGLState.
+    std::vector<std::shared_ptr<QueuedProgram>> built_programs;
+};
+
+} // namespace OpenGL
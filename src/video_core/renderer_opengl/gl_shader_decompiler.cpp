@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <iterator>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -34,7 +36,6 @@ using Tegra::Shader::Register;
 using namespace VideoCommon::Shader;
 
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
-using ShaderStage = Tegra::Engines::Maxwell3D::Regs::ShaderStage;
 using Operation = const OperationNode&;
 
 enum class Type { Bool, Bool2, Float, Int, Uint, HalfFloat };
@@ -49,6 +50,12 @@ constexpr u32 MAX_CONSTBUFFER_ELEMENTS =
 
 class ShaderWriter {
 public:
+    ShaderWriter() {
+        // Programs generated by the same thread tend to have similar sizes, start from the
+        // largest one seen so far instead of growing the buffer from scratch
+        shader_source.reserve(reserved_size);
+    }
+
     void AddExpression(std::string_view text) {
         DEBUG_ASSERT(scope >= 0);
         if (!text.empty()) {
@@ -57,14 +64,18 @@ public:
         shader_source += text;
     }
 
-    // Forwards all arguments directly to libfmt.
+    // Forwards all arguments directly to libfmt, formatting them in place.
     // Note that all formatting requirements for fmt must be
     // obeyed when using this function. (e.g. {{ must be used
     // printing the character '{' is desirable. Ditto for }} and '}',
     // etc).
     template <typename... Args>
     void AddLine(std::string_view text, Args&&... args) {
-        AddExpression(fmt::format(text, std::forward<Args>(args)...));
+        DEBUG_ASSERT(scope >= 0);
+        if (!text.empty()) {
+            AppendIndentation();
+        }
+        fmt::format_to(std::back_inserter(shader_source), text, std::forward<Args>(args)...);
         AddNewLine();
     }
 
@@ -78,12 +89,16 @@ public:
     }
 
     std::string GetResult() {
+        reserved_size = std::max(reserved_size, shader_source.size());
         return std::move(shader_source);
     }
 
     s32 scope = 0;
 
 private:
+    /// Capacity reserved for the programs generated by the current thread
+    static inline thread_local std::size_t reserved_size = 0x4000;
+
     void AppendIndentation() {
         shader_source.append(static_cast<std::size_t>(scope) * 4, ' ');
     }
@@ -146,7 +161,7 @@ u32 GetGenericAttributeIndex(Attribute::Index index) {
 
 class GLSLDecompiler final {
 public:
-    explicit GLSLDecompiler(const Device& device, const ShaderIR& ir, ShaderStage stage,
+    explicit GLSLDecompiler(const Device& device, const ShaderIR& ir, ProgramType stage,
                             std::string suffix)
         : device{device}, ir{ir}, stage{stage}, suffix{suffix}, header{ir.GetHeader()} {}
 
@@ -156,6 +171,7 @@ public:
         DeclareRegisters();
         DeclarePredicates();
         DeclareLocalMemory();
+        DeclareSharedMemory();
         DeclareInternalFlags();
         DeclareInputAttributes();
         DeclareOutputAttributes();
@@ -167,6 +183,13 @@ public:
         code.AddLine("void execute_{}() {{", suffix);
         ++code.scope;
 
+        if (ir.IsFlowStructured()) {
+            VisitStructuredBlock(ir.GetStructuredProgram());
+            --code.scope;
+            code.AddLine("}}");
+            return;
+        }
+
         // VM's program counter
         const auto first_address = ir.GetBasicBlocks().begin()->first;
         code.AddLine("uint jmp_to = {}u;", first_address);
@@ -231,14 +254,14 @@ private:
         std::array<OperationDecompilerFn, static_cast<std::size_t>(OperationCode::Amount)>;
 
     void DeclareVertex() {
-        if (stage != ShaderStage::Vertex)
+        if (stage != ProgramType::Vertex)
             return;
 
         DeclareVertexRedeclarations();
     }
 
     void DeclareGeometry() {
-        if (stage != ShaderStage::Geometry) {
+        if (stage != ProgramType::Geometry) {
             return;
         }
 
@@ -294,6 +317,15 @@ private:
     }
 
     void DeclareLocalMemory() {
+        if (stage == ProgramType::Compute) {
+            // Kernels have no header, their local memory size is given by the launch and defined
+            // when the program is specialized
+            if (ir.UsesLocalMemory()) {
+                code.AddLine("float {}[LOCAL_MEMORY_ELEMENTS];", GetLocalMemory());
+                code.AddNewLine();
+            }
+            return;
+        }
         if (const u64 local_memory_size = header.GetLocalMemorySize(); local_memory_size > 0) {
             const auto element_count = Common::AlignUp(local_memory_size, 4) / 4;
             code.AddLine("float {}[{}];", GetLocalMemory(), element_count);
@@ -301,6 +333,16 @@ private:
         }
     }
 
+    void DeclareSharedMemory() {
+        if (!ir.UsesSharedMemory()) {
+            return;
+        }
+        ASSERT(stage == ProgramType::Compute);
+        // Its size is given by the launch, like the local memory of kernels
+        code.AddLine("shared float {}[SHARED_MEMORY_ELEMENTS];", GetSharedMemory());
+        code.AddNewLine();
+    }
+
     void DeclareInternalFlags() {
         for (u32 flag = 0; flag < static_cast<u32>(InternalFlag::Amount); flag++) {
             const auto flag_code = static_cast<InternalFlag>(flag);
@@ -352,12 +394,12 @@ private:
         const u32 generic_index{GetGenericAttributeIndex(index)};
 
         std::string name{GetInputAttribute(index)};
-        if (stage == ShaderStage::Geometry) {
+        if (stage == ProgramType::Geometry) {
             name = "gs_" + name + "[]";
         }
 
         std::string suffix;
-        if (stage == ShaderStage::Fragment) {
+        if (stage == ProgramType::Fragment) {
             const auto input_mode{header.ps.GetAttributeUse(generic_index)};
             if (skip_unused && input_mode == AttributeUse::Unused) {
                 return;
@@ -366,7 +408,7 @@ private:
         }
 
         u32 location = generic_index;
-        if (stage != ShaderStage::Vertex) {
+        if (stage != ProgramType::Vertex) {
             // If inputs are varyings, add an offset
             location += GENERIC_VARYING_START_LOCATION;
         }
@@ -375,7 +417,7 @@ private:
     }
 
     void DeclareOutputAttributes() {
-        if (ir.HasPhysicalAttributes() && stage != ShaderStage::Fragment) {
+        if (ir.HasPhysicalAttributes() && stage != ProgramType::Fragment) {
             for (u32 i = 0; i < GetNumPhysicalVaryings(); ++i) {
                 DeclareOutputAttribute(ToGenericAttribute(i));
             }
@@ -395,8 +437,11 @@ private:
     }
 
     void DeclareOutputAttribute(Attribute::Index index) {
-        const u32 location{GetGenericAttributeIndex(index) + GENERIC_VARYING_START_LOCATION};
+        const u32 generic_index{GetGenericAttributeIndex(index)};
+        const u32 location{generic_index + GENERIC_VARYING_START_LOCATION};
         code.AddLine("layout (location = {}) out vec4 {};", location, GetOutputAttribute(index));
+        // Lets transform feedback find the outputs the program declares
+        code.AddLine("#define OUTPUT_ATTRIBUTE_{} {}", generic_index, GetOutputAttribute(index));
     }
 
     void DeclareConstantBuffers() {
@@ -456,8 +501,10 @@ private:
                 sampler_type += "Shadow";
             }
 
-            code.AddLine("layout (binding = SAMPLER_BINDING_{}) uniform {} {};", sampler.GetIndex(),
-                         sampler_type, GetSampler(sampler));
+            const std::string array_size =
+                sampler.IsIndexed() ? fmt::format("[{}]", sampler.GetSize()) : "";
+            code.AddLine("layout (binding = SAMPLER_BINDING_{}) uniform {} {}{};",
+                         sampler.GetIndex(), sampler_type, GetSampler(sampler), array_size);
         }
         if (!samplers.empty()) {
             code.AddNewLine();
@@ -482,7 +529,7 @@ private:
                 constexpr u32 element_stride{4};
                 const u32 address{generic_base + index * generic_stride + element * element_stride};
 
-                const bool declared{stage != ShaderStage::Fragment ||
+                const bool declared{stage != ProgramType::Fragment ||
                                     header.ps.GetAttributeUse(index) != AttributeUse::Unused};
                 const std::string value{declared ? ReadAttribute(attribute, element) : "0"};
                 code.AddLine("case 0x{:x}: return {};", address, value);
@@ -500,7 +547,53 @@ private:
     void VisitBlock(const NodeBlock& bb) {
         for (const Node node : bb) {
             if (const std::string expr = Visit(node); !expr.empty()) {
-                code.AddLine(expr);
+                // Expressions are not format strings, append them as they are
+                code.AddExpression(expr);
+                code.AddNewLine();
+            }
+        }
+    }
+
+    void VisitStructuredBlock(const StructuredBlock& block) {
+        const auto visit_scope = [&](const StructuredBlock& scope) {
+            ++code.scope;
+            VisitStructuredBlock(scope);
+            --code.scope;
+        };
+        const auto visit_jump = [&](const StructuredNode& node, std::string_view statement) {
+            if (node.condition) {
+                code.AddLine("if ({}) {}", Visit(node.condition), statement);
+            } else {
+                code.AddExpression(statement);
+                code.AddNewLine();
+            }
+        };
+
+        for (const StructuredNode& node : block) {
+            switch (node.type) {
+            case StructuredNode::Type::Code:
+                VisitBlock(node.code);
+                break;
+            case StructuredNode::Type::If:
+                code.AddLine("if ({}) {{", Visit(node.condition));
+                visit_scope(node.then_block);
+                if (!node.else_block.empty()) {
+                    code.AddLine("}} else {{");
+                    visit_scope(node.else_block);
+                }
+                code.AddLine("}}");
+                break;
+            case StructuredNode::Type::Loop:
+                code.AddLine("while (true) {{");
+                visit_scope(node.then_block);
+                code.AddLine("}}");
+                break;
+            case StructuredNode::Type::Break:
+                visit_jump(node, "break;");
+                break;
+            case StructuredNode::Type::Continue:
+                visit_jump(node, "continue;");
+                break;
             }
         }
     }
@@ -555,7 +648,7 @@ private:
         }
 
         if (const auto abuf = std::get_if<AbufNode>(node)) {
-            UNIMPLEMENTED_IF_MSG(abuf->IsPhysicalBuffer() && stage == ShaderStage::Geometry,
+            UNIMPLEMENTED_IF_MSG(abuf->IsPhysicalBuffer() && stage == ProgramType::Geometry,
                                  "Physical attributes in geometry shaders are not implemented");
             if (abuf->IsPhysicalBuffer()) {
                 return fmt::format("readPhysicalAttribute(ftou({}))",
@@ -596,6 +689,10 @@ private:
             return fmt::format("{}[ftou({}) / 4]", GetLocalMemory(), Visit(lmem->GetAddress()));
         }
 
+        if (const auto smem = std::get_if<SmemNode>(node)) {
+            return fmt::format("{}[ftou({}) / 4]", GetSharedMemory(), Visit(smem->GetAddress()));
+        }
+
         if (const auto internal_flag = std::get_if<InternalFlagNode>(node)) {
             return GetInternalFlag(internal_flag->GetFlag());
         }
@@ -622,7 +719,7 @@ private:
 
     std::string ReadAttribute(Attribute::Index attribute, u32 element, Node buffer = {}) {
         const auto GeometryPass = [&](std::string_view name) {
-            if (stage == ShaderStage::Geometry && buffer) {
+            if (stage == ProgramType::Geometry && buffer) {
                 // TODO(Rodrigo): Guard geometry inputs against out of bound reads. Some games
                 // set an 0x80000000 index for those and the shader fails to build. Find out why
                 // this happens and what's its intent.
@@ -633,7 +730,7 @@ private:
 
         switch (attribute) {
         case Attribute::Index::Position:
-            if (stage != ShaderStage::Fragment) {
+            if (stage != ProgramType::Fragment) {
                 return GeometryPass("position") + GetSwizzle(element);
             } else {
                 return element == 3 ? "1.0f" : "gl_FragCoord" + GetSwizzle(element);
@@ -654,11 +751,12 @@ private:
             // TODO(Subv): Find out what the values are for the first two elements when inside a
             // vertex shader, and what's the value of the fourth element when inside a Tess Eval
             // shader.
-            ASSERT(stage == ShaderStage::Vertex);
+            ASSERT(stage == ProgramType::Vertex);
             switch (element) {
             case 2:
-                // Config pack's first value is instance_id.
-                return "uintBitsToFloat(config_pack[0])";
+                // Config pack's first value is the first instance of the draw, instances merged
+                // into the draw by the 3D engine are counted by gl_InstanceID.
+                return "uintBitsToFloat(config_pack[0] + uint(gl_InstanceID))";
             case 3:
                 return "uintBitsToFloat(gl_VertexID)";
             }
@@ -666,7 +764,7 @@ private:
             return "0";
         case Attribute::Index::FrontFacing:
             // TODO(Subv): Find out what the values are for the other elements.
-            ASSERT(stage == ShaderStage::Fragment);
+            ASSERT(stage == ProgramType::Fragment);
             switch (element) {
             case 3:
                 return "itof(gl_FrontFacing ? -1 : 0)";
@@ -688,7 +786,7 @@ private:
             return value;
         }
         // There's a bug in NVidia's proprietary drivers that makes precise fail on fragment shaders
-        const std::string precise = stage != ShaderStage::Fragment ? "precise " : "";
+        const std::string precise = stage != ProgramType::Fragment ? "precise " : "";
 
         const std::string temporary = code.GenerateTemporary();
         code.AddLine("{}float {} = {};", precise, temporary, value);
@@ -812,7 +910,7 @@ private:
         if (!meta->aoffi.empty()) {
             expr += "Offset";
         }
-        expr += '(' + GetSampler(meta->sampler) + ", ";
+        expr += '(' + GetSampler(*meta) + ", ";
         expr += coord_constructors.at(count + (has_array ? 1 : 0) + (has_shadow ? 1 : 0) - 1);
         expr += '(';
         for (std::size_t i = 0; i < count; ++i) {
@@ -939,6 +1037,8 @@ private:
             }();
         } else if (const auto lmem = std::get_if<LmemNode>(dest)) {
             target = fmt::format("{}[ftou({}) / 4]", GetLocalMemory(), Visit(lmem->GetAddress()));
+        } else if (const auto smem = std::get_if<SmemNode>(dest)) {
+            target = fmt::format("{}[ftou({}) / 4]", GetSharedMemory(), Visit(smem->GetAddress()));
         } else if (const auto gmem = std::get_if<GmemNode>(dest)) {
             const std::string real = Visit(gmem->GetRealAddress());
             const std::string base = Visit(gmem->GetBaseAddress());
@@ -1349,7 +1449,7 @@ private:
         const auto meta = std::get_if<MetaTexture>(&operation.GetMeta());
         ASSERT(meta);
 
-        const std::string sampler = GetSampler(meta->sampler);
+        const std::string sampler = GetSampler(*meta);
         const std::string lod = VisitOperand(operation, 0, Type::Int);
 
         switch (meta->element) {
@@ -1386,7 +1486,7 @@ private:
         const std::size_t count = operation.GetOperandsCount();
 
         std::string expr = "texelFetch(";
-        expr += GetSampler(meta->sampler);
+        expr += GetSampler(*meta);
         expr += ", ";
 
         expr += constructors.at(operation.GetOperandsCount() - 1);
@@ -1432,7 +1532,7 @@ private:
     }
 
     std::string Exit(Operation operation) {
-        if (stage != ShaderStage::Fragment) {
+        if (stage != ProgramType::Fragment) {
             code.AddLine("return;");
             return {};
         }
@@ -1501,9 +1601,14 @@ private:
     }
 
     std::string EmitVertex(Operation operation) {
-        ASSERT_MSG(stage == ShaderStage::Geometry,
+        ASSERT_MSG(stage == ProgramType::Geometry,
                    "EmitVertex is expected to be used in a geometry shader.");
 
+        // Transform feedback captures the vertex as the guest wrote it
+        code.AddLine("#ifdef TRANSFORM_FEEDBACK");
+        code.AddLine("write_transform_feedback();");
+        code.AddLine("#endif");
+
         // If a geometry shader is attached, it will always flip (it's the last stage before
         // fragment). For more info about flipping, refer to gl_shader_gen.cpp.
         code.AddLine("position.xy *= viewport_flip.xy;");
@@ -1514,18 +1619,41 @@ private:
     }
 
     std::string EndPrimitive(Operation operation) {
-        ASSERT_MSG(stage == ShaderStage::Geometry,
+        ASSERT_MSG(stage == ProgramType::Geometry,
                    "EndPrimitive is expected to be used in a geometry shader.");
 
         code.AddLine("EndPrimitive();");
         return {};
     }
 
+    std::string Barrier(Operation) {
+        ASSERT(stage == ProgramType::Compute);
+        code.AddLine("barrier();");
+        return {};
+    }
+
+    std::string MemoryBarrierGL(Operation) {
+        code.AddLine("memoryBarrier();");
+        return {};
+    }
+
     std::string YNegate(Operation operation) {
         // Config pack's third value is Y_NEGATE's state.
         return "uintBitsToFloat(config_pack[2])";
     }
 
+    template <u32 element>
+    std::string LocalInvocationId(Operation) {
+        ASSERT(stage == ProgramType::Compute);
+        return "utof(gl_LocalInvocationID" + GetSwizzle(element) + ')';
+    }
+
+    template <u32 element>
+    std::string WorkGroupId(Operation) {
+        ASSERT(stage == ProgramType::Compute);
+        return "utof(gl_WorkGroupID" + GetSwizzle(element) + ')';
+    }
+
     static constexpr OperationDecompilersArray operation_decompilers = {
         &GLSLDecompiler::Assign,
 
@@ -1664,7 +1792,16 @@ private:
         &GLSLDecompiler::EmitVertex,
         &GLSLDecompiler::EndPrimitive,
 
+        &GLSLDecompiler::Barrier,
+        &GLSLDecompiler::MemoryBarrierGL,
+
         &GLSLDecompiler::YNegate,
+        &GLSLDecompiler::LocalInvocationId<0>,
+        &GLSLDecompiler::LocalInvocationId<1>,
+        &GLSLDecompiler::LocalInvocationId<2>,
+        &GLSLDecompiler::WorkGroupId<0>,
+        &GLSLDecompiler::WorkGroupId<1>,
+        &GLSLDecompiler::WorkGroupId<2>,
     };
 
     std::string GetRegister(u32 index) const {
@@ -1704,6 +1841,10 @@ private:
         return "lmem_" + suffix;
     }
 
+    std::string GetSharedMemory() const {
+        return "smem_" + suffix;
+    }
+
     std::string GetInternalFlag(InternalFlag flag) const {
         constexpr std::array<const char*, 4> InternalFlagNames = {"zero_flag", "sign_flag",
                                                                   "carry_flag", "overflow_flag"};
@@ -1717,12 +1858,23 @@ private:
         return GetDeclarationWithSuffix(static_cast<u32>(sampler.GetIndex()), "sampler");
     }
 
+    /// Returns the sampler used by a texture operation, selecting the element of indexed ones
+    std::string GetSampler(const MetaTexture& meta) {
+        const std::string sampler = GetSampler(meta.sampler);
+        if (!meta.sampler.IsIndexed()) {
+            return sampler;
+        }
+        // Handles are words, clamp the index to the bound samplers
+        return fmt::format("{}[min(ftou({}) >> 2U, {}U)]", sampler, Visit(meta.index),
+                           meta.sampler.GetSize() - 1);
+    }
+
     std::string GetDeclarationWithSuffix(u32 index, const std::string& name) const {
         return fmt::format("{}_{}_{}", name, index, suffix);
     }
 
     u32 GetNumPhysicalInputAttributes() const {
-        return stage == ShaderStage::Vertex ? GetNumPhysicalAttributes() : GetNumPhysicalVaryings();
+        return stage == ProgramType::Vertex ? GetNumPhysicalAttributes() : GetNumPhysicalVaryings();
     }
 
     u32 GetNumPhysicalAttributes() const {
@@ -1736,7 +1888,7 @@ private:
 
     const Device& device;
     const ShaderIR& ir;
-    const ShaderStage stage;
+    const ProgramType stage;
     const std::string suffix;
     const Header header;
 
@@ -1767,7 +1919,7 @@ std::string GetCommonDeclarations() {
         MAX_CONSTBUFFER_ELEMENTS);
 }
 
-ProgramResult Decompile(const Device& device, const ShaderIR& ir, Maxwell::ShaderStage stage,
+ProgramResult Decompile(const Device& device, const ShaderIR& ir, ProgramType stage,
                         const std::string& suffix) {
     GLSLDecompiler decompiler(device, ir, stage, suffix);
     decompiler.Decompile();
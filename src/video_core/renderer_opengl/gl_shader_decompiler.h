@@ -25,6 +25,15 @@ namespace OpenGL::GLShader {
 struct ShaderEntries;
 
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/// Kinds of programs the decompiler generates code for
+enum class ProgramType : u32 {
+    Vertex,
+    Geometry,
+    Fragment,
+    Compute,
+};
+
 using ProgramResult = std::pair<std::string, ShaderEntries>;
 using SamplerEntry = VideoCommon::Shader::Sampler;
 
@@ -82,6 +91,6 @@ struct ShaderEntries {
 std::string GetCommonDeclarations();
 
 ProgramResult Decompile(const Device& device, const VideoCommon::Shader::ShaderIR& ir,
-                        Maxwell::ShaderStage stage, const std::string& suffix);
+                        ProgramType stage, const std::string& suffix);
 
 } // namespace OpenGL::GLShader
@@ -2,21 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <fmt/format.h>
 
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/lz4_compression.h"
 #include "common/scm_rev.h"
-#include "common/zstd_compression.h"
 
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/settings.h"
 
+#include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 
@@ -34,14 +37,46 @@ enum class PrecompiledEntryKind : u32 {
     Dump,
 };
 
-constexpr u32 NativeVersion = 1;
+// Version 1 stored usages without recording when they were first used. These files are still
+// loaded and they are upgraded to the native version when the title boots.
+constexpr u32 LegacyUsageVersion = 1;
+constexpr u32 NativeVersion = 2;
+
+// The precompiled file is a PrecompiledHeader followed by its entries, each one stored as a
+// PrecompiledEntryHeader and the LZ4 compressed entry. Entries are appended to the file as they
+// are created, so an interrupted write can only leave a truncated entry at the end of the file.
+constexpr u32 PrecompiledVersion = 4;
+
+struct PrecompiledHeader {
+    ShaderCacheVersionHash version_hash;
+    u32 version;
+};
+static_assert(sizeof(PrecompiledHeader) == 68, "PrecompiledHeader has incorrect size.");
+
+struct PrecompiledEntryHeader {
+    u32 kind;
+    u32 uncompressed_size;
+    u32 compressed_size;
+    u32 reserved;
+    // Hash of the compressed entry
+    u64 checksum;
+};
+static_assert(sizeof(PrecompiledEntryHeader) == 24, "PrecompiledEntryHeader has incorrect size.");
 
 // Making sure sizes doesn't change by accident
 static_assert(sizeof(BaseBindings) == 12);
-static_assert(sizeof(ShaderDiskCacheUsage) == 24);
+static_assert(sizeof(ShaderDiskCacheUsage) == 32);
 
 namespace {
 
+/// Usage entry of the transferable files with the legacy version
+struct LegacyShaderDiskCacheUsage {
+    u64 unique_identifier;
+    BaseBindings bindings;
+    GLenum primitive;
+};
+static_assert(sizeof(LegacyShaderDiskCacheUsage) == 24);
+
 ShaderCacheVersionHash GetShaderCacheVersionHash() {
     ShaderCacheVersionHash hash{};
     const std::size_t length = std::min(std::strlen(Common::g_shader_cache_version), hash.size());
@@ -49,6 +84,71 @@ ShaderCacheVersionHash GetShaderCacheVersionHash() {
     return hash;
 }
 
+/// Hashes a compressed entry. The checksum is stored in the file, so it must not change with the
+/// hash used by the in-memory caches.
+u64 ComputeChecksum(const std::vector<u8>& compressed) {
+    return Common::CityHash64(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+}
+
+/// Returns true if transferable files with the given version can be loaded
+bool IsLoadableVersion(u32 version) {
+    return version >= LegacyUsageVersion && version <= NativeVersion;
+}
+
+/// Reads a usage entry stored with the given version. Returns true on success.
+bool LoadUsage(FileUtil::IOFile& file, u32 version, u32 index, ShaderDiskCacheUsage& usage) {
+    if (version != LegacyUsageVersion) {
+        return file.ReadBytes(&usage, sizeof(usage)) == sizeof(usage);
+    }
+    LegacyShaderDiskCacheUsage legacy{};
+    if (file.ReadBytes(&legacy, sizeof(legacy)) != sizeof(legacy)) {
+        return false;
+    }
+    // Legacy usages were saved in the order they were first used but the frame is unknown, they
+    // are all built on boot as they used to be
+    usage = {legacy.unique_identifier, legacy.bindings, legacy.primitive, index, 0};
+    return true;
+}
+
+/// Loads the entries of a transferable file, positioned after its version. Returns true on success.
+bool LoadTransferableEntries(FileUtil::IOFile& file, u32 version,
+                             std::vector<ShaderDiskCacheRaw>& raws,
+                             std::vector<ShaderDiskCacheUsage>& usages) {
+    while (file.Tell() < file.GetSize()) {
+        TransferableEntryKind kind{};
+        if (file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
+            LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
+            return false;
+        }
+
+        switch (kind) {
+        case TransferableEntryKind::Raw: {
+            ShaderDiskCacheRaw entry;
+            if (!entry.Load(file)) {
+                LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
+                return false;
+            }
+            raws.push_back(std::move(entry));
+            break;
+        }
+        case TransferableEntryKind::Usage: {
+            ShaderDiskCacheUsage usage{};
+            if (!LoadUsage(file, version, static_cast<u32>(usages.size()), usage)) {
+                LOG_ERROR(Render_OpenGL, "Failed to load transferable usage entry - skipping");
+                return false;
+            }
+            usages.push_back(usage);
+            break;
+        }
+        default:
+            LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
+                      static_cast<u32>(kind));
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 ShaderDiskCacheRaw::ShaderDiskCacheRaw(u64 unique_identifier, Maxwell::ShaderProgram program_type,
@@ -131,7 +231,7 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
         return {};
     }
 
-    if (version < NativeVersion) {
+    if (version < LegacyUsageVersion) {
         LOG_INFO(Render_OpenGL, "Transferable shader cache is old - removing");
         file.Close();
         InvalidateTransferable();
@@ -146,36 +246,33 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
     // Version is valid, load the shaders
     std::vector<ShaderDiskCacheRaw> raws;
     std::vector<ShaderDiskCacheUsage> usages;
-    while (file.Tell() < file.GetSize()) {
-        TransferableEntryKind kind{};
-        if (file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
-            LOG_ERROR(Render_OpenGL, "Failed to read transferable file - skipping");
-            return {};
-        }
+    if (!LoadTransferableEntries(file, version, raws, usages)) {
+        return {};
+    }
+    file.Close();
 
-        switch (kind) {
-        case TransferableEntryKind::Raw: {
-            ShaderDiskCacheRaw entry;
-            if (!entry.Load(file)) {
-                LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - skipping");
-                return {};
-            }
-            transferable.insert({entry.GetUniqueIdentifier(), {}});
-            raws.push_back(std::move(entry));
-            break;
-        }
-        case TransferableEntryKind::Usage: {
-            ShaderDiskCacheUsage usage{};
-            if (file.ReadBytes(&usage, sizeof(usage)) != sizeof(usage)) {
-                LOG_ERROR(Render_OpenGL, "Failed to load transferable usage entry - skipping");
-                return {};
-            }
-            usages.push_back(std::move(usage));
-            break;
-        }
-        default:
-            LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
-                      static_cast<u32>(kind));
+    for (const auto& raw : raws) {
+        transferable.insert({raw.GetUniqueIdentifier(), {}});
+    }
+
+    // Usages are not checked for collisions when they are saved, drop the ones stored more than
+    // once and the ones of unknown shaders
+    const auto is_duplicated = [this](const ShaderDiskCacheUsage& usage) {
+        const auto it = transferable.find(usage.unique_identifier);
+        return it == transferable.end() || !it->second.insert(usage).second;
+    };
+    usages.erase(std::remove_if(usages.begin(), usages.end(), is_duplicated), usages.end());
+    num_usages = static_cast<u32>(usages.size());
+
+    // New usages are appended with the native layout, upgrade legacy files before that happens
+    if (version != NativeVersion) {
+        LOG_INFO(Render_OpenGL, "Upgrading transferable shader cache from version {} to {}",
+                 version, NativeVersion);
+        if (!RewriteTransferable(raws, usages)) {
+            LOG_ERROR(Render_OpenGL, "Failed to upgrade transferable shader cache - removing");
+            transferable.clear();
+            num_usages = 0;
+            InvalidateTransferable();
             return {};
         }
     }
@@ -188,7 +285,8 @@ ShaderDiskCacheOpenGL::LoadPrecompiled() {
     if (!IsUsable())
         return {};
 
-    FileUtil::IOFile file(GetPrecompiledPath(), "rb");
+    // Opened for writing too, to be able to discard a truncated entry at the end of the file
+    FileUtil::IOFile file(GetPrecompiledPath(), "r+b");
     if (!file.IsOpen()) {
         LOG_INFO(Render_OpenGL, "No precompiled shader cache found for game with title id={}",
                  GetTitleID());
@@ -209,33 +307,65 @@ ShaderDiskCacheOpenGL::LoadPrecompiled() {
 
 std::optional<std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>>
 ShaderDiskCacheOpenGL::LoadPrecompiledFile(FileUtil::IOFile& file) {
-    // Read compressed file from disk and decompress to virtual precompiled cache file
-    std::vector<u8> compressed(file.GetSize());
-    file.ReadBytes(compressed.data(), compressed.size());
-    const std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(compressed);
-    SaveArrayToPrecompiled(decompressed.data(), decompressed.size());
-    precompiled_cache_virtual_file_offset = 0;
-
-    ShaderCacheVersionHash file_hash{};
-    if (!LoadArrayFromPrecompiled(file_hash.data(), file_hash.size())) {
-        precompiled_cache_virtual_file_offset = 0;
+    PrecompiledHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
         return {};
     }
-    if (GetShaderCacheVersionHash() != file_hash) {
+    if (header.version_hash != GetShaderCacheVersionHash()) {
         LOG_INFO(Render_OpenGL, "Precompiled cache is from another version of the emulator");
-        precompiled_cache_virtual_file_offset = 0;
+        return {};
+    }
+    if (header.version != PrecompiledVersion) {
+        LOG_INFO(Render_OpenGL, "Precompiled cache has an old format");
         return {};
     }
 
     std::unordered_map<u64, ShaderDiskCacheDecompiled> decompiled;
     ShaderDumpsMap dumps;
-    while (precompiled_cache_virtual_file_offset < precompiled_cache_virtual_file.GetSize()) {
-        PrecompiledEntryKind kind{};
-        if (!LoadObjectFromPrecompiled(kind)) {
+
+    // Entries are decompressed one at a time, the file is never held in memory as a whole
+    const u64 file_size = file.GetSize();
+    u64 offset = sizeof(header);
+    std::vector<u8> compressed;
+    while (offset < file_size) {
+        PrecompiledEntryHeader entry_header{};
+        if (file_size - offset < sizeof(entry_header) ||
+            file.ReadBytes(&entry_header, sizeof(entry_header)) != sizeof(entry_header) ||
+            file_size - offset - sizeof(entry_header) < entry_header.compressed_size) {
+            // The last write was interrupted, keep the entries stored before it
+            LOG_WARNING(Render_OpenGL, "Discarding truncated precompiled entry at offset {}",
+                        offset);
+            file.Resize(offset);
+            break;
+        }
+
+        compressed.resize(entry_header.compressed_size);
+        if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size()) {
             return {};
         }
+        const u64 entry_end = offset + sizeof(entry_header) + entry_header.compressed_size;
+        if (ComputeChecksum(compressed) != entry_header.checksum) {
+            if (entry_end != file_size) {
+                return {};
+            }
+            // The last write was not fully flushed to disk, only that entry is lost
+            LOG_WARNING(Render_OpenGL, "Discarding corrupted precompiled entry at offset {}",
+                        offset);
+            file.Resize(offset);
+            break;
+        }
+        const Common::PooledVector uncompressed =
+            Common::Compression::DecompressDataLZ4(compressed, entry_header.uncompressed_size);
+        if (uncompressed.size() != entry_header.uncompressed_size) {
+            return {};
+        }
+        offset = entry_end;
 
-        switch (kind) {
+        entry_buffer.Resize(0);
+        entry_buffer.WriteArray(uncompressed.data(), uncompressed.size(), 0);
+        entry_buffer_offset = 0;
+
+        switch (static_cast<PrecompiledEntryKind>(entry_header.kind)) {
         case PrecompiledEntryKind::Decompiled: {
             u64 unique_identifier{};
             if (!LoadObjectFromPrecompiled(unique_identifier)) {
@@ -250,36 +380,45 @@ ShaderDiskCacheOpenGL::LoadPrecompiledFile(FileUtil::IOFile& file) {
             break;
         }
         case PrecompiledEntryKind::Dump: {
-            ShaderDiskCacheUsage usage;
-            if (!LoadObjectFromPrecompiled(usage)) {
-                return {};
-            }
-
-            ShaderDiskCacheDump dump;
-            if (!LoadObjectFromPrecompiled(dump.binary_format)) {
-                return {};
-            }
-
-            u32 binary_length{};
-            if (!LoadObjectFromPrecompiled(binary_length)) {
-                return {};
-            }
-
-            dump.binary.resize(binary_length);
-            if (!LoadArrayFromPrecompiled(dump.binary.data(), dump.binary.size())) {
+            auto entry = LoadDumpEntry();
+            if (!entry) {
                 return {};
             }
-
-            dumps.insert({usage, dump});
+            dumps.insert(std::move(*entry));
             break;
         }
         default:
             return {};
         }
     }
+    entry_buffer.Resize(0);
     return {{decompiled, dumps}};
 }
 
+std::optional<std::pair<ShaderDiskCacheUsage, ShaderDiskCacheDump>>
+ShaderDiskCacheOpenGL::LoadDumpEntry() {
+    ShaderDiskCacheUsage usage;
+    if (!LoadObjectFromPrecompiled(usage)) {
+        return {};
+    }
+
+    ShaderDiskCacheDump dump;
+    if (!LoadObjectFromPrecompiled(dump.binary_format)) {
+        return {};
+    }
+
+    u32 binary_length{};
+    if (!LoadObjectFromPrecompiled(binary_length)) {
+        return {};
+    }
+
+    dump.binary.resize(binary_length);
+    if (!LoadArrayFromPrecompiled(dump.binary.data(), dump.binary.size())) {
+        return {};
+    }
+    return {{usage, std::move(dump)}};
+}
+
 std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiledEntry() {
     u32 code_size{};
     if (!LoadObjectFromPrecompiled(code_size)) {
@@ -322,14 +461,17 @@ std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiledEn
         bool is_array{};
         bool is_shadow{};
         bool is_bindless{};
+        u64 size{};
         if (!LoadObjectFromPrecompiled(offset) || !LoadObjectFromPrecompiled(index) ||
             !LoadObjectFromPrecompiled(type) || !LoadObjectFromPrecompiled(is_array) ||
-            !LoadObjectFromPrecompiled(is_shadow) || !LoadObjectFromPrecompiled(is_bindless)) {
+            !LoadObjectFromPrecompiled(is_shadow) || !LoadObjectFromPrecompiled(is_bindless) ||
+            !LoadObjectFromPrecompiled(size)) {
             return {};
         }
         entry.entries.samplers.emplace_back(
             static_cast<std::size_t>(offset), static_cast<std::size_t>(index),
-            static_cast<Tegra::Shader::TextureType>(type), is_array, is_shadow, is_bindless);
+            static_cast<Tegra::Shader::TextureType>(type), is_array, is_shadow, is_bindless,
+            static_cast<std::size_t>(size));
     }
 
     u32 global_memory_count{};
@@ -366,10 +508,9 @@ std::optional<ShaderDiskCacheDecompiled> ShaderDiskCacheOpenGL::LoadDecompiledEn
     return entry;
 }
 
-bool ShaderDiskCacheOpenGL::SaveDecompiledFile(u64 unique_identifier, const std::string& code,
-                                               const GLShader::ShaderEntries& entries) {
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Decompiled)) ||
-        !SaveObjectToPrecompiled(unique_identifier) ||
+bool ShaderDiskCacheOpenGL::SaveDecompiledEntry(u64 unique_identifier, const std::string& code,
+                                                const GLShader::ShaderEntries& entries) {
+    if (!SaveObjectToPrecompiled(unique_identifier) ||
         !SaveObjectToPrecompiled(static_cast<u32>(code.size())) ||
         !SaveArrayToPrecompiled(code.data(), code.size())) {
         return false;
@@ -395,7 +536,8 @@ bool ShaderDiskCacheOpenGL::SaveDecompiledFile(u64 unique_identifier, const std:
             !SaveObjectToPrecompiled(static_cast<u32>(sampler.GetType())) ||
             !SaveObjectToPrecompiled(sampler.IsArray()) ||
             !SaveObjectToPrecompiled(sampler.IsShadow()) ||
-            !SaveObjectToPrecompiled(sampler.IsBindless())) {
+            !SaveObjectToPrecompiled(sampler.IsBindless()) ||
+            !SaveObjectToPrecompiled(static_cast<u64>(sampler.GetSize()))) {
             return false;
         }
     }
@@ -424,6 +566,98 @@ bool ShaderDiskCacheOpenGL::SaveDecompiledFile(u64 unique_identifier, const std:
     return true;
 }
 
+std::optional<std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
+ShaderDiskCacheOpenGL::LoadTransferableFile(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    u32 version{};
+    if (!file.IsOpen() || file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
+        LOG_ERROR(Render_OpenGL, "Failed to open transferable cache in path={}", path);
+        return {};
+    }
+    if (!IsLoadableVersion(version)) {
+        LOG_ERROR(Render_OpenGL, "Transferable cache in path={} has version {}, expected {}", path,
+                  version, NativeVersion);
+        return {};
+    }
+    std::vector<ShaderDiskCacheRaw> raws;
+    std::vector<ShaderDiskCacheUsage> usages;
+    if (!LoadTransferableEntries(file, version, raws, usages)) {
+        return {};
+    }
+    return {{std::move(raws), std::move(usages)}};
+}
+
+std::optional<std::size_t> ShaderDiskCacheOpenGL::MergeTransferable(u64 title_id,
+                                                                    const std::string& path) {
+    auto source = LoadTransferableFile(path);
+    if (!source) {
+        return {};
+    }
+    const auto& [raws, usages] = *source;
+
+    // Gather the entries the title's cache already has
+    const std::string target_path{FileUtil::SanitizePath(
+        GetTransferableDir() + DIR_SEP_CHR + fmt::format("{:016X}.bin", title_id))};
+    std::map<u64, std::unordered_set<ShaderDiskCacheUsage>> known;
+    if (FileUtil::IOFile target(target_path, "rb"); target.IsOpen() && target.GetSize() != 0) {
+        std::vector<ShaderDiskCacheRaw> target_raws;
+        std::vector<ShaderDiskCacheUsage> target_usages;
+        u32 version{};
+        if (target.ReadBytes(&version, sizeof(version)) != sizeof(version) ||
+            version != NativeVersion ||
+            !LoadTransferableEntries(target, version, target_raws, target_usages)) {
+            LOG_ERROR(Render_OpenGL, "Transferable cache in path={} can't be merged into",
+                      target_path);
+            return {};
+        }
+        for (const auto& raw : target_raws) {
+            known.insert({raw.GetUniqueIdentifier(), {}});
+        }
+        for (const auto& usage : target_usages) {
+            if (const auto it = known.find(usage.unique_identifier); it != known.end()) {
+                it->second.insert(usage);
+            }
+        }
+    }
+
+    if (!EnsureDirectories()) {
+        return {};
+    }
+    FileUtil::IOFile target(target_path, "ab");
+    if (!target.IsOpen() || (target.GetSize() == 0 && target.WriteObject(NativeVersion) != 1)) {
+        LOG_ERROR(Render_OpenGL, "Failed to open transferable cache in path={}", target_path);
+        return {};
+    }
+
+    std::size_t num_merged = 0;
+    for (const auto& raw : raws) {
+        if (!known.insert({raw.GetUniqueIdentifier(), {}}).second) {
+            continue;
+        }
+        if (target.WriteObject(TransferableEntryKind::Raw) != 1 || !raw.Save(target)) {
+            LOG_ERROR(Render_OpenGL, "Failed to merge raw transferable cache entry");
+            return {};
+        }
+        ++num_merged;
+    }
+    for (const auto& usage : usages) {
+        const auto it = known.find(usage.unique_identifier);
+        if (it == known.end() || !it->second.insert(usage).second) {
+            continue;
+        }
+        if (target.WriteObject(TransferableEntryKind::Usage) != 1 ||
+            target.WriteObject(usage) != 1) {
+            LOG_ERROR(Render_OpenGL, "Failed to merge usage transferable cache entry");
+            return {};
+        }
+        ++num_merged;
+    }
+
+    LOG_INFO(Render_OpenGL, "Merged {} transferable cache entries from {} into {}", num_merged,
+             path, target_path);
+    return num_merged;
+}
+
 void ShaderDiskCacheOpenGL::InvalidateTransferable() {
     if (!FileUtil::Delete(GetTransferablePath())) {
         LOG_ERROR(Render_OpenGL, "Failed to invalidate transferable file={}",
@@ -433,8 +667,8 @@ void ShaderDiskCacheOpenGL::InvalidateTransferable() {
 }
 
 void ShaderDiskCacheOpenGL::InvalidatePrecompiled() {
-    // Clear virtaul precompiled cache file
-    precompiled_cache_virtual_file.Resize(0);
+    // Drop the entries that were not written yet
+    pending_precompiled.clear();
 
     if (!FileUtil::Delete(GetPrecompiledPath())) {
         LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}", GetPrecompiledPath());
@@ -481,7 +715,10 @@ void ShaderDiskCacheOpenGL::SaveUsage(const ShaderDiskCacheUsage& usage) {
     if (!file.IsOpen())
         return;
 
-    if (file.WriteObject(TransferableEntryKind::Usage) != 1 || file.WriteObject(usage) != 1) {
+    ShaderDiskCacheUsage stamped{usage};
+    stamped.first_use_order = num_usages++;
+    stamped.first_use_frame = static_cast<u32>(system.Renderer().GetCurrentFrame());
+    if (file.WriteObject(TransferableEntryKind::Usage) != 1 || file.WriteObject(stamped) != 1) {
         LOG_ERROR(Render_OpenGL, "Failed to save usage transferable cache entry - removing");
         file.Close();
         InvalidateTransferable();
@@ -494,15 +731,15 @@ void ShaderDiskCacheOpenGL::SaveDecompiled(u64 unique_identifier, const std::str
     if (!IsUsable())
         return;
 
-    if (precompiled_cache_virtual_file.GetSize() == 0) {
-        SavePrecompiledHeaderToVirtualPrecompiledCache();
-    }
-
-    if (!SaveDecompiledFile(unique_identifier, code, entries)) {
+    entry_buffer.Resize(0);
+    entry_buffer_offset = 0;
+    if (!SaveDecompiledEntry(unique_identifier, code, entries)) {
         LOG_ERROR(Render_OpenGL,
                   "Failed to save decompiled entry to the precompiled file - removing");
         InvalidatePrecompiled();
+        return;
     }
+    QueuePrecompiledEntry(static_cast<u32>(PrecompiledEntryKind::Decompiled));
 }
 
 void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint program) {
@@ -516,8 +753,9 @@ void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint p
     std::vector<u8> binary(binary_length);
     glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
 
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Dump)) ||
-        !SaveObjectToPrecompiled(usage) ||
+    entry_buffer.Resize(0);
+    entry_buffer_offset = 0;
+    if (!SaveObjectToPrecompiled(usage) ||
         !SaveObjectToPrecompiled(static_cast<u32>(binary_format)) ||
         !SaveObjectToPrecompiled(static_cast<u32>(binary_length)) ||
         !SaveArrayToPrecompiled(binary.data(), binary.size())) {
@@ -526,12 +764,54 @@ void ShaderDiskCacheOpenGL::SaveDump(const ShaderDiskCacheUsage& usage, GLuint p
         InvalidatePrecompiled();
         return;
     }
+    QueuePrecompiledEntry(static_cast<u32>(PrecompiledEntryKind::Dump));
+}
+
+void ShaderDiskCacheOpenGL::QueuePrecompiledEntry(u32 kind) {
+    const std::vector<u8>& uncompressed = entry_buffer.ReadAllBytes();
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataLZ4(uncompressed.data(), uncompressed.size());
+
+    PrecompiledEntryHeader header{};
+    header.kind = kind;
+    header.uncompressed_size = static_cast<u32>(uncompressed.size());
+    header.compressed_size = static_cast<u32>(compressed.size());
+    header.checksum = ComputeChecksum(compressed);
+
+    const std::size_t offset = pending_precompiled.size();
+    pending_precompiled.resize(offset + sizeof(header) + compressed.size());
+    pending_accounting.Resize(pending_precompiled.capacity());
+    std::memcpy(pending_precompiled.data() + offset, &header, sizeof(header));
+    std::memcpy(pending_precompiled.data() + offset + sizeof(header), compressed.data(),
+                compressed.size());
 }
 
 bool ShaderDiskCacheOpenGL::IsUsable() const {
     return tried_to_load && Settings::values.use_disk_shader_cache;
 }
 
+bool ShaderDiskCacheOpenGL::RewriteTransferable(const std::vector<ShaderDiskCacheRaw>& raws,
+                                                const std::vector<ShaderDiskCacheUsage>& usages) {
+    if (!EnsureDirectories()) {
+        return false;
+    }
+    FileUtil::IOFile file(GetTransferablePath(), "wb");
+    if (!file.IsOpen() || file.WriteObject(NativeVersion) != 1) {
+        return false;
+    }
+    for (const auto& raw : raws) {
+        if (file.WriteObject(TransferableEntryKind::Raw) != 1 || !raw.Save(file)) {
+            return false;
+        }
+    }
+    for (const auto& usage : usages) {
+        if (file.WriteObject(TransferableEntryKind::Usage) != 1 || file.WriteObject(usage) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
 FileUtil::IOFile ShaderDiskCacheOpenGL::AppendTransferableFile() const {
     if (!EnsureDirectories())
         return {};
@@ -555,36 +835,51 @@ FileUtil::IOFile ShaderDiskCacheOpenGL::AppendTransferableFile() const {
     return file;
 }
 
-void ShaderDiskCacheOpenGL::SavePrecompiledHeaderToVirtualPrecompiledCache() {
-    const auto hash{GetShaderCacheVersionHash()};
-    if (!SaveArrayToPrecompiled(hash.data(), hash.size())) {
-        LOG_ERROR(
-            Render_OpenGL,
-            "Failed to write precompiled cache version hash to virtual precompiled cache file");
-    }
-}
-
-void ShaderDiskCacheOpenGL::SaveVirtualPrecompiledFile() {
-    precompiled_cache_virtual_file_offset = 0;
-    const std::vector<u8>& uncompressed = precompiled_cache_virtual_file.ReadAllBytes();
-    const std::vector<u8>& compressed =
-        Common::Compression::CompressDataZSTDDefault(uncompressed.data(), uncompressed.size());
+FileUtil::IOFile ShaderDiskCacheOpenGL::AppendPrecompiledFile() const {
+    if (!EnsureDirectories())
+        return {};
 
     const auto precompiled_path{GetPrecompiledPath()};
-    FileUtil::IOFile file(precompiled_path, "wb");
+    const bool existed = FileUtil::Exists(precompiled_path);
 
+    FileUtil::IOFile file(precompiled_path, "ab");
     if (!file.IsOpen()) {
         LOG_ERROR(Render_OpenGL, "Failed to open precompiled cache in path={}", precompiled_path);
+        return {};
+    }
+    if (!existed || file.GetSize() == 0) {
+        // If the file didn't exist, write its header
+        PrecompiledHeader header{};
+        header.version_hash = GetShaderCacheVersionHash();
+        header.version = PrecompiledVersion;
+        if (file.WriteObject(header) != 1) {
+            LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache version in path={}",
+                      precompiled_path);
+            return {};
+        }
+    }
+    return file;
+}
+
+void ShaderDiskCacheOpenGL::SavePrecompiledEntries() {
+    if (pending_precompiled.empty()) {
+        return;
+    }
+
+    FileUtil::IOFile file = AppendPrecompiledFile();
+    if (!file.IsOpen()) {
         return;
     }
-    if (file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
-        LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache version in path={}",
-                  precompiled_path);
+    if (file.WriteBytes(pending_precompiled.data(), pending_precompiled.size()) !=
+        pending_precompiled.size()) {
+        LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache entries in path={}",
+                  GetPrecompiledPath());
         return;
     }
+    pending_precompiled.clear();
 }
 
-bool ShaderDiskCacheOpenGL::EnsureDirectories() const {
+bool ShaderDiskCacheOpenGL::EnsureDirectories() {
     const auto CreateDir = [](const std::string& dir) {
         if (!FileUtil::CreateDir(dir)) {
             LOG_ERROR(Render_OpenGL, "Failed to create directory={}", dir);
@@ -606,15 +901,15 @@ std::string ShaderDiskCacheOpenGL::GetPrecompiledPath() const {
     return FileUtil::SanitizePath(GetPrecompiledDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
 }
 
-std::string ShaderDiskCacheOpenGL::GetTransferableDir() const {
+std::string ShaderDiskCacheOpenGL::GetTransferableDir() {
     return GetBaseDir() + DIR_SEP "transferable";
 }
 
-std::string ShaderDiskCacheOpenGL::GetPrecompiledDir() const {
+std::string ShaderDiskCacheOpenGL::GetPrecompiledDir() {
     return GetBaseDir() + DIR_SEP "precompiled";
 }
 
-std::string ShaderDiskCacheOpenGL::GetBaseDir() const {
+std::string ShaderDiskCacheOpenGL::GetBaseDir() {
     return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "opengl";
 }
 
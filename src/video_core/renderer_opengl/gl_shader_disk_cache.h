@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -16,6 +17,7 @@
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "core/file_sys/vfs_vector.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
@@ -53,11 +55,14 @@ struct BaseBindings {
     }
 };
 
-/// Describes how a shader is used
+/// Describes how a shader is used. When it was first used doesn't identify the usage, it's only
+/// recorded to build the usages in the order the title needs them.
 struct ShaderDiskCacheUsage {
     u64 unique_identifier{};
     BaseBindings bindings;
     GLenum primitive{};
+    u32 first_use_order{}; ///< Number of usages of the title saved before this one
+    u32 first_use_frame{}; ///< Frame since boot the usage was first saved in
 
     bool operator==(const ShaderDiskCacheUsage& rhs) const {
         return std::tie(unique_identifier, bindings, primitive) ==
@@ -178,27 +183,43 @@ public:
               std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>>
     LoadPrecompiled();
 
+    /// Loads a transferable cache file that doesn't belong to the running title, e.g. to merge it
+    /// or to replay its shaders. The file is left untouched on failure.
+    static std::optional<
+        std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
+    LoadTransferableFile(const std::string& path);
+
+    /**
+     * Merges a transferable cache, e.g. one recorded on another machine, into a title's
+     * transferable cache. Shaders and usages the title's cache already has are skipped. All the
+     * usages are built and stored in the precompiled cache the next time the title boots.
+     * @returns The number of merged entries, or empty on failure.
+     */
+    static std::optional<std::size_t> MergeTransferable(u64 title_id, const std::string& path);
+
     /// Removes the transferable (and precompiled) cache file.
     void InvalidateTransferable();
 
-    /// Removes the precompiled cache file and clears virtual precompiled cache file.
+    /// Removes the precompiled cache file and drops the entries that were not written yet.
     void InvalidatePrecompiled();
 
     /// Saves a raw dump to the transferable file. Checks for collisions.
     void SaveRaw(const ShaderDiskCacheRaw& entry);
 
-    /// Saves shader usage to the transferable file. Does not check for collisions.
+    /// Saves shader usage to the transferable file, stamping when it was first used. Does not
+    /// check for collisions.
     void SaveUsage(const ShaderDiskCacheUsage& usage);
 
-    /// Saves a decompiled entry to the precompiled file. Does not check for collisions.
+    /// Queues a decompiled entry to be saved in the precompiled file. Does not check for
+    /// collisions.
     void SaveDecompiled(u64 unique_identifier, const std::string& code,
                         const GLShader::ShaderEntries& entries);
 
-    /// Saves a dump entry to the precompiled file. Does not check for collisions.
+    /// Queues a dump entry to be saved in the precompiled file. Does not check for collisions.
     void SaveDump(const ShaderDiskCacheUsage& usage, GLuint program);
 
-    /// Serializes virtual precompiled shader cache file to real file
-    void SaveVirtualPrecompiledFile();
+    /// Appends the queued entries to the precompiled file
+    void SavePrecompiledEntries();
 
 private:
     /// Loads the transferable cache. Returns empty on failure.
@@ -206,25 +227,35 @@ private:
                             std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>>>
     LoadPrecompiledFile(FileUtil::IOFile& file);
 
-    /// Loads a decompiled cache entry from m_precompiled_cache_virtual_file. Returns empty on
-    /// failure.
+    /// Loads a decompiled cache entry from entry_buffer. Returns empty on failure.
     std::optional<ShaderDiskCacheDecompiled> LoadDecompiledEntry();
 
-    /// Saves a decompiled entry to the passed file. Returns true on success.
-    bool SaveDecompiledFile(u64 unique_identifier, const std::string& code,
-                            const GLShader::ShaderEntries& entries);
+    /// Loads a dump cache entry from entry_buffer. Returns empty on failure.
+    std::optional<std::pair<ShaderDiskCacheUsage, ShaderDiskCacheDump>> LoadDumpEntry();
+
+    /// Serializes a decompiled entry to entry_buffer. Returns true on success.
+    bool SaveDecompiledEntry(u64 unique_identifier, const std::string& code,
+                             const GLShader::ShaderEntries& entries);
+
+    /// Compresses entry_buffer and queues it to be appended to the precompiled file
+    void QueuePrecompiledEntry(u32 kind);
 
     /// Returns if the cache can be used
     bool IsUsable() const;
 
+    /// Writes the current game's transferable file from scratch with the current version. Returns
+    /// true on success.
+    bool RewriteTransferable(const std::vector<ShaderDiskCacheRaw>& raws,
+                             const std::vector<ShaderDiskCacheUsage>& usages);
+
     /// Opens current game's transferable file and write it's header if it doesn't exist
     FileUtil::IOFile AppendTransferableFile() const;
 
-    /// Save precompiled header to precompiled_cache_in_memory
-    void SavePrecompiledHeaderToVirtualPrecompiledCache();
+    /// Opens current game's precompiled file and writes its header if it doesn't exist
+    FileUtil::IOFile AppendPrecompiledFile() const;
 
     /// Create shader disk cache directories. Returns true on success.
-    bool EnsureDirectories() const;
+    static bool EnsureDirectories();
 
     /// Gets current game's transferable file path
     std::string GetTransferablePath() const;
@@ -233,30 +264,29 @@ private:
     std::string GetPrecompiledPath() const;
 
     /// Get user's transferable directory path
-    std::string GetTransferableDir() const;
+    static std::string GetTransferableDir();
 
     /// Get user's precompiled directory path
-    std::string GetPrecompiledDir() const;
+    static std::string GetPrecompiledDir();
 
     /// Get user's shader directory path
-    std::string GetBaseDir() const;
+    static std::string GetBaseDir();
 
     /// Get current game's title id
     std::string GetTitleID() const;
 
     template <typename T>
     bool SaveArrayToPrecompiled(const T* data, std::size_t length) {
-        const std::size_t write_length = precompiled_cache_virtual_file.WriteArray(
-            data, length, precompiled_cache_virtual_file_offset);
-        precompiled_cache_virtual_file_offset += write_length;
+        const std::size_t write_length =
+            entry_buffer.WriteArray(data, length, entry_buffer_offset);
+        entry_buffer_offset += write_length;
         return write_length == sizeof(T) * length;
     }
 
     template <typename T>
     bool LoadArrayFromPrecompiled(T* data, std::size_t length) {
-        const std::size_t read_length = precompiled_cache_virtual_file.ReadArray(
-            data, length, precompiled_cache_virtual_file_offset);
-        precompiled_cache_virtual_file_offset += read_length;
+        const std::size_t read_length = entry_buffer.ReadArray(data, length, entry_buffer_offset);
+        entry_buffer_offset += read_length;
         return read_length == sizeof(T) * length;
     }
 
@@ -290,10 +320,17 @@ private:
     Core::System& system;
     // Stored transferable shaders
     std::map<u64, std::unordered_set<ShaderDiskCacheUsage>> transferable;
-    // Stores whole precompiled cache which will be read from/saved to the precompiled cache file
-    FileSys::VectorVfsFile precompiled_cache_virtual_file;
-    // Stores the current offset of the precompiled cache file for IO purposes
-    std::size_t precompiled_cache_virtual_file_offset = 0;
+    // Number of usages in the transferable file, it's the first use order of the next one
+    u32 num_usages = 0;
+    // Uncompressed precompiled entry being serialized or deserialized
+    FileSys::VectorVfsFile entry_buffer;
+    // Stores the current offset of the entry buffer for IO purposes
+    std::size_t entry_buffer_offset = 0;
+    // Compressed entries waiting to be appended to the precompiled file
+    std::vector<u8> pending_precompiled;
+    // Capacity of the pending entries, it's kept once they are written
+    Common::MemoryAccounting::Allocation pending_accounting{
+        Common::MemoryAccounting::Category::ShaderDiskCache};
 
     // The cache has been loaded at boot
     bool tried_to_load{};
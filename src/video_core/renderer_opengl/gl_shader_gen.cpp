@@ -10,11 +10,11 @@
 
 namespace OpenGL::GLShader {
 
-using Tegra::Engines::Maxwell3D;
 using VideoCommon::Shader::ProgramCode;
 using VideoCommon::Shader::ShaderIR;
 
 static constexpr u32 PROGRAM_OFFSET{10};
+static constexpr u32 KERNEL_OFFSET{0};
 
 ProgramResult GenerateVertexShader(const Device& device, const ShaderSetup& setup) {
     const std::string id = fmt::format("{:016x}", setup.program.unique_identifier);
@@ -34,15 +34,13 @@ layout (std140, binding = EMULATION_UBO_BINDING) uniform vs_config {
 
 )";
     const ShaderIR program_ir(setup.program.code, PROGRAM_OFFSET);
-    ProgramResult program =
-        Decompile(device, program_ir, Maxwell3D::Regs::ShaderStage::Vertex, "vertex");
+    ProgramResult program = Decompile(device, program_ir, ProgramType::Vertex, "vertex");
 
     out += program.first;
 
     if (setup.IsDualProgram()) {
         const ShaderIR program_ir_b(setup.program.code_b, PROGRAM_OFFSET);
-        ProgramResult program_b =
-            Decompile(device, program_ir_b, Maxwell3D::Regs::ShaderStage::Vertex, "vertex_b");
+        ProgramResult program_b = Decompile(device, program_ir_b, ProgramType::Vertex, "vertex_b");
 
         out += program_b.first;
     }
@@ -58,6 +56,10 @@ void main() {
     }
 
     out += R"(
+#ifdef TRANSFORM_FEEDBACK
+    // Transform feedback captures the vertex as the guest wrote it
+    write_transform_feedback();
+#endif
 
     // Set Position Y direction
     position.y *= utof(config_pack[2]);
@@ -98,8 +100,7 @@ layout (std140, binding = EMULATION_UBO_BINDING) uniform gs_config {
 
 )";
     const ShaderIR program_ir(setup.program.code, PROGRAM_OFFSET);
-    ProgramResult program =
-        Decompile(device, program_ir, Maxwell3D::Regs::ShaderStage::Geometry, "geometry");
+    ProgramResult program = Decompile(device, program_ir, ProgramType::Geometry, "geometry");
     out += program.first;
 
     out += R"(
@@ -161,8 +162,7 @@ bool AlphaFunc(in float value) {
 
 )";
     const ShaderIR program_ir(setup.program.code, PROGRAM_OFFSET);
-    ProgramResult program =
-        Decompile(device, program_ir, Maxwell3D::Regs::ShaderStage::Fragment, "fragment");
+    ProgramResult program = Decompile(device, program_ir, ProgramType::Fragment, "fragment");
 
     out += program.first;
 
@@ -175,4 +175,24 @@ void main() {
     return {std::move(out), std::move(program.second)};
 }
 
+ProgramResult GenerateComputeShader(const Device& device, const ShaderSetup& setup) {
+    const std::string id = fmt::format("{:016x}", setup.program.unique_identifier);
+
+    std::string out = "// Shader Unique Id: CS" + id + "\n\n";
+    out += GetCommonDeclarations();
+
+    // Kernels have no shader header, their code starts at the first instruction
+    const ShaderIR program_ir(setup.program.code, KERNEL_OFFSET);
+    ProgramResult program = Decompile(device, program_ir, ProgramType::Compute, "compute");
+
+    out += program.first;
+
+    out += R"(
+void main() {
+    execute_compute();
+}
+)";
+    return {std::move(out), std::move(program.second)};
+}
+
 } // namespace OpenGL::GLShader
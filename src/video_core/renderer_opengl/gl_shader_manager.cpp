@@ -59,7 +59,7 @@ void MaxwellUniformData::SetFromRegs(const Maxwell3D& maxwell, std::size_t shade
     alpha_test.func = func;
     alpha_test.ref = regs.alpha_test_ref;
 
-    instance_id = state.current_instance;
+    instance_id = state.base_instance;
 
     // Assign in which stage the position has to be flipped
     // (the last stage before the fragment shader).
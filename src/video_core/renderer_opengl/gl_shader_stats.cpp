@@ -0,0 +1,133 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
+#include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_shader_stats.h"
+
+namespace OpenGL {
+
+ShaderStatistics::ShaderStatistics(Core::System& system) : system{system} {}
+
+ShaderStatistics::~ShaderStatistics() {
+    if (shaders.empty()) {
+        return;
+    }
+
+    std::chrono::microseconds decompile_time{};
+    std::chrono::microseconds build_time{};
+    std::size_t num_variants = 0;
+    for (const auto& [unique_identifier, stats] : shaders) {
+        decompile_time += stats.decompile_time;
+        build_time += stats.build_time;
+        num_variants += stats.variants;
+    }
+    LOG_INFO(Render_OpenGL,
+             "Title {:016X} used {} shaders with {} variants, {} ms were spent decompiling and {} "
+             "ms building on the GPU thread",
+             title_id, shaders.size(), num_variants, decompile_time.count() / 1000,
+             build_time.count() / 1000);
+
+    if (Settings::values.dump_shader_stats) {
+        Dump();
+    }
+}
+
+void ShaderStatistics::RecordDecompile(u64 unique_identifier, const char* stage,
+                                       Clock::duration time) {
+    GetStats(unique_identifier, stage).decompile_time +=
+        std::chrono::duration_cast<std::chrono::microseconds>(time);
+}
+
+void ShaderStatistics::RecordUse(u64 unique_identifier, const char* stage) {
+    GetStats(unique_identifier, stage);
+}
+
+void ShaderStatistics::RecordBuild(u64 unique_identifier, Clock::duration time) {
+    const auto build_time = std::chrono::duration_cast<std::chrono::microseconds>(time);
+    ShaderStats& stats = GetStats(unique_identifier);
+    ++stats.variants;
+    stats.build_time += build_time;
+    stats.max_build_time = std::max(stats.max_build_time, build_time);
+    system.GetPerfStats().AddSessionSample(Core::SessionHistogram::ShaderBuildTime,
+                                           static_cast<u64>(build_time.count()));
+}
+
+void ShaderStatistics::RecordQueued(u64 unique_identifier) {
+    ShaderStats& stats = GetStats(unique_identifier);
+    ++stats.variants;
+    ++stats.queued_variants;
+}
+
+void ShaderStatistics::RecordPrecompiled(u64 unique_identifier) {
+    ShaderStats& stats = GetStats(unique_identifier);
+    ++stats.variants;
+    ++stats.precompiled_variants;
+}
+
+ShaderStats& ShaderStatistics::GetStats(u64 unique_identifier, const char* stage) {
+    const auto [entry, is_new] = shaders.try_emplace(unique_identifier);
+    ShaderStats& stats = entry->second;
+    if (is_new) {
+        if (title_id == 0) {
+            // The process is not available when the cache is created
+            title_id = system.CurrentProcess()->GetTitleID();
+        }
+        stats.stage = stage;
+        stats.first_use_frame = system.Renderer().GetCurrentFrame();
+    }
+    return stats;
+}
+
+void ShaderStatistics::Dump() const {
+    const std::string dir{FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) + "shader_stats" +
+                          DIR_SEP};
+    if (!FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create directory={}", dir);
+        return;
+    }
+
+    // Sort the shaders by the time they stall the GPU thread, the worst ones come first
+    std::vector<std::pair<u64, const ShaderStats*>> sorted;
+    sorted.reserve(shaders.size());
+    for (const auto& [unique_identifier, stats] : shaders) {
+        sorted.emplace_back(unique_identifier, &stats);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second->decompile_time + lhs.second->build_time >
+               rhs.second->decompile_time + rhs.second->build_time;
+    });
+
+    std::string json = fmt::format("{{\n  \"title_id\": \"{:016X}\",\n  \"shaders\": [", title_id);
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        const auto& [unique_identifier, stats] = sorted[i];
+        json += fmt::format(
+            "{}\n    {{\"id\": \"{:016x}\", \"stage\": \"{}\", \"first_use_frame\": {}, "
+            "\"decompile_us\": {}, \"variants\": {}, \"queued_variants\": {}, "
+            "\"precompiled_variants\": {}, \"build_us\": {}, \"max_build_us\": {}}}",
+            i == 0 ? "" : ",", unique_identifier, stats->stage, stats->first_use_frame,
+            stats->decompile_time.count(), stats->variants, stats->queued_variants,
+            stats->precompiled_variants, stats->build_time.count(),
+            stats->max_build_time.count());
+    }
+    json += "\n  ]\n}\n";
+
+    const std::string path{fmt::format("{}{:016X}.json", dir, title_id)};
+    if (FileUtil::WriteStringToFile(true, path, json) != json.size()) {
+        LOG_ERROR(Render_OpenGL, "Failed to write shader statistics to path={}", path);
+    }
+}
+
+} // namespace OpenGL
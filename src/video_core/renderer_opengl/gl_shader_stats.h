@@ -0,0 +1,68 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace OpenGL {
+
+/// Time spent decompiling and building the programs of a guest shader
+struct ShaderStats {
+    std::string stage;
+    int first_use_frame{};
+    std::chrono::microseconds decompile_time{};
+    u32 variants{};             ///< Programs specialized from the shader
+    u32 queued_variants{};      ///< Variants built by the background compiler
+    u32 precompiled_variants{}; ///< Variants loaded from the precompiled disk cache
+    std::chrono::microseconds build_time{};     ///< Time spent building on the GPU thread
+    std::chrono::microseconds max_build_time{}; ///< Longest build done on the GPU thread
+};
+
+/**
+ * Collects how expensive each shader of a title is, to find the titles that stutter on new
+ * shaders. The statistics are logged when the cache is destroyed and dumped as JSON when
+ * Settings::values.dump_shader_stats is set.
+ */
+class ShaderStatistics final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ShaderStatistics(Core::System& system);
+    ~ShaderStatistics();
+
+    /// Records that a shader was decompiled on the GPU thread
+    void RecordDecompile(u64 unique_identifier, const char* stage, Clock::duration time);
+
+    /// Records that a shader was used for the first time, without having to decompile it
+    void RecordUse(u64 unique_identifier, const char* stage);
+
+    /// Records a variant built on the GPU thread
+    void RecordBuild(u64 unique_identifier, Clock::duration time);
+
+    /// Records a variant handed to the background compiler
+    void RecordQueued(u64 unique_identifier);
+
+    /// Records a variant loaded from the precompiled disk cache
+    void RecordPrecompiled(u64 unique_identifier);
+
+private:
+    ShaderStats& GetStats(u64 unique_identifier, const char* stage = "");
+
+    void Dump() const;
+
+    Core::System& system;
+    u64 title_id{};
+    std::unordered_map<u64, ShaderStats> shaders;
+};
+
+} // namespace OpenGL
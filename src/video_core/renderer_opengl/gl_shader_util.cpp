@@ -22,6 +22,9 @@ GLuint LoadShader(const char* source, GLenum type) {
     case GL_FRAGMENT_SHADER:
         debug_type = "fragment";
         break;
+    case GL_COMPUTE_SHADER:
+        debug_type = "compute";
+        break;
     default:
         UNREACHABLE();
     }
@@ -14,6 +14,8 @@ using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 
 OpenGLState OpenGLState::cur_state;
 bool OpenGLState::s_rgb_used;
+std::array<const OpenGLState*, static_cast<std::size_t>(OpenGLState::Group::Count)>
+    OpenGLState::group_owners{};
 
 namespace {
 
@@ -204,12 +206,14 @@ void OpenGLState::ApplyClipDistances() const {
 }
 
 void OpenGLState::ApplyPointSize() const {
+    SetGroupOwner(Group::PointSize);
     if (UpdateValue(cur_state.point.size, point.size)) {
         glPointSize(point.size);
     }
 }
 
 void OpenGLState::ApplyFragmentColorClamp() const {
+    SetGroupOwner(Group::FragmentColorClamp);
     if (UpdateValue(cur_state.fragment_color_clamp.enabled, fragment_color_clamp.enabled)) {
         glClampColor(GL_CLAMP_FRAGMENT_COLOR_ARB,
                      fragment_color_clamp.enabled ? GL_TRUE : GL_FALSE);
@@ -217,6 +221,7 @@ void OpenGLState::ApplyFragmentColorClamp() const {
 }
 
 void OpenGLState::ApplyMultisample() const {
+    SetGroupOwner(Group::Multisample);
     Enable(GL_SAMPLE_ALPHA_TO_COVERAGE, cur_state.multisample_control.alpha_to_coverage,
            multisample_control.alpha_to_coverage);
     Enable(GL_SAMPLE_ALPHA_TO_ONE, cur_state.multisample_control.alpha_to_one,
@@ -224,6 +229,7 @@ void OpenGLState::ApplyMultisample() const {
 }
 
 void OpenGLState::ApplyDepthClamp() const {
+    SetGroupOwner(Group::DepthClamp);
     if (depth_clamp.far_plane == cur_state.depth_clamp.far_plane &&
         depth_clamp.near_plane == cur_state.depth_clamp.near_plane) {
         return;
@@ -250,6 +256,7 @@ void OpenGLState::ApplySRgb() const {
 }
 
 void OpenGLState::ApplyCulling() const {
+    SetGroupOwner(Group::Culling);
     Enable(GL_CULL_FACE, cur_state.cull.enabled, cull.enabled);
 
     if (UpdateValue(cur_state.cull.mode, cull.mode)) {
@@ -262,6 +269,7 @@ void OpenGLState::ApplyCulling() const {
 }
 
 void OpenGLState::ApplyColorMask() const {
+    SetGroupOwner(Group::ColorMask);
     for (std::size_t i = 0; i < Maxwell::NumRenderTargets; ++i) {
         const auto& updated = color_mask[i];
         auto& current = cur_state.color_mask[i];
@@ -277,6 +285,7 @@ void OpenGLState::ApplyColorMask() const {
 }
 
 void OpenGLState::ApplyDepth() const {
+    SetGroupOwner(Group::Depth);
     Enable(GL_DEPTH_TEST, cur_state.depth.test_enabled, depth.test_enabled);
 
     if (cur_state.depth.test_func != depth.test_func) {
@@ -291,6 +300,7 @@ void OpenGLState::ApplyDepth() const {
 }
 
 void OpenGLState::ApplyPrimitiveRestart() const {
+    SetGroupOwner(Group::PrimitiveRestart);
     Enable(GL_PRIMITIVE_RESTART, cur_state.primitive_restart.enabled, primitive_restart.enabled);
 
     if (cur_state.primitive_restart.index != primitive_restart.index) {
@@ -300,6 +310,7 @@ void OpenGLState::ApplyPrimitiveRestart() const {
 }
 
 void OpenGLState::ApplyStencilTest() const {
+    SetGroupOwner(Group::Stencil);
     Enable(GL_STENCIL_TEST, cur_state.stencil.test_enabled, stencil.test_enabled);
 
     const auto ConfigStencil = [](GLenum face, const auto& config, auto& current) {
@@ -329,6 +340,7 @@ void OpenGLState::ApplyStencilTest() const {
 }
 
 void OpenGLState::ApplyViewport() const {
+    SetGroupOwner(Group::Viewport);
     for (GLuint i = 0; i < static_cast<GLuint>(Maxwell::NumViewports); ++i) {
         const auto& updated = viewports[i];
         auto& current = cur_state.viewports[i];
@@ -414,6 +426,7 @@ void OpenGLState::ApplyTargetBlending(std::size_t target, bool force) const {
 }
 
 void OpenGLState::ApplyBlending() const {
+    SetGroupOwner(Group::Blending);
     if (independant_blend.enabled) {
         const bool force = independant_blend.enabled != cur_state.independant_blend.enabled;
         for (std::size_t target = 0; target < Maxwell::NumRenderTargets; ++target) {
@@ -433,6 +446,7 @@ void OpenGLState::ApplyBlending() const {
 }
 
 void OpenGLState::ApplyLogicOp() const {
+    SetGroupOwner(Group::LogicOp);
     Enable(GL_COLOR_LOGIC_OP, cur_state.logic_op.enabled, logic_op.enabled);
 
     if (UpdateValue(cur_state.logic_op.operation, logic_op.operation)) {
@@ -441,6 +455,7 @@ void OpenGLState::ApplyLogicOp() const {
 }
 
 void OpenGLState::ApplyPolygonOffset() const {
+    SetGroupOwner(Group::PolygonOffset);
     Enable(GL_POLYGON_OFFSET_FILL, cur_state.polygon_offset.fill_enable,
            polygon_offset.fill_enable);
     Enable(GL_POLYGON_OFFSET_LINE, cur_state.polygon_offset.line_enable,
@@ -511,28 +526,39 @@ void OpenGLState::ApplySamplers() const {
     }
 }
 
+void OpenGLState::ApplyGroup(Group group, void (OpenGLState::*apply)() const) const {
+    const auto index = static_cast<std::size_t>(group);
+    if (!dirty_groups.flags[index] && group_owners[index] == this) {
+        return;
+    }
+    (this->*apply)();
+    dirty_groups.flags.reset(index);
+}
+
 void OpenGLState::Apply() const {
+    // Bindings change on most draws, so they are always compared
     ApplyFramebufferState();
     ApplyVertexArrayState();
     ApplyShaderProgram();
     ApplyProgramPipeline();
     ApplyClipDistances();
-    ApplyPointSize();
-    ApplyFragmentColorClamp();
-    ApplyMultisample();
-    ApplyDepthClamp();
-    ApplyColorMask();
-    ApplyViewport();
-    ApplyStencilTest();
     ApplySRgb();
-    ApplyCulling();
-    ApplyDepth();
-    ApplyPrimitiveRestart();
-    ApplyBlending();
-    ApplyLogicOp();
     ApplyTextures();
     ApplySamplers();
-    ApplyPolygonOffset();
+
+    ApplyGroup(Group::PointSize, &OpenGLState::ApplyPointSize);
+    ApplyGroup(Group::FragmentColorClamp, &OpenGLState::ApplyFragmentColorClamp);
+    ApplyGroup(Group::Multisample, &OpenGLState::ApplyMultisample);
+    ApplyGroup(Group::DepthClamp, &OpenGLState::ApplyDepthClamp);
+    ApplyGroup(Group::ColorMask, &OpenGLState::ApplyColorMask);
+    ApplyGroup(Group::Viewport, &OpenGLState::ApplyViewport);
+    ApplyGroup(Group::Stencil, &OpenGLState::ApplyStencilTest);
+    ApplyGroup(Group::Culling, &OpenGLState::ApplyCulling);
+    ApplyGroup(Group::Depth, &OpenGLState::ApplyDepth);
+    ApplyGroup(Group::PrimitiveRestart, &OpenGLState::ApplyPrimitiveRestart);
+    ApplyGroup(Group::Blending, &OpenGLState::ApplyBlending);
+    ApplyGroup(Group::LogicOp, &OpenGLState::ApplyLogicOp);
+    ApplyGroup(Group::PolygonOffset, &OpenGLState::ApplyPolygonOffset);
 }
 
 void OpenGLState::EmulateViewportWithScissor() {
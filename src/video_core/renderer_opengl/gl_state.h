@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <glad/glad.h>
 #include "video_core/engines/maxwell_3d.h"
 
@@ -35,6 +36,25 @@ constexpr TextureUnit ProcTexDiffLUT{9};
 
 class OpenGLState {
 public:
+    /// Groups of state that are only applied when they have been marked as dirty, or when another
+    /// state object applied them after this one.
+    enum class Group : std::size_t {
+        Multisample,
+        FragmentColorClamp,
+        DepthClamp,
+        Culling,
+        Depth,
+        PrimitiveRestart,
+        ColorMask,
+        Stencil,
+        Viewport,
+        Blending,
+        LogicOp,
+        PointSize,
+        PolygonOffset,
+        Count,
+    };
+
     struct {
         bool enabled; // GL_FRAMEBUFFER_SRGB
     } framebuffer_srgb;
@@ -189,9 +209,17 @@ public:
         s_rgb_used = false;
     }
 
-    /// Apply this state as the current OpenGL state
+    /**
+     * Apply this state as the current OpenGL state. Groups that weren't marked as dirty since this
+     * state last applied them are skipped.
+     */
     void Apply() const;
 
+    /// Marks a group of state as modified, it will be applied in the next call to Apply
+    void MarkDirty(Group group) {
+        dirty_groups.flags.set(static_cast<std::size_t>(group));
+    }
+
     void ApplyFramebufferState() const;
     void ApplyVertexArrayState() const;
     void ApplyShaderProgram() const;
@@ -231,8 +259,36 @@ public:
     void EmulateViewportWithScissor();
 
 private:
+    /// Dirty flags of the tracked groups. Copies of a state start with every group dirty, as their
+    /// values are not known to match the current OpenGL state.
+    struct DirtyGroups {
+        DirtyGroups() {
+            flags.set();
+        }
+        DirtyGroups(const DirtyGroups&) : DirtyGroups{} {}
+        DirtyGroups& operator=(const DirtyGroups&) {
+            flags.set();
+            return *this;
+        }
+
+        std::bitset<static_cast<std::size_t>(Group::Count)> flags;
+    };
+
+    /// Applies a tracked group if it's dirty or if other state object applied it last
+    void ApplyGroup(Group group, void (OpenGLState::*apply)() const) const;
+
+    /// Records this state as the last one that applied the given group
+    void SetGroupOwner(Group group) const {
+        group_owners[static_cast<std::size_t>(group)] = this;
+    }
+
+    mutable DirtyGroups dirty_groups;
+
     static OpenGLState cur_state;
 
+    /// State objects that last applied each tracked group
+    static std::array<const OpenGLState*, static_cast<std::size_t>(Group::Count)> group_owners;
+
     // Workaround for sRGB problems caused by QT not supporting srgb output
     static bool s_rgb_used;
 };
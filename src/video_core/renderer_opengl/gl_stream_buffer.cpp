@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include "common/alignment.h"
@@ -12,11 +13,13 @@
 
 MICROPROFILE_DEFINE(OpenGL_StreamBuffer, "OpenGL", "Stream Buffer Orphaning",
                     MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(OpenGL_StreamBufferWait, "OpenGL", "Stream Buffer Wait",
+                    MP_RGB(128, 128, 192));
 
 namespace OpenGL {
 
 OGLStreamBuffer::OGLStreamBuffer(GLsizeiptr size, bool vertex_data_usage, bool prefer_coherent)
-    : buffer_size(size) {
+    : buffer_size(size), region_size(size / static_cast<GLsizeiptr>(NumRegions)) {
     gl_buffer.Create();
 
     GLsizeiptr allocate_size = size;
@@ -66,21 +69,55 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
         buffer_pos = Common::AlignUp<std::size_t>(buffer_pos, alignment);
     }
 
+    if (persistent) {
+        // Fence again the regions reused since they were fenced
+        for (std::size_t region = 0; region < NumRegions; ++region) {
+            if (std::exchange(used_regions[region], false)) {
+                FenceRegions(region, region + 1);
+            }
+        }
+
+        if (buffer_pos + size > buffer_size) {
+            // Start a new pass through the buffer, the previous one is done with every region
+            FenceRegions(unfenced_region, entered_regions);
+            buffer_pos = 0;
+            unfenced_region = 0;
+            entered_regions = 0;
+        }
+
+        const GLintptr chunk_end = buffer_pos + std::max<GLsizeiptr>(size, 1);
+        const auto first_region =
+            std::min(static_cast<std::size_t>(buffer_pos / region_size), NumRegions - 1);
+        const auto last_region =
+            std::min(static_cast<std::size_t>((chunk_end - 1) / region_size), NumRegions - 1);
+        FenceRegions(unfenced_region, first_region);
+        unfenced_region = std::max(unfenced_region, first_region);
+
+        const std::size_t enter_begin = std::max(entered_regions, first_region);
+        const bool invalidate = enter_begin <= last_region;
+        if (invalidate) {
+            WaitRegions(enter_begin, last_region + 1);
+            invalidated_range = {static_cast<GLintptr>(enter_begin) * region_size,
+                                 last_region + 1 == NumRegions
+                                     ? buffer_size
+                                     : static_cast<GLintptr>(last_region + 1) * region_size};
+            entered_regions = last_region + 1;
+        }
+        return std::make_tuple(mapped_ptr + buffer_pos, buffer_pos, invalidate);
+    }
+
     bool invalidate = false;
     if (buffer_pos + size > buffer_size) {
         buffer_pos = 0;
         invalidate = true;
-
-        if (persistent) {
-            glUnmapNamedBuffer(gl_buffer.handle);
-        }
+        invalidated_range = {0, buffer_size};
     }
 
-    if (invalidate || !persistent) {
+    {
         MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
-        GLbitfield flags = GL_MAP_WRITE_BIT | (persistent ? GL_MAP_PERSISTENT_BIT : 0) |
-                           (coherent ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT) |
-                           (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
+        const GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT |
+            (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
         mapped_ptr = static_cast<u8*>(
             glMapNamedBufferRange(gl_buffer.handle, buffer_pos, buffer_size - buffer_pos, flags));
         mapped_offset = buffer_pos;
@@ -103,4 +140,38 @@ void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     buffer_pos += size;
 }
 
+void OGLStreamBuffer::MarkUsed(GLintptr offset, GLsizeiptr size) {
+    if (!persistent || size == 0) {
+        return;
+    }
+    const auto first_region =
+        std::min(static_cast<std::size_t>(offset / region_size), NumRegions - 1);
+    const auto last_region =
+        std::min(static_cast<std::size_t>((offset + size - 1) / region_size), NumRegions - 1);
+    for (std::size_t region = first_region; region <= last_region; ++region) {
+        used_regions[region] = true;
+    }
+}
+
+void OGLStreamBuffer::FenceRegions(std::size_t begin, std::size_t end) {
+    for (std::size_t region = begin; region < end; ++region) {
+        region_fences[region].Release();
+        region_fences[region].Create();
+    }
+}
+
+void OGLStreamBuffer::WaitRegions(std::size_t begin, std::size_t end) {
+    for (std::size_t region = begin; region < end; ++region) {
+        OGLSync& fence = region_fences[region];
+        if (fence.handle == 0) {
+            continue;
+        }
+        MICROPROFILE_SCOPE(OpenGL_StreamBufferWait);
+        while (glClientWaitSync(fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) ==
+               GL_TIMEOUT_EXPIRED) {
+        }
+        fence.Release();
+    }
+}
+
 } // namespace OpenGL
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
+#include <utility>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
@@ -22,7 +24,10 @@ public:
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
-     * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
+     * Persistent buffers are split in regions guarded by fences. When the chunk enters regions
+     * used in the previous pass through the buffer, it waits for the GPU to be done with them and
+     * the chunks stored in those regions are invalidated. Otherwise, if the buffer is full, the
+     * whole buffer is reallocated which invalidates old chunks.
      * The return values are the pointer to the new chunk, the offset within the buffer,
      * and the invalidation flag for previous chunks.
      * The actual used size must be specified on unmapping the chunk.
@@ -31,7 +36,24 @@ public:
 
     void Unmap(GLsizeiptr size);
 
+    /// Keeps the regions holding a chunk mapped in a previous call from being overwritten until
+    /// the GPU is done with the commands submitted before the next call to Map.
+    void MarkUsed(GLintptr offset, GLsizeiptr size);
+
+    /// Returns the range of the buffer, as [begin, end), invalidated by the last call to Map.
+    std::pair<GLintptr, GLintptr> GetInvalidatedRange() const {
+        return invalidated_range;
+    }
+
 private:
+    static constexpr std::size_t NumRegions = 8;
+
+    /// Fences the regions in [begin, end), all the commands using them have been submitted.
+    void FenceRegions(std::size_t begin, std::size_t end);
+
+    /// Waits for the GPU to be done with the regions in [begin, end) before they are overwritten.
+    void WaitRegions(std::size_t begin, std::size_t end);
+
     OGLBuffer gl_buffer;
 
     bool coherent = false;
@@ -42,6 +64,16 @@ private:
     GLintptr mapped_offset = 0;
     GLsizeiptr mapped_size = 0;
     u8* mapped_ptr = nullptr;
+
+    GLsizeiptr region_size = 0;
+    std::array<OGLSync, NumRegions> region_fences;
+    /// Regions read by commands that were submitted after the region was fenced
+    std::array<bool, NumRegions> used_regions{};
+    /// First region written in the current pass that hasn't been fenced yet
+    std::size_t unfenced_region = 0;
+    /// End of the regions entered in the current pass
+    std::size_t entered_regions = 0;
+    std::pair<GLintptr, GLintptr> invalidated_range{};
 };
 
 } // namespace OpenGL
@@ -0,0 +1,121 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+#include "video_core/textures/convert.h"
+
+namespace OpenGL {
+
+using Tegra::Texture::GuestConversion;
+
+namespace {
+
+constexpr u32 WorkGroupSize = 64;
+/// Upper bound of the work groups of a dispatch, the invocations loop over the rest of the words
+constexpr u32 MaxWorkGroups = 65535;
+
+/// Conversion of a guest word to the host one and back, value is the word to convert
+struct WordConversion {
+    GuestConversion conversion;
+    const char* decode;
+    const char* encode;
+};
+
+// Mirrors the conversions of Tegra::Texture::ConvertFromGuestToHost and ConvertFromHostToGuest
+constexpr std::array<WordConversion, 1> word_conversions{{
+    {GuestConversion::SwapS8Z24, "(value << 8) | (value >> 24)", "(value >> 8) | (value << 24)"},
+}};
+
+constexpr char conversion_shader[] = R"(
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 0) buffer Texels {
+    uint texels[];
+};
+
+layout (location = 0) uniform uint num_words;
+
+void main() {
+    uint stride = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
+    for (uint i = gl_GlobalInvocationID.x; i < num_words; i += stride) {
+        uint value = texels[i];
+        texels[i] = CONVERT(value);
+    }
+}
+)";
+
+OGLProgram BuildProgram(const char* convert) {
+    const std::string source = std::string("#version 430 core\n#define CONVERT(value) ") +
+                               convert + '\n' + conversion_shader;
+    OGLShader shader;
+    shader.Create(source.c_str(), GL_COMPUTE_SHADER);
+    OGLProgram program;
+    program.Create(false, false, shader.handle);
+    return program;
+}
+
+std::size_t GetConversionIndex(GuestConversion conversion) {
+    const auto it = std::find_if(
+        word_conversions.begin(), word_conversions.end(),
+        [conversion](const WordConversion& entry) { return entry.conversion == conversion; });
+    ASSERT_MSG(it != word_conversions.end(), "Conversion {} has no compute shader",
+               static_cast<u32>(conversion));
+    return static_cast<std::size_t>(it - word_conversions.begin());
+}
+
+} // Anonymous namespace
+
+TextureDecoder::TextureDecoder() {
+    programs.reserve(word_conversions.size());
+    for (const WordConversion& entry : word_conversions) {
+        programs.push_back({BuildProgram(entry.decode), BuildProgram(entry.encode)});
+    }
+}
+
+TextureDecoder::~TextureDecoder() = default;
+
+bool TextureDecoder::IsCompatible(GuestConversion conversion) {
+    if (!Tegra::Texture::IsWordConversion(conversion)) {
+        return false;
+    }
+    return std::any_of(
+        word_conversions.begin(), word_conversions.end(),
+        [conversion](const WordConversion& entry) { return entry.conversion == conversion; });
+}
+
+void TextureDecoder::Decode(GuestConversion conversion, GLuint buffer, std::size_t size) {
+    Dispatch(programs[GetConversionIndex(conversion)].decode, buffer, size);
+}
+
+void TextureDecoder::Encode(GuestConversion conversion, GLuint buffer, std::size_t size) {
+    Dispatch(programs[GetConversionIndex(conversion)].encode, buffer, size);
+}
+
+void TextureDecoder::Dispatch(const OGLProgram& program, GLuint buffer, std::size_t size) {
+    ASSERT(size % sizeof(u32) == 0);
+    const auto num_words = static_cast<u32>(size / sizeof(u32));
+    const u32 num_groups =
+        std::clamp((num_words + WorkGroupSize - 1) / WorkGroupSize, 1U, MaxWorkGroups);
+    glProgramUniform1ui(program.handle, 0, num_words);
+
+    OpenGLState state = OpenGLState::GetCurState();
+    const GLuint previous_program = state.draw.shader_program;
+    state.draw.shader_program = program.handle;
+    state.ApplyShaderProgram();
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+    glDispatchCompute(num_groups, 1, 1);
+
+    state.draw.shader_program = previous_program;
+    state.ApplyShaderProgram();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,50 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Tegra::Texture {
+enum class GuestConversion;
+}
+
+namespace OpenGL {
+
+/**
+ * Converts the texels of guest formats the host can't sample in place in a buffer with compute
+ * shaders, so surfaces swizzled on the GPU don't come back to the CPU to be converted.
+ */
+class TextureDecoder final {
+public:
+    TextureDecoder();
+    ~TextureDecoder();
+
+    /// Returns true if the conversion can be applied by a compute shader
+    static bool IsCompatible(Tegra::Texture::GuestConversion conversion);
+
+    /// Converts the guest texels in the first size bytes of the buffer to the host format
+    void Decode(Tegra::Texture::GuestConversion conversion, GLuint buffer, std::size_t size);
+
+    /// Converts the host texels in the first size bytes of the buffer back to the guest format
+    void Encode(Tegra::Texture::GuestConversion conversion, GLuint buffer, std::size_t size);
+
+private:
+    struct ConversionPrograms {
+        OGLProgram decode;
+        OGLProgram encode;
+    };
+
+    void Dispatch(const OGLProgram& program, GLuint buffer, std::size_t size);
+
+    /// Programs of every compatible conversion, in the order of the conversion table
+    std::vector<ConversionPrograms> programs;
+};
+
+} // namespace OpenGL
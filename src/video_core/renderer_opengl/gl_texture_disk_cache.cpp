@@ -0,0 +1,370 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+
+#include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/lz4_compression.h"
+
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/settings.h"
+
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_texture_disk_cache.h"
+
+namespace OpenGL {
+
+// The file is a FileHeader followed by its entries, each one stored as an EntryHeader and the LZ4
+// compressed levels of a surface. Entries are appended to the file as surfaces are decoded, so an
+// interrupted write can only leave a truncated entry at the end of the file.
+constexpr u32 FileMagic = Common::MakeMagic('Y', 'T', 'E', 'X');
+
+// Bump when the texels written by the decoders change, the entries of other versions are dropped
+constexpr u32 FileVersion = 1;
+
+/// Bytes of the pending entries that make them be written before the next one is queued
+constexpr std::size_t MaxPendingSize = 64 * 1024 * 1024;
+
+/// Entries aren't added to files of this size, the least used textures are the last ones added
+constexpr u64 MaxFileSize = u64{2} * 1024 * 1024 * 1024;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+static_assert(sizeof(FileHeader) == 8, "FileHeader has incorrect size.");
+
+struct EntryHeader {
+    u64 key;
+    u32 uncompressed_size;
+    u32 compressed_size;
+    // Hash of the compressed entry
+    u64 checksum;
+};
+static_assert(sizeof(EntryHeader) == 24, "EntryHeader has incorrect size.");
+
+namespace {
+
+/// Parameters of a surface its decoded texels depend on, besides the guest data
+struct KeyParams {
+    u32 pixel_format;
+    u32 target;
+    u32 width;
+    u32 height;
+    u32 depth;
+    u32 block_width;
+    u32 block_height;
+    u32 block_depth;
+    u32 tile_width_spacing;
+    u32 max_mip_level;
+    u32 is_layered;
+    u32 reserved;
+    u64 memory_size;
+};
+static_assert(sizeof(KeyParams) == 56, "KeyParams has incorrect size.");
+
+/// Hashes a compressed entry. The checksum is stored in the file, so it must not change with the
+/// hash used by the in-memory caches.
+u64 ComputeChecksum(const u8* compressed, std::size_t size) {
+    return Common::CityHash64(reinterpret_cast<const char*>(compressed), size);
+}
+
+} // Anonymous namespace
+
+TextureDiskCacheOpenGL::TextureDiskCacheOpenGL(Core::System& system) : system{system} {}
+
+TextureDiskCacheOpenGL::~TextureDiskCacheOpenGL() {
+    SavePendingEntries();
+}
+
+void TextureDiskCacheOpenGL::Load() {
+    // Skip games without title id
+    const bool has_title_id = system.CurrentProcess()->GetTitleID() != 0;
+    if (!Settings::values.use_disk_texture_cache || !has_title_id) {
+        return;
+    }
+    tried_to_load = true;
+
+    if (!FileUtil::Exists(GetPath())) {
+        LOG_INFO(Render_OpenGL, "No texture cache found for game with title id={:016X}",
+                 system.CurrentProcess()->GetTitleID());
+        return;
+    }
+    if (!MapFile()) {
+        LOG_INFO(Render_OpenGL, "Texture cache is unusable - removing");
+        Invalidate();
+        return;
+    }
+    LOG_INFO(Render_OpenGL, "Loaded {} decoded textures from the texture cache", entries.size());
+}
+
+std::optional<u64> TextureDiskCacheOpenGL::GetKey(const SurfaceParams& params) const {
+    if (!IsUsable() || params.host_ptr == nullptr || !params.is_tiled) {
+        return {};
+    }
+    if (params.GetGuestConversion() != Tegra::Texture::GuestConversion::DecodeASTC) {
+        // The other textures are uploaded as they are or converted faster than they are read
+        return {};
+    }
+
+    KeyParams key_params{};
+    key_params.pixel_format = static_cast<u32>(params.pixel_format);
+    key_params.target = static_cast<u32>(params.target);
+    key_params.width = params.width;
+    key_params.height = params.height;
+    key_params.depth = params.depth;
+    key_params.block_width = params.block_width;
+    key_params.block_height = params.block_height;
+    key_params.block_depth = params.block_depth;
+    key_params.tile_width_spacing = params.tile_width_spacing;
+    key_params.max_mip_level = params.max_mip_level;
+    key_params.is_layered = params.is_layered ? 1 : 0;
+    key_params.memory_size = params.MemorySize();
+
+    const u64 seed =
+        Common::CityHash64(reinterpret_cast<const char*>(&key_params), sizeof(key_params));
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(params.host_ptr),
+                                      key_params.memory_size, seed);
+}
+
+bool TextureDiskCacheOpenGL::Read(u64 key, u32 num_levels, std::vector<std::vector<u8>>& levels) {
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    const u8* const entry = GetEntry(it->second);
+    if (entry == nullptr) {
+        return false;
+    }
+    EntryHeader header;
+    std::memcpy(&header, entry, sizeof(header));
+    const u8* const compressed = entry + sizeof(header);
+
+    // The entry is only checked once a surface uses it, corrupted ones are decoded again
+    std::vector<u8> uncompressed(header.uncompressed_size);
+    if (ComputeChecksum(compressed, header.compressed_size) != header.checksum ||
+        !Common::Compression::DecompressDataLZ4(compressed, header.compressed_size,
+                                                uncompressed.data(), uncompressed.size())) {
+        LOG_WARNING(Render_OpenGL, "Discarding corrupted texture cache entry {:016X}", key);
+        entries.erase(it);
+        return false;
+    }
+
+    // Levels are stored as their count, the size of each one and their texels
+    u32 stored_levels;
+    std::memcpy(&stored_levels, uncompressed.data(), sizeof(stored_levels));
+    const std::size_t sizes_offset = sizeof(u32);
+    std::size_t data_offset = sizes_offset + num_levels * sizeof(u64);
+    if (stored_levels != num_levels || uncompressed.size() < data_offset) {
+        entries.erase(it);
+        return false;
+    }
+    if (levels.size() < num_levels) {
+        levels.resize(num_levels);
+    }
+    for (u32 level = 0; level < num_levels; ++level) {
+        u64 level_size;
+        std::memcpy(&level_size, uncompressed.data() + sizes_offset + level * sizeof(u64),
+                    sizeof(level_size));
+        if (uncompressed.size() - data_offset < level_size) {
+            entries.erase(it);
+            return false;
+        }
+        levels[level].resize(level_size);
+        std::memcpy(levels[level].data(), uncompressed.data() + data_offset, level_size);
+        data_offset += level_size;
+    }
+    return true;
+}
+
+void TextureDiskCacheOpenGL::Write(u64 key, u32 num_levels,
+                                   const std::vector<std::vector<u8>>& levels) {
+    if (!IsUsable() || entries.find(key) != entries.end()) {
+        return;
+    }
+    ASSERT(levels.size() >= num_levels);
+
+    std::vector<u8> uncompressed(sizeof(u32) + num_levels * sizeof(u64));
+    std::memcpy(uncompressed.data(), &num_levels, sizeof(num_levels));
+    for (u32 level = 0; level < num_levels; ++level) {
+        const u64 level_size = levels[level].size();
+        std::memcpy(uncompressed.data() + sizeof(u32) + level * sizeof(u64), &level_size,
+                    sizeof(level_size));
+        uncompressed.insert(uncompressed.end(), levels[level].begin(), levels[level].end());
+    }
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataLZ4(uncompressed.data(), uncompressed.size());
+    if (compressed.empty()) {
+        return;
+    }
+
+    const std::size_t entry_size = sizeof(EntryHeader) + compressed.size();
+    if (file_size + entry_size > MaxFileSize) {
+        return;
+    }
+    if (pending.size() + entry_size > MaxPendingSize) {
+        SavePendingEntries();
+    }
+
+    EntryHeader header{};
+    header.key = key;
+    header.uncompressed_size = static_cast<u32>(uncompressed.size());
+    header.compressed_size = static_cast<u32>(compressed.size());
+    header.checksum = ComputeChecksum(compressed.data(), compressed.size());
+
+    const std::size_t offset = pending.size();
+    pending.resize(offset + entry_size);
+    pending_accounting.Resize(pending.capacity());
+    std::memcpy(pending.data() + offset, &header, sizeof(header));
+    std::memcpy(pending.data() + offset + sizeof(header), compressed.data(), compressed.size());
+    entries.insert({key, {offset, true}});
+    file_size += entry_size;
+}
+
+void TextureDiskCacheOpenGL::SavePendingEntries() {
+    if (pending.empty()) {
+        return;
+    }
+
+    const std::string path = GetPath();
+    if (!FileUtil::Exists(path) && !FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create texture cache directory for path={}", path);
+        return;
+    }
+    FileUtil::IOFile file(path, "ab");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_OpenGL, "Failed to open texture cache in path={}", path);
+        return;
+    }
+    u64 pending_offset = file.GetSize();
+    if (pending_offset == 0) {
+        const FileHeader header{FileMagic, FileVersion};
+        if (file.WriteObject(header) != 1) {
+            LOG_ERROR(Render_OpenGL, "Failed to write texture cache header in path={}", path);
+            return;
+        }
+        pending_offset = sizeof(header);
+    }
+    if (file.WriteBytes(pending.data(), pending.size()) != pending.size()) {
+        LOG_ERROR(Render_OpenGL, "Failed to write texture cache entries in path={}", path);
+        return;
+    }
+    file.Close();
+
+    pending.clear();
+    pending.shrink_to_fit();
+    pending_accounting.Resize(0);
+
+    // The written entries are read from the file from now on, through a new mapping of it
+    for (auto& [key, location] : entries) {
+        if (location.is_pending) {
+            location = {static_cast<std::size_t>(pending_offset) + location.offset, false};
+        }
+    }
+    mapping = std::make_unique<FileUtil::MappedFile>(path);
+    file_size = mapping->Size();
+}
+
+bool TextureDiskCacheOpenGL::MapFile() {
+    mapping = std::make_unique<FileUtil::MappedFile>(GetPath());
+    if (!mapping->IsOpen() || mapping->Size() < sizeof(FileHeader)) {
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, mapping->Data(), sizeof(header));
+    if (header.magic != FileMagic || header.version != FileVersion) {
+        LOG_INFO(Render_OpenGL, "Texture cache is from another version of the emulator");
+        return false;
+    }
+
+    // Only the headers are read, the pages of the entries are touched once a surface uses them
+    const std::size_t size = mapping->Size();
+    std::size_t offset = sizeof(header);
+    while (offset < size) {
+        EntryHeader entry_header;
+        if (size - offset < sizeof(entry_header)) {
+            break;
+        }
+        std::memcpy(&entry_header, mapping->Data() + offset, sizeof(entry_header));
+        if (size - offset - sizeof(entry_header) < entry_header.compressed_size) {
+            break;
+        }
+        entries.insert({entry_header.key, {offset, false}});
+        offset += sizeof(entry_header) + entry_header.compressed_size;
+    }
+    mapping->Advise(0, size, FileUtil::MappedFile::AccessHint::Random);
+
+    if (offset != size) {
+        // The last write was interrupted, keep the entries stored before it
+        LOG_WARNING(Render_OpenGL, "Discarding truncated texture cache entry at offset {}", offset);
+        mapping.reset();
+        FileUtil::IOFile file(GetPath(), "r+b");
+        if (!file.IsOpen() || !file.Resize(offset)) {
+            entries.clear();
+            return false;
+        }
+        file.Close();
+        mapping = std::make_unique<FileUtil::MappedFile>(GetPath());
+        if (!mapping->IsOpen() || mapping->Size() != offset) {
+            entries.clear();
+            return false;
+        }
+    }
+    file_size = offset;
+    return true;
+}
+
+const u8* TextureDiskCacheOpenGL::GetEntry(const EntryLocation& location) const {
+    const u8* data = nullptr;
+    std::size_t size = 0;
+    if (location.is_pending) {
+        data = pending.data();
+        size = pending.size();
+    } else if (mapping != nullptr) {
+        data = mapping->Data();
+        size = mapping->Size();
+    }
+    if (location.offset > size || size - location.offset < sizeof(EntryHeader)) {
+        return nullptr;
+    }
+    EntryHeader header;
+    std::memcpy(&header, data + location.offset, sizeof(header));
+    if (size - location.offset - sizeof(header) < header.compressed_size) {
+        return nullptr;
+    }
+    return data + location.offset;
+}
+
+void TextureDiskCacheOpenGL::Invalidate() {
+    mapping.reset();
+    entries.clear();
+    pending.clear();
+    pending_accounting.Resize(0);
+    file_size = 0;
+    if (!FileUtil::Delete(GetPath())) {
+        LOG_ERROR(Render_OpenGL, "Failed to invalidate texture cache file={}", GetPath());
+    }
+}
+
+bool TextureDiskCacheOpenGL::IsUsable() const {
+    return tried_to_load && Settings::values.use_disk_texture_cache;
+}
+
+std::string TextureDiskCacheOpenGL::GetPath() const {
+    const u64 title_id = system.CurrentProcess()->GetTitleID();
+    return FileUtil::SanitizePath(fmt::format("{}" DIR_SEP "{:016X}.bin", GetBaseDir(), title_id));
+}
+
+std::string TextureDiskCacheOpenGL::GetBaseDir() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "texture" DIR_SEP "opengl";
+}
+
+} // namespace OpenGL
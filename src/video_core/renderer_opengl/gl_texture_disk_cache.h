@@ -0,0 +1,97 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+
+namespace Core {
+class System;
+}
+
+namespace FileUtil {
+class MappedFile;
+}
+
+namespace OpenGL {
+
+struct SurfaceParams;
+
+/**
+ * Per title cache of the textures decoded on the CPU, so later runs upload the decoded texels
+ * instead of decoding the guest data again. Entries are keyed by a hash of the guest data and of
+ * the parameters of the surface, the file is mapped into memory and an entry is only decompressed
+ * when a surface uses it.
+ */
+class TextureDiskCacheOpenGL final {
+public:
+    explicit TextureDiskCacheOpenGL(Core::System& system);
+    ~TextureDiskCacheOpenGL();
+
+    /// Opens the current title's cache. Invalidates it when it's from another version.
+    void Load();
+
+    /// Returns the key of the decoded levels of the surface, empty if they aren't cached
+    std::optional<u64> GetKey(const SurfaceParams& params) const;
+
+    /// Copies the decoded levels of the entry to the buffers. Returns false if there is none.
+    bool Read(u64 key, u32 num_levels, std::vector<std::vector<u8>>& levels);
+
+    /// Queues the decoded levels of a surface to be appended to the cache
+    void Write(u64 key, u32 num_levels, const std::vector<std::vector<u8>>& levels);
+
+    /// Appends the queued entries to the cache file
+    void SavePendingEntries();
+
+private:
+    /// Location of an entry, in the mapped file or in the entries waiting to be written
+    struct EntryLocation {
+        std::size_t offset;
+        bool is_pending;
+    };
+
+    /// Maps the cache file and indexes its entries. Returns false if it's unusable.
+    bool MapFile();
+
+    /// Returns the entry at the location, its header included, or nullptr if it's out of bounds
+    const u8* GetEntry(const EntryLocation& location) const;
+
+    /// Removes the cache file and every entry
+    void Invalidate();
+
+    /// Returns if the cache can be used
+    bool IsUsable() const;
+
+    /// Gets current game's cache file path
+    std::string GetPath() const;
+
+    /// Get user's texture cache directory path
+    static std::string GetBaseDir();
+
+    // Core system
+    Core::System& system;
+    // Current title's cache file, null when it's empty or doesn't exist
+    std::unique_ptr<FileUtil::MappedFile> mapping;
+    // Entries of the mapped file and of the pending ones
+    std::unordered_map<u64, EntryLocation> entries;
+    // Compressed entries waiting to be appended to the file
+    std::vector<u8> pending;
+    Common::MemoryAccounting::Allocation pending_accounting{
+        Common::MemoryAccounting::Category::TextureDiskCache};
+    // Bytes the file will take once the pending entries are written
+    u64 file_size = 0;
+
+    // The cache has been loaded at boot
+    bool tried_to_load{};
+};
+
+} // namespace OpenGL
@@ -0,0 +1,212 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_texture_swizzler.h"
+#include "video_core/surface.h"
+#include "video_core/textures/convert.h"
+
+namespace OpenGL {
+
+using VideoCore::Surface::GetBytesPerPixel;
+using VideoCore::Surface::GetDefaultBlockHeight;
+using VideoCore::Surface::GetDefaultBlockWidth;
+using Tegra::Texture::GuestConversion;
+
+namespace {
+
+constexpr u32 GobSizeX = 64;
+constexpr u32 GobSizeY = 8;
+
+constexpr u32 WorkGroupSizeX = 16;
+constexpr u32 WorkGroupSizeY = 8;
+
+// Every invocation moves a 32-bit word. Sectors of 16 bytes are contiguous in both layouts, so
+// words never straddle two sectors.
+constexpr char swizzle_shader[] = R"(
+#version 430 core
+
+layout (local_size_x = 16, local_size_y = 8) in;
+
+layout (std430, binding = 0) buffer SwizzledBuffer {
+    uint swizzled[];
+};
+
+layout (std430, binding = 1) buffer LinearBuffer {
+    uint linear[];
+};
+
+// Row size in words, height and depth of the level
+layout (location = 0) uniform uvec3 size;
+// Blocks on the x and y axes and GOBs per block on the y and z axes
+layout (location = 1) uniform uvec4 blocks;
+// Offset of the level, swizzled layer stride and pitch linear layer stride in words
+layout (location = 2) uniform uvec3 strides;
+layout (location = 3) uniform uint unswizzle;
+
+void main() {
+    uvec3 pos = gl_GlobalInvocationID;
+    if (pos.x >= size.x || pos.y >= size.y) {
+        return;
+    }
+    uint layer = pos.z / size.z;
+    uint z = pos.z % size.z;
+    uint x = pos.x * 4;
+    uint y = pos.y;
+
+    uint block_rows = 8 * blocks.z;
+    uint block_size = 512 * blocks.z * blocks.w;
+    uint block = ((z / blocks.w) * blocks.y + y / block_rows) * blocks.x + x / 64;
+    uint offset = block * block_size + (z % blocks.w) * 512 * blocks.z +
+                  ((y % block_rows) / 8) * 512 + ((x % 64) / 32) * 256 + ((y % 8) / 2) * 64 +
+                  ((x % 32) / 16) * 32 + (y % 2) * 16 + (x % 16);
+
+    uint swizzled_index = strides.x + layer * strides.y + offset / 4;
+    uint linear_index = layer * strides.z + (z * size.y + y) * size.x + pos.x;
+    if (unswizzle != 0) {
+        linear[linear_index] = swizzled[swizzled_index];
+    } else {
+        swizzled[swizzled_index] = linear[linear_index];
+    }
+}
+)";
+
+} // Anonymous namespace
+
+TextureSwizzler::TextureSwizzler() {
+    OGLShader shader;
+    shader.Create(swizzle_shader, GL_COMPUTE_SHADER);
+    program.Create(false, false, shader.handle);
+    swizzled_buffer.Create();
+    linear_buffer.Create();
+}
+
+TextureSwizzler::~TextureSwizzler() = default;
+
+bool TextureSwizzler::IsCompatible(const SurfaceParams& params) {
+    const PixelFormat format = params.pixel_format;
+    if (!params.is_tiled || params.block_width > 1) {
+        return false;
+    }
+    const GuestConversion conversion = params.GetGuestConversion();
+    if (conversion != GuestConversion::None && !TextureDecoder::IsCompatible(conversion)) {
+        // The other conversions are applied on the CPU after unswizzling
+        return false;
+    }
+    if (GetDefaultBlockWidth(format) != 1 || GetDefaultBlockHeight(format) != 1) {
+        // Compressed formats are swizzled per tile
+        return false;
+    }
+    const u32 bpp = GetBytesPerPixel(format);
+    if (bpp == 0 || bpp > 16 || (bpp & (bpp - 1)) != 0) {
+        return false;
+    }
+    if (params.LayerMemorySize() % 4 != 0) {
+        return false;
+    }
+    for (u32 level = 0; level < params.max_mip_level; ++level) {
+        if ((params.MipWidth(level) * bpp) % 4 != 0 || params.GetMipmapLevelOffset(level) % 4 != 0 ||
+            params.LayerSizeGL(level) % 4 != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TextureSwizzler::UploadSwizzled(const SurfaceParams& params) {
+    glNamedBufferData(swizzled_buffer.handle, static_cast<GLsizeiptr>(params.MemorySize()),
+                      params.host_ptr, GL_STREAM_COPY);
+}
+
+void TextureSwizzler::DownloadSwizzled(const SurfaceParams& params) {
+    // Make sure the writes of the swizzle are visible to the download
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glGetNamedBufferSubData(swizzled_buffer.handle, 0,
+                            static_cast<GLsizeiptr>(params.MemorySize()), params.host_ptr);
+}
+
+void TextureSwizzler::Unswizzle(const SurfaceParams& params, u32 mip_level) {
+    Dispatch(params, mip_level, true);
+    const GuestConversion conversion = params.GetGuestConversion();
+    if (conversion != GuestConversion::None) {
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        decoder.Decode(conversion, linear_buffer.handle, params.GetMipmapSizeGL(mip_level));
+    }
+    // The linear buffer is read as a pixel unpack buffer afterwards
+    glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+}
+
+void TextureSwizzler::Swizzle(const SurfaceParams& params, u32 mip_level) {
+    const GuestConversion conversion = params.GetGuestConversion();
+    if (conversion != GuestConversion::None) {
+        decoder.Encode(conversion, linear_buffer.handle, params.GetMipmapSizeGL(mip_level));
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    Dispatch(params, mip_level, false);
+}
+
+GLuint TextureSwizzler::GetLinearBuffer(std::size_t size) {
+    if (size > linear_buffer_size) {
+        glNamedBufferData(linear_buffer.handle, static_cast<GLsizeiptr>(size), nullptr,
+                          GL_STREAM_COPY);
+        linear_buffer_size = size;
+    }
+    return linear_buffer.handle;
+}
+
+void TextureSwizzler::Dispatch(const SurfaceParams& params, u32 mip_level, bool unswizzle) {
+    const u32 bpp = GetBytesPerPixel(params.pixel_format);
+    const u32 width = params.MipWidth(mip_level);
+    const u32 height = params.MipHeight(mip_level);
+    const u32 block_height = params.MipBlockHeight(mip_level);
+    const u32 block_depth = params.MipBlockDepth(mip_level);
+
+    // Mirrors the layout SwizzleFunc hands to the CPU swizzler
+    u32 depth = params.MipDepth(mip_level);
+    u32 layers = 1;
+    std::size_t swizzled_layer_stride = 0;
+    std::size_t linear_layer_stride = 0;
+    if (params.is_layered) {
+        depth = 1;
+        layers = params.depth;
+        swizzled_layer_stride = params.LayerMemorySize();
+        linear_layer_stride = params.LayerSizeGL(mip_level);
+    } else if (params.target == SurfaceTarget::Texture2D) {
+        depth = 1;
+    }
+
+    const u32 row_words = width * bpp / 4;
+    const u32 aligned_width = Common::AlignUp(width, GobSizeX / bpp * params.tile_width_spacing);
+    const u32 blocks_on_x = aligned_width * bpp / GobSizeX;
+    const u32 block_rows = GobSizeY * block_height;
+    const u32 blocks_on_y = (height + block_rows - 1) / block_rows;
+
+    GetLinearBuffer(params.GetMipmapSizeGL(mip_level));
+
+    glProgramUniform3ui(program.handle, 0, row_words, height, depth);
+    glProgramUniform4ui(program.handle, 1, blocks_on_x, blocks_on_y, block_height, block_depth);
+    glProgramUniform3ui(program.handle, 2,
+                        static_cast<GLuint>(params.GetMipmapLevelOffset(mip_level) / 4),
+                        static_cast<GLuint>(swizzled_layer_stride / 4),
+                        static_cast<GLuint>(linear_layer_stride / 4));
+    glProgramUniform1ui(program.handle, 3, unswizzle ? 1 : 0);
+
+    OpenGLState state = OpenGLState::GetCurState();
+    const GLuint previous_program = state.draw.shader_program;
+    state.draw.shader_program = program.handle;
+    state.ApplyShaderProgram();
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, swizzled_buffer.handle);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, linear_buffer.handle);
+    glDispatchCompute((row_words + WorkGroupSizeX - 1) / WorkGroupSizeX,
+                      (height + WorkGroupSizeY - 1) / WorkGroupSizeY, depth * layers);
+
+    state.draw.shader_program = previous_program;
+    state.ApplyShaderProgram();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,57 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+
+namespace OpenGL {
+
+struct SurfaceParams;
+
+/**
+ * Converts block linear surfaces from and to pitch linear data with a compute shader, so tiled
+ * surfaces can be loaded and flushed without swizzling their contents on the CPU. The texels of
+ * formats the host can't sample are converted in the linear buffer by the texture decoder.
+ */
+class TextureSwizzler final {
+public:
+    TextureSwizzler();
+    ~TextureSwizzler();
+
+    /// Returns true if the layout of the surface can be converted by the compute shader
+    static bool IsCompatible(const SurfaceParams& params);
+
+    /// Uploads the guest memory of the surface to the block linear buffer
+    void UploadSwizzled(const SurfaceParams& params);
+
+    /// Downloads the block linear buffer to the guest memory of the surface
+    void DownloadSwizzled(const SurfaceParams& params);
+
+    /// Converts a level of the uploaded surface to pitch linear data in the linear buffer
+    void Unswizzle(const SurfaceParams& params, u32 mip_level);
+
+    /// Converts the pitch linear data of a level in the linear buffer into the block linear buffer
+    void Swizzle(const SurfaceParams& params, u32 mip_level);
+
+    /// Returns the buffer holding the pitch linear data, resized to hold at least size bytes
+    GLuint GetLinearBuffer(std::size_t size);
+
+private:
+    void Dispatch(const SurfaceParams& params, u32 mip_level, bool unswizzle);
+
+    TextureDecoder decoder;
+    OGLProgram program;
+    OGLBuffer swizzled_buffer;
+    OGLBuffer linear_buffer;
+    std::size_t linear_buffer_size = 0;
+};
+
+} // namespace OpenGL
@@ -5,11 +5,15 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
 #include "common/telemetry.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/frontend/emu_window.h"
@@ -18,13 +22,15 @@
 #include "core/perf_stats.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
-#include "core/tracer/recorder.h"
 #include "video_core/morton.h"
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 
 namespace OpenGL {
 
+MICROPROFILE_DEFINE_GPU(OpenGL_GpuPresent, "Present", MP_RGB(192, 192, 128));
+
 static const char vertex_shader[] = R"(
 #version 150 core
 
@@ -97,22 +103,58 @@ static std::array<GLfloat, 3 * 2> MakeOrthographicMatrix(const float width, cons
     return matrix;
 }
 
+/**
+ * Builds the rectangle of the screen, the texture coordinates are those of the top left and
+ * bottom right corners.
+ */
+static std::array<ScreenRectVertex, 4> MakeScreenVertices(float x, float y, float w, float h,
+                                                          const Common::Rectangle<float>& tex) {
+    return {{
+        ScreenRectVertex(x, y, tex.left, tex.top),
+        ScreenRectVertex(x + w, y, tex.right, tex.top),
+        ScreenRectVertex(x, y + h, tex.left, tex.bottom),
+        ScreenRectVertex(x + w, y + h, tex.right, tex.bottom),
+    }};
+}
+
 RendererOpenGL::RendererOpenGL(Core::Frontend::EmuWindow& emu_window, Core::System& system)
     : VideoCore::RendererBase{emu_window}, emu_window{emu_window}, system{system} {}
 
-RendererOpenGL::~RendererOpenGL() = default;
+RendererOpenGL::~RendererOpenGL() {
+    if (!present_thread.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{present_mutex};
+        stop_presenting = true;
+    }
+    present_cv.notify_all();
+    present_thread.join();
+}
 
 /// Swap buffers (render frame)
 void RendererOpenGL::SwapBuffers(
-    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) {
+    std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+    const Tegra::FramebufferOverlays& overlays, const std::function<void()>& release_callback) {
 
-    system.GetPerfStats().EndSystemFrame();
+    auto& perf_stats = system.GetPerfStats();
+    perf_stats.EndSystemFrame();
+
+    std::optional<u64> frame_number;
+    if (framebuffer) {
+        frame_number = perf_stats.RecordFrameEvent(Core::FrameEvent::SwapBegin);
+    }
 
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
 
+    // Presentation does not belong to any of the guest's render passes
+    gpu_profiler->EndRenderPass();
+
     if (framebuffer) {
+        MICROPROFILE_SCOPEGPU(OpenGL_GpuPresent);
+
         // If framebuffer is provided, reload it from memory to a texture
         if (screen_info.texture.width != (GLsizei)framebuffer->get().width ||
             screen_info.texture.height != (GLsizei)framebuffer->get().height ||
@@ -125,30 +167,58 @@ void RendererOpenGL::SwapBuffers(
 
         // Load the framebuffer from memory, draw it to the screen, and swap buffers
         LoadFBToScreenInfo(*framebuffer);
+        LoadOverlays(overlays);
+        ComposeOverlays();
+        if (frame_recorder) {
+            frame_recorder->Record(screen_info.display_texture);
+        }
 
-        if (renderer_settings.screenshot_requested)
-            CaptureScreenshot();
+        if (command_context) {
+            // Presentation runs in its own thread, don't wait for the host's vsync here
+            QueueFrame(*frame_number);
+        } else {
+            // The previous screenshot is still being read back while it is busy
+            if (renderer_settings.screenshot_requested && !screenshot_capture.IsBusy())
+                CaptureScreenshot();
 
-        DrawScreen(render_window.GetFramebufferLayout());
+            DrawScreen(render_window.GetFramebufferLayout());
 
-        render_window.SwapBuffers();
+            render_window.SwapBuffers();
+            perf_stats.RecordFrameEvent(Core::FrameEvent::Present, *frame_number);
+        }
+    }
+
+    // Commands reading the buffers were issued before any later guest rendering and the CPU
+    // copies are done, hand them back without waiting for the frame limiter
+    if (release_callback) {
+        release_callback();
+    }
+
+    if (!command_context) {
+        screenshot_capture.Poll();
     }
 
     render_window.PollEvents();
 
+    const auto limiter_start = Core::PerfStats::Clock::now();
     system.FrameLimiter().DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
-    system.GetPerfStats().BeginSystemFrame();
+    perf_stats.AddFrameLimiterTime(Core::PerfStats::Clock::now() - limiter_start);
+    perf_stats.BeginSystemFrame();
+    if (frame_number) {
+        perf_stats.RecordFrameEvent(Core::FrameEvent::SwapEnd, *frame_number);
+    }
 
     // Restore the rasterizer state
     prev_state.Apply();
+
+    rasterizer->TickFrame();
+    gpu_profiler->TickFrame();
 }
 
 /**
  * Loads framebuffer from emulated memory into the active OpenGL texture.
  */
 void RendererOpenGL::LoadFBToScreenInfo(const Tegra::FramebufferConfig& framebuffer) {
-    const u32 bytes_per_pixel{Tegra::FramebufferConfig::BytesPerPixel(framebuffer.pixel_format)};
-    const u64 size_in_bytes{framebuffer.stride * framebuffer.height * bytes_per_pixel};
     const VAddr framebuffer_addr{framebuffer.address + framebuffer.offset};
 
     // Framebuffer orientation handling
@@ -163,27 +233,180 @@ void RendererOpenGL::LoadFBToScreenInfo(const Tegra::FramebufferConfig& framebuf
         // Reset the screen info's display texture to its own permanent texture
         screen_info.display_texture = screen_info.texture.resource.handle;
 
-        rasterizer->FlushRegion(ToCacheAddr(Memory::GetPointer(framebuffer_addr)), size_in_bytes);
+        LoadFBToTexture(framebuffer, screen_info.texture);
+    }
+}
+
+void RendererOpenGL::LoadFBToTexture(const Tegra::FramebufferConfig& framebuffer,
+                                     const TextureInfo& texture) {
+    const u32 bytes_per_pixel{Tegra::FramebufferConfig::BytesPerPixel(framebuffer.pixel_format)};
+    const u64 size_in_bytes{framebuffer.stride * framebuffer.height * bytes_per_pixel};
+    const VAddr framebuffer_addr{framebuffer.address + framebuffer.offset};
+
+    rasterizer->FlushRegion(ToCacheAddr(Memory::GetPointer(framebuffer_addr)), size_in_bytes);
+
+    // Deswizzle straight into a mapped pixel buffer when possible, the upload is then
+    // asynchronous and the framebuffer is only copied once
+    constexpr u32 linear_bpp = 4;
+    const auto linear_size =
+        static_cast<std::size_t>(framebuffer.stride * framebuffer.height * linear_bpp);
+    const bool use_upload_buffer = GLAD_GL_ARB_buffer_storage;
+    if (!use_upload_buffer && gl_framebuffer_data.size() < linear_size) {
+        // Overlays may be larger than the primary framebuffer
+        gl_framebuffer_data.resize(linear_size);
+    }
+    u8* const linear_data =
+        use_upload_buffer ? ReserveFramebufferUpload(linear_size) : gl_framebuffer_data.data();
+    VideoCore::MortonCopyPixels128(VideoCore::MortonSwizzleMode::MortonToLinear, framebuffer.width,
+                                   framebuffer.height, bytes_per_pixel, linear_bpp,
+                                   Memory::GetPointer(framebuffer_addr), linear_data);
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(framebuffer.stride));
+    const void* pixels = gl_framebuffer_data.data();
+    if (use_upload_buffer) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, framebuffer_upload_buffer.handle);
+        pixels =
+            reinterpret_cast<const void*>(framebuffer_upload_slot * framebuffer_upload_slot_size);
+    }
+
+    // Update existing texture
+    // TODO: Test what happens on hardware when you change the framebuffer dimensions so that
+    //       they differ from the LCD resolution.
+    // TODO: Applications could theoretically crash yuzu here by specifying too large
+    //       framebuffer sizes. We should make sure that this cannot happen.
+    glTextureSubImage2D(texture.resource.handle, 0, 0, 0, framebuffer.width, framebuffer.height,
+                        texture.gl_format, texture.gl_type, pixels);
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    if (use_upload_buffer) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        framebuffer_upload_fences[framebuffer_upload_slot].Create();
+        framebuffer_upload_slot = (framebuffer_upload_slot + 1) % NUM_FRAMEBUFFER_UPLOAD_SLOTS;
+    }
+}
+
+void RendererOpenGL::LoadOverlays(const Tegra::FramebufferOverlays& overlays) {
+    overlay_textures.resize(overlays.size());
+    for (std::size_t i = 0; i < overlays.size(); ++i) {
+        if (!overlays[i]) {
+            // The layer keeps showing its last buffer
+            continue;
+        }
+        const Tegra::FramebufferConfig& overlay = *overlays[i];
+        TextureInfo& texture = overlay_textures[i];
+        if (texture.resource.handle == 0 || texture.width != static_cast<GLsizei>(overlay.width) ||
+            texture.height != static_cast<GLsizei>(overlay.height) ||
+            texture.pixel_format != overlay.pixel_format) {
+            ConfigureFramebufferTexture(texture, overlay);
+        }
+        ASSERT(overlay.stride % 4 == 0);
 
-        constexpr u32 linear_bpp = 4;
-        VideoCore::MortonCopyPixels128(VideoCore::MortonSwizzleMode::MortonToLinear,
-                                       framebuffer.width, framebuffer.height, bytes_per_pixel,
-                                       linear_bpp, Memory::GetPointer(framebuffer_addr),
-                                       gl_framebuffer_data.data());
+        // Overlays are usually small applet layers, they always go through the CPU
+        LoadFBToTexture(overlay, texture);
+    }
+}
+
+void RendererOpenGL::ComposeOverlays() {
+    if (overlay_textures.empty()) {
+        return;
+    }
 
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(framebuffer.stride));
+    const GLuint display_texture = screen_info.display_texture;
+    GLint internal_format, width, height;
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_HEIGHT, &height);
+    if (composition_format != static_cast<GLenum>(internal_format) ||
+        composition_width != width || composition_height != height) {
+        composition_texture.Release();
+        composition_texture.Create(GL_TEXTURE_2D);
+        glTextureStorage2D(composition_texture.handle, 1, internal_format, width, height);
+        composition_framebuffer.Release();
+        composition_framebuffer.Create();
+        glNamedFramebufferTexture(composition_framebuffer.handle, GL_COLOR_ATTACHMENT0,
+                                  composition_texture.handle, 0);
+        composition_format = static_cast<GLenum>(internal_format);
+        composition_width = width;
+        composition_height = height;
+    }
+    glCopyImageSubData(display_texture, GL_TEXTURE_2D, 0, 0, 0, 0, composition_texture.handle,
+                       GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+
+    const GLuint old_draw_fb = state.draw.draw_framebuffer;
+    state.draw.draw_framebuffer = composition_framebuffer.handle;
+    auto& blend = state.blend[0];
+    blend.enabled = true;
+    blend.rgb_equation = GL_FUNC_ADD;
+    blend.a_equation = GL_FUNC_ADD;
+    blend.src_rgb_func = GL_SRC_ALPHA;
+    blend.dst_rgb_func = GL_ONE_MINUS_SRC_ALPHA;
+    blend.src_a_func = GL_ONE;
+    blend.dst_a_func = GL_ONE_MINUS_SRC_ALPHA;
+    state.Apply();
 
-        // Update existing texture
-        // TODO: Test what happens on hardware when you change the framebuffer dimensions so that
-        //       they differ from the LCD resolution.
-        // TODO: Applications could theoretically crash yuzu here by specifying too large
-        //       framebuffer sizes. We should make sure that this cannot happen.
-        glTextureSubImage2D(screen_info.texture.resource.handle, 0, 0, 0, framebuffer.width,
-                            framebuffer.height, screen_info.texture.gl_format,
-                            screen_info.texture.gl_type, gl_framebuffer_data.data());
+    glViewport(0, 0, width, height);
+    const std::array<GLfloat, 3 * 2> ortho_matrix =
+        MakeOrthographicMatrix(static_cast<float>(width), static_cast<float>(height));
+    glUniformMatrix3x2fv(uniform_modelview_matrix, 1, GL_FALSE, ortho_matrix.data());
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(uniform_color_texture, 0);
 
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    // Layers are stretched over the primary framebuffer in its texture space, so the transform of
+    // the primary framebuffer applies to them when the composition is displayed
+    const auto vertices =
+        MakeScreenVertices(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height),
+                           Common::Rectangle<float>{0.0f, 1.0f, 1.0f, 0.0f});
+    glNamedBufferSubData(vertex_buffer.handle, 0, sizeof(vertices), vertices.data());
+    for (const TextureInfo& texture : overlay_textures) {
+        if (texture.resource.handle == 0) {
+            continue;
+        }
+        state.texture_units[0].texture = texture.resource.handle;
+        state.Apply();
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     }
+
+    state.texture_units[0].texture = 0;
+    state.draw.draw_framebuffer = old_draw_fb;
+    blend.enabled = false;
+    state.Apply();
+
+    screen_info.display_texture = composition_texture.handle;
+}
+
+u8* RendererOpenGL::ReserveFramebufferUpload(std::size_t size) {
+    if (size > framebuffer_upload_slot_size) {
+        // The framebuffer grew, wait for the pending uploads before replacing the buffer
+        for (auto& fence : framebuffer_upload_fences) {
+            if (!fence.handle) {
+                continue;
+            }
+            while (glClientWaitSync(fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) ==
+                   GL_TIMEOUT_EXPIRED) {
+            }
+            fence.Release();
+        }
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const auto buffer_size = static_cast<GLsizeiptr>(size * NUM_FRAMEBUFFER_UPLOAD_SLOTS);
+        framebuffer_upload_buffer.Release();
+        framebuffer_upload_buffer.Create();
+        glNamedBufferStorage(framebuffer_upload_buffer.handle, buffer_size, nullptr, flags);
+        framebuffer_upload_pointer = static_cast<u8*>(
+            glMapNamedBufferRange(framebuffer_upload_buffer.handle, 0, buffer_size, flags));
+        framebuffer_upload_slot_size = size;
+        framebuffer_upload_slot = 0;
+    }
+
+    OGLSync& fence = framebuffer_upload_fences[framebuffer_upload_slot];
+    if (fence.handle) {
+        // The slot was used NUM_FRAMEBUFFER_UPLOAD_SLOTS frames ago, this rarely waits
+        while (glClientWaitSync(fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) ==
+               GL_TIMEOUT_EXPIRED) {
+        }
+        fence.Release();
+    }
+    return framebuffer_upload_pointer + framebuffer_upload_slot * framebuffer_upload_slot_size;
 }
 
 /**
@@ -265,7 +488,12 @@ void RendererOpenGL::CreateRasterizer() {
     }
     // Initialize sRGB Usage
     OpenGLState::ClearsRGBUsed();
-    rasterizer = std::make_unique<RasterizerOpenGL>(system, emu_window, screen_info);
+    gpu_profiler = std::make_unique<GLGpuProfiler>();
+    if (Settings::values.record_frames) {
+        frame_recorder =
+            std::make_unique<FrameRecorder>(system, Settings::values.record_frames_zstd_level);
+    }
+    rasterizer = std::make_unique<RasterizerOpenGL>(system, emu_window, screen_info, *gpu_profiler);
 }
 
 void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
@@ -297,8 +525,7 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
     glTextureStorage2D(texture.resource.handle, 1, internal_format, texture.width, texture.height);
 }
 
-void RendererOpenGL::DrawScreenTriangles(const ScreenInfo& screen_info, float x, float y, float w,
-                                         float h) {
+Common::Rectangle<float> RendererOpenGL::GetScreenTexcoords() const {
     const auto& texcoords = screen_info.display_texcoords;
     auto left = texcoords.left;
     auto right = texcoords.right;
@@ -328,12 +555,12 @@ void RendererOpenGL::DrawScreenTriangles(const ScreenInfo& screen_info, float x,
         scale_v = static_cast<f32>(framebuffer_crop_rect.GetHeight()) / screen_info.texture.height;
     }
 
-    std::array<ScreenRectVertex, 4> vertices = {{
-        ScreenRectVertex(x, y, texcoords.top * scale_u, left * scale_v),
-        ScreenRectVertex(x + w, y, texcoords.bottom * scale_u, left * scale_v),
-        ScreenRectVertex(x, y + h, texcoords.top * scale_u, right * scale_v),
-        ScreenRectVertex(x + w, y + h, texcoords.bottom * scale_u, right * scale_v),
-    }};
+    return {texcoords.top * scale_u, left * scale_v, texcoords.bottom * scale_u, right * scale_v};
+}
+
+void RendererOpenGL::DrawScreenTriangles(const ScreenInfo& screen_info, float x, float y, float w,
+                                         float h) {
+    const auto vertices = MakeScreenVertices(x, y, w, h, GetScreenTexcoords());
 
     state.texture_units[0].texture = screen_info.display_texture;
     // Workaround brigthness problems in SMO by enabling sRGB in the final output
@@ -402,17 +629,191 @@ void RendererOpenGL::CaptureScreenshot() {
 
     DrawScreen(layout);
 
-    glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
-                 renderer_settings.screenshot_bits);
+    // The read is queued before the framebuffer is deleted, so it still sees the renderbuffer
+    screenshot_capture.ReadFramebuffer(layout.width, layout.height, GetScreenshotConsumer());
 
     screenshot_framebuffer.Release();
     state.draw.read_framebuffer = old_read_fb;
     state.draw.draw_framebuffer = old_draw_fb;
     state.Apply();
     glDeleteRenderbuffers(1, &renderbuffer);
+}
+
+FrameCapture::Consumer RendererOpenGL::GetScreenshotConsumer() {
+    return [this](std::vector<u8> pixels, u32 width, u32 height) {
+        std::memcpy(renderer_settings.screenshot_bits, pixels.data(), pixels.size());
+        renderer_settings.screenshot_complete_callback();
+        renderer_settings.screenshot_requested = false;
+    };
+}
+
+void RendererOpenGL::QueueFrame(u64 frame_number) {
+    PresentFrame* frame;
+    {
+        std::scoped_lock lock{present_mutex};
+        if (!free_frames.empty()) {
+            frame = free_frames.front();
+            free_frames.pop_front();
+        } else {
+            // The presentation thread is behind, drop the oldest frame it has not shown yet
+            frame = queued_frames.front();
+            queued_frames.pop_front();
+        }
+    }
+    if (frame->render_fence) {
+        glDeleteSync(frame->render_fence);
+        frame->render_fence = nullptr;
+    }
+    if (frame->present_fence) {
+        // Don't overwrite the texture while the previous presentation might still read it
+        glWaitSync(frame->present_fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame->present_fence);
+        frame->present_fence = nullptr;
+    }
+
+    const GLuint display_texture = screen_info.display_texture;
+    GLint internal_format, width, height;
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(display_texture, 0, GL_TEXTURE_HEIGHT, &height);
+    if (frame->internal_format != static_cast<GLenum>(internal_format) || frame->width != width ||
+        frame->height != height) {
+        frame->texture.Release();
+        frame->texture.Create(GL_TEXTURE_2D);
+        glTextureStorage2D(frame->texture.handle, 1, internal_format, width, height);
+        frame->internal_format = static_cast<GLenum>(internal_format);
+        frame->width = width;
+        frame->height = height;
+    }
+    glCopyImageSubData(display_texture, GL_TEXTURE_2D, 0, 0, 0, 0, frame->texture.handle,
+                       GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+
+    frame->texcoords = GetScreenTexcoords();
+    frame->is_srgb = OpenGLState::GetsRGBUsed();
+    frame->frame_number = frame_number;
+    OpenGLState::ClearsRGBUsed();
+
+    // The fence has to reach the GPU before the presentation thread waits for it
+    frame->render_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    {
+        std::scoped_lock lock{present_mutex};
+        queued_frames.push_back(frame);
+    }
+    present_cv.notify_one();
+
+    m_current_frame++;
+}
+
+void RendererOpenGL::PresentLoop() {
+    MicroProfileOnThreadCreate("PresentThread");
+    Common::SetCurrentThreadName("yuzu:Present");
+    Common::SetCurrentThreadPlacement(Common::ThreadRole::Background);
+
+    bool is_context_current = false;
+    PresentFrame* frame = nullptr;
+    while (true) {
+        {
+            std::unique_lock lock{present_mutex};
+            if (frame) {
+                free_frames.push_back(frame);
+            }
+            present_cv.wait(lock, [this] { return stop_presenting || !queued_frames.empty(); });
+            if (stop_presenting) {
+                break;
+            }
+            // Only the newest frame is presented, older frames are recycled without being shown
+            frame = queued_frames.back();
+            queued_frames.pop_back();
+            free_frames.insert(free_frames.end(), queued_frames.begin(), queued_frames.end());
+            queued_frames.clear();
+        }
+
+        if (!is_context_current) {
+            // The window context is not acquired until the first frame, the emulation thread uses
+            // it to load the disk shader cache before the GPU thread starts rendering
+            render_window.MakeCurrent();
+            is_context_current = true;
+        }
+
+        glWaitSync(frame->render_fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(frame->render_fence);
+        frame->render_fence = nullptr;
+
+        if (renderer_settings.screenshot_requested && !screenshot_capture.IsBusy()) {
+            CaptureFrameScreenshot(*frame);
+        }
+        DrawFrame(*frame, render_window.GetFramebufferLayout());
+        frame->present_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        screenshot_capture.Poll();
+
+        render_window.SwapBuffers();
+        system.GetPerfStats().RecordFrameEvent(Core::FrameEvent::Present, frame->frame_number);
+    }
+
+    if (is_context_current) {
+        render_window.DoneCurrent();
+    }
+}
+
+void RendererOpenGL::DrawFrame(const PresentFrame& frame, const Layout::FramebufferLayout& layout) {
+    if (renderer_settings.set_background_color) {
+        // Update background color before drawing
+        glClearColor(Settings::values.bg_red, Settings::values.bg_green, Settings::values.bg_blue,
+                     0.0f);
+    }
+
+    const auto& screen = layout.screen;
+
+    glViewport(0, 0, layout.width, layout.height);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // The window context is only used for presentation, OpenGLState tracks the GPU thread's
+    // context so the objects are bound directly
+    glUseProgram(shader.handle);
+    glBindVertexArray(vertex_array.handle);
+
+    const std::array<GLfloat, 3 * 2> ortho_matrix =
+        MakeOrthographicMatrix(static_cast<float>(layout.width), static_cast<float>(layout.height));
+    glUniformMatrix3x2fv(uniform_modelview_matrix, 1, GL_FALSE, ortho_matrix.data());
+    glUniform1i(uniform_color_texture, 0);
+    glBindTextureUnit(0, frame.texture.handle);
 
-    renderer_settings.screenshot_complete_callback();
-    renderer_settings.screenshot_requested = false;
+    if (frame.is_srgb) {
+        glEnable(GL_FRAMEBUFFER_SRGB);
+    } else {
+        glDisable(GL_FRAMEBUFFER_SRGB);
+    }
+
+    const auto vertices = MakeScreenVertices(
+        static_cast<float>(screen.left), static_cast<float>(screen.top),
+        static_cast<float>(screen.GetWidth()), static_cast<float>(screen.GetHeight()),
+        frame.texcoords);
+    glNamedBufferSubData(vertex_buffer.handle, 0, sizeof(vertices), vertices.data());
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+void RendererOpenGL::CaptureFrameScreenshot(const PresentFrame& frame) {
+    const Layout::FramebufferLayout layout{renderer_settings.screenshot_framebuffer_layout};
+
+    // OGLFramebuffer releases through OpenGLState, manage the objects by hand in this context
+    GLuint framebuffer;
+    GLuint renderbuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, frame.is_srgb ? GL_SRGB8 : GL_RGB8, layout.width,
+                          layout.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+
+    DrawFrame(frame, layout);
+
+    screenshot_capture.ReadFramebuffer(layout.width, layout.height, GetScreenshotConsumer());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &renderbuffer);
 }
 
 static const char* GetSource(GLenum source) {
@@ -454,41 +855,66 @@ static const char* GetType(GLenum type) {
 
 static void APIENTRY DebugHandler(GLenum source, GLenum type, GLuint id, GLenum severity,
                                   GLsizei length, const GLchar* message, const void* user_param) {
-    const char format[] = "{} {} {}: {}";
     const char* const str_source = GetSource(source);
     const char* const str_type = GetType(type);
 
     switch (severity) {
     case GL_DEBUG_SEVERITY_HIGH:
-        LOG_CRITICAL(Render_OpenGL, format, str_source, str_type, id, message);
+        LOG_CRITICAL(Render_OpenGL, "{} {} {}: {}", str_source, str_type, id, message);
         break;
     case GL_DEBUG_SEVERITY_MEDIUM:
-        LOG_WARNING(Render_OpenGL, format, str_source, str_type, id, message);
+        LOG_WARNING(Render_OpenGL, "{} {} {}: {}", str_source, str_type, id, message);
         break;
     case GL_DEBUG_SEVERITY_NOTIFICATION:
     case GL_DEBUG_SEVERITY_LOW:
-        LOG_DEBUG(Render_OpenGL, format, str_source, str_type, id, message);
+        LOG_DEBUG(Render_OpenGL, "{} {} {}: {}", str_source, str_type, id, message);
         break;
     }
 }
 
 /// Initialize the renderer
 bool RendererOpenGL::Init() {
-    Core::Frontend::ScopeAcquireWindowContext acquire_context{render_window};
+    if (Settings::values.use_asynchronous_gpu_emulation) {
+        // The GPU thread renders on a shared context, leaving the window context to the
+        // presentation thread. Frontends without shared contexts present from the GPU thread.
+        command_context = emu_window.CreateSharedContext();
+    }
+
+    {
+        Core::Frontend::ScopeAcquireWindowContext acquire_context{render_window};
+
+        if (GLAD_GL_KHR_debug) {
+            glEnable(GL_DEBUG_OUTPUT);
+            glDebugMessageCallback(DebugHandler, nullptr);
+        }
 
+        AddTelemetryFields();
+
+        if (!GLAD_GL_VERSION_4_3) {
+            return false;
+        }
+
+        InitOpenGLObjects();
+
+        if (!command_context) {
+            CreateRasterizer();
+            return true;
+        }
+    }
+
+    // Objects like program pipelines are not shared, create the rasterizer in its own context
+    command_context->MakeCurrent();
     if (GLAD_GL_KHR_debug) {
         glEnable(GL_DEBUG_OUTPUT);
         glDebugMessageCallback(DebugHandler, nullptr);
     }
+    CreateRasterizer();
+    command_context->DoneCurrent();
 
-    AddTelemetryFields();
-
-    if (!GLAD_GL_VERSION_4_3) {
-        return false;
+    for (auto& frame : present_frames) {
+        free_frames.push_back(&frame);
     }
-
-    InitOpenGLObjects();
-    CreateRasterizer();
+    present_thread = std::thread(&RendererOpenGL::PresentLoop, this);
 
     return true;
 }
@@ -496,4 +922,11 @@ bool RendererOpenGL::Init() {
 /// Shutdown the renderer
 void RendererOpenGL::ShutDown() {}
 
+Core::Frontend::GraphicsContext& RendererOpenGL::GetCommandContext() {
+    if (command_context) {
+        return *command_context;
+    }
+    return render_window;
+}
+
 } // namespace OpenGL
@@ -4,11 +4,19 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_frame_capture.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
@@ -18,7 +26,8 @@ class System;
 
 namespace Core::Frontend {
 class EmuWindow;
-}
+class GraphicsContext;
+} // namespace Core::Frontend
 
 namespace Layout {
 struct FramebufferLayout;
@@ -26,6 +35,8 @@ struct FramebufferLayout;
 
 namespace OpenGL {
 
+class GLGpuProfiler;
+
 /// Structure used for storing information about the textures for the Switch screen
 struct TextureInfo {
     OGLTexture resource;
@@ -43,6 +54,19 @@ struct ScreenInfo {
     TextureInfo texture;
 };
 
+/// Screen rendered by the GPU thread, waiting in the mailbox to be presented
+struct PresentFrame {
+    OGLTexture texture;
+    GLenum internal_format{}; ///< Matches the displayed texture to copy from it directly
+    GLsizei width{};
+    GLsizei height{};
+    Common::Rectangle<float> texcoords; ///< Texture coordinates of the screen corners
+    bool is_srgb{};                     ///< True when the frame has to be presented in sRGB
+    u64 frame_number{};                 ///< Number of the frame in the performance statistics
+    GLsync render_fence{};              ///< Signaled when the GPU thread has written the texture
+    GLsync present_fence{};             ///< Signaled when the presentation thread has read it
+};
+
 class RendererOpenGL : public VideoCore::RendererBase {
 public:
     explicit RendererOpenGL(Core::Frontend::EmuWindow& emu_window, Core::System& system);
@@ -50,7 +74,9 @@ public:
 
     /// Swap buffers (render frame)
     void SwapBuffers(
-        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer) override;
+        std::optional<std::reference_wrapper<const Tegra::FramebufferConfig>> framebuffer,
+        const Tegra::FramebufferOverlays& overlays,
+        const std::function<void()>& release_callback) override;
 
     /// Initialize the renderer
     bool Init() override;
@@ -58,6 +84,8 @@ public:
     /// Shutdown the renderer
     void ShutDown() override;
 
+    Core::Frontend::GraphicsContext& GetCommandContext() override;
+
 private:
     void InitOpenGLObjects();
     void AddTelemetryFields();
@@ -71,8 +99,30 @@ private:
 
     void CaptureScreenshot();
 
+    /// Returns the consumer that hands a read back screenshot to the frontend
+    FrameCapture::Consumer GetScreenshotConsumer();
+
+    /// Returns the texture coordinates of the screen corners for the current framebuffer
+    Common::Rectangle<float> GetScreenTexcoords() const;
+
+    /// Copies the displayed texture to a mailbox frame and hands it to the presentation thread
+    void QueueFrame(u64 frame_number);
+
+    /// Presents the frames in the mailbox, runs in the presentation thread
+    void PresentLoop();
+    void DrawFrame(const PresentFrame& frame, const Layout::FramebufferLayout& layout);
+    void CaptureFrameScreenshot(const PresentFrame& frame);
+
     // Loads framebuffer from emulated memory into the display information structure
     void LoadFBToScreenInfo(const Tegra::FramebufferConfig& framebuffer);
+    // Deswizzles a framebuffer from emulated memory and uploads it to a texture
+    void LoadFBToTexture(const Tegra::FramebufferConfig& framebuffer, const TextureInfo& texture);
+    // Loads the overlay layers that presented a new buffer into their textures
+    void LoadOverlays(const Tegra::FramebufferOverlays& overlays);
+    // Blends the overlay layers on top of the displayed texture into the composition texture
+    void ComposeOverlays();
+    // Returns a pointer to the next framebuffer upload slot, waiting until the GPU is done with it
+    u8* ReserveFramebufferUpload(std::size_t size);
     // Fills active OpenGL texture with the given RGBA color.
     void LoadColorToActiveGLTexture(u8 color_r, u8 color_g, u8 color_b, u8 color_a,
                                     const TextureInfo& texture);
@@ -82,6 +132,15 @@ private:
 
     OpenGLState state;
 
+    /// Feeds the GPU timeline of MicroProfile, used by the rasterizer
+    std::unique_ptr<GLGpuProfiler> gpu_profiler;
+
+    /// Reads screenshots back on the thread that presents, without waiting for the GPU
+    FrameCapture screenshot_capture{1};
+
+    /// Records every presented frame when Settings::values.record_frames is set
+    std::unique_ptr<FrameRecorder> frame_recorder;
+
     // OpenGL object IDs
     OGLVertexArray vertex_array;
     OGLBuffer vertex_buffer;
@@ -94,6 +153,25 @@ private:
     /// OpenGL framebuffer data
     std::vector<u8> gl_framebuffer_data;
 
+    /// Textures of the layers composed on top of the primary framebuffer, from the bottom up
+    std::vector<TextureInfo> overlay_textures;
+
+    /// Displayed texture with the overlays blended on top, only used when there are overlays
+    OGLTexture composition_texture;
+    OGLFramebuffer composition_framebuffer;
+    GLenum composition_format{};
+    GLsizei composition_width{};
+    GLsizei composition_height{};
+
+    /// Ring of persistently mapped slots CPU rendered framebuffers are deswizzled into, so their
+    /// upload is done asynchronously with a pixel buffer
+    static constexpr std::size_t NUM_FRAMEBUFFER_UPLOAD_SLOTS = 3;
+    OGLBuffer framebuffer_upload_buffer;
+    u8* framebuffer_upload_pointer = nullptr;
+    std::size_t framebuffer_upload_slot_size = 0;
+    std::size_t framebuffer_upload_slot = 0;
+    std::array<OGLSync, NUM_FRAMEBUFFER_UPLOAD_SLOTS> framebuffer_upload_fences;
+
     // Shader uniform location indices
     GLuint uniform_modelview_matrix;
     GLuint uniform_color_texture;
@@ -105,6 +183,18 @@ private:
     /// Used for transforming the framebuffer orientation
     Tegra::FramebufferConfig::TransformFlags framebuffer_transform_flags;
     Common::Rectangle<int> framebuffer_crop_rect;
+
+    /// Shared context the GPU thread renders with when presentation runs in its own thread
+    std::unique_ptr<Core::Frontend::GraphicsContext> command_context;
+
+    /// Frame mailbox between the GPU thread and the presentation thread
+    std::array<PresentFrame, 3> present_frames;
+    std::deque<PresentFrame*> free_frames;    ///< Frames the GPU thread can render to
+    std::deque<PresentFrame*> queued_frames;  ///< Rendered frames, the newest one is at the back
+    std::mutex present_mutex;
+    std::condition_variable present_cv;
+    bool stop_presenting = false;
+    std::thread present_thread;
 };
 
 } // namespace OpenGL
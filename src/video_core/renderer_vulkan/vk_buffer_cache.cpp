@@ -25,6 +25,7 @@ CachedBufferEntry::CachedBufferEntry(VAddr cpu_addr, std::size_t size, u64 offse
 
 VKBufferCache::VKBufferCache(Tegra::MemoryManager& tegra_memory_manager,
                              VideoCore::RasterizerInterface& rasterizer, const VKDevice& device,
+                             VKResourceManager& resource_manager,
                              VKMemoryManager& memory_manager, VKScheduler& scheduler, u64 size)
     : RasterizerCache{rasterizer}, tegra_memory_manager{tegra_memory_manager} {
     const auto usage = vk::BufferUsageFlagBits::eVertexBuffer |
@@ -33,8 +34,8 @@ VKBufferCache::VKBufferCache(Tegra::MemoryManager& tegra_memory_manager,
     const auto access = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead |
                         vk::AccessFlagBits::eUniformRead;
     stream_buffer =
-        std::make_unique<VKStreamBuffer>(device, memory_manager, scheduler, size, usage, access,
-                                         vk::PipelineStageFlagBits::eAllCommands);
+        std::make_unique<VKStreamBuffer>(device, resource_manager, memory_manager, scheduler, size,
+                                         usage, access, vk::PipelineStageFlagBits::eAllCommands);
     buffer_handle = stream_buffer->GetBuffer();
 }
 
@@ -22,6 +22,7 @@ namespace Vulkan {
 class VKDevice;
 class VKFence;
 class VKMemoryManager;
+class VKResourceManager;
 class VKStreamBuffer;
 
 class CachedBufferEntry final : public RasterizerCacheObject {
@@ -60,7 +61,8 @@ class VKBufferCache final : public RasterizerCache<std::shared_ptr<CachedBufferE
 public:
     explicit VKBufferCache(Tegra::MemoryManager& tegra_memory_manager,
                            VideoCore::RasterizerInterface& rasterizer, const VKDevice& device,
-                           VKMemoryManager& memory_manager, VKScheduler& scheduler, u64 size);
+                           VKResourceManager& resource_manager, VKMemoryManager& memory_manager,
+                           VKScheduler& scheduler, u64 size);
     ~VKBufferCache();
 
     /// Uploads data from a guest GPU address. Returns host's buffer offset where it's been
@@ -3,8 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <iterator>
+#include <map>
 #include <optional>
+#include <set>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include "common/alignment.h"
 #include "common/assert.h"
@@ -22,15 +26,17 @@ constexpr u64 ALLOC_CHUNK_SIZE = 64 * 1024 * 1024;
 class VKMemoryAllocation final {
 public:
     explicit VKMemoryAllocation(const VKDevice& device, vk::DeviceMemory memory,
-                                vk::MemoryPropertyFlags properties, u64 alloc_size, u32 type)
+                                vk::MemoryPropertyFlags properties, u64 alloc_size, u32 type,
+                                bool is_linear)
         : device{device}, memory{memory}, properties{properties}, alloc_size{alloc_size},
-          shifted_type{ShiftType(type)}, is_mappable{properties &
-                                                     vk::MemoryPropertyFlagBits::eHostVisible} {
+          shifted_type{ShiftType(type)}, is_linear{is_linear},
+          is_mappable{properties & vk::MemoryPropertyFlagBits::eHostVisible} {
         if (is_mappable) {
             const auto dev = device.GetLogical();
             const auto& dld = device.GetDispatchLoader();
             base_address = static_cast<u8*>(dev.mapMemory(memory, 0, alloc_size, {}, dld));
         }
+        InsertFreeRange(0, alloc_size);
     }
 
     ~VKMemoryAllocation() {
@@ -42,44 +48,66 @@ public:
     }
 
     VKMemoryCommit Commit(vk::DeviceSize commit_size, vk::DeviceSize alignment) {
-        auto found = TryFindFreeSection(free_iterator, alloc_size, static_cast<u64>(commit_size),
-                                        static_cast<u64>(alignment));
+        const auto found =
+            TryFindFreeSection(static_cast<u64>(commit_size), static_cast<u64>(alignment));
         if (!found) {
-            found = TryFindFreeSection(0, free_iterator, static_cast<u64>(commit_size),
-                                       static_cast<u64>(alignment));
-            if (!found) {
-                // Signal out of memory, it'll try to do more allocations.
-                return nullptr;
-            }
+            // Signal out of memory, it'll try to do more allocations.
+            return nullptr;
         }
         u8* address = is_mappable ? base_address + *found : nullptr;
-        auto commit = std::make_unique<VKMemoryCommitImpl>(this, memory, address, *found,
-                                                           *found + commit_size);
-        commits.push_back(commit.get());
-
-        // Last commit's address is highly probable to be free.
-        free_iterator = *found + commit_size;
-
-        return commit;
+        ++num_commits;
+        return std::make_unique<VKMemoryCommitImpl>(this, memory, address, *found,
+                                                    *found + commit_size);
     }
 
     void Free(const VKMemoryCommitImpl* commit) {
         ASSERT(commit);
-        const auto it =
-            std::find_if(commits.begin(), commits.end(),
-                         [&](const auto& stored_commit) { return stored_commit == commit; });
-        if (it == commits.end()) {
+        if (num_commits == 0) {
             LOG_CRITICAL(Render_Vulkan, "Freeing unallocated commit!");
             UNREACHABLE();
             return;
         }
-        commits.erase(it);
+        --num_commits;
+
+        // Merge the freed interval with the free ranges around it
+        auto [begin, end] = commit->interval;
+        if (const auto next = free_ranges.lower_bound(begin); next != free_ranges.end()) {
+            ASSERT_MSG(next->first >= end, "Freed commit overlaps");
+            if (next->first == end) {
+                end += next->second;
+                EraseFreeRange(next);
+            }
+        }
+        if (const auto after = free_ranges.lower_bound(begin); after != free_ranges.begin()) {
+            const auto previous = std::prev(after);
+            ASSERT_MSG(previous->first + previous->second <= begin, "Freed commit overlaps");
+            if (previous->first + previous->second == begin) {
+                begin = previous->first;
+                EraseFreeRange(previous);
+            }
+        }
+        InsertFreeRange(begin, end - begin);
     }
 
     /// Returns whether this allocation is compatible with the arguments.
-    bool IsCompatible(vk::MemoryPropertyFlags wanted_properties, u32 type_mask) const {
+    bool IsCompatible(vk::MemoryPropertyFlags wanted_properties, u32 type_mask,
+                      bool linear) const {
         return (wanted_properties & properties) != vk::MemoryPropertyFlagBits(0) &&
-               (type_mask & shifted_type) != 0;
+               (type_mask & shifted_type) != 0 && linear == is_linear;
+    }
+
+    /// Returns the number of bytes that are not committed.
+    u64 GetFreeSize() const {
+        u64 free_size = 0;
+        for (const auto& [offset, size] : free_ranges) {
+            free_size += size;
+        }
+        return free_size;
+    }
+
+    /// Returns the size of the largest free range.
+    u64 GetLargestFreeRange() const {
+        return ranges_by_size.empty() ? 0 : ranges_by_size.rbegin()->first;
     }
 
 private:
@@ -87,48 +115,59 @@ private:
         return 1U << type;
     }
 
-    /// A memory allocator, it may return a free region between "start" and "end" with the solicited
-    /// requeriments.
-    std::optional<u64> TryFindFreeSection(u64 start, u64 end, u64 size, u64 alignment) const {
-        u64 iterator = start;
-        while (iterator + size < end) {
-            const u64 try_left = Common::AlignUp(iterator, alignment);
-            const u64 try_right = try_left + size;
-
-            bool overlap = false;
-            for (const auto& commit : commits) {
-                const auto [commit_left, commit_right] = commit->interval;
-                if (try_left < commit_right && commit_left < try_right) {
-                    // There's an overlap, continue the search where the overlapping commit ends.
-                    iterator = commit_right;
-                    overlap = true;
-                    break;
-                }
+    /// A best fit allocator, it returns the offset of the smallest free range that can hold the
+    /// solicited requeriments.
+    std::optional<u64> TryFindFreeSection(u64 size, u64 alignment) {
+        // Ranges are sorted by size, the first one that fits after aligning its offset is the best
+        for (auto it = ranges_by_size.lower_bound({size, 0}); it != ranges_by_size.end(); ++it) {
+            const auto [range_size, range_offset] = *it;
+            const u64 aligned_offset = Common::AlignUp(range_offset, alignment);
+            const u64 range_end = range_offset + range_size;
+            if (aligned_offset + size > range_end) {
+                continue;
+            }
+            EraseFreeRange(free_ranges.find(range_offset));
+            if (aligned_offset != range_offset) {
+                InsertFreeRange(range_offset, aligned_offset - range_offset);
             }
-            if (!overlap) {
-                // A free address has been found.
-                return try_left;
+            if (aligned_offset + size != range_end) {
+                InsertFreeRange(aligned_offset + size, range_end - aligned_offset - size);
             }
+            return aligned_offset;
         }
         // No free regions where found, return an empty optional.
         return std::nullopt;
     }
 
+    void InsertFreeRange(u64 offset, u64 size) {
+        free_ranges.emplace(offset, size);
+        ranges_by_size.emplace(size, offset);
+    }
+
+    void EraseFreeRange(std::map<u64, u64>::iterator it) {
+        ranges_by_size.erase({it->second, it->first});
+        free_ranges.erase(it);
+    }
+
     const VKDevice& device;                   ///< Vulkan device.
     const vk::DeviceMemory memory;            ///< Vulkan memory allocation handler.
     const vk::MemoryPropertyFlags properties; ///< Vulkan properties.
     const u64 alloc_size;                     ///< Size of this allocation.
     const u32 shifted_type;                   ///< Stored Vulkan type of this allocation, shifted.
+    const bool is_linear;                     ///< Whether it holds linear or optimal resources.
     const bool is_mappable;                   ///< Whether the allocation is mappable.
 
     /// Base address of the mapped pointer.
     u8* base_address{};
 
-    /// Hints where the next free region is likely going to be.
-    u64 free_iterator{};
+    /// Free ranges indexed by their offset, used to merge neighbours when a commit is freed.
+    std::map<u64, u64> free_ranges;
 
-    /// Stores all commits done from this allocation.
-    std::vector<const VKMemoryCommitImpl*> commits;
+    /// Free ranges sorted by size and offset, used to find the best fit of a commit.
+    std::set<std::pair<u64, u64>> ranges_by_size;
+
+    /// Number of live commits done from this allocation.
+    std::size_t num_commits{};
 };
 
 VKMemoryManager::VKMemoryManager(const VKDevice& device)
@@ -137,7 +176,8 @@ VKMemoryManager::VKMemoryManager(const VKDevice& device)
 
 VKMemoryManager::~VKMemoryManager() = default;
 
-VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool host_visible) {
+VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool host_visible,
+                                       bool linear) {
     ASSERT(reqs.size < ALLOC_CHUNK_SIZE);
 
     // When a host visible commit is asked, search for host visible and coherent, otherwise search
@@ -149,7 +189,7 @@ VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool
 
     const auto TryCommit = [&]() -> VKMemoryCommit {
         for (auto& alloc : allocs) {
-            if (!alloc->IsCompatible(wanted_properties, reqs.memoryTypeBits))
+            if (!alloc->IsCompatible(wanted_properties, reqs.memoryTypeBits, linear))
                 continue;
 
             if (auto commit = alloc->Commit(reqs.size, reqs.alignment); commit) {
@@ -163,8 +203,10 @@ VKMemoryCommit VKMemoryManager::Commit(const vk::MemoryRequirements& reqs, bool
         return commit;
     }
 
+    LogFragmentation(wanted_properties, linear);
+
     // Commit has failed, allocate more memory.
-    if (!AllocMemory(wanted_properties, reqs.memoryTypeBits, ALLOC_CHUNK_SIZE)) {
+    if (!AllocMemory(wanted_properties, reqs.memoryTypeBits, ALLOC_CHUNK_SIZE, linear)) {
         // TODO(Rodrigo): Try to use host memory.
         LOG_CRITICAL(Render_Vulkan, "Ran out of memory!");
         UNREACHABLE();
@@ -181,7 +223,7 @@ VKMemoryCommit VKMemoryManager::Commit(vk::Buffer buffer, bool host_visible) {
     const auto dev = device.GetLogical();
     const auto& dld = device.GetDispatchLoader();
     const auto requeriments = dev.getBufferMemoryRequirements(buffer, dld);
-    auto commit = Commit(requeriments, host_visible);
+    auto commit = Commit(requeriments, host_visible, true);
     dev.bindBufferMemory(buffer, commit->GetMemory(), commit->GetOffset(), dld);
     return commit;
 }
@@ -190,13 +232,13 @@ VKMemoryCommit VKMemoryManager::Commit(vk::Image image, bool host_visible) {
     const auto dev = device.GetLogical();
     const auto& dld = device.GetDispatchLoader();
     const auto requeriments = dev.getImageMemoryRequirements(image, dld);
-    auto commit = Commit(requeriments, host_visible);
+    auto commit = Commit(requeriments, host_visible, false);
     dev.bindImageMemory(image, commit->GetMemory(), commit->GetOffset(), dld);
     return commit;
 }
 
 bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask,
-                                  u64 size) {
+                                  u64 size, bool linear) {
     const u32 type = [&]() {
         for (u32 type_index = 0; type_index < props.memoryTypeCount; ++type_index) {
             const auto flags = props.memoryTypes[type_index].propertyFlags;
@@ -221,11 +263,30 @@ bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32
         LOG_CRITICAL(Render_Vulkan, "Device allocation failed with code {}!", vk::to_string(res));
         return false;
     }
-    allocs.push_back(
-        std::make_unique<VKMemoryAllocation>(device, memory, wanted_properties, size, type));
+    allocs.push_back(std::make_unique<VKMemoryAllocation>(device, memory, wanted_properties,
+                                                          size, type, linear));
     return true;
 }
 
+void VKMemoryManager::LogFragmentation(vk::MemoryPropertyFlags wanted_properties,
+                                       bool linear) const {
+    u64 free_size = 0;
+    u64 largest_range = 0;
+    std::size_t num_allocs = 0;
+    for (const auto& alloc : allocs) {
+        if (!alloc->IsCompatible(wanted_properties, ~0U, linear)) {
+            continue;
+        }
+        free_size += alloc->GetFreeSize();
+        largest_range = std::max(largest_range, alloc->GetLargestFreeRange());
+        ++num_allocs;
+    }
+    LOG_DEBUG(Render_Vulkan,
+              "Growing {} {} memory, {} allocations have {} free bytes, the largest range has {}",
+              vk::to_string(wanted_properties), linear ? "linear" : "optimal", num_allocs,
+              free_size, largest_range);
+}
+
 /*static*/ bool VKMemoryManager::GetMemoryUnified(const vk::PhysicalDeviceMemoryProperties& props) {
     for (u32 heap_index = 0; heap_index < props.memoryHeapCount; ++heap_index) {
         if (!(props.memoryHeaps[heap_index].flags & vk::MemoryHeapFlagBits::eDeviceLocal)) {
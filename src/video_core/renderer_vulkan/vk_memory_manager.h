@@ -28,14 +28,16 @@ public:
      * @param reqs Requeriments returned from a Vulkan call.
      * @param host_visible Signals the allocator that it *must* use host visible and coherent
      * memory. When passing false, it will try to allocate device local memory.
+     * @param linear Whether the memory is for a buffer or a linear image. Linear and optimal
+     * resources are taken from different allocations to respect the buffer-image granularity.
      * @returns A memory commit.
      */
-    VKMemoryCommit Commit(const vk::MemoryRequirements& reqs, bool host_visible);
+    VKMemoryCommit Commit(const vk::MemoryRequirements& reqs, bool host_visible, bool linear);
 
     /// Commits memory required by the buffer and binds it.
     VKMemoryCommit Commit(vk::Buffer buffer, bool host_visible);
 
-    /// Commits memory required by the image and binds it.
+    /// Commits memory required by the image and binds it. The image has to be optimally tiled.
     VKMemoryCommit Commit(vk::Image image, bool host_visible);
 
     /// Returns true if the memory allocations are done always in host visible and coherent memory.
@@ -45,7 +47,11 @@ public:
 
 private:
     /// Allocates a chunk of memory.
-    bool AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask, u64 size);
+    bool AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask, u64 size,
+                     bool linear);
+
+    /// Logs how fragmented the allocations compatible with the arguments are.
+    void LogFragmentation(vk::MemoryPropertyFlags wanted_properties, bool linear) const;
 
     /// Returns true if the device uses an unified memory model.
     static bool GetMemoryUnified(const vk::PhysicalDeviceMemoryProperties& props);
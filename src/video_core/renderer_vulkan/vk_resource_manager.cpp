@@ -14,12 +14,13 @@ namespace Vulkan {
 
 // TODO(Rodrigo): Fine tune these numbers.
 constexpr std::size_t COMMAND_BUFFER_POOL_SIZE = 0x1000;
+constexpr std::size_t SECONDARY_COMMAND_BUFFER_POOL_SIZE = 0x100;
 constexpr std::size_t FENCES_GROW_STEP = 0x40;
 
 class CommandBufferPool final : public VKFencedPool {
 public:
-    CommandBufferPool(const VKDevice& device)
-        : VKFencedPool(COMMAND_BUFFER_POOL_SIZE), device{device} {}
+    CommandBufferPool(const VKDevice& device, vk::CommandBufferLevel level, std::size_t pool_size)
+        : VKFencedPool(pool_size), device{device}, level{level}, pool_size{pool_size} {}
 
     void Allocate(std::size_t begin, std::size_t end) override {
         const auto dev = device.GetLogical();
@@ -35,9 +36,8 @@ public:
         const vk::CommandPoolCreateInfo cmdbuf_pool_ci(pool_flags, graphics_family);
         pool->handle = dev.createCommandPoolUnique(cmdbuf_pool_ci, nullptr, dld);
 
-        const vk::CommandBufferAllocateInfo cmdbuf_ai(*pool->handle,
-                                                      vk::CommandBufferLevel::ePrimary,
-                                                      static_cast<u32>(COMMAND_BUFFER_POOL_SIZE));
+        const vk::CommandBufferAllocateInfo cmdbuf_ai(*pool->handle, level,
+                                                      static_cast<u32>(pool_size));
         pool->cmdbufs =
             dev.allocateCommandBuffersUnique<std::allocator<UniqueCommandBuffer>>(cmdbuf_ai, dld);
 
@@ -46,8 +46,8 @@ public:
 
     vk::CommandBuffer Commit(VKFence& fence) {
         const std::size_t index = CommitResource(fence);
-        const auto pool_index = index / COMMAND_BUFFER_POOL_SIZE;
-        const auto sub_index = index % COMMAND_BUFFER_POOL_SIZE;
+        const auto pool_index = index / pool_size;
+        const auto sub_index = index % pool_size;
         return *pools[pool_index]->cmdbufs[sub_index];
     }
 
@@ -58,6 +58,8 @@ private:
     };
 
     const VKDevice& device;
+    const vk::CommandBufferLevel level;
+    const std::size_t pool_size;
 
     std::vector<std::unique_ptr<Pool>> pools;
 };
@@ -81,7 +83,8 @@ void VKFence::Release() {
     is_owned = false;
 }
 
-void VKFence::Commit() {
+void VKFence::Commit(u64 new_tick) {
+    tick = new_tick;
     is_owned = true;
     is_used = true;
 }
@@ -221,14 +224,15 @@ void VKFencedPool::Grow() {
 
 VKResourceManager::VKResourceManager(const VKDevice& device) : device{device} {
     GrowFences(FENCES_GROW_STEP);
-    command_buffer_pool = std::make_unique<CommandBufferPool>(device);
+    command_buffer_pool = std::make_unique<CommandBufferPool>(
+        device, vk::CommandBufferLevel::ePrimary, COMMAND_BUFFER_POOL_SIZE);
 }
 
 VKResourceManager::~VKResourceManager() = default;
 
 VKFence& VKResourceManager::CommitFence() {
     const auto StepFences = [&](bool gpu_wait, bool owner_wait) -> VKFence* {
-        const auto Tick = [=](auto& fence) { return fence->Tick(gpu_wait, owner_wait); };
+        const auto Tick = [=](auto& fence) { return TickFence(*fence, gpu_wait, owner_wait); };
         const auto hinted = fences.begin() + fences_iterator;
 
         auto it = std::find_if(hinted, fences.end(), Tick);
@@ -243,7 +247,7 @@ VKFence& VKResourceManager::CommitFence() {
             fences_iterator = 0;
 
         auto& fence = *it;
-        fence->Commit();
+        fence->Commit(next_tick++);
         return fence.get();
     };
 
@@ -265,10 +269,59 @@ VKFence& VKResourceManager::CommitFence() {
     return *found_fence;
 }
 
+bool VKResourceManager::IsTickComplete(u64 tick) {
+    if (tick <= completed_tick) {
+        return true;
+    }
+    for (auto& fence : fences) {
+        if (fence->is_used && !fence->is_owned && fence->tick <= tick) {
+            TickFence(*fence, false, false);
+        }
+    }
+    return tick <= completed_tick;
+}
+
+void VKResourceManager::WaitTick(u64 tick) {
+    if (tick <= completed_tick) {
+        return;
+    }
+    const auto it = std::find_if(fences.begin(), fences.end(), [tick](const auto& fence) {
+        return fence->is_used && fence->tick == tick;
+    });
+    if (it == fences.end()) {
+        // Fences are only recycled after being signaled
+        return;
+    }
+    ASSERT_MSG(!(*it)->is_owned, "Waiting for a tick that has not been submitted");
+    TickFence(**it, true, false);
+}
+
 vk::CommandBuffer VKResourceManager::CommitCommandBuffer(VKFence& fence) {
     return command_buffer_pool->Commit(fence);
 }
 
+vk::CommandBuffer VKResourceManager::CommitSecondaryCommandBuffer(VKFence& fence,
+                                                                  std::size_t pool_index) {
+    while (pool_index >= secondary_pools.size()) {
+        secondary_pools.push_back(std::make_unique<CommandBufferPool>(
+            device, vk::CommandBufferLevel::eSecondary, SECONDARY_COMMAND_BUFFER_POOL_SIZE));
+    }
+    return secondary_pools[pool_index]->Commit(fence);
+}
+
+bool VKResourceManager::TickFence(VKFence& fence, bool gpu_wait, bool owner_wait) {
+    const bool was_used = fence.is_used;
+    const u64 tick = fence.tick;
+    if (!fence.Tick(gpu_wait, owner_wait)) {
+        return false;
+    }
+    if (was_used) {
+        // Submissions to the queue are completed in order
+        completed_tick = std::max(completed_tick, tick);
+    }
+    return true;
+}
+
 void VKResourceManager::GrowFences(std::size_t new_fences_count) {
     const auto dev = device.GetLogical();
     const auto& dld = device.GetDispatchLoader();
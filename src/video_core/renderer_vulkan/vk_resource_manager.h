@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <memory>
 #include <vector>
+#include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
 
 namespace Vulkan {
@@ -70,9 +71,14 @@ public:
         return *handle;
     }
 
+    /// Returns the tick that is completed when this fence is signaled.
+    u64 GetTick() const {
+        return tick;
+    }
+
 private:
     /// Take ownership of the fence.
-    void Commit();
+    void Commit(u64 new_tick);
 
     /**
      * Updates the fence status.
@@ -86,6 +92,7 @@ private:
     const VKDevice& device;                       ///< Device handler
     UniqueFence handle;                           ///< Vulkan fence
     std::vector<VKResource*> protected_resources; ///< List of resources protected by this fence
+    u64 tick = 0;          ///< Tick of the submission the fence is used for.
     bool is_owned = false; ///< The fence has been commited but not released yet.
     bool is_used = false;  ///< The fence has been commited but it has not been checked to be free.
 };
@@ -155,6 +162,8 @@ private:
 /**
  * The resource manager handles all resources that can be protected with a fence avoiding
  * driver-side or GPU-side concurrent usage. Usage is documented in VKFence.
+ * Every committed fence gets a monotonically increasing tick. Resources can store the tick they
+ * were last used in and ask whether it has been completed instead of watching the fence.
  */
 class VKResourceManager final {
 public:
@@ -164,17 +173,40 @@ public:
     /// Commits a fence. It has to be sent to a queue and released.
     VKFence& CommitFence();
 
+    /// Returns true if the submission of the tick has been completed by the GPU.
+    bool IsTickComplete(u64 tick);
+
+    /**
+     * Waits for the submission of a tick to be completed by the GPU.
+     * @warning The fence of the tick must have been sent to a queue.
+     */
+    void WaitTick(u64 tick);
+
     /// Commits an unused command buffer and protects it with a fence.
     vk::CommandBuffer CommitCommandBuffer(VKFence& fence);
 
+    /**
+     * Commits an unused secondary command buffer and protects it with a fence. Command buffers
+     * committed from different pools can be recorded concurrently.
+     * @param fence Fence that protects the commited command buffer.
+     * @param pool_index Pool to take the command buffer from.
+     */
+    vk::CommandBuffer CommitSecondaryCommandBuffer(VKFence& fence, std::size_t pool_index);
+
 private:
     /// Allocates new fences.
     void GrowFences(std::size_t new_fences_count);
 
+    /// Ticks a fence, updating the completed tick when it's signaled.
+    bool TickFence(VKFence& fence, bool gpu_wait, bool owner_wait);
+
     const VKDevice& device;          ///< Device handler.
+    u64 next_tick = 1;               ///< Tick given to the next committed fence.
+    u64 completed_tick = 0;          ///< Most recent tick known to be completed.
     std::size_t fences_iterator = 0; ///< Index where a free fence is likely to be found.
     std::vector<std::unique_ptr<VKFence>> fences;           ///< Pool of fences.
     std::unique_ptr<CommandBufferPool> command_buffer_pool; ///< Pool of command buffers.
+    std::vector<std::unique_ptr<CommandBufferPool>> secondary_pools; ///< Secondary pools.
 };
 
 } // namespace Vulkan
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <utility>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "video_core/renderer_vulkan/declarations.h"
@@ -11,16 +14,62 @@
 
 namespace Vulkan {
 
+/// Number of commands recorded before a chunk is handed to a worker
+constexpr std::size_t COMMANDS_PER_CHUNK = 64;
+
 VKScheduler::VKScheduler(const VKDevice& device, VKResourceManager& resource_manager)
     : device{device}, resource_manager{resource_manager} {
     next_fence = &resource_manager.CommitFence();
     AllocateNewContext();
+
+    // Leave host threads to the emulated CPU cores and the GPU thread
+    const std::size_t num_workers{
+        std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4)};
+    worker_jobs.resize(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&VKScheduler::WorkerLoop, this, i);
+    }
 }
 
-VKScheduler::~VKScheduler() = default;
+VKScheduler::~VKScheduler() {
+    {
+        std::scoped_lock lock{mutex};
+        stop_workers = true;
+    }
+    job_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void VKScheduler::Record(Command command) {
+    if (!current_chunk) {
+        current_chunk = std::make_unique<CommandChunk>();
+        current_chunk->commands.reserve(COMMANDS_PER_CHUNK);
+    }
+    current_chunk->commands.push_back(std::move(command));
+    if (current_chunk->commands.size() >= COMMANDS_PER_CHUNK) {
+        DispatchChunk();
+    }
+}
+
+void VKScheduler::BeginRenderPass(vk::RenderPass renderpass, vk::Framebuffer framebuffer,
+                                  vk::Rect2D render_area,
+                                  std::vector<vk::ClearValue> clear_values) {
+    ASSERT_MSG(!current_renderpass, "Render pass is already active");
+    DispatchChunk();
+    current_renderpass = renderpasses.size();
+    renderpasses.push_back({renderpass, framebuffer, render_area, std::move(clear_values)});
+}
+
+void VKScheduler::EndRenderPass() {
+    ASSERT_MSG(current_renderpass, "No render pass is active");
+    DispatchChunk();
+    current_renderpass = std::nullopt;
+}
 
 VKExecutionContext VKScheduler::GetExecutionContext() const {
-    return VKExecutionContext(current_fence, current_cmdbuf);
+    return VKExecutionContext(current_fence);
 }
 
 VKExecutionContext VKScheduler::Flush(vk::Semaphore semaphore) {
@@ -39,6 +88,11 @@ VKExecutionContext VKScheduler::Finish(vk::Semaphore semaphore) {
 }
 
 void VKScheduler::SubmitExecution(vk::Semaphore semaphore) {
+    ASSERT_MSG(!current_renderpass, "Render pass is still active on submission");
+    DispatchChunk();
+    WaitChunks();
+    ExecuteChunks();
+
     const auto& dld = device.GetDispatchLoader();
     current_cmdbuf.end(dld);
 
@@ -57,4 +111,99 @@ void VKScheduler::AllocateNewContext() {
     current_cmdbuf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit}, dld);
 }
 
+void VKScheduler::DispatchChunk() {
+    if (!current_chunk || current_chunk->commands.empty()) {
+        return;
+    }
+    CommandChunk& chunk = *current_chunk;
+    chunk.renderpass_index = current_renderpass;
+    if (current_renderpass) {
+        const auto& state = renderpasses[*current_renderpass];
+        chunk.renderpass = state.renderpass;
+        chunk.framebuffer = state.framebuffer;
+    }
+
+    // Each worker records from its own pool, command pools can't be used concurrently
+    const std::size_t worker = next_worker;
+    next_worker = (next_worker + 1) % workers.size();
+    chunk.cmdbuf = resource_manager.CommitSecondaryCommandBuffer(*current_fence, worker);
+
+    {
+        std::scoped_lock lock{mutex};
+        worker_jobs[worker].push_back(&chunk);
+        ++pending_chunks;
+    }
+    job_condition.notify_all();
+    chunks.push_back(std::move(current_chunk));
+}
+
+void VKScheduler::WaitChunks() {
+    std::unique_lock lock{mutex};
+    recorded_condition.wait(lock, [this] { return pending_chunks == 0; });
+}
+
+void VKScheduler::ExecuteChunks() {
+    const auto& dld = device.GetDispatchLoader();
+    std::optional<std::size_t> active_renderpass;
+    for (const auto& chunk : chunks) {
+        if (chunk->renderpass_index != active_renderpass) {
+            if (active_renderpass) {
+                current_cmdbuf.endRenderPass(dld);
+            }
+            active_renderpass = chunk->renderpass_index;
+            if (active_renderpass) {
+                const auto& state = renderpasses[*active_renderpass];
+                const vk::RenderPassBeginInfo renderpass_bi(
+                    state.renderpass, state.framebuffer, state.render_area,
+                    static_cast<u32>(state.clear_values.size()), state.clear_values.data());
+                current_cmdbuf.beginRenderPass(renderpass_bi,
+                                               vk::SubpassContents::eSecondaryCommandBuffers, dld);
+            }
+        }
+        current_cmdbuf.executeCommands(1, &chunk->cmdbuf, dld);
+    }
+    if (active_renderpass) {
+        current_cmdbuf.endRenderPass(dld);
+    }
+    chunks.clear();
+    renderpasses.clear();
+}
+
+void VKScheduler::WorkerLoop(std::size_t worker_index) {
+    const auto& dld = device.GetDispatchLoader();
+    auto& jobs = worker_jobs[worker_index];
+    while (true) {
+        CommandChunk* chunk;
+        {
+            std::unique_lock lock{mutex};
+            job_condition.wait(lock, [&] { return stop_workers || !jobs.empty(); });
+            if (stop_workers) {
+                return;
+            }
+            chunk = jobs.front();
+            jobs.pop_front();
+        }
+
+        const vk::CommandBufferInheritanceInfo inheritance(chunk->renderpass, 0,
+                                                           chunk->framebuffer);
+        auto flags = vk::CommandBufferUsageFlags{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
+        if (chunk->renderpass_index) {
+            flags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+        }
+        chunk->cmdbuf.begin({flags, &inheritance}, dld);
+        for (const auto& command : chunk->commands) {
+            command(chunk->cmdbuf, dld);
+        }
+        chunk->cmdbuf.end(dld);
+        // Release what the commands hold as soon as possible
+        chunk->commands.clear();
+
+        {
+            std::scoped_lock lock{mutex};
+            --pending_chunks;
+        }
+        recorded_condition.notify_one();
+    }
+}
+
 } // namespace Vulkan
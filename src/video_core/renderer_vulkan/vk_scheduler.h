@@ -4,6 +4,16 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
 
@@ -18,10 +28,28 @@ class VKResourceManager;
 /// OpenGL-like operations on Vulkan command buffers.
 class VKScheduler {
 public:
+    /// Command recorded on a worker thread
+    using Command = std::function<void(vk::CommandBuffer, const vk::DispatchLoaderDynamic&)>;
+
     explicit VKScheduler(const VKDevice& device, VKResourceManager& resource_manager);
     ~VKScheduler();
 
-    /// Gets the current execution context.
+    /**
+     * Records a command in a secondary command buffer on a worker thread. All the commands of a
+     * context go through here, uploads and layout transitions included, so they are executed in
+     * the order they were recorded. Everything the command references has to be owned by it.
+     */
+    void Record(Command command);
+
+    /// Begins a render pass. Commands recorded until EndRenderPass are executed inside of it.
+    void BeginRenderPass(vk::RenderPass renderpass, vk::Framebuffer framebuffer,
+                         vk::Rect2D render_area, std::vector<vk::ClearValue> clear_values = {});
+
+    /// Ends the current render pass
+    void EndRenderPass();
+
+    /// Gets the current execution context. Its fence tracks the commands recorded until the next
+    /// flush.
     [[nodiscard]] VKExecutionContext GetExecutionContext() const;
 
     /// Sends the current execution context to the GPU. It invalidates the current execution context
@@ -33,15 +61,59 @@ public:
     VKExecutionContext Finish(vk::Semaphore semaphore = nullptr);
 
 private:
+    struct RenderPassState {
+        vk::RenderPass renderpass;
+        vk::Framebuffer framebuffer;
+        vk::Rect2D render_area;
+        std::vector<vk::ClearValue> clear_values;
+    };
+
+    /// Commands recorded in the same secondary command buffer
+    struct CommandChunk {
+        std::vector<Command> commands;
+        vk::CommandBuffer cmdbuf;
+        /// Index of the render pass the chunk is executed in, if any
+        std::optional<std::size_t> renderpass_index;
+        /// Render pass and framebuffer the secondary command buffer inherits
+        vk::RenderPass renderpass;
+        vk::Framebuffer framebuffer;
+    };
+
     void SubmitExecution(vk::Semaphore semaphore);
 
     void AllocateNewContext();
 
+    /// Hands the current chunk to a worker, if it holds any command
+    void DispatchChunk();
+
+    /// Waits until the workers have recorded all the dispatched chunks
+    void WaitChunks();
+
+    /// Executes the recorded chunks of the context in the primary command buffer
+    void ExecuteChunks();
+
+    void WorkerLoop(std::size_t worker_index);
+
     const VKDevice& device;
     VKResourceManager& resource_manager;
+    /// Primary command buffer, it only executes the secondary command buffers of the chunks
     vk::CommandBuffer current_cmdbuf;
     VKFence* current_fence = nullptr;
     VKFence* next_fence = nullptr;
+
+    std::unique_ptr<CommandChunk> current_chunk;
+    std::vector<std::unique_ptr<CommandChunk>> chunks;
+    std::vector<RenderPassState> renderpasses;
+    std::optional<std::size_t> current_renderpass;
+    std::size_t next_worker = 0;
+
+    std::vector<std::thread> workers;
+    std::vector<std::deque<CommandChunk*>> worker_jobs;
+    std::mutex mutex;
+    std::condition_variable job_condition;
+    std::condition_variable recorded_condition;
+    std::size_t pending_chunks = 0;
+    bool stop_workers = false;
 };
 
 class VKExecutionContext {
@@ -54,16 +126,10 @@ public:
         return *fence;
     }
 
-    vk::CommandBuffer GetCommandBuffer() const {
-        return cmdbuf;
-    }
-
 private:
-    explicit VKExecutionContext(VKFence* fence, vk::CommandBuffer cmdbuf)
-        : fence{fence}, cmdbuf{cmdbuf} {}
+    explicit VKExecutionContext(VKFence* fence) : fence{fence} {}
 
     VKFence* fence{};
-    vk::CommandBuffer cmdbuf;
 };
 
 } // namespace Vulkan
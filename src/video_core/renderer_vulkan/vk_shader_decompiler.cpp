@@ -117,6 +117,13 @@ public:
             Emit(OpFunction(t_void, spv::FunctionControlMask::Inline, TypeFunction(t_void)));
         Emit(OpLabel());
 
+        if (ir.IsFlowStructured()) {
+            VisitStructuredBlock(ir.GetStructuredProgram());
+            Emit(OpReturn());
+            Emit(OpFunctionEnd());
+            return;
+        }
+
         const u32 first_address = ir.GetBasicBlocks().begin()->first;
         const Id loop_label = OpLabel("loop");
         const Id merge_label = OpLabel("merge");
@@ -406,6 +413,8 @@ private:
     void DeclareSamplers() {
         u32 binding = samplers_base_binding;
         for (const auto& sampler : ir.GetSamplers()) {
+            // Indexed samplers are bound as their first element
+            UNIMPLEMENTED_IF(sampler.IsIndexed());
             const auto dim = GetSamplerDim(sampler);
             const int depth = sampler.IsShadow() ? 1 : 0;
             const int arrayed = sampler.IsArray() ? 1 : 0;
@@ -486,6 +495,78 @@ private:
         }
     }
 
+    void VisitStructuredBlock(const StructuredBlock& block) {
+        for (const StructuredNode& node : block) {
+            switch (node.type) {
+            case StructuredNode::Type::Code:
+                VisitBasicBlock(node.code);
+                break;
+            case StructuredNode::Type::If: {
+                const Id condition = Visit(node.condition);
+                const Id then_label = OpLabel();
+                const Id merge_label = OpLabel();
+                const Id else_label = node.else_block.empty() ? merge_label : OpLabel();
+                Emit(OpSelectionMerge(merge_label, spv::SelectionControlMask::MaskNone));
+                Emit(OpBranchConditional(condition, then_label, else_label));
+
+                Emit(then_label);
+                VisitStructuredBlock(node.then_block);
+                Emit(OpBranch(merge_label));
+                if (!node.else_block.empty()) {
+                    Emit(else_label);
+                    VisitStructuredBlock(node.else_block);
+                    Emit(OpBranch(merge_label));
+                }
+                Emit(merge_label);
+                break;
+            }
+            case StructuredNode::Type::Loop: {
+                const Id header_label = OpLabel();
+                const Id body_label = OpLabel();
+                const Id continue_target = OpLabel();
+                const Id merge_label = OpLabel();
+                Emit(OpBranch(header_label));
+                Emit(header_label);
+                Emit(OpLoopMerge(merge_label, continue_target, spv::LoopControlMask::MaskNone));
+                Emit(OpBranch(body_label));
+
+                Emit(body_label);
+                loop_labels.emplace_back(merge_label, continue_target);
+                VisitStructuredBlock(node.then_block);
+                loop_labels.pop_back();
+                Emit(OpBranch(merge_label));
+
+                Emit(continue_target);
+                Emit(OpBranch(header_label));
+                Emit(merge_label);
+                break;
+            }
+            case StructuredNode::Type::Break:
+                LoopJump(node.condition, loop_labels.back().first);
+                break;
+            case StructuredNode::Type::Continue:
+                LoopJump(node.condition, loop_labels.back().second);
+                break;
+            }
+        }
+    }
+
+    /// Branches to a label of the innermost loop, if the condition is met when there's any
+    void LoopJump(Node condition, Id target) {
+        if (!condition) {
+            BranchingOp([&]() { Emit(OpBranch(target)); });
+            return;
+        }
+        const Id condition_id = Visit(condition);
+        const Id jump_label = OpLabel();
+        const Id skip_label = OpLabel();
+        Emit(OpSelectionMerge(skip_label, spv::SelectionControlMask::MaskNone));
+        Emit(OpBranchConditional(condition_id, jump_label, skip_label));
+        Emit(jump_label);
+        Emit(OpBranch(target));
+        Emit(skip_label);
+    }
+
     Id Visit(Node node) {
         if (const auto operation = std::get_if<OperationNode>(node)) {
             const auto operation_index = static_cast<std::size_t>(operation->GetCode());
@@ -739,6 +820,10 @@ private:
             Id address = BitcastTo<Type::Uint>(Visit(lmem->GetAddress()));
             address = Emit(OpUDiv(t_uint, address, Constant(t_uint, 4)));
             target = Emit(OpAccessChain(t_prv_float, local_memory, {address}));
+        } else if (std::holds_alternative<SmemNode>(*dest)) {
+            // Shared memory is only used by kernels, which aren't supported on Vulkan yet
+            UNIMPLEMENTED_MSG("Shared memory stores are not implemented");
+            return {};
         }
 
         Emit(OpStore(target, Visit(src)));
@@ -1040,11 +1125,45 @@ private:
         return {};
     }
 
+    Id Barrier(Operation) {
+        // Barriers are only used by kernels, which aren't supported on Vulkan yet
+        UNIMPLEMENTED();
+        return {};
+    }
+
+    Id MemoryBarrierGL(Operation) {
+        UNIMPLEMENTED();
+        return {};
+    }
+
     Id YNegate(Operation operation) {
         UNIMPLEMENTED();
         return {};
     }
 
+    template <u32 element>
+    Id LocalInvocationId(Operation) {
+        return LoadComputeBuiltIn(local_invocation_id, spv::BuiltIn::LocalInvocationId,
+                                  "local_invocation_id", element);
+    }
+
+    template <u32 element>
+    Id WorkGroupId(Operation) {
+        return LoadComputeBuiltIn(work_group_id, spv::BuiltIn::WorkgroupId, "work_group_id",
+                                  element);
+    }
+
+    /// Loads an element of a compute built-in, declaring it on its first use as only kernels
+    /// read them
+    Id LoadComputeBuiltIn(Id& variable, spv::BuiltIn builtin, const std::string& name,
+                          u32 element) {
+        if (!variable) {
+            variable = DeclareBuiltIn(builtin, spv::StorageClass::Input, t_in_uint3, name);
+        }
+        const Id pointer = AccessElement(t_in_uint, variable, element);
+        return BitcastFrom<Type::Uint>(Emit(OpLoad(t_uint, pointer)));
+    }
+
     Id DeclareBuiltIn(spv::BuiltIn builtin, spv::StorageClass storage, Id type,
                       const std::string& name) {
         const Id id = OpVariable(type, storage);
@@ -1300,7 +1419,16 @@ private:
         &SPIRVDecompiler::EmitVertex,
         &SPIRVDecompiler::EndPrimitive,
 
+        &SPIRVDecompiler::Barrier,
+        &SPIRVDecompiler::MemoryBarrierGL,
+
         &SPIRVDecompiler::YNegate,
+        &SPIRVDecompiler::LocalInvocationId<0>,
+        &SPIRVDecompiler::LocalInvocationId<1>,
+        &SPIRVDecompiler::LocalInvocationId<2>,
+        &SPIRVDecompiler::WorkGroupId<0>,
+        &SPIRVDecompiler::WorkGroupId<1>,
+        &SPIRVDecompiler::WorkGroupId<2>,
     };
 
     const VKDevice& device;
@@ -1335,6 +1463,7 @@ private:
 
     const Id t_in_bool = Name(TypePointer(spv::StorageClass::Input, t_bool), "in_bool");
     const Id t_in_uint = Name(TypePointer(spv::StorageClass::Input, t_uint), "in_uint");
+    const Id t_in_uint3 = Name(TypePointer(spv::StorageClass::Input, t_uint3), "in_uint3");
     const Id t_in_float = Name(TypePointer(spv::StorageClass::Input, t_float), "in_float");
     const Id t_in_float4 = Name(TypePointer(spv::StorageClass::Input, t_float4), "in_float4");
 
@@ -1383,6 +1512,8 @@ private:
     Id frag_depth{};
     Id frag_coord{};
     Id front_facing{};
+    Id local_invocation_id{};
+    Id work_group_id{};
 
     u32 position_index{};
     u32 point_size_index{};
@@ -1400,6 +1531,8 @@ private:
     Id flow_stack{};
     Id continue_label{};
     std::map<u32, Id> labels;
+    /// Merge and continue labels of the loops being emitted, from the outermost to the innermost
+    std::vector<std::pair<Id, Id>> loop_labels;
 };
 
 DecompilerResult Decompile(const VKDevice& device, const VideoCommon::Shader::ShaderIR& ir,
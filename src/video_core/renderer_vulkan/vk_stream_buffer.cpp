@@ -3,8 +3,6 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <memory>
-#include <optional>
 #include <vector>
 
 #include "common/assert.h"
@@ -17,16 +15,13 @@
 
 namespace Vulkan {
 
-constexpr u64 WATCHES_INITIAL_RESERVE = 0x4000;
-constexpr u64 WATCHES_RESERVE_CHUNK = 0x1000;
-
-VKStreamBuffer::VKStreamBuffer(const VKDevice& device, VKMemoryManager& memory_manager,
-                               VKScheduler& scheduler, u64 size, vk::BufferUsageFlags usage,
-                               vk::AccessFlags access, vk::PipelineStageFlags pipeline_stage)
-    : device{device}, scheduler{scheduler}, buffer_size{size}, access{access}, pipeline_stage{
-                                                                                   pipeline_stage} {
+VKStreamBuffer::VKStreamBuffer(const VKDevice& device, VKResourceManager& resource_manager,
+                               VKMemoryManager& memory_manager, VKScheduler& scheduler, u64 size,
+                               vk::BufferUsageFlags usage, vk::AccessFlags access,
+                               vk::PipelineStageFlags pipeline_stage)
+    : device{device}, resource_manager{resource_manager}, scheduler{scheduler}, buffer_size{size},
+      access{access}, pipeline_stage{pipeline_stage} {
     CreateBuffers(memory_manager, usage);
-    ReserveWatches(WATCHES_INITIAL_RESERVE);
 }
 
 VKStreamBuffer::~VKStreamBuffer() = default;
@@ -36,39 +31,64 @@ std::tuple<u8*, u64, bool> VKStreamBuffer::Reserve(u64 size) {
     mapped_size = size;
 
     if (offset + size > buffer_size) {
-        // The buffer would overflow, save the amount of used buffers, signal an invalidation and
-        // reset the state.
-        invalidation_mark = used_watches;
-        used_watches = 0;
+        // The buffer would overflow, wrap it and signal an invalidation. Regions of the previous
+        // pass that have not been reached yet are older than the ones of the last pass.
+        previous_watches.erase(previous_watches.begin(), previous_watches.begin() + wait_cursor);
+        const auto last_end = current_watches.empty() ? 0 : current_watches.back().end;
+        const auto first_pending = std::find_if(previous_watches.begin(), previous_watches.end(),
+                                                [last_end](const Watch& watch) {
+                                                    return watch.end > last_end;
+                                                });
+        previous_watches.erase(previous_watches.begin(), first_pending);
+        previous_watches.insert(previous_watches.begin(), current_watches.begin(),
+                                current_watches.end());
+        current_watches.clear();
+        wait_cursor = 0;
+        is_invalidated = true;
         offset = 0;
     }
+    WaitPendingOperations(offset + size);
 
-    return {mapped_pointer + offset, offset, invalidation_mark.has_value()};
+    return {mapped_pointer + offset, offset, is_invalidated};
 }
 
 VKExecutionContext VKStreamBuffer::Send(VKExecutionContext exctx, u64 size) {
     ASSERT_MSG(size <= mapped_size, "Reserved size is too small");
 
-    if (invalidation_mark) {
-        // TODO(Rodrigo): Find a better way to invalidate than waiting for all watches to finish.
-        exctx = scheduler.Flush();
-        std::for_each(watches.begin(), watches.begin() + *invalidation_mark,
-                      [&](auto& resource) { resource->Wait(); });
-        invalidation_mark = std::nullopt;
-    }
+    // Reserve may have flushed the context the caller holds
+    exctx = scheduler.GetExecutionContext();
+    is_invalidated = false;
 
-    if (used_watches + 1 >= watches.size()) {
-        // Ensure that there are enough watches.
-        ReserveWatches(WATCHES_RESERVE_CHUNK);
+    const u64 tick = exctx.GetFence().GetTick();
+    if (!current_watches.empty() && current_watches.back().tick == tick) {
+        current_watches.back().end = offset + size;
+    } else {
+        current_watches.push_back({offset, offset + size, tick});
     }
-    // Add a watch for this allocation.
-    watches[used_watches++]->Watch(exctx.GetFence());
-
     offset += size;
 
     return exctx;
 }
 
+void VKStreamBuffer::WaitPendingOperations(u64 end) {
+    u64 wait_tick = 0;
+    for (; wait_cursor < previous_watches.size(); ++wait_cursor) {
+        const Watch& watch = previous_watches[wait_cursor];
+        if (watch.begin >= end) {
+            break;
+        }
+        wait_tick = std::max(wait_tick, watch.tick);
+    }
+    if (wait_tick == 0 || resource_manager.IsTickComplete(wait_tick)) {
+        return;
+    }
+    if (wait_tick == scheduler.GetExecutionContext().GetFence().GetTick()) {
+        // The region is used by commands that have not been submitted yet
+        scheduler.Flush();
+    }
+    resource_manager.WaitTick(wait_tick);
+}
+
 void VKStreamBuffer::CreateBuffers(VKMemoryManager& memory_manager, vk::BufferUsageFlags usage) {
     const vk::BufferCreateInfo buffer_ci({}, buffer_size, usage, vk::SharingMode::eExclusive, 0,
                                          nullptr);
@@ -80,11 +100,4 @@ void VKStreamBuffer::CreateBuffers(VKMemoryManager& memory_manager, vk::BufferUs
     mapped_pointer = commit->GetData();
 }
 
-void VKStreamBuffer::ReserveWatches(std::size_t grow_size) {
-    const std::size_t previous_size = watches.size();
-    watches.resize(previous_size + grow_size);
-    std::generate(watches.begin() + previous_size, watches.end(),
-                  []() { return std::make_unique<VKFenceWatch>(); });
-}
-
 } // namespace Vulkan
@@ -4,8 +4,6 @@
 
 #pragma once
 
-#include <memory>
-#include <optional>
 #include <tuple>
 #include <vector>
 
@@ -16,20 +14,21 @@
 namespace Vulkan {
 
 class VKDevice;
-class VKFence;
-class VKFenceWatch;
 class VKResourceManager;
 class VKScheduler;
 
 class VKStreamBuffer {
 public:
-    explicit VKStreamBuffer(const VKDevice& device, VKMemoryManager& memory_manager,
-                            VKScheduler& scheduler, u64 size, vk::BufferUsageFlags usage,
-                            vk::AccessFlags access, vk::PipelineStageFlags pipeline_stage);
+    explicit VKStreamBuffer(const VKDevice& device, VKResourceManager& resource_manager,
+                            VKMemoryManager& memory_manager, VKScheduler& scheduler, u64 size,
+                            vk::BufferUsageFlags usage, vk::AccessFlags access,
+                            vk::PipelineStageFlags pipeline_stage);
     ~VKStreamBuffer();
 
     /**
-     * Reserves a region of memory from the stream buffer.
+     * Reserves a region of memory from the stream buffer. It waits for the GPU to finish the
+     * submissions that used the region. When the region is used by the current execution context,
+     * the scheduler is flushed; use the execution context returned by Send afterwards.
      * @param size Size to reserve.
      * @returns A tuple in the following order: Raw memory pointer (with offset added), buffer
      * offset and a boolean that's true when buffer has been invalidated.
@@ -47,10 +46,18 @@ private:
     /// Creates Vulkan buffer handles committing the required the required memory.
     void CreateBuffers(VKMemoryManager& memory_manager, vk::BufferUsageFlags usage);
 
-    /// Increases the amount of watches available.
-    void ReserveWatches(std::size_t grow_size);
+    /// Waits for the submissions using the previous contents of the buffer before "end".
+    void WaitPendingOperations(u64 end);
+
+    /// Region of the buffer used by a submission.
+    struct Watch {
+        u64 begin;
+        u64 end;
+        u64 tick;
+    };
 
     const VKDevice& device;                      ///< Vulkan device manager.
+    VKResourceManager& resource_manager;         ///< Tracker of the submissions completed.
     VKScheduler& scheduler;                      ///< Command scheduler.
     const u64 buffer_size;                       ///< Total size of the stream buffer.
     const vk::AccessFlags access;                ///< Access usage of this stream buffer.
@@ -63,10 +70,10 @@ private:
     u64 offset{};      ///< Buffer iterator.
     u64 mapped_size{}; ///< Size reserved for the current copy.
 
-    std::vector<std::unique_ptr<VKFenceWatch>> watches; ///< Total watches
-    std::size_t used_watches{}; ///< Count of watches, reset on invalidation.
-    std::optional<std::size_t>
-        invalidation_mark{}; ///< Number of watches used in the current invalidation.
+    std::vector<Watch> current_watches;  ///< Regions used since the buffer was last wrapped.
+    std::vector<Watch> previous_watches; ///< Regions used before the buffer was last wrapped.
+    std::size_t wait_cursor{};           ///< First previous watch that has not been waited.
+    bool is_invalidated{};               ///< The buffer has wrapped since the last Send.
 };
 
 } // namespace Vulkan
@@ -2,16 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "common/cityhash.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "video_core/sampler_cache.h"
 
 namespace VideoCommon {
 
 std::size_t SamplerCacheKey::Hash() const {
-    static_assert(sizeof(raw) % sizeof(u64) == 0);
-    return static_cast<std::size_t>(
-        Common::CityHash64(reinterpret_cast<const char*>(raw.data()), sizeof(raw) / sizeof(u64)));
+    return static_cast<std::size_t>(Common::ComputeStructHash64(raw));
 }
 
 bool SamplerCacheKey::operator==(const SamplerCacheKey& rhs) const {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <unordered_map>
 
@@ -48,13 +49,41 @@ public:
         return ToSamplerType(sampler);
     }
 
+    /**
+     * Gets the sampler of a TSC entry bound to the given slot. When the slot had the same entry in
+     * the previous lookup, its sampler is returned without hashing the entry. Samplers are never
+     * released, so the remembered ones can't go stale.
+     */
+    SamplerType GetSampler(const Tegra::Texture::TSCEntry& tsc, std::size_t slot) {
+        if (slot >= slots.size()) {
+            return GetSampler(tsc);
+        }
+        Slot& cached = slots[slot];
+        if (!cached.is_valid || cached.raw != tsc.raw) {
+            cached.raw = tsc.raw;
+            cached.sampler = GetSampler(tsc);
+            cached.is_valid = true;
+        }
+        return cached.sampler;
+    }
+
 protected:
     virtual SamplerStorageType CreateSampler(const Tegra::Texture::TSCEntry& tsc) const = 0;
 
     virtual SamplerType ToSamplerType(const SamplerStorageType& sampler) const = 0;
 
 private:
+    /// Number of binding slots whose last sampler is remembered
+    static constexpr std::size_t NumSlots = 64;
+
+    struct Slot {
+        decltype(Tegra::Texture::TSCEntry::raw) raw{};
+        SamplerType sampler{};
+        bool is_valid = false;
+    };
+
     std::unordered_map<SamplerCacheKey, SamplerStorageType> cache;
+    std::array<Slot, NumSlots> slots;
 };
 
 } // namespace VideoCommon
\ No newline at end of file
@@ -0,0 +1,404 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/logging/log.h"
+#include "video_core/shader/shader_ir.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+
+/// Depth of the flow stack emulated by the backends
+constexpr std::size_t MaxFlowStackDepth = 20;
+
+constexpr std::size_t InvalidPosition = std::numeric_limits<std::size_t>::max();
+
+enum class Terminator {
+    Fallthrough, ///< Execution continues on the next block
+    Jump,        ///< Execution continues on target when condition is met
+    Pop,         ///< Execution continues on the popped address when condition is met
+    Return,      ///< The program ends
+};
+
+/// Straight-line piece of a basic block, ended by its first flow instruction
+struct FlowBlock {
+    NodeBlock code;
+    std::vector<u32> pushes; ///< Addresses pushed to the flow stack, in order
+    Terminator terminator = Terminator::Fallthrough;
+    Node condition{}; ///< Null when the terminator is unconditional
+    u32 target = 0;   ///< Branch target of a jump, resolved popped address of a pop
+    std::vector<u32> stack;
+    bool is_reachable = false;
+};
+
+bool IsFlowOperation(OperationCode code) {
+    return code == OperationCode::Branch || code == OperationCode::PushFlowStack ||
+           code == OperationCode::PopFlowStack;
+}
+
+bool ContainsFlow(Node node) {
+    if (const auto operation = std::get_if<OperationNode>(node)) {
+        return IsFlowOperation(operation->GetCode());
+    }
+    if (const auto conditional = std::get_if<ConditionalNode>(node)) {
+        const auto& code = conditional->GetCode();
+        return std::any_of(code.begin(), code.end(), ContainsFlow);
+    }
+    return false;
+}
+
+std::optional<u32> GetImmediateOperand(const OperationNode& operation) {
+    if (operation.GetOperandsCount() != 1) {
+        return {};
+    }
+    if (const auto immediate = std::get_if<ImmediateNode>(operation[0])) {
+        return immediate->GetValue();
+    }
+    return {};
+}
+
+class Structurizer final {
+public:
+    using OperationFactory = std::function<Node(OperationCode, NodeBlock&&)>;
+
+    explicit Structurizer(const std::map<u32, NodeBlock>& basic_blocks,
+                          OperationFactory make_operation)
+        : basic_blocks{basic_blocks}, make_operation{std::move(make_operation)} {}
+
+    std::optional<StructuredBlock> Run() {
+        if (!SplitBlocks() || !ResolveFlowStack()) {
+            return {};
+        }
+        return BuildProgram();
+    }
+
+private:
+    struct Region {
+        std::size_t loop_header = InvalidPosition;
+        std::size_t loop_exit = InvalidPosition;
+        /// Position reached by the unconditional jump ending the region ending at alias_end. The
+        /// then scope of an if-else reaches the end of the else scope this way.
+        std::size_t alias_target = InvalidPosition;
+        std::size_t alias_end = InvalidPosition;
+    };
+
+    bool SplitBlocks() {
+        for (const auto& [address, basic_block] : basic_blocks) {
+            address_to_index.emplace(address, blocks.size());
+            FlowBlock* block = &blocks.emplace_back();
+            const auto end_block = [&] { block = &blocks.emplace_back(); };
+
+            for (const Node node : basic_block) {
+                if (!ContainsFlow(node)) {
+                    block->code.push_back(node);
+                    if (const auto operation = std::get_if<OperationNode>(node);
+                        operation && operation->GetCode() == OperationCode::Exit) {
+                        block->terminator = Terminator::Return;
+                        end_block();
+                    }
+                    continue;
+                }
+
+                // Conditional flow instructions are wrapped by the condition code and predicate
+                // tests of the instruction
+                Node condition{};
+                Node flow = node;
+                while (const auto conditional = std::get_if<ConditionalNode>(flow)) {
+                    if (conditional->GetCode().size() != 1) {
+                        return false;
+                    }
+                    condition = condition ? make_operation(OperationCode::LogicalAnd,
+                                                           {condition, conditional->GetCondition()})
+                                          : conditional->GetCondition();
+                    flow = conditional->GetCode()[0];
+                }
+
+                const auto& operation = std::get<OperationNode>(*flow);
+                switch (operation.GetCode()) {
+                case OperationCode::PushFlowStack: {
+                    const auto target = GetImmediateOperand(operation);
+                    if (condition || !target) {
+                        return false;
+                    }
+                    block->pushes.push_back(*target);
+                    break;
+                }
+                case OperationCode::Branch: {
+                    const auto target = GetImmediateOperand(operation);
+                    if (!target) {
+                        return false;
+                    }
+                    block->terminator = Terminator::Jump;
+                    block->condition = condition;
+                    block->target = *target;
+                    end_block();
+                    break;
+                }
+                case OperationCode::PopFlowStack:
+                    block->terminator = Terminator::Pop;
+                    block->condition = condition;
+                    end_block();
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Walks the blocks keeping track of the flow stack. Every block has to be reached with the
+    /// same stack, this way the address popped by each pop is known ahead of time.
+    bool ResolveFlowStack() {
+        std::vector<std::pair<std::size_t, std::vector<u32>>> pending;
+        pending.emplace_back(0, std::vector<u32>{});
+
+        while (!pending.empty()) {
+            auto [index, stack] = std::move(pending.back());
+            pending.pop_back();
+            if (index >= blocks.size()) {
+                // Execution falls off the end of the program
+                return false;
+            }
+
+            FlowBlock& block = blocks[index];
+            if (block.is_reachable) {
+                if (block.stack != stack) {
+                    return false;
+                }
+                continue;
+            }
+            block.is_reachable = true;
+            block.stack = stack;
+
+            stack.insert(stack.end(), block.pushes.begin(), block.pushes.end());
+            if (stack.size() > MaxFlowStackDepth) {
+                return false;
+            }
+
+            switch (block.terminator) {
+            case Terminator::Fallthrough:
+                pending.emplace_back(index + 1, std::move(stack));
+                break;
+            case Terminator::Jump: {
+                const auto target = address_to_index.find(block.target);
+                if (target == address_to_index.end()) {
+                    return false;
+                }
+                if (block.condition) {
+                    pending.emplace_back(index + 1, stack);
+                }
+                pending.emplace_back(target->second, std::move(stack));
+                break;
+            }
+            case Terminator::Pop: {
+                if (stack.empty()) {
+                    return false;
+                }
+                block.target = stack.back();
+                const auto target = address_to_index.find(block.target);
+                if (target == address_to_index.end()) {
+                    return false;
+                }
+                if (block.condition) {
+                    pending.emplace_back(index + 1, stack);
+                }
+                stack.pop_back();
+                pending.emplace_back(target->second, std::move(stack));
+                break;
+            }
+            case Terminator::Return:
+                break;
+            }
+        }
+        return true;
+    }
+
+    std::optional<StructuredBlock> BuildProgram() {
+        std::vector<std::size_t> index_to_position(blocks.size(), InvalidPosition);
+        for (std::size_t index = 0; index < blocks.size(); ++index) {
+            if (blocks[index].is_reachable) {
+                index_to_position[index] = order.size();
+                order.push_back(index);
+            }
+        }
+
+        targets.resize(order.size(), InvalidPosition);
+        for (std::size_t position = 0; position < order.size(); ++position) {
+            const FlowBlock& block = blocks[order[position]];
+            if (block.terminator == Terminator::Jump || block.terminator == Terminator::Pop) {
+                targets[position] = index_to_position[address_to_index.at(block.target)];
+            }
+        }
+
+        StructuredBlock program;
+        if (!Structure(0, order.size(), {}, false, program)) {
+            return {};
+        }
+        return program;
+    }
+
+    const FlowBlock& GetBlock(std::size_t position) const {
+        return blocks[order[position]];
+    }
+
+    bool IsJump(std::size_t position) const {
+        const Terminator terminator = GetBlock(position).terminator;
+        return terminator == Terminator::Jump || terminator == Terminator::Pop;
+    }
+
+    /// Returns the end of the loop headed at begin, if there's any
+    std::optional<std::size_t> FindLoop(std::size_t begin, std::size_t end) const {
+        std::size_t latch = InvalidPosition;
+        for (std::size_t position = begin; position < end; ++position) {
+            if (IsJump(position) && targets[position] == begin) {
+                latch = position;
+            }
+        }
+        if (latch == InvalidPosition) {
+            return {};
+        }
+
+        // Forward jumps leaving the loop from inside the region grow the loop body, so all of
+        // them reach the same exit
+        std::size_t exit = latch + 1;
+        for (bool has_grown = true; has_grown;) {
+            has_grown = false;
+            for (std::size_t position = begin; position < exit; ++position) {
+                if (IsJump(position) && targets[position] > exit && targets[position] <= end) {
+                    exit = targets[position];
+                    has_grown = true;
+                }
+            }
+        }
+        return exit;
+    }
+
+    StructuredNode MakeNode(StructuredNode::Type type, Node condition = nullptr) const {
+        StructuredNode node;
+        node.type = type;
+        node.condition = condition;
+        return node;
+    }
+
+    bool Structure(std::size_t begin, std::size_t end, const Region& region, bool is_loop_body,
+                   StructuredBlock& out) {
+        for (std::size_t position = begin; position < end;) {
+            if (!is_loop_body || position != begin) {
+                if (const auto loop_exit = FindLoop(position, end)) {
+                    Region loop_region = region;
+                    loop_region.loop_header = position;
+                    loop_region.loop_exit = *loop_exit;
+
+                    StructuredNode loop = MakeNode(StructuredNode::Type::Loop);
+                    if (!Structure(position, *loop_exit, loop_region, true, loop.then_block)) {
+                        return false;
+                    }
+                    loop.then_block.push_back(MakeNode(StructuredNode::Type::Break));
+                    out.push_back(std::move(loop));
+                    position = *loop_exit;
+                    continue;
+                }
+            }
+
+            const FlowBlock& block = GetBlock(position);
+            if (!block.code.empty()) {
+                StructuredNode code = MakeNode(StructuredNode::Type::Code);
+                code.code = block.code;
+                out.push_back(std::move(code));
+            }
+            if (!IsJump(position)) {
+                ++position;
+                continue;
+            }
+
+            const std::size_t target = targets[position];
+            const Node condition = block.condition;
+            if (target == region.loop_header) {
+                out.push_back(MakeNode(StructuredNode::Type::Continue, condition));
+                ++position;
+                continue;
+            }
+            if (target == region.loop_exit) {
+                out.push_back(MakeNode(StructuredNode::Type::Break, condition));
+                ++position;
+                continue;
+            }
+            if (target == position + 1) {
+                ++position;
+                continue;
+            }
+            if (!condition) {
+                if (position + 1 == end && end == region.alias_end &&
+                    target == region.alias_target) {
+                    ++position;
+                    continue;
+                }
+                return false;
+            }
+            if (target <= position || target > end) {
+                return false;
+            }
+
+            // The jump skips a scope executed when the condition is not met
+            StructuredNode branch = MakeNode(
+                StructuredNode::Type::If, make_operation(OperationCode::LogicalNegate, {condition}));
+            const std::size_t then_last = target - 1;
+            const std::size_t else_end = targets[then_last];
+            if (IsJump(then_last) && !GetBlock(then_last).condition && else_end > target &&
+                else_end <= end && else_end != region.loop_header &&
+                else_end != region.loop_exit) {
+                Region then_region = region;
+                then_region.alias_target = else_end;
+                then_region.alias_end = target;
+                if (!Structure(position + 1, target, then_region, false, branch.then_block) ||
+                    !Structure(target, else_end, region, false, branch.else_block)) {
+                    return false;
+                }
+                position = else_end;
+            } else {
+                if (!Structure(position + 1, target, region, false, branch.then_block)) {
+                    return false;
+                }
+                position = target;
+            }
+            out.push_back(std::move(branch));
+        }
+        return true;
+    }
+
+    const std::map<u32, NodeBlock>& basic_blocks;
+    OperationFactory make_operation;
+
+    std::vector<FlowBlock> blocks;
+    std::unordered_map<u32, std::size_t> address_to_index;
+
+    /// Indices of the reachable blocks, in program order
+    std::vector<std::size_t> order;
+    /// Position of the block jumped to by the block at each position
+    std::vector<std::size_t> targets;
+};
+
+} // Anonymous namespace
+
+void ShaderIR::StructurizeFlow() {
+    Structurizer structurizer(basic_blocks, [this](OperationCode code, NodeBlock&& operands) {
+        return Operation(code, std::move(operands));
+    });
+    structured_program = structurizer.Run();
+    if (!structured_program) {
+        LOG_DEBUG(HW_GPU, "Shader control flow can't be structured, dispatching basic blocks");
+    }
+}
+
+} // namespace VideoCommon::Shader
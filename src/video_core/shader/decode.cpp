@@ -58,17 +58,19 @@ void ShaderIR::Decode() {
 
     if (labels.empty()) {
         basic_blocks.insert({main_offset, DecodeRange(main_offset, MAX_PROGRAM_LENGTH)});
-        return;
-    }
-
-    labels.insert(main_offset);
+    } else {
+        labels.insert(main_offset);
 
-    for (const u32 label : labels) {
-        const auto next_it = labels.lower_bound(label + 1);
-        const u32 next_label = next_it == labels.end() ? MAX_PROGRAM_LENGTH : *next_it;
+        for (const u32 label : labels) {
+            const auto next_it = labels.lower_bound(label + 1);
+            const u32 next_label = next_it == labels.end() ? MAX_PROGRAM_LENGTH : *next_it;
 
-        basic_blocks.insert({label, DecodeRange(label, next_label)});
+            basic_blocks.insert({label, DecodeRange(label, next_label)});
+        }
     }
+
+    Optimize();
+    StructurizeFlow();
 }
 
 ExitMethod ShaderIR::Scan(u32 begin, u32 end, std::set<u32>& labels) {
@@ -70,6 +70,24 @@ u32 ShaderIR::DecodeOther(NodeBlock& bb, u32 pc) {
             SetRegister(bb, instr.gpr0, Operation(OperationCode::YNegate));
             break;
         }
+        case Tegra::Shader::SystemVariable::TidX:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::LocalInvocationIdX));
+            break;
+        case Tegra::Shader::SystemVariable::TidY:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::LocalInvocationIdY));
+            break;
+        case Tegra::Shader::SystemVariable::TidZ:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::LocalInvocationIdZ));
+            break;
+        case Tegra::Shader::SystemVariable::CtaIdX:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::WorkGroupIdX));
+            break;
+        case Tegra::Shader::SystemVariable::CtaIdY:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::WorkGroupIdY));
+            break;
+        case Tegra::Shader::SystemVariable::CtaIdZ:
+            SetRegister(bb, instr.gpr0, Operation(OperationCode::WorkGroupIdZ));
+            break;
         default:
             UNIMPLEMENTED_MSG("Unhandled system move: {}", static_cast<u32>(instr.sys20.Value()));
         }
@@ -183,6 +201,18 @@ u32 ShaderIR::DecodeOther(NodeBlock& bb, u32 pc) {
         LOG_WARNING(HW_GPU, "DEPBAR instruction is stubbed");
         break;
     }
+    case OpCode::Id::BAR: {
+        // Only the barrier waiting for all the threads of the block is implemented, it is the
+        // one kernels use to synchronize their shared memory accesses
+        UNIMPLEMENTED_IF_MSG(instr.value != 0xF0A81B8000070000ULL, "BAR is not BAR.SYNC 0x0");
+        bb.push_back(Operation(OperationCode::Barrier));
+        break;
+    }
+    case OpCode::Id::MEMBAR: {
+        // All the scopes are treated as the strongest one
+        bb.push_back(Operation(OperationCode::MemoryBarrierGL));
+        break;
+    }
     default:
         UNIMPLEMENTED_MSG("Unhandled instruction: {}", opcode->get().GetName());
     }
@@ -163,10 +163,11 @@ u32 ShaderIR::DecodeTexture(NodeBlock& bb, u32 pc) {
         // TODO: The new commits on the texture refactor, change the way samplers work.
         // Sadly, not all texture instructions specify the type of texture their sampler
         // uses. This must be fixed at a later instance.
+        Node index;
         const auto& sampler =
             is_bindless
                 ? GetBindlessSampler(instr.gpr8, Tegra::Shader::TextureType::Texture2D, false,
-                                     false)
+                                     false, index)
                 : GetSampler(instr.sampler, Tegra::Shader::TextureType::Texture2D, false, false);
 
         u32 indexer = 0;
@@ -176,7 +177,7 @@ u32 ShaderIR::DecodeTexture(NodeBlock& bb, u32 pc) {
                 if (!instr.txq.IsComponentEnabled(element)) {
                     continue;
                 }
-                MetaTexture meta{sampler, {}, {}, {}, {}, {}, {}, element};
+                MetaTexture meta{sampler, {}, {}, {}, {}, {}, {}, element, index};
                 const Node value =
                     Operation(OperationCode::TextureQueryDimensions, meta,
                               GetRegister(instr.gpr8.Value() + (is_bindless ? 1 : 0)));
@@ -206,9 +207,10 @@ u32 ShaderIR::DecodeTexture(NodeBlock& bb, u32 pc) {
 
         auto texture_type = instr.tmml.texture_type.Value();
         const bool is_array = instr.tmml.array != 0;
-        const auto& sampler = is_bindless
-                                  ? GetBindlessSampler(instr.gpr20, texture_type, is_array, false)
-                                  : GetSampler(instr.sampler, texture_type, is_array, false);
+        Node index;
+        const auto& sampler =
+            is_bindless ? GetBindlessSampler(instr.gpr20, texture_type, is_array, false, index)
+                        : GetSampler(instr.sampler, texture_type, is_array, false);
 
         std::vector<Node> coords;
 
@@ -235,7 +237,7 @@ u32 ShaderIR::DecodeTexture(NodeBlock& bb, u32 pc) {
                 continue;
             }
             auto params = coords;
-            MetaTexture meta{sampler, {}, {}, {}, {}, {}, {}, element};
+            MetaTexture meta{sampler, {}, {}, {}, {}, {}, {}, element, index};
             const Node value = Operation(OperationCode::TextureQueryLod, meta, std::move(params));
             SetTemporal(bb, indexer++, value);
         }
@@ -287,15 +289,29 @@ const Sampler& ShaderIR::GetSampler(const Tegra::Shader::Sampler& sampler, Textu
 }
 
 const Sampler& ShaderIR::GetBindlessSampler(const Tegra::Shader::Register& reg, TextureType type,
-                                            bool is_array, bool is_shadow) {
+                                            bool is_array, bool is_shadow, Node& index) {
     const Node sampler_register = GetRegister(reg);
-    const Node base_sampler =
-        TrackCbuf(sampler_register, global_code, static_cast<s64>(global_code.size()));
-    const auto cbuf = std::get_if<CbufNode>(base_sampler);
-    const auto cbuf_offset_imm = std::get_if<ImmediateNode>(cbuf->GetOffset());
-    ASSERT(cbuf_offset_imm != nullptr);
-    const auto cbuf_offset = cbuf_offset_imm->GetValue();
-    const auto cbuf_index = cbuf->GetIndex();
+    const auto cursor = static_cast<s64>(global_code.size());
+
+    u32 cbuf_index{};
+    u32 cbuf_offset{};
+    std::size_t size = 1;
+    index = nullptr;
+    if (const auto cbuf = std::get_if<CbufNode>(TrackCbuf(sampler_register, global_code, cursor))) {
+        cbuf_index = cbuf->GetIndex();
+        cbuf_offset = std::get<ImmediateNode>(*cbuf->GetOffset()).GetValue();
+    } else if (const auto [dynamic, indexed_cbuf, base] =
+                   TrackIndexedCbuf(sampler_register, global_code, cursor);
+               dynamic) {
+        // The handle is selected from consecutive words of the const buffer, bind a bounded
+        // array of samplers starting at the base offset and index it with the register
+        index = dynamic;
+        cbuf_index = indexed_cbuf;
+        cbuf_offset = base;
+        size = INDEXED_SAMPLER_SIZE;
+    } else {
+        UNIMPLEMENTED_MSG("Untracked bindless sampler handle");
+    }
     const auto cbuf_key = (static_cast<u64>(cbuf_index) << 32) | static_cast<u64>(cbuf_offset);
 
     // If this sampler has already been used, return the existing mapping.
@@ -304,13 +320,13 @@ const Sampler& ShaderIR::GetBindlessSampler(const Tegra::Shader::Register& reg,
                      [&](const Sampler& entry) { return entry.GetOffset() == cbuf_key; });
     if (itr != used_samplers.end()) {
         ASSERT(itr->GetType() == type && itr->IsArray() == is_array &&
-               itr->IsShadow() == is_shadow);
+               itr->IsShadow() == is_shadow && itr->GetSize() == size);
         return *itr;
     }
 
     // Otherwise create a new mapping for this sampler
     const std::size_t next_index = used_samplers.size();
-    const Sampler entry{cbuf_index, cbuf_offset, next_index, type, is_array, is_shadow};
+    const Sampler entry{cbuf_index, cbuf_offset, next_index, type, is_array, is_shadow, size};
     return *used_samplers.emplace(entry).first;
 }
 
@@ -396,9 +412,10 @@ Node4 ShaderIR::GetTextureCode(Instruction instr, TextureType texture_type,
                              (texture_type == TextureType::TextureCube && is_array && is_shadow),
                          "This method is not supported.");
 
-    const auto& sampler = is_bindless
-                              ? GetBindlessSampler(*bindless_reg, texture_type, is_array, is_shadow)
-                              : GetSampler(instr.sampler, texture_type, is_array, is_shadow);
+    Node index;
+    const auto& sampler =
+        is_bindless ? GetBindlessSampler(*bindless_reg, texture_type, is_array, is_shadow, index)
+                    : GetSampler(instr.sampler, texture_type, is_array, is_shadow);
 
     const bool lod_needed = process_mode == TextureProcessMode::LZ ||
                             process_mode == TextureProcessMode::LL ||
@@ -441,7 +458,7 @@ Node4 ShaderIR::GetTextureCode(Instruction instr, TextureType texture_type,
     Node4 values;
     for (u32 element = 0; element < values.size(); ++element) {
         auto copy_coords = coords;
-        MetaTexture meta{sampler, array, depth_compare, aoffi, bias, lod, {}, element};
+        MetaTexture meta{sampler, array, depth_compare, aoffi, bias, lod, {}, element, index};
         values[element] = Operation(read_method, meta, std::move(copy_coords));
     }
 
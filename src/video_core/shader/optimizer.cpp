@@ -0,0 +1,565 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "common/common_types.h"
+#include "common/logging/log.h"
+#include "video_core/shader/shader_ir.h"
+
+namespace VideoCommon::Shader {
+
+using Tegra::Shader::Pred;
+using Tegra::Shader::Register;
+
+namespace {
+
+/// SPH type of pixel shader headers. The rest of the stages use the same header type.
+constexpr u32 PixelShaderHeaderType = 2;
+
+struct OptimizationStats {
+    std::size_t folded_operations{};
+    std::size_t removed_casts{};
+    std::size_t removed_conditionals{};
+    std::size_t removed_register_writes{};
+    std::size_t removed_predicate_writes{};
+    std::size_t removed_flag_writes{};
+};
+
+/// Registers, predicates and internal flags referenced by a program
+struct Usage {
+    std::set<u32> registers;
+    std::set<Pred> predicates;
+    std::set<InternalFlag> flags;
+};
+
+bool IsConstantPredicate(Pred index) {
+    return index == Pred::UnusedIndex || index == Pred::NeverExecute;
+}
+
+std::optional<u32> GetImmediateValue(Node node) {
+    if (const auto immediate = std::get_if<ImmediateNode>(node)) {
+        return immediate->GetValue();
+    }
+    return {};
+}
+
+std::optional<bool> GetBoolValue(Node node) {
+    const auto predicate = std::get_if<PredicateNode>(node);
+    if (!predicate) {
+        return {};
+    }
+    switch (predicate->GetIndex()) {
+    case Pred::UnusedIndex:
+        return !predicate->IsNegated();
+    case Pred::NeverExecute:
+        return predicate->IsNegated();
+    default:
+        return {};
+    }
+}
+
+/// Returns the operand of node when it's an operation of the given code
+Node GetOperandOf(Node node, OperationCode code) {
+    const auto operation = std::get_if<OperationNode>(node);
+    if (!operation || operation->GetCode() != code || operation->GetOperandsCount() != 1) {
+        return nullptr;
+    }
+    return (*operation)[0];
+}
+
+bool IsNormalOrZero(f32 value) {
+    return value == 0.0f || std::isnormal(value);
+}
+
+u32 FloatBits(f32 value) {
+    u32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+f32 BitsFloat(u32 bits) {
+    f32 value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+class Optimizer final {
+public:
+    using NodeStorage = std::function<Node(NodeData&&)>;
+
+    explicit Optimizer(std::map<u32, NodeBlock>& basic_blocks, bool has_implicit_register_reads,
+                       NodeStorage store)
+        : basic_blocks{basic_blocks},
+          has_implicit_register_reads{has_implicit_register_reads}, store{std::move(store)} {}
+
+    void Run() {
+        for (auto& [address, block] : basic_blocks) {
+            block = FoldBlock(block);
+        }
+
+        // Removing a write can leave the writes feeding it unused, iterate until nothing changes
+        while (true) {
+            CollectUsage();
+            bool has_removed = false;
+            for (auto& [address, block] : basic_blocks) {
+                has_removed |= RemoveDeadWrites(block);
+            }
+            if (!has_removed) {
+                break;
+            }
+        }
+    }
+
+    const OptimizationStats& GetStats() const {
+        return stats;
+    }
+
+    /// Returns the registers, predicates and flags read or written by the optimized program
+    Usage GetUsage() const {
+        Usage usage = reads;
+        usage.registers.insert(writes.registers.begin(), writes.registers.end());
+        usage.predicates.insert(writes.predicates.begin(), writes.predicates.end());
+        usage.flags.insert(writes.flags.begin(), writes.flags.end());
+        return usage;
+    }
+
+private:
+    NodeBlock FoldBlock(const NodeBlock& block) {
+        NodeBlock result;
+        for (const Node node : block) {
+            const auto conditional = std::get_if<ConditionalNode>(node);
+            if (!conditional) {
+                result.push_back(Fold(node));
+                continue;
+            }
+
+            const Node condition = Fold(conditional->GetCondition());
+            if (const auto value = GetBoolValue(condition)) {
+                ++stats.removed_conditionals;
+                if (*value) {
+                    const NodeBlock code = FoldBlock(conditional->GetCode());
+                    result.insert(result.end(), code.begin(), code.end());
+                }
+                continue;
+            }
+            NodeBlock code = FoldBlock(conditional->GetCode());
+            if (condition == conditional->GetCondition() && code == conditional->GetCode()) {
+                result.push_back(node);
+            } else {
+                result.push_back(store(ConditionalNode(condition, std::move(code))));
+            }
+        }
+        return result;
+    }
+
+    Node Fold(Node node) {
+        const auto operation = std::get_if<OperationNode>(node);
+        if (!operation) {
+            return node;
+        }
+        if (const auto it = folded_nodes.find(node); it != folded_nodes.end()) {
+            return it->second;
+        }
+
+        NodeBlock operands;
+        bool has_changed = false;
+        for (std::size_t i = 0; i < operation->GetOperandsCount(); ++i) {
+            const Node operand = (*operation)[i];
+            operands.push_back(Fold(operand));
+            has_changed |= operands.back() != operand;
+        }
+
+        Node result = Evaluate(operation->GetCode(), operands);
+        if (!result) {
+            if (has_changed) {
+                Meta meta = operation->GetMeta();
+                result = store(
+                    OperationNode(operation->GetCode(), std::move(meta), std::move(operands)));
+            } else {
+                result = node;
+            }
+        }
+        folded_nodes.emplace(node, result);
+        return result;
+    }
+
+    /// Returns a simpler node computing the same value as the operation, or null when there's none
+    Node Evaluate(OperationCode code, const NodeBlock& operands) {
+        const std::optional<u32> a =
+            operands.size() > 0 ? GetImmediateValue(operands[0]) : std::nullopt;
+        const std::optional<u32> b =
+            operands.size() > 1 ? GetImmediateValue(operands[1]) : std::nullopt;
+        const auto fold = [&](u32 value) {
+            ++stats.folded_operations;
+            return store(ImmediateNode(value));
+        };
+        const auto fold_bool = [&](bool value) {
+            ++stats.folded_operations;
+            return MakeBool(value);
+        };
+        const auto forward = [&](std::size_t index) {
+            ++stats.folded_operations;
+            return operands[index];
+        };
+
+        switch (code) {
+        case OperationCode::Select:
+            if (const auto condition = GetBoolValue(operands[0])) {
+                return forward(*condition ? 1 : 2);
+            }
+            return nullptr;
+
+        case OperationCode::FNegate:
+            return a ? fold(*a ^ 0x80000000) : nullptr;
+        case OperationCode::FAbsolute:
+            return a ? fold(*a & 0x7fffffff) : nullptr;
+        case OperationCode::FAdd:
+        case OperationCode::FMul: {
+            // Denormals might be flushed by the host GPU, only fold values where it doesn't matter
+            if (!a || !b || !IsNormalOrZero(BitsFloat(*a)) || !IsNormalOrZero(BitsFloat(*b))) {
+                return nullptr;
+            }
+            const f32 value = code == OperationCode::FAdd ? BitsFloat(*a) + BitsFloat(*b)
+                                                          : BitsFloat(*a) * BitsFloat(*b);
+            return IsNormalOrZero(value) ? fold(FloatBits(value)) : nullptr;
+        }
+        case OperationCode::FCastInteger:
+            return a ? fold(FloatBits(static_cast<f32>(static_cast<s32>(*a)))) : nullptr;
+        case OperationCode::FCastUInteger:
+            return a ? fold(FloatBits(static_cast<f32>(*a))) : nullptr;
+
+        case OperationCode::IAdd:
+        case OperationCode::UAdd:
+            if (a && b) {
+                return fold(*a + *b);
+            }
+            return a == 0u ? forward(1) : b == 0u ? forward(0) : nullptr;
+        case OperationCode::IMul:
+        case OperationCode::UMul:
+            if (a && b) {
+                return fold(*a * *b);
+            }
+            if (a == 0u || b == 0u) {
+                return fold(0);
+            }
+            return a == 1u ? forward(1) : b == 1u ? forward(0) : nullptr;
+        case OperationCode::INegate:
+            return a ? fold(0u - *a) : nullptr;
+        case OperationCode::IBitwiseAnd:
+        case OperationCode::UBitwiseAnd:
+            if (a && b) {
+                return fold(*a & *b);
+            }
+            if (a == 0u || b == 0u) {
+                return fold(0);
+            }
+            return a == 0xffffffffu ? forward(1) : b == 0xffffffffu ? forward(0) : nullptr;
+        case OperationCode::IBitwiseOr:
+        case OperationCode::UBitwiseOr:
+            if (a && b) {
+                return fold(*a | *b);
+            }
+            return a == 0u ? forward(1) : b == 0u ? forward(0) : nullptr;
+        case OperationCode::IBitwiseXor:
+        case OperationCode::UBitwiseXor:
+            if (a && b) {
+                return fold(*a ^ *b);
+            }
+            return a == 0u ? forward(1) : b == 0u ? forward(0) : nullptr;
+        case OperationCode::IBitwiseNot:
+        case OperationCode::UBitwiseNot:
+            return a ? fold(~*a) : nullptr;
+        case OperationCode::ILogicalShiftLeft:
+        case OperationCode::ULogicalShiftLeft:
+        case OperationCode::ILogicalShiftRight:
+        case OperationCode::ULogicalShiftRight:
+        case OperationCode::IArithmeticShiftRight:
+        case OperationCode::UArithmeticShiftRight: {
+            // Shifting by 32 or more is undefined on the host GPU, leave it as it is
+            if (!b || *b >= 32) {
+                return nullptr;
+            }
+            if (*b == 0) {
+                return forward(0);
+            }
+            if (!a) {
+                return nullptr;
+            }
+            if (code == OperationCode::ILogicalShiftLeft ||
+                code == OperationCode::ULogicalShiftLeft) {
+                return fold(*a << *b);
+            }
+            if (code == OperationCode::ILogicalShiftRight ||
+                code == OperationCode::ULogicalShiftRight) {
+                return fold(*a >> *b);
+            }
+            return fold(static_cast<u32>(static_cast<s32>(*a) >> *b));
+        }
+
+        case OperationCode::ICastUnsigned:
+        case OperationCode::UCastSigned: {
+            // Both casts keep the bits of their operand
+            const OperationCode inverse = code == OperationCode::ICastUnsigned
+                                              ? OperationCode::UCastSigned
+                                              : OperationCode::ICastUnsigned;
+            if (a) {
+                ++stats.removed_casts;
+                return operands[0];
+            }
+            if (const Node original = GetOperandOf(operands[0], inverse)) {
+                ++stats.removed_casts;
+                return original;
+            }
+            return nullptr;
+        }
+
+        case OperationCode::LogicalAnd:
+        case OperationCode::LogicalOr: {
+            // The absorbing value is false for and, true for or
+            const bool absorbing = code == OperationCode::LogicalOr;
+            const std::optional<bool> x = GetBoolValue(operands[0]);
+            const std::optional<bool> y = GetBoolValue(operands[1]);
+            if (x == absorbing || y == absorbing) {
+                return fold_bool(absorbing);
+            }
+            return x ? forward(1) : y ? forward(0) : nullptr;
+        }
+        case OperationCode::LogicalXor: {
+            const std::optional<bool> x = GetBoolValue(operands[0]);
+            const std::optional<bool> y = GetBoolValue(operands[1]);
+            if (x && y) {
+                return fold_bool(*x != *y);
+            }
+            return x == false ? forward(1) : y == false ? forward(0) : nullptr;
+        }
+        case OperationCode::LogicalNegate: {
+            if (const auto predicate = std::get_if<PredicateNode>(operands[0])) {
+                ++stats.folded_operations;
+                return store(PredicateNode(predicate->GetIndex(), !predicate->IsNegated()));
+            }
+            if (const Node original = GetOperandOf(operands[0], OperationCode::LogicalNegate)) {
+                ++stats.folded_operations;
+                return original;
+            }
+            return nullptr;
+        }
+
+        case OperationCode::LogicalIEqual:
+        case OperationCode::LogicalUEqual:
+            return a && b ? fold_bool(*a == *b) : nullptr;
+        case OperationCode::LogicalINotEqual:
+        case OperationCode::LogicalUNotEqual:
+            return a && b ? fold_bool(*a != *b) : nullptr;
+        case OperationCode::LogicalILessThan:
+            return a && b ? fold_bool(static_cast<s32>(*a) < static_cast<s32>(*b)) : nullptr;
+        case OperationCode::LogicalILessEqual:
+            return a && b ? fold_bool(static_cast<s32>(*a) <= static_cast<s32>(*b)) : nullptr;
+        case OperationCode::LogicalIGreaterThan:
+            return a && b ? fold_bool(static_cast<s32>(*a) > static_cast<s32>(*b)) : nullptr;
+        case OperationCode::LogicalIGreaterEqual:
+            return a && b ? fold_bool(static_cast<s32>(*a) >= static_cast<s32>(*b)) : nullptr;
+        case OperationCode::LogicalULessThan:
+            return a && b ? fold_bool(*a < *b) : nullptr;
+        case OperationCode::LogicalULessEqual:
+            return a && b ? fold_bool(*a <= *b) : nullptr;
+        case OperationCode::LogicalUGreaterThan:
+            return a && b ? fold_bool(*a > *b) : nullptr;
+        case OperationCode::LogicalUGreaterEqual:
+            return a && b ? fold_bool(*a >= *b) : nullptr;
+
+        default:
+            return nullptr;
+        }
+    }
+
+    Node MakeBool(bool value) {
+        return store(PredicateNode(value ? Pred::UnusedIndex : Pred::NeverExecute, false));
+    }
+
+    void CollectUsage() {
+        reads = {};
+        writes = {};
+        scanned_nodes.clear();
+        for (const auto& [address, block] : basic_blocks) {
+            for (const Node node : block) {
+                CollectReads(node);
+            }
+        }
+    }
+
+    void CollectReads(Node node) {
+        if (!node) {
+            return;
+        }
+        if (const auto operation = std::get_if<OperationNode>(node)) {
+            if (!scanned_nodes.insert(node).second) {
+                return;
+            }
+            std::size_t first_read = 0;
+            const OperationCode code = operation->GetCode();
+            if (code == OperationCode::Assign || code == OperationCode::LogicalAssign) {
+                first_read = 1;
+                const Node dest = (*operation)[0];
+                if (const auto gpr = std::get_if<GprNode>(dest)) {
+                    writes.registers.insert(gpr->GetIndex());
+                } else if (const auto predicate = std::get_if<PredicateNode>(dest)) {
+                    writes.predicates.insert(predicate->GetIndex());
+                } else if (const auto flag = std::get_if<InternalFlagNode>(dest)) {
+                    writes.flags.insert(flag->GetFlag());
+                } else {
+                    // Memory destinations read their address
+                    first_read = 0;
+                }
+            }
+            for (std::size_t i = first_read; i < operation->GetOperandsCount(); ++i) {
+                CollectReads((*operation)[i]);
+            }
+            if (const auto meta = std::get_if<MetaTexture>(&operation->GetMeta())) {
+                CollectReads(meta->array);
+                CollectReads(meta->depth_compare);
+                CollectReads(meta->bias);
+                CollectReads(meta->lod);
+                CollectReads(meta->component);
+                for (const Node aoffi : meta->aoffi) {
+                    CollectReads(aoffi);
+                }
+            }
+        } else if (const auto conditional = std::get_if<ConditionalNode>(node)) {
+            CollectReads(conditional->GetCondition());
+            for (const Node child : conditional->GetCode()) {
+                CollectReads(child);
+            }
+        } else if (const auto gpr = std::get_if<GprNode>(node)) {
+            reads.registers.insert(gpr->GetIndex());
+        } else if (const auto predicate = std::get_if<PredicateNode>(node)) {
+            reads.predicates.insert(predicate->GetIndex());
+        } else if (const auto flag = std::get_if<InternalFlagNode>(node)) {
+            reads.flags.insert(flag->GetFlag());
+        } else if (const auto abuf = std::get_if<AbufNode>(node)) {
+            CollectReads(abuf->GetPhysicalAddress());
+            CollectReads(abuf->GetBuffer());
+        } else if (const auto cbuf = std::get_if<CbufNode>(node)) {
+            CollectReads(cbuf->GetOffset());
+        } else if (const auto lmem = std::get_if<LmemNode>(node)) {
+            CollectReads(lmem->GetAddress());
+        } else if (const auto smem = std::get_if<SmemNode>(node)) {
+            CollectReads(smem->GetAddress());
+        } else if (const auto gmem = std::get_if<GmemNode>(node)) {
+            CollectReads(gmem->GetRealAddress());
+            CollectReads(gmem->GetBaseAddress());
+        }
+    }
+
+    bool IsDeadWrite(Node node) {
+        const auto operation = std::get_if<OperationNode>(node);
+        if (!operation) {
+            return false;
+        }
+        const OperationCode code = operation->GetCode();
+        if (code != OperationCode::Assign && code != OperationCode::LogicalAssign) {
+            return false;
+        }
+        const Node dest = (*operation)[0];
+        if (const auto gpr = std::get_if<GprNode>(dest)) {
+            const u32 index = gpr->GetIndex();
+            if (index == Register::ZeroIndex ||
+                (!has_implicit_register_reads && reads.registers.count(index) == 0)) {
+                ++stats.removed_register_writes;
+                return true;
+            }
+        } else if (const auto predicate = std::get_if<PredicateNode>(dest)) {
+            const Pred index = predicate->GetIndex();
+            if (IsConstantPredicate(index) || reads.predicates.count(index) == 0) {
+                ++stats.removed_predicate_writes;
+                return true;
+            }
+        } else if (const auto flag = std::get_if<InternalFlagNode>(dest)) {
+            if (reads.flags.count(flag->GetFlag()) == 0) {
+                ++stats.removed_flag_writes;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool RemoveDeadWrites(NodeBlock& block) {
+        bool has_removed = false;
+        NodeBlock result;
+        for (const Node node : block) {
+            if (IsDeadWrite(node)) {
+                has_removed = true;
+                continue;
+            }
+            const auto conditional = std::get_if<ConditionalNode>(node);
+            if (!conditional) {
+                result.push_back(node);
+                continue;
+            }
+            NodeBlock code = conditional->GetCode();
+            if (!RemoveDeadWrites(code)) {
+                result.push_back(node);
+                continue;
+            }
+            has_removed = true;
+            if (!code.empty()) {
+                result.push_back(store(ConditionalNode(conditional->GetCondition(), std::move(code))));
+            }
+        }
+        if (has_removed) {
+            block = std::move(result);
+        }
+        return has_removed;
+    }
+
+    std::map<u32, NodeBlock>& basic_blocks;
+    const bool has_implicit_register_reads;
+    NodeStorage store;
+
+    OptimizationStats stats;
+    std::unordered_map<Node, Node> folded_nodes;
+    std::unordered_set<Node> scanned_nodes;
+    Usage reads;
+    Usage writes;
+};
+
+} // Anonymous namespace
+
+void ShaderIR::Optimize() {
+    // Pixel shaders read their output registers when they exit
+    const bool is_pixel_shader = header.common0.sph_type == PixelShaderHeaderType;
+
+    Optimizer optimizer(basic_blocks, is_pixel_shader,
+                        [this](NodeData&& node_data) { return StoreNode(std::move(node_data)); });
+    optimizer.Run();
+
+    // Drop the declarations of everything that is no longer referenced
+    const Usage usage = optimizer.GetUsage();
+    if (!is_pixel_shader) {
+        for (auto it = used_registers.begin(); it != used_registers.end();) {
+            it = usage.registers.count(*it) == 0 ? used_registers.erase(it) : std::next(it);
+        }
+    }
+    for (auto it = used_predicates.begin(); it != used_predicates.end();) {
+        it = usage.predicates.count(*it) == 0 ? used_predicates.erase(it) : std::next(it);
+    }
+
+    const OptimizationStats& stats = optimizer.GetStats();
+    LOG_DEBUG(HW_GPU,
+              "Shader IR optimized: {} operations folded, {} casts and {} conditionals removed, "
+              "{} register, {} predicate and {} flag writes removed",
+              stats.folded_operations, stats.removed_casts, stats.removed_conditionals,
+              stats.removed_register_writes, stats.removed_predicate_writes,
+              stats.removed_flag_writes);
+}
+
+} // namespace VideoCommon::Shader
@@ -127,9 +127,15 @@ Node ShaderIR::GetInternalFlag(InternalFlag flag, bool negated) {
 }
 
 Node ShaderIR::GetLocalMemory(Node address) {
+    uses_local_memory = true;
     return StoreNode(LmemNode(address));
 }
 
+Node ShaderIR::GetSharedMemory(Node address) {
+    uses_shared_memory = true;
+    return StoreNode(SmemNode(address));
+}
+
 Node ShaderIR::GetTemporal(u32 id) {
     return GetRegister(Register::ZeroIndex + 1 + id);
 }
@@ -366,6 +372,10 @@ void ShaderIR::SetLocalMemory(NodeBlock& bb, Node address, Node value) {
     bb.push_back(Operation(OperationCode::Assign, GetLocalMemory(address), value));
 }
 
+void ShaderIR::SetSharedMemory(NodeBlock& bb, Node address, Node value) {
+    bb.push_back(Operation(OperationCode::Assign, GetSharedMemory(address), value));
+}
+
 void ShaderIR::SetTemporal(NodeBlock& bb, u32 id, Node value) {
     SetRegister(bb, Register::ZeroIndex + 1 + id, value);
 }
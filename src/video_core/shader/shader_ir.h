@@ -30,6 +30,7 @@ class PredicateNode;
 class AbufNode; ///< Attribute buffer
 class CbufNode; ///< Constant buffer
 class LmemNode; ///< Local memory
+class SmemNode; ///< Shared memory
 class GmemNode; ///< Global memory
 class CommentNode;
 
@@ -37,13 +38,18 @@ using ProgramCode = std::vector<u64>;
 
 using NodeData =
     std::variant<OperationNode, ConditionalNode, GprNode, ImmediateNode, InternalFlagNode,
-                 PredicateNode, AbufNode, CbufNode, LmemNode, GmemNode, CommentNode>;
+                 PredicateNode, AbufNode, CbufNode, LmemNode, SmemNode, GmemNode,
+                 CommentNode>;
 using Node = const NodeData*;
 using Node4 = std::array<Node, 4>;
 using NodeBlock = std::vector<Node>;
 
 constexpr u32 MAX_PROGRAM_LENGTH = 0x1000;
 
+/// Samplers a bindless handle indexed by a register selects from, their handles are consecutive
+/// words of a const buffer
+constexpr std::size_t INDEXED_SAMPLER_SIZE = 8;
+
 enum class OperationCode {
     Assign, /// (float& dest, float src) -> void
 
@@ -181,7 +187,16 @@ enum class OperationCode {
     EmitVertex,   /// () -> void
     EndPrimitive, /// () -> void
 
-    YNegate, /// () -> float
+    Barrier,         /// () -> void
+    MemoryBarrierGL, /// () -> void
+
+    YNegate,            /// () -> float
+    LocalInvocationIdX, /// () -> float
+    LocalInvocationIdY, /// () -> float
+    LocalInvocationIdZ, /// () -> float
+    WorkGroupIdX,       /// () -> float
+    WorkGroupIdY,       /// () -> float
+    WorkGroupIdZ,       /// () -> float
 
     Amount,
 };
@@ -210,17 +225,19 @@ public:
         : offset{offset}, index{index}, type{type}, is_array{is_array}, is_shadow{is_shadow},
           is_bindless{false} {}
 
-    // Use this constructor for bindless Samplers
+    // Use this constructor for bindless Samplers, size is the number of handles of an indexed
+    // sampler
     explicit Sampler(u32 cbuf_index, u32 cbuf_offset, std::size_t index,
-                     Tegra::Shader::TextureType type, bool is_array, bool is_shadow)
+                     Tegra::Shader::TextureType type, bool is_array, bool is_shadow,
+                     std::size_t size = 1)
         : offset{(static_cast<u64>(cbuf_index) << 32) | cbuf_offset}, index{index}, type{type},
-          is_array{is_array}, is_shadow{is_shadow}, is_bindless{true} {}
+          is_array{is_array}, is_shadow{is_shadow}, is_bindless{true}, size{size} {}
 
     // Use this only for serialization/deserialization
     explicit Sampler(std::size_t offset, std::size_t index, Tegra::Shader::TextureType type,
-                     bool is_array, bool is_shadow, bool is_bindless)
+                     bool is_array, bool is_shadow, bool is_bindless, std::size_t size = 1)
         : offset{offset}, index{index}, type{type}, is_array{is_array}, is_shadow{is_shadow},
-          is_bindless{is_bindless} {}
+          is_bindless{is_bindless}, size{size} {}
 
     std::size_t GetOffset() const {
         return offset;
@@ -250,10 +267,19 @@ public:
         return {static_cast<u32>(offset >> 32), static_cast<u32>(offset)};
     }
 
+    /// Returns the number of samplers of the entry, more than one when it's indexed
+    std::size_t GetSize() const {
+        return size;
+    }
+
+    bool IsIndexed() const {
+        return size > 1;
+    }
+
     bool operator<(const Sampler& rhs) const {
-        return std::tie(index, offset, type, is_array, is_shadow, is_bindless) <
+        return std::tie(index, offset, type, is_array, is_shadow, is_bindless, size) <
                std::tie(rhs.index, rhs.offset, rhs.type, rhs.is_array, rhs.is_shadow,
-                        rhs.is_bindless);
+                        rhs.is_bindless, rhs.size);
     }
 
 private:
@@ -265,6 +291,7 @@ private:
     bool is_array{};    ///< Whether the texture is being sampled as an array texture or not.
     bool is_shadow{};   ///< Whether the texture is being sampled as a depth texture or not.
     bool is_bindless{}; ///< Whether this sampler belongs to a bindless texture or not.
+    std::size_t size{1}; ///< Number of samplers selected from by an index, 1 when not indexed.
 };
 
 class ConstBuffer {
@@ -326,6 +353,8 @@ struct MetaTexture {
     Node lod{};
     Node component{};
     u32 element{};
+    /// Byte offset of the handle from the first one of an indexed sampler, null otherwise
+    Node index{};
 };
 
 constexpr MetaArithmetic PRECISE = {true};
@@ -523,6 +552,19 @@ private:
     const Node address;
 };
 
+/// Shared memory node
+class SmemNode final {
+public:
+    explicit constexpr SmemNode(Node address) : address{address} {}
+
+    Node GetAddress() const {
+        return address;
+    }
+
+private:
+    const Node address;
+};
+
 /// Global memory node
 class GmemNode final {
 public:
@@ -561,6 +603,26 @@ private:
     std::string text;
 };
 
+struct StructuredNode;
+using StructuredBlock = std::vector<StructuredNode>;
+
+/// Statement of a shader program whose control flow has been recovered as nested scopes
+struct StructuredNode {
+    enum class Type {
+        Code,     ///< Straight-line code
+        If,       ///< Executes then_block if condition is met, else_block otherwise
+        Loop,     ///< Executes then_block until a break statement is reached
+        Break,    ///< Leaves the innermost loop if condition is met
+        Continue, ///< Restarts the innermost loop if condition is met
+    };
+
+    Type type = Type::Code;
+    Node condition{}; ///< Null when the statement is unconditional
+    NodeBlock code;
+    StructuredBlock then_block;
+    StructuredBlock else_block;
+};
+
 class ShaderIR final {
 public:
     explicit ShaderIR(const ProgramCode& program_code, u32 main_offset);
@@ -570,6 +632,16 @@ public:
         return basic_blocks;
     }
 
+    /// Returns true if the control flow of the basic blocks could be expressed as nested scopes.
+    /// When this is false, backends have to dispatch the basic blocks by their address.
+    bool IsFlowStructured() const {
+        return structured_program.has_value();
+    }
+
+    const StructuredBlock& GetStructuredProgram() const {
+        return *structured_program;
+    }
+
     const std::set<u32>& GetRegisters() const {
         return used_registers;
     }
@@ -611,6 +683,14 @@ public:
         return uses_physical_attributes;
     }
 
+    bool UsesLocalMemory() const {
+        return uses_local_memory;
+    }
+
+    bool UsesSharedMemory() const {
+        return uses_shared_memory;
+    }
+
     const Tegra::Shader::Header& GetHeader() const {
         return header;
     }
@@ -622,6 +702,12 @@ private:
 
     NodeBlock DecodeRange(u32 begin, u32 end);
 
+    /// Folds constants and removes writes that are never read from the basic blocks
+    void Optimize();
+
+    /// Tries to build structured_program out of the decoded basic blocks
+    void StructurizeFlow();
+
     /**
      * Decodes a single instruction from Tegra to IR.
      * @param bb Basic block where the nodes will be written to.
@@ -701,6 +787,8 @@ private:
     Node GetInternalFlag(InternalFlag flag, bool negated = false);
     /// Generates a node representing a local memory address
     Node GetLocalMemory(Node address);
+    /// Generates a node representing a shared memory address
+    Node GetSharedMemory(Node address);
     /// Generates a temporal, internally it uses a post-RZ register
     Node GetTemporal(u32 id);
 
@@ -712,6 +800,8 @@ private:
     void SetInternalFlag(NodeBlock& bb, InternalFlag flag, Node value);
     /// Sets a local memory address. address and value must be a number-evaluated node
     void SetLocalMemory(NodeBlock& bb, Node address, Node value);
+    /// Sets a shared memory address. address and value must be a number-evaluated node
+    void SetSharedMemory(NodeBlock& bb, Node address, Node value);
     /// Sets a temporal. Internally it uses a post-RZ register
     void SetTemporal(NodeBlock& bb, u32 id, Node value);
 
@@ -759,10 +849,11 @@ private:
     const Sampler& GetSampler(const Tegra::Shader::Sampler& sampler,
                               Tegra::Shader::TextureType type, bool is_array, bool is_shadow);
 
-    // Accesses a texture sampler for a bindless texture.
+    // Accesses a texture sampler for a bindless texture. Sets index to the byte offset of the
+    // handle from the first one when it's selected by a register, otherwise it becomes null.
     const Sampler& GetBindlessSampler(const Tegra::Shader::Register& reg,
                                       Tegra::Shader::TextureType type, bool is_array,
-                                      bool is_shadow);
+                                      bool is_shadow, Node& index);
 
     /// Extracts a sequence of bits from a node
     Node BitfieldExtract(Node value, u32 offset, u32 bits);
@@ -813,6 +904,11 @@ private:
 
     Node TrackCbuf(Node tracked, const NodeBlock& code, s64 cursor) const;
 
+    /// Tracks a const buffer read whose offset adds a register to an immediate. Returns the added
+    /// node, the const buffer index and the immediate; the node is null when it can't be tracked.
+    std::tuple<Node, u32, u32> TrackIndexedCbuf(Node tracked, const NodeBlock& code,
+                                                s64 cursor) const;
+
     std::optional<u32> TrackImmediate(Node tracked, const NodeBlock& code, s64 cursor) const;
 
     std::pair<Node, s64> TrackRegister(const GprNode* tracked, const NodeBlock& code,
@@ -860,6 +956,7 @@ private:
     std::map<std::pair<u32, u32>, ExitMethod> exit_method_map;
 
     std::map<u32, NodeBlock> basic_blocks;
+    std::optional<StructuredBlock> structured_program;
     NodeBlock global_code;
 
     std::vector<std::unique_ptr<NodeData>> stored_nodes;
@@ -873,6 +970,8 @@ private:
     std::array<bool, Tegra::Engines::Maxwell3D::Regs::NumClipDistances> used_clip_distances{};
     std::map<GlobalMemoryBase, GlobalMemoryUsage> used_global_memory;
     bool uses_physical_attributes{}; // Shader uses AL2P or physical attribute read/writes
+    bool uses_local_memory{};
+    bool uses_shared_memory{};
 
     Tegra::Shader::Header header;
 };
@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <tuple>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "common/common_types.h"
 #include "video_core/shader/shader_ir.h"
@@ -32,6 +34,52 @@ std::pair<Node, s64> FindOperation(const NodeBlock& code, s64 cursor,
     }
     return {};
 }
+
+/// Returns true when the node only reads registers and immediates, collecting the registers
+bool CollectRegisters(Node node, std::vector<u32>& registers) {
+    if (const auto gpr = std::get_if<GprNode>(node)) {
+        registers.push_back(gpr->GetIndex());
+        return true;
+    }
+    if (std::holds_alternative<ImmediateNode>(*node)) {
+        return true;
+    }
+    if (const auto operation = std::get_if<OperationNode>(node)) {
+        for (std::size_t i = 0; i < operation->GetOperandsCount(); ++i) {
+            if (!CollectRegisters((*operation)[i], registers)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+/// Returns true when any of the registers is assigned in [begin, end) of the code
+bool IsAnyRegisterAssigned(const NodeBlock& code, s64 begin, s64 end,
+                           const std::vector<u32>& registers) {
+    for (s64 cursor = std::max<s64>(begin, 0); cursor < end; ++cursor) {
+        const Node node = code.at(cursor);
+        if (const auto operation = std::get_if<OperationNode>(node)) {
+            if (operation->GetCode() != OperationCode::Assign) {
+                continue;
+            }
+            const auto gpr = std::get_if<GprNode>((*operation)[0]);
+            if (gpr && std::find(registers.begin(), registers.end(), gpr->GetIndex()) !=
+                           registers.end()) {
+                return true;
+            }
+        }
+        if (const auto conditional = std::get_if<ConditionalNode>(node)) {
+            const auto& conditional_code = conditional->GetCode();
+            if (IsAnyRegisterAssigned(conditional_code, 0,
+                                      static_cast<s64>(conditional_code.size()), registers)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
 } // namespace
 
 Node ShaderIR::TrackCbuf(Node tracked, const NodeBlock& code, s64 cursor) const {
@@ -67,6 +115,44 @@ Node ShaderIR::TrackCbuf(Node tracked, const NodeBlock& code, s64 cursor) const
     return nullptr;
 }
 
+std::tuple<Node, u32, u32> ShaderIR::TrackIndexedCbuf(Node tracked, const NodeBlock& code,
+                                                      s64 cursor) const {
+    s64 load_cursor = cursor;
+    while (const auto gpr = std::get_if<GprNode>(tracked)) {
+        if (gpr->GetIndex() == Tegra::Shader::Register::ZeroIndex) {
+            return {};
+        }
+        const auto [source, new_cursor] = TrackRegister(gpr, code, load_cursor - 1);
+        if (!source) {
+            return {};
+        }
+        tracked = source;
+        load_cursor = new_cursor;
+    }
+    const auto cbuf = std::get_if<CbufNode>(tracked);
+    if (!cbuf) {
+        return {};
+    }
+    // Indirect reads are built as the addition of the dynamic offset and an immediate
+    const auto operation = std::get_if<OperationNode>(cbuf->GetOffset());
+    if (!operation || operation->GetCode() != OperationCode::UAdd) {
+        return {};
+    }
+    const Node dynamic = (*operation)[0];
+    const auto base = std::get_if<ImmediateNode>((*operation)[1]);
+    if (!base) {
+        return {};
+    }
+    // The offset is evaluated again where the handle is used, so the registers it reads can't
+    // change after the handle is loaded
+    std::vector<u32> registers;
+    if (!CollectRegisters(dynamic, registers) ||
+        IsAnyRegisterAssigned(code, load_cursor + 1, cursor, registers)) {
+        return {};
+    }
+    return {dynamic, cbuf->GetIndex(), base->GetValue()};
+}
+
 std::optional<u32> ShaderIR::TrackImmediate(Node tracked, const NodeBlock& code, s64 cursor) const {
     // Reduce the cursor in one to avoid infinite loops when the instruction sets the same register
     // that it uses as operand
@@ -4,8 +4,8 @@
 
 #include "common/alignment.h"
 #include "common/assert.h"
-#include "common/cityhash.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "core/core.h"
 #include "video_core/surface.h"
 #include "video_core/texture_cache.h"
@@ -359,8 +359,7 @@ bool SurfaceParams::IsInBounds(const SurfaceParams& view_params, u32 layer, u32
 }
 
 std::size_t HasheableSurfaceParams::Hash() const {
-    return static_cast<std::size_t>(
-        Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this)));
+    return static_cast<std::size_t>(Common::ComputeHash64(this, sizeof(*this)));
 }
 
 bool HasheableSurfaceParams::operator==(const HasheableSurfaceParams& rhs) const {
@@ -374,8 +373,7 @@ bool HasheableSurfaceParams::operator==(const HasheableSurfaceParams& rhs) const
 }
 
 std::size_t ViewKey::Hash() const {
-    return static_cast<std::size_t>(
-        Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this)));
+    return static_cast<std::size_t>(Common::ComputeHash64(this, sizeof(*this)));
 }
 
 bool ViewKey::operator==(const ViewKey& rhs) const {
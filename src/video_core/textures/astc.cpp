@@ -21,6 +21,7 @@
 #include <cstring>
 #include <vector>
 
+#include "common/thread_pool.h"
 #include "video_core/textures/astc.h"
 
 class InputBitStream {
@@ -47,10 +48,22 @@ public:
     }
 
     unsigned int ReadBits(unsigned int nBits) {
+        // Extract as many bits as possible from the current byte at once instead of going bit
+        // by bit. Bytes past the last requested bit are never dereferenced.
         unsigned int ret = 0;
-        for (unsigned int i = 0; i < nBits; i++) {
-            ret |= (ReadBit() & 1) << i;
+        unsigned int read = 0;
+        while (read < nBits) {
+            const unsigned int chunk = std::min(nBits - read, 8U - m_NextBit);
+            const unsigned int mask = (1U << chunk) - 1;
+            ret |= ((static_cast<unsigned int>(*m_CurByte) >> m_NextBit) & mask) << read;
+            read += chunk;
+            m_NextBit += chunk;
+            if (m_NextBit == 8) {
+                m_NextBit = 0;
+                m_CurByte++;
+            }
         }
+        m_BitsRead += nBits;
         return ret;
     }
 
@@ -148,8 +161,8 @@ enum EIntegerEncoding { eIntegerEncoding_JustBits, eIntegerEncoding_Quint, eInte
 
 class IntegerEncodedValue {
 private:
-    const EIntegerEncoding m_Encoding;
-    const uint32_t m_NumBits;
+    EIntegerEncoding m_Encoding;
+    uint32_t m_NumBits;
     uint32_t m_BitValue;
     union {
         uint32_t m_QuintValue;
@@ -157,13 +170,6 @@ private:
     };
 
 public:
-    // Jank, but we're not doing any heavy lifting in this class, so it's
-    // probably OK. It allows us to use these in std::vectors...
-    IntegerEncodedValue& operator=(const IntegerEncodedValue& other) {
-        new (this) IntegerEncodedValue(other);
-        return *this;
-    }
-
     IntegerEncodedValue(EIntegerEncoding encoding, uint32_t numBits)
         : m_Encoding(encoding), m_NumBits(numBits) {}
 
@@ -222,29 +228,20 @@ public:
     // Returns a new instance of this struct that corresponds to the
     // can take no more than maxval values
     static IntegerEncodedValue CreateEncoding(uint32_t maxVal) {
-        while (maxVal > 0) {
-            uint32_t check = maxVal + 1;
-
-            // Is maxVal a power of two?
-            if (!(check & (check - 1))) {
-                return IntegerEncodedValue(eIntegerEncoding_JustBits, Popcnt(maxVal));
+        // Every block searches the encodings of the color ranges, so the ones a block can
+        // reference are computed once and looked up afterwards.
+        static const std::vector<IntegerEncodedValue> encodings = [] {
+            std::vector<IntegerEncodedValue> table;
+            table.reserve(NumCachedEncodings);
+            for (uint32_t i = 0; i < NumCachedEncodings; i++) {
+                table.push_back(ComputeEncoding(i));
             }
-
-            // Is maxVal of the type 3*2^n - 1?
-            if ((check % 3 == 0) && !((check / 3) & ((check / 3) - 1))) {
-                return IntegerEncodedValue(eIntegerEncoding_Trit, Popcnt(check / 3 - 1));
-            }
-
-            // Is maxVal of the type 5*2^n - 1?
-            if ((check % 5 == 0) && !((check / 5) & ((check / 5) - 1))) {
-                return IntegerEncodedValue(eIntegerEncoding_Quint, Popcnt(check / 5 - 1));
-            }
-
-            // Apparently it can't be represented with a bounded integer sequence...
-            // just iterate.
-            maxVal--;
+            return table;
+        }();
+        if (maxVal < NumCachedEncodings) {
+            return encodings[maxVal];
         }
-        return IntegerEncodedValue(eIntegerEncoding_JustBits, 0);
+        return ComputeEncoding(maxVal);
     }
 
     // Fills result with the values that are encoded in the given
@@ -255,6 +252,9 @@ public:
         // Determine encoding parameters
         IntegerEncodedValue val = IntegerEncodedValue::CreateEncoding(maxRange);
 
+        // Trits and quints are decoded in groups of five and three values
+        result.reserve(nValues + 4);
+
         // Start decoding
         uint32_t nValsDecoded = 0;
         while (nValsDecoded < nValues) {
@@ -279,6 +279,35 @@ public:
     }
 
 private:
+    // Color values are at most 8 bits wide, so ranges never go past 255
+    static constexpr uint32_t NumCachedEncodings = 256;
+
+    static IntegerEncodedValue ComputeEncoding(uint32_t maxVal) {
+        while (maxVal > 0) {
+            uint32_t check = maxVal + 1;
+
+            // Is maxVal a power of two?
+            if (!(check & (check - 1))) {
+                return IntegerEncodedValue(eIntegerEncoding_JustBits, Popcnt(maxVal));
+            }
+
+            // Is maxVal of the type 3*2^n - 1?
+            if ((check % 3 == 0) && !((check / 3) & ((check / 3) - 1))) {
+                return IntegerEncodedValue(eIntegerEncoding_Trit, Popcnt(check / 3 - 1));
+            }
+
+            // Is maxVal of the type 5*2^n - 1?
+            if ((check % 5 == 0) && !((check / 5) & ((check / 5) - 1))) {
+                return IntegerEncodedValue(eIntegerEncoding_Quint, Popcnt(check / 5 - 1));
+            }
+
+            // Apparently it can't be represented with a bounded integer sequence...
+            // just iterate.
+            maxVal--;
+        }
+        return IntegerEncodedValue(eIntegerEncoding_JustBits, 0);
+    }
+
     static void DecodeTritBlock(InputBitStream& bits, std::vector<IntegerEncodedValue>& result,
                                 uint32_t nBitsPerValue) {
         // Implement the algorithm in section C.2.12
@@ -1087,47 +1116,49 @@ static void UnquantizeTexelWeights(uint32_t out[2][144],
     uint32_t Ds = (1024 + (blockWidth / 2)) / (blockWidth - 1);
     uint32_t Dt = (1024 + (blockHeight / 2)) / (blockHeight - 1);
 
-    const uint32_t kPlaneScale = params.m_bDualPlane ? 2U : 1U;
-    for (uint32_t plane = 0; plane < kPlaneScale; plane++)
-        for (uint32_t t = 0; t < blockHeight; t++)
-            for (uint32_t s = 0; s < blockWidth; s++) {
-                uint32_t cs = Ds * s;
-                uint32_t ct = Dt * t;
-
-                uint32_t gs = (cs * (params.m_Width - 1) + 32) >> 6;
-                uint32_t gt = (ct * (params.m_Height - 1) + 32) >> 6;
-
-                uint32_t js = gs >> 4;
-                uint32_t fs = gs & 0xF;
-
-                uint32_t jt = gt >> 4;
-                uint32_t ft = gt & 0x0F;
-
-                uint32_t w11 = (fs * ft + 8) >> 4;
-                uint32_t w10 = ft - w11;
-                uint32_t w01 = fs - w11;
-                uint32_t w00 = 16 - fs - ft + w11;
-
-                uint32_t v0 = js + jt * params.m_Width;
+    // The grid coordinates only depend on one of the texel coordinates, compute them once per
+    // column and once per row instead of once per texel.
+    uint32_t js[12];
+    uint32_t fs[12];
+    for (uint32_t s = 0; s < blockWidth; s++) {
+        const uint32_t gs = (Ds * s * (params.m_Width - 1) + 32) >> 6;
+        js[s] = gs >> 4;
+        fs[s] = gs & 0xF;
+    }
+    uint32_t jt[12];
+    uint32_t ft[12];
+    for (uint32_t t = 0; t < blockHeight; t++) {
+        const uint32_t gt = (Dt * t * (params.m_Height - 1) + 32) >> 6;
+        jt[t] = gt >> 4;
+        ft[t] = gt & 0xF;
+    }
 
-#define FIND_TEXEL(tidx, bidx)                                                                     \
-    uint32_t p##bidx = 0;                                                                          \
-    do {                                                                                           \
-        if ((tidx) < (params.m_Width * params.m_Height)) {                                         \
-            p##bidx = unquantized[plane][(tidx)];                                                  \
-        }                                                                                          \
-    } while (0)
+    const uint32_t numWeights = params.m_Width * params.m_Height;
+    const uint32_t kPlaneScale = params.m_bDualPlane ? 2U : 1U;
+    for (uint32_t plane = 0; plane < kPlaneScale; plane++) {
+        const uint32_t* const planeWeights = unquantized[plane];
+        const auto findTexel = [planeWeights, numWeights](uint32_t tidx) {
+            return tidx < numWeights ? planeWeights[tidx] : 0;
+        };
 
-                FIND_TEXEL(v0, 00);
-                FIND_TEXEL(v0 + 1, 01);
-                FIND_TEXEL(v0 + params.m_Width, 10);
-                FIND_TEXEL(v0 + params.m_Width + 1, 11);
+        for (uint32_t t = 0; t < blockHeight; t++) {
+            for (uint32_t s = 0; s < blockWidth; s++) {
+                const uint32_t w11 = (fs[s] * ft[t] + 8) >> 4;
+                const uint32_t w10 = ft[t] - w11;
+                const uint32_t w01 = fs[s] - w11;
+                const uint32_t w00 = 16 - fs[s] - ft[t] + w11;
 
-#undef FIND_TEXEL
+                const uint32_t v0 = js[s] + jt[t] * params.m_Width;
+                const uint32_t p00 = findTexel(v0);
+                const uint32_t p01 = findTexel(v0 + 1);
+                const uint32_t p10 = findTexel(v0 + params.m_Width);
+                const uint32_t p11 = findTexel(v0 + params.m_Width + 1);
 
                 out[plane][t * blockWidth + s] =
                     (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 8) >> 4;
             }
+        }
+    }
 }
 
 // Transfers a bit as described in C.2.14
@@ -1571,72 +1602,106 @@ static void DecompressBlock(const uint8_t inBuf[16], const uint32_t blockWidth,
     uint32_t weights[2][144];
     UnquantizeTexelWeights(weights, texelWeightValues, weightParams, blockWidth, blockHeight);
 
+    // Expand the endpoints to 16 bits once per block instead of once per texel
+    uint32_t C0[4][4];
+    uint32_t C1[4][4];
+    for (uint32_t partition = 0; partition < nPartitions; partition++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            C0[partition][c] = Replicate<uint32_t>(endpoints[partition][0].Component(c), 8, 16);
+            C1[partition][c] = Replicate<uint32_t>(endpoints[partition][1].Component(c), 8, 16);
+        }
+    }
+
+    uint32_t planes[4] = {};
+    if (weightParams.m_bDualPlane) {
+        planes[(planeIdx + 1) & 3] = 1;
+    }
+
     // Now that we have endpoints and weights, we can interpolate and generate
     // the proper decoding...
-    for (uint32_t j = 0; j < blockHeight; j++)
+    const bool smallBlock = (blockHeight * blockWidth) < 32;
+    for (uint32_t j = 0; j < blockHeight; j++) {
         for (uint32_t i = 0; i < blockWidth; i++) {
-            uint32_t partition = Select2DPartition(partitionIndex, i, j, nPartitions,
-                                                   (blockHeight * blockWidth) < 32);
+            uint32_t partition = 0;
+            if (nPartitions > 1) {
+                partition = Select2DPartition(partitionIndex, i, j, nPartitions, smallBlock);
+            }
             assert(partition < nPartitions);
 
-            Pixel p;
+            uint32_t texel = 0;
             for (uint32_t c = 0; c < 4; c++) {
-                uint32_t C0 = endpoints[partition][0].Component(c);
-                C0 = Replicate(C0, 8, 16);
-                uint32_t C1 = endpoints[partition][1].Component(c);
-                C1 = Replicate(C1, 8, 16);
-
-                uint32_t plane = 0;
-                if (weightParams.m_bDualPlane && (((planeIdx + 1) & 3) == c)) {
-                    plane = 1;
-                }
-
-                uint32_t weight = weights[plane][j * blockWidth + i];
-                uint32_t C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
-                if (C == 65535) {
-                    p.Component(c) = 255;
-                } else {
-                    double Cf = static_cast<double>(C);
-                    p.Component(c) = static_cast<uint16_t>(255.0 * (Cf / 65536.0) + 0.5);
-                }
+                const uint32_t weight = weights[planes[c]][j * blockWidth + i];
+                const uint32_t C0c = C0[partition][c];
+                const uint32_t C1c = C1[partition][c];
+                const uint32_t C = (C0c * (64 - weight) + C1c * weight + 32) / 64;
+                // Round to the nearest 8-bit value, maps 0xFFFF to 0xFF
+                const uint32_t channel = (C * 255 + 0x8000) >> 16;
+                // Components are stored as ARGB, texels are packed as ABGR
+                texel |= channel << (c == 0 ? 24 : (c - 1) * 8);
             }
-
-            outBuf[j * blockWidth + i] = p.Pack();
+            outBuf[j * blockWidth + i] = texel;
         }
+    }
 }
 
 } // namespace ASTCC
 
 namespace Tegra::Texture::ASTC {
 
-std::vector<uint8_t> Decompress(const uint8_t* data, uint32_t width, uint32_t height,
-                                uint32_t depth, uint32_t block_width, uint32_t block_height) {
-    uint32_t blockIdx = 0;
-    std::size_t depth_offset = 0;
-    std::vector<uint8_t> outData(height * width * depth * 4);
-    for (uint32_t k = 0; k < depth; k++) {
-        for (uint32_t j = 0; j < height; j += block_height) {
-            for (uint32_t i = 0; i < width; i += block_width) {
-
-                const uint8_t* blockPtr = data + blockIdx * 16;
-
-                // Blocks can be at most 12x12
-                uint32_t uncompData[144];
-                ASTCC::DecompressBlock(blockPtr, block_width, block_height, uncompData);
-
-                uint32_t decompWidth = std::min(block_width, width - i);
-                uint32_t decompHeight = std::min(block_height, height - j);
-
-                uint8_t* outRow = depth_offset + outData.data() + (j * width + i) * 4;
-                for (uint32_t jj = 0; jj < decompHeight; jj++) {
-                    memcpy(outRow + jj * width * 4, uncompData + jj * block_width, decompWidth * 4);
-                }
-
-                blockIdx++;
+namespace {
+
+/// Decodes the rows of blocks in [first_row, last_row), rows are counted across all the layers
+void DecompressRows(const uint8_t* data, uint32_t width, uint32_t height, uint32_t block_width,
+                    uint32_t block_height, uint32_t first_row, uint32_t last_row,
+                    uint8_t* outData) {
+    const uint32_t blocks_x = (width + block_width - 1) / block_width;
+    const uint32_t blocks_y = (height + block_height - 1) / block_height;
+    const std::size_t layer_size = static_cast<std::size_t>(height) * width * 4;
+
+    for (uint32_t row = first_row; row < last_row; row++) {
+        const uint32_t k = row / blocks_y;
+        const uint32_t j = (row % blocks_y) * block_height;
+        const uint8_t* blockPtr = data + static_cast<std::size_t>(row) * blocks_x * 16;
+        uint8_t* const layerData = outData + k * layer_size;
+
+        for (uint32_t i = 0; i < width; i += block_width, blockPtr += 16) {
+            // Blocks can be at most 12x12
+            uint32_t uncompData[144];
+            ASTCC::DecompressBlock(blockPtr, block_width, block_height, uncompData);
+
+            uint32_t decompWidth = std::min(block_width, width - i);
+            uint32_t decompHeight = std::min(block_height, height - j);
+
+            uint8_t* outRow = layerData + (static_cast<std::size_t>(j) * width + i) * 4;
+            for (uint32_t jj = 0; jj < decompHeight; jj++) {
+                memcpy(outRow + jj * width * 4, uncompData + jj * block_width, decompWidth * 4);
             }
         }
-        depth_offset += height * width * 4;
     }
+}
+
+} // Anonymous namespace
+
+Common::PooledVector Decompress(const uint8_t* data, uint32_t width, uint32_t height,
+                                uint32_t depth, uint32_t block_width, uint32_t block_height) {
+    Common::PooledVector outData = Common::BufferPool::Acquire(height * width * depth * 4);
+
+    const uint32_t blocks_x = (width + block_width - 1) / block_width;
+    const uint32_t blocks_y = (height + block_height - 1) / block_height;
+    const uint32_t num_rows = blocks_y * depth;
+
+    // Blocks are independent from each other and every row of blocks writes to its own region of
+    // the output, so split the rows between the threads of the shared pool. Small textures aren't
+    // worth handing to other threads.
+    constexpr uint32_t MinBlocksPerChunk = 1024;
+    const std::size_t min_rows =
+        std::max<uint32_t>(MinBlocksPerChunk / std::max(blocks_x, 1U), 1);
+    Common::ThreadPool::GetInstance().ParallelFor(
+        num_rows, min_rows, [&](std::size_t first_row, std::size_t last_row) {
+            DecompressRows(data, width, height, block_width, block_height,
+                           static_cast<uint32_t>(first_row), static_cast<uint32_t>(last_row),
+                           outData.data());
+        });
 
     return outData;
 }
@@ -5,11 +5,12 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
+#include "common/buffer_pool.h"
 
 namespace Tegra::Texture::ASTC {
 
-std::vector<uint8_t> Decompress(const uint8_t* data, uint32_t width, uint32_t height,
+/// Decompresses ASTC blocks to RGBA8 texels, the returned buffer is taken from the buffer pool
+Common::PooledVector Decompress(const uint8_t* data, uint32_t width, uint32_t height,
                                 uint32_t depth, uint32_t block_width, uint32_t block_height);
 
 } // namespace Tegra::Texture::ASTC
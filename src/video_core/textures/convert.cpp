@@ -14,52 +14,122 @@
 #include "video_core/textures/astc.h"
 #include "video_core/textures/convert.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/simd.h"
+#endif
+
 namespace Tegra::Texture {
 
 using VideoCore::Surface::PixelFormat;
 
+namespace {
+
+// S8Z24 keeps the depth in the low 24 bits and the stencil in the high byte, the host Z24S8 keeps
+// them the other way around. Converting a word is a rotation by 8 bits, left to move to the host
+// layout and right to move back to the guest one.
+template <bool reverse>
+u32 SwapS8Z24Word(u32 value) {
+    if constexpr (reverse) {
+        return (value >> 8) | (value << 24);
+    } else {
+        return (value << 8) | (value >> 24);
+    }
+}
+
+template <bool reverse>
+void SwapS8Z24Scalar(u8* data, std::size_t num_pixels) {
+    for (std::size_t i = 0; i < num_pixels; ++i) {
+        u32 value;
+        std::memcpy(&value, data + i * sizeof(u32), sizeof(u32));
+        value = SwapS8Z24Word<reverse>(value);
+        std::memcpy(data + i * sizeof(u32), &value, sizeof(u32));
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+template <bool reverse>
+std::size_t SwapS8Z24SSE2(u8* data, std::size_t num_pixels) {
+    constexpr int left = reverse ? 24 : 8;
+    constexpr int right = reverse ? 8 : 24;
+    const std::size_t num_vectors = num_pixels / 4;
+    const auto vectors = reinterpret_cast<__m128i*>(data);
+    for (std::size_t i = 0; i < num_vectors; ++i) {
+        const __m128i value = _mm_loadu_si128(vectors + i);
+        const __m128i result =
+            _mm_or_si128(_mm_slli_epi32(value, left), _mm_srli_epi32(value, right));
+        _mm_storeu_si128(vectors + i, result);
+    }
+    return num_vectors * 4;
+}
+
 template <bool reverse>
-void SwapS8Z24ToZ24S8(u8* data, u32 width, u32 height) {
-    union S8Z24 {
-        BitField<0, 24, u32> z24;
-        BitField<24, 8, u32> s8;
-    };
-    static_assert(sizeof(S8Z24) == 4, "S8Z24 is incorrect size");
-
-    union Z24S8 {
-        BitField<0, 8, u32> s8;
-        BitField<8, 24, u32> z24;
-    };
-    static_assert(sizeof(Z24S8) == 4, "Z24S8 is incorrect size");
-
-    S8Z24 s8z24_pixel{};
-    Z24S8 z24s8_pixel{};
-    constexpr auto bpp{
-        VideoCore::Surface::GetBytesPerPixel(VideoCore::Surface::PixelFormat::S8Z24)};
-    for (std::size_t y = 0; y < height; ++y) {
-        for (std::size_t x = 0; x < width; ++x) {
-            const std::size_t offset{bpp * (y * width + x)};
-            if constexpr (reverse) {
-                std::memcpy(&z24s8_pixel, &data[offset], sizeof(Z24S8));
-                s8z24_pixel.s8.Assign(z24s8_pixel.s8);
-                s8z24_pixel.z24.Assign(z24s8_pixel.z24);
-                std::memcpy(&data[offset], &s8z24_pixel, sizeof(S8Z24));
-            } else {
-                std::memcpy(&s8z24_pixel, &data[offset], sizeof(S8Z24));
-                z24s8_pixel.s8.Assign(s8z24_pixel.s8);
-                z24s8_pixel.z24.Assign(s8z24_pixel.z24);
-                std::memcpy(&data[offset], &z24s8_pixel, sizeof(Z24S8));
-            }
-        }
+AVX2_TARGET std::size_t SwapS8Z24AVX2(u8* data, std::size_t num_pixels) {
+    // Byte indices within each pixel of the rotated words, repeated for both 128-bit lanes
+    const __m256i shuffle = reverse ? _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13,
+                                                       14, 15, 12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10,
+                                                       11, 8, 13, 14, 15, 12)
+                                    : _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15,
+                                                       12, 13, 14, 3, 0, 1, 2, 7, 4, 5, 6, 11, 8,
+                                                       9, 10, 15, 12, 13, 14);
+    const std::size_t num_vectors = num_pixels / 8;
+    const auto vectors = reinterpret_cast<__m256i*>(data);
+    for (std::size_t i = 0; i < num_vectors; ++i) {
+        const __m256i value = _mm256_loadu_si256(vectors + i);
+        _mm256_storeu_si256(vectors + i, _mm256_shuffle_epi8(value, shuffle));
     }
+    return num_vectors * 8;
+}
+
+#endif
+
+template <bool reverse>
+void SwapS8Z24ToZ24S8(u8* data, u32 width, u32 height, u32 depth) {
+    static_assert(VideoCore::Surface::GetBytesPerPixel(PixelFormat::S8Z24) == sizeof(u32),
+                  "S8Z24 is incorrect size");
+    const std::size_t num_pixels = static_cast<std::size_t>(width) * height * depth;
+    std::size_t converted = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::HasAVX2()) {
+        converted = SwapS8Z24AVX2<reverse>(data, num_pixels);
+    } else {
+        converted = SwapS8Z24SSE2<reverse>(data, num_pixels);
+    }
+#endif
+    // Pixels that don't fill a whole vector are converted one at a time
+    SwapS8Z24Scalar<reverse>(data + converted * sizeof(u32), num_pixels - converted);
+}
+
+void ConvertS8Z24ToZ24S8(u8* data, u32 width, u32 height, u32 depth) {
+    SwapS8Z24ToZ24S8<false>(data, width, height, depth);
 }
 
-static void ConvertS8Z24ToZ24S8(u8* data, u32 width, u32 height) {
-    SwapS8Z24ToZ24S8<false>(data, width, height);
+void ConvertZ24S8ToS8Z24(u8* data, u32 width, u32 height, u32 depth) {
+    SwapS8Z24ToZ24S8<true>(data, width, height, depth);
 }
 
-static void ConvertZ24S8ToS8Z24(u8* data, u32 width, u32 height) {
-    SwapS8Z24ToZ24S8<true>(data, width, height);
+} // Anonymous namespace
+
+GuestConversion GetGuestConversion(PixelFormat pixel_format, bool native_astc) {
+    if (IsPixelFormatASTC(pixel_format)) {
+        return native_astc ? GuestConversion::None : GuestConversion::DecodeASTC;
+    }
+    if (pixel_format == PixelFormat::S8Z24) {
+        return GuestConversion::SwapS8Z24;
+    }
+    return GuestConversion::None;
+}
+
+bool IsWordConversion(GuestConversion conversion) {
+    switch (conversion) {
+    case GuestConversion::None:
+    case GuestConversion::SwapS8Z24:
+        return true;
+    case GuestConversion::DecodeASTC:
+        return false;
+    }
+    UNREACHABLE();
+    return false;
 }
 
 void ConvertFromGuestToHost(u8* data, PixelFormat pixel_format, u32 width, u32 height, u32 depth,
@@ -69,12 +139,12 @@ void ConvertFromGuestToHost(u8* data, PixelFormat pixel_format, u32 width, u32 h
         u32 block_width{};
         u32 block_height{};
         std::tie(block_width, block_height) = GetASTCBlockSize(pixel_format);
-        const std::vector<u8> rgba8_data =
+        const Common::PooledVector rgba8_data =
             Tegra::Texture::ASTC::Decompress(data, width, height, depth, block_width, block_height);
         std::copy(rgba8_data.begin(), rgba8_data.end(), data);
 
     } else if (convert_s8z24 && pixel_format == PixelFormat::S8Z24) {
-        Tegra::Texture::ConvertS8Z24ToZ24S8(data, width, height);
+        ConvertS8Z24ToZ24S8(data, width, height, depth);
     }
 }
 
@@ -86,7 +156,7 @@ void ConvertFromHostToGuest(u8* data, PixelFormat pixel_format, u32 width, u32 h
         UNREACHABLE();
 
     } else if (convert_s8z24 && pixel_format == PixelFormat::S8Z24) {
-        Tegra::Texture::ConvertZ24S8ToS8Z24(data, width, height);
+        ConvertZ24S8ToS8Z24(data, width, height, depth);
     }
 }
 
@@ -12,6 +12,22 @@ enum class PixelFormat;
 
 namespace Tegra::Texture {
 
+/// Conversions applied to the texels of guest formats the host can't sample as they are stored
+enum class GuestConversion {
+    None,
+    SwapS8Z24,  ///< Depth and stencil are swapped into Z24S8, and back when flushed
+    DecodeASTC, ///< ASTC blocks are decoded to RGBA8, there is no encoder to flush them
+};
+
+/// Returns the conversion the texels of the format need, native_astc if the host samples ASTC
+GuestConversion GetGuestConversion(VideoCore::Surface::PixelFormat pixel_format, bool native_astc);
+
+/**
+ * Returns true if the conversion maps every 32-bit word on its own to a word of the same size and
+ * back, so it can be applied in place by a compute shader before the upload and after the download.
+ */
+bool IsWordConversion(GuestConversion conversion);
+
 void ConvertFromGuestToHost(u8* data, VideoCore::Surface::PixelFormat pixel_format, u32 width,
                             u32 height, u32 depth, bool convert_astc, bool convert_s8z24);
 
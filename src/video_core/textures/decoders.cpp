@@ -2,10 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <vector>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/thread_pool.h"
 #include "video_core/gpu.h"
 #include "video_core/textures/decoders.h"
 #include "video_core/textures/texture.h"
@@ -92,6 +95,7 @@ void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const
     u32 z_address = tile_offset;
     const u32 x_startb = x_start * bytes_per_pixel;
     const u32 x_endb = x_end * bytes_per_pixel;
+    const bool same_size = bytes_per_pixel == out_bytes_per_pixel;
 
     for (u32 z = z_start; z < z_end; z++) {
         u32 y_address = z_address;
@@ -100,7 +104,8 @@ void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const
             const auto& table = fast_swizzle_table[y % gob_size_y];
             for (u32 xb = x_startb; xb < x_endb; xb += fast_swizzle_align) {
                 const u32 swizzle_offset{y_address + table[(xb / fast_swizzle_align) % 4]};
-                const u32 out_x = xb * out_bytes_per_pixel / bytes_per_pixel;
+                // Avoid the division when the pixel sizes match, which is the common case
+                const u32 out_x = same_size ? xb : xb * out_bytes_per_pixel / bytes_per_pixel;
                 const u32 pixel_index{out_x + pixel_base};
                 data_ptrs[unswizzle ? 1 : 0] = swizzled_data + swizzle_offset;
                 data_ptrs[unswizzle ? 0 : 1] = unswizzled_data + pixel_index;
@@ -114,11 +119,55 @@ void FastProcessBlock(u8* const swizzled_data, u8* const unswizzled_data, const
     }
 }
 
+/// Processes the rows of blocks in [first_row, last_row), rows are counted across all the layers
+template <bool fast>
+void SwizzleBlockRows(u8* const swizzled_data, u8* const unswizzled_data, const bool unswizzle,
+                      const u32 width, const u32 height, const u32 depth,
+                      const u32 bytes_per_pixel, const u32 out_bytes_per_pixel,
+                      const u32 block_height, const u32 block_depth, const u32 blocks_on_x,
+                      const u32 blocks_on_y, const u32 first_row, const u32 last_row) {
+    const u32 stride_x = width * out_bytes_per_pixel;
+    const u32 layer_z = height * stride_x;
+    const u32 gob_elements_x = gob_size_x / bytes_per_pixel;
+    constexpr u32 gob_elements_y = gob_size_y;
+    constexpr u32 gob_elements_z = gob_size_z;
+    const u32 block_x_elements = gob_elements_x;
+    const u32 block_y_elements = gob_elements_y * block_height;
+    const u32 block_z_elements = gob_elements_z * block_depth;
+    const u32 xy_block_size = gob_size * block_height;
+    const u32 block_size = xy_block_size * block_depth;
+    u32 tile_offset = first_row * blocks_on_x * block_size;
+    for (u32 row = first_row; row < last_row; row++) {
+        const u32 zb = row / blocks_on_y;
+        const u32 yb = row % blocks_on_y;
+        const u32 z_start = zb * block_z_elements;
+        const u32 z_end = std::min(depth, z_start + block_z_elements);
+        const u32 y_start = yb * block_y_elements;
+        const u32 y_end = std::min(height, y_start + block_y_elements);
+        for (u32 xb = 0; xb < blocks_on_x; xb++) {
+            const u32 x_start = xb * block_x_elements;
+            const u32 x_end = std::min(width, x_start + block_x_elements);
+            if constexpr (fast) {
+                FastProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
+                                 z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
+                                 layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
+            } else {
+                PreciseProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
+                                    z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
+                                    layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
+            }
+            tile_offset += block_size;
+        }
+    }
+}
+
 /**
  * This function unswizzles or swizzles a texture by mapping Linear to BlockLinear Textue.
  * The body of this function takes care of splitting the swizzled texture into blocks,
  * and managing the extents of it. Once all the parameters of a single block are obtained,
  * the function calls 'ProcessBlock' to process that particular Block.
+ * Rows of blocks touch disjoint ranges of both the swizzled and the linear data, large textures
+ * are split between the threads of the shared pool by rows.
  *
  * Documentation for the memory layout and decoding can be found at:
  *  https://envytools.readthedocs.io/en/latest/hw/memory/g80-surface.html#blocklinear-surfaces
@@ -128,44 +177,29 @@ void SwizzledData(u8* const swizzled_data, u8* const unswizzled_data, const bool
                   const u32 width, const u32 height, const u32 depth, const u32 bytes_per_pixel,
                   const u32 out_bytes_per_pixel, const u32 block_height, const u32 block_depth,
                   const u32 width_spacing) {
+    // Chunks smaller than this aren't worth handing to another thread
+    constexpr u64 min_bytes_per_chunk = 256 * 1024;
+
     auto div_ceil = [](const u32 x, const u32 y) { return ((x + y - 1) / y); };
-    const u32 stride_x = width * out_bytes_per_pixel;
-    const u32 layer_z = height * stride_x;
     const u32 gob_elements_x = gob_size_x / bytes_per_pixel;
-    constexpr u32 gob_elements_y = gob_size_y;
-    constexpr u32 gob_elements_z = gob_size_z;
-    const u32 block_x_elements = gob_elements_x;
-    const u32 block_y_elements = gob_elements_y * block_height;
-    const u32 block_z_elements = gob_elements_z * block_depth;
     const u32 aligned_width = Common::AlignUp(width, gob_elements_x * width_spacing);
-    const u32 blocks_on_x = div_ceil(aligned_width, block_x_elements);
-    const u32 blocks_on_y = div_ceil(height, block_y_elements);
-    const u32 blocks_on_z = div_ceil(depth, block_z_elements);
-    const u32 xy_block_size = gob_size * block_height;
-    const u32 block_size = xy_block_size * block_depth;
-    u32 tile_offset = 0;
-    for (u32 zb = 0; zb < blocks_on_z; zb++) {
-        const u32 z_start = zb * block_z_elements;
-        const u32 z_end = std::min(depth, z_start + block_z_elements);
-        for (u32 yb = 0; yb < blocks_on_y; yb++) {
-            const u32 y_start = yb * block_y_elements;
-            const u32 y_end = std::min(height, y_start + block_y_elements);
-            for (u32 xb = 0; xb < blocks_on_x; xb++) {
-                const u32 x_start = xb * block_x_elements;
-                const u32 x_end = std::min(width, x_start + block_x_elements);
-                if constexpr (fast) {
-                    FastProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
-                                     z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
-                                     layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
-                } else {
-                    PreciseProcessBlock(swizzled_data, unswizzled_data, unswizzle, x_start, y_start,
-                                        z_start, x_end, y_end, z_end, tile_offset, xy_block_size,
-                                        layer_z, stride_x, bytes_per_pixel, out_bytes_per_pixel);
-                }
-                tile_offset += block_size;
-            }
-        }
+    const u32 blocks_on_x = div_ceil(aligned_width, gob_elements_x);
+    const u32 blocks_on_y = div_ceil(height, gob_size_y * block_height);
+    const u32 blocks_on_z = div_ceil(depth, gob_size_z * block_depth);
+    const u32 num_rows = blocks_on_y * blocks_on_z;
+    if (num_rows == 0) {
+        return;
     }
+    const u64 row_size = blocks_on_x * gob_size * block_height * block_depth;
+
+    const std::size_t min_rows_per_chunk = std::max<u64>(min_bytes_per_chunk / row_size, 1);
+    Common::ThreadPool::GetInstance().ParallelFor(
+        num_rows, min_rows_per_chunk, [=](std::size_t first_row, std::size_t last_row) {
+            SwizzleBlockRows<fast>(swizzled_data, unswizzled_data, unswizzle, width, height, depth,
+                                   bytes_per_pixel, out_bytes_per_pixel, block_height,
+                                   block_depth, blocks_on_x, blocks_on_y,
+                                   static_cast<u32>(first_row), static_cast<u32>(last_row));
+        });
 }
 
 void CopySwizzledData(u32 width, u32 height, u32 depth, u32 bytes_per_pixel,
@@ -238,10 +272,11 @@ void UnswizzleTexture(u8* const unswizzled_data, u8* address, u32 tile_size_x, u
                      width_spacing);
 }
 
-std::vector<u8> UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y, u32 bytes_per_pixel,
-                                 u32 width, u32 height, u32 depth, u32 block_height,
-                                 u32 block_depth, u32 width_spacing) {
-    std::vector<u8> unswizzled_data(width * height * depth * bytes_per_pixel);
+Common::PooledVector UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y,
+                                      u32 bytes_per_pixel, u32 width, u32 height, u32 depth,
+                                      u32 block_height, u32 block_depth, u32 width_spacing) {
+    Common::PooledVector unswizzled_data =
+        Common::BufferPool::Acquire(width * height * depth * bytes_per_pixel);
     UnswizzleTexture(unswizzled_data.data(), address, tile_size_x, tile_size_y, bytes_per_pixel,
                      width, height, depth, block_height, block_depth, width_spacing);
     return unswizzled_data;
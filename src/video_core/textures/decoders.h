@@ -5,6 +5,7 @@
 #pragma once
 
 #include <vector>
+#include "common/buffer_pool.h"
 #include "common/common_types.h"
 #include "video_core/textures/texture.h"
 
@@ -22,12 +23,12 @@ void UnswizzleTexture(u8* unswizzled_data, u8* address, u32 tile_size_x, u32 til
                       u32 block_height = TICEntry::DefaultBlockHeight,
                       u32 block_depth = TICEntry::DefaultBlockHeight, u32 width_spacing = 0);
 
-/// Unswizzles a swizzled texture without changing its format.
-std::vector<u8> UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y, u32 bytes_per_pixel,
-                                 u32 width, u32 height, u32 depth,
-                                 u32 block_height = TICEntry::DefaultBlockHeight,
-                                 u32 block_depth = TICEntry::DefaultBlockHeight,
-                                 u32 width_spacing = 0);
+/// Unswizzles a swizzled texture without changing its format, into a buffer of the buffer pool.
+Common::PooledVector UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y,
+                                      u32 bytes_per_pixel, u32 width, u32 height, u32 depth,
+                                      u32 block_height = TICEntry::DefaultBlockHeight,
+                                      u32 block_depth = TICEntry::DefaultBlockHeight,
+                                      u32 width_spacing = 0);
 
 /// Copies texture data from a buffer and performs swizzling/unswizzling as necessary.
 void CopySwizzledData(u32 width, u32 height, u32 depth, u32 bytes_per_pixel,
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include "core/core.h"
 #include "core/settings.h"
@@ -27,10 +29,12 @@ std::unique_ptr<Tegra::GPU> CreateGPU(Core::System& system) {
 }
 
 u16 GetResolutionScaleFactor(const RendererBase& renderer) {
-    return static_cast<u16>(
-        Settings::values.resolution_factor
-            ? Settings::values.resolution_factor
-            : renderer.GetRenderWindow().GetFramebufferLayout().GetScalingRatio());
+    // Factors below native are rounded up, the integer factor is never zero
+    return std::max<u16>(
+        1, static_cast<u16>(
+               Settings::values.resolution_factor
+                   ? std::ceil(Settings::values.resolution_factor)
+                   : renderer.GetRenderWindow().GetFramebufferLayout().GetScalingRatio()));
 }
 
 } // namespace VideoCore
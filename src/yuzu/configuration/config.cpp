@@ -406,6 +406,10 @@ void Config::ReadAudioValues() {
                                    .toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting(QStringLiteral("enable_audio_stretching"), true).toBool();
+    Settings::values.resampling_quality =
+        static_cast<u16>(ReadSetting(QStringLiteral("resampling_quality"), 2).toUInt());
+    Settings::values.enable_low_latency_audio =
+        ReadSetting(QStringLiteral("enable_low_latency_audio"), false).toBool();
     Settings::values.audio_device_id =
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
@@ -438,6 +442,14 @@ void Config::ReadCoreValues() {
 
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
     Settings::values.use_multi_core = ReadSetting(QStringLiteral("use_multi_core"), false).toBool();
+    Settings::values.use_function_hooks =
+        ReadSetting(QStringLiteral("use_function_hooks"), true).toBool();
+    Settings::values.use_host_timing =
+        ReadSetting(QStringLiteral("use_host_timing"), false).toBool();
+    Settings::values.use_service_threads =
+        ReadSetting(QStringLiteral("use_service_threads"), true).toBool();
+    Settings::values.pin_host_threads =
+        ReadSetting(QStringLiteral("pin_host_threads"), false).toBool();
 
     qt_config->endGroup();
 }
@@ -473,6 +485,14 @@ void Config::ReadDebuggingValues() {
         ReadSetting(QStringLiteral("program_args"), QStringLiteral("")).toString().toStdString();
     Settings::values.dump_exefs = ReadSetting(QStringLiteral("dump_exefs"), false).toBool();
     Settings::values.dump_nso = ReadSetting(QStringLiteral("dump_nso"), false).toBool();
+    Settings::values.gpu_trace_frames =
+        ReadSetting(QStringLiteral("gpu_trace_frames"), 0).toUInt();
+    Settings::values.dump_shader_stats =
+        ReadSetting(QStringLiteral("dump_shader_stats"), false).toBool();
+    Settings::values.record_frames = ReadSetting(QStringLiteral("record_frames"), false).toBool();
+    Settings::values.record_frames_zstd_level =
+        ReadSetting(QStringLiteral("record_frames_zstd_level"), 1).toUInt();
+    Settings::values.profile_guest = ReadSetting(QStringLiteral("profile_guest"), false).toBool();
 
     qt_config->endGroup();
 }
@@ -497,6 +517,37 @@ void Config::ReadDisabledAddOnValues() {
     qt_config->endArray();
 }
 
+void Config::ReadTitleOverrideValues() {
+    const auto size = qt_config->beginReadArray(QStringLiteral("TitleOverrides"));
+
+    const auto read_bool = [this](const QString& name, std::optional<bool>& out) {
+        if (qt_config->contains(name)) {
+            out = ReadSetting(name).toBool();
+        }
+    };
+
+    for (int i = 0; i < size; ++i) {
+        qt_config->setArrayIndex(i);
+        const auto title_id = ReadSetting(QStringLiteral("title_id"), 0).toULongLong();
+
+        Settings::TitleOverrides overrides;
+        read_bool(QStringLiteral("use_multi_core"), overrides.use_multi_core);
+        read_bool(QStringLiteral("use_function_hooks"), overrides.use_function_hooks);
+        read_bool(QStringLiteral("use_asynchronous_gpu_emulation"),
+                  overrides.use_asynchronous_gpu_emulation);
+        read_bool(QStringLiteral("use_accurate_gpu_emulation"),
+                  overrides.use_accurate_gpu_emulation);
+        read_bool(QStringLiteral("use_disk_shader_cache"), overrides.use_disk_shader_cache);
+        if (qt_config->contains(QStringLiteral("resolution_factor"))) {
+            overrides.resolution_factor =
+                ReadSetting(QStringLiteral("resolution_factor")).toFloat();
+        }
+        Settings::values.title_overrides.insert_or_assign(title_id, overrides);
+    }
+
+    qt_config->endArray();
+}
+
 void Config::ReadMiscellaneousValues() {
     qt_config->beginGroup(QStringLiteral("Miscellaneous"));
 
@@ -531,16 +582,27 @@ void Config::ReadRendererValues() {
     Settings::values.use_frame_limit =
         ReadSetting(QStringLiteral("use_frame_limit"), true).toBool();
     Settings::values.frame_limit = ReadSetting(QStringLiteral("frame_limit"), 100).toInt();
+    Settings::values.frame_limit_fps = ReadSetting(QStringLiteral("frame_limit_fps"), 0).toInt();
     Settings::values.use_compatibility_profile =
         ReadSetting(QStringLiteral("use_compatibility_profile"), true).toBool();
     Settings::values.use_disk_shader_cache =
         ReadSetting(QStringLiteral("use_disk_shader_cache"), true).toBool();
+    Settings::values.use_disk_texture_cache =
+        ReadSetting(QStringLiteral("use_disk_texture_cache"), false).toBool();
     Settings::values.use_accurate_gpu_emulation =
         ReadSetting(QStringLiteral("use_accurate_gpu_emulation"), false).toBool();
     Settings::values.use_asynchronous_gpu_emulation =
         ReadSetting(QStringLiteral("use_asynchronous_gpu_emulation"), false).toBool();
+    Settings::values.use_asynchronous_shaders =
+        ReadSetting(QStringLiteral("use_asynchronous_shaders"), false).toBool();
+    Settings::values.use_compute_swizzle =
+        ReadSetting(QStringLiteral("use_compute_swizzle"), false).toBool();
+    Settings::values.vram_budget =
+        static_cast<u16>(ReadSetting(QStringLiteral("vram_budget"), 0).toUInt());
     Settings::values.force_30fps_mode =
         ReadSetting(QStringLiteral("force_30fps_mode"), false).toBool();
+    Settings::values.use_immediate_composition =
+        ReadSetting(QStringLiteral("use_immediate_composition"), false).toBool();
 
     Settings::values.bg_red = ReadSetting(QStringLiteral("bg_red"), 0.0).toFloat();
     Settings::values.bg_green = ReadSetting(QStringLiteral("bg_green"), 0.0).toFloat();
@@ -694,6 +756,7 @@ void Config::ReadValues() {
     ReadDebugValues();
     ReadWebServiceValues();
     ReadDisabledAddOnValues();
+    ReadTitleOverrideValues();
     ReadUIValues();
 }
 
@@ -791,6 +854,7 @@ void Config::SaveValues() {
     SaveDebuggingValues();
     SaveWebServiceValues();
     SaveDisabledAddOnValues();
+    SaveTitleOverrideValues();
     SaveUIValues();
 }
 
@@ -801,6 +865,9 @@ void Config::SaveAudioValues() {
                  QStringLiteral("auto"));
     WriteSetting(QStringLiteral("enable_audio_stretching"),
                  Settings::values.enable_audio_stretching, true);
+    WriteSetting(QStringLiteral("resampling_quality"), Settings::values.resampling_quality, 2);
+    WriteSetting(QStringLiteral("enable_low_latency_audio"),
+                 Settings::values.enable_low_latency_audio, false);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
@@ -828,7 +895,18 @@ void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
-    WriteSetting(QStringLiteral("use_multi_core"), Settings::values.use_multi_core, false);
+    // The overrides of a running title are not part of the global configuration
+    WriteSetting(QStringLiteral("use_multi_core"),
+                 Settings::GetGlobalValue(Settings::values.use_multi_core,
+                                          &Settings::TitleOverrides::use_multi_core),
+                 false);
+    WriteSetting(QStringLiteral("use_function_hooks"),
+                 Settings::GetGlobalValue(Settings::values.use_function_hooks,
+                                          &Settings::TitleOverrides::use_function_hooks),
+                 true);
+    WriteSetting(QStringLiteral("use_host_timing"), Settings::values.use_host_timing, false);
+    WriteSetting(QStringLiteral("use_service_threads"), Settings::values.use_service_threads, true);
+    WriteSetting(QStringLiteral("pin_host_threads"), Settings::values.pin_host_threads, false);
 
     qt_config->endGroup();
 }
@@ -856,6 +934,12 @@ void Config::SaveDebuggingValues() {
                  QString::fromStdString(Settings::values.program_args), QStringLiteral(""));
     WriteSetting(QStringLiteral("dump_exefs"), Settings::values.dump_exefs, false);
     WriteSetting(QStringLiteral("dump_nso"), Settings::values.dump_nso, false);
+    WriteSetting(QStringLiteral("gpu_trace_frames"), Settings::values.gpu_trace_frames, 0);
+    WriteSetting(QStringLiteral("dump_shader_stats"), Settings::values.dump_shader_stats, false);
+    WriteSetting(QStringLiteral("record_frames"), Settings::values.record_frames, false);
+    WriteSetting(QStringLiteral("record_frames_zstd_level"),
+                 Settings::values.record_frames_zstd_level, 1);
+    WriteSetting(QStringLiteral("profile_guest"), Settings::values.profile_guest, false);
 
     qt_config->endGroup();
 }
@@ -880,6 +964,41 @@ void Config::SaveDisabledAddOnValues() {
     qt_config->endArray();
 }
 
+void Config::SaveTitleOverrideValues() {
+    // Clear the previous entries, the settings that are no longer overridden have no key
+    qt_config->remove(QStringLiteral("TitleOverrides"));
+    qt_config->beginWriteArray(QStringLiteral("TitleOverrides"));
+
+    const auto write_bool = [this](const QString& name, const std::optional<bool>& value) {
+        if (value) {
+            WriteSetting(name, *value);
+        }
+    };
+
+    int i = 0;
+    for (const auto& [title_id, overrides] : Settings::values.title_overrides) {
+        if (overrides.IsEmpty()) {
+            continue;
+        }
+        qt_config->setArrayIndex(i);
+        WriteSetting(QStringLiteral("title_id"), QVariant::fromValue<u64>(title_id), 0);
+        write_bool(QStringLiteral("use_multi_core"), overrides.use_multi_core);
+        write_bool(QStringLiteral("use_function_hooks"), overrides.use_function_hooks);
+        write_bool(QStringLiteral("use_asynchronous_gpu_emulation"),
+                   overrides.use_asynchronous_gpu_emulation);
+        write_bool(QStringLiteral("use_accurate_gpu_emulation"),
+                   overrides.use_accurate_gpu_emulation);
+        write_bool(QStringLiteral("use_disk_shader_cache"), overrides.use_disk_shader_cache);
+        if (overrides.resolution_factor) {
+            WriteSetting(QStringLiteral("resolution_factor"),
+                         static_cast<double>(*overrides.resolution_factor));
+        }
+        ++i;
+    }
+
+    qt_config->endArray();
+}
+
 void Config::SaveMiscellaneousValues() {
     qt_config->beginGroup(QStringLiteral("Miscellaneous"));
 
@@ -908,19 +1027,38 @@ void Config::SavePathValues() {
 void Config::SaveRendererValues() {
     qt_config->beginGroup(QStringLiteral("Renderer"));
 
-    WriteSetting(QStringLiteral("resolution_factor"),
-                 static_cast<double>(Settings::values.resolution_factor), 1.0);
+    // The overrides of a running title are not part of the global configuration
+    const float resolution_factor = Settings::GetGlobalValue(
+        Settings::values.resolution_factor, &Settings::TitleOverrides::resolution_factor);
+    WriteSetting(QStringLiteral("resolution_factor"), static_cast<double>(resolution_factor), 1.0);
     WriteSetting(QStringLiteral("use_frame_limit"), Settings::values.use_frame_limit, true);
     WriteSetting(QStringLiteral("frame_limit"), Settings::values.frame_limit, 100);
+    WriteSetting(QStringLiteral("frame_limit_fps"), Settings::values.frame_limit_fps, 0);
     WriteSetting(QStringLiteral("use_compatibility_profile"),
                  Settings::values.use_compatibility_profile, true);
-    WriteSetting(QStringLiteral("use_disk_shader_cache"), Settings::values.use_disk_shader_cache,
+    WriteSetting(QStringLiteral("use_disk_shader_cache"),
+                 Settings::GetGlobalValue(Settings::values.use_disk_shader_cache,
+                                          &Settings::TitleOverrides::use_disk_shader_cache),
                  true);
+    WriteSetting(QStringLiteral("use_disk_texture_cache"), Settings::values.use_disk_texture_cache,
+                 false);
     WriteSetting(QStringLiteral("use_accurate_gpu_emulation"),
-                 Settings::values.use_accurate_gpu_emulation, false);
-    WriteSetting(QStringLiteral("use_asynchronous_gpu_emulation"),
-                 Settings::values.use_asynchronous_gpu_emulation, false);
+                 Settings::GetGlobalValue(Settings::values.use_accurate_gpu_emulation,
+                                          &Settings::TitleOverrides::use_accurate_gpu_emulation),
+                 false);
+    WriteSetting(
+        QStringLiteral("use_asynchronous_gpu_emulation"),
+        Settings::GetGlobalValue(Settings::values.use_asynchronous_gpu_emulation,
+                                 &Settings::TitleOverrides::use_asynchronous_gpu_emulation),
+        false);
+    WriteSetting(QStringLiteral("use_asynchronous_shaders"),
+                 Settings::values.use_asynchronous_shaders, false);
+    WriteSetting(QStringLiteral("use_compute_swizzle"), Settings::values.use_compute_swizzle,
+                 false);
+    WriteSetting(QStringLiteral("vram_budget"), Settings::values.vram_budget, 0);
     WriteSetting(QStringLiteral("force_30fps_mode"), Settings::values.force_30fps_mode, false);
+    WriteSetting(QStringLiteral("use_immediate_composition"),
+                 Settings::values.use_immediate_composition, false);
 
     // Cast to double because Qt's written float values are not human-readable
     WriteSetting(QStringLiteral("bg_red"), static_cast<double>(Settings::values.bg_red), 0.0);
@@ -48,6 +48,7 @@ private:
     void ReadRendererValues();
     void ReadShortcutValues();
     void ReadSystemValues();
+    void ReadTitleOverrideValues();
     void ReadUIValues();
     void ReadUIGamelistValues();
     void ReadUILayoutValues();
@@ -71,6 +72,7 @@ private:
     void SaveRendererValues();
     void SaveShortcutValues();
     void SaveSystemValues();
+    void SaveTitleOverrideValues();
     void SaveUIValues();
     void SaveUIGamelistValues();
     void SaveUILayoutValues();
@@ -11,6 +11,7 @@
 namespace {
 enum class Resolution : int {
     Auto,
+    ScaleHalf,
     Scale1x,
     Scale2x,
     Scale3x,
@@ -21,6 +22,8 @@ float ToResolutionFactor(Resolution option) {
     switch (option) {
     case Resolution::Auto:
         return 0.f;
+    case Resolution::ScaleHalf:
+        return 0.5f;
     case Resolution::Scale1x:
         return 1.f;
     case Resolution::Scale2x:
@@ -36,6 +39,8 @@ float ToResolutionFactor(Resolution option) {
 Resolution FromResolutionFactor(float factor) {
     if (factor == 0.f) {
         return Resolution::Auto;
+    } else if (factor == 0.5f) {
+        return Resolution::ScaleHalf;
     } else if (factor == 1.f) {
         return Resolution::Scale1x;
     } else if (factor == 2.f) {
@@ -79,9 +84,16 @@ void ConfigureGraphics::setConfiguration() {
     ui->use_compatibility_profile->setChecked(Settings::values.use_compatibility_profile);
     ui->use_disk_shader_cache->setEnabled(runtime_lock);
     ui->use_disk_shader_cache->setChecked(Settings::values.use_disk_shader_cache);
+    ui->use_disk_texture_cache->setEnabled(runtime_lock);
+    ui->use_disk_texture_cache->setChecked(Settings::values.use_disk_texture_cache);
     ui->use_accurate_gpu_emulation->setChecked(Settings::values.use_accurate_gpu_emulation);
     ui->use_asynchronous_gpu_emulation->setEnabled(runtime_lock);
     ui->use_asynchronous_gpu_emulation->setChecked(Settings::values.use_asynchronous_gpu_emulation);
+    ui->use_asynchronous_shaders->setEnabled(runtime_lock);
+    ui->use_asynchronous_shaders->setChecked(Settings::values.use_asynchronous_shaders);
+    ui->use_compute_swizzle->setEnabled(runtime_lock);
+    ui->use_compute_swizzle->setChecked(Settings::values.use_compute_swizzle);
+    ui->vram_budget->setValue(Settings::values.vram_budget);
     ui->force_30fps_mode->setEnabled(runtime_lock);
     ui->force_30fps_mode->setChecked(Settings::values.force_30fps_mode);
     UpdateBackgroundColorButton(QColor::fromRgbF(Settings::values.bg_red, Settings::values.bg_green,
@@ -95,9 +107,13 @@ void ConfigureGraphics::applyConfiguration() {
     Settings::values.frame_limit = ui->frame_limit->value();
     Settings::values.use_compatibility_profile = ui->use_compatibility_profile->isChecked();
     Settings::values.use_disk_shader_cache = ui->use_disk_shader_cache->isChecked();
+    Settings::values.use_disk_texture_cache = ui->use_disk_texture_cache->isChecked();
     Settings::values.use_accurate_gpu_emulation = ui->use_accurate_gpu_emulation->isChecked();
     Settings::values.use_asynchronous_gpu_emulation =
         ui->use_asynchronous_gpu_emulation->isChecked();
+    Settings::values.use_asynchronous_shaders = ui->use_asynchronous_shaders->isChecked();
+    Settings::values.use_compute_swizzle = ui->use_compute_swizzle->isChecked();
+    Settings::values.vram_budget = static_cast<u16>(ui->vram_budget->value());
     Settings::values.force_30fps_mode = ui->force_30fps_mode->isChecked();
     Settings::values.bg_red = static_cast<float>(bg_color.redF());
     Settings::values.bg_green = static_cast<float>(bg_color.greenF());
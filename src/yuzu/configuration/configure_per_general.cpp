@@ -6,6 +6,9 @@
 #include <memory>
 #include <utility>
 
+#include <QComboBox>
+#include <QFormLayout>
+#include <QGroupBox>
 #include <QHeaderView>
 #include <QMenu>
 #include <QStandardItemModel>
@@ -17,6 +20,7 @@
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/xts_archive.h"
 #include "core/loader/loader.h"
+#include "core/settings.h"
 #include "ui_configure_per_general.h"
 #include "yuzu/configuration/config.h"
 #include "yuzu/configuration/configure_input.h"
@@ -24,6 +28,43 @@
 #include "yuzu/ui_settings.h"
 #include "yuzu/util/util.h"
 
+namespace {
+/// The first entry of every override combo box keeps the global setting, it has no data
+QComboBox* CreateBoolOverride(QWidget* parent) {
+    auto* const combo_box = new QComboBox(parent);
+    combo_box->addItem(QObject::tr("Use global setting"));
+    combo_box->addItem(QObject::tr("Enabled"), true);
+    combo_box->addItem(QObject::tr("Disabled"), false);
+    return combo_box;
+}
+
+QComboBox* CreateResolutionOverride(QWidget* parent) {
+    auto* const combo_box = new QComboBox(parent);
+    combo_box->addItem(QObject::tr("Use global setting"));
+    combo_box->addItem(QObject::tr("Auto (Window Size)"), 0.f);
+    combo_box->addItem(QObject::tr("0.5x Native (640x360)"), 0.5f);
+    combo_box->addItem(QObject::tr("Native (1280x720)"), 1.f);
+    combo_box->addItem(QObject::tr("2x Native (2560x1440)"), 2.f);
+    combo_box->addItem(QObject::tr("3x Native (3840x2160)"), 3.f);
+    combo_box->addItem(QObject::tr("4x Native (5120x2880)"), 4.f);
+    return combo_box;
+}
+
+template <typename T>
+void SetOverride(QComboBox* combo_box, const std::optional<T>& value) {
+    combo_box->setCurrentIndex(value ? std::max(combo_box->findData(*value), 0) : 0);
+}
+
+template <typename T>
+std::optional<T> GetOverride(const QComboBox* combo_box) {
+    const QVariant data = combo_box->currentData();
+    if (!data.isValid()) {
+        return std::nullopt;
+    }
+    return data.value<T>();
+}
+} // Anonymous namespace
+
 ConfigurePerGameGeneral::ConfigurePerGameGeneral(QWidget* parent, u64 title_id)
     : QDialog(parent), ui(std::make_unique<Ui::ConfigurePerGameGeneral>()), title_id(title_id) {
 
@@ -65,6 +106,8 @@ ConfigurePerGameGeneral::ConfigurePerGameGeneral(QWidget* parent, u64 title_id)
     connect(item_model, &QStandardItemModel::itemChanged,
             [] { UISettings::values.is_game_list_reload_pending.exchange(true); });
 
+    CreateOverrideWidgets();
+
     this->loadConfiguration();
 }
 
@@ -80,6 +123,48 @@ void ConfigurePerGameGeneral::applyConfiguration() {
     }
 
     Settings::values.disabled_addons[title_id] = disabled_addons;
+
+    Settings::TitleOverrides overrides;
+    overrides.use_multi_core = GetOverride<bool>(use_multi_core);
+    overrides.use_asynchronous_gpu_emulation = GetOverride<bool>(use_asynchronous_gpu_emulation);
+    overrides.use_accurate_gpu_emulation = GetOverride<bool>(use_accurate_gpu_emulation);
+    overrides.use_disk_shader_cache = GetOverride<bool>(use_disk_shader_cache);
+    overrides.resolution_factor = GetOverride<float>(resolution_factor);
+    if (overrides.IsEmpty()) {
+        Settings::values.title_overrides.erase(title_id);
+    } else {
+        Settings::values.title_overrides.insert_or_assign(title_id, overrides);
+    }
+}
+
+void ConfigurePerGameGeneral::CreateOverrideWidgets() {
+    auto* const group_box = new QGroupBox(tr("Setting Overrides"), this);
+    auto* const form_layout = new QFormLayout(group_box);
+
+    use_multi_core = CreateBoolOverride(group_box);
+    use_asynchronous_gpu_emulation = CreateBoolOverride(group_box);
+    use_accurate_gpu_emulation = CreateBoolOverride(group_box);
+    use_disk_shader_cache = CreateBoolOverride(group_box);
+    resolution_factor = CreateResolutionOverride(group_box);
+
+    form_layout->addRow(tr("Multicore CPU Emulation"), use_multi_core);
+    form_layout->addRow(tr("Asynchronous GPU Emulation"), use_asynchronous_gpu_emulation);
+    form_layout->addRow(tr("Accurate GPU Emulation"), use_accurate_gpu_emulation);
+    form_layout->addRow(tr("Disk Shader Cache"), use_disk_shader_cache);
+    form_layout->addRow(tr("Internal Resolution"), resolution_factor);
+
+    // The overrides are read when the title boots, a running title keeps its settings
+    group_box->setToolTip(tr("Applied the next time this title boots"));
+    ui->VerticalLayout->addWidget(group_box);
+
+    const auto it = Settings::values.title_overrides.find(title_id);
+    const Settings::TitleOverrides overrides =
+        it != Settings::values.title_overrides.end() ? it->second : Settings::TitleOverrides{};
+    SetOverride(use_multi_core, overrides.use_multi_core);
+    SetOverride(use_asynchronous_gpu_emulation, overrides.use_asynchronous_gpu_emulation);
+    SetOverride(use_accurate_gpu_emulation, overrides.use_accurate_gpu_emulation);
+    SetOverride(use_disk_shader_cache, overrides.use_disk_shader_cache);
+    SetOverride(resolution_factor, overrides.resolution_factor);
 }
 
 void ConfigurePerGameGeneral::loadFromFile(FileSys::VirtualFile file) {
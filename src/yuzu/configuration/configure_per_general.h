@@ -12,6 +12,7 @@
 
 #include "core/file_sys/vfs_types.h"
 
+class QComboBox;
 class QGraphicsScene;
 class QStandardItem;
 class QStandardItemModel;
@@ -46,5 +47,13 @@ private:
 
     std::vector<QList<QStandardItem*>> list_items;
 
+    /// Overrides of the global settings, applied when the title boots
+    QComboBox* use_multi_core;
+    QComboBox* use_asynchronous_gpu_emulation;
+    QComboBox* use_accurate_gpu_emulation;
+    QComboBox* use_disk_shader_cache;
+    QComboBox* resolution_factor;
+
+    void CreateOverrideWidgets();
     void loadConfiguration();
 };
@@ -0,0 +1,79 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <QHeaderView>
+#include <QTableWidget>
+#include <QTimer>
+
+#include "common/memory_accounting.h"
+#include "yuzu/debugger/memory_usage.h"
+
+namespace {
+
+constexpr int REFRESH_INTERVAL_MS = 1000;
+
+enum Column { Name, Live, Peak, NumColumns };
+
+QString FormatBytes(u64 bytes) {
+    return QStringLiteral("%1 MiB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 2);
+}
+
+} // Anonymous namespace
+
+MemoryUsageWidget::MemoryUsageWidget(QWidget* parent) : QDockWidget(tr("Memory Usage"), parent) {
+    setObjectName(QStringLiteral("MemoryUsageWidget"));
+
+    table = new QTableWidget(static_cast<int>(Common::MemoryAccounting::NumCategories), NumColumns,
+                             this);
+    table->setHorizontalHeaderLabels({tr("Category"), tr("Live"), tr("Peak")});
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+
+    for (std::size_t i = 0; i < Common::MemoryAccounting::NumCategories; ++i) {
+        const auto category = static_cast<Common::MemoryAccounting::Category>(i);
+        QString name = QString::fromUtf8(Common::MemoryAccounting::GetName(category));
+        if (Common::MemoryAccounting::IsDeviceMemory(category)) {
+            // Estimated from the sizes of the objects, the driver isn't queried
+            name += tr(" (VRAM, estimated)");
+        }
+        const int row = static_cast<int>(i);
+        table->setItem(row, Name, new QTableWidgetItem(name));
+        for (const int column : {Live, Peak}) {
+            auto* const item = new QTableWidgetItem;
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+    }
+    setWidget(table);
+
+    refresh_timer = new QTimer(this);
+    refresh_timer->setInterval(REFRESH_INTERVAL_MS);
+    connect(refresh_timer, &QTimer::timeout, this, &MemoryUsageWidget::Refresh);
+}
+
+MemoryUsageWidget::~MemoryUsageWidget() = default;
+
+void MemoryUsageWidget::showEvent(QShowEvent* ev) {
+    Refresh();
+    refresh_timer->start();
+    QDockWidget::showEvent(ev);
+}
+
+void MemoryUsageWidget::hideEvent(QHideEvent* ev) {
+    refresh_timer->stop();
+    QDockWidget::hideEvent(ev);
+}
+
+void MemoryUsageWidget::Refresh() {
+    for (std::size_t i = 0; i < Common::MemoryAccounting::NumCategories; ++i) {
+        const auto category = static_cast<Common::MemoryAccounting::Category>(i);
+        const int row = static_cast<int>(i);
+        table->item(row, Live)->setText(
+            FormatBytes(Common::MemoryAccounting::GetLiveBytes(category)));
+        table->item(row, Peak)->setText(
+            FormatBytes(Common::MemoryAccounting::GetPeakBytes(category)));
+    }
+}
@@ -0,0 +1,31 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QDockWidget>
+
+class QHideEvent;
+class QShowEvent;
+class QTableWidget;
+class QTimer;
+
+/// Live and peak memory of every memory accounting category, refreshed while the pane is visible
+class MemoryUsageWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit MemoryUsageWidget(QWidget* parent = nullptr);
+    ~MemoryUsageWidget() override;
+
+protected:
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+
+private:
+    void Refresh();
+
+    QTableWidget* table = nullptr;
+    QTimer* refresh_timer = nullptr;
+};
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <vector>
 #include <QAction>
 #include <QLayout>
 #include <QMouseEvent>
@@ -10,9 +12,26 @@
 #include <QTimer>
 #include "common/common_types.h"
 #include "common/microprofile.h"
+#include "core/core.h"
+#include "core/perf_stats.h"
 #include "yuzu/debugger/profiler.h"
 #include "yuzu/util/util.h"
 
+/// Draws the frame times of the last frames, along with their percentiles
+class FrameTimeWidget : public QWidget {
+public:
+    explicit FrameTimeWidget(QWidget* parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent* ev) override;
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+
+private:
+    /// Redraws the graph while the widget is visible
+    QTimer update_timer;
+};
+
 // Include the implementation of the UI in this file. This isn't in microprofile.cpp because the
 // non-Qt frontends don't need it (and don't implement the UI drawing hooks either).
 #if MICROPROFILE_ENABLED
@@ -53,14 +72,16 @@ MicroProfileDialog::MicroProfileDialog(QWidget* parent) : QWidget(parent, Qt::Di
     // Remove the "?" button from the titlebar and enable the maximize button
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint | Qt::WindowMaximizeButtonHint);
 
+    QLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    layout->addWidget(new FrameTimeWidget(this));
+    setLayout(layout);
+
 #if MICROPROFILE_ENABLED
 
     MicroProfileWidget* widget = new MicroProfileWidget(this);
-
-    QLayout* layout = new QVBoxLayout(this);
-    layout->setContentsMargins(0, 0, 0, 0);
     layout->addWidget(widget);
-    setLayout(layout);
 
     // Configure focus so that widget is focusable and the dialog automatically forwards focus to
     // it.
@@ -95,6 +116,68 @@ void MicroProfileDialog::hideEvent(QHideEvent* ev) {
     QWidget::hideEvent(ev);
 }
 
+FrameTimeWidget::FrameTimeWidget(QWidget* parent) : QWidget(parent) {
+    setFixedHeight(120);
+
+    connect(&update_timer, &QTimer::timeout, this,
+            static_cast<void (FrameTimeWidget::*)()>(&FrameTimeWidget::update));
+}
+
+void FrameTimeWidget::paintEvent(QPaintEvent* ev) {
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    auto& system = Core::System::GetInstance();
+    if (!system.IsPoweredOn()) {
+        return;
+    }
+    const auto history = system.GetPerfStats().GetFrameHistory();
+    const std::vector<double> frame_times = Core::GetFrameTimes(history);
+    const Core::FrameTimeStats stats = Core::ComputeFrameTimeStats(history);
+
+    // Scale the graph to fit the worst frame, but never below 2 frames at 60 Hz
+    const double max_time = std::max(stats.max, 2 * 1000.0 / 60);
+    const qreal scale_y = height() / max_time;
+    const auto to_y = [&](double frame_time) { return height() - frame_time * scale_y; };
+
+    painter.setPen(QColor(60, 60, 60));
+    for (const double target : {1000.0 / 60, 1000.0 / 30}) {
+        painter.drawLine(QPointF(0, to_y(target)), QPointF(width(), to_y(target)));
+    }
+
+    // Draw the newest frames at the right edge, one pixel per frame
+    const std::size_t num_points = std::min<std::size_t>(frame_times.size(), width());
+    std::vector<QPointF> points;
+    points.reserve(num_points);
+    for (std::size_t i = 0; i < num_points; ++i) {
+        const double frame_time = frame_times[frame_times.size() - num_points + i];
+        points.emplace_back(width() - static_cast<qreal>(num_points - i), to_y(frame_time));
+    }
+    painter.setPen(QColor(80, 220, 80));
+    painter.drawPolyline(points.data(), static_cast<int>(points.size()));
+
+    painter.setPen(Qt::white);
+    painter.setFont(GetMonospaceFont());
+    painter.drawText(rect().adjusted(4, 4, -4, -4), Qt::AlignLeft | Qt::AlignTop,
+                     tr("Frame time: %1 ms avg, %2 ms 1% low, %3 ms 0.1% low, %4 ms max, "
+                        "%5 dropped")
+                         .arg(stats.average, 0, 'f', 2)
+                         .arg(stats.percentile_99, 0, 'f', 2)
+                         .arg(stats.percentile_999, 0, 'f', 2)
+                         .arg(stats.max, 0, 'f', 2)
+                         .arg(stats.dropped_frames));
+}
+
+void FrameTimeWidget::showEvent(QShowEvent* ev) {
+    update_timer.start(100);
+    QWidget::showEvent(ev);
+}
+
+void FrameTimeWidget::hideEvent(QHideEvent* ev) {
+    update_timer.stop();
+    QWidget::hideEvent(ev);
+}
+
 #if MICROPROFILE_ENABLED
 
 /// There's no way to pass a user pointer to MicroProfile, so this variable is used to make the
@@ -2,16 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
 
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
@@ -21,6 +29,7 @@
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
+#include "core/file_sys/vfs_offset.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
 #include "yuzu/compatibility_list.h"
@@ -30,6 +39,47 @@
 #include "yuzu/ui_settings.h"
 
 namespace {
+constexpr quint32 CACHE_MAGIC = 0x434C4759; // "YGLC"
+constexpr quint32 CACHE_VERSION = 1;
+
+QString GetCachePath() {
+    return QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) +
+                                  "game_list" DIR_SEP "metadata.bin");
+}
+
+/// Sizes and modification times of the key files, files may parse differently with other keys
+QVector<qint64> GetKeysSignature() {
+    QVector<qint64> signature;
+    for (const auto& dir : {FileUtil::GetUserPath(FileUtil::UserPath::KeysDir),
+                            FileUtil::GetHactoolConfigurationPath() + DIR_SEP}) {
+        for (const char* name : {"prod.keys", "dev.keys", "title.keys", "console.keys"}) {
+            const QFileInfo info(QString::fromStdString(dir + name));
+            signature << info.size()
+                      << (info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0);
+        }
+    }
+    return signature;
+}
+
+/// Returns the offset of a file within another one, if it is a window into it
+std::optional<u64> GetOffsetInFile(FileSys::VirtualFile content, const FileSys::VirtualFile& file) {
+    u64 offset = 0;
+    while (content != file) {
+        const auto offset_file = std::dynamic_pointer_cast<FileSys::OffsetVfsFile>(content);
+        if (offset_file == nullptr) {
+            return std::nullopt;
+        }
+        offset += offset_file->GetOffset();
+        content = offset_file->GetBaseFile();
+    }
+    return offset;
+}
+
+u32 GetUpdateVersion(u64 program_id) {
+    const auto& installed = Core::System::GetInstance().GetContentProvider();
+    return installed.GetEntryVersion(FileSys::GetUpdateTitleID(program_id)).value_or(0);
+}
+
 void GetMetadataFromControlNCA(const FileSys::PatchManager& patch_manager, const FileSys::NCA& nca,
                                std::vector<u8>& icon, std::string& name) {
     auto [nacp, icon_file] = patch_manager.ParseControlNCA(nca);
@@ -60,10 +110,9 @@ QString FormatGameName(const std::string& physical_name) {
 }
 
 QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
-                                Loader::AppLoader& loader, bool updatable = true) {
+                                Loader::FileType file_type, FileSys::VirtualFile update_raw,
+                                bool updatable) {
     QString out;
-    FileSys::VirtualFile update_raw;
-    loader.ReadUpdateRaw(update_raw);
     for (const auto& kv : patch_manager.GetPatchVersionNames(update_raw)) {
         const bool is_update = kv.first == "Update" || kv.first == "[D] Update";
         if (!updatable && is_update) {
@@ -79,7 +128,7 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
 
             // Display container name for packed updates
             if (is_update && ver == "PACKED") {
-                ver = Loader::GetFileTypeString(loader.GetFileType());
+                ver = Loader::GetFileTypeString(file_type);
             }
 
             out.append(QStringLiteral("%1 (%2)\n").arg(type, QString::fromStdString(ver)));
@@ -90,10 +139,18 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
     return out;
 }
 
+QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
+                                Loader::AppLoader& loader) {
+    FileSys::VirtualFile update_raw;
+    loader.ReadUpdateRaw(update_raw);
+    return FormatPatchNameVersions(patch_manager, loader.GetFileType(), std::move(update_raw),
+                                   loader.IsRomFSUpdatable());
+}
+
 QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
-                                        const std::vector<u8>& icon, Loader::AppLoader& loader,
+                                        const std::vector<u8>& icon, Loader::FileType file_type,
                                         u64 program_id, const CompatibilityList& compatibility_list,
-                                        const FileSys::PatchManager& patch) {
+                                        const QString& patch_versions) {
     const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
     // The game list uses this as compatibility number for untested games
@@ -102,7 +159,6 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
     const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
 
     QList<QStandardItem*> list{
@@ -114,8 +170,7 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
     };
 
     if (UISettings::values.show_add_ons) {
-        list.insert(
-            2, new GameListItem(FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable())));
+        list.insert(2, new GameListItem(patch_versions));
     }
 
     return list;
@@ -155,9 +210,174 @@ void GameListWorker::AddTitlesToGameList() {
         if (control != nullptr)
             GetMetadataFromControlNCA(patch, *control, icon, name);
 
-        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, *loader, program_id,
-                                          compatibility_list, patch));
+        const QString patch_versions =
+            UISettings::values.show_add_ons ? FormatPatchNameVersions(patch, *loader) : QString{};
+        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, loader->GetFileType(),
+                                          program_id, compatibility_list, patch_versions));
+    }
+}
+
+GameListWorker::CacheEntry& GameListWorker::GetCacheEntry(const std::string& physical_name) {
+    const auto iter = cache.find(physical_name);
+    if (iter != cache.end()) {
+        return iter->second;
+    }
+
+    const QFileInfo info(QString::fromStdString(physical_name));
+    const auto size = static_cast<u64>(info.size());
+    const auto modified = info.lastModified().toMSecsSinceEpoch();
+
+    auto& entry = cache[physical_name];
+    const auto loaded = loaded_cache.find(physical_name);
+    if (loaded != loaded_cache.end() && loaded->second.size == size &&
+        loaded->second.modified == modified) {
+        entry = std::move(loaded->second);
+    } else {
+        entry.size = size;
+        entry.modified = modified;
+    }
+    return entry;
+}
+
+void GameListWorker::AddFileToContentProvider(const std::string& physical_name,
+                                              CacheEntry& entry) {
+    const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
+    if (file == nullptr) {
+        return;
+    }
+
+    if (entry.has_contents) {
+        for (const auto& content : entry.contents) {
+            FileSys::VirtualFile content_file = file;
+            if (content.offset != 0 || content.size != file->GetSize()) {
+                content_file = std::make_shared<FileSys::OffsetVfsFile>(
+                    file, content.size, content.offset, content.name);
+            }
+            provider->AddEntry(static_cast<FileSys::TitleType>(content.title_type),
+                               static_cast<FileSys::ContentRecordType>(content.record_type),
+                               content.title_id, std::move(content_file));
+        }
+        return;
+    }
+
+    const auto loader = Loader::GetLoader(file);
+    if (!loader) {
+        return;
+    }
+
+    u64 program_id = 0;
+    if (loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        return;
+    }
+
+    // The contents are only cached if they can be found again without parsing the file
+    std::vector<CachedContent> contents;
+    bool is_cacheable = !IsExtractedNCAMain(physical_name);
+    const auto add_entry = [&](FileSys::TitleType title_type,
+                               FileSys::ContentRecordType record_type, u64 title_id,
+                               FileSys::VirtualFile content_file) {
+        const auto offset = GetOffsetInFile(content_file, file);
+        if (offset) {
+            contents.push_back({static_cast<u8>(title_type), static_cast<u8>(record_type),
+                                title_id, *offset, content_file->GetSize(),
+                                content_file->GetName()});
+        } else {
+            is_cacheable = false;
+        }
+        provider->AddEntry(title_type, record_type, title_id, std::move(content_file));
+    };
+
+    const auto file_type = loader->GetFileType();
+    if (file_type == Loader::FileType::NCA) {
+        add_entry(FileSys::TitleType::Application,
+                  FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()), program_id, file);
+    } else if (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP) {
+        const auto nsp = file_type == Loader::FileType::NSP
+                             ? std::make_shared<FileSys::NSP>(file)
+                             : FileSys::XCI{file}.GetSecurePartitionNSP();
+        for (const auto& title : nsp->GetNCAs()) {
+            for (const auto& nca_entry : title.second) {
+                add_entry(nca_entry.first.first, nca_entry.first.second, title.first,
+                          nca_entry.second->GetBaseFile());
+            }
+        }
+    }
+
+    if (is_cacheable) {
+        entry.has_contents = true;
+        entry.contents = std::move(contents);
+        cache_changed = true;
+    }
+}
+
+void GameListWorker::AddFileToGameList(const std::string& physical_name, CacheEntry& entry) {
+    // The name and the icon come from the installed update if there is one
+    if (entry.has_metadata && entry.update_version == GetUpdateVersion(entry.program_id)) {
+        QString patch_versions;
+        if (UISettings::values.show_add_ons) {
+            const auto update_raw =
+                entry.has_packed_update
+                    ? provider->GetEntryRaw(FileSys::GetUpdateTitleID(entry.program_id),
+                                            FileSys::ContentRecordType::Program)
+                    : nullptr;
+            patch_versions =
+                FormatPatchNameVersions(FileSys::PatchManager{entry.program_id}, entry.file_type,
+                                        update_raw, entry.is_romfs_updatable);
+        }
+
+        emit EntryReady(MakeGameListEntry(physical_name, entry.name, entry.icon, entry.file_type,
+                                          entry.program_id, compatibility_list, patch_versions));
+        return;
+    }
+
+    const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
+    const auto loader = Loader::GetLoader(file);
+    if (!loader) {
+        return;
     }
+
+    const auto file_type = loader->GetFileType();
+    const bool is_unknown =
+        file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error;
+    if (is_unknown && !UISettings::values.show_unknown) {
+        return;
+    }
+
+    u64 program_id = 0;
+    const auto res2 = loader->ReadProgramId(program_id);
+
+    std::vector<u8> icon;
+    const auto res1 = loader->ReadIcon(icon);
+
+    std::string name = " ";
+    const auto res3 = loader->ReadTitle(name);
+
+    FileSys::VirtualFile update_raw;
+    const bool has_packed_update =
+        loader->ReadUpdateRaw(update_raw) == Loader::ResultStatus::Success && update_raw != nullptr;
+
+    const FileSys::PatchManager patch{program_id};
+    const QString patch_versions =
+        UISettings::values.show_add_ons
+            ? FormatPatchNameVersions(patch, file_type, update_raw, loader->IsRomFSUpdatable())
+            : QString{};
+
+    emit EntryReady(MakeGameListEntry(physical_name, name, icon, file_type, program_id,
+                                      compatibility_list, patch_versions));
+
+    if (res2 != Loader::ResultStatus::Success || is_unknown || IsExtractedNCAMain(physical_name)) {
+        return;
+    }
+
+    entry.has_metadata = true;
+    entry.program_id = program_id;
+    entry.name = std::move(name);
+    entry.icon = std::move(icon);
+    entry.file_type = file_type;
+    entry.is_romfs_updatable = loader->IsRomFSUpdatable();
+    entry.has_packed_update = has_packed_update;
+    entry.update_version = GetUpdateVersion(program_id);
+    cache_changed = true;
 }
 
 void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path,
@@ -174,50 +394,11 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
-            auto loader = Loader::GetLoader(file);
-            if (!loader) {
-                return true;
-            }
-
-            const auto file_type = loader->GetFileType();
-            if ((file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) &&
-                !UISettings::values.show_unknown) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
+            auto& entry = GetCacheEntry(physical_name);
             if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
+                AddFileToContentProvider(physical_name, entry);
             } else {
-                std::vector<u8> icon;
-                const auto res1 = loader->ReadIcon(icon);
-
-                std::string name = " ";
-                const auto res3 = loader->ReadTitle(name);
-
-                const FileSys::PatchManager patch{program_id};
-
-                emit EntryReady(MakeGameListEntry(physical_name, name, icon, *loader, program_id,
-                                                  compatibility_list, patch));
+                AddFileToGameList(physical_name, entry);
             }
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
@@ -230,14 +411,127 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::LoadCache() {
+    QFile file(GetCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QVector<qint64> keys_signature;
+    stream >> magic >> version >> keys_signature;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || keys_signature != GetKeysSignature()) {
+        return;
+    }
+
+    quint32 num_entries = 0;
+    stream >> num_entries;
+    for (quint32 i = 0; i < num_entries && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray path;
+        quint64 size = 0;
+        qint64 modified = 0;
+        bool has_contents = false;
+        quint32 num_contents = 0;
+        stream >> path >> size >> modified >> has_contents >> num_contents;
+
+        CacheEntry entry;
+        entry.size = size;
+        entry.modified = modified;
+        entry.has_contents = has_contents;
+        for (quint32 j = 0; j < num_contents && stream.status() == QDataStream::Ok; ++j) {
+            quint8 title_type = 0;
+            quint8 record_type = 0;
+            quint64 title_id = 0;
+            quint64 offset = 0;
+            quint64 content_size = 0;
+            QByteArray name;
+            stream >> title_type >> record_type >> title_id >> offset >> content_size >> name;
+            entry.contents.push_back(
+                {title_type, record_type, title_id, offset, content_size, name.toStdString()});
+        }
+
+        quint64 program_id = 0;
+        QByteArray name;
+        QByteArray icon;
+        qint32 file_type = 0;
+        quint32 update_version = 0;
+        stream >> entry.has_metadata >> program_id >> name >> icon >> file_type >>
+            entry.is_romfs_updatable >> entry.has_packed_update >> update_version;
+        entry.program_id = program_id;
+        entry.name = name.toStdString();
+        entry.icon.assign(icon.begin(), icon.end());
+        entry.file_type = static_cast<Loader::FileType>(file_type);
+        entry.update_version = update_version;
+
+        loaded_cache.insert_or_assign(path.toStdString(), std::move(entry));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        LOG_WARNING(Frontend, "Game list cache is corrupted, rescanning all files");
+        loaded_cache.clear();
+    }
+}
+
+void GameListWorker::SaveCache() const {
+    const QString path = GetCachePath();
+    if (!FileUtil::CreateFullPath(path.toStdString())) {
+        LOG_ERROR(Frontend, "Failed to create the game list cache directory");
+        return;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERROR(Frontend, "Failed to open the game list cache for writing");
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << CACHE_MAGIC << CACHE_VERSION << GetKeysSignature()
+           << static_cast<quint32>(cache.size());
+    for (const auto& [physical_name, entry] : cache) {
+        stream << QByteArray::fromStdString(physical_name) << quint64{entry.size}
+               << qint64{entry.modified} << entry.has_contents
+               << static_cast<quint32>(entry.contents.size());
+        for (const auto& content : entry.contents) {
+            stream << quint8{content.title_type} << quint8{content.record_type}
+                   << quint64{content.title_id} << quint64{content.offset}
+                   << quint64{content.size} << QByteArray::fromStdString(content.name);
+        }
+
+        const QByteArray icon(reinterpret_cast<const char*>(entry.icon.data()),
+                              static_cast<int>(entry.icon.size()));
+        stream << entry.has_metadata << quint64{entry.program_id}
+               << QByteArray::fromStdString(entry.name) << icon
+               << static_cast<qint32>(entry.file_type) << entry.is_romfs_updatable
+               << entry.has_packed_update << quint32{entry.update_version};
+    }
+
+    if (!file.commit()) {
+        LOG_ERROR(Frontend, "Failed to write the game list cache");
+    }
+}
+
 void GameListWorker::run() {
     stop_processing = false;
+    LoadCache();
     watch_list.append(dir_path);
     provider->ClearAllEntries();
     ScanFileSystem(ScanTarget::FillManualContentProvider, dir_path.toStdString(),
                    deep_scan ? 256 : 0);
     AddTitlesToGameList();
     ScanFileSystem(ScanTarget::PopulateGameList, dir_path.toStdString(), deep_scan ? 256 : 0);
+
+    if (!stop_processing) {
+        // Files that are gone are dropped from the cache
+        const bool removed_files =
+            std::any_of(loaded_cache.begin(), loaded_cache.end(),
+                        [this](const auto& kv) { return cache.count(kv.first) == 0; });
+        if (cache_changed || removed_files) {
+            SaveCache();
+        }
+    }
     emit Finished(watch_list);
 }
 
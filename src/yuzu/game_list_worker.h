@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -25,6 +26,10 @@ class NCA;
 class VfsFilesystem;
 } // namespace FileSys
 
+namespace Loader {
+enum class FileType;
+}
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -68,6 +73,46 @@ private:
 
     void ScanFileSystem(ScanTarget target, const std::string& dir_path, unsigned int recursion = 0);
 
+    /// Content of a file of the game directory that was added to the manual content provider
+    struct CachedContent {
+        u8 title_type;
+        u8 record_type;
+        u64 title_id;
+        u64 offset; ///< Offset of the content within the file
+        u64 size;
+        std::string name;
+    };
+
+    /**
+     * What was read from a file of the game directory. It is reused as long as the size and the
+     * modification time of the file are the same, so only new and changed files are parsed.
+     */
+    struct CacheEntry {
+        u64 size = 0;
+        s64 modified = 0;
+
+        bool has_contents = false;
+        std::vector<CachedContent> contents;
+
+        bool has_metadata = false;
+        u64 program_id = 0;
+        std::string name;
+        std::vector<u8> icon;
+        Loader::FileType file_type{};
+        bool is_romfs_updatable = false;
+        bool has_packed_update = false;
+        u32 update_version = 0; ///< Version of the installed update when the file was parsed
+    };
+
+    /// Returns the cache entry of a file, it is reset when the file has changed since it was cached
+    CacheEntry& GetCacheEntry(const std::string& physical_name);
+
+    void AddFileToContentProvider(const std::string& physical_name, CacheEntry& entry);
+    void AddFileToGameList(const std::string& physical_name, CacheEntry& entry);
+
+    void LoadCache();
+    void SaveCache() const;
+
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     FileSys::ManualContentProvider* provider;
     QStringList watch_list;
@@ -75,4 +120,8 @@ private:
     bool deep_scan;
     const CompatibilityList& compatibility_list;
     std::atomic_bool stop_processing;
+
+    std::unordered_map<std::string, CacheEntry> loaded_cache; ///< Entries of the previous scan
+    std::unordered_map<std::string, CacheEntry> cache;        ///< Entries of the files seen now
+    bool cache_changed = false;
 };
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <clocale>
 #include <memory>
@@ -23,18 +25,12 @@
 #include "core/hle/service/hid/controllers/npad.h"
 #include "core/hle/service/hid/hid.h"
 
-// These are wrappers to avoid the calls to CreateDirectory and CreateFile because of the Windows
-// defines.
+// This is a wrapper to avoid the call to CreateDirectory because of the Windows defines.
 static FileSys::VirtualDir VfsFilesystemCreateDirectoryWrapper(
     const FileSys::VirtualFilesystem& vfs, const std::string& path, FileSys::Mode mode) {
     return vfs->CreateDirectory(path, mode);
 }
 
-static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::VirtualDir& dir,
-                                                          const std::string& path) {
-    return dir->CreateFile(path);
-}
-
 #include <fmt/ostream.h>
 #include <glad/glad.h>
 
@@ -84,6 +80,7 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "yuzu/about_dialog.h"
 #include "yuzu/bootmanager.h"
 #include "yuzu/compatdb.h"
@@ -92,6 +89,7 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "yuzu/configuration/configure_dialog.h"
 #include "yuzu/debugger/console.h"
 #include "yuzu/debugger/graphics/graphics_breakpoints.h"
+#include "yuzu/debugger/memory_usage.h"
 #include "yuzu/debugger/profiler.h"
 #include "yuzu/debugger/wait_tree.h"
 #include "yuzu/discord.h"
@@ -493,6 +491,11 @@ void GMainWindow::InitializeDebugWidgets() {
             &WaitTreeWidget::OnEmulationStarting);
     connect(this, &GMainWindow::EmulationStopping, waitTreeWidget,
             &WaitTreeWidget::OnEmulationStopping);
+
+    memoryUsageWidget = new MemoryUsageWidget(this);
+    addDockWidget(Qt::LeftDockWidgetArea, memoryUsageWidget);
+    memoryUsageWidget->hide();
+    debug_menu->addAction(memoryUsageWidget->toggleViewAction());
 }
 
 void GMainWindow::InitializeRecentFileMenuActions() {
@@ -665,6 +668,8 @@ void GMainWindow::ConnectWidgetEvents() {
     connect(game_list, &GameList::OpenFolderRequested, this, &GMainWindow::OnGameListOpenFolder);
     connect(game_list, &GameList::OpenTransferableShaderCacheRequested, this,
             &GMainWindow::OnTransferableShaderCacheOpenFile);
+    connect(game_list, &GameList::ImportTransferableShaderCacheRequested, this,
+            &GMainWindow::OnTransferableShaderCacheImport);
     connect(game_list, &GameList::DumpRomFSRequested, this, &GMainWindow::OnGameListDumpRomFS);
     connect(game_list, &GameList::CopyTIDRequested, this, &GMainWindow::OnGameListCopyTID);
     connect(game_list, &GameList::NavigateToGamedbEntryRequested, this,
@@ -1142,37 +1147,53 @@ void GMainWindow::OnTransferableShaderCacheOpenFile(u64 program_id) {
 #endif
 }
 
-static std::size_t CalculateRomFSEntrySize(const FileSys::VirtualDir& dir, bool full) {
+void GMainWindow::OnTransferableShaderCacheImport(u64 program_id) {
+    ASSERT(program_id != 0);
+
+    const QString file_path = QFileDialog::getOpenFileName(
+        this, tr("Import Transferable Shader Cache"), {}, tr("Shader Cache (*.bin)"));
+    if (file_path.isEmpty()) {
+        return;
+    }
+
+    const auto num_merged =
+        OpenGL::ShaderDiskCacheOpenGL::MergeTransferable(program_id, file_path.toStdString());
+    if (!num_merged) {
+        QMessageBox::warning(this, tr("Error Importing Transferable Shader Cache"),
+                             tr("The shader cache could not be imported. Check the log for "
+                                "details."));
+        return;
+    }
+    QMessageBox::information(this, tr("Transferable Shader Cache Imported"),
+                             tr("%n new shader cache entries were imported. They will be built "
+                                "the next time the title is started.",
+                                "", static_cast<int>(*num_merged)));
+}
+
+// Progress of full RomFS dumps is tracked in thousandths of their size, sizes of large titles
+// don't fit in the range of the dialog
+constexpr int ROMFS_DUMP_PROGRESS_STEPS = 1000;
+
+static std::size_t CalculateRomFSDirectoryCount(const FileSys::VirtualDir& dir) {
     std::size_t out = 0;
 
     for (const auto& subdir : dir->GetSubdirectories()) {
-        out += 1 + CalculateRomFSEntrySize(subdir, full);
+        out += 1 + CalculateRomFSDirectoryCount(subdir);
     }
 
-    return out + (full ? dir->GetFiles().size() : 0);
+    return out;
 }
 
-static bool RomFSRawCopy(QProgressDialog& dialog, const FileSys::VirtualDir& src,
-                         const FileSys::VirtualDir& dest, std::size_t block_size, bool full) {
+static bool RomFSSkeletonCopy(QProgressDialog& dialog, const FileSys::VirtualDir& src,
+                              const FileSys::VirtualDir& dest) {
     if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
         return false;
     if (dialog.wasCanceled())
         return false;
 
-    if (full) {
-        for (const auto& file : src->GetFiles()) {
-            const auto out = VfsDirectoryCreateFileWrapper(dest, file->GetName());
-            if (!FileSys::VfsRawCopy(file, out, block_size))
-                return false;
-            dialog.setValue(dialog.value() + 1);
-            if (dialog.wasCanceled())
-                return false;
-        }
-    }
-
     for (const auto& dir : src->GetSubdirectories()) {
         const auto out = dest->CreateSubdirectory(dir->GetName());
-        if (!RomFSRawCopy(dialog, dir, out, block_size, full))
+        if (!RomFSSkeletonCopy(dialog, dir, out))
             return false;
         dialog.setValue(dialog.value() + 1);
         if (dialog.wasCanceled())
@@ -1182,6 +1203,31 @@ static bool RomFSRawCopy(QProgressDialog& dialog, const FileSys::VirtualDir& src
     return true;
 }
 
+static bool RomFSParallelCopy(QProgressDialog& dialog, const FileSys::VirtualDir& src,
+                              const FileSys::VirtualDir& dest) {
+    std::atomic_int progress{0};
+    std::atomic_bool canceled{false};
+    // The files are copied on the thread pool, the dialog is kept responsive in the meantime
+    auto future = QtConcurrent::run([&] {
+        return FileSys::VfsParallelCopyD(
+            src, dest, 0x400000, [&](std::size_t copied, std::size_t total) {
+                progress = static_cast<int>(copied * ROMFS_DUMP_PROGRESS_STEPS /
+                                            std::max<std::size_t>(total, 1));
+                return !canceled;
+            });
+    });
+
+    while (!future.isFinished()) {
+        QApplication::processEvents();
+        dialog.setValue(progress);
+        if (dialog.wasCanceled()) {
+            canceled = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return future.result();
+}
+
 void GMainWindow::OnGameListDumpRomFS(u64 program_id, const std::string& game_path) {
     const auto failed = [this] {
         QMessageBox::warning(this, tr("RomFS Extraction Failed!"),
@@ -1249,14 +1295,17 @@ void GMainWindow::OnGameListDumpRomFS(u64 program_id, const std::string& game_pa
     }
 
     const auto full = res == selections.constFirst();
-    const auto entry_size = CalculateRomFSEntrySize(extracted, full);
+    const auto entry_size =
+        full ? ROMFS_DUMP_PROGRESS_STEPS : CalculateRomFSDirectoryCount(extracted);
 
     QProgressDialog progress(tr("Extracting RomFS..."), tr("Cancel"), 0,
                              static_cast<s32>(entry_size), this);
     progress.setWindowModality(Qt::WindowModal);
     progress.setMinimumDuration(100);
 
-    if (RomFSRawCopy(progress, extracted, out, 0x400000, full)) {
+    const bool copied = full ? RomFSParallelCopy(progress, extracted, out)
+                             : RomFSSkeletonCopy(progress, extracted, out);
+    if (copied) {
         progress.close();
         QMessageBox::information(this, tr("RomFS Extraction Succeeded!"),
                                  tr("The operation completed successfully."));
@@ -1360,35 +1409,22 @@ void GMainWindow::OnMenuInstallToNAND() {
         return;
     }
 
-    const auto qt_raw_copy = [this](const FileSys::VirtualFile& src,
-                                    const FileSys::VirtualFile& dest, std::size_t block_size) {
-        if (src == nullptr || dest == nullptr)
-            return false;
-        if (!dest->Resize(src->GetSize()))
-            return false;
-
-        std::array<u8, 0x1000> buffer{};
-        const int progress_maximum = static_cast<int>(src->GetSize() / buffer.size());
-
-        QProgressDialog progress(
-            tr("Installing file \"%1\"...").arg(QString::fromStdString(src->GetName())),
-            tr("Cancel"), 0, progress_maximum, this);
-        progress.setWindowModality(Qt::WindowModal);
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (progress.wasCanceled()) {
-                dest->Resize(0);
-                return false;
-            }
-
-            const int progress_value = static_cast<int>(i / buffer.size());
-            progress.setValue(progress_value);
-
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
+    // Progress is reported in MiB, so the range of the dialog fits an int for any NCA
+    constexpr std::size_t progress_unit = 0x100000;
+    std::unique_ptr<QProgressDialog> progress;
+    FileSys::VirtualFile progress_file;
+    const auto qt_progress = [this, &progress, &progress_file](const FileSys::VirtualFile& nca,
+                                                               std::size_t copied) {
+        if (nca != progress_file) {
+            progress_file = nca;
+            progress = std::make_unique<QProgressDialog>(
+                tr("Installing file \"%1\"...").arg(QString::fromStdString(nca->GetName())),
+                tr("Cancel"), 0, static_cast<int>(nca->GetSize() / progress_unit), this);
+            progress->setWindowModality(Qt::WindowModal);
         }
 
-        return true;
+        progress->setValue(static_cast<int>(copied / progress_unit));
+        return !progress->wasCanceled();
     };
 
     const auto success = [this]() {
@@ -1432,14 +1468,14 @@ void GMainWindow::OnMenuInstallToNAND() {
             return;
         }
         const auto res =
-            Service::FileSystem::GetUserNANDContents()->InstallEntry(*nsp, false, qt_raw_copy);
+            Service::FileSystem::GetUserNANDContents()->InstallEntry(*nsp, false, qt_progress);
         if (res == FileSys::InstallResult::Success) {
             success();
         } else {
             if (res == FileSys::InstallResult::ErrorAlreadyExists) {
                 if (overwrite()) {
                     const auto res2 = Service::FileSystem::GetUserNANDContents()->InstallEntry(
-                        *nsp, true, qt_raw_copy);
+                        *nsp, true, qt_progress);
                     if (res2 == FileSys::InstallResult::Success) {
                         success();
                     } else {
@@ -1494,10 +1530,10 @@ void GMainWindow::OnMenuInstallToNAND() {
         FileSys::InstallResult res;
         if (index >= static_cast<size_t>(FileSys::TitleType::Application)) {
             res = Service::FileSystem::GetUserNANDContents()->InstallEntry(
-                *nca, static_cast<FileSys::TitleType>(index), false, qt_raw_copy);
+                *nca, static_cast<FileSys::TitleType>(index), false, qt_progress);
         } else {
             res = Service::FileSystem::GetSystemNANDContents()->InstallEntry(
-                *nca, static_cast<FileSys::TitleType>(index), false, qt_raw_copy);
+                *nca, static_cast<FileSys::TitleType>(index), false, qt_progress);
         }
 
         if (res == FileSys::InstallResult::Success) {
@@ -1505,7 +1541,7 @@ void GMainWindow::OnMenuInstallToNAND() {
         } else if (res == FileSys::InstallResult::ErrorAlreadyExists) {
             if (overwrite()) {
                 const auto res2 = Service::FileSystem::GetUserNANDContents()->InstallEntry(
-                    *nca, static_cast<FileSys::TitleType>(index), true, qt_raw_copy);
+                    *nca, static_cast<FileSys::TitleType>(index), true, qt_progress);
                 if (res2 == FileSys::InstallResult::Success) {
                     success();
                 } else {
@@ -25,6 +25,7 @@ class GImageInfo;
 class GraphicsBreakPointsWidget;
 class GRenderWindow;
 class LoadingScreen;
+class MemoryUsageWidget;
 class MicroProfileDialog;
 class ProfilerWidget;
 class QLabel;
@@ -179,6 +180,7 @@ private slots:
     void OnGameListLoadFile(QString game_path);
     void OnGameListOpenFolder(u64 program_id, GameListOpenTarget target);
     void OnTransferableShaderCacheOpenFile(u64 program_id);
+    void OnTransferableShaderCacheImport(u64 program_id);
     void OnGameListDumpRomFS(u64 program_id, const std::string& game_path);
     void OnGameListCopyTID(u64 program_id);
     void OnGameListNavigateToGamedbEntry(u64 program_id,
@@ -244,6 +246,7 @@ private:
     MicroProfileDialog* microProfileDialog;
     GraphicsBreakPointsWidget* graphicsBreakpointsWidget;
     WaitTreeWidget* waitTreeWidget;
+    MemoryUsageWidget* memoryUsageWidget;
 
     QAction* actions_recent_files[max_recent_files_item];
 
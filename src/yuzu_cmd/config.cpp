@@ -342,6 +342,12 @@ void Config::ReadValues() {
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
     Settings::values.use_multi_core = sdl2_config->GetBoolean("Core", "use_multi_core", false);
+    Settings::values.use_function_hooks =
+        sdl2_config->GetBoolean("Core", "use_function_hooks", true);
+    Settings::values.use_host_timing = sdl2_config->GetBoolean("Core", "use_host_timing", false);
+    Settings::values.use_service_threads =
+        sdl2_config->GetBoolean("Core", "use_service_threads", true);
+    Settings::values.pin_host_threads = sdl2_config->GetBoolean("Core", "pin_host_threads", false);
 
     // Renderer
     Settings::values.resolution_factor =
@@ -349,14 +355,26 @@ void Config::ReadValues() {
     Settings::values.use_frame_limit = sdl2_config->GetBoolean("Renderer", "use_frame_limit", true);
     Settings::values.frame_limit =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit", 100));
+    Settings::values.frame_limit_fps =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit_fps", 0));
     Settings::values.use_compatibility_profile =
         sdl2_config->GetBoolean("Renderer", "use_compatibility_profile", true);
     Settings::values.use_disk_shader_cache =
         sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", false);
+    Settings::values.use_disk_texture_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_texture_cache", false);
     Settings::values.use_accurate_gpu_emulation =
         sdl2_config->GetBoolean("Renderer", "use_accurate_gpu_emulation", false);
     Settings::values.use_asynchronous_gpu_emulation =
         sdl2_config->GetBoolean("Renderer", "use_asynchronous_gpu_emulation", false);
+    Settings::values.use_asynchronous_shaders =
+        sdl2_config->GetBoolean("Renderer", "use_asynchronous_shaders", false);
+    Settings::values.use_compute_swizzle =
+        sdl2_config->GetBoolean("Renderer", "use_compute_swizzle", false);
+    Settings::values.vram_budget =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "vram_budget", 0));
+    Settings::values.use_immediate_composition =
+        sdl2_config->GetBoolean("Renderer", "use_immediate_composition", false);
 
     Settings::values.bg_red = static_cast<float>(sdl2_config->GetReal("Renderer", "bg_red", 0.0));
     Settings::values.bg_green =
@@ -367,6 +385,10 @@ void Config::ReadValues() {
     Settings::values.sink_id = sdl2_config->Get("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.resampling_quality =
+        static_cast<u16>(sdl2_config->GetInteger("Audio", "resampling_quality", 2));
+    Settings::values.enable_low_latency_audio =
+        sdl2_config->GetBoolean("Audio", "enable_low_latency_audio", false);
     Settings::values.audio_device_id = sdl2_config->Get("Audio", "output_device", "auto");
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
 
@@ -383,6 +405,14 @@ void Config::ReadValues() {
     Settings::values.program_args = sdl2_config->Get("Debugging", "program_args", "");
     Settings::values.dump_exefs = sdl2_config->GetBoolean("Debugging", "dump_exefs", false);
     Settings::values.dump_nso = sdl2_config->GetBoolean("Debugging", "dump_nso", false);
+    Settings::values.gpu_trace_frames =
+        static_cast<u32>(sdl2_config->GetInteger("Debugging", "gpu_trace_frames", 0));
+    Settings::values.dump_shader_stats =
+        sdl2_config->GetBoolean("Debugging", "dump_shader_stats", false);
+    Settings::values.record_frames = sdl2_config->GetBoolean("Debugging", "record_frames", false);
+    Settings::values.record_frames_zstd_level =
+        static_cast<u32>(sdl2_config->GetInteger("Debugging", "record_frames_zstd_level", 1));
+    Settings::values.profile_guest = sdl2_config->GetBoolean("Debugging", "profile_guest", false);
 
     const auto title_list = sdl2_config->Get("AddOns", "title_ids", "");
     std::stringstream ss(title_list);
@@ -401,6 +431,34 @@ void Config::ReadValues() {
         Settings::values.disabled_addons.insert_or_assign(title_id, out);
     }
 
+    const auto override_list = sdl2_config->Get("TitleOverrides", "title_ids", "");
+    std::stringstream overrides_ss(override_list);
+    while (std::getline(overrides_ss, line, '|')) {
+        const auto title_id = std::stoull(line, nullptr, 16);
+        const auto key = [&line](const char* name) { return fmt::format("{}_{}", name, line); };
+        const auto has_value = [&](const char* name) {
+            return !sdl2_config->Get("TitleOverrides", key(name), "").empty();
+        };
+        const auto read_bool = [&](const char* name, std::optional<bool>& out) {
+            if (has_value(name)) {
+                out = sdl2_config->GetBoolean("TitleOverrides", key(name), false);
+            }
+        };
+
+        Settings::TitleOverrides overrides;
+        read_bool("use_multi_core", overrides.use_multi_core);
+        read_bool("use_function_hooks", overrides.use_function_hooks);
+        read_bool("use_asynchronous_gpu_emulation", overrides.use_asynchronous_gpu_emulation);
+        read_bool("use_accurate_gpu_emulation", overrides.use_accurate_gpu_emulation);
+        read_bool("use_disk_shader_cache", overrides.use_disk_shader_cache);
+        if (has_value("resolution_factor")) {
+            overrides.resolution_factor = static_cast<float>(
+                sdl2_config->GetReal("TitleOverrides", key("resolution_factor"), 1.0));
+        }
+
+        Settings::values.title_overrides.insert_or_assign(title_id, overrides);
+    }
+
     // Web Service
     Settings::values.enable_telemetry =
         sdl2_config->GetBoolean("WebService", "enable_telemetry", true);
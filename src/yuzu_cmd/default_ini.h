@@ -84,6 +84,24 @@ use_cpu_jit =
 # 0 (default): Disabled, 1: Enabled
 use_multi_core=
 
+# Whether the C library functions games export, such as memcpy, run as host code instead of
+# guest code
+# 0: Disabled, 1 (default): Enabled
+use_function_hooks=
+
+# Whether guest time follows the host clock instead of the amount of executed guest cycles
+# 0 (default): Disabled, 1: Enabled
+use_host_timing=
+
+# Whether services run their slow requests on host threads while the guest keeps executing
+# 0: Disabled, 1 (default): Enabled
+use_service_threads=
+
+# Whether the emulated cores and the GPU thread get physical host cores of their own on one NUMA
+# node, background threads then run on the host cores left
+# 0 (default): Disabled, 1: Enabled
+pin_host_threads=
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -93,9 +111,9 @@ use_hw_renderer =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
-# Resolution scale factor
-# 0: Auto (scales resolution to window size), 1: Native Switch screen resolution, Otherwise a scale
-# factor for the Switch resolution
+# Resolution scale factor of the render targets that are never read by the guest
+# 0: Auto (scales resolution to window size), 1 (default): Native Switch screen resolution,
+# Otherwise a scale factor for the Switch resolution, values below 1 render at a lower resolution
 resolution_factor =
 
 # Whether to enable V-Sync (caps the framerate at 60FPS) or not.
@@ -110,10 +128,18 @@ use_frame_limit =
 # 1 - 9999: Speed limit as a percentage of target game speed. 100 (default)
 frame_limit =
 
+# Paces frames to a fixed rate instead of the emulated time, ignoring frame_limit
+# 0 (default): Follow the emulated time, 1 - 65535: Target frames per second
+frame_limit_fps =
+
 # Whether to use disk based shader cache
 # 0 (default): Off, 1 : On
 use_disk_shader_cache =
 
+# Whether to store the textures decoded on the CPU on disk, so later runs of the title load them
+# 0 (default): Off, 1 : On
+use_disk_texture_cache =
+
 # Whether to use accurate GPU emulation
 # 0 (default): Off (fast), 1 : On (slow)
 use_accurate_gpu_emulation =
@@ -122,6 +148,23 @@ use_accurate_gpu_emulation =
 # 0 : Off (slow), 1 (default): On (fast)
 use_asynchronous_gpu_emulation =
 
+# Whether to build new shaders in the background, skipping the draws using them until they're ready
+# 0 (default): Off, 1 : On
+use_asynchronous_shaders =
+
+# Whether to swizzle and unswizzle tiled textures with compute shaders instead of on the CPU
+# 0 (default): Off, 1 : On
+use_compute_swizzle =
+
+# Amount of video memory in MiB cached textures may use before the least recently used are evicted
+# 0 (default): Unlimited, 1 - 65535: Budget in MiB
+vram_budget =
+
+# Whether to present guest frames as soon as they are queued instead of on the next emulated vsync.
+# Lowers latency on variable refresh rate and high refresh rate displays.
+# 0 (default): Off, 1 : On
+use_immediate_composition =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
@@ -164,6 +207,15 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# How voices are resampled to the output rate, lower qualities use less CPU.
+# 0: Linear, 1: Cubic, 2 (default): Sinc
+resampling_quality =
+
+# Whether to output audio with the smallest period the audio device supports.
+# This lowers audio latency, at the cost of stutter on slower systems.
+# 0 (default): No, 1: Yes
+enable_low_latency_audio =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -224,6 +276,19 @@ gdbstub_port=24689
 dump_exefs=false
 # Determines whether or not yuzu will dump all NSOs it attempts to load while loading them
 dump_nso=false
+# Number of frames to record into a GPU trace from the start, saved in the dump directory
+# 0 (default): Disabled
+gpu_trace_frames =
+# Writes the compile statistics of the shaders used by a title to the dump directory on exit
+dump_shader_stats=false
+# Records every presented frame to the dump directory without stalling the GPU thread
+record_frames=false
+# Zstandard level the recorded frames are compressed with
+# 0: Raw frames, 1 (default) - 22: Compression level
+record_frames_zstd_level =
+# Samples the guest code run by the CPU cores and writes the stacks in the format flame graph tools
+# read to the dump directory on exit
+profile_guest=false
 
 [WebService]
 # Whether or not to enable telemetry
@@ -242,5 +307,14 @@ yuzu_token =
 title_ids =
 # For each title ID, have a key/value pair called `disabled_<title_id>` equal to the names of the add-ons to disable (sep. by '|')
 # e.x. disabled_0100000000010000 = Update|DLC <- disables Updates and DLC on Super Mario Odyssey
+
+[TitleOverrides]
+# Used to override settings per game, they are applied when the game boots
+# List of title IDs of games that override settings (separated by '|'):
+title_ids =
+# For each title ID, have key/value pairs called `<setting>_<title_id>`, the settings that can be
+# overridden are use_multi_core, use_function_hooks, use_asynchronous_gpu_emulation,
+# use_accurate_gpu_emulation, use_disk_shader_cache and resolution_factor
+# e.x. use_multi_core_0100000000010000 = 1 <- enables multicore on Super Mario Odyssey
 )";
 }
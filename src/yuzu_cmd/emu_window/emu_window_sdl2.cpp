@@ -101,6 +101,12 @@ void EmuWindow_SDL2::OnFingerUp() {
 }
 
 void EmuWindow_SDL2::OnKeyEvent(int key, u8 state) {
+    if (state == SDL_PRESSED && key == SDL_SCANCODE_F5) {
+        snapshot_request = SnapshotRequest::Create;
+    } else if (state == SDL_PRESSED && key == SDL_SCANCODE_F9) {
+        snapshot_request = SnapshotRequest::Restore;
+    }
+
     if (state == SDL_PRESSED) {
         InputCommon::GetKeyboard()->PressKey(key);
     } else if (state == SDL_RELEASED) {
@@ -112,6 +118,10 @@ bool EmuWindow_SDL2::IsOpen() const {
     return is_open;
 }
 
+EmuWindow_SDL2::SnapshotRequest EmuWindow_SDL2::TakeSnapshotRequest() {
+    return snapshot_request.exchange(SnapshotRequest::None);
+}
+
 void EmuWindow_SDL2::OnResize() {
     int width, height;
     SDL_GetWindowSize(render_window, &width, &height);
@@ -165,7 +175,7 @@ bool EmuWindow_SDL2::SupportsRequiredGLExtensions() {
     return unsupported_ext.empty();
 }
 
-EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
+EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen, bool is_headless) : is_headless{is_headless} {
     // Initialize the window
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
         LOG_CRITICAL(Frontend, "Failed to initialize SDL2! Exiting...");
@@ -192,19 +202,22 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
     std::string window_title = fmt::format("yuzu {} | {}-{}", Common::g_build_fullname,
                                            Common::g_scm_branch, Common::g_scm_desc);
-    render_window =
-        SDL_CreateWindow(window_title.c_str(),
-                         SDL_WINDOWPOS_UNDEFINED, // x position
-                         SDL_WINDOWPOS_UNDEFINED, // y position
-                         Layout::ScreenUndocked::Width, Layout::ScreenUndocked::Height,
-                         SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+    // A headless window is never shown, the frames are rendered to its default framebuffer
+    const u32 window_flags = is_headless ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+                                         : SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE |
+                                               SDL_WINDOW_ALLOW_HIGHDPI;
+    render_window = SDL_CreateWindow(window_title.c_str(),
+                                     SDL_WINDOWPOS_UNDEFINED, // x position
+                                     SDL_WINDOWPOS_UNDEFINED, // y position
+                                     Layout::ScreenUndocked::Width, Layout::ScreenUndocked::Height,
+                                     window_flags);
 
     if (render_window == nullptr) {
         LOG_CRITICAL(Frontend, "Failed to create SDL2 window! {}", SDL_GetError());
         exit(1);
     }
 
-    if (fullscreen) {
+    if (fullscreen && !is_headless) {
         Fullscreen();
     }
     gl_context = SDL_GL_CreateContext(render_window);
@@ -242,6 +255,9 @@ EmuWindow_SDL2::~EmuWindow_SDL2() {
 }
 
 void EmuWindow_SDL2::SwapBuffers() {
+    if (is_headless) {
+        return;
+    }
     SDL_GL_SwapWindow(render_window);
 }
 
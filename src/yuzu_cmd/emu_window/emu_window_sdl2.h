@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include "core/frontend/emu_window.h"
@@ -12,7 +13,14 @@ struct SDL_Window;
 
 class EmuWindow_SDL2 : public Core::Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    enum class SnapshotRequest { None, Create, Restore };
+
+    /**
+     * Creates the window and its graphics context.
+     * @param fullscreen Whether the window starts in fullscreen mode
+     * @param is_headless Whether the window stays hidden, frames are rendered but not presented
+     */
+    explicit EmuWindow_SDL2(bool fullscreen, bool is_headless);
     ~EmuWindow_SDL2();
 
     /// Swap buffers to display the next frame
@@ -32,6 +40,9 @@ public:
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
+    /// Returns and clears the last snapshot hotkey (F5 creates, F9 restores) that was pressed
+    SnapshotRequest TakeSnapshotRequest();
+
 private:
     /// Called by PollEvents when a key is pressed or released.
     void OnKeyEvent(int key, u8 state);
@@ -70,6 +81,12 @@ private:
     /// Is the window still open?
     bool is_open = true;
 
+    /// Whether the window is hidden and swapping buffers is skipped
+    const bool is_headless;
+
+    /// Events are polled by the thread presenting frames, snapshots are taken by the main thread
+    std::atomic<SnapshotRequest> snapshot_request{SnapshotRequest::None};
+
     /// Internal SDL2 render window
     SDL_Window* render_window;
 
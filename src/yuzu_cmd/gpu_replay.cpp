@@ -0,0 +1,239 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <glad/glad.h>
+
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "core/core.h"
+#include "core/settings.h"
+#include "core/tracer/player.h"
+#include "yuzu_cmd/config.h"
+#include "yuzu_cmd/emu_window/emu_window_sdl2.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+extern "C" {
+// tells Nvidia and AMD drivers to use the dedicated GPU by default on laptops with switchable
+// graphics
+__declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
+}
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <trace>\n"
+                 "Replays a GPU trace recorded with the gpu_trace_frames setting on a hidden\n"
+                 "window and reports the time taken by every frame.\n"
+                 "-o, --output=FILE     Write the frame times as CSV to FILE, '-' writes them to\n"
+                 "                      the standard output\n"
+                 "-l, --loops=NUMBER    Replay the trace NUMBER times (default: 1), the caches\n"
+                 "                      are kept between two replays\n"
+                 "-h, --help            Display this help and exit\n"
+                 "-v, --version         Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "yuzu " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+static void InitializeLogging() {
+    Log::Filter log_filter(Log::Level::Debug);
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+}
+
+/// Times of a replayed frame, in microseconds
+struct FrameTime {
+    u32 loop;
+    u32 frame;
+    /// Host time taken to submit the frame to the GPU and the driver
+    u64 cpu_time;
+    /// Time the host GPU spent between the first command of the frame and its presentation
+    u64 gpu_time;
+};
+
+/// Logs the average, 99th percentile and max of a list of times given in microseconds
+static void LogTimeStats(const char* name, std::vector<u64> times) {
+    if (times.empty()) {
+        return;
+    }
+    std::sort(times.begin(), times.end());
+    u64 sum = 0;
+    for (const u64 time : times) {
+        sum += time;
+    }
+    const auto to_ms = [](u64 us) { return static_cast<double>(us) / 1000.0; };
+    const std::size_t p99_index = std::min(times.size() - 1, times.size() * 99 / 100);
+    LOG_INFO(Frontend, "{} time: {:.3f} ms avg, {:.3f} ms p99, {:.3f} ms max", name,
+             to_ms(sum) / static_cast<double>(times.size()), to_ms(times[p99_index]),
+             to_ms(times.back()));
+}
+
+static bool WriteFrameTimes(const std::string& path, const std::vector<FrameTime>& frame_times) {
+    std::string csv = "loop,frame,cpu_us,gpu_us\n";
+    for (const FrameTime& time : frame_times) {
+        csv += fmt::format("{},{},{},{}\n", time.loop, time.frame, time.cpu_time, time.gpu_time);
+    }
+
+    if (path == "-") {
+        std::cout << csv << std::flush;
+        return true;
+    }
+    if (FileUtil::WriteStringToFile(true, path, csv) != csv.size()) {
+        LOG_ERROR(Frontend, "Failed to write frame times to path={}", path);
+        return false;
+    }
+    return true;
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Config config;
+    InitializeLogging();
+
+    std::string filepath;
+    std::string output_path;
+    u32 num_loops = 1;
+
+    int option_index = 0;
+    char* endarg;
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'}, {"loops", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},         {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "o:l:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'l':
+                num_loops = static_cast<u32>(std::strtoul(optarg, &endarg, 0));
+                if (endarg == optarg || num_loops == 0) {
+                    std::cerr << "--loops: Expected a positive number of loops" << std::endl;
+                    return 1;
+                }
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+            filepath = argv[optind];
+            optind++;
+        }
+    }
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty()) {
+        LOG_CRITICAL(Frontend, "No GPU trace specified");
+        return -1;
+    }
+
+    // The frames are timed on the thread that submits them, nothing is recorded while replaying
+    Settings::values.use_asynchronous_gpu_emulation = false;
+    Settings::values.use_frame_limit = false;
+    Settings::values.gpu_trace_frames = 0;
+    Settings::Apply();
+
+    EmuWindow_SDL2 emu_window(false, true);
+    emu_window.MakeCurrent();
+
+    Core::System& system{Core::System::GetInstance()};
+    if (system.InitForReplay(emu_window) != Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to initialize VideoCore!");
+        return -1;
+    }
+    SCOPE_EXIT({ system.Shutdown(); });
+
+    Tracer::Player player(system);
+    if (!player.Load(filepath)) {
+        return -1;
+    }
+    const u32 num_frames = player.GetHeader().num_frames;
+    LOG_INFO(Frontend, "Replaying {} frames of {} {} times", num_frames, filepath, num_loops);
+
+    // Timestamp queries may overlap with the time elapsed queries of the renderer
+    std::array<GLuint, 2> queries{};
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    SCOPE_EXIT({ glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data()); });
+
+    std::vector<FrameTime> frame_times;
+    frame_times.reserve(static_cast<std::size_t>(num_frames) * num_loops);
+    for (u32 loop = 0; loop < num_loops && emu_window.IsOpen(); ++loop) {
+        player.Rewind();
+        for (u32 frame = 0;; ++frame) {
+            glQueryCounter(queries[0], GL_TIMESTAMP);
+            const auto cpu_start = std::chrono::steady_clock::now();
+            if (!player.PlayFrame()) {
+                break;
+            }
+            glQueryCounter(queries[1], GL_TIMESTAMP);
+            const auto cpu_end = std::chrono::steady_clock::now();
+
+            // Waits for the GPU, the following frame starts without work in flight
+            GLuint64 gpu_start = 0;
+            GLuint64 gpu_end = 0;
+            glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &gpu_start);
+            glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &gpu_end);
+
+            FrameTime& time = frame_times.emplace_back();
+            time.loop = loop;
+            time.frame = frame;
+            time.cpu_time = static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::microseconds>(cpu_end - cpu_start)
+                    .count());
+            time.gpu_time = (gpu_end - gpu_start) / 1000;
+
+            emu_window.PollEvents();
+        }
+    }
+
+    std::vector<u64> cpu_times;
+    std::vector<u64> gpu_times;
+    for (const FrameTime& time : frame_times) {
+        cpu_times.push_back(time.cpu_time);
+        gpu_times.push_back(time.gpu_time);
+    }
+    LOG_INFO(Frontend, "Replayed {} frames", frame_times.size());
+    LogTimeStats("CPU", std::move(cpu_times));
+    LogTimeStats("GPU", std::move(gpu_times));
+
+    if (!output_path.empty() && !WriteFrameTimes(output_path, frame_times)) {
+        return -1;
+    }
+    return 0;
+}
@@ -2,10 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <fmt/ostream.h>
 
@@ -15,18 +20,24 @@
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "common/telemetry.h"
+#include "common/trace.h"
 #include "core/core.h"
 #include "core/crypto/key_manager.h"
+#include "core/file_sys/title_compression.h"
 #include "core/file_sys/vfs_real.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
+#include "core/snapshot.h"
 #include "core/telemetry_session.h"
 #include "video_core/renderer_base.h"
 #include "yuzu_cmd/config.h"
@@ -38,7 +49,10 @@
 // windows.h needs to be included before shellapi.h
 #include <windows.h>
 
+#include <psapi.h>
 #include <shellapi.h>
+#else
+#include <sys/resource.h>
 #endif
 
 #undef _UNICODE
@@ -63,7 +77,192 @@ static void PrintHelp(const char* argv0) {
                  "-f, --fullscreen      Start in fullscreen mode\n"
                  "-h, --help            Display this help and exit\n"
                  "-v, --version         Output version information and exit\n"
-                 "-p, --program         Pass following string as arguments to executable\n";
+                 "-p, --program         Pass following string as arguments to executable\n"
+                 "-t, --frame-times=FILE  Write the timestamps of the last frames to a CSV FILE\n"
+                 "-c, --compress=FILE   Compress the XCI or NSP to FILE and exit\n"
+                 "-T, --trace=FILE      Write a Chrome trace of the emulation to FILE\n"
+                 "-b, --benchmark=FILE  Run a benchmark without frame limiting and write its JSON\n"
+                 "                      report to FILE, '-' writes it to the standard output\n"
+                 "-n, --frames=NUMBER   Stop the benchmark after NUMBER frames\n"
+                 "-s, --seconds=NUMBER  Stop the benchmark after NUMBER seconds (default: 60)\n"
+                 "-H, --headless        Render to a hidden window and don't present frames\n";
+}
+
+/// Options of a benchmark run, the run stops at the first of the limits reached
+struct BenchmarkOptions {
+    std::string report_path;
+    u64 num_frames = 0;
+    double num_seconds = 0.0;
+};
+
+/// Converts a title to the compressed format, which is loaded like the original
+static bool CompressTitleFile(const std::string& path, const std::string& output_path) {
+    const auto vfs = std::make_shared<FileSys::RealVfsFilesystem>();
+    const auto src = vfs->OpenFile(path, FileSys::Mode::Read);
+    const auto dest = vfs->CreateFile(output_path, FileSys::Mode::ReadWrite);
+    if (src == nullptr || dest == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to open {} or {}", path, output_path);
+        return false;
+    }
+
+    const std::size_t size = src->GetSize();
+    const bool success = FileSys::CompressTitle(src, dest, [size](std::size_t done) {
+        std::cout << "\rCompressing... " << done * 100 / std::max<std::size_t>(size, 1) << "%"
+                  << std::flush;
+        return true;
+    });
+    std::cout << std::endl;
+    if (!success) {
+        LOG_CRITICAL(Frontend, "Failed to compress {}", path);
+        return false;
+    }
+    LOG_INFO(Frontend, "Compressed {} from {} to {} bytes", path, size, dest->GetSize());
+    return true;
+}
+
+/// Writes the frame history as CSV, times are in microseconds since the first recorded event
+static void DumpFrameTimes(const std::string& path, Core::PerfStats& perf_stats) {
+    const auto history = perf_stats.GetFrameHistory();
+    if (history.empty()) {
+        LOG_WARNING(Frontend, "No frames were recorded, not writing {}", path);
+        return;
+    }
+
+    auto origin = Core::FrameTimestamps::Clock::time_point::max();
+    for (const auto& entry : history) {
+        for (const auto time : entry.times) {
+            if (time != Core::FrameTimestamps::Clock::time_point{}) {
+                origin = std::min(origin, time);
+            }
+        }
+    }
+
+    std::string csv = "frame,queue_buffer,compose,swap_begin,swap_end,present\n";
+    for (const auto& entry : history) {
+        csv += std::to_string(entry.frame);
+        for (const auto time : entry.times) {
+            csv += ',';
+            if (time != Core::FrameTimestamps::Clock::time_point{}) {
+                csv += std::to_string(
+                    std::chrono::duration_cast<std::chrono::microseconds>(time - origin).count());
+            }
+        }
+        csv += '\n';
+    }
+
+    const auto stats = Core::ComputeFrameTimeStats(history);
+    LOG_INFO(Frontend,
+             "Frame time: {:.2f} ms avg, {:.2f} ms 1% low, {:.2f} ms 0.1% low, {:.2f} ms max, {} "
+             "dropped",
+             stats.average, stats.percentile_99, stats.percentile_999, stats.max,
+             stats.dropped_frames);
+
+    if (FileUtil::WriteStringToFile(true, path, csv) != csv.size()) {
+        LOG_ERROR(Frontend, "Failed to write frame times to path={}", path);
+    }
+}
+
+/// Returns the largest resident set size the process had in bytes, 0 when the host doesn't tell
+static u64 GetPeakResidentSetSize() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<u64>(counters.PeakWorkingSetSize);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<u64>(usage.ru_maxrss);
+#else
+    // Linux reports the size in KiB
+    return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/// Formats the live and peak bytes of every memory accounting category as a JSON object
+static std::string FormatMemoryAccounting() {
+    std::string json = "{";
+    for (std::size_t i = 0; i < Common::MemoryAccounting::NumCategories; ++i) {
+        const auto category = static_cast<Common::MemoryAccounting::Category>(i);
+        json += fmt::format("{}\n    \"{}\": {{\"live_bytes\": {}, \"peak_bytes\": {}, "
+                            "\"device\": {}}}",
+                            i == 0 ? "" : ",", Common::MemoryAccounting::GetName(category),
+                            Common::MemoryAccounting::GetLiveBytes(category),
+                            Common::MemoryAccounting::GetPeakBytes(category),
+                            Common::MemoryAccounting::IsDeviceMemory(category));
+    }
+    return json + "\n  }";
+}
+
+/**
+ * Writes the JSON report of a benchmark, from the session metrics gathered since it started. Frame
+ * times are in milliseconds, the FPS lows are the rates of the frame time percentiles.
+ */
+static bool WriteBenchmarkReport(const std::string& path, Core::System& system,
+                                 double elapsed_seconds) {
+    auto& perf_stats = system.GetPerfStats();
+    const auto& frame_times = perf_stats.GetSessionHistogram(Core::SessionHistogram::FrameTime);
+    const auto& shader_builds =
+        perf_stats.GetSessionHistogram(Core::SessionHistogram::ShaderBuildTime);
+
+    const auto to_ms = [](u64 us) { return static_cast<double>(us) / 1000.0; };
+    const auto to_fps = [](double ms) { return ms > 0.0 ? 1000.0 / ms : 0.0; };
+    const u64 num_frames = frame_times.GetCount();
+    const double average_ms =
+        num_frames != 0 ? to_ms(frame_times.GetSum()) / static_cast<double>(num_frames) : 0.0;
+    const double p50_ms = to_ms(frame_times.GetPercentile(0.5));
+    const double p90_ms = to_ms(frame_times.GetPercentile(0.9));
+    const double p99_ms = to_ms(frame_times.GetPercentile(0.99));
+    const double p999_ms = to_ms(frame_times.GetPercentile(0.999));
+
+    const u64 cache_hits = perf_stats.GetSessionCount(Core::SessionCounter::SurfaceCacheHits);
+    const u64 cache_misses = perf_stats.GetSessionCount(Core::SessionCounter::SurfaceCacheMisses);
+    const u64 cache_lookups = cache_hits + cache_misses;
+    const double cache_hit_rate =
+        cache_lookups != 0 ? static_cast<double>(cache_hits) / cache_lookups : 0.0;
+    const auto perf_results = system.GetAndResetPerfStats();
+
+    const std::string report = fmt::format(
+        "{{\n"
+        "  \"version\": \"{} {}\",\n"
+        "  \"title_id\": \"{:016X}\",\n"
+        "  \"duration_seconds\": {:.3f},\n"
+        "  \"frames\": {},\n"
+        "  \"emulation_speed\": {:.4f},\n"
+        "  \"fps\": {{\"average\": {:.2f}, \"median\": {:.2f}, \"low_1\": {:.2f}, "
+        "\"low_0_1\": {:.2f}}},\n"
+        "  \"frame_time_ms\": {{\"average\": {:.3f}, \"p50\": {:.3f}, \"p90\": {:.3f}, "
+        "\"p99\": {:.3f}, \"p99_9\": {:.3f}, \"max\": {:.3f}}},\n"
+        "  \"shaders\": {{\"compiled\": {}, \"compile_time_ms\": {:.3f}, "
+        "\"max_compile_time_ms\": {:.3f}}},\n"
+        "  \"surface_cache\": {{\"hits\": {}, \"misses\": {}, \"hit_rate\": {:.4f}}},\n"
+        "  \"ipc_requests\": {},\n"
+        "  \"peak_rss_bytes\": {},\n"
+        "  \"memory\": {}\n"
+        "}}\n",
+        Common::g_scm_branch, Common::g_scm_desc, system.CurrentProcess()->GetTitleID(),
+        elapsed_seconds, num_frames, perf_results.emulation_speed,
+        elapsed_seconds > 0.0 ? static_cast<double>(num_frames) / elapsed_seconds : 0.0,
+        to_fps(p50_ms), to_fps(p99_ms), to_fps(p999_ms), average_ms, p50_ms, p90_ms, p99_ms,
+        p999_ms, to_ms(frame_times.GetMax()), shader_builds.GetCount(),
+        to_ms(shader_builds.GetSum()), to_ms(shader_builds.GetMax()), cache_hits, cache_misses,
+        cache_hit_rate, perf_stats.GetSessionCount(Core::SessionCounter::IpcRequests),
+        GetPeakResidentSetSize(), FormatMemoryAccounting());
+
+    if (path == "-") {
+        std::cout << report << std::flush;
+        return true;
+    }
+    if (FileUtil::WriteStringToFile(true, path, report) != report.size()) {
+        LOG_ERROR(Frontend, "Failed to write the benchmark report to path={}", path);
+        return false;
+    }
+    return true;
 }
 
 static void PrintVersion() {
@@ -109,15 +308,28 @@ int main(int argc, char** argv) {
     std::string filepath;
 
     bool fullscreen = false;
+    std::string frame_times_path;
+    std::string compress_path;
+    std::string trace_path;
+    std::optional<BenchmarkOptions> benchmark;
+    bool is_headless = false;
 
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'}, {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},          {"version", no_argument, 0, 'v'},
-        {"program", optional_argument, 0, 'p'}, {0, 0, 0, 0},
+        {"program", optional_argument, 0, 'p'}, {"frame-times", required_argument, 0, 't'},
+        {"compress", required_argument, 0, 'c'}, {"trace", required_argument, 0, 'T'},
+        {"benchmark", required_argument, 0, 'b'}, {"frames", required_argument, 0, 'n'},
+        {"seconds", required_argument, 0, 's'}, {"headless", no_argument, 0, 'H'},
+        {0, 0, 0, 0},
     };
 
+    // The limits may be given before --benchmark, they are applied once all options are parsed
+    u64 benchmark_frames = 0;
+    double benchmark_seconds = 0.0;
+
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:fhvp::t:c:T:b:n:s:H", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -145,6 +357,35 @@ int main(int argc, char** argv) {
                 Settings::values.program_args = argv[optind];
                 ++optind;
                 break;
+            case 't':
+                frame_times_path = optarg;
+                break;
+            case 'c':
+                compress_path = optarg;
+                break;
+            case 'T':
+                trace_path = optarg;
+                break;
+            case 'b':
+                benchmark.emplace().report_path = optarg;
+                break;
+            case 'n':
+                benchmark_frames = std::strtoull(optarg, &endarg, 0);
+                if (endarg == optarg || benchmark_frames == 0) {
+                    std::cerr << "--frames: Expected a positive number of frames" << std::endl;
+                    exit(1);
+                }
+                break;
+            case 's':
+                benchmark_seconds = std::strtod(optarg, &endarg);
+                if (endarg == optarg || benchmark_seconds <= 0.0) {
+                    std::cerr << "--seconds: Expected a positive number of seconds" << std::endl;
+                    exit(1);
+                }
+                break;
+            case 'H':
+                is_headless = true;
+                break;
             }
         } else {
 #ifdef _WIN32
@@ -161,6 +402,7 @@ int main(int argc, char** argv) {
 #endif
 
     MicroProfileOnThreadCreate("EmuThread");
+    Common::Trace::SetThreadName("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
     if (filepath.empty()) {
@@ -168,12 +410,27 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!compress_path.empty()) {
+        return CompressTitleFile(filepath, compress_path) ? 0 : -1;
+    }
+
+    if (benchmark) {
+        benchmark->num_frames = benchmark_frames;
+        // Without limits the benchmark runs for a minute
+        benchmark->num_seconds = benchmark_frames == 0 && benchmark_seconds == 0.0
+                                     ? 60.0
+                                     : benchmark_seconds;
+        // The emulation runs as fast as it can, the results must not depend on the host display
+        Settings::values.use_frame_limit = false;
+    }
+
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    std::unique_ptr<EmuWindow_SDL2> emu_window{
+        std::make_unique<EmuWindow_SDL2>(fullscreen, is_headless)};
 
     if (!Settings::values.use_multi_core) {
         // Single core mode must acquire OpenGL context for entire emulation session
@@ -185,6 +442,16 @@ int main(int argc, char** argv) {
     system.SetFilesystem(std::make_shared<FileSys::RealVfsFilesystem>());
     Service::FileSystem::CreateFactories(*system.GetFilesystem());
 
+    if (!trace_path.empty()) {
+        Common::Trace::Start();
+    }
+    // Runs after the shutdown below, the trace is written once the emulator threads are joined
+    SCOPE_EXIT({
+        if (!trace_path.empty()) {
+            Common::Trace::Stop();
+            Common::Trace::WriteChromeTrace(trace_path);
+        }
+    });
     SCOPE_EXIT({ system.Shutdown(); });
 
     const Core::System::ResultStatus load_result{system.Load(*emu_window, filepath)};
@@ -225,10 +492,63 @@ int main(int argc, char** argv) {
     emu_window->MakeCurrent();
     system.Renderer().Rasterizer().LoadDiskResources();
 
+    if (Settings::values.use_asynchronous_gpu_emulation) {
+        // Release OpenGL context for the GPU and presentation threads
+        emu_window->DoneCurrent();
+    }
+
+    // The benchmark measures the emulation from here, the boot and the disk caches are excluded
+    const auto benchmark_start = std::chrono::steady_clock::now();
+    const auto get_benchmark_seconds = [&benchmark_start] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - benchmark_start)
+            .count();
+    };
+    if (benchmark) {
+        system.GetPerfStats().ResetSessionMetrics();
+        system.GetAndResetPerfStats();
+    }
+
+    // Snapshots are kept in memory, the emulated CPU cores are stopped between two runs of the loop
+    std::optional<std::vector<u8>> snapshot;
     while (emu_window->IsOpen()) {
         system.RunLoop();
+
+        if (benchmark) {
+            const u64 num_frames =
+                system.GetPerfStats().GetSessionHistogram(Core::SessionHistogram::FrameTime)
+                    .GetCount();
+            if ((benchmark->num_frames != 0 && num_frames >= benchmark->num_frames) ||
+                (benchmark->num_seconds != 0.0 &&
+                 get_benchmark_seconds() >= benchmark->num_seconds)) {
+                break;
+            }
+        }
+
+        switch (emu_window->TakeSnapshotRequest()) {
+        case EmuWindow_SDL2::SnapshotRequest::Create:
+            snapshot = Core::CreateSnapshot(system);
+            break;
+        case EmuWindow_SDL2::SnapshotRequest::Restore:
+            if (!snapshot || !Core::RestoreSnapshot(system, *snapshot)) {
+                LOG_ERROR(Frontend, "Failed to restore the snapshot");
+            }
+            break;
+        case EmuWindow_SDL2::SnapshotRequest::None:
+            break;
+        }
+    }
+    const double elapsed_seconds = get_benchmark_seconds();
+
+    if (!frame_times_path.empty()) {
+        DumpFrameTimes(frame_times_path, system.GetPerfStats());
+    }
+
+    bool is_report_written = true;
+    if (benchmark) {
+        is_report_written =
+            WriteBenchmarkReport(benchmark->report_path, system, elapsed_seconds);
     }
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return is_report_written ? 0 : -1;
 }